@@ -2,10 +2,13 @@
 #include <ATen/BatchedFallback.h>
 #include <ATen/MatrixRef.h>
 #include <ATen/VmapTransforms.h>
+#include <ATen/core/Vitals.h>
 #include <ATen/core/dispatch/Dispatcher.h>
 #include <c10/util/accumulate.h>
 #include <c10/util/llvmMathExtras.h>
 
+#include <mutex>
+
 namespace at {
 
 // Given a linear index, return the actual index.
@@ -65,6 +68,30 @@ static bool isInplaceOp(const c10::FunctionSchema& schema) {
   return return_alias_info && return_alias_info.value().isWrite();
 }
 
+static std::mutex fallback_counts_mutex;
+
+static std::unordered_map<std::string, int64_t>& fallbackCounts() {
+  static std::unordered_map<std::string, int64_t> counts;
+  return counts;
+}
+
+// The fallback is slow enough that taking a lock per call does not matter
+static void countFallback(const c10::FunctionSchema& schema) {
+  TORCH_VITAL_COUNT("dispatcher.vmap_fallbacks", 1);
+  std::lock_guard<std::mutex> lock(fallback_counts_mutex);
+  fallbackCounts()[c10::toString(schema.operator_name())]++;
+}
+
+std::unordered_map<std::string, int64_t> getVmapFallbackCounts() {
+  std::lock_guard<std::mutex> lock(fallback_counts_mutex);
+  return fallbackCounts();
+}
+
+void resetVmapFallbackCounts() {
+  std::lock_guard<std::mutex> lock(fallback_counts_mutex);
+  fallbackCounts().clear();
+}
+
 static void warnFallback(const c10::FunctionSchema& schema, bool is_inplace) {
   if (!globalContext().areVmapFallbackWarningsEnabled()) {
     return;
@@ -88,6 +115,7 @@ static void warnFallback(const c10::FunctionSchema& schema, bool is_inplace) {
 void batchedTensorInplaceForLoopFallback(const c10::OperatorHandle& op, torch::jit::Stack* stack) {
   const auto& schema = op.schema();
   const auto num_returns = schema.returns().size();
+  countFallback(schema);
   warnFallback(schema, /*in_place*/true);
 
   const auto num_arguments = schema.arguments().size();
@@ -260,6 +288,7 @@ void batchedTensorForLoopFallback(const c10::OperatorHandle& op, torch::jit::Sta
   TORCH_CHECK(num_returns >= 1,
               "Batching rule not implemented for ", schema.operator_name(), ". ",
               "The fallback path does not support operations with no returns.");
+  countFallback(schema);
   warnFallback(schema, /*in_place*/false);
 
   const auto num_arguments = schema.arguments().size();
@@ -3,6 +3,9 @@
 #include <ATen/core/op_registration/op_registration.h>
 #include <torch/library.h>
 
+#include <string>
+#include <unordered_map>
+
 namespace at {
 
 // If an operator doesn't have a batching rule implemented then we fallback
@@ -20,4 +23,10 @@ namespace at {
 // write batching rules for operators whenever possible.
 void batchedTensorForLoopFallback(const c10::OperatorHandle& op, torch::jit::Stack* stack);
 
+// Counts, per operator name, the calls that went through the fallback since
+// the last reset. This is a coverage report of the missing batching rules:
+// the operators at the top are the ones that slow down vmap the most.
+TORCH_API std::unordered_map<std::string, int64_t> getVmapFallbackCounts();
+TORCH_API void resetVmapFallbackCounts();
+
 } // namespace at
@@ -3,6 +3,7 @@
 #include <ATen/BatchedFallback.h>
 #include <ATen/native/ResizeCommon.h>
 #include <ATen/ATen.h>
+#include <c10/util/accumulate.h>
 
 namespace at {
 
@@ -1013,6 +1014,312 @@ Tensor comparison_pointwise_batching_rule(const Tensor& self, const Tensor& othe
   return physical_args[0].getPhysicalToLogicalMap().apply(result);
 }
 
+// The physical arguments of a reduction over the logical `dims` of `self`. As
+// for the operators themselves, an empty `dims` reduces over all the logical
+// dims. A logical scalar is given a size-one dim to reduce over, which keepdim
+// must not keep.
+struct PhysicalReduction {
+  VmapPhysicalView self;
+  Tensor tensor;
+  VmapDimVector dims;
+  bool keepdim;
+};
+
+static PhysicalReduction getPhysicalReduction(const Tensor& self, IntArrayRef dims, bool keepdim) {
+  auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
+  auto tensor = self_physical.tensor();
+  VmapDimVector dims_physical;
+  if (/*logical*/self.dim() == 0) {
+    for (auto dim : dims) {
+      TORCH_CHECK(is_allowed_dim_on_scalar_tensor(dim),
+          "Dimension out of range (expected to be in range of [-1, 0], but got ", dim, ")");
+    }
+    tensor = tensor.unsqueeze(-1);
+    dims_physical.push_back(tensor.dim() - 1);
+    keepdim = false;
+  } else if (dims.empty()) {
+    for (int64_t dim = self_physical.numBatchDims(); dim < tensor.dim(); dim++) {
+      dims_physical.push_back(dim);
+    }
+  } else {
+    dims_physical = self_physical.getPhysicalDims(dims);
+  }
+  return {std::move(self_physical), std::move(tensor), std::move(dims_physical), keepdim};
+}
+
+Tensor mean_dim_batching_rule(const Tensor& self, IntArrayRef dims, bool keepdim, optional<ScalarType> dtype) {
+  auto physical = getPhysicalReduction(self, dims, keepdim);
+  auto result = at::mean(physical.tensor, physical.dims, physical.keepdim, dtype);
+  return physical.self.getPhysicalToLogicalMap().apply(result);
+}
+
+template <typename F, F Func>
+Tensor amax_amin_batching_rule(const Tensor& self, IntArrayRef dims, bool keepdim) {
+  auto physical = getPhysicalReduction(self, dims, keepdim);
+  auto result = Func(physical.tensor, physical.dims, physical.keepdim);
+  return physical.self.getPhysicalToLogicalMap().apply(result);
+}
+
+template <typename F, F Func>
+Tensor var_std_batching_rule(const Tensor& self, IntArrayRef dims, bool unbiased, bool keepdim) {
+  auto physical = getPhysicalReduction(self, dims, keepdim);
+  auto result = Func(physical.tensor, physical.dims, unbiased, physical.keepdim);
+  return physical.self.getPhysicalToLogicalMap().apply(result);
+}
+
+Tensor norm_batching_rule(const Tensor& self, const optional<Scalar>& p, IntArrayRef dims, bool keepdim) {
+  auto physical = getPhysicalReduction(self, dims, keepdim);
+  auto result = at::norm(physical.tensor, p, physical.dims, physical.keepdim);
+  return physical.self.getPhysicalToLogicalMap().apply(result);
+}
+
+Tensor prod_dim_batching_rule(const Tensor& self, int64_t dim, bool keepdim, optional<ScalarType> dtype) {
+  auto physical = getPhysicalReduction(self, dim, keepdim);
+  auto result = at::prod(physical.tensor, physical.dims[0], physical.keepdim, dtype);
+  return physical.self.getPhysicalToLogicalMap().apply(result);
+}
+
+template <typename F, F Func>
+std::tuple<Tensor, Tensor> max_min_dim_batching_rule(const Tensor& self, int64_t dim, bool keepdim) {
+  auto physical = getPhysicalReduction(self, dim, keepdim);
+  auto result = Func(physical.tensor, physical.dims[0], physical.keepdim);
+  auto physical_to_logical_map = physical.self.getPhysicalToLogicalMap();
+  return std::make_tuple(
+      physical_to_logical_map.apply(std::get<0>(result)),
+      physical_to_logical_map.apply(std::get<1>(result)));
+}
+
+// For operators that compute along one logical dim without reducing it, e.g.
+// softmax. A logical scalar is given a size-one dim that is removed afterwards.
+template <typename F, F Func, typename... ExtraArgs>
+Tensor along_dim_batching_rule(const Tensor& self, int64_t dim, ExtraArgs... extra_args) {
+  auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
+  if (/*logical*/self.dim() == 0) {
+    TORCH_CHECK(is_allowed_dim_on_scalar_tensor(dim),
+        "Dimension out of range (expected to be in range of [-1, 0], but got ", dim, ")");
+    auto result = Func(self_physical.tensor().unsqueeze(-1), -1, extra_args...);
+    return self_physical.getPhysicalToLogicalMap().apply(result.squeeze(-1));
+  }
+  auto dim_physical = self_physical.getPhysicalDim(dim);
+  auto result = Func(self_physical.tensor(), dim_physical, extra_args...);
+  return self_physical.getPhysicalToLogicalMap().apply(result);
+}
+
+// Note [Batching rules for convolution]
+// If only the input is batched, the batch dims are folded into N. A batched
+// weight gives every example its own filters: the examples are folded into the
+// channels and the convolution is done with `groups * batch_size` groups, so
+// that each group only sees the channels and the filters of one example:
+//   input [B, N, C, *], weight [B, O, C / groups, *]
+//   -> convolution of [N, B * C, *] with [B * O, C / groups, *]
+//   -> output [N, B * O, *] -> [B, N, O, *]
+// The same holds for transposed convolutions, whose weight is [B, C, O / groups, *].
+// A batched bias is added afterwards.
+Tensor convolution_batching_rule(
+    const Tensor& input, const Tensor& weight, const c10::optional<Tensor>& bias,
+    IntArrayRef stride, IntArrayRef padding, IntArrayRef dilation, bool transposed,
+    IntArrayRef output_padding, int64_t groups) {
+  const bool has_bias = bias.has_value() && bias->defined();
+  const bool weight_batched = isBatchedTensor(weight);
+  const bool add_bias_after = has_bias && (weight_batched || isBatchedTensor(*bias));
+  const auto physical_bias = add_bias_after ? c10::optional<Tensor>() : bias;
+
+  Tensor result;
+  if (!weight_batched && isBatchedTensor(input)) {
+    auto input_physical = MultiBatchVmapTransform::logicalToPhysical(input);
+    const auto& input_tensor = input_physical.tensor();
+    const auto num_batch_dims = input_physical.numBatchDims();
+    auto output = at::convolution(
+        input_tensor.flatten(0, num_batch_dims), weight, physical_bias, stride, padding,
+        dilation, transposed, output_padding, groups);
+    VmapDimVector output_shape(
+        input_tensor.sizes().begin(), input_tensor.sizes().begin() + num_batch_dims + 1);
+    output_shape.insert(output_shape.end(), output.sizes().begin() + 1, output.sizes().end());
+    result = input_physical.getPhysicalToLogicalMap().apply(output.view(output_shape));
+  } else if (!weight_batched) {
+    // Only the bias is batched
+    result = at::convolution(
+        input, weight, physical_bias, stride, padding, dilation, transposed, output_padding, groups);
+  } else {
+    auto physical_args = MultiBatchVmapTransform::logicalToPhysical({input, weight});
+    const auto& input_tensor = physical_args[0].tensor();
+    const auto& weight_tensor = physical_args[1].tensor();
+    const auto num_batch_dims = physical_args[0].numBatchDims();
+    const auto batch_sizes = input_tensor.sizes().slice(0, num_batch_dims);
+    const auto batch_size = c10::multiply_integers(batch_sizes);
+    const auto batch_size_n = input_tensor.size(num_batch_dims);
+    auto input_grouped = input_tensor.flatten(0, num_batch_dims - 1).transpose(0, 1).flatten(1, 2);
+    auto output = at::convolution(
+        input_grouped, weight_tensor.flatten(0, num_batch_dims), c10::nullopt, stride, padding,
+        dilation, transposed, output_padding, groups * batch_size);
+    // [N, B * O, *] -> [B, N, O, *] -> [B..., N, O, *]
+    VmapDimVector unflattened_shape(output.sizes().begin(), output.sizes().end());
+    unflattened_shape[1] = output.size(1) / batch_size;
+    unflattened_shape.insert(unflattened_shape.begin() + 1, batch_size);
+    VmapDimVector output_shape(batch_sizes.begin(), batch_sizes.end());
+    output_shape.push_back(batch_size_n);
+    output_shape.insert(output_shape.end(), unflattened_shape.begin() + 2, unflattened_shape.end());
+    output = output.view(unflattened_shape).transpose(0, 1).reshape(output_shape);
+    result = physical_args[0].getPhysicalToLogicalMap().apply(output);
+  }
+
+  if (add_bias_after) {
+    VmapDimVector bias_shape(/*logical*/result.dim() - 1, 1);
+    bias_shape[0] = -1;
+    result = result + bias->view(bias_shape);
+  }
+  return result;
+}
+
+Tensor embedding_batching_rule(
+    const Tensor& weight, const Tensor& indices, int64_t padding_idx,
+    bool scale_grad_by_freq, bool sparse) {
+  if (!isBatchedTensor(weight)) {
+    auto indices_physical = MultiBatchVmapTransform::logicalToPhysical(indices);
+    auto result = at::embedding(
+        weight, indices_physical.tensor(), padding_idx, scale_grad_by_freq, sparse);
+    return indices_physical.getPhysicalToLogicalMap().apply(result);
+  }
+  // Every example looks up its own weight: the indices are offset into the
+  // weights of all the examples stacked together.
+  auto physical_args = MultiBatchVmapTransform::logicalToPhysical({weight, indices});
+  const auto& weight_tensor = physical_args[0].tensor();
+  const auto& indices_tensor = physical_args[1].tensor();
+  const auto num_batch_dims = physical_args[0].numBatchDims();
+  const auto batch_sizes = weight_tensor.sizes().slice(0, num_batch_dims);
+  VmapDimVector offsets_shape(batch_sizes.begin(), batch_sizes.end());
+  offsets_shape.resize(indices_tensor.dim(), 1);
+  auto offsets = at::arange(c10::multiply_integers(batch_sizes), indices_tensor.options())
+      .mul_(weight_tensor.size(num_batch_dims))
+      .view(offsets_shape);
+  auto result = at::embedding(
+      weight_tensor.flatten(0, num_batch_dims), indices_tensor + offsets,
+      /*padding_idx=*/-1, scale_grad_by_freq, sparse);
+  if (padding_idx >= 0) {
+    // The offset indices can't express a padding_idx per example, its entries
+    // are instead cut off from the gradient here.
+    result = at::where((indices_tensor == padding_idx).unsqueeze(-1), result.detach(), result);
+  }
+  return physical_args[0].getPhysicalToLogicalMap().apply(result);
+}
+
+Tensor index_select_batching_rule(const Tensor& self, int64_t dim, const Tensor& index) {
+  if (!isBatchedTensor(index)) {
+    auto self_physical = MultiBatchVmapTransform::logicalToPhysical(self);
+    auto dim_physical = self_physical.getPhysicalDim(dim);
+    auto result = at::index_select(self_physical.tensor(), dim_physical, index);
+    return self_physical.getPhysicalToLogicalMap().apply(result);
+  }
+  // Every example selects with its own index: move `dim` next to the batch
+  // dims and offset the indices into the slices of all the examples.
+  auto physical_args = MultiBatchVmapTransform::logicalToPhysical({self, index});
+  const auto& self_tensor = physical_args[0].tensor();
+  auto index_tensor = physical_args[1].tensor();
+  const auto num_batch_dims = physical_args[0].numBatchDims();
+  const auto dim_physical = physical_args[0].getPhysicalDim(dim);
+  const auto batch_sizes = self_tensor.sizes().slice(0, num_batch_dims);
+  const auto batch_size = c10::multiply_integers(batch_sizes);
+  if (/*logical*/index.dim() == 0) {
+    index_tensor = index_tensor.unsqueeze(-1);
+  }
+  const auto dim_size = self_tensor.size(dim_physical);
+  auto self_flat = self_tensor.movedim(dim_physical, num_batch_dims).flatten(0, num_batch_dims);
+  auto offsets = at::arange(batch_size, index_tensor.options()).mul_(dim_size).unsqueeze(-1);
+  auto flat_index = (index_tensor.reshape({batch_size, -1}) + offsets).flatten();
+  auto result = at::index_select(self_flat, 0, flat_index);
+  VmapDimVector result_shape(batch_sizes.begin(), batch_sizes.end());
+  result_shape.push_back(index_tensor.size(-1));
+  result_shape.insert(result_shape.end(), result.sizes().begin() + 1, result.sizes().end());
+  result = result.view(result_shape).movedim(num_batch_dims, dim_physical);
+  return physical_args[0].getPhysicalToLogicalMap().apply(result);
+}
+
+Tensor gather_batching_rule(const Tensor& self, int64_t dim, const Tensor& index, bool sparse_grad) {
+  auto physical_args = MultiBatchVmapTransform::logicalToPhysical({self, index});
+  auto dim_physical = physical_args[0].getPhysicalDim(dim);
+  auto result = at::gather(
+      physical_args[0].tensor(), dim_physical, physical_args[1].tensor(), sparse_grad);
+  return physical_args[0].getPhysicalToLogicalMap().apply(result);
+}
+
+static bool isBatchedAffine(const c10::optional<Tensor>& weight, const c10::optional<Tensor>& bias) {
+  return (weight.has_value() && isBatchedTensor(*weight)) ||
+      (bias.has_value() && isBatchedTensor(*bias));
+}
+
+// Applies a batched weight and bias of a normalization, as views of
+// `affine_shape` so that they broadcast against `result`.
+static Tensor applyBatchedAffine(
+    Tensor result, const c10::optional<Tensor>& weight, const c10::optional<Tensor>& bias,
+    IntArrayRef affine_shape) {
+  if (weight.has_value() && weight->defined()) {
+    result = result * weight->view(affine_shape);
+  }
+  if (bias.has_value() && bias->defined()) {
+    result = result + bias->view(affine_shape);
+  }
+  return result;
+}
+
+// The normalized dims are the last ones, so batch dims at the front do not
+// change what is normalized. A batched weight or bias is applied afterwards.
+Tensor layer_norm_batching_rule(
+    const Tensor& input, IntArrayRef normalized_shape, const c10::optional<Tensor>& weight,
+    const c10::optional<Tensor>& bias, double eps, bool cudnn_enable) {
+  const bool affine_batched = isBatchedAffine(weight, bias);
+  const auto physical_weight = affine_batched ? c10::optional<Tensor>() : weight;
+  const auto physical_bias = affine_batched ? c10::optional<Tensor>() : bias;
+  Tensor result;
+  if (isBatchedTensor(input)) {
+    auto input_physical = MultiBatchVmapTransform::logicalToPhysical(input);
+    result = at::layer_norm(
+        input_physical.tensor(), normalized_shape, physical_weight, physical_bias, eps, cudnn_enable);
+    result = input_physical.getPhysicalToLogicalMap().apply(result);
+  } else {
+    result = at::layer_norm(input, normalized_shape, c10::nullopt, c10::nullopt, eps, cudnn_enable);
+  }
+  if (affine_batched) {
+    result = applyBatchedAffine(result, weight, bias, normalized_shape);
+  }
+  return result;
+}
+
+// The batch dims are folded into N, as the groups are normalized per sample.
+Tensor group_norm_batching_rule(
+    const Tensor& input, int64_t num_groups, const c10::optional<Tensor>& weight,
+    const c10::optional<Tensor>& bias, double eps, bool cudnn_enabled) {
+  const bool affine_batched = isBatchedAffine(weight, bias);
+  const auto physical_weight = affine_batched ? c10::optional<Tensor>() : weight;
+  const auto physical_bias = affine_batched ? c10::optional<Tensor>() : bias;
+  Tensor result;
+  if (isBatchedTensor(input)) {
+    auto input_physical = MultiBatchVmapTransform::logicalToPhysical(input);
+    const auto& input_tensor = input_physical.tensor();
+    result = at::group_norm(
+        input_tensor.flatten(0, input_physical.numBatchDims()), num_groups, physical_weight,
+        physical_bias, eps, cudnn_enabled);
+    result = input_physical.getPhysicalToLogicalMap().apply(result.view(input_tensor.sizes()));
+  } else {
+    result = at::group_norm(input, num_groups, c10::nullopt, c10::nullopt, eps, cudnn_enabled);
+  }
+  if (affine_batched) {
+    VmapDimVector affine_shape(/*logical*/input.dim() - 1, 1);
+    affine_shape[0] = -1;
+    result = applyBatchedAffine(result, weight, bias, affine_shape);
+  }
+  return result;
+}
+
+// Only the tangent may be batched: a batched tangent on an unbatched primal
+// propagates all the directions of the batch in one forward pass, see
+// torch.autograd.functional.batched_jvp.
+Tensor _make_dual_batching_rule(const Tensor& primal, const Tensor& tangent, int64_t level) {
+  TORCH_CHECK(!isBatchedTensor(primal),
+      "vmap: Creating a dual Tensor from a primal that is being vmapped over is "
+      "not supported. Only the tangent may have a batch dimension.");
+  return native::_make_dual(primal, tangent, level);
+}
+
 TORCH_LIBRARY_IMPL(_, Batched, m) {
   m.fallback(torch::CppFunction::makeFromBoxedFunction<&batchedTensorForLoopFallback>());
 }
@@ -1025,6 +1332,7 @@ TORCH_LIBRARY_IMPL(aten, Batched, m) {
   m.impl("size.int", static_cast<int64_t (*)(const Tensor&, int64_t)>(native::size));
   m.impl("_add_batch_dim", native::_add_batch_dim);
   m.impl("_remove_batch_dim", native::_remove_batch_dim);
+  m.impl("_make_dual", _make_dual_batching_rule);
 
   m.impl("sum.dim_IntList", sum_batching_rule);
   m.impl("is_complex", native::is_complex);
@@ -1217,6 +1525,36 @@ TORCH_LIBRARY_IMPL(aten, Batched, m) {
   COMPARISON_POINTWISE(ne);
 
 #undef COMPARISON_POINTWISE
+
+  // reductions
+  using AmaxAminType = Tensor (*)(const Tensor&, IntArrayRef, bool);
+  using VarStdType = Tensor (*)(const Tensor&, IntArrayRef, bool, bool);
+  using MaxMinDimType = std::tuple<Tensor, Tensor> (*)(const Tensor&, int64_t, bool);
+  m.impl("mean.dim", mean_dim_batching_rule);
+  m.impl("amax", amax_amin_batching_rule<AmaxAminType, at::amax>);
+  m.impl("amin", amax_amin_batching_rule<AmaxAminType, at::amin>);
+  m.impl("var.dim", var_std_batching_rule<VarStdType, at::var>);
+  m.impl("std.dim", var_std_batching_rule<VarStdType, at::std>);
+  m.impl("norm.ScalarOpt_dim", norm_batching_rule);
+  m.impl("prod.dim_int", prod_dim_batching_rule);
+  m.impl("max.dim", max_min_dim_batching_rule<MaxMinDimType, at::max>);
+  m.impl("min.dim", max_min_dim_batching_rule<MaxMinDimType, at::min>);
+
+  using SoftmaxType = Tensor (*)(const Tensor&, int64_t, bool);
+  using CumsumType = Tensor (*)(const Tensor&, int64_t, optional<ScalarType>);
+  m.impl("_softmax", along_dim_batching_rule<SoftmaxType, at::_softmax, bool>);
+  m.impl("_log_softmax", along_dim_batching_rule<SoftmaxType, at::_log_softmax, bool>);
+  m.impl("cumsum", along_dim_batching_rule<CumsumType, at::cumsum, optional<ScalarType>>);
+
+  // indexing
+  m.impl("index_select", index_select_batching_rule);
+  m.impl("gather", gather_batching_rule);
+  m.impl("embedding", embedding_batching_rule);
+
+  // convolution and normalization
+  m.impl("convolution", convolution_batching_rule);
+  m.impl("layer_norm", layer_norm_batching_rule);
+  m.impl("group_norm", group_norm_batching_rule);
 }
 
 } // namespace at
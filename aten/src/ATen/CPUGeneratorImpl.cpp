@@ -45,6 +45,18 @@ struct CPUGeneratorImplState {
   bool is_next_float_normal_sample_valid;
 };
 
+/**
+ * CPUGeneratorImplPhiloxState extends CPUGeneratorImplState with the
+ * counter-based mode of at::CPUGeneratorImpl. get_state() only returns it
+ * once the Philox stream has been used, so the state of every other generator
+ * keeps the size of CPUGeneratorImplState.
+ */
+struct CPUGeneratorImplPhiloxState {
+  CPUGeneratorImplState state;
+  uint64_t philox_offset;
+  bool philox_mode;
+};
+
 /**
  * PyTorch maintains a collection of default generators that get
  * initialized once. The purpose of these default generators is to
@@ -75,6 +87,27 @@ inline uint64_t make64BitsFrom32Bits(uint32_t hi, uint32_t lo) {
 
 } // namespace detail
 
+/**
+ * Note [CPU Philox mode]
+ * ~~~~~~~~~~~~~~~~~~~~~~
+ * By default CPUGeneratorImpl draws from its mt19937 engine, which is
+ * inherently serial: the distribution kernels hold the generator mutex for
+ * the whole tensor and fill it on one thread.
+ *
+ * In the Philox mode, the uniform, normal and scalar bernoulli kernels
+ * instead reserve a range of the counter-based Philox4_32_10 stream for
+ * (current_seed(), philox_offset) under the lock, advance philox_offset past
+ * it and release the lock. Element i of the output is then computed from a
+ * fixed position of that range, so the tensor can be filled by parallel_for
+ * chunks and the result doesn't depend on the number of threads. The other
+ * kernels keep using the mt19937 engine in either mode.
+ *
+ * _fused_dropout_add_layer_norm draws its mask from the Philox stream in
+ * either mode, since its backward regenerates the mask from the reserved range.
+ *
+ * The two modes produce different sequences for the same seed.
+ */
+
 /**
  * CPUGeneratorImpl class implementation
  */
@@ -92,6 +125,7 @@ void CPUGeneratorImpl::set_current_seed(uint64_t seed) {
   next_float_normal_sample_.reset();
   next_double_normal_sample_.reset();
   engine_ = mt19937(seed);
+  philox_offset_ = 0;
 }
 
 /**
@@ -125,19 +159,25 @@ uint64_t CPUGeneratorImpl::seed() {
 void CPUGeneratorImpl::set_state(const c10::TensorImpl& new_state) {
   using detail::CPUGeneratorImplState;
   using detail::CPUGeneratorImplStateLegacy;
+  using detail::CPUGeneratorImplPhiloxState;
 
   static_assert(std::is_pod<CPUGeneratorImplStateLegacy>::value, "CPUGeneratorImplStateLegacy is not a PODType");
   static_assert(std::is_pod<CPUGeneratorImplState>::value, "CPUGeneratorImplState is not a PODType");
+  static_assert(std::is_pod<CPUGeneratorImplPhiloxState>::value, "CPUGeneratorImplPhiloxState is not a PODType");
 
   static const size_t size_legacy = sizeof(CPUGeneratorImplStateLegacy);
   static const size_t size_current = sizeof(CPUGeneratorImplState);
+  static const size_t size_philox = sizeof(CPUGeneratorImplPhiloxState);
   static_assert(size_legacy != size_current, "CPUGeneratorImplStateLegacy and CPUGeneratorImplState can't be of the same size");
+  static_assert(size_legacy != size_philox, "CPUGeneratorImplStateLegacy and CPUGeneratorImplPhiloxState can't be of the same size");
 
   detail::check_rng_state(new_state);
 
   at::mt19937 engine;
   auto float_normal_sample = c10::optional<float>();
   auto double_normal_sample = c10::optional<double>();
+  bool philox_mode = false;
+  uint64_t philox_offset = 0;
 
   // Construct the state of at::CPUGeneratorImpl based on input byte tensor size.
   CPUGeneratorImplStateLegacy* legacy_pod;
@@ -158,8 +198,16 @@ void CPUGeneratorImpl::set_state(const c10::TensorImpl& new_state) {
       // we return the sin version of the normal sample when in caching mode
       double_normal_sample = c10::optional<double>(r * ::sin(theta));
     }
-  } else if (new_state_size == size_current) {
-    auto rng_state = (CPUGeneratorImplState*)new_state.data();
+  } else if (new_state_size == size_current || new_state_size == size_philox) {
+    CPUGeneratorImplState* rng_state;
+    if (new_state_size == size_philox) {
+      auto philox_state = (CPUGeneratorImplPhiloxState*)new_state.data();
+      rng_state = &philox_state->state;
+      philox_mode = philox_state->philox_mode;
+      philox_offset = philox_state->philox_offset;
+    } else {
+      rng_state = (CPUGeneratorImplState*)new_state.data();
+    }
     legacy_pod = &rng_state->legacy_pod;
     // update next_float_normal_sample
     if (rng_state->is_next_float_normal_sample_valid) {
@@ -175,7 +223,8 @@ void CPUGeneratorImpl::set_state(const c10::TensorImpl& new_state) {
     }
   } else {
     AT_ERROR("Expected either a CPUGeneratorImplStateLegacy of size ", size_legacy,
-             " or a CPUGeneratorImplState of size ", size_current,
+             ", a CPUGeneratorImplState of size ", size_current,
+             " or a CPUGeneratorImplPhiloxState of size ", size_philox,
              " but found the input RNG state size to be ", new_state_size);
   }
 
@@ -194,6 +243,8 @@ void CPUGeneratorImpl::set_state(const c10::TensorImpl& new_state) {
   this->engine_ = engine;
   this->next_float_normal_sample_ = float_normal_sample;
   this->next_double_normal_sample_ = double_normal_sample;
+  this->philox_mode_ = philox_mode;
+  this->philox_offset_ = philox_offset;
 }
 
 /**
@@ -202,15 +253,23 @@ void CPUGeneratorImpl::set_state(const c10::TensorImpl& new_state) {
  */
 c10::intrusive_ptr<c10::TensorImpl> CPUGeneratorImpl::get_state() const {
   using detail::CPUGeneratorImplState;
+  using detail::CPUGeneratorImplPhiloxState;
 
-  static const size_t size = sizeof(CPUGeneratorImplState);
   static_assert(std::is_pod<CPUGeneratorImplState>::value, "CPUGeneratorImplState is not a PODType");
+  static_assert(std::is_pod<CPUGeneratorImplPhiloxState>::value, "CPUGeneratorImplPhiloxState is not a PODType");
+
+  // See Note [CPU Philox mode]
+  const bool with_philox = philox_mode_ || philox_offset_ != 0;
+  const size_t size = with_philox ? sizeof(CPUGeneratorImplPhiloxState) : sizeof(CPUGeneratorImplState);
 
   auto state_tensor = at::detail::empty_cpu({(int64_t)size}, ScalarType::Byte, c10::nullopt, c10::nullopt, c10::nullopt, c10::nullopt);
   auto rng_state = state_tensor.data_ptr();
 
   // accumulate generator data to be copied into byte tensor
-  auto accum_state = std::make_unique<CPUGeneratorImplState>();
+  auto philox_state = std::make_unique<CPUGeneratorImplPhiloxState>();
+  philox_state->philox_offset = philox_offset_;
+  philox_state->philox_mode = philox_mode_;
+  CPUGeneratorImplState* accum_state = &philox_state->state;
   auto rng_data = this->engine_.data();
   accum_state->legacy_pod.the_initial_seed = rng_data.seed_;
   accum_state->legacy_pod.left = rng_data.left_;
@@ -232,7 +291,11 @@ c10::intrusive_ptr<c10::TensorImpl> CPUGeneratorImpl::get_state() const {
     accum_state->next_float_normal_sample = *(this->next_float_normal_sample_);
   }
 
-  memcpy(rng_state, accum_state.get(), size);
+  if (with_philox) {
+    memcpy(rng_state, philox_state.get(), size);
+  } else {
+    memcpy(rng_state, accum_state, size);
+  }
   return state_tensor.getIntrusivePtr();
 }
 
@@ -312,6 +375,53 @@ void CPUGeneratorImpl::set_engine(at::mt19937 engine) {
   engine_ = engine;
 }
 
+/**
+ * Switches the uniform, normal and scalar bernoulli kernels between the
+ * mt19937 engine and the Philox stream. See Note [CPU Philox mode]
+ *
+ * See Note [Acquire lock when using random generators]
+ */
+void CPUGeneratorImpl::set_philox_mode(bool enabled) {
+  philox_mode_ = enabled;
+}
+
+/**
+ * Gets whether the CPUGeneratorImpl is in the Philox mode
+ */
+bool CPUGeneratorImpl::philox_mode() const {
+  return philox_mode_;
+}
+
+/**
+ * Sets the offset, in 128 bit Philox outputs, of the next reserved range
+ *
+ * See Note [Acquire lock when using random generators]
+ */
+void CPUGeneratorImpl::set_philox_offset(uint64_t offset) {
+  philox_offset_ = offset;
+}
+
+/**
+ * Gets the offset of the next reserved range of the Philox stream
+ */
+uint64_t CPUGeneratorImpl::philox_offset() const {
+  return philox_offset_;
+}
+
+/**
+ * Reserves increment 128 bit outputs of the Philox stream and returns the
+ * seed and the offset of the reserved range. Like its counterpart in
+ * CUDAGeneratorImpl, the caller fills its tensor from that range without
+ * holding the lock.
+ *
+ * See Note [Acquire lock when using random generators]
+ */
+std::pair<uint64_t, uint64_t> CPUGeneratorImpl::philox_engine_inputs(uint64_t increment) {
+  uint64_t offset = philox_offset_;
+  philox_offset_ += increment;
+  return std::make_pair(this->current_seed(), offset);
+}
+
 /**
  * Public clone method implementation
  *
@@ -331,6 +441,8 @@ CPUGeneratorImpl* CPUGeneratorImpl::clone_impl() const {
   gen->set_engine(engine_);
   gen->set_next_float_normal_sample(next_float_normal_sample_);
   gen->set_next_double_normal_sample(next_double_normal_sample_);
+  gen->set_philox_mode(philox_mode_);
+  gen->set_philox_offset(philox_offset_);
   return gen;
 }
 
@@ -37,25 +37,24 @@ DLDataType getDLDataType(const Tensor& t) {
       dtype.code = DLDataTypeCode::kDLFloat;
       break;
     case ScalarType::Bool:
-      dtype.code = DLDataTypeCode::kDLUInt;
+      dtype.code = DLDataTypeCode::kDLBool;
       break;
     case ScalarType::BFloat16:
-      throw std::logic_error("BFloat16 is not supported by dlpack");
+      dtype.code = DLDataTypeCode::kDLBfloat;
+      break;
+    case ScalarType::ComplexHalf:
+    case ScalarType::ComplexFloat:
+    case ScalarType::ComplexDouble:
+      dtype.code = DLDataTypeCode::kDLComplex;
       break;
     case ScalarType::QInt8:
     case ScalarType::QUInt8:
     case ScalarType::QInt32:
     case ScalarType::QUInt4x2:
-      throw std::logic_error("QUInt/QInt types are not supported by dlpack");
-      break;
-    case ScalarType::ComplexHalf:
-      throw std::logic_error("ComplexHalf is not supported by dlpack");
-      break;
-    case ScalarType::ComplexFloat:
-      throw std::logic_error("ComplexFloat is not supported by dlpack");
-      break;
-    case ScalarType::ComplexDouble:
-      throw std::logic_error("ComplexDouble is not supported by dlpack");
+      // dlpack has no way to carry the quantization parameters
+      throw std::logic_error(
+          "QUInt/QInt types are not supported by dlpack, "
+          "export the integer representation from int_repr() instead");
       break;
     case ScalarType::Undefined:
       throw std::logic_error("Undefined is not a valid ScalarType");
@@ -96,6 +95,7 @@ DLContext getDLContext(const Tensor& tensor, const int64_t& device_id) {
 static Device getATenDevice(const DLContext& ctx) {
   switch (ctx.device_type) {
     case DLDeviceType::kDLCPU:
+    case DLDeviceType::kDLCPUPinned:
       return at::Device(DeviceType::CPU);
 #ifndef USE_ROCM
     // if we are compiled under HIP, we cannot do cuda
@@ -167,6 +167,42 @@ ScalarType toScalarType(const DLDataType& dtype) {
               "Unsupported kFloat bits " + c10::to_string(dtype.bits));
       }
       break;
+    case DLDataTypeCode::kDLBfloat:
+      switch (dtype.bits) {
+        case 16:
+          stype = ScalarType::BFloat16;
+          break;
+        default:
+          throw std::logic_error(
+              "Unsupported kBfloat bits " + c10::to_string(dtype.bits));
+      }
+      break;
+    case DLDataTypeCode::kDLComplex:
+      switch (dtype.bits) {
+        case 32:
+          stype = ScalarType::ComplexHalf;
+          break;
+        case 64:
+          stype = ScalarType::ComplexFloat;
+          break;
+        case 128:
+          stype = ScalarType::ComplexDouble;
+          break;
+        default:
+          throw std::logic_error(
+              "Unsupported kComplex bits " + c10::to_string(dtype.bits));
+      }
+      break;
+    case DLDataTypeCode::kDLBool:
+      switch (dtype.bits) {
+        case 8:
+          stype = ScalarType::Bool;
+          break;
+        default:
+          throw std::logic_error(
+              "Unsupported kBool bits " + c10::to_string(dtype.bits));
+      }
+      break;
     default:
       throw std::logic_error("Unsupported code " + c10::to_string(dtype.code));
   }
@@ -211,16 +247,28 @@ Tensor fromDLPack(const DLManagedTensor* src) {
   auto deleter = [src](void* self) {
     src->deleter(const_cast<DLManagedTensor*>(src));
   };
+  void* data =
+      static_cast<char*>(src->dl_tensor.data) + src->dl_tensor.byte_offset;
+  IntArrayRef sizes(src->dl_tensor.shape, src->dl_tensor.ndim);
   if (!src->dl_tensor.strides) {
-    return at::from_blob(src->dl_tensor.data,
-        IntArrayRef(src->dl_tensor.shape, src->dl_tensor.ndim),
+    return at::from_blob(data,
+        sizes,
         deleter,
         at::device(device).dtype(stype));
   }
+  IntArrayRef strides(src->dl_tensor.strides, src->dl_tensor.ndim);
+  for (int64_t i = 0; i < src->dl_tensor.ndim; i++) {
+    // a view that is empty along a dimension can have any stride there
+    if (strides[i] < 0 && sizes[i] > 1) {
+      throw std::logic_error(
+          "ATen does not support negative strides, got " +
+          c10::to_string(strides[i]) + " in dimension " + c10::to_string(i));
+    }
+  }
   return at::from_blob(
-      src->dl_tensor.data,
-      IntArrayRef(src->dl_tensor.shape, src->dl_tensor.ndim),
-      IntArrayRef(src->dl_tensor.strides, src->dl_tensor.ndim),
+      data,
+      sizes,
+      strides,
       deleter,
       at::device(device).dtype(stype),
       { device });
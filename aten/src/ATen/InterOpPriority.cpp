@@ -0,0 +1,189 @@
+#include <ATen/InterOpPriority.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace at {
+
+namespace {
+
+thread_local internal::InterOpPriorityState interop_state;
+
+// Future whose task the next at::launch call on this thread queues
+thread_local c10::intrusive_ptr<c10::ivalue::Future> launch_future;
+
+// Tasks completing futures that are not completed yet. Leaked so that it
+// outlives tasks finishing during shutdown.
+struct FutureTasks {
+  std::mutex mutex;
+  std::unordered_map<
+      const c10::ivalue::Future*,
+      std::weak_ptr<internal::InterOpTask>>
+      tasks;
+};
+
+FutureTasks& future_tasks() {
+  static FutureTasks* future_tasks = new FutureTasks();
+  return *future_tasks;
+}
+
+void set_future_task(
+    const c10::intrusive_ptr<c10::ivalue::Future>& future,
+    const std::shared_ptr<internal::InterOpTask>& task) {
+  auto& registry = future_tasks();
+  const c10::ivalue::Future* key = future.get();
+  {
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.tasks[key] = task;
+  }
+  future->addCallback([key]() {
+    auto& registry = future_tasks();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.tasks.erase(key);
+  });
+}
+
+c10::TaskPriority current_priority() {
+  if (interop_state.task) {
+    return interop_state.priority.combine(interop_state.task->priority());
+  }
+  return interop_state.priority;
+}
+
+} // namespace
+
+c10::TaskPriority get_interop_priority() {
+  return interop_state.priority;
+}
+
+void set_interop_priority(const c10::TaskPriority& priority) {
+  interop_state.priority = priority;
+}
+
+InterOpPriorityGuard::InterOpPriorityGuard(const c10::TaskPriority& priority)
+    : prev_(get_interop_priority()) {
+  set_interop_priority(priority);
+}
+
+InterOpPriorityGuard::~InterOpPriorityGuard() {
+  set_interop_priority(prev_);
+}
+
+void raise_interop_priority_for(const c10::ivalue::Future& future) {
+  if (future.completed()) {
+    return;
+  }
+  std::shared_ptr<internal::InterOpTask> task;
+  {
+    auto& registry = future_tasks();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = registry.tasks.find(&future);
+    if (it == registry.tasks.end()) {
+      return;
+    }
+    task = it->second.lock();
+  }
+  if (task) {
+    task->raise(current_priority());
+  }
+}
+
+namespace internal {
+
+c10::TaskPriority InterOpTask::priority() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return priority_;
+}
+
+void InterOpTask::set_queued(
+    std::shared_ptr<c10::PriorityThreadPool::Task> queued) {
+  c10::TaskPriority priority;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queued_ = queued;
+    priority = priority_;
+  }
+  // catch up with raises that happened before the task was queued
+  queued->raise(priority);
+}
+
+void InterOpTask::add_launched(const std::shared_ptr<InterOpTask>& task) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // drop finished tasks before growing, which keeps this amortized O(1)
+  if (launched_.size() == launched_.capacity()) {
+    launched_.erase(
+        std::remove_if(
+            launched_.begin(),
+            launched_.end(),
+            [](const std::weak_ptr<InterOpTask>& t) { return t.expired(); }),
+        launched_.end());
+  }
+  launched_.push_back(task);
+}
+
+void InterOpTask::raise(const c10::TaskPriority& priority) {
+  std::shared_ptr<c10::PriorityThreadPool::Task> queued;
+  std::vector<std::weak_ptr<InterOpTask>> launched;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!priority.runsBefore(priority_)) {
+      return;
+    }
+    priority_ = priority_.combine(priority);
+    queued = queued_.lock();
+    launched = launched_;
+  }
+  if (queued) {
+    queued->raise(priority);
+  }
+  for (const auto& weak_task : launched) {
+    if (auto task = weak_task.lock()) {
+      task->raise(priority);
+    }
+  }
+}
+
+InterOpPriorityState get_interop_priority_state() {
+  return interop_state;
+}
+
+void set_interop_priority_state(InterOpPriorityState state) {
+  interop_state = std::move(state);
+}
+
+std::shared_ptr<InterOpTask> new_launched_interop_task() {
+  auto task = std::make_shared<InterOpTask>(current_priority());
+  if (interop_state.task) {
+    interop_state.task->add_launched(task);
+  }
+  if (launch_future) {
+    set_future_task(launch_future, task);
+    launch_future.reset();
+  }
+  return task;
+}
+
+LaunchForFutureGuard::LaunchForFutureGuard(
+    c10::intrusive_ptr<c10::ivalue::Future> future)
+    : prev_(std::move(launch_future)) {
+  launch_future = std::move(future);
+}
+
+LaunchForFutureGuard::~LaunchForFutureGuard() {
+  launch_future = std::move(prev_);
+}
+
+InterOpTaskGuard::InterOpTaskGuard(std::shared_ptr<InterOpTask> task)
+    : prev_(get_interop_priority_state()) {
+  InterOpPriorityState state;
+  state.priority = task->priority();
+  state.task = std::move(task);
+  set_interop_priority_state(std::move(state));
+}
+
+InterOpTaskGuard::~InterOpTaskGuard() {
+  set_interop_priority_state(std::move(prev_));
+}
+
+} // namespace internal
+} // namespace at
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <ATen/core/ivalue.h>
+#include <c10/core/thread_pool.h>
+#include <c10/macros/Macros.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace at {
+
+// Note [Inter-op task priorities]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// at::launch queues tasks on the native inter-op pool in c10::TaskPriority
+// order: higher priority first, then earliest deadline first, then FIFO.
+// A task gets the priority of the thread that launches it, which is set with
+// InterOpPriorityGuard and inherited by launched tasks through
+// ThreadLocalState, so the forks of one request run at that request's
+// priority wherever they are launched from.
+//
+// Waiting for a future that an inter-op task completes raises that task to
+// the waiter's priority if the waiter's is more urgent (see
+// raise_interop_priority_for). The raise is transitive over launches: the
+// tasks launched by a raised task are raised as well. In TorchScript these
+// are its forks and the continuations it resumes with after waiting, so a
+// high priority wait does not end up behind the low priority subgraphs it
+// depends on. Only queued tasks are reordered; running tasks are never
+// preempted.
+
+// Returns the priority given to the tasks that at::launch queues from the
+// calling thread
+TORCH_API c10::TaskPriority get_interop_priority();
+
+// Sets the priority given to the tasks that at::launch queues from the
+// calling thread
+TORCH_API void set_interop_priority(const c10::TaskPriority& priority);
+
+// Sets the inter-op priority of the calling thread for the guard's lifetime,
+// e.g. for one request:
+//
+//   at::InterOpPriorityGuard guard(
+//       {/* priority */ 1, c10::TaskPriority::deadlineAfter(deadline)});
+//   module.forward(inputs);
+class TORCH_API InterOpPriorityGuard {
+ public:
+  explicit InterOpPriorityGuard(const c10::TaskPriority& priority);
+  ~InterOpPriorityGuard();
+
+ private:
+  c10::TaskPriority prev_;
+};
+
+// Raises the inter-op task that completes `future`, and the tasks it
+// launched, to the calling thread's priority. Does nothing if `future` is
+// not completed by an inter-op task or the task is already more urgent.
+TORCH_API void raise_interop_priority_for(const c10::ivalue::Future& future);
+
+namespace internal {
+
+// Priority state of one task queued by at::launch
+class TORCH_API InterOpTask {
+ public:
+  explicit InterOpTask(const c10::TaskPriority& priority)
+      : priority_(priority) {}
+
+  c10::TaskPriority priority() const;
+
+  // Attaches the pool entry of this task, which raise() reorders
+  void set_queued(std::shared_ptr<c10::PriorityThreadPool::Task> queued);
+
+  // Records `task` as launched by this one
+  void add_launched(const std::shared_ptr<InterOpTask>& task);
+
+  // Raises this task and the tasks it launched to `priority`
+  void raise(const c10::TaskPriority& priority);
+
+ private:
+  mutable std::mutex mutex_;
+  c10::TaskPriority priority_;
+  std::weak_ptr<c10::PriorityThreadPool::Task> queued_;
+  std::vector<std::weak_ptr<InterOpTask>> launched_;
+};
+
+// Inter-op priority state of a thread, saved and restored by
+// ThreadLocalState
+struct InterOpPriorityState {
+  c10::TaskPriority priority;
+  // Task the thread is running, if it is an inter-op task
+  std::shared_ptr<InterOpTask> task;
+};
+
+TORCH_API InterOpPriorityState get_interop_priority_state();
+TORCH_API void set_interop_priority_state(InterOpPriorityState state);
+
+// Creates the state of a task that the calling thread is about to launch.
+// The task inherits the thread's priority and is recorded as launched by the
+// thread's current task and as completing the future of the innermost
+// LaunchForFutureGuard, if any.
+TORCH_API std::shared_ptr<InterOpTask> new_launched_interop_task();
+
+// Makes the task launched by the next at::launch call on this thread the one
+// that completes `future`, see raise_interop_priority_for
+class TORCH_API LaunchForFutureGuard {
+ public:
+  explicit LaunchForFutureGuard(c10::intrusive_ptr<c10::ivalue::Future> future);
+  ~LaunchForFutureGuard();
+
+ private:
+  c10::intrusive_ptr<c10::ivalue::Future> prev_;
+};
+
+// Sets the calling thread's state to run `task` for the guard's lifetime
+class TORCH_API InterOpTaskGuard {
+ public:
+  explicit InterOpTaskGuard(std::shared_ptr<InterOpTask> task);
+  ~InterOpTaskGuard();
+
+ private:
+  InterOpPriorityState prev_;
+};
+
+} // namespace internal
+} // namespace at
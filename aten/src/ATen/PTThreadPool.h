@@ -2,6 +2,12 @@
 
 #include <ATen/Parallel.h>
 #include <c10/core/thread_pool.h>
+#include <c10/util/numa.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace at {
 
@@ -10,10 +16,64 @@ public:
   explicit PTThreadPool(
       int pool_size,
       int numa_node_id = -1)
-    : c10::ThreadPool(pool_size, numa_node_id, [](){
+    : c10::ThreadPool(pool_size, numa_node_id, [numa_node_id](){
+        c10::setThreadName("PTThreadPool");
+        c10::NUMABind(numa_node_id);
+        at::init_num_threads();
+      }) {}
+};
+
+class TORCH_API PTPriorityThreadPool : public c10::PriorityThreadPool {
+public:
+  explicit PTPriorityThreadPool(
+      int pool_size,
+      int numa_node_id = -1)
+    : c10::PriorityThreadPool(pool_size, numa_node_id, [numa_node_id](){
+        c10::setThreadName("PTThreadPool");
+        c10::NUMABind(numa_node_id);
+        at::init_num_threads();
+      }) {}
+};
+
+class TORCH_API PTWorkStealingThreadPool : public c10::WorkStealingThreadPool {
+public:
+  explicit PTWorkStealingThreadPool(
+      int pool_size,
+      int numa_node_id = -1)
+    : c10::WorkStealingThreadPool(pool_size, numa_node_id, [numa_node_id](){
         c10::setThreadName("PTThreadPool");
+        c10::NUMABind(numa_node_id);
         at::init_num_threads();
       }) {}
 };
 
+// Thread pools of type `Pool`, one per NUMA node, each created on first use
+// with `pool_size` threads bound to its node.
+template <typename Pool>
+class NUMAThreadPools {
+public:
+  explicit NUMAThreadPools(int pool_size)
+    : pool_size_(pool_size),
+      num_nodes_(std::max(c10::GetNumNUMANodes(), 0)),
+      pools_(num_nodes_),
+      created_(new std::once_flag[num_nodes_]) {}
+
+  // Returns nullptr for nodes that are not configured
+  c10::TaskThreadPoolBase* get(int node) {
+    if (node < 0 || node >= num_nodes_) {
+      return nullptr;
+    }
+    std::call_once(created_[node], [this, node]() {
+      pools_[node] = std::make_shared<Pool>(pool_size_, node);
+    });
+    return pools_[node].get();
+  }
+
+private:
+  const int pool_size_;
+  const int num_nodes_;
+  std::vector<std::shared_ptr<c10::TaskThreadPoolBase>> pools_;
+  std::unique_ptr<std::once_flag[]> created_;
+};
+
 } // namespace at
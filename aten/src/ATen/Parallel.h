@@ -25,6 +25,15 @@ TORCH_API int get_thread_num();
 // Checks whether the code runs in parallel region
 TORCH_API bool in_parallel_region();
 
+// Sets whether a parallel_for or parallel_reduce nested in a parallel region
+// may use idle intra-op threads instead of running serially. Only the native
+// parallel backend supports it; with other backends nested regions always
+// run serially. Disabled by default.
+TORCH_API void set_nested_parallelism(bool enabled);
+
+// Returns whether nested parallel regions may use idle intra-op threads
+TORCH_API bool get_nested_parallelism();
+
 namespace internal {
 
 // Initialise num_threads lazily at first parallel call
@@ -36,6 +45,12 @@ inline TORCH_API void lazy_init_num_threads() {
   }
 }
 
+// Returns the grain size to pass to parallel_for for elements that each
+// cost about `cost` units, one unit being one element of a vectorized float
+// add. Ranges shorter than the result are not worth splitting and run
+// serially. See Note [Cost-based grain size]
+TORCH_API int64_t grain_size_for_cost(double cost);
+
 }
 
 /*
@@ -118,12 +133,38 @@ TORCH_API void set_num_interop_threads(int);
 // Returns the number of threads used for inter-op parallelism
 TORCH_API int get_num_interop_threads();
 
-// Launches inter-op parallel task
+// Launches inter-op parallel task. Tasks are queued in the priority order
+// set with InterOpPriorityGuard, see Note [Inter-op task priorities]
 TORCH_API void launch(std::function<void()> func);
 namespace internal {
 void launch_no_thread_state(std::function<void()> fn);
 } // namespace internal
 
+// Sets whether inter-op and intra-op thread pools are partitioned by NUMA
+// node. When enabled, each node gets its own pools whose threads are bound to
+// that node, and launch() and parallel_for called from a thread bound to a
+// node (see set_thread_numa_node) only use that node's threads; other threads
+// keep using the default pools. Per-node intra-op pools are only used by the
+// native parallel backend. Like set_num_interop_threads, it cannot be changed
+// after parallel work has started. Has no effect unless NUMA is enabled.
+TORCH_API void set_numa_thread_pools(bool enabled);
+
+// Returns whether thread pools are partitioned by NUMA node
+TORCH_API bool get_numa_thread_pools();
+
+// Binds the calling thread, and the CPU memory it allocates, to NUMA node
+// `node`
+TORCH_API void set_thread_numa_node(int node);
+
+// Returns the NUMA node the calling thread is bound to, or -1
+TORCH_API int get_thread_numa_node();
+
+namespace internal {
+// Returns the node whose thread pools the calling thread should use, or -1
+// for the default pools. Marks the NUMA pool setting as consumed.
+TORCH_API int numa_pool_node();
+} // namespace internal
+
 // Launches intra-op parallel task
 TORCH_API void intraop_launch(std::function<void()> func);
 
@@ -4,8 +4,13 @@
 #include <ATen/PTThreadPool.h>
 #include <ATen/Version.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
 #include <sstream>
 #include <thread>
+#include <vector>
 
 #ifdef TH_BLAS_MKL
 #include <mkl.h>
@@ -40,8 +45,65 @@ size_t get_env_num_threads(const char* var_name, size_t def_value = 0) {
   return def_value;
 }
 
+std::atomic<bool> nested_parallelism{false};
+
+// Note [Cost-based grain size]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// A parallel_for chunk has to do enough work to pay for handing it to a
+// pool thread and joining it, which costs on the order of microseconds
+// whatever the op. A fixed grain size in elements cannot express that: it
+// is too small for cheap ops and too large for expensive ones like lgamma.
+// grain_size_for_cost instead takes a per-element cost estimate from the
+// kernel, in units of one element of a vectorized float add, and returns
+// the number of elements that keep a thread busy for kMinChunkNanos. The
+// time of a unit is calibrated once per process with a reference loop on
+// the calling thread, so the grain size follows the host's single-thread
+// throughput.
+constexpr double kMinChunkNanos = 10000;
+
+double measure_nanos_per_cost_unit() {
+  constexpr int64_t kSize = 4096;
+  std::vector<float> x(kSize, 1.f);
+  std::vector<float> y(kSize, 0.f);
+  double best = std::numeric_limits<double>::max();
+  for (int rep = 0; rep < 16; rep++) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < kSize; i++) {
+      y[i] += x[i];
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    const double nanos =
+        std::chrono::duration<double, std::nano>(stop - start).count();
+    best = std::min(best, nanos / kSize);
+  }
+  // keep the loop from being optimized away
+  volatile float sink = y[kSize - 1];
+  (void)sink;
+  // guard against coarse clocks and preempted measurements
+  return std::min(std::max(best, 0.05), 5.0);
+}
+
 } // namespace
 
+namespace internal {
+
+int64_t grain_size_for_cost(double cost) {
+  static const double nanos_per_unit = measure_nanos_per_cost_unit();
+  TORCH_INTERNAL_ASSERT(cost > 0);
+  const double grain = kMinChunkNanos / (cost * nanos_per_unit);
+  return static_cast<int64_t>(std::min(std::max(grain, 1.0), 1e12));
+}
+
+} // namespace internal
+
+void set_nested_parallelism(bool enabled) {
+  nested_parallelism = enabled;
+}
+
+bool get_nested_parallelism() {
+  return nested_parallelism.load(std::memory_order_relaxed);
+}
+
 std::string get_parallel_info() {
   std::ostringstream ss;
 
@@ -49,6 +111,8 @@ std::string get_parallel_info() {
      << at::get_num_threads() << std::endl;
   ss << "\tat::get_num_interop_threads() : "
      << at::get_num_interop_threads() << std::endl;
+  ss << "\tat::get_nested_parallelism() : "
+     << at::get_nested_parallelism() << std::endl;
 
   ss << at::get_openmp_version() << std::endl;
 #ifdef _OPENMP
@@ -10,6 +10,13 @@
 #endif // C10_MOBILE
 
 #include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -36,10 +43,6 @@ void _set_thread_num(size_t thread_num) {
   thread_num_ = thread_num;
 }
 
-void _unset_thread_num() {
-  thread_num_ = 0;
-}
-
 #ifndef C10_MOBILE
 
 const int NOT_SET = -1;
@@ -55,6 +58,20 @@ const int CONSUMED = -2;
 //  - CONSUMED - pool is initialized
 std::atomic<int> num_intraop_threads{NOT_SET};
 
+// Note [Intra-op parallelism after fork]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// fork() only copies the calling thread, so in a process forked after the
+// intra-op pool started its threads, the pool has workers that do not exist
+// and possibly locks that they held. Work queued there would never run, so
+// such a child runs all intra-op parallel work serially on the calling thread
+// and never touches the pool. set_num_threads() cannot do this: the pool
+// cannot be resized once it exists.
+bool in_forked_child = false;
+
+void forked_child() {
+  in_forked_child = true;
+}
+
 int _num_pool_threads(int nthreads) {
   if (nthreads == NOT_SET) {
     nthreads = intraop_default_num_threads();
@@ -65,27 +82,49 @@ int _num_pool_threads(int nthreads) {
   return nthreads - 1;
 }
 
+int _intraop_pool_size() {
+  static const int pool_size =
+      _num_pool_threads(num_intraop_threads.exchange(CONSUMED));
+  return pool_size;
+}
+
 TaskThreadPoolBase& _get_intraop_pool() {
+  // Not taken from ThreadPoolRegistry: the intra-op pool runs many short,
+  // often nested tasks and uses a work-stealing pool for them.
   static std::shared_ptr<TaskThreadPoolBase> pool =
-      ThreadPoolRegistry()->Create(
-          "C10",
-          /* device_id */ 0,
-          /* pool_size */ _num_pool_threads(num_intraop_threads.exchange(CONSUMED)),
-          /* create_new */ true); // create a separate thread pool for intra-op
+      std::make_shared<PTWorkStealingThreadPool>(_intraop_pool_size());
+#ifndef _WIN32
+  // See Note [Intra-op parallelism after fork]
+  static std::once_flag flag;
+  std::call_once(flag, []() {
+    pthread_atfork(nullptr, nullptr, forked_child);
+  });
+#endif
+  // Threads bound to a node, including the workers of that node's pool,
+  // use the node's own pool. See set_numa_thread_pools.
+  const int node = internal::numa_pool_node();
+  if (node >= 0) {
+    static NUMAThreadPools<PTWorkStealingThreadPool> numa_pools(
+        _intraop_pool_size());
+    if (auto* numa_pool = numa_pools.get(node)) {
+      return *numa_pool;
+    }
+  }
   return *pool;
 }
 
 #endif // C10_MOBILE
 
-// Run lambda function `fn` over `task_id` in [0, `range`) with threadpool.
-// `fn` will be called with params: (thread_pool_task_id, task_id).
-void _run_with_pool(const std::function<void(int, size_t)>& fn, size_t range) {
+// Run lambda function `fn` over `worker_id` in [0, `num_workers`) with
+// threadpool. Worker 0 runs on the current thread. Does not wait for the
+// remaining workers; `fn` must keep whatever it uses alive on its own.
+void _run_with_pool(const std::function<void(size_t)>& fn, size_t num_workers) {
 #ifndef C10_MOBILE
-  for (size_t i = 1; i < range; ++i) {
-    _get_intraop_pool().run([fn, i]() { fn((int)i, i); });
+  for (size_t i = 1; i < num_workers; ++i) {
+    _get_intraop_pool().run([fn, i]() { fn(i); });
   }
-  // Run the first task on the current thread directly.
-  fn(0, 0);
+  // Run the first worker on the current thread directly.
+  fn(0);
 #else
   caffe2::PThreadPool* const pool = caffe2::pthreadpool();
   TORCH_INTERNAL_ASSERT(pool, "Invalid thread pool!");
@@ -94,28 +133,81 @@ void _run_with_pool(const std::function<void(int, size_t)>& fn, size_t range) {
     // PThreadPool::run() is blocking.  A std::function [const] reference to
     // this lambda cannot go out of scope before PThreadPool::run() returns.
     [&fn](const size_t task_id) {
-      fn(0 /* unused */, task_id);
-    }, range);
+      fn(task_id);
+    }, num_workers);
 #endif // C10_MOBILE
 }
 
 // RAII guard helps to support in_parallel_region() and get_thread_num() API.
+// Restores the enclosing region's state, as regions can nest.
+// See Note [Nested parallelism in the native backend]
 struct ParallelRegionGuard {
-  ParallelRegionGuard(int64_t task_id) {
+  ParallelRegionGuard(int64_t task_id)
+    : prev_thread_num_(thread_num_),
+      prev_in_parallel_region_(in_parallel_region_) {
     _set_thread_num(task_id);
     _set_in_parallel_region(true);
   }
 
   ~ParallelRegionGuard() {
-    _set_in_parallel_region(false);
-    _unset_thread_num();
+    _set_in_parallel_region(prev_in_parallel_region_);
+    _set_thread_num(prev_thread_num_);
   }
+
+ private:
+  size_t prev_thread_num_;
+  bool prev_in_parallel_region_;
 };
 
 } // namespace
 
 namespace internal {
 
+// Note [Chunk scheduling in the native backend]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// _parallel_run splits the range into up to kChunksPerThread chunks per
+// thread (never smaller than grain_size) and starts one worker per thread,
+// at most one per chunk. Workers claim chunks from a shared counter until
+// none are left, the calling thread being worker 0. With one chunk per thread
+// a parallel_for finished only when its slowest thread did; now a thread
+// that drew cheap chunks, or a pool thread that starts late because it was
+// busy, just claims more or fewer of them.
+//
+// Two ids are involved:
+//  - the chunk index is passed to `f` as its task id. parallel_reduce stores
+//    one partial result per chunk and combines them in chunk order, so its
+//    result does not depend on which thread ran which chunk.
+//  - get_thread_num() returns the worker id, which stays in
+//    [0, get_num_threads()). Kernels that index per-thread buffers with it
+//    must expect to be called for several chunks on the same thread.
+
+// Note [Nested parallelism in the native backend]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// By default a parallel_for inside a parallel region runs serially. That
+// leaves most cores idle when the outer loop has fewer iterations than there
+// are threads, e.g. a batch of a few large matrices. With
+// set_nested_parallelism(true) the inner region instead runs as a regular
+// region whose extra workers are limited to the pool threads that are idle
+// when it starts, so the total number of busy threads stays within the
+// intra-op budget; with no idle thread it still runs serially.
+//
+// This cannot deadlock: a thread only waits for chunks that other workers
+// have already claimed and are running, never for workers that are still
+// queued (see Note [Chunk scheduling in the native backend]).
+// get_thread_num() inside the inner region is the inner worker id, and the
+// outer id is restored when the inner region returns.
+
+bool _nested_region_runs_serially() {
+#ifndef C10_MOBILE
+  return in_forked_child || !get_nested_parallelism() ||
+      _get_intraop_pool().numAvailable() == 0;
+#else
+  // PThreadPool::run() blocks, and does not support being called from its
+  // own workers.
+  return true;
+#endif // C10_MOBILE
+}
+
 void _parallel_run(
   const int64_t begin,
   const int64_t end,
@@ -127,47 +219,59 @@ void _parallel_run(
   std::tie(num_tasks, chunk_size) =
       internal::calc_num_tasks_and_chunk_size(begin, end, grain_size);
 
-  struct {
+  // See Note [Chunk scheduling in the native backend]
+  struct State {
     std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
     std::exception_ptr eptr;
+    std::atomic<size_t> next_chunk{0};
+    std::atomic<size_t> chunks_done{0};
     std::mutex mutex;
-    volatile size_t remaining;
     std::condition_variable cv;
-  } state;
-
-  auto task = [f, &state, begin, end, chunk_size]
-      (int /* unused */, size_t task_id) {
-    int64_t local_start = begin + task_id * chunk_size;
-    if (local_start < end) {
+  };
+  // Shared with the workers: a worker scheduled after all chunks are done
+  // still reads the chunk counter.
+  auto state = std::make_shared<State>();
+  const auto* f_ptr = &f;
+
+  auto worker = [state, f_ptr, begin, end, chunk_size, num_tasks]
+      (size_t worker_id) {
+    ParallelRegionGuard guard(worker_id);
+    size_t chunk;
+    while ((chunk = state->next_chunk++) < num_tasks) {
+      int64_t local_start = begin + chunk * chunk_size;
       int64_t local_end = std::min(end, (int64_t)(chunk_size + local_start));
       try {
-        ParallelRegionGuard guard(task_id);
-        f(local_start, local_end, task_id);
+        (*f_ptr)(local_start, local_end, chunk);
       } catch (...) {
-        if (!state.err_flag.test_and_set()) {
-          state.eptr = std::current_exception();
+        if (!state->err_flag.test_and_set()) {
+          state->eptr = std::current_exception();
         }
       }
-    }
-    {
-      std::unique_lock<std::mutex> lk(state.mutex);
-      if (--state.remaining == 0) {
-        state.cv.notify_one();
+      if (++state->chunks_done == num_tasks) {
+        std::unique_lock<std::mutex> lk(state->mutex);
+        state->cv.notify_one();
       }
     }
   };
-  state.remaining = num_tasks;
-  _run_with_pool(task, num_tasks);
+  size_t num_workers =
+      std::min(num_tasks, static_cast<size_t>(get_num_threads()));
+#ifndef C10_MOBILE
+  if (in_parallel_region() && !in_forked_child) {
+    // Only borrow idle threads, see Note [Nested parallelism in the native backend]
+    num_workers = std::min(num_workers, _get_intraop_pool().numAvailable() + 1);
+  }
+#endif // C10_MOBILE
+  _run_with_pool(worker, num_workers);
 
-  // Wait for all tasks to finish.
+  // Wait for all chunks to finish.
   {
-    std::unique_lock<std::mutex> lk(state.mutex);
-    if (state.remaining != 0) {
-      state.cv.wait(lk);
-    }
+    std::unique_lock<std::mutex> lk(state->mutex);
+    state->cv.wait(lk, [&state, num_tasks]() {
+      return state->chunks_done == num_tasks;
+    });
   }
-  if (state.eptr) {
-    std::rethrow_exception(state.eptr);
+  if (state->eptr) {
+    std::rethrow_exception(state->eptr);
   }
 }
 
@@ -195,7 +299,9 @@ void set_num_threads(int nthreads) {
     // num_intraop_threads either stores a positive integer or CONSUMED,
     // check that requested size is the same as the current one
     int stored_nthreads = num_intraop_threads.load();
-    if (stored_nthreads <= 0) {
+    if (in_forked_child) {
+      stored_nthreads = 1;
+    } else if (stored_nthreads <= 0) {
       // plus one because of master thread
       stored_nthreads = _get_intraop_pool().size() + 1;
     }
@@ -224,7 +330,8 @@ int get_num_threads() {
     return intraop_default_num_threads();
   } else {
     TORCH_INTERNAL_ASSERT(nthreads == CONSUMED);
-    return _get_intraop_pool().size() + 1;
+    // See Note [Intra-op parallelism after fork]
+    return in_forked_child ? 1 : _get_intraop_pool().size() + 1;
   }
 #else
   caffe2::PThreadPool* const pool = caffe2::pthreadpool();
@@ -240,7 +347,7 @@ int get_thread_num() {
 bool in_parallel_region() {
 #ifndef C10_MOBILE
   return in_parallel_region_ || (
-    num_intraop_threads.load() == CONSUMED &&
+    num_intraop_threads.load() == CONSUMED && !in_forked_child &&
     // Needed as intraop_launch() doesn't set in_parallel_region().
     _get_intraop_pool().inThreadPool()
   );
@@ -9,19 +9,31 @@
 namespace at {
 namespace internal {
 
+// Number of chunks per thread that _parallel_run aims for, so that threads
+// which finish early can pick up the remaining work.
+// See Note [Chunk scheduling in the native backend]
+constexpr int64_t kChunksPerThread = 4;
+
 inline std::tuple<size_t, size_t> calc_num_tasks_and_chunk_size(
     int64_t begin, int64_t end, int64_t grain_size) {
   if ((end - begin) < grain_size) {
     return std::make_tuple(1, std::max((int64_t)0, end - begin));
   }
   // Choose number of tasks based on grain size and number of threads.
-  size_t chunk_size = divup((end - begin), get_num_threads());
+  const int64_t num_threads = get_num_threads();
+  size_t chunk_size = divup((end - begin),
+      num_threads > 1 ? num_threads * kChunksPerThread : 1);
   // Make sure each task is at least grain_size size.
   chunk_size = std::max((size_t)grain_size, chunk_size);
   size_t num_tasks = divup((end - begin), chunk_size);
   return std::make_tuple(num_tasks, chunk_size);
 }
 
+// Whether a parallel_for or parallel_reduce called from inside a parallel
+// region has to run serially on the calling thread.
+// See Note [Nested parallelism in the native backend]
+TORCH_API bool _nested_region_runs_serially();
+
 TORCH_API void _parallel_run(
   const int64_t begin,
   const int64_t end,
@@ -40,7 +52,8 @@ inline void parallel_for(
   if (begin >= end) {
     return;
   }
-  if ((end - begin) < grain_size || in_parallel_region()) {
+  if ((end - begin) < grain_size ||
+      (in_parallel_region() && internal::_nested_region_runs_serially())) {
     f(begin, end);
     return;
   }
@@ -66,7 +79,8 @@ inline scalar_t parallel_reduce(
   if (begin >= end) {
     return ident;
   }
-  if ((end - begin) < grain_size || in_parallel_region()) {
+  if ((end - begin) < grain_size ||
+      (in_parallel_region() && internal::_nested_region_runs_serially())) {
     return f(begin, end, ident);
   }
   size_t num_tasks, chunk_size;
@@ -1,6 +1,7 @@
 #include <ATen/Config.h>
 #if AT_PARALLEL_OPENMP || AT_PARALLEL_NATIVE || AT_PARALLEL_NATIVE_TBB
 #include <ATen/Parallel.h>
+#include <ATen/InterOpPriority.h>
 #include <ATen/PTThreadPool.h>
 #include <ATen/ThreadLocalState.h>
 
@@ -19,6 +20,16 @@ const int CONSUMED = -2;
 // NOT_SET -> CONSUMED
 std::atomic<int> num_interop_threads{NOT_SET};
 
+// Whether thread pools are partitioned by NUMA node, and whether that
+// setting was already used to pick a pool
+std::atomic<bool> numa_thread_pools{false};
+std::atomic<bool> numa_thread_pools_consumed{false};
+
+int _num_interop_pool_threads() {
+  static const int pool_size = num_interop_threads.exchange(CONSUMED);
+  return pool_size;
+}
+
 // thread pool global instance is hidden,
 // users should use at::launch and get/set_num_interop_threads interface
 TaskThreadPoolBase& get_pool() {
@@ -26,8 +37,15 @@ TaskThreadPoolBase& get_pool() {
       ThreadPoolRegistry()->Create(
           "C10",
           /* device_id */ 0,
-          /* pool_size */ num_interop_threads.exchange(CONSUMED),
+          /* pool_size */ _num_interop_pool_threads(),
           /* create_new */ true);
+  const int node = internal::numa_pool_node();
+  if (node >= 0) {
+    static NUMAThreadPools<PTPriorityThreadPool> numa_pools(_num_interop_pool_threads());
+    if (auto* numa_pool = numa_pools.get(node)) {
+      return *numa_pool;
+    }
+  }
   return *pool;
 }
 
@@ -40,7 +58,7 @@ std::shared_ptr<TaskThreadPoolBase> create_c10_threadpool(
   TORCH_CHECK(device_id == 0);
   // Create new thread pool
   TORCH_CHECK(create_new);
-  return std::make_shared<PTThreadPool>(pool_size);
+  return std::make_shared<PTPriorityThreadPool>(pool_size);
 }
 
 } // namespace
@@ -68,7 +86,35 @@ int get_num_interop_threads() {
   }
 }
 
+void set_numa_thread_pools(bool enabled) {
+  TORCH_CHECK(!numa_thread_pools_consumed.load(),
+      "Error: cannot change NUMA partitioning of thread pools after "
+      "parallel work has started");
+  numa_thread_pools = enabled;
+}
+
+bool get_numa_thread_pools() {
+  return numa_thread_pools.load();
+}
+
+void set_thread_numa_node(int node) {
+  TORCH_CHECK(node >= 0, "Expected a non-negative NUMA node id");
+  c10::NUMABind(node);
+}
+
+int get_thread_numa_node() {
+  return c10::GetThreadNUMANode();
+}
+
 namespace internal {
+int numa_pool_node() {
+  static const bool enabled = []() {
+    numa_thread_pools_consumed = true;
+    return numa_thread_pools.load() && c10::IsNUMAEnabled();
+  }();
+  return enabled ? c10::GetThreadNUMANode() : -1;
+}
+
 void launch_no_thread_state(std::function<void()> fn) {
 #if AT_EXPERIMENTAL_SINGLE_THREAD_POOL
   intraop_launch(std::move(fn));
@@ -79,14 +125,31 @@ void launch_no_thread_state(std::function<void()> fn) {
 } // namespace internal
 
 void launch(std::function<void()> func) {
-  internal::launch_no_thread_state(std::bind([](
-    std::function<void()> f, ThreadLocalState thread_locals) {
+  auto task = internal::new_launched_interop_task();
+  auto fn = std::bind([](
+    std::function<void()> f,
+    ThreadLocalState thread_locals,
+    std::shared_ptr<internal::InterOpTask> task) {
       ThreadLocalStateGuard guard(std::move(thread_locals));
+      internal::InterOpTaskGuard task_guard(std::move(task));
       f();
     },
     std::move(func),
-    ThreadLocalState()
-  ));
+    ThreadLocalState(),
+    task
+  );
+#if AT_EXPERIMENTAL_SINGLE_THREAD_POOL
+  intraop_launch(std::move(fn));
+#else
+  // See Note [Inter-op task priorities]
+  auto& pool = get_pool();
+  if (auto* priority_pool = dynamic_cast<c10::PriorityThreadPool*>(&pool)) {
+    task->set_queued(
+        priority_pool->runWithPriority(std::move(fn), task->priority()));
+  } else {
+    pool.run(std::move(fn));
+  }
+#endif
 }
 
 } // namespace at
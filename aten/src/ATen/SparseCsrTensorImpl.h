@@ -24,6 +24,14 @@ namespace at {
 //
 // If not calling MKL, it should be alright to use 64 bit integer tensors
 // for indexing.
+//
+// The same struct implements block sparse (BSR) tensors, which store dense
+// blocks of shape `blocksize()` instead of scalars: `values_` then has shape
+// `(nnz(), blocksize[0], blocksize[1])`, and `crow_indices_` and
+// `col_indices_` index rows and columns of blocks, so that `crow_indices_`
+// has shape `(size(0) / blocksize[0] + 1)`. BSR tensors have the dispatch
+// keys of CSR tensors; kernels that do not support blocks check
+// `is_blocked()`.
 struct TORCH_API SparseCsrTensorImpl : public TensorImpl {
   Tensor crow_indices_;
   Tensor col_indices_;
@@ -44,6 +52,12 @@ struct TORCH_API SparseCsrTensorImpl : public TensorImpl {
   const Tensor& values() const { return values_; }
   int nnz() { return values_.size(0); }
 
+  bool is_blocked() const { return values_.dim() == 3; }
+  IntArrayRef blocksize() const {
+    TORCH_INTERNAL_ASSERT(is_blocked());
+    return values_.sizes().slice(1);
+  }
+
  private:
   explicit SparseCsrTensorImpl(
       at::DispatchKeySet key_set,
@@ -1208,6 +1208,14 @@ void TensorIteratorBase::build(TensorIteratorConfig& config) {
   // Check that the outputs have no internal overlap
   // and do not share memory with inputs.
   compute_mem_overlaps(config);
+  // reuse the geometry of a previous build if the caller opted in
+  auto* geometry_cache = TensorIteratorGeometryCacheGuard::current();
+  const bool cacheable =
+      geometry_cache && TensorIteratorGeometryCache::is_cacheable(*this);
+  if (cacheable && geometry_cache->restore(config, *this)) {
+    finish_build();
+    return;
+  }
   // Check that input dimensions are aligned correctly & compute outnames.
   compute_names(config);
   // compute the broadcasted shape
@@ -1230,6 +1238,13 @@ void TensorIteratorBase::build(TensorIteratorConfig& config) {
 
   if (is_meta_) return;
 
+  if (geometry_cache && cacheable) {
+    geometry_cache->store(config, *this);
+  }
+  finish_build();
+}
+
+void TensorIteratorBase::finish_build() {
   for (auto& op : operands_) {
     TORCH_INTERNAL_ASSERT(op.tensor.defined());
     op.data = op.tensor.data_ptr();
@@ -1243,6 +1258,140 @@ void TensorIteratorBase::build(TensorIteratorConfig& config) {
   view_offsets_ = DimVector(ndim_offsets, 0);
 }
 
+namespace {
+thread_local TensorIteratorGeometryCache* current_geometry_cache = nullptr;
+} // namespace
+
+TensorIteratorGeometryCacheGuard::TensorIteratorGeometryCacheGuard(
+    TensorIteratorGeometryCache* cache)
+  : prev_(current_geometry_cache) {
+  current_geometry_cache = cache;
+}
+
+TensorIteratorGeometryCacheGuard::~TensorIteratorGeometryCacheGuard() {
+  current_geometry_cache = prev_;
+}
+
+TensorIteratorGeometryCache* TensorIteratorGeometryCacheGuard::current() {
+  return current_geometry_cache;
+}
+
+bool TensorIteratorGeometryCache::is_cacheable(const TensorIteratorBase& iter) {
+  if (iter.is_meta_) {
+    return false;
+  }
+  for (const auto& op : iter.operands_) {
+    if (!op.tensor.defined() || op.tensor.has_names()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void TensorIteratorGeometryCache::compute_key(
+    const TensorIteratorConfig& config, const TensorIteratorBase& iter, Key& key) {
+  // Everything build() derives the geometry from, apart from the tensors'
+  // data pointers
+  key.push_back(
+      (config.allow_cpu_scalars_ << 0) |
+      (config.is_reduction_ << 1) |
+      (config.resize_outputs_ << 2) |
+      (config.check_all_same_dtype_ << 3) |
+      (config.check_all_same_device_ << 4) |
+      (config.enforce_safe_casting_to_output_ << 5) |
+      (config.promote_inputs_to_common_dtype_ << 6) |
+      (config.promote_integer_inputs_to_float_ << 7) |
+      (config.cast_common_dtype_to_outputs_ << 8));
+  if (config.static_dtype_and_device_.has_value()) {
+    key.push_back(static_cast<int64_t>(config.static_dtype_and_device_->first));
+    key.push_back(static_cast<int64_t>(config.static_dtype_and_device_->second.type()));
+    key.push_back(config.static_dtype_and_device_->second.index());
+  } else {
+    key.push_back(-1);
+  }
+  if (config.static_shape_.has_value()) {
+    key.push_back(config.static_shape_->size());
+    key.append(config.static_shape_->begin(), config.static_shape_->end());
+  } else {
+    key.push_back(-1);
+  }
+  key.push_back(iter.num_outputs_);
+  for (const auto& op : iter.operands_) {
+    // not current_dtype and device, which compute_types may update
+    const auto device = op.tensor.device();
+    key.push_back(static_cast<int64_t>(op.tensor.scalar_type()));
+    key.push_back(static_cast<int64_t>(device.type()));
+    key.push_back(device.index());
+    key.push_back(op.is_read_write);
+    // wrapped numbers take part in type promotion differently
+    key.push_back(op.tensor.unsafeGetTensorImpl()->is_wrapped_number());
+    const auto sizes = op.tensor.sizes();
+    const auto strides = op.tensor.strides();
+    key.push_back(sizes.size());
+    key.append(sizes.begin(), sizes.end());
+    key.append(strides.begin(), strides.end());
+  }
+}
+
+bool TensorIteratorGeometryCache::restore(
+    const TensorIteratorConfig& config, TensorIteratorBase& iter) {
+  if (!valid_) {
+    return false;
+  }
+  Key key;
+  compute_key(config, iter, key);
+  if (key.size() != key_.size() || !std::equal(key.begin(), key.end(), key_.begin())) {
+    return false;
+  }
+  iter.shape_ = shape_;
+  iter.perm_ = perm_;
+  iter.has_coalesced_dimensions_ = has_coalesced_dimensions_;
+  iter.all_ops_same_shape_ = all_ops_same_shape_;
+  iter.common_dtype_ = common_dtype_;
+  for (size_t i = 0; i < iter.operands_.size(); i++) {
+    auto& op = iter.operands_[i];
+    op.stride_bytes = stride_bytes_[i];
+    op.target_dtype = target_dtypes_[i];
+    op.device = devices_[i];
+  }
+  // as in allocate_or_resize_outputs, set_output is told about preallocated
+  // outputs so that subclasses can set up guards
+  for (int i = 0; i < iter.num_outputs_; i++) {
+    auto& op = iter.operands_[i];
+    iter.set_output(i, op.tensor.sizes(), {}, original_options(op), iter.names_);
+  }
+  hits_++;
+  return true;
+}
+
+void TensorIteratorGeometryCache::store(
+    const TensorIteratorConfig& config, const TensorIteratorBase& iter) {
+  valid_ = false;
+  for (const auto& op : iter.operands_) {
+    // the operand was replaced by a resized or converted tensor, so the key
+    // computed now would not describe what future builds start from
+    if (op.will_resize || op.original_tensor.defined()) {
+      return;
+    }
+  }
+  key_.clear();
+  compute_key(config, iter, key_);
+  shape_ = iter.shape_;
+  perm_ = iter.perm_;
+  has_coalesced_dimensions_ = iter.has_coalesced_dimensions_;
+  all_ops_same_shape_ = iter.all_ops_same_shape_;
+  common_dtype_ = iter.common_dtype_;
+  stride_bytes_.clear();
+  target_dtypes_.clear();
+  devices_.clear();
+  for (const auto& op : iter.operands_) {
+    stride_bytes_.push_back(op.stride_bytes);
+    target_dtypes_.push_back(op.target_dtype);
+    devices_.push_back(op.device);
+  }
+  valid_ = true;
+}
+
 // This is the structured kernels implementation of set_output.  It is
 // NEVER actually called directly; instead, a subclass of TensorIteratorBase
 // will override set_output to actually do the operation, and then call
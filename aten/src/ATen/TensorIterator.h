@@ -139,6 +139,7 @@ enum class FastSetupType : uint8_t {
 };
 
 class TensorIteratorConfig;
+class TensorIteratorGeometryCache;
 struct TensorIterator;
 
 struct TORCH_API TensorIteratorBase : public impl::MetaBase {
@@ -337,6 +338,8 @@ public:
   void build_unary_op(const Tensor& out, const Tensor& a);
 
 protected:
+  friend class TensorIteratorGeometryCache;
+
   // Mutable reference as it moves tensors out of TensorIteratorConfig
   void populate_operands(TensorIteratorConfig&);
   void mark_outputs();
@@ -354,6 +357,8 @@ protected:
   void compute_names(const TensorIteratorConfig&);
   void propagate_names_to_outputs();
   void coalesce_dimensions();
+  // Sets operand data pointers and view offsets once the geometry is final
+  void finish_build();
 
 protected:
 
@@ -465,6 +470,7 @@ class TORCH_API TensorIteratorConfig final {
 public:
   friend struct TensorIteratorBase;
   friend struct TensorIterator;
+  friend class TensorIteratorGeometryCache;
 
   TensorIteratorConfig() {}
 
@@ -603,6 +609,75 @@ private:
 };
 
 
+/// Memoizes the geometry that TensorIteratorBase::build() computes: the
+/// broadcast shape, dimension order, coalesced strides and operand dtypes.
+/// One entry is kept, for the last build() that stored into the cache, keyed
+/// on the configuration and on every operand's sizes, strides, dtype and
+/// device. When the next build() matches the key, it skips compute_shape,
+/// compute_types, compute_strides, reorder_dimensions and
+/// coalesce_dimensions. Memory overlap checks still run.
+///
+/// Opt-in: build() only uses a cache installed on the current thread with
+/// TensorIteratorGeometryCacheGuard. build() calls are only cached when
+/// all outputs are preallocated with the right size, no operand has names,
+/// and no dtype conversion copy is needed. This is the steady state of
+/// out= variants in the static runtime.
+///
+/// A cache must not be used from several threads at once. Copies start out
+/// empty.
+class TORCH_API TensorIteratorGeometryCache final {
+public:
+  TensorIteratorGeometryCache() = default;
+  TensorIteratorGeometryCache(const TensorIteratorGeometryCache&) {}
+  TensorIteratorGeometryCache& operator=(const TensorIteratorGeometryCache&) {
+    clear();
+    return *this;
+  }
+
+  void clear() { valid_ = false; }
+
+  /// Number of build() calls that reused the cached geometry
+  int64_t hits() const { return hits_; }
+
+private:
+  friend struct TensorIteratorBase;
+
+  using Key = SmallVector<int64_t, 32>;
+
+  static bool is_cacheable(const TensorIteratorBase& iter);
+  static void compute_key(
+      const TensorIteratorConfig& config, const TensorIteratorBase& iter, Key& key);
+
+  // Applies the cached geometry to `iter`, whose operands have been
+  // populated. Returns false on a miss.
+  bool restore(const TensorIteratorConfig& config, TensorIteratorBase& iter);
+  void store(const TensorIteratorConfig& config, const TensorIteratorBase& iter);
+
+  bool valid_ = false;
+  int64_t hits_ = 0;
+  Key key_;
+
+  DimVector shape_;
+  DimVector perm_;
+  bool has_coalesced_dimensions_ = false;
+  bool all_ops_same_shape_ = false;
+  ScalarType common_dtype_ = ScalarType::Undefined;
+  SmallVector<OperandInfo::StrideVector, 4> stride_bytes_;
+  SmallVector<ScalarType, 4> target_dtypes_;
+  SmallVector<Device, 4> devices_;
+};
+
+/// Installs `cache` as the geometry cache used by TensorIterator builds on
+/// the current thread for the lifetime of the guard.
+struct TORCH_API TensorIteratorGeometryCacheGuard {
+  explicit TensorIteratorGeometryCacheGuard(TensorIteratorGeometryCache* cache);
+  ~TensorIteratorGeometryCacheGuard();
+
+  static TensorIteratorGeometryCache* current();
+
+private:
+  TensorIteratorGeometryCache* prev_;
+};
 
 /// A container-like struct that acts as if it contains splits of a
 /// TensorIterator that can use 32-bit indexing. Taken together the splits cover
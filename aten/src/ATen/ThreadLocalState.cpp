@@ -11,7 +11,8 @@ namespace at {
 ThreadLocalState::ThreadLocalState(bool keep_grad_mode)
     : dispatch_key_(c10::impl::tls_local_dispatch_key_set()),
       debug_info_(c10::ThreadLocalDebugInfo::current()),
-      inference_mode_enabled_(c10::InferenceMode::is_enabled()) {
+      inference_mode_enabled_(c10::InferenceMode::is_enabled()),
+      interop_priority_(internal::get_interop_priority_state()) {
   rf_tls_ = at::get_record_function_tls_();
 
 #if !defined(CAFFE2_IS_XPLAT_BUILD) && !defined(C10_MOBILE)
@@ -39,6 +40,8 @@ void ThreadLocalState::setThreadLocalState(
   c10::impl::_force_tls_local_dispatch_key_set(state.dispatch_key_);
 
   c10::InferenceMode::set_enabled(state.inference_mode_enabled_);
+
+  internal::set_interop_priority_state(state.interop_priority_);
 }
 
 } // namespace at
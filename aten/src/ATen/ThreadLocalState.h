@@ -5,6 +5,7 @@
 #include <c10/util/Exception.h>
 #include <c10/util/ThreadLocalDebugInfo.h>
 
+#include <ATen/InterOpPriority.h>
 #include <ATen/record_function.h>
 
 namespace at {
@@ -42,6 +43,9 @@ class TORCH_API ThreadLocalState {
   // TLS for InferenceMode
   bool inference_mode_enabled_;
 
+  // Priority of inter-op tasks, see Note [Inter-op task priorities]
+  internal::InterOpPriorityState interop_priority_;
+
   // Whether pre-sampling RecordFunction optimization was enabled
   bool bumped_record_all_functions_ = false;
 
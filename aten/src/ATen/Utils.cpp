@@ -3,6 +3,8 @@
 #include <ATen/Dispatch.h>
 #include <ATen/Functions.h>
 #include <ATen/Utils.h>
+#include <ATen/core/Vitals.h>
+#include <c10/core/CPUAllocator.h>
 #include <c10/util/accumulate.h>
 
 
@@ -47,6 +49,20 @@ Tensor empty_cpu(
   return empty_generic(size, allocator, at::DispatchKey::CPU, dtype, device, memory_format_opt);
 }
 
+// See Note [Inline storage for tiny tensors]. Only the plain default CPU
+// allocator is bypassed; custom allocators and memory profiling (which would
+// miss these allocations) keep seeing every allocation.
+static bool use_inline_storage(c10::Allocator* allocator, int64_t size_bytes) {
+#ifdef C10_MOBILE
+  return false;
+#else
+  return size_bytes > 0 &&
+      static_cast<size_t>(size_bytes) <= c10::StorageImpl::kInlineBytes &&
+      allocator == c10::GetDefaultCPUAllocator() &&
+      !c10::memoryProfilingEnabled();
+#endif
+}
+
 Tensor empty_generic(
   IntArrayRef size,
   c10::Allocator* allocator,
@@ -63,12 +79,22 @@ Tensor empty_generic(
   int64_t nelements = c10::multiply_integers(size);
   caffe2::TypeMeta dtype = scalarTypeToTypeMeta(scalar_type);
   int64_t size_bytes = nelements * dtype.itemsize();
-  auto storage_impl = c10::make_intrusive<StorageImpl>(
-      c10::StorageImpl::use_byte_size_t(),
-      size_bytes,
-      allocator->allocate(size_bytes),
-      allocator,
-      /*resizeable=*/true);
+  if (dispatch_key == c10::DispatchKey::CPU) {
+    TORCH_VITAL_COUNT("allocator.cpu.allocations", 1);
+    TORCH_VITAL_RECORD("allocator.cpu.bytes", size_bytes);
+  }
+  c10::intrusive_ptr<StorageImpl> storage_impl;
+  if (use_inline_storage(allocator, size_bytes)) {
+    storage_impl = c10::make_intrusive<StorageImpl>(
+        c10::StorageImpl::use_inline_data_t(), size_bytes, allocator);
+  } else {
+    storage_impl = c10::make_intrusive<StorageImpl>(
+        c10::StorageImpl::use_byte_size_t(),
+        size_bytes,
+        allocator->allocate(size_bytes),
+        allocator,
+        /*resizeable=*/true);
+  }
 
   auto tensor = detail::make_tensor<TensorImpl>(
       std::move(storage_impl), dispatch_key, dtype);
@@ -1,5 +1,10 @@
 #include <ATen/core/Vitals.h>
+#include <c10/util/llvmMathExtras.h>
+
 #include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
 
 namespace at {
 namespace vitals {
@@ -30,5 +35,124 @@ bool torchVitalEnabled() {
   return enabled;
 }
 
+namespace {
+
+std::atomic<bool>& vitalCountersEnabledFlag() {
+  static std::atomic<bool> enabled([]() {
+    auto e = getenv("TORCH_VITAL_COUNTERS");
+    return e != nullptr && strlen(e) > 0 && strcmp(e, "0") != 0;
+  }());
+  return enabled;
+}
+
+// Counters and histograms are intentionally leaked so that call sites can
+// keep references to them in statics that outlive static destruction.
+struct VitalRegistry {
+  std::mutex mutex;
+  std::map<std::string, std::unique_ptr<VitalCounter>> counters;
+  std::map<std::string, std::unique_ptr<VitalHistogram>> histograms;
+};
+
+VitalRegistry& vitalRegistry() {
+  static auto* registry = new VitalRegistry();
+  return *registry;
+}
+
+} // namespace
+
+bool vitalCountersEnabled() {
+  return vitalCountersEnabledFlag().load(std::memory_order_relaxed);
+}
+
+void setVitalCountersEnabled(bool enabled) {
+  vitalCountersEnabledFlag().store(enabled, std::memory_order_relaxed);
+}
+
+size_t VitalHistogram::bucketFor(int64_t value) {
+  if (value <= 0) {
+    return 0;
+  }
+  return 64 - llvm::countLeadingZeros(static_cast<uint64_t>(value));
+}
+
+void VitalHistogram::record(int64_t value) {
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+  buckets_[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+}
+
+VitalHistogram::Snapshot VitalHistogram::snapshot() const {
+  Snapshot result;
+  result.count = count_.load(std::memory_order_relaxed);
+  result.sum = sum_.load(std::memory_order_relaxed);
+  result.buckets.reserve(kNumBuckets);
+  for (const auto& bucket : buckets_) {
+    result.buckets.push_back(bucket.load(std::memory_order_relaxed));
+  }
+  return result;
+}
+
+void VitalHistogram::reset() {
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+VitalCounter& vitalCounter(const std::string& name) {
+  auto& registry = vitalRegistry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  auto& slot = registry.counters[name];
+  if (!slot) {
+    slot = std::make_unique<VitalCounter>(name);
+  }
+  return *slot;
+}
+
+VitalHistogram& vitalHistogram(const std::string& name) {
+  auto& registry = vitalRegistry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  auto& slot = registry.histograms[name];
+  if (!slot) {
+    slot = std::make_unique<VitalHistogram>(name);
+  }
+  return *slot;
+}
+
+std::vector<std::pair<std::string, int64_t>> vitalCounterValues() {
+  auto& registry = vitalRegistry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  std::vector<std::pair<std::string, int64_t>> result;
+  result.reserve(registry.counters.size());
+  for (const auto& entry : registry.counters) {
+    result.emplace_back(entry.first, entry.second->value());
+  }
+  return result;
+}
+
+std::vector<std::pair<std::string, VitalHistogram::Snapshot>>
+vitalHistogramValues() {
+  auto& registry = vitalRegistry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  std::vector<std::pair<std::string, VitalHistogram::Snapshot>> result;
+  result.reserve(registry.histograms.size());
+  for (const auto& entry : registry.histograms) {
+    result.emplace_back(entry.first, entry.second->snapshot());
+  }
+  return result;
+}
+
+void resetVitalCounters() {
+  auto& registry = vitalRegistry();
+  std::lock_guard<std::mutex> guard(registry.mutex);
+  for (auto& entry : registry.counters) {
+    entry.second->reset();
+  }
+  for (auto& entry : registry.histograms) {
+    entry.second->reset();
+  }
+}
+
 } // namespace at
 } // namespace vitals
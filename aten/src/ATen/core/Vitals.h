@@ -1,8 +1,17 @@
 #pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <sstream>
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <c10/macros/Export.h>
+#include <c10/macros/Macros.h>
 
 namespace at {
 namespace vitals {
@@ -40,6 +49,90 @@ struct TorchVital {
   }
 };
 
+// Note [Vital counters]
+// ~~~~~~~~~~~~~~~~~~~~~
+// TorchVital attributes above are strings that are printed once at exit.
+// Runtime counters and histograms are the live, queryable counterpart: hot
+// paths (allocations, JIT recompilations, guard failures, fusion cache misses,
+// collective sizes, ...) bump a named VitalCounter or record into a named
+// VitalHistogram, and tools read a snapshot of all of them at any time
+// (torch._C._vital_counters() / torch._C._vital_histograms() from Python).
+//
+// Counters are off by default. They are enabled by setting the
+// TORCH_VITAL_COUNTERS environment variable to a non-empty value other than
+// "0", or with setVitalCountersEnabled(). When disabled, a call site costs one
+// relaxed atomic load; when enabled, a relaxed fetch_add per update.
+//
+// Counters and histograms live in a process-wide registry keyed by name and
+// are never destroyed, so references returned by vitalCounter() and
+// vitalHistogram() stay valid; call sites cache them in a function-local
+// static (see TORCH_VITAL_COUNT / TORCH_VITAL_RECORD).
+
+TORCH_API bool vitalCountersEnabled();
+TORCH_API void setVitalCountersEnabled(bool enabled);
+
+struct TORCH_API VitalCounter {
+  explicit VitalCounter(std::string n) : name(std::move(n)) {}
+  VitalCounter(const VitalCounter&) = delete;
+  VitalCounter& operator=(const VitalCounter&) = delete;
+
+  void add(int64_t n = 1) {
+    value_.fetch_add(n, std::memory_order_relaxed);
+  }
+  int64_t value() const {
+    return value_.load(std::memory_order_relaxed);
+  }
+  void reset() {
+    value_.store(0, std::memory_order_relaxed);
+  }
+
+  const std::string name;
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+// Histogram with power-of-two buckets: bucket 0 counts values <= 0 and
+// bucket i > 0 counts values in [2^(i-1), 2^i).
+struct TORCH_API VitalHistogram {
+  static constexpr size_t kNumBuckets = 64;
+
+  struct Snapshot {
+    int64_t count = 0;
+    int64_t sum = 0;
+    std::vector<int64_t> buckets;
+  };
+
+  explicit VitalHistogram(std::string n) : name(std::move(n)) {}
+  VitalHistogram(const VitalHistogram&) = delete;
+  VitalHistogram& operator=(const VitalHistogram&) = delete;
+
+  static size_t bucketFor(int64_t value);
+  void record(int64_t value);
+  Snapshot snapshot() const;
+  void reset();
+
+  const std::string name;
+
+ private:
+  std::atomic<int64_t> count_{0};
+  std::atomic<int64_t> sum_{0};
+  std::array<std::atomic<int64_t>, kNumBuckets> buckets_{};
+};
+
+// Returns the counter / histogram registered under `name`, creating it on
+// first use.
+TORCH_API VitalCounter& vitalCounter(const std::string& name);
+TORCH_API VitalHistogram& vitalHistogram(const std::string& name);
+
+// Snapshots of every registered counter / histogram, sorted by name.
+TORCH_API std::vector<std::pair<std::string, int64_t>> vitalCounterValues();
+TORCH_API std::vector<std::pair<std::string, VitalHistogram::Snapshot>>
+vitalHistogramValues();
+
+// Zeroes every registered counter and histogram.
+TORCH_API void resetVitalCounters();
+
 } // namespace at
 } // namespace vitals
 
@@ -48,3 +141,23 @@ struct TorchVital {
 #define TORCH_VITAL_DEFINE(name) TorchVital TorchVital_##name(#name);
 
 #define TORCH_VITAL(name, attr) TorchVital_##name.create(#attr)
+
+// Bumps the counter `name` (a string literal) by `n` when counters are enabled.
+#define TORCH_VITAL_COUNT(name, n)                                     \
+  do {                                                                 \
+    if (C10_UNLIKELY(::at::vitals::vitalCountersEnabled())) {          \
+      static ::at::vitals::VitalCounter& torch_vital_counter_ =        \
+          ::at::vitals::vitalCounter(name);                            \
+      torch_vital_counter_.add(n);                                     \
+    }                                                                  \
+  } while (0)
+
+// Records `value` into the histogram `name` when counters are enabled.
+#define TORCH_VITAL_RECORD(name, value)                                \
+  do {                                                                 \
+    if (C10_UNLIKELY(::at::vitals::vitalCountersEnabled())) {          \
+      static ::at::vitals::VitalHistogram& torch_vital_histogram_ =    \
+          ::at::vitals::vitalHistogram(name);                          \
+      torch_vital_histogram_.record(value);                            \
+    }                                                                  \
+  } while (0)
@@ -3,6 +3,7 @@
 #include <ATen/core/ivalue.h>
 #include <ATen/core/stack.h>
 #include <c10/util/Metaprogramming.h>
+#include <c10/util/SmallVector.h>
 
 namespace c10 {
 
@@ -351,10 +352,22 @@ namespace impl {
 
   template<class T, bool AllowDeprecatedTypes>
   struct ivalue_to_arg<ArrayRef<T>, AllowDeprecatedTypes> final {
-    // If an argument is ArrayRef<T>, convert the IValue to a std::vector<T> and pass that
-    // to the operator. std::vector<T> is implicitly convertible to ArrayRef<T>.
-    static std::vector<T> call(IValue& v) {
-      return ivalue_to_arg<std::vector<T>, AllowDeprecatedTypes>::call(v);
+    // If an argument is ArrayRef<T>, copy the elements of the list IValue into a
+    // SmallVector<T> and pass that to the operator. SmallVector<T> is implicitly
+    // convertible to ArrayRef<T>. The elements are read in place, without going
+    // through a List<T>, and the inline capacity covers the sizes, strides and
+    // tensor lists operators usually take, so that the conversion does not
+    // allocate on every call of the operator.
+    static constexpr size_t kInlineSize = 8;
+    static c10::SmallVector<T, kInlineSize> call(IValue& v) {
+      assert_is_valid_input_type<ArrayRef<T>, AllowDeprecatedTypes>();
+      const auto elements = v.toListRef();
+      c10::SmallVector<T, kInlineSize> result;
+      result.reserve(elements.size());
+      for (const IValue& element : elements) {
+        result.push_back(element.to<T>());
+      }
+      return result;
     }
   };
   template<class T, bool AllowDeprecatedTypes>
@@ -449,6 +449,62 @@ TEST(OperatorRegistrationTest_FunctorBasedKernel, givenKernelWithTensorListInput
   EXPECT_EQ(2, outputs[0].toInt());
 }
 
+struct KernelWithIntArrayRefInputWithOutput final : OperatorKernel {
+  int64_t operator()(Tensor, c10::IntArrayRef input1) {
+    int64_t sum = 0;
+    for (int64_t value : input1) {
+      sum += value;
+    }
+    return sum;
+  }
+};
+
+TEST(OperatorRegistrationTest_FunctorBasedKernel, givenKernelWithIntArrayRefInput_withOutput_whenRegistered_thenCanBeCalled) {
+  auto registrar = RegisterOperators()
+      .op("_test::int_array_ref_input(Tensor dummy, int[] input) -> int", RegisterOperators::options().kernel<KernelWithIntArrayRefInputWithOutput>(DispatchKey::CPU));
+
+  auto op = c10::Dispatcher::singleton().findSchema({"_test::int_array_ref_input", ""});
+  ASSERT_TRUE(op.has_value());
+
+  auto outputs = callOp(*op, dummyTensor(DispatchKey::CPU), c10::List<int64_t>({2, 4, 6}));
+  EXPECT_EQ(1, outputs.size());
+  EXPECT_EQ(12, outputs[0].toInt());
+
+  // more elements than fit in the inline storage of the argument
+  outputs = callOp(*op, dummyTensor(DispatchKey::CPU), c10::List<int64_t>({1, 2, 3, 4, 5, 6, 7, 8, 9, 10}));
+  EXPECT_EQ(1, outputs.size());
+  EXPECT_EQ(55, outputs[0].toInt());
+}
+
+struct KernelWithTensorArrayRefInputWithOutput final : OperatorKernel {
+  int64_t operator()(c10::ArrayRef<Tensor> input1) {
+    for (const Tensor& tensor : input1) {
+      EXPECT_TRUE(tensor.defined());
+    }
+    return input1.size();
+  }
+};
+
+TEST(OperatorRegistrationTest_FunctorBasedKernel, givenKernelWithTensorArrayRefInput_withOutput_whenRegistered_thenCanBeCalled) {
+  auto registrar = RegisterOperators()
+      .op("_test::tensor_array_ref_input(Tensor[] input) -> int", RegisterOperators::options().kernel<KernelWithTensorArrayRefInputWithOutput>(DispatchKey::CPU));
+
+  auto op = c10::Dispatcher::singleton().findSchema({"_test::tensor_array_ref_input", ""});
+  ASSERT_TRUE(op.has_value());
+
+  auto outputs = callOp(*op, c10::List<Tensor>({dummyTensor(DispatchKey::CPU), dummyTensor(DispatchKey::CPU)}));
+  EXPECT_EQ(1, outputs.size());
+  EXPECT_EQ(2, outputs[0].toInt());
+
+  c10::List<Tensor> long_list;
+  for (int i = 0; i < 10; ++i) {
+    long_list.push_back(dummyTensor(DispatchKey::CPU));
+  }
+  outputs = callOp(*op, long_list);
+  EXPECT_EQ(1, outputs.size());
+  EXPECT_EQ(10, outputs[0].toInt());
+}
+
 int captured_dict_size = 0;
 
 struct KernelWithDictInputWithoutOutput final : OperatorKernel {
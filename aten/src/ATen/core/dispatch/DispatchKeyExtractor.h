@@ -60,12 +60,14 @@ namespace detail {
         ts = ts | x.key_set();
       }
     }
-    void operator()(at::Generator gen) {
+    // NB: take generators by const reference, copying one bumps its
+    // (atomic) refcount on every call of a random operator.
+    void operator()(const at::Generator& gen) {
       if (gen.defined()) {
         ts = ts | gen.key_set();
       }
     }
-    void operator()(c10::optional<at::Generator> gen) {
+    void operator()(const c10::optional<at::Generator>& gen) {
       if (gen.has_value() && gen->defined()) {
         ts = ts | gen->key_set();
       }
@@ -124,8 +126,10 @@ public:
         // no safe toTensorRef method, alas)
         ks = ks | ivalue.unsafeToTensorImpl()->key_set();
       } else if (C10_UNLIKELY(ivalue.isTensorList())) {
-        for (const at::Tensor tensor : ivalue.toTensorList()) {
-          ks = ks | tensor.key_set();
+        // Same as above: read the elements in place rather than copying each
+        // into a Tensor.
+        for (const auto& element : ivalue.toListRef()) {
+          ks = ks | element.unsafeToTensorImpl()->key_set();
         }
       }
     });
@@ -33,6 +33,7 @@ namespace c10 {
   _(prim, ChunkSizes)                \
   _(prim, ConstantMKLDNNTensor)      \
   _(prim, BroadcastMKLDNNTensors)    \
+  _(prim, MKLDNNConcat)              \
   _(prim, MKLDNNGroup)               \
   _(prim, Drop)                      \
   _(prim, Eval)                      \
@@ -44,6 +45,7 @@ namespace c10 {
   _(prim, DifferentiableGraph)       \
   _(prim, TensorExprGroup)           \
   _(prim, StaticSubgraph)            \
+  _(prim, StaticTensorExprGroup)     \
   _(prim, If)                        \
   _(prim, Jump) /* debug */          \
   _(prim, JumpNZ) /* debug */        \
@@ -118,6 +120,7 @@ namespace c10 {
   _(prim, ConstantChunk)             \
   _(prim, MMTreeReduce)              \
   _(prim, MMBatchSide)               \
+  _(prim, MMBatchLinear)             \
   _(prim, list)                      \
   _(prim, dict)                      \
   _(prim, min)                       \
@@ -0,0 +1,192 @@
+#pragma once
+
+// DO NOT DEFINE STATIC DATA IN THIS HEADER!
+// See Note [Do not compile initializers with AVX]
+
+#include <ATen/cpu/vec256/functional.h>
+
+namespace at { namespace vec256 {
+
+// Note [BFloat16 functional overloads]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// The overloads below take BFloat16 data but hand Vec256<float> operands to
+// the user functions: each block of Vec256<BFloat16>::size() inputs is widened
+// to two float vectors once, all arithmetic and accumulation happens in float,
+// and results are rounded back to BFloat16 only when stored. Compared to the
+// generic versions instantiated with Vec256<BFloat16>, which round after every
+// operation, this is both faster and more accurate.
+//
+// Overload resolution picks these when called without explicit template
+// arguments, e.g. `vec256::reduce_all([](Vec& x, Vec& y) {...}, bf16_ptr, n)`
+// with `Vec = Vec256<float>`.
+
+template <typename Op>
+inline float reduce_all(const Op& vec_fun, const BFloat16* data, int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  if (size < bVec::size()) {
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(data, size));
+    if (size > fVec::size()) {
+      data_fvec0 = fVec::set(data_fvec0, vec_fun(data_fvec0, data_fvec1), size - fVec::size());
+      return vec_reduce_all<float>(vec_fun, data_fvec0, fVec::size());
+    }
+    return vec_reduce_all<float>(vec_fun, data_fvec0, size);
+  }
+  int64_t d = bVec::size();
+  fVec acc_fvec0, acc_fvec1;
+  load_fp32_from_bf16(data, acc_fvec0, acc_fvec1);
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec data_fvec0, data_fvec1;
+    load_fp32_from_bf16(data + d, data_fvec0, data_fvec1);
+    acc_fvec0 = vec_fun(acc_fvec0, data_fvec0);
+    acc_fvec1 = vec_fun(acc_fvec1, data_fvec1);
+  }
+  if (size - d > 0) {
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(data + d, size - d));
+    if (size - d > fVec::size()) {
+      acc_fvec0 = vec_fun(acc_fvec0, data_fvec0);
+      acc_fvec1 = fVec::set(acc_fvec1, vec_fun(acc_fvec1, data_fvec1), size - d - fVec::size());
+    } else {
+      acc_fvec0 = fVec::set(acc_fvec0, vec_fun(acc_fvec0, data_fvec0), size - d);
+    }
+  }
+  acc_fvec0 = vec_fun(acc_fvec0, acc_fvec1);
+  return vec_reduce_all<float>(vec_fun, acc_fvec0, fVec::size());
+}
+
+template <typename MapOp, typename ReduceOp>
+inline float map_reduce_all(
+    const MapOp& map_fun,
+    const ReduceOp& red_fun,
+    BFloat16* data,
+    int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  if (size < bVec::size()) {
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(data, size));
+    if (size > fVec::size()) {
+      data_fvec0 = map_fun(data_fvec0);
+      data_fvec1 = map_fun(data_fvec1);
+      data_fvec0 = fVec::set(data_fvec0, red_fun(data_fvec0, data_fvec1), size - fVec::size());
+      return vec_reduce_all<float>(red_fun, data_fvec0, fVec::size());
+    }
+    data_fvec0 = map_fun(data_fvec0);
+    return vec_reduce_all<float>(red_fun, data_fvec0, size);
+  }
+  int64_t d = bVec::size();
+  fVec acc_fvec0, acc_fvec1;
+  load_fp32_from_bf16(data, acc_fvec0, acc_fvec1);
+  acc_fvec0 = map_fun(acc_fvec0);
+  acc_fvec1 = map_fun(acc_fvec1);
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec data_fvec0, data_fvec1;
+    load_fp32_from_bf16(data + d, data_fvec0, data_fvec1);
+    data_fvec0 = map_fun(data_fvec0);
+    data_fvec1 = map_fun(data_fvec1);
+    acc_fvec0 = red_fun(acc_fvec0, data_fvec0);
+    acc_fvec1 = red_fun(acc_fvec1, data_fvec1);
+  }
+  if (size - d > 0) {
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(data + d, size - d));
+    data_fvec0 = map_fun(data_fvec0);
+    data_fvec1 = map_fun(data_fvec1);
+    if (size - d > fVec::size()) {
+      acc_fvec0 = red_fun(acc_fvec0, data_fvec0);
+      acc_fvec1 = fVec::set(acc_fvec1, red_fun(acc_fvec1, data_fvec1), size - d - fVec::size());
+    } else {
+      acc_fvec0 = fVec::set(acc_fvec0, red_fun(acc_fvec0, data_fvec0), size - d);
+    }
+  }
+  acc_fvec0 = red_fun(acc_fvec0, acc_fvec1);
+  return vec_reduce_all<float>(red_fun, acc_fvec0, fVec::size());
+}
+
+template <typename Op>
+inline void map(
+    const Op& vec_fun,
+    BFloat16* output_data,
+    const BFloat16* input_data,
+    int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec data_fvec0, data_fvec1;
+    load_fp32_from_bf16(input_data + d, data_fvec0, data_fvec1);
+    bVec output_bvec = convert_float_bfloat16(vec_fun(data_fvec0), vec_fun(data_fvec1));
+    output_bvec.store(output_data + d);
+  }
+  if (size - d > 0) {
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(input_data + d, size - d));
+    bVec output_bvec = convert_float_bfloat16(vec_fun(data_fvec0), vec_fun(data_fvec1));
+    output_bvec.store(output_data + d, size - d);
+  }
+}
+
+template <typename Op>
+inline void map2(
+    const Op& vec_fun,
+    BFloat16* output_data,
+    const BFloat16* input_data,
+    const BFloat16* input_data2,
+    int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec data_fvec0, data_fvec1, data2_fvec0, data2_fvec1;
+    load_fp32_from_bf16(input_data + d, data_fvec0, data_fvec1);
+    load_fp32_from_bf16(input_data2 + d, data2_fvec0, data2_fvec1);
+    bVec output_bvec = convert_float_bfloat16(
+        vec_fun(data_fvec0, data2_fvec0), vec_fun(data_fvec1, data2_fvec1));
+    output_bvec.store(output_data + d);
+  }
+  if (size - d > 0) {
+    fVec data_fvec0, data_fvec1, data2_fvec0, data2_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(input_data + d, size - d));
+    std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(bVec::loadu(input_data2 + d, size - d));
+    bVec output_bvec = convert_float_bfloat16(
+        vec_fun(data_fvec0, data2_fvec0), vec_fun(data_fvec1, data2_fvec1));
+    output_bvec.store(output_data + d, size - d);
+  }
+}
+
+template <typename Op>
+inline void map3(
+    const Op& vec_fun,
+    BFloat16* output_data,
+    const BFloat16* input_data1,
+    const BFloat16* input_data2,
+    const BFloat16* input_data3,
+    int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec data1_fvec0, data1_fvec1, data2_fvec0, data2_fvec1, data3_fvec0, data3_fvec1;
+    load_fp32_from_bf16(input_data1 + d, data1_fvec0, data1_fvec1);
+    load_fp32_from_bf16(input_data2 + d, data2_fvec0, data2_fvec1);
+    load_fp32_from_bf16(input_data3 + d, data3_fvec0, data3_fvec1);
+    bVec output_bvec = convert_float_bfloat16(
+        vec_fun(data1_fvec0, data2_fvec0, data3_fvec0),
+        vec_fun(data1_fvec1, data2_fvec1, data3_fvec1));
+    output_bvec.store(output_data + d);
+  }
+  if (size - d > 0) {
+    fVec data1_fvec0, data1_fvec1, data2_fvec0, data2_fvec1, data3_fvec0, data3_fvec1;
+    std::tie(data1_fvec0, data1_fvec1) = convert_bfloat16_float(bVec::loadu(input_data1 + d, size - d));
+    std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(bVec::loadu(input_data2 + d, size - d));
+    std::tie(data3_fvec0, data3_fvec1) = convert_bfloat16_float(bVec::loadu(input_data3 + d, size - d));
+    bVec output_bvec = convert_float_bfloat16(
+        vec_fun(data1_fvec0, data2_fvec0, data3_fvec0),
+        vec_fun(data1_fvec1, data2_fvec1, data3_fvec1));
+    output_bvec.store(output_data + d, size - d);
+  }
+}
+
+}} // namespace at::vec256
@@ -5,6 +5,8 @@
 
 #include <ATen/cpu/vec256/intrinsics.h>
 #include <ATen/cpu/vec256/vec256_base.h>
+
+#include <tuple>
 #if defined(CPU_CAPABILITY_AVX2) && !defined(_MSC_VER)
 #include <sleef.h>
 #endif
@@ -677,6 +679,68 @@ Vec256<BFloat16> inline fmadd(const Vec256<BFloat16>& a,
   return cvtfp32_bf16(o1, o2);
 }
 
+inline std::tuple<Vec256<float>, Vec256<float>> convert_bfloat16_float(const Vec256<BFloat16>& a) {
+  __m256 o1, o2;
+  cvtbf16_fp32(__m256i(a), o1, o2);
+  return std::make_tuple(o1, o2);
+}
+
+inline Vec256<BFloat16> convert_float_bfloat16(const Vec256<float>& a, const Vec256<float>& b) {
+  return cvtfp32_bf16(__m256(a), __m256(b));
+}
+
+// Loads Vec256<float>::size() BFloat16 values, widening them to float.
+inline void load_fp32_from_bf16(const c10::BFloat16* data, Vec256<float>& out) {
+  auto values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  out = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(values), 16));
+}
+
+// Loads Vec256<BFloat16>::size() BFloat16 values, widening them to float.
+inline void load_fp32_from_bf16(const c10::BFloat16* data, Vec256<float>& out1, Vec256<float>& out2) {
+  auto values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+  __m256 o1, o2;
+  cvtbf16_fp32(values, o1, o2);
+  out1 = o1;
+  out2 = o2;
+}
+
+#else // defined(CPU_CAPABILITY_AVX2) && !defined(_MSC_VER)
+
+inline std::tuple<Vec256<float>, Vec256<float>> convert_bfloat16_float(const Vec256<BFloat16>& a) {
+  constexpr int64_t K = Vec256<BFloat16>::size();
+  __at_align32__ float arr[K];
+  __at_align32__ BFloat16 arr2[K];
+  a.store(arr2);
+  convert(arr2, arr, K);
+  return std::make_tuple(
+      Vec256<float>::loadu(arr),
+      Vec256<float>::loadu(arr + Vec256<float>::size()));
+}
+
+inline Vec256<BFloat16> convert_float_bfloat16(const Vec256<float>& a, const Vec256<float>& b) {
+  constexpr int64_t K = Vec256<BFloat16>::size();
+  __at_align32__ float arr[K];
+  __at_align32__ BFloat16 arr2[K];
+  a.store(arr);
+  b.store(arr + Vec256<float>::size());
+  convert(arr, arr2, K);
+  return Vec256<BFloat16>::loadu(arr2);
+}
+
+inline void load_fp32_from_bf16(const c10::BFloat16* data, Vec256<float>& out) {
+  __at_align32__ float values[Vec256<float>::size()];
+  for (int64_t k = 0; k < Vec256<float>::size(); ++k) {
+    values[k] = data[k];
+  }
+  out = Vec256<float>::loadu(values);
+}
+
+inline void load_fp32_from_bf16(const c10::BFloat16* data, Vec256<float>& out1, Vec256<float>& out2) {
+  load_fp32_from_bf16(data, out1);
+  data += Vec256<float>::size();
+  load_fp32_from_bf16(data, out2);
+}
+
 #endif
 
 }}}
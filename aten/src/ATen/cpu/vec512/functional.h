@@ -0,0 +1,53 @@
+#pragma once
+
+// DO NOT DEFINE STATIC DATA IN THIS HEADER!
+// See Note [Do not compile initializers with AVX]
+
+#include <ATen/cpu/vec256/functional.h>
+#include <ATen/cpu/vec512/vec512.h>
+
+namespace at { namespace vec512 {
+
+// `vec_fun` must accept both Vec512<scalar_t> and Vec256<scalar_t> operands
+// (e.g. a generic lambda), since the final horizontal step folds the two
+// 256-bit halves together and hands off to vec256::vec_reduce_all.
+template <typename scalar_t, typename Op>
+inline scalar_t reduce_all(const Op& vec_fun, const scalar_t* data, int64_t size) {
+  using Vec = Vec512<scalar_t>;
+  using Vec256 = vec256::Vec256<scalar_t>;
+  if (size < Vec::size()) {
+    return vec256::reduce_all<scalar_t>(vec_fun, data, size);
+  }
+  int64_t d = Vec::size();
+  Vec acc_vec = Vec::loadu(data);
+  for (; d < size - (size % Vec::size()); d += Vec::size()) {
+    Vec data_vec = Vec::loadu(data + d);
+    acc_vec = vec_fun(acc_vec, data_vec);
+  }
+  if (size - d > 0) {
+    Vec data_vec = Vec::loadu(data + d, size - d);
+    acc_vec = Vec::set(acc_vec, vec_fun(acc_vec, data_vec), size - d);
+  }
+  Vec256 folded = vec_fun(acc_vec.lo(), acc_vec.hi());
+  return vec256::vec_reduce_all<scalar_t>(vec_fun, folded, Vec256::size());
+}
+
+template <typename scalar_t, typename Op>
+inline void map(
+    const Op& vec_fun,
+    scalar_t* output_data,
+    const scalar_t* input_data,
+    int64_t size) {
+  using Vec = Vec512<scalar_t>;
+  int64_t d = 0;
+  for (; d < size - (size % Vec::size()); d += Vec::size()) {
+    Vec output_vec = vec_fun(Vec::loadu(input_data + d));
+    output_vec.store(output_data + d);
+  }
+  if (size - d > 0) {
+    Vec output_vec = vec_fun(Vec::loadu(input_data + d, size - d));
+    output_vec.store(output_data + d, size - d);
+  }
+}
+
+}}
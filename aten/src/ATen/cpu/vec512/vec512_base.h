@@ -0,0 +1,162 @@
+#pragma once
+
+// DO NOT DEFINE STATIC DATA IN THIS HEADER!
+// See Note [Do not compile initializers with AVX]
+//
+// Note [Vec512 fallback]
+// ~~~~~~~~~~~~~~~~~~~~~~
+// Vec512<T> is the 512-bit counterpart of Vec256<T>. Kernels written against
+// Vec512 process twice as many lanes per iteration; on CPU_CAPABILITY_AVX512
+// builds the float and double specializations map onto a single zmm register.
+// Every other build (and every other scalar type) gets this generic version,
+// which is a pair of Vec256<T> halves, so kernels can use Vec512 without
+// guarding on the capability and still pick up the AVX2 Vec256 code paths.
+
+#include <ATen/cpu/vec256/vec256.h>
+
+#if defined(__GNUC__)
+#define __at_align64__ __attribute__((aligned(64)))
+#elif defined(_WIN32)
+#define __at_align64__ __declspec(align(64))
+#else
+#define __at_align64__
+#endif
+
+namespace at {
+namespace vec512 {
+// See Note [Acceptable use of anonymous namespace in header]
+namespace {
+
+using vec256::Vec256;
+
+template <class T>
+struct Vec512 {
+private:
+  Vec256<T> lo_;
+  Vec256<T> hi_;
+public:
+  using value_type = T;
+  // See Note [constexpr static function to avoid odr-usage compiler bug]
+  static constexpr int size() {
+    return 2 * Vec256<T>::size();
+  }
+  Vec512() {}
+  Vec512(T val) : lo_(val), hi_(val) {}
+  Vec512(const Vec256<T>& lo, const Vec256<T>& hi) : lo_(lo), hi_(hi) {}
+  const Vec256<T>& lo() const {
+    return lo_;
+  }
+  const Vec256<T>& hi() const {
+    return hi_;
+  }
+  static Vec512<T> loadu(const void* ptr, int64_t count = size()) {
+    constexpr int64_t half = Vec256<T>::size();
+    const T* data = reinterpret_cast<const T*>(ptr);
+    if (count == size()) {
+      return Vec512<T>(Vec256<T>::loadu(data), Vec256<T>::loadu(data + half));
+    }
+    if (count <= half) {
+      return Vec512<T>(Vec256<T>::loadu(data, count), Vec256<T>(T(0)));
+    }
+    return Vec512<T>(
+        Vec256<T>::loadu(data), Vec256<T>::loadu(data + half, count - half));
+  }
+  void store(void* ptr, int64_t count = size()) const {
+    constexpr int64_t half = Vec256<T>::size();
+    T* data = reinterpret_cast<T*>(ptr);
+    if (count == size()) {
+      lo_.store(data);
+      hi_.store(data + half);
+    } else if (count <= half) {
+      lo_.store(data, count);
+    } else {
+      lo_.store(data);
+      hi_.store(data + half, count - half);
+    }
+  }
+  static Vec512<T> set(const Vec512<T>& a, const Vec512<T>& b,
+                       int64_t count = size()) {
+    constexpr int64_t half = Vec256<T>::size();
+    if (count <= half) {
+      return Vec512<T>(Vec256<T>::set(a.lo_, b.lo_, count), a.hi_);
+    }
+    return Vec512<T>(b.lo_, Vec256<T>::set(a.hi_, b.hi_, count - half));
+  }
+  Vec512<T> map(T (*f)(T)) const {
+    return Vec512<T>(lo_.map(f), hi_.map(f));
+  }
+  Vec512<T> abs() const {
+    return Vec512<T>(lo_.abs(), hi_.abs());
+  }
+  Vec512<T> exp() const {
+    return Vec512<T>(lo_.exp(), hi_.exp());
+  }
+  Vec512<T> log() const {
+    return Vec512<T>(lo_.log(), hi_.log());
+  }
+  Vec512<T> sqrt() const {
+    return Vec512<T>(lo_.sqrt(), hi_.sqrt());
+  }
+  Vec512<T> reciprocal() const {
+    return Vec512<T>(lo_.reciprocal(), hi_.reciprocal());
+  }
+  Vec512<T> neg() const {
+    return Vec512<T>(lo_.neg(), hi_.neg());
+  }
+};
+
+#define DEFINE_VEC512_BINARY_OP(op)                                            \
+template <class T>                                                             \
+Vec512<T> inline operator op(const Vec512<T>& a, const Vec512<T>& b) {         \
+  return Vec512<T>(a.lo() op b.lo(), a.hi() op b.hi());                        \
+}
+
+DEFINE_VEC512_BINARY_OP(+)
+DEFINE_VEC512_BINARY_OP(-)
+DEFINE_VEC512_BINARY_OP(*)
+DEFINE_VEC512_BINARY_OP(/)
+
+#undef DEFINE_VEC512_BINARY_OP
+
+template <typename T>
+inline Vec512<T>& operator += (Vec512<T>& a, const Vec512<T>& b) {
+  a = a + b;
+  return a;
+}
+template <typename T>
+inline Vec512<T>& operator -= (Vec512<T>& a, const Vec512<T>& b) {
+  a = a - b;
+  return a;
+}
+template <typename T>
+inline Vec512<T>& operator *= (Vec512<T>& a, const Vec512<T>& b) {
+  a = a * b;
+  return a;
+}
+template <typename T>
+inline Vec512<T>& operator /= (Vec512<T>& a, const Vec512<T>& b) {
+  a = a / b;
+  return a;
+}
+
+// Implements the IEEE 754 201X `maximum` operation, which propagates NaN if
+// either input is a NaN.
+template <class T>
+Vec512<T> inline maximum(const Vec512<T>& a, const Vec512<T>& b) {
+  return Vec512<T>(vec256::maximum(a.lo(), b.lo()), vec256::maximum(a.hi(), b.hi()));
+}
+
+// Implements the IEEE 754 201X `minimum` operation, which propagates NaN if
+// either input is a NaN.
+template <class T>
+Vec512<T> inline minimum(const Vec512<T>& a, const Vec512<T>& b) {
+  return Vec512<T>(vec256::minimum(a.lo(), b.lo()), vec256::minimum(a.hi(), b.hi()));
+}
+
+template <typename T>
+inline Vec512<T> fmadd(const Vec512<T>& a, const Vec512<T>& b, const Vec512<T>& c) {
+  return Vec512<T>(
+      vec256::fmadd(a.lo(), b.lo(), c.lo()), vec256::fmadd(a.hi(), b.hi(), c.hi()));
+}
+
+}}}
@@ -0,0 +1,138 @@
+#pragma once
+
+// DO NOT DEFINE STATIC DATA IN THIS HEADER!
+// See Note [Do not compile initializers with AVX]
+
+#include <ATen/cpu/vec512/vec512_base.h>
+#if defined(CPU_CAPABILITY_AVX512) && !defined(_MSC_VER)
+#include <sleef.h>
+#endif
+
+namespace at {
+namespace vec512 {
+// See Note [Acceptable use of anonymous namespace in header]
+namespace {
+
+#if defined(CPU_CAPABILITY_AVX512) && !defined(_MSC_VER)
+
+template <> class Vec512<double> {
+private:
+  __m512d values;
+public:
+  using value_type = double;
+  static constexpr int size() {
+    return 8;
+  }
+  Vec512() {}
+  Vec512(__m512d v) : values(v) {}
+  Vec512(double val) {
+    values = _mm512_set1_pd(val);
+  }
+  Vec512(const Vec256<double>& lo, const Vec256<double>& hi) {
+    values = _mm512_insertf64x4(_mm512_castpd256_pd512(lo), hi, 1);
+  }
+  operator __m512d() const {
+    return values;
+  }
+  Vec256<double> lo() const {
+    return _mm512_castpd512_pd256(values);
+  }
+  Vec256<double> hi() const {
+    return _mm512_extractf64x4_pd(values, 1);
+  }
+  static Vec512<double> loadu(const void* ptr, int64_t count = size()) {
+    if (count == size()) {
+      return _mm512_loadu_pd(reinterpret_cast<const double*>(ptr));
+    }
+    // Masked loads never touch the lanes past `count`, and zero them, so there
+    // is no need for the zero-initialized bounce buffer used by Vec256.
+    __mmask8 mask = (1ULL << count) - 1;
+    return _mm512_maskz_loadu_pd(mask, ptr);
+  }
+  void store(void* ptr, int64_t count = size()) const {
+    if (count == size()) {
+      _mm512_storeu_pd(reinterpret_cast<double*>(ptr), values);
+    } else if (count > 0) {
+      __mmask8 mask = (1ULL << count) - 1;
+      _mm512_mask_storeu_pd(ptr, mask, values);
+    }
+  }
+  static Vec512<double> set(const Vec512<double>& a, const Vec512<double>& b,
+                            int64_t count = size()) {
+    __mmask8 mask = (1ULL << count) - 1;
+    return _mm512_mask_mov_pd(a.values, mask, b.values);
+  }
+  Vec512<double> map(double (*f)(double)) const {
+    __at_align64__ double tmp[size()];
+    store(tmp);
+    for (int64_t i = 0; i < size(); i++) {
+      tmp[i] = f(tmp[i]);
+    }
+    return loadu(tmp);
+  }
+  Vec512<double> abs() const {
+    return _mm512_abs_pd(values);
+  }
+  Vec512<double> exp() const {
+    return Vec512<double>(Sleef_expd8_u10(values));
+  }
+  Vec512<double> log() const {
+    return Vec512<double>(Sleef_logd8_u10(values));
+  }
+  Vec512<double> sqrt() const {
+    return _mm512_sqrt_pd(values);
+  }
+  Vec512<double> reciprocal() const {
+    return _mm512_div_pd(_mm512_set1_pd(1), values);
+  }
+  Vec512<double> neg() const {
+    return _mm512_xor_pd(_mm512_set1_pd(-0.0), values);
+  }
+};
+
+template <>
+Vec512<double> inline operator+(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_add_pd(a, b);
+}
+
+template <>
+Vec512<double> inline operator-(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_sub_pd(a, b);
+}
+
+template <>
+Vec512<double> inline operator*(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_mul_pd(a, b);
+}
+
+template <>
+Vec512<double> inline operator/(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_div_pd(a, b);
+}
+
+// Implements the IEEE 754 201X `maximum` operation, which propagates NaN if
+// either input is a NaN.
+template <>
+Vec512<double> inline maximum(const Vec512<double>& a, const Vec512<double>& b) {
+  auto max = _mm512_max_pd(a, b);
+  auto isnan_mask = _mm512_cmp_pd_mask(a, b, _CMP_UNORD_Q);
+  return _mm512_mask_mov_pd(max, isnan_mask, _mm512_set1_pd(NAN));
+}
+
+// Implements the IEEE 754 201X `minimum` operation, which propagates NaN if
+// either input is a NaN.
+template <>
+Vec512<double> inline minimum(const Vec512<double>& a, const Vec512<double>& b) {
+  auto min = _mm512_min_pd(a, b);
+  auto isnan_mask = _mm512_cmp_pd_mask(a, b, _CMP_UNORD_Q);
+  return _mm512_mask_mov_pd(min, isnan_mask, _mm512_set1_pd(NAN));
+}
+
+template <>
+Vec512<double> inline fmadd(const Vec512<double>& a, const Vec512<double>& b, const Vec512<double>& c) {
+  return _mm512_fmadd_pd(a, b, c);
+}
+
+#endif
+
+}}}
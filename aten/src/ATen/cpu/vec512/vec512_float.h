@@ -0,0 +1,138 @@
+#pragma once
+
+// DO NOT DEFINE STATIC DATA IN THIS HEADER!
+// See Note [Do not compile initializers with AVX]
+
+#include <ATen/cpu/vec512/vec512_base.h>
+#if defined(CPU_CAPABILITY_AVX512) && !defined(_MSC_VER)
+#include <sleef.h>
+#endif
+
+namespace at {
+namespace vec512 {
+// See Note [Acceptable use of anonymous namespace in header]
+namespace {
+
+#if defined(CPU_CAPABILITY_AVX512) && !defined(_MSC_VER)
+
+template <> class Vec512<float> {
+private:
+  __m512 values;
+public:
+  using value_type = float;
+  static constexpr int size() {
+    return 16;
+  }
+  Vec512() {}
+  Vec512(__m512 v) : values(v) {}
+  Vec512(float val) {
+    values = _mm512_set1_ps(val);
+  }
+  Vec512(const Vec256<float>& lo, const Vec256<float>& hi) {
+    values = _mm512_insertf32x8(_mm512_castps256_ps512(lo), hi, 1);
+  }
+  operator __m512() const {
+    return values;
+  }
+  Vec256<float> lo() const {
+    return _mm512_castps512_ps256(values);
+  }
+  Vec256<float> hi() const {
+    return _mm512_extractf32x8_ps(values, 1);
+  }
+  static Vec512<float> loadu(const void* ptr, int64_t count = size()) {
+    if (count == size()) {
+      return _mm512_loadu_ps(reinterpret_cast<const float*>(ptr));
+    }
+    // Masked loads never touch the lanes past `count`, and zero them, so there
+    // is no need for the zero-initialized bounce buffer used by Vec256.
+    __mmask16 mask = (1ULL << count) - 1;
+    return _mm512_maskz_loadu_ps(mask, ptr);
+  }
+  void store(void* ptr, int64_t count = size()) const {
+    if (count == size()) {
+      _mm512_storeu_ps(reinterpret_cast<float*>(ptr), values);
+    } else if (count > 0) {
+      __mmask16 mask = (1ULL << count) - 1;
+      _mm512_mask_storeu_ps(ptr, mask, values);
+    }
+  }
+  static Vec512<float> set(const Vec512<float>& a, const Vec512<float>& b,
+                           int64_t count = size()) {
+    __mmask16 mask = (1ULL << count) - 1;
+    return _mm512_mask_mov_ps(a.values, mask, b.values);
+  }
+  Vec512<float> map(float (*f)(float)) const {
+    __at_align64__ float tmp[size()];
+    store(tmp);
+    for (int64_t i = 0; i < size(); i++) {
+      tmp[i] = f(tmp[i]);
+    }
+    return loadu(tmp);
+  }
+  Vec512<float> abs() const {
+    return _mm512_abs_ps(values);
+  }
+  Vec512<float> exp() const {
+    return Vec512<float>(Sleef_expf16_u10(values));
+  }
+  Vec512<float> log() const {
+    return Vec512<float>(Sleef_logf16_u10(values));
+  }
+  Vec512<float> sqrt() const {
+    return _mm512_sqrt_ps(values);
+  }
+  Vec512<float> reciprocal() const {
+    return _mm512_div_ps(_mm512_set1_ps(1), values);
+  }
+  Vec512<float> neg() const {
+    return _mm512_xor_ps(_mm512_set1_ps(-0.f), values);
+  }
+};
+
+template <>
+Vec512<float> inline operator+(const Vec512<float>& a, const Vec512<float>& b) {
+  return _mm512_add_ps(a, b);
+}
+
+template <>
+Vec512<float> inline operator-(const Vec512<float>& a, const Vec512<float>& b) {
+  return _mm512_sub_ps(a, b);
+}
+
+template <>
+Vec512<float> inline operator*(const Vec512<float>& a, const Vec512<float>& b) {
+  return _mm512_mul_ps(a, b);
+}
+
+template <>
+Vec512<float> inline operator/(const Vec512<float>& a, const Vec512<float>& b) {
+  return _mm512_div_ps(a, b);
+}
+
+// Implements the IEEE 754 201X `maximum` operation, which propagates NaN if
+// either input is a NaN.
+template <>
+Vec512<float> inline maximum(const Vec512<float>& a, const Vec512<float>& b) {
+  auto max = _mm512_max_ps(a, b);
+  auto isnan_mask = _mm512_cmp_ps_mask(a, b, _CMP_UNORD_Q);
+  return _mm512_mask_mov_ps(max, isnan_mask, _mm512_set1_ps(NAN));
+}
+
+// Implements the IEEE 754 201X `minimum` operation, which propagates NaN if
+// either input is a NaN.
+template <>
+Vec512<float> inline minimum(const Vec512<float>& a, const Vec512<float>& b) {
+  auto min = _mm512_min_ps(a, b);
+  auto isnan_mask = _mm512_cmp_ps_mask(a, b, _CMP_UNORD_Q);
+  return _mm512_mask_mov_ps(min, isnan_mask, _mm512_set1_ps(NAN));
+}
+
+template <>
+Vec512<float> inline fmadd(const Vec512<float>& a, const Vec512<float>& b, const Vec512<float>& c) {
+  return _mm512_fmadd_ps(a, b, c);
+}
+
+#endif
+
+}}}
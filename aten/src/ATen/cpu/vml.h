@@ -59,7 +59,8 @@ using namespace vec256;
 
 template <typename scalar_t>
 inline void vrsqrt(scalar_t* out, scalar_t* in, int64_t size) {
-  parallel_for(0, size, 2048, [out, in](int64_t begin, int64_t end) {
+  static const int64_t grain_size = internal::grain_size_for_cost(4);
+  parallel_for(0, size, grain_size, [out, in](int64_t begin, int64_t end) {
     map(
         [](const Vec256<scalar_t>& x) {
           return Vec256<scalar_t>((scalar_t)(1)) / x.sqrt();
@@ -81,11 +82,15 @@ inline void vrsqrt(scalar_t* out, scalar_t* in, int64_t size) {
 // for BFloat16, we need specialize it, the reason is that avx/avx2 and glic=2.23,
 // we can't give DL_RUNTIME_BUG volatile type in x = std::op(x);
 
-#define IMPLEMENT_VML_BUG(op)                                                     \
+// `cost` is the per-element cost estimate used to pick the grain size, see
+// Note [Cost-based grain size]
+
+#define IMPLEMENT_VML_BUG(op, cost)                                               \
   template <typename scalar_t>                                                    \
   inline void v##op(scalar_t* out, const scalar_t* in, int64_t size) {            \
     DL_RUNTIME_BUG(op, scalar_t)                                                  \
-    parallel_for(0, size, 2048, [out, in](int64_t begin, int64_t end) {           \
+    static const int64_t grain_size = internal::grain_size_for_cost(cost);        \
+    parallel_for(0, size, grain_size, [out, in](int64_t begin, int64_t end) {     \
       map([](const Vec256<scalar_t>& x) { return x.op(); },                       \
           out + begin,                                                            \
           in + begin,                                                             \
@@ -95,7 +100,8 @@ inline void vrsqrt(scalar_t* out, scalar_t* in, int64_t size) {
   template <>                                                                     \
   inline void v##op<c10::BFloat16>(                                               \
       c10::BFloat16* out, const c10::BFloat16* in, int64_t size) {                \
-    parallel_for(0, size, 2048, [out, in](int64_t begin, int64_t end) {           \
+    static const int64_t grain_size = internal::grain_size_for_cost(cost);        \
+    parallel_for(0, size, grain_size, [out, in](int64_t begin, int64_t end) {     \
       DL_RUNTIME_BUG_BFLOAT16()                                                   \
       map([](const Vec256<c10::BFloat16>& x) { return x.op(); },                  \
           out + begin,                                                            \
@@ -104,46 +110,47 @@ inline void vrsqrt(scalar_t* out, scalar_t* in, int64_t size) {
     });                                                                           \
   }
 
-#define IMPLEMENT_VML(op)                                              \
-  template <typename scalar_t>                                          \
-  inline void v##op(scalar_t* out, const scalar_t* in, int64_t size) {  \
-    parallel_for(0, size, 2048, [out, in](int64_t begin, int64_t end) { \
-      map([](const Vec256<scalar_t>& x) { return x.op(); },             \
-          out + begin,                                                  \
-          in + begin,                                                   \
-          end - begin);                                                 \
-    });                                                                 \
+#define IMPLEMENT_VML(op, cost)                                               \
+  template <typename scalar_t>                                                \
+  inline void v##op(scalar_t* out, const scalar_t* in, int64_t size) {        \
+    static const int64_t grain_size = internal::grain_size_for_cost(cost);    \
+    parallel_for(0, size, grain_size, [out, in](int64_t begin, int64_t end) { \
+      map([](const Vec256<scalar_t>& x) { return x.op(); },                   \
+          out + begin,                                                        \
+          in + begin,                                                         \
+          end - begin);                                                       \
+    });                                                                       \
   }
 
-IMPLEMENT_VML_BUG(abs)
-IMPLEMENT_VML_BUG(acos)
-IMPLEMENT_VML_BUG(asin)
-IMPLEMENT_VML_BUG(atan)
-IMPLEMENT_VML_BUG(ceil)
-IMPLEMENT_VML_BUG(cos)
+IMPLEMENT_VML_BUG(abs, 1)
+IMPLEMENT_VML_BUG(acos, 12)
+IMPLEMENT_VML_BUG(asin, 12)
+IMPLEMENT_VML_BUG(atan, 12)
+IMPLEMENT_VML_BUG(ceil, 1)
+IMPLEMENT_VML_BUG(cos, 12)
 // IMPLEMENT_VML_BUG(cosh)
-IMPLEMENT_VML_BUG(erf)
-IMPLEMENT_VML_BUG(erfc)
-IMPLEMENT_VML(erfinv)
-IMPLEMENT_VML_BUG(exp)
-IMPLEMENT_VML_BUG(expm1)
-IMPLEMENT_VML_BUG(floor)
-IMPLEMENT_VML(i0)
-IMPLEMENT_VML(reciprocal)
-IMPLEMENT_VML_BUG(log)
-IMPLEMENT_VML_BUG(log10)
-IMPLEMENT_VML_BUG(log1p)
-IMPLEMENT_VML_BUG(log2)
-IMPLEMENT_VML(neg)
-IMPLEMENT_VML_BUG(sin)
+IMPLEMENT_VML_BUG(erf, 10)
+IMPLEMENT_VML_BUG(erfc, 12)
+IMPLEMENT_VML(erfinv, 24)
+IMPLEMENT_VML_BUG(exp, 8)
+IMPLEMENT_VML_BUG(expm1, 10)
+IMPLEMENT_VML_BUG(floor, 1)
+IMPLEMENT_VML(i0, 32)
+IMPLEMENT_VML(reciprocal, 2)
+IMPLEMENT_VML_BUG(log, 8)
+IMPLEMENT_VML_BUG(log10, 10)
+IMPLEMENT_VML_BUG(log1p, 10)
+IMPLEMENT_VML_BUG(log2, 10)
+IMPLEMENT_VML(neg, 1)
+IMPLEMENT_VML_BUG(sin, 12)
 // IMPLEMENT_VML_BUG(sinh)
-IMPLEMENT_VML_BUG(sqrt)
-IMPLEMENT_VML_BUG(round)
-IMPLEMENT_VML(rsqrt)
-IMPLEMENT_VML_BUG(tan)
-IMPLEMENT_VML_BUG(tanh)
-IMPLEMENT_VML_BUG(trunc)
-IMPLEMENT_VML_BUG(lgamma)
+IMPLEMENT_VML_BUG(sqrt, 4)
+IMPLEMENT_VML_BUG(round, 1)
+IMPLEMENT_VML(rsqrt, 4)
+IMPLEMENT_VML_BUG(tan, 16)
+IMPLEMENT_VML_BUG(tanh, 10)
+IMPLEMENT_VML_BUG(trunc, 1)
+IMPLEMENT_VML_BUG(lgamma, 48)
 
 
 #if AT_MKL_ENABLED() && !defined(__APPLE__)
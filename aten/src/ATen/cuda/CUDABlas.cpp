@@ -5,6 +5,13 @@
 #include <ATen/cuda/CUDABlas.h>
 #include <ATen/cuda/Exceptions.h>
 
+#if AT_CUDA_BLAS_LT_ENABLED()
+#include <ATen/native/utils/ParamsHash.h>
+#include <c10/cuda/CUDACachingAllocator.h>
+#include <cublasLt.h>
+#include <unordered_map>
+#endif
+
 #define CUDABLAS_POSINT_CHECK(FD, X)         \
   TORCH_CHECK(                               \
       (X > 0 && X <= INT_MAX),               \
@@ -572,6 +579,351 @@ void gemm<at::BFloat16>(CUDABLAS_GEMM_ARGTYPES(at::BFloat16)) {
 }
 #endif
 
+#if AT_CUDA_BLAS_LT_ENABLED()
+
+namespace {
+
+template <typename T, cublasStatus_t (*destructor)(T*)>
+struct CuBlasLtDeleter {
+  void operator()(T* x) {
+    if (x != nullptr) {
+      destructor(x);
+    }
+  }
+};
+
+// An owned cuBLASLt descriptor, T* being its handle type
+template <typename T, cublasStatus_t (*destructor)(T*)>
+class CuBlasLtDescriptor {
+ public:
+  T* descriptor() const {
+    return descriptor_.get();
+  }
+
+ protected:
+  std::unique_ptr<T, CuBlasLtDeleter<T, destructor>> descriptor_;
+};
+
+class CuBlasLtMatmulDescriptor : public CuBlasLtDescriptor<
+                                     cublasLtMatmulDescOpaque_t,
+                                     &cublasLtMatmulDescDestroy> {
+ public:
+  CuBlasLtMatmulDescriptor(
+      cublasComputeType_t compute_type,
+      cudaDataType_t scale_type) {
+    cublasLtMatmulDesc_t raw_descriptor = nullptr;
+    TORCH_CUDABLAS_CHECK(
+        cublasLtMatmulDescCreate(&raw_descriptor, compute_type, scale_type));
+    descriptor_.reset(raw_descriptor);
+  }
+  template <typename T>
+  void setAttribute(cublasLtMatmulDescAttributes_t attr, const T& value) {
+    TORCH_CUDABLAS_CHECK(cublasLtMatmulDescSetAttribute(
+        descriptor(), attr, &value, sizeof(T)));
+  }
+};
+
+class CuBlasLtMatrixLayout : public CuBlasLtDescriptor<
+                                 cublasLtMatrixLayoutOpaque_t,
+                                 &cublasLtMatrixLayoutDestroy> {
+ public:
+  CuBlasLtMatrixLayout(
+      cudaDataType_t type,
+      uint64_t rows,
+      uint64_t cols,
+      int64_t ld) {
+    cublasLtMatrixLayout_t raw_descriptor = nullptr;
+    TORCH_CUDABLAS_CHECK(
+        cublasLtMatrixLayoutCreate(&raw_descriptor, type, rows, cols, ld));
+    descriptor_.reset(raw_descriptor);
+  }
+};
+
+class CuBlasLtMatmulPreference : public CuBlasLtDescriptor<
+                                     cublasLtMatmulPreferenceOpaque_t,
+                                     &cublasLtMatmulPreferenceDestroy> {
+ public:
+  CuBlasLtMatmulPreference() {
+    cublasLtMatmulPreference_t raw_descriptor = nullptr;
+    TORCH_CUDABLAS_CHECK(cublasLtMatmulPreferenceCreate(&raw_descriptor));
+    descriptor_.reset(raw_descriptor);
+  }
+  template <typename T>
+  void setAttribute(cublasLtMatmulPreferenceAttributes_t attr, const T& value) {
+    TORCH_CUDABLAS_CHECK(cublasLtMatmulPreferenceSetAttribute(
+        descriptor(), attr, &value, sizeof(T)));
+  }
+};
+
+template <typename Dtype>
+struct CuBlasLtType {};
+
+template <>
+struct CuBlasLtType<double> {
+  using scale_t = double;
+  static constexpr cudaDataType_t data_type = CUDA_R_64F;
+  static constexpr cudaDataType_t scale_type = CUDA_R_64F;
+};
+
+template <>
+struct CuBlasLtType<float> {
+  using scale_t = float;
+  static constexpr cudaDataType_t data_type = CUDA_R_32F;
+  static constexpr cudaDataType_t scale_type = CUDA_R_32F;
+};
+
+template <>
+struct CuBlasLtType<at::Half> {
+  using scale_t = float;
+  static constexpr cudaDataType_t data_type = CUDA_R_16F;
+  static constexpr cudaDataType_t scale_type = CUDA_R_32F;
+};
+
+template <>
+struct CuBlasLtType<at::BFloat16> {
+  using scale_t = float;
+  static constexpr cudaDataType_t data_type = CUDA_R_16BF;
+  static constexpr cudaDataType_t scale_type = CUDA_R_32F;
+};
+
+constexpr size_t kGemmAndBiasWorkspaceSize = 1024 * 1024;
+
+// Everything the descriptors and the algorithm of gemm_and_bias depend on;
+// a POD for ParamsHash
+struct GemmAndBiasKey {
+  int device;
+  cudaDataType_t data_type;
+  cublasComputeType_t compute_type;
+  cublasLtEpilogue_t epilogue;
+  bool transpose_mat1;
+  bool transpose_mat2;
+  int64_t m, n, k;
+  int64_t mat1_ld, mat2_ld, result_ld;
+  // The algorithms may need the pointers aligned to up to 16 bytes
+  uint32_t alignment[4];
+};
+
+struct GemmAndBiasPlan {
+  GemmAndBiasPlan(const GemmAndBiasKey& key, cudaDataType_t scale_type)
+      : matmul(key.compute_type, scale_type),
+        mat1(key.data_type,
+             key.transpose_mat1 ? key.k : key.m,
+             key.transpose_mat1 ? key.m : key.k,
+             key.mat1_ld),
+        mat2(key.data_type,
+             key.transpose_mat2 ? key.n : key.k,
+             key.transpose_mat2 ? key.k : key.n,
+             key.mat2_ld),
+        result(key.data_type, key.m, key.n, key.result_ld) {}
+
+  CuBlasLtMatmulDescriptor matmul;
+  CuBlasLtMatrixLayout mat1;
+  CuBlasLtMatrixLayout mat2;
+  CuBlasLtMatrixLayout result;
+  cublasLtMatmulHeuristicResult_t heuristic;
+};
+
+uint32_t alignment_of(const void* ptr) {
+  uint32_t alignment = 16;
+  while (reinterpret_cast<uintptr_t>(ptr) % alignment != 0) {
+    alignment /= 2;
+  }
+  return alignment;
+}
+
+} // anonymous namespace
+
+template <typename Dtype>
+void gemm_and_bias(
+    bool transpose_mat1,
+    bool transpose_mat2,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    Dtype alpha,
+    const Dtype* mat1,
+    int64_t mat1_ld,
+    const Dtype* mat2,
+    int64_t mat2_ld,
+    const Dtype* bias,
+    Dtype* result,
+    int64_t result_ld,
+    GEMMAndBiasActivationEpilogue activation) {
+  using scale_t = typename CuBlasLtType<Dtype>::scale_t;
+
+  GemmAndBiasKey key;
+  memset(&key, 0, sizeof(key));
+  key.device = c10::cuda::current_device();
+  key.data_type = CuBlasLtType<Dtype>::data_type;
+  key.compute_type = std::is_same<Dtype, double>::value
+      ? CUBLAS_COMPUTE_64F
+      : (std::is_same<Dtype, float>::value && at::globalContext().allowTF32CuBLAS()
+             ? CUBLAS_COMPUTE_32F_FAST_TF32
+             : CUBLAS_COMPUTE_32F);
+  switch (activation) {
+    case GEMMAndBiasActivationEpilogue::RELU:
+      key.epilogue = CUBLASLT_EPILOGUE_RELU_BIAS;
+      break;
+    case GEMMAndBiasActivationEpilogue::GELU:
+      key.epilogue = CUBLASLT_EPILOGUE_GELU_BIAS;
+      break;
+    default:
+      key.epilogue = CUBLASLT_EPILOGUE_BIAS;
+      break;
+  }
+  key.transpose_mat1 = transpose_mat1;
+  key.transpose_mat2 = transpose_mat2;
+  key.m = m;
+  key.n = n;
+  key.k = k;
+  key.mat1_ld = mat1_ld;
+  key.mat2_ld = mat2_ld;
+  key.result_ld = result_ld;
+  key.alignment[0] = alignment_of(mat1);
+  key.alignment[1] = alignment_of(mat2);
+  key.alignment[2] = alignment_of(result);
+  key.alignment[3] = alignment_of(bias);
+
+  // Per thread, so that a plan's bias pointer is only ever set by one thread
+  thread_local std::unordered_map<
+      GemmAndBiasKey,
+      std::unique_ptr<GemmAndBiasPlan>,
+      at::native::ParamsHash<GemmAndBiasKey>,
+      at::native::ParamsEqual<GemmAndBiasKey>>
+      plans;
+  auto it = plans.find(key);
+  if (it == plans.end()) {
+    auto plan = std::make_unique<GemmAndBiasPlan>(
+        key, CuBlasLtType<Dtype>::scale_type);
+    const cublasOperation_t transa = transpose_mat1 ? CUBLAS_OP_T : CUBLAS_OP_N;
+    const cublasOperation_t transb = transpose_mat2 ? CUBLAS_OP_T : CUBLAS_OP_N;
+    plan->matmul.setAttribute(CUBLASLT_MATMUL_DESC_TRANSA, transa);
+    plan->matmul.setAttribute(CUBLASLT_MATMUL_DESC_TRANSB, transb);
+    plan->matmul.setAttribute(CUBLASLT_MATMUL_DESC_EPILOGUE, key.epilogue);
+    plan->matmul.setAttribute(CUBLASLT_MATMUL_DESC_BIAS_POINTER, bias);
+
+    CuBlasLtMatmulPreference preference;
+    preference.setAttribute(
+        CUBLASLT_MATMUL_PREF_MAX_WORKSPACE_BYTES, kGemmAndBiasWorkspaceSize);
+    preference.setAttribute(
+        CUBLASLT_MATMUL_PREF_MIN_ALIGNMENT_A_BYTES, key.alignment[0]);
+    preference.setAttribute(
+        CUBLASLT_MATMUL_PREF_MIN_ALIGNMENT_B_BYTES, key.alignment[1]);
+    preference.setAttribute(
+        CUBLASLT_MATMUL_PREF_MIN_ALIGNMENT_C_BYTES, key.alignment[2]);
+    preference.setAttribute(
+        CUBLASLT_MATMUL_PREF_MIN_ALIGNMENT_D_BYTES, key.alignment[2]);
+
+    int returned_results = 0;
+    TORCH_CUDABLAS_CHECK(cublasLtMatmulAlgoGetHeuristic(
+        reinterpret_cast<cublasLtHandle_t>(at::cuda::getCurrentCUDABlasHandle()),
+        plan->matmul.descriptor(),
+        plan->mat1.descriptor(),
+        plan->mat2.descriptor(),
+        plan->result.descriptor(),
+        plan->result.descriptor(),
+        preference.descriptor(),
+        1,
+        &plan->heuristic,
+        &returned_results));
+    TORCH_CHECK(
+        returned_results > 0,
+        "at::cuda::blas::gemm_and_bias: no cuBLASLt algorithm for m = ", m,
+        ", n = ", n, ", k = ", k);
+    it = plans.emplace(key, std::move(plan)).first;
+  }
+  GemmAndBiasPlan& plan = *it->second;
+  plan.matmul.setAttribute(CUBLASLT_MATMUL_DESC_BIAS_POINTER, bias);
+
+  const scale_t alpha_val = alpha;
+  const scale_t beta_val = 0;
+  auto workspace = c10::cuda::CUDACachingAllocator::get()->allocate(
+      kGemmAndBiasWorkspaceSize);
+  TORCH_CUDABLAS_CHECK(cublasLtMatmul(
+      reinterpret_cast<cublasLtHandle_t>(at::cuda::getCurrentCUDABlasHandle()),
+      plan.matmul.descriptor(),
+      &alpha_val,
+      mat1,
+      plan.mat1.descriptor(),
+      mat2,
+      plan.mat2.descriptor(),
+      &beta_val,
+      result,
+      plan.result.descriptor(),
+      result,
+      plan.result.descriptor(),
+      &plan.heuristic.algo,
+      workspace.get(),
+      kGemmAndBiasWorkspaceSize,
+      at::cuda::getCurrentCUDAStream()));
+}
+
+template void gemm_and_bias(
+    bool transpose_mat1,
+    bool transpose_mat2,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    double alpha,
+    const double* mat1,
+    int64_t mat1_ld,
+    const double* mat2,
+    int64_t mat2_ld,
+    const double* bias,
+    double* result,
+    int64_t result_ld,
+    GEMMAndBiasActivationEpilogue activation);
+
+template void gemm_and_bias(
+    bool transpose_mat1,
+    bool transpose_mat2,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    float alpha,
+    const float* mat1,
+    int64_t mat1_ld,
+    const float* mat2,
+    int64_t mat2_ld,
+    const float* bias,
+    float* result,
+    int64_t result_ld,
+    GEMMAndBiasActivationEpilogue activation);
+
+template void gemm_and_bias(
+    bool transpose_mat1,
+    bool transpose_mat2,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    at::Half alpha,
+    const at::Half* mat1,
+    int64_t mat1_ld,
+    const at::Half* mat2,
+    int64_t mat2_ld,
+    const at::Half* bias,
+    at::Half* result,
+    int64_t result_ld,
+    GEMMAndBiasActivationEpilogue activation);
+
+template void gemm_and_bias(
+    bool transpose_mat1,
+    bool transpose_mat2,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    at::BFloat16 alpha,
+    const at::BFloat16* mat1,
+    int64_t mat1_ld,
+    const at::BFloat16* mat2,
+    int64_t mat2_ld,
+    const at::BFloat16* bias,
+    at::BFloat16* result,
+    int64_t result_ld,
+    GEMMAndBiasActivationEpilogue activation);
+
+#endif // AT_CUDA_BLAS_LT_ENABLED()
+
 template <>
 void trsm<float>(CUDABLAS_TRSM_ARGTYPES(float)) {
   TORCH_CUDABLAS_CHECK(cublasStrsm(
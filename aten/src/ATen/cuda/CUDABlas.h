@@ -9,6 +9,10 @@
 
     dot<Dtype>(n, x, incx, y, incy, result)
 
+    gemm_and_bias<Dtype>(transpose_mat1, transpose_mat2, m, n, k, alpha,
+  mat1, mat1_ld, mat2, mat2_ld, bias, result, result_ld, activation)
+  (cuBLASLt, CUDA 11.4 and later)
+
   where Dtype is double, float, at::Half or at::BFloat16 (ROCm, NOT for dot).
   The functions are available in at::cuda::blas namespace.
  */
@@ -95,6 +99,40 @@ template <>
 void bgemm<at::BFloat16>(CUDABLAS_BGEMM_ARGTYPES(at::BFloat16));
 #endif
 
+#if !defined(__HIP_PLATFORM_HCC__) && defined(CUDA_VERSION) && CUDA_VERSION >= 11040
+// Whether gemm_and_bias is built
+#define AT_CUDA_BLAS_LT_ENABLED() 1
+
+enum class GEMMAndBiasActivationEpilogue {
+  None,
+  RELU,
+  GELU,
+};
+
+// The cuBLASLt GEMM whose epilogue adds a bias and applies an activation:
+//   result = activation(alpha * op(mat1) @ op(mat2) + bias)
+// for column-major matrices, where bias has m elements, broadcast over the n
+// columns of result. The descriptors and the algorithm are cached per shape.
+template <typename Dtype>
+void gemm_and_bias(
+    bool transpose_mat1,
+    bool transpose_mat2,
+    int64_t m,
+    int64_t n,
+    int64_t k,
+    Dtype alpha,
+    const Dtype* mat1,
+    int64_t mat1_ld,
+    const Dtype* mat2,
+    int64_t mat2_ld,
+    const Dtype* bias,
+    Dtype* result,
+    int64_t result_ld,
+    GEMMAndBiasActivationEpilogue activation = GEMMAndBiasActivationEpilogue::None);
+#else
+#define AT_CUDA_BLAS_LT_ENABLED() 0
+#endif
+
 #define CUDABLAS_TRSM_ARGTYPES(Dtype)                                  \
   cublasHandle_t handle, cublasSideMode_t side, cublasFillMode_t uplo, \
       cublasOperation_t trans, cublasDiagType_t diag, int m, int n,    \
@@ -365,6 +365,22 @@ void CUDAHooks::cuFFTClearPlanCache(int64_t device_index) const {
 #endif
 }
 
+bool CUDAHooks::cuFFTGetPlanCacheBatchBucketing(int64_t device_index) const {
+#ifndef __HIP_PLATFORM_HCC__
+  return at::native::detail::cufft_get_plan_cache_batch_bucketing_impl(device_index);
+#else
+  AT_ERROR("cuFFT with HIP is not supported");
+#endif
+}
+
+void CUDAHooks::cuFFTSetPlanCacheBatchBucketing(int64_t device_index, bool enabled) const {
+#ifndef __HIP_PLATFORM_HCC__
+  at::native::detail::cufft_set_plan_cache_batch_bucketing_impl(device_index, enabled);
+#else
+  AT_ERROR("cuFFT with HIP is not supported");
+#endif
+}
+
 int CUDAHooks::getNumGPUs() const {
   return at::cuda::device_count();
 }
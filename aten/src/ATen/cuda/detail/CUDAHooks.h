@@ -37,6 +37,8 @@ struct CUDAHooks : public at::CUDAHooksInterface {
   void cuFFTSetPlanCacheMaxSize(int64_t device_index, int64_t max_size) const override;
   int64_t cuFFTGetPlanCacheSize(int64_t device_index) const override;
   void cuFFTClearPlanCache(int64_t device_index) const override;
+  bool cuFFTGetPlanCacheBatchBucketing(int64_t device_index) const override;
+  void cuFFTSetPlanCacheBatchBucketing(int64_t device_index, bool enabled) const override;
   int getNumGPUs() const override;
   void deviceSynchronize(int64_t device_index) const override;
 };
@@ -178,6 +178,14 @@ struct TORCH_API CUDAHooksInterface {
     TORCH_CHECK(false, "Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
   }
 
+  virtual bool cuFFTGetPlanCacheBatchBucketing(int64_t device_index) const {
+    TORCH_CHECK(false, "Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
+  }
+
+  virtual void cuFFTSetPlanCacheBatchBucketing(int64_t device_index, bool enabled) const {
+    TORCH_CHECK(false, "Cannot access cuFFT plan cache without ATen_cuda library. ", CUDA_HELP);
+  }
+
   virtual int getNumGPUs() const {
     return 0;
   }
@@ -63,6 +63,10 @@ typedef enum {
   kDLInt = 0U,
   kDLUInt = 1U,
   kDLFloat = 2U,
+  // the codes below follow later DLPack releases
+  kDLBfloat = 4U,
+  kDLComplex = 5U,
+  kDLBool = 6U,
 } DLDataTypeCode;
 
 /*!
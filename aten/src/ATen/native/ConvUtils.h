@@ -105,4 +105,11 @@ static inline bool cudnn_conv_use_channels_last(const at::Tensor& input, const a
   return can_use_cudnn_channels_last_2d || can_use_cudnn_channels_last_3d;
 }
 
+// Direct (im2col-free) 2d convolution of a channels last CPU input, see
+// Note [Direct channels last convolution] in ConvolutionMM2d.cpp.
+// Not differentiable; only used when no input requires grad.
+Tensor slow_conv2d_channels_last_cpu(
+    const Tensor& input, const Tensor& weight, const Tensor& bias,
+    IntArrayRef stride, IntArrayRef padding, IntArrayRef dilation);
+
 }} // namespace at::native
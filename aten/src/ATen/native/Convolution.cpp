@@ -24,6 +24,7 @@ constexpr int MIOPEN_DIM_MAX = 5;
 namespace at { namespace native {
 
 DEFINE_DISPATCH(convolution_depthwise3x3_winograd_stub);
+DEFINE_DISPATCH(convolution_depthwise_stub);
 
 struct ConvParams {
   std::vector<int64_t> stride;
@@ -46,6 +47,8 @@ struct ConvParams {
   bool is_stride_nonpos() const;
   void view1d_as_2d();
   bool use_cpu_depthwise3x3_winograd(const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias) const;
+  bool use_cpu_depthwise(const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias) const;
+  bool use_cpu_channels_last(const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias) const;
   bool needs_64bit_indexing_no_split(const at::Tensor& input, const at::Tensor& weight) const;
   bool use_cudnn(const at::Tensor& input, const at::Tensor& weight) const;
   bool use_cudnn_depthwise(const at::Tensor& input, const at::Tensor& weight) const;
@@ -167,6 +170,50 @@ auto ConvParams::use_cpu_depthwise3x3_winograd(
 #endif
 }
 
+// The direct CPU kernels below produce their output without recording any
+// autograd history, so they are only usable for inference.
+static inline bool cpu_direct_conv_supported(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias) {
+  const auto dtype = input.scalar_type();
+  return input.device().is_cpu() &&
+         input.layout() == at::kStrided &&
+         (dtype == at::kFloat || dtype == at::kDouble) &&
+         input.ndimension() == 4 &&
+         weight.ndimension() == 4 &&
+         weight.device().is_cpu() &&
+         weight.layout() == at::kStrided &&
+         weight.scalar_type() == dtype &&
+         (!bias.defined() ||
+            (bias.device().is_cpu() && bias.scalar_type() == dtype)) &&
+         !input.requires_grad() &&
+         !weight.requires_grad() &&
+         !(bias.defined() && bias.requires_grad());
+}
+
+auto ConvParams::use_cpu_depthwise(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias) const -> bool {
+  return !transposed &&
+         cpu_direct_conv_supported(input, weight, bias) &&
+         groups > 1 &&
+         input.size(1) == groups &&
+         weight.size(0) % groups == 0 &&
+         weight.size(1) == 1;
+}
+
+auto ConvParams::use_cpu_channels_last(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias) const -> bool {
+  return !transposed &&
+         groups == 1 &&
+         cpu_direct_conv_supported(input, weight, bias) &&
+         input.suggest_memory_format() == at::MemoryFormat::ChannelsLast;
+}
+
 auto ConvParams::needs_64bit_indexing_no_split(const at::Tensor& input, const at::Tensor& weight) const -> bool {
   constexpr int64_t int_max = std::numeric_limits<int>::max();
   int64_t numel_input = input.numel();
@@ -927,6 +974,23 @@ at::Tensor _convolution(
         params.stride,
         params.padding,
         params.groups);
+  } else if (params.use_cpu_depthwise(input, weight, bias)) {
+    output = convolution_depthwise_stub(
+        input.device().type(),
+        input,
+        weight,
+        bias,
+        params.stride,
+        params.padding,
+        params.dilation);
+  } else if (params.use_cpu_channels_last(input, weight, bias)) {
+    output = slow_conv2d_channels_last_cpu(
+        input,
+        weight,
+        bias,
+        params.stride,
+        params.padding,
+        params.dilation);
   } else if (
         !params.transposed && (input.ndimension() == 5) &&
         (input.device().is_cpu()) &&
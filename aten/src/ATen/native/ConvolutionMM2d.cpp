@@ -5,6 +5,8 @@
 #include <ATen/TensorUtils.h>
 #include <ATen/core/grad_mode.h>
 #include <ATen/div_rtn.h>
+#include <ATen/native/CPUBlas.h>
+#include <ATen/native/ConvUtils.h>
 #include <ATen/native/Unfold2d.h>
 
 namespace at {
@@ -210,6 +212,15 @@ void slow_conv2d_backward_update_grad_input_frame(
     int64_t pad_width) {
   auto grad_output_2d = grad_output.reshape(
       {grad_output.size(0), grad_output.size(1) * grad_output.size(2)});
+  if ((kernel_height == 1) && (stride_height == 1) && (pad_height == 0) &&
+      (kernel_width == 1) && (stride_width == 1) && (pad_width == 0)) {
+    // The 1x1 column buffer is the input itself, so there is nothing to fold
+    // back: write the product straight into grad_input.
+    auto grad_input_2d = grad_input.view(
+        {grad_input.size(0), grad_input.size(1) * grad_input.size(2)});
+    at::mm_out(grad_input_2d, weight, grad_output_2d);
+    return;
+  }
   fgrad_input.addmm_(weight, grad_output_2d, 0, 1);
 
   grad_input.zero_();
@@ -264,8 +275,12 @@ void slow_conv2d_backward_out_cpu_template(
   const Tensor input = input_.contiguous();
   const Tensor grad_output = grad_output_.contiguous();
   grad_input.resize_as_(input);
-  fgrad_input.resize_as_(finput);
-  fgrad_input.zero_();
+  const bool is_1x1 = (kernel_height == 1) && (stride_height == 1) && (pad_height == 0) &&
+      (kernel_width == 1) && (stride_width == 1) && (pad_width == 0);
+  if (!is_1x1) {
+    fgrad_input.resize_as_(finput);
+    fgrad_input.zero_();
+  }
   const Tensor tweight = weight.transpose(0, 1);
   const int64_t batch_size = input.size(0);
   at::parallel_for(0, batch_size, 0, [&](int64_t start, int64_t end) {
@@ -274,7 +289,7 @@ void slow_conv2d_backward_out_cpu_template(
     for (int64_t t = start; t < end; t++) {
       Tensor grad_input_t = grad_input[t];
       Tensor grad_output_t = grad_output[t];
-      Tensor fgrad_input_t = fgrad_input[t];
+      Tensor fgrad_input_t = is_1x1 ? fgrad_input : fgrad_input[t];
       slow_conv2d_backward_update_grad_input_frame(
           grad_input_t,
           grad_output_t,
@@ -611,5 +626,104 @@ Tensor thnn_conv2d(const Tensor & self, const Tensor & weight, IntArrayRef kerne
   return std::get<0>(at::thnn_conv2d_forward(self, weight, kernel_size, bias, stride, padding));
 }
 
+// Note [Direct channels last convolution]
+// For a channels last (NHWC) input every input pixel is a contiguous vector
+// of input channels and every output pixel a contiguous vector of output
+// channels, so a convolution is just a sum of GEMMs without any im2col:
+// for each kernel tap (kh, kw) and output row, the output pixels of the row
+// accumulate W[:, :, kh, kw] times the input pixels they read through that
+// tap. Those input pixels are equally spaced (stride_width * channels apart),
+// which GEMM takes as the leading dimension of its right-hand side.
+// Padding is handled by clipping each tap to the output columns whose input
+// column is in bounds. A 1x1, stride 1 convolution degenerates to one GEMM
+// per output row with no data movement at all.
+Tensor slow_conv2d_channels_last_cpu(
+    const Tensor& input_,
+    const Tensor& weight_,
+    const Tensor& bias,
+    IntArrayRef stride,
+    IntArrayRef padding,
+    IntArrayRef dilation) {
+  const Tensor input = input_.contiguous(at::MemoryFormat::ChannelsLast);
+  // [out_channels, in_channels, kh, kw] -> [kh, kw, in_channels, out_channels],
+  // i.e. one column-major out_channels x in_channels matrix per tap.
+  const Tensor weight = weight_.permute({2, 3, 1, 0}).contiguous();
+
+  const int64_t batch_size = input.size(0);
+  const int64_t n_input_plane = input.size(1);
+  const int64_t input_height = input.size(2);
+  const int64_t input_width = input.size(3);
+  const int64_t n_output_plane = weight_.size(0);
+  const int64_t kernel_height = weight_.size(2);
+  const int64_t kernel_width = weight_.size(3);
+  const auto output_size = conv_output_size(
+      input.sizes(), weight_.sizes(), padding, stride, dilation);
+  const int64_t output_height = output_size[2];
+  const int64_t output_width = output_size[3];
+
+  Tensor output = at::empty(
+      output_size, input.options().memory_format(at::MemoryFormat::ChannelsLast));
+
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "slow_conv2d_channels_last_cpu", [&] {
+    const scalar_t* input_data = input.data_ptr<scalar_t>();
+    const scalar_t* weight_data = weight.data_ptr<scalar_t>();
+    scalar_t* output_data = output.data_ptr<scalar_t>();
+    Tensor bias_contig;
+    const scalar_t* bias_data = nullptr;
+    if (bias.defined()) {
+      bias_contig = bias.contiguous();
+      bias_data = bias_contig.data_ptr<scalar_t>();
+    }
+
+    at::parallel_for(0, batch_size * output_height, 0, [&](int64_t start, int64_t end) {
+      for (int64_t row = start; row < end; ++row) {
+        const int64_t n = row / output_height;
+        const int64_t oh = row % output_height;
+        scalar_t* out_row = output_data + row * output_width * n_output_plane;
+        for (int64_t ow = 0; ow < output_width; ++ow) {
+          scalar_t* out_pixel = out_row + ow * n_output_plane;
+          if (bias_data) {
+            std::copy(bias_data, bias_data + n_output_plane, out_pixel);
+          } else {
+            std::fill(out_pixel, out_pixel + n_output_plane, scalar_t(0));
+          }
+        }
+        for (int64_t kh = 0; kh < kernel_height; ++kh) {
+          const int64_t ih = oh * stride[0] - padding[0] + kh * dilation[0];
+          if (ih < 0 || ih >= input_height) {
+            continue;
+          }
+          const scalar_t* in_row = input_data +
+              (n * input_height + ih) * input_width * n_input_plane;
+          for (int64_t kw = 0; kw < kernel_width; ++kw) {
+            // Output column ow reads input column ow * stride[1] + offset.
+            const int64_t offset = kw * dilation[1] - padding[1];
+            const int64_t ow_begin =
+                offset >= 0 ? 0 : (-offset + stride[1] - 1) / stride[1];
+            const int64_t ow_end = input_width - offset <= 0 ? 0 :
+                std::min(output_width, (input_width - offset - 1) / stride[1] + 1);
+            if (ow_begin >= ow_end) {
+              continue;
+            }
+            cpublas::gemm(
+                cpublas::NoTranspose, cpublas::NoTranspose,
+                n_output_plane, ow_end - ow_begin, n_input_plane,
+                scalar_t(1),
+                weight_data + (kh * kernel_width + kw) * n_input_plane * n_output_plane,
+                n_output_plane,
+                in_row + (ow_begin * stride[1] + offset) * n_input_plane,
+                stride[1] * n_input_plane,
+                scalar_t(1),
+                out_row + ow_begin * n_output_plane,
+                n_output_plane);
+          }
+        }
+      }
+    });
+  });
+
+  return output;
+}
+
 } // namespace native
 } // namespace at
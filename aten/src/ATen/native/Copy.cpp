@@ -23,64 +23,27 @@ namespace {
 
 using namespace at;
 
-bool copy_transpose_valid(const Tensor& self, const Tensor& src) {
+// Whether to copy with the tiled permute_copy_stub, i.e. self is contiguous and
+// the innermost dimension of self is not the fastest moving one in src, which
+// is the case TensorIterator handles poorly. See Note [Tiled permute copy]
+bool copy_permute_valid(const Tensor& self, const Tensor& src) {
   const int MIN_SZ = 60 * 60;
-  return self.is_contiguous() && src.numel() != 0 && src.dim() == 2 &&
-      src.stride(0) == 1 && src.stride(1) == src.size(0) &&
-      self.scalar_type() == src.scalar_type() &&
-      self.numel() >= MIN_SZ;
-}
-
-// special case copy where tensor is contiguous and src is a transposed matrix
-// This can be generalized to most copies, but it's trickier
-void copy_same_type_transpose_(Tensor& self, const Tensor& src) {
-  int64_t BLOCK_SZ;
-  if (self.scalar_type() == kByte) {
-    BLOCK_SZ = 120;
-  } else {
-    BLOCK_SZ = 60;
-  }
-  Tensor buf = empty({BLOCK_SZ, BLOCK_SZ}, self.options());
-
-  AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND3(kHalf, kBool, kBFloat16, self.scalar_type(), "copy_", [&] {
-    scalar_t* sp = src.data_ptr<scalar_t>();
-    scalar_t* rp = self.data_ptr<scalar_t>();
-    scalar_t* bp = buf.data_ptr<scalar_t>();
-
-    int64_t NR = src.size(0);
-    int64_t NC = src.size(1);
-    for (int64_t R = 0; R < NR; R += BLOCK_SZ) {
-      for (int64_t C = 0; C < NC; C += BLOCK_SZ) {
-        scalar_t* spo = sp + R + C * NR;
-        scalar_t* rpo = rp + C + R * NC;
-
-        int nr = std::min(NR - R, BLOCK_SZ);
-        int nc = std::min(NC - C, BLOCK_SZ);
-
-        // 1. copy columns from src to buf
-        for (int c = 0; c < nc; c++) {
-          memcpy(bp + c * BLOCK_SZ, spo + c * NR, nr * sizeof(scalar_t));
-        }
-
-        // 2. transpose buf in place
-        int rc_max = std::max(nr, nc);
-        int rc_min = std::min(nr, nc);
-        for (int r = 0; r < rc_max; r++) {
-          int end = std::min(r, rc_min);
-          for (int c = 0; c < end; c++) {
-            scalar_t tmp = bp[r + BLOCK_SZ * c];
-            bp[r + BLOCK_SZ * c] = bp[r * BLOCK_SZ + c];
-            bp[r * BLOCK_SZ + c] = tmp;
-          }
-        }
-
-        // 3. copy rows from buf to dst
-        for (int r = 0; r < nr; r++) {
-          memcpy(rpo + r * NC, bp + r * BLOCK_SZ, nc * sizeof(scalar_t));
-        }
-      }
+  if (!(self.is_contiguous() && src.dim() >= 2 && self.sizes() == src.sizes() &&
+        self.scalar_type() == src.scalar_type() && self.numel() >= MIN_SZ)) {
+    return false;
+  }
+  int64_t self_inner = -1;
+  int64_t src_inner = -1;
+  for (int64_t i = 0; i < src.dim(); i++) {
+    if (src.size(i) == 1) {
+      continue;
+    }
+    self_inner = i;
+    if (src_inner < 0 || src.stride(i) < src.stride(src_inner)) {
+      src_inner = i;
     }
-  });
+  }
+  return self_inner != src_inner;
 }
 
 // Devices directly supported by this copy implementation. Other device types
@@ -228,8 +191,8 @@ static Tensor & copy_impl(Tensor & self, const Tensor & src, bool non_blocking)
   }
 
   // TODO: if we need to, we can also enable this path for quantized tensor
-  if (device_type == kCPU && copy_transpose_valid(self, src) && !self.is_quantized()) {
-    copy_same_type_transpose_(self, src);
+  if (device_type == kCPU && copy_permute_valid(self, src) && !self.is_quantized()) {
+    permute_copy_stub(kCPU, self, src);
     return self;
   }
 
@@ -251,6 +214,7 @@ Tensor& copy_(Tensor& self, const Tensor& src, bool non_blocking) {
 }
 
 DEFINE_DISPATCH(copy_stub);
+DEFINE_DISPATCH(permute_copy_stub);
 
 } // namespace native
 } // namespace at
@@ -10,8 +10,12 @@ struct TensorIterator;
 namespace native {
 
 using copy_fn = void (*)(TensorIterator&, bool non_blocking);
+using permute_copy_fn = void (*)(Tensor& self, const Tensor& src);
 
 DECLARE_DISPATCH(copy_fn, copy_stub);
+// Same dtype copy from a permuted (or otherwise strided) tensor into a
+// contiguous tensor of the same shape. See Note [Tiled permute copy]
+DECLARE_DISPATCH(permute_copy_fn, permute_copy_stub);
 
 } // namespace native
 } // namespace at
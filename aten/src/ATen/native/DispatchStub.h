@@ -37,7 +37,7 @@
 // TODO: CPU instruction set selection should be folded into whatever
 // the main dispatch mechanism is.
 
-// ignore warnings about DispatchStub::DEFAULT, AVX, AVX2 defined elsewhere
+// ignore warnings about DispatchStub::DEFAULT, AVX, AVX2, AVX512 defined elsewhere
 #if defined(__clang__)
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wundefined-var-template"
@@ -52,6 +52,7 @@ enum class CPUCapability {
 #else
   AVX = 1,
   AVX2 = 2,
+  AVX512 = 3,
 #endif
   NUM_OPTIONS
 };
@@ -77,6 +78,9 @@ struct TORCH_API DispatchStubImpl {
 #ifdef HAVE_AVX2_CPU_DEFINITION
       , void *AVX2
 #endif
+#ifdef HAVE_AVX512_CPU_DEFINITION
+      , void *AVX512
+#endif
 #ifdef HAVE_VSX_CPU_DEFINITION
       , void *VSX
 #endif
@@ -95,6 +99,9 @@ struct TORCH_API DispatchStubImpl {
 #ifdef HAVE_AVX2_CPU_DEFINITION
     , void *AVX2
 #endif
+#ifdef HAVE_AVX512_CPU_DEFINITION
+    , void *AVX512
+#endif
 #ifdef HAVE_VSX_CPU_DEFINITION
     , void *VSX
 #endif
@@ -132,6 +139,9 @@ private:
 #ifdef HAVE_AVX2_CPU_DEFINITION
       , reinterpret_cast<void*>(AVX2)
 #endif
+#ifdef HAVE_AVX512_CPU_DEFINITION
+      , reinterpret_cast<void*>(AVX512)
+#endif
 #ifdef HAVE_VSX_CPU_DEFINITION
       , reinterpret_cast<void*>(VSX)
 #endif
@@ -161,6 +171,9 @@ public:
 #ifdef HAVE_AVX2_CPU_DEFINITION
   static FnPtr AVX2;
 #endif
+#ifdef HAVE_AVX512_CPU_DEFINITION
+  static FnPtr AVX512;
+#endif
 #ifdef HAVE_VSX_CPU_DEFINITION
   static FnPtr VSX;
 #endif
@@ -215,6 +228,12 @@ struct RegisterHIPDispatch {
 #define REGISTER_AVX2_DISPATCH(name, fn)
 #endif
 
+#ifdef HAVE_AVX512_CPU_DEFINITION
+#define REGISTER_AVX512_DISPATCH(name, fn) REGISTER_ARCH_DISPATCH(name, AVX512, fn)
+#else
+#define REGISTER_AVX512_DISPATCH(name, fn)
+#endif
+
 #ifdef HAVE_VSX_CPU_DEFINITION
 #define REGISTER_VSX_DISPATCH(name, fn) REGISTER_ARCH_DISPATCH(name, VSX, fn)
 #else
@@ -224,7 +243,8 @@ struct RegisterHIPDispatch {
 #define REGISTER_NO_CPU_DISPATCH(name, fn_type)                                \
   REGISTER_ARCH_DISPATCH(name, DEFAULT, static_cast<fn_type>(nullptr))         \
   REGISTER_AVX_DISPATCH(name, static_cast<fn_type>(nullptr))                   \
-  REGISTER_AVX2_DISPATCH(name, static_cast<fn_type>(nullptr))          \
+  REGISTER_AVX2_DISPATCH(name, static_cast<fn_type>(nullptr))                  \
+  REGISTER_AVX512_DISPATCH(name, static_cast<fn_type>(nullptr))                \
   REGISTER_VSX_DISPATCH(name, static_cast<fn_type>(nullptr))
 
 #define REGISTER_CUDA_DISPATCH(name, fn) \
@@ -17,10 +17,13 @@
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/DistributionTemplates.h>
 #include <ATen/NamedTensorUtils.h>
+#include <ATen/Parallel.h>
 #include <ATen/native/cpu/Loops.h>
 
 #include <type_traits>
 #include <functional>
+#include <tuple>
+#include <vector>
 #include <assert.h>
 #include <float.h>
 
@@ -119,6 +122,7 @@ DEFINE_DISPATCH(bernoulli_scalar_stub);
 DEFINE_DISPATCH(cauchy_stub);
 DEFINE_DISPATCH(exponential_stub);
 DEFINE_DISPATCH(multinomial_with_replacement_stub);
+DEFINE_DISPATCH(multinomial_alias_draw_stub);
 DEFINE_DISPATCH(geometric_stub);
 DEFINE_DISPATCH(log_normal_stub);
 DEFINE_DISPATCH(uniform_stub);
@@ -494,6 +498,117 @@ Tensor _s_dirichlet_cpu(const Tensor& alpha, c10::optional<Generator> gen) {
 /* The largest consecutive integer representable in float32 (2^24) */
 constexpr int64_t FLOAT32_MAX_CONSECUTIVE_INT = 1 << (FLT_MANT_DIG);
 
+// Note [Alias method for multinomial sampling]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Vose's alias method splits a distribution over K categories into K equally
+// likely columns. Column k keeps category k with probability q[k] and
+// otherwise yields its alias J[k]. Building the tables takes O(K) per row, and
+// every sample afterwards takes O(1): pick a column uniformly, then accept or
+// take the alias. _multinomial_alias_setup builds the tables once, so callers
+// that repeatedly sample from a fixed distribution (e.g. negative sampling)
+// skip the per call cumulative distribution and binary search of multinomial.
+// The tables are built on the CPU, where the algorithm is sequential per row,
+// and moved to the device of probs. Every sample of _multinomial_alias_draw
+// consumes two 32 bit Philox words, one for the column and one for the
+// acceptance test, so draws are parallel and independent of the thread count.
+
+// multinomial with replacement switches to the alias method on CPU from these
+// sizes on, where the table setup is amortized over the draws
+constexpr int64_t MULTINOMIAL_ALIAS_MIN_SAMPLES = 256;
+constexpr int64_t MULTINOMIAL_ALIAS_MIN_CATEGORIES = 32;
+
+template <typename scalar_t, typename prob_t>
+static void multinomial_alias_setup_row(
+    const scalar_t* probs, int64_t stride, int64_t n_categories, int64_t* J, prob_t* q) {
+  std::vector<double> scaled(n_categories);
+  double sum = 0;
+  for (int64_t k = 0; k < n_categories; k++) {
+    const double val = static_cast<double>(probs[k * stride]);
+    TORCH_CHECK(val >= 0, "invalid multinomial distribution (encountering probability entry < 0)");
+    TORCH_CHECK(std::isfinite(val),
+                "invalid multinomial distribution (encountering probability entry = infinity or NaN)");
+    scaled[k] = val;
+    sum += val;
+  }
+  TORCH_CHECK(sum > 0, "invalid multinomial distribution (sum of probabilities <= 0)");
+
+  std::vector<int64_t> small, large;
+  for (int64_t k = 0; k < n_categories; k++) {
+    scaled[k] = scaled[k] * n_categories / sum;
+    (scaled[k] < 1 ? small : large).push_back(k);
+  }
+  while (!small.empty() && !large.empty()) {
+    const int64_t s = small.back();
+    const int64_t l = large.back();
+    small.pop_back();
+    large.pop_back();
+    q[s] = static_cast<prob_t>(scaled[s]);
+    J[s] = l;
+    scaled[l] = (scaled[l] + scaled[s]) - 1;
+    (scaled[l] < 1 ? small : large).push_back(l);
+  }
+  // Whatever is left is 1 up to rounding
+  auto keep_all = [&](const std::vector<int64_t>& remaining) {
+    for (const int64_t k : remaining) {
+      q[k] = 1;
+      J[k] = k;
+    }
+  };
+  keep_all(small);
+  keep_all(large);
+}
+
+std::tuple<Tensor, Tensor> _multinomial_alias_setup(const Tensor& probs) {
+  TORCH_CHECK(probs.dim() == 1 || probs.dim() == 2, "_multinomial_alias_setup: probs must be 1 or 2 dim");
+  TORCH_CHECK(at::isFloatingType(probs.scalar_type()),
+              "_multinomial_alias_setup only supports floating-point dtypes for probs, got: ", probs.scalar_type());
+  const int64_t n_categories = probs.size(-1);
+  TORCH_CHECK(n_categories > 0, "_multinomial_alias_setup: probs must have at least one category");
+  TORCH_CHECK(n_categories <= FLOAT32_MAX_CONSECUTIVE_INT, "number of categories cannot exceed 2^24");
+
+  const auto probs_cpu = probs.to(kCPU).contiguous();
+  const auto prob_type = probs.scalar_type() == kDouble ? kDouble : kFloat;
+  Tensor J = at::empty(probs.sizes(), probs_cpu.options().dtype(kLong));
+  Tensor q = at::empty(probs.sizes(), probs_cpu.options().dtype(prob_type));
+  const int64_t n_dist = probs.dim() == 1 ? 1 : probs.size(0);
+
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(probs.scalar_type(), "_multinomial_alias_setup", [&] {
+    const scalar_t* probs_data = probs_cpu.data_ptr<scalar_t>();
+    int64_t* J_data = J.data_ptr<int64_t>();
+    AT_DISPATCH_FLOATING_TYPES(prob_type, "_multinomial_alias_setup", [&] {
+      using prob_t = scalar_t;
+      prob_t* q_data = q.data_ptr<prob_t>();
+      at::parallel_for(0, n_dist, internal::GRAIN_SIZE / n_categories + 1, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          multinomial_alias_setup_row(
+              probs_data + i * n_categories, 1, n_categories, J_data + i * n_categories, q_data + i * n_categories);
+        }
+      });
+    });
+  });
+  return std::make_tuple(J.to(probs.device()), q.to(probs.device()));
+}
+
+Tensor _multinomial_alias_draw(const Tensor& J, const Tensor& q, int64_t num_samples, c10::optional<Generator> gen) {
+  TORCH_CHECK(J.dim() == 1 || J.dim() == 2, "_multinomial_alias_draw: J must be 1 or 2 dim");
+  TORCH_CHECK(J.sizes() == q.sizes(), "_multinomial_alias_draw: J and q must have the same shape, got ",
+              J.sizes(), " and ", q.sizes());
+  TORCH_CHECK(J.scalar_type() == kLong, "_multinomial_alias_draw: expected J to be a Long tensor, got: ",
+              J.scalar_type());
+  TORCH_CHECK(q.scalar_type() == kFloat || q.scalar_type() == kDouble,
+              "_multinomial_alias_draw: expected q to be a Float or Double tensor, got: ", q.scalar_type());
+  TORCH_CHECK(J.device() == q.device(), "_multinomial_alias_draw: J and q must be on the same device");
+  TORCH_CHECK(num_samples > 0, "cannot sample n_sample <= 0 samples");
+  TORCH_CHECK(J.size(-1) > 0, "_multinomial_alias_draw: J must have at least one category");
+
+  Tensor result = J.dim() == 1 ? at::empty({num_samples}, J.options())
+                               : at::empty({J.size(0), num_samples}, J.options());
+  if (result.numel() > 0) {
+    multinomial_alias_draw_stub(J.device().type(), result, J.contiguous(), q.contiguous(), gen);
+  }
+  return result;
+}
+
 Tensor& multinomial_out(const Tensor& self,
     int64_t n_sample,
     bool with_replacement,
@@ -576,6 +691,15 @@ Tensor& multinomial_out(const Tensor& self,
     return result;
   }
 
+  // See Note [Alias method for multinomial sampling]
+  if (self.device().is_cpu() && n_sample >= MULTINOMIAL_ALIAS_MIN_SAMPLES &&
+      n_categories >= MULTINOMIAL_ALIAS_MIN_CATEGORIES) {
+    Tensor J, q;
+    std::tie(J, q) = at::_multinomial_alias_setup(self);
+    multinomial_alias_draw_stub(kCPU, result, J, q, gen);
+    return result;
+  }
+
   multinomial_with_replacement_stub(
       result.device().type(), result, self, n_sample, gen);
   return result;
@@ -6,6 +6,7 @@
 
 #include <ATen/native/CPUBlas.h>
 
+#include <c10/util/flat_hash_map.h>
 #include <c10/util/irange.h>
 
 #ifdef USE_FBGEMM
@@ -20,6 +21,7 @@
 #include <memory>
 #include <sstream>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 
 
@@ -44,6 +46,7 @@ static void make_offset2bag(const Tensor &offsets, Tensor& offset2bag) {
 
 namespace {
 
+#ifdef USE_FBGEMM
 bool is_fast_path_index_select(const Tensor& src, Tensor& output) {
   return src.scalar_type() == kFloat && src.strides()[1] == 1 && output.strides()[1] == 1;
 }
@@ -58,259 +61,294 @@ bool is_fast_path(const Tensor& src, const c10::optional<Tensor>& scale, Tensor&
          is_fast_path_index_select(src, output);
 }
 
-// This function combines index_select (using select_indices as the index) and
-// index_add (using add_indices as the index), without creating an intermediary
-// tensor to hold the selected embeddings
-template<typename data_t, typename index_t>
-typename std::enable_if<!std::is_same<data_t, float>::value, void>::type
-index_select_add(const Tensor &select_indices,
-                             const Tensor &add_indices,
-                             const Tensor &src,
-                             Tensor &output,
-                             const Tensor& /*offsets*/,
-                             bool /*include_last_offset*/) {
-  TORCH_CHECK(select_indices.numel() == add_indices.numel());
-  auto* add_indices_data = add_indices.data_ptr<index_t>();
-  auto* select_indices_data = select_indices.data_ptr<index_t>();
-  auto* src_data = src.data_ptr<data_t>();
-  auto* output_data = output.data_ptr<data_t>();
-  auto numel = add_indices.numel();
-  int64_t ddim = src.sizes()[1];
-  auto src_stride0 = src.strides()[0];
-  auto src_stride1 = src.strides()[1];
-  auto output_stride0 = output.strides()[0];
-  auto output_stride1 = output.strides()[1];
-
-  for (int64_t i = 0; i < numel; i++) {
-    at::native::cpublas::axpy<data_t>(ddim, 1,
-            src_data + src_stride0 * select_indices_data[i], src_stride1,
-            output_data + output_stride0 * add_indices_data[i], output_stride1);
-  }
-}
-
-template<typename data_t, typename index_t>
-typename std::enable_if<std::is_same<data_t, float>::value, void>::type
-index_select_add(const Tensor &select_indices,
-                             const Tensor &add_indices,
-                             const Tensor &src,
-                             Tensor &output,
-                             const Tensor& offsets,
-                             bool include_last_offset) {
+// fbgemm's JIT-generated kernels are still used for float sum and mean bags
+// with contiguous rows; see Note [Fused embedding_bag forward on CPU] for
+// everything else.
+template<typename index_t>
+void embedding_bag_fbgemm_out(
+    const Tensor& src,
+    const index_t* select_indices_data,
+    const index_t* offsets_data,
+    int64_t output_size,
+    const float* scale_data,
+    bool normalize_by_lengths,
+    Tensor& output) {
   int64_t ddim = src.sizes()[1];
-  auto* select_indices_data = select_indices.data_ptr<index_t>();
+  auto src_contig = src.contiguous();
+  auto* src_data = src_contig.data_ptr<float>();
   auto* output_data = output.data_ptr<float>();
 
-  if (is_fast_path_index_select(src, output)) {
-    auto src_contig = src.contiguous();
-    auto* src_data = src_contig.data_ptr<float>();
-    int64_t output_size = offsets.numel() - 1;
-    auto* offsets_data = offsets.data_ptr<index_t>();
-    std::vector<index_t> offsets_include_last;
+  auto kernel_fp32_index_t =
+    fbgemm::GenerateEmbeddingSpMDM<float, index_t, index_t>(
+      /* block_size */ddim,
+      /* has_weight */scale_data != nullptr,
+      /* normalize_by_lengths */normalize_by_lengths,
+      /* prefetch */16,
+      /* is_weight_positional */false,
+      /* use_offsets */true
+    );
+  at::parallel_for(
+      0, output_size, 1, [&](int64_t start_idx, int64_t end_idx) {
+        bool success = kernel_fp32_index_t(
+          /* output_size */end_idx - start_idx,
+          /* index_size */offsets_data[end_idx] - offsets_data[start_idx],
+          /* data_size */src.sizes()[0],
+          /* input */src_data,
+          /* indices */select_indices_data + offsets_data[start_idx],
+          /* offsets_or_lengths */offsets_data + start_idx,
+          /* weights */scale_data ? scale_data + offsets_data[start_idx] : nullptr,
+          /* output */output_data + start_idx * ddim);
+        TORCH_CHECK(success, "embedding_bag: an index is out of bounds for weight with ",
+                    src.sizes()[0], " rows");
+      });
+}
+#endif
 
-    if (include_last_offset) {
-      output_size = offsets.numel() - 1;
-    } else {
-      output_size = offsets.numel();
-      offsets_include_last.resize(offsets.numel() + 1);
-      std::memcpy(
-          offsets_include_last.data(),
-          offsets.data_ptr<index_t>(),
-          sizeof(index_t) * offsets.numel());
-      offsets_include_last[offsets.numel()] = select_indices.numel();
-      offsets_data = offsets_include_last.data();
-    }
+// Note [Fused embedding_bag forward on CPU]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// embedding_bag_cpu_fused_out computes sum, mean and max bags, with or without
+// per_sample_weights, straight from `offsets`: the rows of each bag are
+// reduced into a per-thread accumulator (float for Half and BFloat16 weights)
+// and written to `output` once, so neither offset2bag nor a zero-filled output
+// is needed. While one row is accumulated, the row kEmbeddingBagPrefetch
+// lookups ahead is prefetched.
+//
+// Bags are split between threads by cost rather than by count. `offsets` is
+// already the running total of bag lengths, so chunks with roughly equal
+// numbers of looked-up rows (plus kEmbeddingBagCostPerBag per bag) are found
+// by binary search, which keeps skewed bag lengths from serializing on one
+// thread.
+constexpr int64_t kEmbeddingBagPrefetch = 16;
+constexpr int64_t kEmbeddingBagCostPerBag = 2;
+constexpr int64_t kEmbeddingBagTasksPerThread = 4;
+
+template <typename data_t>
+struct EmbeddingBagAccType {
+  using type = float;
+};
 
-#ifdef USE_FBGEMM
-    auto kernel_fp32_index_t =
-      fbgemm::GenerateEmbeddingSpMDM<float, index_t, index_t>(
-        /* block_size */ddim,
-        /* has_weight */false,
-        /* normalize_by_lengths */false,
-        /* prefetch */16,
-        /* is_weight_positional */false,
-        /* use_offsets */true
-      );
-#endif
-    at::parallel_for(
-        0, output_size, 1, [&](index_t start_idx, index_t end_idx) {
-#ifdef USE_FBGEMM
-          kernel_fp32_index_t(
-            /* output_size */end_idx - start_idx,
-            /* index_size */offsets_data[end_idx] - offsets_data[start_idx],
-            /* data_size */src.sizes()[0],
-            /* input */src_data,
-            /* indices */select_indices_data + offsets_data[start_idx],
-            /* offsets_or_lengths */offsets_data + start_idx,
-            /* weights */nullptr,
-            /* output */output_data + start_idx * ddim);
-#else
-          caffe2::EmbeddingLookupIdx(
-              /*block_size=*/ddim,
-              /*output_size=*/end_idx - start_idx,
-              /*index_size=*/offsets_data[end_idx] - offsets_data[start_idx],
-              /*data_size=*/src.sizes()[0],
-              /*input=*/src_data,
-              /*indices=*/select_indices_data + offsets_data[start_idx],
-              /*offsets=*/offsets_data + start_idx,
-              /*weights=*/nullptr,
-              /*scale_bias=*/nullptr,
-              /*normalize_by_lengths=*/false,
-              /*out=*/output_data + start_idx * ddim);
+template <>
+struct EmbeddingBagAccType<double> {
+  using type = double;
+};
+
+inline void embedding_bag_prefetch_row(const char* row, int64_t row_bytes) {
+#if defined(__GNUC__) || defined(__clang__)
+  for (int64_t offset = 0; offset < row_bytes; offset += 64) {
+    __builtin_prefetch(row + offset);
+  }
 #endif
-        });
-  } else {
-    AT_ASSERT(select_indices.numel() == add_indices.numel());
-    auto* src_data = src.data_ptr<float>();
-    auto* add_indices_data = add_indices.data_ptr<index_t>();
-    auto src_stride0 = src.strides()[0];
-    auto src_stride1 = src.strides()[1];
-    auto output_stride0 = output.strides()[0];
-    auto output_stride1 = output.strides()[1];
-    auto numel = add_indices.numel();
-    for (int64_t i = 0; i < numel; i++) {
-      at::native::cpublas::axpy<float>(
-          ddim,
-          1,
-          src_data + src_stride0 * select_indices_data[i],
-          src_stride1,
-          output_data + output_stride0 * add_indices_data[i],
-          output_stride1);
+}
+
+// Splits the bags into tasks of equal cost, see the note above. Returns the
+// first bag of every task followed by num_bags.
+template <typename index_t>
+std::vector<int64_t> embedding_bag_task_boundaries(
+    const index_t* offsets_data,
+    int64_t num_bags) {
+  const int64_t num_tasks = std::max<int64_t>(1,
+      std::min(num_bags, at::get_num_threads() * kEmbeddingBagTasksPerThread));
+  const int64_t total_cost = offsets_data[num_bags] + num_bags * kEmbeddingBagCostPerBag;
+  std::vector<int64_t> task_begin(num_tasks + 1, num_bags);
+  task_begin[0] = 0;
+  for (int64_t t = 1; t < num_tasks; t++) {
+    const int64_t target = total_cost * t / num_tasks;
+    int64_t lo = task_begin[t - 1], hi = num_bags;
+    while (lo < hi) {
+      const int64_t mid = lo + (hi - lo) / 2;
+      if (offsets_data[mid] + mid * kEmbeddingBagCostPerBag < target) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
     }
+    task_begin[t] = lo;
   }
+  return task_begin;
 }
 
-// This function fuses the following three fns:
-// index_select (using select_indices as the index)
-// mul (scaling by per_sample_weights)
-// index_add (using add_indices as the index)
-template<typename data_t, typename index_t>
-static typename std::enable_if<!std::is_same<data_t, float>::value, void>::type
-index_select_scale_add(const Tensor &select_indices,
-                                   const Tensor &add_indices,
-                                   const Tensor &scale,
-                                   const Tensor &src,
-                                   Tensor &output,
-                                   const Tensor& /*offsets*/,
-                                   bool /*include_last_offset*/) {
-  AT_ASSERT(select_indices.numel() == add_indices.numel());
-  auto* add_indices_data = add_indices.data_ptr<index_t>();
-  auto* select_indices_data = select_indices.data_ptr<index_t>();
-  auto* src_data = src.data_ptr<data_t>();
+// `offsets_data` holds num_bags + 1 entries, the last one being the number of
+// indices. `per_sample_weights` may be undefined; `max_indices` is only used
+// in MODE_MAX.
+template <typename data_t, typename index_t>
+void embedding_bag_cpu_fused_out(
+    Tensor& output,
+    Tensor& max_indices,
+    const Tensor& weight,
+    const Tensor& indices,
+    const index_t* offsets_data,
+    int64_t num_bags,
+    const int64_t mode,
+    const Tensor& per_sample_weights) {
+  using acc_t = typename EmbeddingBagAccType<data_t>::type;
+  const int64_t num_weights = weight.sizes()[0];
+  const int64_t ddim = weight.sizes()[1];
+  const int64_t num_indices = offsets_data[num_bags];
+  const auto* weight_data = weight.data_ptr<data_t>();
+  const auto weight_stride0 = weight.strides()[0];
+  const auto weight_stride1 = weight.strides()[1];
+  const auto* indices_data = indices.data_ptr<index_t>();
   auto* output_data = output.data_ptr<data_t>();
-  auto numel = add_indices.numel();
-  int64_t ddim = src.sizes()[1];
-  auto src_stride0 = src.strides()[0];
-  auto src_stride1 = src.strides()[1];
-  auto output_stride0 = output.strides()[0];
-  auto output_stride1 = output.strides()[1];
-
-  auto* scale_data = scale.data_ptr<data_t>();
-  auto scale_stride = scale.strides()[0];
-
-  for (int64_t i = 0; i < numel; i++) {
-    auto* src_base = src_data + src_stride0 * select_indices_data[i];
-    auto* output_base = output_data + output_stride0 * add_indices_data[i];
-    auto scale = scale_data[i * scale_stride];
-    for (int64_t j = 0; j < ddim; j++) {
-      output_base[j * output_stride1] += src_base[j * src_stride1] * scale;
+  const auto output_stride0 = output.strides()[0];
+  const auto output_stride1 = output.strides()[1];
+
+  const data_t* scale_data = nullptr;
+  int64_t scale_stride = 0;
+  if (per_sample_weights.defined()) {
+    scale_data = per_sample_weights.data_ptr<data_t>();
+    scale_stride = per_sample_weights.strides()[0];
+  }
+  index_t* max_indices_data = nullptr;
+  int64_t max_indices_stride = 0;
+  if (mode == MODE_MAX) {
+    max_indices_data = max_indices.data_ptr<index_t>();
+    max_indices_stride = max_indices.strides()[0];
+  }
+
+  const auto task_begin = embedding_bag_task_boundaries(offsets_data, num_bags);
+  const int64_t num_tasks = task_begin.size() - 1;
+
+  at::parallel_for(0, num_tasks, 1, [&](int64_t task_start, int64_t task_end) {
+    std::vector<acc_t> acc(ddim);
+    for (int64_t bag = task_begin[task_start]; bag < task_begin[task_end]; bag++) {
+      const int64_t start = offsets_data[bag];
+      const int64_t end = offsets_data[bag + 1];
+      TORCH_CHECK(start <= end, "embedding_bag: offsets must be non-decreasing, but got offsets[",
+                  bag, "] = ", start, " > offsets[", bag + 1, "] = ", end);
+      std::fill(acc.begin(), acc.end(), acc_t(0));
+      auto* output_row = output_data + bag * output_stride0;
+      index_t* max_indices_row = max_indices_data ?
+          max_indices_data + bag * max_indices_stride : nullptr;
+
+      for (int64_t i = start; i < end; i++) {
+        if (weight_stride1 == 1 && i + kEmbeddingBagPrefetch < num_indices) {
+          const index_t next = indices_data[i + kEmbeddingBagPrefetch];
+          if (next >= 0 && next < num_weights) {
+            embedding_bag_prefetch_row(
+                reinterpret_cast<const char*>(weight_data + next * weight_stride0),
+                ddim * sizeof(data_t));
+          }
+        }
+        const index_t idx = indices_data[i];
+        TORCH_CHECK(idx >= 0 && idx < num_weights,
+                    "embedding_bag: index ", idx, " is out of bounds for weight with ",
+                    num_weights, " rows");
+        const auto* weight_row = weight_data + idx * weight_stride0;
+
+        if (mode == MODE_MAX) {
+          for (int64_t d = 0; d < ddim; d++) {
+            const acc_t value = static_cast<acc_t>(weight_row[d * weight_stride1]);
+            if (i == start || value > acc[d]) {
+              acc[d] = value;
+              max_indices_row[d] = idx;
+            }
+          }
+        } else {
+          const acc_t scale = scale_data ?
+              static_cast<acc_t>(scale_data[i * scale_stride]) : acc_t(1);
+          if (weight_stride1 == 1) {
+            for (int64_t d = 0; d < ddim; d++) {
+              acc[d] += scale * static_cast<acc_t>(weight_row[d]);
+            }
+          } else {
+            for (int64_t d = 0; d < ddim; d++) {
+              acc[d] += scale * static_cast<acc_t>(weight_row[d * weight_stride1]);
+            }
+          }
+        }
+      }
+
+      if (mode == MODE_MAX && start == end) {
+        std::fill(max_indices_row, max_indices_row + ddim, index_t(0));
+      }
+      // Empty bags are all zeros in every mode
+      const acc_t inv_bag_size = (mode == MODE_MEAN && end > start) ?
+          acc_t(1) / static_cast<acc_t>(end - start) : acc_t(1);
+      for (int64_t d = 0; d < ddim; d++) {
+        output_row[d * output_stride1] = static_cast<data_t>(acc[d] * inv_bag_size);
+      }
     }
+  });
+}
+
+#ifndef USE_FBGEMM
+// Without fbgemm, float and Half sum and mean bags over contiguous rows use
+// caffe2's EmbeddingLookupIdx kernels, generated by
+// caffe2/perfkernels/hp_emblookup_codegen.py: they unroll over the embedding
+// dimension and prefetch upcoming rows with AVX2 + FMA, and fall back to a
+// generic loop on other CPUs. They only write float, so Half bags are staged
+// through a float buffer.
+bool is_perfkernel_path(
+    const Tensor& weight,
+    const Tensor& per_sample_weights,
+    const Tensor& output,
+    const int64_t mode) {
+  if (mode == MODE_MAX) {
+    return false;
+  }
+  if (weight.scalar_type() != kFloat && weight.scalar_type() != kHalf) {
+    return false;
+  }
+  if (!weight.is_contiguous() || !output.is_contiguous()) {
+    return false;
   }
+  return !per_sample_weights.defined() ||
+      (per_sample_weights.scalar_type() == kFloat && per_sample_weights.is_contiguous());
 }
 
-template<typename data_t, typename index_t>
-typename std::enable_if<std::is_same<data_t, float>::value, void>::type
-index_select_scale_add(const Tensor &select_indices,
-                                          const Tensor &add_indices,
-                                          const Tensor &scale,
-                                          const Tensor &src,
-                                          Tensor &output,
-                                          const Tensor& offsets,
-                                          bool include_last_offset) {
-  int64_t ddim = src.sizes()[1];
-  auto* scale_data = scale.data_ptr<float>();
-  auto* select_indices_data = select_indices.data_ptr<index_t>();
-  auto* output_data = output.data_ptr<float>();
+template <typename data_t, typename index_t>
+void embedding_bag_perfkernel_out(
+    Tensor& output,
+    const Tensor& weight,
+    const Tensor& indices,
+    const index_t* offsets_data,
+    int64_t num_bags,
+    const int64_t mode,
+    const Tensor& per_sample_weights) {
+  const int64_t num_weights = weight.sizes()[0];
+  const int64_t ddim = weight.sizes()[1];
+  const auto* weight_data = weight.data_ptr<data_t>();
+  const auto* indices_data = indices.data_ptr<index_t>();
+  const float* scale_data =
+      per_sample_weights.defined() ? per_sample_weights.data_ptr<float>() : nullptr;
+  auto* output_data = output.data_ptr<data_t>();
 
-  if (is_fast_path_index_select_scale(src, scale, output)) {
-    auto src_contig = src.contiguous();
-    auto* src_data = src_contig.data_ptr<float>();
-    int64_t output_size = offsets.numel() - 1;
-    auto* offsets_data = offsets.data_ptr<index_t>();
-    std::vector<index_t> offsets_include_last;
+  const auto task_begin = embedding_bag_task_boundaries(offsets_data, num_bags);
+  const int64_t num_tasks = task_begin.size() - 1;
 
-    if (include_last_offset) {
-      output_size = offsets.numel() - 1;
+  at::parallel_for(0, num_tasks, 1, [&](int64_t task_start, int64_t task_end) {
+    const int64_t bag_start = task_begin[task_start];
+    const int64_t bag_end = task_begin[task_end];
+    if (bag_start == bag_end) {
+      return;
+    }
+    const int64_t index_start = offsets_data[bag_start];
+    std::vector<float> staging;
+    float* out;
+    if (std::is_same<data_t, float>::value) {
+      out = reinterpret_cast<float*>(output_data + bag_start * ddim);
     } else {
-      output_size = offsets.numel();
-      offsets_include_last.resize(offsets.numel() + 1);
-      std::memcpy(
-          offsets_include_last.data(),
-          offsets.data_ptr<index_t>(),
-          sizeof(index_t) * offsets.numel());
-      offsets_include_last[offsets.numel()] = select_indices.numel();
-      offsets_data = offsets_include_last.data();
+      staging.resize((bag_end - bag_start) * ddim);
+      out = staging.data();
     }
-
-#ifdef USE_FBGEMM
-    auto kernel_fp32_index_t =
-      fbgemm::GenerateEmbeddingSpMDM<float, index_t, index_t>(
-        /* block_size */ddim,
-        /* has_weight */true,
-        /* normalize_by_lengths */false,
-        /* prefetch */16,
-        /* is_weight_positional */false,
-        /* use_offsets */true
-      );
-#endif
-    at::parallel_for(
-        0, output_size, 1, [&](index_t start_idx, index_t end_idx) {
-#ifdef USE_FBGEMM
-          kernel_fp32_index_t(
-            /* output_size */end_idx - start_idx,
-            /* index_size */offsets_data[end_idx] - offsets_data[start_idx],
-            /* data_size */src.sizes()[0],
-            /* input */src_data,
-            /* indices */select_indices_data + offsets_data[start_idx],
-            /* offsets_or_lengths */offsets_data + start_idx,
-            /* weights */scale_data + offsets_data[start_idx],
-            /* output */output_data + start_idx * ddim);
-#else
-          caffe2::EmbeddingLookupIdx(
-              /*block_size=*/ddim,
-              /*output_size=*/end_idx - start_idx,
-              /*index_size=*/offsets_data[end_idx] - offsets_data[start_idx],
-              /*data_size=*/src.sizes()[0],
-              /*input=*/src_data,
-              /*indices=*/select_indices_data + offsets_data[start_idx],
-              /*offsets=*/offsets_data + start_idx,
-              /*weights=*/scale_data + offsets_data[start_idx],
-              /*scale_bias=*/nullptr,
-              /*normalize_by_lengths=*/false,
-              /*out=*/output_data + start_idx * ddim);
-#endif
-        });
-  } else {
-    AT_ASSERT(select_indices.numel() == add_indices.numel());
-    auto* src_data = src.data_ptr<float>();
-    auto* add_indices_data = add_indices.data_ptr<index_t>();
-    auto src_stride0 = src.strides()[0];
-    auto src_stride1 = src.strides()[1];
-    auto output_stride0 = output.strides()[0];
-    auto output_stride1 = output.strides()[1];
-    auto scale_stride = scale.strides()[0];
-    auto numel = add_indices.numel();
-
-
-    for (int64_t i = 0; i < numel; i++) {
-      auto* src_base = src_data + src_stride0 * select_indices_data[i];
-      auto* output_base = output_data + output_stride0 * add_indices_data[i];
-      auto scale = scale_data[i * scale_stride];
-      for (int64_t j = 0; j < ddim; j++) {
-        output_base[j * output_stride1] += src_base[j * src_stride1] * scale;
-      }
+    caffe2::EmbeddingLookupIdx(
+        /*block_size=*/ddim,
+        /*output_size=*/bag_end - bag_start,
+        /*index_size=*/offsets_data[bag_end] - index_start,
+        /*data_size=*/num_weights,
+        /*input=*/weight_data,
+        /*indices=*/indices_data + index_start,
+        /*offsets=*/offsets_data + bag_start,
+        /*weights=*/scale_data ? scale_data + index_start : nullptr,
+        /*scale_bias=*/nullptr,
+        /*normalize_by_lengths=*/mode == MODE_MEAN,
+        /*out=*/out);
+    if (!staging.empty()) {
+      std::copy(staging.begin(), staging.end(), output_data + bag_start * ddim);
     }
-  }
+  });
 }
+#endif
 
 void make_bag_size_out(
     Tensor& bag_size_out,
@@ -349,7 +387,7 @@ void check_arguments(
   checkScalarTypes("embedding_bag", offsets_arg, {kLong, kInt});
   checkSameType("embedding_bag", indices_arg, offsets_arg);
   auto weight_arg = TensorArg(weight, "weight", 1);
-  checkScalarTypes("embedding_bag", weight_arg, {kFloat, kDouble});
+  checkScalarTypes("embedding_bag", weight_arg, {kHalf, kBFloat16, kFloat, kDouble});
 
   AT_DISPATCH_INDEX_TYPES(offsets.scalar_type(), "_embedding_bag_cpu_impl", [&]() {
     TORCH_CHECK(offsets.sizes()[0] >= 1, "offsets should have at least 1 element");
@@ -419,27 +457,16 @@ void make_max_indices_out(
 
 void make_offset2bag_out(
     Tensor& offset2bag,
-    Tensor& output,
-    const Tensor& weight,
-    const Tensor& indices,
-    const Tensor& offsets,
-    const int64_t mode,
-    const c10::optional<Tensor>& per_sample_weights) {
-  // To save compute, if we are going to go down the fast path case for the 'sum'
-  // mode, we skip calculating offset2bag, since it is not going to be used.
-  bool fast_path_sum = is_fast_path(weight, per_sample_weights, output);
-
-  if (mode == MODE_MEAN || mode == MODE_MAX || !fast_path_sum) {
-    at::native::resize_(offset2bag, {indices.sizes()[0] + 1}, c10::nullopt);
-    at::native::zero_(offset2bag);
-  }
-
-  if (mode == MODE_MEAN || mode == MODE_MAX || !fast_path_sum) {
-    make_offset2bag(offsets, offset2bag);
-    at::native::resize_(offset2bag, {indices.sizes()[0]}, c10::nullopt);
-    // only initialize output in slow path
-    at::native::zero_(output);
-  }
+    Tensor& /*output*/,
+    const Tensor& /*weight*/,
+    const Tensor& /*indices*/,
+    const Tensor& /*offsets*/,
+    const int64_t /*mode*/,
+    const c10::optional<Tensor>& /*per_sample_weights*/) {
+  // None of the forward kernels read offset2bag, so it is left empty; the
+  // backward functions build it from `offsets` when they get an empty one.
+  // See Note [Fused embedding_bag forward on CPU].
+  at::native::resize_(offset2bag, {0}, c10::nullopt);
 }
 
 static Tensor make_bag_size(
@@ -477,26 +504,6 @@ static Tensor make_offset2bag(
   return offset2bag;
 }
 
-static Tensor apply_bag_size(const Tensor &offsets, const Tensor &indices,
-                             const int64_t mode, Tensor &output,
-                             const Tensor &bag_size) {
-  if (mode == MODE_MEAN) {
-    // Avoid dividing by 0 for empty bags.
-    // Instead we want empty bags to return all 0s
-    if (offsets.sizes()[0] == 1) {
-      auto bag_size_ = std::max(indices.sizes()[0], static_cast<int64_t>(1));
-      output /= bag_size_;
-    } else {
-      auto bag_size_ = at::max(bag_size, at::ones_like(bag_size, LEGACY_CONTIGUOUS_MEMORY_FORMAT))
-                           .to(output.options())
-                           .unsqueeze(1)
-                           .expand_as(output);
-      output /= bag_size_;
-    }
-  }
-  return output;
-}
-
 static Tensor apply_bag_size_backward(const Tensor &offsets,
                                       const Tensor &indices, const int64_t mode,
                                       Tensor &output, const Tensor &offset2bag,
@@ -515,77 +522,63 @@ static Tensor apply_bag_size_backward(const Tensor &offsets,
   return output;
 }
 
-template <typename scalar_t>
-void embedding_bag_cpu_max_out(
-    Tensor& max_indices,
-    const Tensor& weight,
-    const Tensor& indices,
-    const Tensor& offset2bag,
-    const Tensor& output,
-    const Tensor& bag_size) {
-  int64_t numIndices = indices.numel();
-  int64_t featureSize = weight.sizes()[1];
-  AT_DISPATCH_INDEX_TYPES(indices.scalar_type(), "embedding_bag_cpu_max_out", [&] {
-    auto* indices_data = indices.data_ptr<index_t>();
-    auto* offset2bag_data = offset2bag.data_ptr<index_t>();
-
-    auto* max_indices_data = max_indices.data_ptr<index_t>();
-    auto max_indices_stride = max_indices.strides()[0];
-
-    auto* weight_data = weight.data_ptr<scalar_t>();
-    auto* output_data = output.data_ptr<scalar_t>();
-    auto weight_stride0 = weight.strides()[0];
-    auto weight_stride1 = weight.strides()[1];
-    auto output_stride = output.strides()[0];
-
-    for (const auto i : c10::irange(numIndices)) {
-      auto bag = offset2bag_data[i];
-      auto word_idx = indices_data[i];
-
-      for (const auto dim : c10::irange(featureSize)) {
-        auto& current_item = output_data[output_stride * bag + dim];
-        auto weight_item =
-            weight_data[weight_stride0 * word_idx + dim * weight_stride1];
-        bool is_first_for_bag = (i == 0) || offset2bag_data[i - 1] != bag;
-
-        if (is_first_for_bag || weight_item > current_item) {
-          current_item = weight_item;
-          max_indices_data[max_indices_stride * bag + dim] = word_idx;
-        }
-      }
-    }
-  });
-}
-
 void _embedding_bag_cpu_impl_out(Tensor& output, Tensor& offset2bag,
                             Tensor& bag_size, Tensor& max_indices,
                             const Tensor &weight, const Tensor &indices,
                             const Tensor &offsets, const int64_t mode,
                             const c10::optional<Tensor>& per_sample_weights,
                             bool include_last_offset) {
-  if (mode == MODE_MEAN || mode == MODE_SUM) {
-    AT_DISPATCH_FLOATING_TYPES(weight.scalar_type(), "embedding_bag_no_grad_cpu_out",
-      [&indices, &offset2bag, &per_sample_weights, &weight, &output, &offsets, &include_last_offset, &mode]() {
-      AT_DISPATCH_INDEX_TYPES(indices.scalar_type(), "embedding_bag_no_grad_cpu_out",
-        [&indices, &offset2bag, &per_sample_weights, &weight, &output, &offsets, &include_last_offset, &mode]() {
-        if (per_sample_weights.has_value() && per_sample_weights.value().defined()) {
-          TORCH_INTERNAL_ASSERT(mode == MODE_SUM);
-          index_select_scale_add<scalar_t, index_t>(
-          indices, offset2bag, per_sample_weights.value(), weight, output, offsets, include_last_offset);
-        } else {
-          index_select_add<scalar_t, index_t>(indices, offset2bag, weight, output, offsets, include_last_offset);
-        }
+  const bool has_per_sample_weights =
+      per_sample_weights.has_value() && per_sample_weights.value().defined();
+  TORCH_INTERNAL_ASSERT(mode == MODE_SUM || !has_per_sample_weights);
+
+  AT_DISPATCH_INDEX_TYPES(indices.scalar_type(), "embedding_bag_cpu_out", [&] {
+    // Both kernels expect num_bags + 1 offsets
+    const index_t* offsets_data = offsets.data_ptr<index_t>();
+    int64_t num_bags = offsets.numel();
+    std::vector<index_t> offsets_include_last;
+    if (include_last_offset) {
+      num_bags -= 1;
+    } else {
+      offsets_include_last.resize(offsets.numel() + 1);
+      std::memcpy(
+          offsets_include_last.data(), offsets_data, sizeof(index_t) * offsets.numel());
+      offsets_include_last[offsets.numel()] = indices.numel();
+      offsets_data = offsets_include_last.data();
+    }
+
+#ifdef USE_FBGEMM
+    if (mode != MODE_MAX && is_fast_path(weight, per_sample_weights, output)) {
+      embedding_bag_fbgemm_out<index_t>(
+          weight, indices.data_ptr<index_t>(), offsets_data, num_bags,
+          has_per_sample_weights ? per_sample_weights.value().data_ptr<float>() : nullptr,
+          /*normalize_by_lengths=*/mode == MODE_MEAN, output);
+      return;
+    }
+#else
+    const Tensor scale = has_per_sample_weights ? per_sample_weights.value() : Tensor();
+    if (is_perfkernel_path(weight, scale, output, mode)) {
+      if (weight.scalar_type() == kFloat) {
+        embedding_bag_perfkernel_out<float, index_t>(
+            output, weight, indices, offsets_data, num_bags, mode, scale);
+      } else {
+        embedding_bag_perfkernel_out<at::Half, index_t>(
+            output, weight, indices, offsets_data, num_bags, mode, scale);
+      }
+      return;
+    }
+#endif
+
+    AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16,
+      weight.scalar_type(), "embedding_bag_cpu_out", [&] {
+        embedding_bag_cpu_fused_out<scalar_t, index_t>(
+            output, max_indices, weight, indices, offsets_data, num_bags, mode,
+            has_per_sample_weights ? per_sample_weights.value() : Tensor());
       });
-    });
-    apply_bag_size(offsets, indices, mode, output, bag_size);
+  });
+
+  if (mode == MODE_MEAN || mode == MODE_SUM) {
     max_indices = bag_size;
-  } else { // MODE_MAX
-    AT_DISPATCH_FLOATING_TYPES_AND_HALF(
-      weight.scalar_type(), "embedding_bag_cpu_max_out", [&]() {
-        embedding_bag_cpu_max_out<scalar_t>(
-          max_indices, weight, indices, offset2bag, output, bag_size);
-      }
-    );
   }
 }
 
@@ -1006,6 +999,132 @@ Tensor _embedding_bag_per_sample_weights_backward_cpu(
   );
 }
 
+// Note [Hash-aggregated sparse embedding_bag backward on CPU]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Instead of expanding grad to one row per index and leaving duplicates for
+// coalesce() to sort out, every thread aggregates a contiguous range of
+// indices into its own ska::flat_hash_map from embedding row to a partial
+// gradient row. The per-thread maps are merged into one row per distinct
+// embedding index, so the result is already coalesced and only the distinct
+// indices, not every lookup, get sorted.
+template <typename scalar_t, typename index_t>
+Tensor _embedding_bag_sparse_backward_cpu_sum_mean(
+    const Tensor& grad,
+    const Tensor& indices,
+    const Tensor& offset2bag,
+    const Tensor& bag_size,
+    int64_t num_weights,
+    bool scale_grad_by_freq,
+    int64_t mode,
+    const Tensor& per_sample_weights) {
+  const int64_t numel = indices.numel();
+  const int64_t ddim = grad.sizes()[1];
+  const auto* grad_data = grad.data_ptr<scalar_t>();
+  const auto grad_stride0 = grad.strides()[0];
+  const auto grad_stride1 = grad.strides()[1];
+  const auto* indices_data = indices.data_ptr<index_t>();
+  const auto* offset2bag_data = offset2bag.data_ptr<index_t>();
+  const index_t* bag_size_data = mode == MODE_MEAN ? bag_size.data_ptr<index_t>() : nullptr;
+  const scalar_t* scale_data = nullptr;
+  int64_t scale_stride = 0;
+  if (per_sample_weights.defined()) {
+    scale_data = per_sample_weights.data_ptr<scalar_t>();
+    scale_stride = per_sample_weights.strides()[0];
+  }
+
+  struct Partial {
+    ska::flat_hash_map<index_t, int64_t> slot;  // embedding row -> row in `rows`
+    std::vector<int64_t> count;                 // lookups per slot
+    std::vector<scalar_t> rows;                 // slot-major partial gradients
+  };
+  // Every chunk builds and merges its own map; below this many lookups that
+  // overhead outweighs splitting the work.
+  constexpr int64_t kMinLookupsPerChunk = 1024;
+  const int64_t num_chunks = std::max<int64_t>(1,
+      std::min<int64_t>(at::get_num_threads(), numel / kMinLookupsPerChunk));
+  const int64_t chunk_size = (numel + num_chunks - 1) / num_chunks;
+  std::vector<Partial> partials(num_chunks);
+
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      auto& partial = partials[c];
+      const int64_t hi = std::min(numel, (c + 1) * chunk_size);
+      for (int64_t i = c * chunk_size; i < hi; i++) {
+        const index_t idx = indices_data[i];
+        TORCH_CHECK(idx >= 0 && idx < num_weights,
+                    "embedding_bag_backward: index ", idx, " is out of bounds for ",
+                    num_weights, " embeddings");
+        auto it = partial.slot.find(idx);
+        if (it == partial.slot.end()) {
+          it = partial.slot.emplace(idx, partial.count.size()).first;
+          partial.count.push_back(0);
+          partial.rows.resize(partial.rows.size() + ddim, scalar_t(0));
+        }
+        partial.count[it->second]++;
+
+        const index_t bag = offset2bag_data[i];
+        scalar_t scale = scale_data ? scale_data[i * scale_stride] : scalar_t(1);
+        if (bag_size_data) {
+          scale /= static_cast<scalar_t>(bag_size_data[bag]);
+        }
+        auto* row = partial.rows.data() + it->second * ddim;
+        const auto* grad_row = grad_data + bag * grad_stride0;
+        for (int64_t d = 0; d < ddim; d++) {
+          row[d] += scale * grad_row[d * grad_stride1];
+        }
+      }
+    }
+  });
+
+  std::vector<index_t> unique_indices;
+  unique_indices.reserve(partials[0].slot.size());
+  {
+    ska::flat_hash_set<index_t> seen;
+    for (const auto& partial : partials) {
+      for (const auto& kv : partial.slot) {
+        if (num_chunks == 1 || seen.insert(kv.first).second) {
+          unique_indices.push_back(kv.first);
+        }
+      }
+    }
+  }
+  std::sort(unique_indices.begin(), unique_indices.end());
+  const int64_t num_unique = unique_indices.size();
+
+  auto values = at::zeros({num_unique, ddim}, grad.options());
+  auto sparse_indices = at::empty({1, num_unique}, indices.options().dtype(kLong));
+  auto* values_data = values.data_ptr<scalar_t>();
+  auto* sparse_indices_data = sparse_indices.data_ptr<int64_t>();
+  at::parallel_for(0, num_unique, 64, [&](int64_t begin, int64_t end) {
+    for (int64_t u = begin; u < end; u++) {
+      const index_t idx = unique_indices[u];
+      sparse_indices_data[u] = idx;
+      auto* out_row = values_data + u * ddim;
+      int64_t count = 0;
+      for (const auto& partial : partials) {
+        auto it = partial.slot.find(idx);
+        if (it == partial.slot.end()) {
+          continue;
+        }
+        count += partial.count[it->second];
+        const auto* row = partial.rows.data() + it->second * ddim;
+        for (int64_t d = 0; d < ddim; d++) {
+          out_row[d] += row[d];
+        }
+      }
+      if (scale_grad_by_freq) {
+        const scalar_t inv_count = scalar_t(1) / static_cast<scalar_t>(count);
+        for (int64_t d = 0; d < ddim; d++) {
+          out_row[d] *= inv_count;
+        }
+      }
+    }
+  });
+
+  return at::_sparse_coo_tensor_unsafe(
+      sparse_indices, values, {num_weights, ddim})._coalesced_(true);
+}
+
 Tensor _embedding_bag_sparse_backward(
     const Tensor &grad_, const Tensor &indices, const Tensor &offsets,
     const Tensor &offset2bag, const Tensor &bag_size_, int64_t num_weights,
@@ -1018,6 +1137,20 @@ Tensor _embedding_bag_sparse_backward(
   // Also see NOTE [ embedding_bag Native Functions ] in native_functions.yaml
   // for more details.
 
+  // See Note [Hash-aggregated sparse embedding_bag backward on CPU]
+  if (grad_.device().is_cpu() && (mode == MODE_SUM || mode == MODE_MEAN) &&
+      (grad_.scalar_type() == kFloat || grad_.scalar_type() == kDouble)) {
+    Tensor result;
+    AT_DISPATCH_FLOATING_TYPES(grad_.scalar_type(), "embedding_bag_sparse_backward_cpu", [&] {
+      AT_DISPATCH_INDEX_TYPES(indices.scalar_type(), "embedding_bag_sparse_backward_cpu", [&] {
+        result = _embedding_bag_sparse_backward_cpu_sum_mean<scalar_t, index_t>(
+            grad_, indices, offset2bag, bag_size_, num_weights, scale_grad_by_freq,
+            mode, per_sample_weights);
+      });
+    });
+    return result;
+  }
+
   Tensor grad = grad_;
   Tensor index_grad = grad_.index_select(0, offset2bag);
   index_grad = apply_bag_size_backward(offsets, indices, mode, index_grad,
@@ -0,0 +1,264 @@
+#include <ATen/native/FusedOptimizers.h>
+
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <c10/util/irange.h>
+
+#include <cmath>
+
+namespace at { namespace native {
+
+DEFINE_DISPATCH(fused_adam_stub);
+DEFINE_DISPATCH(fused_sgd_stub);
+DEFINE_DISPATCH(fused_adagrad_stub);
+
+void check_fused_optimizer_inputs(
+    const char* op_name,
+    TensorList params,
+    TensorList grads,
+    ArrayRef<TensorList> states,
+    ArrayRef<bool> states_optional) {
+  TORCH_CHECK(
+      params.size() == grads.size(),
+      op_name, ": expected as many gradients as parameters, but got ",
+      grads.size(), " and ", params.size());
+  for (const auto i : c10::irange(params.size())) {
+    TORCH_CHECK(
+        params[i].layout() == kStrided && grads[i].layout() == kStrided,
+        op_name, " only supports strided parameters and gradients");
+    TORCH_CHECK(
+        params[i].device() == grads[i].device() &&
+            params[i].sizes() == grads[i].sizes(),
+        op_name, ": gradient ", i, " doesn't match its parameter");
+  }
+  for (const auto s : c10::irange(states.size())) {
+    if (states_optional[s] && states[s].empty()) {
+      continue;
+    }
+    TORCH_CHECK(
+        states[s].size() == params.size(),
+        op_name, ": expected a state tensor per parameter, but got ",
+        states[s].size(), " and ", params.size());
+    for (const auto i : c10::irange(params.size())) {
+      TORCH_CHECK(
+          states[s][i].device() == params[i].device() &&
+              states[s][i].sizes() == params[i].sizes(),
+          op_name, ": state tensor ", i, " doesn't match its parameter");
+    }
+  }
+}
+
+FusedAdamParams make_fused_adam_params(
+    double lr,
+    double beta1,
+    double beta2,
+    double weight_decay,
+    double eps,
+    bool amsgrad,
+    bool decoupled_weight_decay,
+    int64_t step) {
+  TORCH_CHECK(step >= 1, "_fused_adam_: expected step >= 1, but got ", step);
+  return {
+      lr,
+      beta1,
+      beta2,
+      weight_decay,
+      eps,
+      amsgrad,
+      decoupled_weight_decay,
+      1 - std::pow(beta1, step),
+      1 - std::pow(beta2, step)};
+}
+
+void fused_adam_step_slow(
+    const Tensor& param,
+    const Tensor& grad,
+    const Tensor& exp_avg,
+    const Tensor& exp_avg_sq,
+    const Tensor& max_exp_avg_sq,
+    const FusedAdamParams& p) {
+  Tensor g = grad;
+  if (p.weight_decay != 0) {
+    if (p.decoupled_weight_decay) {
+      param.mul_(1 - p.lr * p.weight_decay);
+    } else {
+      g = g.add(param, p.weight_decay);
+    }
+  }
+  exp_avg.mul_(p.beta1).add_(g, 1 - p.beta1);
+  exp_avg_sq.mul_(p.beta2).addcmul_(g, g, 1 - p.beta2);
+  Tensor denom;
+  if (p.amsgrad) {
+    Tensor max_sq = max_exp_avg_sq;
+    at::max_out(max_sq, exp_avg_sq, max_sq);
+    denom = (max_sq.sqrt() / std::sqrt(p.bias_correction2)).add_(p.eps);
+  } else {
+    denom = (exp_avg_sq.sqrt() / std::sqrt(p.bias_correction2)).add_(p.eps);
+  }
+  param.addcdiv_(exp_avg, denom, -p.lr / p.bias_correction1);
+}
+
+void fused_sgd_step_slow(
+    const Tensor& param,
+    const Tensor& grad,
+    const Tensor& momentum_buffer,
+    const FusedSGDParams& p) {
+  Tensor d_p = grad;
+  if (p.weight_decay != 0) {
+    d_p = d_p.add(param, p.weight_decay);
+  }
+  if (p.momentum != 0) {
+    if (p.is_first_step) {
+      momentum_buffer.copy_(d_p);
+    } else {
+      momentum_buffer.mul_(p.momentum).add_(d_p, 1 - p.dampening);
+    }
+    if (p.nesterov) {
+      d_p = d_p.add(momentum_buffer, p.momentum);
+    } else {
+      d_p = momentum_buffer;
+    }
+  }
+  param.add_(d_p, -p.lr);
+}
+
+void fused_adagrad_step_slow(
+    const Tensor& param,
+    const Tensor& grad,
+    const Tensor& state_sum,
+    const FusedAdagradParams& p) {
+  Tensor g = grad;
+  if (p.weight_decay != 0) {
+    g = g.add(param, p.weight_decay);
+  }
+  state_sum.addcmul_(g, g, 1.0);
+  param.addcdiv_(g, state_sum.sqrt().add_(p.eps), -p.lr);
+}
+
+namespace {
+
+// The CPU kernels run on contiguous float and double tensors of the
+// parameter's dtype
+bool can_use_cpu_kernel(const Tensor& param, std::initializer_list<Tensor> others) {
+  if (!(param.scalar_type() == kFloat || param.scalar_type() == kDouble) ||
+      !param.is_contiguous()) {
+    return false;
+  }
+  for (const auto& t : others) {
+    if (t.defined() &&
+        (t.scalar_type() != param.scalar_type() || !t.is_contiguous())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+void _fused_adam_cpu_(
+    TensorList self,
+    TensorList grads,
+    TensorList exp_avgs,
+    TensorList exp_avg_sqs,
+    TensorList max_exp_avg_sqs,
+    double lr,
+    double beta1,
+    double beta2,
+    double weight_decay,
+    double eps,
+    bool amsgrad,
+    bool decoupled_weight_decay,
+    int64_t step) {
+  check_fused_optimizer_inputs(
+      "_fused_adam_", self, grads, {exp_avgs, exp_avg_sqs, max_exp_avg_sqs},
+      {false, false, !amsgrad});
+  const auto p = make_fused_adam_params(
+      lr, beta1, beta2, weight_decay, eps, amsgrad, decoupled_weight_decay,
+      step);
+
+  std::vector<Tensor> params, fast_grads, fast_exp_avgs, fast_exp_avg_sqs,
+      fast_max_exp_avg_sqs;
+  for (const auto i : c10::irange(self.size())) {
+    const Tensor max_exp_avg_sq = amsgrad ? max_exp_avg_sqs[i] : Tensor();
+    if (can_use_cpu_kernel(
+            self[i], {grads[i], exp_avgs[i], exp_avg_sqs[i], max_exp_avg_sq})) {
+      params.push_back(self[i]);
+      fast_grads.push_back(grads[i]);
+      fast_exp_avgs.push_back(exp_avgs[i]);
+      fast_exp_avg_sqs.push_back(exp_avg_sqs[i]);
+      if (amsgrad) {
+        fast_max_exp_avg_sqs.push_back(max_exp_avg_sq);
+      }
+    } else {
+      fused_adam_step_slow(
+          self[i], grads[i], exp_avgs[i], exp_avg_sqs[i], max_exp_avg_sq, p);
+    }
+  }
+  if (!params.empty()) {
+    fused_adam_stub(
+        kCPU, params, fast_grads, fast_exp_avgs, fast_exp_avg_sqs,
+        fast_max_exp_avg_sqs, p);
+  }
+}
+
+void _fused_sgd_cpu_(
+    TensorList self,
+    TensorList grads,
+    TensorList momentum_buffers,
+    double lr,
+    double momentum,
+    double dampening,
+    double weight_decay,
+    bool nesterov,
+    bool is_first_step) {
+  const bool has_momentum = momentum != 0;
+  check_fused_optimizer_inputs(
+      "_fused_sgd_", self, grads, {momentum_buffers}, {!has_momentum});
+  const FusedSGDParams p{
+      lr, momentum, dampening, weight_decay, nesterov, is_first_step};
+
+  std::vector<Tensor> params, fast_grads, fast_momentum_buffers;
+  for (const auto i : c10::irange(self.size())) {
+    const Tensor buf = has_momentum ? momentum_buffers[i] : Tensor();
+    if (can_use_cpu_kernel(self[i], {grads[i], buf})) {
+      params.push_back(self[i]);
+      fast_grads.push_back(grads[i]);
+      if (has_momentum) {
+        fast_momentum_buffers.push_back(buf);
+      }
+    } else {
+      fused_sgd_step_slow(self[i], grads[i], buf, p);
+    }
+  }
+  if (!params.empty()) {
+    fused_sgd_stub(kCPU, params, fast_grads, fast_momentum_buffers, p);
+  }
+}
+
+void _fused_adagrad_cpu_(
+    TensorList self,
+    TensorList grads,
+    TensorList state_sums,
+    double lr,
+    double weight_decay,
+    double eps) {
+  check_fused_optimizer_inputs(
+      "_fused_adagrad_", self, grads, {state_sums}, {false});
+  const FusedAdagradParams p{lr, weight_decay, eps};
+
+  std::vector<Tensor> params, fast_grads, fast_state_sums;
+  for (const auto i : c10::irange(self.size())) {
+    if (can_use_cpu_kernel(self[i], {grads[i], state_sums[i]})) {
+      params.push_back(self[i]);
+      fast_grads.push_back(grads[i]);
+      fast_state_sums.push_back(state_sums[i]);
+    } else {
+      fused_adagrad_step_slow(self[i], grads[i], state_sums[i], p);
+    }
+  }
+  if (!params.empty()) {
+    fused_adagrad_stub(kCPU, params, fast_grads, fast_state_sums, p);
+  }
+}
+
+}} // namespace at::native
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Coefficients of one step of the fused optimizers, for all the parameters
+// of a call. See _fused_adam_, _fused_sgd_ and _fused_adagrad_ in
+// native_functions.yaml.
+struct FusedAdamParams {
+  double lr;
+  double beta1;
+  double beta2;
+  double weight_decay;
+  double eps;
+  bool amsgrad;
+  // AdamW: decay the parameter instead of adding weight_decay * param to the
+  // gradient
+  bool decoupled_weight_decay;
+  // 1 - beta1^step and 1 - beta2^step
+  double bias_correction1;
+  double bias_correction2;
+};
+
+struct FusedSGDParams {
+  double lr;
+  double momentum;
+  double dampening;
+  double weight_decay;
+  bool nesterov;
+  // The momentum buffers are uninitialized and get the first update
+  bool is_first_step;
+};
+
+struct FusedAdagradParams {
+  double lr;
+  double weight_decay;
+  double eps;
+};
+
+// The CPU kernels take lists of contiguous tensors of the same floating
+// dtype, one list per operand in the order of the native function; the
+// optional state lists (max_exp_avg_sqs, momentum_buffers) are empty when
+// unused.
+using fused_adam_fn = void (*)(TensorList params, TensorList grads,
+    TensorList exp_avgs, TensorList exp_avg_sqs, TensorList max_exp_avg_sqs,
+    const FusedAdamParams&);
+using fused_sgd_fn = void (*)(TensorList params, TensorList grads,
+    TensorList momentum_buffers, const FusedSGDParams&);
+using fused_adagrad_fn = void (*)(TensorList params, TensorList grads,
+    TensorList state_sums, const FusedAdagradParams&);
+
+DECLARE_DISPATCH(fused_adam_fn, fused_adam_stub);
+DECLARE_DISPATCH(fused_sgd_fn, fused_sgd_stub);
+DECLARE_DISPATCH(fused_adagrad_fn, fused_adagrad_stub);
+
+// Checks the arguments of a fused optimizer op: state lists must match the
+// parameters one to one, or be empty when optional
+TORCH_API void check_fused_optimizer_inputs(const char* op_name, TensorList params,
+    TensorList grads, ArrayRef<TensorList> states,
+    ArrayRef<bool> states_optional);
+
+TORCH_API FusedAdamParams make_fused_adam_params(double lr, double beta1, double beta2,
+    double weight_decay, double eps, bool amsgrad,
+    bool decoupled_weight_decay, int64_t step);
+
+// Unfused steps of a single parameter, for the tensors the kernels can't
+// take (non-contiguous, mixed dtypes, ...)
+TORCH_API void fused_adam_step_slow(const Tensor& param, const Tensor& grad,
+    const Tensor& exp_avg, const Tensor& exp_avg_sq,
+    const Tensor& max_exp_avg_sq, const FusedAdamParams& p);
+TORCH_API void fused_sgd_step_slow(const Tensor& param, const Tensor& grad,
+    const Tensor& momentum_buffer, const FusedSGDParams& p);
+TORCH_API void fused_adagrad_step_slow(const Tensor& param, const Tensor& grad,
+    const Tensor& state_sum, const FusedAdagradParams& p);
+
+}} // namespace at::native
@@ -29,6 +29,17 @@ Tensor linear(const Tensor& input, const Tensor& weight, const c10::optional<Ten
     return xnnpack::linear(input, weight, *bias);
   }
 #endif
+  if (weight.is_sparse_csr()) {
+    // Sparse CSR and BSR matrices only multiply dense matrices from the left,
+    // so compute (weight @ input^T)^T.
+    auto input_t = input.reshape({-1, input.size(-1)}).t();
+    auto output_t = bias->defined()
+        ? at::addmm(bias->unsqueeze(1), weight, input_t)
+        : at::mm(weight, input_t);
+    auto output_size = input.sizes().vec();
+    output_size.back() = weight.size(0);
+    return output_t.t().reshape(output_size);
+  }
   if (input.dim() == 2 && bias->defined()) {
     // Fused op is marginally faster.
     return at::addmm(*bias, input, weight.t());
@@ -28,6 +28,7 @@ namespace native {
 
 DEFINE_DISPATCH(addr_stub);
 DEFINE_DISPATCH(linalg_vector_norm_stub);
+DEFINE_DISPATCH(baddbmm_small_stub);
 
 // Helper function for det methods.
 // For pivoted LU factorization A = P * L * U. Since we always have det(L) = 1,
@@ -1035,6 +1036,11 @@ Tensor &addmm_cpu_(Tensor& self, const Tensor& mat1, const Tensor& mat2, const S
   return addmm_cpu_out(self, mat1, mat2, beta, alpha, self);
 }
 
+Tensor addmm_activation_cpu(const Tensor& self, const Tensor& mat1, const Tensor& mat2, const Scalar& beta, const Scalar& alpha, bool use_gelu) {
+  Tensor result = addmm_cpu(self, mat1, mat2, beta, alpha);
+  return use_gelu ? at::gelu(result) : result.relu_();
+}
+
 Tensor& mm_cpu_out(const Tensor & self, const Tensor & mat2, Tensor & result) {
   TORCH_CHECK(self.dim() == 2, "self must be a matrix");
   TORCH_CHECK(mat2.dim() == 2, "mat2 must be a matrix");
@@ -1093,12 +1099,17 @@ inline void baddbmm_cpu_kernel(const Tensor& result, const Tensor& self, const T
 
 // This tries to apply some optimizations to bmm/baddbmm:
 // - When the operand size is small, computation are parallelized over the batch
-//   dimension using OMP and naive matrix multiplication is applied.
+//   dimension using OMP and naive matrix multiplication is applied. For float
+//   and double the naive kernel is replaced by baddbmm_small_stub, which is
+//   vectorized and register-blocked.
 // - When the operand size is larger than the threshold, if compiled with MKL, MKL's batch gemm is used.
+// - Otherwise, batches of matrices no larger than kSmallGemmMaxDim in each
+//   dimension also use baddbmm_small_stub, parallelized over the batch.
 // - Otherwise, we use a series of matrix multiplications.
 // The threshold of 400 for the first has not been thoroughly benchmarked yet and may have room for further
 // optimization, it likely depends on the characteristics of the CPU, MKL will be different from non-MKL etc.,
 // but this seems to be a first starting point.
+constexpr int64_t kSmallGemmMaxDim = 128;
 
 static inline Tensor& bmm_out_or_baddbmm_(Tensor& self_or_result, const Tensor& batch1, const Tensor& batch2, const Scalar& beta, const Scalar& alpha, bool is_bmm_out) {
   // is_bmm_out: true for bmm_out, false for baddbmm_
@@ -1157,8 +1168,14 @@ static inline Tensor& bmm_out_or_baddbmm_(Tensor& self_or_result, const Tensor&
             || (strides[1] == 1 && strides[2] >= sizes[1]);
   };
 
+  const bool small_gemm_supported =
+      (self_or_result.scalar_type() == kFloat || self_or_result.scalar_type() == kDouble) &&
+      (self_or_result.stride(2) == 1 || res_cols == 1);
+
   if (contraction_size * res_rows * res_cols < 400) {
-    if (is_bmm_out) {
+    if (small_gemm_supported) {
+      baddbmm_small_stub(kCPU, self_or_result, batch1, batch2, beta, alpha, is_bmm_out);
+    } else if (is_bmm_out) {
       AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND2(kHalf, kBFloat16, batch1.scalar_type(), "bmm", [&] {
           baddbmm_cpu_kernel<scalar_t, true>(self_or_result, batch1, batch2, beta, alpha);
         });
@@ -1176,6 +1193,9 @@ static inline Tensor& bmm_out_or_baddbmm_(Tensor& self_or_result, const Tensor&
             && batch_items_contiguous_or_transposed(batch2)
             && self_or_result.is_contiguous()) {
     at::native::_baddbmm_mkl_(self_or_result, batch1, batch2, beta, alpha);
+  } else if (small_gemm_supported && res_rows <= kSmallGemmMaxDim &&
+             res_cols <= kSmallGemmMaxDim && contraction_size <= kSmallGemmMaxDim) {
+    baddbmm_small_stub(kCPU, self_or_result, batch1, batch2, beta, alpha, is_bmm_out);
   } else { // split along batch dimension
     if (is_bmm_out) {
       for (int64_t b = 0; b < bs; b++) {
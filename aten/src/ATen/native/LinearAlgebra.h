@@ -13,4 +13,11 @@ DECLARE_DISPATCH(addr_fn, addr_stub);
 using linalg_vector_norm_fn = void(*)(TensorIterator &, Scalar);
 DECLARE_DISPATCH(linalg_vector_norm_fn, linalg_vector_norm_stub);
 
+// result = beta * result + alpha * (batch1 @ batch2) for float and double
+// batches of small matrices whose result rows are contiguous. `beta` is
+// ignored, and result not read, when is_bmm is set or beta is 0.
+using baddbmm_small_fn = void(*)(const Tensor& result, const Tensor& batch1, const Tensor& batch2,
+                                 const Scalar& beta, const Scalar& alpha, bool is_bmm);
+DECLARE_DISPATCH(baddbmm_small_fn, baddbmm_small_stub);
+
 }} // namespace at::native
@@ -87,7 +87,9 @@ static bool init_nnpack() {
 }
 
 static pthreadpool_t nnpack_threadpool() {
-#ifdef C10_MOBILE
+#ifdef USE_PTHREADPOOL
+  // Shared with QNNPACK and XNNPACK, and resized by at::set_num_threads, so
+  // that the libraries don't oversubscribe the cores with pools of their own.
   return caffe2::pthreadpool_();
 #else
   static pthreadpool_t nnpack_threadpool_ = nullptr;
@@ -576,6 +576,21 @@ std::tuple<Tensor, Tensor, Tensor> batch_norm_cpu(const Tensor& self, const c10:
 
   checkBackend("batch_norm_cpu", {self, weight, bias, running_mean, running_var}, Backend::CPU);
 
+  if (self.scalar_type() == ScalarType::BFloat16) {
+    // Only the contiguous inference fast path has a BFloat16 kernel.
+    TORCH_CHECK(!train && self.is_contiguous()
+        && (!weight.defined() || weight.is_contiguous())
+        && (!bias.defined() || bias.is_contiguous())
+        && running_mean.defined() && running_mean.is_contiguous()
+        && running_var.defined() && running_var.is_contiguous(),
+        "batch_norm: BFloat16 input on CPU is only supported in inference mode "
+        "with contiguous input, parameters and running stats");
+    Tensor output = at::empty_like(self, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+    batch_norm_cpu_inference_contiguous_stub(kCPU, output, self, weight,
+        bias, running_mean, running_var, eps);
+    return std::make_tuple(output, Tensor(), Tensor());
+  }
+
   return AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "batch_norm", [&] {
       if (!train) {
         return batch_norm_cpu_transform_input_template<scalar_t>(self, weight, bias, {}, {}, running_mean, running_var, train, eps);
@@ -0,0 +1,139 @@
+#include <ATen/native/PackedLinear.h>
+
+#include <ATen/ATen.h>
+#include <ATen/Config.h>
+#include <ATen/Parallel.h>
+#include <torch/custom_class.h>
+#include <torch/library.h>
+
+#include <limits>
+#include <vector>
+
+#if AT_MKL_ENABLED()
+#include <mkl.h>
+#endif
+
+namespace at {
+namespace native {
+
+namespace {
+
+#if AT_MKL_ENABLED()
+bool fits_mkl_int(int64_t value) {
+  return value <= static_cast<int64_t>(std::numeric_limits<MKL_INT>::max());
+}
+#endif
+
+} // namespace
+
+c10::intrusive_ptr<LinearFp32PackedContext> LinearFp32PackedContext::create(
+    Tensor weight,
+    c10::optional<Tensor> bias) {
+  TORCH_CHECK(
+      weight.dim() == 2 && weight.scalar_type() == kFloat && weight.device().is_cpu(),
+      "linear_prepack: expected a 2-D float CPU weight");
+  if (bias.has_value() && bias->defined()) {
+    TORCH_CHECK(
+        bias->dim() == 1 && bias->size(0) == weight.size(0) &&
+            bias->scalar_type() == kFloat && bias->device().is_cpu(),
+        "linear_prepack: expected a 1-D float CPU bias of size ", weight.size(0));
+  } else {
+    bias = c10::nullopt;
+  }
+
+  Tensor packed_weight;
+#if AT_MKL_ENABLED()
+  const int64_t N = weight.size(0);
+  const int64_t K = weight.size(1);
+  if (N > 0 && K > 0 && fits_mkl_int(N) && fits_mkl_int(K)) {
+    const Tensor weight_contig = weight.contiguous();
+    // only n and k determine the packed layout of b, m is a size hint
+    const size_t packed_bytes = cblas_sgemm_pack_get_size(CblasBMatrix, 1, N, K);
+    packed_weight = at::empty(
+        {static_cast<int64_t>(divup(packed_bytes, sizeof(float)))},
+        weight.options());
+    // linear computes input @ weight.t(), so b is the transposed weight
+    cblas_sgemm_pack(
+        CblasRowMajor, CblasBMatrix, CblasTrans, 1, N, K, 1.0f,
+        weight_contig.data_ptr<float>(), K, packed_weight.data_ptr<float>());
+  }
+#endif
+  return c10::make_intrusive<LinearFp32PackedContext>(
+      std::move(weight), std::move(bias), std::move(packed_weight));
+}
+
+Tensor LinearFp32PackedContext::run(const Tensor& input) const {
+  TORCH_CHECK(
+      input.dim() >= 1 && input.size(-1) == weight_.size(1),
+      "linear_run: expected input with ", weight_.size(1), " features in its last dimension");
+  if (!packed_weight_.defined() || input.scalar_type() != kFloat ||
+      !input.device().is_cpu()) {
+    return at::linear(input, weight_, bias_);
+  }
+#if AT_MKL_ENABLED()
+  const int64_t N = weight_.size(0);
+  const int64_t K = weight_.size(1);
+  const Tensor input_contig = input.contiguous();
+  const int64_t M = input_contig.numel() / K;
+  if (!fits_mkl_int(M)) {
+    return at::linear(input, weight_, bias_);
+  }
+
+  std::vector<int64_t> output_size = input.sizes().vec();
+  output_size.back() = N;
+  Tensor output = at::empty(output_size, input.options());
+  if (M == 0) {
+    return output;
+  }
+  float beta = 0.0f;
+  if (bias_.has_value()) {
+    output.view({M, N}).copy_(bias_->expand({M, N}));
+    beta = 1.0f;
+  }
+  cblas_sgemm_compute(
+      CblasRowMajor, CblasNoTrans, CblasPacked, M, N, K,
+      input_contig.data_ptr<float>(), K,
+      packed_weight_.data_ptr<float>(), K,
+      beta, output.data_ptr<float>(), N);
+  return output;
+#else
+  TORCH_INTERNAL_ASSERT(false, "linear_run: packed weight without MKL");
+#endif
+}
+
+c10::intrusive_ptr<LinearFp32PackedContext> linear_fp32_prepack(
+    Tensor weight,
+    c10::optional<Tensor> bias) {
+  return LinearFp32PackedContext::create(std::move(weight), std::move(bias));
+}
+
+Tensor linear_fp32_prepacked_run(
+    const Tensor& input,
+    const c10::intrusive_ptr<LinearFp32PackedContext>& context) {
+  return context->run(input);
+}
+
+TORCH_LIBRARY(cpu_prepacked, m) {
+  m.class_<LinearFp32PackedContext>("LinearFp32PackedContext")
+    .def_pickle(
+        [](const c10::intrusive_ptr<LinearFp32PackedContext>& context)
+            -> SerializationTypeLinearFp32PrePack { // __getstate__
+          return context->unpack();
+        },
+        [](SerializationTypeLinearFp32PrePack state)
+            -> c10::intrusive_ptr<LinearFp32PackedContext> { // __setstate__
+          return LinearFp32PackedContext::create(
+              std::move(std::get<0>(state)), std::move(std::get<1>(state)));
+        });
+
+  m.def(TORCH_SELECTIVE_SCHEMA("cpu_prepacked::linear_prepack(Tensor W, Tensor? B=None) -> __torch__.torch.classes.cpu_prepacked.LinearFp32PackedContext"));
+  m.def(TORCH_SELECTIVE_SCHEMA("cpu_prepacked::linear_run(Tensor X, __torch__.torch.classes.cpu_prepacked.LinearFp32PackedContext W_prepack) -> Tensor Y"));
+}
+
+TORCH_LIBRARY_IMPL(cpu_prepacked, CPU, m) {
+  m.impl(TORCH_SELECTIVE_NAME("cpu_prepacked::linear_prepack"), TORCH_FN(linear_fp32_prepack));
+  m.impl(TORCH_SELECTIVE_NAME("cpu_prepacked::linear_run"), TORCH_FN(linear_fp32_prepacked_run));
+}
+
+} // namespace native
+} // namespace at
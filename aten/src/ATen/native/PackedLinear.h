@@ -0,0 +1,57 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <ATen/core/ivalue.h>
+#include <c10/util/Optional.h>
+
+#include <tuple>
+
+namespace at {
+namespace native {
+
+using SerializationTypeLinearFp32PrePack =
+    std::tuple<Tensor, c10::optional<Tensor>>;
+
+// fp32 linear whose weight is packed once for the CPU GEMM, for graphs where
+// the weight is a constant (see PrepackFrozenLinear in
+// torch/csrc/jit/passes/frozen_linear_prepack.h). The weight is
+// converted to MKL's packed GEMM format when MKL is available, which saves
+// the packing that sgemm otherwise redoes on every call. Without MKL, run()
+// falls back to at::linear with the original weight.
+class TORCH_API LinearFp32PackedContext : public torch::jit::CustomClassHolder {
+ public:
+  static c10::intrusive_ptr<LinearFp32PackedContext> create(
+      Tensor weight,
+      c10::optional<Tensor> bias);
+
+  Tensor run(const Tensor& input) const;
+
+  SerializationTypeLinearFp32PrePack unpack() const {
+    return std::make_tuple(weight_, bias_);
+  }
+
+  LinearFp32PackedContext(
+      Tensor weight,
+      c10::optional<Tensor> bias,
+      Tensor packed_weight)
+      : weight_(std::move(weight)),
+        bias_(std::move(bias)),
+        packed_weight_(std::move(packed_weight)) {}
+
+ private:
+  Tensor weight_;
+  c10::optional<Tensor> bias_;
+  // Undefined when the weight could not be packed
+  Tensor packed_weight_;
+};
+
+TORCH_API c10::intrusive_ptr<LinearFp32PackedContext> linear_fp32_prepack(
+    Tensor weight,
+    c10::optional<Tensor> bias);
+
+TORCH_API Tensor linear_fp32_prepacked_run(
+    const Tensor& input,
+    const c10::intrusive_ptr<LinearFp32PackedContext>& context);
+
+} // namespace native
+} // namespace at
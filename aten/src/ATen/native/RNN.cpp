@@ -2,6 +2,7 @@
 
 #include <ATen/ATen.h>
 #include <ATen/NativeFunctions.h>
+#include <ATen/core/grad_mode.h>
 #include <ATen/core/op_registration/op_registration.h>
 #include <ATen/cpp_custom_type_hack.h>
 #include <ATen/native/quantized/cpu/packed_params.h>
@@ -705,6 +706,24 @@ void check_rnn_cell_forward_hidden(const Tensor& input, const Tensor& hx, int64_
     "hidden", hidden_label, " has inconsistent hidden_size: got ", hx.size(1), ", expected ", hidden_size);
 }
 
+// The fused CPU cells compute the pointwise part of a cell in one pass, but
+// have no derivatives. They are used for inference, e.g. with the quantized
+// dynamic cell params, where every step would otherwise allocate a tensor per
+// intermediate of the cell.
+bool use_fused_cell_cpu(TensorList tensors) {
+  const auto dtype = tensors[0].scalar_type();
+  if (dtype != kFloat && dtype != kDouble) {
+    return false;
+  }
+  for (const auto& t : tensors) {
+    if (!t.device().is_cpu() || t.dim() != 2 || t.requires_grad() ||
+        t.scalar_type() != dtype) {
+      return false;
+    }
+  }
+  return true;
+}
+
 template<typename hidden_type_tmpl, typename cell_params_tmpl>
 struct Cell {
   using hidden_type = hidden_type_tmpl;
@@ -718,8 +737,153 @@ struct Cell {
       const hidden_type& hidden,
       const cell_params& params,
       bool pre_compute_input = false) const = 0;
+
+  // Runs the cell over a whole (seq_len, batch, input_size) CPU sequence,
+  // see Note [Fused CPU RNN layers]. Returns false, without touching outputs
+  // and final_hidden, if the cell has no such path for these arguments.
+  virtual bool run_sequence_cpu(
+      const Tensor& inputs,
+      const hidden_type& hidden,
+      const cell_params& params,
+      bool reverse,
+      Tensor& outputs,
+      hidden_type& final_hidden) const {
+    return false;
+  }
 };
 
+// Note [Fused CPU RNN layers]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// When no derivatives are needed, float and double LSTM (without projections)
+// and GRU layers with plain CellParams run their whole sequence here instead
+// of going through the cell once per step:
+//
+// * the input projections of all steps, with both biases for LSTM, are one
+//   GEMM over the whole sequence;
+// * each step is one addmm of the hidden state into a reused gates buffer,
+//   followed by the fused pointwise kernel of lstm_cell_cpu_stub or
+//   gru_cell_cpu_stub;
+// * the hidden state of each step is written straight into its slice of the
+//   output, which is also the input hidden state of the next step, so there
+//   is no per-step allocation and no final stack.
+//
+// Reverse directions walk the sequence backwards, so bidirectional layers
+// don't need to reverse their inputs and outputs either.
+bool use_fused_sequence_cpu(TensorList tensors) {
+  const auto dtype = tensors[0].scalar_type();
+  if (dtype != kFloat && dtype != kDouble) {
+    return false;
+  }
+  const bool grad_mode = at::GradMode::is_enabled();
+  for (const auto& t : tensors) {
+    if (!t.defined()) {
+      continue;
+    }
+    if (!t.device().is_cpu() || t.scalar_type() != dtype ||
+        (grad_mode && t.requires_grad())) {
+      return false;
+    }
+  }
+  return tensors[0].dim() == 3;
+}
+
+template <typename cell_params>
+bool lstm_sequence_cpu(
+    const Tensor& inputs,
+    const tpair_of<Tensor>& hidden,
+    const cell_params& params,
+    bool reverse,
+    Tensor& outputs,
+    tpair_of<Tensor>& final_hidden) {
+  return false;
+}
+
+bool lstm_sequence_cpu(
+    const Tensor& inputs,
+    const tpair_of<Tensor>& hidden,
+    const CellParams& params,
+    bool reverse,
+    Tensor& outputs,
+    tpair_of<Tensor>& final_hidden) {
+  const auto& hx = std::get<0>(hidden);
+  const auto& cx = std::get<1>(hidden);
+  if (params.w_hr.defined() ||
+      !use_fused_sequence_cpu(
+          {inputs, hx, cx, params.w_ih, params.w_hh, params.b_ih_, params.b_hh_})) {
+    return false;
+  }
+  const int64_t seq_length = inputs.size(0);
+  const Tensor bias =
+      params.b_ih_.defined() ? params.b_ih_ + params.b_hh_ : Tensor();
+  const auto input_projections =
+      at::linear(inputs, params.w_ih, bias).contiguous();
+  const auto w_hh_t = params.w_hh.t();
+
+  Tensor h = hx.contiguous();
+  Tensor c = cx.contiguous();
+  outputs = at::empty({seq_length, h.size(0), h.size(1)}, h.options());
+  auto gates = at::empty({h.size(0), input_projections.size(2)}, h.options());
+  Tensor cell_states[2] = {at::empty_like(c), at::empty_like(c)};
+  for (int64_t i = 0; i < seq_length; ++i) {
+    const int64_t t = reverse ? seq_length - 1 - i : i;
+    at::addmm_out(gates, input_projections[t], h, w_hh_t);
+    Tensor hy = outputs[t];
+    Tensor& cy = cell_states[i % 2];
+    lstm_cell_cpu_stub(kCPU, gates, c, hy, cy);
+    h = hy;
+    c = cy;
+  }
+  final_hidden = std::make_tuple(std::move(h), std::move(c));
+  return true;
+}
+
+template <typename cell_params>
+bool gru_sequence_cpu(
+    const Tensor& inputs,
+    const Tensor& hidden,
+    const cell_params& params,
+    bool reverse,
+    Tensor& outputs,
+    Tensor& final_hidden) {
+  return false;
+}
+
+bool gru_sequence_cpu(
+    const Tensor& inputs,
+    const Tensor& hidden,
+    const CellParams& params,
+    bool reverse,
+    Tensor& outputs,
+    Tensor& final_hidden) {
+  if (!use_fused_sequence_cpu(
+          {inputs, hidden, params.w_ih, params.w_hh, params.b_ih_, params.b_hh_})) {
+    return false;
+  }
+  const int64_t seq_length = inputs.size(0);
+  // b_hh can't be folded into the input projections: the reset gate scales
+  // the hidden part of the new gate, bias included
+  const auto input_projections =
+      at::linear(inputs, params.w_ih, params.b_ih_).contiguous();
+  const auto w_hh_t = params.w_hh.t();
+
+  Tensor h = hidden.contiguous();
+  outputs = at::empty({seq_length, h.size(0), h.size(1)}, h.options());
+  auto hgates = at::empty({h.size(0), input_projections.size(2)}, h.options());
+  for (int64_t i = 0; i < seq_length; ++i) {
+    const int64_t t = reverse ? seq_length - 1 - i : i;
+    if (params.b_hh_.defined()) {
+      at::addmm_out(hgates, params.b_hh_, h, w_hh_t);
+    } else {
+      at::mm_out(hgates, h, w_hh_t);
+    }
+    Tensor hy = outputs[t];
+    gru_cell_cpu_stub(kCPU, input_projections[t], hgates, h, hy);
+    h = hy;
+  }
+  final_hidden = std::move(h);
+  return true;
+}
+
 template<typename nonlinearity, typename cell_params>
 struct SimpleCell : Cell<Tensor, cell_params> {
   using hidden_type = Tensor;
@@ -760,6 +924,14 @@ struct LSTMCell : Cell<std::tuple<Tensor, Tensor>, cell_params> {
 
     const auto gates = params.linear_hh(hx).add_(
         pre_compute_input ? input : params.linear_ih(input));
+    if (use_fused_cell_cpu({gates, cx})) {
+      auto cx_contig = cx.contiguous();
+      auto hy = at::empty_like(cx_contig);
+      auto cy = at::empty_like(cx_contig);
+      lstm_cell_cpu_stub(kCPU, gates.contiguous(), cx_contig, hy, cy);
+      hy = params.matmul_hr(hy);
+      return std::make_tuple(std::move(hy), std::move(cy));
+    }
     auto chunked_gates = gates.unsafe_chunk(4, 1);
     auto ingate = chunked_gates[0].sigmoid_();
     auto forgetgate = chunked_gates[1].sigmoid_();
@@ -771,6 +943,16 @@ struct LSTMCell : Cell<std::tuple<Tensor, Tensor>, cell_params> {
     return std::make_tuple(std::move(hy), std::move(cy));
   }
 
+  bool run_sequence_cpu(
+      const Tensor& inputs,
+      const hidden_type& hidden,
+      const cell_params& params,
+      bool reverse,
+      Tensor& outputs,
+      hidden_type& final_hidden) const override {
+    return lstm_sequence_cpu(
+        inputs, hidden, params, reverse, outputs, final_hidden);
+  }
 };
 
 template <typename cell_params>
@@ -791,10 +973,17 @@ struct GRUCell : Cell<Tensor, cell_params> {
       // Slice off the workspace argument (it's needed only for AD).
       return std::move(std::get<0>(result));
     }
-    const auto chunked_igates = pre_compute_input
-        ? input.unsafe_chunk(3, 1)
-        : params.linear_ih(input).unsafe_chunk(3, 1);
-    auto chunked_hgates = params.linear_hh(hidden).unsafe_chunk(3, 1);
+    const auto igates = pre_compute_input ? input : params.linear_ih(input);
+    const auto hgates = params.linear_hh(hidden);
+    if (use_fused_cell_cpu({igates, hgates, hidden})) {
+      auto hx = hidden.contiguous();
+      auto hy = at::empty_like(hx);
+      gru_cell_cpu_stub(
+          kCPU, igates.contiguous(), hgates.contiguous(), hx, hy);
+      return hy;
+    }
+    const auto chunked_igates = igates.unsafe_chunk(3, 1);
+    auto chunked_hgates = hgates.unsafe_chunk(3, 1);
     const auto reset_gate =
         chunked_hgates[0].add_(chunked_igates[0]).sigmoid_();
     const auto input_gate =
@@ -803,6 +992,17 @@ struct GRUCell : Cell<Tensor, cell_params> {
         chunked_igates[2].add(chunked_hgates[2].mul_(reset_gate)).tanh_();
     return (hidden - new_gate).mul_(input_gate).add_(new_gate);
   }
+
+  bool run_sequence_cpu(
+      const Tensor& inputs,
+      const hidden_type& hidden,
+      const cell_params& params,
+      bool reverse,
+      Tensor& outputs,
+      hidden_type& final_hidden) const override {
+    return gru_sequence_cpu(
+        inputs, hidden, params, reverse, outputs, final_hidden);
+  }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -862,6 +1062,12 @@ struct FullLayer : Layer<Tensor, hidden_type, cell_params> {
       const hidden_type& input_hidden,
       const cell_params& params) const override {
     if (inputs.device().is_cpu()) {
+      Tensor outputs;
+      hidden_type final_hidden;
+      if (cell_.run_sequence_cpu(
+              inputs, input_hidden, params, /*reverse=*/false, outputs, final_hidden)) {
+        return {std::move(outputs), std::move(final_hidden)};
+      }
       const auto inputs_w = params.linear_ih(inputs);
       auto unstacked_output =
           (*this)(inputs_w.unbind(0), input_hidden, params, true);
@@ -892,6 +1098,18 @@ struct FullBidirectionalLayer
       const param_type& params) const override {
     std::vector<Tensor> step_inputs;
     if (input.device().is_cpu()) {
+      Tensor fw_outputs, rev_outputs;
+      dir_hidden_type fw_hidden, rev_hidden;
+      const auto& cell = layer_.cell_;
+      if (cell.run_sequence_cpu(
+              input, input_hidden.first, params.first, /*reverse=*/false,
+              fw_outputs, fw_hidden) &&
+          cell.run_sequence_cpu(
+              input, input_hidden.second, params.second, /*reverse=*/true,
+              rev_outputs, rev_hidden)) {
+        return {at::cat({fw_outputs, rev_outputs}, fw_outputs.dim() - 1),
+                std::make_pair(std::move(fw_hidden), std::move(rev_hidden))};
+      }
       auto input_w = params.first.linear_ih(input);
       step_inputs = input_w.unbind(0);
       auto fw_result = layer_(
@@ -1441,6 +1659,8 @@ DEFINE_DISPATCH(lstm_cudnn_stub);
 DEFINE_DISPATCH(lstm_packed_cudnn_stub);
 DEFINE_DISPATCH(lstm_miopen_stub);
 DEFINE_DISPATCH(lstm_packed_miopen_stub);
+DEFINE_DISPATCH(lstm_cell_cpu_stub);
+DEFINE_DISPATCH(gru_cell_cpu_stub);
 REGISTER_NO_CPU_DISPATCH(lstm_cudnn_stub, lstm_fn);
 REGISTER_NO_CPU_DISPATCH(lstm_packed_cudnn_stub, lstm_packed_fn);
 REGISTER_NO_CPU_DISPATCH(lstm_miopen_stub, lstm_fn);
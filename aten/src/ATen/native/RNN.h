@@ -9,6 +9,12 @@ using lstm_fn = void(*)(Tensor&, Tensor&, Tensor&, const Tensor&, TensorList, Te
 using rnn_fn = void(*)(Tensor&, Tensor&, const Tensor&, const Tensor&, TensorList, bool, int64_t, double, bool, bool, bool);
 using lstm_packed_fn = void(*)(Tensor&, Tensor&, Tensor&, const Tensor&, const Tensor&, TensorList, TensorList, bool, int64_t, double, bool, bool);
 using rnn_packed_fn = void(*)(Tensor&, Tensor&, const Tensor&, const Tensor&, const Tensor&, TensorList, bool, int64_t, double, bool, bool);
+// Pointwise part of the LSTM and GRU cells on CPU, fused into one pass over
+// the gates. Only used when no derivatives are needed, see RNN.cpp.
+// gates: (batch, 4 * hidden) input + hidden projections, cx: (batch, hidden)
+using lstm_cell_cpu_fn = void(*)(const Tensor& gates, const Tensor& cx, Tensor& hy, Tensor& cy);
+// igates, hgates: (batch, 3 * hidden) input and hidden projections, hx: (batch, hidden)
+using gru_cell_cpu_fn = void(*)(const Tensor& igates, const Tensor& hgates, const Tensor& hx, Tensor& hy);
 
 DECLARE_DISPATCH(lstm_fn, lstm_cudnn_stub);
 DECLARE_DISPATCH(lstm_fn, lstm_miopen_stub);
@@ -26,6 +32,8 @@ DECLARE_DISPATCH(rnn_packed_fn, rnn_tanh_packed_cudnn_stub);
 DECLARE_DISPATCH(rnn_packed_fn, rnn_tanh_packed_miopen_stub);
 DECLARE_DISPATCH(rnn_packed_fn, rnn_relu_packed_cudnn_stub);
 DECLARE_DISPATCH(rnn_packed_fn, rnn_relu_packed_miopen_stub);
+DECLARE_DISPATCH(lstm_cell_cpu_fn, lstm_cell_cpu_stub);
+DECLARE_DISPATCH(gru_cell_cpu_fn, gru_cell_cpu_stub);
 
 inline void check_attributes(const Tensor& input, const TensorList& params, const TensorList& hiddens, bool check_dtype=false) {
   auto input_device = input.device();
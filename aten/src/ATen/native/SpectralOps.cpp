@@ -601,6 +601,14 @@ void _cufft_clear_plan_cache(int64_t device_index) {
   detail::getCUDAHooks().cuFFTClearPlanCache(device_index);
 }
 
+bool _cufft_get_plan_cache_batch_bucketing(int64_t device_index) {
+  return detail::getCUDAHooks().cuFFTGetPlanCacheBatchBucketing(device_index);
+}
+
+void _cufft_set_plan_cache_batch_bucketing(int64_t device_index, bool enabled) {
+  detail::getCUDAHooks().cuFFTSetPlanCacheBatchBucketing(device_index, enabled);
+}
+
 template <typename Stream, typename T>
 static Stream& write_opt(Stream& SS, const optional<T>& value) {
   if (value) {
@@ -1,15 +1,59 @@
 // Returns the frequency of elements of input non-negative integer tensor.
 
 #include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/native/Resize.h>
+#include <ATen/native/SummaryOps.h>
 
+#include <algorithm>
+#include <cmath>
 #include <tuple>
+#include <vector>
 
 namespace at { namespace native {
 
 ///////////////// bincount /////////////////
 namespace {
 
+// Adds weight(i) to output_p[self_p[i]] for every i.
+// See Note [Privatized histograms]
+template <typename input_t, typename output_t, typename weight_fn_t>
+void bincount_cpu_accumulate(output_t* output_p, const input_t* self_p, int64_t self_size,
+                             int64_t nbins, const weight_fn_t& weight) {
+  using acc_t = at::acc_type<output_t, /*is_cuda=*/false>;
+  const int64_t num_chunks = std::max<int64_t>(1, std::min({
+      static_cast<int64_t>(at::get_num_threads()),
+      at::divup(self_size, at::internal::GRAIN_SIZE),
+      self_size / nbins}));
+  if (num_chunks == 1) {
+    for (int64_t i = 0; i < self_size; i++) {
+      output_p[self_p[i]] += weight(i);
+    }
+    return;
+  }
+  const int64_t chunk_size = at::divup(self_size, num_chunks);
+  std::vector<acc_t> local_hists(num_chunks * nbins, 0);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      acc_t* local_hist = local_hists.data() + c * nbins;
+      for (int64_t i = c * chunk_size; i < std::min(self_size, (c + 1) * chunk_size); i++) {
+        local_hist[self_p[i]] += weight(i);
+      }
+    }
+  });
+  at::parallel_for(0, nbins, at::internal::GRAIN_SIZE / num_chunks + 1, [&](int64_t begin, int64_t end) {
+    for (int64_t bin = begin; bin < end; bin++) {
+      acc_t sum = 0;
+      for (int64_t c = 0; c < num_chunks; c++) {
+        sum += local_hists[c * nbins + bin];
+      }
+      output_p[bin] = static_cast<output_t>(sum);
+    }
+  });
+}
+
 template <typename input_t, typename weights_t>
 Tensor _bincount_cpu_template(
     const Tensor& self,
@@ -45,15 +89,13 @@ Tensor _bincount_cpu_template(
         weights.options().pinned_memory_opt());
     weights_t* output_p = output.data_ptr<weights_t>();
     const weights_t* weights_p = weights.data_ptr<weights_t>();
-    for (int64_t i = 0; i < self_size; i++) {
-      output_p[self_p[i]] += weights_p[i];
-    }
+    bincount_cpu_accumulate(output_p, self_p, self_size, nbins,
+                            [weights_p](int64_t i) { return weights_p[i]; });
   } else {
     output = native::zeros({nbins}, kLong);
     int64_t* output_p = output.data_ptr<int64_t>();
-    for (int64_t i = 0; i < self_size; i++) {
-      output_p[self_p[i]] += 1L;
-    }
+    bincount_cpu_accumulate(output_p, self_p, self_size, nbins,
+                            [](int64_t i) { return int64_t(1); });
   }
   return output;
 }
@@ -73,4 +115,42 @@ _bincount_cpu(const Tensor& self, const c10::optional<Tensor>& weights_opt, int6
   });
 }
 
+///////////////// histc /////////////////
+Tensor& histc_out_cpu(const Tensor& self, int64_t bins, const Scalar& min, const Scalar& max, Tensor& result) {
+  TORCH_CHECK(bins > 0, "bins must be > 0");
+  TORCH_CHECK(self.scalar_type() == result.scalar_type(),
+              "histc: expected result to have dtype ", self.scalar_type(), " but got ", result.scalar_type());
+  at::native::resize_output(result, {bins});
+  Tensor hist = result.is_contiguous() ? result : at::empty({bins}, result.options());
+
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "histc_cpu", [&] {
+    scalar_t minval = min.to<scalar_t>();
+    scalar_t maxval = max.to<scalar_t>();
+    if (minval == maxval && self.numel() > 0) {
+      minval = self.min().item<scalar_t>();
+      maxval = self.max().item<scalar_t>();
+    }
+    if (minval == maxval) {
+      minval = minval - 1;
+      maxval = maxval + 1;
+    }
+    TORCH_CHECK(!(std::isinf(minval) || std::isinf(maxval) || std::isnan(minval) || std::isnan(maxval)),
+                "range of [", minval, ", ", maxval, "] is not finite");
+    TORCH_CHECK(minval < maxval, "max must be larger than min");
+    histc_stub(kCPU, hist, self, bins, minval, maxval);
+  });
+
+  if (!hist.is_same(result)) {
+    result.copy_(hist);
+  }
+  return result;
+}
+
+Tensor histc_cpu(const Tensor& self, int64_t bins, const Scalar& min, const Scalar& max) {
+  Tensor result = at::empty({0}, self.options());
+  return at::native::histc_out_cpu(self, bins, min, max, result);
+}
+
+DEFINE_DISPATCH(histc_stub);
+
 }} // namespace at::native
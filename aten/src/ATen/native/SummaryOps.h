@@ -0,0 +1,16 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at {
+namespace native {
+
+// Fills the contiguous `hist` with the counts of `self` over `nbins` equal
+// width bins spanning [min, max]. Elements outside the range are ignored.
+using histc_fn = void (*)(Tensor& hist, const Tensor& self, int64_t nbins, const Scalar& min, const Scalar& max);
+
+DECLARE_DISPATCH(histc_fn, histc_stub);
+
+} // namespace native
+} // namespace at
@@ -62,8 +62,10 @@
 #include <ATen/Parallel.h>
 
 #include <c10/util/irange.h>
+#include <c10/util/llvmMathExtras.h>
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
 #include <numeric>
 #include <vector>
@@ -1144,6 +1146,76 @@ Tensor masked_fill(const Tensor & self, const Tensor & mask, const Tensor & sour
   return result;
 }
 
+// Note [Parallel stream compaction]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// nonzero and masked_select write the selected elements of their input densely,
+// in logical order. Both split [0, numel) into fixed chunks, count the selected
+// elements of every chunk in parallel and turn the counts into per-chunk output
+// offsets with an exclusive scan, after which every chunk writes its part of the
+// output independently.
+
+// Returns the output offset of every chunk of `chunk_size` elements, followed by
+// the total. `count(begin, end)` returns the number of selected elements in
+// [begin, end).
+template <typename count_t>
+static std::vector<int64_t> parallel_chunk_offsets(int64_t numel, int64_t chunk_size, const count_t& count) {
+  const int64_t num_chunks = at::divup(numel, chunk_size);
+  std::vector<int64_t> offsets(num_chunks + 1, 0);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      offsets[c + 1] = count(c * chunk_size, std::min(numel, (c + 1) * chunk_size));
+    }
+  });
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  return offsets;
+}
+
+// Number of true values in a contiguous bool array. A bool is a byte holding 0
+// or 1, so the popcount of eight of them read as a uint64_t counts the true ones.
+static int64_t count_true(const bool* data, int64_t n) {
+  int64_t count = 0;
+  int64_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    count += llvm::countPopulation(word);
+  }
+  for (; i < n; i++) {
+    count += data[i];
+  }
+  return count;
+}
+
+template <typename mask_t>
+static int64_t count_mask(const mask_t* data, int64_t n) {
+  return std::count_if(data, data + n, [](mask_t m) { return m != 0; });
+}
+
+template <>
+int64_t count_mask<bool>(const bool* data, int64_t n) {
+  return count_true(data, n);
+}
+
+// Writes the inclusive prefix sum of a contiguous mask into prefix_sum
+template <typename mask_t>
+static void masked_select_prefix_sum(const Tensor& mask, int64_t* prefix_sum) {
+  const auto* mask_data = mask.data_ptr<mask_t>();
+  const int64_t numel = mask.numel();
+  const int64_t chunk_size = at::internal::GRAIN_SIZE;
+  const auto offsets = parallel_chunk_offsets(numel, chunk_size, [&](int64_t begin, int64_t end) {
+    return count_mask(mask_data + begin, end - begin);
+  });
+  at::parallel_for(0, offsets.size() - 1, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      int64_t sum = offsets[c];
+      for (int64_t i = c * chunk_size; i < std::min(numel, (c + 1) * chunk_size); i++) {
+        sum += mask_data[i] != 0;
+        prefix_sum[i] = sum;
+      }
+    }
+  });
+}
+
 static Tensor & masked_select_out_impl_cpu(Tensor & result, const Tensor & self, const Tensor & mask) {
   NoNamesGuard guard;
 
@@ -1198,15 +1270,15 @@ static Tensor & masked_select_out_impl_cpu(Tensor & result, const Tensor & self,
   }
 
   // Use a prefix sum to record the output locations of the masked elements,
-  // so as to parallel with TensorIterator.
-  auto mask_long = at::empty(shape, self.options().dtype(at::kLong)).copy_(*_mask);
+  // so as to parallel with TensorIterator. See Note [Parallel stream compaction]
+  auto mask_contig = _mask->contiguous();
   auto mask_prefix_sum = at::empty(shape, self.options().dtype(at::kLong));
-  auto mask_long_data = mask_long.data_ptr<int64_t>();
   auto mask_prefix_sum_data = mask_prefix_sum.data_ptr<int64_t>();
-  // TODO: Here can only use std::partial_sum for C++14,
-  // use std::exclusive_scan when PyTorch upgrades to C++17, which have better peformance.
-  // std::exclusive_scan(mask_long_data, mask_long_data + mask_long.numel(), mask_prefix_sum_data, 0);
-  std::partial_sum(mask_long_data, mask_long_data + mask_long.numel(), mask_prefix_sum_data);
+  if (mask_contig.scalar_type() == ScalarType::Bool) {
+    masked_select_prefix_sum<bool>(mask_contig, mask_prefix_sum_data);
+  } else {
+    masked_select_prefix_sum<uint8_t>(mask_contig, mask_prefix_sum_data);
+  }
 
   auto iter = TensorIteratorConfig()
     .set_check_mem_overlap(false)  // result is intenionally zero-strided above
@@ -1232,6 +1304,79 @@ Tensor masked_select_cpu(const Tensor & self, const Tensor & mask) {
   return at::native::masked_select_out_cpu(self, mask, result);
 }
 
+// See Note [Parallel stream compaction]
+template <typename scalar_t>
+static void nonzero_cpu_template(const Tensor& self, Tensor& result) {
+  const auto self_contig = self.expect_contiguous();
+  const auto* self_data = self_contig->data_ptr<scalar_t>();
+  const int64_t numel = self.numel();
+  const int64_t ndim = self.dim();
+  const int64_t chunk_size = at::internal::GRAIN_SIZE;
+
+  const auto offsets = parallel_chunk_offsets(numel, chunk_size, [&](int64_t begin, int64_t end) -> int64_t {
+    if (std::is_same<scalar_t, bool>::value) {
+      return count_true(reinterpret_cast<const bool*>(self_data) + begin, end - begin);
+    }
+    return std::count_if(self_data + begin, self_data + end,
+                         [](scalar_t value) { return value != scalar_t(0); });
+  });
+  const int64_t num_nonzero = offsets.back();
+  at::native::resize_output(result, {num_nonzero, ndim});
+  if (num_nonzero == 0 || ndim == 0) {
+    return;
+  }
+
+  Tensor out = result.is_contiguous() ? result : at::empty({num_nonzero, ndim}, result.options());
+  auto* out_data = out.data_ptr<int64_t>();
+  const auto sizes = self.sizes();
+  at::parallel_for(0, offsets.size() - 1, 1, [&](int64_t begin, int64_t end) {
+    DimVector index(ndim);
+    for (int64_t c = begin; c < end; c++) {
+      const int64_t chunk_begin = c * chunk_size;
+      const int64_t chunk_end = std::min(numel, chunk_begin + chunk_size);
+      if (offsets[c] == offsets[c + 1]) {
+        continue;
+      }
+      int64_t linear = chunk_begin;
+      for (int64_t d = ndim - 1; d >= 0; d--) {
+        index[d] = linear % sizes[d];
+        linear /= sizes[d];
+      }
+      int64_t* out_ptr = out_data + offsets[c] * ndim;
+      for (int64_t i = chunk_begin; i < chunk_end; i++) {
+        if (self_data[i] != scalar_t(0)) {
+          std::copy(index.begin(), index.end(), out_ptr);
+          out_ptr += ndim;
+        }
+        for (int64_t d = ndim - 1; d >= 0 && ++index[d] == sizes[d]; d--) {
+          index[d] = 0;
+        }
+      }
+    }
+  });
+  if (!out.is_same(result)) {
+    result.copy_(out);
+  }
+}
+
+Tensor& nonzero_out_cpu(const Tensor& self, Tensor& result) {
+  TORCH_CHECK(result.scalar_type() == kLong,
+              "nonzero: Expected out tensor to have scalar type Long but got scalar type ", result.scalar_type());
+  at::assert_no_internal_overlap(result);
+  at::assert_no_overlap(result, self);
+
+  AT_DISPATCH_ALL_TYPES_AND3(ScalarType::Half, ScalarType::BFloat16, ScalarType::Bool,
+                             self.scalar_type(), "nonzero_cpu", [&] {
+    nonzero_cpu_template<scalar_t>(self, result);
+  });
+  return result;
+}
+
+Tensor nonzero_cpu(const Tensor& self) {
+  Tensor result = at::empty({0}, self.options().dtype(kLong));
+  return at::native::nonzero_out_cpu(self, result);
+}
+
 Tensor masked_select_backward(const Tensor& grad, const Tensor& input, const Tensor& mask) {
   // The following could just be written as `zeros_like(input).masked_scatter(mask, grad)`.
   // However, as an optimization, we call the in-place variant of masked_scatter.
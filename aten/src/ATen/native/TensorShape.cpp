@@ -30,6 +30,7 @@ namespace at {
 namespace native {
 
 DEFINE_DISPATCH(cat_serial_stub);
+DEFINE_DISPATCH(cat_strided_stub);
 DEFINE_DISPATCH(stack_serial_stub);
 
 Tensor _reshape_from_tensor(const Tensor& self, const Tensor& shape_tensor) {
@@ -156,9 +157,6 @@ Tensor & _cat_out_cpu(TensorList tensors, int64_t dim, Tensor& result) {
   TORCH_CHECK(tensors.size() > 0, "torch.cat(): expected a non-empty list of Tensors");
   TORCH_CHECK(dim <= notSkippedTensor.dim(), "torch.cat(): dimension ", dim, "out of range");
 
-  // when the input tensors are of the same size and strides,
-  // reuse the same iterator for all input tensors
-  bool reuse_iterator = true;
   bool no_type_promotion = true;
   // Check the type of the result
   no_type_promotion = result.dtype() == notSkippedTensor.dtype();
@@ -180,10 +178,6 @@ Tensor & _cat_out_cpu(TensorList tensors, int64_t dim, Tensor& result) {
       allContiguous = false;
     }
 
-    if (tensor.sizes() != notSkippedTensor.sizes() ||
-        tensor.strides() != notSkippedTensor.strides()) {
-      reuse_iterator = false;
-    }
     if (tensor.dtype() != notSkippedTensor.dtype()) {
       no_type_promotion = false;
     }
@@ -211,55 +205,32 @@ Tensor & _cat_out_cpu(TensorList tensors, int64_t dim, Tensor& result) {
     return result;
   }
 
+  // inputs of the result dtype are copied in one parallel pass over all of
+  // them, whatever their strides and memory formats
+  if (no_type_promotion) {
+    cat_strided_stub(kCPU, result, tensors, dim);
+    return result;
+  }
+
   int64_t offset = 0;
-  if (reuse_iterator &&
-      result.is_contiguous(first_tensor_mem_format) &&
-      no_type_promotion) {
-    const auto& source_slice = notSkippedTensor;
-    auto slice_dim_size = source_slice.sizes()[dim];
-    auto result_slice = result.narrow(dim, 0, slice_dim_size);
-    auto result_slice_data = result_slice.data_ptr();
-    auto result_stride_bytes = result.stride(dim) * elementSize(result.scalar_type());
+  for (auto const &tensor: tensors) {
+    if (should_skip(tensor)) {
+      continue;
+    }
+    auto slice_dim_size = tensor.sizes()[dim];
+    auto result_slice = result.narrow(dim, offset, slice_dim_size);
 
     auto iter = TensorIteratorConfig()
       .set_check_mem_overlap(false)  // Already checked above
       .resize_outputs(false)
       .add_output(result_slice)
-      .add_input(source_slice)
+      .add_input(tensor)
+      .promote_inputs_to_common_dtype(true)
+      .cast_common_dtype_to_outputs(true)
       .enforce_safe_casting_to_output(true)
       .build();
-
-    for (auto const &tensor : tensors) {
-      if (should_skip(tensor)) {
-        continue;
-      }
-      auto source_data = static_cast<char*>(tensor.data_ptr());
-      auto result_data = static_cast<char*>(result_slice_data) + offset * result_stride_bytes;
-      iter.unsafe_replace_operand(0, result_data);
-      iter.unsafe_replace_operand(1, source_data);
-      copy_stub(iter.device_type(), iter, false);
-      offset += slice_dim_size;
-    }
-  } else {
-    for (auto const &tensor: tensors) {
-      if (should_skip(tensor)) {
-        continue;
-      }
-      auto slice_dim_size = tensor.sizes()[dim];
-      auto result_slice = result.narrow(dim, offset, slice_dim_size);
-
-      auto iter = TensorIteratorConfig()
-        .set_check_mem_overlap(false)  // Already checked above
-        .resize_outputs(false)
-        .add_output(result_slice)
-        .add_input(tensor)
-        .promote_inputs_to_common_dtype(true)
-        .cast_common_dtype_to_outputs(true)
-        .enforce_safe_casting_to_output(true)
-        .build();
-      copy_stub(iter.device_type(), iter, false);
-      offset += slice_dim_size;
-    }
+    copy_stub(iter.device_type(), iter, false);
+    offset += slice_dim_size;
   }
 
   return result;
@@ -0,0 +1,282 @@
+#include <ATen/native/Transformer.h>
+
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+
+#include <cmath>
+#include <limits>
+
+namespace at { namespace native {
+
+DEFINE_DISPATCH(transform_bias_rescale_qkv_stub);
+DEFINE_DISPATCH(masked_softmax_stub);
+DEFINE_DISPATCH(bias_residual_layer_norm_stub);
+DEFINE_DISPATCH(fused_dropout_add_layer_norm_stub);
+DEFINE_DISPATCH(fused_dropout_add_layer_norm_backward_stub);
+
+std::tuple<Tensor, Tensor, Tensor> transform_bias_rescale_qkv(
+    const Tensor& qkv,
+    const Tensor& qkv_bias,
+    int64_t num_heads) {
+  TORCH_CHECK(qkv.dim() == 3, "_transform_bias_rescale_qkv: expected a 3-d qkv, but got ", qkv.dim(), "-d");
+  const int64_t B = qkv.size(0);
+  const int64_t S = qkv.size(1);
+  TORCH_CHECK(
+      qkv.size(2) % 3 == 0 && (qkv.size(2) / 3) % num_heads == 0,
+      "_transform_bias_rescale_qkv: the last dim of qkv, ", qkv.size(2),
+      ", isn't 3 * num_heads * head_dim for num_heads = ", num_heads);
+  TORCH_CHECK(
+      qkv_bias.dim() == 1 && qkv_bias.size(0) == qkv.size(2),
+      "_transform_bias_rescale_qkv: expected a qkv_bias of size ", qkv.size(2));
+  const int64_t D = qkv.size(2) / 3 / num_heads;
+
+  auto q = at::empty({B, num_heads, S, D}, qkv.options());
+  auto k = at::empty_like(q);
+  auto v = at::empty_like(q);
+  if (q.numel() > 0) {
+    transform_bias_rescale_qkv_stub(
+        qkv.device().type(), qkv.contiguous(),
+        qkv_bias.to(qkv.scalar_type()).contiguous(), num_heads, q, k, v);
+  }
+  return std::make_tuple(q, k, v);
+}
+
+Tensor masked_softmax(const Tensor& self, const c10::optional<Tensor>& mask_opt) {
+  const Tensor& mask = c10::value_or_else(mask_opt, [] {return Tensor();});
+  TORCH_CHECK(
+      self.dim() == 4 && self.size(2) == self.size(3),
+      "_masked_softmax: expected (B, H, S, S) scores, but got ", self.sizes());
+  if (mask.defined()) {
+    TORCH_CHECK(
+        mask.scalar_type() == kBool && mask.dim() == 2 &&
+            mask.size(0) == self.size(0) && mask.size(1) == self.size(3),
+        "_masked_softmax: expected a (B, S) bool mask, but got ", mask.sizes(),
+        " ", mask.scalar_type());
+  }
+  auto result = at::empty_like(self, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  if (result.numel() > 0) {
+    masked_softmax_stub(
+        self.device().type(), self.contiguous(),
+        mask.defined() ? mask.contiguous() : mask, result);
+  }
+  return result;
+}
+
+Tensor bias_residual_layer_norm(
+    const Tensor& self,
+    const Tensor& bias,
+    const Tensor& residual,
+    const Tensor& weight,
+    const Tensor& ln_bias,
+    double eps) {
+  TORCH_CHECK(self.dim() == 2, "_bias_residual_layer_norm: expected a 2-d self, but got ", self.dim(), "-d");
+  TORCH_CHECK(
+      residual.sizes() == self.sizes(),
+      "_bias_residual_layer_norm: residual of size ", residual.sizes(),
+      " doesn't match self of size ", self.sizes());
+  const int64_t N = self.size(1);
+  for (const Tensor* t : {&bias, &weight, &ln_bias}) {
+    TORCH_CHECK(
+        t->dim() == 1 && t->size(0) == N,
+        "_bias_residual_layer_norm: expected bias, weight and ln_bias of size ", N);
+  }
+  const auto dtype = self.scalar_type();
+  auto result = at::empty_like(self, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  if (result.numel() > 0) {
+    bias_residual_layer_norm_stub(
+        self.device().type(), self.contiguous(), bias.to(dtype).contiguous(),
+        residual.to(dtype).contiguous(), weight.to(dtype).contiguous(),
+        ln_bias.to(dtype).contiguous(), eps, result);
+  }
+  return result;
+}
+
+std::tuple<Tensor, Tensor, Tensor, Tensor> fused_dropout_add_layer_norm(
+    const Tensor& self,
+    const Tensor& residual,
+    const Tensor& weight,
+    const Tensor& bias,
+    double p,
+    bool train,
+    double eps,
+    c10::optional<Generator> gen) {
+  TORCH_CHECK(self.dim() >= 1, "_fused_dropout_add_layer_norm: expected a self of at least 1 dim");
+  TORCH_CHECK(
+      p >= 0 && p <= 1,
+      "_fused_dropout_add_layer_norm: dropout probability has to be between 0 and 1, but got ", p);
+  TORCH_CHECK(
+      residual.sizes() == self.sizes(),
+      "_fused_dropout_add_layer_norm: residual of size ", residual.sizes(),
+      " doesn't match self of size ", self.sizes());
+  const int64_t N = self.size(-1);
+  const int64_t M = N == 0 ? 0 : self.numel() / N;
+  for (const Tensor* t : {&weight, &bias}) {
+    TORCH_CHECK(
+        t->dim() == 1 && t->size(0) == N,
+        "_fused_dropout_add_layer_norm: expected weight and bias of size ", N);
+  }
+  const auto dtype = self.scalar_type();
+  // The statistics are kept in float for reduced precision inputs
+  const auto stat_dtype = (dtype == kHalf || dtype == kBFloat16) ? kFloat : dtype;
+  auto result = at::empty_like(self, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  auto mean = at::empty({M}, self.options().dtype(stat_dtype));
+  auto rstd = at::empty({M}, self.options().dtype(stat_dtype));
+  // Stays zeros when no element is dropped
+  auto rng_state = at::zeros({2}, self.options().dtype(kLong));
+  if (result.numel() > 0) {
+    fused_dropout_add_layer_norm_stub(
+        self.device().type(), self.contiguous().view({M, N}),
+        residual.to(dtype).contiguous().view({M, N}), weight.to(dtype).contiguous(),
+        bias.to(dtype).contiguous(), train ? p : 0, eps, gen, result.view({M, N}),
+        mean, rstd, rng_state);
+  }
+  return std::make_tuple(result, mean, rstd, rng_state);
+}
+
+std::tuple<Tensor, Tensor, Tensor, Tensor> fused_dropout_add_layer_norm_backward(
+    const Tensor& grad_out,
+    const Tensor& self,
+    const Tensor& residual,
+    const Tensor& weight,
+    const Tensor& mean,
+    const Tensor& rstd,
+    const Tensor& rng_state,
+    double p,
+    bool train,
+    std::array<bool, 4> output_mask) {
+  const auto dtype = self.scalar_type();
+  auto grad_self = at::empty_like(self, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  auto grad_residual = at::empty_like(self, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  Tensor grad_weight, grad_bias;
+  if (output_mask[2]) {
+    grad_weight = at::empty(weight.sizes(), self.options());
+  }
+  if (output_mask[3]) {
+    grad_bias = at::empty(weight.sizes(), self.options());
+  }
+  if (self.numel() > 0) {
+    const int64_t N = self.size(-1);
+    const int64_t M = self.numel() / N;
+    fused_dropout_add_layer_norm_backward_stub(
+        self.device().type(), grad_out.to(dtype).contiguous().view({M, N}),
+        self.contiguous().view({M, N}), residual.to(dtype).contiguous().view({M, N}),
+        weight.to(dtype).contiguous(), mean, rstd, rng_state, train ? p : 0,
+        grad_self.view({M, N}), grad_residual.view({M, N}), grad_weight, grad_bias);
+  } else {
+    for (Tensor* t : {&grad_weight, &grad_bias}) {
+      if (t->defined()) {
+        t->zero_();
+      }
+    }
+  }
+  return std::make_tuple(
+      output_mask[0] ? grad_self : Tensor(),
+      output_mask[1] ? grad_residual.to(residual.scalar_type()) : Tensor(),
+      output_mask[2] ? grad_weight.to(weight.scalar_type()) : Tensor(),
+      output_mask[3] ? grad_bias.to(weight.scalar_type()) : Tensor());
+}
+
+Tensor transformer_encoder_layer_forward(
+    const Tensor& src,
+    int64_t num_heads,
+    const Tensor& qkv_weight,
+    const Tensor& qkv_bias,
+    const Tensor& proj_weight,
+    const Tensor& proj_bias,
+    const Tensor& norm_weight_1,
+    const Tensor& norm_bias_1,
+    const Tensor& norm_weight_2,
+    const Tensor& norm_bias_2,
+    const Tensor& ffn_weight_1,
+    const Tensor& ffn_bias_1,
+    const Tensor& ffn_weight_2,
+    const Tensor& ffn_bias_2,
+    bool use_gelu,
+    double eps,
+    const c10::optional<Tensor>& src_mask_opt,
+    const c10::optional<Tensor>& src_key_padding_mask_opt) {
+  const Tensor& src_mask = c10::value_or_else(src_mask_opt, [] {return Tensor();});
+  const Tensor& key_padding_mask = c10::value_or_else(src_key_padding_mask_opt, [] {return Tensor();});
+  TORCH_CHECK(src.dim() == 3, "_transformer_encoder_layer_fwd: expected a (S, B, E) src, but got ", src.sizes());
+  const int64_t S = src.size(0);
+  const int64_t B = src.size(1);
+  const int64_t E = src.size(2);
+  TORCH_CHECK(
+      num_heads > 0 && E % num_heads == 0,
+      "_transformer_encoder_layer_fwd: embedding dim ", E,
+      " isn't divisible by num_heads ", num_heads);
+  const int64_t D = E / num_heads;
+
+  // Rows of the non-padding tokens in the (B * S, E) batch major tokens;
+  // undefined without padding
+  Tensor token_index;
+  if (key_padding_mask.defined()) {
+    TORCH_CHECK(
+        key_padding_mask.scalar_type() == kBool &&
+            key_padding_mask.sizes() == IntArrayRef({B, S}),
+        "_transformer_encoder_layer_fwd: expected a (B, S) bool src_key_padding_mask, but got ",
+        key_padding_mask.sizes(), " ", key_padding_mask.scalar_type());
+    token_index = key_padding_mask.logical_not().reshape({B * S}).nonzero().squeeze(1);
+    if (token_index.numel() == B * S) {
+      token_index = Tensor();
+    }
+  }
+  auto pack = [&](const Tensor& rows) {
+    return token_index.defined() ? rows.index_select(0, token_index) : rows;
+  };
+  auto unpack = [&](const Tensor& tokens) {
+    if (!token_index.defined()) {
+      return tokens;
+    }
+    return at::zeros({B * S, tokens.size(1)}, tokens.options())
+        .index_copy_(0, token_index, tokens);
+  };
+
+  const Tensor tokens = pack(src.transpose(0, 1).reshape({B * S, E}));
+
+  // Packed QKV projection, whose bias _transform_bias_rescale_qkv adds
+  const Tensor qkv = unpack(at::mm(tokens, qkv_weight.t())).view({B, S, 3 * E});
+  Tensor q, k, v;
+  std::tie(q, k, v) = at::_transform_bias_rescale_qkv(qkv, qkv_bias, num_heads);
+  q = q.view({B * num_heads, S, D});
+  k = k.view({B * num_heads, S, D});
+  v = v.view({B * num_heads, S, D});
+
+  // q is already scaled; an attention mask is added by the score bmm
+  Tensor scores;
+  if (src_mask.defined()) {
+    TORCH_CHECK(
+        src_mask.sizes() == IntArrayRef({S, S}),
+        "_transformer_encoder_layer_fwd: expected a (S, S) src_mask, but got ", src_mask.sizes());
+    Tensor attn_mask = src_mask;
+    if (src_mask.scalar_type() == kBool) {
+      attn_mask = at::zeros({S, S}, q.options())
+          .masked_fill_(src_mask, -std::numeric_limits<double>::infinity());
+    }
+    scores = at::baddbmm(
+        attn_mask.to(q.scalar_type()).expand({B * num_heads, S, S}), q,
+        k.transpose(1, 2));
+  } else {
+    scores = at::bmm(q, k.transpose(1, 2));
+  }
+  const Tensor probs =
+      at::_masked_softmax(scores.view({B, num_heads, S, S}), key_padding_mask);
+  const Tensor attn = at::bmm(probs.view({B * num_heads, S, S}), v)
+                          .view({B, num_heads, S, D})
+                          .transpose(1, 2)
+                          .reshape({B * S, E});
+
+  const Tensor x1 = at::_bias_residual_layer_norm(
+      at::mm(pack(attn), proj_weight.t()), proj_bias, tokens, norm_weight_1,
+      norm_bias_1, eps);
+  const Tensor hidden = at::_addmm_activation(
+      ffn_bias_1, x1, ffn_weight_1.t(), 1, 1, use_gelu);
+  const Tensor x2 = at::_bias_residual_layer_norm(
+      at::mm(hidden, ffn_weight_2.t()), ffn_bias_2, x1, norm_weight_2,
+      norm_bias_2, eps);
+
+  // A view of the batch major result, which the next layer takes without a copy
+  return unpack(x2).view({B, S, E}).transpose(0, 1);
+}
+
+}} // namespace at::native
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/core/PhiloxRNGEngine.h>
+#include <ATen/native/DispatchStub.h>
+#include <c10/macros/Macros.h>
+
+namespace at { namespace native {
+
+// Kernels of the ops of the transformer encoder fast path, see
+// _transformer_encoder_layer_fwd in native_functions.yaml. All the tensors
+// are contiguous and the outputs are allocated by the caller.
+
+// qkv: (B, S, 3 * E), qkv_bias: (3 * E); q, k, v: (B, num_heads, S, E / num_heads)
+using transform_bias_rescale_qkv_fn = void (*)(const Tensor& qkv,
+    const Tensor& qkv_bias, int64_t num_heads, const Tensor& q,
+    const Tensor& k, const Tensor& v);
+// self, result: (B, H, S, S); mask: (B, S) bool or undefined
+using masked_softmax_fn = void (*)(const Tensor& self, const Tensor& mask,
+    const Tensor& result);
+// self, residual, result: (M, N); bias, weight, ln_bias: (N)
+using bias_residual_layer_norm_fn = void (*)(const Tensor& self,
+    const Tensor& bias, const Tensor& residual, const Tensor& weight,
+    const Tensor& ln_bias, double eps, const Tensor& result);
+// self, residual, result: (M, N); weight, bias: (N); mean, rstd: (M);
+// rng_state: (2) int64 on the device of self, written by the kernel
+using fused_dropout_add_layer_norm_fn = void (*)(const Tensor& self,
+    const Tensor& residual, const Tensor& weight, const Tensor& bias,
+    double p, double eps, c10::optional<Generator> gen, const Tensor& result,
+    const Tensor& mean, const Tensor& rstd, const Tensor& rng_state);
+// grad_out, self, residual, grad_self, grad_residual: (M, N); weight: (N);
+// grad_weight, grad_bias: (N) or undefined
+using fused_dropout_add_layer_norm_backward_fn = void (*)(
+    const Tensor& grad_out, const Tensor& self, const Tensor& residual,
+    const Tensor& weight, const Tensor& mean, const Tensor& rstd,
+    const Tensor& rng_state, double p, const Tensor& grad_self,
+    const Tensor& grad_residual, const Tensor& grad_weight,
+    const Tensor& grad_bias);
+
+DECLARE_DISPATCH(transform_bias_rescale_qkv_fn, transform_bias_rescale_qkv_stub);
+DECLARE_DISPATCH(masked_softmax_fn, masked_softmax_stub);
+DECLARE_DISPATCH(bias_residual_layer_norm_fn, bias_residual_layer_norm_stub);
+DECLARE_DISPATCH(fused_dropout_add_layer_norm_fn, fused_dropout_add_layer_norm_stub);
+DECLARE_DISPATCH(fused_dropout_add_layer_norm_backward_fn, fused_dropout_add_layer_norm_backward_stub);
+
+// The dropout mask of _fused_dropout_add_layer_norm, from element e on.
+// Element e keeps its value when the 32 bit word word + e of the Philox
+// stream of seed, as for curand_init(seed, 0, word), is uniform below
+// 1 - p. The mask is only a function of (seed, word), which the op returns
+// as its rng_state, so the backward regenerates it instead of the forward
+// storing it.
+struct FusedDropoutMask {
+  C10_HOST_DEVICE FusedDropoutMask(uint64_t seed, uint64_t word, uint64_t e, float keep_prob)
+    : engine_(seed, /*subsequence=*/0, (word + e) / 4), keep_prob_(keep_prob) {
+    for (uint64_t i = 0; i < (word + e) % 4; i++) {
+      engine_();
+    }
+  }
+
+  // Whether the next element keeps its value
+  C10_HOST_DEVICE bool next() {
+    return static_cast<float>(engine_() & ((1u << 24) - 1)) * (1.0f / (1u << 24)) < keep_prob_;
+  }
+
+ private:
+  at::Philox4_32_10 engine_;
+  float keep_prob_;
+};
+
+}} // namespace at::native
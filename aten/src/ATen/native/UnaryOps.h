@@ -83,6 +83,9 @@ DECLARE_DISPATCH(void(*)(TensorIterator&, const Scalar& a, const Scalar& b), cla
 DECLARE_DISPATCH(
     void (*)(Tensor&, const Tensor&, int64_t, c10::optional<Generator>),
     multinomial_with_replacement_stub);
+DECLARE_DISPATCH(
+    void (*)(Tensor&, const Tensor&, const Tensor&, c10::optional<Generator>),
+    multinomial_alias_draw_stub);
 DECLARE_DISPATCH(
     void (*)(
         TensorIterator&,
@@ -2,7 +2,12 @@
 
 #include <ATen/ATen.h>
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/TensorIterator.h>
+#include <c10/util/flat_hash_map.h>
 
+#include <algorithm>
+#include <numeric>
 #include <set>
 #include <tuple>
 #include <unordered_map>
@@ -13,12 +18,206 @@ namespace native{
 
 namespace {
 
+// Splits n items into the chunks of the parallel unique kernels, at most one
+// per thread. Unlike parallel_for's own split, the bounds are the same in
+// every pass, so a pass can reuse what an earlier one computed per chunk.
+struct UniqueChunks {
+  explicit UniqueChunks(int64_t n, int64_t grain_size = at::internal::GRAIN_SIZE) : n_(n) {
+    num = std::max<int64_t>(
+        1, std::min<int64_t>(at::get_num_threads(), divup(n, grain_size)));
+    size_ = divup(n, num);
+  }
+
+  int64_t begin(int64_t c) const {
+    return std::min(c * size_, n_);
+  }
+
+  int64_t end(int64_t c) const {
+    return std::min((c + 1) * size_, n_);
+  }
+
+  // Runs f(c, begin(c), end(c)) for each chunk in parallel
+  template <typename F>
+  void for_each(const F& f) const {
+    at::parallel_for(0, num, 1, [&](int64_t c_begin, int64_t c_end) {
+      for (int64_t c = c_begin; c < c_end; c++) {
+        f(c, begin(c), end(c));
+      }
+    });
+  }
+
+  int64_t num;
+
+ private:
+  int64_t n_;
+  int64_t size_;
+};
+
+template <typename scalar_t>
+bool unique_is_nan(scalar_t x) {
+  // Like the std::unordered_set of the serial path, each NaN is its own
+  // unique value
+  return x != x;
+}
+
+// Hash based unique over chunks of the flattened input. Each chunk counts its
+// values in a ska::flat_hash_map per partition of the value range, with the
+// partition bounds taken from a sorted sample. Each partition then merges
+// the maps of the chunks and sorts its values, so the output is the
+// concatenation of the partitions, sorted when they are. The inverse indices
+// are looked up in the merged maps.
+template <typename scalar_t>
+std::tuple<Tensor, Tensor, Tensor> unique_cpu_parallel_template(
+    const Tensor& self,
+    const bool sorted,
+    const bool return_inverse,
+    const bool return_counts) {
+  using map_t = ska::flat_hash_map<scalar_t, int64_t>;
+  const Tensor& input = self.contiguous();
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  const int64_t numel = input.numel();
+  const UniqueChunks chunks(numel);
+  const int64_t num_parts = chunks.num;
+
+  std::vector<scalar_t> splitters;
+  {
+    constexpr int64_t kSamplesPerPart = 32;
+    const int64_t num_samples = std::min(numel, num_parts * kSamplesPerPart);
+    std::vector<scalar_t> samples;
+    samples.reserve(num_samples);
+    for (int64_t i = 0; i < num_samples; i++) {
+      const scalar_t x = input_data[i * (numel / num_samples)];
+      if (!unique_is_nan(x)) {
+        samples.push_back(x);
+      }
+    }
+    std::sort(samples.begin(), samples.end());
+    for (int64_t k = 1; k < num_parts && !samples.empty(); k++) {
+      splitters.push_back(samples[k * samples.size() / num_parts]);
+    }
+  }
+  auto part_of = [&](scalar_t x) -> int64_t {
+    return std::upper_bound(splitters.begin(), splitters.end(), x) - splitters.begin();
+  };
+
+  // The counts of chunk c in partition k are in chunk_maps[c * num_parts + k]
+  std::vector<map_t> chunk_maps(chunks.num * num_parts);
+  std::vector<int64_t> chunk_nans(chunks.num, 0);
+  chunks.for_each([&](int64_t c, int64_t begin, int64_t end) {
+    map_t* maps = chunk_maps.data() + c * num_parts;
+    for (int64_t i = begin; i < end; i++) {
+      const scalar_t x = input_data[i];
+      if (unique_is_nan(x)) {
+        chunk_nans[c]++;
+      } else {
+        maps[part_of(x)][x]++;
+      }
+    }
+  });
+
+  // Merges the partitions, whose values are then listed in part_values
+  std::vector<map_t> part_maps(num_parts);
+  std::vector<std::vector<scalar_t>> part_values(num_parts);
+  at::parallel_for(0, num_parts, 1, [&](int64_t k_begin, int64_t k_end) {
+    for (int64_t k = k_begin; k < k_end; k++) {
+      map_t& merged = part_maps[k];
+      for (int64_t c = 0; c < chunks.num; c++) {
+        map_t& chunk_map = chunk_maps[c * num_parts + k];
+        if (merged.empty()) {
+          merged.swap(chunk_map);
+        } else {
+          for (const auto& kv : chunk_map) {
+            merged[kv.first] += kv.second;
+          }
+          map_t().swap(chunk_map);
+        }
+      }
+      std::vector<scalar_t>& values = part_values[k];
+      values.reserve(merged.size());
+      for (const auto& kv : merged) {
+        values.push_back(kv.first);
+      }
+      if (sorted) {
+        std::sort(values.begin(), values.end());
+      }
+    }
+  });
+
+  // NaNs go last, in the order of the input, like sort puts them
+  std::vector<int64_t> part_offsets(num_parts + 1, 0);
+  for (int64_t k = 0; k < num_parts; k++) {
+    part_offsets[k + 1] = part_offsets[k] + part_values[k].size();
+  }
+  std::vector<int64_t> nan_offsets(chunks.num + 1, part_offsets[num_parts]);
+  for (int64_t c = 0; c < chunks.num; c++) {
+    nan_offsets[c + 1] = nan_offsets[c] + chunk_nans[c];
+  }
+  const int64_t num_unique = nan_offsets[chunks.num];
+
+  Tensor output = at::empty({num_unique}, input.options());
+  Tensor inverse_indices = at::empty({0}, self.options().dtype(kLong));
+  Tensor counts = at::empty({0}, self.options().dtype(kLong));
+  if (return_counts) {
+    counts.resize_({num_unique});
+  }
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+  int64_t* counts_data = return_counts ? counts.data_ptr<int64_t>() : nullptr;
+  // The merged maps now give the index of each value in the output
+  at::parallel_for(0, num_parts, 1, [&](int64_t k_begin, int64_t k_end) {
+    for (int64_t k = k_begin; k < k_end; k++) {
+      const std::vector<scalar_t>& values = part_values[k];
+      for (size_t j = 0; j < values.size(); j++) {
+        const int64_t index = part_offsets[k] + j;
+        int64_t& entry = part_maps[k][values[j]];
+        output_data[index] = values[j];
+        if (counts_data) {
+          counts_data[index] = entry;
+        }
+        entry = index;
+      }
+    }
+  });
+
+  const bool with_nans = num_unique > part_offsets[num_parts];
+  if (return_inverse || return_counts || with_nans) {
+    if (return_inverse || return_counts) {
+      inverse_indices.resize_(input.sizes());
+    }
+    int64_t* inverse_data = inverse_indices.numel() > 0 ? inverse_indices.data_ptr<int64_t>() : nullptr;
+    chunks.for_each([&](int64_t c, int64_t begin, int64_t end) {
+      int64_t nan_index = nan_offsets[c];
+      for (int64_t i = begin; i < end; i++) {
+        const scalar_t x = input_data[i];
+        int64_t index;
+        if (unique_is_nan(x)) {
+          output_data[nan_index] = x;
+          if (counts_data) {
+            counts_data[nan_index] = 1;
+          }
+          index = nan_index++;
+        } else if (inverse_data) {
+          index = part_maps[part_of(x)].find(x)->second;
+        } else {
+          continue;
+        }
+        if (inverse_data) {
+          inverse_data[i] = index;
+        }
+      }
+    });
+  }
+  return std::make_tuple(output, inverse_indices, counts);
+}
+
 template <typename scalar_t>
 std::tuple<Tensor, Tensor, Tensor> unique_cpu_template(
     const Tensor& self,
     const bool sorted,
     const bool return_inverse,
     const bool return_counts) {
+  if (at::get_num_threads() > 1 && self.numel() >= 2 * at::internal::GRAIN_SIZE) {
+    return unique_cpu_parallel_template<scalar_t>(self, sorted, return_inverse, return_counts);
+  }
   const Tensor& input = self.contiguous();
   const scalar_t* input_data = input.data_ptr<scalar_t>();
   int64_t numel = input.numel();
@@ -69,11 +268,81 @@ std::tuple<Tensor, Tensor, Tensor> unique_cpu_template(
   return std::make_tuple(output, inverse_indices, counts);
 }
 
+// A run starts at i == 0 and wherever input[i] != input[i - 1]. A first pass
+// counts the runs starting in each chunk, which gives each chunk the output
+// index of its first run; a second pass writes the runs.
+template <typename scalar_t>
+std::tuple<Tensor, Tensor, Tensor> unique_consecutive_cpu_parallel_template(
+    const Tensor& self,
+    const bool return_inverse,
+    const bool return_counts) {
+  const Tensor& input = self.contiguous();
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  const int64_t numel = input.numel();
+  const UniqueChunks chunks(numel);
+  auto starts_run = [&](int64_t i) {
+    return i == 0 || input_data[i] != input_data[i - 1];
+  };
+
+  std::vector<int64_t> run_offsets(chunks.num + 1, 0);
+  chunks.for_each([&](int64_t c, int64_t begin, int64_t end) {
+    int64_t runs = 0;
+    for (int64_t i = begin; i < end; i++) {
+      runs += starts_run(i);
+    }
+    run_offsets[c + 1] = runs;
+  });
+  std::partial_sum(run_offsets.begin(), run_offsets.end(), run_offsets.begin());
+  const int64_t num_runs = run_offsets[chunks.num];
+
+  Tensor output = at::empty({num_runs}, input.options());
+  Tensor inverse_indices = at::empty({0}, self.options().dtype(kLong));
+  Tensor counts = at::empty({0}, self.options().dtype(kLong));
+  if (return_inverse) {
+    inverse_indices.resize_(input.sizes());
+  }
+  if (return_counts) {
+    counts.resize_({num_runs});
+  }
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+  int64_t* inverse_data = return_inverse ? inverse_indices.data_ptr<int64_t>() : nullptr;
+  // The start of each run, from which the counts are computed
+  std::vector<int64_t> run_starts(return_counts ? num_runs + 1 : 0, numel);
+  chunks.for_each([&](int64_t c, int64_t begin, int64_t end) {
+    // The index of the run holding element begin - 1, if any
+    int64_t run = run_offsets[c] - 1;
+    for (int64_t i = begin; i < end; i++) {
+      if (starts_run(i)) {
+        run++;
+        output_data[run] = input_data[i];
+        if (return_counts) {
+          run_starts[run] = i;
+        }
+      }
+      if (inverse_data) {
+        inverse_data[i] = run;
+      }
+    }
+  });
+  if (return_counts) {
+    int64_t* counts_data = counts.data_ptr<int64_t>();
+    at::parallel_for(0, num_runs, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+      for (int64_t r = begin; r < end; r++) {
+        counts_data[r] = run_starts[r + 1] - run_starts[r];
+      }
+    });
+  }
+  return std::make_tuple(output, inverse_indices, counts);
+}
+
 template <typename scalar_t>
 std::tuple<Tensor, Tensor, Tensor> unique_consecutive_cpu_template(
     const Tensor& self,
     const bool return_inverse,
     const bool return_counts) {
+  if (at::get_num_threads() > 1 && self.numel() >= 2 * at::internal::GRAIN_SIZE) {
+    return unique_consecutive_cpu_parallel_template<scalar_t>(self, return_inverse, return_counts);
+  }
   const Tensor& input = self.contiguous();
   const scalar_t* input_data = input.data_ptr<scalar_t>();
   int64_t numel = input.numel();
@@ -121,32 +390,25 @@ std::tuple<Tensor, Tensor, Tensor> unique_consecutive_cpu_template(
   return std::make_tuple(output, inverse_indices, counts);
 }
 
-template<class ForwardIt>
-ForwardIt _unique_dim_cpu_impl(ForwardIt first, ForwardIt last,
-  std::vector<int64_t>& indices, Tensor inverse_indices_vec, Tensor counts) {
-    if (first == last) {
-      return last;
-    }
-    // save to calculate distance to iterators
-    ForwardIt begin = first;
-
-    // set first inverse index and count
-    inverse_indices_vec[indices[0]] = 0;
-    counts[0] += 1;
-
-    ForwardIt result = first;
-    while (++first != last) {
-      if (!at::equal(*result, *first) && ++result != first) {
-          *result = std::move(*first);
+// Sorts v with std::sort on parallel chunks, then merges pairs of sorted
+// chunks in parallel rounds
+template <typename T, typename Compare>
+void unique_parallel_sort(std::vector<T>& v, int64_t grain_size, const Compare& comp) {
+  const UniqueChunks chunks(v.size(), grain_size);
+  chunks.for_each([&](int64_t /*c*/, int64_t begin, int64_t end) {
+    std::sort(v.begin() + begin, v.begin() + end, comp);
+  });
+  for (int64_t width = 1; width < chunks.num; width *= 2) {
+    at::parallel_for(0, divup(chunks.num, 2 * width), 1, [&](int64_t p_begin, int64_t p_end) {
+      for (int64_t p = p_begin; p < p_end; p++) {
+        const int64_t first = chunks.begin(2 * p * width);
+        const int64_t middle = chunks.begin(std::min((2 * p + 1) * width, chunks.num));
+        const int64_t last = chunks.begin(std::min((2 * p + 2) * width, chunks.num));
+        std::inplace_merge(v.begin() + first, v.begin() + middle, v.begin() + last, comp);
       }
-      int64_t idx_result = std::distance(begin, result);
-      int64_t idx_first = std::distance(begin, first);
-      inverse_indices_vec[indices[idx_first]] = idx_result;
-      counts[idx_result] += 1;
-    }
-
-    return ++result;
+    });
   }
+}
 
 template <typename scalar_t>
 std::tuple<Tensor, Tensor, Tensor> _unique_dim_cpu_template(
@@ -181,14 +443,18 @@ std::tuple<Tensor, Tensor, Tensor> _unique_dim_cpu_template(
   auto orig_sizes = input_flat.sizes().vec();
   input_flat = input_flat.contiguous().view({input_flat.size(0), -1});
 
-  std::vector<int64_t> indices(input_flat.size(0));
+  const int64_t num_rows = input_flat.size(0);
+  const int64_t numel = input_flat.size(1);
+  const scalar_t* input_flat_ptr = input_flat.data_ptr<scalar_t>();
+  // Rows take numel element comparisons each
+  const int64_t grain_size = std::max<int64_t>(1, at::internal::GRAIN_SIZE / numel);
+
+  std::vector<int64_t> indices(num_rows);
   std::iota(indices.begin(), indices.end(), 0);
-  int64_t numel = input_flat.size(1);
-  scalar_t* input_flat_ptr = ((scalar_t*)input_flat.data_ptr());
 
   // sort indices using data
   if (!consecutive) {
-    std::sort(indices.begin(), indices.end(),
+    unique_parallel_sort(indices, grain_size,
       [&](int64_t a, int64_t b) -> bool {
         for (int64_t i = 0; i < numel; ++i) {
           scalar_t lhs = input_flat_ptr[i + a * numel];
@@ -203,26 +469,56 @@ std::tuple<Tensor, Tensor, Tensor> _unique_dim_cpu_template(
       });
   }
 
-  Tensor input_sorted;
-  if (!consecutive) {
-    input_sorted = at::empty(input_flat.sizes(), input_flat.options());
-    for (size_t i = 0; i < indices.size(); ++i) {
-      input_sorted[i] = input_flat[indices[i]];
+  // Position j of indices starts a group of equal rows when its row differs
+  // from the row at j - 1. Each chunk numbers its groups from the number of
+  // groups starting in the chunks before it.
+  auto starts_group = [&](int64_t j) {
+    if (j == 0) {
+      return true;
     }
-  } else {
-    input_sorted = input_flat;
+    const scalar_t* row = input_flat_ptr + indices[j] * numel;
+    const scalar_t* prev_row = input_flat_ptr + indices[j - 1] * numel;
+    return !std::equal(row, row + numel, prev_row);
+  };
+  const UniqueChunks chunks(num_rows, grain_size);
+  std::vector<uint8_t> group_starts(num_rows);
+  std::vector<int64_t> group_offsets(chunks.num + 1, 0);
+  chunks.for_each([&](int64_t c, int64_t begin, int64_t end) {
+    int64_t groups = 0;
+    for (int64_t j = begin; j < end; j++) {
+      group_starts[j] = starts_group(j);
+      groups += group_starts[j];
+    }
+    group_offsets[c + 1] = groups;
+  });
+  std::partial_sum(group_offsets.begin(), group_offsets.end(), group_offsets.begin());
+  const int64_t num_groups = group_offsets[chunks.num];
+
+  Tensor inverse_indices = at::empty(num_rows, self.options().dtype(kLong));
+  Tensor counts = at::empty(num_groups, self.options().dtype(kLong));
+  Tensor first_rows = at::empty(num_groups, self.options().dtype(kLong));
+  int64_t* inverse_data = inverse_indices.data_ptr<int64_t>();
+  int64_t* first_rows_data = first_rows.data_ptr<int64_t>();
+  // The position in indices at which each group starts, for the counts
+  std::vector<int64_t> group_begins(num_groups + 1, num_rows);
+  chunks.for_each([&](int64_t c, int64_t begin, int64_t end) {
+    int64_t group = group_offsets[c] - 1;
+    for (int64_t j = begin; j < end; j++) {
+      if (group_starts[j]) {
+        group++;
+        first_rows_data[group] = indices[j];
+        group_begins[group] = j;
+      }
+      inverse_data[indices[j]] = group;
+    }
+  });
+  int64_t* counts_data = counts.data_ptr<int64_t>();
+  for (int64_t g = 0; g < num_groups; g++) {
+    counts_data[g] = group_begins[g + 1] - group_begins[g];
   }
 
-  Tensor inverse_indices = at::empty(indices.size(), self.options().dtype(kLong));
-  Tensor counts = at::zeros(indices.size(), self.options().dtype(kLong));
-  std::vector<Tensor> input_unbind = at::unbind(input_sorted, 0);
-  auto last = _unique_dim_cpu_impl(
-    input_unbind.begin(), input_unbind.end(), indices, inverse_indices, counts);
-  input_unbind.erase(last, input_unbind.end());
-  counts = at::narrow(counts, 0, 0, input_unbind.size());
-
   // reshape back
-  auto output = at::stack(input_unbind, 0);
+  auto output = input_flat.index_select(0, first_rows);
   auto new_sizes = std::vector<int64_t>(orig_sizes);
   new_sizes[0] = -1;
   output = output.view(new_sizes);
@@ -23,37 +23,28 @@ namespace native {
 
 namespace {
 
-template <typename scalar_t>
-inline void _vec_log_sigmoid(Tensor& output, Tensor& buffer, const Tensor& input) {
-  using Vec = Vec256<scalar_t>;
-  scalar_t* output_data = output.data_ptr<scalar_t>();
-  scalar_t* buffer_data = buffer.data_ptr<scalar_t>();
-  scalar_t* input_data = input.data_ptr<scalar_t>();
-  parallel_for(0, input.numel(), 1, [&] (int64_t begin, int64_t end) {
-    int64_t size = end - begin;
-    int64_t d = 0;
-    for (; d < size - (size % Vec::size()); d += Vec::size()) {
-      Vec data_vec = Vec::loadu(input_data + begin+ d);
-      Vec max_vec = vec256::maximum(data_vec.neg(), Vec(scalar_t(0)));
-      Vec buffer_vec =  max_vec.neg().exp() + (data_vec.neg() - max_vec).exp();
-      Vec output_vec = (max_vec + buffer_vec.log()).neg();
-      buffer_vec.store(buffer_data + begin + d);
-      output_vec.store(output_data + begin + d);
-    }
-    if (size - d > 0) {
-      Vec data_vec = Vec::loadu(input_data + begin + d, size - d);
-      Vec max_vec = vec256::maximum(data_vec.neg(), Vec(scalar_t(0)));
-      Vec buffer_vec =  max_vec.neg().exp() + (data_vec.neg() - max_vec).exp();
-      Vec output_vec = (max_vec + buffer_vec.log()).neg();
-      buffer_vec.store(buffer_data + begin + d, size - d);
-      output_vec.store(output_data + begin + d, size - d);
-    }
-  });
-}
-
 static void log_sigmoid_cpu_kernel(Tensor& output, Tensor& buffer, const Tensor& input) {
+  // output and buffer are written in the same pass over input
+  auto iter = TensorIteratorConfig()
+    .add_output(output)
+    .add_output(buffer)
+    .add_input(input)
+    .build();
   AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "log_sigmoid_cpu", [&] {
-    _vec_log_sigmoid<scalar_t>(output, buffer, input);
+    using Vec = Vec256<scalar_t>;
+    const scalar_t zero_val(0);
+    const Vec zero_vec(zero_val);
+    cpu_kernel_multiple_outputs_vec(iter,
+      [=](scalar_t a) -> std::tuple<scalar_t, scalar_t> {
+        const scalar_t max_val = std::max(-a, zero_val);
+        const scalar_t buffer_val = std::exp(-max_val) + std::exp(-a - max_val);
+        return std::make_tuple(-(max_val + std::log(buffer_val)), buffer_val);
+      },
+      [=](Vec a) -> std::tuple<Vec, Vec> {
+        const Vec max_vec = vec256::maximum(a.neg(), zero_vec);
+        const Vec buffer_vec = max_vec.neg().exp() + (a.neg() - max_vec).exp();
+        return std::make_tuple((max_vec + buffer_vec.log()).neg(), buffer_vec);
+      });
   });
 }
 
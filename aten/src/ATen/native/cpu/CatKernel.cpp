@@ -1,10 +1,15 @@
 #include <ATen/ATen.h>
 
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/native/TensorIterator.h>
 #include <ATen/native/cpu/CatKernel.h>
 #include <ATen/cpu/vec256/functional.h>
 #include <ATen/cpu/vec256/vec256.h>
 
+#include <algorithm>
+#include <cstring>
+
 namespace at { namespace native {
 
 namespace {
@@ -62,8 +67,94 @@ void cat_serial_kernel(Tensor& result, TensorList tensors, int64_t dim) {
   });
 }
 
+// Copies elements of sizeof(word_t) bytes, with a memcpy when both the
+// output and the input are contiguous along the inner dimension
+template <typename word_t>
+void cat_copy_loop(char** data, const int64_t* strides, int64_t size0, int64_t size1) {
+  constexpr int64_t word_size = sizeof(word_t);
+  for (int64_t j = 0; j < size1; j++) {
+    char* dst = data[0] + j * strides[2];
+    const char* src = data[1] + j * strides[3];
+    if (strides[0] == word_size && strides[1] == word_size) {
+      std::memcpy(dst, src, size0 * word_size);
+    } else {
+      for (int64_t i = 0; i < size0; i++) {
+        *reinterpret_cast<word_t*>(dst + i * strides[0]) =
+            *reinterpret_cast<const word_t*>(src + i * strides[1]);
+      }
+    }
+  }
+}
+
+// One TensorIterator per input copies it into its narrowed slice of `result`,
+// so each input is traversed in the order that suits its own strides and
+// memory format. The concatenated element ranges of all iterators are then
+// split evenly between threads, which keeps every thread busy regardless of
+// how the sizes of the inputs compare.
+void cat_strided_kernel(Tensor& result, TensorList tensors, int64_t dim) {
+  std::vector<TensorIterator> iters;
+  iters.reserve(tensors.size());
+  std::vector<int64_t> iter_begin{0};
+  iter_begin.reserve(tensors.size() + 1);
+
+  int64_t offset = 0;
+  const Tensor* prev = nullptr;
+  for (auto const &tensor : tensors) {
+    // Legacy size [0] tensors may not even have `dim`; other empty inputs
+    // have size 0 along `dim` when the result is not empty
+    if (tensor.numel() == 0) {
+      continue;
+    }
+    const int64_t slice_dim_size = tensor.sizes()[dim];
+    auto result_slice = result.narrow(dim, offset, slice_dim_size);
+    offset += slice_dim_size;
+
+    // Inputs with the same sizes and strides as the previous one reuse its
+    // iterator with the data pointers replaced
+    if (prev && tensor.sizes() == prev->sizes() && tensor.strides() == prev->strides()) {
+      TensorIterator iter = iters.back();
+      iter.unsafe_replace_operand(0, result_slice.data_ptr());
+      iter.unsafe_replace_operand(1, tensor.data_ptr());
+      iters.push_back(std::move(iter));
+    } else {
+      iters.push_back(TensorIteratorConfig()
+        .set_check_mem_overlap(false)  // Checked by _cat_out_cpu
+        .resize_outputs(false)
+        .add_output(result_slice)
+        .add_input(tensor)
+        .build());
+    }
+    iter_begin.push_back(iter_begin.back() + iters.back().numel());
+    prev = &tensor;
+  }
+
+  auto copy = [&](TensorIterator& iter, int64_t begin, int64_t end) {
+    switch (result.element_size()) {
+      case 1: iter.serial_for_each(cat_copy_loop<uint8_t>, {begin, end}); break;
+      case 2: iter.serial_for_each(cat_copy_loop<uint16_t>, {begin, end}); break;
+      case 4: iter.serial_for_each(cat_copy_loop<uint32_t>, {begin, end}); break;
+      case 8: iter.serial_for_each(cat_copy_loop<uint64_t>, {begin, end}); break;
+      case 16: iter.serial_for_each(cat_copy_loop<c10::complex<double>>, {begin, end}); break;
+      default:
+        TORCH_INTERNAL_ASSERT(false, "cat: unexpected element size ", result.element_size());
+    }
+  };
+
+  at::parallel_for(0, iter_begin.back(), at::internal::GRAIN_SIZE,
+    [&](int64_t begin, int64_t end) {
+      auto k = std::upper_bound(iter_begin.begin(), iter_begin.end(), begin) - iter_begin.begin() - 1;
+      while (begin < end) {
+        const int64_t local_end = std::min(end, iter_begin[k + 1]);
+        copy(iters[k], begin - iter_begin[k], local_end - iter_begin[k]);
+        begin = local_end;
+        k++;
+      }
+    });
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(cat_serial_stub, &cat_serial_kernel);
+REGISTER_DISPATCH(cat_strided_stub, &cat_strided_kernel);
 
 }} // at::native
@@ -8,4 +8,9 @@ namespace at { namespace native {
 using cat_serial_fn = void(*)(Tensor &, TensorList, int64_t);
 DECLARE_DISPATCH(cat_serial_fn, cat_serial_stub);
 
+// Copies inputs with the same dtype as the result but arbitrary strides and
+// memory formats into `result` in a single parallel pass
+using cat_strided_fn = void(*)(Tensor &, TensorList, int64_t);
+DECLARE_DISPATCH(cat_strided_fn, cat_strided_stub);
+
 }}  // namespace at::native
@@ -1,6 +1,8 @@
 #include <ATen/native/cpu/DepthwiseConvKernel.h>
 #include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
 #include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
 
 #ifdef __ARM_NEON__
 #include <arm_neon.h>
@@ -297,9 +299,132 @@ Tensor _convolution_depthwise3x3_winograd(
   return output;
 }
 
+// Note [Direct depthwise convolution]
+// Depthwise convolutions do very little work per input element, so the
+// im2col + GEMM path spends most of its time materializing the unfolded
+// input. Instead, every (batch, output channel) plane is computed directly:
+// each output row starts out as the bias and each kernel tap adds a scaled
+// row of the input. For unit column stride the input row is contiguous and
+// the update is a vectorized fmadd; the valid output range of every tap is
+// computed up front so the inner loop never checks padding.
+template <typename scalar_t>
+void convolution_depthwise_plane(
+    const scalar_t* input,
+    const scalar_t* weight,
+    scalar_t bias,
+    scalar_t* output,
+    int64_t in_rows, int64_t in_cols,
+    int64_t out_rows, int64_t out_cols,
+    int64_t kernel_rows, int64_t kernel_cols,
+    int64_t stride_rows, int64_t stride_cols,
+    int64_t pad_rows, int64_t pad_cols,
+    int64_t dilation_rows, int64_t dilation_cols) {
+  using Vec = vec256::Vec256<scalar_t>;
+  for (int64_t oh = 0; oh < out_rows; ++oh) {
+    scalar_t* out_row = output + oh * out_cols;
+    std::fill(out_row, out_row + out_cols, bias);
+    for (int64_t kh = 0; kh < kernel_rows; ++kh) {
+      const int64_t ih = oh * stride_rows - pad_rows + kh * dilation_rows;
+      if (ih < 0 || ih >= in_rows) {
+        continue;
+      }
+      const scalar_t* in_row = input + ih * in_cols;
+      for (int64_t kw = 0; kw < kernel_cols; ++kw) {
+        const scalar_t w = weight[kh * kernel_cols + kw];
+        // Output column ow reads input column ow * stride_cols + offset.
+        const int64_t offset = kw * dilation_cols - pad_cols;
+        const int64_t ow_begin =
+            offset >= 0 ? 0 : (-offset + stride_cols - 1) / stride_cols;
+        const int64_t ow_end = in_cols - offset <= 0 ? 0 :
+            std::min(out_cols, (in_cols - offset - 1) / stride_cols + 1);
+        if (ow_begin >= ow_end) {
+          continue;
+        }
+        if (stride_cols == 1) {
+          const scalar_t* in_ptr = in_row + offset;
+          const Vec w_vec(w);
+          int64_t ow = ow_begin;
+          for (; ow + Vec::size() <= ow_end; ow += Vec::size()) {
+            const Vec out_vec = vec256::fmadd(
+                w_vec, Vec::loadu(in_ptr + ow), Vec::loadu(out_row + ow));
+            out_vec.store(out_row + ow);
+          }
+          if (ow < ow_end) {
+            const int64_t count = ow_end - ow;
+            const Vec out_vec = vec256::fmadd(
+                w_vec, Vec::loadu(in_ptr + ow, count), Vec::loadu(out_row + ow, count));
+            out_vec.store(out_row + ow, count);
+          }
+        } else {
+          for (int64_t ow = ow_begin; ow < ow_end; ++ow) {
+            out_row[ow] += w * in_row[ow * stride_cols + offset];
+          }
+        }
+      }
+    }
+  }
+}
+
+Tensor _convolution_depthwise(
+    const Tensor & input_,
+    const Tensor & weight_,
+    const Tensor & bias_,
+    const IntArrayRef stride,
+    const IntArrayRef padding,
+    const IntArrayRef dilation)
+{
+  const Tensor input = input_.contiguous();
+  const Tensor weight = weight_.contiguous();
+  const Tensor bias = bias_.defined() ? bias_.contiguous() : bias_;
+
+  const int64_t batch = input.size(0);
+  const int64_t in_channels = input.size(1);
+  const int64_t in_rows = input.size(2);
+  const int64_t in_cols = input.size(3);
+  const int64_t out_channels = weight.size(0);
+  const int64_t kernel_rows = weight.size(2);
+  const int64_t kernel_cols = weight.size(3);
+  const int64_t multiplier = out_channels / in_channels;
+  const int64_t out_rows =
+      (in_rows + 2 * padding[0] - dilation[0] * (kernel_rows - 1) - 1) / stride[0] + 1;
+  const int64_t out_cols =
+      (in_cols + 2 * padding[1] - dilation[1] * (kernel_cols - 1) - 1) / stride[1] + 1;
+
+  Tensor output = at::empty({batch, out_channels, out_rows, out_cols}, input.options());
+
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "convolution_depthwise", [&] {
+    const scalar_t* input_data = input.data_ptr<scalar_t>();
+    const scalar_t* weight_data = weight.data_ptr<scalar_t>();
+    const scalar_t* bias_data = bias.defined() ? bias.data_ptr<scalar_t>() : nullptr;
+    scalar_t* output_data = output.data_ptr<scalar_t>();
+
+    at::parallel_for(0, batch * out_channels, 0, [&](int64_t start, int64_t end) {
+      for (int64_t k = start; k < end; ++k) {
+        const int64_t n = k / out_channels;
+        const int64_t oc = k % out_channels;
+        const int64_t ic = oc / multiplier;
+        convolution_depthwise_plane<scalar_t>(
+            input_data + (n * in_channels + ic) * in_rows * in_cols,
+            weight_data + oc * kernel_rows * kernel_cols,
+            bias_data ? bias_data[oc] : scalar_t(0),
+            output_data + k * out_rows * out_cols,
+            in_rows, in_cols,
+            out_rows, out_cols,
+            kernel_rows, kernel_cols,
+            stride[0], stride[1],
+            padding[0], padding[1],
+            dilation[0], dilation[1]);
+      }
+    });
+  });
+
+  return output;
+}
+
 }  // namespace
 
 REGISTER_DISPATCH(convolution_depthwise3x3_winograd_stub, &_convolution_depthwise3x3_winograd);
+REGISTER_DISPATCH(convolution_depthwise_stub, &_convolution_depthwise);
 
 }  // namespace native
 }  // namespace at
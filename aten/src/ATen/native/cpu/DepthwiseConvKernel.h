@@ -4,7 +4,8 @@
 #include <ATen/native/DispatchStub.h>
 
 /*
-  Depthwise 3x3 Winograd convolution operator
+  Depthwise 3x3 Winograd convolution operator, and a generic direct
+  depthwise convolution for arbitrary kernel sizes, strides and dilations
 */
 
 namespace at {
@@ -15,5 +16,10 @@ using convolution_depthwise3x3_winograd_fn =
 
 DECLARE_DISPATCH(convolution_depthwise3x3_winograd_fn, convolution_depthwise3x3_winograd_stub);
 
+using convolution_depthwise_fn =
+    Tensor (*)(const Tensor &, const Tensor &, const Tensor &, IntArrayRef, IntArrayRef, IntArrayRef);
+
+DECLARE_DISPATCH(convolution_depthwise_fn, convolution_depthwise_stub);
+
 }  // namespace native
 }  // namespace at
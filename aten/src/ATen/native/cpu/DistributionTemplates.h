@@ -2,11 +2,15 @@
 
 #include <ATen/Dispatch.h>
 #include <ATen/CPUApplyUtils.h>
+#include <ATen/Parallel.h>
 #include <ATen/core/DistributionsHelper.h>
+#include <ATen/core/PhiloxRNGEngine.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/cpu/Loops.h>
+#include <algorithm>
 #include <limits>
 #include <mutex>
+#include <tuple>
 
 #ifdef CPU_CAPABILITY_AVX2
 #include <ATen/native/cpu/avx_mathfun.h>
@@ -19,6 +23,75 @@ namespace templates {
 namespace cpu {
 namespace {
 
+// ==================================================== Philox ========================================================
+
+// See Note [CPU Philox mode]. Sample i of a kernel consumes the 32 bit words
+// [i * words, (i + 1) * words) of the range reserved from the generator, so a
+// PhiloxChunkGenerator positioned at the first sample of a parallel_for chunk
+// produces the same values however the tensor is split.
+constexpr int64_t kPhiloxGrainSize = 32768;
+
+template <typename scalar_t>
+constexpr uint64_t philox_words_per_sample() {
+  // uniform_real_distribution takes random64() for double and random() otherwise
+  return std::is_same<scalar_t, double>::value ? 2 : 1;
+}
+
+struct PhiloxChunkGenerator {
+  PhiloxChunkGenerator(uint64_t seed, uint64_t offset, uint64_t word)
+    : engine_(seed, /*subsequence=*/0, offset + word / 4) {
+    for (uint64_t i = 0; i < word % 4; ++i) {
+      engine_();
+    }
+  }
+
+  uint32_t random() {
+    return engine_();
+  }
+
+  uint64_t random64() {
+    uint32_t hi = engine_();
+    uint32_t lo = engine_();
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+  }
+
+ private:
+  at::Philox4_32_10 engine_;
+};
+
+// Reserves the words of num_samples samples, returning the seed and offset
+template<typename RNG>
+std::pair<uint64_t, uint64_t> philox_reserve(RNG generator, int64_t num_samples, uint64_t words) {
+  // See Note [Acquire lock when using random generators]
+  std::lock_guard<std::mutex> lock(generator->mutex_);
+  return generator->philox_engine_inputs((num_samples * words + 3) / 4);
+}
+
+// Fills self with sample(gen), which consumes words words, in parallel. Non
+// contiguous outputs are sampled into a contiguous buffer, so values follow
+// the logical order.
+template <typename scalar_t, uint64_t words, typename RNG, typename sample_t>
+void philox_fill(Tensor& self, RNG generator, const sample_t& sample) {
+  const int64_t size = self.numel();
+  if (size == 0) {
+    return;
+  }
+  uint64_t seed, offset;
+  std::tie(seed, offset) = philox_reserve(generator, size, words);
+  Tensor out = self.is_contiguous() ? self : at::empty(self.sizes(), self.options());
+  scalar_t* data = out.data_ptr<scalar_t>();
+  at::parallel_for(0, size, kPhiloxGrainSize, [&](int64_t begin, int64_t end) {
+    PhiloxChunkGenerator gen(seed, offset, begin * words);
+    auto sample_ = sample;
+    for (int64_t i = begin; i < end; ++i) {
+      data[i] = sample_(&gen);
+    }
+  });
+  if (!out.is_same(self)) {
+    self.copy_(out);
+  }
+}
+
 // ==================================================== Random ========================================================
 
 template<typename RNG>
@@ -170,6 +243,69 @@ void normal_fill(Tensor& self, const scalar_t mean, const scalar_t std, RNG gene
   }
 }
 
+template <typename scalar_t>
+static void normal_transform_16(scalar_t *data, const scalar_t mean, const scalar_t std) {
+  normal_fill_16<scalar_t>(data, mean, std);
+}
+
+#ifdef CPU_CAPABILITY_AVX2
+static void normal_transform_16(float *data, const float mean, const float std) {
+  const __m256 two_pi = _mm256_set1_ps(2.0f * c10::pi<double>);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 minus_two = _mm256_set1_ps(-2.0f);
+  const __m256 mean_v = _mm256_set1_ps(mean);
+  const __m256 std_v = _mm256_set1_ps(std);
+  normal_fill_16_AVX2(data, &two_pi, &one, &minus_two, &mean_v, &std_v);
+}
+#endif
+
+// Box-Muller pairs stay within groups of 16 samples, so chunks are whole groups.
+// Like normal_fill, a partial last group is recomputed from 16 extra samples.
+template <typename scalar_t, typename RNG>
+void normal_fill_philox(scalar_t *data, int64_t size, const scalar_t mean, const scalar_t std, RNG generator) {
+  constexpr uint64_t words = philox_words_per_sample<scalar_t>();
+  uint64_t seed, offset;
+  std::tie(seed, offset) = philox_reserve(generator, size + 16, words);
+  at::parallel_for(0, size / 16, kPhiloxGrainSize / 16, [&](int64_t begin, int64_t end) {
+    PhiloxChunkGenerator gen(seed, offset, begin * 16 * words);
+    at::uniform_real_distribution<scalar_t> uniform(0, 1);
+    for (int64_t i = begin * 16; i < end * 16; ++i) {
+      data[i] = uniform(&gen);
+    }
+    for (int64_t i = begin * 16; i < end * 16; i += 16) {
+      normal_transform_16(data + i, mean, std);
+    }
+  });
+  if (size % 16 != 0) {
+    PhiloxChunkGenerator gen(seed, offset, size * words);
+    at::uniform_real_distribution<scalar_t> uniform(0, 1);
+    data = data + size - 16;
+    for (int64_t i = 0; i < 16; ++i) {
+      data[i] = uniform(&gen);
+    }
+    normal_transform_16(data, mean, std);
+  }
+}
+
+template<typename RNG>
+void normal_philox_kernel(Tensor& self, double mean, double std, RNG generator) {
+  const int64_t size = self.numel();
+  if (size == 0) {
+    return;
+  }
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, self.scalar_type(), "normal_philox_kernel_cpu", [&] {
+    const auto mean_ = static_cast<scalar_t>(mean);
+    const auto std_ = static_cast<scalar_t>(std);
+    if (size >= 16 && self.is_contiguous()) {
+      normal_fill_philox<scalar_t>(self.data_ptr<scalar_t>(), size, mean_, std_, generator);
+    } else {
+      Tensor out = at::empty({std::max<int64_t>(size, 16)}, self.options());
+      normal_fill_philox<scalar_t>(out.data_ptr<scalar_t>(), out.numel(), mean_, std_, generator);
+      self.copy_(out.narrow(0, 0, size).view(self.sizes()));
+    }
+  });
+}
+
 template<typename RNG>
 void normal_kernel(Tensor& self, double mean, double std, RNG generator) {
   auto size = self.numel();
@@ -217,6 +353,17 @@ void uniform_kernel(TensorIterator& iter, double from_, double to_, RNG generato
   });
 }
 
+template<typename RNG>
+void uniform_philox_kernel(TensorIterator& iter, double from_, double to_, RNG generator) {
+  Tensor self = iter.tensor(0);
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, self.scalar_type(), "uniform_philox_kernel_cpu", [&]() {
+    at::uniform_real_distribution<scalar_t> uniform(static_cast<scalar_t>(from_), static_cast<scalar_t>(to_));
+    philox_fill<scalar_t, philox_words_per_sample<scalar_t>()>(self, generator, [uniform](PhiloxChunkGenerator* gen) mutable -> scalar_t {
+      return static_cast<scalar_t>(uniform(gen));
+    });
+  });
+}
+
 template<typename RNG>
 struct UniformKernel {
   void operator()(TensorIterator& iter, double from, double to, c10::optional<Generator> gen) {
@@ -349,6 +496,17 @@ void bernoulli_kernel(Tensor& self, double p, RNG generator) {
   });
 }
 
+template<typename RNG>
+void bernoulli_philox_kernel(Tensor& self, double p, RNG generator) {
+  AT_DISPATCH_ALL_TYPES_AND(at::ScalarType::Bool, self.scalar_type(), "bernoulli_scalar_philox_cpu_", [&] {
+    // bernoulli_distribution<double> samples a double uniform, whatever scalar_t is
+    at::bernoulli_distribution<double> bernoulli(p);
+    philox_fill<scalar_t, philox_words_per_sample<double>()>(self, generator, [bernoulli](PhiloxChunkGenerator* gen) mutable -> scalar_t {
+      return static_cast<scalar_t>(bernoulli(gen));
+    });
+  });
+}
+
 template<typename RNG>
 struct BernoulliKernel {
   void operator()(Tensor& self, double p, c10::optional<Generator> gen) {
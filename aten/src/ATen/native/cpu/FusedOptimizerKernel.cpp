@@ -0,0 +1,235 @@
+#include <ATen/ATen.h>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+#include <ATen/native/FusedOptimizers.h>
+
+#include <cmath>
+
+namespace at { namespace native {
+
+namespace {
+
+using namespace vec256;
+
+// The elements of all the parameters are split into chunks of at most this
+// many, so that parallel_for balances many small parameters as well as a few
+// large ones
+constexpr int64_t kChunkSize = 32768;
+
+struct Chunk {
+  int64_t tensor;
+  int64_t begin;
+  int64_t end;
+};
+
+// Runs f(tensor index, begin, end) over the chunks of params, in parallel
+template <typename F>
+void parallel_for_each_chunk(TensorList params, const F& f) {
+  std::vector<Chunk> chunks;
+  for (int64_t t = 0; t < static_cast<int64_t>(params.size()); t++) {
+    const int64_t numel = params[t].numel();
+    for (int64_t begin = 0; begin < numel; begin += kChunkSize) {
+      chunks.push_back({t, begin, std::min(begin + kChunkSize, numel)});
+    }
+  }
+  at::parallel_for(0, chunks.size(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      f(chunks[c].tensor, chunks[c].begin, chunks[c].end);
+    }
+  });
+}
+
+// Calls body(offset, count) over [0, n) in steps of a vector, the last one
+// possibly partial
+template <typename scalar_t, typename F>
+inline void vectorized_loop(int64_t n, const F& body) {
+  using Vec = Vec256<scalar_t>;
+  int64_t i = 0;
+  for (; i + Vec::size() <= n; i += Vec::size()) {
+    body(i, Vec::size());
+  }
+  if (i < n) {
+    body(i, n - i);
+  }
+}
+
+template <typename scalar_t>
+inline Vec256<scalar_t> load(const scalar_t* ptr, int64_t count) {
+  using Vec = Vec256<scalar_t>;
+  return count == Vec::size() ? Vec::loadu(ptr) : Vec::loadu(ptr, count);
+}
+
+template <typename scalar_t>
+inline void store(const Vec256<scalar_t>& v, scalar_t* ptr, int64_t count) {
+  v.store(ptr, count);
+}
+
+template <typename scalar_t>
+void adam_chunk(
+    scalar_t* param,
+    const scalar_t* grad,
+    scalar_t* exp_avg,
+    scalar_t* exp_avg_sq,
+    scalar_t* max_exp_avg_sq,
+    int64_t n,
+    const FusedAdamParams& p) {
+  using Vec = Vec256<scalar_t>;
+  const bool decay_param = p.weight_decay != 0 && p.decoupled_weight_decay;
+  const bool decay_grad = p.weight_decay != 0 && !p.decoupled_weight_decay;
+  const Vec param_decay(1 - p.lr * p.weight_decay);
+  const Vec weight_decay(p.weight_decay);
+  const Vec beta1(p.beta1);
+  const Vec one_minus_beta1(1 - p.beta1);
+  const Vec beta2(p.beta2);
+  const Vec one_minus_beta2(1 - p.beta2);
+  const Vec sqrt_bias_correction2(std::sqrt(p.bias_correction2));
+  const Vec eps(p.eps);
+  const Vec neg_step_size(-p.lr / p.bias_correction1);
+
+  vectorized_loop<scalar_t>(n, [&](int64_t i, int64_t count) {
+    Vec param_vec = load(param + i, count);
+    Vec grad_vec = load(grad + i, count);
+    if (decay_param) {
+      param_vec = param_vec * param_decay;
+    } else if (decay_grad) {
+      grad_vec = grad_vec + param_vec * weight_decay;
+    }
+    const Vec exp_avg_vec =
+        load(exp_avg + i, count) * beta1 + grad_vec * one_minus_beta1;
+    const Vec exp_avg_sq_vec = load(exp_avg_sq + i, count) * beta2 +
+        grad_vec * grad_vec * one_minus_beta2;
+    Vec second_moment = exp_avg_sq_vec;
+    if (max_exp_avg_sq) {
+      second_moment = maximum(load(max_exp_avg_sq + i, count), exp_avg_sq_vec);
+      store(second_moment, max_exp_avg_sq + i, count);
+    }
+    const Vec denom = second_moment.sqrt() / sqrt_bias_correction2 + eps;
+    param_vec = param_vec + neg_step_size * (exp_avg_vec / denom);
+    store(exp_avg_vec, exp_avg + i, count);
+    store(exp_avg_sq_vec, exp_avg_sq + i, count);
+    store(param_vec, param + i, count);
+  });
+}
+
+void fused_adam_kernel(
+    TensorList params,
+    TensorList grads,
+    TensorList exp_avgs,
+    TensorList exp_avg_sqs,
+    TensorList max_exp_avg_sqs,
+    const FusedAdamParams& p) {
+  parallel_for_each_chunk(params, [&](int64_t t, int64_t begin, int64_t end) {
+    AT_DISPATCH_FLOATING_TYPES(params[t].scalar_type(), "fused_adam_cpu", [&] {
+      adam_chunk<scalar_t>(
+          params[t].data_ptr<scalar_t>() + begin,
+          grads[t].data_ptr<scalar_t>() + begin,
+          exp_avgs[t].data_ptr<scalar_t>() + begin,
+          exp_avg_sqs[t].data_ptr<scalar_t>() + begin,
+          p.amsgrad ? max_exp_avg_sqs[t].data_ptr<scalar_t>() + begin
+                    : nullptr,
+          end - begin,
+          p);
+    });
+  });
+}
+
+template <typename scalar_t>
+void sgd_chunk(
+    scalar_t* param,
+    const scalar_t* grad,
+    scalar_t* momentum_buffer,
+    int64_t n,
+    const FusedSGDParams& p) {
+  using Vec = Vec256<scalar_t>;
+  const Vec weight_decay(p.weight_decay);
+  const Vec momentum(p.momentum);
+  const Vec one_minus_dampening(1 - p.dampening);
+  const Vec neg_lr(-p.lr);
+
+  vectorized_loop<scalar_t>(n, [&](int64_t i, int64_t count) {
+    Vec param_vec = load(param + i, count);
+    Vec d_p = load(grad + i, count);
+    if (p.weight_decay != 0) {
+      d_p = d_p + param_vec * weight_decay;
+    }
+    if (momentum_buffer) {
+      const Vec buf = p.is_first_step
+          ? d_p
+          : load(momentum_buffer + i, count) * momentum +
+              d_p * one_minus_dampening;
+      store(buf, momentum_buffer + i, count);
+      d_p = p.nesterov ? d_p + buf * momentum : buf;
+    }
+    store(param_vec + d_p * neg_lr, param + i, count);
+  });
+}
+
+void fused_sgd_kernel(
+    TensorList params,
+    TensorList grads,
+    TensorList momentum_buffers,
+    const FusedSGDParams& p) {
+  const bool has_momentum = p.momentum != 0;
+  parallel_for_each_chunk(params, [&](int64_t t, int64_t begin, int64_t end) {
+    AT_DISPATCH_FLOATING_TYPES(params[t].scalar_type(), "fused_sgd_cpu", [&] {
+      sgd_chunk<scalar_t>(
+          params[t].data_ptr<scalar_t>() + begin,
+          grads[t].data_ptr<scalar_t>() + begin,
+          has_momentum ? momentum_buffers[t].data_ptr<scalar_t>() + begin
+                       : nullptr,
+          end - begin,
+          p);
+    });
+  });
+}
+
+template <typename scalar_t>
+void adagrad_chunk(
+    scalar_t* param,
+    const scalar_t* grad,
+    scalar_t* state_sum,
+    int64_t n,
+    const FusedAdagradParams& p) {
+  using Vec = Vec256<scalar_t>;
+  const Vec weight_decay(p.weight_decay);
+  const Vec eps(p.eps);
+  const Vec neg_lr(-p.lr);
+
+  vectorized_loop<scalar_t>(n, [&](int64_t i, int64_t count) {
+    const Vec param_vec = load(param + i, count);
+    Vec grad_vec = load(grad + i, count);
+    if (p.weight_decay != 0) {
+      grad_vec = grad_vec + param_vec * weight_decay;
+    }
+    const Vec sum = load(state_sum + i, count) + grad_vec * grad_vec;
+    store(sum, state_sum + i, count);
+    store(param_vec + neg_lr * (grad_vec / (sum.sqrt() + eps)), param + i, count);
+  });
+}
+
+void fused_adagrad_kernel(
+    TensorList params,
+    TensorList grads,
+    TensorList state_sums,
+    const FusedAdagradParams& p) {
+  parallel_for_each_chunk(params, [&](int64_t t, int64_t begin, int64_t end) {
+    AT_DISPATCH_FLOATING_TYPES(params[t].scalar_type(), "fused_adagrad_cpu", [&] {
+      adagrad_chunk<scalar_t>(
+          params[t].data_ptr<scalar_t>() + begin,
+          grads[t].data_ptr<scalar_t>() + begin,
+          state_sums[t].data_ptr<scalar_t>() + begin,
+          end - begin,
+          p);
+    });
+  });
+}
+
+} // namespace
+
+REGISTER_DISPATCH(fused_adam_stub, &fused_adam_kernel);
+REGISTER_DISPATCH(fused_sgd_stub, &fused_sgd_kernel);
+REGISTER_DISPATCH(fused_adagrad_stub, &fused_adagrad_kernel);
+
+}} // namespace at::native
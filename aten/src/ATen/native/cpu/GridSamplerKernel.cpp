@@ -4,7 +4,9 @@
 #include <ATen/TensorUtils.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/native/GridSampler.h>
+#include <ATen/native/UpSample.h>
 #include <ATen/native/cpu/GridSamplerKernel.h>
+#include <ATen/native/cpu/utils.h>
 #include <ATen/cpu/vml.h>
 #include <c10/util/C++17.h>
 
@@ -1101,12 +1103,141 @@ static inline void grid_sample_2d_grid_slice_iterator(
 // and backward.
 // See NOTE [ Grid Sample CPU Kernels ] for details.
 
+// Forward kernel for channels last (NHWC) input, producing channels last
+// output. The kernels above vectorize across output locations, which turns
+// every input access into a gather with stride C. Here each output location
+// is handled separately: its taps are computed once as (pointer, weight)
+// pairs with the scalar helpers of GridSampler.h, and the weighted sum is
+// vectorized across the contiguous channel dimension.
+template <typename scalar_t>
+void grid_sampler_2d_channels_last_kernel(
+    const Tensor& output, const Tensor& input, const Tensor& grid,
+    GridSamplerInterpolation interpolation_mode,
+    GridSamplerPadding padding_mode, bool align_corners) {
+  using Vec = Vec256<scalar_t>;
+  int64_t N = input.size(0);
+  int64_t C = input.size(1);
+  int64_t inp_H = input.size(2);
+  int64_t inp_W = input.size(3);
+  int64_t out_H = grid.size(1);
+  int64_t out_W = grid.size(2);
+  int64_t grid_sN = grid.stride(0);
+  int64_t grid_sH = grid.stride(1);
+  int64_t grid_sW = grid.stride(2);
+  int64_t grid_sCoor = grid.stride(3);
+  const int64_t inp_sH = inp_W * C;
+  const int64_t inp_sW = C;
+  const scalar_t* inp_ptr = input.data_ptr<scalar_t>();
+  const scalar_t* grid_ptr = grid.data_ptr<scalar_t>();
+  scalar_t* out_ptr = output.data_ptr<scalar_t>();
+
+  constexpr int64_t max_taps = 16;
+  auto interpolate = [&](scalar_t* out, const scalar_t* const* in,
+                         const scalar_t* weight, int64_t num_taps) {
+    int64_t c = 0;
+    for (; c < C - (C % Vec::size()); c += Vec::size()) {
+      Vec res(0);
+      for (int64_t k = 0; k < num_taps; k++) {
+        res = res + Vec(weight[k]) * Vec::loadu(in[k] + c);
+      }
+      res.store(out + c);
+    }
+    for (; c < C; c++) {
+      scalar_t res = 0;
+      for (int64_t k = 0; k < num_taps; k++) {
+        res += weight[k] * in[k][c];
+      }
+      out[c] = res;
+    }
+  };
+
+  auto grain_size = at::divup(at::internal::GRAIN_SIZE, C * 4);
+  at::parallel_for(0, N * out_H * out_W, grain_size, [&](int64_t begin, int64_t end) {
+    int64_t n = 0;
+    int64_t h = 0;
+    int64_t w = 0;
+    data_index_init(begin, n, N, h, out_H, w, out_W);
+
+    const scalar_t* in[max_taps];
+    scalar_t weight[max_taps];
+    for (int64_t i = begin; i < end; i++) {
+      const scalar_t* grid_ptr_NHW = grid_ptr + n * grid_sN + h * grid_sH + w * grid_sW;
+      const scalar_t x = grid_ptr_NHW[0];
+      const scalar_t y = grid_ptr_NHW[grid_sCoor];
+      const scalar_t* inp_ptr_N = inp_ptr + n * inp_H * inp_sH;
+      scalar_t* out_ptr_NHW = out_ptr + i * C;
+
+      int64_t num_taps = 0;
+      auto add_tap = [&](int64_t iy, int64_t ix, scalar_t wt) {
+        if (within_bounds_2d(iy, ix, inp_H, inp_W)) {
+          in[num_taps] = inp_ptr_N + iy * inp_sH + ix * inp_sW;
+          weight[num_taps] = wt;
+          num_taps++;
+        }
+      };
+
+      if (interpolation_mode == GridSamplerInterpolation::Bilinear) {
+        scalar_t ix = grid_sampler_compute_source_index(x, inp_W, padding_mode, align_corners);
+        scalar_t iy = grid_sampler_compute_source_index(y, inp_H, padding_mode, align_corners);
+        int64_t ix_nw = static_cast<int64_t>(std::floor(ix));
+        int64_t iy_nw = static_cast<int64_t>(std::floor(iy));
+        scalar_t tx = ix - ix_nw;
+        scalar_t ty = iy - iy_nw;
+        add_tap(iy_nw, ix_nw, (1 - tx) * (1 - ty));
+        add_tap(iy_nw, ix_nw + 1, tx * (1 - ty));
+        add_tap(iy_nw + 1, ix_nw, (1 - tx) * ty);
+        add_tap(iy_nw + 1, ix_nw + 1, tx * ty);
+      } else if (interpolation_mode == GridSamplerInterpolation::Nearest) {
+        scalar_t ix = grid_sampler_compute_source_index(x, inp_W, padding_mode, align_corners);
+        scalar_t iy = grid_sampler_compute_source_index(y, inp_H, padding_mode, align_corners);
+        add_tap(static_cast<int64_t>(std::nearbyint(iy)),
+                static_cast<int64_t>(std::nearbyint(ix)), scalar_t(1));
+      } else {
+        // Padding is applied to each tap rather than to the location, see
+        // _grid_sampler_2d_cpu_fallback
+        scalar_t ix = grid_sampler_unnormalize(x, inp_W, align_corners);
+        scalar_t iy = grid_sampler_unnormalize(y, inp_H, align_corners);
+        scalar_t ix_nw = std::floor(ix);
+        scalar_t iy_nw = std::floor(iy);
+        scalar_t coeff_x[4], coeff_y[4];
+        get_cubic_upsample_coefficients<scalar_t>(coeff_x, ix - ix_nw);
+        get_cubic_upsample_coefficients<scalar_t>(coeff_y, iy - iy_nw);
+        for (int64_t j = 0; j < 4; j++) {
+          auto yy = static_cast<int64_t>(compute_coordinates(
+              iy_nw - 1 + j, inp_H, padding_mode, align_corners));
+          for (int64_t k = 0; k < 4; k++) {
+            auto xx = static_cast<int64_t>(compute_coordinates(
+                ix_nw - 1 + k, inp_W, padding_mode, align_corners));
+            add_tap(yy, xx, coeff_y[j] * coeff_x[k]);
+          }
+        }
+      }
+      interpolate(out_ptr_NHW, in, weight, num_taps);
+      data_index_step(n, N, h, out_H, w, out_W);
+    }
+  });
+}
+
 Tensor grid_sampler_2d_cpu_kernel_impl(const Tensor& input, const Tensor& grid,
                                        int64_t interpolation_mode,
                                        int64_t padding_mode, bool align_corners) {
   auto N = input.size(0);
   auto H = grid.size(1);
   auto W = grid.size(2);
+  if (input.is_contiguous(at::MemoryFormat::ChannelsLast) && !input.is_contiguous()) {
+    auto output = at::empty({N, input.size(1), H, W},
+                            input.options().memory_format(at::MemoryFormat::ChannelsLast));
+    if (output.numel() == 0) {
+      return output;
+    }
+    AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "grid_sampler_2d_channels_last", [&] {
+      grid_sampler_2d_channels_last_kernel<scalar_t>(
+          output, input, grid,
+          static_cast<GridSamplerInterpolation>(interpolation_mode),
+          static_cast<GridSamplerPadding>(padding_mode), align_corners);
+    });
+    return output;
+  }
   auto output = at::empty({N, input.size(1), H, W}, input.options());
   auto spatial_size = H * W;
   auto grain_size = spatial_size == 0 ? (N + 1)
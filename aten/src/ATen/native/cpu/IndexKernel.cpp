@@ -1,7 +1,11 @@
 #include <ATen/native/TensorAdvancedIndexing.h>
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <vector>
 #include <ATen/Dispatch.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/Parallel.h>
@@ -58,15 +62,8 @@ static bool is_constant_index(int ntensor, const int64_t* strides) {
 }
 
 template <typename scalar_t, typename func_t>
-void cpu_index_kernel(TensorIterator& iter, IntArrayRef index_size, IntArrayRef index_stride,
-                      const func_t& f, bool serial_execution=false)
-{
-  int ntensor = iter.ntensors();
-  // When launch the index parallel version, set a relative samll grain size less than the INTERNAL::GRAIN_SIZE
-  // to make the whole available thread numbers get more balanced work load and a better cache location.
-  // The grain size here is chosen by the op benchmark to overcome the thread launch overhead
-  const int index_parallel_grain_size = 3000;
-  auto loop = [&](char** data, const int64_t* strides, int64_t n) {
+auto make_index_loop(int ntensor, IntArrayRef index_size, IntArrayRef index_stride, const func_t& f) {
+  return [ntensor, index_size, index_stride, &f](char** data, const int64_t* strides, int64_t n) {
     auto indexer = Indexer(ntensor - 2, &data[2], &strides[2], index_size, index_stride);
     char* dst = data[0];
     char* src = data[1];
@@ -89,6 +86,17 @@ void cpu_index_kernel(TensorIterator& iter, IntArrayRef index_size, IntArrayRef
       }
     }
   };
+}
+
+template <typename scalar_t, typename func_t>
+void cpu_index_kernel(TensorIterator& iter, IntArrayRef index_size, IntArrayRef index_stride,
+                      const func_t& f, bool serial_execution=false)
+{
+  // When launch the index parallel version, set a relative samll grain size less than the INTERNAL::GRAIN_SIZE
+  // to make the whole available thread numbers get more balanced work load and a better cache location.
+  // The grain size here is chosen by the op benchmark to overcome the thread launch overhead
+  const int index_parallel_grain_size = 3000;
+  auto loop = make_index_loop<scalar_t>(iter.ntensors(), index_size, index_stride, f);
   if (serial_execution) {
     iter.serial_for_each(loop, {0, iter.numel()});
   } else {
@@ -96,6 +104,91 @@ void cpu_index_kernel(TensorIterator& iter, IntArrayRef index_size, IntArrayRef
   }
 }
 
+// Note [Parallel accumulation in index_put_ and put_]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// With accumulate=True the same destination may be written more than once, so the
+// iteration space cannot simply be split across threads. Instead, the
+// (destination, value) pairs are first gathered in parallel, then bucketed by
+// destination address range with a stable counting sort, and each bucket is
+// reduced by exactly one thread. A bucket keeps its pairs in iteration order, so
+// every destination sees the same sequence of additions as in the serial kernel:
+// the result is bitwise identical to it, and therefore deterministic, for every
+// dtype. This costs O(numel) scratch memory; the float atomic-add path is kept
+// for the nondeterministic mode, where it does the same work without it.
+//
+// `gather(begin, end, record)` must call `record(dst, value)` once for every
+// element in [begin, end), in iteration order.
+template <typename scalar_t, typename gather_t>
+void cpu_accumulate_bucketed(int64_t numel, const gather_t& gather) {
+  struct Entry {
+    scalar_t* dst;
+    scalar_t value;
+  };
+  const int64_t num_threads = at::get_num_threads();
+  const int64_t num_chunks = std::min(num_threads, at::divup(numel, internal::GRAIN_SIZE));
+  const int64_t chunk_size = at::divup(numel, num_chunks);
+  auto chunk_begin = [&](int64_t c) { return std::min(numel, c * chunk_size); };
+
+  std::vector<Entry> entries(numel);
+  std::vector<uintptr_t> chunk_lo(num_chunks, std::numeric_limits<uintptr_t>::max());
+  std::vector<uintptr_t> chunk_hi(num_chunks, 0);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      Entry* out = entries.data() + chunk_begin(c);
+      gather(chunk_begin(c), chunk_begin(c + 1), [&out](scalar_t* dst, scalar_t value) {
+        *out++ = {dst, value};
+      });
+      for (int64_t i = chunk_begin(c); i < chunk_begin(c + 1); i++) {
+        const auto addr = reinterpret_cast<uintptr_t>(entries[i].dst);
+        chunk_lo[c] = std::min(chunk_lo[c], addr);
+        chunk_hi[c] = std::max(chunk_hi[c], addr);
+      }
+    }
+  });
+  const uintptr_t lo = *std::min_element(chunk_lo.begin(), chunk_lo.end());
+  const uintptr_t hi = *std::max_element(chunk_hi.begin(), chunk_hi.end());
+
+  // Bucket b owns the addresses [lo + b * span, lo + (b + 1) * span)
+  const int64_t num_buckets = num_threads;
+  const uintptr_t span = (hi - lo) / num_buckets + 1;
+  auto bucket_of = [&](const Entry& e) {
+    return static_cast<int64_t>((reinterpret_cast<uintptr_t>(e.dst) - lo) / span);
+  };
+
+  // offsets[b * num_chunks + c] is where chunk c starts writing into bucket b
+  std::vector<int64_t> offsets(num_buckets * num_chunks + 1, 0);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      for (int64_t i = chunk_begin(c); i < chunk_begin(c + 1); i++) {
+        offsets[bucket_of(entries[i]) * num_chunks + c + 1]++;
+      }
+    }
+  });
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  std::vector<Entry> sorted(numel);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    std::vector<int64_t> cursor(num_buckets);
+    for (int64_t c = begin; c < end; c++) {
+      for (int64_t b = 0; b < num_buckets; b++) {
+        cursor[b] = offsets[b * num_chunks + c];
+      }
+      for (int64_t i = chunk_begin(c); i < chunk_begin(c + 1); i++) {
+        sorted[cursor[bucket_of(entries[i])]++] = entries[i];
+      }
+    }
+  });
+  entries = std::vector<Entry>();
+
+  at::parallel_for(0, num_buckets, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t b = begin; b < end; b++) {
+      for (int64_t i = offsets[b * num_chunks]; i < offsets[(b + 1) * num_chunks]; i++) {
+        *sorted[i].dst += sorted[i].value;
+      }
+    }
+  });
+}
+
 void index_kernel(TensorIterator& iter, IntArrayRef index_size, IntArrayRef index_stride) {
   AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND3(ScalarType::Half, ScalarType::Bool, ScalarType::BFloat16,
     iter.dtype(), "index_cpu", [&] {
@@ -127,27 +220,12 @@ struct IndexToOffset {
 };
 
 template <typename scalar_t, typename func_t>
-void cpu_take_put_kernel(
-    TensorIterator& iter,
-    const Tensor& indexed,
-    const func_t& f,
-    bool serial_execution=false) {
-  // This kernel follows the same strategy as `cpu_index_kernel`
-  // Even though the indexed_tensor is const, we modify it through the data_ptr
-  // This is a bit dirty, but otherwise it would be necessary to innecessarily add tensor
-  // with zero strides to `iter` which would not be much better
-
-  // When launch the parallel version, set a relative small grain size less than the INTERNAL::GRAIN_SIZE
-  // to make the whole available thread numbers get more balanced work load and a better cache location.
-  // The grain size here is chosen by the op benchmark to overcome the thread launch overhead
-  // Perhaps tweak this number for `put_`? This number was tweaked for `index_put`
-  constexpr int parallel_grain_size = 3000;
+auto make_take_put_loop(const Tensor& indexed, const func_t& f) {
   const bool is_contiguous = indexed.is_contiguous();
   const auto numel = indexed.numel();
   const auto offset_indexed = IndexToOffset(indexed);
-
   auto* indexed_data = indexed.data_ptr<scalar_t>();
-  auto loop = [&](char** data, const int64_t* strides, int64_t n) {
+  return [is_contiguous, numel, offset_indexed, indexed_data, &f](char** data, const int64_t* strides, int64_t n) {
     auto* iterated_data_bytes = data[0];
     auto* index_data_bytes = data[1];
     for (int64_t elem = 0; elem < n; ++elem) {
@@ -168,6 +246,25 @@ void cpu_take_put_kernel(
       index_data_bytes += strides[1];
     }
   };
+}
+
+template <typename scalar_t, typename func_t>
+void cpu_take_put_kernel(
+    TensorIterator& iter,
+    const Tensor& indexed,
+    const func_t& f,
+    bool serial_execution=false) {
+  // This kernel follows the same strategy as `cpu_index_kernel`
+  // Even though the indexed_tensor is const, we modify it through the data_ptr
+  // This is a bit dirty, but otherwise it would be necessary to innecessarily add tensor
+  // with zero strides to `iter` which would not be much better
+
+  // When launch the parallel version, set a relative small grain size less than the INTERNAL::GRAIN_SIZE
+  // to make the whole available thread numbers get more balanced work load and a better cache location.
+  // The grain size here is chosen by the op benchmark to overcome the thread launch overhead
+  // Perhaps tweak this number for `put_`? This number was tweaked for `index_put`
+  constexpr int parallel_grain_size = 3000;
+  auto loop = make_take_put_loop<scalar_t>(indexed, f);
   if (serial_execution) {
     iter.serial_for_each(loop, {0, iter.numel()});
   } else {
@@ -185,19 +282,24 @@ void put_kernel(
     if (accumulate) {
       // nb. This deterministic issue the same as that of `index_put_kernel`
       // See Note [Enabling Deterministic Operations]
-      // Parallel cpu_put_kernel with accumulation is nondeterministic, so we
-      // must enable serial execution if deterministic algorithms are enabled.
+      // The atomic float kernel is nondeterministic, so deterministic algorithms
+      // fall back to the bucketed kernel, which matches the serial result exactly.
+      // See Note [Parallel accumulation in index_put_ and put_]
       bool is_deterministic = at::globalContext().deterministicAlgorithms();
-      bool use_parallel_for = (!is_deterministic) && (
-        (iter.numel() >= internal::GRAIN_SIZE) && (at::get_num_threads() > 1));
-      if (use_parallel_for && iter.dtype() == ScalarType::Float) {
+      bool use_parallel_for = (iter.numel() >= internal::GRAIN_SIZE) && (at::get_num_threads() > 1);
+      if (use_parallel_for && !is_deterministic && iter.dtype() == ScalarType::Float) {
         cpu_take_put_kernel<float>(iter, self,
             [](float& iterated, float* indexed, const int64_t idx) {
                 cpu_atomic_add_float(indexed+idx, iterated);
               });
+      } else if (use_parallel_for) {
+        cpu_accumulate_bucketed<scalar_t>(iter.numel(), [&](int64_t begin, int64_t end, const auto& record) {
+          auto f = [&record](scalar_t& iterated, scalar_t* indexed, const int64_t idx) {
+            record(indexed + idx, iterated);
+          };
+          iter.serial_for_each(make_take_put_loop<scalar_t>(self, f), {begin, end});
+        });
       } else {
-        // TODO: investigate parallelization of the accumulate kernel.
-        // Unlike the non-accumulate case, this needs to be thread-safe.
         cpu_take_put_kernel<scalar_t>(iter, self,
             [](scalar_t& iterated, scalar_t* indexed, const int64_t idx) {
                 indexed[idx] += iterated;
@@ -231,18 +333,23 @@ void index_put_kernel(TensorIterator& iter, IntArrayRef index_size, IntArrayRef
     iter.dtype(), "index_put", [&] {
     if (accumulate) {
       // See Note [Enabling Deterministic Operations]
-      // Parallel cpu_index_kernel with accumulation is nondeterministic, so we
-      // must enable serial execution if deterministic algorithms are enabled.
+      // The atomic float kernel is nondeterministic, so deterministic algorithms
+      // fall back to the bucketed kernel, which matches the serial result exactly.
+      // See Note [Parallel accumulation in index_put_ and put_]
       bool is_deterministic = at::globalContext().deterministicAlgorithms();
-      bool use_parallel_for = (!is_deterministic) && (
-        (iter.numel() >= internal::GRAIN_SIZE) && (at::get_num_threads() > 1));
-      if (use_parallel_for && iter.dtype() == ScalarType::Float) {
+      bool use_parallel_for = (iter.numel() >= internal::GRAIN_SIZE) && (at::get_num_threads() > 1);
+      if (use_parallel_for && !is_deterministic && iter.dtype() == ScalarType::Float) {
         cpu_index_kernel<float>(iter, index_size, index_stride, [](char* dst, char* src, int64_t offset) {
           cpu_atomic_add_float((float*)(dst + offset), *(float*)src);
         });
+      } else if (use_parallel_for) {
+        cpu_accumulate_bucketed<scalar_t>(iter.numel(), [&](int64_t begin, int64_t end, const auto& record) {
+          auto f = [&record](char* dst, char* src, int64_t offset) {
+            record((scalar_t*)(dst + offset), *(scalar_t*)src);
+          };
+          iter.serial_for_each(make_index_loop<scalar_t>(iter.ntensors(), index_size, index_stride, f), {begin, end});
+        });
       } else {
-        // TODO: investigate parallelization of the accumulate kernel. Unlike the non-accumulate case,
-        // this needs to be thread-safe.
         cpu_index_kernel<scalar_t>(iter, index_size, index_stride, [](char* dst, char* src, int64_t offset) {
           *(scalar_t*)(dst + offset) += *(scalar_t*)src;
         }, /*serial_execution=*/true);
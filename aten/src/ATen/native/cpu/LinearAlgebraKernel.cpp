@@ -5,6 +5,10 @@
 #include <ATen/native/SharedReduceOps.h>
 #include <ATen/native/cpu/Reduce.h>
 #include <ATen/native/cpu/Loops.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+#include <vector>
 
 namespace at { namespace native { namespace {
 
@@ -120,9 +124,165 @@ static void linalg_vector_norm_kernel_cpu(TensorIterator& iter, Scalar ord) {
   });
 }
 
+// Computes ROWS rows and `cols` (at most two vectors) columns of
+// c = beta * c + alpha * (a @ b), keeping the whole tile in registers while
+// looping over the contraction dimension. `a` may have any strides, the rows
+// of `b` and `c` must be contiguous.
+template <typename scalar_t, int ROWS>
+inline void small_gemm_tile(
+    int64_t k, int64_t cols,
+    const scalar_t* a, int64_t a_row_stride, int64_t a_col_stride,
+    const scalar_t* b, int64_t ldb,
+    scalar_t* c, int64_t ldc,
+    scalar_t alpha, scalar_t beta, bool use_beta) {
+  using Vec = vec256::Vec256<scalar_t>;
+  constexpr int64_t kVecSize = Vec::size();
+  Vec acc0[ROWS];
+  Vec acc1[ROWS];
+  for (int r = 0; r < ROWS; r++) {
+    acc0[r] = Vec(scalar_t(0));
+    acc1[r] = Vec(scalar_t(0));
+  }
+  if (cols == 2 * kVecSize) {
+    for (int64_t l = 0; l < k; l++) {
+      const Vec b0 = Vec::loadu(b + l * ldb);
+      const Vec b1 = Vec::loadu(b + l * ldb + kVecSize);
+      for (int r = 0; r < ROWS; r++) {
+        const Vec a_val(a[r * a_row_stride + l * a_col_stride]);
+        acc0[r] = vec256::fmadd(a_val, b0, acc0[r]);
+        acc1[r] = vec256::fmadd(a_val, b1, acc1[r]);
+      }
+    }
+  } else {
+    const int64_t cols0 = std::min(cols, kVecSize);
+    const int64_t cols1 = cols - cols0;
+    for (int64_t l = 0; l < k; l++) {
+      const Vec b0 = Vec::loadu(b + l * ldb, cols0);
+      const Vec b1 = cols1 > 0 ? Vec::loadu(b + l * ldb + kVecSize, cols1) : Vec(scalar_t(0));
+      for (int r = 0; r < ROWS; r++) {
+        const Vec a_val(a[r * a_row_stride + l * a_col_stride]);
+        acc0[r] = vec256::fmadd(a_val, b0, acc0[r]);
+        acc1[r] = vec256::fmadd(a_val, b1, acc1[r]);
+      }
+    }
+  }
+
+  const Vec alpha_vec(alpha);
+  const Vec beta_vec(beta);
+  const int64_t cols0 = std::min(cols, kVecSize);
+  const int64_t cols1 = cols - cols0;
+  for (int r = 0; r < ROWS; r++) {
+    scalar_t* c_row = c + r * ldc;
+    Vec out0 = acc0[r] * alpha_vec;
+    Vec out1 = acc1[r] * alpha_vec;
+    if (use_beta) {
+      out0 = vec256::fmadd(Vec::loadu(c_row, cols0), beta_vec, out0);
+      if (cols1 > 0) {
+        out1 = vec256::fmadd(Vec::loadu(c_row + kVecSize, cols1), beta_vec, out1);
+      }
+    }
+    out0.store(c_row, cols0);
+    if (cols1 > 0) {
+      out1.store(c_row + kVecSize, cols1);
+    }
+  }
+}
+
+template <typename scalar_t>
+void small_gemm(
+    int64_t m, int64_t n, int64_t k,
+    const scalar_t* a, int64_t a_row_stride, int64_t a_col_stride,
+    const scalar_t* b, int64_t ldb,
+    scalar_t* c, int64_t ldc,
+    scalar_t alpha, scalar_t beta, bool use_beta) {
+  constexpr int64_t kTileCols = 2 * vec256::Vec256<scalar_t>::size();
+  constexpr int64_t kTileRows = 4;
+  // Sweep the rows for each column block, so that the k x kTileCols block of
+  // b stays in L1
+  for (int64_t j = 0; j < n; j += kTileCols) {
+    const int64_t cols = std::min(kTileCols, n - j);
+    int64_t i = 0;
+    for (; i + kTileRows <= m; i += kTileRows) {
+      small_gemm_tile<scalar_t, kTileRows>(
+          k, cols, a + i * a_row_stride, a_row_stride, a_col_stride,
+          b + j, ldb, c + i * ldc + j, ldc, alpha, beta, use_beta);
+    }
+    const scalar_t* a_rest = a + i * a_row_stride;
+    scalar_t* c_rest = c + i * ldc + j;
+    switch (m - i) {
+      case 3:
+        small_gemm_tile<scalar_t, 3>(
+            k, cols, a_rest, a_row_stride, a_col_stride,
+            b + j, ldb, c_rest, ldc, alpha, beta, use_beta);
+        break;
+      case 2:
+        small_gemm_tile<scalar_t, 2>(
+            k, cols, a_rest, a_row_stride, a_col_stride,
+            b + j, ldb, c_rest, ldc, alpha, beta, use_beta);
+        break;
+      case 1:
+        small_gemm_tile<scalar_t, 1>(
+            k, cols, a_rest, a_row_stride, a_col_stride,
+            b + j, ldb, c_rest, ldc, alpha, beta, use_beta);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+void baddbmm_small_kernel(
+    const Tensor& result, const Tensor& batch1, const Tensor& batch2,
+    const Scalar& beta_, const Scalar& alpha_, bool is_bmm) {
+  AT_DISPATCH_FLOATING_TYPES(result.scalar_type(), "baddbmm_small", [&] {
+    const int64_t bs = result.size(0);
+    const int64_t m = result.size(1);
+    const int64_t n = result.size(2);
+    const int64_t k = batch1.size(2);
+    const scalar_t alpha = alpha_.to<scalar_t>();
+    const scalar_t beta = is_bmm ? scalar_t(0) : beta_.to<scalar_t>();
+    const bool use_beta = beta != scalar_t(0);
+
+    const scalar_t* a_data = batch1.data_ptr<scalar_t>();
+    const scalar_t* b_data = batch2.data_ptr<scalar_t>();
+    scalar_t* c_data = result.data_ptr<scalar_t>();
+    const auto a_strides = batch1.strides();
+    const auto b_strides = batch2.strides();
+    const auto c_strides = result.strides();
+    // b is packed into contiguous rows when they are not already
+    const bool pack_b = n > 1 && b_strides[2] != 1;
+
+    const double cost = std::max(
+        static_cast<double>(m * n * k) / vec256::Vec256<scalar_t>::size(), 1.0);
+    parallel_for(0, bs, at::internal::grain_size_for_cost(cost), [&](int64_t begin, int64_t end) {
+      std::vector<scalar_t> packed(pack_b ? k * n : 0);
+      for (int64_t batch = begin; batch < end; batch++) {
+        const scalar_t* b = b_data + batch * b_strides[0];
+        int64_t ldb = b_strides[1];
+        if (pack_b) {
+          for (int64_t l = 0; l < k; l++) {
+            for (int64_t j = 0; j < n; j++) {
+              packed[l * n + j] = b[l * b_strides[1] + j * b_strides[2]];
+            }
+          }
+          b = packed.data();
+          ldb = n;
+        }
+        small_gemm<scalar_t>(
+            m, n, k,
+            a_data + batch * a_strides[0], a_strides[1], a_strides[2],
+            b, ldb,
+            c_data + batch * c_strides[0], c_strides[1],
+            alpha, beta, use_beta);
+      }
+    });
+  });
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(addr_stub, &addr_kernel);
 REGISTER_DISPATCH(linalg_vector_norm_stub, &linalg_vector_norm_kernel_cpu);
+REGISTER_DISPATCH(baddbmm_small_stub, &baddbmm_small_kernel);
 
 }} // namespace at::native
@@ -5,7 +5,10 @@
 //   cpu_kernel(TensorIterator iter, <lambda>)
 //   cpu_kernel_vec(TensorIterator iter, <lambda>, <vec_lambda>)
 //
-// Both functions may generate vectorized code. The cpu_kernel implementation
+// and their variants for several outputs, cpu_kernel_multiple_outputs and
+// cpu_kernel_multiple_outputs_vec, whose lambdas return std::tuple.
+//
+// These functions may generate vectorized code. The cpu_kernel implementation
 // relies on the compiler's auto-vectorization. The cpu_kernel_vec
 // implementation uses x86 SIMD intrinsics when available. These functions
 // are only intended to be used in the ATen/native/cpu subdirectory, since files
@@ -28,6 +31,7 @@
 
 #include <stdint.h>
 #include <c10/util/C++17.h>
+#include <ATen/Parallel.h>
 #include <ATen/detail/FunctionTraits.h>
 #include <ATen/native/cpu/IsContiguous.h>
 #include <ATen/native/TensorIterator.h>
@@ -59,14 +63,13 @@ dereference(char* C10_RESTRICT data[], const int64_t* strides, int64_t i) {
   return dereference_impl<traits>(data, strides, i, Indices{});
 }
 
-template <typename traits, std::size_t... INDEX>
+template <typename traits, typename Vec, std::size_t... INDEX>
 typename traits::ArgsTuple
 dereference_vec_impl(char* C10_RESTRICT data[],
-                     const typename traits::result_type& opt_scalar,
+                     const Vec& opt_scalar,
                      size_t S,
                      int64_t i,
                      std::index_sequence<INDEX...>) {
-  using Vec = typename traits::result_type;
   using scalar_t = typename Vec::value_type;
   return std::make_tuple(
       S == INDEX + 1 ?
@@ -74,9 +77,11 @@ dereference_vec_impl(char* C10_RESTRICT data[],
       Vec::loadu(data[INDEX] + i * sizeof(scalar_t))...);
 }
 
-template <typename traits>
+// `Vec` is the vector type of the inputs; for single output kernels it is
+// also the result type.
+template <typename traits, typename Vec>
 typename traits::ArgsTuple
-dereference_vec(char* C10_RESTRICT data[], const typename traits::result_type& opt_scalar, size_t S, int64_t i) {
+dereference_vec(char* C10_RESTRICT data[], const Vec& opt_scalar, size_t S, int64_t i) {
   using Indices = std::make_index_sequence<traits::arity>;
   return dereference_vec_impl<traits>(data, opt_scalar, S, i, Indices{});
 }
@@ -227,6 +232,83 @@ vectorized_loop(char** C10_RESTRICT data_, int64_t n, int64_t S, func_t&& op, ve
   }
 }
 
+// Stores the vectors of a tuple returned by the vectorized lambda of
+// `cpu_kernel_multiple_outputs_vec`, one per output.
+template <typename scalar_t, typename VecTuple, std::size_t... INDEX>
+static inline void
+store_vec_outputs_impl(char* C10_RESTRICT data[], int64_t i, const VecTuple& outputs,
+                       std::index_sequence<INDEX...>) {
+  (void)std::initializer_list<int>{
+      (std::get<INDEX>(outputs).store(data[INDEX] + i * sizeof(scalar_t)), 0)...};
+}
+
+template <typename scalar_t, typename... Vecs>
+static inline void
+store_vec_outputs(char* C10_RESTRICT data[], int64_t i, const std::tuple<Vecs...>& outputs) {
+  store_vec_outputs_impl<scalar_t>(data, i, outputs, std::index_sequence_for<Vecs...>{});
+}
+
+// Explicitly vectorized loop for `cpu_kernel_multiple_outputs_vec`. Same
+// contract as `vectorized_loop`: all outputs and inputs have the same type
+// and are contiguous, except for an optional scalar input at position `S`
+// (1-based among the inputs, 0 if there is none). The outputs come first in
+// `data`.
+template <typename func_t, typename vec_func_t>
+static inline void
+multiple_outputs_vectorized_loop(char** C10_RESTRICT data_, int64_t n, int64_t S, func_t&& op, vec_func_t&& vop) {
+  using traits = function_traits<vec_func_t>;
+  using result_type = typename function_traits<func_t>::result_type;
+  using scalar_t = typename std::tuple_element<0, result_type>::type;
+  using Vec = Vec256<scalar_t>;
+  constexpr int num_outputs = std::tuple_size<result_type>::value;
+  constexpr int ntensors = traits::arity + num_outputs;
+
+  char* C10_RESTRICT data[ntensors];
+  for (int arg = 0; arg < ntensors; arg++) {
+    data[arg] = data_[arg];
+  }
+
+  Vec opt_scalar = Vec(S > 0 ? *(scalar_t*)data[num_outputs + S - 1] : scalar_t(0));
+  int64_t i = 0;
+  for (; i <= n - 2 * Vec::size(); i += 2 * Vec::size()) {
+    auto args1 = dereference_vec<traits>(&data[num_outputs], opt_scalar, S, i);
+    auto args2 = dereference_vec<traits>(&data[num_outputs], opt_scalar, S, i + Vec::size());
+    auto out1 = c10::guts::apply(std::forward<vec_func_t>(vop), std::move(args1));
+    auto out2 = c10::guts::apply(std::forward<vec_func_t>(vop), std::move(args2));
+    store_vec_outputs<scalar_t>(data, i, out1);
+    store_vec_outputs<scalar_t>(data, i + Vec::size(), out2);
+  }
+  if (i < n) {
+    int64_t strides[ntensors];
+    for (int arg = 0; arg < ntensors; arg++) {
+      strides[arg] = (S > 0 && arg == num_outputs + S - 1) ? 0 : sizeof(scalar_t);
+    }
+    multiple_outputs_loop(data, strides, i, n, std::forward<func_t>(op));
+  }
+}
+
+// Returns the position (1-based among the inputs) of the scalar input if all
+// other operands are contiguous, 0 if all operands are contiguous, or -1.
+template <typename scalar_t>
+static inline int64_t
+multiple_outputs_scalar_input(const int64_t* strides, int num_outputs, int ninputs) {
+  for (int arg = 0; arg < num_outputs; arg++) {
+    if (strides[arg] != sizeof(scalar_t)) {
+      return -1;
+    }
+  }
+  int64_t S = 0;
+  for (int arg = num_outputs; arg < num_outputs + ninputs; arg++) {
+    if (strides[arg] == sizeof(scalar_t)) {
+      continue;
+    }
+    if (strides[arg] != 0 || S != 0) {
+      return -1;
+    }
+    S = arg - num_outputs + 1;
+  }
+  return S;
+}
 
 template <typename traits, typename cb_t>
 static inline void unroll_contiguous_scalar_checks(
@@ -248,8 +330,11 @@ static inline void unroll_contiguous_scalar_checks(
   }
 }
 
+// `grain_size` is forwarded to TensorIteratorBase::for_each; expensive
+// kernels pass at::internal::grain_size_for_cost(cost) so that they split
+// smaller ranges across threads than the default allows.
 template <typename func_t>
-void cpu_kernel(TensorIteratorBase& iter, func_t&& op) {
+void cpu_kernel(TensorIteratorBase& iter, func_t&& op, int64_t grain_size = at::internal::GRAIN_SIZE) {
   using traits = function_traits<func_t>;
   // this could be extended to work with void return types
   TORCH_INTERNAL_ASSERT(iter.ninputs() == traits::arity);
@@ -266,7 +351,7 @@ void cpu_kernel(TensorIteratorBase& iter, func_t&& op) {
         basic_loop(data, strides, 0, n, std::forward<func_t>(op));
       });
     }
-  });
+  }, grain_size);
   iter.cast_outputs();
 }
 
@@ -297,8 +382,39 @@ void cpu_kernel_multiple_outputs(TensorIteratorBase& iter, func_t&& op) {
   iter.cast_outputs();
 }
 
+// Vectorized version of `cpu_kernel_multiple_outputs`: `op` returns a
+// std::tuple of scalars and `vop` a std::tuple of Vec256, one per output, so
+// that kernels producing several results read their inputs once. All outputs
+// and inputs must have the same dtype. For example, for sin and cos at once:
+//
+//   cpu_kernel_multiple_outputs_vec(iter,
+//     [](float a) { return std::make_tuple(std::sin(a), std::cos(a)); },
+//     [](Vec256<float> a) { return std::make_tuple(a.sin(), a.cos()); });
+template <typename func_t, typename vec_func_t>
+void cpu_kernel_multiple_outputs_vec(TensorIteratorBase& iter, func_t&& op, vec_func_t&& vop) {
+  using traits = function_traits<func_t>;
+  using result_type = typename traits::result_type;
+  using scalar_t = typename std::tuple_element<0, result_type>::type;
+  constexpr int num_outputs = std::tuple_size<result_type>::value;
+  TORCH_INTERNAL_ASSERT(iter.ninputs() == traits::arity);
+  TORCH_INTERNAL_ASSERT(iter.noutputs() == num_outputs);
+  for (int arg = 0; arg < iter.ntensors(); arg++) {
+    TORCH_INTERNAL_ASSERT(iter.dtype(arg) == c10::CppTypeToScalarType<scalar_t>::value);
+  }
+
+  iter.for_each([&](char** data, const int64_t* strides, int64_t n) {
+    int64_t S = multiple_outputs_scalar_input<scalar_t>(strides, num_outputs, traits::arity);
+    if (S >= 0) {
+      multiple_outputs_vectorized_loop(data, n, S, std::forward<func_t>(op), std::forward<vec_func_t>(vop));
+    } else {
+      multiple_outputs_loop(data, strides, 0, n, std::forward<func_t>(op));
+    }
+  });
+  iter.cast_outputs();
+}
+
 template <bool check_dynamic_cast=true, typename func_t, typename vec_func_t>
-void cpu_kernel_vec(TensorIteratorBase& iter, func_t&& op, vec_func_t&& vop) {
+void cpu_kernel_vec(TensorIteratorBase& iter, func_t&& op, vec_func_t&& vop, int64_t grain_size = at::internal::GRAIN_SIZE) {
   using traits = function_traits<func_t>;
   // this could be extended to work with void return types
   TORCH_INTERNAL_ASSERT(iter.ninputs() == traits::arity);
@@ -322,7 +438,7 @@ void cpu_kernel_vec(TensorIteratorBase& iter, func_t&& op, vec_func_t&& vop) {
         }
       });
     }
-  });
+  }, grain_size);
   iter.cast_outputs();
 }
 
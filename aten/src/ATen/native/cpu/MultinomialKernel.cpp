@@ -4,8 +4,10 @@
 #include <ATen/native/Copy.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/cpu/Loops.h>
+#include <ATen/native/cpu/DistributionTemplates.h>
 #include <ATen/core/DistributionsHelper.h>
 #include <ATen/native/UnaryOps.h>
+#include <ATen/Parallel.h>
 
 namespace at {
 namespace native {
@@ -106,6 +108,51 @@ void multinomial_with_replacement_apply(
   }
 }
 
+// See Note [Alias method for multinomial sampling]
+template <typename prob_t>
+void multinomial_alias_draw_apply(
+    Tensor& result,
+    const Tensor& J,
+    const Tensor& q,
+    c10::optional<Generator> generator) {
+  auto gen = get_generator_or_default<CPUGeneratorImpl>(generator, detail::getDefaultCPUGenerator());
+  const int64_t n_categories = J.size(-1);
+  const int64_t n_sample = result.size(-1);
+  const int64_t numel = result.numel();
+  constexpr uint64_t words = 2;
+  uint64_t seed, offset;
+  std::tie(seed, offset) = templates::cpu::philox_reserve(gen, numel, words);
+
+  Tensor out = result.is_contiguous() ? result : at::empty(result.sizes(), result.options());
+  int64_t* const out_ptr = out.data_ptr<int64_t>();
+  const int64_t* const J_ptr = J.data_ptr<int64_t>();
+  const prob_t* const q_ptr = q.data_ptr<prob_t>();
+  at::parallel_for(0, numel, templates::cpu::kPhiloxGrainSize, [&](int64_t begin, int64_t end) {
+    templates::cpu::PhiloxChunkGenerator philox(seed, offset, begin * words);
+    for (int64_t i = begin; i < end; i++) {
+      const int64_t row = (i / n_sample) * n_categories;
+      // Scale a 32 bit word to a column in [0, n_categories)
+      const int64_t col = static_cast<int64_t>(
+          (static_cast<uint64_t>(philox.random()) * static_cast<uint64_t>(n_categories)) >> 32);
+      const double u = philox.random() * (1.0 / 4294967296.0);
+      out_ptr[i] = u < q_ptr[row + col] ? col : J_ptr[row + col];
+    }
+  });
+  if (!out.is_same(result)) {
+    result.copy_(out);
+  }
+}
+
+static void multinomial_alias_draw_kernel_impl(
+    Tensor& result,
+    const Tensor& J,
+    const Tensor& q,
+    c10::optional<Generator> gen) {
+  AT_DISPATCH_FLOATING_TYPES(q.scalar_type(), "multinomial_alias_draw", [&] {
+    multinomial_alias_draw_apply<scalar_t>(result, J, q, gen);
+  });
+}
+
 static void multinomial_with_replacement_kernel_impl(
     Tensor& result,
     const Tensor& self,
@@ -120,5 +167,6 @@ static void multinomial_with_replacement_kernel_impl(
 REGISTER_DISPATCH(
     multinomial_with_replacement_stub,
     &multinomial_with_replacement_kernel_impl);
+REGISTER_DISPATCH(multinomial_alias_draw_stub, &multinomial_alias_draw_kernel_impl);
 }
 }
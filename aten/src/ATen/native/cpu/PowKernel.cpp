@@ -22,7 +22,8 @@ void pow_tensor_tensor_kernel(TensorIteratorBase& iter) {
         },
         [&](Vec base, Vec exp) -> Vec {
           return base.pow(exp);
-        }
+        },
+        at::internal::grain_size_for_cost(32)
       );
     });
   } else {
@@ -0,0 +1,104 @@
+#include <ATen/native/RNN.h>
+
+#include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+#include <algorithm>
+
+namespace at {
+namespace native {
+
+namespace {
+
+template <typename scalar_t>
+inline vec256::Vec256<scalar_t> sigmoid(vec256::Vec256<scalar_t> x) {
+  using Vec = vec256::Vec256<scalar_t>;
+  return (Vec(scalar_t(1)) + x.neg().exp()).reciprocal();
+}
+
+// Each row of the batch is done in one pass, so the gates are read once and
+// only hy and cy are written, instead of allocating a tensor per
+// intermediate of the cell.
+void lstm_cell_cpu_kernel(
+    const Tensor& gates,
+    const Tensor& cx,
+    Tensor& hy,
+    Tensor& cy) {
+  const int64_t batch_size = cx.size(0);
+  const int64_t hidden_size = cx.size(1);
+  AT_DISPATCH_FLOATING_TYPES(gates.scalar_type(), "lstm_cell_cpu", [&]() {
+    using Vec = vec256::Vec256<scalar_t>;
+    const scalar_t* gates_data = gates.data_ptr<scalar_t>();
+    const scalar_t* cx_data = cx.data_ptr<scalar_t>();
+    scalar_t* hy_data = hy.data_ptr<scalar_t>();
+    scalar_t* cy_data = cy.data_ptr<scalar_t>();
+    at::parallel_for(0, batch_size, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t b = begin; b < end; ++b) {
+        const scalar_t* g = gates_data + b * 4 * hidden_size;
+        const int64_t offset = b * hidden_size;
+        for (int64_t d = 0; d < hidden_size; d += Vec::size()) {
+          const int64_t count = std::min<int64_t>(Vec::size(), hidden_size - d);
+          const auto ingate = sigmoid(Vec::loadu(g + d, count));
+          const auto forgetgate =
+              sigmoid(Vec::loadu(g + hidden_size + d, count));
+          const auto cellgate =
+              Vec::loadu(g + 2 * hidden_size + d, count).tanh();
+          const auto outgate =
+              sigmoid(Vec::loadu(g + 3 * hidden_size + d, count));
+          const auto c = Vec::loadu(cx_data + offset + d, count);
+          const auto cy_vec = forgetgate * c + ingate * cellgate;
+          cy_vec.store(cy_data + offset + d, count);
+          (outgate * cy_vec.tanh()).store(hy_data + offset + d, count);
+        }
+      }
+    });
+  });
+}
+
+void gru_cell_cpu_kernel(
+    const Tensor& igates,
+    const Tensor& hgates,
+    const Tensor& hx,
+    Tensor& hy) {
+  const int64_t batch_size = hx.size(0);
+  const int64_t hidden_size = hx.size(1);
+  AT_DISPATCH_FLOATING_TYPES(hx.scalar_type(), "gru_cell_cpu", [&]() {
+    using Vec = vec256::Vec256<scalar_t>;
+    const scalar_t* igates_data = igates.data_ptr<scalar_t>();
+    const scalar_t* hgates_data = hgates.data_ptr<scalar_t>();
+    const scalar_t* hx_data = hx.data_ptr<scalar_t>();
+    scalar_t* hy_data = hy.data_ptr<scalar_t>();
+    at::parallel_for(0, batch_size, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t b = begin; b < end; ++b) {
+        const scalar_t* ig = igates_data + b * 3 * hidden_size;
+        const scalar_t* hg = hgates_data + b * 3 * hidden_size;
+        const int64_t offset = b * hidden_size;
+        for (int64_t d = 0; d < hidden_size; d += Vec::size()) {
+          const int64_t count = std::min<int64_t>(Vec::size(), hidden_size - d);
+          const auto reset_gate = sigmoid(
+              Vec::loadu(ig + d, count) + Vec::loadu(hg + d, count));
+          const auto input_gate = sigmoid(
+              Vec::loadu(ig + hidden_size + d, count) +
+              Vec::loadu(hg + hidden_size + d, count));
+          const auto new_gate = (Vec::loadu(ig + 2 * hidden_size + d, count) +
+                                 reset_gate *
+                                     Vec::loadu(hg + 2 * hidden_size + d, count))
+                                    .tanh();
+          const auto h = Vec::loadu(hx_data + offset + d, count);
+          ((h - new_gate) * input_gate + new_gate)
+              .store(hy_data + offset + d, count);
+        }
+      }
+    });
+  });
+}
+
+} // namespace
+
+REGISTER_DISPATCH(lstm_cell_cpu_stub, &lstm_cell_cpu_kernel);
+REGISTER_DISPATCH(gru_cell_cpu_stub, &gru_cell_cpu_kernel);
+
+} // namespace native
+} // namespace at
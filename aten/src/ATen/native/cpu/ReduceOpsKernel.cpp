@@ -1,8 +1,10 @@
 #include <numeric>
 #include <iterator>
 #include <algorithm>
+#include <vector>
 
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
 #include <ATen/cpu/vec256/vec256.h>
 #include <ATen/native/ReduceOps.h>
 #include <ATen/native/ReduceOpsUtils.h>
@@ -134,18 +136,6 @@ static void logcumsumexp_cpu_kernel(Tensor& result, const Tensor& self, int64_t
   });
 }
 
-// TODO: Implement `nansum` similar to the stable `sum`
-// implementation in cpu/SumKernel.cpp
-static void nansum_kernel_impl(TensorIterator& iter) {
-  if (iter.dtype() == ScalarType::Half){
-    binary_kernel_reduce(iter, NanSumOps<float, c10::Half>{}, float{0});
-  } else {
-    AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "nansum_cpu", [&] {
-    binary_kernel_reduce(iter, NanSumOps<scalar_t, scalar_t>{}, scalar_t{0});
-  });
-  }
-}
-
 static void mean_kernel_impl(TensorIterator& iter) {
   AT_DISPATCH_ALL_TYPES_AND_COMPLEX(iter.dtype(), "mean_cpu", [&] {
     scalar_t factor = scalar_t(iter.num_output_elements()) / scalar_t(iter.numel());
@@ -157,8 +147,250 @@ static void mean_kernel_impl(TensorIterator& iter) {
   });
 }
 
+// Note [Vectorized Welford reduction on CPU]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// var/std/var_mean over float, double and BFloat16 avoid the scalar
+// binary_kernel_reduce whenever the reduction coalesces to at most one reduced
+// and one kept dimension:
+//   * all-reduce:           the input is split into one chunk per task,
+//   * inner reduction:      each output reduces a (possibly strided) row,
+//   * outer reduction:      outputs are contiguous, each vector lane reduces
+//                           one column.
+// Each Vec256 lane runs its own Welford recurrence in the vector accumulation
+// type (float for BFloat16). All lanes of a vector see the same number of
+// elements, so the `1 / count` factor is shared. Every kWelfordBlockSize
+// updates the lane states are merged into double precision WelfordData with
+// Chan's formula and restarted, which bounds the count each low-precision
+// recurrence runs over. Partial results of lanes and of tasks are merged
+// the same way, pairwise, so that only partials of similar size are combined.
+
+constexpr int64_t kWelfordBlockSize = 4096;
+
+using WelfordAcc = WelfordData<double, int64_t, double>;
+
+template <typename scalar_t>
+struct WelfordVecType {
+  using type = Vec256<scalar_t>;
+};
+
+template <>
+struct WelfordVecType<BFloat16> {
+  using type = Vec256<float>;
+};
+
+template <typename scalar_t>
+using welford_vec_t = typename WelfordVecType<scalar_t>::type;
+
+template <typename scalar_t>
+inline welford_vec_t<scalar_t> welford_load(const char* data) {
+  return Vec256<scalar_t>::loadu(data);
+}
+
+template <>
+inline welford_vec_t<BFloat16> welford_load<BFloat16>(const char* data) {
+  Vec256<float> ret;
+  load_fp32_from_bf16(reinterpret_cast<const BFloat16*>(data), ret);
+  return ret;
+}
+
+inline WelfordAcc welford_combine(const WelfordAcc& a, const WelfordAcc& b) {
+  return WelfordOps<double, double, int64_t, double, std::tuple<double, double>>{false, false}.combine(a, b);
+}
+
+// Merges partials pairwise
+inline WelfordAcc welford_combine_all(std::vector<WelfordAcc>& partials) {
+  if (partials.empty()) {
+    return WelfordAcc();
+  }
+  for (size_t step = 1; step < partials.size(); step *= 2) {
+    for (size_t i = 0; i + step < partials.size(); i += 2 * step) {
+      partials[i] = welford_combine(partials[i], partials[i + step]);
+    }
+  }
+  return partials[0];
+}
+
+// Runs one Welford recurrence per lane over up to kWelfordBlockSize vectors,
+// `count` of them, found at `data + i * stride` for i in [0, count)
+template <typename scalar_t>
+inline void welford_vec_block(
+    const char* data, int64_t stride, int64_t count,
+    welford_vec_t<scalar_t>& mean, welford_vec_t<scalar_t>& m2) {
+  using Vec = welford_vec_t<scalar_t>;
+  using acc_t = typename Vec::value_type;
+  mean = Vec(0);
+  m2 = Vec(0);
+  for (int64_t i = 0; i < count; i++) {
+    const auto x = welford_load<scalar_t>(data + i * stride);
+    const auto delta = x - mean;
+    mean = mean + delta * Vec(acc_t(1) / acc_t(i + 1));
+    m2 = m2 + delta * (x - mean);
+  }
+}
+
+// Welford over `size` elements that are contiguous in memory
+template <typename scalar_t>
+WelfordAcc welford_contiguous(const char* data, int64_t size) {
+  using Vec = welford_vec_t<scalar_t>;
+  using acc_t = typename Vec::value_type;
+  constexpr int64_t vec_size = Vec::size();
+  const int64_t num_vecs = size / vec_size;
+
+  std::vector<WelfordAcc> partials;
+  partials.reserve(divup(num_vecs, kWelfordBlockSize) * vec_size + 1);
+  Vec mean, m2;
+  for (int64_t i = 0; i < num_vecs; i += kWelfordBlockSize) {
+    const int64_t count = std::min(kWelfordBlockSize, num_vecs - i);
+    welford_vec_block<scalar_t>(
+        data + i * vec_size * sizeof(scalar_t), vec_size * sizeof(scalar_t), count, mean, m2);
+    acc_t mean_arr[vec_size], m2_arr[vec_size];
+    mean.store(mean_arr);
+    m2.store(m2_arr);
+    for (int64_t k = 0; k < vec_size; k++) {
+      partials.emplace_back(mean_arr[k], m2_arr[k], -1, double(count));
+    }
+  }
+
+  WelfordOps<scalar_t, double, int64_t, double, std::tuple<scalar_t, scalar_t>> ops{false, false};
+  WelfordAcc tail;
+  auto* ptr = reinterpret_cast<const scalar_t*>(data);
+  for (int64_t k = num_vecs * vec_size; k < size; k++) {
+    tail = ops.reduce(tail, ptr[k], k);
+  }
+  partials.push_back(tail);
+  return welford_combine_all(partials);
+}
+
+template <typename scalar_t>
+WelfordAcc welford_strided(const char* data, int64_t stride, int64_t size) {
+  if (stride == sizeof(scalar_t)) {
+    return welford_contiguous<scalar_t>(data, size);
+  }
+  WelfordOps<scalar_t, double, int64_t, double, std::tuple<scalar_t, scalar_t>> ops{false, false};
+  WelfordAcc acc;
+  for (int64_t k = 0; k < size; k++) {
+    acc = ops.reduce(acc, *reinterpret_cast<const scalar_t*>(data + k * stride), k);
+  }
+  return acc;
+}
+
+// Returns false if the reduction doesn't fit one of the vectorized layouts
+template <typename scalar_t>
+bool std_var_vectorized(TensorIterator& iter, bool unbiased, bool take_sqrt) {
+  const int in = iter.noutputs();
+  for (int arg = 0; arg < in; arg++) {
+    if (iter.dtype(arg) != iter.dtype(in)) {
+      return false;
+    }
+  }
+
+  int64_t num_outputs, reduce_size, in_reduce_stride, in_output_stride;
+  int64_t out_strides[2] = {0, 0};
+  if (iter.ndim() == 1 && iter.is_dim_reduced(0)) {
+    num_outputs = 1;
+    reduce_size = iter.shape()[0];
+    in_reduce_stride = iter.strides(in)[0];
+    in_output_stride = 0;
+  } else if (iter.ndim() == 2 && iter.is_dim_reduced(0) != iter.is_dim_reduced(1)) {
+    const int reduce_dim = iter.is_dim_reduced(0) ? 0 : 1;
+    const int output_dim = 1 - reduce_dim;
+    num_outputs = iter.shape()[output_dim];
+    reduce_size = iter.shape()[reduce_dim];
+    in_reduce_stride = iter.strides(in)[reduce_dim];
+    in_output_stride = iter.strides(in)[output_dim];
+    for (int arg = 0; arg < in; arg++) {
+      out_strides[arg] = iter.strides(arg)[output_dim];
+    }
+  } else {
+    return false;
+  }
+
+  WelfordOps<scalar_t, double, int64_t, double, std::tuple<scalar_t, scalar_t>> ops{unbiased, take_sqrt};
+  const char* in_data = static_cast<const char*>(iter.data_ptr(in));
+  char* out_data[2] = {static_cast<char*>(iter.data_ptr(0)),
+                       in == 2 ? static_cast<char*>(iter.data_ptr(1)) : nullptr};
+  auto set_result = [&](int64_t j, const WelfordAcc& acc) {
+    auto res = ops.project(acc);
+    *reinterpret_cast<scalar_t*>(out_data[0] + j * out_strides[0]) = res.first;
+    if (in == 2) {
+      *reinterpret_cast<scalar_t*>(out_data[1] + j * out_strides[1]) = res.second;
+    }
+  };
+
+  using Vec = welford_vec_t<scalar_t>;
+  using acc_t = typename Vec::value_type;
+  constexpr int64_t vec_size = Vec::size();
+
+  if (num_outputs == 1) {
+    const int64_t num_chunks = std::max(int64_t(1), std::min(
+        int64_t(at::get_num_threads()), reduce_size / at::internal::GRAIN_SIZE));
+    const int64_t chunk_size = divup(reduce_size, num_chunks);
+    std::vector<WelfordAcc> partials(num_chunks);
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        const int64_t offset = c * chunk_size;
+        const int64_t size = std::min(chunk_size, reduce_size - offset);
+        partials[c] = welford_strided<scalar_t>(in_data + offset * in_reduce_stride, in_reduce_stride, size);
+      }
+    });
+    set_result(0, welford_combine_all(partials));
+  } else if (in_output_stride == sizeof(scalar_t) && in_reduce_stride != sizeof(scalar_t) &&
+             num_outputs >= vec_size) {
+    // Outer reduction: each lane reduces one column
+    const int64_t num_col_vecs = num_outputs / vec_size;
+    const int64_t grain_size = std::max(int64_t(1), at::internal::GRAIN_SIZE / (reduce_size * vec_size));
+    at::parallel_for(0, num_col_vecs + 1, grain_size, [&](int64_t begin, int64_t end) {
+      std::vector<WelfordAcc> partials;
+      for (int64_t v = begin; v < end; v++) {
+        if (v == num_col_vecs) {
+          // Remaining columns
+          for (int64_t j = num_col_vecs * vec_size; j < num_outputs; j++) {
+            set_result(j, welford_strided<scalar_t>(in_data + j * in_output_stride, in_reduce_stride, reduce_size));
+          }
+          continue;
+        }
+        const char* col_data = in_data + v * vec_size * sizeof(scalar_t);
+        std::vector<std::vector<WelfordAcc>> lane_partials(vec_size);
+        Vec mean, m2;
+        for (int64_t i = 0; i < reduce_size; i += kWelfordBlockSize) {
+          const int64_t count = std::min(kWelfordBlockSize, reduce_size - i);
+          welford_vec_block<scalar_t>(col_data + i * in_reduce_stride, in_reduce_stride, count, mean, m2);
+          acc_t mean_arr[vec_size], m2_arr[vec_size];
+          mean.store(mean_arr);
+          m2.store(m2_arr);
+          for (int64_t k = 0; k < vec_size; k++) {
+            lane_partials[k].emplace_back(mean_arr[k], m2_arr[k], -1, double(count));
+          }
+        }
+        for (int64_t k = 0; k < vec_size; k++) {
+          set_result(v * vec_size + k, welford_combine_all(lane_partials[k]));
+        }
+      }
+    });
+  } else {
+    // Inner reduction: each output reduces one row
+    const int64_t grain_size = std::max(int64_t(1), at::internal::GRAIN_SIZE / reduce_size);
+    at::parallel_for(0, num_outputs, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t j = begin; j < end; j++) {
+        set_result(j, welford_strided<scalar_t>(in_data + j * in_output_stride, in_reduce_stride, reduce_size));
+      }
+    });
+  }
+  return true;
+}
+
+// Half has no vectorized arithmetic, keep it on binary_kernel_reduce
+template <>
+bool std_var_vectorized<Half>(TensorIterator& iter, bool unbiased, bool take_sqrt) {
+  return false;
+}
+
 static void std_var_kernel_impl(TensorIterator &iter, bool unbiased, bool take_sqrt) {
-  AT_DISPATCH_FLOATING_TYPES_AND_HALF(iter.dtype(), "std_cpu", [&] {
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, iter.dtype(), "std_cpu", [&] {
+    // See Note [Vectorized Welford reduction on CPU]
+    if (std_var_vectorized<scalar_t>(iter, unbiased, take_sqrt)) {
+      return;
+    }
     binary_kernel_reduce(
       iter,
       WelfordOps<scalar_t, double, int64_t, double, std::tuple<scalar_t, scalar_t>> { unbiased, take_sqrt },
@@ -396,7 +628,6 @@ static void argmin_kernel_impl(TensorIterator &iter) {
 
 }  // anonymous namespace
 
-REGISTER_DISPATCH(nansum_stub, &nansum_kernel_impl);
 REGISTER_DISPATCH(std_var_stub, &std_var_kernel_impl);
 REGISTER_DISPATCH(prod_stub, &prod_kernel_impl);
 REGISTER_DISPATCH(mean_stub, &mean_kernel_impl);
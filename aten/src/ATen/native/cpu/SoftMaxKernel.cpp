@@ -7,7 +7,9 @@
 #include <ATen/Dispatch.h>
 #include <ATen/Parallel.h>
 #include <ATen/cpu/vec256/functional.h>
+#include <ATen/cpu/vec256/functional_bfloat16.h>
 #include <ATen/cpu/vec256/vec256.h>
+#include <ATen/cpu/vec512/functional.h>
 #include <c10/util/Optional.h>
 
 // [Note AVX-SSE transitions] In general we avoid calls into cmath for code
@@ -98,7 +100,14 @@ inline void _vec_softmax_lastdim(
     scalar_t* output_data_base,
     int64_t outer_size,
     int64_t dim_size) {
+#if defined(CPU_CAPABILITY_AVX512)
+  // Process rows 512 bits at a time; see Note [Vec512 fallback].
+  namespace vec = vec512;
+  using Vec = vec512::Vec512<scalar_t>;
+#else
+  namespace vec = vec256;
   using Vec = vec256::Vec256<scalar_t>;
+#endif
   int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size);
   if (grain_size < 1)
     grain_size = 1;
@@ -111,19 +120,19 @@ inline void _vec_softmax_lastdim(
         for (int64_t i = begin; i < end; i++) {
           scalar_t* input_data = input_data_base + i * dim_size;
           scalar_t* output_data = output_data_base + i * dim_size;
-          scalar_t max_input = vec256::reduce_all<scalar_t>(
-              [](Vec& x, Vec& y) { return vec256::maximum(x, y); },
+          scalar_t max_input = vec::reduce_all<scalar_t>(
+              [](const auto& x, const auto& y) { return maximum(x, y); },
               input_data,
               dim_size);
-          vec256::map(
+          vec::map(
               [max_input](Vec x) { return (x - Vec(max_input)).exp(); },
               output_data,
               input_data,
               dim_size);
-          scalar_t tmp_sum = vec256::reduce_all<scalar_t>(
-              [](Vec x, Vec y) { return x + y; }, output_data, dim_size);
+          scalar_t tmp_sum = vec::reduce_all<scalar_t>(
+              [](const auto& x, const auto& y) { return x + y; }, output_data, dim_size);
           tmp_sum = 1 / tmp_sum;
-          vec256::map(
+          vec::map(
               [tmp_sum](Vec x) { return x * Vec(tmp_sum); },
               output_data,
               output_data,
@@ -132,6 +141,113 @@ inline void _vec_softmax_lastdim(
       });
 }
 
+// BFloat16 overloads of the two kernels above. Row statistics and
+// intermediates are kept in float and every row is read and written at
+// BFloat16 width, see Note [BFloat16 functional overloads].
+inline void _vec_log_softmax_lastdim(
+    BFloat16* input_data_base,
+    BFloat16* output_data_base,
+    int64_t outer_size,
+    int64_t dim_size) {
+  using Vec = vec256::Vec256<float>;
+  static constexpr int64_t CHUNK_SIZE = (128 / sizeof(BFloat16)) * Vec::size();
+  int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size * CHUNK_SIZE);
+  if (grain_size < CHUNK_SIZE)
+    grain_size = CHUNK_SIZE;
+
+  parallel_for(
+      0,
+      outer_size,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t ii = begin; ii < end; ii += CHUNK_SIZE) {
+          float tmp_sum_scalar[CHUNK_SIZE];
+          float max_input_arr[CHUNK_SIZE];
+          int64_t loop_end = CHUNK_SIZE;
+          if (ii + CHUNK_SIZE > end)
+            loop_end = end - ii;
+          for (int64_t j = 0; j < loop_end; j++) {
+            int64_t i = ii + j;
+            BFloat16* input_data = input_data_base + i * dim_size;
+            max_input_arr[j] = vec256::reduce_all(
+                [](Vec& x, Vec& y) { return vec256::maximum(x, y); },
+                input_data,
+                dim_size);
+          }
+          for (int64_t j = 0; j < loop_end; j++) {
+            int64_t i = ii + j;
+            BFloat16* input_data = input_data_base + i * dim_size;
+            float max_input = max_input_arr[j];
+            tmp_sum_scalar[j] = vec256::map_reduce_all(
+                [max_input](Vec x) { return (x - Vec(max_input)).exp(); },
+                [](Vec x, Vec y) { return x + y; },
+                input_data,
+                dim_size);
+          }
+          // See [Note AVX-SSE transitions] for why this should call the
+          // vectorized version (aside from perf improvements).
+          vec256::map(
+              [](Vec x) { return x.log(); },
+              tmp_sum_scalar,
+              tmp_sum_scalar,
+              loop_end);
+          for (int64_t j = 0; j < loop_end; j++) {
+            int64_t i = ii + j;
+            BFloat16* input_data = input_data_base + i * dim_size;
+            BFloat16* output_data = output_data_base + i * dim_size;
+            float tmp_sum = tmp_sum_scalar[j];
+            float max_input = max_input_arr[j];
+            vec256::map(
+                [tmp_sum, max_input](Vec x) { return x - Vec(max_input) - Vec(tmp_sum); },
+                output_data,
+                input_data,
+                dim_size);
+          }
+        }
+      });
+}
+
+inline void _vec_softmax_lastdim(
+    BFloat16* input_data_base,
+    BFloat16* output_data_base,
+    int64_t outer_size,
+    int64_t dim_size) {
+  using Vec = vec256::Vec256<float>;
+  int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size);
+  if (grain_size < 1)
+    grain_size = 1;
+
+  parallel_for(
+      0,
+      outer_size,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          BFloat16* input_data = input_data_base + i * dim_size;
+          BFloat16* output_data = output_data_base + i * dim_size;
+          float max_input = vec256::reduce_all(
+              [](Vec& x, Vec& y) { return vec256::maximum(x, y); },
+              input_data,
+              dim_size);
+          float tmp_sum = vec256::map_reduce_all(
+              [max_input](Vec x) { return (x - Vec(max_input)).exp(); },
+              [](Vec x, Vec y) { return x + y; },
+              input_data,
+              dim_size);
+          tmp_sum = 1 / tmp_sum;
+          // Recompute exp() instead of re-reading rounded BFloat16 values
+          // from output_data, so the normalization happens in float.
+          vec256::map(
+              [max_input, tmp_sum](Vec x) {
+                return (x - Vec(max_input)).exp() * Vec(tmp_sum);
+              },
+              output_data,
+              input_data,
+              dim_size);
+        }
+      });
+}
+
 template <typename scalar_t, bool log_softmax>
 inline void _vec_host_softmax_backward_lastdim(
     scalar_t* grad_input_data_base,
@@ -224,9 +340,10 @@ struct vec_host_softmax_backward_lastdim {
 };
 
 static void softmax_lastdim_kernel_impl(Tensor& result, const Tensor& self) {
-  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "softmax_lastdim_kernel_impl", [&] {
-    vec_host_softmax_lastdim<scalar_t, false>::apply(result, self);
-  });
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, self.scalar_type(),
+      "softmax_lastdim_kernel_impl",
+      [&] { vec_host_softmax_lastdim<scalar_t, false>::apply(result, self); });
 }
 
 static void log_softmax_lastdim_kernel_impl(
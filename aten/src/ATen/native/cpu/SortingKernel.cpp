@@ -8,6 +8,10 @@
 #include <ATen/native/Sorting.h>
 #include <ATen/native/SortingUtils.h>
 
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
 namespace at { namespace native {
 
 namespace {
@@ -92,6 +96,266 @@ struct KeyValueCompDesc {
   }
 };
 
+// Note [Parallel sort for large slices]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Sorting one big slice with std::sort over a CompositeRandomAccessor runs on
+// a single core and chases two strided arrays at once. Slices with at least
+// kParallelSortMinSize elements are instead copied to contiguous buffers of
+// (radix key, index) and sorted with all threads:
+//
+//   - keys of at most 4 bytes use an LSD radix sort with 8-bit digits. Each
+//     pass builds per-chunk histograms in parallel, turns them into scatter
+//     offsets and scatters in parallel. Passes where every key has the same
+//     digit are skipped.
+//   - 8-byte keys (int64_t, double) sort equally sized chunks in parallel and
+//     then merge runs pairwise. Every merge is split along its merge path so
+//     that all threads stay busy during the last rounds as well.
+//
+// Floating point values are mapped to unsigned integers with the same order
+// as KeyValueCompAsc: -0.0 is mapped to the key of 0.0 and every NaN to the
+// largest key. Descending order uses the bitwise complement of the key, which
+// puts NaNs first like KeyValueCompDesc. Both algorithms keep equal keys in
+// their original order, so the result is stable whether or not `stable` was
+// requested.
+constexpr int64_t kParallelSortMinSize = 1 << 16;
+constexpr int kRadixBits = 8;
+constexpr int kRadixBuckets = 1 << kRadixBits;
+
+template <typename key_t>
+key_t _float_radix_key(key_t bits, bool is_nan) {
+  constexpr key_t sign = key_t(1) << (sizeof(key_t) * 8 - 1);
+  if (is_nan) {
+    return ~key_t(0);
+  }
+  if (bits == sign) {
+    bits = 0;
+  }
+  return (bits & sign) ? key_t(~bits) : key_t(bits | sign);
+}
+
+template <typename scalar_t, typename Enable = void>
+struct RadixKey;
+
+template <typename scalar_t>
+struct RadixKey<scalar_t, typename std::enable_if<
+    std::is_integral<scalar_t>::value && !std::is_same<scalar_t, bool>::value>::type> {
+  using type = typename std::make_unsigned<scalar_t>::type;
+  static type get(scalar_t v) {
+    constexpr type sign = std::is_signed<scalar_t>::value ?
+      type(type(1) << (sizeof(type) * 8 - 1)) : type(0);
+    return type(static_cast<type>(v) ^ sign);
+  }
+};
+
+template <>
+struct RadixKey<bool> {
+  using type = uint8_t;
+  static type get(bool v) {
+    return static_cast<type>(v);
+  }
+};
+
+template <>
+struct RadixKey<float> {
+  using type = uint32_t;
+  static type get(float v) {
+    type bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return _float_radix_key(bits, _isnan(v));
+  }
+};
+
+template <>
+struct RadixKey<double> {
+  using type = uint64_t;
+  static type get(double v) {
+    type bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return _float_radix_key(bits, _isnan(v));
+  }
+};
+
+template <>
+struct RadixKey<c10::Half> {
+  using type = uint16_t;
+  static type get(c10::Half v) {
+    return _float_radix_key<type>(v.x, _isnan(v));
+  }
+};
+
+// Number of contiguous chunks of at least `min_chunk_size` elements that a
+// parallel phase splits `n` elements into. The chunking has to be identical
+// between the histogram and scatter phases of the radix sort.
+inline int64_t _num_chunks(int64_t n, int64_t min_chunk_size) {
+  const int64_t max_chunks = at::in_parallel_region() ? 1 : at::get_num_threads();
+  return std::max<int64_t>(1, std::min(max_chunks, n / min_chunk_size));
+}
+
+// Sorts `idx` by `keys` and returns the buffer (either `idx` or `idx_tmp`)
+// holding the sorted indices
+template <typename key_t>
+const int64_t* _radix_sort(
+    key_t* keys, int64_t* idx, key_t* keys_tmp, int64_t* idx_tmp, int64_t n) {
+  const int64_t num_chunks = _num_chunks(n, kParallelSortMinSize / 4);
+  const int64_t chunk_size = (n + num_chunks - 1) / num_chunks;
+  std::vector<int64_t> offsets(num_chunks * kRadixBuckets);
+
+  for (int shift = 0; shift < static_cast<int>(sizeof(key_t)) * 8; shift += kRadixBits) {
+    std::fill(offsets.begin(), offsets.end(), 0);
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* hist = offsets.data() + c * kRadixBuckets;
+        const int64_t hi = std::min(n, (c + 1) * chunk_size);
+        for (int64_t i = c * chunk_size; i < hi; i++) {
+          hist[(keys[i] >> shift) & (kRadixBuckets - 1)]++;
+        }
+      }
+    });
+
+    // Exclusive scan in (digit, chunk) order: chunk c writes its elements
+    // with a given digit after those of all chunks before it, which keeps
+    // every pass stable.
+    bool all_same_digit = false;
+    int64_t offset = 0;
+    for (int64_t b = 0; b < kRadixBuckets; b++) {
+      int64_t bucket_size = 0;
+      for (int64_t c = 0; c < num_chunks; c++) {
+        const int64_t count = offsets[c * kRadixBuckets + b];
+        offsets[c * kRadixBuckets + b] = offset;
+        offset += count;
+        bucket_size += count;
+      }
+      all_same_digit |= (bucket_size == n);
+    }
+    if (all_same_digit) {
+      continue;
+    }
+
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* pos = offsets.data() + c * kRadixBuckets;
+        const int64_t hi = std::min(n, (c + 1) * chunk_size);
+        for (int64_t i = c * chunk_size; i < hi; i++) {
+          const int64_t dst = pos[(keys[i] >> shift) & (kRadixBuckets - 1)]++;
+          keys_tmp[dst] = keys[i];
+          idx_tmp[dst] = idx[i];
+        }
+      }
+    });
+    std::swap(keys, keys_tmp);
+    std::swap(idx, idx_tmp);
+  }
+  return idx;
+}
+
+// Number of elements of `a` among the first `diag` outputs of a stable
+// merge of `a` and `b`
+template <typename T>
+int64_t _merge_path_split(
+    const T* a, int64_t a_size, const T* b, int64_t b_size, int64_t diag) {
+  int64_t lo = std::max<int64_t>(0, diag - b_size);
+  int64_t hi = std::min(diag, a_size);
+  while (lo < hi) {
+    const int64_t mid = lo + (hi - lo) / 2;
+    if (!(b[diag - mid - 1] < a[mid])) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+// Sorts (key, index) pairs and returns the buffer (either `data` or `tmp`)
+// holding the result. Indices are unique and increasing within each chunk,
+// so ordering by the whole pair is the same as a stable sort by key.
+template <typename key_t>
+const std::pair<key_t, int64_t>* _merge_sort(
+    std::pair<key_t, int64_t>* data, std::pair<key_t, int64_t>* tmp, int64_t n) {
+  const int64_t num_chunks = _num_chunks(n, kParallelSortMinSize / 4);
+  const int64_t chunk_size = (n + num_chunks - 1) / num_chunks;
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      std::sort(data + c * chunk_size, data + std::min(n, (c + 1) * chunk_size));
+    }
+  });
+
+  for (int64_t width = chunk_size; width < n; width *= 2) {
+    const int64_t num_merges = (n + 2 * width - 1) / (2 * width);
+    const int64_t parts = std::max<int64_t>(1, num_chunks / num_merges);
+    at::parallel_for(0, num_merges * parts, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t t = begin; t < end; t++) {
+        const int64_t start = (t / parts) * 2 * width;
+        const int64_t part = t % parts;
+        const auto* a = data + start;
+        const int64_t a_size = std::min(width, n - start);
+        const auto* b = a + a_size;
+        const int64_t b_size = std::min(width, n - start - a_size);
+        const int64_t d0 = (a_size + b_size) * part / parts;
+        const int64_t d1 = (a_size + b_size) * (part + 1) / parts;
+        const int64_t i0 = _merge_path_split(a, a_size, b, b_size, d0);
+        const int64_t i1 = _merge_path_split(a, a_size, b, b_size, d1);
+        std::merge(a + i0, a + i1, b + (d0 - i0), b + (d1 - i1), tmp + start + d0);
+      }
+    });
+    std::swap(data, tmp);
+  }
+  return data;
+}
+
+// See Note [Parallel sort for large slices]
+template <typename scalar_t>
+void _parallel_sort_slice(
+    scalar_t* values, int64_t values_dim_stride,
+    int64_t* indices, int64_t indices_dim_stride,
+    int64_t dim_size, bool descending) {
+  using key_t = typename RadixKey<scalar_t>::type;
+  const key_t key_mask = descending ? ~key_t(0) : key_t(0);
+  const int64_t grain_size = kParallelSortMinSize / 4;
+
+  // Not a std::vector, which packs bool and can't be written from several threads
+  std::unique_ptr<scalar_t[]> orig_values(new scalar_t[dim_size]);
+  at::parallel_for(0, dim_size, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      orig_values[i] = values[i * values_dim_stride];
+    }
+  });
+
+  auto write_sorted = [&](const auto& sorted_index) {
+    at::parallel_for(0, dim_size, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        const int64_t j = sorted_index(i);
+        values[i * values_dim_stride] = orig_values[j];
+        indices[i * indices_dim_stride] = j;
+      }
+    });
+  };
+
+  if (sizeof(key_t) <= 4) {
+    std::vector<key_t> keys(dim_size), keys_tmp(dim_size);
+    std::vector<int64_t> idx(dim_size), idx_tmp(dim_size);
+    at::parallel_for(0, dim_size, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        keys[i] = key_t(RadixKey<scalar_t>::get(orig_values[i]) ^ key_mask);
+        idx[i] = i;
+      }
+    });
+    const int64_t* sorted = _radix_sort(
+      keys.data(), idx.data(), keys_tmp.data(), idx_tmp.data(), dim_size);
+    write_sorted([sorted](int64_t i) { return sorted[i]; });
+  } else {
+    using elem_t = std::pair<key_t, int64_t>;
+    std::vector<elem_t> data(dim_size), tmp(dim_size);
+    at::parallel_for(0, dim_size, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        data[i] = elem_t(key_t(RadixKey<scalar_t>::get(orig_values[i]) ^ key_mask), i);
+      }
+    });
+    const elem_t* sorted = _merge_sort(data.data(), tmp.data(), dim_size);
+    write_sorted([sorted](int64_t i) { return sorted[i].second; });
+  }
+}
+
 static void sort_kernel(
     Tensor& values,
     Tensor& indices,
@@ -108,6 +372,13 @@ static void sort_kernel(
       int64_t dim_size
     ) {
       using scalar_t = typename std::remove_pointer<decltype(values)>::type;
+      if (dim_size >= kParallelSortMinSize) {
+        _parallel_sort_slice(
+          values, values_dim_stride, indices, indices_dim_stride,
+          dim_size, descending);
+        return;
+      }
+
       auto values_accessor = StridedRandomAccessor<scalar_t>(
         values, values_dim_stride);
       auto indices_accessor = StridedRandomAccessor<int64_t>(
@@ -140,6 +411,150 @@ static void sort_kernel(
   );
 }
 
+// Note [CPU topk]
+// ~~~~~~~~~~~~~~~
+// topk works on the radix keys of Note [Parallel sort for large slices],
+// complemented when `largest` is set, so it always selects the k smallest
+// (key, index) pairs. NaN is the largest value as in sort, and ties are
+// resolved in favour of the smaller index. Per row, one of two strategies is
+// used:
+//
+//   - for k * kTopkHeapRatio <= n, a max-heap holds the best k pairs seen so
+//     far. The row is scanned in blocks of kTopkBlockSize keys: a branch-free
+//     test of whether any key in the block beats the heap top (which the
+//     compiler vectorizes) lets most blocks skip the heap entirely.
+//   - otherwise, a radix select finds the k-th smallest key one 8-bit digit at
+//     a time, and a last pass collects all keys below it plus the leading ties.
+//
+// Rows are processed in parallel. When there are fewer rows than threads,
+// rows of at least kTopkParallelMinSize elements are split into chunks whose
+// local top k are computed in parallel and then reduced to the final k.
+constexpr int64_t kTopkHeapRatio = 64;
+constexpr int64_t kTopkBlockSize = 64;
+constexpr int64_t kTopkParallelMinSize = 1 << 18;
+
+template <typename key_t>
+void _topk_heap(const key_t* keys, int64_t n, int64_t k, std::pair<key_t, int64_t>* out) {
+  using elem_t = std::pair<key_t, int64_t>;
+  for (int64_t i = 0; i < k; i++) {
+    out[i] = elem_t(keys[i], i);
+  }
+  std::make_heap(out, out + k);
+  key_t threshold = out[0].first;
+  for (int64_t i = k; i < n; i += kTopkBlockSize) {
+    const int64_t len = std::min(kTopkBlockSize, n - i);
+    bool any_smaller = false;
+    for (int64_t j = 0; j < len; j++) {
+      any_smaller |= keys[i + j] < threshold;
+    }
+    if (!any_smaller) {
+      continue;
+    }
+    // A later index never beats an equal key, so strict `<` keeps ties stable
+    for (int64_t j = 0; j < len; j++) {
+      if (keys[i + j] < threshold) {
+        std::pop_heap(out, out + k);
+        out[k - 1] = elem_t(keys[i + j], i + j);
+        std::push_heap(out, out + k);
+        threshold = out[0].first;
+      }
+    }
+  }
+}
+
+template <typename key_t>
+void _topk_radix_select(const key_t* keys, int64_t n, int64_t k, std::pair<key_t, int64_t>* out) {
+  using elem_t = std::pair<key_t, int64_t>;
+  key_t prefix = 0;
+  key_t prefix_mask = 0;
+  // number of keys equal to the final `prefix` that belong to the top k
+  int64_t remaining = k;
+  for (int shift = static_cast<int>(sizeof(key_t)) * 8 - kRadixBits; shift >= 0; shift -= kRadixBits) {
+    int64_t hist[kRadixBuckets] = {0};
+    for (int64_t i = 0; i < n; i++) {
+      if ((keys[i] & prefix_mask) == prefix) {
+        hist[(keys[i] >> shift) & (kRadixBuckets - 1)]++;
+      }
+    }
+    int64_t digit = 0;
+    while (hist[digit] < remaining) {
+      remaining -= hist[digit];
+      digit++;
+    }
+    prefix |= key_t(key_t(digit) << shift);
+    prefix_mask |= key_t(key_t(kRadixBuckets - 1) << shift);
+  }
+
+  int64_t j = 0;
+  for (int64_t i = 0; i < n && j < k; i++) {
+    if (keys[i] < prefix) {
+      out[j++] = elem_t(keys[i], i);
+    } else if (keys[i] == prefix && remaining > 0) {
+      out[j++] = elem_t(keys[i], i);
+      remaining--;
+    }
+  }
+}
+
+template <typename key_t>
+void _topk_select(const key_t* keys, int64_t n, int64_t k, std::pair<key_t, int64_t>* out) {
+  if (k * kTopkHeapRatio <= n) {
+    _topk_heap(keys, n, k, out);
+  } else {
+    _topk_radix_select(keys, n, k, out);
+  }
+}
+
+// See Note [CPU topk]. Writes the k smallest (key, index) pairs of keys[0, n)
+// to `out`, in ascending order if `sorted`.
+template <typename key_t>
+void _topk_keys(
+    const key_t* keys, int64_t n, int64_t k, bool sorted, bool split_row,
+    std::pair<key_t, int64_t>* out) {
+  using elem_t = std::pair<key_t, int64_t>;
+  const int64_t num_chunks = split_row ? _num_chunks(n, kTopkParallelMinSize / 4) : 1;
+  if (num_chunks == 1) {
+    _topk_select(keys, n, k, out);
+    if (sorted) {
+      std::sort(out, out + k);
+    }
+    return;
+  }
+
+  // The top k of the row are among the union of the top k of every chunk
+  const int64_t chunk_size = (n + num_chunks - 1) / num_chunks;
+  std::vector<elem_t> candidates(num_chunks * k);
+  std::vector<int64_t> num_candidates(num_chunks);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      const int64_t start = c * chunk_size;
+      const int64_t len = std::max<int64_t>(0, std::min(chunk_size, n - start));
+      const int64_t chunk_k = std::min(k, len);
+      elem_t* chunk_out = candidates.data() + c * k;
+      if (chunk_k > 0) {
+        _topk_select(keys + start, len, chunk_k, chunk_out);
+      }
+      for (int64_t i = 0; i < chunk_k; i++) {
+        chunk_out[i].second += start;
+      }
+      num_candidates[c] = chunk_k;
+    }
+  });
+
+  int64_t total = 0;
+  for (int64_t c = 0; c < num_chunks; c++) {
+    std::copy(candidates.begin() + c * k, candidates.begin() + c * k + num_candidates[c],
+              candidates.begin() + total);
+    total += num_candidates[c];
+  }
+  if (sorted) {
+    std::partial_sort(candidates.begin(), candidates.begin() + k, candidates.begin() + total);
+  } else {
+    std::nth_element(candidates.begin(), candidates.begin() + (k - 1), candidates.begin() + total);
+  }
+  std::copy(candidates.begin(), candidates.begin() + k, out);
+}
+
 static void topk_kernel(
     Tensor& values,
     Tensor& indices,
@@ -148,69 +563,61 @@ static void topk_kernel(
     int64_t dim,
     bool largest,
     bool sorted) {
+  if (k == 0) {
+    return;
+  }
+  auto sizes = self.sizes();
+  auto iter = TensorIteratorConfig()
+    .check_all_same_dtype(false)
+    .resize_outputs(false)
+    .declare_static_shape(sizes, /*squash_dim=*/dim)
+    .add_output(values)
+    .add_output(indices)
+    .add_input(self)
+    .build();
+
+  const int64_t mode_values_stride = values.stride(dim);
+  const int64_t mode_indices_stride = indices.stride(dim);
+  const int64_t tmp_values_stride = self.stride(dim);
+  const int64_t dim_size = sizes[dim];
+  const int64_t num_rows = iter.numel();
+
+  // See Note [CPU topk]: either rows are spread over threads, or every row
+  // is split between them
+  const bool split_rows = dim_size >= kTopkParallelMinSize && num_rows < at::get_num_threads();
+  const int64_t grain_size = split_rows ?
+    num_rows + 1 : internal::GRAIN_SIZE / std::max<int64_t>(1, dim_size);
+
   AT_DISPATCH_ALL_TYPES(self.scalar_type(), "topk_cpu", [&] {
-    dim_apply(
-        {self, values, indices},
-        dim,
-        [&](int64_t i, TensorList tl) {
-          auto tmp_values = tl[0].accessor<scalar_t, 1>();
-          auto mode_values = tl[1].accessor<scalar_t, 1>();
-          auto mode_indices = tl[2].accessor<int64_t, 1>();
-
-          auto n = tmp_values.size(0);
-          auto use_partial_sort = k * 64 <= n;
-
-          using elem_t = std::pair<scalar_t, int64_t>;
-          std::vector<elem_t> queue(n);
-          for (int64_t j = 0; j < n; j++) {
-            queue[j].first = tmp_values[j];
-            queue[j].second = j;
-          }
-
-          // we want NaN to be sorted as top for numpy compatibility
-          if (use_partial_sort) {
-            if (largest) {
-              std::partial_sort(queue.begin(), queue.begin() + k, queue.end(),
-                [](const elem_t& x, const elem_t& y) -> bool {
-                  return ((_isnan<scalar_t>(x.first) && !_isnan<scalar_t>(y.first)) || (x.first > y.first));
-                });
-            } else {
-              std::partial_sort(queue.begin(), queue.begin() + k, queue.end(),
-                [](const elem_t& x, const elem_t& y) -> bool {
-                  return ((!_isnan<scalar_t>(x.first) && _isnan<scalar_t>(y.first)) || (x.first < y.first));
-                });
-            }
-          } else {
-            if (largest) {
-              std::nth_element(queue.begin(), queue.begin() + k - 1, queue.end(),
-                [](const elem_t& x, const elem_t& y) -> bool {
-                  return ((_isnan<scalar_t>(x.first) && !_isnan<scalar_t>(y.first)) || (x.first > y.first));
-                });
-              if (sorted) {
-                std::sort(queue.begin(), queue.begin() + k - 1,
-                  [](const elem_t& x, const elem_t& y) -> bool {
-                    return ((_isnan<scalar_t>(x.first) && !_isnan<scalar_t>(y.first)) || (x.first > y.first));
-                  });
-              }
-            } else {
-              std::nth_element(queue.begin(), queue.begin() + k -1, queue.end(),
-                [](const elem_t& x, const elem_t& y) -> bool {
-                  return ((!_isnan<scalar_t>(x.first) && _isnan<scalar_t>(y.first)) || (x.first < y.first));
-                });
-              if (sorted) {
-                std::sort(queue.begin(), queue.begin() + k -1,
-                  [](const elem_t& x, const elem_t& y) -> bool {
-                    return ((!_isnan<scalar_t>(x.first) && _isnan<scalar_t>(y.first)) || (x.first < y.first));
-                  });
-              }
+    using key_t = typename RadixKey<scalar_t>::type;
+    const key_t key_mask = largest ? ~key_t(0) : key_t(0);
+
+    auto loop = [&](char** data, const int64_t* strides, int64_t n) {
+      std::vector<key_t> keys(dim_size);
+      std::vector<std::pair<key_t, int64_t>> queue(k);
+      for (int64_t r = 0; r < n; r++) {
+        auto* mode_values = reinterpret_cast<scalar_t*>(data[0] + r * strides[0]);
+        auto* mode_indices = reinterpret_cast<int64_t*>(data[1] + r * strides[1]);
+        const auto* tmp_values = reinterpret_cast<const scalar_t*>(data[2] + r * strides[2]);
+
+        at::parallel_for(0, dim_size, split_rows ? kTopkParallelMinSize / 4 : dim_size,
+          [&](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; i++) {
+              keys[i] = key_t(RadixKey<scalar_t>::get(tmp_values[i * tmp_values_stride]) ^ key_mask);
             }
-          }
+          });
+
+        _topk_keys(keys.data(), dim_size, k, sorted, split_rows, queue.data());
+
+        for (int64_t j = 0; j < k; j++) {
+          const int64_t index = queue[j].second;
+          mode_values[j * mode_values_stride] = tmp_values[index * tmp_values_stride];
+          mode_indices[j * mode_indices_stride] = index;
+        }
+      }
+    };
 
-          for (int64_t j = 0; j < k; j++) {
-            mode_values[j] = queue[j].first;
-            mode_indices[j] = queue[j].second;
-          }
-        });
+    iter.for_each(loop, grain_size);
   });
 }
 
@@ -0,0 +1,86 @@
+#include <ATen/ATen.h>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/functional.h>
+#include <ATen/cpu/vec256/vec256.h>
+#include <ATen/native/cpu/SparseCoalesceKernel.h>
+
+#include <algorithm>
+
+namespace at {
+namespace native {
+
+namespace {
+
+using namespace vec256;
+
+template <typename scalar_t>
+void sparse_coalesce_values_kernel_impl(
+    Tensor& new_values,
+    const Tensor& values,
+    const Tensor& permutation,
+    const Tensor& segment_offsets) {
+  using Vec = Vec256<scalar_t>;
+  const int64_t num_segments = segment_offsets.numel() - 1;
+  const int64_t nnz = values.size(0);
+  if (num_segments <= 0 || values.numel() == 0) {
+    return;
+  }
+  const int64_t block_size = values.numel() / nnz;
+
+  const scalar_t* values_ptr = values.data_ptr<scalar_t>();
+  scalar_t* new_values_ptr = new_values.data_ptr<scalar_t>();
+  const int64_t* perm = permutation.data_ptr<int64_t>();
+  const int64_t* offsets = segment_offsets.data_ptr<int64_t>();
+
+  // Segments differ in length, but on average cover nnz / num_segments rows.
+  const int64_t rows_per_segment = std::max<int64_t>(nnz / num_segments, 1);
+  const int64_t grain_size = std::max<int64_t>(
+      internal::GRAIN_SIZE / (rows_per_segment * block_size), 1);
+  at::parallel_for(0, num_segments, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t u = begin; u < end; ++u) {
+      scalar_t* dst = new_values_ptr + u * block_size;
+      const int64_t first = offsets[u];
+      const int64_t last = offsets[u + 1];
+      const scalar_t* src = values_ptr + perm[first] * block_size;
+      if (last - first == 1) {
+        std::copy(src, src + block_size, dst);
+        continue;
+      }
+      // Summing the first two rows also initializes dst.
+      vec256::map2(
+          [](Vec x, Vec y) { return x + y; },
+          dst,
+          src,
+          values_ptr + perm[first + 1] * block_size,
+          block_size);
+      for (int64_t p = first + 2; p < last; ++p) {
+        vec256::map2(
+            [](Vec x, Vec y) { return x + y; },
+            dst,
+            dst,
+            values_ptr + perm[p] * block_size,
+            block_size);
+      }
+    }
+  });
+}
+
+void sparse_coalesce_values_kernel(
+    Tensor& new_values,
+    const Tensor& values,
+    const Tensor& permutation,
+    const Tensor& segment_offsets) {
+  AT_DISPATCH_ALL_TYPES(values.scalar_type(), "sparse_coalesce_values_kernel", [&]() {
+    sparse_coalesce_values_kernel_impl<scalar_t>(
+        new_values, values, permutation, segment_offsets);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(sparse_coalesce_values_stub, &sparse_coalesce_values_kernel);
+
+} // namespace native
+} // namespace at
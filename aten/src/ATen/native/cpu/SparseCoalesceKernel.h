@@ -0,0 +1,18 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Sums the rows of the contiguous `values` of a sparse COO tensor into the
+// rows of `new_values` that coalesce them: row u of new_values is the sum of
+// the rows permutation[segment_offsets[u]:segment_offsets[u + 1]] of values.
+using sparse_coalesce_values_fn = void(*)(
+    Tensor& new_values,
+    const Tensor& values,
+    const Tensor& permutation,
+    const Tensor& segment_offsets);
+DECLARE_DISPATCH(sparse_coalesce_values_fn, sparse_coalesce_values_stub);
+
+}}  // namespace at::native
@@ -0,0 +1,231 @@
+#include <ATen/ATen.h>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/functional.h>
+#include <ATen/cpu/vec256/vec256.h>
+#include <ATen/native/cpu/SparseCsrMmKernel.h>
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+namespace at {
+namespace native {
+
+namespace {
+
+using namespace vec256;
+
+// Splits the rows of a CSR matrix into at most `max_chunks` ranges of about
+// the same work. The work of a row is counted as its number of nonzeros plus
+// one, so that chunks stay balanced for both power-law rows and many empty
+// rows, which a split into equal numbers of rows does not achieve.
+template <typename index_t>
+std::vector<int64_t> balanced_row_partition(
+    const index_t* crow,
+    int64_t rows,
+    int64_t max_chunks) {
+  // The work of the rows before `row`.
+  auto work_before = [crow](int64_t row) {
+    return static_cast<int64_t>(crow[row] - crow[0]) + row;
+  };
+  const int64_t work = work_before(rows);
+  const int64_t chunks = std::max<int64_t>(std::min(max_chunks, rows), 1);
+  std::vector<int64_t> bounds(chunks + 1, rows);
+  bounds[0] = 0;
+  for (int64_t c = 1; c < chunks; ++c) {
+    const int64_t target = work * c / chunks;
+    // The first row before which the work reaches the target...
+    int64_t lo = bounds[c - 1];
+    int64_t hi = rows;
+    while (lo < hi) {
+      const int64_t mid = lo + (hi - lo) / 2;
+      if (work_before(mid) < target) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    // ...or the row before it, if that is closer, e.g. when row lo - 1 is
+    // much heavier than the others.
+    if (lo > bounds[c - 1] &&
+        target - work_before(lo - 1) < work_before(lo) - target) {
+      --lo;
+    }
+    bounds[c] = lo;
+  }
+  return bounds;
+}
+
+// out_row[0:n] += alpha * sum(vals[p] * dense[cols[p], 0:n] for p in row),
+// where each row of dense is ld elements apart. The dense columns are
+// processed in blocks that stay in registers for the whole row, so that each
+// element of out_row is loaded and stored once.
+template <typename scalar_t>
+struct SpmmRow {
+  static constexpr int64_t kVecsPerBlock = 4;
+
+  template <typename index_t>
+  static void apply(
+      scalar_t* out_row,
+      const scalar_t* dense,
+      int64_t ld,
+      const index_t* cols,
+      const scalar_t* vals,
+      int64_t row_nnz,
+      scalar_t alpha,
+      int64_t n) {
+    using Vec = Vec256<scalar_t>;
+    constexpr int64_t kBlock = kVecsPerBlock * Vec::size();
+    int64_t j = 0;
+    for (; j + kBlock <= n; j += kBlock) {
+      Vec acc[kVecsPerBlock];
+      for (int64_t v = 0; v < kVecsPerBlock; ++v) {
+        acc[v] = Vec::loadu(out_row + j + v * Vec::size());
+      }
+      for (int64_t p = 0; p < row_nnz; ++p) {
+        const Vec a(alpha * vals[p]);
+        const scalar_t* d = dense + cols[p] * ld + j;
+        for (int64_t v = 0; v < kVecsPerBlock; ++v) {
+          acc[v] = vec256::fmadd(a, Vec::loadu(d + v * Vec::size()), acc[v]);
+        }
+      }
+      for (int64_t v = 0; v < kVecsPerBlock; ++v) {
+        acc[v].store(out_row + j + v * Vec::size());
+      }
+    }
+    for (; j + Vec::size() <= n; j += Vec::size()) {
+      Vec acc = Vec::loadu(out_row + j);
+      for (int64_t p = 0; p < row_nnz; ++p) {
+        acc = vec256::fmadd(Vec(alpha * vals[p]), Vec::loadu(dense + cols[p] * ld + j), acc);
+      }
+      acc.store(out_row + j);
+    }
+    // The remaining columns, which is all of them for a matrix-vector
+    // product: a dot product of the row with the column.
+    for (; j < n; ++j) {
+      scalar_t acc = 0;
+      for (int64_t p = 0; p < row_nnz; ++p) {
+        acc += vals[p] * dense[cols[p] * ld + j];
+      }
+      out_row[j] += alpha * acc;
+    }
+  }
+};
+
+// BFloat16 accumulates in float, converting the dense rows as they are read.
+template <>
+struct SpmmRow<BFloat16> {
+  template <typename index_t>
+  static void apply(
+      BFloat16* out_row,
+      const BFloat16* dense,
+      int64_t ld,
+      const index_t* cols,
+      const BFloat16* vals,
+      int64_t row_nnz,
+      float alpha,
+      int64_t n) {
+    using bVec = Vec256<BFloat16>;
+    using fVec = Vec256<float>;
+    int64_t j = 0;
+    for (; j + bVec::size() <= n; j += bVec::size()) {
+      fVec acc0, acc1;
+      std::tie(acc0, acc1) = convert_bfloat16_float(bVec::loadu(out_row + j));
+      for (int64_t p = 0; p < row_nnz; ++p) {
+        const fVec a(alpha * static_cast<float>(vals[p]));
+        fVec d0, d1;
+        std::tie(d0, d1) =
+            convert_bfloat16_float(bVec::loadu(dense + cols[p] * ld + j));
+        acc0 = vec256::fmadd(a, d0, acc0);
+        acc1 = vec256::fmadd(a, d1, acc1);
+      }
+      convert_float_bfloat16(acc0, acc1).store(out_row + j);
+    }
+    for (; j < n; ++j) {
+      float acc = 0;
+      for (int64_t p = 0; p < row_nnz; ++p) {
+        acc += static_cast<float>(vals[p]) *
+            static_cast<float>(dense[cols[p] * ld + j]);
+      }
+      out_row[j] = static_cast<float>(out_row[j]) + alpha * acc;
+    }
+  }
+};
+
+template <typename scalar_t, typename index_t>
+void sparse_csr_addmm_kernel_impl(
+    Tensor& out,
+    const Tensor& crow_indices,
+    const Tensor& col_indices,
+    const Tensor& values,
+    const Tensor& dense,
+    const Scalar& alpha) {
+  using alpha_t = typename std::conditional<
+      std::is_same<scalar_t, BFloat16>::value, float, scalar_t>::type;
+  const alpha_t cast_alpha = alpha.to<alpha_t>();
+  const int64_t rows = crow_indices.numel() - 1;
+  const int64_t n = dense.size(1);
+  if (rows <= 0 || n == 0) {
+    return;
+  }
+
+  const index_t* crow = crow_indices.data_ptr<index_t>();
+  const index_t* cols = col_indices.data_ptr<index_t>();
+  const scalar_t* vals = values.data_ptr<scalar_t>();
+  const scalar_t* dense_ptr = dense.data_ptr<scalar_t>();
+  scalar_t* out_ptr = out.data_ptr<scalar_t>();
+  const int64_t ld = dense.stride(0);
+
+  // Only go parallel when there is enough work for it: each nonzero costs a
+  // pass over the dense columns.
+  const int64_t work = (static_cast<int64_t>(crow[rows] - crow[0]) + rows) * n;
+  const int64_t max_chunks = work < internal::GRAIN_SIZE
+      ? 1
+      : std::min<int64_t>(at::get_num_threads() * 4, work / internal::GRAIN_SIZE);
+  const auto bounds = balanced_row_partition(crow, rows, max_chunks);
+  const int64_t chunks = bounds.size() - 1;
+
+  at::parallel_for(0, chunks, 1, [&](int64_t chunk_begin, int64_t chunk_end) {
+    for (int64_t chunk = chunk_begin; chunk < chunk_end; ++chunk) {
+      for (int64_t row = bounds[chunk]; row < bounds[chunk + 1]; ++row) {
+        const int64_t begin = crow[row];
+        const int64_t row_nnz = crow[row + 1] - crow[row];
+        SpmmRow<scalar_t>::apply(
+            out_ptr + row * n,
+            dense_ptr,
+            ld,
+            cols + begin,
+            vals + begin,
+            row_nnz,
+            cast_alpha,
+            n);
+      }
+    }
+  });
+}
+
+void sparse_csr_addmm_kernel(
+    Tensor& out,
+    const Tensor& crow_indices,
+    const Tensor& col_indices,
+    const Tensor& values,
+    const Tensor& dense,
+    const Scalar& alpha) {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      kBFloat16, values.scalar_type(), "sparse_csr_addmm_kernel", [&]() {
+        AT_DISPATCH_INDEX_TYPES(
+            crow_indices.scalar_type(), "sparse_csr_addmm_kernel_indices", [&]() {
+              sparse_csr_addmm_kernel_impl<scalar_t, index_t>(
+                  out, crow_indices, col_indices, values, dense, alpha);
+            });
+      });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(sparse_csr_addmm_stub, &sparse_csr_addmm_kernel);
+
+} // namespace native
+} // namespace at
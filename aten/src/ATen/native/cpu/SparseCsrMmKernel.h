@@ -0,0 +1,19 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// out += alpha * csr @ dense, where csr is the sparse CSR matrix given by
+// crow_indices, col_indices and values, and out and dense are contiguous.
+using sparse_csr_addmm_fn = void(*)(
+    Tensor& out,
+    const Tensor& crow_indices,
+    const Tensor& col_indices,
+    const Tensor& values,
+    const Tensor& dense,
+    const Scalar& alpha);
+DECLARE_DISPATCH(sparse_csr_addmm_fn, sparse_csr_addmm_stub);
+
+}}  // namespace at::native
@@ -2,6 +2,7 @@
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/ReduceOps.h>
 #include <ATen/native/cpu/Reduce.h>
+#include <ATen/NumericUtils.h>
 #include <c10/util/llvmMathExtras.h>
 
 #include <algorithm>
@@ -11,39 +12,113 @@ namespace at {
 namespace native {
 namespace {
 
-template <typename scalar_t>
+// LoadImpl<acc_t, scalar_t> reads a scalar_t (or a vector of them) from memory
+// and widens it to the accumulation type acc_t.
+template <typename acc_t, typename scalar_t>
 struct LoadImpl {
-  static scalar_t load(const char * C10_RESTRICT data, int64_t stride, int64_t index) {
+  static acc_t load(const char * C10_RESTRICT data, int64_t stride, int64_t index) {
     auto *ptr = reinterpret_cast<const scalar_t*>(data + index * stride);
-    return *ptr;
+    return static_cast<acc_t>(*ptr);
   }
 };
 
 template <typename scalar_t>
-struct LoadImpl<Vec256<scalar_t>> {
+struct LoadImpl<Vec256<scalar_t>, scalar_t> {
   static Vec256<scalar_t> load(const char * C10_RESTRICT data, int64_t stride, int64_t index) {
     auto *ptr = data + index * stride;
     return Vec256<scalar_t>::loadu(ptr);
   }
 };
 
-template <typename T>
-T load(const char * C10_RESTRICT data, int64_t stride, int64_t index) {
-  return LoadImpl<T>::load(data, stride, index);
+// BFloat16 is summed in float: each vector load reads Vec256<float>::size()
+// BFloat16 values and widens them, which keeps the cascade sum accurate and
+// avoids rounding back to BFloat16 after every addition.
+template <>
+struct LoadImpl<Vec256<float>, BFloat16> {
+  static Vec256<float> load(const char * C10_RESTRICT data, int64_t stride, int64_t index) {
+    auto *ptr = reinterpret_cast<const BFloat16*>(data + index * stride);
+    Vec256<float> ret;
+    vec256::load_fp32_from_bf16(ptr, ret);
+    return ret;
+  }
+};
+
+// Half is summed in float as well. There is no vector conversion for Half,
+// so each value is widened separately before the vector load.
+template <>
+struct LoadImpl<Vec256<float>, Half> {
+  static Vec256<float> load(const char * C10_RESTRICT data, int64_t stride, int64_t index) {
+    auto *ptr = reinterpret_cast<const Half*>(data + index * stride);
+    __at_align32__ float values[Vec256<float>::size()];
+    for (int64_t k = 0; k < Vec256<float>::size(); ++k) {
+      values[k] = static_cast<float>(ptr[k]);
+    }
+    return Vec256<float>::loadu(values);
+  }
+};
+
+template <typename acc_t>
+acc_t nan_to_zero(acc_t value) {
+  return _isnan(value) ? acc_t(0) : value;
+}
+
+template <typename acc_t>
+Vec256<acc_t> nan_to_zero(const Vec256<acc_t>& value) {
+  return Vec256<acc_t>::blendv(Vec256<acc_t>(0), value, value == value);
 }
 
+// nansum loads NaN as zero and then shares the sum implementation below
+template <typename acc_t, typename scalar_t, bool ignore_nan>
+struct LoadPolicy {
+  static acc_t load(const char * C10_RESTRICT data, int64_t stride, int64_t index) {
+    return LoadImpl<acc_t, scalar_t>::load(data, stride, index);
+  }
+};
+
+template <typename acc_t, typename scalar_t>
+struct LoadPolicy<acc_t, scalar_t, /*ignore_nan=*/true> {
+  static acc_t load(const char * C10_RESTRICT data, int64_t stride, int64_t index) {
+    return nan_to_zero(LoadImpl<acc_t, scalar_t>::load(data, stride, index));
+  }
+};
+
+template <typename acc_t, typename scalar_t, bool ignore_nan>
+acc_t load(const char * C10_RESTRICT data, int64_t stride, int64_t index) {
+  return LoadPolicy<acc_t, scalar_t, ignore_nan>::load(data, stride, index);
+}
+
+// Type used to accumulate sums of scalar_t
 template <typename scalar_t>
-void accumulate_result(char * C10_RESTRICT data, int64_t stride, int64_t index, scalar_t value) {
+struct SumAccType {
+  using type = scalar_t;
+};
+
+template <>
+struct SumAccType<BFloat16> {
+  using type = float;
+};
+
+template <>
+struct SumAccType<Half> {
+  using type = float;
+};
+
+template <typename scalar_t>
+using sum_acc_t = typename SumAccType<scalar_t>::type;
+
+// Adds `value` into the scalar_t output, rounding only once per output element
+template <typename scalar_t, typename acc_t>
+void accumulate_result(char * C10_RESTRICT data, int64_t stride, int64_t index, acc_t value) {
   auto * ptr = reinterpret_cast<scalar_t*>(data + index * stride);
-  *ptr += value;
+  *ptr = static_cast<scalar_t>(static_cast<acc_t>(*ptr) + value);
 }
 
-template <typename scalar_t, size_t numel>
+template <typename scalar_t, typename acc_t, size_t numel>
 void accumulate_result(char * C10_RESTRICT data, int64_t stride, int64_t index,
-    const std::array<scalar_t, numel> &values) {
+    const std::array<acc_t, numel> &values) {
   auto *base_ptr = data + stride * index;
   for (int64_t k = 0; k < numel; ++k) {
-    accumulate_result(base_ptr, stride, k, values[k]);
+    accumulate_result<scalar_t>(base_ptr, stride, k, values[k]);
   }
 }
 
@@ -91,8 +166,8 @@ A simplified recursive implementation would look like this:
     return sum;
   }
 */
-template <typename scalar_t, int64_t nrows>
-std::array<scalar_t, nrows> multi_row_sum(
+template <typename acc_t, int64_t nrows, typename scalar_t, bool ignore_nan>
+std::array<acc_t, nrows> multi_row_sum(
     const char * C10_RESTRICT in_data,
     const int64_t row_stride,
     const int64_t col_stride,
@@ -104,8 +179,8 @@ std::array<scalar_t, nrows> multi_row_sum(
   const int64_t level_step = (1 << level_power);
   const int64_t level_mask = level_step - 1;
 
-  scalar_t acc[num_levels][nrows];
-  std::fill_n(&acc[0][0], num_levels * nrows, scalar_t(0));
+  acc_t acc[num_levels][nrows];
+  std::fill_n(&acc[0][0], num_levels * nrows, acc_t(0));
 
   int64_t i = 0;
   for (; i + level_step <= size;) {
@@ -115,7 +190,7 @@ std::array<scalar_t, nrows> multi_row_sum(
       # pragma unroll
       #endif
       for (int64_t k = 0; k < nrows; ++k) {
-        acc[0][k] += load<scalar_t>(sum_base, col_stride, k);
+        acc[0][k] += load<acc_t, scalar_t, ignore_nan>(sum_base, col_stride, k);
       }
     }
 
@@ -125,7 +200,7 @@ std::array<scalar_t, nrows> multi_row_sum(
       #endif
       for (int64_t k = 0; k < nrows; ++k) {
         acc[j][k] += acc[j-1][k];
-        acc[j-1][k] = scalar_t(0);
+        acc[j-1][k] = acc_t(0);
       }
 
       const auto mask = (level_mask << (j * level_power));
@@ -141,7 +216,7 @@ std::array<scalar_t, nrows> multi_row_sum(
     # pragma unroll
     #endif
     for (int64_t k = 0; k < nrows; ++k) {
-      acc[0][k] += load<scalar_t>(sum_base, col_stride, k);
+      acc[0][k] += load<acc_t, scalar_t, ignore_nan>(sum_base, col_stride, k);
     }
   }
 
@@ -154,25 +229,25 @@ std::array<scalar_t, nrows> multi_row_sum(
     }
   }
 
-  std::array<scalar_t, nrows> ret;
+  std::array<acc_t, nrows> ret;
   for (int64_t k = 0; k < nrows; ++k) {
     ret[k] = acc[0][k];
   }
   return ret;
 }
 
-template <typename scalar_t>
-scalar_t row_sum(const char * C10_RESTRICT in_data,
-                 const int64_t in_stride, const int64_t size) {
+template <typename acc_t, typename scalar_t, bool ignore_nan>
+acc_t row_sum(const char * C10_RESTRICT in_data,
+              const int64_t in_stride, const int64_t size) {
   constexpr int64_t ilp_factor = 4;
 
   // Interpret row as a (-1, ilp_factor) shaped array to find partial sums
   const int64_t size_ilp = size / ilp_factor;
-  auto partial_sums = multi_row_sum<scalar_t, ilp_factor>(
+  auto partial_sums = multi_row_sum<acc_t, ilp_factor, scalar_t, ignore_nan>(
       in_data, in_stride * ilp_factor, in_stride, size_ilp);
 
   for (int64_t i = size_ilp * ilp_factor; i < size; ++i) {
-    partial_sums[0] += load<scalar_t>(in_data, in_stride, i);
+    partial_sums[0] += load<acc_t, scalar_t, ignore_nan>(in_data, in_stride, i);
   }
 
   for (int64_t k = 1; k < ilp_factor; ++k) {
@@ -182,49 +257,52 @@ scalar_t row_sum(const char * C10_RESTRICT in_data,
   return partial_sums[0];
 }
 
-template <typename scalar_t>
+template <typename scalar_t, bool ignore_nan>
 void vectorized_inner_sum(
     char * C10_RESTRICT data[2], int64_t outer_stride, int64_t out_stride,
     int64_t size0, int64_t size1) {
-  using vec_t = Vec256<scalar_t>;
+  using acc_t = sum_acc_t<scalar_t>;
+  using vec_t = Vec256<acc_t>;
   constexpr int64_t vec_stride = vec_t::size() * sizeof(scalar_t);
   const int64_t vec_size = size0 / vec_t::size();
 
   // Input is contiguous over the first (reduced) dimension
   for (int64_t j = 0; j < size1; ++j) {
     const auto *row_in = data[1] + j * outer_stride;
-    auto vec_acc = row_sum<vec_t>(row_in, vec_stride, vec_size);
+    auto vec_acc = row_sum<vec_t, scalar_t, ignore_nan>(row_in, vec_stride, vec_size);
 
-    scalar_t final_acc = 0;
+    acc_t final_acc = 0;
     for (int64_t k = vec_size * vec_t::size(); k < size0; ++k) {
-      final_acc += load<scalar_t>(row_in, sizeof(scalar_t), k);
+      final_acc += load<acc_t, scalar_t, ignore_nan>(row_in, sizeof(scalar_t), k);
     }
 
-    scalar_t partials[vec_t::size()];
+    acc_t partials[vec_t::size()];
     vec_acc.store(partials);
     for (int64_t k = 0; k < vec_t::size(); ++k) {
       final_acc += partials[k];
     }
-    accumulate_result(data[0], out_stride, j, final_acc);
+    accumulate_result<scalar_t>(data[0], out_stride, j, final_acc);
   }
 }
 
-template <typename scalar_t>
+template <typename scalar_t, bool ignore_nan>
 void scalar_inner_sum(
     char * C10_RESTRICT data[2], int64_t in_strides[2], int64_t out_stride,
     int64_t size0, int64_t size1) {
+  using acc_t = sum_acc_t<scalar_t>;
   for (int64_t j = 0; j < size1; ++j) {
     const auto *row_in = data[1] + j * in_strides[1];
-    scalar_t ans = row_sum<scalar_t>(row_in, in_strides[0], size0);
-    accumulate_result(data[0], out_stride, j, ans);
+    acc_t ans = row_sum<acc_t, scalar_t, ignore_nan>(row_in, in_strides[0], size0);
+    accumulate_result<scalar_t>(data[0], out_stride, j, ans);
   }
 }
 
-template <typename scalar_t>
+template <typename scalar_t, bool ignore_nan>
 void vectorized_outer_sum(
     char * C10_RESTRICT data[2], int64_t inner_stride, int64_t out_stride,
     int64_t size0, int64_t size1) {
-  using vec_t = Vec256<scalar_t>;
+  using acc_t = sum_acc_t<scalar_t>;
+  using vec_t = Vec256<acc_t>;
   constexpr int64_t nrows = 4;
   constexpr int64_t vec_stride = vec_t::size() * sizeof(scalar_t);
 
@@ -232,54 +310,107 @@ void vectorized_outer_sum(
   int64_t j = 0;
   for (; j + nrows * vec_t::size() <= size1; j += nrows * vec_t::size()) {
     const auto *row_in = data[1] + j * sizeof(scalar_t);
-    auto sums = multi_row_sum<vec_t, nrows>(row_in, inner_stride, vec_stride, size0);
+    auto sums = multi_row_sum<vec_t, nrows, scalar_t, ignore_nan>(row_in, inner_stride, vec_stride, size0);
 
     for (int64_t i = 0; i < nrows; ++i) {
       const int64_t base_idx = j + i * vec_t::size();
 
-      std::array<scalar_t, vec_t::size()> ans;
+      std::array<acc_t, vec_t::size()> ans;
       sums[i].store(ans.data());
-      accumulate_result(data[0], out_stride, base_idx, ans);
+      accumulate_result<scalar_t>(data[0], out_stride, base_idx, ans);
     }
   }
 
   for (; j + vec_t::size() <= size1; j += vec_t::size()) {
     const auto *row_in = data[1] + j * sizeof(scalar_t);
-    const vec_t sums = row_sum<vec_t>(row_in, inner_stride, size0);
+    const vec_t sums = row_sum<vec_t, scalar_t, ignore_nan>(row_in, inner_stride, size0);
 
-    std::array<scalar_t, vec_t::size()> ans;
+    std::array<acc_t, vec_t::size()> ans;
     sums.store(ans.data());
-    accumulate_result(data[0], out_stride, j, ans);
+    accumulate_result<scalar_t>(data[0], out_stride, j, ans);
   }
 
   for (; j < size1; ++j) {
     const auto *row_in = data[1] + j * sizeof(scalar_t);
-    scalar_t ans = row_sum<scalar_t>(row_in, inner_stride, size0);
-    accumulate_result(data[0], out_stride, j, ans);
+    acc_t ans = row_sum<acc_t, scalar_t, ignore_nan>(row_in, inner_stride, size0);
+    accumulate_result<scalar_t>(data[0], out_stride, j, ans);
   }
 }
 
-template <typename scalar_t>
+template <typename scalar_t, bool ignore_nan>
 void scalar_outer_sum(
     char * C10_RESTRICT data[2], int64_t in_strides[2], int64_t out_stride,
     int64_t size0, int64_t size1) {
 
+  using acc_t = sum_acc_t<scalar_t>;
   constexpr int64_t nrows = 4;
   int64_t j = 0;
   for (; j + (nrows - 1) < size1; j += nrows) {
     const auto *row_in = data[1] + j * in_strides[1];
-    auto sums = multi_row_sum<scalar_t, nrows>(
+    auto sums = multi_row_sum<acc_t, nrows, scalar_t, ignore_nan>(
         row_in, in_strides[0], in_strides[1], size0);
-    accumulate_result(data[0], out_stride, j, sums);
+    accumulate_result<scalar_t>(data[0], out_stride, j, sums);
   }
 
   for (; j < size1; ++j) {
     const auto *row_in = data[1] + j * in_strides[1];
-    scalar_t ans = row_sum<scalar_t>(row_in, in_strides[0], size0);
-    accumulate_result(data[0], out_stride, j, ans);
+    acc_t ans = row_sum<acc_t, scalar_t, ignore_nan>(row_in, in_strides[0], size0);
+    accumulate_result<scalar_t>(data[0], out_stride, j, ans);
   }
 }
 
+// Cascade sum of iter's input into its output, see multi_row_sum. With
+// ignore_nan NaN inputs count as zero, which implements nansum.
+template <bool ignore_nan, typename scalar_t>
+void cascade_sum(TensorIterator &iter) {
+  iter.output().fill_(scalar_t(0));
+  iter.parallel_reduce(
+    [&](char** data, const int64_t* strides, int64_t size0, int64_t size1) {
+      int64_t in_strides[] = { strides[1], strides[3] };
+      int64_t out_strides[] = { strides[0], strides[2] };
+
+      // Move reduction to be the 1st dim
+      if (out_strides[0] != 0 && out_strides[1] == 0) {
+        std::swap(in_strides[0], in_strides[1]);
+        std::swap(out_strides[0], out_strides[1]);
+        std::swap(size0, size1);
+      }
+
+      // Special case? - not a true reduction
+      if (out_strides[0] != 0 && out_strides[1] != 0) {
+        int64_t outer_strides[] = { strides[2], strides[3] };
+        UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
+          char* ptrs[3] = { data[0], data[0], data[1] };
+          int64_t inner_strides[3] = { strides[0], strides[0], strides[1] };
+          if (ignore_nan) {
+            basic_loop(ptrs, inner_strides, 0, size0, [](scalar_t a, scalar_t b) {
+              return _isnan(b) ? a : scalar_t(a + b);
+            });
+          } else {
+            basic_loop(ptrs, inner_strides, 0, size0, [](scalar_t a, scalar_t b) { return a + b; });
+          }
+        });
+        return;
+      }
+
+      const int64_t out_stride = out_strides[1];
+      TORCH_INTERNAL_ASSERT(out_strides[0] == 0);
+
+      using vec_t = Vec256<sum_acc_t<scalar_t>>;
+      if (in_strides[0] == sizeof(scalar_t) && size0 >= vec_t::size()) {
+        // Contiguous inner reduction
+        vectorized_inner_sum<scalar_t, ignore_nan>(data, in_strides[1], out_stride, size0, size1);
+      } else if (in_strides[1] == sizeof(scalar_t) && size1 >= vec_t::size()) {
+        // Contiguous outer reduction
+        vectorized_outer_sum<scalar_t, ignore_nan>(data, in_strides[0], out_stride, size0, size1);
+      } else if (in_strides[0] < in_strides[1]) {
+        scalar_inner_sum<scalar_t, ignore_nan>(data, in_strides, out_stride, size0, size1);
+      } else {
+        scalar_outer_sum<scalar_t, ignore_nan>(data, in_strides, out_stride, size0, size1);
+      }
+    });
+}
+
 void sum_kernel_impl(TensorIterator &iter) {
   if (isIntegralType(iter.dtype(), /*includeBool=*/ true)) {
     AT_DISPATCH_INTEGRAL_TYPES_AND(ScalarType::Bool, iter.dtype(), "sum_cpu",
@@ -295,50 +426,21 @@ void sum_kernel_impl(TensorIterator &iter) {
   AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES_AND2(
     ScalarType::BFloat16, ScalarType::Half, iter.dtype(), "sum_cpu",
     [&] {
-      iter.output().fill_(scalar_t(0));
-      iter.parallel_reduce(
-        [&](char** data, const int64_t* strides, int64_t size0, int64_t size1) {
-          int64_t in_strides[] = { strides[1], strides[3] };
-          int64_t out_strides[] = { strides[0], strides[2] };
-
-          // Move reduction to be the 1st dim
-          if (out_strides[0] != 0 && out_strides[1] == 0) {
-            std::swap(in_strides[0], in_strides[1]);
-            std::swap(out_strides[0], out_strides[1]);
-            std::swap(size0, size1);
-          }
-
-          // Special case? - not a true reduction
-          if (out_strides[0] != 0 && out_strides[1] != 0) {
-            int64_t outer_strides[] = { strides[2], strides[3] };
-            UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
-              char* ptrs[3] = { data[0], data[0], data[1] };
-              int64_t inner_strides[3] = { strides[0], strides[0], strides[1] };
-              basic_loop(ptrs, inner_strides, 0, size0, [](scalar_t a, scalar_t b) { return a + b; });
-            });
-            return;
-          }
+      cascade_sum</*ignore_nan=*/false, scalar_t>(iter);
+    });
+}
 
-          const int64_t out_stride = out_strides[1];
-          TORCH_INTERNAL_ASSERT(out_strides[0] == 0);
-
-          if (in_strides[0] == sizeof(scalar_t) && size0 >= Vec256<scalar_t>::size()) {
-            // Contiguous inner reduction
-            vectorized_inner_sum<scalar_t>(data, in_strides[1], out_stride, size0, size1);
-          } else if (in_strides[1] == sizeof(scalar_t) && size1 >= Vec256<scalar_t>::size()) {
-            // Contiguous outer reduction
-            vectorized_outer_sum<scalar_t>(data, in_strides[0], out_stride, size0, size1);
-          } else if (in_strides[0] < in_strides[1]) {
-            scalar_inner_sum<scalar_t>(data, in_strides, out_stride, size0, size1);
-          } else {
-            scalar_outer_sum<scalar_t>(data, in_strides, out_stride, size0, size1);
-          }
-        });
+void nansum_kernel_impl(TensorIterator &iter) {
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+    ScalarType::BFloat16, ScalarType::Half, iter.dtype(), "nansum_cpu",
+    [&] {
+      cascade_sum</*ignore_nan=*/true, scalar_t>(iter);
     });
 }
 
 }  // namespace (anonymous)
 
 REGISTER_DISPATCH(sum_stub, &sum_kernel_impl);
+REGISTER_DISPATCH(nansum_stub, &nansum_kernel_impl);
 
 }}  // namespace at::native
@@ -0,0 +1,95 @@
+#include <ATen/native/SummaryOps.h>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace at { namespace native {
+
+namespace {
+
+using namespace vec256;
+
+// Note [Privatized histograms]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// The input is split into at most one chunk per thread, and every chunk counts
+// into its own private histogram, so no synchronization is needed while
+// counting. The private histograms are then summed bin by bin, again in
+// parallel. The number of chunks is also bounded so that the private
+// histograms together have at most as many bins as the input has elements,
+// which keeps the reduction cheap for histograms with many bins.
+template <typename scalar_t>
+void histc_cpu_kernel_impl(Tensor& hist, const Tensor& self, int64_t nbins, scalar_t minval, scalar_t maxval) {
+  using Vec = Vec256<scalar_t>;
+  const auto self_contig = self.expect_contiguous();
+  const scalar_t* self_data = self_contig->data_ptr<scalar_t>();
+  const int64_t numel = self.numel();
+  const int64_t num_chunks = std::max<int64_t>(1, std::min({
+      static_cast<int64_t>(at::get_num_threads()),
+      at::divup(numel, internal::GRAIN_SIZE),
+      numel / nbins}));
+  const int64_t chunk_size = at::divup(numel, num_chunks);
+
+  // Bin of an element, or -1 if it falls outside of [minval, maxval]. Matches
+  // the bin computed by the scalar tail below exactly.
+  const scalar_t range = maxval - minval;
+  const Vec min_vec(minval);
+  const Vec max_vec(maxval);
+  const Vec range_vec(range);
+  const Vec nbins_vec(static_cast<scalar_t>(nbins));
+  const Vec out_of_range_vec(scalar_t(-1));
+
+  std::vector<int64_t> local_hists(num_chunks * nbins, 0);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    scalar_t pos[Vec::size()];
+    for (int64_t c = begin; c < end; c++) {
+      int64_t* local_hist = local_hists.data() + c * nbins;
+      const int64_t chunk_begin = c * chunk_size;
+      const int64_t chunk_end = std::min(numel, chunk_begin + chunk_size);
+      int64_t i = chunk_begin;
+      for (; i + Vec::size() <= chunk_end; i += Vec::size()) {
+        const Vec x = Vec::loadu(self_data + i);
+        const Vec in_range = (x >= min_vec) & (x <= max_vec);
+        Vec::blendv(out_of_range_vec, (x - min_vec) / range_vec * nbins_vec, in_range).store(pos);
+        for (int64_t j = 0; j < Vec::size(); j++) {
+          if (pos[j] >= 0) {
+            local_hist[std::min(static_cast<int64_t>(pos[j]), nbins - 1)]++;
+          }
+        }
+      }
+      for (; i < chunk_end; i++) {
+        const scalar_t x = self_data[i];
+        if (x >= minval && x <= maxval) {
+          const auto bin = static_cast<int64_t>((x - minval) / range * static_cast<scalar_t>(nbins));
+          local_hist[std::min(bin, nbins - 1)]++;
+        }
+      }
+    }
+  });
+
+  scalar_t* hist_data = hist.data_ptr<scalar_t>();
+  at::parallel_for(0, nbins, internal::GRAIN_SIZE / num_chunks + 1, [&](int64_t begin, int64_t end) {
+    for (int64_t bin = begin; bin < end; bin++) {
+      int64_t count = 0;
+      for (int64_t c = 0; c < num_chunks; c++) {
+        count += local_hists[c * nbins + bin];
+      }
+      hist_data[bin] = static_cast<scalar_t>(count);
+    }
+  });
+}
+
+void histc_cpu_kernel(Tensor& hist, const Tensor& self, int64_t nbins, const Scalar& min, const Scalar& max) {
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "histc_cpu", [&] {
+    histc_cpu_kernel_impl<scalar_t>(hist, self, nbins, min.to<scalar_t>(), max.to<scalar_t>());
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(histc_stub, &histc_cpu_kernel);
+
+}} // namespace at::native
@@ -0,0 +1,357 @@
+#include <ATen/native/Transformer.h>
+
+#include <ATen/ATen.h>
+#include <ATen/CPUGeneratorImpl.h>
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/functional.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace at { namespace native {
+
+namespace {
+
+using namespace vec256;
+
+void transform_bias_rescale_qkv_kernel(
+    const Tensor& qkv,
+    const Tensor& qkv_bias,
+    int64_t num_heads,
+    const Tensor& q,
+    const Tensor& k,
+    const Tensor& v) {
+  const int64_t B = qkv.size(0);
+  const int64_t S = qkv.size(1);
+  const int64_t E = qkv.size(2) / 3;
+  const int64_t D = E / num_heads;
+  AT_DISPATCH_FLOATING_TYPES(qkv.scalar_type(), "transform_bias_rescale_qkv", [&] {
+    using Vec = Vec256<scalar_t>;
+    const scalar_t* qkv_data = qkv.data_ptr<scalar_t>();
+    const scalar_t* bias_data = qkv_bias.data_ptr<scalar_t>();
+    scalar_t* out_data[3] = {
+        q.data_ptr<scalar_t>(), k.data_ptr<scalar_t>(), v.data_ptr<scalar_t>()};
+    const Vec scale(static_cast<scalar_t>(1.0 / std::sqrt(static_cast<double>(D))));
+    // Over the (b, s) tokens, each copying its 3 * num_heads head vectors
+    at::parallel_for(0, B * S, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t t = begin; t < end; t++) {
+        const int64_t b = t / S;
+        const int64_t s = t % S;
+        for (int64_t part = 0; part < 3; part++) {
+          for (int64_t h = 0; h < num_heads; h++) {
+            const int64_t c = part * E + h * D;
+            scalar_t* out = out_data[part] + ((b * num_heads + h) * S + s) * D;
+            if (part == 0) {
+              vec256::map2<scalar_t>(
+                  [scale](Vec x, Vec bias) { return (x + bias) * scale; },
+                  out, qkv_data + t * 3 * E + c, bias_data + c, D);
+            } else {
+              vec256::map2<scalar_t>(
+                  [](Vec x, Vec bias) { return x + bias; },
+                  out, qkv_data + t * 3 * E + c, bias_data + c, D);
+            }
+          }
+        }
+      }
+    });
+  });
+}
+
+void masked_softmax_kernel(
+    const Tensor& self,
+    const Tensor& mask,
+    const Tensor& result) {
+  const int64_t B = self.size(0);
+  const int64_t S = self.size(3);
+  const int64_t rows_per_batch = self.size(1) * self.size(2);
+  const bool* mask_data = mask.defined() ? mask.data_ptr<bool>() : nullptr;
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "masked_softmax", [&] {
+    using Vec = Vec256<scalar_t>;
+    const scalar_t* self_data = self.data_ptr<scalar_t>();
+    scalar_t* result_data = result.data_ptr<scalar_t>();
+    constexpr scalar_t kNegInf = -std::numeric_limits<scalar_t>::infinity();
+    at::parallel_for(0, B * rows_per_batch, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t row = begin; row < end; row++) {
+        const scalar_t* in = self_data + row * S;
+        scalar_t* out = result_data + row * S;
+        // The masked keys become -inf, whose exp is 0
+        if (mask_data) {
+          const bool* row_mask = mask_data + (row / rows_per_batch) * S;
+          for (int64_t j = 0; j < S; j++) {
+            out[j] = row_mask[j] ? kNegInf : in[j];
+          }
+          in = out;
+        }
+        const scalar_t max = vec256::reduce_all<scalar_t>(
+            [](Vec& x, Vec& y) { return vec256::maximum(x, y); }, in, S);
+        if (max == kNegInf) {
+          std::fill(out, out + S, scalar_t(0));
+          continue;
+        }
+        vec256::map<scalar_t>(
+            [max](Vec x) { return (x - Vec(max)).exp(); }, out, in, S);
+        const scalar_t sum = vec256::reduce_all<scalar_t>(
+            [](Vec& x, Vec& y) { return x + y; }, out, S);
+        const Vec inv_sum(scalar_t(1) / sum);
+        vec256::map<scalar_t>(
+            [inv_sum](Vec x) { return x * inv_sum; }, out, out, S);
+      }
+    });
+  });
+}
+
+void bias_residual_layer_norm_kernel(
+    const Tensor& self,
+    const Tensor& bias,
+    const Tensor& residual,
+    const Tensor& weight,
+    const Tensor& ln_bias,
+    double eps,
+    const Tensor& result) {
+  const int64_t M = self.size(0);
+  const int64_t N = self.size(1);
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "bias_residual_layer_norm", [&] {
+    using Vec = Vec256<scalar_t>;
+    const scalar_t* self_data = self.data_ptr<scalar_t>();
+    const scalar_t* bias_data = bias.data_ptr<scalar_t>();
+    const scalar_t* residual_data = residual.data_ptr<scalar_t>();
+    const scalar_t* weight_data = weight.data_ptr<scalar_t>();
+    const scalar_t* ln_bias_data = ln_bias.data_ptr<scalar_t>();
+    scalar_t* result_data = result.data_ptr<scalar_t>();
+    const scalar_t c = scalar_t(1) / static_cast<scalar_t>(N);
+    at::parallel_for(0, M, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        scalar_t* out = result_data + i * N;
+        // The sum is normalized in place in the result row
+        vec256::map3<scalar_t>(
+            [](Vec x, Vec bias, Vec residual) { return x + bias + residual; },
+            out, self_data + i * N, bias_data, residual_data + i * N, N);
+        const scalar_t mean = c * vec256::reduce_all<scalar_t>(
+            [](Vec& x, Vec& y) { return x + y; }, out, N);
+        const scalar_t var = std::max(
+            c * vec256::map_reduce_all<scalar_t>(
+                    [](Vec x) { return x * x; },
+                    [](Vec x, Vec y) { return x + y; }, out, N) -
+                mean * mean,
+            scalar_t(0));
+        const scalar_t rstd = scalar_t(1) / std::sqrt(var + static_cast<scalar_t>(eps));
+        const Vec scale(rstd);
+        const Vec shift(-rstd * mean);
+        vec256::map3<scalar_t>(
+            [scale, shift](Vec x, Vec gamma, Vec beta) {
+              return (x * scale + shift) * gamma + beta;
+            },
+            out, out, weight_data, ln_bias_data, N);
+      }
+    });
+  });
+}
+
+void fused_dropout_add_layer_norm_kernel(
+    const Tensor& self,
+    const Tensor& residual,
+    const Tensor& weight,
+    const Tensor& bias,
+    double p,
+    double eps,
+    c10::optional<Generator> gen,
+    const Tensor& result,
+    const Tensor& mean,
+    const Tensor& rstd,
+    const Tensor& rng_state) {
+  const int64_t M = self.size(0);
+  const int64_t N = self.size(1);
+  uint64_t seed = 0;
+  uint64_t word = 0;
+  if (p > 0) {
+    auto generator = get_generator_or_default<CPUGeneratorImpl>(gen, detail::getDefaultCPUGenerator());
+    // See Note [Acquire lock when using random generators]
+    std::lock_guard<std::mutex> lock(generator->mutex_);
+    std::tie(seed, word) = generator->philox_engine_inputs((M * N + 3) / 4);
+    // The offset counts 128 bit outputs
+    word *= 4;
+    int64_t* rng_state_data = rng_state.data_ptr<int64_t>();
+    rng_state_data[0] = static_cast<int64_t>(seed);
+    rng_state_data[1] = static_cast<int64_t>(word);
+  }
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "fused_dropout_add_layer_norm", [&] {
+    using Vec = Vec256<scalar_t>;
+    const scalar_t* self_data = self.data_ptr<scalar_t>();
+    const scalar_t* residual_data = residual.data_ptr<scalar_t>();
+    const scalar_t* weight_data = weight.data_ptr<scalar_t>();
+    const scalar_t* bias_data = bias.data_ptr<scalar_t>();
+    scalar_t* result_data = result.data_ptr<scalar_t>();
+    scalar_t* mean_data = mean.data_ptr<scalar_t>();
+    scalar_t* rstd_data = rstd.data_ptr<scalar_t>();
+    const scalar_t scale = p < 1 ? static_cast<scalar_t>(1 / (1 - p)) : scalar_t(0);
+    const scalar_t c = scalar_t(1) / static_cast<scalar_t>(N);
+    at::parallel_for(0, M, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        const scalar_t* x = self_data + i * N;
+        const scalar_t* r = residual_data + i * N;
+        scalar_t* out = result_data + i * N;
+        // The sum is normalized in place in the result row
+        if (p > 0) {
+          FusedDropoutMask mask(seed, word, i * N, static_cast<float>(1 - p));
+          for (int64_t j = 0; j < N; j++) {
+            out[j] = (mask.next() ? x[j] * scale : scalar_t(0)) + r[j];
+          }
+        } else {
+          vec256::map2<scalar_t>(
+              [](Vec x, Vec r) { return x + r; }, out, x, r, N);
+        }
+        const scalar_t mean_val = c * vec256::reduce_all<scalar_t>(
+            [](Vec& x, Vec& y) { return x + y; }, out, N);
+        const scalar_t var = std::max(
+            c * vec256::map_reduce_all<scalar_t>(
+                    [](Vec x) { return x * x; },
+                    [](Vec x, Vec y) { return x + y; }, out, N) -
+                mean_val * mean_val,
+            scalar_t(0));
+        const scalar_t rstd_val = scalar_t(1) / std::sqrt(var + static_cast<scalar_t>(eps));
+        mean_data[i] = mean_val;
+        rstd_data[i] = rstd_val;
+        const Vec rstd_v(rstd_val);
+        const Vec shift(-rstd_val * mean_val);
+        vec256::map3<scalar_t>(
+            [rstd_v, shift](Vec x, Vec gamma, Vec beta) {
+              return (x * rstd_v + shift) * gamma + beta;
+            },
+            out, out, weight_data, bias_data, N);
+      }
+    });
+  });
+}
+
+// With x = dropout(self) + residual and x_hat = (x - mean) * rstd, each row
+// computes dx = rstd * (dy * gamma - mean(dy * gamma) - x_hat * mean(dy * gamma * x_hat)),
+// which is grad_residual, and grad_self = dropout's mask * scale * dx. Like
+// the layer_norm backward, dgamma and dbeta are reduced into per thread
+// buffers first.
+void fused_dropout_add_layer_norm_backward_kernel(
+    const Tensor& grad_out,
+    const Tensor& self,
+    const Tensor& residual,
+    const Tensor& weight,
+    const Tensor& mean,
+    const Tensor& rstd,
+    const Tensor& rng_state,
+    double p,
+    const Tensor& grad_self,
+    const Tensor& grad_residual,
+    const Tensor& grad_weight,
+    const Tensor& grad_bias) {
+  const int64_t M = self.size(0);
+  const int64_t N = self.size(1);
+  uint64_t seed = 0;
+  uint64_t word = 0;
+  if (p > 0) {
+    const int64_t* rng_state_data = rng_state.data_ptr<int64_t>();
+    seed = static_cast<uint64_t>(rng_state_data[0]);
+    word = static_cast<uint64_t>(rng_state_data[1]);
+  }
+  const int num_threads = at::get_num_threads();
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "fused_dropout_add_layer_norm_backward", [&] {
+    using Vec = Vec256<scalar_t>;
+    const scalar_t* dy_data = grad_out.data_ptr<scalar_t>();
+    const scalar_t* self_data = self.data_ptr<scalar_t>();
+    const scalar_t* residual_data = residual.data_ptr<scalar_t>();
+    const scalar_t* weight_data = weight.data_ptr<scalar_t>();
+    const scalar_t* mean_data = mean.data_ptr<scalar_t>();
+    const scalar_t* rstd_data = rstd.data_ptr<scalar_t>();
+    scalar_t* grad_self_data = grad_self.data_ptr<scalar_t>();
+    scalar_t* grad_residual_data = grad_residual.data_ptr<scalar_t>();
+    const bool need_params = grad_weight.defined() || grad_bias.defined();
+    // dgamma and dbeta buffers of each thread
+    Tensor buffer;
+    scalar_t* buffer_data = nullptr;
+    if (need_params) {
+      buffer = at::zeros({2, num_threads, N}, self.options());
+      buffer_data = buffer.data_ptr<scalar_t>();
+    }
+    const scalar_t scale = p < 1 ? static_cast<scalar_t>(1 / (1 - p)) : scalar_t(0);
+    const scalar_t c = scalar_t(1) / static_cast<scalar_t>(N);
+    at::parallel_for(0, M, 1, [&](int64_t begin, int64_t end) {
+      const int tid = at::get_thread_num();
+      std::vector<uint8_t> keep(p > 0 ? N : 0);
+      for (int64_t i = begin; i < end; i++) {
+        const scalar_t* dy = dy_data + i * N;
+        const scalar_t* x = self_data + i * N;
+        const scalar_t* r = residual_data + i * N;
+        scalar_t* x_hat = grad_self_data + i * N;
+        scalar_t* dx = grad_residual_data + i * N;
+        const Vec rstd_v(rstd_data[i]);
+        const Vec shift(-rstd_data[i] * mean_data[i]);
+        // x_hat is kept in the grad_self row until grad_self is written
+        if (p > 0) {
+          FusedDropoutMask mask(seed, word, i * N, static_cast<float>(1 - p));
+          for (int64_t j = 0; j < N; j++) {
+            keep[j] = mask.next();
+            x_hat[j] = (keep[j] ? x[j] * scale : scalar_t(0)) + r[j];
+          }
+          vec256::map<scalar_t>(
+              [rstd_v, shift](Vec x) { return x * rstd_v + shift; }, x_hat, x_hat, N);
+        } else {
+          vec256::map2<scalar_t>(
+              [rstd_v, shift](Vec x, Vec r) { return (x + r) * rstd_v + shift; },
+              x_hat, x, r, N);
+        }
+        if (need_params) {
+          scalar_t* dgamma = buffer_data + tid * N;
+          scalar_t* dbeta = buffer_data + (num_threads + tid) * N;
+          vec256::map3<scalar_t>(
+              [](Vec dgamma, Vec dy, Vec x_hat) { return dgamma + dy * x_hat; },
+              dgamma, dgamma, dy, x_hat, N);
+          vec256::map2<scalar_t>(
+              [](Vec dbeta, Vec dy) { return dbeta + dy; }, dbeta, dbeta, dy, N);
+        }
+        // dx holds dy * gamma for the two means
+        vec256::map2<scalar_t>(
+            [](Vec dy, Vec gamma) { return dy * gamma; }, dx, dy, weight_data, N);
+        const scalar_t a = c * vec256::reduce_all<scalar_t>(
+            [](Vec& x, Vec& y) { return x + y; }, dx, N);
+        const scalar_t b = c * vec256::map2_reduce_all<scalar_t>(
+            [](Vec dy_gamma, Vec x_hat) { return dy_gamma * x_hat; },
+            [](Vec x, Vec y) { return x + y; }, dx, x_hat, N);
+        const Vec a_v(a);
+        const Vec b_v(b);
+        vec256::map2<scalar_t>(
+            [rstd_v, a_v, b_v](Vec dy_gamma, Vec x_hat) {
+              return rstd_v * (dy_gamma - a_v - x_hat * b_v);
+            },
+            dx, dx, x_hat, N);
+        if (p > 0) {
+          for (int64_t j = 0; j < N; j++) {
+            grad_self_data[i * N + j] = keep[j] ? dx[j] * scale : scalar_t(0);
+          }
+        } else {
+          std::copy(dx, dx + N, grad_self_data + i * N);
+        }
+      }
+    });
+    if (need_params) {
+      // Sums the thread buffers, the rows of buffer[0] and buffer[1]
+      const auto sums = buffer.sum(1);
+      if (grad_weight.defined()) {
+        grad_weight.copy_(sums[0]);
+      }
+      if (grad_bias.defined()) {
+        grad_bias.copy_(sums[1]);
+      }
+    }
+  });
+}
+
+} // namespace
+
+REGISTER_DISPATCH(transform_bias_rescale_qkv_stub, &transform_bias_rescale_qkv_kernel);
+REGISTER_DISPATCH(masked_softmax_stub, &masked_softmax_kernel);
+REGISTER_DISPATCH(bias_residual_layer_norm_stub, &bias_residual_layer_norm_kernel);
+REGISTER_DISPATCH(fused_dropout_add_layer_norm_stub, &fused_dropout_add_layer_norm_kernel);
+REGISTER_DISPATCH(fused_dropout_add_layer_norm_backward_stub, &fused_dropout_add_layer_norm_backward_kernel);
+
+}} // namespace at::native
@@ -364,7 +364,8 @@ static void digamma_kernel(TensorIterator& iter) {
   AT_DISPATCH_FLOATING_TYPES(iter.common_dtype(), "digamma", [&]() {
     cpu_kernel(
         iter,
-        [=](scalar_t a) -> scalar_t { return calc_digamma(a); });
+        [=](scalar_t a) -> scalar_t { return calc_digamma(a); },
+        at::internal::grain_size_for_cost(64));
   });
 }
 
@@ -372,7 +373,8 @@ static void trigamma_kernel(TensorIterator& iter) {
   AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "trigamma", [&]() {
     cpu_kernel(
         iter,
-        [=](scalar_t a) -> scalar_t { return trigamma(a); });
+        [=](scalar_t a) -> scalar_t { return trigamma(a); },
+        at::internal::grain_size_for_cost(48));
   });
 }
 
@@ -394,7 +396,8 @@ static void polygamma_kernel(TensorIterator& iter, int64_t n) {
   } else {
     AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "polygamma", [&]() {
       cpu_kernel(
-          iter, [=](scalar_t a) -> scalar_t { return calc_polygamma(n, a); });
+          iter, [=](scalar_t a) -> scalar_t { return calc_polygamma(n, a); },
+          at::internal::grain_size_for_cost(256));
     });
   }
 }
@@ -479,6 +482,10 @@ void bernoulli_tensor_kernel(Tensor& self, const Tensor& p_, c10::optional<Gener
 
 void bernoulli_scalar_kernel_default(Tensor& self, double p, c10::optional<Generator> gen) {
   CPUGeneratorImpl* generator = get_generator_or_default<CPUGeneratorImpl>(gen, detail::getDefaultCPUGenerator());
+  if (generator->philox_mode()) {
+    templates::cpu::bernoulli_philox_kernel(self, p, generator);
+    return;
+  }
   templates::cpu::bernoulli_kernel(self, p, generator);
 }
 
@@ -488,8 +495,11 @@ void bernoulli_scalar_kernel(Tensor& self, double p, c10::optional<Generator> ge
 }
 #else
 void bernoulli_scalar_kernel(Tensor &self, double p, c10::optional<Generator> gen) {
-  if (cpuinfo_initialize() && cpuinfo_vendor_intel == cpuinfo_get_processor(0)->core->vendor) {
-    CPUGeneratorImpl* generator = get_generator_or_default<CPUGeneratorImpl>(gen, detail::getDefaultCPUGenerator());
+  CPUGeneratorImpl* generator = get_generator_or_default<CPUGeneratorImpl>(gen, detail::getDefaultCPUGenerator());
+  if (generator->philox_mode()) {
+    // See Note [CPU Philox mode]
+    bernoulli_scalar_kernel_default(self, p, gen);
+  } else if (cpuinfo_initialize() && cpuinfo_vendor_intel == cpuinfo_get_processor(0)->core->vendor) {
     int64_t seed;
     {
       // See Note [Acquire lock when using random generators]
@@ -561,11 +571,19 @@ static void log_normal_kernel(TensorIterator& iter, double mean, double std, c10
 
 void uniform_kernel(TensorIterator& iter, double from, double to, c10::optional<Generator> gen) {
   CPUGeneratorImpl* generator = get_generator_or_default<CPUGeneratorImpl>(gen, detail::getDefaultCPUGenerator());
+  if (generator->philox_mode()) {
+    templates::cpu::uniform_philox_kernel(iter, from, to, generator);
+    return;
+  }
   templates::cpu::uniform_kernel(iter, from, to, generator);
 }
 
 void normal_kernel(Tensor& self, double mean, double std, c10::optional<Generator> gen) {
   CPUGeneratorImpl* generator = get_generator_or_default<CPUGeneratorImpl>(gen, detail::getDefaultCPUGenerator());
+  if (generator->philox_mode()) {
+    templates::cpu::normal_philox_kernel(self, mean, std, generator);
+    return;
+  }
   templates::cpu::normal_kernel(self, mean, std, generator);
 }
 
@@ -508,6 +508,121 @@ void cpu_upsample_linear_channels_last(
   }
 }
 
+// Source indices (clamped to the input, in units of `stride`) and cubic
+// weights of the 4 taps for every output position along one dimension
+template <typename scalar_t>
+static inline void compute_cubic_indices_weights(
+    std::vector<int64_t>& indices,
+    std::vector<scalar_t>& weights,
+    int64_t input_size,
+    int64_t output_size,
+    int64_t stride,
+    bool align_corners,
+    const c10::optional<double>& opt_scale) {
+  indices.resize(output_size * 4);
+  weights.resize(output_size * 4);
+  const scalar_t scale = area_pixel_compute_scale<scalar_t>(
+      input_size, output_size, align_corners, opt_scale);
+  for (int64_t i = 0; i < output_size; i++) {
+    const scalar_t real_input_index = area_pixel_compute_source_index<scalar_t>(
+        scale, i, align_corners, /*cubic=*/true);
+    int64_t input_index = static_cast<int64_t>(floorf(real_input_index));
+    get_cubic_upsample_coefficients<scalar_t>(&weights[i * 4], real_input_index - input_index);
+    for (int64_t j = 0; j < 4; j++) {
+      indices[i * 4 + j] = std::max(std::min(input_index + j - 1, input_size - 1),
+                                    static_cast<int64_t>(0)) * stride;
+    }
+  }
+}
+
+template <typename scalar_t, typename scale_type>
+void cpu_upsample_bicubic_channels_last(
+    const Tensor& output_,
+    const Tensor& input_,
+    bool align_corners,
+    const scale_type& scales) {
+  TORCH_CHECK(input_.dtype() == output_.dtype(), "expected dtype ", input_.dtype(),
+              " for `output` but got dtype ", output_.dtype());
+  TORCH_CHECK(input_.dim() == 4, "Upsample bicubic with NHWC format supports tensors with 4 dims.")
+
+  auto input = input_.contiguous(at::MemoryFormat::ChannelsLast);
+  auto output = output_.contiguous(at::MemoryFormat::ChannelsLast);
+
+  auto input_data = input.data_ptr<scalar_t>();
+  auto output_data = output.data_ptr<scalar_t>();
+
+  int64_t num_batches = input.size(0);
+  int64_t channels = input.size(1);
+  int64_t input_height = input.size(2);
+  int64_t input_width = input.size(3);
+  int64_t output_height = output.size(2);
+  int64_t output_width = output.size(3);
+
+  TORCH_CHECK(channels > 0, "expected input and output channels greater than 0 but got ", channels);
+
+  // the taps along W and H only depend on the output position, so compute
+  // them once instead of for every pixel
+  std::vector<int64_t> w_indices, h_indices;
+  std::vector<scalar_t> w_weights, h_weights;
+  compute_cubic_indices_weights<scalar_t>(
+      w_indices, w_weights, input_width, output_width, channels, align_corners, scales[1]);
+  compute_cubic_indices_weights<scalar_t>(
+      h_indices, h_weights, input_height, output_height, input_width * channels, align_corners, scales[0]);
+
+  using Vec = vec256::Vec256<scalar_t>;
+  auto loop = [&](int64_t begin, int64_t end) {
+    int64_t n = 0;
+    int64_t oh = 0;
+    data_index_init(begin, n, num_batches, oh, output_height);
+
+    for (int64_t i = begin; i < end; i++) {
+      const scalar_t* input_n = input_data + n * input_height * input_width * channels;
+      const int64_t* ih = &h_indices[oh * 4];
+      const scalar_t* wh = &h_weights[oh * 4];
+      scalar_t* out = output_data + i * output_width * channels;
+
+      for (int64_t ow = 0; ow < output_width; ow++, out += channels) {
+        const int64_t* iw = &w_indices[ow * 4];
+        const scalar_t* ww = &w_weights[ow * 4];
+
+        const scalar_t* in[16];
+        scalar_t weight[16];
+        for (int64_t y = 0; y < 4; y++) {
+          for (int64_t x = 0; x < 4; x++) {
+            in[y * 4 + x] = input_n + ih[y] + iw[x];
+            weight[y * 4 + x] = wh[y] * ww[x];
+          }
+        }
+
+        int64_t size = channels;
+        int64_t d = 0;
+        for (; d < size - (size % Vec::size()); d += Vec::size()) {
+          Vec out_vec = Vec(weight[0]) * Vec::loadu(in[0] + d);
+          for (int64_t k = 1; k < 16; k++) {
+            out_vec = out_vec + Vec(weight[k]) * Vec::loadu(in[k] + d);
+          }
+          out_vec.store(out + d);
+        }
+        for (; d < size; d++) {
+          scalar_t val = weight[0] * in[0][d];
+          for (int64_t k = 1; k < 16; k++) {
+            val += weight[k] * in[k][d];
+          }
+          out[d] = val;
+        }
+      }
+      data_index_step(n, num_batches, oh, output_height);
+    }
+  };
+
+  at::parallel_for(0, num_batches * output_height,
+                   at::internal::GRAIN_SIZE / (output_width * channels * 16) + 1, loop);
+
+  if (!output_.is_contiguous(at::MemoryFormat::ChannelsLast)) {
+    output_.copy_(output);
+  }
+}
+
 // Helper structs to use with upsample_generic_Nd_kernel_impl
 struct HelperInterpBase {
 
@@ -869,8 +984,14 @@ void upsample_bicubic2d_kernel_impl(
     bool align_corners,
     c10::optional<double> scales_h,
     c10::optional<double> scales_w) {
-  upsample_generic_Nd_kernel_impl<2, scale_t, HelperInterpCubic>(
-    output, input, align_corners, {scales_h, scales_w});
+  if (input.is_contiguous(at::MemoryFormat::ChannelsLast)) {
+    AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "upsample_bicubic2d_channels_last", [&] {
+      cpu_upsample_bicubic_channels_last<scalar_t, scale_t>(output, input, align_corners, {scales_h, scales_w});
+    });
+  } else {
+    upsample_generic_Nd_kernel_impl<2, scale_t, HelperInterpCubic>(
+      output, input, align_corners, {scales_h, scales_w});
+  }
 }
 
 template <typename scalar_t, typename scale_type>
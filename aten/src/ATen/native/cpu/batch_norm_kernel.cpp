@@ -3,6 +3,7 @@
 #include <ATen/ATen.h>
 #include <ATen/CPUApplyUtils.h>
 #include <ATen/Dispatch.h>
+#include <ATen/cpu/vec256/functional_bfloat16.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/cpu/Loops.h>
 
@@ -100,9 +101,54 @@ void batch_norm_cpu_inference_contiguous_impl(Tensor& output,
   }
 }
 
+/// BFloat16 input with float math: alpha and beta are collected in float and
+/// each block of input is widened once, transformed with fmadd and rounded
+/// back to BFloat16 on store.
+template<>
+void batch_norm_cpu_inference_contiguous_impl<BFloat16>(Tensor& output,
+    const Tensor& input, const Tensor& weight, const Tensor& bias,
+    const Tensor& mean, const Tensor& variance, double eps) {
+
+  using Vec = Vec256<float>;
+  int64_t n_batch = input.size(0);
+  int64_t n_channel = input.size(1);
+  int64_t image_size = input.numel() / n_batch / n_channel;
+
+  // The per-channel parameters are tiny, so widen them up front.
+  auto to_float = [](const Tensor& t) {
+    return t.defined() ? t.to(ScalarType::Float) : t;
+  };
+  const Tensor mean_f = to_float(mean);
+  Tensor alpha = at::empty_like(mean_f, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  Tensor beta = at::empty_like(mean_f, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  auto alpha_data = alpha.accessor<float, 1>();
+  auto beta_data = beta.accessor<float, 1>();
+
+  batch_norm_cpu_inference_collect_linear_and_constant_terms<float>(
+     alpha_data, beta_data, n_channel, to_float(weight), to_float(bias),
+     mean_f, to_float(variance), eps);
+
+  BFloat16* output_data = output.data_ptr<BFloat16>();
+  const BFloat16* input_data = input.data_ptr<BFloat16>();
+
+  const int64_t n_offset = n_channel * image_size;
+  for (int64_t n = 0; n < n_batch; n++) {
+    for (int64_t c = 0; c < n_channel; c++) {
+      const Vec alpha_vec(alpha_data[c]);
+      const Vec beta_vec(beta_data[c]);
+      int64_t offset = n * n_offset + c * image_size;
+      vec256::map(
+          [alpha_vec, beta_vec](Vec x) { return vec256::fmadd(x, alpha_vec, beta_vec); },
+          output_data + offset,
+          input_data + offset,
+          image_size);
+    }
+  }
+}
+
 void batch_norm_cpu_inference_contiguous_kernel(Tensor& output, const Tensor& input,
     const Tensor& weight, const Tensor& bias, const Tensor& mean, const Tensor& variance, double eps) {
-  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "batch_norm_cpu_inference_contiguous", [&] {
+  AT_DISPATCH_FLOATING_TYPES_AND(ScalarType::BFloat16, input.scalar_type(), "batch_norm_cpu_inference_contiguous", [&] {
     batch_norm_cpu_inference_contiguous_impl<scalar_t>(output, input, weight, bias, mean, variance, eps);
   });
 }
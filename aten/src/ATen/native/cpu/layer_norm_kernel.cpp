@@ -6,6 +6,7 @@
 #include <ATen/CPUApplyUtils.h>
 #include <ATen/Dispatch.h>
 #include <ATen/cpu/vec256/functional.h>
+#include <ATen/cpu/vec256/functional_bfloat16.h>
 #include <ATen/cpu/vec256/vec256.h>
 #include <ATen/Parallel.h>
 
@@ -79,6 +80,75 @@ void LayerNormKernelImplInternal(
   });
 }
 
+// BFloat16 rows are widened to float once per vector load and both moments and
+// the affine transform are computed in float, see
+// Note [BFloat16 functional overloads].
+template <>
+void LayerNormKernelImplInternal<BFloat16>(
+    const Tensor& X,
+    const Tensor& gamma,
+    const Tensor& beta,
+    int64_t M,
+    int64_t N,
+    BFloat16 eps,
+    Tensor* Y,
+    Tensor* mean,
+    Tensor* rstd) {
+  using Vec = vec256::Vec256<float>;
+  DCHECK_EQ(X.numel(), M * N);
+  DCHECK(!gamma.defined() || gamma.numel() == N);
+  DCHECK(!beta.defined() || beta.numel() == N);
+  BFloat16* X_data = X.data_ptr<BFloat16>();
+  const BFloat16* gamma_data = gamma.defined() ? gamma.data_ptr<BFloat16>() : nullptr;
+  const BFloat16* beta_data = beta.defined() ? beta.data_ptr<BFloat16>() : nullptr;
+  BFloat16* Y_data = Y->data_ptr<BFloat16>();
+  BFloat16* mean_data = mean->data_ptr<BFloat16>();
+  BFloat16* rstd_data = rstd->data_ptr<BFloat16>();
+  const float c = 1.0f / static_cast<float>(N);
+  const float eps_val = static_cast<float>(eps);
+  const bool gamma_null = gamma_data == nullptr;
+  const bool beta_null = beta_data == nullptr;
+  at::parallel_for(0, M, 1, [&](int64_t start, int64_t end) {
+    for (int64_t i = start; i < end; ++i) {
+      BFloat16* X_ptr = X_data + i * N;
+      BFloat16* Y_ptr = Y_data + i * N;
+      float mean_val = vec256::reduce_all(
+          [](Vec& x, Vec& y) { return x + y; },
+          X_ptr,
+          N);
+      float rstd_val = vec256::map_reduce_all(
+          [](Vec x) { return x * x; },
+          [](Vec x, Vec y) { return x + y; },
+          X_ptr,
+          N);
+      mean_val *= c;
+      rstd_val = std::max(rstd_val * c - mean_val * mean_val, 0.0f);
+      rstd_val = 1.0f / std::sqrt(rstd_val + eps_val);
+      const float scale = rstd_val;
+      const float bias = -rstd_val * mean_val;
+      if (gamma_null || beta_null) {
+        for (int64_t j = 0; j < N; ++j) {
+          const float gamma_v = gamma_null ? 1.0f : static_cast<float>(gamma_data[j]);
+          const float beta_v = beta_null ? 0.0f : static_cast<float>(beta_data[j]);
+          Y_ptr[j] = (static_cast<float>(X_ptr[j]) * scale + bias) * gamma_v + beta_v;
+        }
+      } else {
+        vec256::map3(
+            [scale, bias](Vec x, Vec gamma, Vec beta) {
+              return (x * Vec(scale) + Vec(bias)) * gamma + beta;
+            },
+            Y_ptr,
+            X_ptr,
+            gamma_data,
+            beta_data,
+            N);
+      }
+      mean_data[i] = mean_val;
+      rstd_data[i] = rstd_val;
+    }
+  });
+}
+
 void LayerNormKernelImpl(
     const Tensor& X,
     const Tensor& gamma,
@@ -89,7 +159,8 @@ void LayerNormKernelImpl(
     Tensor* Y,
     Tensor* mean,
     Tensor* rstd) {
-  AT_DISPATCH_FLOATING_TYPES(X.scalar_type(), "LayerNormKernelImpl", [&]() {
+  AT_DISPATCH_FLOATING_TYPES_AND(at::ScalarType::BFloat16, X.scalar_type(),
+      "LayerNormKernelImpl", [&]() {
     LayerNormKernelImplInternal<scalar_t>(
         X, gamma, beta, M, N, static_cast<scalar_t>(eps), Y, mean, rstd);
   });
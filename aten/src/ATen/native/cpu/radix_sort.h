@@ -0,0 +1,102 @@
+#pragma once
+
+#include <ATen/Parallel.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace at { namespace native {
+
+// Sorts the `n` pairs (keys[i], values[i]) by key with a parallel least
+// significant digit radix sort over 8 bit digits. The sort is stable, so that
+// pairs with equal keys keep their order, and takes only as many passes as
+// there are digits in `max_key`, the largest key; keys must be non-negative.
+//
+// Each pass scatters the pairs between (keys, values) and (tmp_keys,
+// tmp_values), so both buffers are overwritten; the returned pointers are the
+// ones that hold the sorted pairs.
+template <typename K, typename V>
+std::pair<K*, V*> radix_sort_parallel(
+    K* keys,
+    V* values,
+    K* tmp_keys,
+    V* tmp_values,
+    int64_t n,
+    int64_t max_key) {
+  constexpr int kDigitBits = 8;
+  constexpr int64_t kNumBuckets = 1 << kDigitBits;
+  // Below this, a chunk is not worth the cost of its histogram.
+  constexpr int64_t kMinChunkSize = 1 << 14;
+
+  int num_passes = 0;
+  for (uint64_t key = max_key; key > 0; key >>= kDigitBits) {
+    ++num_passes;
+  }
+  if (n <= 1 || num_passes == 0) {
+    return {keys, values};
+  }
+
+  // Every pass splits the pairs into the same chunks, so that the histogram
+  // of a chunk gives where the scatter of that chunk writes.
+  const int64_t num_chunks = std::max<int64_t>(
+      1, std::min<int64_t>(at::get_num_threads(), n / kMinChunkSize));
+  auto chunk_begin = [n, num_chunks](int64_t chunk) {
+    return n * chunk / num_chunks;
+  };
+  std::vector<int64_t> offsets(num_chunks * kNumBuckets);
+
+  for (int pass = 0; pass < num_passes; ++pass) {
+    const int shift = pass * kDigitBits;
+    auto digit = [shift](K key) {
+      return static_cast<int64_t>(
+          (static_cast<uint64_t>(key) >> shift) & (kNumBuckets - 1));
+    };
+
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t chunk = begin; chunk < end; ++chunk) {
+        int64_t* histogram = offsets.data() + chunk * kNumBuckets;
+        std::fill(histogram, histogram + kNumBuckets, 0);
+        for (int64_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+          ++histogram[digit(keys[i])];
+        }
+      }
+    });
+
+    // Exclusive scan over (bucket, chunk), so that each chunk writes its
+    // pairs of a bucket after those of the chunks before it.
+    int64_t offset = 0;
+    bool single_bucket = false;
+    for (int64_t bucket = 0; bucket < kNumBuckets; ++bucket) {
+      const int64_t bucket_begin = offset;
+      for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+        const int64_t count = offsets[chunk * kNumBuckets + bucket];
+        offsets[chunk * kNumBuckets + bucket] = offset;
+        offset += count;
+      }
+      single_bucket |= offset - bucket_begin == n;
+    }
+    // All the keys have the same digit, e.g. the high digits of keys that
+    // are all small, so the pass would not change the order.
+    if (single_bucket) {
+      continue;
+    }
+
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t chunk = begin; chunk < end; ++chunk) {
+        int64_t* next = offsets.data() + chunk * kNumBuckets;
+        for (int64_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+          const int64_t pos = next[digit(keys[i])]++;
+          tmp_keys[pos] = keys[i];
+          tmp_values[pos] = values[i];
+        }
+      }
+    });
+    std::swap(keys, tmp_keys);
+    std::swap(values, tmp_values);
+  }
+  return {keys, values};
+}
+
+}}  // namespace at::native
@@ -11,6 +11,7 @@
 #include <ATen/native/Resize.h>
 #include <ATen/native/BatchLinearAlgebra.h>
 #include <ATen/native/cuda/BatchLinearAlgebraLib.h>
+#include <ATen/native/cuda/BatchLinearAlgebraSmall.h>
 #include <ATen/native/cpu/zmath.h>
 
 #include <THC/THC.h> // for USE_MAGMA
@@ -1276,9 +1277,13 @@ std::tuple<Tensor, Tensor> _solve_helper_cuda(const Tensor& self, const Tensor&
   auto A_working_copy = cloneBatchedColumnMajor(A);
   // infos might not get filled for empty inputs therefore at::zeros is used instead of at::empty
   auto infos = at::zeros({std::max<int64_t>(1, batchCount(self))}, self.options().dtype(kInt));
-  AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES(self.scalar_type(), "solve_cuda", [&]{
-    apply_solve<scalar_t>(self_working_copy, A_working_copy, infos);
-  });
+  if (use_small_matrix_kernels(A)) {
+    solve_small_batched(self_working_copy, A_working_copy, infos);
+  } else {
+    AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES(self.scalar_type(), "solve_cuda", [&]{
+      apply_solve<scalar_t>(self_working_copy, A_working_copy, infos);
+    });
+  }
   if (self.dim() > 2) {
     batchCheckErrors(infos, "solve_cuda");
   } else {
@@ -1293,6 +1298,10 @@ Tensor& _linalg_solve_out_helper_cuda(Tensor& result, Tensor& input, Tensor& inf
   // the content of 'result', 'input' and 'infos' is overwritten by 'apply_solve'
   // 'result' should contain data of 'other' tensor (right-hand-side of the linear system of equations)
   // 'input' should contain data of origianl 'input' tensor (left-hand-side of the linear system)
+  if (use_small_matrix_kernels(input)) {
+    solve_small_batched(result, input, infos);
+    return result;
+  }
   AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES(result.scalar_type(), "linalg_solve_out_cpu", [&]{
     apply_solve<scalar_t>(result, input, infos);
   });
@@ -1430,6 +1439,13 @@ Tensor _inverse_helper_cuda_legacy(const Tensor& self) {
 }
 
 Tensor _inverse_helper_cuda(const Tensor& self) {
+  if (use_small_matrix_kernels(self)) {
+    auto self_inv_working_copy = cloneBatchedColumnMajor(self);
+    auto infos = at::zeros({batchCount(self)}, self.options().dtype(kInt));
+    inverse_small_batched(self_inv_working_copy, infos);
+    batchCheckErrors(infos, "inverse_cuda");
+    return self_inv_working_copy;
+  }
 #ifdef USE_CUSOLVER
   if ((self.dim() == 2) || (/* self.dim() > 2 && */ batchCount(self) <= 2) || !use_magma_) {
     return _inverse_helper_cuda_lib(self);    // cusolver or cublas
@@ -1462,6 +1478,12 @@ Tensor& _linalg_inv_out_helper_cuda_legacy(Tensor& result, Tensor& infos_lu, Ten
 Tensor& _linalg_inv_out_helper_cuda(Tensor &result, Tensor& infos_lu, Tensor& infos_getri) {
   // This function calculates the inverse matrix in-place
   // result should be in column major order and contain matrices to invert
+  if (use_small_matrix_kernels(result)) {
+    inverse_small_batched(result, infos_lu);
+    // the small-matrix kernels report singular matrices through infos_lu only
+    infos_getri.copy_(infos_lu);
+    return result;
+  }
 #ifdef USE_CUSOLVER
   if ((result.dim() == 2) || (/* result.dim() > 2 && */ batchCount(result) <= 2) || !use_magma_) {
     return _linalg_inv_out_helper_cuda_lib(result, infos_lu, infos_getri);  // cusolver or cublas
@@ -1667,11 +1689,23 @@ Tensor _cholesky_helper_cuda_magma(const Tensor& self, bool upper) {
   return upper ? result.transpose_(-1, -2) : result;
 }
 
+Tensor _cholesky_helper_cuda_small(const Tensor& self, bool upper) {
+  // the kernels factorize the lower triangle, see cholesky_small_batched
+  Tensor result = cloneBatchedColumnMajor(upper ? self.transpose(-1, -2) : self);
+  auto infos = at::zeros({batchCount(self)}, self.options().dtype(kInt));
+  cholesky_small_batched(result, infos);
+  batchCheckErrors(infos, "cholesky_cuda");
+  return upper ? result.transpose_(-1, -2) : result;
+}
+
 // Todo: cusolverDnXpotrfBatched has some numerical issue and is not used
 //     here. Batched cholesky is dispatched to magma.
 //     We will switch to cusolverDnXpotrfBatched after the issue is fixed.
 //     See https://github.com/pytorch/pytorch/issues/53879.
 Tensor _cholesky_helper_cuda(const Tensor& self, bool upper) {
+  if (use_small_matrix_kernels(self)) {
+    return _cholesky_helper_cuda_small(self, upper);
+  }
 #ifdef USE_CUSOLVER
   if (batchCount(self) == 1 || !use_magma_) {
     return _cholesky_helper_cuda_cusolver(self, upper);
@@ -1826,9 +1860,13 @@ std::tuple<Tensor, Tensor, Tensor> _lu_with_info_cuda(const Tensor& self, bool p
     self_working_copy = at::empty_like(self, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
   } else {
     self_working_copy = cloneBatchedColumnMajor(self);
-    AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES(self.scalar_type(), "lu_cuda", [&]{
-        apply_lu<scalar_t>(self_working_copy, pivots_tensor, infos_tensor, pivot);
-    });
+    if (use_small_matrix_kernels(self)) {
+      lu_small_batched(self_working_copy, pivots_tensor, infos_tensor, pivot);
+    } else {
+      AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES(self.scalar_type(), "lu_cuda", [&]{
+          apply_lu<scalar_t>(self_working_copy, pivots_tensor, infos_tensor, pivot);
+      });
+    }
   }
   if (check_errors) {
     if (self.dim() == 2) {
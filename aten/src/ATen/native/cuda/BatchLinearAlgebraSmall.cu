@@ -0,0 +1,499 @@
+#include <ATen/native/cuda/BatchLinearAlgebraSmall.h>
+
+#include <ATen/Dispatch.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/DeviceUtils.cuh>
+#include <ATen/native/LinearAlgebraUtils.h>
+#include <ATen/native/cuda/BatchLinearAlgebraSmall.cuh>
+#include <c10/cuda/CUDAException.h>
+
+#include <type_traits>
+
+namespace at {
+namespace native {
+
+namespace {
+
+// See Note [Small-matrix batched linear algebra]
+constexpr int64_t kRegisterMaxSize = 8;
+constexpr int kThreadsPerBlock = 128;
+constexpr int kWarpsPerBlock = 4;
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~ one thread per matrix ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+template <typename scalar_t, int N>
+__device__ __forceinline__ void load_matrix(scalar_t (&m)[N * N], const scalar_t* a) {
+#pragma unroll
+  for (int i = 0; i < N * N; i++) {
+    m[i] = a[i];
+  }
+}
+
+template <typename scalar_t, int N>
+__device__ __forceinline__ void store_matrix(const scalar_t (&m)[N * N], scalar_t* a) {
+#pragma unroll
+  for (int i = 0; i < N * N; i++) {
+    a[i] = m[i];
+  }
+}
+
+template <typename scalar_t, int N>
+__global__ void lu_register_kernel(
+    scalar_t* a, int64_t a_stride, int* pivots, int* infos, int64_t batch, bool get_pivots) {
+  const int64_t b = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (b >= batch) {
+    return;
+  }
+  scalar_t m[N * N];
+  int piv[N];
+  load_matrix<scalar_t, N>(m, a + b * a_stride);
+  infos[b] = small_linalg::getrf<scalar_t, N>(m, piv, get_pivots);
+  store_matrix<scalar_t, N>(m, a + b * a_stride);
+  if (get_pivots) {
+#pragma unroll
+    for (int k = 0; k < N; k++) {
+      pivots[b * N + k] = piv[k];
+    }
+  }
+}
+
+template <typename scalar_t, int N>
+__global__ void solve_register_kernel(
+    scalar_t* a, int64_t a_stride, scalar_t* rhs, int64_t rhs_stride, int64_t nrhs,
+    int* infos, int64_t batch) {
+  const int64_t b = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (b >= batch) {
+    return;
+  }
+  scalar_t m[N * N];
+  int piv[N];
+  load_matrix<scalar_t, N>(m, a + b * a_stride);
+  infos[b] = small_linalg::getrf<scalar_t, N>(m, piv, /*pivot=*/true);
+  store_matrix<scalar_t, N>(m, a + b * a_stride);
+  for (int64_t c = 0; c < nrhs; c++) {
+    scalar_t* column = rhs + b * rhs_stride + c * N;
+    scalar_t x[N];
+#pragma unroll
+    for (int i = 0; i < N; i++) {
+      x[i] = column[i];
+    }
+    small_linalg::getrs<scalar_t, N>(m, piv, x);
+#pragma unroll
+    for (int i = 0; i < N; i++) {
+      column[i] = x[i];
+    }
+  }
+}
+
+template <typename scalar_t, int N>
+__global__ void inverse_register_kernel(scalar_t* a, int64_t a_stride, int* infos, int64_t batch) {
+  const int64_t b = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (b >= batch) {
+    return;
+  }
+  scalar_t m[N * N];
+  int piv[N];
+  load_matrix<scalar_t, N>(m, a + b * a_stride);
+  infos[b] = small_linalg::getrf<scalar_t, N>(m, piv, /*pivot=*/true);
+#pragma unroll
+  for (int c = 0; c < N; c++) {
+    scalar_t x[N];
+#pragma unroll
+    for (int i = 0; i < N; i++) {
+      x[i] = i == c ? scalar_t(1) : scalar_t(0);
+    }
+    small_linalg::getrs<scalar_t, N>(m, piv, x);
+#pragma unroll
+    for (int i = 0; i < N; i++) {
+      a[b * a_stride + c * N + i] = x[i];
+    }
+  }
+}
+
+template <typename scalar_t, int N>
+__global__ void cholesky_register_kernel(scalar_t* a, int64_t a_stride, int* infos, int64_t batch) {
+  const int64_t b = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (b >= batch) {
+    return;
+  }
+  scalar_t m[N * N];
+  load_matrix<scalar_t, N>(m, a + b * a_stride);
+  infos[b] = small_linalg::potrf<scalar_t, N>(m);
+  store_matrix<scalar_t, N>(m, a + b * a_stride);
+}
+
+// Calls f with std::integral_constant<int, n> for 1 <= n <= kRegisterMaxSize
+template <typename F>
+void dispatch_register_size(int64_t n, const F& f) {
+  switch (n) {
+    case 1: f(std::integral_constant<int, 1>()); break;
+    case 2: f(std::integral_constant<int, 2>()); break;
+    case 3: f(std::integral_constant<int, 3>()); break;
+    case 4: f(std::integral_constant<int, 4>()); break;
+    case 5: f(std::integral_constant<int, 5>()); break;
+    case 6: f(std::integral_constant<int, 6>()); break;
+    case 7: f(std::integral_constant<int, 7>()); break;
+    case 8: f(std::integral_constant<int, 8>()); break;
+    default: TORCH_INTERNAL_ASSERT(false, "unexpected matrix size ", n);
+  }
+}
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~ one warp per matrix ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+__device__ __forceinline__ void sync_warp() {
+#ifndef __HIP_PLATFORM_HCC__
+  __syncwarp();
+#endif
+}
+
+// Shared memory of a block: kWarpsPerBlock n x n matrices followed by
+// kWarpsPerBlock pivot arrays
+template <typename scalar_t>
+int64_t warp_kernel_shared_memory(int64_t n) {
+  return kWarpsPerBlock * (n * n * sizeof(scalar_t) + C10_WARP_SIZE * sizeof(int));
+}
+
+template <typename scalar_t>
+struct WarpMatrix {
+  scalar_t* s;
+  int* piv;
+  int lane;
+  int64_t b;
+};
+
+template <typename scalar_t>
+__device__ __forceinline__ WarpMatrix<scalar_t> warp_matrix(unsigned char* smem, int n) {
+  const int warp = threadIdx.x / C10_WARP_SIZE;
+  auto* matrices = reinterpret_cast<scalar_t*>(smem);
+  auto* pivots = reinterpret_cast<int*>(matrices + kWarpsPerBlock * n * n);
+  return {matrices + warp * n * n,
+          pivots + warp * C10_WARP_SIZE,
+          static_cast<int>(threadIdx.x % C10_WARP_SIZE),
+          blockIdx.x * static_cast<int64_t>(kWarpsPerBlock) + warp};
+}
+
+template <typename scalar_t>
+__device__ __forceinline__ void warp_load(scalar_t* s, const scalar_t* a, int n, int lane) {
+  for (int i = lane; i < n * n; i += C10_WARP_SIZE) {
+    s[i] = a[i];
+  }
+  sync_warp();
+}
+
+template <typename scalar_t>
+__device__ __forceinline__ void warp_store(const scalar_t* s, scalar_t* a, int n, int lane) {
+  for (int i = lane; i < n * n; i += C10_WARP_SIZE) {
+    a[i] = s[i];
+  }
+}
+
+// Same contract as small_linalg::getrf; lane i owns row i.
+template <typename scalar_t>
+__device__ int warp_getrf(scalar_t* s, int* piv, int n, int lane, bool pivot) {
+  int info = 0;
+  for (int k = 0; k < n; k++) {
+    int p = k;
+    if (pivot) {
+      // argmax of |s(i, k)| over i >= k, the first one on ties like LAPACK
+      scalar_t value = (lane >= k && lane < n) ? std::abs(s[lane + k * n]) : scalar_t(-1);
+      int index = lane;
+      for (int offset = C10_WARP_SIZE / 2; offset > 0; offset /= 2) {
+        const scalar_t other_value = WARP_SHFL_DOWN(value, offset);
+        const int other_index = WARP_SHFL_DOWN(index, offset);
+        if (other_value > value || (other_value == value && other_index < index)) {
+          value = other_value;
+          index = other_index;
+        }
+      }
+      p = WARP_SHFL(index, 0);
+    }
+    const scalar_t pivot_value = s[p + k * n];
+    if (lane == 0) {
+      piv[k] = p + 1;
+    }
+    sync_warp();
+    if (pivot_value != scalar_t(0)) {
+      if (p != k && lane < n) {
+        small_linalg::swap_values(s[k + lane * n], s[p + lane * n]);
+      }
+      sync_warp();
+      if (lane > k && lane < n) {
+        s[lane + k * n] *= scalar_t(1) / pivot_value;
+      }
+    } else if (info == 0) {
+      info = k + 1;
+    }
+    sync_warp();
+    if (lane > k && lane < n) {
+      const scalar_t l = s[lane + k * n];
+      for (int j = k + 1; j < n; j++) {
+        s[lane + j * n] -= l * s[k + j * n];
+      }
+    }
+    sync_warp();
+  }
+  return info;
+}
+
+// Solves A x = column in place from the output of warp_getrf, for a single
+// lane.
+template <typename scalar_t>
+__device__ void lane_getrs(const scalar_t* s, const int* piv, int n, scalar_t* column) {
+  for (int k = 0; k < n; k++) {
+    const int p = piv[k] - 1;
+    if (p != k) {
+      small_linalg::swap_values(column[k], column[p]);
+    }
+  }
+  for (int k = 0; k < n; k++) {
+    const scalar_t x = column[k];
+    for (int i = k + 1; i < n; i++) {
+      column[i] -= s[i + k * n] * x;
+    }
+  }
+  for (int k = n - 1; k >= 0; k--) {
+    const scalar_t x = column[k] / s[k + k * n];
+    column[k] = x;
+    for (int i = 0; i < k; i++) {
+      column[i] -= s[i + k * n] * x;
+    }
+  }
+}
+
+// Same contract as small_linalg::potrf; lane i owns row i.
+template <typename scalar_t>
+__device__ int warp_potrf(scalar_t* s, int n, int lane) {
+  for (int j = 0; j < n; j++) {
+    const scalar_t diag = s[j + j * n];
+    if (!(diag > scalar_t(0))) {
+      return j + 1;
+    }
+    const scalar_t root = std::sqrt(diag);
+    sync_warp();
+    if (lane == j) {
+      s[j + j * n] = root;
+    } else if (lane > j && lane < n) {
+      s[lane + j * n] /= root;
+    }
+    sync_warp();
+    if (lane > j && lane < n) {
+      const scalar_t l = s[lane + j * n];
+      for (int c = j + 1; c <= lane; c++) {
+        s[lane + c * n] -= l * s[c + j * n];
+      }
+    }
+    sync_warp();
+  }
+  return 0;
+}
+
+template <typename scalar_t>
+__global__ void lu_warp_kernel(
+    scalar_t* a, int64_t a_stride, int* pivots, int* infos, int64_t batch, int n, bool get_pivots) {
+  extern __shared__ unsigned char smem[];
+  const auto w = warp_matrix<scalar_t>(smem, n);
+  if (w.b >= batch) {
+    return;
+  }
+  warp_load(w.s, a + w.b * a_stride, n, w.lane);
+  const int info = warp_getrf(w.s, w.piv, n, w.lane, get_pivots);
+  warp_store(w.s, a + w.b * a_stride, n, w.lane);
+  if (get_pivots && w.lane < n) {
+    pivots[w.b * n + w.lane] = w.piv[w.lane];
+  }
+  if (w.lane == 0) {
+    infos[w.b] = info;
+  }
+}
+
+template <typename scalar_t>
+__global__ void solve_warp_kernel(
+    scalar_t* a, int64_t a_stride, scalar_t* rhs, int64_t rhs_stride, int64_t nrhs,
+    int* infos, int64_t batch, int n) {
+  extern __shared__ unsigned char smem[];
+  const auto w = warp_matrix<scalar_t>(smem, n);
+  if (w.b >= batch) {
+    return;
+  }
+  warp_load(w.s, a + w.b * a_stride, n, w.lane);
+  const int info = warp_getrf(w.s, w.piv, n, w.lane, /*pivot=*/true);
+  warp_store(w.s, a + w.b * a_stride, n, w.lane);
+  if (w.lane == 0) {
+    infos[w.b] = info;
+  }
+  for (int64_t c = w.lane; c < nrhs; c += C10_WARP_SIZE) {
+    lane_getrs(w.s, w.piv, n, rhs + w.b * rhs_stride + c * n);
+  }
+}
+
+template <typename scalar_t>
+__global__ void inverse_warp_kernel(scalar_t* a, int64_t a_stride, int* infos, int64_t batch, int n) {
+  extern __shared__ unsigned char smem[];
+  const auto w = warp_matrix<scalar_t>(smem, n);
+  if (w.b >= batch) {
+    return;
+  }
+  warp_load(w.s, a + w.b * a_stride, n, w.lane);
+  const int info = warp_getrf(w.s, w.piv, n, w.lane, /*pivot=*/true);
+  if (w.lane == 0) {
+    infos[w.b] = info;
+  }
+  // the factorization lives in shared memory, so the inverse can overwrite
+  // the input column by column
+  if (w.lane < n) {
+    scalar_t* column = a + w.b * a_stride + w.lane * n;
+    for (int i = 0; i < n; i++) {
+      column[i] = i == w.lane ? scalar_t(1) : scalar_t(0);
+    }
+    lane_getrs(w.s, w.piv, n, column);
+  }
+}
+
+template <typename scalar_t>
+__global__ void cholesky_warp_kernel(scalar_t* a, int64_t a_stride, int* infos, int64_t batch, int n) {
+  extern __shared__ unsigned char smem[];
+  const auto w = warp_matrix<scalar_t>(smem, n);
+  if (w.b >= batch) {
+    return;
+  }
+  warp_load(w.s, a + w.b * a_stride, n, w.lane);
+  const int info = warp_potrf(w.s, n, w.lane);
+  sync_warp();
+  warp_store(w.s, a + w.b * a_stride, n, w.lane);
+  if (w.lane == 0) {
+    infos[w.b] = info;
+  }
+}
+
+int64_t register_kernel_blocks(int64_t batch) {
+  return (batch + kThreadsPerBlock - 1) / kThreadsPerBlock;
+}
+
+int64_t warp_kernel_blocks(int64_t batch) {
+  return (batch + kWarpsPerBlock - 1) / kWarpsPerBlock;
+}
+
+constexpr int kWarpKernelThreads = kWarpsPerBlock * C10_WARP_SIZE;
+
+} // anonymous namespace
+
+bool use_small_matrix_kernels(const Tensor& input) {
+  if (input.dim() <= 2 ||
+      (input.scalar_type() != kFloat && input.scalar_type() != kDouble)) {
+    return false;
+  }
+  const int64_t n = input.size(-1);
+  if (input.size(-2) != n || n == 0 || n > kSmallMatrixMaxSize) {
+    return false;
+  }
+  const int64_t batch = batchCount(input);
+  if (n <= kRegisterMaxSize) {
+    return batch >= 2;
+  }
+  if (n <= 16) {
+    return batch >= 32;
+  }
+  return batch >= 256;
+}
+
+void lu_small_batched(Tensor& self, Tensor& pivots, Tensor& infos, bool get_pivots) {
+  const int64_t n = self.size(-1);
+  const int64_t batch = batchCount(self);
+  const int64_t stride = matrixStride(self);
+  auto stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "lu_small_cuda", [&] {
+    auto* a = self.data_ptr<scalar_t>();
+    int* pivots_data = get_pivots ? pivots.data_ptr<int>() : nullptr;
+    int* infos_data = infos.data_ptr<int>();
+    if (n <= kRegisterMaxSize) {
+      dispatch_register_size(n, [&](auto size) {
+        constexpr int N = decltype(size)::value;
+        lu_register_kernel<scalar_t, N><<<register_kernel_blocks(batch), kThreadsPerBlock, 0, stream>>>(
+            a, stride, pivots_data, infos_data, batch, get_pivots);
+        C10_CUDA_KERNEL_LAUNCH_CHECK();
+      });
+    } else {
+      lu_warp_kernel<scalar_t><<<warp_kernel_blocks(batch), kWarpKernelThreads,
+                                 warp_kernel_shared_memory<scalar_t>(n), stream>>>(
+          a, stride, pivots_data, infos_data, batch, n, get_pivots);
+      C10_CUDA_KERNEL_LAUNCH_CHECK();
+    }
+  });
+}
+
+void solve_small_batched(Tensor& B, Tensor& A, Tensor& infos) {
+  const int64_t n = A.size(-1);
+  const int64_t batch = batchCount(A);
+  const int64_t a_stride = matrixStride(A);
+  const int64_t b_stride = matrixStride(B);
+  const int64_t nrhs = B.size(-1);
+  auto stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_FLOATING_TYPES(A.scalar_type(), "solve_small_cuda", [&] {
+    auto* a = A.data_ptr<scalar_t>();
+    auto* b = B.data_ptr<scalar_t>();
+    int* infos_data = infos.data_ptr<int>();
+    if (n <= kRegisterMaxSize) {
+      dispatch_register_size(n, [&](auto size) {
+        constexpr int N = decltype(size)::value;
+        solve_register_kernel<scalar_t, N><<<register_kernel_blocks(batch), kThreadsPerBlock, 0, stream>>>(
+            a, a_stride, b, b_stride, nrhs, infos_data, batch);
+        C10_CUDA_KERNEL_LAUNCH_CHECK();
+      });
+    } else {
+      solve_warp_kernel<scalar_t><<<warp_kernel_blocks(batch), kWarpKernelThreads,
+                                    warp_kernel_shared_memory<scalar_t>(n), stream>>>(
+          a, a_stride, b, b_stride, nrhs, infos_data, batch, n);
+      C10_CUDA_KERNEL_LAUNCH_CHECK();
+    }
+  });
+}
+
+void inverse_small_batched(Tensor& self, Tensor& infos) {
+  const int64_t n = self.size(-1);
+  const int64_t batch = batchCount(self);
+  const int64_t stride = matrixStride(self);
+  auto stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "inverse_small_cuda", [&] {
+    auto* a = self.data_ptr<scalar_t>();
+    int* infos_data = infos.data_ptr<int>();
+    if (n <= kRegisterMaxSize) {
+      dispatch_register_size(n, [&](auto size) {
+        constexpr int N = decltype(size)::value;
+        inverse_register_kernel<scalar_t, N><<<register_kernel_blocks(batch), kThreadsPerBlock, 0, stream>>>(
+            a, stride, infos_data, batch);
+        C10_CUDA_KERNEL_LAUNCH_CHECK();
+      });
+    } else {
+      inverse_warp_kernel<scalar_t><<<warp_kernel_blocks(batch), kWarpKernelThreads,
+                                      warp_kernel_shared_memory<scalar_t>(n), stream>>>(
+          a, stride, infos_data, batch, n);
+      C10_CUDA_KERNEL_LAUNCH_CHECK();
+    }
+  });
+}
+
+void cholesky_small_batched(Tensor& self, Tensor& infos) {
+  const int64_t n = self.size(-1);
+  const int64_t batch = batchCount(self);
+  const int64_t stride = matrixStride(self);
+  auto stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "cholesky_small_cuda", [&] {
+    auto* a = self.data_ptr<scalar_t>();
+    int* infos_data = infos.data_ptr<int>();
+    if (n <= kRegisterMaxSize) {
+      dispatch_register_size(n, [&](auto size) {
+        constexpr int N = decltype(size)::value;
+        cholesky_register_kernel<scalar_t, N><<<register_kernel_blocks(batch), kThreadsPerBlock, 0, stream>>>(
+            a, stride, infos_data, batch);
+        C10_CUDA_KERNEL_LAUNCH_CHECK();
+      });
+    } else {
+      cholesky_warp_kernel<scalar_t><<<warp_kernel_blocks(batch), kWarpKernelThreads,
+                                       warp_kernel_shared_memory<scalar_t>(n), stream>>>(
+          a, stride, infos_data, batch, n);
+      C10_CUDA_KERNEL_LAUNCH_CHECK();
+    }
+  });
+}
+
+}}  // namespace at::native
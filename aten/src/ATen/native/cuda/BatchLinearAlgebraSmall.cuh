@@ -0,0 +1,142 @@
+#pragma once
+
+#include <c10/macros/Macros.h>
+
+#include <cmath>
+
+namespace at {
+namespace native {
+namespace small_linalg {
+
+// Per-matrix routines of the register-resident small-matrix kernels, see
+// Note [Small-matrix batched linear algebra] in BatchLinearAlgebraSmall.h.
+// Matrices are N x N and column-major, a[i + j * N] being row i and column j.
+// N is a compile time constant and every loop is unrolled, so all indices are
+// constants and the arrays stay in registers; row swaps are written as
+// predicated copies for the same reason.
+
+template <typename scalar_t>
+C10_HOST_DEVICE inline void swap_values(scalar_t& a, scalar_t& b) {
+  const scalar_t tmp = a;
+  a = b;
+  b = tmp;
+}
+
+// LU decomposition with partial pivoting like LAPACK's getrf: on return `a`
+// holds L (unit diagonal, not stored) and U, and `piv` the 1-based pivot rows.
+// Returns 0, or k + 1 if U(k, k) is exactly zero.
+template <typename scalar_t, int N>
+C10_HOST_DEVICE inline int getrf(scalar_t (&a)[N * N], int (&piv)[N], bool pivot) {
+  int info = 0;
+#pragma unroll
+  for (int k = 0; k < N; k++) {
+    int p = k;
+    if (pivot) {
+      scalar_t max_abs = std::abs(a[k + k * N]);
+#pragma unroll
+      for (int i = k + 1; i < N; i++) {
+        const scalar_t value = std::abs(a[i + k * N]);
+        if (value > max_abs) {
+          max_abs = value;
+          p = i;
+        }
+      }
+    }
+    piv[k] = p + 1;
+
+    scalar_t pivot_value = a[k + k * N];
+#pragma unroll
+    for (int i = k + 1; i < N; i++) {
+      if (i == p) {
+        pivot_value = a[i + k * N];
+      }
+    }
+    if (pivot_value != scalar_t(0)) {
+#pragma unroll
+      for (int i = k + 1; i < N; i++) {
+        if (i == p) {
+#pragma unroll
+          for (int j = 0; j < N; j++) {
+            swap_values(a[k + j * N], a[i + j * N]);
+          }
+        }
+      }
+      const scalar_t inv_pivot = scalar_t(1) / pivot_value;
+#pragma unroll
+      for (int i = k + 1; i < N; i++) {
+        a[i + k * N] *= inv_pivot;
+      }
+    } else if (info == 0) {
+      info = k + 1;
+    }
+
+#pragma unroll
+    for (int j = k + 1; j < N; j++) {
+#pragma unroll
+      for (int i = k + 1; i < N; i++) {
+        a[i + j * N] -= a[i + k * N] * a[k + j * N];
+      }
+    }
+  }
+  return info;
+}
+
+// Solves A x = b in place given the output of getrf, like LAPACK's getrs.
+template <typename scalar_t, int N>
+C10_HOST_DEVICE inline void getrs(const scalar_t (&lu)[N * N], const int (&piv)[N], scalar_t (&b)[N]) {
+#pragma unroll
+  for (int k = 0; k < N; k++) {
+#pragma unroll
+    for (int i = k + 1; i < N; i++) {
+      if (i == piv[k] - 1) {
+        swap_values(b[k], b[i]);
+      }
+    }
+  }
+#pragma unroll
+  for (int k = 0; k < N; k++) {
+#pragma unroll
+    for (int i = k + 1; i < N; i++) {
+      b[i] -= lu[i + k * N] * b[k];
+    }
+  }
+#pragma unroll
+  for (int k = N - 1; k >= 0; k--) {
+    b[k] /= lu[k + k * N];
+#pragma unroll
+    for (int i = 0; i < k; i++) {
+      b[i] -= lu[i + k * N] * b[k];
+    }
+  }
+}
+
+// Cholesky decomposition of the lower triangle like LAPACK's potrf; the upper
+// triangle is left untouched. Returns 0, or k + 1 if the leading minor of
+// order k + 1 is not positive-definite.
+template <typename scalar_t, int N>
+C10_HOST_DEVICE inline int potrf(scalar_t (&a)[N * N]) {
+#pragma unroll
+  for (int j = 0; j < N; j++) {
+    const scalar_t diag = a[j + j * N];
+    if (!(diag > scalar_t(0))) {
+      return j + 1;
+    }
+    const scalar_t root = std::sqrt(diag);
+    a[j + j * N] = root;
+    const scalar_t inv_root = scalar_t(1) / root;
+#pragma unroll
+    for (int i = j + 1; i < N; i++) {
+      a[i + j * N] *= inv_root;
+    }
+#pragma unroll
+    for (int c = j + 1; c < N; c++) {
+#pragma unroll
+      for (int i = c; i < N; i++) {
+        a[i + c * N] -= a[i + j * N] * a[c + j * N];
+      }
+    }
+  }
+  return 0;
+}
+
+}}}  // namespace at::native::small_linalg
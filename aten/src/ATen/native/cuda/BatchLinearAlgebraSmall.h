@@ -0,0 +1,47 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+namespace at {
+namespace native {
+
+// Note [Small-matrix batched linear algebra]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// MAGMA, cuSOLVER and cuBLAS either loop over the batch or launch several
+// kernels per factorization, which dominates for large batches of tiny
+// matrices (e.g. a million 6x6 systems). For real square matrices up to
+// kSmallMatrixMaxSize, lu, solve, inverse and cholesky instead use one kernel
+// launch for the whole batch:
+//
+// * n <= 8: one thread per matrix; the matrix is held in registers and every
+//   loop is unrolled for the exact size (see BatchLinearAlgebraSmall.cuh).
+// * 8 < n <= 32: one warp per matrix; the matrix is held in shared memory and
+//   lane i owns row i during the factorization and column i of the
+//   right-hand side during the triangular solves.
+//
+// use_small_matrix_kernels decides between these kernels and the libraries
+// from (n, batch): the larger n is, the less work a single thread or warp can
+// hide, so the batch has to be larger before the kernels win.
+//
+// All functions take batched column-major inputs (see cloneBatchedColumnMajor)
+// and write LAPACK-style error codes to the int CUDA tensor `infos`, one per
+// matrix, instead of raising.
+constexpr int64_t kSmallMatrixMaxSize = 32;
+
+bool use_small_matrix_kernels(const Tensor& input);
+
+// LU decomposition with (or, if !get_pivots, without) partial pivoting of
+// `self` in place; pivots are 1-based with `n` entries per matrix.
+void lu_small_batched(Tensor& self, Tensor& pivots, Tensor& infos, bool get_pivots);
+
+// Solves A X = B, overwriting `A` with its LU decomposition and `B` with X.
+void solve_small_batched(Tensor& B, Tensor& A, Tensor& infos);
+
+// Inverts `self` in place.
+void inverse_small_batched(Tensor& self, Tensor& infos);
+
+// Cholesky decomposition of the lower triangle of `self` in place; the upper
+// triangle is left untouched.
+void cholesky_small_batched(Tensor& self, Tensor& infos);
+
+}}  // namespace at::native
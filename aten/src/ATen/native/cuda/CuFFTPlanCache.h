@@ -8,8 +8,11 @@
 #include <cufft.h>
 #include <cufftXt.h>
 
+#include <atomic>
 #include <limits>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -409,18 +412,47 @@ static_assert(CUFFT_MAX_PLAN_NUM >= 0 && CUFFT_MAX_PLAN_NUM <= std::numeric_limi
 static_assert(CUFFT_DEFAULT_CACHE_SIZE >= 0 && CUFFT_DEFAULT_CACHE_SIZE <= CUFFT_MAX_PLAN_NUM,
               "CUFFT_DEFAULT_CACHE_SIZE not in [0, CUFFT_MAX_PLAN_NUM] range");
 
+class CuFFTParamsLRUCache;
+
+// A config checked out of a CuFFTParamsLRUCache for the exclusive use of one
+// caller, who may set its stream and work area and execute it without holding
+// the cache's lock. Returns the config to the cache when destroyed.
+class CuFFTCheckedOutConfig {
+public:
+  CuFFTCheckedOutConfig(CuFFTParamsLRUCache* cache, const CuFFTParams& params,
+                        std::unique_ptr<CuFFTConfig> config) :
+    _cache(cache), _params(params), _config(std::move(config)) {}
+
+  CuFFTCheckedOutConfig(CuFFTCheckedOutConfig&&) noexcept = default;
+  CuFFTCheckedOutConfig(const CuFFTCheckedOutConfig&) = delete;
+  CuFFTCheckedOutConfig& operator=(const CuFFTCheckedOutConfig&) = delete;
+
+  inline ~CuFFTCheckedOutConfig();
+
+  const CuFFTConfig& operator*() const { return *_config; }
+  const CuFFTConfig* operator->() const { return _config.get(); }
+
+private:
+  CuFFTParamsLRUCache* _cache;
+  CuFFTParams _params;
+  std::unique_ptr<CuFFTConfig> _config;
+};
+
 // This cache assumes that the mapping from key to value never changes.
-// This is **NOT** thread-safe. Please use a mutex when using it **AND** the
-// value returned from try_emplace_value.
-// The contract of using this cache is that try_emplace_value should only be
-// used when the max_size is positive.
+// A config is taken out of the cache while it is checked out, so that
+// concurrent callers with the same key get different plans (a cuFFT plan
+// can't be executed from two threads at once) and the cache can hold several
+// plans per key. size() counts the configs that aren't checked out; checked
+// out configs return to the front of the LRU list, evicting the least
+// recently used ones beyond max_size. Plans are created without holding the
+// lock.
 class CuFFTParamsLRUCache {
 public:
-  using kv_t = typename std::pair<CuFFTParams, CuFFTConfig>;
-  using map_t = typename std::unordered_map<std::reference_wrapper<CuFFTParams>,
-                                            typename std::list<kv_t>::iterator,
-                                            ParamsHash<CuFFTParams>,
-                                            ParamsEqual<CuFFTParams>>;
+  using kv_t = typename std::pair<CuFFTParams, std::unique_ptr<CuFFTConfig>>;
+  using map_t = typename std::unordered_multimap<std::reference_wrapper<CuFFTParams>,
+                                                 typename std::list<kv_t>::iterator,
+                                                 ParamsHash<CuFFTParams>,
+                                                 ParamsEqual<CuFFTParams>>;
   using map_kkv_iter_t = typename map_t::iterator;
 
 
@@ -430,74 +462,63 @@ public:
     _set_max_size(max_size);
   }
 
-  CuFFTParamsLRUCache(CuFFTParamsLRUCache&& other) noexcept :
-    _usage_list(std::move(other._usage_list)),
-    _cache_map(std::move(other._cache_map)),
-    _max_size(other._max_size) {}
-
-  CuFFTParamsLRUCache& operator=(CuFFTParamsLRUCache&& other) noexcept {
-    _usage_list = std::move(other._usage_list);
-    _cache_map = std::move(other._cache_map);
-    _max_size = other._max_size;
-    return *this;
-  }
-
-  // If key is in this cache, return the cached config. Otherwise, emplace the
-  // config in this cache and return it.
-  // Return const reference because CuFFTConfig shouldn't be tampered with once
-  // created.
-  const CuFFTConfig &lookup(CuFFTParams params) {
-    AT_ASSERT(_max_size > 0);
-
-    map_kkv_iter_t map_it = _cache_map.find(params);
-    // Hit, put to list front
-    if (map_it != _cache_map.end()) {
-      _usage_list.splice(_usage_list.begin(), _usage_list, map_it->second);
-      return map_it->second->second;
+  // Returns a config for params, reusing a cached one if one is free.
+  CuFFTCheckedOutConfig checkout(CuFFTParams params) {
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      map_kkv_iter_t map_it = _cache_map.find(params);
+      if (map_it != _cache_map.end()) {
+        auto kv_it = map_it->second;
+        auto config = std::move(kv_it->second);
+        _cache_map.erase(map_it);
+        _usage_list.erase(kv_it);
+        return CuFFTCheckedOutConfig(this, params, std::move(config));
+      }
     }
+    // Miss, plan without the lock
+    auto config = std::make_unique<CuFFTConfig>(params);
+    return CuFFTCheckedOutConfig(this, params, std::move(config));
+  }
 
-    // Miss
-    // remove if needed
-    if (_usage_list.size() >= _max_size) {
-      auto last = _usage_list.end();
-      last--;
-      _cache_map.erase(last->first);
-      _usage_list.pop_back();
+  // Returns a checked out config to the list front
+  void release(const CuFFTParams& params, std::unique_ptr<CuFFTConfig> config) {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (_max_size == 0) {
+      return;
     }
-
-    // construct new plan at list front, then insert into _cache_map
-    _usage_list.emplace_front(std::piecewise_construct,
-                       std::forward_as_tuple(params),
-                       std::forward_as_tuple(params));
+    _usage_list.emplace_front(params, std::move(config));
     auto kv_it = _usage_list.begin();
     _cache_map.emplace(std::piecewise_construct,
                 std::forward_as_tuple(kv_it->first),
                 std::forward_as_tuple(kv_it));
-    return kv_it->second;
+    _evict();
   }
 
   void clear() {
+    std::lock_guard<std::mutex> guard(mutex);
     _cache_map.clear();
     _usage_list.clear();
   }
 
   void resize(int64_t new_size) {
+    std::lock_guard<std::mutex> guard(mutex);
     _set_max_size(new_size);
-    auto cur_size = _usage_list.size();
-    if (cur_size > _max_size) {
-      auto delete_it = _usage_list.end();
-      for (size_t i = 0; i < cur_size - _max_size; i++) {
-        delete_it--;
-        _cache_map.erase(delete_it->first);
-      }
-      _usage_list.erase(delete_it, _usage_list.end());
-    }
+    _evict();
   }
 
-  size_t size() const { return _cache_map.size(); }
+  size_t size() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return _cache_map.size();
+  }
 
   size_t max_size() const noexcept { return _max_size; }
 
+  // Whether the batch of a transform is split into chunks whose sizes are
+  // powers of two, so that varying batch sizes share O(log(batch)) plans per
+  // signal shape instead of a plan per batch size
+  bool batch_bucketing() const noexcept { return _batch_bucketing; }
+  void set_batch_bucketing(bool enabled) noexcept { _batch_bucketing = enabled; }
+
   std::mutex mutex;
 
 private:
@@ -513,20 +534,48 @@ private:
     _max_size = static_cast<size_t>(new_size);
   }
 
+  // Removes the least recently used configs beyond _max_size; the lock must
+  // be held
+  void _evict() {
+    while (_usage_list.size() > _max_size) {
+      auto last = std::prev(_usage_list.end());
+      // Among the entries of the key, erase the one of this config
+      auto range = _cache_map.equal_range(last->first);
+      for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == last) {
+          _cache_map.erase(it);
+          break;
+        }
+      }
+      _usage_list.pop_back();
+    }
+  }
+
   std::list<kv_t> _usage_list;
   map_t _cache_map;
-  size_t _max_size;
+  std::atomic<size_t> _max_size;
+  std::atomic<bool> _batch_bucketing{false};
 };
 
+CuFFTCheckedOutConfig::~CuFFTCheckedOutConfig() {
+  if (_config) {
+    _cache->release(_params, std::move(_config));
+  }
+}
+
 // Since ATen is separated into CPU build and CUDA build, we need a way to call
 // these functions only when CUDA is loaded. We use CUDA hooks for this purpose
 // (at cuda/detail/CUDAHooks.cpp), and call the hooked functions from the actual
 // native function counterparts (at native/SpectralOps.cpp), i.e.,
 // _cufft_get_plan_cache_max_size, _cufft_set_plan_cache_max_size
-// _cufft_get_plan_cache_size, and _cufft_clear_plan_cache.
+// _cufft_get_plan_cache_size, _cufft_clear_plan_cache,
+// _cufft_get_plan_cache_batch_bucketing and
+// _cufft_set_plan_cache_batch_bucketing.
 int64_t cufft_get_plan_cache_max_size_impl(int64_t device_index);
 void cufft_set_plan_cache_max_size_impl(int64_t device_index, int64_t max_size);
 int64_t cufft_get_plan_cache_size_impl(int64_t device_index);
 void cufft_clear_plan_cache_impl(int64_t device_index);
+bool cufft_get_plan_cache_batch_bucketing_impl(int64_t device_index);
+void cufft_set_plan_cache_batch_bucketing_impl(int64_t device_index, bool enabled);
 
 }}} // namespace at::native::detail
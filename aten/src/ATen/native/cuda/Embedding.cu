@@ -5,6 +5,7 @@
 #include <c10/util/Exception.h>
 #include <c10/macros/Macros.h>
 
+#include <THC/THCAtomics.cuh>
 #include <THC/THCDeviceUtils.cuh>
 #include <THC/THCTensorMathReduce.cuh>
 #include <THC/THCTensorSort.cuh>
@@ -27,6 +28,9 @@ static const int BLOCKDIMY = 16;
 static const int BLOCKDIMY = 32;
 #endif
 
+// Warps per block of embedding_backward_atomic_kernel
+static const int ATOMIC_WARPS_PER_BLOCK = 4;
+
 template
   <typename scalar_t,
    typename accscalar_t,
@@ -118,6 +122,66 @@ __global__ void embedding_backward_feature_kernel
 }
 
 
+// The unsorted backward, for many indices into a large table: each warp takes
+// C10_WARP_SIZE consecutive indices, sums the gradient rows of the indices
+// that are equal, and adds each sum to grad_weight atomically. The order of
+// the atomic adds, and so the result, is nondeterministic.
+template
+  <typename scalar_t,
+   typename accscalar_t,
+   typename index_t>
+__global__ void embedding_backward_atomic_kernel
+  (const index_t* indices,
+   const scalar_t* __restrict__ grad,
+   scalar_t* __restrict__ grad_weight,
+   int64_t n,
+   int64_t stride,
+   int64_t padding_idx)
+{
+  const int64_t start =
+      (static_cast<int64_t>(blockIdx.x) * blockDim.y + threadIdx.y) * C10_WARP_SIZE;
+  if (start >= n) {
+    return;
+  }
+  const int lane = threadIdx.x;
+  const bool valid = start + lane < n;
+  const index_t row = valid ? indices[start + lane] : static_cast<index_t>(padding_idx);
+
+  // Rows not yet added; every pass of the loop adds the row of the lowest
+  // remaining lane, for all the lanes that share it
+#ifdef __HIP_PLATFORM_HCC__
+  unsigned long long int pending = WARP_BALLOT(valid && row != padding_idx);
+#else
+  unsigned int pending = WARP_BALLOT(valid && row != padding_idx);
+#endif
+  while (pending) {
+#ifdef __HIP_PLATFORM_HCC__
+    const int leader = __ffsll(pending) - 1;
+    const unsigned long long int peers =
+        WARP_BALLOT(valid && row == WARP_SHFL(row, leader));
+#else
+    const int leader = __ffs(pending) - 1;
+    const unsigned int peers = WARP_BALLOT(valid && row == WARP_SHFL(row, leader));
+#endif
+    pending &= ~peers;
+    const int64_t dst_row = WARP_SHFL(row, leader);
+    for (int64_t f = lane; f < stride; f += C10_WARP_SIZE) {
+      accscalar_t sum = 0;
+      auto remaining = peers;
+      while (remaining) {
+#ifdef __HIP_PLATFORM_HCC__
+        const int peer = __ffsll(remaining) - 1;
+#else
+        const int peer = __ffs(remaining) - 1;
+#endif
+        sum += static_cast<accscalar_t>(grad[(start + peer) * stride + f]);
+        remaining &= remaining - 1;
+      }
+      gpuAtomicAdd(&grad_weight[dst_row * stride + f], static_cast<scalar_t>(sum));
+    }
+  }
+}
+
 template <typename scalar_t, typename index_t>
 __global__ void embedding_backward_kernel(
   index_t* input, index_t* indices, scalar_t* grad_output, scalar_t* grad_weight,
@@ -268,6 +332,37 @@ Tensor embedding_dense_backward_cuda(const Tensor & grad_, const Tensor & indice
     return grad_weight;
   }
 
+  // Without repeated rows to merge, sorting the indices costs more than the
+  // atomic adds it saves. Half and bfloat16 gradients keep the sort, which
+  // accumulates a row in float rather than rounding after every add.
+  const bool use_atomics = !scale_grad_by_freq &&
+      !globalContext().deterministicAlgorithms() &&
+      num_weights >= num_indices &&
+      (grad.scalar_type() == kFloat || grad.scalar_type() == kDouble);
+  if (use_atomics) {
+    auto indices_contig = indices.contiguous();
+    auto grad_weight = at::zeros({num_weights, grad_.size(-1)}, grad_.options());
+    const int64_t warps = THCCeilDiv(num_indices, (int64_t)C10_WARP_SIZE);
+    dim3 grid(THCCeilDiv(warps, (int64_t)ATOMIC_WARPS_PER_BLOCK));
+    dim3 block(C10_WARP_SIZE, ATOMIC_WARPS_PER_BLOCK);
+
+    AT_DISPATCH_FLOATING_TYPES(grad.scalar_type(), "embedding_backward", [&] {
+      using accscalar_t = acc_type<scalar_t, true>;
+      AT_DISPATCH_INDEX_TYPES(indices.scalar_type(), "embedding_dense_backward_cuda", [&] () {
+        embedding_backward_atomic_kernel<scalar_t, accscalar_t, index_t>
+          <<<grid, block, 0, stream>>>(
+            indices_contig.data_ptr<index_t>(),
+            grad.data_ptr<scalar_t>(),
+            grad_weight.data_ptr<scalar_t>(),
+            num_indices,
+            grad_weight.stride(0),
+            padding_idx);
+        C10_CUDA_KERNEL_LAUNCH_CHECK();
+      });
+    });
+    return grad_weight;
+  }
+
   auto sorted_indices = at::empty_like(indices, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
   auto orig_indices = at::empty_like(indices, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
   Tensor count;
@@ -0,0 +1,297 @@
+#include <ATen/Dispatch.h>
+#include <ATen/NumericUtils.h>
+#include <ATen/native/FusedOptimizers.h>
+#include <ATen/native/ForeachUtils.h>
+#include <ATen/native/cuda/ForeachFunctors.cuh>
+
+// Multi-tensor CUDA kernels of _fused_adam_, _fused_sgd_ and _fused_adagrad_.
+// A single multi_tensor_apply launch reads the parameters, gradients and
+// states of a whole parameter list and writes each once.
+
+namespace at { namespace native {
+
+namespace {
+
+// Processes the chunk of the block: loads the depth operands, lets update
+// modify r_args[0..depth) elementwise, and stores all of them but the
+// gradient, r_args[1]
+template <int depth, typename T, typename Update>
+__device__ __forceinline__ void fused_optimizer_chunk(
+    int chunk_size,
+    TensorListMetadata<depth>& tl,
+    const Update& update) {
+  int tensor_loc = tl.block_to_tensor[blockIdx.x];
+  int chunk_idx = tl.block_to_chunk[blockIdx.x];
+  int n = tl.numel_for_tensor[tensor_loc];
+
+  T* args[depth];
+  init_args<depth>(args, tl, chunk_idx, chunk_size, tensor_loc);
+  n -= chunk_idx * chunk_size;
+
+  T r_args[depth][kILP];
+  for (int i_start = 0; i_start < n && i_start < chunk_size;
+       i_start += blockDim.x * kILP) {
+    load_args<depth>(r_args, args, i_start, chunk_size, n);
+#pragma unroll
+    for (int ii = 0; ii < kILP; ii++) {
+      update(r_args, ii);
+    }
+#pragma unroll
+    for (int d = 0; d < depth; d++) {
+      if (d != 1) {
+        store_args(args[d], r_args[d], i_start, chunk_size, n);
+      }
+    }
+  }
+}
+
+// Operands: param, grad, exp_avg, exp_avg_sq and, with amsgrad (depth 5),
+// max_exp_avg_sq
+template <typename T, int depth>
+struct FusedAdamFunctor {
+  using opmath_t = typename get_opmath_t<T>::opmath_t;
+  __device__ __forceinline__ void operator()(
+      int chunk_size,
+      TensorListMetadata<depth>& tl,
+      FusedAdamParams p) {
+    const bool decay_param = p.weight_decay != 0 && p.decoupled_weight_decay;
+    const bool decay_grad = p.weight_decay != 0 && !p.decoupled_weight_decay;
+    const opmath_t param_decay = 1 - p.lr * p.weight_decay;
+    const opmath_t weight_decay = p.weight_decay;
+    const opmath_t beta1 = p.beta1;
+    const opmath_t beta2 = p.beta2;
+    const opmath_t sqrt_bias_correction2 = ::sqrt(p.bias_correction2);
+    const opmath_t eps = p.eps;
+    const opmath_t neg_step_size = -p.lr / p.bias_correction1;
+
+    fused_optimizer_chunk<depth, T>(chunk_size, tl, [&](T r_args[][kILP], int ii) {
+      opmath_t param = static_cast<opmath_t>(r_args[0][ii]);
+      opmath_t grad = static_cast<opmath_t>(r_args[1][ii]);
+      if (decay_param) {
+        param *= param_decay;
+      } else if (decay_grad) {
+        grad += param * weight_decay;
+      }
+      const opmath_t exp_avg =
+          static_cast<opmath_t>(r_args[2][ii]) * beta1 + grad * (1 - beta1);
+      const opmath_t exp_avg_sq = static_cast<opmath_t>(r_args[3][ii]) * beta2 +
+          grad * grad * (1 - beta2);
+      opmath_t second_moment = exp_avg_sq;
+      if (depth == 5) {
+        const opmath_t max_exp_avg_sq = static_cast<opmath_t>(r_args[depth - 1][ii]);
+        // Propagates NaN, as max_out does
+        second_moment = (max_exp_avg_sq > exp_avg_sq || _isnan(max_exp_avg_sq))
+            ? max_exp_avg_sq
+            : exp_avg_sq;
+        r_args[depth - 1][ii] = static_cast<T>(second_moment);
+      }
+      const opmath_t denom = ::sqrt(second_moment) / sqrt_bias_correction2 + eps;
+      r_args[0][ii] = static_cast<T>(param + neg_step_size * (exp_avg / denom));
+      r_args[2][ii] = static_cast<T>(exp_avg);
+      r_args[3][ii] = static_cast<T>(exp_avg_sq);
+    });
+  }
+};
+
+// Operands: param, grad and, with momentum (depth 3), momentum_buffer
+template <typename T, int depth>
+struct FusedSGDFunctor {
+  using opmath_t = typename get_opmath_t<T>::opmath_t;
+  __device__ __forceinline__ void operator()(
+      int chunk_size,
+      TensorListMetadata<depth>& tl,
+      FusedSGDParams p) {
+    const opmath_t weight_decay = p.weight_decay;
+    const opmath_t momentum = p.momentum;
+    const opmath_t one_minus_dampening = 1 - p.dampening;
+    const opmath_t neg_lr = -p.lr;
+
+    fused_optimizer_chunk<depth, T>(chunk_size, tl, [&](T r_args[][kILP], int ii) {
+      const opmath_t param = static_cast<opmath_t>(r_args[0][ii]);
+      opmath_t d_p = static_cast<opmath_t>(r_args[1][ii]);
+      if (p.weight_decay != 0) {
+        d_p += param * weight_decay;
+      }
+      if (depth == 3) {
+        const opmath_t buf = p.is_first_step
+            ? d_p
+            : static_cast<opmath_t>(r_args[depth - 1][ii]) * momentum +
+                d_p * one_minus_dampening;
+        r_args[depth - 1][ii] = static_cast<T>(buf);
+        d_p = p.nesterov ? d_p + buf * momentum : buf;
+      }
+      r_args[0][ii] = static_cast<T>(param + d_p * neg_lr);
+    });
+  }
+};
+
+// Operands: param, grad, state_sum
+template <typename T>
+struct FusedAdagradFunctor {
+  using opmath_t = typename get_opmath_t<T>::opmath_t;
+  __device__ __forceinline__ void operator()(
+      int chunk_size,
+      TensorListMetadata<3>& tl,
+      FusedAdagradParams p) {
+    const opmath_t weight_decay = p.weight_decay;
+    const opmath_t eps = p.eps;
+    const opmath_t neg_lr = -p.lr;
+
+    fused_optimizer_chunk<3, T>(chunk_size, tl, [&](T r_args[][kILP], int ii) {
+      const opmath_t param = static_cast<opmath_t>(r_args[0][ii]);
+      opmath_t grad = static_cast<opmath_t>(r_args[1][ii]);
+      if (p.weight_decay != 0) {
+        grad += param * weight_decay;
+      }
+      const opmath_t sum = static_cast<opmath_t>(r_args[2][ii]) + grad * grad;
+      r_args[2][ii] = static_cast<T>(sum);
+      r_args[0][ii] = static_cast<T>(param + neg_lr * (grad / (::sqrt(sum) + eps)));
+    });
+  }
+};
+
+// Whether a single multi_tensor_apply can take all the lists: the same CUDA
+// device, floating dtype and strides throughout, non-overlapping and dense
+bool can_use_multi_tensor_apply(ArrayRef<TensorList> tensor_lists) {
+  const auto& first = tensor_lists[0][0];
+  if (!first.is_cuda() || !at::isFloatingType(first.scalar_type())) {
+    return false;
+  }
+  for (const auto& list : tensor_lists) {
+    for (const auto& t : list) {
+      if (t.scalar_type() != first.scalar_type()) {
+        return false;
+      }
+    }
+  }
+  return can_use_fast_route(tensor_lists);
+}
+
+std::vector<std::vector<Tensor>> to_vectors(ArrayRef<TensorList> tensor_lists) {
+  std::vector<std::vector<Tensor>> vectors;
+  vectors.reserve(tensor_lists.size());
+  for (const auto& list : tensor_lists) {
+    vectors.push_back(list.vec());
+  }
+  return vectors;
+}
+
+} // namespace
+
+void _fused_adam_cuda_(
+    TensorList self,
+    TensorList grads,
+    TensorList exp_avgs,
+    TensorList exp_avg_sqs,
+    TensorList max_exp_avg_sqs,
+    double lr,
+    double beta1,
+    double beta2,
+    double weight_decay,
+    double eps,
+    bool amsgrad,
+    bool decoupled_weight_decay,
+    int64_t step) {
+  check_fused_optimizer_inputs(
+      "_fused_adam_", self, grads, {exp_avgs, exp_avg_sqs, max_exp_avg_sqs},
+      {false, false, !amsgrad});
+  const auto p = make_fused_adam_params(
+      lr, beta1, beta2, weight_decay, eps, amsgrad, decoupled_weight_decay,
+      step);
+  if (self.empty()) {
+    return;
+  }
+
+  std::vector<TensorList> lists{self, grads, exp_avgs, exp_avg_sqs};
+  if (amsgrad) {
+    lists.push_back(max_exp_avg_sqs);
+  }
+  if (!can_use_multi_tensor_apply(lists)) {
+    for (size_t i = 0; i < self.size(); i++) {
+      fused_adam_step_slow(
+          self[i], grads[i], exp_avgs[i], exp_avg_sqs[i],
+          amsgrad ? max_exp_avg_sqs[i] : Tensor(), p);
+    }
+    return;
+  }
+
+  auto tensor_lists = to_vectors(lists);
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, self[0].scalar_type(), "fused_adam_cuda", [&]() {
+    if (amsgrad) {
+      multi_tensor_apply<5>(tensor_lists, FusedAdamFunctor<scalar_t, 5>(), p);
+    } else {
+      multi_tensor_apply<4>(tensor_lists, FusedAdamFunctor<scalar_t, 4>(), p);
+    }
+  });
+}
+
+void _fused_sgd_cuda_(
+    TensorList self,
+    TensorList grads,
+    TensorList momentum_buffers,
+    double lr,
+    double momentum,
+    double dampening,
+    double weight_decay,
+    bool nesterov,
+    bool is_first_step) {
+  const bool has_momentum = momentum != 0;
+  check_fused_optimizer_inputs(
+      "_fused_sgd_", self, grads, {momentum_buffers}, {!has_momentum});
+  const FusedSGDParams p{
+      lr, momentum, dampening, weight_decay, nesterov, is_first_step};
+  if (self.empty()) {
+    return;
+  }
+
+  std::vector<TensorList> lists{self, grads};
+  if (has_momentum) {
+    lists.push_back(momentum_buffers);
+  }
+  if (!can_use_multi_tensor_apply(lists)) {
+    for (size_t i = 0; i < self.size(); i++) {
+      fused_sgd_step_slow(
+          self[i], grads[i], has_momentum ? momentum_buffers[i] : Tensor(), p);
+    }
+    return;
+  }
+
+  auto tensor_lists = to_vectors(lists);
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, self[0].scalar_type(), "fused_sgd_cuda", [&]() {
+    if (has_momentum) {
+      multi_tensor_apply<3>(tensor_lists, FusedSGDFunctor<scalar_t, 3>(), p);
+    } else {
+      multi_tensor_apply<2>(tensor_lists, FusedSGDFunctor<scalar_t, 2>(), p);
+    }
+  });
+}
+
+void _fused_adagrad_cuda_(
+    TensorList self,
+    TensorList grads,
+    TensorList state_sums,
+    double lr,
+    double weight_decay,
+    double eps) {
+  check_fused_optimizer_inputs(
+      "_fused_adagrad_", self, grads, {state_sums}, {false});
+  const FusedAdagradParams p{lr, weight_decay, eps};
+  if (self.empty()) {
+    return;
+  }
+
+  std::vector<TensorList> lists{self, grads, state_sums};
+  if (!can_use_multi_tensor_apply(lists)) {
+    for (size_t i = 0; i < self.size(); i++) {
+      fused_adagrad_step_slow(self[i], grads[i], state_sums[i], p);
+    }
+    return;
+  }
+
+  auto tensor_lists = to_vectors(lists);
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, self[0].scalar_type(), "fused_adagrad_cuda", [&]() {
+    multi_tensor_apply<3>(tensor_lists, FusedAdagradFunctor<scalar_t>(), p);
+  });
+}
+
+}} // namespace at::native
@@ -71,7 +71,41 @@ Tensor prepare_batch_matrix_for_cublas(const Tensor& tensor, bool& transpose_ten
 
 namespace {
 
-Tensor& addmm_out_cuda_impl(Tensor& result, const Tensor& self, const Tensor& mat1, const Tensor& mat2, const Scalar& beta, const Scalar& alpha) {
+enum class Activation {
+  None,
+  RELU,
+  GELU,
+};
+
+#if AT_CUDA_BLAS_LT_ENABLED()
+cuda::blas::GEMMAndBiasActivationEpilogue activation_to_gemm_and_blas_arg(Activation a) {
+  switch (a) {
+    case Activation::RELU:
+      return cuda::blas::GEMMAndBiasActivationEpilogue::RELU;
+    case Activation::GELU:
+      return cuda::blas::GEMMAndBiasActivationEpilogue::GELU;
+    default:
+      return cuda::blas::GEMMAndBiasActivationEpilogue::None;
+  }
+}
+#endif
+
+Tensor& apply_activation(Tensor& result, Activation activation) {
+  switch (activation) {
+    case Activation::RELU:
+      return at::relu_(result);
+    case Activation::GELU:
+      return result.copy_(at::gelu(result));
+    default:
+      return result;
+  }
+}
+
+// result = activation(beta * self + alpha * mat1 @ mat2). A 1-D self with
+// beta = 1, the bias of a linear layer, is added by the epilogue of a
+// cuBLASLt GEMM along with the activation, rather than copied into result
+// beforehand.
+Tensor& addmm_out_cuda_impl(Tensor& result, const Tensor& self, const Tensor& mat1, const Tensor& mat2, const Scalar& beta, const Scalar& alpha, Activation activation = Activation::None) {
   TORCH_CHECK(mat1.dim() == 2 && mat2.dim() == 2, "tensors must be 2-D");
 
   TensorArg args[]{{result, "out", 0}, {self, "self", 1}, {mat1, "mat1", 2}, {mat2, "mat2", 3}};
@@ -100,9 +134,27 @@ Tensor& addmm_out_cuda_impl(Tensor& result, const Tensor& self, const Tensor& ma
       " mat2 dim0: ",
       mat2_sizes[0]);
 
+  bool use_lt_interface = false;
+#if AT_CUDA_BLAS_LT_ENABLED()
+  const auto self_scalar_type = self.scalar_type();
+  // cuBLASLt finds no algorithm when mat2 has a single row or column
+  use_lt_interface = &result != &self && beta.toComplexDouble() == 1.0 &&
+      self.dim() == 1 && self.size(0) == mat2_sizes[1] && self.is_contiguous() &&
+      mat1.numel() > 0 && mat2_sizes[0] > 1 && mat2_sizes[1] > 1 &&
+      (self_scalar_type == at::ScalarType::Double ||
+       self_scalar_type == at::ScalarType::Float ||
+       self_scalar_type == at::ScalarType::Half ||
+       self_scalar_type == at::ScalarType::BFloat16) &&
+      mat1.scalar_type() == self_scalar_type &&
+      mat2.scalar_type() == self_scalar_type;
+#endif
+
   if (&result != &self) {
     at::native::resize_output(result, self__sizes);
-    if (beta.toComplexDouble() != 0.0) {
+    // The bias of the epilogue broadcasts over the columns of the
+    // column-major result, so that result must be row-major
+    use_lt_interface = use_lt_interface && result.is_contiguous();
+    if (beta.toComplexDouble() != 0.0 && !use_lt_interface) {
       at::native::copy_(result, *self_);
     }
   }
@@ -143,7 +195,7 @@ Tensor& addmm_out_cuda_impl(Tensor& result, const Tensor& self, const Tensor& ma
     }
     // TODO: We could squeeze some perf by calling at::cuda::mul_out here instead, to bypass the dispatcher.
     // That requires some fixing some internal build dependencies though.
-    return at::mul_out(
+    at::mul_out(
         result,
         self,
         at::native::scalar_tensor(
@@ -152,7 +204,28 @@ Tensor& addmm_out_cuda_impl(Tensor& result, const Tensor& self, const Tensor& ma
             c10::nullopt /* layout */,
             at::kCPU,
             c10::nullopt /* pin_memory */));
+    return apply_activation(result, activation);
+  }
+
+#if AT_CUDA_BLAS_LT_ENABLED()
+  if (use_lt_interface) {
+    TORCH_INTERNAL_ASSERT(transpose_result && result.is_same(*result_));
+    AT_DISPATCH_FLOATING_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16, scalar_type, "addmm_cuda_lt", [&] {
+      at::cuda::blas::gemm_and_bias<scalar_t>(
+        transpose_mat1,
+        transpose_mat2,
+        m, n, k,
+        alpha.to<scalar_t>(),
+        mat1_->data_ptr<scalar_t>(), mat1_ld,
+        mat2_->data_ptr<scalar_t>(), mat2_ld,
+        self.data_ptr<scalar_t>(),
+        result_->data_ptr<scalar_t>(), result_ld,
+        activation_to_gemm_and_blas_arg(activation)
+      );
+    });
+    return result;
   }
+#endif
 
   AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES_AND2(at::ScalarType::Half, at::ScalarType::BFloat16, scalar_type, "addmm_cuda", [&] {
     scalar_t alpha_val = alpha.to<scalar_t>();
@@ -174,7 +247,7 @@ Tensor& addmm_out_cuda_impl(Tensor& result, const Tensor& self, const Tensor& ma
   if (!result.is_same(*result_)) {
     result.copy_(*result_);
   }
-  return result;
+  return apply_activation(result, activation);
 }
 
 Tensor& baddbmm_out_cuda_impl(Tensor& result, const Tensor& self, const Tensor& batch1, const Tensor& batch2, const Scalar& beta, const Scalar& alpha) {
@@ -300,6 +373,18 @@ Tensor addmm_cuda(const Tensor& self, const Tensor& mat1, const Tensor& mat2,
   return out;
 }
 
+Tensor addmm_activation_cuda(const Tensor& self, const Tensor& mat1, const Tensor& mat2,
+                             const Scalar& beta, const Scalar& alpha, bool use_gelu) {
+  Tensor out = at::empty({0}, self.options());
+  {
+    at::NoNamesGuard guard;
+    addmm_out_cuda_impl(out, self, mat1, mat2, beta, alpha,
+                        use_gelu ? Activation::GELU : Activation::RELU);
+  }
+  at::namedinference::propagate_names_for_addmm(out, mat1, mat2, self);
+  return out;
+}
+
 Tensor& addmm__cuda(Tensor& self, const Tensor& mat1, const Tensor& mat2,
                     const Scalar& beta, const Scalar& alpha) {
   addmm_out_cuda(self, mat1, mat2, beta, alpha, self);
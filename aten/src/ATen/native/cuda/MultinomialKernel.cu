@@ -300,6 +300,68 @@ sampleMultinomialOnce(int64_t* dest,
   }
 }
 
+// See Note [Alias method for multinomial sampling]
+template <typename prob_t>
+C10_LAUNCH_BOUNDS_1(256)
+__global__ void multinomial_alias_draw_kernel(
+    PhiloxCudaState philox_args,
+    int64_t* dest,
+    const int64_t* J,
+    const prob_t* q,
+    int64_t n_sample,
+    int64_t n_categories,
+    int64_t numel) {
+  auto seeds = at::cuda::philox::unpack(philox_args);
+  const int64_t idx = blockIdx.x * blockDim.x + threadIdx.x;
+  curandStatePhilox4_32_10_t state;
+  curand_init(std::get<0>(seeds), idx, std::get<1>(seeds), &state);
+  for (int64_t i = idx; i < numel; i += blockDim.x * gridDim.x) {
+    const uint4 rand = curand4(&state);
+    const int64_t row = (i / n_sample) * n_categories;
+    const int64_t col = static_cast<int64_t>(
+        (static_cast<uint64_t>(rand.x) * static_cast<uint64_t>(n_categories)) >> 32);
+    const double u = rand.y * (1.0 / 4294967296.0);
+    dest[i] = u < q[row + col] ? col : J[row + col];
+  }
+}
+
+void multinomial_alias_draw_kernel_impl(
+    Tensor& result,
+    const Tensor& J,
+    const Tensor& q,
+    c10::optional<Generator> generator) {
+  auto gen = get_generator_or_default<CUDAGeneratorImpl>(generator, cuda::detail::getDefaultCUDAGenerator());
+  const int64_t numel = result.numel();
+  Tensor out = result.is_contiguous() ? result : at::empty(result.sizes(), result.options());
+
+  const int block = 256;
+  const int64_t max_grid = at::cuda::getCurrentDeviceProperties()->multiProcessorCount *
+      (at::cuda::getCurrentDeviceProperties()->maxThreadsPerMultiProcessor / block);
+  const int64_t grid = std::min<int64_t>(max_grid, (numel + block - 1) / block);
+  PhiloxCudaState rng_engine_inputs;
+  {
+    // See Note [Acquire lock when using random generators]
+    std::lock_guard<std::mutex> lock(gen->mutex_);
+    // Every thread draws one curand4 per sample of its grid-stride loop
+    rng_engine_inputs = gen->philox_cuda_state(((numel - 1) / (block * grid) + 1) * 4);
+  }
+
+  AT_DISPATCH_FLOATING_TYPES(q.scalar_type(), "multinomial_alias_draw_cuda", [&] {
+    multinomial_alias_draw_kernel<scalar_t><<<grid, block, 0, at::cuda::getCurrentCUDAStream()>>>(
+        rng_engine_inputs,
+        out.data_ptr<int64_t>(),
+        J.data_ptr<int64_t>(),
+        q.data_ptr<scalar_t>(),
+        result.size(-1),
+        J.size(-1),
+        numel);
+    C10_CUDA_KERNEL_LAUNCH_CHECK();
+  });
+  if (!out.is_same(result)) {
+    result.copy_(out);
+  }
+}
+
 void multinomial_with_replacement_kernel_impl(
     Tensor& result,
     const Tensor& self,
@@ -435,4 +497,5 @@ void multinomial_with_replacement_kernel_impl(
 REGISTER_DISPATCH(
     multinomial_with_replacement_stub,
     &multinomial_with_replacement_kernel_impl);
+REGISTER_DISPATCH(multinomial_alias_draw_stub, &multinomial_alias_draw_kernel_impl);
 }}
@@ -1,6 +1,7 @@
 #include <ATen/native/TensorAdvancedIndexing.h>
 
 #include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
 #include <ATen/Dispatch.h>
 #include <ATen/MemoryOverlap.h>
 
@@ -9,9 +10,12 @@
 #include <ATen/native/TensorIterator.h>
 
 #include <ATen/native/cuda/Loops.cuh>
+#include <ATen/native/cuda/MemoryAccess.cuh>
 #include <ATen/cuda/detail/OffsetCalculator.cuh>
 #include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/DeviceUtils.cuh>
 #include <THC/THCAtomics.cuh>
+#include <THC/THCIntegerDivider.cuh>
 
 namespace at { namespace native {
 
@@ -432,7 +436,240 @@ struct cuda_scatter_fill_base_kernel {
   }
 }; // struct cuda_scatter_fill_base_kernel
 
+// Fast paths of gather and scatter_add along the last dim of contiguous
+// tensors, whose index has the leading sizes of self (and of src): element i
+// of the index is in row i / K of self, for K the last size of the index. A
+// single divider (a fast one with 32-bit offsets) replaces the
+// OffsetCalculator, and gather loads the index and stores the result in
+// vectors of up to 4 elements.
+
+template <typename offset_t>
+struct LastDimLayout {
+  IntDivider<offset_t> row;  // by the last size of the index
+  offset_t self_row_stride;
+  int64_t self_dim_size;
+};
+
+template <int vec_size, typename scalar_t, typename offset_t>
+C10_LAUNCH_BOUNDS_1(num_threads)
+__global__ void gather_last_dim_kernel(
+    scalar_t* out,
+    const scalar_t* self,
+    const int64_t* index,
+    offset_t num_vecs,
+    LastDimLayout<offset_t> layout) {
+  using vec_t = memory::aligned_vector<scalar_t, vec_size>;
+  using index_vec_t = memory::aligned_vector<int64_t, vec_size>;
+  for (offset_t v = blockIdx.x * blockDim.x + threadIdx.x; v < num_vecs;
+       v += blockDim.x * gridDim.x) {
+    // K is a multiple of vec_size, so the vector is in a single row
+    const offset_t row = layout.row.div(v * vec_size);
+    const scalar_t* self_row = self + row * layout.self_row_stride;
+    const index_vec_t idx = reinterpret_cast<const index_vec_t*>(index)[v];
+    vec_t result;
+    #pragma unroll
+    for (int j = 0; j < vec_size; j++) {
+      CUDA_KERNEL_ASSERT(idx.val[j] >= 0 && idx.val[j] < layout.self_dim_size
+        && "index out of bounds");
+      result.val[j] = self_row[static_cast<offset_t>(idx.val[j])];
+    }
+    reinterpret_cast<vec_t*>(out)[v] = result;
+  }
+}
+
+// The lanes of a warp take consecutive elements, and first sum the runs of
+// them that add to the same element of self: only the head of a run adds
+// atomically, which serializes far less for duplicate-heavy (e.g. sorted)
+// indices.
+template <typename scalar_t, typename offset_t>
+C10_LAUNCH_BOUNDS_1(num_threads)
+__global__ void scatter_add_last_dim_kernel(
+    scalar_t* self,
+    const scalar_t* src,
+    const int64_t* index,
+    offset_t numel,
+    LastDimLayout<offset_t> layout) {
+  using accscalar_t = acc_type<scalar_t, true>;
+  const int lane = threadIdx.x % C10_WARP_SIZE;
+  // The loop is uniform over the block, so that all the lanes shuffle
+  for (offset_t base = blockIdx.x * blockDim.x; base < numel;
+       base += blockDim.x * gridDim.x) {
+    const offset_t i = base + threadIdx.x;
+    const bool valid = i < numel;
+    offset_t dst = 0;
+    accscalar_t val = 0;
+    if (valid) {
+      const int64_t idx = index[i];
+      CUDA_KERNEL_ASSERT(idx >= 0 && idx < layout.self_dim_size
+        && "index out of bounds");
+      dst = layout.row.div(i) * layout.self_row_stride + static_cast<offset_t>(idx);
+      val = static_cast<accscalar_t>(src[i]);
+    }
+
+    const offset_t prev_dst = WARP_SHFL_UP(dst, 1);
+    const int prev_valid = WARP_SHFL_UP(static_cast<int>(valid), 1);
+    const bool head = valid && (lane == 0 || !prev_valid || prev_dst != dst);
+#ifdef __HIP_PLATFORM_HCC__
+    const unsigned long long int heads = WARP_BALLOT(head);
+    const int run = __popcll(heads & ((2ull << lane) - 1));
+#else
+    const unsigned int heads = WARP_BALLOT(head);
+    const int run = __popc(heads & ((2u << lane) - 1));
+#endif
+    // Segmented suffix sums, so that the head of a run gets its total
+    #pragma unroll
+    for (int offset = 1; offset < C10_WARP_SIZE; offset <<= 1) {
+      const accscalar_t other = WARP_SHFL_DOWN(val, offset);
+      const int other_run = WARP_SHFL_DOWN(run, offset);
+      if (lane + offset < C10_WARP_SIZE && other_run == run) {
+        val += other;
+      }
+    }
+    if (head) {
+      gpuAtomicAdd(self + dst, static_cast<scalar_t>(val));
+    }
+  }
+}
+
+// Whether self, index and src (undefined for gather's self) have the layout
+// of the fast paths, along dim
+static bool is_last_dim_layout(
+    const Tensor& self, int64_t dim, const Tensor& index, const Tensor& src) {
+  if (self.dim() == 0 || index.numel() == 0 ||
+      maybe_wrap_dim(dim, self.dim()) != self.dim() - 1 ||
+      index.dim() != self.dim() || index.scalar_type() != kLong ||
+      !self.is_contiguous() || !index.is_contiguous()) {
+    return false;
+  }
+  if (src.defined() &&
+      (!src.is_contiguous() || src.sizes() != index.sizes() ||
+       src.scalar_type() != self.scalar_type())) {
+    return false;
+  }
+  return self.sizes().slice(0, self.dim() - 1) ==
+      index.sizes().slice(0, index.dim() - 1);
+}
+
+template <typename offset_t>
+static LastDimLayout<offset_t> make_last_dim_layout(const Tensor& self, const Tensor& index) {
+  return {
+    IntDivider<offset_t>(static_cast<offset_t>(index.size(-1))),
+    static_cast<offset_t>(self.size(-1)),
+    self.size(-1)};
+}
+
+static bool can_use_32bit_offsets(const Tensor& a, const Tensor& b) {
+  return a.numel() <= std::numeric_limits<int32_t>::max() &&
+      b.numel() <= std::numeric_limits<int32_t>::max();
+}
+
+template <int vec_size, typename scalar_t, typename offset_t>
+static void launch_gather_last_dim_kernel(
+    Tensor& result, const Tensor& self, const Tensor& index) {
+  const offset_t num_vecs = index.numel() / vec_size;
+  const int64_t grid = std::min<int64_t>(
+      (num_vecs + num_threads - 1) / num_threads,
+      at::cuda::getCurrentDeviceProperties()->multiProcessorCount * 32);
+  gather_last_dim_kernel<vec_size, scalar_t, offset_t>
+    <<<grid, num_threads, 0, at::cuda::getCurrentCUDAStream()>>>(
+      reinterpret_cast<scalar_t*>(result.data_ptr()),
+      reinterpret_cast<const scalar_t*>(self.data_ptr()),
+      index.data_ptr<int64_t>(),
+      num_vecs,
+      make_last_dim_layout<offset_t>(self, index));
+  C10_CUDA_KERNEL_LAUNCH_CHECK();
+}
+
+template <typename scalar_t, typename offset_t>
+static void gather_last_dim(Tensor& result, const Tensor& self, const Tensor& index) {
+  const int64_t K = index.size(-1);
+  int vec_size = std::min(
+      memory::can_vectorize_up_to<scalar_t>(static_cast<char*>(result.data_ptr())),
+      memory::can_vectorize_up_to<int64_t>(static_cast<char*>(index.data_ptr())));
+  while (K % vec_size != 0) {
+    vec_size /= 2;
+  }
+  switch (vec_size) {
+    case 4:
+      launch_gather_last_dim_kernel<4, scalar_t, offset_t>(result, self, index);
+      break;
+    case 2:
+      launch_gather_last_dim_kernel<2, scalar_t, offset_t>(result, self, index);
+      break;
+    default:
+      launch_gather_last_dim_kernel<1, scalar_t, offset_t>(result, self, index);
+      break;
+  }
+}
+
+// Runs gather on the fast path, when result, self and index have its layout
+static bool gather_last_dim_cuda(Tensor& result, const Tensor& self, int64_t dim, const Tensor& index) {
+  if (!is_last_dim_layout(self, dim, index, Tensor()) || !result.is_contiguous() ||
+      result.sizes() != index.sizes()) {
+    return false;
+  }
+  at::assert_no_internal_overlap(result);
+  scatter_gather_dtype_check("gather_out_cuda", result, index, self);
+  gather_shape_check(result, maybe_wrap_dim(dim, self.dim()), index, self);
+
+  AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND3(
+    at::ScalarType::Half, at::ScalarType::Bool, at::ScalarType::BFloat16,
+    self.scalar_type(), "gather_last_dim_cuda", [&] {
+      using dtype = OpaqueType<sizeof(scalar_t)>;
+      if (can_use_32bit_offsets(self, index)) {
+        gather_last_dim<dtype, uint32_t>(result, self, index);
+      } else {
+        gather_last_dim<dtype, int64_t>(result, self, index);
+      }
+    }
+  );
+  return true;
+}
+
+template <typename scalar_t, typename offset_t>
+static void scatter_add_last_dim(Tensor& self, const Tensor& index, const Tensor& src) {
+  const offset_t numel = index.numel();
+  const int64_t grid = std::min<int64_t>(
+      (numel + num_threads - 1) / num_threads,
+      at::cuda::getCurrentDeviceProperties()->multiProcessorCount * 32);
+  scatter_add_last_dim_kernel<scalar_t, offset_t>
+    <<<grid, num_threads, 0, at::cuda::getCurrentCUDAStream()>>>(
+      self.data_ptr<scalar_t>(),
+      src.data_ptr<scalar_t>(),
+      index.data_ptr<int64_t>(),
+      numel,
+      make_last_dim_layout<offset_t>(self, index));
+  C10_CUDA_KERNEL_LAUNCH_CHECK();
+}
+
+// Runs scatter_add of floating types on the fast path, when self, index and
+// src have its layout
+static bool scatter_add_last_dim_cuda(Tensor& self, int64_t dim, const Tensor& index, const Tensor& src) {
+  if (!at::isFloatingType(self.scalar_type()) ||
+      !is_last_dim_layout(self, dim, index, src)) {
+    return false;
+  }
+  at::assert_no_internal_overlap(self);
+  scatter_gather_dtype_check("scatter_add_cuda_", self, index, src);
+  scatter_shape_check(self, maybe_wrap_dim(dim, self.dim()), index, src);
+
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+    at::ScalarType::Half, at::ScalarType::BFloat16,
+    self.scalar_type(), "scatter_add_last_dim_cuda", [&] {
+      if (can_use_32bit_offsets(self, index)) {
+        scatter_add_last_dim<scalar_t, uint32_t>(self, index, src);
+      } else {
+        scatter_add_last_dim<scalar_t, int64_t>(self, index, src);
+      }
+    }
+  );
+  return true;
+}
+
 void gather_cuda_kernel(Tensor& result, const Tensor& self, int64_t dim, const Tensor& index) {
+  if (gather_last_dim_cuda(result, self, dim, index)) {
+    return;
+  }
   cuda_scatter_gather_base_kernel</*is_scatter_like=*/false>()(
     result, dim, index, self,
     "gather_out_cuda", tensor_assign);
@@ -454,6 +691,9 @@ void scatter_add_cuda_kernel(Tensor& self, int64_t dim, const Tensor& index, con
   // See Note [Writing Nondeterministic Operations]
   // Nondeterministic because of atomicAdd usage
   globalContext().alertNotDeterministic("scatter_add_cuda_kernel");
+  if (scatter_add_last_dim_cuda(self, dim, index, src)) {
+    return;
+  }
   cuda_scatter_gather_base_kernel</*is_scatter_like=*/true, /*cast_to_opaque=*/false>()(
     self, dim, index, src,
     "scatter_add_cuda_", reduce_add);
@@ -682,6 +682,215 @@ cunn_SoftMaxBackward(scalar_t *gradInput, outscalar_t *output, outscalar_t *grad
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Block persistent kernels (rows too long for PersistentSoftmax.cuh)
+////////////////////////////////////////////////////////////////////////////////
+// A block reads its row once, into registers: each thread holds up to kVecs
+// aligned vectors of ILP elements, from which the max, the sum and the result
+// are computed, where cunn_SoftMaxForward reads the row three times. The rows
+// must be multiples of ILP elements, so that all their vectors are aligned.
+
+// At most 128 registers a thread, which hold up to 8 vectors of the row
+constexpr int kPersistentMaxThreads = 512;
+constexpr int kPersistentMaxVecs = 8;
+
+// Picks the vectors per thread and the block size for rows of dim_size
+// elements; false when they don't fit in the registers of a block
+inline bool SoftMaxPersistent_getLaunchSizes(int ILP, int64_t dim_size, int* vecs, dim3* block) {
+  const int64_t num_vecs = dim_size / ILP;
+  for (int v = 1; v <= kPersistentMaxVecs; v *= 2) {
+    if (num_vecs <= v * kPersistentMaxThreads) {
+      const int64_t threads = (num_vecs + v - 1) / v;
+      *vecs = v;
+      *block = dim3((threads + C10_WARP_SIZE - 1) / C10_WARP_SIZE * C10_WARP_SIZE);
+      return true;
+    }
+  }
+  return false;
+}
+
+inline bool is_vec_aligned(const void* ptr) {
+  return reinterpret_cast<uintptr_t>(ptr) % ALIGN_BYTES == 0;
+}
+
+template <int ILP, int kVecs, typename scalar_t, typename accscalar_t, typename outscalar_t, template <typename, typename, typename> class Epilogue>
+__global__ void
+C10_LAUNCH_BOUNDS_1(kPersistentMaxThreads)
+cunn_SoftMaxForwardPersistent(outscalar_t *output, const scalar_t *input, int classes)
+{
+  extern __shared__ unsigned char smem[];
+  auto sdata = reinterpret_cast<accscalar_t*>(smem);
+
+  using LoadT = at::native::memory::aligned_vector<scalar_t, ILP>;
+  using StoreT = at::native::memory::aligned_vector<outscalar_t, ILP>;
+
+  input += static_cast<int64_t>(blockIdx.x) * classes;
+  output += static_cast<int64_t>(blockIdx.x) * classes;
+  const int num_vecs = classes / ILP;
+
+  LoadT in_v[kVecs];
+  accscalar_t threadMax = -at::numeric_limits<accscalar_t>::max();
+  #pragma unroll
+  for (int k = 0; k < kVecs; ++k) {
+    const int v = k * blockDim.x + threadIdx.x;
+    if (v < num_vecs) {
+      in_v[k] = reinterpret_cast<const LoadT*>(input)[v];
+      #pragma unroll
+      for (int j = 0; j < ILP; ++j) {
+        threadMax = Max<accscalar_t>()(threadMax, static_cast<accscalar_t>(in_v[k].val[j]));
+      }
+    }
+  }
+  accscalar_t max_k = blockReduce<Max, accscalar_t>(
+      sdata, threadMax, Max<accscalar_t>(), -at::numeric_limits<accscalar_t>::max());
+
+  accscalar_t threadExp = 0;
+  #pragma unroll
+  for (int k = 0; k < kVecs; ++k) {
+    if (k * blockDim.x + threadIdx.x < num_vecs) {
+      #pragma unroll
+      for (int j = 0; j < ILP; ++j) {
+        threadExp += std::exp(static_cast<accscalar_t>(in_v[k].val[j]) - max_k);
+      }
+    }
+  }
+  accscalar_t sumAll = blockReduce<Add, accscalar_t>(
+      sdata, threadExp, Add<accscalar_t>(), static_cast<accscalar_t>(0));
+
+  Epilogue<scalar_t, accscalar_t, outscalar_t> epilogue(max_k, sumAll);
+  #pragma unroll
+  for (int k = 0; k < kVecs; ++k) {
+    const int v = k * blockDim.x + threadIdx.x;
+    if (v < num_vecs) {
+      StoreT out_v;
+      #pragma unroll
+      for (int j = 0; j < ILP; ++j) {
+        out_v.val[j] = epilogue(in_v[k].val[j]);
+      }
+      reinterpret_cast<StoreT*>(output)[v] = out_v;
+    }
+  }
+}
+
+// gradOutput is read once, output only by the final pass
+template <int ILP, int kVecs, typename scalar_t, typename accscalar_t, typename outscalar_t, template<typename, typename, typename> class Epilogue>
+__global__ void
+C10_LAUNCH_BOUNDS_1(kPersistentMaxThreads)
+cunn_SoftMaxBackwardPersistent(scalar_t *gradInput, const outscalar_t *output, const outscalar_t *gradOutput, int classes)
+{
+  extern __shared__ unsigned char smem[];
+  auto sdata = reinterpret_cast<accscalar_t*>(smem);
+
+  using OutLoadT = at::native::memory::aligned_vector<outscalar_t, ILP>;
+  using StoreT = at::native::memory::aligned_vector<scalar_t, ILP>;
+
+  gradInput += static_cast<int64_t>(blockIdx.x) * classes;
+  output += static_cast<int64_t>(blockIdx.x) * classes;
+  gradOutput += static_cast<int64_t>(blockIdx.x) * classes;
+  const int num_vecs = classes / ILP;
+
+  OutLoadT grad_v[kVecs];
+  accscalar_t threadSum = 0;
+  #pragma unroll
+  for (int k = 0; k < kVecs; ++k) {
+    const int v = k * blockDim.x + threadIdx.x;
+    if (v < num_vecs) {
+      grad_v[k] = reinterpret_cast<const OutLoadT*>(gradOutput)[v];
+      #pragma unroll
+      for (int j = 0; j < ILP; ++j) {
+        threadSum += static_cast<accscalar_t>(grad_v[k].val[j]);
+      }
+    }
+  }
+  accscalar_t sum_k = blockReduce<Add, accscalar_t>(
+      sdata, threadSum, Add<accscalar_t>(), accscalar_t(0));
+
+  Epilogue<scalar_t, accscalar_t, outscalar_t> epilogue(sum_k);
+  #pragma unroll
+  for (int k = 0; k < kVecs; ++k) {
+    const int v = k * blockDim.x + threadIdx.x;
+    if (v < num_vecs) {
+      const OutLoadT out_v = reinterpret_cast<const OutLoadT*>(output)[v];
+      StoreT grad_input_v;
+      #pragma unroll
+      for (int j = 0; j < ILP; ++j) {
+        grad_input_v.val[j] = epilogue(grad_v[k].val[j], out_v.val[j]);
+      }
+      reinterpret_cast<StoreT*>(gradInput)[v] = grad_input_v;
+    }
+  }
+}
+
+// Launches cunn_SoftMaxForwardPersistent over outer_size rows; false when the
+// rows are misaligned or too long for it
+template <int ILP, typename scalar_t, typename accscalar_t, typename outscalar_t, template <typename, typename, typename> class Epilogue>
+bool dispatch_softmax_forward_persistent(
+    outscalar_t* output, const scalar_t* input, int64_t dim_size, int64_t outer_size, cudaStream_t stream) {
+  int vecs;
+  dim3 block;
+  if (dim_size % ILP != 0 || !is_vec_aligned(output) || !is_vec_aligned(input) ||
+      !SoftMaxPersistent_getLaunchSizes(ILP, dim_size, &vecs, &block)) {
+    return false;
+  }
+  const dim3 grid(outer_size);
+  const size_t smem_size = block.x * sizeof(accscalar_t);
+  switch (vecs) {
+    case 1:
+      cunn_SoftMaxForwardPersistent<ILP, 1, scalar_t, accscalar_t, outscalar_t, Epilogue>
+        <<<grid, block, smem_size, stream>>>(output, input, dim_size);
+      break;
+    case 2:
+      cunn_SoftMaxForwardPersistent<ILP, 2, scalar_t, accscalar_t, outscalar_t, Epilogue>
+        <<<grid, block, smem_size, stream>>>(output, input, dim_size);
+      break;
+    case 4:
+      cunn_SoftMaxForwardPersistent<ILP, 4, scalar_t, accscalar_t, outscalar_t, Epilogue>
+        <<<grid, block, smem_size, stream>>>(output, input, dim_size);
+      break;
+    default:
+      cunn_SoftMaxForwardPersistent<ILP, kPersistentMaxVecs, scalar_t, accscalar_t, outscalar_t, Epilogue>
+        <<<grid, block, smem_size, stream>>>(output, input, dim_size);
+      break;
+  }
+  C10_CUDA_KERNEL_LAUNCH_CHECK();
+  return true;
+}
+
+template <int ILP, typename scalar_t, typename accscalar_t, typename outscalar_t, template <typename, typename, typename> class Epilogue>
+bool dispatch_softmax_backward_persistent(
+    scalar_t* gradInput, const outscalar_t* output, const outscalar_t* gradOutput,
+    int64_t dim_size, int64_t outer_size, cudaStream_t stream) {
+  int vecs;
+  dim3 block;
+  if (dim_size % ILP != 0 || !is_vec_aligned(gradInput) || !is_vec_aligned(output) ||
+      !is_vec_aligned(gradOutput) ||
+      !SoftMaxPersistent_getLaunchSizes(ILP, dim_size, &vecs, &block)) {
+    return false;
+  }
+  const dim3 grid(outer_size);
+  const size_t smem_size = block.x * sizeof(accscalar_t);
+  switch (vecs) {
+    case 1:
+      cunn_SoftMaxBackwardPersistent<ILP, 1, scalar_t, accscalar_t, outscalar_t, Epilogue>
+        <<<grid, block, smem_size, stream>>>(gradInput, output, gradOutput, dim_size);
+      break;
+    case 2:
+      cunn_SoftMaxBackwardPersistent<ILP, 2, scalar_t, accscalar_t, outscalar_t, Epilogue>
+        <<<grid, block, smem_size, stream>>>(gradInput, output, gradOutput, dim_size);
+      break;
+    case 4:
+      cunn_SoftMaxBackwardPersistent<ILP, 4, scalar_t, accscalar_t, outscalar_t, Epilogue>
+        <<<grid, block, smem_size, stream>>>(gradInput, output, gradOutput, dim_size);
+      break;
+    default:
+      cunn_SoftMaxBackwardPersistent<ILP, kPersistentMaxVecs, scalar_t, accscalar_t, outscalar_t, Epilogue>
+        <<<grid, block, smem_size, stream>>>(gradInput, output, gradOutput, dim_size);
+      break;
+  }
+  C10_CUDA_KERNEL_LAUNCH_CHECK();
+  return true;
+}
+
 template<template<typename, typename, typename> class Epilogue, bool is_log_softmax>
 Tensor host_softmax(const Tensor & input_, const int64_t dim_, const bool half_to_float){
   if (half_to_float) {
@@ -725,11 +934,14 @@ Tensor host_softmax(const Tensor & input_, const int64_t dim_, const bool half_t
             }
           } else {
             constexpr int ILP = sizeof(float4) / sizeof(scalar_t);
-            dim3 block = SoftMax_getBlockSize(ILP, dim_size);
-            cunn_SoftMaxForward<ILP, scalar_t, accscalar_t, scalar_t, Epilogue>
-              <<<grid, block, block.x * sizeof(accscalar_t), stream>>>(
-                output.data_ptr<scalar_t>(), input.data_ptr<scalar_t>(), dim_size);
-            C10_CUDA_KERNEL_LAUNCH_CHECK();
+            if (!dispatch_softmax_forward_persistent<ILP, scalar_t, accscalar_t, scalar_t, Epilogue>(
+                    output.data_ptr<scalar_t>(), input.data_ptr<scalar_t>(), dim_size, outer_size, stream)) {
+              dim3 block = SoftMax_getBlockSize(ILP, dim_size);
+              cunn_SoftMaxForward<ILP, scalar_t, accscalar_t, scalar_t, Epilogue>
+                <<<grid, block, block.x * sizeof(accscalar_t), stream>>>(
+                  output.data_ptr<scalar_t>(), input.data_ptr<scalar_t>(), dim_size);
+              C10_CUDA_KERNEL_LAUNCH_CHECK();
+            }
           }
         } else {
           if (dim_size <= 1024 && dim_size*sizeof(scalar_t) <= 4096) {
@@ -746,11 +958,14 @@ Tensor host_softmax(const Tensor & input_, const int64_t dim_, const bool half_t
             }
           } else {
             constexpr int ILP = sizeof(float4) / sizeof(accscalar_t);
-            dim3 block = SoftMax_getBlockSize(ILP, dim_size);
-            cunn_SoftMaxForward<ILP, scalar_t, accscalar_t, accscalar_t, Epilogue>
-              <<<grid, block, block.x * sizeof(accscalar_t), stream>>>(
-                output.data_ptr<accscalar_t>(), input.data_ptr<scalar_t>(), dim_size);
-            C10_CUDA_KERNEL_LAUNCH_CHECK();
+            if (!dispatch_softmax_forward_persistent<ILP, scalar_t, accscalar_t, accscalar_t, Epilogue>(
+                    output.data_ptr<accscalar_t>(), input.data_ptr<scalar_t>(), dim_size, outer_size, stream)) {
+              dim3 block = SoftMax_getBlockSize(ILP, dim_size);
+              cunn_SoftMaxForward<ILP, scalar_t, accscalar_t, accscalar_t, Epilogue>
+                <<<grid, block, block.x * sizeof(accscalar_t), stream>>>(
+                  output.data_ptr<accscalar_t>(), input.data_ptr<scalar_t>(), dim_size);
+              C10_CUDA_KERNEL_LAUNCH_CHECK();
+            }
           }
         }
       });
@@ -830,12 +1045,16 @@ Tensor host_softmax_backward(const Tensor &grad_, const Tensor &output_, int64_t
         }
       } else {
         constexpr int ILP = sizeof(float4) / sizeof(scalar_t);
-        dim3 block = SoftMax_getBlockSize(ILP, dim_size);
-        cunn_SoftMaxBackward<ILP, scalar_t, accscalar_t, scalar_t, Epilogue>
-         <<<grid, block, block.x * sizeof(accscalar_t), stream>>>(
-            gI.data_ptr<scalar_t>(), output.data_ptr<scalar_t>(), grad.data_ptr<scalar_t>(), dim_size
-        );
-        C10_CUDA_KERNEL_LAUNCH_CHECK();
+        if (!dispatch_softmax_backward_persistent<ILP, scalar_t, accscalar_t, scalar_t, Epilogue>(
+                gI.data_ptr<scalar_t>(), output.data_ptr<scalar_t>(), grad.data_ptr<scalar_t>(),
+                dim_size, outer_size, stream)) {
+          dim3 block = SoftMax_getBlockSize(ILP, dim_size);
+          cunn_SoftMaxBackward<ILP, scalar_t, accscalar_t, scalar_t, Epilogue>
+           <<<grid, block, block.x * sizeof(accscalar_t), stream>>>(
+              gI.data_ptr<scalar_t>(), output.data_ptr<scalar_t>(), grad.data_ptr<scalar_t>(), dim_size
+          );
+          C10_CUDA_KERNEL_LAUNCH_CHECK();
+        }
       }
     } else {
       if (dim_size <= 1024 && dim_size*sizeof(scalar_t) <= 4096) {
@@ -854,12 +1073,16 @@ Tensor host_softmax_backward(const Tensor &grad_, const Tensor &output_, int64_t
         }
       } else {
         constexpr int ILP = sizeof(float4) / sizeof(accscalar_t);
-        dim3 block = SoftMax_getBlockSize(ILP, dim_size);
-        cunn_SoftMaxBackward<ILP, scalar_t, accscalar_t, accscalar_t, Epilogue>
-         <<<grid, block, block.x * sizeof(accscalar_t), stream>>>(
-            gI.data_ptr<scalar_t>(), output.data_ptr<accscalar_t>(), grad.data_ptr<accscalar_t>(), dim_size
-        );
-        C10_CUDA_KERNEL_LAUNCH_CHECK();
+        if (!dispatch_softmax_backward_persistent<ILP, scalar_t, accscalar_t, accscalar_t, Epilogue>(
+                gI.data_ptr<scalar_t>(), output.data_ptr<accscalar_t>(), grad.data_ptr<accscalar_t>(),
+                dim_size, outer_size, stream)) {
+          dim3 block = SoftMax_getBlockSize(ILP, dim_size);
+          cunn_SoftMaxBackward<ILP, scalar_t, accscalar_t, accscalar_t, Epilogue>
+           <<<grid, block, block.x * sizeof(accscalar_t), stream>>>(
+              gI.data_ptr<scalar_t>(), output.data_ptr<accscalar_t>(), grad.data_ptr<accscalar_t>(), dim_size
+          );
+          C10_CUDA_KERNEL_LAUNCH_CHECK();
+        }
       }
     }
     });
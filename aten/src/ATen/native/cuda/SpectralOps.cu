@@ -13,6 +13,7 @@
 #include <ATen/native/cuda/CuFFTUtils.h>
 #include <ATen/native/cuda/CuFFTPlanCache.h>
 #include <c10/util/accumulate.h>
+#include <c10/util/llvmMathExtras.h>
 #include <THC/THCTensorSort.cuh>
 #include <THC/THCThrustAllocator.cuh>
 
@@ -341,6 +342,22 @@ void cufft_clear_plan_cache_impl(int64_t device_index) {
   return cufft_get_plan_cache(device_index).clear();
 }
 
+bool cufft_get_plan_cache_batch_bucketing_impl(int64_t device_index) {
+  TORCH_CHECK(0 <= device_index && device_index < at::detail::getCUDAHooks().getNumGPUs(),
+    "cufft_get_plan_cache_batch_bucketing: expected 0 <= device_index < ",
+    at::detail::getCUDAHooks().getNumGPUs(), "], but got device_index=",
+    device_index);
+  return cufft_get_plan_cache(device_index).batch_bucketing();
+}
+
+void cufft_set_plan_cache_batch_bucketing_impl(int64_t device_index, bool enabled) {
+  TORCH_CHECK(0 <= device_index && device_index < at::detail::getCUDAHooks().getNumGPUs(),
+    "cufft_set_plan_cache_batch_bucketing: expected 0 <= device_index < ",
+    at::detail::getCUDAHooks().getNumGPUs(), "], but got device_index=",
+    device_index);
+  cufft_get_plan_cache(device_index).set_batch_bucketing(enabled);
+}
+
 } // namespace at::native::detail
 
 namespace {
@@ -396,41 +413,46 @@ static Tensor& _exec_fft(Tensor& out, const Tensor& self, IntArrayRef out_sizes,
   }
   out.resize_(batched_out_sizes, MemoryFormat::Contiguous);
 
-  // Create the transform plan (either from cache or locally)
   const auto value_type = c10::toValueType(input.scalar_type());
   auto fft_type = GetCuFFTTransformType(input.is_complex(), out.is_complex());
-  CuFFTParams Params(input.strides(), out.strides(), signal_size, fft_type, value_type);
   CuFFTParamsLRUCache& plan_cache = cufft_get_plan_cache(input.device().index());
-  std::unique_lock<std::mutex> guard(plan_cache.mutex, std::defer_lock);
-  c10::optional<CuFFTConfig> uncached_plan;
-  const CuFFTConfig * config = nullptr;
-
-  if (plan_cache.max_size() > 0) {
-    guard.lock();
-    if (plan_cache.max_size() > 0) {  // check again after acquiring the lock
-      config = &plan_cache.lookup(Params);
+  const bool bucket_batches = plan_cache.batch_bucketing();
+  const auto stream = at::cuda::getCurrentCUDAStream();
+  bool input_cloned = false;
+
+  // With batch bucketing, the batch is transformed in chunks of decreasing
+  // powers of two, e.g. 100 = 64 + 32 + 4
+  for (int64_t batch_start = 0; batch_start < batch_size;) {
+    const int64_t remaining = batch_size - batch_start;
+    const int64_t chunk = bucket_batches
+        ? int64_t{1} << llvm::Log2_64(static_cast<uint64_t>(remaining))
+        : remaining;
+    signal_size[0] = chunk;
+
+    // The plan is checked out of the cache for the exclusive use of this call
+    CuFFTParams Params(input.strides(), out.strides(), signal_size, fft_type, value_type);
+    auto config = plan_cache.checkout(Params);
+    auto & plan = config->plan();
+
+    if (config->should_clone_input() && !input_cloned) {
+      input = input.clone(MemoryFormat::Contiguous);
+      input_cloned = true;
     }
-  }
-
-  if (config == nullptr) {
-    uncached_plan.emplace(Params);
-    config = &uncached_plan.value();
-  }
 
-  auto & plan = config->plan();
-
-  if (config->should_clone_input()) {
-    input = input.clone(MemoryFormat::Contiguous);
+    // prepare cufft for execution
+    CUFFT_CHECK(cufftSetStream(plan, stream));
+    auto workspace = at::empty({ config->workspace_size() }, at::device(at::kCUDA).dtype(at::kByte));
+    CUFFT_CHECK(cufftSetWorkArea(plan, workspace.data_ptr()));
+
+    // execute transform plan
+    auto in_data = static_cast<char*>(input.data_ptr()) +
+        batch_start * input.strides()[0] * input.element_size();
+    auto out_data = static_cast<char*>(out.data_ptr()) +
+        batch_start * out.strides()[0] * out.element_size();
+    exec_cufft_plan(*config, in_data, out_data, forward);
+    batch_start += chunk;
   }
 
-  // prepare cufft for execution
-  CUFFT_CHECK(cufftSetStream(plan, at::cuda::getCurrentCUDAStream()));
-  auto workspace = at::empty({ config->workspace_size() }, at::device(at::kCUDA).dtype(at::kByte));
-  CUFFT_CHECK(cufftSetWorkArea(plan, workspace.data_ptr()));
-
-  // execute transform plan
-  exec_cufft_plan(*config, input.data_ptr(), out.data_ptr(), forward);
-
   // Inplace reshaping to original batch shape and inverting the dimension permutation
   DimVector out_strides(ndim);
   int64_t batch_numel = 1;
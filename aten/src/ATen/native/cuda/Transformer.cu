@@ -0,0 +1,558 @@
+#include <ATen/native/Transformer.h>
+
+#include <ATen/ATen.h>
+#include <ATen/AccumulateType.h>
+#include <ATen/CUDAGeneratorImpl.h>
+#include <ATen/Dispatch.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDAGraphsUtils.cuh>
+#include <ATen/cuda/DeviceUtils.cuh>
+#include <c10/cuda/CUDAMathCompat.h>
+
+#include <cmath>
+#include <limits>
+
+namespace at { namespace native {
+
+namespace {
+
+constexpr int kNumThreads = 256;
+
+// Reduces val over the block with op; all the threads get the result.
+// shared holds a value per warp.
+template <typename T, typename Op>
+__device__ __forceinline__ T block_reduce(T val, T* shared, const Op& op) {
+  const int lid = threadIdx.x % C10_WARP_SIZE;
+  const int wid = threadIdx.x / C10_WARP_SIZE;
+#pragma unroll
+  for (int offset = (C10_WARP_SIZE >> 1); offset > 0; offset >>= 1) {
+    val = op(val, WARP_SHFL_DOWN(val, offset));
+  }
+  __syncthreads();
+  if (lid == 0) {
+    shared[wid] = val;
+  }
+  __syncthreads();
+  val = shared[0];
+  for (int w = 1; w < blockDim.x / C10_WARP_SIZE; w++) {
+    val = op(val, shared[w]);
+  }
+  return val;
+}
+
+template <typename scalar_t, typename accscalar_t>
+__global__ void transform_bias_rescale_qkv_cuda_kernel(
+    const scalar_t* qkv,
+    const scalar_t* qkv_bias,
+    scalar_t* q,
+    scalar_t* k,
+    scalar_t* v,
+    int64_t S,
+    int64_t num_heads,
+    int64_t D,
+    accscalar_t scale) {
+  // One block per (b, s) token
+  const int64_t t = blockIdx.x;
+  const int64_t b = t / S;
+  const int64_t s = t % S;
+  const int64_t E = num_heads * D;
+  scalar_t* outs[3] = {q, k, v};
+  for (int64_t c = threadIdx.x; c < 3 * E; c += blockDim.x) {
+    const int64_t part = c / E;
+    const int64_t h = (c % E) / D;
+    const int64_t d = c % D;
+    accscalar_t x = static_cast<accscalar_t>(qkv[t * 3 * E + c]) +
+        static_cast<accscalar_t>(qkv_bias[c]);
+    if (part == 0) {
+      x *= scale;
+    }
+    outs[part][((b * num_heads + h) * S + s) * D + d] = static_cast<scalar_t>(x);
+  }
+}
+
+void transform_bias_rescale_qkv_cuda(
+    const Tensor& qkv,
+    const Tensor& qkv_bias,
+    int64_t num_heads,
+    const Tensor& q,
+    const Tensor& k,
+    const Tensor& v) {
+  const int64_t B = qkv.size(0);
+  const int64_t S = qkv.size(1);
+  const int64_t D = qkv.size(2) / 3 / num_heads;
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, qkv.scalar_type(), "transform_bias_rescale_qkv_cuda", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    transform_bias_rescale_qkv_cuda_kernel<scalar_t, accscalar_t>
+        <<<B * S, kNumThreads, 0, at::cuda::getCurrentCUDAStream()>>>(
+            qkv.data_ptr<scalar_t>(),
+            qkv_bias.data_ptr<scalar_t>(),
+            q.data_ptr<scalar_t>(),
+            k.data_ptr<scalar_t>(),
+            v.data_ptr<scalar_t>(),
+            S,
+            num_heads,
+            D,
+            static_cast<accscalar_t>(1.0 / std::sqrt(static_cast<double>(D))));
+    C10_CUDA_KERNEL_LAUNCH_CHECK();
+  });
+}
+
+// One block per row of S scores
+template <typename scalar_t, typename accscalar_t>
+__global__ void masked_softmax_cuda_kernel(
+    const scalar_t* self,
+    const bool* mask,
+    scalar_t* result,
+    int64_t S,
+    int64_t rows_per_batch) {
+  __shared__ accscalar_t shared[kNumThreads / C10_WARP_SIZE];
+  const int64_t row = blockIdx.x;
+  const scalar_t* in = self + row * S;
+  scalar_t* out = result + row * S;
+  const bool* row_mask = mask ? mask + (row / rows_per_batch) * S : nullptr;
+  constexpr accscalar_t kNegInf = -std::numeric_limits<accscalar_t>::infinity();
+
+  accscalar_t max = kNegInf;
+  for (int64_t j = threadIdx.x; j < S; j += blockDim.x) {
+    if (!row_mask || !row_mask[j]) {
+      max = c10::cuda::compat::max(max, static_cast<accscalar_t>(in[j]));
+    }
+  }
+  max = block_reduce(max, shared, [](accscalar_t a, accscalar_t b) {
+    return c10::cuda::compat::max(a, b);
+  });
+  if (max == kNegInf) {
+    for (int64_t j = threadIdx.x; j < S; j += blockDim.x) {
+      out[j] = scalar_t(0);
+    }
+    return;
+  }
+
+  accscalar_t sum = 0;
+  for (int64_t j = threadIdx.x; j < S; j += blockDim.x) {
+    if (!row_mask || !row_mask[j]) {
+      sum += c10::cuda::compat::exp(static_cast<accscalar_t>(in[j]) - max);
+    }
+  }
+  sum = block_reduce(sum, shared, [](accscalar_t a, accscalar_t b) { return a + b; });
+
+  const accscalar_t inv_sum = accscalar_t(1) / sum;
+  for (int64_t j = threadIdx.x; j < S; j += blockDim.x) {
+    out[j] = (row_mask && row_mask[j])
+        ? scalar_t(0)
+        : static_cast<scalar_t>(
+              c10::cuda::compat::exp(static_cast<accscalar_t>(in[j]) - max) * inv_sum);
+  }
+}
+
+void masked_softmax_cuda(
+    const Tensor& self,
+    const Tensor& mask,
+    const Tensor& result) {
+  const int64_t S = self.size(3);
+  const int64_t rows = self.numel() / S;
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, self.scalar_type(), "masked_softmax_cuda", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    masked_softmax_cuda_kernel<scalar_t, accscalar_t>
+        <<<rows, kNumThreads, 0, at::cuda::getCurrentCUDAStream()>>>(
+            self.data_ptr<scalar_t>(),
+            mask.defined() ? mask.data_ptr<bool>() : nullptr,
+            result.data_ptr<scalar_t>(),
+            S,
+            self.size(1) * self.size(2));
+    C10_CUDA_KERNEL_LAUNCH_CHECK();
+  });
+}
+
+// One block per row of N; the sum self + bias + residual is recomputed by the
+// normalization pass rather than stored in the result's precision
+template <typename scalar_t, typename accscalar_t>
+__global__ void bias_residual_layer_norm_cuda_kernel(
+    const scalar_t* self,
+    const scalar_t* bias,
+    const scalar_t* residual,
+    const scalar_t* weight,
+    const scalar_t* ln_bias,
+    accscalar_t eps,
+    scalar_t* result,
+    int64_t N) {
+  __shared__ accscalar_t shared[kNumThreads / C10_WARP_SIZE];
+  const int64_t i = blockIdx.x;
+  auto x = [&](int64_t j) {
+    return static_cast<accscalar_t>(self[i * N + j]) +
+        static_cast<accscalar_t>(bias[j]) +
+        static_cast<accscalar_t>(residual[i * N + j]);
+  };
+  auto add = [](accscalar_t a, accscalar_t b) { return a + b; };
+
+  accscalar_t sum = 0;
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
+    sum += x(j);
+  }
+  const accscalar_t mean = block_reduce(sum, shared, add) / N;
+  accscalar_t sum_sq = 0;
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
+    const accscalar_t centered = x(j) - mean;
+    sum_sq += centered * centered;
+  }
+  const accscalar_t rstd =
+      c10::cuda::compat::rsqrt(block_reduce(sum_sq, shared, add) / N + eps);
+
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x) {
+    result[i * N + j] = static_cast<scalar_t>(
+        (x(j) - mean) * rstd * static_cast<accscalar_t>(weight[j]) +
+        static_cast<accscalar_t>(ln_bias[j]));
+  }
+}
+
+void bias_residual_layer_norm_cuda(
+    const Tensor& self,
+    const Tensor& bias,
+    const Tensor& residual,
+    const Tensor& weight,
+    const Tensor& ln_bias,
+    double eps,
+    const Tensor& result) {
+  const int64_t M = self.size(0);
+  const int64_t N = self.size(1);
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, self.scalar_type(), "bias_residual_layer_norm_cuda", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    bias_residual_layer_norm_cuda_kernel<scalar_t, accscalar_t>
+        <<<M, kNumThreads, 0, at::cuda::getCurrentCUDAStream()>>>(
+            self.data_ptr<scalar_t>(),
+            bias.data_ptr<scalar_t>(),
+            residual.data_ptr<scalar_t>(),
+            weight.data_ptr<scalar_t>(),
+            ln_bias.data_ptr<scalar_t>(),
+            static_cast<accscalar_t>(eps),
+            result.data_ptr<scalar_t>(),
+            N);
+    C10_CUDA_KERNEL_LAUNCH_CHECK();
+  });
+}
+
+// The elements of a row a thread keeps in registers across the passes of
+// the fused dropout kernels; the elements past them have their dropout
+// mask regenerated by each pass
+constexpr int kFusedDropoutCachedItems = 4;
+
+// dropout(self) + residual at element e, with keep_prob == 1 for no dropout
+template <typename scalar_t, typename accscalar_t>
+__device__ __forceinline__ accscalar_t fused_dropout_add(
+    const scalar_t* self,
+    const scalar_t* residual,
+    int64_t e,
+    uint64_t seed,
+    uint64_t word,
+    accscalar_t keep_prob,
+    accscalar_t scale,
+    bool* keep) {
+  accscalar_t x = static_cast<accscalar_t>(self[e]);
+  *keep = true;
+  if (keep_prob < 1) {
+    FusedDropoutMask mask(seed, word, e, static_cast<float>(keep_prob));
+    *keep = mask.next();
+    x = *keep ? x * scale : accscalar_t(0);
+  }
+  return x + static_cast<accscalar_t>(residual[e]);
+}
+
+// One block per row of N. Block 0 also stores the unpacked Philox seed and
+// offset, which are only known on the device under graph capture.
+template <typename scalar_t, typename accscalar_t>
+__global__ void fused_dropout_add_layer_norm_cuda_kernel(
+    const scalar_t* self,
+    const scalar_t* residual,
+    const scalar_t* weight,
+    const scalar_t* bias,
+    accscalar_t keep_prob,
+    accscalar_t scale,
+    accscalar_t eps,
+    PhiloxCudaState philox_args,
+    scalar_t* result,
+    accscalar_t* mean,
+    accscalar_t* rstd,
+    int64_t* rng_state,
+    int64_t N) {
+  __shared__ accscalar_t shared[kNumThreads / C10_WARP_SIZE];
+  const int64_t i = blockIdx.x;
+  uint64_t seed = 0;
+  uint64_t word = 0;
+  if (keep_prob < 1) {
+    auto seeds = at::cuda::philox::unpack(philox_args);
+    seed = std::get<0>(seeds);
+    word = std::get<1>(seeds);
+    if (i == 0 && threadIdx.x == 0) {
+      rng_state[0] = static_cast<int64_t>(seed);
+      rng_state[1] = static_cast<int64_t>(word);
+    }
+  }
+  accscalar_t cached[kFusedDropoutCachedItems];
+  auto x = [&](int64_t j, int k) {
+    if (k < kFusedDropoutCachedItems) {
+      return cached[k];
+    }
+    bool keep;
+    return fused_dropout_add(self, residual, i * N + j, seed, word, keep_prob, scale, &keep);
+  };
+  auto add = [](accscalar_t a, accscalar_t b) { return a + b; };
+
+  accscalar_t sum = 0;
+  int k = 0;
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x, k++) {
+    bool keep;
+    const accscalar_t v =
+        fused_dropout_add(self, residual, i * N + j, seed, word, keep_prob, scale, &keep);
+    if (k < kFusedDropoutCachedItems) {
+      cached[k] = v;
+    }
+    sum += v;
+  }
+  const accscalar_t row_mean = block_reduce(sum, shared, add) / N;
+  accscalar_t sum_sq = 0;
+  k = 0;
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x, k++) {
+    const accscalar_t centered = x(j, k) - row_mean;
+    sum_sq += centered * centered;
+  }
+  const accscalar_t row_rstd =
+      c10::cuda::compat::rsqrt(block_reduce(sum_sq, shared, add) / N + eps);
+  if (threadIdx.x == 0) {
+    mean[i] = row_mean;
+    rstd[i] = row_rstd;
+  }
+
+  k = 0;
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x, k++) {
+    result[i * N + j] = static_cast<scalar_t>(
+        (x(j, k) - row_mean) * row_rstd * static_cast<accscalar_t>(weight[j]) +
+        static_cast<accscalar_t>(bias[j]));
+  }
+}
+
+void fused_dropout_add_layer_norm_cuda(
+    const Tensor& self,
+    const Tensor& residual,
+    const Tensor& weight,
+    const Tensor& bias,
+    double p,
+    double eps,
+    c10::optional<Generator> gen,
+    const Tensor& result,
+    const Tensor& mean,
+    const Tensor& rstd,
+    const Tensor& rng_state) {
+  const int64_t M = self.size(0);
+  const int64_t N = self.size(1);
+  PhiloxCudaState rng_engine_inputs;
+  if (p > 0) {
+    auto generator = get_generator_or_default<CUDAGeneratorImpl>(gen, cuda::detail::getDefaultCUDAGenerator());
+    // See Note [Acquire lock when using random generators]
+    std::lock_guard<std::mutex> lock(generator->mutex_);
+    // Each element takes a 32 bit word of subsequence 0; rounded like the
+    // increments of the curand based kernels
+    rng_engine_inputs = generator->philox_cuda_state(((M * N + 3) / 4) * 4);
+  }
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, self.scalar_type(), "fused_dropout_add_layer_norm_cuda", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    fused_dropout_add_layer_norm_cuda_kernel<scalar_t, accscalar_t>
+        <<<M, kNumThreads, 0, at::cuda::getCurrentCUDAStream()>>>(
+            self.data_ptr<scalar_t>(),
+            residual.data_ptr<scalar_t>(),
+            weight.data_ptr<scalar_t>(),
+            bias.data_ptr<scalar_t>(),
+            static_cast<accscalar_t>(1 - p),
+            static_cast<accscalar_t>(p < 1 ? 1 / (1 - p) : 0),
+            static_cast<accscalar_t>(eps),
+            rng_engine_inputs,
+            result.data_ptr<scalar_t>(),
+            mean.data_ptr<accscalar_t>(),
+            rstd.data_ptr<accscalar_t>(),
+            rng_state.data_ptr<int64_t>(),
+            N);
+    C10_CUDA_KERNEL_LAUNCH_CHECK();
+  });
+}
+
+// One block per row of N, computing grad_residual = dx and grad_self, see
+// fused_dropout_add_layer_norm_backward_kernel on CPU
+template <typename scalar_t, typename accscalar_t>
+__global__ void fused_dropout_add_layer_norm_backward_cuda_kernel(
+    const scalar_t* grad_out,
+    const scalar_t* self,
+    const scalar_t* residual,
+    const scalar_t* weight,
+    const accscalar_t* mean,
+    const accscalar_t* rstd,
+    const int64_t* rng_state,
+    accscalar_t keep_prob,
+    accscalar_t scale,
+    scalar_t* grad_self,
+    scalar_t* grad_residual,
+    int64_t N) {
+  __shared__ accscalar_t shared[kNumThreads / C10_WARP_SIZE];
+  const int64_t i = blockIdx.x;
+  const uint64_t seed = keep_prob < 1 ? static_cast<uint64_t>(rng_state[0]) : 0;
+  const uint64_t word = keep_prob < 1 ? static_cast<uint64_t>(rng_state[1]) : 0;
+  const accscalar_t row_mean = mean[i];
+  const accscalar_t row_rstd = rstd[i];
+  accscalar_t cached_x_hat[kFusedDropoutCachedItems];
+  bool cached_keep[kFusedDropoutCachedItems];
+  auto x_hat = [&](int64_t j, int k, bool* keep) {
+    if (k < kFusedDropoutCachedItems) {
+      *keep = cached_keep[k];
+      return cached_x_hat[k];
+    }
+    return (fused_dropout_add(self, residual, i * N + j, seed, word, keep_prob, scale, keep) -
+            row_mean) * row_rstd;
+  };
+  auto add = [](accscalar_t a, accscalar_t b) { return a + b; };
+
+  accscalar_t sum_dy_gamma = 0;
+  accscalar_t sum_dy_gamma_x_hat = 0;
+  int k = 0;
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x, k++) {
+    bool keep;
+    const accscalar_t v = (fused_dropout_add(
+        self, residual, i * N + j, seed, word, keep_prob, scale, &keep) - row_mean) * row_rstd;
+    if (k < kFusedDropoutCachedItems) {
+      cached_x_hat[k] = v;
+      cached_keep[k] = keep;
+    }
+    const accscalar_t dy_gamma = static_cast<accscalar_t>(grad_out[i * N + j]) *
+        static_cast<accscalar_t>(weight[j]);
+    sum_dy_gamma += dy_gamma;
+    sum_dy_gamma_x_hat += dy_gamma * v;
+  }
+  const accscalar_t a = block_reduce(sum_dy_gamma, shared, add) / N;
+  const accscalar_t b = block_reduce(sum_dy_gamma_x_hat, shared, add) / N;
+
+  k = 0;
+  for (int64_t j = threadIdx.x; j < N; j += blockDim.x, k++) {
+    bool keep;
+    const accscalar_t v = x_hat(j, k, &keep);
+    const accscalar_t dy_gamma = static_cast<accscalar_t>(grad_out[i * N + j]) *
+        static_cast<accscalar_t>(weight[j]);
+    const accscalar_t dx = row_rstd * (dy_gamma - a - v * b);
+    grad_residual[i * N + j] = static_cast<scalar_t>(dx);
+    grad_self[i * N + j] = static_cast<scalar_t>(keep ? dx * scale : accscalar_t(0));
+  }
+}
+
+// Reduces dgamma and dbeta over the M rows: the block's 32 columns are
+// split across its kGammaBetaRows rows of threads, then summed in shared
+// memory
+constexpr int kGammaBetaRows = 8;
+
+template <typename scalar_t, typename accscalar_t>
+__global__ void fused_dropout_add_layer_norm_gamma_beta_backward_cuda_kernel(
+    const scalar_t* grad_out,
+    const scalar_t* self,
+    const scalar_t* residual,
+    const accscalar_t* mean,
+    const accscalar_t* rstd,
+    const int64_t* rng_state,
+    accscalar_t keep_prob,
+    accscalar_t scale,
+    scalar_t* grad_weight,
+    scalar_t* grad_bias,
+    int64_t M,
+    int64_t N) {
+  __shared__ accscalar_t dgamma_shared[kGammaBetaRows][C10_WARP_SIZE + 1];
+  __shared__ accscalar_t dbeta_shared[kGammaBetaRows][C10_WARP_SIZE + 1];
+  const int64_t j = blockIdx.x * C10_WARP_SIZE + threadIdx.x;
+  const uint64_t seed = keep_prob < 1 ? static_cast<uint64_t>(rng_state[0]) : 0;
+  const uint64_t word = keep_prob < 1 ? static_cast<uint64_t>(rng_state[1]) : 0;
+  accscalar_t dgamma = 0;
+  accscalar_t dbeta = 0;
+  if (j < N) {
+    for (int64_t i = threadIdx.y; i < M; i += kGammaBetaRows) {
+      bool keep;
+      const accscalar_t x_hat = (fused_dropout_add(
+          self, residual, i * N + j, seed, word, keep_prob, scale, &keep) - mean[i]) * rstd[i];
+      const accscalar_t dy = static_cast<accscalar_t>(grad_out[i * N + j]);
+      dgamma += dy * x_hat;
+      dbeta += dy;
+    }
+  }
+  dgamma_shared[threadIdx.y][threadIdx.x] = dgamma;
+  dbeta_shared[threadIdx.y][threadIdx.x] = dbeta;
+  __syncthreads();
+  if (threadIdx.y == 0 && j < N) {
+    for (int r = 1; r < kGammaBetaRows; r++) {
+      dgamma += dgamma_shared[r][threadIdx.x];
+      dbeta += dbeta_shared[r][threadIdx.x];
+    }
+    if (grad_weight) {
+      grad_weight[j] = static_cast<scalar_t>(dgamma);
+    }
+    if (grad_bias) {
+      grad_bias[j] = static_cast<scalar_t>(dbeta);
+    }
+  }
+}
+
+void fused_dropout_add_layer_norm_backward_cuda(
+    const Tensor& grad_out,
+    const Tensor& self,
+    const Tensor& residual,
+    const Tensor& weight,
+    const Tensor& mean,
+    const Tensor& rstd,
+    const Tensor& rng_state,
+    double p,
+    const Tensor& grad_self,
+    const Tensor& grad_residual,
+    const Tensor& grad_weight,
+    const Tensor& grad_bias) {
+  const int64_t M = self.size(0);
+  const int64_t N = self.size(1);
+  AT_DISPATCH_FLOATING_TYPES_AND2(kHalf, kBFloat16, self.scalar_type(), "fused_dropout_add_layer_norm_backward_cuda", [&] {
+    using accscalar_t = acc_type<scalar_t, true>;
+    const auto keep_prob = static_cast<accscalar_t>(1 - p);
+    const auto scale = static_cast<accscalar_t>(p < 1 ? 1 / (1 - p) : 0);
+    auto stream = at::cuda::getCurrentCUDAStream();
+    fused_dropout_add_layer_norm_backward_cuda_kernel<scalar_t, accscalar_t>
+        <<<M, kNumThreads, 0, stream>>>(
+            grad_out.data_ptr<scalar_t>(),
+            self.data_ptr<scalar_t>(),
+            residual.data_ptr<scalar_t>(),
+            weight.data_ptr<scalar_t>(),
+            mean.data_ptr<accscalar_t>(),
+            rstd.data_ptr<accscalar_t>(),
+            rng_state.data_ptr<int64_t>(),
+            keep_prob,
+            scale,
+            grad_self.data_ptr<scalar_t>(),
+            grad_residual.data_ptr<scalar_t>(),
+            N);
+    C10_CUDA_KERNEL_LAUNCH_CHECK();
+    if (grad_weight.defined() || grad_bias.defined()) {
+      fused_dropout_add_layer_norm_gamma_beta_backward_cuda_kernel<scalar_t, accscalar_t>
+          <<<(N + C10_WARP_SIZE - 1) / C10_WARP_SIZE, dim3(C10_WARP_SIZE, kGammaBetaRows), 0, stream>>>(
+              grad_out.data_ptr<scalar_t>(),
+              self.data_ptr<scalar_t>(),
+              residual.data_ptr<scalar_t>(),
+              mean.data_ptr<accscalar_t>(),
+              rstd.data_ptr<accscalar_t>(),
+              rng_state.data_ptr<int64_t>(),
+              keep_prob,
+              scale,
+              grad_weight.defined() ? grad_weight.data_ptr<scalar_t>() : nullptr,
+              grad_bias.defined() ? grad_bias.data_ptr<scalar_t>() : nullptr,
+              M,
+              N);
+      C10_CUDA_KERNEL_LAUNCH_CHECK();
+    }
+  });
+}
+
+} // namespace
+
+REGISTER_DISPATCH(transform_bias_rescale_qkv_stub, &transform_bias_rescale_qkv_cuda);
+REGISTER_DISPATCH(masked_softmax_stub, &masked_softmax_cuda);
+REGISTER_DISPATCH(bias_residual_layer_norm_stub, &bias_residual_layer_norm_cuda);
+REGISTER_DISPATCH(fused_dropout_add_layer_norm_stub, &fused_dropout_add_layer_norm_cuda);
+REGISTER_DISPATCH(fused_dropout_add_layer_norm_backward_stub, &fused_dropout_add_layer_norm_backward_cuda);
+
+}} // namespace at::native
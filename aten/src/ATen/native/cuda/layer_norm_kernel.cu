@@ -6,6 +6,7 @@
 #include <ATen/NativeFunctions.h>
 #include <ATen/cuda/CUDAApplyUtils.cuh>
 #include <ATen/cuda/detail/IndexUtils.cuh>
+#include <ATen/native/cuda/MemoryAccess.cuh>
 #include <ATen/native/cuda/block_reduce.cuh>
 #include <THC/THCDeviceUtils.cuh>
 
@@ -19,6 +20,11 @@ namespace {
 constexpr int kCUDANumThreads = 256;
 constexpr int kColwiseReduceTileSize = 32;
 
+// The persistent kernels hold their row in registers, in up to
+// kPersistentMaxVecs vectors of kPersistentVecSize elements a thread
+constexpr int kPersistentVecSize = 4;
+constexpr int kPersistentMaxVecs = 4;
+
 template <typename T>
 __global__ void RowwiseMomentsCUDAKernel(
     int64_t N,
@@ -71,6 +77,97 @@ __global__ void LayerNormForwardCUDAKernel(
   }
 }
 
+// One block per row, which is read once: the moments are computed from the
+// registers, exactly in two passes, and Y is written from them. Takes rows of
+// a multiple of kPersistentVecSize elements with aligned X, gamma, beta and Y.
+template <typename T, int kVecs>
+__global__ void C10_LAUNCH_BOUNDS_1(cuda_utils::kCUDABlockReduceNumThreads)
+LayerNormForwardPersistentCUDAKernel(
+    int64_t N,
+    T eps,
+    const T* X,
+    const T* gamma,
+    const T* beta,
+    T* mean,
+    T* rstd,
+    T* Y) {
+  using T_ACC = acc_type<T, true>;
+  using vec_t = memory::aligned_vector<T, kPersistentVecSize>;
+  __shared__ T_ACC shared[C10_WARP_SIZE];
+  __shared__ T_ACC mean_shared;
+  __shared__ T_ACC rstd_shared;
+  const int64_t i = blockIdx.x;
+  const int num_vecs = N / kPersistentVecSize;
+  const T_ACC scale = T_ACC(1) / static_cast<T_ACC>(N);
+
+  vec_t x_v[kVecs];
+  T_ACC sum = 0;
+#pragma unroll
+  for (int k = 0; k < kVecs; ++k) {
+    const int v = k * blockDim.x + threadIdx.x;
+    if (v < num_vecs) {
+      x_v[k] = reinterpret_cast<const vec_t*>(X + i * N)[v];
+#pragma unroll
+      for (int j = 0; j < kPersistentVecSize; ++j) {
+        sum += static_cast<T_ACC>(x_v[k].val[j]);
+      }
+    }
+  }
+  sum = cuda_utils::BlockReduceSum<T_ACC>(sum, shared);
+  if (threadIdx.x == 0) {
+    mean_shared = sum * scale;
+  }
+  __syncthreads();
+  const T_ACC mean_v = mean_shared;
+
+  T_ACC sum_sq = 0;
+#pragma unroll
+  for (int k = 0; k < kVecs; ++k) {
+    if (k * blockDim.x + threadIdx.x < num_vecs) {
+#pragma unroll
+      for (int j = 0; j < kPersistentVecSize; ++j) {
+        const T_ACC centered = static_cast<T_ACC>(x_v[k].val[j]) - mean_v;
+        sum_sq += centered * centered;
+      }
+    }
+  }
+  sum_sq = cuda_utils::BlockReduceSum<T_ACC>(sum_sq, shared);
+  if (threadIdx.x == 0) {
+    rstd_shared =
+        c10::cuda::compat::rsqrt(sum_sq * scale + static_cast<T_ACC>(eps));
+    mean[i] = mean_v;
+    rstd[i] = rstd_shared;
+  }
+  __syncthreads();
+  const T_ACC rstd_v = rstd_shared;
+
+#pragma unroll
+  for (int k = 0; k < kVecs; ++k) {
+    const int v = k * blockDim.x + threadIdx.x;
+    if (v < num_vecs) {
+      vec_t gamma_v;
+      vec_t beta_v;
+      if (gamma != nullptr) {
+        gamma_v = reinterpret_cast<const vec_t*>(gamma)[v];
+      }
+      if (beta != nullptr) {
+        beta_v = reinterpret_cast<const vec_t*>(beta)[v];
+      }
+      vec_t y_v;
+#pragma unroll
+      for (int j = 0; j < kPersistentVecSize; ++j) {
+        const T_ACC g =
+            gamma == nullptr ? T_ACC(1) : static_cast<T_ACC>(gamma_v.val[j]);
+        const T_ACC b =
+            beta == nullptr ? T_ACC(0) : static_cast<T_ACC>(beta_v.val[j]);
+        y_v.val[j] =
+            (static_cast<T_ACC>(x_v[k].val[j]) - mean_v) * rstd_v * g + b;
+      }
+      reinterpret_cast<vec_t*>(Y + i * N)[v] = y_v;
+    }
+  }
+}
+
 template <typename T>
 __global__ void ComputeInternalGradientsCUDAKernel(
     int64_t N,
@@ -147,6 +244,87 @@ __global__ void LayerNormBackwardCUDAKenrel(
   }
 }
 
+// The fusion of ComputeInternalGradientsCUDAKernel,
+// ComputeGradientFusedParamsCUDAKernel and LayerNormBackwardCUDAKenrel for
+// the rows of LayerNormForwardPersistentCUDAKernel: dY and X are read once.
+template <typename T, int kVecs>
+__global__ void C10_LAUNCH_BOUNDS_1(cuda_utils::kCUDABlockReduceNumThreads)
+LayerNormBackwardPersistentCUDAKernel(
+    int64_t N,
+    const T* dY,
+    const T* X,
+    const T* mean,
+    const T* rstd,
+    const T* gamma,
+    T* dX) {
+  using T_ACC = acc_type<T, true>;
+  using vec_t = memory::aligned_vector<T, kPersistentVecSize>;
+  __shared__ T_ACC ds_shared[C10_WARP_SIZE];
+  __shared__ T_ACC db_shared[C10_WARP_SIZE];
+  __shared__ T_ACC c1_shared;
+  __shared__ T_ACC c2_shared;
+  const int64_t i = blockIdx.x;
+  const int num_vecs = N / kPersistentVecSize;
+
+  vec_t dy_v[kVecs];
+  vec_t x_v[kVecs];
+  T_ACC ds = 0;
+  T_ACC db = 0;
+#pragma unroll
+  for (int k = 0; k < kVecs; ++k) {
+    const int v = k * blockDim.x + threadIdx.x;
+    if (v < num_vecs) {
+      dy_v[k] = reinterpret_cast<const vec_t*>(dY + i * N)[v];
+      x_v[k] = reinterpret_cast<const vec_t*>(X + i * N)[v];
+      vec_t gamma_v;
+      if (gamma != nullptr) {
+        gamma_v = reinterpret_cast<const vec_t*>(gamma)[v];
+      }
+#pragma unroll
+      for (int j = 0; j < kPersistentVecSize; ++j) {
+        const T_ACC g =
+            gamma == nullptr ? T_ACC(1) : static_cast<T_ACC>(gamma_v.val[j]);
+        const T_ACC dy_g = static_cast<T_ACC>(dy_v[k].val[j]) * g;
+        ds += dy_g * static_cast<T_ACC>(x_v[k].val[j]);
+        db += dy_g;
+      }
+    }
+  }
+  ds = cuda_utils::BlockReduceSum<T_ACC>(ds, ds_shared);
+  db = cuda_utils::BlockReduceSum<T_ACC>(db, db_shared);
+  const T_ACC mean_v = static_cast<T_ACC>(mean[i]);
+  const T_ACC rstd_v = static_cast<T_ACC>(rstd[i]);
+  if (threadIdx.x == 0) {
+    const T_ACC s = T_ACC(1) / static_cast<T_ACC>(N);
+    const T_ACC c1 = (db * mean_v - ds) * rstd_v * rstd_v * rstd_v * s;
+    c1_shared = c1;
+    c2_shared = -(c1 * mean_v + db * rstd_v * s);
+  }
+  __syncthreads();
+  const T_ACC c1 = c1_shared;
+  const T_ACC c2 = c2_shared;
+
+#pragma unroll
+  for (int k = 0; k < kVecs; ++k) {
+    const int v = k * blockDim.x + threadIdx.x;
+    if (v < num_vecs) {
+      vec_t gamma_v;
+      if (gamma != nullptr) {
+        gamma_v = reinterpret_cast<const vec_t*>(gamma)[v];
+      }
+      vec_t dx_v;
+#pragma unroll
+      for (int j = 0; j < kPersistentVecSize; ++j) {
+        const T_ACC g =
+            gamma == nullptr ? T_ACC(1) : static_cast<T_ACC>(gamma_v.val[j]);
+        dx_v.val[j] = rstd_v * static_cast<T_ACC>(dy_v[k].val[j]) * g +
+            c1 * static_cast<T_ACC>(x_v[k].val[j]) + c2;
+      }
+      reinterpret_cast<vec_t*>(dX + i * N)[v] = dx_v;
+    }
+  }
+}
+
 template <typename T>
 __global__ void GammaBetaBackwardSimpleCUDAKernel(
     int64_t M,
@@ -254,6 +432,38 @@ __global__ void GammaBetaBackwardCUDAKernel(
   }
 }
 
+// Whether the rows of N elements suit the persistent kernels, given the
+// pointers they access; sets the vectors a thread holds and the block size
+template <typename T>
+bool CanUsePersistentKernels(
+    int64_t N,
+    std::initializer_list<const T*> ptrs,
+    int* vecs,
+    int* num_threads) {
+  if (N % kPersistentVecSize != 0) {
+    return false;
+  }
+  for (const T* ptr : ptrs) {
+    if (ptr != nullptr &&
+        memory::can_vectorize_up_to<T>(
+            reinterpret_cast<char*>(const_cast<T*>(ptr))) <
+            kPersistentVecSize) {
+      return false;
+    }
+  }
+  const int64_t num_vecs = N / kPersistentVecSize;
+  for (int v = 1; v <= kPersistentMaxVecs; v *= 2) {
+    if (num_vecs <= v * cuda_utils::kCUDABlockReduceNumThreads) {
+      const int64_t threads = (num_vecs + v - 1) / v;
+      *vecs = v;
+      *num_threads =
+          (threads + C10_WARP_SIZE - 1) / C10_WARP_SIZE * C10_WARP_SIZE;
+      return true;
+    }
+  }
+  return false;
+}
+
 template <typename T>
 void LayerNormKernelImplInternal(
     const Tensor& X,
@@ -275,6 +485,33 @@ void LayerNormKernelImplInternal(
   T* mean_data = mean->data_ptr<T>();
   T* rstd_data = rstd->data_ptr<T>();
   cudaStream_t cuda_stream = at::cuda::getCurrentCUDAStream();
+  int vecs;
+  int num_threads;
+  if (CanUsePersistentKernels<T>(
+          N, {X_data, gamma_data, beta_data, Y_data}, &vecs, &num_threads)) {
+    switch (vecs) {
+      case 1:
+        LayerNormForwardPersistentCUDAKernel<T, 1>
+            <<<M, num_threads, 0, cuda_stream>>>(
+                N, eps, X_data, gamma_data, beta_data, mean_data, rstd_data,
+                Y_data);
+        break;
+      case 2:
+        LayerNormForwardPersistentCUDAKernel<T, 2>
+            <<<M, num_threads, 0, cuda_stream>>>(
+                N, eps, X_data, gamma_data, beta_data, mean_data, rstd_data,
+                Y_data);
+        break;
+      default:
+        LayerNormForwardPersistentCUDAKernel<T, kPersistentMaxVecs>
+            <<<M, num_threads, 0, cuda_stream>>>(
+                N, eps, X_data, gamma_data, beta_data, mean_data, rstd_data,
+                Y_data);
+        break;
+    }
+    C10_CUDA_KERNEL_LAUNCH_CHECK();
+    return;
+  }
   RowwiseMomentsCUDAKernel<T>
       <<<M, cuda_utils::kCUDABlockReduceNumThreads, 0, cuda_stream>>>(
           N, eps, X_data, mean_data, rstd_data);
@@ -327,7 +564,30 @@ void LayerNormBackwardKernelImplInternal(
       gamma.defined() ? gamma.template data_ptr<T>() : nullptr;
   T* dX_data = dX->defined() ? dX->template data_ptr<T>() : nullptr;
   cudaStream_t cuda_stream = at::cuda::getCurrentCUDAStream();
-  if (dX_data != nullptr) {
+  int vecs;
+  int num_threads;
+  if (dX_data != nullptr &&
+      CanUsePersistentKernels<T>(
+          N, {dY_data, X_data, gamma_data, dX_data}, &vecs, &num_threads)) {
+    switch (vecs) {
+      case 1:
+        LayerNormBackwardPersistentCUDAKernel<T, 1>
+            <<<M, num_threads, 0, cuda_stream>>>(
+                N, dY_data, X_data, mean_data, rstd_data, gamma_data, dX_data);
+        break;
+      case 2:
+        LayerNormBackwardPersistentCUDAKernel<T, 2>
+            <<<M, num_threads, 0, cuda_stream>>>(
+                N, dY_data, X_data, mean_data, rstd_data, gamma_data, dX_data);
+        break;
+      default:
+        LayerNormBackwardPersistentCUDAKernel<T, kPersistentMaxVecs>
+            <<<M, num_threads, 0, cuda_stream>>>(
+                N, dY_data, X_data, mean_data, rstd_data, gamma_data, dX_data);
+        break;
+    }
+    C10_CUDA_KERNEL_LAUNCH_CHECK();
+  } else if (dX_data != nullptr) {
     const auto kAccType = (X.scalar_type() == kHalf || X.scalar_type() == kBFloat16) ? kFloat : X.scalar_type();
     Tensor ds = at::empty({M}, X.options().dtype(kAccType));
     Tensor db = at::empty({M}, X.options().dtype(kAccType));
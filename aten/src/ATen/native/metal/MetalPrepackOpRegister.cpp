@@ -69,6 +69,12 @@ TORCH_LIBRARY(metal_prepack, m) {
   m.def(
       "conv2d_run(Tensor X, "
       "__torch__.torch.classes.metal.Conv2dOpContext W_prepack) -> Tensor Y");
+  m.def(
+      "conv2d_hardswish_run(Tensor X, "
+      "__torch__.torch.classes.metal.Conv2dOpContext W_prepack) -> Tensor Y");
+  m.def(
+      "conv2d_add_run(Tensor X, Tensor Y, "
+      "__torch__.torch.classes.metal.Conv2dOpContext W_prepack) -> Tensor Z");
 }
 
 c10::intrusive_ptr<Conv2dOpContext> conv2d_prepack(
@@ -103,12 +109,40 @@ Tensor conv2d_prepack_run(
 #endif
 }
 
+Tensor conv2d_hardswish_prepack_run(
+    const Tensor& input,
+    const c10::intrusive_ptr<Conv2dOpContext>& op_context) {
+#if (C10_IOS || TARGET_OS_MAC)
+  return prepack::conv2d_hardswish(input, *op_context);
+#else
+  TORCH_CHECK(
+      false,
+      "conv2d_hardswish_prepack_run can only be invoked on iOS and MacOS");
+  return input;
+#endif
+}
+
+Tensor conv2d_add_prepack_run(
+    const Tensor& input,
+    const Tensor& other,
+    const c10::intrusive_ptr<Conv2dOpContext>& op_context) {
+#if (C10_IOS || TARGET_OS_MAC)
+  return prepack::conv2d_add(input, other, *op_context);
+#else
+  TORCH_CHECK(
+      false, "conv2d_add_prepack_run can only be invoked on iOS and MacOS");
+  return input;
+#endif
+}
+
 TORCH_LIBRARY_IMPL(metal_prepack, CPU, m) {
   m.impl("conv2d_prepack", TORCH_FN(conv2d_prepack));
 }
 
 TORCH_LIBRARY_IMPL(metal_prepack, Metal, m) {
   m.impl("conv2d_run", conv2d_prepack_run);
+  m.impl("conv2d_hardswish_run", conv2d_hardswish_prepack_run);
+  m.impl("conv2d_add_run", conv2d_add_prepack_run);
 }
 
 } // namespace metal
@@ -3,6 +3,31 @@
 #import <ATen/native/metal/mpscnn/MPSCNNContext.h>
 #import <ATen/native/metal/mpscnn/MPSImage+Tensor.h>
 
+#include <mutex>
+
+// The bounds of a clamp are read from a buffer, which is shared by every clamp
+// with the same bounds instead of being allocated each time one is encoded.
+// Buffers are never written to after they are created, so command buffers in
+// flight can read them while the next frame is encoded.
+static id<MTLBuffer> clampBuffer(float min, float max) {
+  static std::mutex mutex;
+  static NSMutableDictionary<NSString*, id<MTLBuffer>>* cache =
+      [NSMutableDictionary<NSString*, id<MTLBuffer>> new];
+  NSString* key = [NSString stringWithFormat:@"%a_%a", min, max];
+  std::lock_guard<std::mutex> g(mutex);
+  id<MTLBuffer> buffer = cache[key];
+  if (!buffer) {
+    buffer = [[MPSCNNContext sharedInstance].device
+        newBufferWithLength:2 * sizeof(fp16)
+                    options:MTLResourceOptionCPUCacheModeWriteCombined];
+    fp16* bufferPtr = (fp16*)[buffer contents];
+    bufferPtr[0] = min;
+    bufferPtr[1] = max;
+    cache[key] = buffer;
+  }
+  return buffer;
+}
+
 @implementation MPSCNNClampOp {
   MPSImage* _X;
   MPSImage* _Y;
@@ -34,13 +59,9 @@
   [encoder setComputePipelineState:state];
   [encoder setTexture:[_X texture] atIndex:0];
   [encoder setTexture:[_Y texture] atIndex:1];
-  id<MTLBuffer> clampBuffer = [[MPSCNNContext sharedInstance].device
-      newBufferWithLength:2 * sizeof(fp16)
-                  options:MTLResourceOptionCPUCacheModeWriteCombined];
-  fp16* clampBufferPtr = (fp16*)[clampBuffer contents];
-  clampBufferPtr[0] = _min.floatValue;
-  clampBufferPtr[1] = _max.floatValue;
-  [encoder setBuffer:clampBuffer offset:0 atIndex:0];
+  [encoder setBuffer:clampBuffer(_min.floatValue, _max.floatValue)
+              offset:0
+             atIndex:0];
   const auto& launchParams =
       at::native::metal::mpscnn::spatialPointwiseKernelLaunchParams(state, _Y);
   [encoder dispatchThreadgroups:launchParams.threadgroupsPerGrid
@@ -93,8 +93,13 @@
   for (auto i = 0; i < constants.count; ++i) {
     kernelStr += "_" + std::string([constants[i] stringValue].UTF8String);
   }
+  // states are cached under the specialized name, so that the function is
+  // only compiled the first time it is run with the given constants
+  NSString* specializedKernel =
+      [NSString stringWithCString:kernelStr.c_str()
+                         encoding:NSUTF8StringEncoding];
   std::lock_guard<std::mutex> g(_pipelineCacheMutex);
-  id<MTLComputePipelineState> state = _pipelineCache[kernel];
+  id<MTLComputePipelineState> state = _pipelineCache[specializedKernel];
   if (state) {
     return state;
   }
@@ -130,9 +135,7 @@
   TORCH_CHECK(func, errors.localizedDescription.UTF8String);
   state = [_device newComputePipelineStateWithFunction:func error:&errors];
   TORCH_CHECK(state, errors.localizedDescription.UTF8String);
-  kernel = [NSString stringWithCString:kernelStr.c_str()
-                              encoding:NSUTF8StringEncoding];
-  _pipelineCache[kernel] = state;
+  _pipelineCache[specializedKernel] = state;
   return state;
 }
 
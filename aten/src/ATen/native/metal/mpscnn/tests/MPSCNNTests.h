@@ -43,5 +43,7 @@ bool test_upsampling_nearest2d_vec();
 bool test_adaptive_avg_pool2d();
 bool test_hardtanh_();
 bool test_reshape();
+bool test_conv2d_hardswish();
+bool test_conv2d_add();
 
 #endif
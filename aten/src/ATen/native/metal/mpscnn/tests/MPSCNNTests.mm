@@ -775,3 +775,57 @@ bool test_hardtanh_() {
   return true;
 #endif
 }
+
+namespace {
+
+c10::intrusive_ptr<Conv2dOpContext> prepackConv2d(
+    const at::Tensor& W,
+    const at::Tensor& B) {
+  auto packedBuffer =
+      at::native::metal::permuteWeights(W.data_ptr<float>(), W.sizes().vec());
+  auto packedWeight = at::empty(W.sizes());
+  memcpy(
+      packedWeight.data_ptr(),
+      packedBuffer.data(),
+      packedBuffer.size() * sizeof(float));
+  return c10::make_intrusive<Conv2dOpContext>(
+      std::move(packedWeight),
+      c10::optional<at::Tensor>(B),
+      std::vector<int64_t>{1, 1},
+      std::vector<int64_t>{1, 1},
+      std::vector<int64_t>{1, 1},
+      1,
+      c10::nullopt,
+      c10::nullopt);
+}
+
+} // namespace
+
+bool test_conv2d_hardswish() {
+  __block std::vector<int64_t> x{1, 3, 24, 24};
+  return TEST(x, __PRETTY_FUNCTION__, ^bool {
+    auto options = at::TensorOptions(at::kCPU).dtype(at::kFloat);
+    auto X = at::rand(x, options);
+    auto W = at::rand({8, 3, 3, 3}, options) * 2 - 1;
+    auto B = at::rand({8}, options);
+    auto Y1 = at::hardswish(at::conv2d(X, W, B, {1, 1}, {1, 1}, {1, 1}, 1));
+    auto context = prepackConv2d(W, B);
+    auto Y2 = prepack::conv2d_hardswish(X.metal(), *context).cpu();
+    return almostEqual(Y1, Y2);
+  });
+}
+
+bool test_conv2d_add() {
+  __block std::vector<int64_t> x{1, 3, 24, 24};
+  return TEST(x, __PRETTY_FUNCTION__, ^bool {
+    auto options = at::TensorOptions(at::kCPU).dtype(at::kFloat);
+    auto X = at::rand(x, options);
+    auto W = at::rand({8, 3, 3, 3}, options);
+    auto B = at::rand({8}, options);
+    auto R = at::rand({1, 8, 24, 24}, options);
+    auto Y1 = at::conv2d(X, W, B, {1, 1}, {1, 1}, {1, 1}, 1) + R;
+    auto context = prepackConv2d(W, B);
+    auto Y2 = prepack::conv2d_add(X.metal(), R.metal(), *context).cpu();
+    return almostEqual(Y1, Y2);
+  });
+}
@@ -0,0 +1,19 @@
+#ifndef MetalBinaryElementwise_h
+#define MetalBinaryElementwise_h
+
+#include <ATen/Tensor.h>
+
+namespace at {
+namespace native {
+namespace metal {
+
+Tensor add_Tensor(
+    const Tensor& input1,
+    const Tensor& input2,
+    const Scalar& alpha);
+
+} // namespace metal
+} // namespace native
+} // namespace at
+
+#endif
@@ -6,6 +6,7 @@
 #import <ATen/native/metal/mpscnn/MPSCNNUtils.h>
 #import <ATen/native/metal/mpscnn/MPSImage+Tensor.h>
 #import <ATen/native/metal/mpscnn/MPSImageUtils.h>
+#import <ATen/native/metal/ops/MetalBinaryElementwise.h>
 
 #include <ATen/Tensor.h>
 #include <torch/library.h>
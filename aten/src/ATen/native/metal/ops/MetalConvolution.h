@@ -17,6 +17,13 @@ Tensor conv2d(
 
 namespace prepack {
 Tensor conv2d(const Tensor& input, Conv2dOpContext& context);
+// conv2d followed by hardswish_
+Tensor conv2d_hardswish(const Tensor& input, Conv2dOpContext& context);
+// conv2d followed by an add of other
+Tensor conv2d_add(
+    const Tensor& input,
+    const Tensor& other,
+    Conv2dOpContext& context);
 }
 
 } // namespace metal
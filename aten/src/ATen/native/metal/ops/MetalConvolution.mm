@@ -5,7 +5,9 @@
 #import <ATen/native/metal/mpscnn/MPSCNNConvOp.h>
 #import <ATen/native/metal/mpscnn/MPSImage+Tensor.h>
 #import <ATen/native/metal/mpscnn/MPSImageUtils.h>
+#import <ATen/native/metal/ops/MetalBinaryElementwise.h>
 #import <ATen/native/metal/ops/MetalConvolution.h>
+#import <ATen/native/metal/ops/MetalHardswish.h>
 
 #import <ATen/ATen.h>
 
@@ -97,6 +99,23 @@ Tensor conv2d(const Tensor& input, Conv2dOpContext& context) {
   return output;
 }
 
+// The fused ops below encode the kernels following the convolution into the
+// same command buffer directly, without creating an intermediate tensor or
+// going through the dispatcher and the interpreter for every op.
+
+Tensor conv2d_hardswish(const Tensor& input, Conv2dOpContext& context) {
+  Tensor output = conv2d(input, context);
+  return hardswish_(output);
+}
+
+Tensor conv2d_add(
+    const Tensor& input,
+    const Tensor& other,
+    Conv2dOpContext& context) {
+  Tensor output = conv2d(input, context);
+  return add_Tensor(output, other, 1);
+}
+
 } // namespace prepack
 
 TORCH_LIBRARY_IMPL(aten, Metal, m) {
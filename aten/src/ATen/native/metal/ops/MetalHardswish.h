@@ -0,0 +1,16 @@
+#ifndef MetalHardswish_h
+#define MetalHardswish_h
+
+#include <ATen/Tensor.h>
+
+namespace at {
+namespace native {
+namespace metal {
+
+Tensor& hardswish_(Tensor& input);
+
+} // namespace metal
+} // namespace native
+} // namespace at
+
+#endif
@@ -7,6 +7,7 @@
 #import <ATen/native/metal/mpscnn/MPSCNNUtils.h>
 #import <ATen/native/metal/mpscnn/MPSImage+Tensor.h>
 #import <ATen/native/metal/mpscnn/MPSImageUtils.h>
+#import <ATen/native/metal/ops/MetalHardswish.h>
 #include <torch/library.h>
 
 namespace at {
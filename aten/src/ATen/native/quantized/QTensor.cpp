@@ -2,6 +2,7 @@
 #include <ATen/NativeFunctions.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/cpu/Loops.h>
+#include <ATen/native/quantized/affine_quantizer.h>
 #include <ATen/native/quantized/cpu/quant_utils.h>
 #include <ATen/quantized/QTensorImpl.h>
 #include <ATen/quantized/Quantizer.h>
@@ -45,6 +46,25 @@ Tensor quantize_per_channel_cpu(
   auto quantizer = make_per_channel_affine_quantizer(scales, zero_points, axis, dtype);
   return quantizer->quantize(self);
 }
+Tensor _quantize_int8_symmetric(const Tensor& self, const Tensor& scale) {
+  TORCH_CHECK(
+      isFloatingType(self.scalar_type()),
+      "_quantize_int8_symmetric expects a floating point tensor, got ",
+      self.scalar_type());
+  TORCH_CHECK(
+      scale.scalar_type() == kFloat,
+      "Scale must be Float, found ", scale.scalar_type());
+  auto output = at::empty_like(self, self.options().dtype(kChar));
+  auto iter = TensorIteratorConfig()
+    .check_all_same_dtype(false)
+    .add_output(output)
+    .add_input(self)
+    .add_input(scale)
+    .build();
+  quantize_int8_symmetric_stub(iter.device_type(), iter);
+  return output;
+}
+
 Tensor dequantize_cpu(const Tensor& self) {
   TORCH_CHECK(!self.is_quantized());
   return self.to(at::kFloat);
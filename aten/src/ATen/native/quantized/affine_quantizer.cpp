@@ -19,6 +19,7 @@ DEFINE_DISPATCH(dequantize_tensor_per_channel_affine_stub);
 DEFINE_DISPATCH(dequantize_tensor_per_channel_float_qparams_stub);
 DEFINE_DISPATCH(quantize_tensor_per_tensor_affine_sub_byte_stub);
 DEFINE_DISPATCH(dequantize_tensor_per_tensor_affine_sub_byte_stub);
+DEFINE_DISPATCH(quantize_int8_symmetric_stub);
 
 namespace {
 
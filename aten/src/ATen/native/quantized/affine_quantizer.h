@@ -5,6 +5,9 @@
 #include <ATen/native/quantized/affine_quantizer_base.h>
 
 namespace at {
+
+struct TensorIterator;
+
 namespace native {
 
 Tensor quantize_tensor_per_tensor_affine(
@@ -112,6 +115,11 @@ DECLARE_DISPATCH(
     dequantize_tensor_per_tensor_affine_sub_byte_fn,
     dequantize_tensor_per_tensor_affine_sub_byte_stub);
 
+// Writes the int8 output of iter from its inputs (self, scale)
+using quantize_int8_symmetric_fn = void (*)(TensorIterator& iter);
+
+DECLARE_DISPATCH(quantize_int8_symmetric_fn, quantize_int8_symmetric_stub);
+
 template <typename T>
 TORCH_API Tensor quantize_tensor(
     Tensor rtensor,
@@ -52,6 +52,10 @@ struct TORCH_API PackedLinearWeight : public LinearPackedParamsBase {
 
   at::Tensor apply_dynamic(at::Tensor input, bool reduce_range=false) override;
   at::Tensor apply_dynamic_relu(at::Tensor input, bool reduce_range=false) override;
+  at::Tensor apply_dynamic_rowwise(
+      at::Tensor input,
+      LinearActivation activation,
+      bool reduce_range = false) override;
 
   std::tuple<at::Tensor, c10::optional<at::Tensor>> unpack() override;
 
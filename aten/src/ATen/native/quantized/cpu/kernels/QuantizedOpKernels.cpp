@@ -1,6 +1,7 @@
 #include <ATen/ATen.h>
 #include <ATen/Dispatch.h>
 #include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/functional.h>
 #include <ATen/native/SortingUtils.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/UpSample.h>
@@ -9,6 +10,7 @@
 #include <ATen/native/quantized/cpu/quantized_ops.h>
 
 #include <cmath>
+#include <cstring>
 #ifdef USE_FBGEMM
 #include <fbgemm/QuantUtils.h>
 #endif
@@ -1104,6 +1106,158 @@ void qmul_kernel(Tensor& out, const Tensor& self, const Tensor& other) {
   });
 }
 
+// Note: out is assumed to have the broadcast size of self and others.
+// Every input is dequantized once, the whole chain of ops runs on the float
+// values and the result is quantized once, instead of requantizing after each
+// op. Per channel qparams are added to the iterator as float tensors that are
+// broadcast like the values they belong to, so the inner loop stays
+// vectorized as long as they are either constant or contiguous along it.
+void qelementwise_kernel(
+    Tensor& out,
+    const Tensor& self,
+    TensorList others,
+    c10::ArrayRef<QElementwiseOp> ops) {
+  std::vector<Tensor> inputs{self};
+  inputs.insert(inputs.end(), others.begin(), others.end());
+  const int64_t num_inputs = inputs.size();
+
+  // for input i, qparam_index[i] is the operand holding its per channel
+  // scales, followed by its zero points, or -1 if it is per tensor quantized
+  std::vector<float> scales(num_inputs, 1.0f);
+  std::vector<float> zero_points(num_inputs, 0.0f);
+  std::vector<int64_t> qparam_index(num_inputs, -1);
+  std::vector<Tensor> qparams;
+  for (int64_t i = 0; i < num_inputs; ++i) {
+    const auto& input = inputs[i];
+    if (input.qscheme() == kPerTensorAffine) {
+      scales[i] = input.q_scale();
+      zero_points[i] = input.q_zero_point();
+      continue;
+    }
+    const int64_t axis = input.q_per_channel_axis();
+    std::vector<int64_t> shape(input.dim(), 1);
+    shape[axis] = input.size(axis);
+    qparam_index[i] = 1 + num_inputs + qparams.size();
+    qparams.push_back(input.q_per_channel_scales().to(kFloat).view(shape));
+    qparams.push_back(
+        input.q_per_channel_zero_points().to(kFloat).view(shape));
+  }
+
+  TensorIteratorConfig config;
+  config.check_all_same_dtype(false).add_output(out);
+  for (const auto& input : inputs) {
+    config.add_input(input);
+  }
+  for (const auto& qparam : qparams) {
+    config.add_input(qparam);
+  }
+  auto iter = config.build();
+
+  const float scale = out.q_scale();
+  const int64_t zero_point = out.q_zero_point();
+  const float inv_scale = 1.0f / scale;
+
+  AT_DISPATCH_QINT_TYPES(out.scalar_type(), "qelementwise", [&]() {
+    using Vec = Vec256<scalar_t>;
+    const Vec256<float> one(1.0f);
+    const Vec256<float> zero(0.0f);
+    std::vector<Vec256<float>> scale_vecs;
+    std::vector<Vec256<float>> zero_point_vecs;
+    std::vector<Vec256<float>> premul_vecs;
+    for (int64_t i = 0; i < num_inputs; ++i) {
+      scale_vecs.emplace_back(scales[i]);
+      zero_point_vecs.emplace_back(zero_points[i]);
+      premul_vecs.push_back(scale_vecs[i] * zero_point_vecs[i].neg());
+    }
+
+    iter.for_each([&](char** data, const int64_t* strides, int64_t n) {
+      bool vectorized = strides[0] == sizeof(scalar_t);
+      for (int64_t i = 0; i < num_inputs; ++i) {
+        const int64_t stride = strides[i + 1];
+        vectorized &= stride == 0 || stride == sizeof(scalar_t);
+        const int64_t p = qparam_index[i];
+        vectorized &= p < 0 || strides[p] == 0 || strides[p] == sizeof(float);
+      }
+
+      const auto dequantize_vec = [&](int64_t i, int64_t k) ->
+          typename Vec::float_vec_return_type {
+        const char* ptr = data[i + 1] + k * strides[i + 1];
+        const Vec q = strides[i + 1] == 0
+            ? Vec(*reinterpret_cast<const scalar_t*>(ptr))
+            : Vec::loadu(ptr);
+        const int64_t p = qparam_index[i];
+        if (p < 0) {
+          return q.dequantize(scale_vecs[i], zero_point_vecs[i], premul_vecs[i]);
+        }
+        if (strides[p] == 0) {
+          const Vec256<float> s(*reinterpret_cast<const float*>(data[p]));
+          const Vec256<float> z(*reinterpret_cast<const float*>(data[p + 1]));
+          return q.dequantize(s, z, s * z.neg());
+        }
+        // a different scale per lane, e.g. along the channels of NHWC inputs
+        auto values = q.dequantize(one, zero, zero);
+        for (int m = 0; m < Vec::float_num_vecs(); ++m) {
+          const int64_t offset = (k + m * Vec256<float>::size()) * sizeof(float);
+          const auto s = Vec256<float>::loadu(data[p] + offset);
+          const auto z = Vec256<float>::loadu(data[p + 1] + offset);
+          values[m] = (values[m] - z) * s;
+        }
+        return values;
+      };
+      const auto dequantize = [&](int64_t i, int64_t k) -> float {
+        const auto q =
+            *reinterpret_cast<const scalar_t*>(data[i + 1] + k * strides[i + 1]);
+        const int64_t p = qparam_index[i];
+        if (p < 0) {
+          return (static_cast<float>(q.val_) - zero_points[i]) * scales[i];
+        }
+        const float s = *reinterpret_cast<const float*>(data[p] + k * strides[p]);
+        const float z =
+            *reinterpret_cast<const float*>(data[p + 1] + k * strides[p + 1]);
+        return (static_cast<float>(q.val_) - z) * s;
+      };
+
+      int64_t k = 0;
+      if (vectorized) {
+        for (; k + Vec::size() <= n; k += Vec::size()) {
+          auto acc = dequantize_vec(0, k);
+          int64_t i = 1;
+          for (const auto op : ops) {
+            if (op == QElementwiseOp::Relu) {
+              for (int m = 0; m < Vec::float_num_vecs(); ++m) {
+                acc[m] = vec256::maximum(acc[m], zero);
+              }
+              continue;
+            }
+            const auto other = dequantize_vec(i++, k);
+            for (int m = 0; m < Vec::float_num_vecs(); ++m) {
+              acc[m] = op == QElementwiseOp::Add ? acc[m] + other[m]
+                                                 : acc[m] * other[m];
+            }
+          }
+          Vec::quantize(acc, scale, zero_point, inv_scale)
+              .store(data[0] + k * sizeof(scalar_t));
+        }
+      }
+      for (; k < n; ++k) {
+        float acc = dequantize(0, k);
+        int64_t i = 1;
+        for (const auto op : ops) {
+          if (op == QElementwiseOp::Relu) {
+            acc = std::max(acc, 0.0f);
+          } else if (op == QElementwiseOp::Add) {
+            acc += dequantize(i++, k);
+          } else {
+            acc *= dequantize(i++, k);
+          }
+        }
+        *reinterpret_cast<scalar_t*>(data[0] + k * strides[0]) =
+            at::native::quantize_val<scalar_t>(scale, zero_point, acc);
+      }
+    });
+  });
+}
+
 void qmaxpool_2d_nhwc_kernel(
     const Tensor& qx,
     int64_t iC, // input/output channels
@@ -2176,6 +2330,31 @@ void fake_quant_per_channel_cachemask_cpu(
   });
 }
 
+void fake_quant_tensor_qparams_cachemask_cpu(
+    TensorIterator& iter,
+    int64_t quant_min,
+    int64_t quant_max) {
+  // reads self once and writes the output and the mask in the same pass
+  cpu_kernel_multiple_outputs(
+      iter,
+      [=](float self,
+          float scale,
+          int64_t zero_point,
+          bool fake_quant_on) -> std::tuple<float, bool> {
+        if (!fake_quant_on) {
+          return std::make_tuple(self, true);
+        }
+        float inv_scale = 1.0f / scale;
+        const auto qval =
+            static_cast<int64_t>(zero_point + std::nearbyint(self * inv_scale));
+        return std::make_tuple(
+            static_cast<float>(
+                (std::min(std::max(qval, quant_min), quant_max) - zero_point) *
+                scale),
+            (quant_min <= qval) && (qval <= quant_max));
+      });
+}
+
 void fake_quantize_learnable_channel_grad_kernel_cpu(
     TensorIterator& iter,
     int64_t quant_min,
@@ -3045,17 +3224,112 @@ void dequantize_tensor_per_tensor_affine_sub_byte_cpu(
 
 }
 
+// Weight-only linear, y = x w^T + b, on weights with every row quantized to
+// bit_width bits with its own fp16 scale and zero_point, see
+// _qembeddingbag_nbit_prepack_helper. Since w = scale * q + zero_point for a
+// row, x . w = scale * (x . q) + zero_point * sum(x), so each row is only
+// unpacked to the integers q, once for all the rows of x.
+template <int bit_width>
+void qlinear_nbit_impl(
+    const Tensor& input,
+    const Tensor& packed_weight,
+    const Tensor& bias,
+    Tensor& output) {
+  using Vec = Vec256<float>;
+  constexpr int64_t elem_per_byte = CHAR_BIT / bit_width;
+  constexpr uint8_t mask = (1 << bit_width) - 1;
+  const int64_t M = input.size(0);
+  const int64_t K = input.size(1);
+  const int64_t N = packed_weight.size(0);
+  const int64_t row_bytes = packed_weight.size(1);
+  const int64_t data_bytes = row_bytes - 2 * sizeof(at::Half);
+  const float* input_data = input.data_ptr<float>();
+  const uint8_t* weight_data = packed_weight.data_ptr<uint8_t>();
+  const float* bias_data = bias.defined() ? bias.data_ptr<float>() : nullptr;
+  float* output_data = output.data_ptr<float>();
+
+  std::vector<float> input_sums(M);
+  for (int64_t m = 0; m < M; ++m) {
+    input_sums[m] = vec256::reduce_all<float>(
+        [](Vec& x, Vec& y) { return x + y; }, input_data + m * K, K);
+  }
+
+  const int64_t grain_size =
+      std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(M * K, 1));
+  at::parallel_for(0, N, grain_size, [&](int64_t begin, int64_t end) {
+    std::vector<float> q(data_bytes * elem_per_byte);
+    for (int64_t n = begin; n < end; ++n) {
+      const uint8_t* row = weight_data + n * row_bytes;
+      // Values are packed lowest bits first
+      for (int64_t i = 0; i < data_bytes; ++i) {
+        const uint8_t byte = row[i];
+        for (int64_t j = 0; j < elem_per_byte; ++j) {
+          q[i * elem_per_byte + j] = (byte >> (j * bit_width)) & mask;
+        }
+      }
+      // The row is not necessarily 2-byte aligned
+      at::Half scale_zero_point[2];
+      std::memcpy(scale_zero_point, row + data_bytes, sizeof(scale_zero_point));
+      const float scale = scale_zero_point[0];
+      const float zero_point = scale_zero_point[1];
+      const float b = bias_data ? bias_data[n] : 0.f;
+
+      for (int64_t m = 0; m < M; ++m) {
+        const float* x = input_data + m * K;
+        Vec acc(0.f);
+        int64_t k = 0;
+        for (; k + Vec::size() <= K; k += Vec::size()) {
+          acc = vec256::fmadd(Vec::loadu(x + k), Vec::loadu(&q[k]), acc);
+        }
+        float dot = vec256::vec_reduce_all<float>(
+            [](Vec& x, Vec& y) { return x + y; }, acc, Vec::size());
+        for (; k < K; ++k) {
+          dot += x[k] * q[k];
+        }
+        output_data[m * N + n] = scale * dot + zero_point * input_sums[m] + b;
+      }
+    }
+  });
+}
+
+void qlinear_nbit_kernel(
+    const Tensor& input,
+    const Tensor& packed_weight,
+    const Tensor& bias,
+    int64_t bit_width,
+    Tensor& output) {
+  if (bit_width == 2) {
+    qlinear_nbit_impl<2>(input, packed_weight, bias, output);
+  } else {
+    TORCH_INTERNAL_ASSERT(bit_width == 4);
+    qlinear_nbit_impl<4>(input, packed_weight, bias, output);
+  }
+}
+
+void quantize_int8_symmetric_cpu(TensorIterator& iter) {
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      kHalf, kBFloat16, iter.input_dtype(0), "quantize_int8_symmetric_cpu", [&]() {
+        cpu_kernel(iter, [](scalar_t self, float scale) -> int8_t {
+          const float qval = std::nearbyint(static_cast<float>(self) / scale);
+          return static_cast<int8_t>(std::min(std::max(qval, -127.0f), 127.0f));
+        });
+      });
+}
+
 } // namespace
 
 REGISTER_DISPATCH(dequantize_tensor_per_channel_affine_stub,
                   &dequantize_tensor_per_channel_affine_cpu);
 REGISTER_DISPATCH(dequantize_tensor_per_tensor_affine_stub,
                   &dequantize_tensor_per_tensor_affine_cpu);
+REGISTER_DISPATCH(quantize_int8_symmetric_stub,
+                  &quantize_int8_symmetric_cpu);
 REGISTER_DISPATCH(dequantize_tensor_per_channel_float_qparams_stub,
                   &dequantize_tensor_per_channel_float_qparams_cpu);
 REGISTER_DISPATCH(fake_quant_grad_learnable_tensor_stub,
                   &fake_quantize_learnable_tensor_grad_kernel_cpu);
 REGISTER_DISPATCH(fake_quant_per_channel_cachemask_stub, &fake_quant_per_channel_cachemask_cpu);
+REGISTER_DISPATCH(fake_quant_tensor_qparams_cachemask_stub, &fake_quant_tensor_qparams_cachemask_cpu);
 REGISTER_DISPATCH(fake_quant_tensor_cachemask_stub,
                   &fake_quantize_tensor_cachemask_kernel);
 REGISTER_DISPATCH(qadaptive_avg_pool2d_nhwc_stub,
@@ -3075,9 +3349,11 @@ REGISTER_DISPATCH(qcat_relu_nhwc_stub, &qcat_nhwc_kernel<true>);
 REGISTER_DISPATCH(qclamp_stub, &qclamp_kernel);
 REGISTER_DISPATCH(qclamp_min_stub, &qclamp_min_kernel);
 REGISTER_DISPATCH(qclamp_max_stub, &qclamp_max_kernel);
+REGISTER_DISPATCH(qelementwise_stub, &qelementwise_kernel);
 REGISTER_DISPATCH(qelu_stub, &qelu_kernel);
 REGISTER_DISPATCH(qhardsigmoid_stub, &qhardsigmoid_kernel);
 REGISTER_DISPATCH(qhardswish_stub, &qhardswish_kernel);
+REGISTER_DISPATCH(qlinear_nbit_stub, &qlinear_nbit_kernel);
 REGISTER_DISPATCH(qmaxpool_2d_nhwc_stub, &qmaxpool_2d_nhwc_kernel);
 REGISTER_DISPATCH(qmul_relu_stub, &qmul_kernel<true>);
 REGISTER_DISPATCH(qmul_stub, &qmul_kernel<false>);
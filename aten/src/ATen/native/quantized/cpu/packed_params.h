@@ -2,6 +2,10 @@
 
 #include <ATen/core/ivalue.h>
 
+// Activation applied to the float output of a dynamic linear, see
+// LinearPackedParamsBase::apply_dynamic_rowwise
+enum class LinearActivation { None, Relu, Gelu };
+
 struct LinearPackedParamsBase : public torch::jit::CustomClassHolder {
   virtual at::Tensor apply(
       at::Tensor input,
@@ -15,6 +19,18 @@ struct LinearPackedParamsBase : public torch::jit::CustomClassHolder {
   virtual at::Tensor apply_dynamic(at::Tensor input, bool reduce_range=false) = 0;
   virtual at::Tensor apply_dynamic_relu(at::Tensor input, bool reduce_range=false) = 0;
 
+  // Like apply_dynamic, but every row of the input is quantized with its own
+  // scale and zero point, and the bias and the activation are applied to the
+  // output as it is dequantized.
+  virtual at::Tensor apply_dynamic_rowwise(
+      at::Tensor input,
+      LinearActivation activation,
+      bool reduce_range = false) {
+    throw std::runtime_error(
+        "apply_dynamic_rowwise is not implemented for this packed "
+        "parameter type");
+  }
+
   virtual std::tuple<at::Tensor, c10::optional<at::Tensor>> unpack() = 0;
 
   virtual c10::optional<at::Tensor> bias() = 0;
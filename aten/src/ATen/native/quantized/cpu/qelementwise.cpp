@@ -0,0 +1,87 @@
+#include <ATen/ATen.h>
+#include <ATen/ExpandUtils.h>
+#include <torch/library.h>
+#include <ATen/native/quantized/cpu/quantized_ops.h>
+
+#include <string>
+#include <vector>
+
+namespace at {
+namespace native {
+
+DEFINE_DISPATCH(qelementwise_stub);
+
+namespace {
+
+QElementwiseOp parse_op(const std::string& op) {
+  if (op == "add") {
+    return QElementwiseOp::Add;
+  } else if (op == "mul") {
+    return QElementwiseOp::Mul;
+  } else if (op == "relu") {
+    return QElementwiseOp::Relu;
+  }
+  TORCH_CHECK(false, "Unknown quantized elementwise op ", op);
+  return QElementwiseOp::Relu;
+}
+
+inline void check_inputs(const Tensor& qa, const Tensor& qb) {
+  TORCH_CHECK(
+      qb.qscheme() == kPerTensorAffine || qb.qscheme() == kPerChannelAffine,
+      "Only per tensor and per channel affine quantization is supported in "
+      "elementwise.");
+  TORCH_CHECK(
+      qa.scalar_type() == qb.scalar_type(),
+      "Elementwise operands should have same data type.");
+}
+
+// Runs a chain of elementwise ops in one pass, e.g. ops = ["add", "relu",
+// "mul"] computes relu(qx + others[0]) * others[1]. Each add and mul takes
+// the next of others, which broadcast against qx and each other.
+class QElementwise final {
+ public:
+  static Tensor run(
+      Tensor qx,
+      c10::List<Tensor> others,
+      std::vector<std::string> ops,
+      double scale,
+      int64_t zero_point) {
+    std::vector<QElementwiseOp> parsed;
+    size_t num_operands = 0;
+    for (const auto& op : ops) {
+      parsed.push_back(parse_op(op));
+      num_operands += parsed.back() != QElementwiseOp::Relu;
+    }
+    TORCH_CHECK(
+        num_operands == others.size(),
+        "Elementwise ops take ",
+        num_operands,
+        " operands, got ",
+        others.size());
+
+    check_inputs(qx, qx);
+    const std::vector<Tensor> operands = others.vec();
+    DimVector shape(qx.sizes().begin(), qx.sizes().end());
+    for (const auto& other : operands) {
+      check_inputs(qx, other);
+      shape = infer_size_dimvector(shape, other.sizes());
+    }
+    auto qy = at::_empty_affine_quantized(
+        shape,
+        at::device(kCPU).dtype(qx.scalar_type()),
+        scale,
+        zero_point,
+        shape.size() == static_cast<size_t>(qx.dim())
+            ? qx.suggest_memory_format()
+            : MemoryFormat::Contiguous);
+    qelementwise_stub(qx.device().type(), qy, qx, operands, parsed);
+    return qy;
+  }
+};
+
+TORCH_LIBRARY_IMPL(quantized, QuantizedCPU, m) {
+  m.impl(TORCH_SELECTIVE_NAME("quantized::elementwise"), TORCH_FN(QElementwise::run));
+}
+
+}  // namespace
+}}  // namespace at::native
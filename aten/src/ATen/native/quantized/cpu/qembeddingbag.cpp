@@ -6,10 +6,14 @@
 #ifdef USE_FBGEMM
 #include <fbgemm/Fbgemm.h>
 #include <fbgemm/FbgemmEmbedding.h>
+#elif !defined(C10_MOBILE)
+#include <caffe2/perfkernels/fused_8bit_rowwise_embedding_lookup_idx.h>
 #endif
 
 #include <ATen/Parallel.h>
 
+#include <type_traits>
+
 torch::class_<EmbeddingPackedParamsBase> register_embedding_params();
 
 namespace {
@@ -138,9 +142,10 @@ at::Tensor& embedding_lookup_fallback_impl(
 }
 
 template <typename IndexType, typename OffsetType>
-at::Tensor& embedding_bag_4bit_impl(
+at::Tensor& embedding_bag_nbit_impl(
     at::Tensor& output,
     const at::Tensor& weight,
+    const int bit_width,
     const at::Tensor& indices,
     const at::Tensor& offsets,
     bool pruned_weights,
@@ -175,7 +180,7 @@ at::Tensor& embedding_bag_4bit_impl(
   const int64_t N = weight_sizes[0];
   const int64_t weight_size = weight_sizes[1];
   const int64_t D =
-      (weight_size - 4) * 2; // NB: 2-byte fp16 scale and 2-byte zero_offset
+      (weight_size - 4) * (8 / bit_width); // NB: 2-byte fp16 scale and 2-byte zero_offset
   const int64_t M = offsets.sizes()[0];
 
   int64_t output_size = M - 1;
@@ -207,7 +212,7 @@ at::Tensor& embedding_bag_4bit_impl(
   if (!pruned_weights || fallback_to_no_sparse) {
     // Generate the fbgemm kernel
     auto kernel = fbgemm::GenerateEmbeddingSpMDMNBit<IndexType, OffsetType>(
-        /*bit rate=*/4,
+        /*bit rate=*/bit_width,
         /*block size=*/block_size,
         /*has weights=*/per_sample_weights_.has_value(),
         /*normalize_by_lengths=*/false,
@@ -230,11 +235,13 @@ at::Tensor& embedding_bag_4bit_impl(
 
     TORCH_CHECK(
         success,
-        "FBGEMM GenerateEmbeddingSpMDMNBit kernel failed for 4-bit input");
+        "FBGEMM GenerateEmbeddingSpMDMNBit kernel failed for ",
+        bit_width,
+        "-bit input");
   } else {
     auto kernel =
         fbgemm::GenerateEmbeddingSpMDMNBitRowWiseSparse<IndexType, OffsetType>(
-            /*bit rate=*/4,
+            /*bit rate=*/bit_width,
             /*block_size=*/block_size,
             /*has weights=*/per_sample_weights_.has_value(),
             /*normalize_by_lengths=*/false,
@@ -256,10 +263,25 @@ at::Tensor& embedding_bag_4bit_impl(
         /*compressed_indices_table=*/compressed_indices_mapping_data);
     TORCH_CHECK(
         success,
-        "FBGEMM GenerateEmbeddingSpMDMNBitRowWiseSparse kernel failed for 4-bit input");
+        "FBGEMM GenerateEmbeddingSpMDMNBitRowWiseSparse kernel failed for ",
+        bit_width,
+        "-bit input");
   }
   return output;
 #else
+  if (bit_width == 2) {
+    return embedding_lookup_fallback_impl<IndexType, OffsetType, 2, 4>(
+        weight,
+        indices,
+        offsets,
+        per_sample_weights_,
+        compressed_indices_mapping,
+        output,
+        D,
+        output_size,
+        include_last_offset,
+        (pruned_weights && !fallback_to_no_sparse));
+  }
   return embedding_lookup_fallback_impl<IndexType, OffsetType, 4, 2>(
       weight,
       indices,
@@ -403,6 +425,34 @@ at::Tensor& embedding_bag_byte_impl(
   }
   return output;
 #else
+#ifndef C10_MOBILE
+  // Without fbgemm, use caffe2's code-generated AVX2 kernels for the
+  // 8-bit rowwise layout; they share one type for indices and offsets.
+  if ((!pruned_weights || fallback_to_no_sparse) &&
+      std::is_same<IndexType, OffsetType>::value) {
+    const auto* offsets_idx_data =
+        reinterpret_cast<const IndexType*>(offsets_data);
+    at::parallel_for(
+        0, output_size, 1, [&](int64_t start_idx, int64_t end_idx) {
+          caffe2::Fused8BitRowwiseEmbeddingLookupIdx(
+              /*block_size=*/D,
+              /*output_size=*/end_idx - start_idx,
+              /*index_size=*/offsets_data[end_idx] - offsets_data[start_idx],
+              /*data_size=*/N,
+              /*input=*/weight_data,
+              /*indices=*/indices_data + offsets_data[start_idx],
+              /*offsets=*/offsets_idx_data + start_idx,
+              /*weights=*/
+              per_sample_weights_
+                  ? per_sample_weights_.value().data_ptr<float>() +
+                      offsets_data[start_idx]
+                  : nullptr,
+              /*normalize_by_lengths=*/false,
+              /*out=*/output_data + start_idx * D);
+        });
+    return output;
+  }
+#endif
   return embedding_lookup_fallback_impl<IndexType, OffsetType, 8, 1>(
       weight,
       indices,
@@ -515,9 +565,10 @@ at::Tensor& embedding_bag_byte_helper(
       is_embedding_op);
 }
 
-at::Tensor& embedding_bag_4bit_helper(
+at::Tensor& embedding_bag_nbit_helper(
     at::Tensor& output,
     const at::Tensor& weight,
+    const int bit_width,
     const at::Tensor& indices,
     const c10::optional<at::Tensor>& offsets_in,
     bool pruned_weights,
@@ -535,14 +586,18 @@ at::Tensor& embedding_bag_4bit_helper(
   if (indices.dim() == 2) {
     TORCH_CHECK(
         !offsets_in.has_value(),
-        "embedding_bag_4bit operator: input is 2D, then offsets has to be None, as input is treated is a mini-batch of fixed length sequences.");
+        "embedding_bag_",
+        bit_width,
+        "bit operator: input is 2D, then offsets has to be None, as input is treated is a mini-batch of fixed length sequences.");
 
     offsets = c10::MaybeOwned<at::Tensor>::owned(at::arange(
         0, indices.numel(), indices.sizes()[1], indices.scalar_type()));
   } else {
     TORCH_CHECK(
         offsets_in.has_value(),
-        "embedding_bag_4bit operator expects offsets to be set for 1D indices.");
+        "embedding_bag_",
+        bit_width,
+        "bit operator expects offsets to be set for 1D indices.");
     offsets = c10::MaybeOwned<at::Tensor>::borrowed(offsets_in.value());
   }
 
@@ -564,9 +619,10 @@ at::Tensor& embedding_bag_4bit_helper(
   // Using helper function to support different type combination without the
   // need to cast, which can be additional performance overhead
   if (indices.scalar_type() == at::kInt && offsets->scalar_type() == at::kInt) {
-    return embedding_bag_4bit_impl<int, int>(
+    return embedding_bag_nbit_impl<int, int>(
         output,
         weight,
+        bit_width,
         indices,
         *offsets,
         pruned_weights,
@@ -575,9 +631,10 @@ at::Tensor& embedding_bag_4bit_helper(
         include_last_offset);
   } else if (
       indices.scalar_type() == at::kInt && offsets->scalar_type() == at::kLong) {
-    return embedding_bag_4bit_impl<int, int64_t>(
+    return embedding_bag_nbit_impl<int, int64_t>(
         output,
         weight,
+        bit_width,
         indices,
         *offsets,
         pruned_weights,
@@ -586,9 +643,10 @@ at::Tensor& embedding_bag_4bit_helper(
         include_last_offset);
   } else if (
       indices.scalar_type() == at::kLong && offsets->scalar_type() == at::kInt) {
-    return embedding_bag_4bit_impl<int64_t, int>(
+    return embedding_bag_nbit_impl<int64_t, int>(
         output,
         weight,
+        bit_width,
         indices,
         *offsets,
         pruned_weights,
@@ -596,9 +654,10 @@ at::Tensor& embedding_bag_4bit_helper(
         compressed_indices_mapping,
         include_last_offset);
   }
-  return embedding_bag_4bit_impl<int64_t, int64_t>(
+  return embedding_bag_nbit_impl<int64_t, int64_t>(
       output,
       weight,
+      bit_width,
       indices,
       *offsets,
       pruned_weights,
@@ -646,9 +705,10 @@ at::Tensor PackedEmbeddingBagWeight::embeddingbag_4bit(
   }
 
   auto output = at::empty({0}, packed_w.options().dtype(at::kFloat));
-  return embedding_bag_4bit_helper(
+  return embedding_bag_nbit_helper(
     output,
     packed_w,
+    4 /*bit_width*/,
     indices,
     offsets_in,
     pruned_weights,
@@ -705,9 +765,44 @@ Tensor& embedding_bag_4bit_rowwise_offsets_out(
         per_sample_weights_.value().scalar_type(),
         " instead")
   }
-  return embedding_bag_4bit_helper(
+  return embedding_bag_nbit_helper(
+      output,
+      weight,
+      4 /*bit_width*/,
+      indices,
+      offsets_in,
+      pruned_weights,
+      per_sample_weights_.has_value()
+          ? per_sample_weights_.value().to(at::kFloat)
+          : per_sample_weights_,
+      compressed_indices_mapping,
+      include_last_offset);
+}
+
+Tensor& embedding_bag_2bit_rowwise_offsets_out(
+    Tensor& output,
+    const Tensor& weight,
+    const Tensor& indices,
+    const c10::optional<Tensor>& offsets_in,
+    const bool /* scale_grad_by_freq */,
+    const int64_t /* mode */,
+    bool pruned_weights,
+    const c10::optional<Tensor>& per_sample_weights_,
+    const c10::optional<Tensor>& compressed_indices_mapping,
+    bool include_last_offset) {
+
+  if (per_sample_weights_.has_value()) {
+    TORCH_CHECK(
+        (per_sample_weights_.value().scalar_type() == at::kFloat ||
+         per_sample_weights_.value().scalar_type() == at::kHalf),
+        "Expect fp32 or fp16 weights, but found",
+        per_sample_weights_.value().scalar_type(),
+        " instead")
+  }
+  return embedding_bag_nbit_helper(
       output,
       weight,
+      2 /*bit_width*/,
       indices,
       offsets_in,
       pruned_weights,
@@ -780,6 +875,33 @@ Tensor embedding_bag_4bit_rowwise_offsets(
   return output;
 }
 
+Tensor embedding_bag_2bit_rowwise_offsets(
+    const Tensor& weight,
+    const Tensor& indices,
+    const c10::optional<Tensor>& offsets_in,
+    const bool /* scale_grad_by_freq */,
+    const int64_t /* mode */,
+    bool pruned_weights,
+    const c10::optional<Tensor>& per_sample_weights_,
+    const c10::optional<Tensor>& compressed_indices_mapping,
+    bool include_last_offset) {
+
+  auto output = create_empty_from(weight, at::kFloat);
+  embedding_bag_2bit_rowwise_offsets_out(
+    output,
+    weight,
+    indices,
+    offsets_in,
+    false, // unused scale_grad_by_freq
+    0, // unused mode
+    pruned_weights,
+    per_sample_weights_,
+    compressed_indices_mapping,
+    include_last_offset
+  );
+  return output;
+}
+
 template <int bit_rate>
 class QEmbeddingBag final {
  public:
@@ -865,6 +987,9 @@ TORCH_LIBRARY_IMPL(quantized, CPU, m) {
   m.impl(
       TORCH_SELECTIVE_NAME("quantized::embedding_bag_4bit_rowwise_offsets"),
       embedding_bag_4bit_rowwise_offsets);
+  m.impl(
+      TORCH_SELECTIVE_NAME("quantized::embedding_bag_2bit_rowwise_offsets"),
+      embedding_bag_2bit_rowwise_offsets);
 }
 } // namespace
 } // namespace native
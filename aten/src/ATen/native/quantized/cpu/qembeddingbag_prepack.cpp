@@ -2,6 +2,7 @@
 #include <ATen/Parallel.h>
 #include <ATen/native/quantized/cpu/embedding_packed_params.h>
 #include <ATen/native/quantized/cpu/fbgemm_utils.h>
+#include <ATen/native/quantized/cpu/qembeddingbag_prepack.h>
 #include <torch/library.h>
 
 #include <c10/util/irange.h>
@@ -254,6 +255,8 @@ Tensor qembeddingbag_byte_prepack(const Tensor& weight) {
   return output;
 }
 
+} // namespace
+
 // TODO: Extend support to N-D batched embeddings, similar to qembeddingbag_byte_prepack
 Tensor _qembeddingbag_nbit_prepack_helper(
     const Tensor& weight,
@@ -371,6 +374,8 @@ Tensor _qembeddingbag_nbit_prepack_helper(
   return output;
 }
 
+namespace {
+
 // Applies 4-bit row-wise quantization by determining the range
 // (maximum - minimum) and bias (minimum value) of each row in the input
 // matrix, and then scaling each element to an 2-bit number between 0 and
@@ -392,7 +397,6 @@ Tensor qembeddingbag_4bit_prepack(
 // To later de-quantize values, the scale (range / 3) and zero_point
 // are stored alongside the data. More precisely, each row first has quantized
 // values, and then 2-byte fp16 scale and 2-byte zero_offset.
-// TODO() - Add 2Bit Embedding Lookup operator.
 Tensor qembeddingbag_2bit_prepack(
     const Tensor& weight,
     bool optimized_qparams) {
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+namespace at {
+namespace native {
+// Quantizes each row of a 2-d float weight to bit_width (2 or 4) bits, packed
+// into bytes and followed by its 2-byte fp16 scale and 2-byte fp16 zero_offset
+Tensor _qembeddingbag_nbit_prepack_helper(
+    const Tensor& weight,
+    int bit_width,
+    bool optimized_qparams);
+} // native
+} // at
@@ -13,6 +13,7 @@
 #include <c10/util/irange.h>
 
 #include <algorithm>
+#include <cmath>
 #include <string>
 
 torch::class_<LinearPackedParamsBase> register_linear_params();
@@ -217,6 +218,149 @@ at::Tensor PackedLinearWeight::apply_dynamic_relu(at::Tensor input, bool reduce_
   return apply_dynamic_impl</*ReluFused=*/true>(std::move(input), reduce_range);
 }
 
+at::Tensor PackedLinearWeight::apply_dynamic_rowwise(
+    at::Tensor input,
+    LinearActivation activation,
+    bool reduce_range) {
+  // fp32 * int8 -> fp32, with each row of the activation quantized with its
+  // own qparams. A row is quantized right after its range is found, while it
+  // is still in cache, so the float input is only read from memory once; the
+  // GEMM then packs the (4x smaller) uint8 rows.
+  TORCH_CHECK(
+      fbgemm::fbgemmSupportedCPU(), "Your CPU does not support FBGEMM.");
+  TORCH_CHECK(
+      input.dim() >= 2,
+      "The dimension of input tensor should be larger than or equal to 2");
+  auto input_contig = input.contiguous();
+  const auto* input_ptr = input_contig.data_ptr<float>();
+
+  const int64_t M = size_to_dim_(input.dim() - 1, input.sizes());
+  auto packB = w.get();
+  const int64_t N = static_cast<int64_t>(packB->numCols());
+  const int64_t K = input.size(input.dim() - 1);
+  TORCH_CHECK(
+      K == static_cast<int64_t>(packB->numRows()),
+      "The number of rows in the packB should be equal to K: " +
+          std::to_string(K));
+
+  const float* bias_ptr = nullptr;
+  at::Tensor bias_contig;
+  if (bias_.has_value()) {
+    TORCH_CHECK(bias_->dim() == 1, "bias should be a vector (1D Tensor)");
+    TORCH_CHECK(
+        bias_->size(0) == N,
+        "bias should have N elements: " + std::to_string(N));
+    bias_contig = bias_->contiguous();
+    bias_ptr = bias_contig.data_ptr<float>();
+  }
+
+  std::vector<int64_t> out_sizes = input.sizes().vec();
+  out_sizes.back() = N;
+  auto output = at::empty(out_sizes, input.options().dtype(at::kFloat));
+  if (M == 0 || N == 0) {
+    return output;
+  }
+  auto buffer = at::empty(
+      out_sizes, output.options().dtype(at::kInt), LEGACY_CONTIGUOUS_MEMORY_FORMAT);
+  auto input_q = at::empty({M, K}, input.options().dtype(at::kByte));
+  auto* input_q_ptr = input_q.data_ptr<uint8_t>();
+  auto* buffer_ptr = buffer.data_ptr<int32_t>();
+  auto* output_ptr = output.data_ptr<float>();
+
+  std::vector<float> row_scales(M);
+  std::vector<int32_t> row_zero_points(M);
+  // The sum of each quantized row, needed for the zero points of the weight
+  std::vector<int32_t> row_offsets(M);
+  at::parallel_for(0, M, 1, [&](int64_t begin, int64_t end) {
+    for (const auto i : c10::irange(begin, end)) {
+      const float* row = input_ptr + i * K;
+      uint8_t* row_q = input_q_ptr + i * K;
+      float x_min, x_max;
+      fbgemm::FindMinMax(row, &x_min, &x_max, K);
+      const auto q_params = quant_utils::ChooseQuantizationParams(
+          /*min=*/x_min,
+          /*max=*/x_max,
+          /*qmin=*/0,
+          /*qmax=*/255,
+          /*preserve_sparsity=*/false,
+          /*force_scale_power_of_two=*/false,
+          /*reduce_range=*/reduce_range);
+      fbgemm::Quantize<uint8_t, false /*LEGACY*/>(
+          row,
+          row_q,
+          K,
+          fbgemm::TensorQuantizationParams{
+              static_cast<float>(q_params.scale), q_params.zero_point, 8});
+      int32_t sum = 0;
+      for (const auto k : c10::irange(K)) {
+        sum += row_q[k];
+      }
+      row_scales[i] = q_params.scale;
+      row_zero_points[i] = q_params.zero_point;
+      row_offsets[i] = sum;
+    }
+  });
+
+  // ReQuantizeForFloat only takes a single activation scale, so the GEMM
+  // writes the int32 accumulators and the rows are dequantized below.
+  int num_tasks = at::get_num_threads();
+  at::parallel_for(0, num_tasks, 1, [&](int64_t begin, int64_t end) {
+    fbgemm::PackAMatrix<uint8_t> packA(
+        /*trans=*/fbgemm::matrix_op_t::NoTranspose,
+        /*nRow=*/M,
+        /*nCol=*/K,
+        /*smat=*/input_q_ptr,
+        /*ld=*/K);
+    fbgemm::DoNothing<int32_t, int32_t> doNothingObj{};
+    fbgemm::memCopy<> memCopyObj(doNothingObj);
+    for (const auto task_id : c10::irange(begin, end)) {
+      fbgemm::fbgemmPacked(
+          /*packA=*/packA,
+          /*packB=*/*packB,
+          /*C=*/buffer_ptr,
+          /*C_buffer=*/buffer_ptr,
+          /*ldc=*/N,
+          /*outProcess=*/memCopyObj,
+          /*thread_id=*/task_id,
+          /*num_threads=*/num_tasks);
+    }
+  });
+
+  // Add in the row and column offsets, dequantize, add the bias and apply the
+  // activation in a single pass over the output.
+  const bool per_channel = q_scheme == c10::kPerChannelAffine;
+  at::parallel_for(0, M, 1, [&](int64_t begin, int64_t end) {
+    for (const auto i : c10::irange(begin, end)) {
+      const int32_t* acc = buffer_ptr + i * N;
+      float* out = output_ptr + i * N;
+      for (const auto j : c10::irange(N)) {
+        const int64_t g = per_channel ? j : 0;
+        const int32_t raw = acc[j] - row_zero_points[i] * col_offsets[j] -
+            w_zp[g] * row_offsets[i];
+        out[j] = raw * row_scales[i] * w_scale[g] +
+            (bias_ptr ? bias_ptr[j] : 0.f);
+      }
+      switch (activation) {
+        case LinearActivation::None:
+          break;
+        case LinearActivation::Relu:
+          for (const auto j : c10::irange(N)) {
+            out[j] = std::max(out[j], 0.f);
+          }
+          break;
+        case LinearActivation::Gelu:
+          for (const auto j : c10::irange(N)) {
+            out[j] = 0.5f * out[j] *
+                (1.f + std::erf(out[j] * static_cast<float>(M_SQRT1_2)));
+          }
+          break;
+      }
+    }
+  });
+
+  return output;
+}
+
 #endif // USE_FBGEMM
 
 #ifdef USE_PYTORCH_QNNPACK
@@ -427,6 +571,31 @@ class QLinearDynamicInt8 final {
   }
 };
 
+class QLinearDynamicRowwiseInt8 final {
+ public:
+  static at::Tensor run(
+      at::Tensor input,
+      const c10::intrusive_ptr<LinearPackedParamsBase>& packed_weight,
+      c10::string_view activation,
+      bool reduce_range) {
+    LinearActivation act;
+    if (activation == "none") {
+      act = LinearActivation::None;
+    } else if (activation == "relu") {
+      act = LinearActivation::Relu;
+    } else if (activation == "gelu") {
+      act = LinearActivation::Gelu;
+    } else {
+      TORCH_CHECK(
+          false,
+          "quantized::linear_dynamic_rowwise: unsupported activation ",
+          std::string(activation));
+    }
+    return packed_weight->apply_dynamic_rowwise(
+        std::move(input), act, reduce_range);
+  }
+};
+
 template <bool ReluFused>
 class QLinearDynamicFp16 final {
  public:
@@ -459,6 +628,7 @@ class QLinearDynamicFp16 final {
 TORCH_LIBRARY_IMPL(quantized, CPU, m) {
   m.impl(TORCH_SELECTIVE_NAME("quantized::linear_dynamic"), TORCH_FN(QLinearDynamicInt8<false>::run));
   m.impl(TORCH_SELECTIVE_NAME("quantized::linear_relu_dynamic"), TORCH_FN(QLinearDynamicInt8<true>::run));
+  m.impl(TORCH_SELECTIVE_NAME("quantized::linear_dynamic_rowwise"), TORCH_FN(QLinearDynamicRowwiseInt8::run));
   m.impl(TORCH_SELECTIVE_NAME("quantized::linear_dynamic_fp16"), TORCH_FN(QLinearDynamicFp16<false>::run));
 }
 
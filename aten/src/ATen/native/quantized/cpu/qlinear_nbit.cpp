@@ -0,0 +1,80 @@
+#include <ATen/ATen.h>
+#include <ATen/native/quantized/cpu/quantized_ops.h>
+#include <torch/library.h>
+
+namespace at {
+namespace native {
+
+DEFINE_DISPATCH(qlinear_nbit_stub);
+
+namespace {
+
+// Weight-only quantized linear: the input and the output are float, and the
+// weight is packed by quantized::linear_prepack_4bit or
+// quantized::linear_prepack_2bit. Meant for the memory-bandwidth bound case of
+// a few input rows, where reading the weight dominates.
+template <int bit_width>
+class QLinearNBit final {
+ public:
+  static Tensor run(
+      Tensor input,
+      Tensor packed_weight,
+      c10::optional<Tensor> bias) {
+    TORCH_CHECK(
+        input.dim() >= 2 && input.scalar_type() == at::kFloat,
+        "quantized::linear_",
+        bit_width,
+        "bit expects a float input of at least 2 dimensions");
+    TORCH_CHECK(
+        packed_weight.dim() == 2 && packed_weight.scalar_type() == at::kByte,
+        "quantized::linear_",
+        bit_width,
+        "bit expects a weight packed by quantized::linear_prepack_",
+        bit_width,
+        "bit");
+    const int64_t K = input.size(-1);
+    const int64_t N = packed_weight.size(0);
+    constexpr int64_t elem_per_byte = 8 / bit_width;
+    TORCH_CHECK(
+        (packed_weight.size(1) - 2 * static_cast<int64_t>(sizeof(at::Half))) *
+                elem_per_byte ==
+            K,
+        "The packed weight does not match the ",
+        K,
+        " input features");
+    Tensor bias_contig;
+    if (bias.has_value()) {
+      TORCH_CHECK(
+          bias->dim() == 1 && bias->size(0) == N &&
+              bias->scalar_type() == at::kFloat,
+          "bias should be a float vector of ",
+          N,
+          " elements");
+      bias_contig = bias->contiguous();
+    }
+
+    auto input_2d = input.reshape({-1, K}).contiguous();
+    auto output = at::empty({input_2d.size(0), N}, input.options());
+    if (output.numel() > 0) {
+      qlinear_nbit_stub(
+          kCPU,
+          input_2d,
+          packed_weight.contiguous(),
+          bias_contig,
+          bit_width,
+          output);
+    }
+    std::vector<int64_t> out_sizes = input.sizes().vec();
+    out_sizes.back() = N;
+    return output.view(out_sizes);
+  }
+};
+
+TORCH_LIBRARY_IMPL(quantized, CPU, m) {
+  m.impl(TORCH_SELECTIVE_NAME("quantized::linear_4bit"), TORCH_FN(QLinearNBit<4>::run));
+  m.impl(TORCH_SELECTIVE_NAME("quantized::linear_2bit"), TORCH_FN(QLinearNBit<2>::run));
+}
+
+} // namespace
+} // namespace native
+} // namespace at
@@ -3,6 +3,7 @@
 #include <ATen/native/quantized/cpu/fbgemm_utils.h>
 #include <ATen/native/quantized/cpu/init_qnnpack.h>
 #include <ATen/native/quantized/cpu/packed_params.h>
+#include <ATen/native/quantized/cpu/qembeddingbag_prepack.h>
 #include <ATen/native/quantized/cpu/qnnpack_utils.h>
 #include <ATen/native/quantized/cpu/quant_utils.h>
 #include <ATen/quantized/Quantizer.h>
@@ -320,6 +321,23 @@ class QLinearPackWeightFp16Legacy final {
   }
 };
 
+// Packs the weight of the weight-only quantized::linear_4bit and
+// quantized::linear_2bit: every row (output channel) is quantized with its own
+// fp16 scale and zero_point, in the layout of the n-bit embedding bags.
+template <int bit_width>
+class QLinearPackWeightNBit final {
+ public:
+  static Tensor run(at::Tensor weight) {
+    TORCH_CHECK(
+        weight.dim() == 2 && weight.scalar_type() == at::kFloat,
+        "quantized::linear_prepack_",
+        bit_width,
+        "bit expects a 2-d float weight");
+    return _qembeddingbag_nbit_prepack_helper(
+        weight.contiguous(), bit_width, /*optimized_qparams=*/false);
+  }
+};
+
 TORCH_LIBRARY_IMPL(quantized, QuantizedCPU, m) {
   m.impl(TORCH_SELECTIVE_NAME("quantized::linear_prepack"), TORCH_FN(QLinearPackWeightInt8::run));
   m.impl(TORCH_SELECTIVE_NAME("quantized::linear_prepack_legacy"), TORCH_FN(QLinearPackWeightInt8Legacy::run));
@@ -328,6 +346,8 @@ TORCH_LIBRARY_IMPL(quantized, QuantizedCPU, m) {
 TORCH_LIBRARY_IMPL(quantized, CPU, m) {
   m.impl(TORCH_SELECTIVE_NAME("quantized::linear_prepack_fp16"), TORCH_FN(QLinearPackWeightFp16::run));
   m.impl(TORCH_SELECTIVE_NAME("quantized::linear_prepack_fp16_legacy"), TORCH_FN(QLinearPackWeightFp16Legacy::run));
+  m.impl(TORCH_SELECTIVE_NAME("quantized::linear_prepack_4bit"), TORCH_FN(QLinearPackWeightNBit<4>::run));
+  m.impl(TORCH_SELECTIVE_NAME("quantized::linear_prepack_2bit"), TORCH_FN(QLinearPackWeightNBit<2>::run));
 }
 
 TORCH_LIBRARY_IMPL(_quantized, QuantizedCPU, m) {
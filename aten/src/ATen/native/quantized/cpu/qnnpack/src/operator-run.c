@@ -357,6 +357,7 @@ struct q8dwconv_context {
   size_t output_width;
   size_t output_row_stride;
   size_t output_col_increment;
+  size_t output_pixel_stride;
   union pytorch_qnnp_conv_quantization_params quantization_params;
   union {
     const pytorch_q8dwconv_up_ukernel_function unipass_ukernel;
@@ -364,30 +365,41 @@ struct q8dwconv_context {
   };
 };
 
+// Computes output pixels [output_x, output_x + output_x_size) of one row, see
+// dwconv_output_width_tile.
 static void compute_dwconv_unipass(
     const struct q8dwconv_context context[RESTRICT_STATIC 1],
     size_t image,
-    size_t output_y) {
+    size_t output_y,
+    size_t output_x,
+    size_t image_range /* always 1 */,
+    size_t output_y_range /* always 1 */,
+    size_t output_x_size) {
   const size_t output_height = context->output_height;
 
   context->unipass_ukernel(
       context->groups,
-      context->output_width,
-      context->indirection_buffer +
+      output_x_size,
+      (const uint8_t**)((uintptr_t)(context->indirection_buffer +
           (image * output_height + output_y) *
-              context->indirection_buffer_row_stride,
+              context->indirection_buffer_row_stride) +
+          output_x * context->indirection_buffer_col_stride),
       context->packed_weights,
       context->output +
-          (image * output_height + output_y) * context->output_row_stride,
+          (image * output_height + output_y) * context->output_row_stride +
+          output_x * context->output_pixel_stride,
       context->indirection_buffer_col_stride,
       context->output_col_increment,
       &context->quantization_params);
 }
-
 static void compute_dwconv_multiipass(
     const struct q8dwconv_context context[RESTRICT_STATIC 1],
     size_t image,
-    size_t output_y) {
+    size_t output_y,
+    size_t output_x,
+    size_t image_range /* always 1 */,
+    size_t output_y_range /* always 1 */,
+    size_t output_x_size) {
   const size_t output_height = context->output_height;
   PYTORCH_QNNP_ALIGN(16)
 #ifdef _MSC_VER
@@ -398,14 +410,16 @@ static void compute_dwconv_multiipass(
 
   context->multipass_ukernel(
       context->groups,
-      context->output_width,
-      context->indirection_buffer +
+      output_x_size,
+      (const uint8_t**)((uintptr_t)(context->indirection_buffer +
           (image * output_height + output_y) *
-              context->indirection_buffer_row_stride,
+              context->indirection_buffer_row_stride) +
+          output_x * context->indirection_buffer_col_stride),
       context->packed_weights,
       multipass_acc,
       context->output +
-          (image * output_height + output_y) * context->output_row_stride,
+          (image * output_height + output_y) * context->output_row_stride +
+          output_x * context->output_pixel_stride,
       context->indirection_buffer_col_stride,
       context->output_col_increment,
       &context->quantization_params);
@@ -415,6 +429,25 @@ static void compute_dwconv_multiipass(
 #endif
 }
 
+// Depthwise convolutions are parallelized over the output rows. When there are
+// too few of them to balance the work across the threads of the pool, e.g. for
+// the small spatial sizes at the end of mobile networks, each row is split into
+// tiles of output pixels as well.
+static size_t dwconv_output_width_tile(
+    size_t batch_size,
+    size_t output_height,
+    size_t output_width,
+    pthreadpool_t threadpool) {
+  const size_t threads = pthreadpool_get_threads_count(threadpool);
+  const size_t rows = batch_size * output_height;
+  // aim for a few tasks per thread
+  const size_t target_tasks = threads * 4;
+  if (threads <= 1 || rows >= target_tasks) {
+    return output_width;
+  }
+  return divide_round_up(output_width, divide_round_up(target_tasks, rows));
+}
+
 struct max_pooling_context {
   const void** indirect_input;
   size_t indirect_input_batch_stride;
@@ -814,18 +847,24 @@ enum pytorch_qnnp_status pytorch_qnnp_run_operator(
               .output_row_stride = output_width * op->output_pixel_stride,
               .output_col_increment =
                   (op->output_pixel_stride - groups) * sizeof(uint8_t),
+              .output_pixel_stride = op->output_pixel_stride,
               .quantization_params = op->conv_quantization_params,
               .unipass_ukernel =
                   op->per_channel ?
                       pytorch_qnnp_params.q8dw9.updw_per_channel :
                       pytorch_qnnp_params.q8dw9.updw,
           };
-          pthreadpool_compute_2d(
+          pthreadpool_compute_3d_tiled(
               threadpool,
-              (pthreadpool_function_2d_t)compute_dwconv_unipass,
+              (pthreadpool_function_3d_tiled_t)compute_dwconv_unipass,
               &context,
               batch_size,
-              output_height);
+              output_height,
+              output_width,
+              1,
+              1,
+              dwconv_output_width_tile(
+                  batch_size, output_height, output_width, threadpool));
           break;
         }
         case 25: {
@@ -844,18 +883,24 @@ enum pytorch_qnnp_status pytorch_qnnp_run_operator(
               .output_row_stride = output_width * op->output_pixel_stride,
               .output_col_increment =
                   (op->output_pixel_stride - groups) * sizeof(uint8_t),
+              .output_pixel_stride = op->output_pixel_stride,
               .quantization_params = op->conv_quantization_params,
               .multipass_ukernel =
                   op->per_channel ?
                       pytorch_qnnp_params.q8dw25.mpdw_per_channel :
                       pytorch_qnnp_params.q8dw25.mpdw,
           };
-          pthreadpool_compute_2d(
+          pthreadpool_compute_3d_tiled(
               threadpool,
-              (pthreadpool_function_2d_t)compute_dwconv_multiipass,
+              (pthreadpool_function_3d_tiled_t)compute_dwconv_multiipass,
               &context,
               batch_size,
-              output_height);
+              output_height,
+              output_width,
+              1,
+              1,
+              dwconv_output_width_tile(
+                  batch_size, output_height, output_width, threadpool));
           break;
         }
         default:
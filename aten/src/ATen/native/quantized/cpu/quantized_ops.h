@@ -35,6 +35,17 @@ using qbinary_fn =
     void (*)(Tensor& /*out*/, const Tensor& /*self*/, const Tensor& /*other*/);
 using qadd_scalar_fn =
     void (*)(Tensor& /*out*/, const Tensor& /*self*/, const Scalar& other /*other*/);
+// One step of a fused elementwise chain. Add and Mul take the next of the
+// other operands, Relu takes none.
+enum class QElementwiseOp { Add, Mul, Relu };
+// Computes the chain on the dequantized values of self and others, which
+// broadcast against each other and may be quantized per tensor or per channel,
+// and quantizes the result once into the per tensor quantized out.
+using qelementwise_fn = void (*)(
+    Tensor& /*out*/,
+    const Tensor& /*self*/,
+    TensorList /*others*/,
+    c10::ArrayRef<QElementwiseOp> /*ops*/);
 using qhardswish_fn = void (*)(const at::Tensor& /*qx*/, at::Tensor& /*qy*/);
 using qmaxpool_2d_fn = void (*)(
     const Tensor& qx,
@@ -144,6 +155,14 @@ using qtopk_fn = void(*)(Tensor&, Tensor&, const Tensor&, int64_t, int64_t, bool
 
 using qbatch_norm_fn = void(*)(int64_t, int64_t, int64_t, int64_t, int64_t, const Tensor&, const Tensor&, const Tensor&, Tensor&);
 
+// Weight-only linear on weights packed by _qembeddingbag_nbit_prepack_helper
+using qlinear_nbit_fn = void (*)(
+    const Tensor& /* input */,
+    const Tensor& /* packed_weight */,
+    const Tensor& /* bias, undefined if absent */,
+    int64_t /* bit_width */,
+    Tensor& /* output */);
+
 using qnormalize_fn = void (*)(
     const Tensor& /* X */,
     const Tensor& /* gamma */,
@@ -173,9 +192,11 @@ DECLARE_DISPATCH(qcat_nhwc_fn, qcat_relu_nhwc_stub);
 DECLARE_DISPATCH(qclamp_fn, qclamp_stub);
 DECLARE_DISPATCH(qclamp_minmax_fn, qclamp_min_stub);
 DECLARE_DISPATCH(qclamp_minmax_fn, qclamp_max_stub);
+DECLARE_DISPATCH(qelementwise_fn, qelementwise_stub);
 DECLARE_DISPATCH(qelu_fn, qelu_stub);
 DECLARE_DISPATCH(qhardsigmoid_fn, qhardsigmoid_stub);
 DECLARE_DISPATCH(qhardswish_fn, qhardswish_stub);
+DECLARE_DISPATCH(qlinear_nbit_fn, qlinear_nbit_stub);
 DECLARE_DISPATCH(qmaxpool_2d_fn, qmaxpool_2d_nhwc_stub);
 DECLARE_DISPATCH(qnormalize_fn, quantized_normalize_stub);
 DECLARE_DISPATCH(qrelu_fn, qrelu6_stub);
@@ -56,6 +56,16 @@ void dequantize_tensor_per_tensor_affine_cuda(
       });
 }
 
+void quantize_int8_symmetric_cuda(TensorIterator& iter) {
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      kHalf, kBFloat16, iter.input_dtype(0), "quantize_int8_symmetric_cuda", [&]() {
+        gpu_kernel(iter, [] GPU_LAMBDA(scalar_t self, float scale) -> int8_t {
+          const float qval = nearbyintf(static_cast<float>(self) / scale);
+          return static_cast<int8_t>(fminf(fmaxf(qval, -127.0f), 127.0f));
+        });
+      });
+}
+
 } // anonymous namespace
 
 REGISTER_DISPATCH(
@@ -64,6 +74,9 @@ REGISTER_DISPATCH(
 REGISTER_DISPATCH(
     dequantize_tensor_per_tensor_affine_stub,
     &dequantize_tensor_per_tensor_affine_cuda);
+REGISTER_DISPATCH(
+    quantize_int8_symmetric_stub,
+    &quantize_int8_symmetric_cuda);
 
 } // namespace native
 } // namespace at
@@ -136,7 +136,25 @@ void _fake_quantize_grad_learnable_channel_kernel_cuda(TensorIterator &iter, int
     });
 }
 
+// Fake quantize with qparams computed on device
+
+void fake_quant_tensor_qparams_cachemask_cuda(
+    TensorIterator &iter, int64_t quant_min, int64_t quant_max) {
+  gpu_kernel_multiple_outputs(iter,
+    [=] GPU_LAMBDA (float input_val, float scale, int64_t zero_point, bool fake_quant_on) -> thrust::tuple<float, bool> {
+      if (!fake_quant_on) {
+        return {input_val, true};
+      }
+      float inv_scale = 1.0f / scale;
+      const auto qval = static_cast<int64_t>(std::nearbyint(input_val * inv_scale) + zero_point);
+      return {
+        (fminf(quant_max, fmaxf(quant_min, qval)) - zero_point) * scale,
+        ((quant_min <= qval) && (qval <= quant_max))};
+    });
+}
+
 REGISTER_DISPATCH(fake_quant_per_channel_cachemask_stub, &fake_quant_per_channel_cachemask_cuda);
+REGISTER_DISPATCH(fake_quant_tensor_qparams_cachemask_stub, &fake_quant_tensor_qparams_cachemask_cuda);
 REGISTER_DISPATCH(fake_quant_grad_learnable_channel_stub, &_fake_quantize_grad_learnable_channel_kernel_cuda);
 
 } // namespace native
@@ -0,0 +1,97 @@
+#include <ATen/native/TensorIterator.h>
+#include <ATen/native/cuda/Loops.cuh>
+#include <ATen/native/quantized/cuda/int8_utils.h>
+#include <math.h>
+
+namespace at {
+namespace native {
+
+namespace {
+
+template <typename acc_t>
+void int8_requantize_kernel(TensorIterator& iter, float inv_scale, int64_t zero_point, bool relu) {
+  const int64_t qmin = relu ? zero_point : 0;
+  constexpr int64_t qmax = 255;
+  gpu_kernel(
+      iter,
+      [=] GPU_LAMBDA(acc_t acc, float offset, float scale, float bias) -> c10::quint8 {
+        const float value = (static_cast<float>(acc) + offset) * scale + bias;
+        int64_t qvalue = static_cast<int64_t>(nearbyint(value * inv_scale) + zero_point);
+        qvalue = std::max<int64_t>(qvalue, qmin);
+        qvalue = std::min<int64_t>(qvalue, qmax);
+        return c10::quint8(static_cast<uint8_t>(qvalue));
+      });
+}
+
+} // namespace
+
+Int8Weight int8_weight_cuda(const Tensor& qweight, MemoryFormat memory_format) {
+  TORCH_CHECK(
+      qweight.is_cuda() && qweight.scalar_type() == kQInt8,
+      "Expected a qint8 CUDA weight");
+  const int64_t out_channels = qweight.size(0);
+  Tensor scales;
+  if (qweight.qscheme() == kPerTensorAffine) {
+    TORCH_CHECK(
+        qweight.q_zero_point() == 0,
+        "Quantized CUDA ops only support symmetrically quantized weights");
+    scales = at::full(
+        {out_channels}, qweight.q_scale(), qweight.options().dtype(kFloat));
+  } else {
+    TORCH_CHECK(
+        qweight.qscheme() == kPerChannelAffine &&
+            qweight.q_per_channel_axis() == 0 &&
+            qweight.q_per_channel_zero_points().eq(0).all().item<bool>(),
+        "Quantized CUDA ops only support symmetrically quantized weights, "
+        "per tensor or per output channel");
+    scales = qweight.q_per_channel_scales().to(qweight.device(), kFloat);
+  }
+  auto values = qweight.int_repr().contiguous(memory_format);
+  auto sums = values.reshape({out_channels, -1}).sum(1, false, kFloat);
+  return {values, scales, sums};
+}
+
+Tensor quint8_to_int8_cuda(const Tensor& qx) {
+  TORCH_CHECK(
+      qx.scalar_type() == kQUInt8, "Expected a quint8 tensor, got ", qx.scalar_type());
+  auto out = at::empty(
+      qx.sizes(), qx.options().dtype(kChar), qx.suggest_memory_format());
+  auto iter = TensorIteratorConfig()
+    .check_all_same_dtype(false)
+    .add_output(out)
+    .add_input(qx)
+    .build();
+  // flipping the sign bit maps 0..255 to -128..127
+  gpu_kernel(iter, [] GPU_LAMBDA(c10::quint8 value) -> int8_t {
+    return static_cast<int8_t>(value.val_ ^ 0x80);
+  });
+  return out;
+}
+
+void int8_requantize_cuda(
+    const Tensor& acc,
+    const Tensor& offset,
+    const Tensor& scale,
+    const Tensor& bias,
+    bool relu,
+    Tensor& out) {
+  TORCH_INTERNAL_ASSERT(out.scalar_type() == kQUInt8);
+  auto iter = TensorIteratorConfig()
+    .check_all_same_dtype(false)
+    .add_output(out)
+    .add_input(acc)
+    .add_input(offset)
+    .add_input(scale)
+    .add_input(bias)
+    .build();
+  const float inv_scale = 1.0f / static_cast<float>(out.q_scale());
+  if (acc.scalar_type() == kInt) {
+    int8_requantize_kernel<int32_t>(iter, inv_scale, out.q_zero_point(), relu);
+  } else {
+    TORCH_INTERNAL_ASSERT(acc.scalar_type() == kFloat);
+    int8_requantize_kernel<float>(iter, inv_scale, out.q_zero_point(), relu);
+  }
+}
+
+} // namespace native
+} // namespace at
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+namespace at {
+namespace native {
+
+// Helpers of the int8 GEMM and convolution of the quantized CUDA ops, see
+// Note [Quantized CUDA ops]
+
+// A prepacked qint8 weight whose first dimension is the output channels
+struct Int8Weight {
+  // the int8 values, in the memory format the kernel expects them in
+  Tensor values;
+  // the float scale of every output channel
+  Tensor scales;
+  // the float sum of the values of every output channel
+  Tensor sums;
+};
+
+// Only symmetrically quantized weights (zero points 0) are supported, per
+// tensor or per output channel.
+Int8Weight int8_weight_cuda(const Tensor& qweight, MemoryFormat memory_format);
+
+// The int8 values qx - 128 of a quint8 tensor, in the same memory format.
+Tensor quint8_to_int8_cuda(const Tensor& qx);
+
+// Requantizes the accumulators acc (int32, or float holding int32 values) of
+// an int8 GEMM or convolution into the quint8 tensor out of the same shape:
+//   out = quantize((acc + offset) * scale + bias)
+// with the output scale and zero point of out. offset, scale and bias are
+// float tensors broadcast against acc. With relu, the output is clamped below
+// at the zero point.
+void int8_requantize_cuda(
+    const Tensor& acc,
+    const Tensor& offset,
+    const Tensor& scale,
+    const Tensor& bias,
+    bool relu,
+    Tensor& out);
+
+} // namespace native
+} // namespace at
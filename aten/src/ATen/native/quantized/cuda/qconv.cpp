@@ -0,0 +1,293 @@
+#include <ATen/cuda/CUDAConfig.h>  // for the definition of AT_CUDNN_ENABLED
+
+#if AT_CUDNN_ENABLED()
+
+#include <ATen/ATen.h>
+#include <ATen/cudnn/Descriptors.h>
+#include <ATen/cudnn/Handle.h>
+#include <ATen/native/quantized/cpu/conv_packed_params.h>
+#include <ATen/native/quantized/cuda/int8_utils.h>
+#include <torch/library.h>
+
+namespace at {
+namespace native {
+namespace {
+
+// Runs quantized::conv2d through the int8 convolution of cuDNN, see
+// Note [Quantized CUDA ops] in qlinear.cpp. cuDNN takes int8 NHWC inputs and
+// filters and writes the int32 accumulators as floats.
+struct PackedConvWeightCudnn : public ConvPackedParamsBase<2> {
+  PackedConvWeightCudnn(
+      at::Tensor orig_weight,
+      c10::optional<at::Tensor> bias,
+      torch::List<int64_t> stride,
+      torch::List<int64_t> padding,
+      torch::List<int64_t> dilation,
+      int64_t groups)
+      : orig_weight(std::move(orig_weight)),
+        bias_(std::move(bias)),
+        stride_(std::move(stride)),
+        padding_(std::move(padding)),
+        dilation_(std::move(dilation)),
+        groups_(groups) {
+    TORCH_CHECK(
+        this->orig_weight.dim() == 4,
+        "quantized::conv2d_prepack (cuda): weight should be 4-dimensional");
+    TORCH_CHECK(
+        stride_.size() == 2 && padding_.size() == 2 && dilation_.size() == 2,
+        "quantized::conv2d_prepack (cuda): stride, padding and dilation "
+        "should have 2 elements");
+    TORCH_CHECK(
+        groups_ == 1,
+        "quantized::conv2d (cuda) does not support grouped convolutions");
+    const int64_t out_channels = this->orig_weight.size(0);
+    const int64_t in_channels = this->orig_weight.size(1);
+    TORCH_CHECK(
+        out_channels % 4 == 0 && in_channels % 4 == 0,
+        "quantized::conv2d (cuda) requires the numbers of input and output "
+        "channels to be multiples of 4, got ",
+        in_channels,
+        " and ",
+        out_channels);
+    weight =
+        int8_weight_cuda(this->orig_weight, at::MemoryFormat::ChannelsLast);
+    if (bias_.has_value()) {
+      TORCH_CHECK(
+          bias_->dim() == 1 && bias_->size(0) == out_channels,
+          "bias should have K elements: " + std::to_string(out_channels));
+      bias_or_zeros = bias_->to(this->orig_weight.device(), at::kFloat);
+    } else {
+      bias_or_zeros = at::zeros({out_channels}, weight.scales.options());
+    }
+  }
+
+  at::Tensor orig_weight;
+  c10::optional<at::Tensor> bias_;
+  torch::List<int64_t> stride_;
+  torch::List<int64_t> padding_;
+  torch::List<int64_t> dilation_;
+  int64_t groups_;
+  Int8Weight weight;
+  at::Tensor bias_or_zeros;
+
+  at::Tensor apply(
+      const at::Tensor& input,
+      double output_scale,
+      int64_t output_zero_point) override {
+    return apply_impl(input, output_scale, output_zero_point, false);
+  }
+  at::Tensor apply_relu(
+      const at::Tensor& input,
+      double output_scale,
+      int64_t output_zero_point) override {
+    return apply_impl(input, output_scale, output_zero_point, true);
+  }
+
+  std::tuple<at::Tensor, c10::optional<at::Tensor>> unpack() override {
+    return std::make_tuple(orig_weight, bias_);
+  }
+
+  torch::List<int64_t> stride() const override {
+    return stride_;
+  }
+  torch::List<int64_t> padding() const override {
+    return padding_;
+  }
+  torch::List<int64_t> output_padding() const override {
+    return torch::List<int64_t>({0, 0});
+  }
+  torch::List<int64_t> dilation() const override {
+    return dilation_;
+  }
+  int64_t groups() const override {
+    return groups_;
+  }
+  bool transpose() const override {
+    return false;
+  }
+
+ private:
+  at::Tensor apply_impl(
+      const at::Tensor& input,
+      double output_scale,
+      int64_t output_zero_point,
+      bool relu) {
+    TORCH_CHECK(
+        input.is_cuda() && input.scalar_type() == at::kQUInt8 &&
+            input.qscheme() == at::kPerTensorAffine && input.dim() == 4,
+        "quantized::conv2d (cuda) expects a 4-dimensional quint8 CUDA input "
+        "quantized per tensor");
+    TORCH_CHECK(
+        input.size(1) == orig_weight.size(1),
+        "quantized::conv2d (cuda): expected ",
+        orig_weight.size(1),
+        " input channels, got ",
+        input.size(1));
+
+    auto x = quint8_to_int8_cuda(
+        input.contiguous(at::MemoryFormat::ChannelsLast));
+    // cuDNN pads with zeros, which stand for 128 after the shift, so the
+    // padding is done here with the zero point of the input instead
+    const int64_t pad_h = padding_.get(0);
+    const int64_t pad_w = padding_.get(1);
+    if (pad_h != 0 || pad_w != 0) {
+      x = at::constant_pad_nd(
+              x, {pad_w, pad_w, pad_h, pad_h}, input.q_zero_point() - 128)
+              .contiguous(at::MemoryFormat::ChannelsLast);
+    }
+
+    const int64_t batch = x.size(0);
+    const int64_t in_channels = x.size(1);
+    const int64_t out_channels = orig_weight.size(0);
+    std::vector<int64_t> output_size{batch, out_channels};
+    for (int64_t i = 0; i < 2; ++i) {
+      const int64_t kernel =
+          dilation_.get(i) * (orig_weight.size(i + 2) - 1) + 1;
+      output_size.push_back((x.size(i + 2) - kernel) / stride_.get(i) + 1);
+    }
+    TORCH_CHECK(
+        output_size[2] > 0 && output_size[3] > 0,
+        "quantized::conv2d (cuda): the input is smaller than the kernel");
+    auto acc = at::empty(
+        output_size,
+        x.options().dtype(at::kFloat),
+        at::MemoryFormat::ChannelsLast);
+
+    if (batch > 0) {
+      TensorDescriptor x_desc;
+      AT_CUDNN_CHECK(cudnnSetTensor4dDescriptor(
+          x_desc.mut_desc(),
+          CUDNN_TENSOR_NHWC,
+          CUDNN_DATA_INT8,
+          batch,
+          in_channels,
+          x.size(2),
+          x.size(3)));
+      FilterDescriptor w_desc;
+      AT_CUDNN_CHECK(cudnnSetFilter4dDescriptor(
+          w_desc.mut_desc(),
+          CUDNN_DATA_INT8,
+          CUDNN_TENSOR_NHWC,
+          out_channels,
+          in_channels,
+          orig_weight.size(2),
+          orig_weight.size(3)));
+      TensorDescriptor y_desc;
+      AT_CUDNN_CHECK(cudnnSetTensor4dDescriptor(
+          y_desc.mut_desc(),
+          CUDNN_TENSOR_NHWC,
+          CUDNN_DATA_FLOAT,
+          batch,
+          out_channels,
+          output_size[2],
+          output_size[3]));
+      int pad[2] = {0, 0};
+      int stride[2] = {
+          static_cast<int>(stride_.get(0)), static_cast<int>(stride_.get(1))};
+      int dilation[2] = {static_cast<int>(dilation_.get(0)),
+                         static_cast<int>(dilation_.get(1))};
+      ConvolutionDescriptor conv_desc;
+      conv_desc.set(
+          CUDNN_DATA_INT32,
+          2,
+          pad,
+          stride,
+          dilation,
+          groups_,
+          /*allow_tf32=*/false);
+
+      // the only algorithm supporting int8 inputs
+      const auto algo = CUDNN_CONVOLUTION_FWD_ALGO_IMPLICIT_PRECOMP_GEMM;
+      cudnnHandle_t handle = getCudnnHandle();
+      size_t workspace_size = 0;
+      AT_CUDNN_CHECK(cudnnGetConvolutionForwardWorkspaceSize(
+          handle,
+          x_desc.desc(),
+          w_desc.desc(),
+          conv_desc.desc(),
+          y_desc.desc(),
+          algo,
+          &workspace_size));
+      auto workspace = at::empty(
+          {static_cast<int64_t>(workspace_size)}, x.options().dtype(at::kByte));
+      const float alpha = 1;
+      const float beta = 0;
+      AT_CUDNN_CHECK(cudnnConvolutionForward(
+          handle,
+          &alpha,
+          x_desc.desc(),
+          x.data_ptr(),
+          w_desc.desc(),
+          weight.values.data_ptr(),
+          conv_desc.desc(),
+          algo,
+          workspace.data_ptr(),
+          workspace_size,
+          &beta,
+          y_desc.desc(),
+          acc.data_ptr()));
+    }
+
+    // see Note [Quantized CUDA ops]
+    const auto offset =
+        (weight.sums * static_cast<double>(128 - input.q_zero_point()))
+            .view({1, -1, 1, 1});
+    const auto scale = (weight.scales * input.q_scale()).view({1, -1, 1, 1});
+    auto output = at::_empty_affine_quantized(
+        output_size,
+        input.options().dtype(at::kQUInt8),
+        output_scale,
+        output_zero_point,
+        at::MemoryFormat::ChannelsLast);
+    int8_requantize_cuda(
+        acc, offset, scale, bias_or_zeros.view({1, -1, 1, 1}), relu, output);
+    return output;
+  }
+};
+
+class QConvPackWeightInt8Cudnn final {
+ public:
+  static c10::intrusive_ptr<ConvPackedParamsBase<2>> run_conv(
+      Tensor weight,
+      c10::optional<Tensor> bias,
+      torch::List<int64_t> stride,
+      torch::List<int64_t> padding,
+      torch::List<int64_t> dilation,
+      int64_t groups) {
+    return c10::make_intrusive<PackedConvWeightCudnn>(
+        std::move(weight),
+        std::move(bias),
+        std::move(stride),
+        std::move(padding),
+        std::move(dilation),
+        groups);
+  }
+};
+
+template <bool kReluFused>
+class QConvInt8Cudnn final {
+ public:
+  static Tensor run(
+      Tensor act,
+      const c10::intrusive_ptr<ConvPackedParamsBase<2>>& packed_weight,
+      double output_scale,
+      int64_t output_zero_point) {
+    if (kReluFused) {
+      return packed_weight->apply_relu(act, output_scale, output_zero_point);
+    } else {
+      return packed_weight->apply(act, output_scale, output_zero_point);
+    }
+  }
+};
+
+TORCH_LIBRARY_IMPL(quantized, QuantizedCUDA, m) {
+  m.impl(TORCH_SELECTIVE_NAME("quantized::conv2d_prepack"), TORCH_FN(QConvPackWeightInt8Cudnn::run_conv));
+  m.impl(TORCH_SELECTIVE_NAME("quantized::conv2d.new"), QConvInt8Cudnn<false>::run);
+  m.impl(TORCH_SELECTIVE_NAME("quantized::conv2d_relu.new"), QConvInt8Cudnn<true>::run);
+}
+
+} // namespace
+} // namespace native
+} // namespace at
+
+#endif  // AT_CUDNN_ENABLED()
@@ -0,0 +1,201 @@
+#include <ATen/ATen.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/Exceptions.h>
+#include <ATen/native/quantized/cpu/packed_params.h>
+#include <ATen/native/quantized/cuda/int8_utils.h>
+#include <torch/library.h>
+
+// Note [Quantized CUDA ops]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~
+// quantized::linear and quantized::conv2d (and their prepack and relu
+// variants) are registered for QuantizedCUDA, so that a model quantized with
+// the usual tooling can run on the GPU once its quantized tensors and packed
+// weights are on it. The prepack ops take qint8 CUDA weights, which have to be
+// quantized symmetrically, per tensor or per output channel; activations are
+// quint8 quantized per tensor.
+//
+// Activations are converted to int8 by subtracting 128 (flipping the sign
+// bit). The int8 GEMM (cublasGemmEx, run on the IMMA tensor cores where
+// available) and the int8 convolution (cuDNN, NHWC) accumulate in int32, and
+// a single elementwise kernel then adds back the shift and the zero point of
+// the input, as
+//   sum_k (qx_k - x_zp) * w_k = sum_k (qx_k - 128) * w_k + (128 - x_zp) * sum_k w_k
+// dequantizes, adds the bias and requantizes to the output qparams.
+//
+// The int8 kernels require the input and output channels to be multiples of
+// 4. Packed weights are serialized through unpack like their CPU
+// counterparts, and are packed for the CPU when they are loaded.
+
+namespace at {
+namespace native {
+namespace {
+
+// acc (M x N) = x (M x K) * w^T, where w is N x K
+void int8_gemm(const Tensor& x, const Tensor& w, Tensor& acc) {
+  const int64_t M = x.size(0);
+  const int64_t K = x.size(1);
+  const int64_t N = w.size(0);
+  const int32_t alpha = 1;
+  const int32_t beta = 0;
+  // cuBLAS is column major: acc^T (N x M) = w (N x K) * x^T (K x M)
+  TORCH_CUDABLAS_CHECK(cublasGemmEx(
+      at::cuda::getCurrentCUDABlasHandle(),
+      CUBLAS_OP_T,
+      CUBLAS_OP_N,
+      N,
+      M,
+      K,
+      &alpha,
+      w.data_ptr<int8_t>(),
+      CUDA_R_8I,
+      K,
+      x.data_ptr<int8_t>(),
+      CUDA_R_8I,
+      K,
+      &beta,
+      acc.data_ptr<int32_t>(),
+      CUDA_R_32I,
+      N,
+#if defined(CUDA_VERSION) && CUDA_VERSION >= 11000
+      CUBLAS_COMPUTE_32I,
+#else
+      CUDA_R_32I,
+#endif
+      CUBLAS_GEMM_DEFAULT_TENSOR_OP));
+}
+
+struct PackedLinearWeightCuda : public LinearPackedParamsBase {
+  PackedLinearWeightCuda(at::Tensor orig_weight, c10::optional<at::Tensor> bias)
+      : orig_weight(std::move(orig_weight)), bias_(std::move(bias)) {
+    TORCH_CHECK(
+        this->orig_weight.dim() == 2,
+        "quantized::linear_prepack (cuda): weight should be 2-dimensional");
+    weight = int8_weight_cuda(this->orig_weight, at::MemoryFormat::Contiguous);
+    const int64_t N = this->orig_weight.size(0);
+    const int64_t K = this->orig_weight.size(1);
+    TORCH_CHECK(
+        N % 4 == 0 && K % 4 == 0,
+        "quantized::linear (cuda) requires the numbers of input and output "
+        "features to be multiples of 4, got ",
+        K,
+        " and ",
+        N);
+    if (bias_.has_value()) {
+      TORCH_CHECK(
+          bias_->dim() == 1 && bias_->size(0) == N,
+          "bias should have N elements: " + std::to_string(N));
+      bias_or_zeros = bias_->to(this->orig_weight.device(), at::kFloat);
+    } else {
+      bias_or_zeros = at::zeros({N}, weight.scales.options());
+    }
+  }
+
+  at::Tensor orig_weight;
+  c10::optional<at::Tensor> bias_;
+  Int8Weight weight;
+  at::Tensor bias_or_zeros;
+
+  at::Tensor apply(
+      at::Tensor input,
+      double output_scale,
+      int64_t output_zero_point) override {
+    return apply_impl(std::move(input), output_scale, output_zero_point, false);
+  }
+  at::Tensor apply_relu(
+      at::Tensor input,
+      double output_scale,
+      int64_t output_zero_point) override {
+    return apply_impl(std::move(input), output_scale, output_zero_point, true);
+  }
+
+  at::Tensor apply_dynamic(at::Tensor input, bool reduce_range) override {
+    TORCH_CHECK(false, "quantized::linear_dynamic is not supported on CUDA");
+  }
+  at::Tensor apply_dynamic_relu(at::Tensor input, bool reduce_range) override {
+    TORCH_CHECK(false, "quantized::linear_relu_dynamic is not supported on CUDA");
+  }
+
+  std::tuple<at::Tensor, c10::optional<at::Tensor>> unpack() override {
+    return std::make_tuple(orig_weight, bias_);
+  }
+
+  c10::optional<at::Tensor> bias() override {
+    return bias_;
+  }
+
+ private:
+  at::Tensor apply_impl(
+      at::Tensor input,
+      double output_scale,
+      int64_t output_zero_point,
+      bool relu) {
+    TORCH_CHECK(
+        input.is_cuda() && input.scalar_type() == at::kQUInt8 &&
+            input.qscheme() == at::kPerTensorAffine,
+        "quantized::linear (cuda) expects a quint8 CUDA input quantized per tensor");
+    TORCH_CHECK(
+        input.dim() >= 1 && input.size(-1) == orig_weight.size(1),
+        "The last dimension of the input should be ",
+        orig_weight.size(1));
+    const int64_t K = orig_weight.size(1);
+    const int64_t N = orig_weight.size(0);
+    auto x = quint8_to_int8_cuda(input.reshape({-1, K}).contiguous());
+    auto acc = at::empty({x.size(0), N}, x.options().dtype(at::kInt));
+    if (acc.numel() > 0) {
+      int8_gemm(x, weight.values, acc);
+    }
+
+    // see Note [Quantized CUDA ops]
+    const auto offset =
+        weight.sums * static_cast<double>(128 - input.q_zero_point());
+    const auto scale = weight.scales * input.q_scale();
+    auto output = at::_empty_affine_quantized(
+        {x.size(0), N},
+        input.options().dtype(at::kQUInt8),
+        output_scale,
+        output_zero_point);
+    int8_requantize_cuda(acc, offset, scale, bias_or_zeros, relu, output);
+
+    std::vector<int64_t> out_sizes = input.sizes().vec();
+    out_sizes.back() = N;
+    return output.reshape(out_sizes);
+  }
+};
+
+class QLinearPackWeightInt8Cuda final {
+ public:
+  static c10::intrusive_ptr<LinearPackedParamsBase> run(
+      at::Tensor weight,
+      c10::optional<Tensor> bias) {
+    return c10::make_intrusive<PackedLinearWeightCuda>(
+        std::move(weight), std::move(bias));
+  }
+};
+
+template <bool ReluFused>
+class QLinearInt8Cuda final {
+ public:
+  static at::Tensor run(
+      at::Tensor input,
+      const c10::intrusive_ptr<LinearPackedParamsBase>& packed_weight,
+      double output_scale,
+      int64_t output_zero_point) {
+    if (ReluFused) {
+      return packed_weight->apply_relu(
+          std::move(input), output_scale, output_zero_point);
+    } else {
+      return packed_weight->apply(
+          std::move(input), output_scale, output_zero_point);
+    }
+  }
+};
+
+TORCH_LIBRARY_IMPL(quantized, QuantizedCUDA, m) {
+  m.impl(TORCH_SELECTIVE_NAME("quantized::linear_prepack"), TORCH_FN(QLinearPackWeightInt8Cuda::run));
+  m.impl(TORCH_SELECTIVE_NAME("quantized::linear"), TORCH_FN(QLinearInt8Cuda<false>::run));
+  m.impl(TORCH_SELECTIVE_NAME("quantized::linear_relu"), TORCH_FN(QLinearInt8Cuda<true>::run));
+}
+
+} // namespace
+} // namespace native
+} // namespace at
@@ -51,5 +51,14 @@ using fake_quant_learnable_per_channel_fn = void (*)(
 
 DECLARE_DISPATCH(fake_quant_learnable_per_channel_fn, fake_quant_grad_learnable_channel_stub);
 
+// Fake quantizes with scale and zero point broadcast by the iterator, gated by
+// a bool input, so that no scalar has to be read back to the host.
+using fake_quant_tensor_qparams_cachemask_fn = void (*)(
+    TensorIterator &iter,
+    int64_t quant_min,
+    int64_t quant_max);
+
+DECLARE_DISPATCH(fake_quant_tensor_qparams_cachemask_fn, fake_quant_tensor_qparams_cachemask_stub);
+
 } // namespace native
 } // namespace at
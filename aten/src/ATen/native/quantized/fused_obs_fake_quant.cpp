@@ -0,0 +1,203 @@
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/native/TensorIterator.h>
+#include <ATen/native/quantized/fake_quant_affine.h>
+
+#include <limits>
+#include <tuple>
+
+// Fused observer and FakeQuantize op for quantization aware training.
+namespace at {
+namespace native {
+
+// Use REGISTER_DISPATCH to run CPU and CUDA backend.
+DEFINE_DISPATCH(fake_quant_tensor_qparams_cachemask_stub);
+
+namespace {
+
+// Smallest scale the observers produce, torch.finfo(torch.float32).eps
+constexpr double kEps = 1.1920928955078125e-07;
+
+// Moves running_min and running_max towards the min and max of self, over the
+// whole tensor or per slice of ch_axis. A running value still at +-inf (never
+// observed) is replaced by the current one.
+void update_running_min_max(
+    const Tensor& self,
+    const Tensor& observer_on,
+    Tensor& running_min,
+    Tensor& running_max,
+    double averaging_const,
+    int64_t ch_axis,
+    bool per_row_fake_quant) {
+  Tensor x_min, x_max;
+  if (per_row_fake_quant) {
+    std::tie(x_min, x_max) =
+        at::_aminmax(self.transpose(0, ch_axis).reshape({self.size(ch_axis), -1}), 1);
+  } else {
+    std::tie(x_min, x_max) = at::_aminmax(self);
+  }
+  if (running_min.numel() != x_min.numel()) {
+    running_min.resize_(x_min.sizes()).fill_(std::numeric_limits<float>::infinity());
+    running_max.resize_(x_min.sizes()).fill_(-std::numeric_limits<float>::infinity());
+  }
+  x_min = x_min.view(running_min.sizes());
+  x_max = x_max.view(running_max.sizes());
+
+  const auto first = at::isinf(running_min).logical_and_(at::isinf(running_max));
+  const auto new_min = at::where(
+      first, x_min, running_min + (x_min - running_min) * averaging_const);
+  const auto new_max = at::where(
+      first, x_max, running_max + (x_max - running_max) * averaging_const);
+  running_min.copy_(at::where(observer_on, new_min, running_min));
+  running_max.copy_(at::where(observer_on, new_max, running_max));
+}
+
+// Same qparams as the observers' _calculate_qparams, computed on device.
+void update_qparams(
+    const Tensor& observer_on,
+    const Tensor& running_min,
+    const Tensor& running_max,
+    Tensor& scale,
+    Tensor& zero_point,
+    int64_t quant_min,
+    int64_t quant_max,
+    bool symmetric_quant) {
+  const auto min_neg = at::clamp_max(running_min, 0);
+  const auto max_pos = at::clamp_min(running_max, 0);
+  Tensor new_scale, new_zero_point;
+  if (symmetric_quant) {
+    new_scale = at::clamp_min(
+        at::max(min_neg.neg(), max_pos) / ((quant_max - quant_min) / 2.0),
+        kEps);
+    new_zero_point = at::full_like(
+        new_scale,
+        quant_min < 0 ? 0 : (quant_min + quant_max + 1) / 2,
+        zero_point.scalar_type());
+  } else {
+    new_scale = at::clamp_min(
+        (max_pos - min_neg) / static_cast<double>(quant_max - quant_min),
+        kEps);
+    new_zero_point = at::round(min_neg / new_scale)
+                         .neg_()
+                         .add_(quant_min)
+                         .clamp_(quant_min, quant_max)
+                         .to(zero_point.scalar_type());
+  }
+  if (scale.numel() != new_scale.numel()) {
+    scale.resize_(new_scale.sizes()).fill_(1);
+    zero_point.resize_(new_scale.sizes()).zero_();
+  }
+  scale.copy_(at::where(observer_on, new_scale.view(scale.sizes()), scale));
+  zero_point.copy_(
+      at::where(observer_on, new_zero_point.view(zero_point.sizes()), zero_point));
+}
+
+} // namespace
+
+/* Observes self with a moving average min/max observer, computes the qparams
+and fake quantizes self with them, the way FakeQuantize with a
+MovingAverage(PerChannel)MinMaxObserver does, but in a few kernels and without
+reading anything back to the host.
+
+Args:
+  self: Forward input tensor.
+  observer_on, fake_quant_on: one element flags, on the device of self, so
+    that toggling them does not need a sync either.
+  running_min, running_max: observer state, updated in place if observer_on.
+  scale, zero_point: qparams, updated in place if observer_on.
+  averaging_const: weight of the new min and max in the moving average.
+  ch_axis, per_row_fake_quant: observe and fake quantize per slice of ch_axis.
+  symmetric_quant: compute symmetric instead of affine qparams.
+Returns:
+  The fake quantized tensor (self if fake_quant_on is false) and the mask of
+  the elements within the quantization range.
+*/
+std::tuple<Tensor, Tensor> _fused_moving_avg_obs_fq_helper(
+    const Tensor& self,
+    const Tensor& observer_on,
+    const Tensor& fake_quant_on,
+    Tensor& running_min,
+    Tensor& running_max,
+    Tensor& scale,
+    Tensor& zero_point,
+    const double averaging_const,
+    const int64_t quant_min,
+    const int64_t quant_max,
+    const int64_t ch_axis,
+    bool per_row_fake_quant,
+    bool symmetric_quant) {
+  TORCH_CHECK(self.scalar_type() == ScalarType::Float);
+  TORCH_CHECK(
+      observer_on.numel() == 1 && fake_quant_on.numel() == 1,
+      "observer_on and fake_quant_on must have one element");
+  TORCH_CHECK(
+      running_min.scalar_type() == ScalarType::Float &&
+          running_max.scalar_type() == ScalarType::Float,
+      "running_min and running_max must be Float");
+  TORCH_CHECK(
+      scale.scalar_type() == ScalarType::Float,
+      "Scale must be Float, found ", scale.scalar_type());
+  TORCH_CHECK(
+      quant_min <= quant_max,
+      "`quant_min` should be less than or equal to `quant_max`.");
+  if (per_row_fake_quant) {
+    TORCH_CHECK(
+        ch_axis >= 0 && ch_axis < self.dim(),
+        "`ch_axis` must be between 0 and number of dimensions of input");
+  }
+  if (self.numel() == 0) {
+    return std::make_tuple(self.clone(), at::ones_like(self, at::kBool));
+  }
+
+  const auto observe = observer_on.to(at::kBool).reshape({});
+  update_running_min_max(
+      self, observe, running_min, running_max, averaging_const, ch_axis,
+      per_row_fake_quant);
+  update_qparams(
+      observe, running_min, running_max, scale, zero_point, quant_min,
+      quant_max, symmetric_quant);
+
+  auto Y = at::empty_like(self, self.options(), MemoryFormat::Preserve);
+  auto mask = at::empty_like(self, at::kBool, MemoryFormat::Preserve);
+
+  std::vector<int64_t> expected_shape(self.dim(), 1);
+  if (per_row_fake_quant) {
+    expected_shape[ch_axis] = self.size(ch_axis);
+  }
+  TensorIterator iter = TensorIteratorConfig()
+    .check_all_same_dtype(false)
+    .add_output(Y)
+    .add_output(mask)
+    .add_input(self)
+    .add_input(native::_unsafe_view(scale, expected_shape))
+    .add_input(native::_unsafe_view(zero_point.to(at::kLong), expected_shape))
+    .add_input(native::_unsafe_view(
+        fake_quant_on.to(at::kBool), std::vector<int64_t>(self.dim(), 1)))
+    .build();
+  fake_quant_tensor_qparams_cachemask_stub(
+      iter.device_type(), iter, quant_min, quant_max);
+  return std::make_tuple(Y, mask);
+}
+
+Tensor fused_moving_avg_obs_fake_quant(
+    const Tensor& self,
+    const Tensor& observer_on,
+    const Tensor& fake_quant_on,
+    Tensor& running_min,
+    Tensor& running_max,
+    Tensor& scale,
+    Tensor& zero_point,
+    const double averaging_const,
+    const int64_t quant_min,
+    const int64_t quant_max,
+    const int64_t ch_axis,
+    bool per_row_fake_quant,
+    bool symmetric_quant) {
+  return std::get<0>(at::_fused_moving_avg_obs_fq_helper(
+      self, observer_on, fake_quant_on, running_min, running_max, scale,
+      zero_point, averaging_const, quant_min, quant_max, ch_axis,
+      per_row_fake_quant, symmetric_quant));
+}
+
+} // namespace native
+} // namespace at
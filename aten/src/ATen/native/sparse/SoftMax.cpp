@@ -4,8 +4,11 @@
 #include <ATen/SparseTensorUtils.h>
 #include <ATen/Parallel.h>
 #include <ATen/NamedTensorUtils.h>
+#include <ATen/native/cpu/radix_sort.h>
 #include <ATen/native/sparse/ParamUtils.h>
-#include <map>
+
+#include <algorithm>
+#include <numeric>
 
 namespace at {
 namespace native {
@@ -88,7 +91,29 @@ std::vector<int64_t> get_offsets(const Tensor& indices, const IntArrayRef& sizes
   return offsets;
 }
 
-std::vector<std::vector<int64_t>> get_pools(const Tensor& indices, const IntArrayRef& sizes, const int64_t dim) {
+struct Pools {
+  /* Pools of sparse tensor values, stored like the rows of a CSR
+     matrix: pool p consists of the values with indices
+
+       value_index(k), k in range(offsets[p], offsets[p + 1])
+
+     Empty pools are not stored.
+  */
+  std::vector<int64_t> offsets;
+  // Empty when the values are already grouped by pool, e.g. for a
+  // coalesced tensor and the last sparse dimension.
+  std::vector<int64_t> permutation;
+
+  int64_t size() const {
+    return offsets.size() - 1;
+  }
+
+  int64_t value_index(int64_t k) const {
+    return permutation.empty() ? k : permutation[k];
+  }
+};
+
+Pools get_pools(const Tensor& indices, const IntArrayRef& sizes, const int64_t dim) {
   /*
     Return pools of indices that align with the given dimension.
 
@@ -98,7 +123,7 @@ std::vector<std::vector<int64_t>> get_pools(const Tensor& indices, const IntArra
       `dim`     - given dimension
 
     Returns:
-      `pools`   - a ragged array of indices
+      `pools`   - the pools of values indices, see Pools
 
     A pool is defined as a list of indices (of sparse tensor values)
     that participate in the same softmax computation:
@@ -107,8 +132,11 @@ std::vector<std::vector<int64_t>> get_pools(const Tensor& indices, const IntArra
     - union of all pools is set(range(nnz))
     - X.values[k], k in pools[i], does not affect the result of softmax(X)[n], n in pools[j], iff i != j
 
+    The values are grouped by pool with a stable radix sort of their
+    pool indices, which is skipped when the pool indices are already
+    sorted, so that the indices within a pool stay in increasing order.
   */
-  std::vector<std::vector<int64_t>> pools;
+  Pools pools;
 
   auto ndim = indices.size(0);
   auto nnz = indices.size(1);
@@ -121,19 +149,47 @@ std::vector<std::vector<int64_t>> get_pools(const Tensor& indices, const IntArra
     }
   }
 
-  for (int64_t i=0; i < nnz; i++) {
-    int64_t pool_index = 0;
-    for (int64_t j=0; j < ndim; j++) {
-      if (j != dim) {
-        auto indices_row = indices_accessor[j];
-        auto stride = strides[j];
-        pool_index += stride * indices_row[i];
+  std::vector<int64_t> pool_ids(nnz);
+  parallel_for(0, nnz, internal::GRAIN_SIZE / ndim, [&](int64_t begin, int64_t end) {
+    for (int64_t i=begin; i < end; i++) {
+      int64_t pool_index = 0;
+      for (int64_t j=0; j < ndim; j++) {
+        if (j != dim) {
+          pool_index += strides[j] * indices_accessor[j][i];
+        }
       }
+      pool_ids[i] = pool_index;
     }
-    while (pool_index >= pools.size()) {
-      pools.emplace_back();  // create empty pool
+  });
+
+  int64_t* sorted_ids = pool_ids.data();
+  if (!std::is_sorted(pool_ids.begin(), pool_ids.end())) {
+    std::vector<int64_t> tmp_ids(nnz);
+    std::vector<int64_t> tmp_permutation(nnz);
+    pools.permutation.resize(nnz);
+    std::iota(pools.permutation.begin(), pools.permutation.end(), 0);
+    const int64_t max_id = *std::max_element(pool_ids.begin(), pool_ids.end());
+    int64_t* sorted_permutation;
+    std::tie(sorted_ids, sorted_permutation) = radix_sort_parallel(
+        pool_ids.data(), pools.permutation.data(), tmp_ids.data(),
+        tmp_permutation.data(), nnz, max_id);
+    if (sorted_permutation != pools.permutation.data()) {
+      pools.permutation.swap(tmp_permutation);
+    }
+    if (sorted_ids != pool_ids.data()) {
+      pool_ids.swap(tmp_ids);
+      sorted_ids = pool_ids.data();
     }
-    pools[pool_index].push_back(i);
+  }
+
+  pools.offsets.push_back(0);
+  for (int64_t k=1; k < nnz; k++) {
+    if (sorted_ids[k] != sorted_ids[k - 1]) {
+      pools.offsets.push_back(k);
+    }
+  }
+  if (nnz > 0) {
+    pools.offsets.push_back(nnz);
   }
 
   return pools;
@@ -276,9 +332,10 @@ void cpu_sparse_coo_softmax(Tensor output, const Tensor& input, const int64_t di
     operations become element-wise tensor operations.
 
     The implementation below has more optimizations such as that
-    collect pool indices for enabling concurrency, minimize the calls
-    to exp functions as well as reuse of softmax implementation for
-    log_softmax.
+    collect pool indices for enabling concurrency, compute mx_d and
+    exp_sum_d together in one pass over the values of a pool (the sum
+    is rescaled by exp(old_mx - new_mx) whenever the running maximum
+    grows) as well as reuse of softmax implementation for log_softmax.
   */
   auto sparse_dim = input.sparse_dim();
   auto indices = input._indices().contiguous();
@@ -288,6 +345,9 @@ void cpu_sparse_coo_softmax(Tensor output, const Tensor& input, const int64_t di
   out_values.resize_as_(values);
   out_indices.resize_as_(indices);
   out_indices.copy_(indices);
+  // The input is coalesced, so that the backward doesn't need to coalesce
+  // the output again.
+  output._coalesced_(true);
 
   if (dim >= sparse_dim) {
     if (LogSoftMax) {
@@ -316,35 +376,26 @@ void cpu_sparse_coo_softmax(Tensor output, const Tensor& input, const int64_t di
 
   int64_t grain_size = 1;
   parallel_for(0, pools.size(), grain_size, [&](int64_t begin, int64_t end) {
-      for (auto p = begin; p < end; p++) {
-        auto pool_indices = pools[p];
+      /* Prepare scratch space */
+      std::vector<scalar_t> mx_row(nvalues);
+      std::vector<scalar_t> exp_sums_row(nvalues);
 
-        // Skip empty pools
-        if (pool_indices.size() == 0)
-          continue;
-
-        /* Prepare scratch space */
-        std::vector<scalar_t> mx_row(nvalues, -std::numeric_limits<scalar_t>::infinity());
-        std::vector<scalar_t> exp_sums_row(nvalues, 0);
-
-        /* Compute mx */
-        for (int64_t i : pool_indices) {
-          auto values_row = values_accessor[i];
-          for (int64_t j=0; j < nvalues; j++) {
-            mx_row[j] = std::max(mx_row[j], values_row[j]);
-          }
-        }
+      for (auto p = begin; p < end; p++) {
+        std::fill(mx_row.begin(), mx_row.end(), -std::numeric_limits<scalar_t>::infinity());
+        std::fill(exp_sums_row.begin(), exp_sums_row.end(), 0);
 
-        /* Apply exp to (v - mx) and sum the results */
-        for (int64_t i : pool_indices) {
-          auto values_row = values_accessor[i];
-          auto out_values_row = out_values_accessor[i];
+        /* Compute mx and the sum of exp(v - mx) in a single pass,
+           rescaling the sum whenever mx grows */
+        for (auto k = pools.offsets[p]; k < pools.offsets[p + 1]; k++) {
+          auto values_row = values_accessor[pools.value_index(k)];
           for (int64_t j=0; j < nvalues; j++) {
-            auto v = std::exp(values_row[j] - mx_row[j]);
-            if (!LogSoftMax) {
-              out_values_row[j] = v;
+            auto v = values_row[j];
+            if (v > mx_row[j]) {
+              exp_sums_row[j] = exp_sums_row[j] * std::exp(mx_row[j] - v) + 1;
+              mx_row[j] = v;
+            } else {
+              exp_sums_row[j] += std::exp(v - mx_row[j]);
             }
-            exp_sums_row[j] += v;
           }
         }
 
@@ -357,14 +408,15 @@ void cpu_sparse_coo_softmax(Tensor output, const Tensor& input, const int64_t di
         }
 
         /* Normalize with the sum of exponents */
-        for (int64_t i : pool_indices) {
+        for (auto k = pools.offsets[p]; k < pools.offsets[p + 1]; k++) {
+          auto i = pools.value_index(k);
           auto values_row = values_accessor[i];
           auto out_values_row = out_values_accessor[i];
           for (int64_t j=0; j < nvalues; j++) {
             if (LogSoftMax) {
               out_values_row[j] = values_row[j] - mx_row[j];
             } else {
-              out_values_row[j] *= exp_sums_row[j];
+              out_values_row[j] = std::exp(values_row[j] - mx_row[j]) * exp_sums_row[j];
             }
           }
         }
@@ -457,16 +509,11 @@ void cpu_sparse_coo_softmax_backward(Tensor& grad_input, const Tensor& grad, con
   int64_t grain_size = 1;
   parallel_for(0, pools.size(), grain_size, [&](int64_t begin, int64_t end) {
       for (auto p = begin; p < end; p++) {
-        auto pool_indices = pools[p];
-
-        // Skip empty pools
-        if (pool_indices.size() == 0)
-          continue;
-
         std::vector<scalar_t> tmp_row(nvalues, 0);
 
         /* Compute tmp = - sum_j output_j * grad_j */
-        for (int64_t i : pool_indices) {
+        for (auto k = pools.offsets[p]; k < pools.offsets[p + 1]; k++) {
+          auto i = pools.value_index(k);
           auto out_values_row = out_values_accessor[i];
           auto values_row = values_accessor[i];
           auto low = std::lower_bound(grad_offsets.begin(), grad_offsets.end(), out_offsets[i]);
@@ -485,7 +532,8 @@ void cpu_sparse_coo_softmax_backward(Tensor& grad_input, const Tensor& grad, con
         }
 
         /* Compute grad_input = output * (grad + tmp)*/
-        for (int64_t i : pool_indices) {
+        for (auto k = pools.offsets[p]; k < pools.offsets[p + 1]; k++) {
+          auto i = pools.value_index(k);
           auto out_values_row = out_values_accessor[i];
           auto values_row = values_accessor[i];
           auto low = std::lower_bound(grad_offsets.begin(), grad_offsets.end(), out_offsets[i]);
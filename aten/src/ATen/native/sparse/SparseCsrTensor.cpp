@@ -8,6 +8,7 @@
 #include <ATen/SparseCsrTensorImpl.h>
 #include <ATen/SparseCsrTensorUtils.h>
 #include <ATen/SparseTensorImpl.h>
+#include <ATen/native/sparse/SparseCsrTensorMath.h>
 
 namespace at {
 namespace native {
@@ -19,7 +20,8 @@ SparseCsrTensor new_csr_tensor(const TensorOptions& options) {
   // TODO: remove this comment after enabling autograd support for CSR tensor
   // constructor.
   // TORCH_INTERNAL_ASSERT(impl::variable_excluded_from_dispatch());
-  TORCH_INTERNAL_ASSERT(options.layout() == kSparseCsr);
+  TORCH_INTERNAL_ASSERT(
+      options.layout() == kSparseCsr || options.layout() == kSparseBsr);
   DispatchKey dispatch_key;
 
   if (options.device().is_cuda()) {
@@ -52,19 +54,23 @@ Tensor sparse_csr_tensor(
       "expected sparse CSR layout, but got layout ",
       options.layout());
 
-  AT_DISPATCH_INDEX_TYPES(crow_indices.scalar_type(), "csr_construct_check", [&] {
-    auto crow_indices_accessor = crow_indices.accessor<index_t, 1>();
-    TORCH_CHECK(
-        crow_indices_accessor[crow_indices.numel() - 1] <= col_indices.numel(),
-        "last value of crow_indices should be less than length of col_indices.");
-    TORCH_CHECK(
-        crow_indices_accessor[0] == 0, "0th value of crow_indices must be 0.");
-  });
-
   TORCH_CHECK(
       crow_indices.dim() == 1,
       "crow_indices must have dim=1 but got crow_indices.dim()=",
       crow_indices.dim());
+  TORCH_CHECK(crow_indices.numel() >= 1, "expected crow_indices.numel() >= 1, but got ",
+              crow_indices.numel());
+  {
+    // Copy both ends of crow_indices at once, so that indices on CUDA cost a
+    // single synchronization.
+    Tensor crow_bounds = at::stack({crow_indices[0], crow_indices[-1]}).to(kCPU, kLong);
+    auto crow_bounds_accessor = crow_bounds.accessor<int64_t, 1>();
+    TORCH_CHECK(
+        crow_bounds_accessor[1] <= col_indices.numel(),
+        "last value of crow_indices should be less than length of col_indices.");
+    TORCH_CHECK(
+        crow_bounds_accessor[0] == 0, "0th value of crow_indices must be 0.");
+  }
   TORCH_CHECK(
       col_indices.dim() == 1,
       "col_indices must have dim=1 but got col_indices.dim()=",
@@ -107,8 +113,7 @@ Tensor sparse_csr_tensor(
 
   if (col_indices.numel() > 0) {
     size[0] = crow_indices.numel() - 1;
-    Tensor max_col_indices = std::get<0>(col_indices.max(0, false));
-    size[1] = *max_col_indices.data_ptr<int64_t>() + 1;
+    size[1] = col_indices.max().item<int64_t>() + 1;
   } else {
     size[0] = 0;
     size[1] = 0;
@@ -118,6 +123,69 @@ Tensor sparse_csr_tensor(
       crow_indices, col_indices, values, size, options);
 }
 
+// Construction of BSR tensors, which are CSR tensors with dense blocks for
+// values; see SparseCsrTensorImpl.
+Tensor sparse_bsr_tensor(
+    const Tensor& crow_indices,
+    const Tensor& col_indices,
+    const Tensor& values,
+    IntArrayRef size,
+    c10::optional<ScalarType> dtype,
+    c10::optional<Layout> layout,
+    c10::optional<Device> device,
+    c10::optional<bool> pin_memory) {
+  // See [Note: hacky wrapper removal for TensorOptions]
+  TensorOptions options = TensorOptions().dtype(dtype).layout(layout).device(device).pinned_memory(pin_memory);
+  TORCH_CHECK(
+      options.layout() == kSparseBsr,
+      "expected sparse BSR layout, but got layout ",
+      options.layout());
+
+  TORCH_CHECK(
+      values.dim() == 3,
+      "values must have dim=3, (nnz, blocksize[0], blocksize[1]), but got values.dim()=",
+      values.dim());
+  TORCH_CHECK(size.size() == 2, "expected a 2-D size, but got size ", size);
+  const int64_t block_rows = values.size(1);
+  const int64_t block_cols = values.size(2);
+  TORCH_CHECK(
+      block_rows > 0 && block_cols > 0,
+      "expected blocks of positive size, but got blocksize ",
+      values.sizes().slice(1));
+  TORCH_CHECK(
+      size[0] % block_rows == 0 && size[1] % block_cols == 0,
+      "size ", size, " must be a multiple of blocksize ", values.sizes().slice(1));
+
+  TORCH_CHECK(
+      crow_indices.dim() == 1,
+      "crow_indices must have dim=1 but got crow_indices.dim()=",
+      crow_indices.dim());
+  TORCH_CHECK(
+      crow_indices.numel() == size[0] / block_rows + 1,
+      "crow_indices.numel() must be size(0) / blocksize[0] + 1, but got: ",
+      crow_indices.numel());
+  TORCH_CHECK(
+      col_indices.dim() == 1,
+      "col_indices must have dim=1 but got col_indices.dim()=",
+      col_indices.dim());
+  {
+    // See sparse_csr_tensor.
+    Tensor crow_bounds = at::stack({crow_indices[0], crow_indices[-1]}).to(kCPU, kLong);
+    auto crow_bounds_accessor = crow_bounds.accessor<int64_t, 1>();
+    TORCH_CHECK(
+        crow_bounds_accessor[1] <= col_indices.numel(),
+        "last value of crow_indices should be less than length of col_indices.");
+    TORCH_CHECK(
+        crow_bounds_accessor[0] == 0, "0th value of crow_indices must be 0.");
+  }
+
+  SparseCsrTensor self = new_csr_tensor(options);
+  get_sparse_csr_impl(self)->resize_and_clear_(values.size(0), size);
+  get_sparse_csr_impl(self)->set_member_tensors(
+      crow_indices, col_indices, values);
+  return self;
+}
+
 // Access members of CSR tensors.
 int64_t _nnz_sparse_csr(const SparseCsrTensor& self) {
   return get_sparse_csr_impl(self)->nnz();
@@ -135,6 +203,19 @@ Tensor col_indices_sparse_csr(const Tensor& self) {
   return get_sparse_csr_impl(self)->col_indices().alias();
 }
 
+// Conversion of CSR tensors to COO tensors.
+Tensor sparse_csr_to_sparse(const Tensor& self) {
+  if (get_sparse_csr_impl(self)->is_blocked()) {
+    return self.to_dense().to_sparse();
+  }
+  Tensor indices = at::_convert_indices_from_csr_to_coo(
+      self.crow_indices(), self.col_indices(), /*out_int32=*/false);
+  // The nonzeros of a CSR tensor are sorted by row, but not necessarily by
+  // column within a row, so the result can't just be marked as coalesced.
+  return at::_sparse_coo_tensor_unsafe(indices, self.values().clone(), self.sizes())
+      .coalesce();
+}
+
 bool _is_same_size_as_sparse_csr(
     const SparseCsrTensor& self,
     const SparseCsrTensor& src) {
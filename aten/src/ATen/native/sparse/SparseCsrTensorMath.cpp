@@ -9,7 +9,10 @@
 #include <ATen/WrapDimUtilsMulti.h>
 #include <ATen/native/BinaryOps.h>
 #include <ATen/native/CPUBlas.h>
+#include <ATen/native/IndexingUtils.h>
+#include <ATen/native/cpu/SparseCsrMmKernel.h>
 #include <ATen/native/mkl/SparseCsrLinearAlgebra.h>
+#include <ATen/native/sparse/SparseCsrTensorMath.h>
 
 #include <algorithm>
 
@@ -20,6 +23,8 @@ using namespace at::sparse_csr;
 // certain utiliy functions are usable from sparse COO.
 using namespace at::sparse;
 
+DEFINE_DISPATCH(sparse_csr_addmm_stub);
+
 static constexpr bool is_msvc() {
 #ifdef _MSC_VER
   return true;
@@ -28,6 +33,75 @@ static constexpr bool is_msvc() {
 #endif
 }
 
+// out += alpha * bsr @ dense, where bsr is the block sparse (BSR) matrix given
+// by crow_indices, col_indices and values, with one GEMM per block, so that
+// the blocks are multiplied by the BLAS microkernels. Rows of blocks are
+// computed in parallel, each by a single thread, which owns their rows of out.
+template <typename scalar_t, typename index_t>
+void addmm_out_sparse_bsr_dense_cpu_impl(
+    Tensor& out,
+    const Tensor& crow_indices,
+    const Tensor& col_indices,
+    const Tensor& values,
+    const Tensor& dense,
+    const Scalar& alpha) {
+  const int64_t block_rows = crow_indices.numel() - 1;
+  const int64_t blocksize_rows = values.size(1);
+  const int64_t blocksize_cols = values.size(2);
+  const int64_t n = dense.size(1);
+  if (block_rows <= 0 || n == 0 || values.size(0) == 0) {
+    return;
+  }
+
+  const scalar_t cast_alpha = alpha.to<scalar_t>();
+  const index_t* crow = crow_indices.data_ptr<index_t>();
+  const index_t* cols = col_indices.data_ptr<index_t>();
+  const scalar_t* vals = values.data_ptr<scalar_t>();
+  const scalar_t* dense_ptr = dense.data_ptr<scalar_t>();
+  scalar_t* out_ptr = out.data_ptr<scalar_t>();
+  const int64_t block_numel = blocksize_rows * blocksize_cols;
+
+  at::parallel_for(0, block_rows, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t block_row = begin; block_row < end; ++block_row) {
+      scalar_t* out_rows = out_ptr + block_row * blocksize_rows * n;
+      for (index_t p = crow[block_row]; p < crow[block_row + 1]; ++p) {
+        // BLAS is column major, so compute out_rows^T += dense_rows^T @ block^T.
+        cpublas::gemm(
+            cpublas::NoTranspose,
+            cpublas::NoTranspose,
+            n,
+            blocksize_rows,
+            blocksize_cols,
+            cast_alpha,
+            dense_ptr + cols[p] * blocksize_cols * n,
+            n,
+            vals + p * block_numel,
+            blocksize_cols,
+            scalar_t(1),
+            out_rows,
+            n);
+      }
+    }
+  });
+}
+
+static void addmm_out_sparse_bsr_dense_cpu_(
+    Tensor& out,
+    const Tensor& crow_indices,
+    const Tensor& col_indices,
+    const Tensor& values,
+    const Tensor& dense,
+    const Scalar& alpha) {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      kBFloat16, values.scalar_type(), "addmm_out_sparse_bsr_dense_cpu", [&] {
+        AT_DISPATCH_INDEX_TYPES(
+            crow_indices.scalar_type(), "addmm_out_sparse_bsr_dense_cpu_indices", [&] {
+              addmm_out_sparse_bsr_dense_cpu_impl<scalar_t, index_t>(
+                  out, crow_indices, col_indices, values, dense, alpha);
+            });
+      });
+}
+
 // Functions for matrix multiplication.
 Tensor& addmm_out_sparse_csr_dense_cpu(
     const Tensor& self,
@@ -89,8 +163,8 @@ Tensor& addmm_out_sparse_csr_dense_cpu(
   auto crow_indices = op1.crow_indices();
   auto values = op1.values();
 
-  AT_DISPATCH_FLOATING_TYPES(
-      values.scalar_type(), "addmm_sparse_csr_dense", [&] {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      kBFloat16, values.scalar_type(), "addmm_sparse_csr_dense", [&] {
         scalar_t cast_beta = beta.to<scalar_t>();
         if (!is_same_tensor(out, expand_self)) {
           out.copy_(expand_self);
@@ -102,85 +176,45 @@ Tensor& addmm_out_sparse_csr_dense_cpu(
         }
       });
 
-  // Do not use MKL for Windows due to linking issues with sparse MKL routines.
-  if (at::hasMKL() && !is_msvc()) {
+  if (get_sparse_csr_impl(op1)->is_blocked()) {
+    TORCH_CHECK(
+        op2.scalar_type() == values.scalar_type() &&
+            out.scalar_type() == values.scalar_type(),
+        "addmm: Expected mat1, mat2 and out to have the same dtype, but got ",
+        values.scalar_type(), ", ", op2.scalar_type(), " and ", out.scalar_type());
+    addmm_out_sparse_bsr_dense_cpu_(
+        out,
+        crow_indices.contiguous(),
+        col_indices.contiguous(),
+        values.contiguous(),
+        op2.contiguous(),
+        alpha);
+    return out;
+  }
+
+  // Do not use MKL for Windows due to linking issues with sparse MKL routines,
+  // nor for BFloat16, which it doesn't support.
+  if (at::hasMKL() && !is_msvc() && values.scalar_type() != kBFloat16) {
     _sparse_mm_mkl_(out, op1, op2, expand_self, alpha, beta);
   } else {
-    int64_t dense_stride0 = op1.stride(0);
-    int64_t dense_stride1 = op1.stride(1);
-    int64_t out_stride0 = out.stride(0);
-    int64_t out_stride1 = out.stride(1);
-
-    AT_DISPATCH_FLOATING_TYPES(
-        values.scalar_type(),
-        "sparse_csr_mm_cpu",
-        [&alpha,
-         &beta,
-         &op1,
-         &out,
-         &values,
-         &crow_indices,
-         &col_indices,
-         &dense_stride0,
-         &dense_stride1,
-         &out_stride0,
-         &out_stride1,
-         &dim_k]() {
-          AT_DISPATCH_INDEX_TYPES(
-              crow_indices.scalar_type(),
-              "csr_mm_crow_indices",
-              [&alpha,
-               &beta,
-               &op1,
-               &out,
-               &values,
-               &crow_indices,
-               &col_indices,
-               &dense_stride0,
-               &dense_stride1,
-               &out_stride0,
-               &out_stride1,
-               &dim_k]() {
-                scalar_t cast_alpha = alpha.to<scalar_t>();
-                scalar_t cast_beta = beta.to<scalar_t>();
-                scalar_t* dense_ptr = op1.data_ptr<scalar_t>();
-                scalar_t* out_ptr = out.data_ptr<scalar_t>();
-
-                auto col_indices_accessor = col_indices.accessor<index_t, 1>();
-                auto crow_indices_accessor =
-                    crow_indices.accessor<index_t, 1>();
-                auto values_accessor = values.accessor<scalar_t, 1>();
-
-                at::parallel_for(
-                    0,
-                    crow_indices.size(0) - 1,
-                    internal::GRAIN_SIZE,
-                    [&](int64_t irow_start, int64_t irow_end) {
-                      for (int irow = irow_start; irow < irow_end; ++irow) {
-                        int start_index = crow_indices_accessor[irow];
-                        int end_index = crow_indices_accessor[irow + 1];
-
-                        for (int i = start_index; i < end_index; ++i) {
-                          auto val = values_accessor[i];
-                          auto icol = col_indices_accessor[i];
-
-                          at::native::cpublas::axpy<scalar_t>(
-                              dim_k,
-                              cast_alpha * val,
-                              dense_ptr + icol * dense_stride0,
-                              dense_stride1,
-                              out_ptr + irow * out_stride0,
-                              out_stride1);
-                        }
-                      }
-                    });
-              });
-        });
+    TORCH_CHECK(
+        op2.scalar_type() == values.scalar_type() &&
+            out.scalar_type() == values.scalar_type(),
+        "addmm: Expected mat1, mat2 and out to have the same dtype, but got ",
+        values.scalar_type(), ", ", op2.scalar_type(), " and ", out.scalar_type());
+    sparse_csr_addmm_stub(
+        kCPU,
+        out,
+        crow_indices.contiguous(),
+        col_indices.contiguous(),
+        values.contiguous(),
+        op2.contiguous(),
+        alpha);
   }
   return out;
 }
 
-Tensor addmm_sparse_csr_dense_cpu(
+Tensor addmm_sparse_csr_dense(
     const Tensor& self,
     const SparseCsrTensor& sparse,
     const Tensor& dense,
@@ -276,6 +310,14 @@ Tensor& add_out_dense_sparse_csr_cpu(
     resultBuffer.copy_(dense);
   }
 
+  if (get_sparse_csr_impl(src)->is_blocked()) {
+    add_sparse_bsr_to_dense_(resultBuffer, src, alpha);
+    if (!is_same_tensor(out, resultBuffer)) {
+      out.copy_(resultBuffer);
+    }
+    return out;
+  }
+
   AT_DISPATCH_ALL_TYPES(
       commonDtype,
       "add_out_op2_sparse_csr",
@@ -327,5 +369,252 @@ Tensor& add_out_sparse_csr_cpu(
   return out;
 }
 
+// Functions for sampled dense-dense matrix multiplication (SDDMM).
+void sparse_sampled_addmm_prepare_out(
+    const Tensor& self,
+    const Tensor& mat1,
+    const Tensor& mat2,
+    const Scalar& beta,
+    Tensor& result) {
+  TORCH_CHECK(
+      self.is_sparse_csr() && result.is_sparse_csr(),
+      "sparse_sampled_addmm: expected 'self' and 'out' to be sparse CSR tensors, but got ",
+      self.layout(), " and ", result.layout());
+  TORCH_CHECK(
+      !get_sparse_csr_impl(self)->is_blocked(),
+      "sparse_sampled_addmm: block sparse (BSR) tensors are not supported");
+  TORCH_CHECK(
+      mat1.layout() == kStrided && mat2.layout() == kStrided,
+      "sparse_sampled_addmm: expected 'mat1' and 'mat2' to be strided tensors, but got ",
+      mat1.layout(), " and ", mat2.layout());
+  TORCH_CHECK(
+      mat1.dim() == 2 && mat2.dim() == 2,
+      "sparse_sampled_addmm: 2-D matrices expected, got ",
+      mat1.dim(), "D and ", mat2.dim(), "D tensors");
+  TORCH_CHECK(
+      mat1.size(1) == mat2.size(0),
+      "sparse_sampled_addmm: mat1 and mat2 shapes cannot be multiplied (",
+      mat1.size(0), "x", mat1.size(1), " and ", mat2.size(0), "x", mat2.size(1), ")");
+  TORCH_CHECK(
+      self.size(0) == mat1.size(0) && self.size(1) == mat2.size(1),
+      "sparse_sampled_addmm: expected 'self' to be of size ",
+      mat1.size(0), "x", mat2.size(1), ", but got ", self.size(0), "x", self.size(1));
+  TORCH_CHECK(
+      mat1.scalar_type() == self.scalar_type() &&
+          mat2.scalar_type() == self.scalar_type() &&
+          result.scalar_type() == self.scalar_type(),
+      "sparse_sampled_addmm: expected self, mat1, mat2 and out to have the same dtype, but got ",
+      self.scalar_type(), ", ", mat1.scalar_type(), ", ", mat2.scalar_type(),
+      " and ", result.scalar_type());
+  TORCH_CHECK(
+      mat1.device() == self.device() && mat2.device() == self.device() &&
+          result.device() == self.device(),
+      "sparse_sampled_addmm: expected all tensors to be on the same device");
+
+  if (is_same_tensor(result, self)) {
+    if (beta.toComplexDouble() == 0.) {
+      result.values().zero_();
+    } else {
+      result.values().mul_(beta);
+    }
+    return;
+  }
+  Tensor values = beta.toComplexDouble() == 0.
+      ? at::zeros_like(self.values())
+      : self.values().mul(beta);
+  auto* result_impl = get_sparse_csr_impl(result);
+  result_impl->resize_and_clear_(self._nnz(), self.sizes());
+  result_impl->set_member_tensors(
+      self.crow_indices().clone(), self.col_indices().clone(), values);
+}
+
+void sparse_sampled_addmm_gather_(
+    const Tensor& mat1,
+    const Tensor& mat2,
+    const Scalar& alpha,
+    Tensor& result) {
+  const int64_t nnz = result._nnz();
+  const int64_t k = mat1.size(1);
+  if (nnz == 0 || k == 0 || alpha.toComplexDouble() == 0.) {
+    return;
+  }
+  Tensor values = result.values();
+  Tensor indices = at::_convert_indices_from_csr_to_coo(
+      result.crow_indices(), result.col_indices(), /*out_int32=*/false);
+  Tensor rows = indices.select(0, 0);
+  Tensor cols = indices.select(0, 1);
+  Tensor mat2_t = mat2.t();
+  // Bound the memory of the gathered rows and columns.
+  const int64_t chunk = std::max<int64_t>((int64_t{1} << 22) / k, 1);
+  for (int64_t start = 0; start < nnz; start += chunk) {
+    const int64_t length = std::min(chunk, nnz - start);
+    Tensor products = at::mul(
+        mat1.index_select(0, rows.narrow(0, start, length)),
+        mat2_t.index_select(0, cols.narrow(0, start, length)));
+    values.narrow(0, start, length).add_(products.sum(-1), alpha);
+  }
+}
+
+void addmm_sparse_bsr_dense_batched_(
+    Tensor& out,
+    const SparseCsrTensor& bsr,
+    const Tensor& dense,
+    const Scalar& alpha) {
+  const auto blocksize = get_sparse_csr_impl(bsr)->blocksize();
+  const int64_t nnz = bsr._nnz();
+  const int64_t n = dense.size(1);
+  if (nnz == 0 || n == 0 || alpha.toComplexDouble() == 0.) {
+    return;
+  }
+  Tensor values = bsr.values();
+  Tensor col_indices = bsr.col_indices();
+  Tensor block_rows = at::_convert_indices_from_csr_to_coo(
+      bsr.crow_indices(), col_indices, /*out_int32=*/false).select(0, 0);
+  // The rows of dense and out, grouped by rows of blocks.
+  Tensor dense_blocks = dense.reshape({-1, blocksize[1], n});
+  Tensor out_blocks = out.view({-1, blocksize[0], n});
+  // Bound the memory of the gathered rows and products.
+  const int64_t chunk = std::max<int64_t>(
+      (int64_t{1} << 22) / (std::max(blocksize[0], blocksize[1]) * n), 1);
+  for (int64_t start = 0; start < nnz; start += chunk) {
+    const int64_t length = std::min(chunk, nnz - start);
+    Tensor products = at::bmm(
+        values.narrow(0, start, length),
+        dense_blocks.index_select(0, col_indices.narrow(0, start, length)));
+    out_blocks.index_add_(0, block_rows.narrow(0, start, length), products, alpha);
+  }
+}
+
+void add_sparse_bsr_to_dense_(
+    Tensor& dense,
+    const SparseCsrTensor& bsr,
+    const Scalar& alpha) {
+  const auto blocksize = get_sparse_csr_impl(bsr)->blocksize();
+  Tensor values = bsr.values().to(dense.scalar_type());
+  if (alpha.toComplexDouble() != 1.) {
+    values = values.mul(alpha);
+  }
+  Tensor indices = at::_convert_indices_from_csr_to_coo(
+      bsr.crow_indices(), bsr.col_indices(), /*out_int32=*/false);
+  Tensor target = dense.is_contiguous() ? dense : dense.contiguous();
+  // View target as a grid of blocks, indexed by their row and column.
+  Tensor blocks = target
+                      .view({target.size(0) / blocksize[0],
+                             blocksize[0],
+                             target.size(1) / blocksize[1],
+                             blocksize[1]})
+                      .transpose(1, 2);
+  blocks.index_put_(
+      toListOfOptionalTensors(indices.unbind(0)), values, /*accumulate=*/true);
+  if (!is_same_tensor(target, dense)) {
+    dense.copy_(target);
+  }
+}
+
+Tensor& sparse_sampled_addmm_out_sparse_csr_cpu(
+    const Tensor& self,
+    const Tensor& mat1,
+    const Tensor& mat2,
+    const Scalar& beta,
+    const Scalar& alpha,
+    Tensor& result) {
+  sparse_sampled_addmm_prepare_out(self, mat1, mat2, beta, result);
+  sparse_sampled_addmm_gather_(mat1, mat2, alpha, result);
+  return result;
+}
+
+Tensor sparse_sampled_addmm_sparse_csr(
+    const Tensor& self,
+    const Tensor& mat1,
+    const Tensor& mat2,
+    const Scalar& beta,
+    const Scalar& alpha) {
+  Tensor result = new_csr_tensor(self.options().layout(kSparseCsr));
+  at::sparse_sampled_addmm_out(result, self, mat1, mat2, beta, alpha); // redispatch!
+  return result;
+}
+
+// Conversions between the indices of COO and CSR tensors.
+template <typename input_t, typename output_t>
+void convert_indices_from_coo_to_csr_cpu(
+    const Tensor& result,
+    const Tensor& input,
+    int64_t size) {
+  const int64_t numel = input.numel();
+  const input_t* data_in = input.data_ptr<input_t>();
+  output_t* data_out = result.data_ptr<output_t>();
+  if (numel == 0) {
+    result.zero_();
+    return;
+  }
+  // data_out[j] is the number of rows in data_in that are less than j.
+  for (int64_t i = 0; i <= data_in[0]; i++) {
+    data_out[i] = static_cast<output_t>(0);
+  }
+  at::parallel_for(0, numel - 1, internal::GRAIN_SIZE, [&](int64_t start, int64_t end) {
+    for (int64_t i = start; i < end; i++) {
+      for (int64_t row = data_in[i]; row < data_in[i + 1]; row++) {
+        data_out[row + 1] = static_cast<output_t>(i + 1);
+      }
+    }
+  });
+  for (int64_t i = data_in[numel - 1] + 1; i < size + 1; i++) {
+    data_out[i] = static_cast<output_t>(numel);
+  }
+}
+
+Tensor _convert_indices_from_coo_to_csr_cpu(
+    const Tensor& self,
+    int64_t size,
+    bool out_int32) {
+  TORCH_CHECK(self.dim() <= 1, "Input is supposed to be a vector");
+  Tensor input = self.contiguous();
+  Tensor result = at::empty(
+      {size + 1}, self.options().dtype(out_int32 ? kInt : kLong));
+  AT_DISPATCH_INDEX_TYPES(input.scalar_type(), "convert_indices_from_coo_to_csr_cpu", [&] {
+    if (out_int32) {
+      convert_indices_from_coo_to_csr_cpu<index_t, int32_t>(result, input, size);
+    } else {
+      convert_indices_from_coo_to_csr_cpu<index_t, int64_t>(result, input, size);
+    }
+  });
+  return result;
+}
+
+template <typename input_t, typename output_t>
+void convert_indices_from_csr_to_coo_cpu(
+    const Tensor& indices,
+    const Tensor& crow_indices) {
+  const int64_t nrows = crow_indices.numel() - 1;
+  const input_t* crow = crow_indices.data_ptr<input_t>();
+  output_t* rows = indices.select(0, 0).data_ptr<output_t>();
+  at::parallel_for(0, nrows, internal::GRAIN_SIZE, [&](int64_t start, int64_t end) {
+    for (int64_t i = start; i < end; i++) {
+      std::fill(rows + crow[i], rows + crow[i + 1], static_cast<output_t>(i));
+    }
+  });
+}
+
+Tensor _convert_indices_from_csr_to_coo_cpu(
+    const Tensor& crow_indices,
+    const Tensor& col_indices,
+    bool out_int32) {
+  TORCH_CHECK(
+      crow_indices.dim() == 1 && col_indices.dim() == 1,
+      "crow_indices and col_indices are supposed to be vectors");
+  Tensor crow = crow_indices.contiguous();
+  Tensor indices = at::empty(
+      {2, col_indices.numel()}, col_indices.options().dtype(out_int32 ? kInt : kLong));
+  indices.select(0, 1).copy_(col_indices);
+  AT_DISPATCH_INDEX_TYPES(crow.scalar_type(), "convert_indices_from_csr_to_coo_cpu", [&] {
+    if (out_int32) {
+      convert_indices_from_csr_to_coo_cpu<index_t, int32_t>(indices, crow);
+    } else {
+      convert_indices_from_csr_to_coo_cpu<index_t, int64_t>(indices, crow);
+    }
+  });
+  return indices;
+}
+
 } // namespace native
 } // namespace at
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/SparseCsrTensorUtils.h>
+
+namespace at { namespace native {
+
+TORCH_API sparse_csr::SparseCsrTensor new_csr_tensor(const TensorOptions& options);
+
+// Checks the arguments of sparse_sampled_addmm and makes result a sparse CSR
+// tensor with the nonzeros of self and the values beta * self.values(), to
+// which the kernels then add alpha * (mat1 @ mat2) at those nonzeros.
+TORCH_API void sparse_sampled_addmm_prepare_out(
+    const Tensor& self,
+    const Tensor& mat1,
+    const Tensor& mat2,
+    const Scalar& beta,
+    Tensor& result);
+
+// Adds alpha * (mat1 @ mat2) at the nonzeros of result to its values, with
+// dot products of the gathered rows of mat1 and columns of mat2. Works on any
+// device, for the cases that have no dedicated kernel.
+TORCH_API void sparse_sampled_addmm_gather_(
+    const Tensor& mat1,
+    const Tensor& mat2,
+    const Scalar& alpha,
+    Tensor& result);
+
+// out += alpha * bsr @ dense for a block sparse (BSR) tensor, with batched
+// matrix products of the blocks of bsr and the rows of dense they multiply.
+// Works on any device; out must be contiguous.
+TORCH_API void addmm_sparse_bsr_dense_batched_(
+    Tensor& out,
+    const Tensor& bsr,
+    const Tensor& dense,
+    const Scalar& alpha);
+
+// dense += alpha * bsr for a block sparse (BSR) tensor of the size of dense.
+// Works on any device.
+TORCH_API void add_sparse_bsr_to_dense_(
+    Tensor& dense,
+    const Tensor& bsr,
+    const Scalar& alpha);
+
+}}
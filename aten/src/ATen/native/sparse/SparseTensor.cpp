@@ -8,8 +8,12 @@
 #include <ATen/SparseTensorImpl.h>
 #include <ATen/SparseTensorUtils.h>
 #include <ATen/native/IndexingUtils.h>
+#include <ATen/native/cpu/SparseCoalesceKernel.h>
+#include <ATen/native/cpu/radix_sort.h>
 
-#include <ATen/native/CPUBlas.h>
+#include <algorithm>
+#include <numeric>
+#include <vector>
 
 namespace at {
 namespace native {
@@ -529,6 +533,58 @@ SparseTensor coalesce(const SparseTensor& self) {
   return at::_coalesce(self);
 }
 
+DEFINE_DISPATCH(sparse_coalesce_values_stub);
+
+namespace {
+
+// The offsets in the sorted `keys` at which runs of equal keys start, followed
+// by the number of keys.
+Tensor sorted_run_offsets(const Tensor& keys) {
+  const int64_t n = keys.numel();
+  const int64_t* keys_ptr = keys.data_ptr<int64_t>();
+  auto is_run_start = [keys_ptr](int64_t i) {
+    return i == 0 || keys_ptr[i] != keys_ptr[i - 1];
+  };
+
+  // Count the runs that start in each chunk, then write the offsets of each
+  // chunk after those of the chunks before it.
+  const int64_t num_chunks = std::max<int64_t>(
+      1, std::min<int64_t>(at::get_num_threads(), n / internal::GRAIN_SIZE));
+  auto chunk_begin = [n, num_chunks](int64_t chunk) {
+    return n * chunk / num_chunks;
+  };
+  std::vector<int64_t> chunk_offsets(num_chunks + 1, 0);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; ++chunk) {
+      int64_t count = 0;
+      for (int64_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+        count += is_run_start(i);
+      }
+      chunk_offsets[chunk + 1] = count;
+    }
+  });
+  std::partial_sum(
+      chunk_offsets.begin(), chunk_offsets.end(), chunk_offsets.begin());
+
+  const int64_t num_runs = chunk_offsets[num_chunks];
+  Tensor offsets = at::empty({num_runs + 1}, keys.options());
+  int64_t* offsets_ptr = offsets.data_ptr<int64_t>();
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; ++chunk) {
+      int64_t run = chunk_offsets[chunk];
+      for (int64_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+        if (is_run_start(i)) {
+          offsets_ptr[run++] = i;
+        }
+      }
+    }
+  });
+  offsets_ptr[num_runs] = n;
+  return offsets;
+}
+
+} // namespace
+
 SparseTensor _coalesce_sparse_cpu(const SparseTensor& self) {
   AT_ASSERT(self.defined());
   TORCH_INTERNAL_ASSERT(at::impl::variable_excluded_from_dispatch());
@@ -549,7 +605,9 @@ SparseTensor _coalesce_sparse_cpu(const SparseTensor& self) {
   int64_t dense_dim = self.dense_dim();
   int64_t nnz = self._nnz();
 
-  Tensor indices_scalar = flatten_indices(indices, self.sizes());
+  // The radix sort below overwrites the keys it sorts.
+  Tensor indices_scalar =
+      flatten_indices(indices, self.sizes(), /*force_clone=*/true);
 
   SparseTensor dst = new_sparse(
       optTypeMetaToScalarType(self.options().dtype_opt()),
@@ -564,55 +622,58 @@ SparseTensor _coalesce_sparse_cpu(const SparseTensor& self) {
 
   Tensor indicesBuffer;
   Tensor indicesPermutation;
-  std::tie(indicesBuffer, indicesPermutation) = indices_scalar.sort(0);
+  if (indices_scalar.min().item<int64_t>() < 0) {
+    // Only tensors built without checking their indices get here, and the
+    // radix sort needs non-negative keys.
+    std::tie(indicesBuffer, indicesPermutation) = indices_scalar.sort(0);
+  } else {
+    const int64_t max_key = indices_scalar.max().item<int64_t>();
+    Tensor positions = at::arange(nnz, indices.options());
+    Tensor tmpKeys = at::empty_like(indices_scalar);
+    Tensor tmpPositions = at::empty_like(positions);
+    int64_t* sorted_keys;
+    int64_t* sorted_positions;
+    std::tie(sorted_keys, sorted_positions) = radix_sort_parallel(
+        indices_scalar.data_ptr<int64_t>(),
+        positions.data_ptr<int64_t>(),
+        tmpKeys.data_ptr<int64_t>(),
+        tmpPositions.data_ptr<int64_t>(),
+        nnz,
+        max_key);
+    indicesBuffer =
+        sorted_keys == tmpKeys.data_ptr<int64_t>() ? tmpKeys : indices_scalar;
+    indicesPermutation = sorted_positions == tmpPositions.data_ptr<int64_t>()
+        ? tmpPositions
+        : positions;
+  }
+
+  // Each run of equal keys becomes one nonzero of the result.
+  Tensor segmentOffsets = sorted_run_offsets(indicesBuffer);
+  const int64_t newNnz = segmentOffsets.numel() - 1;
+
   // NB: The accessor accesses here rely on self._nnz() > 0 (tested earlier in
   // this function)
   auto newIndicesAccessor = newIndices.accessor<int64_t, 2>();
   auto indicesAccessor = indices.accessor<int64_t, 2>();
   auto indicesPermutationAccessor = indicesPermutation.accessor<int64_t, 1>();
-  auto indicesBufferAccessor = indicesBuffer.accessor<int64_t, 1>();
-
-  int64_t i = -1;
-  AT_DISPATCH_ALL_TYPES(values.scalar_type(), "coalesce", [&] {
-    int64_t prev = -1;
-    int64_t blockSize = values.stride(0);
-    scalar_t* values_ptr = values.data_ptr<scalar_t>();
-    scalar_t* newValues_ptr = newValues.data_ptr<scalar_t>();
-    for (int64_t j = 0; j < nnz; j++) {
-      int64_t pos = indicesPermutationAccessor[j];
-      int64_t curr = indicesBufferAccessor[j];
-      if (curr == prev) {
-        if (values.numel() >
-            0) { // if values is an empty tensor, there are no elements to copy
-          at::native::cpublas::axpy<scalar_t>(
-              blockSize,
-              1,
-              values_ptr + pos * blockSize,
-              1,
-              newValues_ptr + i * blockSize,
-              1);
+  auto segmentOffsetsAccessor = segmentOffsets.accessor<int64_t, 1>();
+  at::parallel_for(
+      0,
+      newNnz,
+      internal::GRAIN_SIZE / std::max<int64_t>(sparse_dim, 1),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          int64_t pos = indicesPermutationAccessor[segmentOffsetsAccessor[i]];
+          for (int64_t d = 0; d < sparse_dim; d++) {
+            newIndicesAccessor[d][i] = indicesAccessor[d][pos];
+          }
         }
-      } else {
-        ++i;
-        for (int64_t d = 0; d < sparse_dim; d++) {
-          newIndicesAccessor[d][i] = indicesAccessor[d][pos];
-        }
-        if (values.numel() >
-            0) { // if values is an empty tensor, there are no elements to copy
-          at::native::cpublas::copy<scalar_t>(
-              blockSize,
-              values_ptr + pos * blockSize,
-              1,
-              newValues_ptr + i * blockSize,
-              1);
-        }
-      }
-      prev = curr;
-    }
-  });
+      });
+  sparse_coalesce_values_stub(
+      kCPU, newValues, values, indicesPermutation, segmentOffsets);
 
   dst._coalesced_(true);
-  get_sparse_impl(dst)->set_nnz_and_narrow(i + 1);
+  get_sparse_impl(dst)->set_nnz_and_narrow(newNnz);
 
   return dst;
 }
@@ -74,7 +74,6 @@ __global__ void cuda_sparse_coo_softmax_kernel(
     int64_t* pool_sizes,
     int64_t* pool_offsets,
     int64_t nvalues,
-    scalar_t* mx_rows,
     PackedTensorAccessor<scalar_t, 2> input_values_acc,
     PackedTensorAccessor<scalar_t, 2> output_values_acc) {
   /*
@@ -94,30 +93,33 @@ __global__ void cuda_sparse_coo_softmax_kernel(
     int64_t offset = pool_offsets[index];
     int64_t* pool_indices = sorted_pool_indices + offset;
     int64_t pool_indices_size = pool_sizes[index];
-    scalar_t* mx_row = mx_rows + index * nvalues;
 
     for (int64_t j = 0; j < nvalues; j++) {
+      /* Compute the max and the sum of exponents in a single pass, see
+         cpu_sparse_coo_softmax */
+      scalar_t mx = -std::numeric_limits<scalar_t>::infinity();
       scalar_t exp_sums = 0;
       for (int64_t p = 0; p < pool_indices_size; p++) {
-        auto i = pool_indices[p];
-        auto values_row = input_values_acc[i];
-        auto out_values_row = output_values_acc[i];
-
-        auto v = c10::cuda::compat::exp(values_row[j] - mx_row[j]);
-        if (!LogSoftMax) {
-          out_values_row[j] = v;
+        auto v = input_values_acc[pool_indices[p]][j];
+        if (v > mx) {
+          exp_sums = exp_sums * c10::cuda::compat::exp(mx - v) + 1;
+          mx = v;
+        } else {
+          exp_sums += c10::cuda::compat::exp(v - mx);
         }
-        exp_sums += v;
+      }
+      if (LogSoftMax) {
+        mx += c10::cuda::compat::log(exp_sums);
+      } else {
+        exp_sums = 1.0 / exp_sums;
       }
       for (int64_t p = 0; p < pool_indices_size; p++) {
         auto i = pool_indices[p];
-        auto values_row = input_values_acc[i];
-        auto out_values_row = output_values_acc[i];
-
+        auto v = input_values_acc[i][j];
         if (LogSoftMax) {
-          out_values_row[j] = values_row[j] - mx_row[j] - c10::cuda::compat::log(exp_sums);
+          output_values_acc[i][j] = v - mx;
         } else {
-          out_values_row[j] *= 1.0 / exp_sums;
+          output_values_acc[i][j] = c10::cuda::compat::exp(v - mx) * exp_sums;
         }
       }
     }
@@ -266,11 +268,16 @@ std::tuple<Tensor, Tensor, Tensor, Tensor> compute_pool_max(
     const Tensor& values,
     const IntArrayRef& sizes,
     int64_t nvalues,
-    const int64_t dim) {
+    const int64_t dim,
+    const bool offsets_sorted) {
   /*
     Return pools of indices that align with the given dimension and the
     corresponding max values for each pool.
 
+    `offsets_sorted` tells that the pool offsets of the values are
+    already in order, e.g. for the last sparse dimension of a
+    coalesced tensor, so that sorting them can be skipped.
+
     See ATen/native/sparse/Softmax.cpp:get_offsets and
     ATen/native/sparse/Softmax.cpp:cpu_sparse_coo_softmax for the CPU
     implementation that this implementation is based on.
@@ -288,13 +295,15 @@ std::tuple<Tensor, Tensor, Tensor, Tensor> compute_pool_max(
   thrust::sequence(
       policy, sorted_indices_thrust_ptr, sorted_indices_thrust_ptr + nnz, 0);
 
-  thrust::sort(
-      policy,
-      sorted_indices_thrust_ptr,
-      sorted_indices_thrust_ptr + nnz,
-      [offsets_ptr] __device__(int64_t x, int64_t y) {
-        return offsets_ptr[x] < offsets_ptr[y];
-      });
+  if (!offsets_sorted) {
+    thrust::sort(
+        policy,
+        sorted_indices_thrust_ptr,
+        sorted_indices_thrust_ptr + nnz,
+        [offsets_ptr] __device__(int64_t x, int64_t y) {
+          return offsets_ptr[x] < offsets_ptr[y];
+        });
+  }
   auto pool_sizes = at::empty({nnz}, indices.options());
 
   auto new_end = thrust::reduce_by_key(
@@ -378,6 +387,9 @@ void cuda_sparse_coo_softmax(
   out_values.resize_as_(values);
   out_indices.resize_as_(indices);
   out_indices.copy_(indices);
+  // The input is coalesced, so that the backward doesn't need to coalesce
+  // the output again.
+  output._coalesced_(true);
 
   if (dim >= sparse_dim) {
     if (LogSoftMax) {
@@ -408,10 +420,13 @@ void cuda_sparse_coo_softmax(
   Tensor sorted_indices;
   Tensor pool_offsets;
   Tensor pool_sizes;
-  Tensor mx_buffer;
 
-  std::tie(sorted_indices, pool_offsets, pool_sizes, mx_buffer) =
-      compute_pool_max<scalar_t, true>(indices, values_2, sizes, nvalues, dim);
+  /* The kernel computes the max of each pool along with the sum of
+     exponents, so that the values are read twice rather than three times */
+  std::tie(sorted_indices, pool_offsets, pool_sizes, std::ignore) =
+      compute_pool_max<scalar_t, false>(
+          indices, values_2, sizes, nvalues, dim,
+          input.is_coalesced() && dim == sparse_dim - 1);
 
   auto pool_size = pool_offsets.size(0);
   int block_size = getNumThreads(pool_size);
@@ -424,7 +439,6 @@ void cuda_sparse_coo_softmax(
           pool_sizes.data_ptr<int64_t>(),
           pool_offsets.data_ptr<int64_t>(),
           nvalues,
-          mx_buffer.data_ptr<scalar_t>(),
           values_accessor,
           out_values_accessor);
   C10_CUDA_KERNEL_LAUNCH_CHECK();
@@ -540,7 +554,8 @@ void cuda_sparse_coo_softmax_backward(
   std::tie(
       sorted_indices, pool_offsets, pool_sizes, std::ignore) =
       compute_pool_max<scalar_t, false>(
-          out_indices, values_2, sizes, nvalues, dim);
+          out_indices, values_2, sizes, nvalues, dim,
+          output.is_coalesced() && dim == sparse_dim - 1);
 
   auto pool_size = pool_offsets.size(0);
 
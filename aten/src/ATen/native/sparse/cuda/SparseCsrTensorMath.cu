@@ -0,0 +1,636 @@
+#include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
+#include <ATen/ExpandUtils.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/SparseCsrTensorUtils.h>
+#include <ATen/cuda/CUDAApplyUtils.cuh>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDAUtils.h>
+#include <ATen/cuda/Exceptions.h>
+#include <ATen/native/IndexingUtils.h>
+#include <ATen/native/sparse/SparseCsrTensorMath.h>
+#include <c10/cuda/CUDACachingAllocator.h>
+
+#include <cusparse.h>
+#include <library_types.h>
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+// The generic cuSPARSE API with row-major dense matrices and 64-bit CSR
+// indices is available from CUDA 11.0; cusparseSDDMM from cuSPARSE 11.4
+// (CUDA 11.2 update 1).
+#if !defined(__HIP_PLATFORM_HCC__) && defined(CUSPARSE_VERSION) && CUSPARSE_VERSION >= 11000
+#define AT_USE_CUSPARSE_GENERIC_API() 1
+#else
+#define AT_USE_CUSPARSE_GENERIC_API() 0
+#endif
+
+#if AT_USE_CUSPARSE_GENERIC_API() && CUSPARSE_VERSION >= 11400
+#define AT_USE_CUSPARSE_GENERIC_SDDMM() 1
+#else
+#define AT_USE_CUSPARSE_GENERIC_SDDMM() 0
+#endif
+
+namespace at { namespace native {
+
+using namespace at::sparse_csr;
+
+namespace {
+
+// --------------------------------------------------------------------
+// Conversions between the indices of COO and CSR tensors
+// --------------------------------------------------------------------
+
+// Thread i writes the entries of the CSR row offsets that fall between the
+// rows of nonzeros i - 1 and i, see convert_indices_from_coo_to_csr_cpu.
+template <typename input_t, typename output_t>
+__global__ void convert_indices_from_coo_to_csr_cuda_kernel(
+    output_t* data_out,
+    const input_t* data_in,
+    const int64_t size,
+    const int64_t numel) {
+  const int64_t tid = blockDim.x * static_cast<int64_t>(blockIdx.x) + threadIdx.x;
+  if (tid == 0) {
+    for (int64_t i = 0; i <= data_in[0]; i++) {
+      data_out[i] = static_cast<output_t>(0);
+    }
+  } else if (tid < numel) {
+    for (int64_t i = data_in[tid - 1]; i < data_in[tid]; i++) {
+      data_out[i + 1] = static_cast<output_t>(tid);
+    }
+  } else if (tid == numel) {
+    for (int64_t i = data_in[numel - 1] + 1; i < size + 1; i++) {
+      data_out[i] = static_cast<output_t>(numel);
+    }
+  }
+}
+
+// Thread i finds the row of nonzero i by binary search over the row offsets,
+// which keeps threads balanced whatever the distribution of nonzeros.
+template <typename input_t, typename output_t>
+__global__ void convert_indices_from_csr_to_coo_cuda_kernel(
+    output_t* rows,
+    const input_t* crow,
+    const int64_t nrows,
+    const int64_t nnz) {
+  const int64_t tid = blockDim.x * static_cast<int64_t>(blockIdx.x) + threadIdx.x;
+  if (tid >= nnz) {
+    return;
+  }
+  // The last row whose offset is at most tid.
+  int64_t lo = 0;
+  int64_t hi = nrows;
+  while (lo < hi) {
+    const int64_t mid = lo + (hi - lo + 1) / 2;
+    if (crow[mid] <= tid) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  rows[tid] = static_cast<output_t>(lo);
+}
+
+constexpr int kConvertThreads = 256;
+
+// --------------------------------------------------------------------
+// cuSPARSE generic API
+// --------------------------------------------------------------------
+
+#if AT_USE_CUSPARSE_GENERIC_API()
+
+// Note [cuSPARSE descriptor cache]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// The generic cuSPARSE API describes every operand with a descriptor, and
+// needs a workspace whose size it reports for each call. Creating the
+// descriptors and allocating the workspace costs more than the product itself
+// for the small matrices of graph neural networks, so both are cached. A
+// descriptor only records pointers, sizes and types, so it is cached, per
+// thread, under exactly those: a later call with the same tensors, or with
+// tensors that reuse the same memory with the same sizes, gets an identical
+// descriptor back. The workspace of a device and stream only grows; since
+// work on a stream is ordered, calls on the same stream can share it.
+
+void destroyDescriptor(cusparseSpMatDescr_t descriptor) {
+  TORCH_CUDASPARSE_CHECK(cusparseDestroySpMat(descriptor));
+}
+
+void destroyDescriptor(cusparseDnMatDescr_t descriptor) {
+  TORCH_CUDASPARSE_CHECK(cusparseDestroyDnMat(descriptor));
+}
+
+void destroyDescriptor(cusparseDnVecDescr_t descriptor) {
+  TORCH_CUDASPARSE_CHECK(cusparseDestroyDnVec(descriptor));
+}
+
+// A least recently used cache of descriptors. Not thread safe.
+template <typename Key, typename Descriptor>
+class DescriptorCache {
+ public:
+  DescriptorCache() = default;
+  DescriptorCache(const DescriptorCache&) = delete;
+  DescriptorCache& operator=(const DescriptorCache&) = delete;
+
+  ~DescriptorCache() {
+    for (auto& entry : entries_) {
+      destroyDescriptor(entry.second);
+    }
+  }
+
+  template <typename Create>
+  Descriptor get(const Key& key, const Create& create) {
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (it->first == key) {
+        entries_.splice(entries_.begin(), entries_, it);
+        return it->second;
+      }
+    }
+    entries_.emplace_front(key, create());
+    if (entries_.size() > kCapacity) {
+      destroyDescriptor(entries_.back().second);
+      entries_.pop_back();
+    }
+    return entries_.front().second;
+  }
+
+ private:
+  static constexpr size_t kCapacity = 32;
+  std::list<std::pair<Key, Descriptor>> entries_;
+};
+
+// Device, crow_indices, col_indices, values, rows, cols, nnz, index type and
+// value type.
+using CsrKey = std::tuple<
+    int, const void*, const void*, const void*, int64_t, int64_t, int64_t,
+    cusparseIndexType_t, cudaDataType>;
+// Device, values, rows, cols, leading dimension and value type.
+using DnMatKey = std::tuple<int, const void*, int64_t, int64_t, int64_t, cudaDataType>;
+// Device, values, size and value type.
+using DnVecKey = std::tuple<int, const void*, int64_t, cudaDataType>;
+
+template <typename scalar_t>
+cudaDataType getCudaDataType();
+
+template <>
+cudaDataType getCudaDataType<float>() {
+  return CUDA_R_32F;
+}
+
+template <>
+cudaDataType getCudaDataType<double>() {
+  return CUDA_R_64F;
+}
+
+template <>
+cudaDataType getCudaDataType<c10::complex<float>>() {
+  return CUDA_C_32F;
+}
+
+template <>
+cudaDataType getCudaDataType<c10::complex<double>>() {
+  return CUDA_C_64F;
+}
+
+cusparseIndexType_t getCusparseIndexType(ScalarType index_type) {
+  return index_type == kInt ? CUSPARSE_INDEX_32I : CUSPARSE_INDEX_64I;
+}
+
+// The descriptor of a sparse CSR tensor with contiguous members.
+cusparseSpMatDescr_t getCsrDescriptor(
+    const Tensor& crow_indices,
+    const Tensor& col_indices,
+    const Tensor& values,
+    int64_t rows,
+    int64_t cols,
+    cudaDataType value_type) {
+  static thread_local DescriptorCache<CsrKey, cusparseSpMatDescr_t> cache;
+  const int64_t nnz = values.numel();
+  const cusparseIndexType_t index_type =
+      getCusparseIndexType(crow_indices.scalar_type());
+  CsrKey key{
+      values.get_device(),
+      crow_indices.data_ptr(),
+      col_indices.data_ptr(),
+      values.data_ptr(),
+      rows,
+      cols,
+      nnz,
+      index_type,
+      value_type};
+  return cache.get(key, [&]() {
+    cusparseSpMatDescr_t descriptor;
+    TORCH_CUDASPARSE_CHECK(cusparseCreateCsr(
+        &descriptor,
+        rows, cols, nnz,
+        crow_indices.data_ptr(),
+        col_indices.data_ptr(),
+        values.data_ptr(),
+        index_type,
+        index_type,
+        CUSPARSE_INDEX_BASE_ZERO,
+        value_type));
+    return descriptor;
+  });
+}
+
+// The descriptor of a row-major matrix whose rows are stride(0) apart.
+cusparseDnMatDescr_t getDnMatDescriptor(const Tensor& matrix, cudaDataType value_type) {
+  static thread_local DescriptorCache<DnMatKey, cusparseDnMatDescr_t> cache;
+  const int64_t rows = matrix.size(0);
+  const int64_t cols = matrix.size(1);
+  const int64_t ld = std::max<int64_t>(matrix.stride(0), std::max<int64_t>(cols, 1));
+  DnMatKey key{matrix.get_device(), matrix.data_ptr(), rows, cols, ld, value_type};
+  return cache.get(key, [&]() {
+    cusparseDnMatDescr_t descriptor;
+    TORCH_CUDASPARSE_CHECK(cusparseCreateDnMat(
+        &descriptor, rows, cols, ld, matrix.data_ptr(), value_type, CUSPARSE_ORDER_ROW));
+    return descriptor;
+  });
+}
+
+// The descriptor of a contiguous vector.
+cusparseDnVecDescr_t getDnVecDescriptor(const Tensor& vector, cudaDataType value_type) {
+  static thread_local DescriptorCache<DnVecKey, cusparseDnVecDescr_t> cache;
+  DnVecKey key{vector.get_device(), vector.data_ptr(), vector.numel(), value_type};
+  return cache.get(key, [&]() {
+    cusparseDnVecDescr_t descriptor;
+    TORCH_CUDASPARSE_CHECK(cusparseCreateDnVec(
+        &descriptor, vector.numel(), vector.data_ptr(), value_type));
+    return descriptor;
+  });
+}
+
+// A workspace of at least `size` bytes for the current device and stream.
+void* getCusparseWorkspace(size_t size) {
+  if (size == 0) {
+    return nullptr;
+  }
+  struct Workspace {
+    c10::DataPtr data;
+    size_t size = 0;
+  };
+  static std::mutex mutex;
+  // Leaked, so that the workspaces are not freed after the allocator.
+  static auto* workspaces = new std::map<std::pair<int, cudaStream_t>, Workspace>();
+  const auto stream = at::cuda::getCurrentCUDAStream();
+  std::lock_guard<std::mutex> guard(mutex);
+  auto& workspace = (*workspaces)[{stream.device_index(), stream.stream()}];
+  if (workspace.size < size) {
+    workspace.data = c10::cuda::CUDACachingAllocator::get()->allocate(size);
+    workspace.size = size;
+  }
+  return workspace.data.get();
+}
+
+// The matrix itself if it is row-major with rows at least a row apart, as
+// cuSPARSE needs, or a contiguous copy.
+c10::MaybeOwned<Tensor> prepare_dense_matrix_for_cusparse(const Tensor& matrix) {
+  if (matrix.stride(1) == 1 && matrix.stride(0) >= matrix.size(1)) {
+    return c10::MaybeOwned<Tensor>::borrowed(matrix);
+  }
+  return c10::MaybeOwned<Tensor>::owned(matrix.contiguous());
+}
+
+// result += alpha * csr @ dense, with result and dense row-major.
+template <typename scalar_t>
+void spmm_cuda(
+    const Tensor& crow_indices,
+    const Tensor& col_indices,
+    const Tensor& values,
+    int64_t k,
+    const Tensor& dense,
+    const Scalar& alpha,
+    const Tensor& result) {
+  const cudaDataType value_type = getCudaDataType<scalar_t>();
+  const scalar_t cast_alpha = alpha.to<scalar_t>();
+  const scalar_t cast_beta = scalar_t(1);
+  auto handle = at::cuda::getCurrentCUDASparseHandle();
+  auto descA = getCsrDescriptor(
+      crow_indices, col_indices, values, result.size(0), k, value_type);
+
+  if (result.size(1) == 1) {
+    // Matrix-vector products have their own, faster, algorithms.
+#if CUSPARSE_VERSION >= 11400
+    constexpr auto algorithm = CUSPARSE_SPMV_ALG_DEFAULT;
+#else
+    constexpr auto algorithm = CUSPARSE_MV_ALG_DEFAULT;
+#endif
+    auto descX = getDnVecDescriptor(dense, value_type);
+    auto descY = getDnVecDescriptor(result, value_type);
+    size_t buffer_size;
+    TORCH_CUDASPARSE_CHECK(cusparseSpMV_bufferSize(
+        handle, CUSPARSE_OPERATION_NON_TRANSPOSE,
+        &cast_alpha, descA, descX, &cast_beta, descY,
+        value_type, algorithm, &buffer_size));
+    TORCH_CUDASPARSE_CHECK(cusparseSpMV(
+        handle, CUSPARSE_OPERATION_NON_TRANSPOSE,
+        &cast_alpha, descA, descX, &cast_beta, descY,
+        value_type, algorithm, getCusparseWorkspace(buffer_size)));
+    return;
+  }
+
+  auto descB = getDnMatDescriptor(dense, value_type);
+  auto descC = getDnMatDescriptor(result, value_type);
+  size_t buffer_size;
+  TORCH_CUDASPARSE_CHECK(cusparseSpMM_bufferSize(
+      handle, CUSPARSE_OPERATION_NON_TRANSPOSE, CUSPARSE_OPERATION_NON_TRANSPOSE,
+      &cast_alpha, descA, descB, &cast_beta, descC,
+      value_type, CUSPARSE_SPMM_ALG_DEFAULT, &buffer_size));
+  TORCH_CUDASPARSE_CHECK(cusparseSpMM(
+      handle, CUSPARSE_OPERATION_NON_TRANSPOSE, CUSPARSE_OPERATION_NON_TRANSPOSE,
+      &cast_alpha, descA, descB, &cast_beta, descC,
+      value_type, CUSPARSE_SPMM_ALG_DEFAULT, getCusparseWorkspace(buffer_size)));
+}
+
+#if AT_USE_CUSPARSE_GENERIC_SDDMM()
+// result.values() += alpha * (mat1 @ mat2) at the nonzeros of result, with
+// mat1 and mat2 row-major.
+template <typename scalar_t>
+void sddmm_cuda(
+    const Tensor& mat1,
+    const Tensor& mat2,
+    const Scalar& alpha,
+    const Tensor& result) {
+  const cudaDataType value_type = getCudaDataType<scalar_t>();
+  const scalar_t cast_alpha = alpha.to<scalar_t>();
+  const scalar_t cast_beta = scalar_t(1);
+  auto handle = at::cuda::getCurrentCUDASparseHandle();
+  auto descA = getDnMatDescriptor(mat1, value_type);
+  auto descB = getDnMatDescriptor(mat2, value_type);
+  auto descC = getCsrDescriptor(
+      result.crow_indices(), result.col_indices(), result.values(),
+      result.size(0), result.size(1), value_type);
+  size_t buffer_size;
+  TORCH_CUDASPARSE_CHECK(cusparseSDDMM_bufferSize(
+      handle, CUSPARSE_OPERATION_NON_TRANSPOSE, CUSPARSE_OPERATION_NON_TRANSPOSE,
+      &cast_alpha, descA, descB, &cast_beta, descC,
+      value_type, CUSPARSE_SDDMM_ALG_DEFAULT, &buffer_size));
+  TORCH_CUDASPARSE_CHECK(cusparseSDDMM(
+      handle, CUSPARSE_OPERATION_NON_TRANSPOSE, CUSPARSE_OPERATION_NON_TRANSPOSE,
+      &cast_alpha, descA, descB, &cast_beta, descC,
+      value_type, CUSPARSE_SDDMM_ALG_DEFAULT, getCusparseWorkspace(buffer_size)));
+}
+#endif
+
+#endif // AT_USE_CUSPARSE_GENERIC_API()
+
+} // anonymous namespace
+
+// --------------------------------------------------------------------
+// _convert_indices_from_coo_to_csr, _convert_indices_from_csr_to_coo
+// --------------------------------------------------------------------
+
+Tensor _convert_indices_from_coo_to_csr_cuda(
+    const Tensor& self,
+    int64_t size,
+    bool out_int32) {
+  TORCH_CHECK(self.dim() <= 1, "Input is supposed to be a vector");
+  Tensor input = self.contiguous();
+  Tensor result = at::empty(
+      {size + 1}, self.options().dtype(out_int32 ? kInt : kLong));
+  const int64_t numel = input.numel();
+  if (numel == 0) {
+    return result.zero_();
+  }
+  const int64_t blocks = cuda::ATenCeilDiv(numel + 1, int64_t{kConvertThreads});
+  auto stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_INDEX_TYPES(input.scalar_type(), "convert_indices_from_coo_to_csr_cuda", [&] {
+    if (out_int32) {
+      convert_indices_from_coo_to_csr_cuda_kernel<index_t, int32_t>
+          <<<blocks, kConvertThreads, 0, stream>>>(
+              result.data_ptr<int32_t>(), input.data_ptr<index_t>(), size, numel);
+    } else {
+      convert_indices_from_coo_to_csr_cuda_kernel<index_t, int64_t>
+          <<<blocks, kConvertThreads, 0, stream>>>(
+              result.data_ptr<int64_t>(), input.data_ptr<index_t>(), size, numel);
+    }
+    C10_CUDA_KERNEL_LAUNCH_CHECK();
+  });
+  return result;
+}
+
+Tensor _convert_indices_from_csr_to_coo_cuda(
+    const Tensor& crow_indices,
+    const Tensor& col_indices,
+    bool out_int32) {
+  TORCH_CHECK(
+      crow_indices.dim() == 1 && col_indices.dim() == 1,
+      "crow_indices and col_indices are supposed to be vectors");
+  Tensor crow = crow_indices.contiguous();
+  const int64_t nnz = col_indices.numel();
+  const int64_t nrows = crow.numel() - 1;
+  Tensor indices = at::empty(
+      {2, nnz}, col_indices.options().dtype(out_int32 ? kInt : kLong));
+  indices.select(0, 1).copy_(col_indices);
+  if (nnz == 0) {
+    return indices;
+  }
+  const int64_t blocks = cuda::ATenCeilDiv(nnz, int64_t{kConvertThreads});
+  auto stream = at::cuda::getCurrentCUDAStream();
+  AT_DISPATCH_INDEX_TYPES(crow.scalar_type(), "convert_indices_from_csr_to_coo_cuda", [&] {
+    if (out_int32) {
+      convert_indices_from_csr_to_coo_cuda_kernel<index_t, int32_t>
+          <<<blocks, kConvertThreads, 0, stream>>>(
+              indices.data_ptr<int32_t>(), crow.data_ptr<index_t>(), nrows, nnz);
+    } else {
+      convert_indices_from_csr_to_coo_cuda_kernel<index_t, int64_t>
+          <<<blocks, kConvertThreads, 0, stream>>>(
+              indices.data_ptr<int64_t>(), crow.data_ptr<index_t>(), nrows, nnz);
+    }
+    C10_CUDA_KERNEL_LAUNCH_CHECK();
+  });
+  return indices;
+}
+
+// --------------------------------------------------------------------
+// addmm(Tensor, SparseCsrTensor, Tensor, Scalar, Scalar)  [broadcasts]
+// --------------------------------------------------------------------
+
+Tensor& addmm_out_sparse_csr_dense_cuda(
+    const Tensor& self,
+    const SparseCsrTensor& mat1,
+    const Tensor& mat2,
+    const Scalar& beta,
+    const Scalar& alpha,
+    Tensor& result) {
+  TORCH_INTERNAL_ASSERT(mat1.is_sparse_csr());
+  TORCH_CHECK(self.is_cuda(), "addmm: expected 'self' to be CUDA, but got CPU");
+  TORCH_CHECK(result.is_cuda(), "addmm: expected 'out' to be CUDA, but got CPU");
+  TORCH_CHECK(mat2.is_cuda(), "addmm: expected 'mat2' to be CUDA, but got CPU");
+  TORCH_CHECK(cuda::check_device({mat1, mat2, self, result}));
+
+  TORCH_CHECK(
+      mat1.dim() == 2 && mat2.dim() == 2,
+      "addmm: 2-D matrices expected, got ", mat1.dim(), "D and ", mat2.dim(), "D tensors");
+  const int64_t m = mat1.size(0);
+  const int64_t k = mat1.size(1);
+  const int64_t n = mat2.size(1);
+  TORCH_CHECK(
+      mat2.size(0) == k,
+      "addmm: Expected dense matrix (mat2) size(0)=", k, ", got ", mat2.size(0));
+  TORCH_CHECK(
+      mat2.scalar_type() == mat1.scalar_type() && result.scalar_type() == mat1.scalar_type(),
+      "addmm: Expected mat1, mat2 and out to have the same dtype, but got ",
+      mat1.scalar_type(), ", ", mat2.scalar_type(), " and ", result.scalar_type());
+
+  c10::MaybeOwned<Tensor> self_ = expand_size(self, {m, n}, "addmm_out_sparse_csr");
+  result.resize_({m, n});
+  if (beta.toComplexDouble() == 0.) {
+    result.zero_();
+  } else {
+    if (!is_same_tensor(result, *self_)) {
+      result.copy_(*self_);
+    }
+    if (beta.toComplexDouble() != 1.) {
+      result.mul_(beta);
+    }
+  }
+  if (mat1._nnz() == 0 || m == 0 || n == 0 || k == 0) {
+    return result;
+  }
+
+  if (get_sparse_csr_impl(mat1)->is_blocked()) {
+    // Batched GEMMs of the blocks, which cuBLAS runs on tensor cores for
+    // half precision, instead of cuSPARSE, whose BSR routines only take
+    // square blocks and column major dense matrices.
+    Tensor out = result.is_contiguous() ? result : result.contiguous();
+    addmm_sparse_bsr_dense_batched_(out, mat1, mat2, alpha);
+    if (!is_same_tensor(out, result)) {
+      result.copy_(out);
+    }
+    return result;
+  }
+
+#if AT_USE_CUSPARSE_GENERIC_API()
+  // cuSPARSE writes into a row-major result with rows at least a row apart.
+  c10::MaybeOwned<Tensor> result_ = prepare_dense_matrix_for_cusparse(result);
+  c10::MaybeOwned<Tensor> mat2_ = prepare_dense_matrix_for_cusparse(mat2);
+  Tensor crow_indices = mat1.crow_indices().contiguous();
+  Tensor col_indices = mat1.col_indices().contiguous();
+  Tensor values = mat1.values().contiguous();
+  // Matrix-vector products need contiguous vectors.
+  Tensor dense = n == 1 ? mat2_->contiguous() : *mat2_;
+  Tensor out = n == 1 ? result_->contiguous() : *result_;
+
+  AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES(values.scalar_type(), "addmm_out_sparse_csr_dense_cuda", [&] {
+    spmm_cuda<scalar_t>(crow_indices, col_indices, values, k, dense, alpha, out);
+  });
+  if (!is_same_tensor(out, result)) {
+    result.copy_(out);
+  }
+#else
+  TORCH_CHECK(
+      false,
+      "addmm: sparse CSR tensors on CUDA need the generic cuSPARSE API of CUDA 11 or newer");
+#endif
+  return result;
+}
+
+// --------------------------------------------------------------------
+// sparse_sampled_addmm(SparseCsrTensor, Tensor, Tensor, Scalar, Scalar)
+// --------------------------------------------------------------------
+
+Tensor& sparse_sampled_addmm_out_sparse_csr_cuda(
+    const Tensor& self,
+    const Tensor& mat1,
+    const Tensor& mat2,
+    const Scalar& beta,
+    const Scalar& alpha,
+    Tensor& result) {
+  sparse_sampled_addmm_prepare_out(self, mat1, mat2, beta, result);
+  if (result._nnz() == 0 || mat1.size(1) == 0 || alpha.toComplexDouble() == 0.) {
+    return result;
+  }
+#if AT_USE_CUSPARSE_GENERIC_SDDMM()
+  if (result.scalar_type() == kFloat || result.scalar_type() == kDouble) {
+    c10::MaybeOwned<Tensor> mat1_ = prepare_dense_matrix_for_cusparse(mat1);
+    c10::MaybeOwned<Tensor> mat2_ = prepare_dense_matrix_for_cusparse(mat2);
+    AT_DISPATCH_FLOATING_TYPES(result.scalar_type(), "sparse_sampled_addmm_out_sparse_csr_cuda", [&] {
+      sddmm_cuda<scalar_t>(*mat1_, *mat2_, alpha, result);
+    });
+    return result;
+  }
+#endif
+  sparse_sampled_addmm_gather_(mat1, mat2, alpha, result);
+  return result;
+}
+
+// --------------------------------------------------------------------
+// add(Tensor, SparseCsrTensor, Scalar)
+// --------------------------------------------------------------------
+
+Tensor& add_out_dense_sparse_csr_cuda(
+    Tensor& out,
+    const Tensor& dense,
+    const SparseCsrTensor& src,
+    const Scalar& alpha) {
+  TORCH_INTERNAL_ASSERT(dense.layout() == kStrided);
+  TORCH_INTERNAL_ASSERT(src.is_sparse_csr());
+  TORCH_CHECK(dense.is_cuda(), "add: expected 'self' to be a CUDA tensor, but got a CPU tensor");
+  TORCH_CHECK(out.is_cuda(), "add: expected 'out' to be a CUDA tensor, but got a CPU tensor");
+  TORCH_CHECK(cuda::check_device({src, dense, out}));
+
+  TORCH_CHECK(
+      dense.sizes().equals(src.sizes()),
+      "add: expected 'self' and 'other' to have same size, but self has size ",
+      dense.sizes(),
+      " while other has size ",
+      src.sizes(),
+      " (FYI: op2-sparse addition does not currently support broadcasting)");
+
+  auto commonDtype = promoteTypes(dense.scalar_type(), src.scalar_type());
+  TORCH_CHECK(
+      canCast(commonDtype, out.scalar_type()),
+      "Can't convert result type ",
+      commonDtype,
+      " to output ",
+      out.scalar_type(),
+      " in add operation");
+
+  out.resize_as_(dense);
+  Tensor resultBuffer = out;
+  if (out.scalar_type() != commonDtype) {
+    resultBuffer = dense.to(commonDtype);
+  } else if (!is_same_tensor(out, dense)) {
+    resultBuffer.copy_(dense);
+  }
+  if (get_sparse_csr_impl(src)->is_blocked()) {
+    add_sparse_bsr_to_dense_(resultBuffer, src, alpha);
+  } else {
+    Tensor values = src.values().to(commonDtype);
+    if (alpha.toComplexDouble() != 1.) {
+      values = values.mul(alpha);
+    }
+    Tensor indices = at::_convert_indices_from_csr_to_coo(
+        src.crow_indices(), src.col_indices(), /*out_int32=*/false);
+    // Nonzeros of a CSR tensor need not be unique, hence the accumulation.
+    resultBuffer.index_put_(
+        toListOfOptionalTensors(indices.unbind(0)),
+        values,
+        /*accumulate=*/true);
+  }
+  if (!is_same_tensor(out, resultBuffer)) {
+    out.copy_(resultBuffer);
+  }
+  return out;
+}
+
+Tensor& add_out_sparse_csr_cuda(
+    const Tensor& self,
+    const SparseCsrTensor& other,
+    const Scalar& alpha,
+    SparseCsrTensor& out) {
+  if (self.layout() == kStrided) {
+    return add_out_dense_sparse_csr_cuda(out, self, other, alpha);
+  } else {
+    TORCH_CHECK(
+        false,
+        "NotImplementedError: Addition of sparse CSR tensors is not yet implemented.")
+  }
+  return out;
+}
+
+}} // namespace at::native
@@ -331,7 +331,8 @@ Command::Pool::Pool(const GPU& gpu)
     command_pool_(
         create_command_pool(gpu.device, gpu.adapter->compute_queue_family_index),
         VK_DELETER(CommandPool)(device_)),
-    buffer_{} {
+    buffer_{},
+    stream_{} {
   TORCH_INTERNAL_ASSERT_DEBUG_ONLY(
       device_,
       "Invalid Vulkan device!");
@@ -341,6 +342,7 @@ Command::Pool::Pool(const GPU& gpu)
       "Invalid Vulkan command pool!");
 
   buffer_.pool.reserve(Configuration::kReserve);
+  stream_.cutoff = Configuration::kSubmit;
 }
 
 Command::Pool::Pool(Pool&& pool)
@@ -428,6 +430,10 @@ void Command::Pool::purge() {
   VK_CHECK(vkResetCommandPool(device_, command_pool_.get(), 0u));
 }
 
+void Command::Pool::set_submission_cutoff(const uint32_t cutoff) {
+  stream_.cutoff = cutoff;
+}
+
 void Command::Pool::submit(
     const VkQueue queue,
     const c10::ArrayRef<const Buffer> buffers,
@@ -458,9 +464,11 @@ void Command::Pool::submit(
     if (stream_.buffer.handle() == command_buffer) {
       // Hand the stream off to the driver if:
       // - The user has implictly signaled interest in the results via a fence.
-      // - We are over the submission cutoff.  We don't want to starve the GPU.
+      // - We are over the submission cutoff, unless submissions are deferred.
+      //   We don't want to starve the GPU.
 
-      if (fence || (stream_.counter++ > Configuration::kSubmit)) {
+      if (fence ||
+          ((stream_.cutoff > 0u) && (stream_.counter++ > stream_.cutoff))) {
         stream_.buffer.end();
         stream_.buffer.invalidate();
       }
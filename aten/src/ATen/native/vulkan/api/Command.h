@@ -90,6 +90,13 @@ struct Command final {
     Buffer& stream();
     void purge();
 
+    // The stream is handed to the driver once it has accumulated this many
+    // submissions, so that the GPU is not starved while the host records.
+    // Zero defers all submissions of the stream until a fence is requested,
+    // i.e. until results are read back on the host, so that an inference is
+    // recorded into one command buffer and submitted once.
+    void set_submission_cutoff(uint32_t cutoff);
+
     void submit(
         VkQueue queue,
         c10::ArrayRef<const Buffer> buffers,
@@ -116,6 +123,7 @@ struct Command final {
     struct {
       Buffer buffer;
       uint32_t counter;
+      uint32_t cutoff;
     } stream_;
   } pool /* [thread_count] */;
 
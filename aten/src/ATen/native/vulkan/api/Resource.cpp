@@ -432,6 +432,20 @@ Resource::Buffer Resource::Pool::buffer(
       "This resource pool is in an invalid state! ",
       "Potential reason: This resource pool is moved from.");
 
+  {
+    const auto free_itr = buffer_.free.find(descriptor);
+
+    if ((buffer_.free.end() != free_itr) && !free_itr->second.empty()) {
+      buffer_.pool.push_back({
+        descriptor,
+        std::move(free_itr->second.back()),
+      });
+
+      free_itr->second.pop_back();
+      return buffer_.pool.back().handle.get();
+    }
+  }
+
   const VkBufferCreateInfo buffer_create_info{
     VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
     nullptr,
@@ -487,7 +501,9 @@ Resource::Buffer Resource::Pool::buffer(
       allocation,
       buffer));
 
-  buffer_.pool.emplace_back(
+  buffer_.pool.push_back({
+    descriptor,
+    {
       Buffer{
         Buffer::Object{
           buffer,
@@ -499,9 +515,11 @@ Resource::Buffer Resource::Pool::buffer(
           allocation,
         },
       },
-      &release_buffer);
+      &release_buffer,
+    },
+  });
 
-  return buffer_.pool.back().get();
+  return buffer_.pool.back().handle.get();
 }
 
 Resource::Image Resource::Pool::image(
@@ -511,6 +529,25 @@ Resource::Image Resource::Pool::image(
       "This resource pool is in an invalid state! ",
       "Potential reason: This resource pool is moved from.");
 
+  {
+    const auto free_itr = image_.free.find(descriptor);
+
+    if ((image_.free.end() != free_itr) && !free_itr->second.empty()) {
+      image_.pool.push_back({
+        descriptor,
+        std::move(free_itr->second.back()),
+      });
+
+      free_itr->second.pop_back();
+
+      // The contents of a reused image are undefined, just as those of a new
+      // one, and its layout is tracked by its user from scratch.
+      Image image = image_.pool.back().handle.get();
+      image.object.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+      return image;
+    }
+  }
+
   const VkImageCreateInfo image_create_info{
     VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
     nullptr,
@@ -606,7 +643,9 @@ Resource::Image Resource::Pool::image(
       view,
       "Invalid Vulkan image view!");
 
-  image_.pool.emplace_back(
+  image_.pool.push_back({
+    descriptor,
+    {
       Image{
         Image::Object{
           image,
@@ -619,9 +658,11 @@ Resource::Image Resource::Pool::image(
           allocation,
         },
       },
-      &release_image);
+      &release_image,
+    },
+  });
 
-  return image_.pool.back().get();
+  return image_.pool.back().handle.get();
 }
 
 Resource::Fence Resource::Pool::fence() {
@@ -680,7 +721,20 @@ void Resource::Pool::purge() {
   }
 
   fence_.in_use = 0u;
+
+  // Destroy what the last run did not reuse, and keep what it used for the
+  // next one.  See Resource::Pool::buffer() and Resource::Pool::image().
+
+  image_.free.clear();
+  for (Entry<Image>& entry : image_.pool) {
+    image_.free[entry.descriptor].push_back(std::move(entry.handle));
+  }
   image_.pool.clear();
+
+  buffer_.free.clear();
+  for (Entry<Buffer>& entry : buffer_.pool) {
+    buffer_.free[entry.descriptor].push_back(std::move(entry.handle));
+  }
   buffer_.pool.clear();
 }
 
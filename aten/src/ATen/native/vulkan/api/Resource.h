@@ -290,6 +290,14 @@ struct Resource final {
 
     // Primary
 
+    // Buffers and images are released all at once by purge(), which happens
+    // once per inference.  Rather than being destroyed, the ones released by a
+    // purge are kept and handed out again, before the next purge, for requests
+    // with an identical descriptor, so that consecutive inferences of the same
+    // model reuse the resources of the previous one instead of allocating and
+    // binding memory, and creating views, all over again.  The ones not reused
+    // by the time of the next purge are destroyed.
+
     Buffer buffer(const Buffer::Descriptor& descriptor);
     Image image(const Image::Descriptor& descriptor);
     Fence fence();
@@ -317,12 +325,31 @@ struct Resource final {
       std::unique_ptr<Policy> policy;
     } memory_;
 
+    struct Hasher final {
+      size_t operator()(const Buffer::Descriptor& descriptor) const;
+      size_t operator()(const Image::Descriptor& descriptor) const;
+    };
+
+    template<typename Type>
+    struct Entry final {
+      typename Type::Descriptor descriptor;
+      Handle<Type, void(*)(const Type&)> handle;
+    };
+
+    template<typename Type>
+    using Free = std::unordered_map<
+        typename Type::Descriptor,
+        std::vector<Handle<Type, void(*)(const Type&)>>,
+        Hasher>;
+
     struct {
-      std::vector<Handle<Buffer, void(*)(const Buffer&)>> pool;
+      std::vector<Entry<Buffer>> pool;
+      Free<Buffer> free;
     } buffer_;
 
     struct {
-      std::vector<Handle<Image, void(*)(const Image&)>> pool;
+      std::vector<Entry<Image>> pool;
+      Free<Image> free;
       Image::Sampler sampler;
     } image_;
 
@@ -403,6 +430,64 @@ inline bool operator==(
   return (0 == memcmp(&_1, &_2, sizeof(Resource::Image::Sampler::Descriptor)));
 }
 
+inline bool operator==(
+    const Resource::Memory::Descriptor& _1,
+    const Resource::Memory::Descriptor& _2) {
+  return (_1.usage == _2.usage) &&
+         (_1.required == _2.required) &&
+         (_1.preferred == _2.preferred);
+}
+
+inline bool operator==(
+    const Resource::Buffer::Descriptor& _1,
+    const Resource::Buffer::Descriptor& _2) {
+  return (_1.size == _2.size) &&
+         (_1.usage.buffer == _2.usage.buffer) &&
+         (_1.usage.memory == _2.usage.memory);
+}
+
+inline bool operator==(
+    const Resource::Image::Descriptor& _1,
+    const Resource::Image::Descriptor& _2) {
+  return (_1.type == _2.type) &&
+         (_1.format == _2.format) &&
+         (_1.extent.width == _2.extent.width) &&
+         (_1.extent.height == _2.extent.height) &&
+         (_1.extent.depth == _2.extent.depth) &&
+         (_1.usage.image == _2.usage.image) &&
+         (_1.usage.memory == _2.usage.memory) &&
+         (_1.view.type == _2.view.type) &&
+         (_1.view.format == _2.view.format) &&
+         (_1.sampler == _2.sampler);
+}
+
+inline size_t Resource::Pool::Hasher::operator()(
+    const Buffer::Descriptor& descriptor) const {
+  return c10::get_hash(
+      descriptor.size,
+      descriptor.usage.buffer,
+      descriptor.usage.memory.usage,
+      descriptor.usage.memory.required,
+      descriptor.usage.memory.preferred);
+}
+
+inline size_t Resource::Pool::Hasher::operator()(
+    const Image::Descriptor& descriptor) const {
+  return c10::get_hash(
+      descriptor.type,
+      descriptor.format,
+      descriptor.extent.width,
+      descriptor.extent.height,
+      descriptor.extent.depth,
+      descriptor.usage.image,
+      descriptor.usage.memory.usage,
+      descriptor.usage.memory.required,
+      descriptor.usage.memory.preferred,
+      descriptor.view.type,
+      descriptor.view.format,
+      Image::Sampler::Factory::Hasher{}(descriptor.sampler));
+}
+
 inline size_t Resource::Image::Sampler::Factory::Hasher::operator()(
     const Descriptor& descriptor) const {
   return c10::get_hash(
@@ -64,12 +64,17 @@ typedef enum {
     ANEURALNETWORKS_PREFER_SUSTAINED_SPEED = 2,
 } PreferenceCode;
 
+enum {
+    ANEURALNETWORKS_BYTE_SIZE_OF_CACHE_TOKEN = 32
+};
+
 typedef struct ANeuralNetworksMemory ANeuralNetworksMemory;
 typedef struct ANeuralNetworksModel ANeuralNetworksModel;
 typedef struct ANeuralNetworksDevice ANeuralNetworksDevice;
 typedef struct ANeuralNetworksCompilation ANeuralNetworksCompilation;
 typedef struct ANeuralNetworksExecution ANeuralNetworksExecution;
 typedef struct ANeuralNetworksEvent ANeuralNetworksEvent;
+typedef struct ANeuralNetworksBurst ANeuralNetworksBurst;
 
 typedef int32_t ANeuralNetworksOperationType;
 
@@ -69,6 +69,10 @@ NNAPI_FUNCTIONS = [
     ("void", "ANeuralNetworksEvent_free", "ANeuralNetworksEvent* event"),  # noqa: B950
     ("int", "ANeuralNetworksExecution_getOutputOperandRank", "ANeuralNetworksExecution* execution, int32_t index, uint32_t* rank"),  # noqa: B950
     ("int", "ANeuralNetworksExecution_getOutputOperandDimensions", "ANeuralNetworksExecution* execution, int32_t index, uint32_t* dimensions"),  # noqa: B950
+    ("int", "ANeuralNetworksCompilation_setCaching", "ANeuralNetworksCompilation* compilation, const char* cacheDir, const uint8_t* token"),  # noqa: B950
+    ("int", "ANeuralNetworksBurst_create", "ANeuralNetworksCompilation* compilation, ANeuralNetworksBurst** burst"),  # noqa: B950
+    ("void", "ANeuralNetworksBurst_free", "ANeuralNetworksBurst* burst"),  # noqa: B950
+    ("int", "ANeuralNetworksExecution_burstCompute", "ANeuralNetworksExecution* execution, ANeuralNetworksBurst* burst"),  # noqa: B950
 ]
 
 
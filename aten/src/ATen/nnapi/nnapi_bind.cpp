@@ -1,6 +1,11 @@
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sstream>
 #include <vector>
 
 #include <ATen/ATen.h>
+#include <c10/util/hash.h>
 #include <torch/custom_class.h>
 
 #include <ATen/nnapi/nnapi_wrapper.h>
@@ -38,19 +43,94 @@ void load_platform_library() {
 MAKE_SMART_PTR(Model)
 MAKE_SMART_PTR(Compilation)
 MAKE_SMART_PTR(Execution)
+MAKE_SMART_PTR(Burst)
 
 #undef MAKE_SMART_PTR
 
+// Note [NNAPI compilation cache]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Compiling a model for an accelerator can take much longer than running it,
+// and happens every time an app loads the model. When a cache directory is
+// set, compilations pass it to ANeuralNetworksCompilation_setCaching so that
+// drivers supporting it store the compiled model there and load it on the
+// next start instead of compiling again.
+//
+// NNAPI cannot tell whether a cached compilation was produced by the same
+// model: the cache token has to be unique to it. The token is made of hashes
+// of the serialized model, of its weights, and of the names and versions of
+// the devices NNAPI exposes, so that a model updated by the app, or an
+// updated driver, is compiled again.
+//
+// Each compilation reads its directory from PYTORCH_NNAPI_CACHE_DIR when it
+// is created; Compilation.set_cache_dir overrides it before init, e.g. with
+// the cache directory of the app. An empty directory (the default) disables
+// caching, as does running on Android versions without setCaching.
+
+std::string describe_devices() {
+  if (!nnapi->_getDeviceCount || !nnapi->_getDevice ||
+      !nnapi->Device_getName || !nnapi->Device_getVersion) {
+    return "";
+  }
+  std::stringstream ss;
+  uint32_t num_devices = 0;
+  check_nnapi->_getDeviceCount(&num_devices);
+  for (uint32_t i = 0; i < num_devices; i++) {
+    ANeuralNetworksDevice* device;
+    const char* name;
+    const char* version;
+    check_nnapi->_getDevice(i, &device);
+    check_nnapi->Device_getName(device, &name);
+    check_nnapi->Device_getVersion(device, &version);
+    ss << name << " " << version << "\n";
+  }
+  return ss.str();
+}
+
+// See Note [NNAPI compilation cache]
+void set_compilation_caching(
+    ANeuralNetworksCompilation* compilation,
+    const std::string& dir,
+    c10::ArrayRef<uint8_t> ser_model,
+    const std::vector<at::Tensor>& parameter_buffers) {
+  if (dir.empty() || !nnapi->Compilation_setCaching) {
+    return;
+  }
+  uint64_t hashes[4];
+  static_assert(
+      sizeof(hashes) == ANEURALNETWORKS_BYTE_SIZE_OF_CACHE_TOKEN,
+      "Unexpected NNAPI cache token size");
+  hashes[0] = c10::stable_hash(ser_model.data(), ser_model.size());
+  hashes[1] = c10::kStableHashSeed;
+  for (auto& t : parameter_buffers) {
+    hashes[1] = c10::stable_hash(t.data_ptr(), t.nbytes(), hashes[1]);
+  }
+  hashes[2] = c10::stable_hash(describe_devices());
+  // the lanes are hashed together so that two models have to collide on all
+  // of them to share a token
+  hashes[3] = c10::stable_hash(hashes, 3 * sizeof(uint64_t));
+  uint8_t token[ANEURALNETWORKS_BYTE_SIZE_OF_CACHE_TOKEN];
+  std::memcpy(token, hashes, sizeof(token));
+  check_nnapi->Compilation_setCaching(compilation, dir.c_str(), token);
+}
+
 struct NnapiCompilation : torch::jit::CustomClassHolder {
   NnapiCompilation() {
     // Could possibly call load_platform_library here, but error reporting
     // can be complicated if the constructor is called during model loading.
     // Instead, delay all work until the explicit init call.
+    const char* cache_dir_env = std::getenv("PYTORCH_NNAPI_CACHE_DIR");
+    cache_dir_ = cache_dir_env ? cache_dir_env : "";
   }
 
   ~NnapiCompilation() {
   }
 
+  // See Note [NNAPI compilation cache]
+  void set_cache_dir(std::string dir) {
+    TORCH_CHECK(!model_, "The NNAPI cache directory must be set before init.");
+    cache_dir_ = std::move(dir);
+  }
+
   void init(
       at::Tensor serialized_model_tensor,
       std::vector<at::Tensor> parameter_buffers) {
@@ -104,10 +184,20 @@ struct NnapiCompilation : torch::jit::CustomClassHolder {
 
     ANeuralNetworksCompilation* compilation;
     check_nnapi->Compilation_create(model_.get(), &compilation);
+    compilation_.reset(compilation);
     // TODO: Make this configurable.
     check_nnapi->Compilation_setPreference(compilation, ANEURALNETWORKS_PREFER_SUSTAINED_SPEED);
+    set_compilation_caching(
+        compilation, cache_dir_, ser_model, parameter_buffers);
     check_nnapi->Compilation_finish(compilation);
-    compilation_.reset(compilation);
+
+    // Executions can only be computed once, but a burst lets the executions
+    // of every run share the resources the driver sets up for the first one.
+    if (nnapi->Burst_create && nnapi->Execution_burstCompute) {
+      ANeuralNetworksBurst* burst;
+      check_nnapi->Burst_create(compilation_.get(), &burst);
+      burst_.reset(burst);
+    }
   }
 
   void run(
@@ -145,7 +235,13 @@ struct NnapiCompilation : torch::jit::CustomClassHolder {
           t.nbytes());
     }
 
-    check_nnapi->Execution_compute(execution);
+    if (burst_) {
+      // A burst runs one execution at a time.
+      std::lock_guard<std::mutex> guard(burst_mutex_);
+      check_nnapi->Execution_burstCompute(execution, burst_.get());
+    } else {
+      check_nnapi->Execution_compute(execution);
+    }
 
     // TODO: Maybe skip this for fixed-size outputs?
     for (size_t i = 0; i < outputs.size(); i++) {
@@ -186,8 +282,11 @@ struct NnapiCompilation : torch::jit::CustomClassHolder {
     CAFFE_THROW("Bad dtype");
   }
 
+  std::string cache_dir_;
   ModelPtr model_;
   CompilationPtr compilation_;
+  BurstPtr burst_;
+  std::mutex burst_mutex_;
   int32_t num_inputs_;
   int32_t num_outputs_;
 };
@@ -198,6 +297,7 @@ static auto register_NnapiCompilation = [](){
         .def(torch::jit::init<>())
         .def("init", &NnapiCompilation::init)
         .def("run", &NnapiCompilation::run)
+        .def("set_cache_dir", &NnapiCompilation::set_cache_dir)
         ;
   } catch (std::exception& exn) {
     LOG(ERROR) << "Failed to register class nnapi.Compilation: " << exn.what();
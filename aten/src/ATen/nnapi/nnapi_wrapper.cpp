@@ -246,6 +246,31 @@ int check_Execution_getOutputOperandDimensions(ANeuralNetworksExecution* executi
   CAFFE_ENFORCE(ret == ANEURALNETWORKS_NO_ERROR);
   return ret;
 }
+int check_Compilation_setCaching(ANeuralNetworksCompilation* compilation, const char* cacheDir, const uint8_t* token) {
+  CAFFE_ENFORCE(nnapi_.Compilation_setCaching);
+  int ret = nnapi_.Compilation_setCaching(compilation,cacheDir,token);
+  // TODO: Maybe add better logging here.
+  CAFFE_ENFORCE(ret == ANEURALNETWORKS_NO_ERROR);
+  return ret;
+}
+int check_Burst_create(ANeuralNetworksCompilation* compilation, ANeuralNetworksBurst** burst) {
+  CAFFE_ENFORCE(nnapi_.Burst_create);
+  int ret = nnapi_.Burst_create(compilation,burst);
+  // TODO: Maybe add better logging here.
+  CAFFE_ENFORCE(ret == ANEURALNETWORKS_NO_ERROR);
+  return ret;
+}
+void check_Burst_free(ANeuralNetworksBurst* burst) {
+  CAFFE_ENFORCE(nnapi_.Burst_free);
+  nnapi_.Burst_free(burst);
+}
+int check_Execution_burstCompute(ANeuralNetworksExecution* execution, ANeuralNetworksBurst* burst) {
+  CAFFE_ENFORCE(nnapi_.Execution_burstCompute);
+  int ret = nnapi_.Execution_burstCompute(execution,burst);
+  // TODO: Maybe add better logging here.
+  CAFFE_ENFORCE(ret == ANEURALNETWORKS_NO_ERROR);
+  return ret;
+}
 void nnapi_wrapper_load(struct nnapi_wrapper** nnapi, struct nnapi_wrapper** check_nnapi) {
 #ifdef _WIN32
   TORCH_CHECK(false, "Running NNAPI models is not supported on Windows.");
@@ -323,6 +348,14 @@ void nnapi_wrapper_load(struct nnapi_wrapper** nnapi, struct nnapi_wrapper** che
     check_nnapi_.Execution_getOutputOperandRank = check_Execution_getOutputOperandRank;
     *(void**)&nnapi_.Execution_getOutputOperandDimensions = dlsym(handle, "ANeuralNetworksExecution_getOutputOperandDimensions");
     check_nnapi_.Execution_getOutputOperandDimensions = check_Execution_getOutputOperandDimensions;
+    *(void**)&nnapi_.Compilation_setCaching = dlsym(handle, "ANeuralNetworksCompilation_setCaching");
+    check_nnapi_.Compilation_setCaching = check_Compilation_setCaching;
+    *(void**)&nnapi_.Burst_create = dlsym(handle, "ANeuralNetworksBurst_create");
+    check_nnapi_.Burst_create = check_Burst_create;
+    *(void**)&nnapi_.Burst_free = dlsym(handle, "ANeuralNetworksBurst_free");
+    check_nnapi_.Burst_free = check_Burst_free;
+    *(void**)&nnapi_.Execution_burstCompute = dlsym(handle, "ANeuralNetworksExecution_burstCompute");
+    check_nnapi_.Execution_burstCompute = check_Execution_burstCompute;
     loaded = 1;
   }
   *nnapi = &nnapi_;
@@ -3,6 +3,7 @@
 #include <ATen/ATen.h>
 #include <ATen/Utils.h>
 #include <ATen/CPUGeneratorImpl.h>
+#include <ATen/Parallel.h>
 #include <ATen/core/PhiloxRNGEngine.h>
 #include <thread>
 #include <limits>
@@ -200,6 +201,72 @@ TEST(CPUGeneratorImpl, TestPhiloxEngineIndex) {
   ASSERT_NE(engine1(), engine2());
 }
 
+/**
+ * Philox mode of CPUGeneratorImpl Tests
+ */
+
+TEST(CPUGeneratorImpl, TestPhiloxModeThreadInvariance) {
+  // Test Description:
+  //   Tests that the Philox mode gives the same samples
+  //   whatever the number of threads filling the tensor.
+  //   The sizes aren't multiples of 16 to cover the tail
+  //   of the Box-Muller transform.
+  auto sample = [](int num_threads) {
+    at::set_num_threads(num_threads);
+    auto gen = at::detail::createCPUGenerator(123);
+    check_generator<CPUGeneratorImpl>(gen)->set_philox_mode(true);
+    auto u = at::empty({100003}).uniform_(-1, 1, gen);
+    auto n = at::empty({100003}, at::kDouble).normal_(2, 3, gen);
+    auto b = at::empty({100003}, at::kByte).bernoulli_(0.3, gen);
+    return std::make_tuple(u, n, b);
+  };
+  const auto num_threads = at::get_num_threads();
+  auto serial = sample(1);
+  auto parallel = sample(4);
+  at::set_num_threads(num_threads);
+  ASSERT_TRUE(at::equal(std::get<0>(serial), std::get<0>(parallel)));
+  ASSERT_TRUE(at::equal(std::get<1>(serial), std::get<1>(parallel)));
+  ASSERT_TRUE(at::equal(std::get<2>(serial), std::get<2>(parallel)));
+}
+
+TEST(CPUGeneratorImpl, TestPhiloxModeLayout) {
+  // Test Description:
+  //   Tests that a non contiguous output gets the
+  //   samples of a contiguous one in its logical order.
+  auto gen1 = at::detail::createCPUGenerator(42);
+  auto gen2 = at::detail::createCPUGenerator(42);
+  check_generator<CPUGeneratorImpl>(gen1)->set_philox_mode(true);
+  check_generator<CPUGeneratorImpl>(gen2)->set_philox_mode(true);
+  auto contiguous = at::empty({64, 33}).normal_(0, 1, gen1);
+  auto transposed = at::empty({33, 64}).t().normal_(0, 1, gen2);
+  ASSERT_TRUE(at::equal(contiguous, transposed));
+}
+
+TEST(CPUGeneratorImpl, TestPhiloxModeGetSetState) {
+  // Test Description:
+  //   Tests that the state of a generator in the Philox mode
+  //   restores its offset, and that the state of a generator
+  //   which never used the mode keeps its size.
+  auto gen = at::detail::createCPUGenerator(7);
+  auto cpu_gen = check_generator<CPUGeneratorImpl>(gen);
+  const auto mt19937_state_size = cpu_gen->get_state()->numel();
+  cpu_gen->set_philox_mode(true);
+  at::empty({1000}).uniform_(0, 1, gen);
+  auto state = cpu_gen->get_state();
+  ASSERT_NE(state->numel(), mt19937_state_size);
+  auto expected = at::empty({1000}).uniform_(0, 1, gen);
+
+  auto other = at::detail::createCPUGenerator(0);
+  auto cpu_other = check_generator<CPUGeneratorImpl>(other);
+  cpu_other->set_state(*state);
+  ASSERT_TRUE(cpu_other->philox_mode());
+  ASSERT_EQ(cpu_other->philox_offset(), cpu_gen->philox_offset() - 250);
+  ASSERT_TRUE(at::equal(at::empty({1000}).uniform_(0, 1, other), expected));
+
+  cpu_other->set_current_seed(7);
+  ASSERT_EQ(cpu_other->philox_offset(), 0u);
+}
+
 /**
  * MT19937 CPU Engine Tests
  */
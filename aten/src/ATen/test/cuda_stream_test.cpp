@@ -197,6 +197,43 @@ TEST(TestStream, StreamPoolTest) {
   ASSERT_TRUE(hasDuplicates);
 }
 
+// Leased streams are exclusive until released
+TEST(TestStream, StreamLeaseTest) {
+  if (!at::cuda::is_available()) return;
+  std::unordered_set<cudaStream_t> pool_streams{};
+  for (const auto i : c10::irange(200)) {
+    pool_streams.insert(at::cuda::getStreamFromPool().stream());
+  }
+
+  std::unordered_set<cudaStream_t> leased_streams{};
+  {
+    std::vector<at::cuda::CUDAStreamLease> leases{};
+    for (const auto i : c10::irange(8)) {
+      leases.emplace_back();
+      auto stream = leases.back().stream();
+      ASSERT_EQ_CUDA(pool_streams.count(stream.stream()), 0);
+      ASSERT_TRUE(leased_streams.insert(stream.stream()).second);
+
+      // The ID of a leased stream maps back to it
+      ASSERT_EQ_CUDA(at::cuda::CUDAStream::unpack(stream.pack()), stream);
+    }
+
+    at::cuda::CUDAStreamLease high(/*isHighPriority=*/true);
+    ASSERT_EQ_CUDA(leased_streams.count(high.stream().stream()), 0);
+
+    // Moving transfers the lease
+    at::cuda::CUDAStreamLease moved = std::move(leases.back());
+    leases.pop_back();
+    ASSERT_EQ_CUDA(leased_streams.count(moved.stream().stream()), 1);
+  }
+
+  // Released streams are leased again
+  at::cuda::CUDAStreamLease lease;
+  ASSERT_EQ_CUDA(leased_streams.count(lease.stream().stream()), 1);
+  at::cuda::CUDAStreamGuard guard(lease.stream());
+  ASSERT_EQ_CUDA(at::cuda::getCurrentCUDAStream(), lease.stream());
+}
+
 // Multi-GPU
 TEST(TestStream, MultiGPUTest) {
   if (!at::cuda::is_available()) return;
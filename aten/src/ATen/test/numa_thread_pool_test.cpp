@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <ATen/Parallel.h>
+#include <c10/util/Exception.h>
+#include <c10/util/numa.h>
+
+#include <future>
+#include <thread>
+
+namespace {
+
+// Returns the NUMA node of the thread that runs a task passed to `launch`
+template <typename Launch>
+int node_of_task(Launch launch) {
+  std::promise<int> node;
+  launch([&node]() { node.set_value(at::get_thread_numa_node()); });
+  return node.get_future().get();
+}
+
+} // namespace
+
+TEST(NUMAThreadPoolTest, UnboundThreadHasNoNode) {
+  std::thread t([]() {
+    ASSERT_EQ(at::get_thread_numa_node(), -1);
+    ASSERT_EQ(c10::GetThreadNUMANode(), -1);
+  });
+  t.join();
+}
+
+TEST(NUMAThreadPoolTest, PoolsFollowBoundNode) {
+  // Partitioning is fixed by the first parallel work of the process, so
+  // everything that depends on it is checked here, in order.
+  FLAGS_caffe2_cpu_numa_enabled = true;
+  at::set_num_threads(2);
+  at::set_numa_thread_pools(true);
+  ASSERT_TRUE(at::get_numa_thread_pools());
+
+  // Binding is a no-op when NUMA is unavailable, and threads then keep using
+  // the default pools.
+  const int expected_node = c10::IsNUMAEnabled() ? 0 : -1;
+
+  std::thread bound([expected_node]() {
+    at::set_thread_numa_node(0);
+    ASSERT_EQ(at::get_thread_numa_node(), expected_node);
+    ASSERT_EQ(c10::GetThreadNUMANode(), expected_node);
+    ASSERT_EQ(at::internal::numa_pool_node(), expected_node);
+
+    // the workers of a node's pools are bound to that node
+    ASSERT_EQ(node_of_task(at::launch), expected_node);
+#if AT_PARALLEL_NATIVE
+    ASSERT_EQ(node_of_task(at::intraop_launch), expected_node);
+#endif
+  });
+  bound.join();
+
+  std::thread unbound([]() {
+    ASSERT_EQ(at::internal::numa_pool_node(), -1);
+    ASSERT_EQ(node_of_task(at::launch), -1);
+#if AT_PARALLEL_NATIVE
+    ASSERT_EQ(node_of_task(at::intraop_launch), -1);
+#endif
+  });
+  unbound.join();
+
+  ASSERT_THROW(at::set_numa_thread_pools(false), c10::Error);
+  ASSERT_TRUE(at::get_numa_thread_pools());
+}
+
+TEST(NUMAThreadPoolTest, RejectsNegativeNode) {
+  ASSERT_THROW(at::set_thread_numa_node(-1), c10::Error);
+}
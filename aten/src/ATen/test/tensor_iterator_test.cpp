@@ -234,3 +234,56 @@ TEST(TensorIteratorTest, CpuKernelMultipleOutputs_##name) {
   EXPECT_TRUE(out2.equal(expected2));                                                               \
 }
 AT_FORALL_SCALAR_TYPES(MULTIPLE_OUTPUTS_TEST_ITER_FOR_TYPE)
+
+TEST(TensorIteratorTest, GeometryCache) {
+  at::TensorIteratorGeometryCache cache;
+  auto a = at::randn({3, 8}).t();
+  auto b = at::randn({8, 1});
+  auto out = at::empty({8, 3});
+  {
+    at::TensorIteratorGeometryCacheGuard guard(&cache);
+    at::add_out(out, a, b);
+    EXPECT_EQ(cache.hits(), 0);
+    // same geometry, different data
+    auto a2 = at::randn({3, 8}).t();
+    at::add_out(out, a2, b);
+    EXPECT_EQ(cache.hits(), 1);
+    EXPECT_TRUE(out.equal(a2 + b));
+    // a different broadcast must not reuse the cached geometry
+    auto c = at::randn({1, 3});
+    at::add_out(out, a, c);
+    EXPECT_EQ(cache.hits(), 1);
+    EXPECT_TRUE(out.equal(a + c));
+  }
+  // builds outside of the guard don't use the cache
+  at::add_out(out, a, b);
+  EXPECT_EQ(cache.hits(), 1);
+}
+
+#define MULTIPLE_OUTPUTS_VEC_TEST_ITER_FOR_TYPE(ctype,name)                                         \
+TEST(TensorIteratorTest, CpuKernelMultipleOutputsVec_##name) {                                      \
+  using Vec = at::vec256::Vec256<ctype>;                                                            \
+  auto in1 = random_tensor_for_type(k##name);                                                       \
+  auto in2 = random_tensor_for_type(k##name);                                                       \
+  Tensor out1 = at::empty({0}, in1.options());                                                      \
+  Tensor out2 = at::empty({0}, in1.options());                                                      \
+  auto expected1 = in1.add(in2);                                                                    \
+  auto expected2 = in1.mul(in2);                                                                    \
+  auto iter = at::TensorIteratorConfig()                                                            \
+    .add_output(out1)                                                                               \
+    .add_output(out2)                                                                               \
+    .add_input(in1)                                                                                 \
+    .add_input(in2)                                                                                 \
+    .build();                                                                                       \
+  at::native::cpu_kernel_multiple_outputs_vec(iter,                                                 \
+    [=](ctype a, ctype b) -> std::tuple<ctype, ctype> {                                             \
+      return std::tuple<ctype, ctype>(a + b, a * b);                                                \
+    },                                                                                              \
+    [=](Vec a, Vec b) -> std::tuple<Vec, Vec> {                                                     \
+      return std::tuple<Vec, Vec>(a + b, a * b);                                                    \
+    });                                                                                             \
+  EXPECT_TRUE(out1.equal(expected1));                                                               \
+  EXPECT_TRUE(out2.equal(expected2));                                                               \
+}
+MULTIPLE_OUTPUTS_VEC_TEST_ITER_FOR_TYPE(float, Float)
+MULTIPLE_OUTPUTS_VEC_TEST_ITER_FOR_TYPE(double, Double)
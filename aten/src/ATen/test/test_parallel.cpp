@@ -2,9 +2,15 @@
 
 #include <ATen/ATen.h>
 #include <ATen/DLConvertor.h>
+#include <ATen/InterOpPriority.h>
 #include <ATen/Parallel.h>
 
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <iostream>
+#include <thread>
+#include <vector>
 #include <string.h>
 #include <sstream>
 
@@ -69,3 +75,96 @@ TEST(TestParallel, IntraOpLaunchFuture) {
 
   ASSERT_TRUE(v1 == 1 && v2 == 2);
 }
+
+TEST(TestParallel, UnevenWork) {
+  // chunks with very different costs must each run exactly once,
+  // and get_thread_num() must stay a valid per-thread index
+  const int64_t n = 1000;
+  std::vector<std::atomic<int>> visits(n);
+  for (auto& v : visits) {
+    v = 0;
+  }
+  std::atomic<bool> bad_thread_num{false};
+  at::parallel_for(0, n, 1, [&](int64_t begin, int64_t end) {
+    if (at::get_thread_num() >= at::get_num_threads()) {
+      bad_thread_num = true;
+    }
+    for (int64_t i = begin; i < end; ++i) {
+      if (i < 10) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      visits[i]++;
+    }
+  });
+  ASSERT_FALSE(bad_thread_num);
+  for (auto& v : visits) {
+    ASSERT_EQ(v, 1);
+  }
+
+  // parallel_reduce keeps one partial result per chunk
+  auto sum = at::parallel_reduce(0, n, 1, (int64_t)0,
+    [](int64_t begin, int64_t end, int64_t ident) {
+      int64_t partial = ident;
+      for (int64_t i = begin; i < end; ++i) {
+        partial += i;
+      }
+      return partial;
+    },
+    std::plus<int64_t>());
+  ASSERT_EQ(sum, n * (n - 1) / 2);
+}
+
+TEST(TestParallel, NestedParallelism) {
+  at::set_nested_parallelism(true);
+  const int64_t outer = 2;
+  const int64_t inner = 1000;
+  std::vector<std::atomic<int>> visits(outer * inner);
+  for (auto& v : visits) {
+    v = 0;
+  }
+  std::atomic<bool> bad_thread_num{false};
+  at::parallel_for(0, outer, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      const int outer_thread_num = at::get_thread_num();
+      at::parallel_for(0, inner, 1, [&](int64_t inner_begin, int64_t inner_end) {
+        if (at::get_thread_num() >= at::get_num_threads()) {
+          bad_thread_num = true;
+        }
+        for (int64_t j = inner_begin; j < inner_end; ++j) {
+          visits[i * inner + j]++;
+        }
+      });
+      // the enclosing region's thread number is restored
+      if (at::get_thread_num() != outer_thread_num || !at::in_parallel_region()) {
+        bad_thread_num = true;
+      }
+    }
+  });
+  at::set_nested_parallelism(false);
+  ASSERT_FALSE(bad_thread_num);
+  for (auto& v : visits) {
+    ASSERT_EQ(v, 1);
+  }
+}
+
+TEST(TestParallel, GrainSizeForCost) {
+  const int64_t cheap = at::internal::grain_size_for_cost(1);
+  const int64_t expensive = at::internal::grain_size_for_cost(100);
+  ASSERT_GE(expensive, 1);
+  ASSERT_LE(expensive, cheap);
+  ASSERT_EQ(at::internal::grain_size_for_cost(1e12), 1);
+  // calibration happens once, so the result is stable
+  ASSERT_EQ(at::internal::grain_size_for_cost(1), cheap);
+}
+
+TEST(TestParallel, InterOpPriorityPropagates) {
+  std::promise<int> launched_priority;
+  {
+    at::InterOpPriorityGuard guard(c10::TaskPriority(3));
+    at::launch([&]() {
+      launched_priority.set_value(at::get_interop_priority().priority);
+    });
+  }
+  ASSERT_EQ(launched_priority.get_future().get(), 3);
+  ASSERT_EQ(at::get_interop_priority().priority, 0);
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <ATen/cpu/vec512/functional.h>
+
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+using namespace at::vec512;
+
+template <typename T>
+class Vec512Test : public ::testing::Test {};
+using FloatTypes = ::testing::Types<float, double>;
+TYPED_TEST_CASE(Vec512Test, FloatTypes);
+
+TYPED_TEST(Vec512Test, LoadStorePartial) {
+  using Vec = Vec512<TypeParam>;
+  std::vector<TypeParam> src(Vec::size());
+  std::iota(src.begin(), src.end(), TypeParam(1));
+  for (int64_t count = 0; count <= Vec::size(); count++) {
+    std::vector<TypeParam> dst(Vec::size(), TypeParam(-1));
+    Vec::loadu(src.data(), count).store(dst.data(), count);
+    for (int64_t i = 0; i < Vec::size(); i++) {
+      ASSERT_EQ(dst[i], i < count ? src[i] : TypeParam(-1));
+    }
+    // lanes past `count` are zero-filled on load
+    std::vector<TypeParam> full(Vec::size(), TypeParam(-1));
+    Vec::loadu(src.data(), count).store(full.data());
+    for (int64_t i = count; i < Vec::size(); i++) {
+      ASSERT_EQ(full[i], TypeParam(0));
+    }
+  }
+}
+
+TYPED_TEST(Vec512Test, Arithmetic) {
+  using Vec = Vec512<TypeParam>;
+  std::vector<TypeParam> a(Vec::size()), b(Vec::size()), out(Vec::size());
+  for (int64_t i = 0; i < Vec::size(); i++) {
+    a[i] = TypeParam(i) - 3;
+    b[i] = TypeParam(2 * i + 1);
+  }
+  auto va = Vec::loadu(a.data());
+  auto vb = Vec::loadu(b.data());
+  fmadd(va, vb, va - vb / vb).store(out.data());
+  for (int64_t i = 0; i < Vec::size(); i++) {
+    ASSERT_EQ(out[i], a[i] * b[i] + (a[i] - 1));
+  }
+  maximum(va, vb).store(out.data());
+  for (int64_t i = 0; i < Vec::size(); i++) {
+    ASSERT_EQ(out[i], std::max(a[i], b[i]));
+  }
+  a[1] = NAN;
+  minimum(Vec::loadu(a.data()), vb).store(out.data());
+  ASSERT_TRUE(std::isnan(out[1]));
+  ASSERT_EQ(out[0], std::min(a[0], b[0]));
+}
+
+TYPED_TEST(Vec512Test, Exp) {
+  using Vec = Vec512<TypeParam>;
+  std::vector<TypeParam> a(Vec::size()), out(Vec::size());
+  for (int64_t i = 0; i < Vec::size(); i++) {
+    a[i] = TypeParam(i) / 4 - 2;
+  }
+  Vec::loadu(a.data()).exp().store(out.data());
+  for (int64_t i = 0; i < Vec::size(); i++) {
+    ASSERT_NEAR(out[i], std::exp(a[i]), 1e-5 * std::exp(a[i]));
+  }
+}
+
+TYPED_TEST(Vec512Test, ReduceAllAndMap) {
+  using Vec = Vec512<TypeParam>;
+  for (int64_t size : {1, 7, Vec::size(), Vec::size() + 3, 5 * Vec::size() + 1}) {
+    std::vector<TypeParam> a(size), out(size);
+    for (int64_t i = 0; i < size; i++) {
+      a[i] = TypeParam((i * 7) % 11) - 5;
+    }
+    auto sum = reduce_all<TypeParam>(
+        [](const auto& x, const auto& y) { return x + y; }, a.data(), size);
+    auto max = reduce_all<TypeParam>(
+        [](const auto& x, const auto& y) { return maximum(x, y); }, a.data(), size);
+    ASSERT_EQ(sum, std::accumulate(a.begin(), a.end(), TypeParam(0)));
+    ASSERT_EQ(max, *std::max_element(a.begin(), a.end()));
+
+    map([](Vec x) { return x * x; }, out.data(), a.data(), size);
+    for (int64_t i = 0; i < size; i++) {
+      ASSERT_EQ(out[i], a[i] * a[i]);
+    }
+  }
+}
+
+} // namespace
@@ -3,6 +3,7 @@
 #include <ATen/ATen.h>
 #include <ATen/core/Vitals.h>
 #include <cstdlib>
+#include <limits>
 
 using namespace at::vitals;
 
@@ -89,3 +90,64 @@ TEST(Vitals, OnAndOff) {
     }
   }
 }
+
+TEST(Vitals, Counters) {
+  resetVitalCounters();
+  setVitalCountersEnabled(false);
+  TORCH_VITAL_COUNT("test.counter", 1);
+  ASSERT_EQ(vitalCounter("test.counter").value(), 0);
+
+  setVitalCountersEnabled(true);
+  for (auto i = 0; i < 3; ++i) {
+    TORCH_VITAL_COUNT("test.counter", 2);
+  }
+  setVitalCountersEnabled(false);
+  ASSERT_EQ(vitalCounter("test.counter").value(), 6);
+
+  bool found = false;
+  for (const auto& entry : vitalCounterValues()) {
+    if (entry.first == "test.counter") {
+      found = true;
+      ASSERT_EQ(entry.second, 6);
+    }
+  }
+  ASSERT_TRUE(found);
+
+  resetVitalCounters();
+  ASSERT_EQ(vitalCounter("test.counter").value(), 0);
+}
+
+TEST(Vitals, Histograms) {
+  ASSERT_EQ(VitalHistogram::bucketFor(-1), 0);
+  ASSERT_EQ(VitalHistogram::bucketFor(0), 0);
+  ASSERT_EQ(VitalHistogram::bucketFor(1), 1);
+  ASSERT_EQ(VitalHistogram::bucketFor(4), 3);
+  ASSERT_EQ(VitalHistogram::bucketFor(7), 3);
+  ASSERT_EQ(
+      VitalHistogram::bucketFor(std::numeric_limits<int64_t>::max()),
+      VitalHistogram::kNumBuckets - 1);
+
+  resetVitalCounters();
+  setVitalCountersEnabled(true);
+  TORCH_VITAL_RECORD("test.histogram", 0);
+  TORCH_VITAL_RECORD("test.histogram", 5);
+  TORCH_VITAL_RECORD("test.histogram", 6);
+  setVitalCountersEnabled(false);
+
+  auto snapshot = vitalHistogram("test.histogram").snapshot();
+  ASSERT_EQ(snapshot.count, 3);
+  ASSERT_EQ(snapshot.sum, 11);
+  ASSERT_EQ(snapshot.buckets.size(), VitalHistogram::kNumBuckets);
+  ASSERT_EQ(snapshot.buckets[0], 1);
+  ASSERT_EQ(snapshot.buckets[3], 2);
+}
+
+TEST(Vitals, AllocationCounters) {
+  resetVitalCounters();
+  setVitalCountersEnabled(true);
+  auto t = at::empty({4, 4});
+  setVitalCountersEnabled(false);
+
+  ASSERT_GE(vitalCounter("allocator.cpu.allocations").value(), 1);
+  ASSERT_GE(vitalHistogram("allocator.cpu.bytes").snapshot().sum, 64);
+}
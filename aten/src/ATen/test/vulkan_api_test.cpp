@@ -2,6 +2,7 @@
 
 #include <gtest/gtest.h>
 #include <ATen/ATen.h>
+#include <ATen/native/vulkan/api/api.h>
 
 // TODO: These functions should move to a common place.
 
@@ -1456,6 +1457,32 @@ TEST(VulkanAPITest, upsample_nearest2d) {
   ASSERT_TRUE(check);
 }
 
+TEST(VulkanAPITest, deferred_submission) {
+  if (!at::is_vulkan_available()) {
+    return;
+  }
+
+  auto& command_pool = at::native::vulkan::api::context()->command().pool;
+  command_pool.set_submission_cutoff(0u);
+
+  const auto in_cpu = at::rand({1, 3, 17, 19}, at::device(at::kCPU).dtype(at::kFloat));
+  auto out_cpu = in_cpu;
+  auto out_vulkan = in_cpu.vulkan();
+  // more ops than the default cutoff, all recorded before the copy back
+  for (int i = 0; i < 32; ++i) {
+    out_cpu = at::add(out_cpu, in_cpu, 0.5f);
+    out_vulkan = at::add(out_vulkan, in_cpu.vulkan(), 0.5f);
+  }
+
+  const auto check = almostEqual(out_cpu, out_vulkan.cpu());
+  command_pool.set_submission_cutoff(10u);
+  if (!check) {
+    showRtol(out_cpu, out_vulkan.cpu());
+  }
+
+  ASSERT_TRUE(check);
+}
+
 enum class OpType {
   addmm,
   conv2d,
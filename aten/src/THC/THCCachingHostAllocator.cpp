@@ -1,85 +1,177 @@
 #include <THC/THCCachingHostAllocator.h>
 #include <ATen/DeviceGuard.h>
 #include <ATen/detail/CUDAHooksInterface.h>
+#include <c10/util/llvmMathExtras.h>
 
 
 #include <cuda_runtime_api.h>
+#include <array>
+#include <atomic>
 #include <deque>
+#include <limits>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <stdint.h>
-#include <unordered_map>
 #include <unordered_set>
-#include <set>
 #include <utility>
+#include <vector>
 
 namespace {
 
-struct BlockSize
+using c10::cuda::CUDACachingAllocator::Stat;
+
+// Requests are rounded up to size classes, four per power of two starting at
+// kMinBlockSize, so a block is only reused for requests of its own class.
+// This bounds the rounding waste to 25% instead of letting a small request
+// take a large cached block.
+constexpr int kMinPow2 = 9;
+constexpr int kMaxPow2 = 48;
+constexpr int kStepsPerPow2 = 4;
+constexpr int kNumClasses = (kMaxPow2 - kMinPow2) * kStepsPerPow2 + 1;
+constexpr size_t kMinBlockSize = size_t(1) << kMinPow2;
+
+int sizeClass(size_t size) {
+  if (size <= kMinBlockSize) {
+    return 0;
+  }
+  // 2^p < size <= 2^(p + 1)
+  const int p = llvm::Log2_64(size - 1);
+  const int shift = p - 2;
+  const size_t k = ((size - (size_t(1) << p)) + (size_t(1) << shift) - 1) >> shift;
+  return (p - kMinPow2) * kStepsPerPow2 + static_cast<int>(k);
+}
+
+size_t classSize(int size_class) {
+  if (size_class == 0) {
+    return kMinBlockSize;
+  }
+  const int p = kMinPow2 + (size_class - 1) / kStepsPerPow2;
+  const size_t k = (size_class - 1) % kStepsPerPow2 + 1;
+  return (size_t(1) << p) + (k << (p - 2));
+}
+
+struct Block
 {
-  size_t  size; // allocation size
-  void*   ptr;  // host memory pointer
+  void*   ptr;         // host memory pointer
+  size_t  size;        // allocation size, the size of the class
+  int     size_class;
+  int     event_count; // number of outstanding cuda events, guarded by the
+                       // mutex of the class pool
+  // streams the block was used on since it was allocated, guarded by
+  // HostAllocator::blocks_mutex
+  std::unordered_set<at::cuda::CUDAStream> streams;
 
-  BlockSize(size_t size, void* ptr=NULL) : size(size), ptr(ptr) {}
+  Block(void* ptr, size_t size, int size_class) :
+      ptr(ptr), size(size), size_class(size_class), event_count(0), streams() {}
 };
 
-struct Block : public BlockSize
+struct PendingEvent
 {
-  bool  allocated;    // true if the block is currently allocated
-  int   event_count;  // number of outstanding cuda events
-  std::unordered_set<at::cuda::CUDAStream> streams;
+  cudaEvent_t event;
+  int device;
+  Block* block;
+};
 
-  Block(size_t size, void* ptr, bool allocated) :
-      BlockSize(size, ptr), allocated(allocated), event_count(0), streams() {}
+// Free blocks of one size class
+struct ClassPool
+{
+  std::mutex mutex;
+  // blocks that are ready to be allocated (event_count=0)
+  std::vector<Block*> available;
+  // outstanding cuda events of freed blocks, in the order they were recorded
+  std::deque<PendingEvent> cuda_events;
 };
 
-static bool BlockComparator(const BlockSize& a, const BlockSize& b)
+struct AtomicStat
 {
-  // sort by size, break ties with pointer
-  if (a.size != b.size) {
-    return a.size < b.size;
+  std::atomic<int64_t> current{0};
+  std::atomic<int64_t> peak{0};
+  std::atomic<int64_t> allocated{0};
+  std::atomic<int64_t> freed{0};
+
+  void increase(int64_t amount) {
+    allocated += amount;
+    const int64_t value = current += amount;
+    int64_t prev = peak.load(std::memory_order_relaxed);
+    while (value > prev && !peak.compare_exchange_weak(prev, value)) {
+    }
   }
-  return (uintptr_t)a.ptr < (uintptr_t)b.ptr;
-}
 
+  void decrease(int64_t amount) {
+    freed += amount;
+    current -= amount;
+  }
+
+  Stat get() const {
+    Stat stat;
+    stat.current = current;
+    stat.peak = peak;
+    stat.allocated = allocated;
+    stat.freed = freed;
+    return stat;
+  }
+
+  void resetPeak() {
+    peak = current.load();
+  }
+
+  void resetAccumulated() {
+    allocated = 0;
+    freed = 0;
+  }
+};
+
+// Locking: blocks_mutex only guards the block table and is never held across
+// CUDA calls, and each size class has its own pool mutex. Allocations and frees
+// of different sizes do not contend, and cudaHostAlloc/cudaFreeHost run
+// without any lock held.
 struct HostAllocator
 {
-  typedef bool (*Comparison)(const BlockSize&, const BlockSize&);
+  std::mutex blocks_mutex;
 
-  // lock around all operations
-  std::mutex mutex;
+  // blocks by pointer, ordered to find the block of pointers into it
+  std::map<void*, std::unique_ptr<Block>> blocks;
 
-  // blocks by pointer
-  std::unordered_map<void*, Block> blocks;
+  std::array<ClassPool, kNumClasses> pools;
 
-  // pointers that are ready to be allocated (event_count=0)
-  std::set<BlockSize, Comparison> available;
+  // cuda events for reuse, by device
+  std::mutex events_mutex;
+  std::vector<std::vector<cudaEvent_t>> free_events;
 
-  // outstanding cuda events
-  std::deque<std::pair<cudaEvent_t, void*>> cuda_events;
+  // cap on the bytes of freed blocks kept for reuse
+  std::atomic<size_t> max_cached_bytes{std::numeric_limits<size_t>::max()};
 
-  HostAllocator() : available(BlockComparator) {}
+  AtomicStat allocation;
+  AtomicStat segment;
+  AtomicStat allocated_bytes;
+  AtomicStat reserved_bytes;
+  AtomicStat cached_bytes;
+  std::atomic<int64_t> num_cache_releases{0};
 
   cudaError_t malloc(void** ptr, size_t size)
   {
-    std::lock_guard<std::mutex> lock(mutex);
-
-    // process outstanding cuda events which may have occurred
-    cudaError_t err = processEvents();
-    if (err != cudaSuccess) {
-      return err;
-    }
+    const int size_class = sizeClass(size);
+    const size_t block_size = classSize(size_class);
+    ClassPool& pool = pools[size_class];
+    {
+      std::lock_guard<std::mutex> lock(pool.mutex);
+
+      // process outstanding cuda events which may have occurred
+      cudaError_t err = processEvents(pool);
+      if (err != cudaSuccess) {
+        return err;
+      }
 
-    // search for the smallest block which can hold this allocation
-    BlockSize search_key(size);
-    auto it = available.lower_bound(search_key);
-    if (it != available.end()) {
-      Block& block = blocks.at(it->ptr);
-      THAssert(!block.allocated && block.event_count == 0);
-      block.allocated = true;
-      *ptr = block.ptr;
-      available.erase(it);
-      return cudaSuccess;
+      if (!pool.available.empty()) {
+        Block* block = pool.available.back();
+        pool.available.pop_back();
+        *ptr = block->ptr;
+        cached_bytes.decrease(block_size);
+        allocation.increase(1);
+        allocated_bytes.increase(block_size);
+        return cudaSuccess;
+      }
     }
 
     // Pinned memory pointers allocated by any device can be directly used by any
@@ -97,155 +189,223 @@ struct HostAllocator
     *ptr = 0;
 
     // allocate a new block if no cached allocation is found
-    err = cudaHostAlloc(ptr, size, cudaHostAllocDefault);
+    cudaError_t err = cudaHostAlloc(ptr, block_size, cudaHostAllocDefault);
+    if (err == cudaErrorMemoryAllocation) {
+      // retry once without the cached blocks
+      cudaGetLastError();
+      emptyCache();
+      err = cudaHostAlloc(ptr, block_size, cudaHostAllocDefault);
+    }
     if (err != cudaSuccess) {
       return err;
     }
 
-    blocks.insert({*ptr, Block(size, *ptr, true)});
+    {
+      std::lock_guard<std::mutex> lock(blocks_mutex);
+      blocks.emplace(*ptr, std::make_unique<Block>(*ptr, block_size, size_class));
+    }
+    segment.increase(1);
+    reserved_bytes.increase(block_size);
+    allocation.increase(1);
+    allocated_bytes.increase(block_size);
     return cudaSuccess;
   }
 
   cudaError_t free(void* ptr)
   {
-    std::lock_guard<std::mutex> lock(mutex);
-
     if (!ptr) {
       return cudaSuccess;
     }
 
-    // process outstanding cuda events which may have occurred
-    cudaError_t err = processEvents();
-    if (err != cudaSuccess) {
-      return err;
+    Block* block;
+    std::unordered_set<at::cuda::CUDAStream> streams;
+    {
+      std::lock_guard<std::mutex> lock(blocks_mutex);
+      auto it = blocks.find(ptr);
+      THAssert(it != blocks.end());
+      block = it->second.get();
+      streams = std::move(block->streams);
+      block->streams.clear();
     }
-
-    auto it = blocks.find(ptr);
-    THAssert(it != blocks.end());
-
-    Block& block = it->second;
-    THAssert(block.allocated);
-
-    // free (on valid memory) shouldn't fail, so mark unallocated before
-    // we process the streams.
-    block.allocated = false;
-
-    // insert CUDA events for each stream on which this block was used. This
-    err = insertEvents(block);
-    if (err != cudaSuccess) {
-      return err;
+    allocation.decrease(1);
+    allocated_bytes.decrease(block->size);
+
+    // insert CUDA events for each stream on which this block was used.
+    // Events are recorded before taking the pool lock.
+    std::vector<PendingEvent> events;
+    cudaError_t err = insertEvents(block, streams, events);
+
+    cached_bytes.increase(block->size);
+    ClassPool& pool = pools[block->size_class];
+    {
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      block->event_count += events.size();
+      for (const auto& e : events) {
+        pool.cuda_events.push_back(e);
+      }
+      if (block->event_count == 0) {
+        // the block can be re-used if there are no outstanding cuda events
+        pool.available.push_back(block);
+      }
     }
 
-    if (block.event_count == 0) {
-      // the block can be re-used if there are no outstanding cuda events
-      available.insert(block);
+    if (static_cast<size_t>(cached_bytes.current.load()) > max_cached_bytes.load()) {
+      releaseCached(max_cached_bytes.load());
     }
-    return cudaSuccess;
+    return err;
   }
 
   cudaError_t recordEvent(void* ptr, at::cuda::CUDAStream stream)
   {
-    std::lock_guard<std::mutex> lock(mutex);
+    std::lock_guard<std::mutex> lock(blocks_mutex);
 
-    auto it = blocks.find(ptr);
-    if (it == blocks.end()) {
+    // ptr can point into a block, e.g. for a view with a storage offset
+    auto it = blocks.upper_bound(ptr);
+    if (it == blocks.begin()) {
       // ignore events for untracked pointers
       return cudaSuccess;
     }
-
-    Block& block = it->second;
-    THAssert(block.allocated);
+    --it;
+    Block& block = *it->second;
+    if (static_cast<char*>(ptr) >= static_cast<char*>(block.ptr) + block.size) {
+      return cudaSuccess;
+    }
 
     block.streams.insert(stream);
     return cudaSuccess;
   }
 
-  cudaError_t processEvents()
+  // Called with the mutex of pool held
+  cudaError_t processEvents(ClassPool& pool)
   {
     // Process outstanding cudaEvents. Events that are completed are removed
     // from the queue, and the 'event_count' for the corresponding allocation
     // is decremented. Stops at the first event which has not been completed.
     // Since events on different devices or streams may occur out of order,
     // the processing of some events may be delayed.
-    while (!cuda_events.empty()) {
-      auto& e = cuda_events.front();
-      cudaEvent_t event = e.first;
+    while (!pool.cuda_events.empty()) {
+      auto& e = pool.cuda_events.front();
 
-      cudaError_t err = cudaEventQuery(event);
+      cudaError_t err = cudaEventQuery(e.event);
       if (err == cudaErrorNotReady) {
+        // ignore and clear the error if not ready
+        cudaGetLastError();
         break;
       } else if (err != cudaSuccess) {
         return err;
       }
-      err = cudaEventDestroy(event);
-      if (err != cudaSuccess) {
-        return err;
-      }
+      releaseEvent(e.event, e.device);
 
-      Block& block = blocks.at(e.second);
-      block.event_count--;
-      if (block.event_count == 0 && !block.allocated) {
-        available.insert(block);
+      Block* block = e.block;
+      block->event_count--;
+      if (block->event_count == 0) {
+        pool.available.push_back(block);
       }
-      cuda_events.pop_front();
+      pool.cuda_events.pop_front();
     }
     return cudaSuccess;
   }
 
-  void emptyCache()
+  // Frees cached blocks, largest first, until the cached bytes are at most
+  // limit. Blocks with outstanding events are only freed when limit is 0.
+  void releaseCached(size_t limit)
   {
-    std::lock_guard<std::mutex> lock(mutex);
-
-    // remove events for freed blocks
-    for (auto it = cuda_events.begin(); it != cuda_events.end(); ++it) {
-      cudaEvent_t event = it->first;
-      Block& block = blocks.at(it->second);
-      if (!block.allocated) {
-        THCudaCheckWarn(cudaEventDestroy(event));
-        block.event_count--;
+    std::vector<Block*> released;
+    for (int c = kNumClasses - 1; c >= 0; c--) {
+      if (static_cast<size_t>(cached_bytes.current.load()) <= limit) {
+        break;
+      }
+      ClassPool& pool = pools[c];
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      THCudaCheckWarn(processEvents(pool));
+      if (limit == 0) {
+        // remove events for freed blocks
+        for (const auto& e : pool.cuda_events) {
+          releaseEvent(e.event, e.device);
+          if (--e.block->event_count == 0) {
+            pool.available.push_back(e.block);
+          }
+        }
+        pool.cuda_events.clear();
+      }
+      while (!pool.available.empty() &&
+             static_cast<size_t>(cached_bytes.current.load()) > limit) {
+        Block* block = pool.available.back();
+        pool.available.pop_back();
+        cached_bytes.decrease(block->size);
+        released.push_back(block);
       }
     }
 
-    // all cuda_events have been processed
-    cuda_events.clear();
+    for (Block* block : released) {
+      THCudaCheckWarn(cudaFreeHost(block->ptr));
+      segment.decrease(1);
+      reserved_bytes.decrease(block->size);
+      num_cache_releases++;
+      std::lock_guard<std::mutex> lock(blocks_mutex);
+      blocks.erase(block->ptr);
+    }
+  }
 
-    // clear list of available blocks
-    available.clear();
+  void emptyCache()
+  {
+    releaseCached(0);
+  }
 
-    // free and erase non-allocated blocks
-    for (auto it = blocks.begin(); it != blocks.end();) {
-      Block& block = it->second;
-      if (!block.allocated) {
-        THCudaCheckWarn(cudaFreeHost(block.ptr));
-        it = blocks.erase(it);
-      } else {
-        ++it;
+  cudaEvent_t getEvent(int device, cudaError_t* err)
+  {
+    {
+      std::lock_guard<std::mutex> lock(events_mutex);
+      if (static_cast<size_t>(device) < free_events.size() &&
+          !free_events[device].empty()) {
+        cudaEvent_t event = free_events[device].back();
+        free_events[device].pop_back();
+        return event;
       }
     }
+    cudaEvent_t event;
+    *err = cudaEventCreateWithFlags(&event, cudaEventDisableTiming);
+    return *err == cudaSuccess ? event : nullptr;
   }
 
-  cudaError_t insertEvents(Block& block)
+  void releaseEvent(cudaEvent_t event, int device)
   {
+    std::lock_guard<std::mutex> lock(events_mutex);
+    if (free_events.size() <= static_cast<size_t>(device)) {
+      free_events.resize(device + 1);
+    }
+    free_events[device].push_back(event);
+  }
+
+  cudaError_t insertEvents(
+      Block* block,
+      const std::unordered_set<at::cuda::CUDAStream>& streams,
+      std::vector<PendingEvent>& events)
+  {
+    if (streams.empty()) {
+      return cudaSuccess;
+    }
+
     cudaError_t err;
 
     int prev_device;
     err = cudaGetDevice(&prev_device);
     if (err != cudaSuccess) return err;
 
-    std::unordered_set<at::cuda::CUDAStream> streams(std::move(block.streams));
     for (auto it = streams.begin(); it != streams.end(); ++it) {
       err = cudaSetDevice(it->device_index());
       if (err != cudaSuccess) break;
 
-      cudaEvent_t event;
-      err = cudaEventCreateWithFlags(&event, cudaEventDisableTiming);
+      cudaEvent_t event = getEvent(it->device_index(), &err);
       if (err != cudaSuccess) break;
 
       err = cudaEventRecord(event, it->stream());
-      if (err != cudaSuccess) break;
+      if (err != cudaSuccess) {
+        releaseEvent(event, it->device_index());
+        break;
+      }
 
-      block.event_count++;
-      cuda_events.emplace_back(event, block.ptr);
+      events.push_back({event, it->device_index(), block});
     }
 
     cudaSetDevice(prev_device);
@@ -267,6 +427,43 @@ void THCCachingHostAllocator_emptyCache()
   allocator.emptyCache();
 }
 
+void THCCachingHostAllocator_setMaxCachedBytes(size_t max_cached_bytes)
+{
+  allocator.max_cached_bytes = max_cached_bytes;
+  allocator.releaseCached(max_cached_bytes);
+}
+
+THCCachingHostAllocatorStats THCCachingHostAllocator_getStats()
+{
+  THCCachingHostAllocatorStats stats;
+  stats.allocation = allocator.allocation.get();
+  stats.segment = allocator.segment.get();
+  stats.allocated_bytes = allocator.allocated_bytes.get();
+  stats.reserved_bytes = allocator.reserved_bytes.get();
+  stats.cached_bytes = allocator.cached_bytes.get();
+  stats.num_cache_releases = allocator.num_cache_releases;
+  return stats;
+}
+
+void THCCachingHostAllocator_resetAccumulatedStats()
+{
+  allocator.allocation.resetAccumulated();
+  allocator.segment.resetAccumulated();
+  allocator.allocated_bytes.resetAccumulated();
+  allocator.reserved_bytes.resetAccumulated();
+  allocator.cached_bytes.resetAccumulated();
+  allocator.num_cache_releases = 0;
+}
+
+void THCCachingHostAllocator_resetPeakStats()
+{
+  allocator.allocation.resetPeak();
+  allocator.segment.resetPeak();
+  allocator.allocated_bytes.resetPeak();
+  allocator.reserved_bytes.resetPeak();
+  allocator.cached_bytes.resetPeak();
+}
+
 static void THCCachingHostDeleter(void* ptr) {
   allocator.free(ptr);
 }
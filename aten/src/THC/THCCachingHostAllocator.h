@@ -4,6 +4,7 @@
 #include <THC/THCGeneral.h>
 
 
+#include <c10/cuda/CUDACachingAllocator.h>
 #include <c10/cuda/CUDAStream.h>
 
 //
@@ -19,7 +20,11 @@
 // copy_from_cpu_async_ and copy_to_cpu_async_.
 //
 // Note that this allocator does not split larger allocations into smaller
-// blocks, unlike the caching device allocator.
+// blocks, unlike the caching device allocator. Sizes are rounded up to size
+// classes, four per power of two, and each class has its own pool and lock,
+// so allocations of different sizes do not contend. The bytes cached in the
+// pools can be capped with THCCachingHostAllocator_setMaxCachedBytes, freed
+// blocks beyond the cap are released with cudaFreeHost.
 //
 TORCH_CUDA_CPP_API c10::Allocator* getTHCCachingHostAllocator(void);
 
@@ -31,4 +36,30 @@ THCCachingHostAllocator_recordEvent(void* ptr, at::cuda::CUDAStream stream);
 // Releases cached pinned memory allocations via cudaHostFree
 TORCH_CUDA_CPP_API void THCCachingHostAllocator_emptyCache(void);
 
+// Sets the cap on the bytes of freed allocations kept for reuse, including
+// the ones still waiting for their events. Unlimited by default.
+TORCH_CUDA_CPP_API void THCCachingHostAllocator_setMaxCachedBytes(size_t max_cached_bytes);
+
+// Summary statistics of the caching host allocator, see
+// torch.cuda.host_memory_stats
+struct THCCachingHostAllocatorStats {
+  using Stat = c10::cuda::CUDACachingAllocator::Stat;
+  // COUNT: allocations requested by client code
+  Stat allocation;
+  // COUNT: number of allocated segments from cudaHostAlloc()
+  Stat segment;
+  // SUM: bytes of the blocks handed out to client code
+  Stat allocated_bytes;
+  // SUM: bytes reserved by this memory allocator (both free and used)
+  Stat reserved_bytes;
+  // SUM: bytes of freed blocks kept for reuse
+  Stat cached_bytes;
+  // COUNT: cached blocks released with cudaFreeHost()
+  int64_t num_cache_releases = 0;
+};
+
+TORCH_CUDA_CPP_API THCCachingHostAllocatorStats THCCachingHostAllocator_getStats(void);
+TORCH_CUDA_CPP_API void THCCachingHostAllocator_resetAccumulatedStats(void);
+TORCH_CUDA_CPP_API void THCCachingHostAllocator_resetPeakStats(void);
+
 #endif
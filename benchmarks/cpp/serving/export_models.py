@@ -0,0 +1,53 @@
+"""
+Export the models that serving_bench loads from files: TorchScript files for
+the JIT based runtimes and torch.package files for deploy.
+
+    python benchmarks/cpp/serving/export_models.py --out_dir /tmp/serving
+    serving_bench --model resnet=/tmp/serving/resnet.pt \
+        --package resnet=/tmp/serving/resnet.package \
+        --model bert=/tmp/serving/bert.pt
+
+DeepAndWide and the LSTM are built into serving_bench. BERT needs the
+transformers package and is skipped without it; it is only exported as
+TorchScript since its code can't be packaged for the deploy interpreters.
+"""
+import argparse
+import sys
+from pathlib import Path
+
+import torch
+from torch.package import PackageExporter
+
+sys.path.append(str(Path(__file__).resolve().parents[3] / "torch/csrc/deploy/example"))
+from examples import resnet18  # noqa: E402
+
+
+def export_resnet(out_dir):
+    model = resnet18().eval()
+    example = torch.rand(1, 3, 224, 224)
+    torch.jit.trace(model, example).save(str(out_dir / "resnet.pt"))
+    with PackageExporter(str(out_dir / "resnet.package")) as e:
+        e.save_pickle("model", "model.pkl", model)
+        e.save_pickle("model", "example.pkl", (example,))
+
+
+def export_bert(out_dir):
+    try:
+        from transformers import BertConfig, BertModel
+    except ImportError:
+        print("transformers is not installed, skipping bert")
+        return
+    model = BertModel(BertConfig(torchscript=True)).eval()
+    example = torch.randint(0, 30522, (1, 128))
+    torch.jit.trace(model, example).save(str(out_dir / "bert.pt"))
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Export the serving benchmark models")
+    parser.add_argument("--out_dir", required=True, help="Directory for the exported files")
+    args = parser.parse_args()
+    out_dir = Path(args.out_dir)
+    out_dir.mkdir(parents=True, exist_ok=True)
+    with torch.no_grad():
+        export_resnet(out_dir)
+        export_bert(out_dir)
@@ -0,0 +1,455 @@
+// End-to-end serving benchmark: runs the same models through each of the C++
+// inference paths and reports, for every (model, runtime, number of calling
+// threads), the latency percentiles, the throughput, the peak RSS and the
+// number of CPU allocations per call, as one JSON object per line.
+//
+// Usage:
+//   serving_bench [--threads 1,2,4,8] [--seconds 5] [--batch-size 1]
+//                 [--intra-op-threads 1]
+//                 [--runtimes jit,profiling,fuser,static,lite,deploy]
+//                 [--model name=torchscript_file]...
+//                 [--package name=torch_package]... [--interpreters 8]
+//
+// DeepAndWide and an LSTM are built in. Other models are loaded from
+// TorchScript files (and torch.package files for deploy, which needs a build
+// with USE_DEPLOY=1), see export_models.py; the name of a model selects its
+// inputs, one of deep_wide, lstm, resnet or bert.
+
+#include <ATen/Parallel.h>
+#include <c10/core/Allocator.h>
+#include <c10/util/ThreadLocalDebugInfo.h>
+#include <torch/csrc/jit/codegen/fuser/interface.h>
+#include <torch/csrc/jit/mobile/import.h>
+#include <torch/csrc/jit/mobile/module.h>
+#include <torch/csrc/jit/passes/tensorexpr_fuser.h>
+#include <torch/csrc/jit/runtime/graph_executor.h>
+#include <torch/csrc/jit/runtime/static/impl.h>
+#include <torch/script.h>
+#ifdef SERVING_BENCH_WITH_DEPLOY
+#include <torch/csrc/deploy/deploy.h>
+#endif
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../static_runtime/deep_wide_pt.h"
+
+namespace {
+
+using torch::jit::IValue;
+
+struct Options {
+  std::vector<int> threads{1, 2, 4, 8};
+  double seconds = 5;
+  int64_t batch_size = 1;
+  int intra_op_threads = 1;
+  std::vector<std::string> runtimes{
+      "jit", "profiling", "fuser", "static", "lite", "deploy"};
+  // name -> path, models without a path are built in
+  std::map<std::string, std::string> models{{"deep_wide", ""}, {"lstm", ""}};
+  std::map<std::string, std::string> packages;
+  size_t interpreters = 8;
+};
+
+// A recurrent model with the cell written out, so that the fusers have
+// pointwise chains to work on.
+torch::jit::Module getLSTMScriptModel(
+    int64_t input_size = 64,
+    int64_t hidden_size = 256) {
+  torch::jit::Module module("LSTM");
+  module.register_parameter(
+      "w_ih", torch::randn({4 * hidden_size, input_size}), false);
+  module.register_parameter(
+      "w_hh", torch::randn({4 * hidden_size, hidden_size}), false);
+  module.register_parameter("b", torch::randn({4 * hidden_size}), false);
+  module.define(R"JIT(
+    def forward(self, x):
+        hidden_size = self.w_hh.size(1)
+        h = torch.zeros([x.size(1), hidden_size])
+        c = torch.zeros([x.size(1), hidden_size])
+        for t in range(x.size(0)):
+            gates = torch.mm(x[t], self.w_ih.t()) + torch.mm(h, self.w_hh.t()) + self.b
+            i, f, g, o = gates.chunk(4, 1)
+            c = torch.sigmoid(f) * c + torch.sigmoid(i) * torch.tanh(g)
+            h = torch.sigmoid(o) * torch.tanh(c)
+        return h
+  )JIT");
+  return module;
+}
+
+std::vector<IValue> makeInputs(const std::string& model, int64_t batch_size) {
+  if (model == "deep_wide") {
+    return {
+        torch::randn({batch_size, 1, 32}),
+        torch::randn({batch_size, 1, 32}),
+        torch::randn({batch_size, 50})};
+  } else if (model == "lstm") {
+    return {torch::randn({32, batch_size, 64})};
+  } else if (model == "resnet") {
+    return {torch::randn({batch_size, 3, 224, 224})};
+  } else if (model == "bert") {
+    return {torch::randint(0, 30522, {batch_size, 128}, torch::kLong)};
+  }
+  TORCH_CHECK(
+      false,
+      "unknown model ",
+      model,
+      ", expected one of deep_wide, lstm, resnet or bert");
+}
+
+// A fresh copy of the model for every runtime, so that one runtime's
+// optimized graphs don't leak into another.
+torch::jit::Module loadModel(const std::string& name, const std::string& path) {
+  torch::jit::Module module = path.empty()
+      ? (name == "deep_wide" ? getDeepAndWideSciptModel() : getLSTMScriptModel())
+      : torch::jit::load(path);
+  module.eval();
+  return module;
+}
+
+// Counts the CPU allocations made by the threads it is installed on, through
+// the memory reporting hook of the CPU allocator.
+struct AllocationCounter : public c10::MemoryReportingInfoBase {
+  void reportMemoryUsage(void* /* unused */, int64_t alloc_size, c10::Device)
+      override {
+    if (alloc_size > 0) {
+      allocations++;
+      bytes += alloc_size;
+    }
+  }
+  bool memoryProfilingEnabled() const override {
+    return true;
+  }
+  std::atomic<int64_t> allocations{0};
+  std::atomic<int64_t> bytes{0};
+};
+
+// Resets the peak RSS of the process where the kernel allows it, so that
+// every run reports its own peak rather than the peak of all previous runs.
+void resetPeakRSS() {
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  if (clear_refs) {
+    clear_refs << "5";
+  }
+}
+
+int64_t peakRSSKiB() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmHWM:") == 0) {
+      return std::stoll(line.substr(6));
+    }
+  }
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+std::string jsonString(const std::string& s) {
+  std::string escaped = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped + "\"";
+}
+
+struct Report {
+  std::string model;
+  std::string runtime;
+  int threads = 0;
+  int64_t batch_size = 0;
+  int64_t calls = 0;
+  double calls_per_second = 0;
+  double p50_ms = 0;
+  double p99_ms = 0;
+  int64_t peak_rss_kib = 0;
+  double allocations_per_call = 0;
+  double allocated_bytes_per_call = 0;
+  std::string error;
+
+  void print(std::ostream& out) const {
+    out << "{\"model\": " << jsonString(model)
+        << ", \"runtime\": " << jsonString(runtime)
+        << ", \"threads\": " << threads << ", \"batch_size\": " << batch_size;
+    if (!error.empty()) {
+      out << ", \"error\": " << jsonString(error) << "}" << std::endl;
+      return;
+    }
+    out << ", \"calls\": " << calls
+        << ", \"calls_per_second\": " << calls_per_second
+        << ", \"items_per_second\": " << calls_per_second * batch_size
+        << ", \"p50_ms\": " << p50_ms << ", \"p99_ms\": " << p99_ms
+        << ", \"peak_rss_kib\": " << peak_rss_kib
+        << ", \"allocations_per_call\": " << allocations_per_call
+        << ", \"allocated_bytes_per_call\": " << allocated_bytes_per_call
+        << "}" << std::endl;
+  }
+};
+
+double percentile(std::vector<double>& sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t idx = std::min(sorted.size() - 1, size_t(sorted.size() * p / 100.0));
+  return sorted[idx];
+}
+
+// Calls `run` from `n_threads` threads at once for `seconds`, after one
+// warmup call per thread. `run` is expected not to throw after its first call.
+void measure(
+    const std::function<void()>& run,
+    int n_threads,
+    double seconds,
+    Report& report) {
+  std::mutex mutex;
+  std::condition_variable cv;
+  int warmed_up = 0;
+  std::atomic<bool> should_run{true};
+  std::vector<std::vector<double>> latencies(n_threads);
+
+  // first call on this thread, so that errors surface here rather than in
+  // the worker threads
+  {
+    torch::NoGradGuard no_grad;
+    run();
+  }
+  resetPeakRSS();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < n_threads; ++i) {
+    threads.emplace_back([&, i] {
+      torch::NoGradGuard no_grad;
+      run();
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        ++warmed_up;
+        cv.notify_all();
+      }
+      while (should_run) {
+        auto begin = std::chrono::steady_clock::now();
+        run();
+        auto end = std::chrono::steady_clock::now();
+        latencies[i].push_back(
+            std::chrono::duration<double, std::milli>(end - begin).count());
+      }
+    });
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return warmed_up == n_threads; });
+  }
+  auto begin = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+  should_run = false;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  double total_seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - begin)
+                             .count();
+
+  std::vector<double> all;
+  for (const auto& l : latencies) {
+    all.insert(all.end(), l.begin(), l.end());
+  }
+  std::sort(all.begin(), all.end());
+  report.calls = all.size();
+  report.calls_per_second = all.size() / total_seconds;
+  report.p50_ms = percentile(all, 50);
+  report.p99_ms = percentile(all, 99);
+  report.peak_rss_kib = peakRSSKiB();
+
+  // Counting allocations slows the allocator down, so it gets its own calls
+  // rather than being done while timing.
+  constexpr int kCountedCalls = 10;
+  auto counter = std::make_shared<AllocationCounter>();
+  {
+    c10::DebugInfoGuard guard(c10::DebugInfoKind::PROFILER_STATE, counter);
+    torch::NoGradGuard no_grad;
+    for (int i = 0; i < kCountedCalls; ++i) {
+      run();
+    }
+  }
+  report.allocations_per_call = double(counter->allocations) / kCountedCalls;
+  report.allocated_bytes_per_call = double(counter->bytes) / kCountedCalls;
+}
+
+// Returns a thread-safe function that runs the model once on `runtime`.
+std::function<void()> prepare(
+    const std::string& runtime,
+    const std::string& model,
+    const Options& options,
+    const std::vector<IValue>& inputs,
+    void* deploy_manager) {
+  const std::string& path = options.models.at(model);
+  auto& executor_mode = torch::jit::getExecutorMode();
+  auto& profiling_mode = torch::jit::getProfilingMode();
+  if (runtime == "jit" || runtime == "profiling" || runtime == "fuser") {
+    // the executor is picked when a graph first runs, which is during the
+    // warmup calls that follow
+    executor_mode = runtime != "jit";
+    profiling_mode = runtime != "jit";
+    torch::jit::setTensorExprFuserEnabled(runtime == "fuser");
+    torch::jit::overrideCanFuseOnCPU(runtime == "fuser");
+    auto module = std::make_shared<torch::jit::Module>(loadModel(model, path));
+    return [module, inputs] { module->forward(inputs); };
+  } else if (runtime == "static") {
+    auto smodule = std::make_shared<torch::jit::StaticModule>(
+        loadModel(model, path));
+    return [smodule, inputs] { (*smodule)(inputs, {}); };
+  } else if (runtime == "lite") {
+    std::stringstream buffer;
+    loadModel(model, path)._save_for_mobile(buffer);
+    auto module = std::make_shared<torch::jit::mobile::Module>(
+        torch::jit::_load_for_mobile(buffer));
+    return [module, inputs] { module->forward(inputs); };
+  } else if (runtime == "deploy") {
+#ifdef SERVING_BENCH_WITH_DEPLOY
+    auto package_it = options.packages.find(model);
+    TORCH_CHECK(
+        package_it != options.packages.end(),
+        "no torch.package given for ",
+        model,
+        ", use --package ",
+        model,
+        "=path");
+    auto manager =
+        static_cast<torch::deploy::InterpreterManager*>(deploy_manager);
+    auto package = manager->load_package(package_it->second);
+    std::shared_ptr<torch::deploy::ReplicatedObj> obj;
+    {
+      auto I = package.acquire_session();
+      obj = std::make_shared<torch::deploy::ReplicatedObj>(I.create_movable(
+          I.self.attr("load_pickle")({"model", "model.pkl"})));
+    }
+    return [obj, inputs] { (*obj)(inputs); };
+#else
+    TORCH_CHECK(false, "built without torch::deploy, rebuild with USE_DEPLOY=1");
+#endif
+  }
+  TORCH_CHECK(false, "unknown runtime ", runtime);
+}
+
+template <typename T>
+std::vector<T> splitList(
+    const std::string& list,
+    const std::function<T(const std::string&)>& parse) {
+  std::vector<T> result;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    result.push_back(parse(item));
+  }
+  return result;
+}
+
+Options parseOptions(int argc, char* argv[]) {
+  Options options;
+  bool models_given = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    TORCH_CHECK(i + 1 < argc, "missing value for ", arg);
+    std::string value = argv[++i];
+    if (arg == "--threads") {
+      options.threads = splitList<int>(
+          value, [](const std::string& s) { return std::stoi(s); });
+    } else if (arg == "--seconds") {
+      options.seconds = std::stod(value);
+    } else if (arg == "--batch-size") {
+      options.batch_size = std::stoll(value);
+    } else if (arg == "--intra-op-threads") {
+      options.intra_op_threads = std::stoi(value);
+    } else if (arg == "--runtimes") {
+      options.runtimes = splitList<std::string>(
+          value, [](const std::string& s) { return s; });
+    } else if (arg == "--model" || arg == "--package") {
+      auto eq = value.find('=');
+      TORCH_CHECK(eq != std::string::npos, arg, " expects name=path");
+      auto name = value.substr(0, eq);
+      auto path = value.substr(eq + 1);
+      if (arg == "--model") {
+        if (!models_given) {
+          // the built-in models run only when no model is given
+          options.models.clear();
+          models_given = true;
+        }
+        options.models[name] = path;
+      } else {
+        options.packages[name] = path;
+      }
+    } else if (arg == "--interpreters") {
+      options.interpreters = std::stoul(value);
+    } else {
+      TORCH_CHECK(false, "unknown option ", arg);
+    }
+  }
+  return options;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  Options options = parseOptions(argc, argv);
+  at::set_num_threads(options.intra_op_threads);
+
+  void* deploy_manager = nullptr;
+#ifdef SERVING_BENCH_WITH_DEPLOY
+  std::unique_ptr<torch::deploy::InterpreterManager> manager;
+  if (std::find(
+          options.runtimes.begin(), options.runtimes.end(), "deploy") !=
+      options.runtimes.end()) {
+    manager = std::make_unique<torch::deploy::InterpreterManager>(
+        options.interpreters);
+    deploy_manager = manager.get();
+  }
+#endif
+
+  for (const auto& model : options.models) {
+    auto inputs = makeInputs(model.first, options.batch_size);
+    for (const auto& runtime : options.runtimes) {
+      std::function<void()> run;
+      std::string error;
+      try {
+        run = prepare(runtime, model.first, options, inputs, deploy_manager);
+      } catch (const std::exception& e) {
+        error = e.what();
+      }
+      for (int n_threads : options.threads) {
+        Report report;
+        report.model = model.first;
+        report.runtime = runtime;
+        report.threads = n_threads;
+        report.batch_size = options.batch_size;
+        report.error = error;
+        if (error.empty()) {
+          try {
+            measure(run, n_threads, options.seconds, report);
+          } catch (const std::exception& e) {
+            report.error = e.what();
+          }
+        }
+        report.print(std::cout);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,105 @@
+import argparse
+import os
+import threading
+import time
+
+import torch
+import torch.distributed.autograd as dist_autograd
+import torch.distributed.rpc as rpc
+import torch.multiprocessing as mp
+import torch.nn as nn
+
+
+TRAINER_NAME = "trainer"
+WORKER_NAME = "worker{}"
+
+_stage = None
+
+
+def _init_stage(in_features, out_features, depth):
+    global _stage
+    layers = []
+    for _ in range(depth):
+        layers += [nn.Linear(in_features, out_features), nn.ReLU()]
+        in_features = out_features
+    _stage = nn.Sequential(*layers)
+
+
+def _forward(x):
+    return _stage(x)
+
+
+def _run_backward(workers, batch_size, features):
+    r"""
+    Runs one distributed backward pass, with a forward that calls all the
+    workers concurrently and sums their outputs, so that the send/recv
+    subgraphs of the workers are independent of each other.
+    """
+    x = torch.randn(batch_size, features, requires_grad=True)
+    with dist_autograd.context() as context_id:
+        futs = [rpc.rpc_async(worker, _forward, args=(x,)) for worker in workers]
+        loss = torch.stack([fut.wait() for fut in futs]).sum()
+        dist_autograd.backward(context_id, [loss])
+
+
+def _measure(workers, args, num_threads):
+    def run():
+        for _ in range(args.iterations):
+            _run_backward(workers, args.batch_size, args.features)
+
+    threads = [threading.Thread(target=run) for _ in range(num_threads)]
+    start = time.time()
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    return (time.time() - start) / (args.iterations * num_threads)
+
+
+def run_trainer(args):
+    workers = [WORKER_NAME.format(rank) for rank in range(1, args.world_size)]
+    for worker in workers:
+        rpc.rpc_sync(
+            worker, _init_stage, args=(args.features, args.features, args.depth))
+
+    # Warm up the agent and the autograd engine.
+    _measure(workers, args, 1)
+
+    print("{:>10} {:>14} {:>10}".format("contexts", "sec/backward", "overlap"))
+    sequential = _measure(workers, args, 1)
+    print("{:>10} {:>14.6f} {:>10.2f}".format(1, sequential, 1.0))
+    for num_threads in args.concurrent_contexts:
+        per_backward = _measure(workers, args, num_threads)
+        print("{:>10} {:>14.6f} {:>10.2f}".format(
+            num_threads, per_backward, sequential / per_backward))
+
+
+def run_worker(rank, args):
+    os.environ["MASTER_ADDR"] = args.master_addr
+    os.environ["MASTER_PORT"] = args.master_port
+    name = TRAINER_NAME if rank == 0 else WORKER_NAME.format(rank)
+    rpc.init_rpc(name, rank=rank, world_size=args.world_size)
+    if rank == 0:
+        run_trainer(args)
+    rpc.shutdown()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Distributed autograd backward pass overlap benchmark")
+    parser.add_argument("--world_size", type=int, default=4)
+    parser.add_argument("--master_addr", type=str, default="127.0.0.1")
+    parser.add_argument("--master_port", type=str, default="29501")
+    parser.add_argument("--batch_size", type=int, default=32)
+    parser.add_argument("--features", type=int, default=1024)
+    parser.add_argument("--depth", type=int, default=4)
+    parser.add_argument("--iterations", type=int, default=20)
+    parser.add_argument(
+        "--concurrent_contexts", type=int, nargs="+", default=[2, 4, 8])
+    args = parser.parse_args()
+
+    mp.spawn(run_worker, args=(args,), nprocs=args.world_size, join=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -7,6 +7,12 @@ def add_tensors_loop(x, y):
         z = torch.add(z, x)
     return z
 
+def add_tensors_loop_inplace(x, y):
+    z = torch.add(x, y)
+    for i in range(NUM_LOOP_ITERS):
+        z.add_(x)
+    return z
+
 class SimpleAddModule(torch.nn.Module):
     def __init__(self, add_op):
         super(SimpleAddModule, self).__init__()
@@ -2,12 +2,12 @@ from utils import ms_to_us, benchmark_module, BenchmarkConfig, ModuleConfig
 import argparse
 from C2Module import C2SimpleNet
 
-from SimpleAddModule import SimpleAddModule, add_tensors_loop
+from SimpleAddModule import SimpleAddModule, add_tensors_loop, add_tensors_loop_inplace
 from pt_wrapper_module import WrapperModule
 
 """ Framework overhead benchmark script.
 Benchmark framework overhead.
-Currently supported ops: add.
+Currently supported ops: add, add_ (PT only).
 As of now runs only forward pass.
 Supports both graph mode and eager mode. In graph mode the module is traced via JIT tracing.
 Debug option prints the traced graph is graph_mode is enabled.
@@ -18,12 +18,14 @@ buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_ben
  --add_op --graph_mode --eager_mode (Runs both graph mode and eager mode)
 buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_benchmark --
  --add_op --graph_mode (Runs only graph mode)
+buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_benchmark --
+ --op add_inplace_op --eager_mode --inference_mode (Runs eager mode under torch.inference_mode)
 To run C2 benchmark:
 buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_benchmark --
  --add_op --benchmark_c2_net
 """
 
-SUPPORTED_OPS = {"add_op"}
+SUPPORTED_OPS = {"add_op", "add_inplace_op"}
 
 def parse_op_args(op):
     op_list = ops.split(",")
@@ -56,8 +58,9 @@ def benchmark_simple_fn(args, config, module_config, module_type, result):
     else:
         f_name = module_config.pt_fn.__name__ + ":Num Operands=" + str(module_config.num_params)
         graph_mode_str = "Graph mode" + ":" + str(module_config.graph_mode)
-        result_key = ','.join((f_name, graph_mode_str))
-        module = WrapperModule(module_type, module_config, args.debug, args.save)
+        inference_mode_str = "Inference mode" + ":" + str(args.inference_mode)
+        result_key = ','.join((f_name, graph_mode_str, inference_mode_str))
+        module = WrapperModule(module_type, module_config, args.debug, args.save, args.inference_mode)
         latency_per_iter_ms = benchmark_module(config, module, args.use_throughput_benchmark)
         result[result_key] = latency_per_iter_ms
 
@@ -69,6 +72,7 @@ def main():
     parser.add_argument("--debug", default=False, dest="debug", action="store_true")
     parser.add_argument("--save", default=False, dest="save", action="store_true")
     parser.add_argument("--eager_mode", default=False, dest="eager_mode", action="store_true")
+    parser.add_argument("--inference_mode", default=False, dest="inference_mode", action="store_true")
     parser.add_argument("--num_warmup_iters", type=int, default=100)
     parser.add_argument("--num_iters", type=int, default=1000)
     args = parser.parse_args()
@@ -78,6 +82,8 @@ def main():
         return
     assert not (args.benchmark_c2_net and args.use_throughput_benchmark), \
         "Benchmarking of C2 net via throughput benchmarking is not yet supported"
+    assert not (args.benchmark_c2_net and (args.inference_mode or args.op != "add_op")), \
+        "Only the add op without inference mode is supported for C2 nets"
 
     num_warmup_iters = args.num_warmup_iters
     num_iters = args.num_iters
@@ -93,6 +99,9 @@ def main():
         else:
             module_config = ModuleConfig(add_tensors_loop, None, num_params, graph_mode)
         benchmark_simple_fn(args, config, module_config, SimpleAddModule, result)
+    elif args.op == "add_inplace_op":
+        module_config = ModuleConfig(add_tensors_loop_inplace, None, 2, graph_mode)
+        benchmark_simple_fn(args, config, module_config, SimpleAddModule, result)
     print_results(result)
 
 if __name__ == "__main__":
@@ -18,26 +18,34 @@ class WrapperModule(object):
             - Whether debug mode is enabled.
         save:
             - In graph mode, whether graph is to be saved.
+        inference_mode:
+            - Whether to run under torch.inference_mode instead of torch.no_grad.
+              The inputs are then inference tensors, so the ops skip the autograd
+              kernels and version counter bumps.
     """
-    def __init__(self, wrapped_type, module_config, debug, save=False):
+    def __init__(self, wrapped_type, module_config, debug, save=False, inference_mode=False):
         pt_fn = module_config.pt_fn
         self.module = wrapped_type(pt_fn)
         self.tensor_inputs = []
         self.module_name = wrapped_type.__name__
-        for _ in range(module_config.num_params):
-            self.tensor_inputs.append(torch.randn(1))
+        self.inference_mode = inference_mode
+        with torch.inference_mode(inference_mode):
+            for _ in range(module_config.num_params):
+                self.tensor_inputs.append(torch.randn(1))
         if module_config.graph_mode:
             self.module = torch.jit.trace(self.module, self.tensor_inputs)
             if save:
                 file_name = self.module_name + "_" + pt_fn.__name__ + ".pt"
                 torch.jit.save(self.module, file_name)
                 print("Generated graph is saved in {}".format(file_name))
-        print("Benchmarking module {} with fn {}: Graph mode:{}".format(self.module_name, pt_fn.__name__, module_config.graph_mode))
+        print("Benchmarking module {} with fn {}: Graph mode:{}, Inference mode:{}".format(
+            self.module_name, pt_fn.__name__, module_config.graph_mode, inference_mode))
         if (debug and isinstance(self.module, torch.jit.ScriptModule)):
             print(self.module.graph)
             print(self.module.code)
 
     def forward(self, niters):
-        with torch.no_grad():
+        mode = torch.inference_mode() if self.inference_mode else torch.no_grad()
+        with mode:
             for _ in range(niters):
                 self.module.forward(*self.tensor_inputs)
@@ -9,6 +9,7 @@ from typing import NamedTuple, Callable, List, Any
 import ppl_models
 import vision_models
 import audio_text_models
+import rl_models
 
 from utils import to_markdown_table, TimingResultType, InputsType, GetterType, VType
 
@@ -53,6 +54,7 @@ MODELS = [
     ModelDef("deepspeech", audio_text_models.get_deepspeech, FAST_TASKS_NO_DOUBLE_BACK, DOUBLE_BACKWARD_TASKS),
     ModelDef("transformer", audio_text_models.get_transformer, FAST_TASKS, []),
     ModelDef("multiheadattn", audio_text_models.get_multiheadattn, FAST_TASKS, []),
+    ModelDef("mlp_policy", rl_models.get_mlp_policy, ALL_TASKS, []),
 ]
 
 def get_v_for(model: Callable, inp: InputsType, task: str) -> VType:
@@ -0,0 +1,44 @@
+import torch
+from torch import nn, Tensor
+
+from utils import extract_weights, load_weights, GetterReturnType
+
+def get_mlp_policy(device: torch.device) -> GetterReturnType:
+    # Actor-critic policy of a small RL agent: every node of the graph does
+    # very little work, so the cost of the autograd engine itself dominates.
+    N = 8
+    obs_size = 32
+    hidden = 64
+    num_actions = 6
+    depth = 4
+
+    def mlp(out_size: int) -> nn.Module:
+        layers = []
+        in_size = obs_size
+        for _ in range(depth):
+            layers += [nn.Linear(in_size, hidden), nn.Tanh()]
+            in_size = hidden
+        layers.append(nn.Linear(in_size, out_size))
+        return nn.Sequential(*layers)
+
+    model = nn.ModuleDict({"actor": mlp(num_actions), "critic": mlp(1)})
+    model.to(device)
+    params, names = extract_weights(model)
+
+    obs = torch.rand(N, obs_size, device=device)
+    actions = torch.rand(N, device=device).mul(num_actions).long()
+    advantages = torch.rand(N, device=device)
+    returns = torch.rand(N, device=device)
+
+    def forward(*new_params: Tensor) -> Tensor:
+        load_weights(model, names, new_params)
+        log_probs = model["actor"](obs).log_softmax(-1)
+        values = model["critic"](obs).squeeze(-1)
+
+        action_log_probs = log_probs.gather(1, actions.unsqueeze(1)).squeeze(1)
+        entropy = -(log_probs.exp() * log_probs).sum(-1)
+        loss = (-(action_log_probs * advantages) - 0.01 * entropy
+                + 0.5 * (values - returns).pow(2))
+        return loss.mean()
+
+    return forward, params
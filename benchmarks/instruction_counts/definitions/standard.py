@@ -113,6 +113,26 @@ BENCHMARKS: FlatIntermediateDefinition = flatten({
         """)),
     },
 
+    "Dispatch": GroupedVariants(*parse_stmts(r"""
+        Python                                   | C++
+        ---------------------------------------- | ----------------------------------------
+        # @setup                                 | // @setup
+        x = torch.ones((4, 4))                   | auto x = torch::ones({4, 4});
+        y = torch.ones((4, 4))                   | auto y = torch::ones({4, 4});
+        g = torch.default_generator              | auto g = at::detail::getDefaultCPUGenerator();
+                                                 |
+        # @Tensor arguments                      | // @Tensor arguments
+        torch.add(x, y)                          | torch::add(x, y);
+                                                 |
+        # @TensorList arguments                  | // @TensorList arguments
+        torch.cat([x, y])                        | torch::cat({x, y});
+        torch.stack([x, y])                      | torch::stack({x, y});
+                                                 |
+        # @Generator arguments                   | // @Generator arguments
+        x.uniform_(0, 1, generator=g)            | x.uniform_(0, 1, g);
+        x.bernoulli_(0.5, generator=g)           | x.bernoulli_(0.5, g);
+    """)),
+
     "Reduction": GroupedVariants(*parse_stmts(r"""
         Python                                   | C++
         ---------------------------------------- | ----------------------------------------
@@ -223,6 +243,30 @@ BENCHMARKS: FlatIntermediateDefinition = flatten({
         )
     },
 
+    "TorchScript interpreter": {
+        # Scalar code, whose cost is dominated by the dispatch of the
+        # instructions, see Note [Interpreter superinstructions]
+        "scalar loop": GroupedStmts(
+            *parse_stmts(r"""
+                Python                                   | C++
+                ---------------------------------------- | ----------------------------------------
+                n = x.size(0) * 16                       | auto n = x.size(0) * 16;
+                acc = 0                                  | int64_t acc = 0;
+                for i in range(n):                       | for (int64_t i = 0; i < n; ++i) {
+                    if i % 3 == 0:                       |   if (i % 3 == 0) {
+                        acc = acc + i * 2                |     acc = acc + i * 2;
+                    else:                                |   } else {
+                        acc = acc - 1                    |     acc = acc - 1;
+                                                         |   }
+                                                         | }
+                y = x + acc                              | auto y = x + acc;
+            """),
+            Setup.TRIVIAL_2D.value,
+            signature=r"f(x) -> y",
+            torchscript=True,
+        ),
+    },
+
     "training": {
         "simple": GroupedStmts(
             *parse_stmts(r"""
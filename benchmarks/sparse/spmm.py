@@ -3,12 +3,13 @@ import sys
 import torch
 from utils import gen_sparse_csr, gen_sparse_coo, Event
 
-def test_sparse_csr(m, n, k, nnz, test_count):
+def test_sparse_csr(m, n, k, nnz, test_count, dtype=torch.double):
     start_timer = Event(enable_timing=True)
     stop_timer = Event(enable_timing=True)
 
     csr = gen_sparse_csr((m, k), nnz)
-    mat = torch.randn(k, n, dtype=torch.double)
+    csr = torch.sparse_csr_tensor(csr.crow_indices(), csr.col_indices(), csr.values().to(dtype), csr.shape)
+    mat = torch.randn(k, n, dtype=torch.double).to(dtype)
 
     times = []
     for _ in range(test_count):
@@ -73,6 +74,8 @@ if __name__ == "__main__":
     parser.add_argument("--nnz_ratio", default='0.1', type=float)
     parser.add_argument("--outfile", default='stdout', type=str)
     parser.add_argument("--test_count", default='10', type=int)
+    parser.add_argument("--dtype", default='double', type=str, choices=['double', 'float', 'bfloat16'],
+                        help="dtype of the csr format")
 
     args = parser.parse_args()
 
@@ -91,7 +94,7 @@ if __name__ == "__main__":
 
     nnz = int(nnz_ratio * m * k)
     if args.format == 'csr':
-        time = test_sparse_csr(m, n, k, nnz, test_count)
+        time = test_sparse_csr(m, n, k, nnz, test_count, getattr(torch, args.dtype))
     elif args.format == 'coo':
         time = test_sparse_coo(m, n, k, nnz, test_count)
     elif args.format == 'both':
@@ -101,5 +104,6 @@ if __name__ == "__main__":
         print("format=coo", " nnz_ratio=", nnz_ratio, " m=", m, " n=", n, " k=", k, " time=", time_coo, file=outfile)
         print("format=csr", " nnz_ratio=", nnz_ratio, " m=", m, " n=", n, " k=", k, " time=", time_csr, file=outfile)
     else:
-        print("format=", args.format, " nnz_ratio=", nnz_ratio, " m=", m, " n=", n, " k=", k, " time=", time,
+        print("format=", args.format, " dtype=", args.dtype, " nnz_ratio=", nnz_ratio, " m=", m, " n=", n, " k=", k,
+              " time=", time,
               file=outfile)
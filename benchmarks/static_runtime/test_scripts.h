@@ -224,3 +224,57 @@ const std::string embedding_bag_max_last_offset = R"JIT(
   def forward(self, a: Tensor, b: Tensor, c: Tensor):
       return torch.embedding_bag(a, b, c, False, 2, False, None, True)
 )JIT";
+
+const auto independent_branches_script = R"JIT(
+  def forward(self, a, b):
+    c = torch.relu(a + b)
+    d = torch.sigmoid(a * b)
+    e = torch.tanh(a - b)
+    f = c * d + e
+    r = f.reshape([-1])
+    return (r, c + e)
+)JIT";
+
+// ops without a hand-written out variant in Static Runtime
+const auto pointwise_chain_script = R"JIT(
+  def forward(self, a, b):
+    c = torch.sigmoid(a * b + 1.0)
+    d = torch.relu(c - a)
+    e = torch.mm(d, b.t())
+    return torch.tanh(e) * 2.0
+)JIT";
+
+const auto generic_out_variant_script = R"JIT(
+  def forward(self, a, b):
+    c = torch.atan2(a, b)
+    d = torch.lt(c, b)
+    e = torch.remainder(c, 2.0)
+    return (d, e.clone())
+)JIT";
+
+const auto control_flow_script = R"JIT(
+  def forward(self, a, b, n: int):
+    c = a * b
+    if n > 2:
+      d = torch.relu(c + a)
+    else:
+      d = a
+    for i in range(n):
+      d = torch.sigmoid(d * b) + c
+      if i == 1:
+        d = d - 1.0
+    k = 0
+    while k < n:
+      d = d + 1.0
+      k += 2
+    return d.clone()
+)JIT";
+
+const auto view_chain_script = R"JIT(
+  def forward(self, a, b):
+    c = a + b
+    d = c.reshape([-1])
+    e = d.flatten()
+    f = e * 2.0
+    return f.clone()
+)JIT";
@@ -1,11 +1,17 @@
 #include <gtest/gtest.h>
+#include <torch/csrc/jit/runtime/static/constant_store.h>
 #include <torch/csrc/jit/runtime/static/fusion.h>
 #include <torch/csrc/jit/runtime/static/impl.h>
+#include <torch/csrc/jit/runtime/static/ops.h>
 #include <torch/csrc/jit/runtime/static/passes.h>
 #include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/utils/static_module_batcher.h>
 #include "deep_wide_pt.h"
 #include "test_scripts.h"
 
+#include <atomic>
+#include <thread>
+
 using namespace caffe2;
 using namespace torch;
 using namespace torch::jit;
@@ -413,6 +419,511 @@ TEST(StaticRuntime, CleanUpMemory) {
   }
 }
 
+TEST(StaticRuntime, ArenaOffsets) {
+  // each buffer is alive together with its neighbours, so the first and the
+  // third can share memory, as can the second and the fourth
+  const std::vector<size_t> sizes{64, 128, 64, 128};
+  const std::vector<torch::jit::ValueLifetime> lifetimes{
+      {0, 1}, {1, 2}, {2, 3}, {3, 4}};
+  std::vector<size_t> offsets;
+  const size_t arena_size =
+      torch::jit::AssignArenaOffsets(sizes, lifetimes, offsets);
+  EXPECT_EQ(arena_size, 192);
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    EXPECT_LE(offsets[i] + sizes[i], arena_size);
+    for (size_t j = 0; j < i; ++j) {
+      const bool alive_together = lifetimes[i].first <= lifetimes[j].second &&
+          lifetimes[j].first <= lifetimes[i].second;
+      if (alive_together) {
+        EXPECT_TRUE(
+            offsets[i] + sizes[i] <= offsets[j] ||
+            offsets[j] + sizes[j] <= offsets[i]);
+      }
+    }
+  }
+}
+
+TEST(StaticRuntime, ManagedOutputs) {
+  const int embedding_size = 32;
+  const int num_features = 50;
+  torch::jit::Module mod = getDeepAndWideSciptModel();
+
+  torch::jit::StaticModuleOptions opts;
+  opts.optimize_output_memory = true;
+  torch::jit::StaticModule smod(mod, opts);
+
+  // outputs of earlier runs are kept, so their memory must not be reused
+  std::vector<std::pair<at::Tensor, at::Tensor>> results;
+  for (int batch_size : {1, 8, 32, 8}) {
+    for (int i = 0; i < 2; ++i) {
+      auto ad_emb_packed = torch::randn({batch_size, 1, embedding_size});
+      auto user_emb = torch::randn({batch_size, 1, embedding_size});
+      auto wide = torch::randn({batch_size, num_features});
+
+      std::vector<at::IValue> inputs({ad_emb_packed, user_emb, wide});
+      auto output_1 = getTensor(mod.forward(inputs));
+
+      std::vector<at::Tensor> input_tensors({ad_emb_packed, user_emb, wide});
+      at::Tensor output_2 = smod(input_tensors)[0];
+      smod.runtime().check_for_memory_leak();
+      EXPECT_TRUE(torch::allclose(output_1, output_2, 1e-6));
+      results.emplace_back(output_1, output_2);
+    }
+  }
+  for (const auto& result : results) {
+    EXPECT_TRUE(torch::allclose(result.first, result.second, 1e-6));
+  }
+
+  const auto* planner = smod.runtime().memory_planner();
+  ASSERT_NE(planner, nullptr);
+  EXPECT_LE(planner->arena_size(), planner->total_managed());
+}
+
+TEST(StaticRuntime, BucketedMemoryPlans) {
+  const int embedding_size = 32;
+  const int num_features = 50;
+  torch::jit::Module mod = getDeepAndWideSciptModel();
+
+  torch::jit::StaticModuleOptions opts;
+  opts.optimize_output_memory = true;
+  opts.bucket_memory_plans = true;
+  torch::jit::StaticModule smod(mod, opts);
+
+  // batch size -> arena size once the bucket has been planned
+  std::unordered_map<int, size_t> arena_sizes;
+  for (int batch_size : {1, 8, 32, 8, 1, 32, 7}) {
+    for (int i = 0; i < 2; ++i) {
+      auto ad_emb_packed = torch::randn({batch_size, 1, embedding_size});
+      auto user_emb = torch::randn({batch_size, 1, embedding_size});
+      auto wide = torch::randn({batch_size, num_features});
+
+      std::vector<at::IValue> inputs({ad_emb_packed, user_emb, wide});
+      auto output_1 = getTensor(mod.forward(inputs));
+
+      std::vector<at::Tensor> input_tensors({ad_emb_packed, user_emb, wide});
+      at::Tensor output_2 = smod(input_tensors)[0];
+      smod.runtime().check_for_memory_leak();
+      EXPECT_TRUE(torch::allclose(output_1, output_2, 1e-6));
+    }
+
+    const auto* planner = smod.runtime().memory_planner();
+    ASSERT_NE(planner, nullptr);
+    // 7 falls into the bucket of 8, whose plan fits it already
+    const int bucket_batch_size = batch_size == 7 ? 8 : batch_size;
+    auto it = arena_sizes.find(bucket_batch_size);
+    if (it == arena_sizes.end()) {
+      arena_sizes.emplace(bucket_batch_size, planner->arena_size());
+    } else {
+      // coming back to a bucket reuses its plan
+      EXPECT_EQ(planner->arena_size(), it->second);
+    }
+  }
+  EXPECT_LT(arena_sizes.at(1), arena_sizes.at(32));
+}
+
+TEST(StaticRuntime, InterOpParallelism) {
+  script::Module module("module");
+  module.define(independent_branches_script);
+
+  torch::jit::StaticModuleOptions opts;
+  opts.enable_inter_op_parallelism = true;
+  torch::jit::StaticModule smodule(module, opts);
+
+  // the three branches on a and b run in the same stage
+  const auto& stages = smodule.parallel_stages();
+  size_t num_nodes = 0;
+  size_t widest = 0;
+  for (const auto& stage : stages) {
+    num_nodes += stage.size();
+    widest = std::max(widest, stage.size());
+  }
+  EXPECT_EQ(num_nodes, smodule.nodes().size());
+  EXPECT_GE(widest, 3);
+
+  for (int size : {4, 16, 4}) {
+    auto a = at::randn({size, 8});
+    auto b = at::randn({size, 8});
+    std::vector<IValue> args{a, b};
+    auto expect = module.forward(args);
+    auto actual = smodule(args, {});
+    smodule.runtime().check_for_memory_leak();
+    compareTensorLists(
+        expect.toTuple()->elements(), actual.toTuple()->elements());
+  }
+}
+
+TEST(StaticRuntime, InterOpParallelismDeepWide) {
+  const int embedding_size = 32;
+  const int num_features = 50;
+  torch::jit::Module mod = getDeepAndWideSciptModel();
+
+  torch::jit::StaticModuleOptions opts;
+  opts.enable_inter_op_parallelism = true;
+  torch::jit::StaticModule smod(mod, opts);
+
+  for (int batch_size : {1, 8, 32}) {
+    for (int i = 0; i < 2; ++i) {
+      auto ad_emb_packed = torch::randn({batch_size, 1, embedding_size});
+      auto user_emb = torch::randn({batch_size, 1, embedding_size});
+      auto wide = torch::randn({batch_size, num_features});
+
+      std::vector<at::IValue> inputs({ad_emb_packed, user_emb, wide});
+      auto output_1 = getTensor(mod.forward(inputs));
+
+      std::vector<at::Tensor> input_tensors({ad_emb_packed, user_emb, wide});
+      at::Tensor output_2 = smod(input_tensors)[0];
+      smod.runtime().check_for_memory_leak();
+      EXPECT_TRUE(torch::allclose(output_1, output_2, 1e-6));
+    }
+  }
+}
+
+TEST(StaticRuntime, GenericOutVariants) {
+  script::Module module("module");
+  module.define(generic_out_variant_script);
+  torch::jit::StaticModule smodule(module);
+
+  for (const auto& pnode : smodule.nodes()) {
+    const auto kind = pnode.node()->kind();
+    if (kind == aten::atan2 || kind == aten::lt || kind == aten::remainder) {
+      EXPECT_TRUE(pnode.has_out_variant());
+    }
+  }
+
+  // the bool output of lt keeps its dtype and the sizes change between runs
+  for (int size : {4, 16, 4}) {
+    auto a = at::randn({size, 8});
+    auto b = at::randn({size, 8});
+    std::vector<IValue> args{a, b};
+    auto expect = module.forward(args);
+    auto actual = smodule(args, {});
+    smodule.runtime().check_for_memory_leak();
+    compareTensorLists(
+        expect.toTuple()->elements(), actual.toTuple()->elements());
+  }
+
+  auto graph = module.get_method("forward").graph();
+  for (const Node* n : torch::jit::nodesWithoutOutVariant(graph)) {
+    EXPECT_NE(n->kind(), aten::atan2);
+    EXPECT_NE(n->kind(), aten::lt);
+  }
+}
+
+TEST(StaticRuntime, BindInputsOutputs) {
+  script::Module module("module");
+  module.define(generic_out_variant_script);
+  torch::jit::StaticModule smodule(module);
+  torch::jit::StaticRuntime runtime(smodule);
+
+  auto a = at::randn({4, 8});
+  auto b = at::randn({4, 8});
+  auto d = at::empty({0}, at::kBool);
+  auto e = at::empty({0});
+  runtime.bind_inputs({a, b});
+  runtime.bind_outputs({d, e});
+  const void* e_data = nullptr;
+  for (int i = 0; i < 3; ++i) {
+    // the caller refills the bound inputs
+    a.copy_(at::randn({4, 8}));
+    b.copy_(at::randn({4, 8}));
+    runtime.run();
+    runtime.check_for_memory_leak();
+
+    std::vector<IValue> args{a, b};
+    auto expect = module.forward(args).toTuple()->elements();
+    EXPECT_TRUE(expect[0].toTensor().equal(d));
+    EXPECT_TRUE(expect[1].toTensor().equal(e));
+    // written in place after the first resize
+    if (i > 0) {
+      EXPECT_EQ(e.data_ptr(), e_data);
+    }
+    e_data = e.data_ptr();
+  }
+
+  // outputs that are inputs are copied
+  script::Module tuple_module("module");
+  tuple_module.define(tuple_construct_script);
+  torch::jit::StaticModule tuple_smodule(tuple_module);
+  torch::jit::StaticRuntime tuple_runtime(tuple_smodule);
+  auto out_a = at::empty({0});
+  auto out_b = at::empty({0});
+  tuple_runtime.bind_inputs({a, b});
+  tuple_runtime.bind_outputs({out_a, out_b});
+  tuple_runtime.run();
+  EXPECT_TRUE(out_a.equal(a));
+  EXPECT_TRUE(out_b.equal(b));
+
+  EXPECT_THROW(runtime.bind_inputs({a}), c10::Error);
+}
+
+TEST(StaticRuntime, TensorExprFusion) {
+  script::Module module("module");
+  module.define(pointwise_chain_script);
+  torch::jit::StaticModuleOptions opts;
+  opts.enable_tensorexpr_fusion = true;
+  torch::jit::StaticModule smodule(module, opts);
+
+  // the chains before and after mm
+  int num_groups = 0;
+  for (const auto& pnode : smodule.nodes()) {
+    if (pnode.node()->kind() == prim::StaticTensorExprGroup) {
+      EXPECT_TRUE(pnode.has_out_variant());
+      num_groups++;
+    }
+  }
+  EXPECT_EQ(num_groups, 2);
+
+  // new shapes, a repeated shape, and a non-contiguous input
+  std::vector<std::vector<at::Tensor>> inputs{
+      {at::randn({4, 8}), at::randn({4, 8})},
+      {at::randn({16, 8}), at::randn({16, 8})},
+      {at::randn({4, 8}), at::randn({4, 8})},
+      {at::randn({8, 4}).t(), at::randn({4, 8})},
+  };
+  for (const auto& input : inputs) {
+    std::vector<IValue> args{input[0], input[1]};
+    auto expect = module.forward(args).toTensor();
+    auto actual = smodule(args, {}).toTensor();
+    smodule.runtime().check_for_memory_leak();
+    EXPECT_TRUE(torch::allclose(expect, actual, 1e-5, 1e-6));
+  }
+}
+
+TEST(StaticRuntime, ControlFlow) {
+  script::Module module("module");
+  module.define(control_flow_script);
+  torch::jit::StaticModule smodule(module);
+
+  int num_control_flow_nodes = 0;
+  for (const auto& pnode : smodule.nodes()) {
+    const auto kind = pnode.node()->kind();
+    if (kind == prim::If || kind == prim::Loop) {
+      EXPECT_TRUE(pnode.blocks());
+      num_control_flow_nodes++;
+    }
+  }
+  EXPECT_EQ(num_control_flow_nodes, 3);
+
+  // both branches, no trip, and several trips, twice to reuse the plans
+  for (int repeat = 0; repeat < 2; ++repeat) {
+    for (int64_t n : {0, 1, 3, 5}) {
+      std::vector<IValue> args{at::randn({4, 8}), at::randn({4, 8}), n};
+      auto expect = module.forward(args).toTensor();
+      auto actual = smodule(args, {}).toTensor();
+      smodule.runtime().check_for_memory_leak();
+      EXPECT_TRUE(torch::allclose(expect, actual, 1e-5, 1e-6));
+    }
+  }
+}
+
+TEST(StaticRuntime, Profile) {
+  script::Module module("module");
+  module.define(generic_out_variant_script);
+  torch::jit::StaticModule smodule(module);
+
+  std::vector<IValue> args{at::randn({16, 8}), at::randn({16, 8})};
+  const int main_runs = 20;
+  auto profile = smodule.runtime().profile(args, {}, 2, main_runs);
+
+  ASSERT_EQ(profile.nodes.size(), smodule.nodes().size());
+  size_t allocated_bytes = 0;
+  int instances = 0;
+  for (const auto& node : profile.nodes) {
+    EXPECT_LE(node.p50_time, node.p90_time);
+    EXPECT_LE(node.p90_time, node.p99_time);
+    EXPECT_LE(node.p99_time, node.max_time);
+    if (node.kind == "aten::lt" || node.kind == "aten::atan2") {
+      EXPECT_EQ(node.run_mode, "out_variant");
+    }
+    if (node.kind == "aten::atan2") {
+      // the memory planner provides the intermediate
+      EXPECT_EQ(node.allocated_bytes, 0);
+    }
+    allocated_bytes += node.allocated_bytes;
+  }
+  for (const auto& p : profile.node_kinds) {
+    instances += p.second.instances;
+  }
+  EXPECT_EQ(instances, profile.nodes.size());
+  EXPECT_EQ(allocated_bytes, profile.allocated_bytes);
+  // the output of clone is allocated in every run
+  EXPECT_GE(profile.node_kinds["aten::clone"].allocated_bytes, 16 * 8 * 4);
+}
+
+TEST(StaticRuntime, ConcurrentCalls) {
+  script::Module module("module");
+  module.define(pointwise_chain_script);
+  torch::jit::StaticModuleOptions opts;
+  opts.max_idle_runtimes = 2;
+  torch::jit::StaticModule smodule(module, opts);
+
+  const int num_threads = 4;
+  const int num_runs = 20;
+  std::vector<std::vector<IValue>> args;
+  std::vector<at::Tensor> expect;
+  for (int t = 0; t < num_threads; ++t) {
+    args.push_back({at::randn({4 + t, 8}), at::randn({4 + t, 8})});
+    expect.push_back(module.forward(args.back()).toTensor());
+  }
+  std::atomic<int> num_mismatches{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < num_runs; ++i) {
+        auto actual = smodule(args[t], {}).toTensor();
+        if (!torch::allclose(expect[t], actual, 1e-5, 1e-6)) {
+          num_mismatches++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_mismatches, 0);
+  const auto& pool = smodule.runtime_pool();
+  EXPECT_LE(pool.num_idle(), 2);
+  EXPECT_LT(pool.num_created(), num_threads * num_runs);
+
+  // without concurrent calls, the primary runtime serves them all
+  const auto num_created = pool.num_created();
+  for (int i = 0; i < 3; ++i) {
+    smodule(args[0], {});
+    smodule.runtime().check_for_memory_leak();
+  }
+  EXPECT_EQ(pool.num_created(), num_created);
+}
+
+TEST(StaticRuntime, DeduplicateConstants) {
+  const auto weight = at::randn({8, 4});
+  auto make_module = [](const at::Tensor& w) {
+    script::Module module("module");
+    module.register_parameter("weight", w, false);
+    module.define(R"JIT(
+      def forward(self, x):
+          return torch.mm(x, self.weight).clone()
+    )JIT");
+    return module;
+  };
+  auto weight_of = [](const torch::jit::StaticModule& smodule) {
+    at::Tensor w;
+    for (const auto& constant : smodule.constants()) {
+      if (constant.isTensor()) {
+        w = constant.toTensor();
+      }
+    }
+    return w;
+  };
+
+  torch::jit::StaticModuleOptions opts;
+  opts.deduplicate_constants = true;
+  auto module_a = make_module(weight.clone());
+  auto module_b = make_module(weight.clone());
+  auto module_c = make_module(at::randn({8, 4}));
+  torch::jit::StaticModule smodule_a(module_a, opts);
+  torch::jit::StaticModule smodule_b(module_b, opts);
+  torch::jit::StaticModule smodule_c(module_c, opts);
+
+  const auto w_a = weight_of(smodule_a);
+  ASSERT_TRUE(w_a.defined());
+  EXPECT_TRUE(w_a.is_same(weight_of(smodule_b)));
+  EXPECT_FALSE(w_a.is_same(weight_of(smodule_c)));
+  EXPECT_GE(
+      torch::jit::StaticConstantStore::global().deduplicated_bytes(),
+      weight.nbytes());
+
+  std::vector<IValue> args{at::randn({2, 8})};
+  auto expect = module_b.forward(args).toTensor();
+  auto actual = smodule_b(args, {}).toTensor();
+  EXPECT_TRUE(torch::allclose(expect, actual));
+}
+
+TEST(StaticRuntime, KeepViews) {
+  script::Module module("module");
+  module.define(view_chain_script);
+  auto count_nodes = [](const std::shared_ptr<Graph>& graph, const char* kind) {
+    int count = 0;
+    for (auto* node : graph->nodes()) {
+      count += node->kind() == c10::Symbol::fromQualString(kind);
+    }
+    return count;
+  };
+
+  auto graph = module.get_method("forward").graph()->copy();
+  torch::jit::ReplaceWithCopy(graph, /*keep_views=*/true);
+  EXPECT_EQ(count_nodes(graph, "static_runtime::reshape_copy"), 0);
+  EXPECT_EQ(count_nodes(graph, "aten::reshape"), 1);
+  torch::jit::ReplaceWithCopy(graph);
+  EXPECT_EQ(count_nodes(graph, "static_runtime::reshape_copy"), 1);
+
+  // the views extend the lifetime of the value they are views of
+  torch::jit::StaticModule smodule(module);
+  const Value* base = nullptr;
+  size_t mul_idx = 0;
+  for (size_t i = 0; i < smodule.nodes().size(); ++i) {
+    const Node* node = smodule.nodes()[i].node();
+    if (node->kind() == aten::add) {
+      base = node->output();
+    } else if (node->kind() == aten::mul) {
+      mul_idx = i;
+    }
+  }
+  ASSERT_TRUE(base);
+  ASSERT_TRUE(smodule.value_lifetimes().count(base));
+  EXPECT_GE(smodule.value_lifetimes().at(base).second, mul_idx);
+
+  std::vector<IValue> args{at::randn({4, 8}), at::randn({4, 8})};
+  for (int i = 0; i < 2; ++i) {
+    auto expect = module.forward(args).toTensor();
+    auto actual = smodule(args, {}).toTensor();
+    smodule.runtime().check_for_memory_leak();
+    EXPECT_TRUE(torch::allclose(expect, actual));
+  }
+}
+
+TEST(StaticRuntime, Batcher) {
+  script::Module module("module");
+  module.define(generic_out_variant_script);
+  auto smodule = std::make_shared<torch::jit::StaticModule>(module);
+
+  torch::jit::StaticModuleBatcherOptions opts;
+  opts.max_batch_size = 16;
+  opts.max_delay = std::chrono::milliseconds(50);
+  torch::jit::StaticModuleBatcher batcher(smodule, opts);
+
+  const std::vector<int64_t> batch_sizes{1, 3, 4, 2, 5, 1};
+  std::vector<std::vector<at::Tensor>> inputs;
+  std::vector<c10::intrusive_ptr<c10::ivalue::Future>> futures;
+  for (auto batch_size : batch_sizes) {
+    inputs.push_back(
+        {at::randn({batch_size, 8}), at::randn({batch_size, 8})});
+    futures.push_back(batcher.run(inputs.back()));
+  }
+  // a request whose other dimensions differ fails the batch, and is run alone
+  futures.push_back(batcher.run({at::randn({2, 3}), at::randn({2, 3})}));
+  // so does one the module can't run
+  futures.push_back(batcher.run({at::randn({2, 8}), at::randn({2, 4})}));
+
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    futures[i]->wait();
+    ASSERT_FALSE(futures[i]->hasError());
+    auto actual = futures[i]->value().toTensorVector();
+    std::vector<IValue> args{inputs[i][0], inputs[i][1]};
+    auto expect = module.forward(args).toTuple()->elements();
+    ASSERT_EQ(actual.size(), expect.size());
+    for (size_t j = 0; j < actual.size(); ++j) {
+      EXPECT_TRUE(expect[j].toTensor().equal(actual[j]));
+    }
+  }
+  futures[inputs.size()]->wait();
+  EXPECT_FALSE(futures[inputs.size()]->hasError());
+  futures[inputs.size() + 1]->wait();
+  EXPECT_TRUE(futures[inputs.size() + 1]->hasError());
+
+  EXPECT_EQ(batcher.num_requests(), batch_sizes.size() + 2);
+  EXPECT_LT(batcher.num_runs(), batcher.num_requests());
+}
+
 TEST(StaticRuntime, FusionPass) {
   const int embedding_size = 32;
   const int num_features = 50;
@@ -1,5 +1,7 @@
 #include <c10/core/CPUAllocator.h>
+#include <c10/core/CPUPoolingAllocator.h>
 #include <c10/core/DeviceType.h>
+#include <c10/core/InferenceArena.h>
 #include <c10/mobile/CPUCachingAllocator.h>
 #include <c10/mobile/CPUProfilingAllocator.h>
 
@@ -101,6 +103,16 @@ struct C10_API DefaultCPUAllocator final : at::Allocator {
   DefaultCPUAllocator() {}
   ~DefaultCPUAllocator() override {}
   at::DataPtr allocate(size_t nbytes) const override {
+    // See Note [Inference arena]
+    InferenceArena* arena = InferenceArena::current();
+    if (C10_UNLIKELY(arena != nullptr)) {
+      return arena->allocate(nbytes);
+    }
+    // See Note [CPU pooling allocator]
+    if (CPUPoolingAllocator::isEnabled() &&
+        nbytes >= CPUPoolingAllocator::kMinPooledSize) {
+      return CPUPoolingAllocator::allocate(nbytes);
+    }
     void* data = alloc_cpu(nbytes);
     profiledCPUMemoryReporter().New(data, nbytes);
     return {data, data, &ReportAndDelete, at::Device(at::DeviceType::CPU)};
@@ -114,8 +126,19 @@ struct C10_API DefaultCPUAllocator final : at::Allocator {
     free_cpu(ptr);
   }
 
+  // raw_allocate can return blocks of the pool and of arenas as well
+  static void RawDelete(void* ptr) {
+    if (InferenceArena::owns(ptr)) {
+      InferenceArena::deleter()(ptr);
+    } else if (CPUPoolingAllocator::owns(ptr)) {
+      CPUPoolingAllocator::deleter()(ptr);
+    } else {
+      ReportAndDelete(ptr);
+    }
+  }
+
   at::DeleterFnPtr raw_deleter() const override {
-    return &ReportAndDelete;
+    return &RawDelete;
   }
 };
 
@@ -0,0 +1,445 @@
+#include <c10/core/CPUPoolingAllocator.h>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/util/Exception.h>
+#include <c10/util/Logging.h>
+#include <c10/util/llvmMathExtras.h>
+#include <c10/util/numa.h>
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace c10 {
+namespace CPUPoolingAllocator {
+
+namespace {
+
+// Size class c > 0 holds the sizes up to 2^p + k * 2^(p - 2), where
+// c = (p - kMinPow2) * kStepsPerPow2 + k and k is in [1, kStepsPerPow2].
+// Class 0 holds kMinPooledSize.
+constexpr int kMinPow2 = 16;
+constexpr int kMaxPow2 = 40;
+constexpr int kStepsPerPow2 = 4;
+constexpr int kNumClasses = (kMaxPow2 - kMinPow2) * kStepsPerPow2 + 1;
+// Blocks above the largest class are allocated exactly and never cached
+constexpr int kUnpooled = -1;
+
+static_assert(
+    kMinPooledSize == (size_t(1) << kMinPow2),
+    "kMinPooledSize must be the smallest size class");
+
+// Limits of the free lists of a thread, blocks beyond these go to the shared
+// pool
+constexpr size_t kThreadCacheBlocksPerClass = 4;
+constexpr size_t kThreadCacheMaxBytes = 64 * 1024 * 1024;
+
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+// Stored in front of the data of every block, keeping the data gAlignment
+// aligned
+struct BlockHeader {
+  size_t block_bytes;
+  int size_class;
+};
+constexpr size_t kHeaderSize = gAlignment;
+static_assert(sizeof(BlockHeader) <= kHeaderSize, "header too large");
+
+int sizeClass(size_t nbytes) {
+  if (nbytes <= kMinPooledSize) {
+    return 0;
+  }
+  if (nbytes > (size_t(1) << kMaxPow2)) {
+    return kUnpooled;
+  }
+  // 2^p < nbytes <= 2^(p + 1)
+  const int p = llvm::Log2_64(nbytes - 1);
+  const int shift = p - 2;
+  const size_t k = ((nbytes - (size_t(1) << p)) + (size_t(1) << shift) - 1) >>
+      shift;
+  return (p - kMinPow2) * kStepsPerPow2 + static_cast<int>(k);
+}
+
+size_t classSize(int size_class) {
+  if (size_class == 0) {
+    return kMinPooledSize;
+  }
+  const int p = kMinPow2 + (size_class - 1) / kStepsPerPow2;
+  const size_t k = (size_class - 1) % kStepsPerPow2 + 1;
+  return (size_t(1) << p) + (k << (p - 2));
+}
+
+BlockHeader* header(void* data) {
+  return reinterpret_cast<BlockHeader*>(
+      static_cast<char*>(data) - kHeaderSize);
+}
+
+std::atomic<bool> enabled{false};
+std::atomic<size_t> max_cached_bytes{size_t(1) << 30};
+std::atomic<bool> huge_pages{false};
+
+std::atomic<int64_t> allocated_bytes{0};
+std::atomic<int64_t> peak_allocated_bytes{0};
+std::atomic<int64_t> reserved_bytes{0};
+std::atomic<int64_t> peak_reserved_bytes{0};
+std::atomic<int64_t> cached_bytes{0};
+std::atomic<int64_t> num_cache_hits{0};
+std::atomic<int64_t> num_system_allocs{0};
+std::atomic<int64_t> num_system_frees{0};
+
+void updatePeak(std::atomic<int64_t>& peak, int64_t value) {
+  int64_t current = peak.load(std::memory_order_relaxed);
+  while (value > current &&
+         !peak.compare_exchange_weak(
+             current, value, std::memory_order_relaxed)) {
+  }
+}
+
+using FreeLists = std::array<std::vector<void*>, kNumClasses>;
+
+struct SharedPool {
+  std::mutex mutex;
+  FreeLists blocks;
+};
+
+// Leaked so that it outlives the thread caches flushed at exit
+SharedPool& sharedPool() {
+  static SharedPool* pool = new SharedPool();
+  return *pool;
+}
+
+// Data pointers of the blocks allocated from the system, for owns(). Only
+// touched when blocks are allocated from or returned to the system.
+struct Registry {
+  std::mutex mutex;
+  std::unordered_set<void*> blocks;
+};
+
+Registry& registry() {
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+struct ThreadCache {
+  FreeLists blocks;
+  size_t bytes = 0;
+
+  ~ThreadCache();
+};
+
+// Set once the thread cache is destroyed, for frees by later thread_local
+// destructors
+thread_local bool thread_cache_destroyed = false;
+
+ThreadCache* threadCache() {
+  if (thread_cache_destroyed) {
+    return nullptr;
+  }
+  static thread_local ThreadCache cache;
+  return &cache;
+}
+
+ThreadCache::~ThreadCache() {
+  thread_cache_destroyed = true;
+  auto& pool = sharedPool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  for (int c = 0; c < kNumClasses; c++) {
+    auto& shared = pool.blocks[c];
+    shared.insert(shared.end(), blocks[c].begin(), blocks[c].end());
+  }
+}
+
+void fill(void* data, size_t nbytes) {
+  if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
+    memset(data, 0, nbytes);
+  } else if (FLAGS_caffe2_cpu_allocator_do_junk_fill) {
+    memset_junk(data, nbytes);
+  }
+}
+
+void* systemAllocOnce(size_t total_bytes, bool huge) {
+  void* base = nullptr;
+#ifdef _MSC_VER
+  base = _aligned_malloc(total_bytes, gAlignment);
+#else
+  const size_t alignment = huge ? kHugePageSize : gAlignment;
+  if (posix_memalign(&base, alignment, total_bytes) != 0) {
+    base = nullptr;
+  }
+#endif
+  return base;
+}
+
+// Returns the data pointer of a new block of block_bytes bytes
+void* systemAlloc(size_t block_bytes, int size_class) {
+  const size_t total_bytes = block_bytes + kHeaderSize;
+  const bool huge = huge_pages.load(std::memory_order_relaxed) &&
+      total_bytes >= kHugePageSize;
+  void* base = systemAllocOnce(total_bytes, huge);
+  if (!base) {
+    // retry once without the cached blocks
+    emptyCache();
+    base = systemAllocOnce(total_bytes, huge);
+  }
+  TORCH_CHECK(
+      base,
+      "CPUPoolingAllocator: not enough memory: you tried to allocate ",
+      block_bytes,
+      " bytes.");
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (huge) {
+    // only a hint, failures are ignored
+    madvise(base, total_bytes, MADV_HUGEPAGE);
+  }
+#endif
+  NUMAMove(base, total_bytes, GetCurrentNUMANode());
+
+  void* data = static_cast<char*>(base) + kHeaderSize;
+  header(data)->block_bytes = block_bytes;
+  header(data)->size_class = size_class;
+  {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.blocks.insert(data);
+  }
+  updatePeak(peak_reserved_bytes, reserved_bytes += block_bytes);
+  num_system_allocs++;
+  return data;
+}
+
+void systemFree(void* data) {
+  const size_t block_bytes = header(data)->block_bytes;
+  {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.blocks.erase(data);
+  }
+  free_cpu(header(data));
+  reserved_bytes -= block_bytes;
+  num_system_frees++;
+}
+
+void* takeCached(int size_class, size_t block_bytes) {
+  void* data = nullptr;
+  ThreadCache* cache = threadCache();
+  if (cache && !cache->blocks[size_class].empty()) {
+    data = cache->blocks[size_class].back();
+    cache->blocks[size_class].pop_back();
+    cache->bytes -= block_bytes;
+  } else {
+    auto& pool = sharedPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    auto& shared = pool.blocks[size_class];
+    if (shared.empty()) {
+      return nullptr;
+    }
+    data = shared.back();
+    shared.pop_back();
+  }
+  cached_bytes -= block_bytes;
+  return data;
+}
+
+// Accounts block_bytes as cached if that stays under the cap
+bool reserveCached(size_t block_bytes) {
+  const int64_t limit =
+      static_cast<int64_t>(max_cached_bytes.load(std::memory_order_relaxed));
+  int64_t current = cached_bytes.load(std::memory_order_relaxed);
+  do {
+    if (current + static_cast<int64_t>(block_bytes) > limit) {
+      return false;
+    }
+  } while (!cached_bytes.compare_exchange_weak(
+      current, current + block_bytes, std::memory_order_relaxed));
+  return true;
+}
+
+void deleteBlock(void* data) {
+  if (!data) {
+    return;
+  }
+  profiledCPUMemoryReporter().Delete(data);
+  const BlockHeader* h = header(data);
+  const size_t block_bytes = h->block_bytes;
+  const int size_class = h->size_class;
+  allocated_bytes -= block_bytes;
+  if (size_class == kUnpooled || !enabled.load(std::memory_order_relaxed) ||
+      !reserveCached(block_bytes)) {
+    systemFree(data);
+    return;
+  }
+  ThreadCache* cache = threadCache();
+  if (cache &&
+      cache->blocks[size_class].size() < kThreadCacheBlocksPerClass &&
+      cache->bytes + block_bytes <= kThreadCacheMaxBytes) {
+    cache->blocks[size_class].push_back(data);
+    cache->bytes += block_bytes;
+    return;
+  }
+  auto& pool = sharedPool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  pool.blocks[size_class].push_back(data);
+}
+
+void releaseAll(FreeLists& blocks) {
+  for (int c = 0; c < kNumClasses; c++) {
+    for (void* data : blocks[c]) {
+      cached_bytes -= classSize(c);
+      systemFree(data);
+    }
+    blocks[c].clear();
+  }
+}
+
+// Releases cached blocks of the shared pool, largest first, until the cached
+// bytes are at most limit
+void trimSharedPool(size_t limit) {
+  auto& pool = sharedPool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  for (int c = kNumClasses - 1; c >= 0; c--) {
+    auto& shared = pool.blocks[c];
+    while (!shared.empty() &&
+           cached_bytes.load(std::memory_order_relaxed) >
+               static_cast<int64_t>(limit)) {
+      cached_bytes -= classSize(c);
+      systemFree(shared.back());
+      shared.pop_back();
+    }
+  }
+}
+
+bool parseBool(const std::string& value) {
+  return value == "1" || value == "true" || value == "True";
+}
+
+// Reads PYTORCH_CPU_ALLOC_CONF, see Note [CPU pooling allocator]
+struct ConfigFromEnv {
+  ConfigFromEnv() {
+    const char* env = std::getenv("PYTORCH_CPU_ALLOC_CONF");
+    if (env == nullptr) {
+      return;
+    }
+    std::stringstream options(env);
+    std::string option;
+    while (std::getline(options, option, ',')) {
+      const size_t colon = option.find(':');
+      const std::string key = option.substr(0, colon);
+      const std::string value =
+          colon == std::string::npos ? "" : option.substr(colon + 1);
+      try {
+        if (key == "pooling") {
+          enabled = parseBool(value);
+        } else if (key == "max_cached_mb") {
+          max_cached_bytes = static_cast<size_t>(std::stoull(value)) << 20;
+        } else if (key == "huge_pages") {
+          huge_pages = parseBool(value);
+        } else {
+          LOG(WARNING) << "Unrecognized PYTORCH_CPU_ALLOC_CONF option: "
+                       << option;
+        }
+      } catch (const std::exception&) {
+        LOG(WARNING) << "Invalid PYTORCH_CPU_ALLOC_CONF option: " << option;
+      }
+    }
+  }
+};
+
+ConfigFromEnv config_from_env;
+
+} // namespace
+
+void setEnabled(bool enable) {
+  enabled = enable;
+  if (!enable) {
+    emptyCache();
+  }
+}
+
+bool isEnabled() {
+  return enabled.load(std::memory_order_relaxed);
+}
+
+void setMaxCachedBytes(size_t limit) {
+  max_cached_bytes = limit;
+  trimSharedPool(limit);
+}
+
+size_t getMaxCachedBytes() {
+  return max_cached_bytes.load(std::memory_order_relaxed);
+}
+
+void setHugePages(bool enable) {
+  huge_pages = enable;
+}
+
+void emptyCache() {
+  ThreadCache* cache = threadCache();
+  if (cache) {
+    releaseAll(cache->blocks);
+    cache->bytes = 0;
+  }
+  trimSharedPool(0);
+}
+
+Stats getStats() {
+  Stats stats;
+  stats.allocated_bytes = allocated_bytes;
+  stats.peak_allocated_bytes = peak_allocated_bytes;
+  stats.reserved_bytes = reserved_bytes;
+  stats.peak_reserved_bytes = peak_reserved_bytes;
+  stats.cached_bytes = cached_bytes;
+  stats.num_cache_hits = num_cache_hits;
+  stats.num_system_allocs = num_system_allocs;
+  stats.num_system_frees = num_system_frees;
+  return stats;
+}
+
+void resetPeakStats() {
+  peak_allocated_bytes = allocated_bytes.load();
+  peak_reserved_bytes = reserved_bytes.load();
+}
+
+DataPtr allocate(size_t nbytes) {
+  TORCH_INTERNAL_ASSERT_DEBUG_ONLY(nbytes >= kMinPooledSize);
+  const int size_class = sizeClass(nbytes);
+  const size_t block_bytes =
+      size_class == kUnpooled ? nbytes : classSize(size_class);
+  void* data = nullptr;
+  if (size_class != kUnpooled) {
+    data = takeCached(size_class, block_bytes);
+  }
+  if (data) {
+    num_cache_hits++;
+  } else {
+    data = systemAlloc(block_bytes, size_class);
+  }
+  updatePeak(peak_allocated_bytes, allocated_bytes += block_bytes);
+  fill(data, nbytes);
+  profiledCPUMemoryReporter().New(data, nbytes);
+  return {data, data, &deleteBlock, Device(DeviceType::CPU)};
+}
+
+bool owns(void* data) {
+  if (reserved_bytes.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+  auto& reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  return reg.blocks.count(data) != 0;
+}
+
+DeleterFnPtr deleter() {
+  return &deleteBlock;
+}
+
+} // namespace CPUPoolingAllocator
+} // namespace c10
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <c10/core/Allocator.h>
+#include <c10/macros/Macros.h>
+
+namespace c10 {
+
+// Note [CPU pooling allocator]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// The default CPU allocator calls posix_memalign and free for every tensor.
+// For allocations of hundreds of KB and more, glibc serves these with mmap and
+// munmap, so every inference step pays for fresh page faults and for the TLB
+// shootdowns of unmapping. When pooling is enabled, the default CPU allocator
+// instead keeps freed blocks of at least kMinPooledSize bytes and hands them
+// out again to allocations of the same size class.
+//
+// - Sizes are rounded up to size classes spaced four per power of two, which
+//   bounds the rounding waste to 25%.
+// - Freed blocks go to a free list of the freeing thread first, which needs
+//   no locking, and overflow to a shared pool. Blocks cached by a thread are
+//   moved to the shared pool when the thread exits.
+// - The bytes cached in free lists are capped (setMaxCachedBytes); blocks
+//   freed beyond the cap are returned to the system. emptyCache releases the
+//   shared pool and the free lists of the calling thread.
+// - With huge pages enabled, blocks of 2 MB and more are 2 MB aligned and
+//   advised as transparent huge pages on Linux.
+//
+// Pooled allocations are reported to ProfiledCPUMemoryReporter like any other
+// CPU allocation, so the profiler sees tensor allocations and frees, while
+// getStats() describes the pool itself.
+//
+// Pooling is disabled by default. It is enabled with setEnabled or with the
+// PYTORCH_CPU_ALLOC_CONF environment variable, which takes a comma separated
+// list of options, e.g. PYTORCH_CPU_ALLOC_CONF=pooling:1,max_cached_mb:1024,
+// huge_pages:1.
+
+namespace CPUPoolingAllocator {
+
+constexpr size_t kMinPooledSize = 64 * 1024;
+
+// Statistics of the pooled allocations, smaller ones are not counted
+struct Stats {
+  // SUM: bytes of the blocks handed out to client code, rounded to their
+  // size class
+  int64_t allocated_bytes = 0;
+  int64_t peak_allocated_bytes = 0;
+  // SUM: bytes of the blocks held by the pool, in use or cached
+  int64_t reserved_bytes = 0;
+  int64_t peak_reserved_bytes = 0;
+  // SUM: bytes of cached blocks, ready for reuse
+  int64_t cached_bytes = 0;
+  // COUNT: allocations served from a cached block
+  int64_t num_cache_hits = 0;
+  // COUNT: allocations that had to allocate from the system
+  int64_t num_system_allocs = 0;
+  // COUNT: blocks returned to the system
+  int64_t num_system_frees = 0;
+};
+
+C10_API void setEnabled(bool enabled);
+C10_API bool isEnabled();
+// Cap on the bytes cached in free lists, 1 GB by default
+C10_API void setMaxCachedBytes(size_t max_cached_bytes);
+C10_API size_t getMaxCachedBytes();
+// Only affects blocks allocated after the call
+C10_API void setHugePages(bool enabled);
+C10_API void emptyCache();
+C10_API Stats getStats();
+C10_API void resetPeakStats();
+
+// Allocates from the pool regardless of isEnabled, for the default CPU
+// allocator. nbytes must be at least kMinPooledSize.
+C10_API DataPtr allocate(size_t nbytes);
+// Whether data is the data pointer of a block allocated by the pool
+C10_API bool owns(void* data);
+// Frees the data pointers of pool blocks
+C10_API DeleterFnPtr deleter();
+
+} // namespace CPUPoolingAllocator
+} // namespace c10
@@ -0,0 +1,241 @@
+#include <c10/core/InferenceArena.h>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
+
+namespace c10 {
+
+// See Note [Inference arena]
+struct InferenceArena::Chunk {
+  char* base;
+  size_t bytes;
+  size_t used = 0;
+  // allocations not freed yet, plus one held by the arena while the chunk is
+  // attached to it
+  std::atomic<size_t> refcount{1};
+};
+
+namespace {
+
+// Stored in front of the data of every allocation, keeping the data
+// gAlignment aligned
+struct AllocationHeader {
+  InferenceArena::Chunk* chunk;
+};
+constexpr size_t kHeaderSize = gAlignment;
+static_assert(sizeof(AllocationHeader) <= kHeaderSize, "header too large");
+
+size_t roundUp(size_t nbytes) {
+  return (nbytes + gAlignment - 1) & ~(gAlignment - 1);
+}
+
+AllocationHeader* header(void* data) {
+  return reinterpret_cast<AllocationHeader*>(
+      static_cast<char*>(data) - kHeaderSize);
+}
+
+thread_local InferenceArena* current_arena = nullptr;
+
+// Address ranges of the chunks, for owns(). Only touched when chunks are
+// allocated from or returned to the system.
+struct Registry {
+  std::mutex mutex;
+  std::map<uintptr_t, size_t> chunks;
+  std::atomic<size_t> num_chunks{0};
+};
+
+// Leaked so that chunks freed by late static destructors can unregister
+Registry& registry() {
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+void releaseChunk(InferenceArena::Chunk* chunk) {
+  if (--chunk->refcount != 0) {
+    return;
+  }
+  {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.chunks.erase(reinterpret_cast<uintptr_t>(chunk->base));
+    reg.num_chunks--;
+  }
+  free_cpu(chunk->base);
+  delete chunk;
+}
+
+void deleteAllocation(void* data) {
+  if (!data) {
+    return;
+  }
+  profiledCPUMemoryReporter().Delete(data);
+  releaseChunk(header(data)->chunk);
+}
+
+} // namespace
+
+InferenceArena::InferenceArena(size_t chunk_bytes)
+    : chunk_bytes_(roundUp(chunk_bytes)) {
+  TORCH_CHECK(chunk_bytes > 0, "InferenceArena: chunk_bytes must be positive");
+}
+
+InferenceArena::~InferenceArena() {
+  TORCH_INTERNAL_ASSERT_DEBUG_ONLY(
+      depth_ == 0, "InferenceArena destroyed inside of its scope");
+  // chunks with live allocations are freed with the last of them
+  for (Chunk* chunk : chunks_) {
+    releaseChunk(chunk);
+  }
+}
+
+InferenceArena::Chunk* InferenceArena::newChunk(size_t min_bytes) {
+  auto* chunk = new Chunk();
+  chunk->bytes = std::max(chunk_bytes_, roundUp(min_bytes));
+  try {
+    chunk->base = static_cast<char*>(alloc_cpu(chunk->bytes));
+  } catch (...) {
+    delete chunk;
+    throw;
+  }
+  {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.chunks.emplace(reinterpret_cast<uintptr_t>(chunk->base), chunk->bytes);
+    reg.num_chunks++;
+  }
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  stats_.reserved_bytes += chunk->bytes;
+  stats_.num_chunk_allocs++;
+  return chunk;
+}
+
+DataPtr InferenceArena::allocate(size_t nbytes) {
+  if (nbytes == 0) {
+    return {nullptr, nullptr, &deleteAllocation, Device(DeviceType::CPU)};
+  }
+  const size_t bytes = kHeaderSize + roundUp(nbytes);
+  // bump allocation, chunks are only revisited after reset()
+  while (current_ < chunks_.size() &&
+         chunks_[current_]->used + bytes > chunks_[current_]->bytes) {
+    current_++;
+  }
+  if (current_ == chunks_.size()) {
+    chunks_.push_back(newChunk(bytes));
+  }
+  Chunk* chunk = chunks_[current_];
+  char* ptr = chunk->base + chunk->used;
+  chunk->used += bytes;
+  chunk->refcount.fetch_add(1, std::memory_order_relaxed);
+  scope_bytes_ += bytes;
+
+  reinterpret_cast<AllocationHeader*>(ptr)->chunk = chunk;
+  void* data = ptr + kHeaderSize;
+  if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
+    memset(data, 0, nbytes);
+  } else if (FLAGS_caffe2_cpu_allocator_do_junk_fill) {
+    memset_junk(data, nbytes);
+  }
+  profiledCPUMemoryReporter().New(data, nbytes);
+  return {data, data, &deleteAllocation, Device(DeviceType::CPU)};
+}
+
+void InferenceArena::reset() {
+  size_t escaped_allocations = 0;
+  size_t escaped_chunks = 0;
+  size_t detached_bytes = 0;
+  const bool spilled = chunks_.size() > 1;
+  std::vector<Chunk*> kept;
+  for (Chunk* chunk : chunks_) {
+    // Only this thread allocates from the chunk, so the count can only drop
+    // concurrently, and a chunk whose allocations were all freed stays so.
+    const size_t refcount = chunk->refcount.load();
+    if (refcount == 1) {
+      chunk->used = 0;
+      kept.push_back(chunk);
+    } else {
+      escaped_allocations += refcount - 1;
+      escaped_chunks++;
+      detached_bytes += chunk->bytes;
+      releaseChunk(chunk);
+    }
+  }
+  size_t freed_bytes = 0;
+  if (spilled && !kept.empty()) {
+    // replace the chunks by one that fits the whole scope
+    for (Chunk* chunk : kept) {
+      freed_bytes += chunk->bytes;
+      releaseChunk(chunk);
+    }
+    kept.clear();
+  }
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.reserved_bytes -= detached_bytes + freed_bytes;
+    stats_.peak_scope_bytes = std::max(stats_.peak_scope_bytes, scope_bytes_);
+    stats_.num_escaped_allocations += escaped_allocations;
+    stats_.num_escaped_chunks += escaped_chunks;
+  }
+  chunks_ = std::move(kept);
+  if (spilled && freed_bytes != 0) {
+    chunks_.push_back(newChunk(scope_bytes_));
+  }
+  current_ = 0;
+  scope_bytes_ = 0;
+}
+
+InferenceArena::Stats InferenceArena::getStats() const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  return stats_;
+}
+
+void InferenceArena::enter() {
+  depth_++;
+}
+
+void InferenceArena::exit() {
+  if (--depth_ == 0) {
+    reset();
+  }
+}
+
+InferenceArena* InferenceArena::current() {
+  return current_arena;
+}
+
+bool InferenceArena::owns(void* data) {
+  auto& reg = registry();
+  if (reg.num_chunks.load(std::memory_order_relaxed) == 0 || !data) {
+    return false;
+  }
+  const auto address = reinterpret_cast<uintptr_t>(data);
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  auto it = reg.chunks.upper_bound(address);
+  if (it == reg.chunks.begin()) {
+    return false;
+  }
+  --it;
+  return address < it->first + it->second;
+}
+
+DeleterFnPtr InferenceArena::deleter() {
+  return &deleteAllocation;
+}
+
+InferenceArenaGuard::InferenceArenaGuard(InferenceArena* arena)
+    : arena_(arena), prev_arena_(current_arena) {
+  TORCH_CHECK(arena_, "InferenceArenaGuard: arena must not be null");
+  arena_->enter();
+  current_arena = arena_;
+}
+
+InferenceArenaGuard::~InferenceArenaGuard() {
+  current_arena = prev_arena_;
+  arena_->exit();
+}
+
+} // namespace c10
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <c10/core/Allocator.h>
+#include <c10/macros/Macros.h>
+
+namespace c10 {
+
+// Note [Inference arena]
+// ~~~~~~~~~~~~~~~~~~~~~~
+// Eager inference, e.g. torch::jit::Module::forward, allocates and frees
+// every intermediate through the default CPU allocator. An InferenceArena
+// turns these into bump allocations: while an InferenceArenaGuard is alive on
+// a thread, the default CPU allocator serves the allocations of that thread
+// from the chunks of the arena, and frees don't return memory. When the
+// outermost guard of the arena exits, the arena is reset and its chunks are
+// reused by the next scope. If a scope needed several chunks, they are
+// replaced by a single chunk of their total size, so a steady workload ends
+// up with one chunk and no system allocations.
+//
+// Tensors that escape the scope, such as the outputs of forward, keep the
+// chunks they were allocated from: a chunk with live allocations at reset is
+// detached from the arena and returned to the system once the last of them is
+// freed. The arena starts over with a new chunk. Escapes are counted in
+// getStats(), and models whose outputs escape every scope should clone them
+// inside the scope, which costs a copy instead of a chunk per scope.
+//
+// - Only the allocations of the thread that entered the guard come from the
+//   arena, allocations made by other threads, e.g. intra-op workers, don't.
+//   Arena allocations may be freed by any thread.
+// - The guard affects the default CPU allocator only, allocators installed
+//   with SetCPUAllocator, and the caching allocators of mobile builds, are
+//   used as before.
+// - Allocations are reported to ProfiledCPUMemoryReporter like any other CPU
+//   allocation.
+//
+// Usage:
+//   c10::InferenceArena arena;
+//   ...
+//   {
+//     c10::InferenceMode mode;
+//     c10::InferenceArenaGuard guard(&arena);
+//     auto output = module.forward(inputs).toTensor().clone();
+//   }
+
+class C10_API InferenceArena {
+ public:
+  struct Stats {
+    // bytes of the chunks held by the arena
+    size_t reserved_bytes = 0;
+    // largest sum of the sizes of the allocations of one scope
+    size_t peak_scope_bytes = 0;
+    // chunks allocated from the system
+    size_t num_chunk_allocs = 0;
+    // allocations that outlived their scope, and the chunks they detached
+    size_t num_escaped_allocations = 0;
+    size_t num_escaped_chunks = 0;
+  };
+
+  static constexpr size_t kDefaultChunkBytes = 4 * 1024 * 1024;
+
+  explicit InferenceArena(size_t chunk_bytes = kDefaultChunkBytes);
+  ~InferenceArena();
+
+  InferenceArena(const InferenceArena&) = delete;
+  InferenceArena& operator=(const InferenceArena&) = delete;
+
+  // Allocates from the current chunk, or from a new one if it is full. Must
+  // be called from the thread that entered the guard.
+  DataPtr allocate(size_t nbytes);
+
+  Stats getStats() const;
+
+  // The innermost arena entered by this thread, or nullptr
+  static InferenceArena* current();
+
+  // Whether data is the data pointer of an arena allocation, for the raw
+  // deleter of the default CPU allocator
+  static bool owns(void* data);
+  static DeleterFnPtr deleter();
+
+  struct Chunk;
+
+ private:
+  friend struct InferenceArenaGuard;
+
+  void enter();
+  void exit();
+  // Reuses the chunks without live allocations and detaches the others
+  void reset();
+  Chunk* newChunk(size_t min_bytes);
+
+  const size_t chunk_bytes_;
+  // guards entered and not exited yet, the arena is reset when the last one
+  // exits
+  int depth_ = 0;
+  std::vector<Chunk*> chunks_;
+  // index of the chunk allocations are taken from
+  size_t current_ = 0;
+  size_t scope_bytes_ = 0;
+
+  mutable std::mutex stats_mutex_;
+  Stats stats_;
+};
+
+// A RAII, thread local (!) guard that makes the default CPU allocator
+// allocate from the arena upon construction, and sets it back to the previous
+// allocator, which may be another arena, upon destruction.
+// See Note [Inference arena].
+struct C10_API InferenceArenaGuard {
+  explicit InferenceArenaGuard(InferenceArena* arena);
+  ~InferenceArenaGuard();
+
+  InferenceArenaGuard(const InferenceArenaGuard&) = delete;
+  InferenceArenaGuard& operator=(const InferenceArenaGuard&) = delete;
+
+ private:
+  InferenceArena* arena_;
+  InferenceArena* prev_arena_;
+};
+
+} // namespace c10
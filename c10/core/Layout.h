@@ -6,12 +6,20 @@
 #include <iostream>
 
 namespace c10 {
-enum class Layout : int8_t { Strided, Sparse, SparseCsr, Mkldnn, NumOptions };
+enum class Layout : int8_t {
+  Strided,
+  Sparse,
+  SparseCsr,
+  Mkldnn,
+  SparseBsr,
+  NumOptions
+};
 
 constexpr auto kStrided = Layout::Strided;
 constexpr auto kSparse = Layout::Sparse;
 constexpr auto kSparseCsr = Layout::SparseCsr;
 constexpr auto kMkldnn = Layout::Mkldnn;
+constexpr auto kSparseBsr = Layout::SparseBsr;
 
 inline Layout layout_from_backend(Backend backend) {
   switch (backend) {
@@ -40,6 +48,8 @@ inline std::ostream& operator<<(std::ostream& stream, at::Layout layout) {
       return stream << "SparseCsr";
     case at::kMkldnn:
       return stream << "Mkldnn";
+    case at::kSparseBsr:
+      return stream << "SparseBsr";
     default:
       TORCH_CHECK(false, "Unknown layout");
   }
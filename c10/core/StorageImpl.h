@@ -5,6 +5,8 @@
 
 #include <c10/util/intrusive_ptr.h>
 
+#include <cstring>
+
 namespace c10 {
 
 // A storage represents the underlying backing data buffer for a
@@ -30,9 +32,22 @@ namespace c10 {
 // - Version counts won't work correctly, because we do all VC tracking at the
 //   level of storages (unless you explicitly disconnect the VC with detach);
 //   mutation because data pointers are the same are totally untracked
+// Note [Inline storage for tiny tensors]
+// Scalars and other tiny CPU tensors would pay for a separate data
+// allocation (a 64-byte aligned one at that) that is often larger than the
+// StorageImpl itself. Instead, a StorageImpl created with use_inline_data_t
+// keeps up to kInlineBytes of data in the StorageImpl and points its
+// non-owning data_ptr_ there. The allocator is still recorded, so a resize
+// moves the data out to a normal allocation; the inline bytes then simply
+// go unused. Moving a StorageImpl (e.g. THStorage swap) rebases a data_ptr_
+// that points at the source's inline bytes. Callers decide when this is
+// appropriate; see at::detail::empty_generic.
 struct C10_API StorageImpl final : public c10::intrusive_ptr_target {
  public:
   struct use_byte_size_t {};
+  struct use_inline_data_t {};
+
+  static constexpr size_t kInlineBytes = 16;
 
   StorageImpl(
       use_byte_size_t use_byte_size,
@@ -63,13 +78,45 @@ struct C10_API StorageImpl final : public c10::intrusive_ptr_target {
             allocator,
             resizable) {}
 
-  StorageImpl& operator=(StorageImpl&& other) = default;
+  // See Note [Inline storage for tiny tensors]
+  StorageImpl(
+      use_inline_data_t use_inline_data,
+      size_t size_bytes,
+      at::Allocator* allocator)
+      : data_ptr_(inline_data_, Device(DeviceType::CPU)),
+        size_bytes_(size_bytes),
+        resizable_(true),
+        received_cuda_(false),
+        allocator_(allocator) {
+    TORCH_INTERNAL_ASSERT(size_bytes <= kInlineBytes && allocator_);
+  }
+
+  StorageImpl& operator=(StorageImpl&& other) {
+    data_ptr_ = std::move(other.data_ptr_);
+    size_bytes_ = other.size_bytes_;
+    resizable_ = other.resizable_;
+    received_cuda_ = other.received_cuda_;
+    allocator_ = other.allocator_;
+    adopt_inline_data(other);
+    return *this;
+  }
   StorageImpl& operator=(const StorageImpl&) = delete;
   StorageImpl() = delete;
-  StorageImpl(StorageImpl&& other) = default;
+  StorageImpl(StorageImpl&& other)
+      : data_ptr_(std::move(other.data_ptr_)),
+        size_bytes_(other.size_bytes_),
+        resizable_(other.resizable_),
+        received_cuda_(other.received_cuda_),
+        allocator_(other.allocator_) {
+    adopt_inline_data(other);
+  }
   StorageImpl(const StorageImpl&) = delete;
   ~StorageImpl() = default;
 
+  bool has_inline_data() const {
+    return data_ptr_.get() == inline_data_;
+  }
+
   void reset() {
     data_ptr_.clear();
     size_bytes_ = 0;
@@ -195,6 +242,15 @@ struct C10_API StorageImpl final : public c10::intrusive_ptr_target {
   }
 
  private:
+  // After data_ptr_ was moved from `other`, points it at our own copy of
+  // other's inline data if that is what it referred to.
+  void adopt_inline_data(const StorageImpl& other) {
+    if (data_ptr_.get() == other.inline_data_) {
+      std::memcpy(inline_data_, other.inline_data_, kInlineBytes);
+      data_ptr_ = DataPtr(inline_data_, data_ptr_.device());
+    }
+  }
+
   DataPtr data_ptr_;
   size_t size_bytes_;
   bool resizable_;
@@ -202,5 +258,7 @@ struct C10_API StorageImpl final : public c10::intrusive_ptr_target {
   // local to process cuda memory allocation
   bool received_cuda_;
   Allocator* allocator_;
+  // See Note [Inline storage for tiny tensors]
+  alignas(16) char inline_data_[kInlineBytes];
 };
 } // namespace c10
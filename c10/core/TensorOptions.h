@@ -664,7 +664,10 @@ inline DispatchKey computeDispatchKey(c10::optional<ScalarType> dtype, c10::opti
           default:
             TORCH_CHECK_NOT_IMPLEMENTED(false, "Unsupported device type for mkldnn layout: ", device_.type());
         }
+      // Block sparse tensors are sparse CSR tensors with blocks for values,
+      // see SparseCsrTensorImpl, and share their kernels.
       case Layout::SparseCsr:
+      case Layout::SparseBsr:
         switch(device_.type()) {
           case DeviceType::CPU:
             return DispatchKey::SparseCsrCPU;
@@ -1,4 +1,5 @@
 #include <c10/core/thread_pool.h>
+#include <c10/util/Logging.h>
 
 namespace c10 {
 
@@ -132,6 +133,275 @@ void ThreadPool::main_loop(std::size_t index) {
   } // while running_
 }
 
+namespace {
+// Pool and deque index of the current thread, if it is a worker of a
+// WorkStealingThreadPool.
+thread_local const WorkStealingThreadPool* current_ws_pool = nullptr;
+thread_local std::size_t current_ws_index = 0;
+} // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(
+      int pool_size,
+      int numa_node_id,
+      std::function<void()> init_thread)
+    : threads_(pool_size < 0 ? defaultNumThreads() : pool_size),
+      pending_(0),
+      available_(threads_.size()),
+      next_queue_(0),
+      running_(true),
+      numa_node_id_(numa_node_id) {
+  queues_.reserve(threads_.size());
+  for (std::size_t i = 0; i < threads_.size(); ++i) {
+    queues_.emplace_back(new WorkerQueue());
+  }
+  for (std::size_t i = 0; i < threads_.size(); ++i) {
+    threads_[i] = std::thread([this, i, init_thread](){
+      if (init_thread) {
+        init_thread();
+      }
+      this->main_loop(i);
+    });
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    running_ = false;
+    wakeup_.notify_all();
+  }
+
+  for (auto& t : threads_) {
+    try {
+      t.join();
+    } catch (const std::exception&) {
+    }
+  }
+}
+
+size_t WorkStealingThreadPool::size() const {
+  return threads_.size();
+}
+
+size_t WorkStealingThreadPool::numAvailable() const {
+  return available_;
+}
+
+bool WorkStealingThreadPool::inThreadPool() const {
+  return current_ws_pool == this;
+}
+
+void WorkStealingThreadPool::run(std::function<void()> func) {
+  if (threads_.size() == 0) {
+    throw std::runtime_error("No threads to run a task");
+  }
+  const std::size_t index = inThreadPool()
+      ? current_ws_index
+      : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+  {
+    std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+    queues_[index]->tasks.push_back(std::move(func));
+    ++pending_;
+  }
+  // Taking the sleep mutex orders the increment above with a worker that is
+  // about to check pending_ and block, so the notification cannot be lost.
+  { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+  wakeup_.notify_one();
+}
+
+bool WorkStealingThreadPool::popTask(
+    std::size_t index, bool own, std::function<void()>& task) {
+  const std::size_t n = queues_.size();
+  if (own) {
+    WorkerQueue& q = *queues_[index];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (!q.tasks.empty()) {
+      task = std::move(q.tasks.back());
+      q.tasks.pop_back();
+      --pending_;
+      return true;
+    }
+  }
+  for (std::size_t k = own ? 1 : 0; k < n; ++k) {
+    WorkerQueue& q = *queues_[(index + k) % n];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (!q.tasks.empty()) {
+      task = std::move(q.tasks.front());
+      q.tasks.pop_front();
+      --pending_;
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkStealingThreadPool::runTask(std::function<void()>& task) {
+  try {
+    task();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Exception in thread pool task: " << e.what();
+  } catch (...) {
+    LOG(ERROR) << "Exception in thread pool task: unknown";
+  }
+  // Destroy the task right away, it may hold shared_ptr arguments.
+  task = nullptr;
+}
+
+void WorkStealingThreadPool::main_loop(std::size_t index) {
+  current_ws_pool = this;
+  current_ws_index = index;
+  std::function<void()> task;
+  while (running_) {
+    if (popTask(index, /* own */ true, task)) {
+      --available_;
+      runTask(task);
+      ++available_;
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wakeup_.wait(lock, [this]() { return pending_ > 0 || !running_; });
+  }
+  current_ws_pool = nullptr;
+}
+
+constexpr int64_t TaskPriority::kNoDeadline;
+
+int64_t TaskPriority::deadlineAfter(std::chrono::nanoseconds timeout) {
+  const auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(now + timeout)
+      .count();
+}
+
+void PriorityThreadPool::Task::raise(const TaskPriority& priority) {
+  if (started_) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(pool_->mutex_);
+  if (started_ || !priority.runsBefore(priority_)) {
+    return;
+  }
+  priority_ = priority_.combine(priority);
+  // The entry with the old key stays queued and is dropped when popped
+  pool_->pushLocked(shared_from_this());
+}
+
+TaskPriority PriorityThreadPool::Task::priority() const {
+  std::unique_lock<std::mutex> lock(pool_->mutex_);
+  return priority_;
+}
+
+PriorityThreadPool::PriorityThreadPool(
+      int pool_size,
+      int numa_node_id,
+      std::function<void()> init_thread)
+    : threads_(pool_size < 0 ? defaultNumThreads() : pool_size),
+      next_seq_(0),
+      running_(true),
+      available_(threads_.size()),
+      numa_node_id_(numa_node_id) {
+  for (std::size_t i = 0; i < threads_.size(); ++i) {
+    threads_[i] = std::thread([this, i, init_thread](){
+      if (init_thread) {
+        init_thread();
+      }
+      this->main_loop(i);
+    });
+  }
+}
+
+PriorityThreadPool::~PriorityThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    running_ = false;
+    condition_.notify_all();
+  }
+
+  for (auto& t : threads_) {
+    try {
+      t.join();
+    } catch (const std::exception&) {
+    }
+  }
+}
+
+size_t PriorityThreadPool::size() const {
+  return threads_.size();
+}
+
+size_t PriorityThreadPool::numAvailable() const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return available_;
+}
+
+bool PriorityThreadPool::inThreadPool() const {
+  for (auto& thread : threads_) {
+    if (thread.get_id() == std::this_thread::get_id()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void PriorityThreadPool::run(std::function<void()> func) {
+  runWithPriority(std::move(func), TaskPriority());
+}
+
+std::shared_ptr<PriorityThreadPool::Task> PriorityThreadPool::runWithPriority(
+    std::function<void()> func,
+    const TaskPriority& priority) {
+  if (threads_.size() == 0) {
+    throw std::runtime_error("No threads to run a task");
+  }
+  std::shared_ptr<Task> task(new Task(this, std::move(func), priority));
+  std::unique_lock<std::mutex> lock(mutex_);
+  pushLocked(task);
+  return task;
+}
+
+void PriorityThreadPool::pushLocked(std::shared_ptr<Task> task) {
+  const TaskPriority priority = task->priority_;
+  tasks_.push(Entry{priority, next_seq_++, std::move(task)});
+  condition_.notify_one();
+}
+
+void PriorityThreadPool::main_loop(std::size_t index) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (running_) {
+    while (tasks_.empty() && running_) {
+      condition_.wait(lock);
+    }
+    if (!running_) {
+      break;
+    }
+
+    std::shared_ptr<Task> task = tasks_.top().task;
+    tasks_.pop();
+    // Set under the lock, so that raise() does not queue entries for tasks
+    // that are already running
+    if (task->started_.exchange(true)) {
+      // Superseded by an entry with a more urgent key
+      continue;
+    }
+    --available_;
+    lock.unlock();
+
+    try {
+      task->func_();
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Exception in thread pool task: " << e.what();
+    } catch (...) {
+      LOG(ERROR) << "Exception in thread pool task: unknown";
+    }
+    // Release the task's captures before taking the lock again, like
+    // ThreadPool does
+    task->func_ = nullptr;
+    task.reset();
+
+    lock.lock();
+    ++available_;
+  }
+}
+
 C10_DEFINE_SHARED_REGISTRY(
     ThreadPoolRegistry,
     TaskThreadPoolBase,
@@ -1,11 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <limits>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include <c10/util/Optional.h>
 #include <c10/util/intrusive_ptr.h>
@@ -103,6 +111,186 @@ class C10_API ThreadPool : public c10::TaskThreadPoolBase {
   void main_loop(std::size_t index);
 };
 
+// Thread pool with one task deque per worker instead of a single queue
+// shared by all of them. A task submitted from one of the workers goes to
+// the back of that worker's deque and is popped LIFO by its owner, so nested
+// submissions stay on the thread that has their data in cache; tasks
+// submitted from other threads are spread round-robin over the deques. A
+// worker whose own deque is empty steals from the front of the others before
+// going to sleep. Compared to ThreadPool this removes the global lock from
+// the task hand-off path, which dominates when many short tasks are queued.
+class C10_API WorkStealingThreadPool : public c10::TaskThreadPoolBase {
+ public:
+  WorkStealingThreadPool() = delete;
+
+  explicit WorkStealingThreadPool(
+      int pool_size,
+      int numa_node_id = -1,
+      std::function<void()> init_thread = nullptr);
+
+  ~WorkStealingThreadPool();
+
+  size_t size() const override;
+
+  size_t numAvailable() const override;
+
+  bool inThreadPool() const override;
+
+  void run(std::function<void()> func) override;
+
+ private:
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  // @brief Pop a task, from the back of deque `index` if `own` is set, then
+  // from the front of the other deques.
+  bool popTask(std::size_t index, bool own, std::function<void()>& task);
+
+  void runTask(std::function<void()>& task);
+
+  // @brief Entry point for pool threads.
+  void main_loop(std::size_t index);
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::vector<std::thread> threads_;
+  // Number of tasks sitting in the deques; idle workers sleep while it is 0.
+  std::atomic<std::size_t> pending_;
+  std::atomic<std::size_t> available_;
+  std::atomic<std::size_t> next_queue_;
+  std::atomic_bool running_;
+  std::mutex sleep_mutex_;
+  std::condition_variable wakeup_;
+  int numa_node_id_;
+};
+
+// Scheduling key of a task queued on a PriorityThreadPool. Tasks with a
+// higher priority run first; among tasks of the same priority the one with
+// the earliest deadline runs first, and ties keep submission order.
+// Deadlines are std::chrono::steady_clock times in nanoseconds since its
+// epoch.
+struct C10_API TaskPriority {
+  static constexpr int64_t kNoDeadline = std::numeric_limits<int64_t>::max();
+
+  int priority = 0;
+  int64_t deadline = kNoDeadline;
+
+  TaskPriority() = default;
+  TaskPriority(int priority, int64_t deadline = kNoDeadline)
+      : priority(priority), deadline(deadline) {}
+
+  bool runsBefore(const TaskPriority& other) const {
+    return priority != other.priority ? priority > other.priority
+                                      : deadline < other.deadline;
+  }
+
+  // Returns the more urgent of the two keys in each component.
+  TaskPriority combine(const TaskPriority& other) const {
+    return TaskPriority(
+        std::max(priority, other.priority),
+        std::min(deadline, other.deadline));
+  }
+
+  // Returns a deadline `timeout` from now.
+  static int64_t deadlineAfter(std::chrono::nanoseconds timeout);
+};
+
+// Thread pool that runs queued tasks in TaskPriority order instead of FIFO.
+// runWithPriority returns a handle on the queued task that can raise its
+// priority until a worker picks it up, e.g. when a more urgent task starts
+// waiting for its result. A raise queues a second entry for the task with
+// the new key; whichever entry is popped first runs the task and the other
+// one is dropped.
+class C10_API PriorityThreadPool : public c10::TaskThreadPoolBase {
+ public:
+  class C10_API Task : public std::enable_shared_from_this<Task> {
+   public:
+    // Raises the priority of the task to `priority` if the task has not
+    // started yet and `priority` runs before its current one.
+    void raise(const TaskPriority& priority);
+
+    TaskPriority priority() const;
+
+    bool started() const {
+      return started_;
+    }
+
+   private:
+    friend class PriorityThreadPool;
+
+    Task(
+        PriorityThreadPool* pool,
+        std::function<void()> func,
+        const TaskPriority& priority)
+        : pool_(pool), func_(std::move(func)), priority_(priority) {}
+
+    PriorityThreadPool* pool_;
+    std::function<void()> func_;
+    // Guarded by pool_->mutex_
+    TaskPriority priority_;
+    std::atomic<bool> started_{false};
+  };
+
+  PriorityThreadPool() = delete;
+
+  explicit PriorityThreadPool(
+      int pool_size,
+      int numa_node_id = -1,
+      std::function<void()> init_thread = nullptr);
+
+  ~PriorityThreadPool();
+
+  size_t size() const override;
+
+  size_t numAvailable() const override;
+
+  bool inThreadPool() const override;
+
+  // Runs `func` with the default priority
+  void run(std::function<void()> func) override;
+
+  std::shared_ptr<Task> runWithPriority(
+      std::function<void()> func,
+      const TaskPriority& priority);
+
+ private:
+  struct Entry {
+    TaskPriority priority;
+    uint64_t seq;
+    std::shared_ptr<Task> task;
+  };
+
+  // Orders the heap so that its top is the entry that runs first
+  struct EntryCompare {
+    bool operator()(const Entry& a, const Entry& b) const {
+      if (b.priority.runsBefore(a.priority)) {
+        return true;
+      }
+      if (a.priority.runsBefore(b.priority)) {
+        return false;
+      }
+      return a.seq > b.seq;
+    }
+  };
+
+  // @brief Queue an entry for `task` with its current priority. Requires
+  // mutex_ to be held.
+  void pushLocked(std::shared_ptr<Task> task);
+
+  // @brief Entry point for pool threads.
+  void main_loop(std::size_t index);
+
+  std::priority_queue<Entry, std::vector<Entry>, EntryCompare> tasks_;
+  std::vector<std::thread> threads_;
+  uint64_t next_seq_;
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  bool running_;
+  std::size_t available_;
+  int numa_node_id_;
+};
+
 class C10_API TaskThreadPool : public c10::ThreadPool {
  public:
   explicit TaskThreadPool(
@@ -4,21 +4,39 @@
 #include <c10/cuda/CUDAGuard.h>
 #include <c10/cuda/CUDAException.h>
 #include <c10/cuda/CUDAFunctions.h>
+#include <c10/util/Optional.h>
 #include <c10/util/UniqueVoidPtr.h>
+#include <c10/util/irange.h>
 
+#include <cuda.h>
 #include <cuda_runtime_api.h>
 #include <algorithm>
+#include <atomic>
 #include <bitset>
+#include <cstdlib>
 #include <deque>
 #include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <set>
+#include <sstream>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#if defined(CUDA_VERSION) && CUDA_VERSION >= 10020 && !defined(_WIN32) && \
+    !defined(__HIP_PLATFORM_HCC__)
+#define C10_CUDA_EXPANDABLE_SEGMENTS_SUPPORTED
+#include <dlfcn.h>
+#endif
+
+#if defined(CUDA_VERSION) && CUDA_VERSION >= 11040 && \
+    !defined(__HIP_PLATFORM_HCC__)
+#define C10_CUDA_MALLOC_ASYNC_SUPPORTED
+#endif
+
 namespace c10 {
 
 C10_DEFINE_REGISTRY(FreeCudaMemoryCallbacksRegistry, FreeMemoryCallback);
@@ -41,6 +59,20 @@ namespace CUDACachingAllocator {
 //   smallest available free block or allocate a new block using cudaMalloc.
 //   To reduce fragmentation, requests between 1MB and 10MB will allocate and
 //   split a 20MB block, if no free block of sufficient size is available.
+// - With PYTORCH_CUDA_ALLOC_CONF=expandable_segments:True, blocks are carved
+//   out of expandable segments instead of fixed cudaMalloc segments, see
+//   Note [Expandable segments].
+// - With PYTORCH_CUDA_ALLOC_CONF=stream_ordered_free:True, frees of blocks
+//   used on other streams are ordered on the allocation stream instead of
+//   being delayed until the other streams are done, see
+//   Note [Stream-ordered frees].
+// - With PYTORCH_CUDA_ALLOC_CONF=garbage_collection_threshold:<fraction>,
+//   the least recently used cached segments of the large pool are released
+//   before reserved memory grows past that fraction of the device memory,
+//   see Note [Garbage collection of cached blocks].
+// - With PYTORCH_CUDA_ALLOC_CONF=backend:cudaMallocAsync, all of the above is
+//   replaced by the stream-ordered allocator of the CUDA driver, see
+//   Note [cudaMallocAsync backend].
 //
 // With this allocator, allocations and frees should logically be considered
 // "usages" of the memory segment associated with streams, just like kernel
@@ -80,6 +112,45 @@ namespace CUDACachingAllocator {
  * notifyCaptureEnd, and notifyCaptureDestroy.
  */
 
+/**
+ * Note [Cross-stream frees during capture]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * A captured training step uses memory on several streams: the autograd
+ * engine runs backward ops on the streams of their forward ops, and NCCL
+ * collectives record their inputs on the NCCL stream. Freeing such a block
+ * normally records events on these streams and reuses the block once
+ * process_events sees them complete. But cudaEventQuery is illegal on events
+ * recorded during capture (and on any event in Global capture mode), so while
+ * a capture may be underway, malloc skips process_events and free defers
+ * blocks with cross-stream uses to needs_events_deferred_until_no_capture.
+ * The first process_events after the last capture ended records their
+ * events (or waits, see Note [Stream-ordered frees]) as if they were freed
+ * then. Cross-stream uses are uncommon, so the memory held back during the
+ * capture is small.
+ */
+
+/**
+ * Note [Garbage collection of cached blocks]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Cached blocks are otherwise only released when cudaMalloc fails or on
+ * emptyCache, both of which release everything after synchronizing the
+ * device. A process sharing its GPU with others (MPS, inference sidecars)
+ * then keeps its high-water mark reserved. With
+ * garbage_collection_threshold:<fraction>, a cache miss that would grow
+ * reserved memory past fraction * limit (the memory fraction of
+ * setMemoryFraction if set, the device memory otherwise) first releases
+ * cached segments of the large pool, least recently freed first, until the
+ * allocation fits below the threshold or nothing is left to release:
+ * - A segment can be released when all of it is cached; for expandable
+ *   segments, the pages covered by cached blocks are unmapped.
+ * - Blocks waiting on events are not released, so unlike free_cached_blocks
+ *   no event is synchronized.
+ * - The small pool and the private pools of CUDA graphs are left alone, and
+ *   nothing is released while a capture is underway.
+ * The work is only done on cache misses above the threshold, which pay for a
+ * cudaMalloc anyway.
+ */
+
 namespace {
 
 using stream_set = std::unordered_set<cuda::CUDAStream>;
@@ -93,6 +164,393 @@ constexpr size_t kRoundLarge    =  2097152; // round up large allocations to 2 M
 
 typedef std::bitset<static_cast<size_t>(StatType::NUM_TYPES)> StatTypes;
 
+// Options of the caching allocator, parsed once from PYTORCH_CUDA_ALLOC_CONF,
+// a comma separated list of option:value pairs.
+class CachingAllocatorConfig {
+ public:
+  static bool expandable_segments() {
+    return instance().m_expandable_segments;
+  }
+
+  static bool stream_ordered_free() {
+    return instance().m_stream_ordered_free;
+  }
+
+  static bool use_malloc_async() {
+    return instance().m_use_malloc_async;
+  }
+
+  // 0 if garbage collection is disabled
+  static double garbage_collection_threshold() {
+    return instance().m_garbage_collection_threshold;
+  }
+
+ private:
+  static CachingAllocatorConfig& instance() {
+    static CachingAllocatorConfig* s_instance = new CachingAllocatorConfig();
+    return *s_instance;
+  }
+
+  CachingAllocatorConfig() {
+    const char* env = std::getenv("PYTORCH_CUDA_ALLOC_CONF");
+    if (env != nullptr) {
+      parseArgs(env);
+    }
+  }
+
+  void parseArgs(const char* env) {
+    std::stringstream options(env);
+    std::string option;
+    while (std::getline(options, option, ',')) {
+      const size_t colon = option.find(':');
+      TORCH_CHECK(colon != std::string::npos,
+                  "Invalid PYTORCH_CUDA_ALLOC_CONF option, expected option:value, got ", option);
+      const std::string key = option.substr(0, colon);
+      const std::string value = option.substr(colon + 1);
+      if (key == "expandable_segments") {
+        TORCH_CHECK(value == "True" || value == "False",
+                    "Expected True or False for expandable_segments, got ", value);
+        m_expandable_segments = value == "True";
+#ifndef C10_CUDA_EXPANDABLE_SEGMENTS_SUPPORTED
+        if (m_expandable_segments) {
+          TORCH_WARN("expandable_segments is not supported on this platform, ignoring it");
+          m_expandable_segments = false;
+        }
+#endif
+      } else if (key == "stream_ordered_free") {
+        TORCH_CHECK(value == "True" || value == "False",
+                    "Expected True or False for stream_ordered_free, got ", value);
+        m_stream_ordered_free = value == "True";
+      } else if (key == "garbage_collection_threshold") {
+        double threshold = 0.0;
+        try {
+          threshold = std::stod(value);
+        } catch (const std::exception&) {
+          TORCH_CHECK(false, "Expected a number for garbage_collection_threshold, got ", value);
+        }
+        TORCH_CHECK(threshold > 0.0 && threshold < 1.0,
+                    "garbage_collection_threshold must be in the interval (0.0, 1.0), got ", value);
+        m_garbage_collection_threshold = threshold;
+      } else if (key == "backend") {
+        TORCH_CHECK(value == "native" || value == "cudaMallocAsync",
+                    "Expected native or cudaMallocAsync for backend, got ", value);
+        m_use_malloc_async = value == "cudaMallocAsync";
+#ifndef C10_CUDA_MALLOC_ASYNC_SUPPORTED
+        if (m_use_malloc_async) {
+          TORCH_WARN("backend:cudaMallocAsync needs CUDA 11.4 or newer, using the native backend");
+          m_use_malloc_async = false;
+        }
+#endif
+      } else {
+        TORCH_CHECK(false, "Unrecognized PYTORCH_CUDA_ALLOC_CONF option: ", key);
+      }
+    }
+    if (m_use_malloc_async && m_expandable_segments) {
+      TORCH_WARN("expandable_segments has no effect with backend:cudaMallocAsync");
+      m_expandable_segments = false;
+    }
+    if (m_use_malloc_async && m_garbage_collection_threshold > 0.0) {
+      TORCH_WARN("garbage_collection_threshold has no effect with backend:cudaMallocAsync");
+      m_garbage_collection_threshold = 0.0;
+    }
+  }
+
+  bool m_expandable_segments = false;
+  bool m_stream_ordered_free = false;
+  bool m_use_malloc_async = false;
+  double m_garbage_collection_threshold = 0.0;
+};
+
+/**
+ * Note [Expandable segments]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * A block freed into a cudaMalloc'd segment can only merge with its neighbours
+ * in the same segment, so workloads whose allocation sizes keep changing (e.g.
+ * variable sequence lengths) strand memory in split blocks of many segments
+ * that are too small for the next request but cannot be returned to the
+ * driver.
+ *
+ * An expandable segment instead reserves a virtual address range as large as
+ * the device memory (cuMemAddressReserve) and backs it with physical memory on
+ * demand, in pages of the segment size (2 MiB for the small pool, 20 MiB for
+ * the large pool), using cuMemCreate and cuMemMap. There is one expandable
+ * segment per stream and pool, and it grows at its end, so consecutive blocks
+ * of a stream are adjacent and coalesce freely when freed.
+ *
+ * The address range of a segment is covered by a list of blocks as before.
+ * Blocks that have no physical memory behind them are "unmapped"; they live in
+ * BlockPool::unmapped rather than BlockPool::blocks, and only merge with other
+ * unmapped blocks. When no cached block fits a request, the allocator maps the
+ * unmapped block at the end of the segment (together with a free block just
+ * before it) instead of calling cudaMalloc. Releasing cached memory unmaps the
+ * pages that are completely covered by free blocks, which also works for
+ * blocks in the middle of a segment, and a segment whose blocks are all
+ * unmapped is released.
+ *
+ * Limitations: memory of expandable segments cannot be shared through CUDA
+ * IPC, is only accessible from its own device, and is not used for the
+ * private pools of CUDA graphs. Expandable segments need the CUDA driver API
+ * from CUDA 10.2 and are not available on Windows or ROCm.
+ */
+
+struct SegmentRange {
+  char* ptr;
+  size_t size;
+  SegmentRange(void* p, size_t s) : ptr(static_cast<char*>(p)), size(s) {}
+};
+
+#ifdef C10_CUDA_EXPANDABLE_SEGMENTS_SUPPORTED
+
+// The driver API functions used by expandable segments. libcuda is opened
+// lazily so that c10_cuda keeps depending only on the CUDA runtime.
+#define C10_FORALL_EXPANDABLE_SEGMENT_DRIVER_API(_) \
+  _(cuGetErrorString)                               \
+  _(cuMemAddressReserve)                            \
+  _(cuMemAddressFree)                               \
+  _(cuMemCreate)                                    \
+  _(cuMemRelease)                                   \
+  _(cuMemMap)                                       \
+  _(cuMemUnmap)                                     \
+  _(cuMemSetAccess)
+
+struct DriverAPI {
+#define CREATE_MEMBER(name) decltype(&name) name##_;
+  C10_FORALL_EXPANDABLE_SEGMENT_DRIVER_API(CREATE_MEMBER)
+#undef CREATE_MEMBER
+
+  static DriverAPI* get() {
+    static DriverAPI* s_driver = create();
+    return s_driver;
+  }
+
+ private:
+  static DriverAPI* create() {
+    void* handle = dlopen("libcuda.so.1", RTLD_LAZY | RTLD_NOLOAD);
+    if (handle == nullptr) {
+      handle = dlopen("libcuda.so.1", RTLD_LAZY);
+    }
+    TORCH_CHECK(handle != nullptr,
+                "expandable_segments requires the CUDA driver library: ", dlerror());
+    auto* driver = new DriverAPI();
+#define LOOKUP_ENTRY(name)                                                 \
+    driver->name##_ = reinterpret_cast<decltype(&name)>(dlsym(handle, #name)); \
+    TORCH_CHECK(driver->name##_ != nullptr, "Can't find ", #name, " in libcuda.so.1");
+    C10_FORALL_EXPANDABLE_SEGMENT_DRIVER_API(LOOKUP_ENTRY)
+#undef LOOKUP_ENTRY
+    return driver;
+  }
+};
+
+#define C10_CUDA_DRIVER_CHECK(EXPR)                                     \
+  do {                                                                  \
+    CUresult __err = EXPR;                                              \
+    if (__err != CUDA_SUCCESS) {                                        \
+      const char* err_str = nullptr;                                    \
+      DriverAPI::get()->cuGetErrorString_(__err, &err_str);             \
+      TORCH_CHECK(false, "CUDA driver error: ", err_str ? err_str : "unknown"); \
+    }                                                                   \
+  } while (0)
+
+// See Note [Expandable segments]
+class ExpandableSegment {
+ public:
+  ExpandableSegment(int device, cudaStream_t stream, size_t segment_size)
+      : device_(device), stream_(stream), segment_size_(segment_size) {
+    size_t device_free;
+    size_t device_total;
+    C10_CUDA_CHECK(cudaMemGetInfo(&device_free, &device_total));
+    // Reserving the size of the whole device means the segment never has to
+    // move, and virtual address space is plentiful.
+    max_handles_ = (device_total + segment_size_ - 1) / segment_size_;
+    CUdeviceptr ptr;
+    C10_CUDA_DRIVER_CHECK(DriverAPI::get()->cuMemAddressReserve_(
+        &ptr, segment_size_ * max_handles_, 0ULL, 0, 0ULL));
+    ptr_ = ptr;
+  }
+
+  ExpandableSegment(const ExpandableSegment&) = delete;
+  ExpandableSegment& operator=(const ExpandableSegment&) = delete;
+
+  ~ExpandableSegment() {
+    // The allocator only releases fully unmapped segments
+    TORCH_INTERNAL_ASSERT(handles_.empty());
+    CUDAGuard device_guard(device_);
+    C10_CUDA_DRIVER_CHECK(DriverAPI::get()->cuMemAddressFree_(
+        ptr_, segment_size_ * max_handles_));
+  }
+
+  // Maps physical memory to the pages covering range, whose start must be
+  // page aligned. Returns the mapped range, which is empty when the device is
+  // out of memory.
+  SegmentRange map(SegmentRange range) {
+    const size_t begin = segmentLeft(range.ptr);
+    const size_t end = segmentRight(range.ptr + range.size);
+    TORCH_INTERNAL_ASSERT(ptr() + begin * segment_size_ == range.ptr);
+    TORCH_INTERNAL_ASSERT(end <= max_handles_);
+    if (handles_.size() < end) {
+      handles_.resize(end);
+    }
+    for (const auto i : c10::irange(begin, end)) {
+      TORCH_INTERNAL_ASSERT(!handles_[i]);
+      CUmemAllocationProp prop = {};
+      prop.type = CU_MEM_ALLOCATION_TYPE_PINNED;
+      prop.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+      prop.location.id = device_;
+      CUmemGenericAllocationHandle handle;
+      const CUresult status =
+          DriverAPI::get()->cuMemCreate_(&handle, segment_size_, &prop, 0);
+      if (status == CUDA_ERROR_OUT_OF_MEMORY) {
+        for (const auto j : c10::irange(begin, i)) {
+          C10_CUDA_DRIVER_CHECK(DriverAPI::get()->cuMemRelease_(*handles_[j]));
+          handles_[j] = c10::nullopt;
+        }
+        trimHandles();
+        return SegmentRange(range.ptr, 0);
+      }
+      C10_CUDA_DRIVER_CHECK(status);
+      handles_[i] = handle;
+    }
+
+    for (const auto i : c10::irange(begin, end)) {
+      C10_CUDA_DRIVER_CHECK(DriverAPI::get()->cuMemMap_(
+          ptr_ + i * segment_size_, segment_size_, 0, *handles_[i], 0ULL));
+    }
+    CUmemAccessDesc desc;
+    desc.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+    desc.location.id = device_;
+    desc.flags = CU_MEM_ACCESS_FLAGS_PROT_READWRITE;
+    C10_CUDA_DRIVER_CHECK(DriverAPI::get()->cuMemSetAccess_(
+        ptr_ + begin * segment_size_, (end - begin) * segment_size_, &desc, 1));
+    return rangeFromHandles(begin, end);
+  }
+
+  // Unmaps the pages that lie completely within range and returns the
+  // unmapped range, which may be empty.
+  SegmentRange unmap(SegmentRange range) {
+    const size_t begin = segmentRight(range.ptr);
+    const size_t end = segmentLeft(range.ptr + range.size);
+    if (begin >= end) {
+      return SegmentRange(range.ptr, 0);
+    }
+    // emptyCache calls this for all devices
+    CUDAGuard device_guard(device_);
+    // Unmapping does not wait for the kernels using the memory. Blocks used
+    // on other streams only become free once their events completed, so
+    // waiting for the allocation stream is enough.
+    C10_CUDA_CHECK(cudaStreamSynchronize(stream_));
+    for (const auto i : c10::irange(begin, end)) {
+      TORCH_INTERNAL_ASSERT(handles_[i]);
+      C10_CUDA_DRIVER_CHECK(DriverAPI::get()->cuMemUnmap_(
+          ptr_ + i * segment_size_, segment_size_));
+      C10_CUDA_DRIVER_CHECK(DriverAPI::get()->cuMemRelease_(*handles_[i]));
+      handles_[i] = c10::nullopt;
+    }
+    trimHandles();
+    return rangeFromHandles(begin, end);
+  }
+
+  char* ptr() const {
+    return reinterpret_cast<char*>(ptr_);
+  }
+
+  size_t size() const {
+    return max_handles_ * segment_size_;
+  }
+
+ private:
+  size_t segmentLeft(const char* p) const {
+    return static_cast<size_t>(p - ptr()) / segment_size_;
+  }
+
+  size_t segmentRight(const char* p) const {
+    return (static_cast<size_t>(p - ptr()) + segment_size_ - 1) / segment_size_;
+  }
+
+  SegmentRange rangeFromHandles(size_t begin, size_t end) const {
+    return SegmentRange(ptr() + begin * segment_size_, (end - begin) * segment_size_);
+  }
+
+  void trimHandles() {
+    while (!handles_.empty() && !handles_.back()) {
+      handles_.pop_back();
+    }
+  }
+
+  int device_;
+  cudaStream_t stream_;
+  CUdeviceptr ptr_;
+  size_t segment_size_;
+  size_t max_handles_;
+  // handles_[i] backs the i-th page of the segment, if it is mapped
+  std::vector<c10::optional<CUmemGenericAllocationHandle>> handles_;
+};
+
+#else
+
+// CachingAllocatorConfig::expandable_segments() is always false here, so the
+// allocator never creates an expandable segment.
+class ExpandableSegment {
+ public:
+  ExpandableSegment(int /*device*/, cudaStream_t /*stream*/, size_t /*segment_size*/) {
+    TORCH_INTERNAL_ASSERT(false, "expandable segments are not supported");
+  }
+  SegmentRange map(SegmentRange range) {
+    return SegmentRange(range.ptr, 0);
+  }
+  SegmentRange unmap(SegmentRange range) {
+    return SegmentRange(range.ptr, 0);
+  }
+  char* ptr() const {
+    return nullptr;
+  }
+  size_t size() const {
+    return 0;
+  }
+};
+
+#endif
+
+/**
+ * Note [Stream-ordered frees]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Blocks are only reused by allocations on the stream they were allocated on,
+ * so work on that stream is ordered with respect to any earlier use of the
+ * memory. A block that was also used on other streams (recordStream) must not
+ * be reused before the work queued on them is done. By default, free records
+ * an event on each of these streams and the block is only returned to its pool
+ * once process_events has seen all of them complete, which costs an event
+ * query per outstanding event in every malloc and keeps the memory unusable
+ * until the host notices that the other streams are done.
+ *
+ * With stream_ordered_free:True, free instead makes the allocation stream wait
+ * for the work queued so far on the other streams (cudaStreamWaitEvent) and
+ * returns the block to its pool right away, like cudaFreeAsync orders a free
+ * on a stream. The next allocation on that stream can reuse the block
+ * immediately: the kernels using it are queued after the wait. The stream that
+ * is current when a block is freed counts as one of its uses, so a tensor that
+ * is freed while a side stream is current needs no recordStream. The cost is a
+ * dependency of the allocation stream on the other streams, even if the block
+ * isn't reused before they are done.
+ *
+ * While a CUDA graph may be captured, the current stream doesn't count as a
+ * use, and blocks with recorded uses are handled once no capture is underway,
+ * see Note [Cross-stream frees during capture].
+ */
+
+// Makes stream wait for the work queued so far on the streams of uses, see
+// Note [Stream-ordered frees]
+void wait_for_stream_uses(cudaStream_t stream, const stream_set& uses) {
+  for (const auto& use : uses) {
+    CUDAGuard device_guard(use.device_index());
+    cudaEvent_t event;
+    C10_CUDA_CHECK(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+    C10_CUDA_CHECK(cudaEventRecord(event, use.stream()));
+    C10_CUDA_CHECK(cudaStreamWaitEvent(stream, event, 0));
+    // the wait keeps the event alive until it completes
+    C10_CUDA_CHECK(cudaEventDestroy(event));
+  }
+}
+
 void update_stat(Stat& stat, int64_t amount) {
   stat.current += amount;
 
@@ -127,15 +585,20 @@ void update_stat_array(StatArray& stat_array, int64_t amount, const StatTypes& s
 struct Block;
 struct PrivatePool;
 typedef bool (*Comparison)(const Block*, const Block*);
+static bool BlockComparator(const Block* a, const Block* b);
+static bool BlockComparatorAddress(const Block* a, const Block* b);
 
 struct BlockPool {
   BlockPool(Comparison comparator,
             bool small,
             PrivatePool* private_pool=nullptr) :
     blocks(comparator),
+    unmapped(BlockComparatorAddress),
     is_small(small),
     owner_PrivatePool(private_pool) {}
   std::set<Block*, Comparison> blocks;
+  // unmapped blocks of expandable segments, see Note [Expandable segments]
+  std::set<Block*, Comparison> unmapped;
   const bool is_small;
   PrivatePool* owner_PrivatePool;
 };
@@ -151,19 +614,42 @@ struct Block {
   Block*        prev;        // prev block if split from a larger allocation
   Block*        next;        // next block if split from a larger allocation
   int           event_count; // number of outstanding CUDA events
+  bool          mapped;      // false for unmapped parts of expandable segments
+  ExpandableSegment* expandable_segment; // owning expandable segment, if any
+  size_t        requested_size; // size requested by client code, if allocated
+  uint64_t      freed_at;    // when the block was last returned to its pool,
+                             // see Note [Garbage collection of cached blocks]
+  // recorded while the history is recorded, see recordHistory
+  std::shared_ptr<GatheredContext> context_when_allocated;
+  // only set for the first block of a segment
+  std::shared_ptr<GatheredContext> context_when_segment_allocated;
 
   Block(int device, cudaStream_t stream, size_t size, BlockPool* pool, void* ptr) :
     device(device), stream(stream), stream_uses(), size(size), pool(pool),
-    ptr(ptr), allocated(0), prev(nullptr), next(nullptr), event_count(0) { }
+    ptr(ptr), allocated(0), prev(nullptr), next(nullptr), event_count(0),
+    mapped(true), expandable_segment(nullptr), requested_size(0), freed_at(0) { }
 
   // constructor for search key
   Block(int device, cudaStream_t stream, size_t size) :
     device(device), stream(stream), stream_uses(), size(size), pool(nullptr),
-    ptr(nullptr), allocated(0), prev(nullptr), next(nullptr), event_count(0) { }
+    ptr(nullptr), allocated(0), prev(nullptr), next(nullptr), event_count(0),
+    mapped(true), expandable_segment(nullptr), requested_size(0), freed_at(0) { }
 
   bool is_split() const {
     return (prev != nullptr) || (next != nullptr);
   }
+
+  // inserts this block into the block list between before and after
+  void splice(Block* before, Block* after) {
+    if (before) {
+      before->next = this;
+    }
+    prev = before;
+    if (after) {
+      after->prev = this;
+    }
+    next = after;
+  }
 };
 
 static bool BlockComparator(const Block* a, const Block* b)
@@ -177,6 +663,14 @@ static bool BlockComparator(const Block* a, const Block* b)
   return (uintptr_t)a->ptr < (uintptr_t)b->ptr;
 }
 
+static bool BlockComparatorAddress(const Block* a, const Block* b)
+{
+  if (a->stream != b->stream) {
+    return (uintptr_t)a->stream < (uintptr_t)b->stream;
+  }
+  return (uintptr_t)a->ptr < (uintptr_t)b->ptr;
+}
+
 static std::string format_size(uint64_t size) {
   std::ostringstream os;
   os.precision(2);
@@ -215,6 +709,8 @@ struct AllocParams {
   Block* block;
   StatTypes stat_types;
   cudaError_t err;
+  // context of the allocation, for the allocator history
+  std::shared_ptr<GatheredContext> context;
 };
 
 
@@ -283,6 +779,9 @@ class DeviceCachingAllocator {
   // whether they came from graph_pools or one of the BlockPools above.
   std::unordered_set<Block*> active_blocks;
 
+  // expandable segments, see Note [Expandable segments]
+  std::vector<std::unique_ptr<ExpandableSegment>> expandable_segments;
+
   // captures_underway tracks if a capture might be underway on any stream.
   // Most of the time it's zero, in which case malloc can avoid calling
   // cudaStreamGetCaptureInfo in the hot path.
@@ -297,6 +796,12 @@ class DeviceCachingAllocator {
 
   bool set_fraction = false;
 
+  // device memory, queried once, see memory_limit
+  size_t device_total_memory = 0;
+
+  // incremented by every free_block, see Note [Garbage collection of cached blocks]
+  uint64_t free_block_clock = 0;
+
   // Members specific to CUDA graphs
 
   // Private pools for CUDA graphs
@@ -310,6 +815,24 @@ class DeviceCachingAllocator {
   // in case we want multiple captures to share the same pool
   std::unordered_map<CaptureId_t, MempoolId_t> capture_to_pool_map;
 
+  // Blocks freed during a capture that were used on other streams,
+  // see Note [Cross-stream frees during capture]
+  std::vector<Block*> needs_events_deferred_until_no_capture;
+
+  // Members of the allocator history, see recordHistory
+
+  bool record_history = false;
+  // Read without the mutex, so that contexts are gathered outside of it
+  std::atomic<CreateContextFn> context_recorder{nullptr};
+  bool alloc_trace_record_context = false;
+  size_t alloc_trace_max_entries = 0;
+  // Ring buffer of the last alloc_trace_max_entries events, alloc_trace_next
+  // is the oldest entry once the buffer is full
+  std::vector<TraceEntry> alloc_trace;
+  size_t alloc_trace_next = 0;
+
+  std::vector<OutOfMemoryObserver> oom_observers;
+
  public:
 
   DeviceCachingAllocator() :
@@ -321,27 +844,45 @@ class DeviceCachingAllocator {
 
   Block* malloc(int device, size_t size, cudaStream_t stream)
   {
+    // The context recorder may be slow or take other locks, so call it
+    // before taking the allocator mutex
+    std::shared_ptr<GatheredContext> context = maybe_gather_context();
+
     std::unique_lock<std::recursive_mutex> lock(mutex);
 
-    // process outstanding cudaEvents
-    process_events();
+    // Processes the end of cross-stream uses of freed blocks, which queries
+    // events and is illegal during capture, see
+    // Note [Cross-stream frees during capture]
+    if (C10_LIKELY(captures_underway == 0)) {
+      process_events();
+    }
 
+    const size_t requested_size = size;
     size = round_size(size);
     auto& pool = get_pool(size, stream);
     const size_t alloc_size = get_allocation_size(size);
     AllocParams params(device, size, stream, &pool, alloc_size, stats);
     params.stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
     params.stat_types[static_cast<size_t>(get_stat_type_for_pool(pool))] = true;
+    params.context = context;
 
     bool block_found =
       // Search pool
       get_free_block(params)
       // Trigger callbacks and retry search
-      || (trigger_free_memory_callbacks(params) && get_free_block(params))
-      // Attempt allocate
-      || alloc_block(params, false)
-      // Free all non-split cached blocks and retry alloc.
-      || (free_cached_blocks() && alloc_block(params, true));
+      || (trigger_free_memory_callbacks(params) && get_free_block(params));
+
+    if (!block_found) {
+      // See Note [Garbage collection of cached blocks]
+      if (C10_UNLIKELY(CachingAllocatorConfig::garbage_collection_threshold() > 0.0)) {
+        garbage_collect_cached_blocks(alloc_size);
+      }
+      block_found =
+        // Attempt allocate
+        alloc_block(params, false)
+        // Free all non-split cached blocks and retry alloc.
+        || (free_cached_blocks() && alloc_block(params, true));
+    }
 
     if (!block_found) {
       // For any error code other than cudaErrorMemoryAllocation,
@@ -359,6 +900,21 @@ class DeviceCachingAllocator {
 
       stats.num_ooms += 1;
 
+      record_trace(TraceEntry::OOM, device_free, alloc_size, stream, context);
+      const int64_t allocated_bytes =
+          stats.allocated_bytes[static_cast<size_t>(StatType::AGGREGATE)].current;
+      const int64_t reserved_bytes =
+          stats.reserved_bytes[static_cast<size_t>(StatType::AGGREGATE)].current;
+      if (!oom_observers.empty()) {
+        // Observers may inspect the allocator, e.g. take a snapshot
+        const auto observers = oom_observers;
+        const size_t device_limit = set_fraction ? allowed_memory_maximum : device_total;
+        lock.unlock();
+        for (const auto& observer : observers) {
+          observer(device, alloc_size, device_limit, device_free);
+        }
+      }
+
       // "total capacity": total global memory on GPU
       // "allowed": memory is allowed to use, which set by fraction.
       // "already allocated": memory allocated by the program using the
@@ -381,11 +937,11 @@ class DeviceCachingAllocator {
         "CUDA out of memory. Tried to allocate ", format_size(alloc_size),
         " (GPU ", device, "; ",
         format_size(device_total), " total capacity; ",
-        format_size(stats.allocated_bytes[static_cast<size_t>(StatType::AGGREGATE)].current),
+        format_size(allocated_bytes),
         " already allocated; ",
         format_size(device_free), " free; ",
         allowed_info,
-        format_size(stats.reserved_bytes[static_cast<size_t>(StatType::AGGREGATE)].current),
+        format_size(reserved_bytes),
         " reserved in total by PyTorch)");
     }
 
@@ -400,6 +956,9 @@ class DeviceCachingAllocator {
       remaining = block;
 
       block = new Block(device, stream, size, &pool, block->ptr);
+      block->expandable_segment = remaining->expandable_segment;
+      block->context_when_segment_allocated =
+          std::move(remaining->context_when_segment_allocated);
       block->prev = remaining->prev;
       if (block->prev) {
         block->prev->next = block;
@@ -428,9 +987,14 @@ class DeviceCachingAllocator {
     }
 
     block->allocated = true;
+    block->requested_size = requested_size;
+    block->context_when_allocated = std::move(context);
     bool inserted = active_blocks.insert(block).second;
     TORCH_INTERNAL_ASSERT_DEBUG_ONLY(inserted);
 
+    record_trace(TraceEntry::ALLOC, reinterpret_cast<int64_t>(block->ptr),
+                 requested_size, stream, block->context_when_allocated);
+
     c10::reportMemoryUsageToProfiler(
         block, block->size, c10::Device(c10::DeviceType::CUDA, device));
 
@@ -444,9 +1008,13 @@ class DeviceCachingAllocator {
 
   void free(Block* block)
   {
+    std::shared_ptr<GatheredContext> context = maybe_gather_context();
+
     std::lock_guard<std::recursive_mutex> lock(mutex);
 
     block->allocated = false;
+    record_trace(TraceEntry::FREE_REQUESTED, reinterpret_cast<int64_t>(block->ptr),
+                 block->requested_size, block->stream, std::move(context));
 
     c10::reportMemoryUsageToProfiler(
         block, -block->size, c10::Device(c10::DeviceType::CUDA, block->device));
@@ -457,15 +1025,28 @@ class DeviceCachingAllocator {
     update_stat_array(stats.allocation, -1, {stat_types});
     update_stat_array(stats.allocated_bytes, -block->size, {stat_types});
 
-    if (!block->stream_uses.empty()) {
-      insert_events(block);
+    if (CachingAllocatorConfig::stream_ordered_free() && captures_underway == 0) {
+      // See Note [Stream-ordered frees]
+      const cuda::CUDAStream current = cuda::getCurrentCUDAStream(block->device);
+      if (current.stream() != block->stream) {
+        block->stream_uses.insert(current);
+      }
+    }
+
+    if (C10_UNLIKELY(captures_underway) && !block->stream_uses.empty()) {
+      // See Note [Cross-stream frees during capture]
+      needs_events_deferred_until_no_capture.push_back(block);
     } else {
-      free_block(block);
+      free_after_stream_uses(block);
     }
   }
 
   void* getBaseAllocation(Block* block, size_t* outSize) {
     std::lock_guard<std::recursive_mutex> lock(mutex);
+    TORCH_CHECK(!block->expandable_segment,
+                "Tensors allocated with expandable_segments:True cannot be shared "
+                "between processes, unset expandable_segments in PYTORCH_CUDA_ALLOC_CONF "
+                "of the process that allocates them");
     while (block->prev) {
       block = block->prev;
     }
@@ -572,7 +1153,9 @@ class DeviceCachingAllocator {
     const auto all_blocks = get_all_blocks();
 
     for (const Block* const head_block : all_blocks) {
-      if (head_block->prev != nullptr) {
+      // Each mapped range of an expandable segment is reported as a segment
+      if (!head_block->mapped ||
+          (head_block->prev != nullptr && head_block->prev->mapped)) {
         continue;
       }
       result.emplace_back();
@@ -580,15 +1163,21 @@ class DeviceCachingAllocator {
       segment_info.device = head_block->device;
       segment_info.address = reinterpret_cast<int64_t>(head_block->ptr);
       segment_info.is_large = (!head_block->pool->is_small);
+      segment_info.is_expandable = (head_block->expandable_segment != nullptr);
+      segment_info.stream = reinterpret_cast<int64_t>(head_block->stream);
+      segment_info.context_when_allocated = head_block->context_when_segment_allocated;
 
       const Block* block = head_block;
-      while (block != nullptr) {
+      while (block != nullptr && block->mapped) {
         segment_info.blocks.emplace_back();
         BlockInfo& block_info = segment_info.blocks.back();
 
         block_info.size = block->size;
+        block_info.requested_size = block->requested_size;
         block_info.allocated = block->allocated;
-        block_info.active = block->allocated || (block->event_count > 0);
+        block_info.context_when_allocated = block->context_when_allocated;
+        block_info.active = block->allocated || (block->event_count > 0) ||
+            !block->stream_uses.empty();
 
         segment_info.total_size += block_info.size;
         if (block_info.allocated) {
@@ -609,6 +1198,38 @@ class DeviceCachingAllocator {
     return result;
   }
 
+  /** Returns the recorded allocator events, oldest first **/
+  std::vector<TraceEntry> trace() const {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    std::vector<TraceEntry> result;
+    result.reserve(alloc_trace.size());
+    result.insert(result.end(), alloc_trace.begin() + alloc_trace_next, alloc_trace.end());
+    result.insert(result.end(), alloc_trace.begin(), alloc_trace.begin() + alloc_trace_next);
+    return result;
+  }
+
+  /** Starts or stops recording the allocator history, see recordHistory **/
+  void recordHistory(bool enabled, CreateContextFn recorder,
+                     size_t trace_max_entries, bool trace_record_context) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    record_history = enabled;
+    context_recorder.store(enabled ? recorder : nullptr);
+    if (enabled) {
+      // The trace of a disabled history is kept until the next enable, so it
+      // can still be inspected after recording stopped
+      alloc_trace_max_entries = trace_max_entries;
+      alloc_trace_record_context = trace_record_context;
+      alloc_trace.clear();
+      alloc_trace.shrink_to_fit();
+      alloc_trace_next = 0;
+    }
+  }
+
+  void attachOutOfMemoryObserver(OutOfMemoryObserver observer) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    oom_observers.emplace_back(std::move(observer));
+  }
+
   static size_t round_size(size_t size) {
     if (size < kMinBlockSize) {
       return kMinBlockSize;
@@ -674,6 +1295,26 @@ class DeviceCachingAllocator {
 
   // All private methods do not acquire the allocator mutex.
 
+  std::shared_ptr<GatheredContext> maybe_gather_context() {
+    const CreateContextFn fn = context_recorder.load();
+    return fn ? fn() : nullptr;
+  }
+
+  void record_trace(TraceEntry::Action action, int64_t addr, size_t size,
+                    cudaStream_t stream, std::shared_ptr<GatheredContext> context) {
+    if (!record_history || alloc_trace_max_entries == 0) {
+      return;
+    }
+    TraceEntry entry(action, addr, size, stream,
+                     alloc_trace_record_context ? std::move(context) : nullptr);
+    if (alloc_trace.size() < alloc_trace_max_entries) {
+      alloc_trace.emplace_back(std::move(entry));
+    } else {
+      alloc_trace[alloc_trace_next] = std::move(entry);
+      alloc_trace_next = (alloc_trace_next + 1) % alloc_trace_max_entries;
+    }
+  }
+
   std::vector<const Block*> get_all_blocks() const {
     std::vector<const Block*> blocks;
     blocks.insert(blocks.end(), small_blocks.blocks.begin(), small_blocks.blocks.end());
@@ -682,6 +1323,8 @@ class DeviceCachingAllocator {
       blocks.insert(blocks.end(), gp.second->small_blocks.blocks.begin(), gp.second->small_blocks.blocks.end());
       blocks.insert(blocks.end(), gp.second->large_blocks.blocks.begin(), gp.second->large_blocks.blocks.end());
     }
+    blocks.insert(blocks.end(), small_blocks.unmapped.begin(), small_blocks.unmapped.end());
+    blocks.insert(blocks.end(), large_blocks.unmapped.begin(), large_blocks.unmapped.end());
     blocks.insert(blocks.end(), active_blocks.begin(), active_blocks.end());
     return blocks;
   }
@@ -691,6 +1334,12 @@ class DeviceCachingAllocator {
   {
     TORCH_INTERNAL_ASSERT(!block->allocated && block->event_count == 0);
 
+    record_trace(TraceEntry::FREE_COMPLETED, reinterpret_cast<int64_t>(block->ptr),
+                 block->requested_size, block->stream,
+                 std::move(block->context_when_allocated));
+    block->context_when_allocated = nullptr;
+    block->requested_size = 0;
+
     size_t original_block_size = block->size;
 
     auto& pool = *block->pool;
@@ -706,6 +1355,7 @@ class DeviceCachingAllocator {
       }
     }
 
+    block->freed_at = ++free_block_clock;
     active_blocks.erase(block);
     // Makes sure the Block* isn't already present in the pool we're freeing it back into.
     bool inserted = pool.blocks.insert(block).second;
@@ -728,7 +1378,8 @@ class DeviceCachingAllocator {
   /** combine previously split blocks. returns the size of the subsumed block, or 0 on failure. */
   size_t try_merge_blocks(Block* dst, Block* src, BlockPool& pool)
   {
-    if (!src || src->allocated || src->event_count > 0) {
+    if (!src || src->allocated || src->event_count > 0 ||
+        !src->stream_uses.empty() || src->mapped != dst->mapped) {
       return 0;
     }
 
@@ -736,6 +1387,8 @@ class DeviceCachingAllocator {
 
     if (dst->prev == src) {
       dst->ptr = src->ptr;
+      dst->context_when_segment_allocated =
+          std::move(src->context_when_segment_allocated);
       dst->prev = src->prev;
       if (dst->prev) {
         dst->prev->next = dst;
@@ -749,7 +1402,11 @@ class DeviceCachingAllocator {
 
     const size_t subsumed_size = src->size;
     dst->size += subsumed_size;
-    pool.blocks.erase(src);
+    if (src->mapped) {
+      pool.blocks.erase(src);
+    } else {
+      pool.unmapped.erase(src);
+    }
     delete src;
 
     return subsumed_size;
@@ -837,6 +1494,12 @@ class DeviceCachingAllocator {
       stats.num_alloc_retries += 1;
     }
 
+    if (CachingAllocatorConfig::expandable_segments() && !p.pool->owner_PrivatePool) {
+      p.block = try_allocate_expandable_block(p.device(), p.stream(), p.pool, p.size(), p.context);
+      p.err = p.block ? cudaSuccess : cudaErrorMemoryAllocation;
+      return p.block != nullptr;
+    }
+
     if (set_fraction && total_allocated_memory + size > allowed_memory_maximum) {
       p.err = cudaErrorMemoryAllocation;
       return false;
@@ -866,8 +1529,11 @@ class DeviceCachingAllocator {
 
     total_allocated_memory += size;
     p.block = new Block(p.device(), p.stream(), size, p.pool, (char*)ptr);
+    p.block->context_when_segment_allocated = p.context;
     update_stat_array(stats.segment, 1, p.stat_types);
     update_stat_array(stats.reserved_bytes, size, p.stat_types);
+    record_trace(TraceEntry::SEGMENT_ALLOC, reinterpret_cast<int64_t>(ptr), size,
+                 p.stream(), p.context);
 
     // p.block came from new, not cudaMalloc. It should not be nullptr here.
     TORCH_INTERNAL_ASSERT(p.block != nullptr && p.block->ptr != nullptr);
@@ -903,33 +1569,337 @@ class DeviceCachingAllocator {
 
   void free_blocks(BlockPool& pool)
   {
+    // Unmaps the free pages of expandable segments
+    std::vector<Block*> to_unmap;
+    for (Block* block : pool.blocks) {
+      if (block->expandable_segment) {
+        to_unmap.push_back(block);
+      }
+    }
+    for (Block* block : to_unmap) {
+      unmap_block(block);
+    }
+    release_expandable_segments(pool);
+
     // Frees all non-split blocks
     auto it = pool.blocks.begin();
     while (it != pool.blocks.end()) {
       Block* block = *it;
-      if (!block->prev && !block->next) {
-        C10_CUDA_CHECK(cudaFree((void*)block->ptr));
-        total_allocated_memory -= block->size;
-
-        if (pool.owner_PrivatePool) {
-          // The cudaFreed block belonged to a CUDA graph's PrivatePool.
-          TORCH_INTERNAL_ASSERT(pool.owner_PrivatePool->cudaMalloc_count > 0);
-          pool.owner_PrivatePool->cudaMalloc_count--;
-        }
+      ++it;
+      if (!block->expandable_segment && !block->prev && !block->next) {
+        release_block(block);
+      }
+    }
+  }
 
-        StatTypes stat_types;
-        stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
-        stat_types[static_cast<size_t>(get_stat_type_for_pool(pool))] = true;
-        update_stat_array(stats.segment, -1, stat_types);
-        update_stat_array(stats.reserved_bytes, -block->size, stat_types);
+  // cudaFrees the segment of a non-split cached block
+  void release_block(Block* block)
+  {
+    TORCH_INTERNAL_ASSERT(!block->expandable_segment && !block->is_split());
+    BlockPool& pool = *block->pool;
+    C10_CUDA_CHECK(cudaFree((void*)block->ptr));
+    total_allocated_memory -= block->size;
+    record_trace(TraceEntry::SEGMENT_FREE, reinterpret_cast<int64_t>(block->ptr),
+                 block->size, block->stream, nullptr);
+
+    if (pool.owner_PrivatePool) {
+      // The cudaFreed block belonged to a CUDA graph's PrivatePool.
+      TORCH_INTERNAL_ASSERT(pool.owner_PrivatePool->cudaMalloc_count > 0);
+      pool.owner_PrivatePool->cudaMalloc_count--;
+    }
 
-        auto cur = it;
-        ++it;
-        pool.blocks.erase(cur);
-        delete block;
+    StatTypes stat_types;
+    stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
+    stat_types[static_cast<size_t>(get_stat_type_for_pool(pool))] = true;
+    update_stat_array(stats.segment, -1, stat_types);
+    update_stat_array(stats.reserved_bytes, -block->size, stat_types);
+
+    pool.blocks.erase(block);
+    delete block;
+  }
+
+  // Memory that garbage_collection_threshold is a fraction of
+  size_t memory_limit()
+  {
+    if (set_fraction) {
+      return allowed_memory_maximum;
+    }
+    if (device_total_memory == 0) {
+      size_t device_free;
+      C10_CUDA_CHECK(cudaMemGetInfo(&device_free, &device_total_memory));
+    }
+    return device_total_memory;
+  }
+
+  // Releases the least recently freed cached segments of the large pool
+  // until alloc_size more bytes fit below the garbage collection threshold,
+  // see Note [Garbage collection of cached blocks]
+  void garbage_collect_cached_blocks(size_t alloc_size)
+  {
+    if (captures_underway) {
+      return;
+    }
+    const size_t gc_limit = static_cast<size_t>(
+        CachingAllocatorConfig::garbage_collection_threshold() * memory_limit());
+    if (total_allocated_memory + alloc_size <= gc_limit) {
+      return;
+    }
+    const size_t target = total_allocated_memory + alloc_size - gc_limit;
+
+    std::vector<Block*> candidates;
+    for (Block* block : large_blocks.blocks) {
+      if (block->expandable_segment || !block->is_split()) {
+        candidates.push_back(block);
+      }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Block* a, const Block* b) {
+      return a->freed_at < b->freed_at;
+    });
+
+    const size_t initial_total_allocated_memory = total_allocated_memory;
+    for (Block* block : candidates) {
+      if (initial_total_allocated_memory - total_allocated_memory >= target) {
+        break;
+      }
+      if (block->expandable_segment) {
+        // Unmapping a block doesn't merge it with other mapped blocks, so
+        // the remaining candidates stay valid
+        unmap_block(block);
       } else {
+        release_block(block);
+      }
+    }
+    release_expandable_segments(large_blocks);
+  }
+
+  // See Note [Expandable segments]
+
+  // Returns a free block of at least size bytes carved out of an expandable
+  // segment of stream, mapping memory as needed, or nullptr if the device is
+  // out of memory. The block is removed from the pool.
+  Block* try_allocate_expandable_block(
+      int device, cudaStream_t stream, BlockPool* pool, size_t size,
+      const std::shared_ptr<GatheredContext>& context) {
+    Block* candidate = find_expandable_block(device, stream, pool, size, context);
+    // candidate starts a run of free and unmapped blocks with room for size
+    // bytes, which is one of
+    //   unmapped -> null
+    //   unmapped -> free -> ...
+    //   free -> unmapped -> ...
+    if (!candidate->mapped &&
+        !map_block(candidate, std::min(candidate->size, size), context)) {
+      return nullptr;
+    }
+    TORCH_INTERNAL_ASSERT(candidate->mapped);
+
+    while (candidate->size < size) {
+      // candidate is followed by an unmapped block, mapping it merges the
+      // two
+      const size_t remaining = size - candidate->size;
+      Block* new_candidate = candidate->next;
+      TORCH_INTERNAL_ASSERT(new_candidate && !new_candidate->mapped);
+      if (!map_block(new_candidate, std::min(remaining, new_candidate->size), context)) {
+        return nullptr;
+      }
+      candidate = new_candidate;
+    }
+    pool->blocks.erase(candidate);
+    return candidate;
+  }
+
+  Block* find_expandable_block(
+      int device, cudaStream_t stream, BlockPool* pool, size_t size,
+      const std::shared_ptr<GatheredContext>& context) {
+    auto allocatable = [](const Block* b) {
+      return b && !b->allocated && b->event_count == 0 && b->stream_uses.empty();
+    };
+    auto has_available_address_space = [&](const Block* b) {
+      size_t bytes = 0;
+      while (bytes < size && allocatable(b)) {
+        bytes += b->size;
+        b = b->next;
+      }
+      return bytes >= size;
+    };
+
+    Block key(device, stream, 0);
+    for (auto it = pool->unmapped.lower_bound(&key);
+         it != pool->unmapped.end() && (*it)->stream == stream;
+         ++it) {
+      Block* c = *it;
+      // A free block right before the unmapped one can be used as well
+      if (allocatable(c->prev)) {
+        c = c->prev;
+      }
+      if (has_available_address_space(c)) {
+        return c;
+      }
+    }
+
+    const size_t segment_size = pool->is_small ? kSmallBuffer : kLargeBuffer;
+    expandable_segments.emplace_back(new ExpandableSegment(device, stream, segment_size));
+    ExpandableSegment* segment = expandable_segments.back().get();
+
+    Block* candidate = new Block(device, stream, segment->size(), pool, segment->ptr());
+    candidate->mapped = false;
+    candidate->expandable_segment = segment;
+    candidate->context_when_segment_allocated = context;
+    pool->unmapped.insert(candidate);
+
+    StatTypes stat_types;
+    stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
+    stat_types[static_cast<size_t>(get_stat_type_for_pool(*pool))] = true;
+    update_stat_array(stats.segment, 1, stat_types);
+    return candidate;
+  }
+
+  // Maps at least size bytes at the start of the unmapped block to_map and
+  // merges them with the free neighbours of to_map
+  bool map_block(Block* to_map, size_t size, const std::shared_ptr<GatheredContext>& context) {
+    TORCH_INTERNAL_ASSERT(!to_map->mapped && size <= to_map->size);
+    if (set_fraction && total_allocated_memory + size > allowed_memory_maximum) {
+      return false;
+    }
+    const SegmentRange mapped_range =
+        to_map->expandable_segment->map(SegmentRange(to_map->ptr, size));
+    if (mapped_range.size == 0) {
+      return false;
+    }
+    TORCH_INTERNAL_ASSERT(mapped_range.ptr == to_map->ptr && mapped_range.size >= size);
+
+    BlockPool& pool = *to_map->pool;
+    pool.unmapped.erase(to_map);
+    to_map->mapped = true;
+
+    if (mapped_range.size < to_map->size) {
+      // to_map -> remaining -> to_map->next
+      Block* remaining = new Block(
+          to_map->device, to_map->stream, to_map->size - mapped_range.size,
+          &pool, static_cast<char*>(to_map->ptr) + mapped_range.size);
+      remaining->mapped = false;
+      remaining->expandable_segment = to_map->expandable_segment;
+      remaining->splice(to_map, to_map->next);
+      pool.unmapped.insert(remaining);
+      to_map->size = mapped_range.size;
+    }
+
+    StatTypes stat_types;
+    stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
+    stat_types[static_cast<size_t>(get_stat_type_for_pool(pool))] = true;
+
+    // The merged neighbours were inactive split blocks, the merged block is
+    // one if it doesn't span the whole segment.
+    int64_t net_change_inactive_split_blocks = 0;
+    int64_t net_change_inactive_split_size = 0;
+    const std::array<Block*, 2> merge_candidates = {to_map->prev, to_map->next};
+    for (Block* merge_candidate : merge_candidates) {
+      const int64_t subsumed_size = try_merge_blocks(to_map, merge_candidate, pool);
+      if (subsumed_size > 0) {
+        net_change_inactive_split_blocks -= 1;
+        net_change_inactive_split_size -= subsumed_size;
+      }
+    }
+    if (to_map->is_split()) {
+      net_change_inactive_split_blocks += 1;
+      net_change_inactive_split_size += to_map->size;
+    }
+    pool.blocks.insert(to_map);
+
+    total_allocated_memory += mapped_range.size;
+    update_stat_array(stats.reserved_bytes, mapped_range.size, stat_types);
+    record_trace(TraceEntry::SEGMENT_MAP, reinterpret_cast<int64_t>(mapped_range.ptr),
+                 mapped_range.size, to_map->stream, context);
+    update_stat_array(stats.inactive_split, net_change_inactive_split_blocks, stat_types);
+    update_stat_array(stats.inactive_split_bytes, net_change_inactive_split_size, stat_types);
+    return true;
+  }
+
+  // Unmaps the pages completely covered by the free block and merges them
+  // with the unmapped neighbours of block
+  void unmap_block(Block* block) {
+    const SegmentRange unmapped =
+        block->expandable_segment->unmap(SegmentRange(block->ptr, block->size));
+    if (unmapped.size == 0) {
+      return;
+    }
+    BlockPool& pool = *block->pool;
+    pool.blocks.erase(block);
+
+    StatTypes stat_types;
+    stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
+    stat_types[static_cast<size_t>(get_stat_type_for_pool(pool))] = true;
+
+    int64_t net_change_inactive_split_blocks = 0;
+    int64_t net_change_inactive_split_size = 0;
+    if (block->is_split()) {
+      net_change_inactive_split_blocks -= 1;
+      net_change_inactive_split_size -= block->size;
+    }
+
+    const size_t before_size = unmapped.ptr - static_cast<char*>(block->ptr);
+    if (before_size > 0) {
+      // block->prev -> before_free -> block
+      Block* before_free = new Block(block->device, block->stream, before_size, &pool, block->ptr);
+      before_free->expandable_segment = block->expandable_segment;
+      before_free->context_when_segment_allocated =
+          std::move(block->context_when_segment_allocated);
+      before_free->splice(block->prev, block);
+      pool.blocks.insert(before_free);
+      net_change_inactive_split_blocks += 1;
+      net_change_inactive_split_size += before_size;
+    }
+
+    const size_t after_size = block->size - (before_size + unmapped.size);
+    if (after_size > 0) {
+      // block -> after_free -> block->next
+      Block* after_free = new Block(
+          block->device, block->stream, after_size, &pool, unmapped.ptr + unmapped.size);
+      after_free->expandable_segment = block->expandable_segment;
+      after_free->splice(block, block->next);
+      pool.blocks.insert(after_free);
+      net_change_inactive_split_blocks += 1;
+      net_change_inactive_split_size += after_size;
+    }
+
+    block->ptr = unmapped.ptr;
+    block->size = unmapped.size;
+    block->mapped = false;
+    try_merge_blocks(block, block->prev, pool);
+    try_merge_blocks(block, block->next, pool);
+    pool.unmapped.insert(block);
+
+    total_allocated_memory -= unmapped.size;
+    update_stat_array(stats.reserved_bytes, -unmapped.size, stat_types);
+    record_trace(TraceEntry::SEGMENT_UNMAP, reinterpret_cast<int64_t>(unmapped.ptr),
+                 unmapped.size, block->stream, nullptr);
+    update_stat_array(stats.inactive_split, net_change_inactive_split_blocks, stat_types);
+    update_stat_array(stats.inactive_split_bytes, net_change_inactive_split_size, stat_types);
+  }
+
+  // Releases the expandable segments of pool that are completely unmapped
+  void release_expandable_segments(BlockPool& pool) {
+    auto it = pool.unmapped.begin();
+    while (it != pool.unmapped.end()) {
+      Block* block = *it;
+      if (block->prev || block->next) {
         ++it;
+        continue;
       }
+      ExpandableSegment* segment = block->expandable_segment;
+      TORCH_INTERNAL_ASSERT(block->size == segment->size());
+      auto segment_it = std::find_if(
+          expandable_segments.begin(), expandable_segments.end(),
+          [&](const std::unique_ptr<ExpandableSegment>& s) { return s.get() == segment; });
+      TORCH_INTERNAL_ASSERT(segment_it != expandable_segments.end());
+      expandable_segments.erase(segment_it);
+
+      StatTypes stat_types;
+      stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
+      stat_types[static_cast<size_t>(get_stat_type_for_pool(pool))] = true;
+      update_stat_array(stats.segment, -1, stat_types);
+
+      it = pool.unmapped.erase(it);
+      delete block;
     }
   }
 
@@ -946,6 +1916,10 @@ class DeviceCachingAllocator {
   void synchronize_and_free_events() {
     // Synchronize on outstanding events and then free associated blocks.
 
+    if (captures_underway == 0) {
+      process_frees_deferred_until_no_capture();
+    }
+
     for (auto& e : cuda_events) {
       cudaEvent_t event = e.first;
       Block* block = e.second;
@@ -962,6 +1936,30 @@ class DeviceCachingAllocator {
     cuda_events.clear();
   }
 
+  // Returns a freed block to its pool once its uses on other streams are
+  // done, right away with stream_ordered_free, see
+  // Note [Stream-ordered frees]
+  void free_after_stream_uses(Block* block)
+  {
+    if (CachingAllocatorConfig::stream_ordered_free()) {
+      wait_for_stream_uses(block->stream, block->stream_uses);
+      block->stream_uses.clear();
+      free_block(block);
+    } else if (!block->stream_uses.empty()) {
+      insert_events(block);
+    } else {
+      free_block(block);
+    }
+  }
+
+  void process_frees_deferred_until_no_capture()
+  {
+    for (Block* block : needs_events_deferred_until_no_capture) {
+      free_after_stream_uses(block);
+    }
+    needs_events_deferred_until_no_capture.clear();
+  }
+
   void insert_events(Block* block)
   {
     int prev_device;
@@ -984,6 +1982,9 @@ class DeviceCachingAllocator {
 
   void process_events()
   {
+    TORCH_INTERNAL_ASSERT(captures_underway == 0);
+    process_frees_deferred_until_no_capture();
+
     // Process outstanding cudaEvents. Events that are completed are removed
     // from the queue, and the 'event_count' for the corresponding allocation
     // is decremented. Stops at the first event which has not been completed.
@@ -1152,12 +2153,13 @@ class THCCachingAllocator {
     device_allocator[block->device]->recordStream(block, stream);
   }
 
-  std::vector<SegmentInfo> snapshot() {
-    std::vector<SegmentInfo> result;
+  SnapshotInfo snapshot() {
+    SnapshotInfo result;
     int count = device_allocator.size();
     for (int i = 0; i < count; i++) {
       auto snap = device_allocator[i]->snapshot();
-      result.insert(result.end(), snap.begin(), snap.end());
+      result.segments.insert(result.segments.end(), snap.begin(), snap.end());
+      result.device_traces.emplace_back(device_allocator[i]->trace());
     }
 
     return result;
@@ -1166,6 +2168,329 @@ class THCCachingAllocator {
 
 THCCachingAllocator caching_allocator;
 
+/**
+ * Note [cudaMallocAsync backend]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * With PYTORCH_CUDA_ALLOC_CONF=backend:cudaMallocAsync, device memory comes
+ * from the default memory pool of the CUDA driver (cudaMallocAsync and
+ * cudaFreeAsync) instead of from DeviceCachingAllocator. The driver keeps
+ * freed memory in the pool (its release threshold is raised so that nothing is
+ * returned at synchronizations) and reuses it in stream order itself,
+ * including for other streams once they have synchronized with the stream of
+ * the free. Frees are ordered like in Note [Stream-ordered frees]: the memory
+ * is freed on its allocation stream after waiting for the streams it was used
+ * on, which are the recorded streams and the stream current at the free.
+ *
+ * MallocAsyncAllocator only tracks the live allocations, for recordStream and
+ * the statistics. Allocation statistics are kept for the small and large
+ * sizes as usual, reserved bytes are those of the driver pool, and there are
+ * no segments. Tensors allocated this way cannot be shared through CUDA IPC,
+ * CUDA graphs cannot be captured, and the allocator history is not recorded.
+ * The backend needs CUDA 11.4 and is not available on ROCm.
+ */
+#ifdef C10_CUDA_MALLOC_ASYNC_SUPPORTED
+
+class MallocAsyncAllocator {
+
+ private:
+
+  struct Allocation {
+    int device;
+    cudaStream_t stream;
+    size_t size;
+    stream_set stream_uses;
+  };
+
+  struct DeviceState {
+    cudaMemPool_t pool = nullptr;
+    DeviceStats stats;
+    size_t allowed_memory_maximum = 0;
+    bool set_fraction = false;
+  };
+
+  std::mutex mutex;
+
+  // live allocations by device pointer
+  std::unordered_map<void*, Allocation> allocations;
+
+  std::vector<DeviceState> devices;
+
+  std::vector<OutOfMemoryObserver> oom_observers;
+
+  static StatTypes get_stat_types(size_t size) {
+    StatTypes stat_types;
+    stat_types[static_cast<size_t>(StatType::AGGREGATE)] = true;
+    stat_types[static_cast<size_t>(
+        size <= kSmallSize ? StatType::SMALL_POOL : StatType::LARGE_POOL)] = true;
+    return stat_types;
+  }
+
+  // mutex must be held
+  cudaMemPool_t get_pool(int device) {
+    DeviceState& state = devices[device];
+    if (state.pool == nullptr) {
+      C10_CUDA_CHECK(cudaDeviceGetDefaultMemPool(&state.pool, device));
+      uint64_t threshold = std::numeric_limits<uint64_t>::max();
+      C10_CUDA_CHECK(cudaMemPoolSetAttribute(
+          state.pool, cudaMemPoolAttrReleaseThreshold, &threshold));
+    }
+    return state.pool;
+  }
+
+  void check_device(int device) const {
+    TORCH_INTERNAL_ASSERT(
+        0 <= device && device < static_cast<int>(devices.size()),
+        "Allocator not initialized for device ",
+        device,
+        ": did you call init?");
+  }
+
+ public:
+
+  void init(int device_count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (static_cast<int>(devices.size()) < device_count) {
+      devices.resize(device_count);
+    }
+  }
+
+  void malloc(void** devPtr, int device, size_t size, cudaStream_t stream) {
+    check_device(device);
+    CUDAGuard device_guard(device);
+
+    cudaMemPool_t pool;
+    size_t allocated_bytes;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      pool = get_pool(device);
+      DeviceState& state = devices[device];
+      allocated_bytes = state.stats.allocated_bytes[
+          static_cast<size_t>(StatType::AGGREGATE)].current;
+      if (state.set_fraction &&
+          allocated_bytes + size > state.allowed_memory_maximum) {
+        state.stats.num_ooms += 1;
+        TORCH_CHECK_WITH(CUDAOutOfMemoryError, false,
+          "CUDA out of memory. Tried to allocate ", format_size(size),
+          " (GPU ", device, "; ",
+          format_size(state.allowed_memory_maximum), " allowed; ",
+          format_size(allocated_bytes), " already allocated)");
+      }
+    }
+
+    cudaError_t err = cudaMallocAsync(devPtr, size, stream);
+    if (err == cudaErrorMemoryAllocation) {
+      // Return the memory cached in the pool to the driver and retry, like
+      // the native backend frees its cached blocks
+      cudaGetLastError();
+      C10_CUDA_CHECK(cudaDeviceSynchronize());
+      C10_CUDA_CHECK(cudaMemPoolTrimTo(pool, 0));
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        devices[device].stats.num_alloc_retries += 1;
+      }
+      err = cudaMallocAsync(devPtr, size, stream);
+    }
+    if (err == cudaErrorMemoryAllocation) {
+      cudaGetLastError();
+      size_t device_free;
+      size_t device_total;
+      C10_CUDA_CHECK(cudaMemGetInfo(&device_free, &device_total));
+      std::vector<OutOfMemoryObserver> observers;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        devices[device].stats.num_ooms += 1;
+        observers = oom_observers;
+      }
+      for (const auto& observer : observers) {
+        observer(device, size, device_total, device_free);
+      }
+      TORCH_CHECK_WITH(CUDAOutOfMemoryError, false,
+        "CUDA out of memory. Tried to allocate ", format_size(size),
+        " (GPU ", device, "; ",
+        format_size(device_total), " total capacity; ",
+        format_size(allocated_bytes), " already allocated; ",
+        format_size(device_free), " free; backend:cudaMallocAsync)");
+    }
+    C10_CUDA_CHECK(err);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    allocations[*devPtr] = Allocation{device, stream, size, stream_set()};
+    DeviceStats& stats = devices[device].stats;
+    const StatTypes stat_types = get_stat_types(size);
+    update_stat_array(stats.allocation, 1, stat_types);
+    update_stat_array(stats.allocated_bytes, size, stat_types);
+    update_stat_array(stats.active, 1, stat_types);
+    update_stat_array(stats.active_bytes, size, stat_types);
+    c10::reportMemoryUsageToProfiler(
+        *devPtr, size, c10::Device(c10::DeviceType::CUDA, device));
+  }
+
+  void free(void* ptr) {
+    if (!ptr) {
+      return;
+    }
+    Allocation allocation;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = allocations.find(ptr);
+      TORCH_CHECK(it != allocations.end(), "invalid device pointer: ", ptr);
+      allocation = std::move(it->second);
+      allocations.erase(it);
+      DeviceStats& stats = devices[allocation.device].stats;
+      const StatTypes stat_types = get_stat_types(allocation.size);
+      update_stat_array(stats.allocation, -1, stat_types);
+      update_stat_array(stats.allocated_bytes, -allocation.size, stat_types);
+      update_stat_array(stats.active, -1, stat_types);
+      update_stat_array(stats.active_bytes, -allocation.size, stat_types);
+    }
+    c10::reportMemoryUsageToProfiler(
+        ptr, -allocation.size, c10::Device(c10::DeviceType::CUDA, allocation.device));
+
+    CUDAGuard device_guard(allocation.device);
+    const cuda::CUDAStream current = cuda::getCurrentCUDAStream(allocation.device);
+    if (current.stream() != allocation.stream) {
+      allocation.stream_uses.insert(current);
+    }
+    wait_for_stream_uses(allocation.stream, allocation.stream_uses);
+    C10_CUDA_CHECK(cudaFreeAsync(ptr, allocation.stream));
+  }
+
+  void recordStream(void* ptr, cuda::CUDAStream stream) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = allocations.find(ptr);
+    TORCH_INTERNAL_ASSERT(it != allocations.end(), "No allocation can be found");
+    if (stream.stream() != it->second.stream) {
+      it->second.stream_uses.insert(stream);
+    }
+  }
+
+  void setMemoryFraction(double fraction, int device) {
+    check_device(device);
+    CUDAGuard device_guard(device);
+    size_t device_free;
+    size_t device_total;
+    C10_CUDA_CHECK(cudaMemGetInfo(&device_free, &device_total));
+    std::lock_guard<std::mutex> lock(mutex);
+    devices[device].allowed_memory_maximum = static_cast<size_t>(fraction * device_total);
+    devices[device].set_fraction = true;
+  }
+
+  void emptyCache() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto device : c10::irange(devices.size())) {
+      if (devices[device].pool != nullptr) {
+        CUDAGuard device_guard(device);
+        // memory freed by pending frees can only be trimmed once they ran
+        C10_CUDA_CHECK(cudaDeviceSynchronize());
+        C10_CUDA_CHECK(cudaMemPoolTrimTo(devices[device].pool, 0));
+      }
+    }
+  }
+
+  void cacheInfo(int device, size_t* total, size_t* largest) {
+    check_device(device);
+    CUDAGuard device_guard(device);
+    std::lock_guard<std::mutex> lock(mutex);
+    cudaMemPool_t pool = get_pool(device);
+    uint64_t reserved = 0;
+    uint64_t used = 0;
+    C10_CUDA_CHECK(cudaMemPoolGetAttribute(pool, cudaMemPoolAttrReservedMemCurrent, &reserved));
+    C10_CUDA_CHECK(cudaMemPoolGetAttribute(pool, cudaMemPoolAttrUsedMemCurrent, &used));
+    *total += reserved - used;
+    if (*largest == 0) {
+      // the pool grows as needed, so free memory is as good a guess as the
+      // native backend's
+      size_t tmp_bytes;
+      C10_CUDA_CHECK(cudaMemGetInfo(largest, &tmp_bytes));
+    }
+  }
+
+  DeviceStats getStats(int device) {
+    check_device(device);
+    std::lock_guard<std::mutex> lock(mutex);
+    DeviceStats stats = devices[device].stats;
+    if (devices[device].pool != nullptr) {
+      uint64_t reserved = 0;
+      uint64_t peak = 0;
+      C10_CUDA_CHECK(cudaMemPoolGetAttribute(
+          devices[device].pool, cudaMemPoolAttrReservedMemCurrent, &reserved));
+      C10_CUDA_CHECK(cudaMemPoolGetAttribute(
+          devices[device].pool, cudaMemPoolAttrReservedMemHigh, &peak));
+      Stat& reserved_bytes = stats.reserved_bytes[static_cast<size_t>(StatType::AGGREGATE)];
+      reserved_bytes.current = reserved;
+      reserved_bytes.peak = peak;
+    }
+    return stats;
+  }
+
+  void resetAccumulatedStats(int device) {
+    check_device(device);
+    std::lock_guard<std::mutex> lock(mutex);
+    DeviceStats& stats = devices[device].stats;
+    for (size_t statType = 0; statType < static_cast<size_t>(StatType::NUM_TYPES); ++statType) {
+      reset_accumulated_stat(stats.allocation[statType]);
+      reset_accumulated_stat(stats.allocated_bytes[statType]);
+      reset_accumulated_stat(stats.active[statType]);
+      reset_accumulated_stat(stats.active_bytes[statType]);
+    }
+    stats.num_alloc_retries = 0;
+    stats.num_ooms = 0;
+  }
+
+  void resetPeakStats(int device) {
+    check_device(device);
+    std::lock_guard<std::mutex> lock(mutex);
+    DeviceStats& stats = devices[device].stats;
+    for (size_t statType = 0; statType < static_cast<size_t>(StatType::NUM_TYPES); ++statType) {
+      reset_peak_stat(stats.allocation[statType]);
+      reset_peak_stat(stats.allocated_bytes[statType]);
+      reset_peak_stat(stats.active[statType]);
+      reset_peak_stat(stats.active_bytes[statType]);
+    }
+    if (devices[device].pool != nullptr) {
+      // the driver only allows resetting the high watermark to zero, which
+      // sets it to the current value
+      uint64_t zero = 0;
+      C10_CUDA_CHECK(cudaMemPoolSetAttribute(
+          devices[device].pool, cudaMemPoolAttrReservedMemHigh, &zero));
+    }
+  }
+
+  void attachOutOfMemoryObserver(OutOfMemoryObserver observer) {
+    std::lock_guard<std::mutex> lock(mutex);
+    oom_observers.emplace_back(std::move(observer));
+  }
+};
+
+#else
+
+// backend:cudaMallocAsync is rejected by CachingAllocatorConfig, so none of
+// this is ever called
+class MallocAsyncAllocator {
+ public:
+  void init(int device_count) {}
+  void malloc(void** devPtr, int device, size_t size, cudaStream_t stream) {
+    TORCH_INTERNAL_ASSERT(false, "cudaMallocAsync backend is not supported");
+  }
+  void free(void* ptr) {
+    TORCH_INTERNAL_ASSERT(false, "cudaMallocAsync backend is not supported");
+  }
+  void recordStream(void* ptr, cuda::CUDAStream stream) {}
+  void setMemoryFraction(double fraction, int device) {}
+  void emptyCache() {}
+  void cacheInfo(int device, size_t* total, size_t* largest) {}
+  DeviceStats getStats(int device) {
+    return DeviceStats();
+  }
+  void resetAccumulatedStats(int device) {}
+  void resetPeakStats(int device) {}
+  void attachOutOfMemoryObserver(OutOfMemoryObserver observer) {}
+};
+
+#endif
+
+MallocAsyncAllocator malloc_async_allocator;
+
 // Returns whether to force all allocations to bypass the caching allocator and
 // go straight to cudaMalloc.  This setting is useful when debugging GPU memory
 // errors, since the caching allocator foils cuda-memcheck.
@@ -1194,7 +2519,11 @@ struct CudaCachingAllocator : public Allocator {
       return {r, r, &uncached_delete, Device(DeviceType::CUDA, device)};
     }
     if (size != 0) {
-      caching_allocator.malloc(&r, device, size, cuda::getCurrentCUDAStream(device));
+      if (CachingAllocatorConfig::use_malloc_async()) {
+        malloc_async_allocator.malloc(&r, device, size, cuda::getCurrentCUDAStream(device));
+      } else {
+        caching_allocator.malloc(&r, device, size, cuda::getCurrentCUDAStream(device));
+      }
     }
     return {r, r, &raw_delete, Device(DeviceType::CUDA, device)};
   }
@@ -1216,30 +2545,64 @@ Allocator* get(void)
 
 void init(int device_count) {
   caching_allocator.init(device_count);
+  if (CachingAllocatorConfig::use_malloc_async()) {
+    malloc_async_allocator.init(device_count);
+  }
 }
 
 void setMemoryFraction(double fraction, int device) {
+  if (CachingAllocatorConfig::use_malloc_async()) {
+    TORCH_INTERNAL_ASSERT(
+        0 <= fraction  && fraction <= 1,
+        "invalid fraction:",
+        fraction,
+        ". Please set within (0, 1).");
+    malloc_async_allocator.setMemoryFraction(fraction, device);
+    return;
+  }
   caching_allocator.setMemoryFraction(fraction, device);
 }
 
 void emptyCache(void) {
+  if (CachingAllocatorConfig::use_malloc_async()) {
+    malloc_async_allocator.emptyCache();
+    return;
+  }
   caching_allocator.emptyCache();
 }
 
 void cacheInfo(int dev_id, size_t* cachedAndFree, size_t* largestBlock) {
+  if (CachingAllocatorConfig::use_malloc_async()) {
+    malloc_async_allocator.cacheInfo(dev_id, cachedAndFree, largestBlock);
+    return;
+  }
   caching_allocator.device_allocator[dev_id]->cacheInfo(cachedAndFree, largestBlock);
 }
 
 void* getBaseAllocation(void *ptr, size_t *size)
 {
+  TORCH_CHECK(!CachingAllocatorConfig::use_malloc_async(),
+              "Tensors allocated with backend:cudaMallocAsync cannot be shared "
+              "between processes");
   return caching_allocator.getBaseAllocation(ptr, size);
 }
 
 void recordStream(const DataPtr& ptr, cuda::CUDAStream stream)
 {
+  if (CachingAllocatorConfig::use_malloc_async()) {
+    // see THCCachingAllocator::recordStream for the pointers that are skipped
+    if (ptr.get() && ptr.get_deleter() == &raw_delete) {
+      malloc_async_allocator.recordStream(ptr.get(), stream);
+    }
+    return;
+  }
   caching_allocator.recordStream(ptr, stream);
 }
 
+std::string allocatorBackend() {
+  return CachingAllocatorConfig::use_malloc_async() ? "cudaMallocAsync" : "native";
+}
+
 std::mutex* getFreeMutex()
 {
   return caching_allocator.getCudaFreeMutex();
@@ -1252,28 +2615,66 @@ static inline void assertValidDevice(int device) {
 
 DeviceStats getDeviceStats(int device) {
   assertValidDevice(device);
+  if (CachingAllocatorConfig::use_malloc_async()) {
+    return malloc_async_allocator.getStats(device);
+  }
   return caching_allocator.device_allocator[device]->getStats();
 }
 
 void resetAccumulatedStats(int device) {
   assertValidDevice(device);
+  if (CachingAllocatorConfig::use_malloc_async()) {
+    malloc_async_allocator.resetAccumulatedStats(device);
+    return;
+  }
   caching_allocator.device_allocator[device]->resetAccumulatedStats();
 }
 
 void resetPeakStats(int device) {
   assertValidDevice(device);
+  if (CachingAllocatorConfig::use_malloc_async()) {
+    malloc_async_allocator.resetPeakStats(device);
+    return;
+  }
   caching_allocator.device_allocator[device]->resetPeakStats();
 }
 
-std::vector<SegmentInfo> snapshot() {
+SnapshotInfo snapshot() {
   return caching_allocator.snapshot();
 }
 
+void recordHistory(
+    bool enabled,
+    CreateContextFn context_recorder,
+    size_t alloc_trace_max_entries,
+    bool alloc_trace_record_context) {
+  if (CachingAllocatorConfig::use_malloc_async()) {
+    TORCH_WARN_ONCE("The allocator history is not recorded with backend:cudaMallocAsync");
+    return;
+  }
+  for (auto& allocator : caching_allocator.device_allocator) {
+    allocator->recordHistory(
+        enabled, context_recorder, alloc_trace_max_entries, alloc_trace_record_context);
+  }
+}
+
+void attachOutOfMemoryObserver(OutOfMemoryObserver observer) {
+  if (CachingAllocatorConfig::use_malloc_async()) {
+    malloc_async_allocator.attachOutOfMemoryObserver(std::move(observer));
+    return;
+  }
+  for (auto& allocator : caching_allocator.device_allocator) {
+    allocator->attachOutOfMemoryObserver(observer);
+  }
+}
+
 // CUDAGraph interactions
 void notifyCaptureBegin(int device,
                         CaptureId_t graph_id,
                         MempoolId_t mempool_id) {
   assertValidDevice(device);
+  TORCH_CHECK(!CachingAllocatorConfig::use_malloc_async(),
+              "CUDA graphs cannot be captured with backend:cudaMallocAsync");
   caching_allocator.device_allocator[device]->notifyCaptureBegin(graph_id, mempool_id);
 }
 
@@ -1348,7 +2749,11 @@ void* raw_alloc(size_t nbytes) {
   int device;
   C10_CUDA_CHECK(cudaGetDevice(&device));
   void* r = nullptr;
-  caching_allocator.malloc(&r, device, nbytes, cuda::getCurrentCUDAStream(device));
+  if (CachingAllocatorConfig::use_malloc_async()) {
+    malloc_async_allocator.malloc(&r, device, nbytes, cuda::getCurrentCUDAStream(device));
+  } else {
+    caching_allocator.malloc(&r, device, nbytes, cuda::getCurrentCUDAStream(device));
+  }
   return r;
 }
 
@@ -1359,11 +2764,19 @@ void* raw_alloc_with_stream(size_t nbytes, cudaStream_t stream) {
   int device;
   C10_CUDA_CHECK(cudaGetDevice(&device));
   void* r = nullptr;
-  caching_allocator.malloc(&r, device, nbytes, stream);
+  if (CachingAllocatorConfig::use_malloc_async()) {
+    malloc_async_allocator.malloc(&r, device, nbytes, stream);
+  } else {
+    caching_allocator.malloc(&r, device, nbytes, stream);
+  }
   return r;
 }
 
 void raw_delete(void* ptr) {
+  if (CachingAllocatorConfig::use_malloc_async()) {
+    malloc_async_allocator.free(ptr);
+    return;
+  }
   caching_allocator.free(ptr);
 }
 
@@ -7,7 +7,10 @@
 #include <c10/util/Registry.h>
 
 #include <array>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <string>
 
 namespace c10 {
 
@@ -87,11 +90,23 @@ struct DeviceStats {
   int64_t num_ooms = 0;
 };
 
+// Context recorded with allocator events while the history is recorded,
+// e.g. the stack that allocated a block. What it contains is up to the
+// CreateContextFn passed to recordHistory.
+struct GatheredContext {
+  virtual ~GatheredContext() = default;
+};
+typedef std::shared_ptr<GatheredContext> (*CreateContextFn)(void);
+
 // Struct containing info of an allocation block (i.e. a fractional part of a cudaMalloc)..
 struct BlockInfo {
   int64_t size = 0;
+  // size requested by client code, 0 for blocks that are not allocated
+  int64_t requested_size = 0;
   bool allocated = false;
   bool active = false;
+  // set for allocated blocks while the history is recorded with context
+  std::shared_ptr<GatheredContext> context_when_allocated;
 };
 
 // Struct containing info of a memory segment (i.e. one contiguous cudaMalloc).
@@ -102,9 +117,60 @@ struct SegmentInfo {
   int64_t allocated_size = 0;
   int64_t active_size = 0;
   bool is_large = false;
+  // a mapped range of an expandable segment rather than a cudaMalloc
+  bool is_expandable = false;
+  int64_t stream = 0;
   std::vector<BlockInfo> blocks;
+  // set while the history is recorded with context
+  std::shared_ptr<GatheredContext> context_when_allocated;
+};
+
+// An event of the allocation trace, see recordHistory
+struct TraceEntry {
+  enum Action {
+    ALLOC,          // client code requested memory
+    FREE_REQUESTED, // client code freed memory
+    FREE_COMPLETED, // the memory can be reused, which is delayed from
+                    // FREE_REQUESTED by record_stream
+    SEGMENT_ALLOC,  // cudaMalloc of a new segment
+    SEGMENT_FREE,   // cudaFree of a segment
+    SEGMENT_MAP,    // memory mapped into an expandable segment
+    SEGMENT_UNMAP,  // memory unmapped from an expandable segment
+    OOM             // an allocation failed, addr is the free device memory
+  };
+  TraceEntry(
+      Action action,
+      int64_t addr,
+      size_t size,
+      cudaStream_t stream,
+      std::shared_ptr<GatheredContext> context = nullptr)
+      : action(action),
+        addr(addr),
+        size(size),
+        stream(stream),
+        context(std::move(context)) {}
+  Action action;
+  int64_t addr;
+  int64_t size;
+  cudaStream_t stream;
+  std::shared_ptr<GatheredContext> context;
 };
 
+struct SnapshotInfo {
+  std::vector<SegmentInfo> segments;
+  // per device, the recorded trace from oldest to newest event
+  std::vector<std::vector<TraceEntry>> device_traces;
+};
+
+// Called on an out of memory error before it is thrown, with the device, the
+// size of the failed allocation, and the total (or allowed, with a memory
+// fraction) and free memory of the device
+using OutOfMemoryObserver = std::function<void(
+    int64_t device,
+    int64_t alloc_size,
+    int64_t device_total,
+    int64_t device_free)>;
+
 C10_CUDA_API void* raw_alloc(size_t nbytes);
 C10_CUDA_API void* raw_alloc_with_stream(size_t nbytes, cudaStream_t stream);
 C10_CUDA_API void raw_delete(void* ptr);
@@ -119,7 +185,22 @@ C10_CUDA_API void recordStream(const DataPtr&, CUDAStream stream);
 C10_CUDA_API DeviceStats getDeviceStats(int device);
 C10_CUDA_API void resetAccumulatedStats(int device);
 C10_CUDA_API void resetPeakStats(int device);
-C10_CUDA_API std::vector<SegmentInfo> snapshot();
+C10_CUDA_API SnapshotInfo snapshot();
+// "native" or "cudaMallocAsync", set with PYTORCH_CUDA_ALLOC_CONF=backend:...
+C10_CUDA_API std::string allocatorBackend();
+
+// Starts or stops recording the allocator history on all devices. While
+// enabled, context_recorder (if not null) is called for every allocation and
+// its result kept with the block until it is freed. With
+// alloc_trace_max_entries > 0, the last alloc_trace_max_entries allocator
+// events are kept in a ring buffer per device, with their context if
+// alloc_trace_record_context is set. Both show up in snapshot().
+C10_CUDA_API void recordHistory(
+    bool enabled,
+    CreateContextFn context_recorder,
+    size_t alloc_trace_max_entries,
+    bool alloc_trace_record_context);
+C10_CUDA_API void attachOutOfMemoryObserver(OutOfMemoryObserver observer);
 
 // CUDAGraph interactions
 C10_CUDA_API void notifyCaptureBegin(int device,
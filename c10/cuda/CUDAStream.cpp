@@ -7,7 +7,10 @@
 #include <array>
 #include <atomic>
 #include <cstdint>
+#include <cstdlib>
 #include <mutex>
+#include <sstream>
+#include <string>
 #include <vector>
 
 namespace c10 {
@@ -38,10 +41,16 @@ struct LeakyStreamInternals {
 
 // Global stream state and constants
 static DeviceIndex num_gpus = -1;
-static constexpr int kStreamsPerPoolBits = 5;
-static constexpr int kStreamsPerPool = 1 << kStreamsPerPoolBits;
+static constexpr int kStreamsPerPoolBits = 7;
+static constexpr int kMaxStreamsPerPool = 1 << kStreamsPerPoolBits;
 static constexpr unsigned int kDefaultFlags = cudaStreamNonBlocking;
 
+// Pool configuration, read from PYTORCH_CUDA_STREAM_POOL_CONF when the
+// stream state is initialized (see parseStreamPoolConf below)
+static int streams_per_pool = 32;
+static int leased_streams_per_pool = 32;
+static bool per_thread_default_streams = false;
+
 // Note: lower numbers are higher priorities, zero is default priority
 static int kHighPriority = -1;
 static int kLowPriority = 0;
@@ -64,22 +73,42 @@ static LeakyStreamInternals default_streams[C10_COMPILE_TIME_MAX_GPUS];
 static std::once_flag device_flags[C10_COMPILE_TIME_MAX_GPUS];
 static std::atomic<uint32_t> low_priority_counters[C10_COMPILE_TIME_MAX_GPUS];
 static std::atomic<uint32_t> high_priority_counters[C10_COMPILE_TIME_MAX_GPUS];
-static std::array<LeakyStreamInternals, kStreamsPerPool>
+static std::array<LeakyStreamInternals, kMaxStreamsPerPool>
     low_priority_streams[C10_COMPILE_TIME_MAX_GPUS];
-static std::array<LeakyStreamInternals, kStreamsPerPool>
+static std::array<LeakyStreamInternals, kMaxStreamsPerPool>
     high_priority_streams[C10_COMPILE_TIME_MAX_GPUS];
 
+// Leased streams
+// Note: unlike the round-robin pools above, a leased stream is handed to one
+// CUDAStreamLease at a time and returns to its pool when the lease ends.
+// The streams are created on demand, up to leased_streams_per_pool per
+// device and priority, and reused by later leases.
+struct LeasedStreamPool {
+  std::mutex mutex;
+  // Indices of the created streams that aren't leased
+  std::vector<size_t> free;
+  size_t num_created = 0;
+};
+static LeasedStreamPool low_priority_leased_pools[C10_COMPILE_TIME_MAX_GPUS];
+static LeasedStreamPool high_priority_leased_pools[C10_COMPILE_TIME_MAX_GPUS];
+static std::array<LeakyStreamInternals, kMaxStreamsPerPool>
+    low_priority_leased_streams[C10_COMPILE_TIME_MAX_GPUS];
+static std::array<LeakyStreamInternals, kMaxStreamsPerPool>
+    high_priority_leased_streams[C10_COMPILE_TIME_MAX_GPUS];
+
 // Note [StreamId assignment]
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~
 // How do we assign stream IDs?
 //
-// -- 25 bits -- -- 2 bits --  -- 5 bits -----
+// -- 22 bits -- -- 3 bits --  -- 7 bits -----
 // zeros         StreamIdType  stream id index
 //
 // Where StreamIdType:
-//  00 = default stream
-//  01 = low priority stream
-//  10 = high priority stream
+//  000 = default stream
+//  001 = low priority stream
+//  010 = high priority stream
+//  011 = leased low priority stream
+//  100 = leased high priority stream
 //
 // This is not really for efficiency; it's just easier to write the code
 // to extract the index if we do this with bitmasks :)
@@ -100,6 +129,8 @@ enum class StreamIdType : uint8_t {
   DEFAULT = 0x0,
   LOW = 0x1,
   HIGH = 0x2,
+  LEASED_LOW = 0x3,
+  LEASED_HIGH = 0x4,
 };
 
 std::ostream& operator<<(std::ostream& stream, StreamIdType s) {
@@ -113,6 +144,12 @@ std::ostream& operator<<(std::ostream& stream, StreamIdType s) {
     case StreamIdType::HIGH:
       stream << "HIGH";
       break;
+    case StreamIdType::LEASED_LOW:
+      stream << "LEASED_LOW";
+      break;
+    case StreamIdType::LEASED_HIGH:
+      stream << "LEASED_HIGH";
+      break;
     default:
       stream << static_cast<uint8_t>(s);
       break;
@@ -174,6 +211,20 @@ static StreamId CUDAStream_getStreamId(const LeakyStreamInternals* ptr) {
         StreamIdType::HIGH, ptr - high_priority_streams[device_index].data());
   }
 
+  // Check if it's a leased stream
+  if (pointer_within<LeakyStreamInternals>(
+          ptr, low_priority_leased_streams[device_index])) {
+    return makeStreamId(
+        StreamIdType::LEASED_LOW,
+        ptr - low_priority_leased_streams[device_index].data());
+  }
+  if (pointer_within<LeakyStreamInternals>(
+          ptr, high_priority_leased_streams[device_index])) {
+    return makeStreamId(
+        StreamIdType::LEASED_HIGH,
+        ptr - high_priority_leased_streams[device_index].data());
+  }
+
   TORCH_INTERNAL_ASSERT(
       0,
       "Could not compute stream ID for ",
@@ -184,8 +235,47 @@ static StreamId CUDAStream_getStreamId(const LeakyStreamInternals* ptr) {
 }
 
 // Thread-local current streams
+// Note: with per-thread default streams, an entry is nullptr until the
+// thread first asks for its current stream on that device.
 static thread_local LeakyStreamInternals** current_streams = nullptr;
 
+// Parses PYTORCH_CUDA_STREAM_POOL_CONF, a comma separated list of
+// option:value pairs
+static void parseStreamPoolConf(const char* env) {
+  auto parse_size = [](const std::string& key, const std::string& value) {
+    int size = 0;
+    try {
+      size = std::stoi(value);
+    } catch (const std::exception&) {
+      TORCH_CHECK(false, "Expected an integer for ", key, ", got ", value);
+    }
+    TORCH_CHECK(
+        size >= 1 && size <= kMaxStreamsPerPool,
+        key, " must be between 1 and ", kMaxStreamsPerPool, ", got ", value);
+    return size;
+  };
+  std::stringstream options(env);
+  std::string option;
+  while (std::getline(options, option, ',')) {
+    const size_t colon = option.find(':');
+    TORCH_CHECK(colon != std::string::npos,
+                "Invalid PYTORCH_CUDA_STREAM_POOL_CONF option, expected option:value, got ", option);
+    const std::string key = option.substr(0, colon);
+    const std::string value = option.substr(colon + 1);
+    if (key == "pool_size") {
+      streams_per_pool = parse_size(key, value);
+    } else if (key == "leased_pool_size") {
+      leased_streams_per_pool = parse_size(key, value);
+    } else if (key == "per_thread_default_stream") {
+      TORCH_CHECK(value == "True" || value == "False",
+                  "Expected True or False for per_thread_default_stream, got ", value);
+      per_thread_default_streams = value == "True";
+    } else {
+      TORCH_CHECK(false, "Unrecognized PYTORCH_CUDA_STREAM_POOL_CONF option: ", key);
+    }
+  }
+}
+
 // Populates global values and creates a default stream for each device.
 // Note: the default stream on each device is signified by a nullptr,
 // and so is not created as usual.
@@ -203,6 +293,11 @@ static void initGlobalStreamState() {
       C10_COMPILE_TIME_MAX_GPUS,
       "). Increase that and recompile.");
 
+  const char* env = std::getenv("PYTORCH_CUDA_STREAM_POOL_CONF");
+  if (env != nullptr) {
+    parseStreamPoolConf(env);
+  }
+
   // Initializes default streams
   for (const auto i: c10::irange(num_gpus)) {
     default_streams[i].device_index = i;
@@ -218,7 +313,7 @@ static void initDeviceStreamState(DeviceIndex device_index) {
   // with it.
   CUDAGuard device_guard{device_index};
 
-  for (const auto i: c10::irange(kStreamsPerPool)) {
+  for (const auto i: c10::irange(streams_per_pool)) {
     auto& lowpri_stream = low_priority_streams[device_index][i];
     auto& hipri_stream = high_priority_streams[device_index][i];
 
@@ -245,7 +340,8 @@ static void initCUDAStreamsOnce() {
   current_streams =
       (LeakyStreamInternals**)malloc(num_gpus * sizeof(LeakyStreamInternals*));
   for (const auto i: c10::irange(num_gpus)) {
-    current_streams[i] = &default_streams[i];
+    current_streams[i] =
+        per_thread_default_streams ? nullptr : &default_streams[i];
   }
 }
 
@@ -258,7 +354,89 @@ static inline void check_gpu(DeviceIndex device_index) {
 // Note: Streams are returned round-robin (see note in CUDAStream.h)
 static uint32_t get_idx(std::atomic<uint32_t>& counter) {
   auto raw_idx = counter++;
-  return raw_idx % kStreamsPerPool;
+  return raw_idx % streams_per_pool;
+}
+
+static LeasedStreamPool& leased_pool(bool isHighPriority, DeviceIndex device_index) {
+  return isHighPriority ? high_priority_leased_pools[device_index]
+                        : low_priority_leased_pools[device_index];
+}
+
+static std::array<LeakyStreamInternals, kMaxStreamsPerPool>& leased_streams(
+    bool isHighPriority,
+    DeviceIndex device_index) {
+  return isHighPriority ? high_priority_leased_streams[device_index]
+                        : low_priority_leased_streams[device_index];
+}
+
+// Takes a stream out of the leased pool, creating it if none is free.
+// Returns nullptr when all the streams of the pool are leased.
+static LeakyStreamInternals* tryLeaseStream(
+    bool isHighPriority,
+    DeviceIndex device_index) {
+  auto& pool = leased_pool(isHighPriority, device_index);
+  auto& streams = leased_streams(isHighPriority, device_index);
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  if (pool.free.empty()) {
+    if (pool.num_created == static_cast<size_t>(leased_streams_per_pool)) {
+      return nullptr;
+    }
+    auto& internals = streams[pool.num_created];
+    CUDAGuard device_guard{device_index};
+    internals.device_index = device_index;
+    C10_CUDA_CHECK(cudaStreamCreateWithPriority(
+        &internals.stream,
+        kDefaultFlags,
+        isHighPriority ? kHighPriority : kLowPriority));
+    pool.free.push_back(pool.num_created++);
+  }
+  const auto idx = pool.free.back();
+  pool.free.pop_back();
+  return &streams[idx];
+}
+
+// Returns a leased stream to its pool. Work already queued on it stays
+// ordered before the work of the next lease.
+static void releaseStream(LeakyStreamInternals* ptr) {
+  const auto device_index = ptr->device_index;
+  const bool isHighPriority = pointer_within<LeakyStreamInternals>(
+      ptr, high_priority_leased_streams[device_index]);
+  auto& pool = leased_pool(isHighPriority, device_index);
+  std::lock_guard<std::mutex> lock(pool.mutex);
+  pool.free.push_back(ptr - leased_streams(isHighPriority, device_index).data());
+}
+
+// With per-thread default streams, the leased streams that are the initial
+// current streams of this thread; they are released when the thread exits
+struct ThreadDefaultStreams {
+  ThreadDefaultStreams() = default;
+  C10_DISABLE_COPY_AND_ASSIGN(ThreadDefaultStreams);
+
+  ~ThreadDefaultStreams() {
+    for (auto ptr : streams) {
+      if (ptr) {
+        releaseStream(ptr);
+      }
+    }
+  }
+
+  LeakyStreamInternals* streams[C10_COMPILE_TIME_MAX_GPUS] = {};
+};
+static thread_local ThreadDefaultStreams thread_default_streams;
+
+// Leases the initial current stream of this thread on the device, falling
+// back to the default stream when the leased pool is exhausted
+static LeakyStreamInternals* initThreadDefaultStream(DeviceIndex device_index) {
+  auto ptr = tryLeaseStream(/*isHighPriority=*/false, device_index);
+  if (!ptr) {
+    TORCH_WARN_ONCE(
+        "All the leased CUDA streams are in use, so a thread uses the default "
+        "stream instead of a stream of its own; raise leased_pool_size in "
+        "PYTORCH_CUDA_STREAM_POOL_CONF");
+    return &default_streams[device_index];
+  }
+  thread_default_streams.streams[device_index] = ptr;
+  return ptr;
 }
 
 // See Note [StreamId assignment]
@@ -282,6 +460,10 @@ LeakyStreamInternals* CUDAStream_internals(CUDAStream s) {
       return &low_priority_streams[device_index][si];
     case StreamIdType::HIGH:
       return &high_priority_streams[device_index][si];
+    case StreamIdType::LEASED_LOW:
+      return &low_priority_leased_streams[device_index][si];
+    case StreamIdType::LEASED_HIGH:
+      return &high_priority_leased_streams[device_index][si];
     default:
       TORCH_INTERNAL_ASSERT(
           0,
@@ -348,6 +530,9 @@ CUDAStream getCurrentCUDAStream(DeviceIndex device_index) {
     device_index = current_device();
   }
   check_gpu(device_index);
+  if (!current_streams[device_index]) {
+    current_streams[device_index] = initThreadDefaultStream(device_index);
+  }
   return CUDAStream_fromInternals(current_streams[device_index]);
 }
 
@@ -358,6 +543,43 @@ void setCurrentCUDAStream(CUDAStream stream) {
   current_streams[ptr->device_index] = ptr;
 }
 
+CUDAStreamLease::CUDAStreamLease(
+    const bool isHighPriority,
+    DeviceIndex device_index) {
+  initCUDAStreamsOnce();
+  if (device_index == -1) {
+    device_index = current_device();
+  }
+  check_gpu(device_index);
+  auto ptr = tryLeaseStream(isHighPriority, device_index);
+  TORCH_CHECK(
+      ptr,
+      "All the ",
+      leased_streams_per_pool,
+      isHighPriority ? " high" : " low",
+      " priority leased streams of CUDA device ",
+      static_cast<int>(device_index),
+      " are in use; raise leased_pool_size in PYTORCH_CUDA_STREAM_POOL_CONF");
+  stream_ = CUDAStream_fromInternals(ptr);
+}
+
+CUDAStreamLease::~CUDAStreamLease() {
+  if (stream_) {
+    releaseStream(CUDAStream_internals(*stream_));
+  }
+}
+
+CUDAStreamLease& CUDAStreamLease::operator=(CUDAStreamLease&& other) noexcept {
+  if (this != &other) {
+    if (stream_) {
+      releaseStream(CUDAStream_internals(*stream_));
+    }
+    stream_ = other.stream_;
+    other.stream_ = c10::nullopt;
+  }
+  return *this;
+}
+
 std::ostream& operator<<(std::ostream& stream, const CUDAStream& s) {
   return stream << s.unwrap();
 }
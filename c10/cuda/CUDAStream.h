@@ -9,6 +9,7 @@
 #include <c10/cuda/CUDAMacros.h>
 #include <c10/core/DeviceGuard.h>
 #include <c10/util/Exception.h>
+#include <c10/util/Optional.h>
 #include <c10/core/Stream.h>
 
 /*
@@ -25,8 +26,9 @@
 *
 * The second pool is the "low priority" or "default priority" streams. In
 * HIP builds there is no distinction between streams in this pool and streams
-* in the third pool (below). There are 32 of these streams per device, and
-* when a stream is requested one of these streams is returned round-robin.
+* in the third pool (below). There are 32 of these streams per device by
+* default, and when a stream is requested one of these streams is returned
+* round-robin.
 * That is, the first stream requested is at index 0, the second at index 1...
 * to index 31, then index 0 again.
 *
@@ -40,9 +42,20 @@
 * These pools suggest that stream users should prefer many short-lived streams,
 * as the cost of acquiring and releasing streams is effectively zero. If
 * many longer-lived streams are required in performance critical scenarios
-* then the functionality here may need to be extended to allow, for example,
-* "reserving" a subset of the pool so that other streams do not accidentally
-* overlap the performance critical streams.
+* then they can be leased instead (see CUDAStreamLease): a leased stream
+* comes from separate pools and is handed to one lease at a time, so no other
+* stream request returns it until the lease is released.
+*
+* The pool sizes are set by the environment variable
+* PYTORCH_CUDA_STREAM_POOL_CONF, a comma separated list of option:value
+* pairs read when the first stream is requested: pool_size (streams per
+* round-robin pool, 32 by default) and leased_pool_size (maximum number of
+* leased streams per device and priority, 32 by default), both at most 128.
+* With per_thread_default_stream:True, the current stream of each thread
+* starts out as a low priority stream leased for the lifetime of the thread
+* instead of the default stream, so that threads which don't pick streams
+* themselves, e.g. concurrent inference requests, don't serialize on the
+* default stream.
 *
 * Note: although the notion of "current stream for device" is thread local
 * (every OS thread has a separate current stream, as one might expect),
@@ -182,6 +195,37 @@ private:
 TORCH_API CUDAStream
 getStreamFromPool(const bool isHighPriority = false, DeviceIndex device = -1);
 
+/**
+ * An exclusive stream leased from the CUDA stream pools.  The stream isn't
+ * returned by getStreamFromPool or by other leases until the lease is
+ * destroyed; CUDAStream copies of it stay valid afterwards, but are no longer
+ * exclusive.  Raises an error when all the leased streams of the device and
+ * priority are in use.
+ */
+class C10_CUDA_API CUDAStreamLease {
+public:
+  explicit CUDAStreamLease(const bool isHighPriority = false, DeviceIndex device = -1);
+  ~CUDAStreamLease();
+
+  CUDAStreamLease(const CUDAStreamLease&) = delete;
+  CUDAStreamLease& operator=(const CUDAStreamLease&) = delete;
+  CUDAStreamLease(CUDAStreamLease&& other) noexcept : stream_(other.stream_) {
+    other.stream_ = c10::nullopt;
+  }
+  CUDAStreamLease& operator=(CUDAStreamLease&& other) noexcept;
+
+  /// The leased stream; must not be called on a moved-from lease.
+  CUDAStream stream() const {
+    TORCH_INTERNAL_ASSERT(stream_.has_value(), "CUDAStreamLease was moved from");
+    return *stream_;
+  }
+
+  operator CUDAStream() const { return stream(); }
+
+private:
+  c10::optional<CUDAStream> stream_;
+};
+
 /**
  * Get the default CUDA stream, for the passed CUDA device, or for the
  * current device if no device index is passed.  The default stream is
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/core/CPUPoolingAllocator.h>
+
+#include <thread>
+
+using namespace c10;
+
+namespace {
+
+struct PoolingGuard {
+  PoolingGuard() {
+    CPUPoolingAllocator::setEnabled(true);
+  }
+  ~PoolingGuard() {
+    CPUPoolingAllocator::setEnabled(false);
+    CPUPoolingAllocator::setMaxCachedBytes(size_t(1) << 30);
+  }
+};
+
+} // namespace
+
+TEST(CPUPoolingAllocatorTest, ReusesFreedBlocks) {
+  PoolingGuard guard;
+  auto* allocator = GetDefaultCPUAllocator();
+  const auto before = CPUPoolingAllocator::getStats();
+
+  void* first = nullptr;
+  {
+    auto data = allocator->allocate(1 << 20);
+    first = data.get();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % gAlignment, 0);
+    memset(first, 1, 1 << 20);
+  }
+  // a close size lands in the same size class
+  auto data = allocator->allocate((1 << 20) - 100);
+  EXPECT_EQ(data.get(), first);
+
+  const auto after = CPUPoolingAllocator::getStats();
+  EXPECT_EQ(after.num_cache_hits - before.num_cache_hits, 1);
+  EXPECT_EQ(after.num_system_allocs - before.num_system_allocs, 1);
+  EXPECT_EQ(after.allocated_bytes - before.allocated_bytes, 1 << 20);
+}
+
+TEST(CPUPoolingAllocatorTest, SmallAllocationsAreNotPooled) {
+  PoolingGuard guard;
+  auto* allocator = GetDefaultCPUAllocator();
+  const auto before = CPUPoolingAllocator::getStats();
+  {
+    auto data = allocator->allocate(1024);
+    EXPECT_FALSE(CPUPoolingAllocator::owns(data.get()));
+  }
+  const auto after = CPUPoolingAllocator::getStats();
+  EXPECT_EQ(after.num_system_allocs, before.num_system_allocs);
+}
+
+TEST(CPUPoolingAllocatorTest, CapAndEmptyCache) {
+  PoolingGuard guard;
+  auto* allocator = GetDefaultCPUAllocator();
+  CPUPoolingAllocator::emptyCache();
+  CPUPoolingAllocator::setMaxCachedBytes(3 << 20);
+  {
+    auto a = allocator->allocate(2 << 20);
+    auto b = allocator->allocate(2 << 20);
+  }
+  // only one of the two blocks fits under the cap
+  auto stats = CPUPoolingAllocator::getStats();
+  EXPECT_EQ(stats.cached_bytes, 2 << 20);
+
+  CPUPoolingAllocator::emptyCache();
+  stats = CPUPoolingAllocator::getStats();
+  EXPECT_EQ(stats.cached_bytes, 0);
+  EXPECT_EQ(stats.reserved_bytes, stats.allocated_bytes);
+}
+
+TEST(CPUPoolingAllocatorTest, FreeFromOtherThread) {
+  PoolingGuard guard;
+  auto* allocator = GetDefaultCPUAllocator();
+  CPUPoolingAllocator::emptyCache();
+  auto data = allocator->allocate(4 << 20);
+  void* ptr = data.get();
+  std::thread([&] {
+    data.clear();
+    // the block moves to the shared pool when the thread exits
+  }).join();
+  auto again = allocator->allocate(4 << 20);
+  EXPECT_EQ(again.get(), ptr);
+}
+
+TEST(CPUPoolingAllocatorTest, RawAllocate) {
+  PoolingGuard guard;
+  auto* allocator = GetDefaultCPUAllocator();
+  void* ptr = allocator->raw_allocate(1 << 20);
+  EXPECT_TRUE(CPUPoolingAllocator::owns(ptr));
+  allocator->raw_deallocate(ptr);
+  void* small = allocator->raw_allocate(16);
+  allocator->raw_deallocate(small);
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/core/InferenceArena.h>
+
+#include <cstring>
+#include <thread>
+
+using namespace c10;
+
+TEST(InferenceArenaTest, ReusesChunkAcrossScopes) {
+  InferenceArena arena(1 << 20);
+  auto* allocator = GetDefaultCPUAllocator();
+  void* first = nullptr;
+  for (int i = 0; i < 3; ++i) {
+    InferenceArenaGuard guard(&arena);
+    EXPECT_EQ(InferenceArena::current(), &arena);
+    auto a = allocator->allocate(1000);
+    auto b = allocator->allocate(1000);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(a.get()) % gAlignment, 0);
+    EXPECT_TRUE(InferenceArena::owns(a.get()));
+    EXPECT_NE(a.get(), b.get());
+    memset(a.get(), 1, 1000);
+    memset(b.get(), 2, 1000);
+    if (i == 0) {
+      first = a.get();
+    } else {
+      EXPECT_EQ(a.get(), first);
+    }
+  }
+  EXPECT_EQ(InferenceArena::current(), nullptr);
+  const auto stats = arena.getStats();
+  EXPECT_EQ(stats.num_chunk_allocs, 1);
+  EXPECT_EQ(stats.num_escaped_allocations, 0);
+  EXPECT_EQ(stats.reserved_bytes, 1 << 20);
+}
+
+TEST(InferenceArenaTest, OutsideOfScope) {
+  InferenceArena arena;
+  auto* allocator = GetDefaultCPUAllocator();
+  { InferenceArenaGuard guard(&arena); }
+  auto data = allocator->allocate(1000);
+  EXPECT_FALSE(InferenceArena::owns(data.get()));
+}
+
+TEST(InferenceArenaTest, SpilledChunksAreMerged) {
+  InferenceArena arena(1 << 20);
+  auto* allocator = GetDefaultCPUAllocator();
+  {
+    InferenceArenaGuard guard(&arena);
+    for (int i = 0; i < 5; ++i) {
+      allocator->allocate(512 * 1024);
+    }
+  }
+  auto stats = arena.getStats();
+  EXPECT_GT(stats.num_chunk_allocs, 2);
+  EXPECT_GE(stats.reserved_bytes, stats.peak_scope_bytes);
+  const auto chunk_allocs = stats.num_chunk_allocs;
+  {
+    InferenceArenaGuard guard(&arena);
+    for (int i = 0; i < 5; ++i) {
+      allocator->allocate(512 * 1024);
+    }
+  }
+  // the merged chunk fits the whole scope
+  stats = arena.getStats();
+  EXPECT_EQ(stats.num_chunk_allocs, chunk_allocs);
+}
+
+TEST(InferenceArenaTest, EscapedAllocationsStayValid) {
+  InferenceArena arena(1 << 20);
+  auto* allocator = GetDefaultCPUAllocator();
+  DataPtr escaped;
+  {
+    InferenceArenaGuard guard(&arena);
+    auto temp = allocator->allocate(1000);
+    escaped = allocator->allocate(1000);
+    memset(escaped.get(), 3, 1000);
+  }
+  const auto stats = arena.getStats();
+  EXPECT_EQ(stats.num_escaped_allocations, 1);
+  EXPECT_EQ(stats.num_escaped_chunks, 1);
+  {
+    // the next scope doesn't reuse the memory of the escaped allocation
+    InferenceArenaGuard guard(&arena);
+    auto data = allocator->allocate(1000);
+    memset(data.get(), 4, 1000);
+  }
+  EXPECT_EQ(static_cast<char*>(escaped.get())[999], 3);
+  // the detached chunk is freed by another thread
+  std::thread([&] { escaped.clear(); }).join();
+}
+
+TEST(InferenceArenaTest, NestedGuards) {
+  InferenceArena outer(1 << 20);
+  InferenceArena inner(1 << 20);
+  auto* allocator = GetDefaultCPUAllocator();
+  InferenceArenaGuard outer_guard(&outer);
+  auto a = allocator->allocate(1000);
+  {
+    InferenceArenaGuard inner_guard(&inner);
+    EXPECT_EQ(InferenceArena::current(), &inner);
+    {
+      // entering the same arena again doesn't reset it at exit
+      InferenceArenaGuard again(&outer);
+      allocator->allocate(1000);
+    }
+    EXPECT_EQ(outer.getStats().num_escaped_allocations, 0);
+  }
+  EXPECT_EQ(InferenceArena::current(), &outer);
+}
+
+TEST(InferenceArenaTest, RawAllocate) {
+  InferenceArena arena;
+  auto* allocator = GetDefaultCPUAllocator();
+  InferenceArenaGuard guard(&arena);
+  void* ptr = allocator->raw_allocate(1000);
+  EXPECT_TRUE(InferenceArena::owns(ptr));
+  allocator->raw_deallocate(ptr);
+}
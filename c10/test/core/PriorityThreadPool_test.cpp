@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <future>
+#include <mutex>
+#include <vector>
+
+#include <c10/core/thread_pool.h>
+
+using namespace c10;
+
+namespace {
+
+// Queues tasks on a single thread pool while its only worker is blocked, then
+// returns the order in which they ran.
+class BlockedPool {
+ public:
+  BlockedPool() : pool_(1), release_(release_promise_.get_future().share()) {
+    std::promise<void> blocked;
+    auto blocked_future = blocked.get_future();
+    pool_.run([&blocked, this]() {
+      blocked.set_value();
+      release_.wait();
+    });
+    blocked_future.wait();
+  }
+
+  std::shared_ptr<PriorityThreadPool::Task> run(
+      int id,
+      const TaskPriority& priority) {
+    return pool_.runWithPriority(
+        [this, id]() {
+          std::lock_guard<std::mutex> lock(mutex_);
+          order_.push_back(id);
+          if (order_.size() == expected_) {
+            done_.set_value();
+          }
+        },
+        priority);
+  }
+
+  std::vector<int> release(size_t expected) {
+    expected_ = expected;
+    auto done = done_.get_future();
+    release_promise_.set_value();
+    done.wait();
+    std::lock_guard<std::mutex> lock(mutex_);
+    return order_;
+  }
+
+ private:
+  PriorityThreadPool pool_;
+  std::promise<void> release_promise_;
+  std::shared_future<void> release_;
+  std::promise<void> done_;
+  std::mutex mutex_;
+  std::vector<int> order_;
+  size_t expected_ = 0;
+};
+
+} // namespace
+
+TEST(PriorityThreadPoolTest, PriorityThenDeadlineThenFifo) {
+  BlockedPool pool;
+  pool.run(0, TaskPriority(0));
+  pool.run(1, TaskPriority(0));
+  pool.run(2, TaskPriority(1, /* deadline */ 200));
+  pool.run(3, TaskPriority(1, /* deadline */ 100));
+  pool.run(4, TaskPriority(2));
+  ASSERT_EQ(pool.release(5), (std::vector<int>{4, 3, 2, 0, 1}));
+}
+
+TEST(PriorityThreadPoolTest, Raise) {
+  BlockedPool pool;
+  pool.run(0, TaskPriority(1));
+  auto task = pool.run(1, TaskPriority(0));
+  task->raise(TaskPriority(2));
+  // lower priorities never demote a task
+  task->raise(TaskPriority(0));
+  ASSERT_EQ(task->priority().priority, 2);
+  ASSERT_EQ(pool.release(2), (std::vector<int>{1, 0}));
+  ASSERT_TRUE(task->started());
+  // no-op once started
+  task->raise(TaskPriority(3));
+}
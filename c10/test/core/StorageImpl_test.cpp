@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/core/StorageImpl.h>
+
+#include <cstring>
+#include <utility>
+
+using namespace c10;
+
+TEST(StorageImplTest, InlineData) {
+  StorageImpl storage(
+      StorageImpl::use_inline_data_t(), sizeof(double), GetDefaultCPUAllocator());
+  EXPECT_TRUE(storage.has_inline_data());
+  EXPECT_TRUE(storage.resizable());
+  EXPECT_EQ(storage.nbytes(), sizeof(double));
+  EXPECT_EQ(storage.device(), Device(DeviceType::CPU));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(storage.data()) % 16, 0);
+  *storage.data<double>() = 1.5;
+  EXPECT_EQ(*storage.data<double>(), 1.5);
+}
+
+TEST(StorageImplTest, InlineDataSurvivesSwap) {
+  auto* allocator = GetDefaultCPUAllocator();
+  StorageImpl inline_storage(
+      StorageImpl::use_inline_data_t(), sizeof(int64_t), allocator);
+  *inline_storage.data<int64_t>() = 7;
+  StorageImpl heap_storage(
+      StorageImpl::use_byte_size_t(), 64, allocator, /*resizable=*/true);
+  *heap_storage.data<int64_t>() = 9;
+  void* heap_data = heap_storage.data();
+
+  std::swap(inline_storage, heap_storage);
+  EXPECT_FALSE(inline_storage.has_inline_data());
+  EXPECT_EQ(inline_storage.data(), heap_data);
+  EXPECT_EQ(*inline_storage.data<int64_t>(), 9);
+  EXPECT_TRUE(heap_storage.has_inline_data());
+  EXPECT_EQ(*heap_storage.data<int64_t>(), 7);
+
+  StorageImpl other(
+      StorageImpl::use_inline_data_t(), sizeof(int64_t), allocator);
+  *other.data<int64_t>() = 3;
+  std::swap(other, heap_storage);
+  EXPECT_TRUE(other.has_inline_data());
+  EXPECT_TRUE(heap_storage.has_inline_data());
+  EXPECT_EQ(*other.data<int64_t>(), 7);
+  EXPECT_EQ(*heap_storage.data<int64_t>(), 3);
+}
+
+TEST(StorageImplTest, InlineDataReplacedOnResize) {
+  auto* allocator = GetDefaultCPUAllocator();
+  StorageImpl storage(StorageImpl::use_inline_data_t(), 4, allocator);
+  std::memset(storage.data(), 1, 4);
+  auto new_data = allocator->allocate(1024);
+  std::memcpy(new_data.get(), storage.data(), 4);
+  storage.set_data_ptr_noswap(std::move(new_data));
+  storage.set_nbytes(1024);
+  EXPECT_FALSE(storage.has_inline_data());
+  EXPECT_EQ(static_cast<char*>(storage.data())[3], 1);
+}
@@ -0,0 +1,22 @@
+#include <c10/util/hash.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+TEST(StableHashTest, MatchesFNV1a) {
+  // Reference values of 64-bit FNV-1a; entries persisted with stable_hash
+  // keys depend on them not changing.
+  EXPECT_EQ(c10::stable_hash(""), 0xcbf29ce484222325ull);
+  EXPECT_EQ(c10::stable_hash("a"), 0xaf63dc4c8601ec8cull);
+  EXPECT_EQ(c10::stable_hash("foobar"), 0x85944171f73967e8ull);
+}
+
+TEST(StableHashTest, ChainsBuffers) {
+  const std::string foo = "foo";
+  const std::string bar = "bar";
+  const auto h = c10::stable_hash(foo.data(), foo.size());
+  EXPECT_EQ(
+      c10::stable_hash(bar.data(), bar.size(), h),
+      c10::stable_hash("foobar"));
+}
@@ -163,12 +163,10 @@ class SymbolHelper {
 } // anonymous namespace
 #endif // SUPPORTS_BACKTRACE
 
-std::string get_backtrace(
+std::vector<void*> get_backtrace_frames(
     size_t frames_to_skip,
-    size_t maximum_number_of_frames,
-    bool skip_python_frames) {
+    size_t maximum_number_of_frames) {
 #if SUPPORTS_BACKTRACE
-
   // We always skip this frame (backtrace).
   frames_to_skip += 1;
 
@@ -191,6 +189,19 @@ std::string get_backtrace(
   // `callstack`, so this is just a pointer subtraction and makes the subsequent
   // code safer.
   callstack.resize(static_cast<size_t>(number_of_frames));
+  return callstack;
+#else // !SUPPORTS_BACKTRACE
+  return {};
+#endif // SUPPORTS_BACKTRACE
+}
+
+std::string symbolize_backtrace_frames(
+    const std::vector<void*>& callstack,
+    bool skip_python_frames) {
+#if SUPPORTS_BACKTRACE
+  if (callstack.empty()) {
+    return "";
+  }
 
   // `backtrace_symbols` takes the return addresses obtained from `backtrace()`
   // and fetches string representations of each stack. Unfortunately it doesn't
@@ -238,6 +249,20 @@ std::string get_backtrace(
   }
 
   return stream.str();
+#else // !SUPPORTS_BACKTRACE
+  return "";
+#endif // SUPPORTS_BACKTRACE
+}
+
+std::string get_backtrace(
+    size_t frames_to_skip,
+    size_t maximum_number_of_frames,
+    bool skip_python_frames) {
+#if SUPPORTS_BACKTRACE
+  // We always skip this frame (backtrace).
+  return symbolize_backtrace_frames(
+      get_backtrace_frames(frames_to_skip + 1, maximum_number_of_frames),
+      skip_python_frames);
 #elif defined(_MSC_VER) // !SUPPORTS_BACKTRACE
   // This backtrace retrieval is implemented on Windows via the Windows
   // API using `CaptureStackBackTrace`, `SymFromAddr` and `SymGetLineFromAddr64`.
@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <string>
 #include <typeinfo>
+#include <vector>
 
 #include <c10/macros/Macros.h>
 
@@ -12,6 +13,18 @@ C10_API std::string get_backtrace(
     size_t frames_to_skip = 0,
     size_t maximum_number_of_frames = 64,
     bool skip_python_frames = true);
+
+// Captures the return addresses of the current call stack without
+// symbolizing them, which is much cheaper than get_backtrace. Returns no
+// frames where backtraces are not supported.
+C10_API std::vector<void*> get_backtrace_frames(
+    size_t frames_to_skip = 0,
+    size_t maximum_number_of_frames = 64);
+
+// Formats frames captured by get_backtrace_frames like get_backtrace.
+C10_API std::string symbolize_backtrace_frames(
+    const std::vector<void*>& frames,
+    bool skip_python_frames = true);
 } // namespace c10
 
 #endif // C10_UTIL_BACKTRACE_H_
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
+#include <string>
 #include <vector>
 #include <c10/util/complex.h>
 namespace c10 {
@@ -35,6 +37,32 @@ inline size_t hash_combine(size_t seed, size_t value) {
   return seed ^ (value + 0x9e3779b9 + (seed << 6u) + (seed >> 2u));
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// c10::stable_hash implementation
+////////////////////////////////////////////////////////////////////////////////
+
+// 64-bit FNV-1a of `size` bytes at `data`. Unlike c10::hash and std::hash,
+// the result is the same in every process, build and platform, so it can key
+// entries that are persisted or shared between processes, e.g. on-disk caches.
+// `h` is the hash of the bytes before these, to hash several buffers as one.
+constexpr uint64_t kStableHashSeed = 14695981039346656037ull;
+
+inline uint64_t stable_hash(
+    const void* data,
+    size_t size,
+    uint64_t h = kStableHashSeed) {
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; i++) {
+    h ^= bytes[i];
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+inline uint64_t stable_hash(const std::string& s) {
+  return stable_hash(s.data(), s.size());
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // c10::hash implementation
 ////////////////////////////////////////////////////////////////////////////////
@@ -14,6 +14,15 @@ C10_DEFINE_bool(caffe2_cpu_numa_enabled, false, "Use NUMA whenever possible.");
 
 namespace c10 {
 
+namespace {
+// Node set by the last successful NUMABind on this thread
+thread_local int bound_numa_node = -1;
+} // namespace
+
+int GetThreadNUMANode() {
+  return bound_numa_node;
+}
+
 #ifdef C10_ENABLE_NUMA
 bool IsNUMAEnabled() {
   return FLAGS_caffe2_cpu_numa_enabled && numa_available() >= 0;
@@ -37,6 +46,7 @@ void NUMABind(int numa_node_id) {
   numa_bitmask_setbit(bm, numa_node_id);
   numa_bind(bm);
   numa_bitmask_free(bm);
+  bound_numa_node = numa_node_id;
 }
 
 int GetNUMANode(const void* ptr) {
@@ -98,6 +108,11 @@ int GetCurrentNUMANode() {
   if (!IsNUMAEnabled()) {
     return -1;
   }
+  // A bound thread allocates on its own node even while the scheduler has
+  // it briefly running elsewhere.
+  if (bound_numa_node >= 0) {
+    return bound_numa_node;
+  }
 
   auto n = numa_node_of_cpu(sched_getcpu());
   return n;
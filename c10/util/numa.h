@@ -13,7 +13,7 @@ namespace c10 {
 C10_API bool IsNUMAEnabled();
 
 /**
- * Bind to a given NUMA node
+ * Bind the calling thread and its memory allocations to a given NUMA node
  */
 C10_API void NUMABind(int numa_node_id);
 
@@ -33,8 +33,14 @@ C10_API int GetNumNUMANodes();
 C10_API void NUMAMove(void* ptr, size_t size, int numa_node_id);
 
 /**
- * Get the current NUMA node id
+ * Get the current NUMA node id: the node the calling thread was bound to with
+ * NUMABind, otherwise the node of the CPU it is running on
  */
 C10_API int GetCurrentNUMANode();
 
+/**
+ * Get the NUMA node the calling thread was bound to with NUMABind, or -1
+ */
+C10_API int GetThreadNUMANode();
+
 } // namespace c10
@@ -2,9 +2,20 @@
 #include <c10/util/Exception.h>
 #include "caffe2/core/common.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
 namespace caffe2 {
 namespace serialize {
 
+#ifdef _WIN32
+
 FileAdapter::FileAdapter(const std::string& file_name) {
   file_stream_.open(file_name, std::ifstream::in | std::ifstream::binary);
   if (!file_stream_) {
@@ -22,7 +33,62 @@ size_t FileAdapter::read(uint64_t pos, void* buf, size_t n, const char* what)
   return istream_adapter_->read(pos, buf, n, what);
 }
 
+bool FileAdapter::supportsConcurrentReads() const {
+  return false;
+}
+
 FileAdapter::~FileAdapter() {}
 
+#else
+
+FileAdapter::FileAdapter(const std::string& file_name) {
+  fd_ = open(file_name.c_str(), O_RDONLY);
+  if (fd_ == -1) {
+    AT_ERROR("open file failed, file path: ", file_name);
+  }
+  struct stat file_stat;
+  if (fstat(fd_, &file_stat) == -1) {
+    close(fd_);
+    AT_ERROR("getting the size of file failed, file path: ", file_name);
+  }
+  size_ = static_cast<size_t>(file_stat.st_size);
+}
+
+size_t FileAdapter::size() const {
+  return size_;
+}
+
+size_t FileAdapter::read(uint64_t pos, void* buf, size_t n, const char* what)
+    const {
+  size_t done = 0;
+  while (done < n) {
+    ssize_t result =
+        pread(fd_, static_cast<char*>(buf) + done, n - done, pos + done);
+    if (result == -1 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      AT_ERROR(
+          "file reader failed: ",
+          what,
+          ": ",
+          result == 0 ? "unexpected end of file" : std::strerror(errno),
+          ".");
+    }
+    done += result;
+  }
+  return n;
+}
+
+bool FileAdapter::supportsConcurrentReads() const {
+  return true;
+}
+
+FileAdapter::~FileAdapter() {
+  close(fd_);
+}
+
+#endif
+
 } // namespace serialize
 } // namespace caffe2
@@ -17,11 +17,19 @@ class TORCH_API FileAdapter final : public ReadAdapterInterface {
   size_t size() const override;
   size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
       const override;
+  bool supportsConcurrentReads() const override;
   ~FileAdapter();
 
  private:
+#ifdef _WIN32
   std::ifstream file_stream_;
   std::unique_ptr<IStreamAdapter> istream_adapter_;
+#else
+  // reads use pread, which leaves the file offset alone, so that they can
+  // run concurrently
+  int fd_ = -1;
+  size_t size_ = 0;
+#endif
 };
 
 } // namespace serialize
@@ -76,6 +76,9 @@ void PyTorchStreamReader::init() {
   memset(ar_.get(), 0, sizeof(mz_zip_archive));
 
   size_t size = in_->size();
+  // readers that can alias their data can do so for an empty range
+  in_can_alias_ = static_cast<bool>(in_->alias(0, 0));
+  in_concurrent_reads_ = in_->supportsConcurrentReads();
 
   // check for the old magic number,
   constexpr size_t kMagicValueLength = 8;
@@ -237,38 +240,81 @@ size_t PyTorchStreamReader::getRecordID(const std::string& name) {
   return result;
 }
 
+static int64_t read_le_16(uint8_t* buf) {
+  return buf[0] + (buf[1] << 8);
+}
+
 // return dataptr, size
 std::tuple<at::DataPtr, size_t> PyTorchStreamReader::getRecord(const std::string& name) {
-  std::lock_guard<std::mutex> guard(reader_lock_);
+  return getRecord(name, nullptr);
+}
+
+std::tuple<at::DataPtr, size_t> PyTorchStreamReader::getRecord(
+    const std::string& name,
+    c10::Allocator* allocator) {
+  const bool can_alias = in_can_alias_ && allocator == nullptr;
+  if (allocator == nullptr) {
+    allocator = c10::GetCPUAllocator();
+  }
+  std::unique_lock<std::mutex> guard(reader_lock_);
   size_t key = getRecordID(name);
   mz_zip_archive_file_stat stat;
   mz_zip_reader_file_stat(ar_.get(), key, &stat);
   valid("retrieving file meta-data for ", name.c_str());
-  at::DataPtr retval = c10::GetCPUAllocator()->allocate(stat.m_uncomp_size);
+  // records stored uncompressed are used in place if the reader can alias its
+  // data, e.g. MmapAdapter, and aligned, or read without holding the lock if
+  // the reader supports concurrent reads. Aliased records are not checked
+  // against their CRC-32, which would read every page of them.
+  if ((can_alias || in_concurrent_reads_) && stat.m_method == 0 &&
+      stat.m_comp_size == stat.m_uncomp_size) {
+    size_t offset = getRecordDataOffset(stat.m_local_header_ofs);
+    if (can_alias && offset % kFieldAlignment == 0) {
+      at::DataPtr aliased = in_->alias(offset, stat.m_uncomp_size);
+      if (aliased) {
+        return std::make_tuple(std::move(aliased), stat.m_uncomp_size);
+      }
+    }
+    if (in_concurrent_reads_) {
+      guard.unlock();
+      at::DataPtr retval = allocator->allocate(stat.m_uncomp_size);
+      in_->read(offset, retval.get(), stat.m_uncomp_size, "reading file");
+      // as mz_zip_reader_extract_to_mem does
+      TORCH_CHECK(
+          mz_crc32(
+              MZ_CRC32_INIT,
+              static_cast<const mz_uint8*>(retval.get()),
+              stat.m_uncomp_size) == stat.m_crc32,
+          "PytorchStreamReader failed reading file ",
+          name,
+          ": CRC-32 check failed");
+      return std::make_tuple(std::move(retval), stat.m_uncomp_size);
+    }
+  }
+  at::DataPtr retval = allocator->allocate(stat.m_uncomp_size);
   mz_zip_reader_extract_to_mem(ar_.get(), key, retval.get(), stat.m_uncomp_size, 0);
   valid("reading file ", name.c_str());
 
   return std::make_tuple(std::move(retval), stat.m_uncomp_size);
 }
 
-static int64_t read_le_16(uint8_t* buf) {
-  return buf[0] + (buf[1] << 8);
-}
-
 size_t PyTorchStreamReader::getRecordOffset(const std::string& name) {
   std::lock_guard<std::mutex> guard(reader_lock_);
   mz_zip_archive_file_stat stat;
   mz_zip_reader_file_stat(ar_.get(), getRecordID(name), &stat);
   valid("retrieving file meta-data for ", name.c_str());
+  return getRecordDataOffset(stat.m_local_header_ofs);
+}
+
+size_t PyTorchStreamReader::getRecordDataOffset(uint64_t local_header_offset) {
   uint8_t local_header[MZ_ZIP_LOCAL_DIR_HEADER_SIZE];
   in_->read(
-      stat.m_local_header_ofs,
+      local_header_offset,
       local_header,
       MZ_ZIP_LOCAL_DIR_HEADER_SIZE,
       "reading file header");
   size_t filename_len = read_le_16(local_header + MZ_ZIP_LDH_FILENAME_LEN_OFS);
   size_t extra_len = read_le_16(local_header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
-  return stat.m_local_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + filename_len + extra_len;
+  return local_header_offset + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + filename_len + extra_len;
 }
 
 
@@ -368,6 +414,66 @@ void PyTorchStreamWriter::writeRecord(
   files_written.push_back(name);
 }
 
+void PyTorchStreamWriter::writeCompressedRecord(
+    const std::string& name,
+    const CompressedRecord& record) {
+  if (record.uncompressed_size == 0) {
+    writeRecord(name, nullptr, 0);
+    return;
+  }
+  AT_ASSERT(!finalized_);
+  AT_ASSERT(!archive_name_plus_slash_.empty());
+  std::string full_name = archive_name_plus_slash_ + name;
+  // miniz adds the zip64 fields based on the uncompressed size
+  size_t padding_size = detail::getPadding(
+      ar_->m_archive_size, full_name.size(), record.uncompressed_size, padding_);
+  mz_zip_writer_add_mem_ex_v2(
+      ar_.get(),
+      full_name.c_str(),
+      record.data.data(),
+      record.data.size(),
+      nullptr,
+      0,
+      MZ_ZIP_FLAG_COMPRESSED_DATA,
+      record.uncompressed_size,
+      record.crc32,
+      nullptr,
+      padding_.c_str(),
+      padding_size,
+      nullptr,
+      0);
+  valid("writing file ", name.c_str());
+  files_written.push_back(name);
+}
+
+CompressedRecord compressRecord(const void* data, size_t size, int level) {
+  TORCH_CHECK(
+      level >= 1 && level <= MZ_BEST_COMPRESSION,
+      "invalid compression level ",
+      level);
+  CompressedRecord record;
+  record.uncompressed_size = size;
+  record.crc32 = static_cast<uint32_t>(
+      mz_crc32(MZ_CRC32_INIT, static_cast<const mz_uint8*>(data), size));
+  if (size == 0) {
+    return record;
+  }
+  // raw deflate, as stored in zip archives
+  size_t compressed_size = 0;
+  void* compressed = tdefl_compress_mem_to_heap(
+      data,
+      size,
+      &compressed_size,
+      tdefl_create_comp_flags_from_zip_params(
+          level, -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY));
+  TORCH_CHECK(compressed != nullptr, "compressing record failed");
+  record.data.assign(
+      static_cast<char*>(compressed),
+      static_cast<char*>(compressed) + compressed_size);
+  mz_free(compressed);
+  return record;
+}
+
 void PyTorchStreamWriter::writeEndOfFile() {
   // Rewrites version info
   std::string version = c10::to_string(version_);
@@ -99,7 +99,16 @@ class TORCH_API PyTorchStreamReader final {
   explicit PyTorchStreamReader(std::shared_ptr<ReadAdapterInterface> in);
 
   // return dataptr, size
+  // the dataptr aliases the data of the reader if the reader supports it and
+  // the record is stored uncompressed and aligned, see
+  // ReadAdapterInterface::alias. Safe to call from several threads; records
+  // stored uncompressed are read concurrently if the reader supports it.
   std::tuple<at::DataPtr, size_t> getRecord(const std::string& name);
+  // reads the record into memory allocated by allocator, e.g. pinned memory to
+  // be copied to a device from, and never aliases the data of the reader
+  std::tuple<at::DataPtr, size_t> getRecord(
+      const std::string& name,
+      c10::Allocator* allocator);
   size_t getRecordOffset(const std::string& name);
   bool hasRecord(const std::string& name);
   std::vector<std::string> getAllRecords();
@@ -114,6 +123,9 @@ class TORCH_API PyTorchStreamReader final {
   size_t read(uint64_t pos, char* buf, size_t n);
   void valid(const char* what, const char* info = "");
   size_t getRecordID(const std::string& name);
+  // offset of the data of the record whose local header is at
+  // local_header_offset
+  size_t getRecordDataOffset(uint64_t local_header_offset);
 
   friend size_t
   istream_read_func(void* pOpaque, uint64_t file_ofs, void* pBuf, size_t n);
@@ -121,10 +133,26 @@ class TORCH_API PyTorchStreamReader final {
   std::string archive_name_;
   std::string archive_name_plus_slash_;
   std::shared_ptr<ReadAdapterInterface> in_;
+  bool in_can_alias_ = false;
+  bool in_concurrent_reads_ = false;
   int64_t version_;
   std::mutex reader_lock_;
 };
 
+// The data of a record deflated by compressRecord, to be written by
+// PyTorchStreamWriter::writeCompressedRecord
+struct TORCH_API CompressedRecord {
+  std::vector<char> data;
+  size_t uncompressed_size = 0;
+  uint32_t crc32 = 0;
+};
+
+// Deflates size bytes at data at the given level, 1 (fastest) to 9 (smallest).
+// Unlike writeRecord with compress set, this does not use any writer, so the
+// records of an archive can be compressed on several threads at once.
+TORCH_API CompressedRecord
+compressRecord(const void* data, size_t size, int level = 6);
+
 class TORCH_API PyTorchStreamWriter final {
  public:
   explicit PyTorchStreamWriter(std::string archive_name);
@@ -138,6 +166,9 @@ class TORCH_API PyTorchStreamWriter final {
       const void* data,
       size_t size,
       bool compress = false);
+  void writeCompressedRecord(
+      const std::string& name,
+      const CompressedRecord& record);
   void writeEndOfFile();
 
   const std::vector<std::string>& getAllWrittenRecords();
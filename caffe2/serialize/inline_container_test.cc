@@ -5,6 +5,7 @@
 #include <gtest/gtest.h>
 
 #include "caffe2/serialize/inline_container.h"
+#include "caffe2/serialize/mmap_adapter.h"
 
 namespace caffe2 {
 namespace serialize {
@@ -68,6 +69,76 @@ TEST(PyTorchStreamWriterAndReader, SaveAndLoad) {
   ASSERT_EQ(memcmp(the_file.c_str() + off2, data2.data(), data2.size()), 0);
 }
 
+TEST(PyTorchStreamWriterAndReader, LoadFromMmap) {
+  int64_t kFieldAlignment = 64L;
+
+  std::ostringstream oss;
+  PyTorchStreamWriter writer([&](const void* b, size_t n) -> size_t {
+    oss.write(static_cast<const char*>(b), n);
+    return oss ? n : 0;
+  });
+  std::array<char, 127> data1;
+  for (int i = 0; i < data1.size(); ++i) {
+    data1[i] = data1.size() - i;
+  }
+  writer.writeRecord("key1", data1.data(), data1.size());
+  writer.writeEndOfFile();
+
+  std::string the_file = oss.str();
+  std::ofstream foo("output_mmap.zip", std::ios::binary);
+  foo.write(the_file.c_str(), the_file.size());
+  foo.close();
+
+  at::DataPtr data_ptr;
+  int64_t size;
+  for (auto mode :
+       {MmapAdapter::Mode::ReadOnly, MmapAdapter::Mode::CopyOnWrite}) {
+    {
+      PyTorchStreamReader reader(
+          std::make_shared<MmapAdapter>("output_mmap.zip", mode));
+      ASSERT_TRUE(reader.hasRecord("key1"));
+      std::tie(data_ptr, size) = reader.getRecord("key1");
+      ASSERT_EQ(size, data1.size());
+      // the record aliases the mapped file, which is aligned to a page,
+      // instead of being allocated by the CPU allocator
+      ASSERT_NE(data_ptr.get_context(), data_ptr.get());
+      ASSERT_EQ(reinterpret_cast<uintptr_t>(data_ptr.get()) % kFieldAlignment, 0);
+    }
+    // the file stays mapped after the reader is gone
+    ASSERT_EQ(memcmp(data_ptr.get(), data1.data(), data1.size()), 0);
+    data_ptr.clear();
+  }
+
+  std::remove("output_mmap.zip");
+}
+
+TEST(PyTorchStreamWriterAndReader, SaveAndLoadCompressed) {
+  std::ostringstream oss;
+  PyTorchStreamWriter writer([&](const void* b, size_t n) -> size_t {
+    oss.write(static_cast<const char*>(b), n);
+    return oss ? n : 0;
+  });
+  std::vector<char> data1(1 << 16, 'a');
+  for (size_t i = 0; i < data1.size(); i += 7) {
+    data1[i] = static_cast<char>(i);
+  }
+  CompressedRecord compressed = compressRecord(data1.data(), data1.size());
+  ASSERT_LT(compressed.data.size(), data1.size());
+  writer.writeCompressedRecord("key1", compressed);
+  writer.writeCompressedRecord("empty", compressRecord(nullptr, 0));
+  writer.writeEndOfFile();
+
+  std::istringstream iss(oss.str());
+  PyTorchStreamReader reader(&iss);
+  at::DataPtr data_ptr;
+  int64_t size;
+  std::tie(data_ptr, size) = reader.getRecord("key1");
+  ASSERT_EQ(size, data1.size());
+  ASSERT_EQ(memcmp(data_ptr.get(), data1.data(), data1.size()), 0);
+  std::tie(data_ptr, size) = reader.getRecord("empty");
+  ASSERT_EQ(size, 0);
+}
+
 TEST(PytorchStreamWriterAndReader, GetNonexistentRecordThrows) {
   std::ostringstream oss;
   // write records through writers
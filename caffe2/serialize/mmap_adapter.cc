@@ -0,0 +1,172 @@
+#include "caffe2/serialize/mmap_adapter.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <c10/util/Exception.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace caffe2 {
+namespace serialize {
+
+struct MmapAdapter::Mapping {
+  Mapping(const std::string& file_name, Mode mode);
+  ~Mapping();
+
+  char* data = nullptr;
+  size_t size = 0;
+#ifdef _WIN32
+  HANDLE file = INVALID_HANDLE_VALUE;
+  HANDLE mapping = nullptr;
+#endif
+};
+
+#ifdef _WIN32
+
+MmapAdapter::Mapping::Mapping(const std::string& file_name, Mode mode) {
+  file = CreateFileA(
+      file_name.c_str(),
+      GENERIC_READ,
+      FILE_SHARE_READ,
+      nullptr,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL,
+      nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    AT_ERROR("open file failed, file path: ", file_name);
+  }
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size)) {
+    CloseHandle(file);
+    AT_ERROR("getting the size of file failed, file path: ", file_name);
+  }
+  size = static_cast<size_t>(file_size.QuadPart);
+  if (size == 0) {
+    return;
+  }
+  mapping = CreateFileMappingA(
+      file,
+      nullptr,
+      mode == Mode::ReadOnly ? PAGE_READONLY : PAGE_WRITECOPY,
+      0,
+      0,
+      nullptr);
+  if (mapping == nullptr) {
+    CloseHandle(file);
+    AT_ERROR("mapping file failed, file path: ", file_name);
+  }
+  data = static_cast<char*>(MapViewOfFile(
+      mapping, mode == Mode::ReadOnly ? FILE_MAP_READ : FILE_MAP_COPY, 0, 0, 0));
+  if (data == nullptr) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    AT_ERROR("mapping file failed, file path: ", file_name);
+  }
+}
+
+MmapAdapter::Mapping::~Mapping() {
+  if (data) {
+    UnmapViewOfFile(data);
+  }
+  if (mapping) {
+    CloseHandle(mapping);
+  }
+  CloseHandle(file);
+}
+
+#else
+
+MmapAdapter::Mapping::Mapping(const std::string& file_name, Mode mode) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd == -1) {
+    AT_ERROR(
+        "open file failed, file path: ", file_name, ": ", std::strerror(errno));
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1) {
+    close(fd);
+    AT_ERROR(
+        "getting the size of file failed, file path: ",
+        file_name,
+        ": ",
+        std::strerror(errno));
+  }
+  size = static_cast<size_t>(file_stat.st_size);
+  if (size == 0) {
+    close(fd);
+    return;
+  }
+  void* ptr = mmap(
+      nullptr,
+      size,
+      mode == Mode::ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE,
+      mode == Mode::ReadOnly ? MAP_SHARED : MAP_PRIVATE,
+      fd,
+      0);
+  // the mapping stays valid after the descriptor is closed
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    AT_ERROR(
+        "mapping file failed, file path: ",
+        file_name,
+        ": ",
+        std::strerror(errno));
+  }
+  data = static_cast<char*>(ptr);
+}
+
+MmapAdapter::Mapping::~Mapping() {
+  if (data) {
+    munmap(data, size);
+  }
+}
+
+#endif
+
+MmapAdapter::MmapAdapter(const std::string& file_name, Mode mode)
+    : mapping_(std::make_shared<Mapping>(file_name, mode)) {}
+
+size_t MmapAdapter::size() const {
+  return mapping_->size;
+}
+
+size_t MmapAdapter::read(uint64_t pos, void* buf, size_t n, const char* what)
+    const {
+  if (pos > mapping_->size || n > mapping_->size - pos) {
+    AT_ERROR("mmap reader failed: ", what, ".");
+  }
+  std::memcpy(buf, mapping_->data + pos, n);
+  return n;
+}
+
+static void deleteMappingRef(void* ctx) {
+  delete static_cast<std::shared_ptr<void>*>(ctx);
+}
+
+at::DataPtr MmapAdapter::alias(uint64_t pos, size_t n) const {
+  if (pos > mapping_->size || n > mapping_->size - pos) {
+    return at::DataPtr();
+  }
+  return at::DataPtr(
+      mapping_->data + pos,
+      new std::shared_ptr<void>(mapping_),
+      &deleteMappingRef,
+      at::Device(at::DeviceType::CPU));
+}
+
+bool MmapAdapter::supportsConcurrentReads() const {
+  return true;
+}
+
+MmapAdapter::~MmapAdapter() {}
+
+} // namespace serialize
+} // namespace caffe2
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "c10/macros/Macros.h"
+#include "caffe2/serialize/read_adapter_interface.h"
+
+namespace caffe2 {
+namespace serialize {
+
+// A reader that maps the whole file into memory. Records read through it by
+// PyTorchStreamReader::getRecord alias the mapped file instead of being copied
+// whenever they are stored uncompressed and aligned, which is always the case
+// for archives written by PyTorchStreamWriter. Tensors loaded from such an
+// archive share the pages of the file with every other process that maps it.
+class TORCH_API MmapAdapter final : public ReadAdapterInterface {
+ public:
+  enum class Mode {
+    // Pages are mapped read only: writing to an aliased record, e.g. updating
+    // a loaded weight in place, crashes the process.
+    ReadOnly,
+    // Pages are private to the process: writing to an aliased record copies
+    // the pages written to, and the file is left unchanged.
+    CopyOnWrite,
+  };
+
+  C10_DISABLE_COPY_AND_ASSIGN(MmapAdapter);
+  explicit MmapAdapter(
+      const std::string& file_name,
+      Mode mode = Mode::CopyOnWrite);
+  size_t size() const override;
+  size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
+      const override;
+  at::DataPtr alias(uint64_t pos, size_t n) const override;
+  bool supportsConcurrentReads() const override;
+  ~MmapAdapter();
+
+ private:
+  struct Mapping;
+  // shared with the DataPtrs returned by alias, the file stays mapped until
+  // the last of them is gone
+  std::shared_ptr<Mapping> mapping_;
+};
+
+} // namespace serialize
+} // namespace caffe2
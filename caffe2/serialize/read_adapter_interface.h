@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "c10/core/Allocator.h"
 #include "c10/macros/Macros.h"
 
 namespace caffe2 {
@@ -16,6 +17,14 @@ class TORCH_API ReadAdapterInterface {
   virtual size_t size() const = 0;
   virtual size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
       const = 0;
+  // return a DataPtr aliasing the n bytes at pos without copying them, or an
+  // empty DataPtr if the reader cannot (the default). A reader that can must
+  // do so for any range within size(), including empty ones. The DataPtr
+  // keeps the data alive after the reader is destroyed.
+  virtual at::DataPtr alias(uint64_t pos, size_t n) const;
+  // whether read may be called from several threads at once, false by
+  // default
+  virtual bool supportsConcurrentReads() const;
   virtual ~ReadAdapterInterface();
 };
 
@@ -110,6 +110,19 @@ if(INTERN_BUILD_ATEN_OPS)
     endif(MSVC)
   endif(CXX_AVX2_FOUND)
 
+  if(CXX_AVX512_FOUND AND CXX_AVX2_FOUND)
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DHAVE_AVX512_CPU_DEFINITION")
+    list(APPEND CPU_CAPABILITY_NAMES "AVX512")
+    # AVX512 is a strict superset of AVX2 here, so the AVX512 copies also
+    # define CPU_CAPABILITY_AVX2 and keep using the 256-bit Vec256 paths for
+    # code that has not been ported to Vec512.
+    if(MSVC)
+      list(APPEND CPU_CAPABILITY_FLAGS "${OPT_FLAG}/arch:AVX512 /DCPU_CAPABILITY_AVX2")
+    else(MSVC)
+      list(APPEND CPU_CAPABILITY_FLAGS "${OPT_FLAG} -mavx512f -mavx512bw -mavx512vl -mavx512dq -mfma ${CPU_NO_AVX256_SPLIT_FLAGS} -DCPU_CAPABILITY_AVX2")
+    endif(MSVC)
+  endif()
+
   if(CXX_VSX_FOUND)
     SET(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DHAVE_VSX_CPU_DEFINITION")
     LIST(APPEND CPU_CAPABILITY_NAMES "VSX")
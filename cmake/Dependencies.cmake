@@ -1670,6 +1670,9 @@ if(NOT INTERN_BUILD_MOBILE)
     message(STATUS "AVX2 compiler support found")
     add_compile_options(-DUSE_AVX2)
   endif()
+  if(C_AVX512_FOUND)
+    message(STATUS "AVX512 compiler support found")
+  endif()
 
   if(WIN32 AND NOT CYGWIN)
     set(BLAS_INSTALL_LIBRARIES "OFF"
@@ -25,6 +25,21 @@ SET(AVX2_CODE "
   }
 ")
 
+SET(AVX512_CODE "
+  #include <immintrin.h>
+
+  int main()
+  {
+    __m512i a = _mm512_set1_epi8(0);
+    __m512i b = _mm512_abs_epi8(a); // AVX512BW
+    __m256i c = _mm512_extracti64x4_epi64(b, 1);
+    __m128 d = _mm_maskz_mov_ps(1, _mm_set1_ps(0)); // AVX512VL
+    __m512 e = _mm512_and_ps(_mm512_set1_ps(0), _mm512_set1_ps(1)); // AVX512DQ
+    (void)c; (void)d; (void)e;
+    return 0;
+  }
+")
+
 MACRO(CHECK_SSE lang type flags)
   SET(__FLAG_I 1)
   SET(CMAKE_REQUIRED_FLAGS_SAVE ${CMAKE_REQUIRED_FLAGS})
@@ -56,6 +71,8 @@ ENDMACRO()
 
 CHECK_SSE(C "AVX" " ;-mavx;/arch:AVX")
 CHECK_SSE(C "AVX2" " ;-mavx2 -mfma;/arch:AVX2")
+CHECK_SSE(C "AVX512" " ;-mavx512f -mavx512bw -mavx512vl -mavx512dq -mfma;/arch:AVX512")
 
 CHECK_SSE(CXX "AVX" " ;-mavx;/arch:AVX")
 CHECK_SSE(CXX "AVX2" " ;-mavx2 -mfma;/arch:AVX2")
+CHECK_SSE(CXX "AVX512" " ;-mavx512f -mavx512bw -mavx512vl -mavx512dq -mfma;/arch:AVX512")
@@ -363,6 +363,15 @@ else()
     set_property(
         TARGET caffe2::cublas PROPERTY INTERFACE_LINK_LIBRARIES
         ${CUDA_CUBLAS_LIBRARIES})
+    if(CUDA_VERSION VERSION_GREATER_EQUAL 11.4)
+      # at::cuda::blas::gemm_and_bias uses cuBLASLt
+      find_library(CUDA_cublasLt_LIBRARY cublasLt
+          HINTS ${CUDA_TOOLKIT_ROOT_DIR}
+          PATH_SUFFIXES lib64 lib lib/x64)
+      set_property(
+        TARGET caffe2::cublas APPEND PROPERTY INTERFACE_LINK_LIBRARIES
+        ${CUDA_cublasLt_LIBRARY})
+    endif()
 endif()
 set_property(
     TARGET caffe2::cublas PROPERTY INTERFACE_INCLUDE_DIRECTORIES
@@ -8,6 +8,7 @@
 #include <c10/util/tempfile.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <future>
 #include <iostream>
@@ -21,6 +22,10 @@
 #include <unordered_set>
 #include <vector>
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 using namespace torch::data; // NOLINT
 
 const std::chrono::milliseconds kMillisecond(1);
@@ -485,6 +490,64 @@ TEST(DataTest, StackTransformWorksForTensorExample) {
   ASSERT_TRUE(second.data.allclose(torch::eye(4).slice(/*dim=*/0, 2, 4)));
 }
 
+TEST(DataTest, StackIntoTransformWritesIntoBatch) {
+  struct D : public datasets::Dataset<D> {
+    Example<> get(size_t index) override {
+      return {tensor[index], 1 + tensor[index]};
+    }
+
+    void get_into(size_t index, Example<>& slot) override {
+      slot.data.copy_(tensor[index]);
+      slot.target.copy_(tensor[index]).add_(1);
+      ++*get_into_calls;
+    }
+
+    torch::optional<size_t> size() const override {
+      return tensor.size(0);
+    }
+
+    torch::Tensor tensor{torch::eye(4)};
+    std::shared_ptr<size_t> get_into_calls = std::make_shared<size_t>(0);
+  };
+
+  D dataset;
+  auto d = dataset.map(transforms::StackInto<Example<>>());
+
+  Example<> batch = d.get_batch({0, 1, 2});
+  ASSERT_TRUE(batch.data.allclose(torch::eye(4).slice(/*dim=*/0, 0, 3)));
+  ASSERT_TRUE(batch.target.allclose(1 + torch::eye(4).slice(/*dim=*/0, 0, 3)));
+  // The first example of a batch is returned by get(), to size the batch.
+  ASSERT_EQ(*dataset.get_into_calls, 2);
+
+  // The batch tensors are reused once the batch is dropped.
+  const auto data_ptr = batch.data.data_ptr();
+  const auto target_ptr = batch.target.data_ptr();
+  batch = Example<>();
+  Example<> second = d.get_batch({3, 2, 1});
+  ASSERT_EQ(second.data.data_ptr(), data_ptr);
+  ASSERT_EQ(second.target.data_ptr(), target_ptr);
+  ASSERT_TRUE(second.data.allclose(torch::eye(4).flip(0).slice(0, 0, 3)));
+  ASSERT_TRUE(second.target.allclose(1 + torch::eye(4).flip(0).slice(0, 0, 3)));
+
+  // But not while the batch is alive.
+  Example<> third = d.get_batch({0, 1, 2});
+  ASSERT_NE(third.data.data_ptr(), data_ptr);
+  ASSERT_TRUE(second.data.allclose(torch::eye(4).flip(0).slice(0, 0, 3)));
+}
+
+TEST(DataTest, StackIntoTransformWorksForTensorExample) {
+  // TensorDataset uses the default get_into(), which copies the result of
+  // get().
+  auto d = datasets::TensorDataset(torch::eye(4))
+               .map(transforms::StackInto<TensorExample>());
+
+  TensorExample batch = d.get_batch({0, 1});
+  ASSERT_TRUE(batch.data.allclose(torch::eye(4).slice(/*dim=*/0, 0, 2)));
+
+  TensorExample second = d.get_batch({2, 3});
+  ASSERT_TRUE(second.data.allclose(torch::eye(4).slice(/*dim=*/0, 2, 4)));
+}
+
 // Template classes cannot be nested in functions.
 template <typename Target>
 struct T : transforms::TensorTransform<Target> {
@@ -688,6 +751,49 @@ TEST(DataTest, QueueClearEmptiesTheQueue) {
   ASSERT_THROWS_WITH(queue.pop(1 * kMillisecond), "Timeout");
 }
 
+TEST(DataTest, QueuePushBlocksWhileFull) {
+  torch::data::detail::Queue<int> queue(/*capacity=*/2);
+  queue.push(1);
+  queue.push(2);
+  std::atomic<bool> pushed{false};
+  std::thread thread([&queue, &pushed] {
+    queue.push(3);
+    pushed = true;
+  });
+  std::this_thread::sleep_for(20 * kMillisecond);
+  ASSERT_FALSE(pushed);
+  ASSERT_EQ(queue.pop(), 1);
+  thread.join();
+  ASSERT_TRUE(pushed);
+  ASSERT_EQ(queue.pop(), 2);
+  ASSERT_EQ(queue.pop(), 3);
+}
+
+TEST(DataTest, QueueDeliversEachValueOnceAcrossThreads) {
+  torch::data::detail::Queue<int> queue(/*capacity=*/4);
+  const int kThreads = 4;
+  const int kValues = 10000;
+  std::vector<std::thread> threads;
+  std::atomic<int64_t> sum{0};
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&queue] {
+      for (int i = 1; i <= kValues; ++i) {
+        queue.push(i);
+      }
+    });
+    threads.emplace_back([&queue, &sum] {
+      for (int i = 0; i < kValues; ++i) {
+        sum += queue.pop();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(sum, int64_t(kThreads) * kValues * (kValues + 1) / 2);
+  ASSERT_EQ(queue.clear(), 0);
+}
+
 TEST(DataTest, DataShuttleCanPushAndPopJob) {
   torch::data::detail::DataShuttle<int, int> shuttle;
   shuttle.push_job(1);
@@ -2223,6 +2329,91 @@ TEST(DataLoaderTest, ChunkDatasetCrossChunkShuffle) {
   }
 }
 
+TEST(DataLoaderTest, ColumnarChunkReaderMapsColumns) {
+  const auto data = torch::arange(7 * 2 * 3, torch::kFloat).view({7, 2, 3});
+  const auto target = torch::arange(7, torch::kLong);
+  auto data_file = c10::make_tempfile();
+  auto target_file = c10::make_tempfile();
+  datasets::ColumnarChunkReader::write_column(data_file.name, data);
+  datasets::ColumnarChunkReader::write_column(target_file.name, target);
+
+  datasets::ColumnarChunkReader reader(
+      {data_file.name, torch::kFloat, {2, 3}},
+      {target_file.name, torch::kLong},
+      /*chunk_size=*/3);
+  ASSERT_EQ(reader.size(), 7);
+  ASSERT_EQ(reader.chunk_count(), 3);
+
+  size_t row = 0;
+  for (size_t chunk = 0; chunk < reader.chunk_count(); ++chunk) {
+    const auto examples = reader.read_chunk(chunk);
+    ASSERT_EQ(examples.size(), chunk < 2 ? 3 : 1);
+    for (const auto& example : examples) {
+      ASSERT_TRUE(example.data.equal(data[row]));
+      ASSERT_TRUE(example.target.equal(target[row]));
+      ++row;
+    }
+  }
+  ASSERT_EQ(row, 7);
+  ASSERT_THROWS_WITH(reader.read_chunk(3), "out of range");
+
+  // Views of a row share the mapping of the whole chunk.
+  const auto examples = reader.read_chunk(0);
+  ASSERT_EQ(
+      static_cast<float*>(examples[1].data.data_ptr()),
+      static_cast<float*>(examples[0].data.data_ptr()) + 2 * 3);
+
+  ASSERT_THROWS_WITH(
+      datasets::ColumnarChunkReader(
+          {data_file.name, torch::kFloat, {4}},
+          {target_file.name, torch::kLong},
+          /*chunk_size=*/3),
+      "not a whole number of rows");
+  ASSERT_THROWS_WITH(
+      datasets::ColumnarChunkReader(
+          {data_file.name, torch::kFloat, {3}},
+          {target_file.name, torch::kLong},
+          /*chunk_size=*/3),
+      "rows but the target column has");
+}
+
+TEST(DataLoaderTest, ColumnarChunkReaderWorksWithChunkDataset) {
+  const auto data = torch::randn({10, 4});
+  const auto target = torch::arange(10, torch::kLong);
+  auto data_file = c10::make_tempfile();
+  auto target_file = c10::make_tempfile();
+  datasets::ColumnarChunkReader::write_column(data_file.name, data);
+  datasets::ColumnarChunkReader::write_column(target_file.name, target);
+
+  datasets::ColumnarChunkReader reader(
+      {data_file.name, torch::kFloat, {4}},
+      {target_file.name, torch::kLong},
+      /*chunk_size=*/4);
+  samplers::SequentialSampler sampler(0);
+  auto dataset = datasets::make_shared_dataset<datasets::ChunkDataset<
+      datasets::ColumnarChunkReader,
+      samplers::SequentialSampler,
+      samplers::SequentialSampler>>(
+      reader,
+      sampler,
+      sampler,
+      datasets::ChunkDatasetOptions(
+          /*preloader_count=*/2, /*batch_size=*/5));
+
+  auto data_loader = torch::data::make_data_loader(
+      dataset.map(transforms::Stack<>()), DataLoaderOptions(5).workers(0));
+  std::vector<Tensor> targets;
+  for (auto& batch : *data_loader) {
+    ASSERT_EQ(batch.data.size(0), batch.target.size(0));
+    for (int64_t i = 0; i < batch.data.size(0); ++i) {
+      ASSERT_TRUE(batch.data[i].equal(data[batch.target[i].item<int64_t>()]));
+    }
+    targets.push_back(batch.target);
+  }
+  const auto seen = std::get<0>(torch::cat(targets).sort());
+  ASSERT_TRUE(seen.equal(target));
+}
+
 TEST(DataLoaderTest, CustomPreprocessPolicy) {
   const size_t chunk_size = 5;
   const size_t batch_size = 10;
@@ -2303,3 +2494,198 @@ TEST(DataLoaderTest, CustomPreprocessPolicy) {
     }
   }
 }
+
+struct RowDataset : datasets::Dataset<RowDataset> {
+  RowDataset()
+      : data(torch::arange(64, torch::kFloat).view({16, 4})),
+        targets(torch::arange(16)) {}
+
+  Example<> get(size_t index) override {
+    return {data[index], targets[index]};
+  }
+  torch::optional<size_t> size() const override {
+    return data.size(0);
+  }
+
+  torch::Tensor data;
+  torch::Tensor targets;
+};
+
+TEST(DataLoaderTest, PinMemory_CUDA) {
+  RowDataset dataset;
+  const auto data = dataset.data;
+  const auto targets = dataset.targets;
+  for (const size_t workers : {0, 2}) {
+    auto data_loader = torch::data::make_data_loader<samplers::SequentialSampler>(
+        dataset.map(transforms::Stack<>()),
+        DataLoaderOptions(4).workers(workers).pin_memory(true));
+    int64_t index = 0;
+    for (auto& batch : *data_loader) {
+      ASSERT_TRUE(batch.data.is_pinned());
+      ASSERT_TRUE(batch.target.is_pinned());
+      ASSERT_TRUE(batch.data.equal(data.narrow(0, index, 4)));
+      ASSERT_TRUE(batch.target.equal(targets.narrow(0, index, 4)));
+      index += 4;
+    }
+    ASSERT_EQ(index, 16);
+  }
+}
+
+TEST(DataLoaderTest, PinnedMemoryPoolReusesBuffers_CUDA) {
+  torch::data::detail::PinnedMemoryPool pool;
+  auto pinned = pool.pin(torch::ones(8));
+  ASSERT_TRUE(pinned.is_pinned());
+  ASSERT_TRUE(pinned.equal(torch::ones(8)));
+  // The buffer is in use as long as the tensor lives.
+  auto other = pool.pin(torch::ones(4));
+  ASSERT_EQ(pool.size(), 2);
+  pinned.reset();
+  other.reset();
+  // A smaller tensor fits in a free buffer.
+  pinned = pool.pin(torch::full({2, 2}, 3));
+  ASSERT_EQ(pool.size(), 2);
+  ASSERT_EQ(pinned.sizes(), torch::IntArrayRef({2, 2}));
+  ASSERT_TRUE(pinned.equal(torch::full({2, 2}, 3)));
+}
+
+TEST(DataLoaderTest, PrefetchesToDevice_CUDA) {
+  RowDataset dataset;
+  const auto data = dataset.data;
+  const auto targets = dataset.targets;
+  for (const size_t workers : {0, 2}) {
+    for (const size_t prefetch : {0, 2, 8}) {
+      auto data_loader =
+          torch::data::make_data_loader<samplers::SequentialSampler>(
+              dataset.map(transforms::Stack<>()),
+              DataLoaderOptions(4)
+                  .workers(workers)
+                  .pin_memory(true)
+                  .device(torch::kCUDA)
+                  .device_prefetch(prefetch));
+      // Two epochs, the second one reusing the pinned buffers.
+      for (int epoch = 0; epoch < 2; epoch++) {
+        int64_t index = 0;
+        for (auto& batch : *data_loader) {
+          ASSERT_TRUE(batch.data.is_cuda());
+          ASSERT_TRUE(batch.target.is_cuda());
+          ASSERT_TRUE(batch.data.cpu().equal(data.narrow(0, index, 4)));
+          ASSERT_TRUE(batch.target.cpu().equal(targets.narrow(0, index, 4)));
+          index += 4;
+        }
+        ASSERT_EQ(index, 16);
+      }
+    }
+  }
+}
+
+#ifndef _WIN32
+TEST(DataLoaderTest, WorkerProcessesLoadBatches) {
+  struct D : datasets::Dataset<D> {
+    Example<> get(size_t index) override {
+      return {torch::full({3}, static_cast<int64_t>(index)),
+              torch::full({}, static_cast<int64_t>(getpid()))};
+    }
+    torch::optional<size_t> size() const override {
+      return 16;
+    }
+  };
+
+  D dataset;
+  auto data_loader = torch::data::make_data_loader<samplers::SequentialSampler>(
+      dataset.map(transforms::Stack<>()),
+      DataLoaderOptions(4).workers(2).worker_processes(true));
+  std::unordered_set<void*> segments;
+  for (int epoch = 0; epoch < 4; epoch++) {
+    int64_t index = 0;
+    for (auto& batch : *data_loader) {
+      const auto indices = torch::arange(index, index + 4).unsqueeze(1);
+      ASSERT_TRUE(batch.data.equal(indices.expand({4, 3})));
+      for (int64_t i = 0; i < 4; ++i) {
+        ASSERT_NE(batch.target[i].item<int64_t>(), getpid());
+      }
+      segments.insert(batch.data.data_ptr());
+      index += 4;
+    }
+    ASSERT_EQ(index, 16);
+  }
+  // Batches dropped by the time the worker processes load later ones free
+  // their segments for them.
+  ASSERT_LT(segments.size(), 16);
+}
+
+TEST(DataLoaderTest, WorkerProcessesPropagateExceptions) {
+  struct D : datasets::Dataset<D, int> {
+    int get(size_t index) override {
+      throw std::invalid_argument("badness");
+    }
+    torch::optional<size_t> size() const override {
+      return 100;
+    }
+  };
+
+  auto data_loader = torch::data::make_data_loader(
+      D{},
+      samplers::RandomSampler(100),
+      DataLoaderOptions().workers(2).worker_processes(true));
+  ASSERT_THROWS_WITH(*data_loader->begin(), "badness");
+}
+
+namespace {
+/// Sums `index + 1` copies of `index` with `at::parallel_for`.
+struct ParallelSumDataset : datasets::Dataset<ParallelSumDataset> {
+  Example<> get(size_t index) override {
+    const int64_t count = (index + 1) * 4096;
+    std::atomic<int64_t> sum{0};
+    at::parallel_for(0, count, 1, [&](int64_t begin, int64_t end) {
+      sum += (end - begin) * static_cast<int64_t>(index);
+    });
+    return {torch::full({1}, sum.load()), torch::full({}, count)};
+  }
+  torch::optional<size_t> size() const override {
+    return 8;
+  }
+};
+
+using ParallelSumLoader = StatelessDataLoader<
+    datasets::MapDataset<ParallelSumDataset, transforms::Stack<>>,
+    samplers::SequentialSampler>;
+
+std::unique_ptr<ParallelSumLoader> make_parallel_sum_loader() {
+  return torch::data::make_data_loader<samplers::SequentialSampler>(
+      ParallelSumDataset{}.map(transforms::Stack<>()),
+      DataLoaderOptions(2).workers(2).worker_processes(true));
+}
+
+void check_parallel_sums(ParallelSumLoader& data_loader) {
+  int64_t index = 0;
+  for (auto& batch : data_loader) {
+    for (int64_t i = 0; i < 2; ++i, ++index) {
+      ASSERT_EQ(batch.data[i].item<int64_t>(), (index + 1) * 4096 * index);
+    }
+  }
+  ASSERT_EQ(index, 8);
+}
+} // namespace
+
+TEST(DataLoaderTest, WorkerProcessesForkAfterIntraOpPoolStarted) {
+  // Starts the intra-op pool, whose threads do not exist in the worker
+  // processes, which must still run their parallel_for.
+  std::atomic<int64_t> count{0};
+  at::parallel_for(0, 1 << 16, 1, [&](int64_t begin, int64_t end) {
+    count += end - begin;
+  });
+  ASSERT_EQ(count.load(), 1 << 16);
+  auto data_loader = make_parallel_sum_loader();
+  check_parallel_sums(*data_loader);
+}
+
+TEST(DataLoaderTest, WorkerProcessesOutliveForkingThread) {
+  // Worker processes are forked by the thread that constructs the DataLoader,
+  // and must keep working once that thread is gone.
+  std::unique_ptr<ParallelSumLoader> data_loader;
+  std::thread([&data_loader] {
+    data_loader = make_parallel_sum_loader();
+  }).join();
+  check_parallel_sums(*data_loader);
+}
+#endif
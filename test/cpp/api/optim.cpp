@@ -373,6 +373,60 @@ TEST(OptimTest, ProducesPyTorchValues_SGDWithWeightDecayAndNesterovMomentum) {
       expected_parameters::SGD_with_weight_decay_and_nesterov_momentum());
 }
 
+TEST(OptimTest, ProducesPyTorchValues_FusedAdamWithWeightDecayAndAMSGrad) {
+  check_exact_values<Adam>(
+      AdamOptions(1.0).weight_decay(1e-6).amsgrad(true).fused(true),
+      expected_parameters::Adam_with_weight_decay_and_amsgrad());
+}
+
+TEST(OptimTest, ProducesPyTorchValues_FusedAdamW) {
+  check_exact_values<AdamW>(
+      AdamWOptions(1.0).fused(true), expected_parameters::AdamW());
+}
+
+TEST(OptimTest, ProducesPyTorchValues_FusedAdagradWithWeightDecayAndLRDecay) {
+  check_exact_values<Adagrad>(
+      AdagradOptions(1.0).weight_decay(1e-6).lr_decay(1e-3).fused(true),
+      expected_parameters::Adagrad_with_weight_decay_and_lr_decay());
+}
+
+TEST(OptimTest, ProducesPyTorchValues_FusedSGDWithWeightDecayAndNesterovMomentum) {
+  check_exact_values<SGD>(
+      SGDOptions(0.1).weight_decay(1e-6).momentum(0.9).nesterov(true).fused(true),
+      expected_parameters::SGD_with_weight_decay_and_nesterov_momentum());
+}
+
+// Steps a few parameters, one of them non-contiguous so that the kernels
+// leave it to the per parameter fallback, with options and options.fused(true)
+template <typename OptimizerClass, typename Options>
+void check_fused_matches_unfused(Options options) {
+  auto run = [](Options options) {
+    torch::manual_seed(0);
+    std::vector<torch::Tensor> params = {
+        torch::randn({100000}), torch::randn({7, 5}).t(), torch::randn({3})};
+    OptimizerClass optimizer(params, options);
+    for (int i = 0; i < 5; i++) {
+      for (auto& p : params) {
+        p.mutable_grad() = torch::sin(p * (i + 1));
+      }
+      optimizer.step();
+    }
+    return params;
+  };
+  auto expected = run(options);
+  auto computed = run(options.fused(true));
+  for (size_t i = 0; i < expected.size(); i++) {
+    ASSERT_TRUE(computed[i].allclose(expected[i], /*rtol=*/1e-5, /*atol=*/1e-6));
+  }
+}
+
+TEST(OptimTest, FusedMatchesUnfused) {
+  check_fused_matches_unfused<Adam>(AdamOptions(0.1).amsgrad(true));
+  check_fused_matches_unfused<AdamW>(AdamWOptions(0.1));
+  check_fused_matches_unfused<SGD>(SGDOptions(0.1).momentum(0.9).dampening(0.1));
+  check_fused_matches_unfused<Adagrad>(AdagradOptions(0.1).weight_decay(1e-2));
+}
+
 TEST(OptimTest, ProducesPyTorchValues_LBFGS) {
   check_exact_values<LBFGS>(
       LBFGSOptions(1.0),
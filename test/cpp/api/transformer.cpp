@@ -160,6 +160,66 @@ TEST_F(TransformerTest, TransformerEncoderLayer_CUDA) {
   transformer_encoder_layer_test_helper(true);
 }
 
+void transformer_encoder_layer_fast_path_test_helper(bool is_cuda) {
+  // the fused inference path against the unfused one, which runs while the
+  // parameters require grad
+  torch::Device device = is_cuda ? torch::kCUDA : torch::kCPU;
+  torch::TensorOptions tensor_options = torch::TensorOptions().dtype(torch::kFloat32).device(device);
+  const int64_t S = 7, B = 3, E = 16;
+
+  for (bool use_gelu : {false, true}) {
+    TransformerEncoderLayerOptions options(E, /*nhead=*/4);
+    options.dim_feedforward(32).dropout(0.0);
+    if (use_gelu) {
+      options.activation(torch::kGELU);
+    }
+    TransformerEncoderLayer model(options);
+    model->to(device);
+    model->eval();
+
+    torch::Tensor src = torch::randn({S, B, E}, tensor_options);
+    torch::Tensor src_mask = torch::triu(
+        torch::full({S, S}, -std::numeric_limits<float>::infinity(), tensor_options), 1);
+    torch::Tensor key_padding_mask = torch::zeros({B, S}, tensor_options) == 1;
+    key_padding_mask[1][6] = 1;
+    key_padding_mask[2][4] = 1;
+    key_padding_mask[2][5] = 1;
+    key_padding_mask[2][6] = 1;
+    // the unfused path adds a bool src_mask like a float one, and so must the
+    // fused one
+    torch::Tensor bool_src_mask = torch::triu(torch::ones({S, S}, tensor_options), 1) == 1;
+
+    for (const auto& masks : std::vector<std::pair<torch::Tensor, torch::Tensor>>{
+           {torch::Tensor{}, torch::Tensor{}},
+           {torch::Tensor{}, key_padding_mask},
+           {src_mask, key_padding_mask},
+           {bool_src_mask, torch::Tensor{}}}) {
+      torch::Tensor expected = model(src, masks.first, masks.second).detach();
+      torch::Tensor result;
+      {
+        torch::NoGradGuard no_grad;
+        result = model(src, masks.first, masks.second);
+      }
+      ASSERT_EQ(result.sizes(), expected.sizes());
+      // the padding tokens come out as zeros
+      if (masks.second.defined()) {
+        torch::Tensor padding = masks.second.t().unsqueeze(2).expand({S, B, E});
+        ASSERT_TRUE(result.masked_select(padding).eq(0).all().item<bool>());
+        expected.masked_fill_(padding, 0);
+      }
+      ASSERT_TRUE(torch::allclose(result, expected, 1e-5, 1e-5));
+    }
+  }
+}
+
+TEST_F(TransformerTest, TransformerEncoderLayerFastPath) {
+  transformer_encoder_layer_fast_path_test_helper(false);
+}
+
+TEST_F(TransformerTest, TransformerEncoderLayerFastPath_CUDA) {
+  transformer_encoder_layer_fast_path_test_helper(true);
+}
+
 void transformer_decoder_layer_test_helper(bool is_cuda){
 
   torch::Device device = is_cuda ? torch::kCUDA : torch::kCPU;
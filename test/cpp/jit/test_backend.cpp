@@ -3,6 +3,7 @@
 #include <torch/csrc/jit/api/module.h>
 #include <torch/csrc/jit/backends/backend_detail.h>
 #include <torch/csrc/jit/mobile/import.h>
+#include <torch/csrc/jit/serialization/import.h>
 #include <torch/torch.h>
 
 // Tests go in torch::jit
@@ -160,5 +161,66 @@ TEST(BackendTest, TestCompilerNotSupport) {
           "backend_with_compiler_demo", m, compile_spec, any_dict_ty),
       "The node of aten::mul is not supported in this compiler. Source code:");
 }
+
+TEST(BackendTest, TestXNNPACK) {
+  Module m("m");
+  m.register_parameter("weight", torch::randn({4, 3, 3, 3}), false);
+  m.register_parameter("bias", torch::randn({4}), false);
+  m.define(R"(
+    def forward(self, x, y):
+        z = torch.conv2d(x, self.weight, self.bias, [1, 1], [1, 1], [1, 1], 1)
+        return torch.relu(z + y)
+  )");
+  m.eval();
+
+  std::vector<IValue> inputs;
+  inputs.emplace_back(torch::randn({1, 3, 8, 8}));
+  inputs.emplace_back(torch::randn({1, 4, 8, 8}));
+  auto ref = m.forward(inputs);
+
+  c10::Dict<IValue, IValue> compile_spec(StringType::get(), AnyType::get());
+  c10::Dict<IValue, IValue> method_spec(StringType::get(), AnyType::get());
+  c10::List<c10::List<int64_t>> input_shapes;
+  input_shapes.push_back(c10::List<int64_t>({1, 3, 8, 8}));
+  input_shapes.push_back(c10::List<int64_t>({1, 4, 8, 8}));
+  method_spec.insert("input_shapes", input_shapes);
+  compile_spec.insert("forward", method_spec);
+  auto any_dict_ty = DictType::create(StringType::get(), AnyType::get());
+  // lowered module
+  auto lm = torch::jit::detail::codegen_backend_module(
+      "xnnpack", m, compile_spec, any_dict_ty);
+  if (!lm.run_method("__is_available").toBool()) {
+    return;
+  }
+  auto res = lm.forward(inputs);
+  AT_ASSERT(res.toTensor().allclose(ref.toTensor(), 1e-4, 1e-4));
+
+  std::stringstream ss;
+  lm.save(ss);
+  auto loaded = load(ss);
+  AT_ASSERT(loaded.forward(inputs).toTensor().allclose(
+      ref.toTensor(), 1e-4, 1e-4));
+}
+
+TEST(BackendTest, TestXNNPACKNotSupport) {
+  Module m("m");
+  m.define(R"(
+    def forward(self, x):
+        return x * x
+  )");
+  m.eval();
+
+  c10::Dict<IValue, IValue> compile_spec(StringType::get(), AnyType::get());
+  c10::Dict<IValue, IValue> method_spec(StringType::get(), AnyType::get());
+  c10::List<c10::List<int64_t>> input_shapes;
+  input_shapes.push_back(c10::List<int64_t>({1, 4}));
+  method_spec.insert("input_shapes", input_shapes);
+  compile_spec.insert("forward", method_spec);
+  auto any_dict_ty = DictType::create(StringType::get(), AnyType::get());
+  ASSERT_THROWS_WITH_MESSAGE(
+      torch::jit::detail::codegen_backend_module(
+          "xnnpack", m, compile_spec, any_dict_ty),
+      "The node of aten::mul is not supported by the XNNPACK backend.");
+}
 } // namespace jit
 } // namespace torch
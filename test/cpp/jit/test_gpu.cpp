@@ -21,11 +21,14 @@
 
 // fuser and IR parser
 #include <torch/csrc/jit/codegen/cuda/parser.h>
+#include <torch/csrc/jit/codegen/fuser/cuda/kernel_binary_cache.h>
 #include <torch/csrc/jit/ir/irparser.h>
 
 #include <ATen/cuda/Exceptions.h>
 #include <c10/cuda/CUDAStream.h>
+#include <c10/util/tempfile.h>
 
+#include <cstdio>
 #include <iostream>
 
 // Tests go in torch::jit
@@ -1345,6 +1348,49 @@ TEST(NVFuserTest, FusionSimplePWise_CUDA) {
   TORCH_CHECK(output_ref.equal(output));
 }
 
+TEST(NVFuserTest, FusionKernelBinaryCache_CUDA) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  TensorView* tv0 = makeContigTensor(1);
+  fusion.addInput(tv0);
+  TensorView* tv1 = add(tv0, new Float(1.0));
+  fusion.addOutput(tv1);
+  tv1->split(0, 128);
+  tv1->axis(0)->parallelize(ParallelType::BIDx);
+  tv1->axis(1)->parallelize(ParallelType::TIDx);
+
+  // use the directory of a fresh temporary file as the cache directory
+  auto tmp = c10::make_tempfile();
+  auto dir = tmp.name.substr(0, tmp.name.rfind('/'));
+  setKernelBinaryCacheDir(dir);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor input = at::randn({1000}, options);
+
+  FusionExecutor fe;
+  fe.compileFusion(&fusion);
+  auto outputs = fe.runFusion({input});
+  TORCH_CHECK(outputs[0].equal(input + 1.0));
+
+  // compiling the same kernel again loads it from the cache
+  FusionExecutor fe_cached;
+  fe_cached.compileFusion(&fusion);
+  outputs = fe_cached.runFusion({input});
+  TORCH_CHECK(outputs[0].equal(input + 1.0));
+
+  KernelBinary kernel{"kernel", {'a', 'b', 'c'}};
+  ASSERT_TRUE(storeKernelBinary("test_entry", kernel));
+  auto loaded = loadKernelBinary("test_entry");
+  ASSERT_TRUE(loaded.has_value());
+  ASSERT_EQ(loaded->name, kernel.name);
+  ASSERT_EQ(loaded->binary, kernel.binary);
+  ASSERT_FALSE(loadKernelBinary("missing_entry").has_value());
+
+  std::remove((dir + "/test_entry.bin").c_str());
+  setKernelBinaryCacheDir("");
+}
+
 TEST(NVFuserTest, FusionExecKernel_CUDA) {
   Fusion fusion;
   FusionGuard fg(&fusion);
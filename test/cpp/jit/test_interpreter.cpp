@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
 #include <ATen/Parallel.h>
+#include <torch/csrc/jit/runtime/instruction.h>
+#include <torch/csrc/jit/runtime/register_calls.h>
 #include "test/cpp/jit/test_utils.h"
 #include "torch/jit.h"
 #include "torch/script.h"
@@ -178,5 +180,86 @@ TEST(InterpreterTest, runAsyncBasicTest) {
   interp.runAsync(stack)->wait();
   ASSERT_TRUE(asyncCounter > 0);
 }
+
+TEST(InterpreterTest, Superinstructions) {
+  auto cu = compile(R"JIT(
+def scalar_loop(n: int, x: float):
+    acc = 0.0
+    for i in range(n):
+        if i % 3 == 0:
+            acc = acc + x * i
+        else:
+            acc = acc - 1.0
+    return acc
+  )JIT");
+  auto graph = cu->get_function("scalar_loop").graph();
+  Code function(graph, "");
+  // superinstructions are only in the code the interpreter runs
+  for (const auto& inst : function.instructions()) {
+    EXPECT_NE(inst.op, PUSH_OP);
+    EXPECT_NE(inst.op, PUSH_OP_STORE);
+    EXPECT_NE(inst.op, OP_STORE);
+  }
+
+  for (int64_t n : {0, 1, 10}) {
+    double expected = 0.0;
+    for (int64_t i = 0; i < n; ++i) {
+      expected = i % 3 == 0 ? expected + 0.5 * i : expected - 1.0;
+    }
+    InterpreterState interp(function);
+    std::vector<IValue> stack{n, 0.5};
+    interp.run(stack);
+    ASSERT_EQ(stack.size(), 1);
+    EXPECT_DOUBLE_EQ(stack[0].toDouble(), expected);
+  }
+}
+
+TEST(InterpreterTest, RegisterCalls) {
+  auto cu = compile(R"JIT(
+def mixed(n: int, x: float, t: Tensor):
+    acc = 0.0
+    for i in range(n):
+        if i * 2 >= n - 1:
+            acc = acc + x
+        t = torch.relu(t * t - t)
+    return acc, t + t
+  )JIT");
+  auto graph = cu->get_function("mixed").graph();
+  size_t num_register_ops = 0;
+  std::function<void(Block*)> count = [&](Block* block) {
+    for (Node* node : block->nodes()) {
+      if (findRegisterOperation(node)) {
+        num_register_ops++;
+      }
+      for (Block* inner : node->blocks()) {
+        count(inner);
+      }
+    }
+  };
+  count(graph->block());
+  // mul.int, sub.int, ge.int, add.float, mul.Tensor, sub.Tensor, relu and
+  // add.Tensor
+  EXPECT_GE(num_register_ops, 8);
+
+  Code function(graph, "");
+  for (int64_t n : {0, 1, 5}) {
+    double acc = 0.0;
+    auto t = at::randn({3, 4});
+    auto expected = t.clone();
+    for (int64_t i = 0; i < n; ++i) {
+      if (i * 2 >= n - 1) {
+        acc += 0.25;
+      }
+      expected = at::relu(expected * expected - expected);
+    }
+    InterpreterState interp(function);
+    std::vector<IValue> stack{n, 0.25, t};
+    interp.run(stack);
+    ASSERT_EQ(stack.size(), 1);
+    auto outputs = stack[0].toTuple()->elements();
+    EXPECT_DOUBLE_EQ(outputs[0].toDouble(), acc);
+    EXPECT_TRUE(outputs[1].toTensor().allclose(expected + expected));
+  }
+}
 } // namespace jit
 } // namespace torch
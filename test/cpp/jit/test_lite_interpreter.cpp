@@ -7,7 +7,9 @@
 #include <torch/csrc/jit/api/module.h>
 #include <torch/csrc/jit/frontend/resolver.h>
 #include <torch/csrc/jit/mobile/import.h>
+#include <torch/csrc/jit/mobile/interpreter.h>
 #include <torch/csrc/jit/mobile/module.h>
+#include <torch/csrc/jit/runtime/instruction.h>
 #include <torch/csrc/jit/serialization/export.h>
 #include <torch/csrc/jit/serialization/import.h>
 #include <torch/custom_class.h>
@@ -943,6 +945,257 @@ TEST(LiteInterpreterTest, OpNameExportFetchRootOperators) {
       << "Expected the root operator lists to be the same";
 }
 
+TEST(LiteInterpreterTest, ModelsShareOperatorsAndTypes) {
+  Module a("a");
+  a.define(R"JIT(
+  def foo(self, x):
+      return {"result": x + 1}
+
+  def forward(self, x):
+      return {"result": x * 2 + 1}
+  )JIT");
+  Module b("b");
+  b.define(R"JIT(
+  def forward(self, x):
+      return {"result": x + 2}
+  )JIT");
+  std::stringstream ss_a, ss_b;
+  a._save_for_mobile(ss_a);
+  b._save_for_mobile(ss_b);
+  mobile::Module bc_a = _load_for_mobile(ss_a);
+  mobile::Module bc_b = _load_for_mobile(ss_b);
+
+  auto result = [](const mobile::Module& m, const std::string& method) {
+    std::vector<IValue> inputs({torch::ones({})});
+    auto output = m.get_method(method)(inputs);
+    return output.toGenericDict().at("result").toTensor().item().toInt();
+  };
+  AT_ASSERT(result(bc_a, "foo") == 2);
+  AT_ASSERT(result(bc_a, "forward") == 3);
+  AT_ASSERT(result(bc_b, "forward") == 3);
+
+  auto dict_type = [](const mobile::Module& m, const std::string& method) {
+    const auto& types = m.get_method(method).function().get_code()->types_;
+    auto it = std::find_if(types.begin(), types.end(), [](const TypePtr& t) {
+      return t->kind() == TypeKind::DictType;
+    });
+    TORCH_INTERNAL_ASSERT(it != types.end());
+    return *it;
+  };
+  // a type used by several methods of a model is only parsed once
+  ASSERT_EQ(dict_type(bc_a, "foo").get(), dict_type(bc_a, "forward").get());
+  ASSERT_EQ(*dict_type(bc_a, "foo"), *dict_type(bc_b, "forward"));
+}
+
+TEST(LiteInterpreterTest, SelectedOperatorTable) {
+  // sorted, like kSelectedOperators
+  static const char* const names[] = {
+      "aten::add.Tensor", "test::not_registered"};
+  mobile::SelectedOperatorTable table(names);
+
+  auto add = table.lookup(c10::OperatorName("aten::add", "Tensor"));
+  ASSERT_TRUE(add);
+  Stack stack{torch::ones({2}), torch::ones({2}), 2};
+  add(stack);
+  ASSERT_EQ(stack.size(), 1);
+  ASSERT_TRUE(stack[0].toTensor().equal(torch::full({2}, 3.0)));
+
+  // operators missing from the table fall back to the usual lookup
+  auto mul = table.lookup(c10::OperatorName("aten::mul", "Tensor"));
+  ASSERT_TRUE(mul);
+  stack = {torch::ones({2}) * 2, torch::ones({2}) * 3};
+  mul(stack);
+  ASSERT_EQ(stack.size(), 1);
+  ASSERT_TRUE(stack[0].toTensor().equal(torch::full({2}, 6.0)));
+
+  ASSERT_FALSE(table.lookup(c10::OperatorName("test::not_registered", "")));
+  ASSERT_FALSE(table.lookup(c10::OperatorName("test::not_selected", "")));
+}
+
+TEST(LiteInterpreterTest, ControlFlow) {
+  Module m("m");
+  m.define(R"JIT(
+  def forward(self, x: int):
+      total = 0
+      for i in range(x):
+          if i % 2 == 0:
+              total += i
+          else:
+              total -= 1
+      j = 0
+      while j < x and total < 20:
+          j += 1
+          total += j
+      return total
+  )JIT");
+  std::stringstream ss;
+  m._save_for_mobile(ss);
+  mobile::Module bc = _load_for_mobile(ss);
+  for (int64_t x : {0, 1, 2, 5, 12}) {
+    std::vector<IValue> inputs({x});
+    auto ref = m.run_method("forward", x);
+    auto res = bc.get_method("forward")(inputs);
+    AT_ASSERT(res.toInt() == ref.toInt());
+  }
+}
+
+TEST(LiteInterpreterTest, RunsEveryOpcode) {
+  // Hand-assembled, so that each instruction the mobile interpreter supports
+  // runs at least once, whatever the compiler happens to emit.
+  auto cu = std::make_shared<CompilationUnit>();
+  auto point = ClassType::create("__torch__.Point", cu);
+  point->addAttribute("x", IntType::get());
+  auto pair = TupleType::createNamed(
+      "__torch__.Pair", {"a", "b"}, {IntType::get(), IntType::get()});
+
+  mobile::Function f(c10::QualifiedName("__torch__.m.f"));
+  f.append_operator(
+      c10::OperatorName("test::sum", ""), [](Stack& stack) {
+        auto n = pop(stack).toInt();
+        int64_t sum = 0;
+        for (const auto& v : last(stack, n)) {
+          sum += v.toInt();
+        }
+        drop(stack, n);
+        push(stack, sum);
+      });
+  f.append_constant("key");
+  f.append_constant("warning");
+  f.append_constant(2);
+  f.append_constant("get");
+  f.append_constant("sliced off");
+  f.append_type(ListType::ofInts());
+  f.append_type(DictType::create(StringType::get(), IntType::get()));
+  f.append_type(point);
+  f.append_type(pair);
+  // inputs: x, obj, t
+  f.append_instruction(STOREN, 1, 3);
+  f.append_instruction(LOAD, 1, 0);
+  f.append_instruction(LOAD, 1, 0);
+  f.append_instruction(LIST_CONSTRUCT, 0, 2); // [x, x]
+  f.append_instruction(LIST_UNPACK, 2, 0);
+  f.append_instruction(OPN, 0, 2); // x + x
+  f.append_instruction(LOADC, 0, 0);
+  f.append_instruction(LOAD, 1, 0);
+  f.append_instruction(DICT_CONSTRUCT, 1, 2); // {"key": x}
+  f.append_instruction(LOAD, 1, 0);
+  f.append_instruction(LOAD, 1, 0);
+  f.append_instruction(NAMED_TUPLE_CONSTRUCT, 3, 2);
+  f.append_instruction(DROP, 0, 0);
+  f.append_instruction(CREATE_OBJECT, 2, 0);
+  f.append_instruction(STORE, 4, 0);
+  f.append_instruction(LOAD, 4, 0);
+  f.append_instruction(LOAD, 1, 0);
+  f.append_instruction(SET_ATTR, 0, 0);
+  f.append_instruction(LOAD, 4, 0);
+  f.append_instruction(GET_ATTR, 0, 0); // point.x
+  f.append_instruction(MOVE, 4, 0);
+  f.append_instruction(ISINSTANCE, 2, 1); // isinstance(point, Point)
+  f.append_instruction(DROPR, 1, 0);
+  f.append_instruction(LOADC, 1, 0);
+  f.append_instruction(LOADC, 2, 0);
+  f.append_instruction(WARN, 0, 0);
+  f.append_instruction(MOVE, 2, 0);
+  f.append_instruction(MOVE, 3, 0);
+  f.append_instruction(INTERFACE_CALL, 3, 2); // obj.get(t)
+  f.append_instruction(LOADC, 4, 0);
+  f.append_instruction(TUPLE_CONSTRUCT, 6, 0);
+  f.append_instruction(TUPLE_SLICE, 0, 5);
+  f.append_instruction(RET, 0, 0);
+  f.set_register_size(4);
+
+  auto obj = make_custom_class<TorchBindLiteInterpreterTestStruct>();
+  Stack stack{int64_t(21), obj, torch::zeros({3, 4})};
+  f.run(stack);
+  ASSERT_EQ(stack.size(), 1);
+  const auto& elements = stack[0].toTuple()->elements();
+  ASSERT_EQ(elements.size(), 5);
+  EXPECT_EQ(elements[0].toInt(), 42);
+  EXPECT_EQ(elements[1].toGenericDict().at("key").toInt(), 21);
+  EXPECT_EQ(elements[2].toInt(), 21);
+  EXPECT_TRUE(elements[3].toBool());
+  EXPECT_EQ(elements[4].toStringRef(), "Hello! Your tensor has 12 elements!");
+
+  // rejected up front instead of failing when the function runs
+  ASSERT_ANY_THROW(f.append_instruction(CALL, 0, 0));
+}
+
+TEST(LiteInterpreterTest, ReturnFromNestedLoopingCalls) {
+  // inner(n) returns -1 early for n == 0, else sum(range(n))
+  mobile::Function inner(c10::QualifiedName("__torch__.m.inner"));
+  inner.append_operator(c10::OperatorName("test::is_zero", ""), [](Stack& stack) {
+    push(stack, pop(stack).toInt() == 0);
+  });
+  inner.append_operator(c10::OperatorName("test::add", ""), [](Stack& stack) {
+    auto b = pop(stack).toInt();
+    auto a = pop(stack).toInt();
+    push(stack, a + b);
+  });
+  inner.append_constant(-1);
+  inner.append_constant(0);
+  inner.append_constant(true);
+  inner.append_instruction(STORE, 1, 0);
+  inner.append_instruction(LOAD, 1, 0);
+  inner.append_instruction(OP, 0, 0);
+  inner.append_instruction(JF, 3, 0);
+  inner.append_instruction(LOADC, 0, 0);
+  inner.append_instruction(RET, 0, 0);
+  inner.append_instruction(LOADC, 1, 0); // trip count
+  inner.append_instruction(LOAD, 1, 0); // max trip count
+  inner.append_instruction(LOADC, 2, 0); // condition
+  inner.append_instruction(LOADC, 1, 0); // acc
+  inner.append_instruction(LOOP, 7, 3);
+  inner.append_instruction(STOREN, 2, 2); // i, acc
+  inner.append_instruction(LOADC, 2, 0);
+  inner.append_instruction(MOVE, 3, 0);
+  inner.append_instruction(MOVE, 2, 0);
+  inner.append_instruction(OP, 1, 0);
+  inner.append_instruction(JMP, -6, 0);
+  inner.append_instruction(RET, 0, 0);
+  inner.set_register_size(3);
+
+  // outer(m) returns sum(inner(k) for k in range(m)), calling inner from
+  // the body of its own loop on the same stack
+  mobile::Function outer(c10::QualifiedName("__torch__.m.outer"));
+  outer.append_operator(
+      c10::OperatorName("test::inner", ""),
+      [&inner](Stack& stack) { inner.run(stack); });
+  outer.append_operator(c10::OperatorName("test::add", ""), [](Stack& stack) {
+    auto b = pop(stack).toInt();
+    auto a = pop(stack).toInt();
+    push(stack, a + b);
+  });
+  outer.append_constant(0);
+  outer.append_constant(true);
+  outer.append_instruction(STORE, 1, 0);
+  outer.append_instruction(LOADC, 0, 0); // trip count
+  outer.append_instruction(LOAD, 1, 0); // max trip count
+  outer.append_instruction(LOADC, 1, 0); // condition
+  outer.append_instruction(LOADC, 0, 0); // total
+  outer.append_instruction(LOOP, 8, 3);
+  outer.append_instruction(STOREN, 2, 2); // k, total
+  outer.append_instruction(LOADC, 1, 0);
+  outer.append_instruction(MOVE, 3, 0);
+  outer.append_instruction(MOVE, 2, 0);
+  outer.append_instruction(OP, 0, 0);
+  outer.append_instruction(OP, 1, 0);
+  outer.append_instruction(JMP, -7, 0);
+  outer.append_instruction(RET, 0, 0);
+  outer.set_register_size(3);
+
+  for (int64_t n : {0, 1, 4}) {
+    Stack stack{n};
+    inner.run(stack);
+    ASSERT_EQ(stack.size(), 1);
+    EXPECT_EQ(stack[0].toInt(), n == 0 ? -1 : n * (n - 1) / 2);
+  }
+  // -1 + 0 + 1 + 3 + 6
+  Stack stack{int64_t(5)};
+  outer.run(stack);
+  ASSERT_EQ(stack.size(), 1);
+  EXPECT_EQ(stack[0].toInt(), 9);
+}
+
 namespace {
 static auto reg =
     torch::class_<TorchBindLiteInterpreterTestStruct>(
@@ -43,8 +43,10 @@
 #include <torch/csrc/jit/runtime/argument_spec.h>
 #include <torch/csrc/jit/runtime/autodiff.h>
 #include <torch/csrc/jit/runtime/custom_operator.h>
+#include <torch/csrc/jit/runtime/disk_cache.h>
 #include <torch/csrc/jit/runtime/graph_executor.h>
 #include <torch/csrc/jit/runtime/interpreter.h>
+#include <torch/csrc/jit/runtime/profiling_graph_cache.h>
 #include <torch/csrc/jit/runtime/profiling_record.h>
 #include <torch/csrc/jit/runtime/symbolic_script.h>
 #include <torch/csrc/jit/serialization/import.h>
@@ -56,9 +58,11 @@
 
 #include <c10/util/Exception.h>
 #include <c10/util/ThreadLocalDebugInfo.h>
+#include <c10/util/tempfile.h>
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdio>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -1432,6 +1436,119 @@ TEST(FallbackGraphsTest, Basic) {
   }
 }
 
+TEST(ProfilingExecutorTest, KeepsPlanPerInputSpecialization) {
+  auto graph_string = R"IR(
+    graph(%0 : Tensor,
+          %1 : Tensor):
+      %2 : Tensor = aten::mul(%0, %1)
+      %3 : Tensor = aten::mul(%2, %0)
+      return (%3))IR";
+  auto graph = std::make_shared<Graph>();
+  torch::jit::parseIR(graph_string, graph.get());
+
+  EnableProfilingGuard epg;
+  size_t old_num_specializations = getNumSpecializations();
+  getNumSpecializations() = 2;
+  GraphFunction f("specializedGraph", graph, nullptr);
+  // runs f on inputs of size n and returns the graph that was run
+  auto run = [&](int64_t n) {
+    auto x = at::randn({n}, at::kCPU);
+    auto y = at::randn({n}, at::kCPU);
+    auto stack = createStack({x, y});
+    f.run(stack);
+    EXPECT_TRUE(pop(stack).toTensor().equal(x * y * x));
+    return lastExecutedOptimizedGraph();
+  };
+
+  std::shared_ptr<Graph> plan_2, plan_3;
+  for (size_t i = 0; i < getNumProfiledRuns() + 1; i++) {
+    plan_2 = run(2);
+  }
+  for (size_t i = 0; i < getNumProfiledRuns() + 1; i++) {
+    plan_3 = run(3);
+  }
+  ASSERT_NE(plan_2, plan_3);
+  testing::FileCheck().check_not("prim::profile")->run(*plan_3);
+  ASSERT_EQ(run(2), plan_2);
+  ASSERT_EQ(run(3), plan_3);
+  // there is no room for a third plan, so other inputs run the first one
+  ASSERT_EQ(run(4), plan_2);
+
+  getNumSpecializations() = old_num_specializations;
+}
+
+TEST(ProfilingGraphCacheTest, SkipsProfilingOfCachedGraph) {
+  auto graph_string = R"IR(
+    graph(%0 : Tensor,
+          %1 : Tensor):
+      %2 : Tensor = aten::mul(%0, %1)
+      %3 : Tensor = aten::mul(%2, %0)
+      return (%3))IR";
+  auto graph = std::make_shared<Graph>();
+  torch::jit::parseIR(graph_string, graph.get());
+
+  // use the directory of a fresh temporary file as the cache directory
+  auto tmp = c10::make_tempfile();
+  auto dir = tmp.name.substr(0, tmp.name.rfind('/'));
+  setProfilingGraphCacheDir(dir);
+
+  auto x = at::randn({2}, at::kCPU);
+  auto y = at::randn({2}, at::kCPU);
+  auto expected = x * y * x;
+  std::string key;
+  {
+    EnableProfilingGuard epg;
+    GraphFunction f("cachedGraph", graph, nullptr);
+    for (size_t i = 0; i < getNumProfiledRuns() + 1; i++) {
+      auto stack = createStack({x, y});
+      if (i == 0) {
+        key = profilingGraphCacheKey(*f.optimized_graph(), stack);
+      }
+      f.run(stack);
+      ASSERT_TRUE(pop(stack).toTensor().equal(expected));
+    }
+    ASSERT_TRUE(loadProfiledGraph(key));
+
+    // a new executor starts from the profiled graph in the cache
+    GraphFunction g("cachedGraph", graph, nullptr);
+    auto stack = createStack({x, y});
+    g.run(stack);
+    ASSERT_TRUE(pop(stack).toTensor().equal(expected));
+    testing::FileCheck()
+        .check_not("prim::profile")
+        ->run(*lastExecutedOptimizedGraph());
+  }
+
+  std::remove((dir + "/" + key + ".ir").c_str());
+  setProfilingGraphCacheDir("");
+}
+
+TEST(DiskCacheTest, StoresAndLoadsEntries) {
+  DiskCache cache("PYTORCH_JIT_TEST_DISK_CACHE_DIR_UNSET", ".entry");
+  // disabled without a directory
+  ASSERT_TRUE(cache.dir().empty());
+  ASSERT_FALSE(cache.store("key", "contents"));
+  ASSERT_FALSE(cache.load("key"));
+
+  auto tmp = c10::make_tempfile();
+  auto dir = tmp.name.substr(0, tmp.name.rfind('/'));
+  cache.setDir(dir);
+  const std::string key = "disk_cache_test_" +
+      tmp.name.substr(tmp.name.rfind('/') + 1);
+  ASSERT_FALSE(cache.load(key));
+  // binary contents survive the round trip
+  const std::string contents("a\0b\nc", 5);
+  ASSERT_TRUE(cache.store(key, contents));
+  auto loaded = cache.load(key);
+  ASSERT_TRUE(loaded);
+  ASSERT_EQ(*loaded, contents);
+  // a later store replaces the entry
+  ASSERT_TRUE(cache.store(key, "other"));
+  ASSERT_EQ(*cache.load(key), "other");
+
+  std::remove((dir + "/" + key + ".entry").c_str());
+}
+
 // TODO this test wasn't running and is broken.
 // TEST(AutogradProfilerTest, Basic) {
 //   constexpr int batch_size = 4;
@@ -6,9 +6,13 @@
 #include <torch/csrc/jit/serialization/export.h>
 #include <torch/csrc/jit/serialization/import.h>
 #include <torch/csrc/jit/serialization/import_source.h>
+#include <torch/csrc/jit/serialization/record_prefetcher.h>
 #include <torch/torch.h>
 
+#include <c10/util/tempfile.h>
+
 #include "caffe2/serialize/istream_adapter.h"
+#include "caffe2/serialize/mmap_adapter.h"
 
 namespace torch {
 namespace jit {
@@ -120,6 +124,101 @@ TEST(SerializationTest, TypeTags) {
   }
 }
 
+TEST(SerializationTest, ParallelRecordLoading) {
+  Module m("__torch__.m");
+  std::vector<at::Tensor> params;
+  for (int i = 0; i < 20; i++) {
+    params.push_back(at::randn({i + 1, 7}));
+    m.register_parameter("p" + c10::to_string(i), params.back(), false);
+  }
+  // a storage referred to twice is stored once
+  m.register_buffer("view", params[3].view({-1}));
+
+  auto tmp = c10::make_tempfile();
+  m.save(tmp.name);
+
+  auto check = [&](const Module& loaded) {
+    for (int i = 0; i < 20; i++) {
+      ASSERT_TRUE(loaded.attr("p" + c10::to_string(i))
+                      .toTensor()
+                      .equal(params[i]));
+    }
+    ASSERT_TRUE(loaded.attr("view").toTensor().equal(params[3].view({-1})));
+  };
+
+  const int old_num_threads = getNumRecordReadThreads();
+  for (int num_threads : {0, 1, 4}) {
+    getNumRecordReadThreads() = num_threads;
+    check(torch::jit::load(tmp.name));
+    check(torch::jit::load(
+        std::make_shared<caffe2::serialize::MmapAdapter>(tmp.name)));
+  }
+  getNumRecordReadThreads() = old_num_threads;
+}
+
+TEST(SerializationTest, CompressedTensorRecords) {
+  Module m("__torch__.m");
+  std::vector<at::Tensor> params;
+  for (int i = 0; i < 10; i++) {
+    params.push_back(at::zeros({i + 1, 1024}));
+    m.register_parameter("p" + c10::to_string(i), params.back(), false);
+  }
+
+  std::stringstream uncompressed;
+  m.save(uncompressed);
+  const int old_level = getTensorRecordCompressionLevel();
+  getTensorRecordCompressionLevel() = 1;
+  std::stringstream compressed;
+  m.save(compressed);
+  getTensorRecordCompressionLevel() = old_level;
+  ASSERT_LT(compressed.str().size(), uncompressed.str().size());
+
+  auto loaded = torch::jit::load(compressed);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_TRUE(
+        loaded.attr("p" + c10::to_string(i)).toTensor().equal(params[i]));
+  }
+}
+
+TEST(SerializationTest, LazyLoading) {
+  Module m("__torch__.m");
+  auto weight = at::randn({64, 16});
+  m.register_parameter("weight", weight, false);
+  auto tmp = c10::make_tempfile();
+  m.save(tmp.name);
+
+  auto loaded = torch::jit::load_lazily(tmp.name);
+  auto loaded_weight = loaded.attr("weight").toTensor();
+  ASSERT_TRUE(loaded_weight.device().is_cpu());
+  ASSERT_TRUE(loaded_weight.equal(weight));
+
+  // writes are private to the module
+  loaded_weight.add_(1);
+  ASSERT_TRUE(loaded_weight.equal(weight + 1));
+  ASSERT_TRUE(torch::jit::load_lazily(tmp.name)
+                  .attr("weight")
+                  .toTensor()
+                  .equal(weight));
+}
+
+TEST(SerializationTest, LoadToDevice_CUDA) {
+  Module m("__torch__.m");
+  std::vector<at::Tensor> params;
+  for (int i = 0; i < 10; i++) {
+    params.push_back(at::randn({i + 1, 1024}));
+    m.register_parameter("p" + c10::to_string(i), params.back(), false);
+  }
+  auto tmp = c10::make_tempfile();
+  m.save(tmp.name);
+
+  auto loaded = torch::jit::load(tmp.name, at::Device(at::kCUDA));
+  for (int i = 0; i < 10; i++) {
+    auto p = loaded.attr("p" + c10::to_string(i)).toTensor();
+    ASSERT_TRUE(p.is_cuda());
+    ASSERT_TRUE(p.cpu().equal(params[i]));
+  }
+}
+
 TEST(SerializationTest, TestJitStream_CUDA) {
   torch::jit::Module model;
   std::vector<torch::jit::IValue> inputs;
@@ -478,6 +478,17 @@ graph(%a, %b):
         &pattern);
     AT_ASSERT(!findPatternMatches(pattern, graph).empty());
   }
+  {
+    Graph pattern;
+    parseIR(
+        R"IR(
+graph(%a, %b):
+  %c = a::c[myattr="qq"](%a, %b)
+  return (%c))IR",
+        &pattern);
+    // Plain names must match the whole attribute, like a regex would.
+    AT_ASSERT(findPatternMatches(pattern, graph).empty());
+  }
 }
 
 TEST(SubgraphMatcherTest, BadPattern) {
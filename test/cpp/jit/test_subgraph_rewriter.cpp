@@ -244,5 +244,48 @@ graph(%a, %b):
     FileCheck().check_not("db::fused")->run(*g);
   }
 }
+
+TEST(SubgraphRewriterTest, ReuseAcrossGraphs) {
+  auto graph = std::make_shared<Graph>();
+  parseIR(
+      R"IR(
+graph(%x):
+  %a = a::aaa(%x)
+  %b = b::bbb(%a)
+  return (%b))IR",
+      graph.get());
+
+  SubgraphRewriter rewriter;
+  rewriter.RegisterRewritePattern(
+      R"IR(
+graph(%x):
+  %a = a::aaa(%x)
+  return (%a))IR",
+      R"IR(
+graph(%x):
+  %c = c::ccc(%x)
+  return (%c))IR");
+
+  auto g1 = graph->copy();
+  rewriter.runOnGraph(g1);
+  FileCheck().check("c::ccc")->check("b::bbb")->run(*g1);
+
+  // Patterns registered after a run are picked up by the next one, and the
+  // earlier ones still apply.
+  rewriter.RegisterRewritePattern(
+      R"IR(
+graph(%x):
+  %b = b::bbb(%x)
+  return (%b))IR",
+      R"IR(
+graph(%x):
+  %d = d::ddd(%x)
+  return (%d))IR");
+
+  auto g2 = graph->copy();
+  rewriter.runOnGraph(g2);
+  FileCheck().check("c::ccc")->check("d::ddd")->run(*g2);
+  FileCheck().check_not("a::aaa")->check_not("b::bbb")->run(*g2);
+}
 } // namespace jit
 } // namespace torch
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/ir/irparser.h>
+#include <torch/csrc/jit/passes/symbolic_shape_analysis.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+std::vector<c10::ShapeSymbol> symbolicSizes(Value* v) {
+  auto sizes = v->type()->expect<TensorType>()->symbolic_sizes().sizes();
+  TORCH_INTERNAL_ASSERT(sizes.has_value());
+  return *sizes;
+}
+
+c10::ShapeSymbol staticSize(int64_t size) {
+  return c10::ShapeSymbol::fromStaticSize(size);
+}
+
+} // namespace
+
+TEST(SymbolicShapeAnalysisTest, LinearAndView) {
+  auto graph = std::make_shared<Graph>();
+  std::unordered_map<std::string, Value*> vmap;
+  parseIR(
+      R"IR(
+graph(%x : Float(*, 64),
+      %w : Float(128, 64),
+      %b : Float(128)):
+  %zero : int = prim::Constant[value=0]()
+  %two : int = prim::Constant[value=2]()
+  %minus_one : int = prim::Constant[value=-1]()
+  %y : Tensor = aten::linear(%x, %w, %b)
+  %batch : int = aten::size(%x, %zero)
+  %sizes : int[] = prim::ListConstruct(%batch, %two, %minus_one)
+  %z : Tensor = aten::view(%y, %sizes)
+  return (%z)
+  )IR",
+      graph.get(),
+      vmap);
+  PropagateSymbolicShapes(graph);
+  auto batch = symbolicSizes(vmap["x"])[0];
+  EXPECT_FALSE(batch.is_static());
+  EXPECT_EQ(
+      symbolicSizes(vmap["y"]),
+      std::vector<c10::ShapeSymbol>({batch, staticSize(128)}));
+  EXPECT_EQ(
+      symbolicSizes(vmap["z"]),
+      std::vector<c10::ShapeSymbol>({batch, staticSize(2), staticSize(64)}));
+}
+
+TEST(SymbolicShapeAnalysisTest, Broadcast) {
+  auto graph = std::make_shared<Graph>();
+  std::unordered_map<std::string, Value*> vmap;
+  parseIR(
+      R"IR(
+graph(%x : Float(*, 1, 5),
+      %y : Float(3, 1),
+      %z : Float(*, 3, 5)):
+  %one : int = prim::Constant[value=1]()
+  %a : Tensor = aten::add(%x, %y, %one)
+  %c : Tensor = aten::mul(%x, %z)
+  return (%a, %c)
+  )IR",
+      graph.get(),
+      vmap);
+  PropagateSymbolicShapes(graph);
+  auto x = symbolicSizes(vmap["x"]);
+  auto z = symbolicSizes(vmap["z"]);
+  EXPECT_EQ(
+      symbolicSizes(vmap["a"]),
+      std::vector<c10::ShapeSymbol>({x[0], staticSize(3), staticSize(5)}));
+  // two different symbols broadcast to an unknown size
+  auto c = symbolicSizes(vmap["c"]);
+  ASSERT_EQ(c.size(), 3u);
+  EXPECT_FALSE(c[0].is_static());
+  EXPECT_FALSE(c[0] == x[0]);
+  EXPECT_FALSE(c[0] == z[0]);
+  EXPECT_EQ(c[1], staticSize(3));
+}
+
+TEST(SymbolicShapeAnalysisTest, SameConvolution) {
+  auto graph = std::make_shared<Graph>();
+  std::unordered_map<std::string, Value*> vmap;
+  parseIR(
+      R"IR(
+graph(%x : Float(*, 3, *, *),
+      %w : Float(8, 3, 3, 3)):
+  %none : NoneType = prim::Constant()
+  %stride : int[] = prim::Constant[value=[1, 1]]()
+  %padding : int[] = prim::Constant[value=[1, 1]]()
+  %dilation : int[] = prim::Constant[value=[1, 1]]()
+  %groups : int = prim::Constant[value=1]()
+  %y : Tensor = aten::conv2d(%x, %w, %none, %stride, %padding, %dilation, %groups)
+  return (%y)
+  )IR",
+      graph.get(),
+      vmap);
+  PropagateSymbolicShapes(graph);
+  auto x = symbolicSizes(vmap["x"]);
+  EXPECT_EQ(
+      symbolicSizes(vmap["y"]),
+      std::vector<c10::ShapeSymbol>({x[0], staticSize(8), x[2], x[3]}));
+}
+
+TEST(SymbolicShapeAnalysisTest, CatAndIf) {
+  auto graph = std::make_shared<Graph>();
+  std::unordered_map<std::string, Value*> vmap;
+  parseIR(
+      R"IR(
+graph(%x : Float(*, 4),
+      %y : Float(*, 4),
+      %cond : bool):
+  %zero : int = prim::Constant[value=0]()
+  %list : Tensor[] = prim::ListConstruct(%x, %y)
+  %c : Tensor = aten::cat(%list, %zero)
+  %r : Tensor = prim::If(%cond)
+    block0():
+      %t : Tensor = aten::relu(%x)
+      -> (%t)
+    block1():
+      -> (%x)
+  return (%c, %r)
+  )IR",
+      graph.get(),
+      vmap);
+  PropagateSymbolicShapes(graph);
+  auto x = symbolicSizes(vmap["x"]);
+  auto y = symbolicSizes(vmap["y"]);
+  auto c = symbolicSizes(vmap["c"]);
+  ASSERT_EQ(c.size(), 2u);
+  EXPECT_FALSE(c[0].is_static());
+  EXPECT_FALSE(c[0] == x[0]);
+  EXPECT_FALSE(c[0] == y[0]);
+  EXPECT_EQ(c[1], staticSize(4));
+  EXPECT_EQ(symbolicSizes(vmap["r"]), x);
+}
+
+} // namespace jit
+} // namespace torch
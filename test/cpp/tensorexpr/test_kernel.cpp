@@ -124,6 +124,53 @@ TEST_F(Kernel, _1) {
   }
 }
 
+TEST_F(Kernel, SymbolicShapes) {
+  KernelScope kernel_scope;
+
+  const auto graph_string = R"IR(
+      graph(%0 : Float(5, 3, strides=[3, 1], device=cpu),
+            %1 : Float(5, 3, strides=[3, 1], device=cpu)):
+        %2 : Float(5, 3, strides=[3, 1]) = aten::mul(%0, %1)
+        %3 : Float(5, 3, strides=[3, 1]) = aten::mul(%0, %2)
+        return (%3))IR";
+  auto graph = std::make_shared<Graph>();
+  parseIR(graph_string, &*graph);
+
+  // make the first dim symbolic, as profiling does when it varies
+  auto type = TensorType::create(
+      at::kFloat,
+      at::kCPU,
+      c10::SymbolicShape(std::vector<c10::ShapeSymbol>{
+          c10::ShapeSymbol::newSymbol(), c10::ShapeSymbol::fromStaticSize(3)}),
+      c10::VaryingShape<c10::Stride>(std::vector<c10::Stride>{
+          c10::Stride(1, true, 1), c10::Stride(0, true, c10::nullopt)}),
+      false);
+  ASSERT_TRUE(symbolicShapeIsSupported(type));
+  for (Value* v : graph->inputs()) {
+    v->setType(type);
+  }
+  for (Node* n : graph->nodes()) {
+    n->output()->setType(type);
+  }
+
+  TensorExprKernel k(graph);
+  // one kernel for all the sizes of the first dim
+  for (int64_t n : {5, 7, 1}) {
+    auto a = at::rand({n, 3}, TensorOptions(kCPU).dtype(at::kFloat));
+    auto b = at::rand({n, 3}, TensorOptions(kCPU).dtype(at::kFloat));
+    std::vector<IValue> stack = fmap<IValue>(std::vector<at::Tensor>({a, b}));
+    k.run(stack);
+    ASSERT_TRUE(at::allclose(stack[0].toTensor(), a * (a * b)));
+  }
+
+  // inputs that do not fit the kernel run the fallback
+  auto a = at::rand({4, 2}, TensorOptions(kCPU).dtype(at::kFloat));
+  auto b = at::rand({4, 2}, TensorOptions(kCPU).dtype(at::kFloat));
+  std::vector<IValue> stack = fmap<IValue>(std::vector<at::Tensor>({a, b}));
+  k.run(stack);
+  ASSERT_TRUE(at::allclose(stack[0].toTensor(), a * (a * b)));
+}
+
 TEST_F(Kernel, _2) {
   KernelScope kernel_scope;
 
@@ -1016,6 +1063,34 @@ TEST_F(Kernel, Softmax4D) {
   }
 }
 
+TEST_F(Kernel, SoftmaxWithProducerAndConsumer) {
+  KernelScope kernel_scope;
+
+  // The scaling of attention scores before a softmax and the mul after it.
+  const auto graph_string = R"IR(
+      graph(%0 : Float(4, 16, strides=[16, 1], device=cpu),
+            %1 : Float(4, 16, strides=[16, 1], device=cpu)):
+        %2 : float = prim::Constant[value=0.125]()
+        %3 : Float(4, 16, strides=[16, 1]) = aten::mul(%0, %2)
+        %4 : int = prim::Constant[value=1]()
+        %5 : NoneType = prim::Constant()
+        %6 : Float(4, 16, strides=[16, 1]) = aten::softmax(%3, %4, %5)
+        %7 : Float(4, 16, strides=[16, 1]) = aten::mul(%6, %1)
+        return (%7))IR";
+  auto graph = std::make_shared<Graph>();
+  parseIR(graph_string, &*graph);
+
+  TensorExprKernel k(graph);
+  auto a = at::rand({4, 16}, TensorOptions(kCPU).dtype(at::kFloat));
+  auto b = at::rand({4, 16}, TensorOptions(kCPU).dtype(at::kFloat));
+  std::vector<at::Tensor> inputs = {a, b};
+  std::vector<IValue> stack = fmap<IValue>(inputs);
+  k.run(stack);
+  auto o = stack[0].toTensor();
+  auto ref = (a * 0.125).softmax(1) * b;
+  ASSERT_TRUE(at::allclose(o, ref));
+}
+
 TEST_F(Kernel, DISABLED_InlineProducerIntoReduction) {
   // see : [zero-dim tensors]
   KernelScope kernel_scope;
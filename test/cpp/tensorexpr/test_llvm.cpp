@@ -1623,6 +1623,37 @@ TEST(LLVM, SimpleParallel) {
   }
 }
 
+TEST(LLVM, ParallelizeWithTail) {
+  ExecutionCounter counter(llvm_codegen_parallel_dispatched);
+  KernelScope kernel_scope;
+  const int N = 103;
+  Tensor* f = Compute("f", {{N, "n"}}, [](const VarHandle& n) {
+    return cast<float>(n * 2);
+  });
+  LoopNest loop_nest({f});
+  For* loop = loop_nest.getLoopStmtsFor(f)[0];
+  For* outer = nullptr;
+  For* inner = nullptr;
+  For* tail = nullptr;
+  LoopNest::parallelizeWithTail(loop, 4, &outer, &inner, &tail);
+  ASSERT_TRUE(outer->is_parallel());
+  ASSERT_FALSE(inner->is_parallel());
+  // 103 = 4 * 25 + 3
+  ASSERT_NE(tail, nullptr);
+  loop_nest.prepareForCodegen();
+  LLVMCodeGen cg(loop_nest.root_stmt(), {f});
+
+  PaddedBuffer<float> f_v(N, "f_v");
+  std::vector<void*> args({f_v.data()});
+  ASSERT_EQ(cg.value<int>(args), 0);
+  PaddedBuffer<float> f_ref(N, "f_ref");
+  for (int n = 0; n < N; n++) {
+    f_ref(n) = n * 2;
+  }
+  ExpectAllNear(f_v, f_ref, 1e-5);
+  ASSERT_GT(counter.elapsed_value(), 0);
+}
+
 TEST(LLVM, CompositeParallel) {
   int loop_count = 6;
   int test_count = 1 << loop_count;
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <c10/util/tempfile.h>
+
 #include <test/cpp/tensorexpr/test_base.h>
 #include <memory>
 #include <sstream>
@@ -13,6 +15,7 @@
 #include <torch/csrc/jit/tensorexpr/ir.h>
 #include <torch/csrc/jit/tensorexpr/ir_printer.h>
 #include <torch/csrc/jit/tensorexpr/ir_simplifier.h>
+#include <torch/csrc/jit/tensorexpr/loop_schedule.h>
 #include <torch/csrc/jit/tensorexpr/loopnest.h>
 #include <torch/csrc/jit/tensorexpr/tensor.h>
 #include <torch/csrc/jit/testing/file_check.h>
@@ -5222,5 +5225,87 @@ TEST(LoopNest, reorderInvalidLoopNest) {
       "reorder is only allowed on perfectly nested loops");
 }
 
+TEST(LoopNest, TileInnerLoops) {
+  KernelScope kernel_scope;
+  const int N = 32;
+  Placeholder a(BufHandle("a", {N, N}, kFloat));
+  Tensor* t = Compute(
+      "t", {{N, "i"}, {N, "j"}}, [&](const VarHandle& i, const VarHandle& j) {
+        return a.load(j, i);
+      });
+  LoopNest l({t});
+  // tiles must divide the loops evenly
+  LoopNest l_uneven(l);
+  ASSERT_EQ(tileInnerLoops(l_uneven, t->buf(), 12), nullptr);
+  ASSERT_NE(tileInnerLoops(l, t->buf(), 8), nullptr);
+
+  checkIR(l.root_stmt(), R"IR(
+# CHECK: for (int i_outer = 0; i_outer < 4
+# CHECK-NEXT: for (int j_outer = 0; j_outer < 4
+# CHECK-NEXT: for (int i_inner = 0; i_inner < 8
+# CHECK-NEXT: for (int j_inner = 0; j_inner < 8)IR");
+
+  l.prepareForCodegen();
+  Stmt* s = IRSimplifier::simplify(l.root_stmt());
+  std::vector<float> a_v(N * N);
+  std::vector<float> t_v(N * N);
+  for (int i = 0; i < N * N; ++i) {
+    a_v[i] = i;
+  }
+  SimpleIREvaluator cg(s, {a, t});
+  cg.call({a_v, t_v});
+  for (int i = 0; i < N; ++i) {
+    for (int j = 0; j < N; ++j) {
+      ASSERT_EQ(t_v[i * N + j], a_v[j * N + i]);
+    }
+  }
+}
+
+TEST(LoopNest, SearchLoopSchedules) {
+  KernelScope kernel_scope;
+  const int N = 1024;
+  Placeholder a(BufHandle("a", {N, N}, kFloat));
+
+  // A transpose reads a with a large stride along the inner loop, tiling
+  // keeps the lines it reads in cache.
+  Tensor* transpose = Compute(
+      "transpose",
+      {{N, "i"}, {N, "j"}},
+      [&](const VarHandle& i, const VarHandle& j) { return a.load(j, i); });
+  LoopNest l_transpose({transpose});
+  auto schedules = searchLoopSchedules(l_transpose, {transpose->buf()});
+  ASSERT_GT(schedules.size(), 1u);
+  ASSERT_GT(schedules.front().tile, 0);
+
+  // A copy reads a contiguously, so the default schedule is cheapest.
+  Tensor* copy = Compute(
+      "copy",
+      {{N, "i"}, {N, "j"}},
+      [&](const VarHandle& i, const VarHandle& j) { return a.load(i, j); });
+  LoopNest l_copy({copy});
+  schedules = searchLoopSchedules(l_copy, {copy->buf()});
+  ASSERT_EQ(schedules.front(), LoopSchedule());
+}
+
+TEST(LoopNest, TuningLog) {
+  auto tmp = c10::make_tempfile();
+  setTETuningLogPath(tmp.name);
+  auto key = loopScheduleKey("kernel");
+  ASSERT_FALSE(lookupTunedLoopSchedule(key).has_value());
+
+  LoopSchedule schedule;
+  schedule.tile = 16;
+  schedule.parallel = false;
+  recordTunedLoopSchedule(key, schedule);
+  ASSERT_EQ(*lookupTunedLoopSchedule(key), schedule);
+
+  // entries are read back from the file
+  setTETuningLogPath("");
+  ASSERT_FALSE(lookupTunedLoopSchedule(key).has_value());
+  setTETuningLogPath(tmp.name);
+  ASSERT_EQ(*lookupTunedLoopSchedule(key), schedule);
+  setTETuningLogPath("");
+}
+
 } // namespace jit
 } // namespace torch
@@ -1803,6 +1803,60 @@ TEST(Reductions, ReductionVectorizeRfactor) {
   ASSERT_EQ(out_before[0], out_after[0]);
 }
 
+TEST(Reductions, VectorizeReduction) {
+  KernelScope kernel_scope;
+
+  const int M = 4;
+  const int N = 16;
+  std::vector<float> in_(M * N);
+  for (int i = 0; i < M * N; ++i) {
+    in_[i] = i;
+  }
+  std::vector<float> out_before(M, -1.f);
+  std::vector<float> out_after(M, -1.f);
+
+  Placeholder in(BufHandle("in", {M, N}, kFloat));
+  Tensor* tensor = Reduce("sum", {{M, "m"}}, Sum(), in, {{N, "n"}});
+
+  LoopNest l_before({tensor});
+  LoopNest l(l_before);
+  l_before.prepareForCodegen();
+  SimpleIREvaluator cg_before(l_before.root_stmt(), {in, tensor});
+  cg_before.call({in_, out_before});
+
+  ASSERT_TRUE(l.vectorizeReduction(tensor->buf(), 8));
+  l.simplify();
+
+  std::ostringstream oss;
+  oss << *l.root_stmt();
+  const std::string& expected_ir =
+      R"IR(
+#CHECK: for (int m = 0; m < 4; m++) {
+#CHECK:   sum_rfac[Ramp(
+#CHECK:   for (int n_outer = 0; n_outer < 2; n_outer++) {
+#CHECK:     sum_rfac[Ramp(
+#CHECK-SAME: in[Ramp(
+#CHECK-SAME: reduce_args={n_outer}
+#CHECK:   for (int n_inner = 0; n_inner < 8; n_inner++) {
+#CHECK:     sum[m] = ReduceOp(
+#CHECK-SAME: reduce_args={n_inner}
+      )IR";
+  torch::jit::testing::FileCheck().run(expected_ir, oss.str());
+
+  l.prepareForCodegen();
+  Stmt* s = IRSimplifier::simplify(l.root_stmt());
+  SimpleIREvaluator cg_after(s, {in, tensor});
+  cg_after.call({in_, out_after});
+  for (int i = 0; i < M; ++i) {
+    ASSERT_EQ(out_before[i], out_after[i]);
+  }
+
+  // The extent of the reduction axis must be a multiple of the lanes.
+  Tensor* odd = Reduce("odd", {{M, "m"}}, Sum(), in, {{12, "n"}});
+  LoopNest l_odd({odd});
+  ASSERT_FALSE(l_odd.vectorizeReduction(odd->buf(), 8));
+}
+
 TEST(Reductions, InitFunction) {
   KernelScope ks;
   constexpr int M = 32;
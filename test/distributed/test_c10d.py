@@ -258,6 +258,18 @@ class StoreTestBase(object):
         self.assertEqual(b"new_value0", new_value_result)
         self.assertEqual(b"new_value0", store.get("key0"))
 
+    def test_multi_set_get(self):
+        store = self._create_store()
+        store.multi_set(["key0", "key1"], ["value0", "value1"])
+        store.set("key2", "value2")
+        self.assertEqual(
+            [b"value0", b"value1", b"value2"],
+            store.multi_get(["key0", "key1", "key2"]),
+        )
+        self.assertEqual([], store.multi_get([]))
+        with self.assertRaisesRegex(RuntimeError, "as many values as keys"):
+            store.multi_set(["key0"], [])
+
     # This is the number of keys used in test_set_get. Adding this as a class
     # property instead of hardcoding in the test since some Store
     # implementations will have differing number of keys. In the base case,
@@ -369,6 +381,23 @@ class TCPStoreTest(TestCase, StoreTestBase):
     def test_numkeys_delkeys(self):
         self._test_numkeys_delkeys(self._create_store())
 
+    def test_multi_get_waits_for_keys(self):
+        store = self._create_store()
+        client = dist.TCPStore("localhost", store.port, 1, timeout=timedelta(seconds=10))
+        store.set("key0", "value0")
+
+        def set_later():
+            time.sleep(0.1)
+            client.multi_set(["key1", "key2"], ["value1", "value2"])
+
+        thread = threading.Thread(target=set_later)
+        thread.start()
+        self.assertEqual(
+            [b"value0", b"value1", b"value2"],
+            store.multi_get(["key0", "key1", "key2"]),
+        )
+        thread.join()
+
     def _create_client(self, index, addr, port, world_size, messages):
         try:
             client_store = dist.TCPStore(addr, port, world_size, timeout=timedelta(seconds=10))
@@ -993,6 +1022,34 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
     def test_allreduce_basics_cuda(self):
         self._test_allreduce_basics(lambda t: t.clone().cuda())
 
+    @unittest.skipIf(not sys.platform.startswith("linux"), "shm_allreduce is Linux only")
+    def test_allreduce_shm(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        opts = self.opts(threads=8)
+        opts._shm_allreduce = True
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, opts)
+
+        # Bitwise ops fall back to Gloo.
+        for (op, input, output) in simple_reduce_tests(self.rank, self.world_size):
+            opts = c10d.AllreduceOptions()
+            opts.reduceOp = op
+            tensor = input.clone()
+            pg.allreduce([tensor], opts).wait()
+            # TODO(#38095): Replace assertEqualIgnoreType. See issue #38095
+            self.assertEqualIgnoreType(output, tensor)
+
+        # Spans several chunks of the segment, and issues allreduces that the
+        # worker threads run concurrently.
+        tensors = [
+            torch.full((300000 + i,), float(self.rank + i), dtype=torch.float64)
+            for i in range(4)
+        ]
+        works = [pg.allreduce(tensor) for tensor in tensors]
+        for i, (work, tensor) in enumerate(zip(works, tensors)):
+            work.wait()
+            expected = float(sum(rank + i for rank in range(self.world_size)))
+            self.assertEqual(torch.full_like(tensor, expected), tensor)
+
     def _test_allreduce_stress(self, inputs):
         store = c10d.FileStore(self.file_name, self.world_size)
         pg = c10d.ProcessGroupGloo(
@@ -1798,6 +1855,70 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
                 self.assertEqual(torch.full([10, 10], float(self.world_size)), tensor)
             del pg
 
+    def _test_pipeline_executor(self, num_chunks):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        forward_group, backward_group = [
+            c10d.ProcessGroupGloo(
+                c10d.PrefixStore(prefix, store), self.rank, self.world_size, self.opts()
+            )
+            for prefix in ("forward", "backward")
+        ]
+        num_micro_batches = 2 * self.world_size
+        torch.manual_seed(0)
+        layers = [nn.Linear(4, 4) for _ in range(self.world_size * num_chunks)]
+        inputs = [torch.randn(2, 4) for _ in range(num_micro_batches)]
+        targets = [torch.randn(2, 4) for _ in range(num_micro_batches)]
+
+        # Expected losses and gradients, running the whole model in order.
+        reference = copy.deepcopy(layers)
+        expected_losses = []
+        for input, target in zip(inputs, targets):
+            for layer in reference:
+                input = layer(input)
+            loss = F.mse_loss(input, target)
+            loss.backward()
+            expected_losses.append(loss.detach())
+
+        # Chunk c of stage s holds layer c * world_size + s.
+        local_layers = layers[self.rank::self.world_size]
+
+        def make_chunk(layer, returns_loss):
+            if returns_loss:
+                return lambda x, i: F.mse_loss(layer(x), targets[i])
+            return lambda x, i: layer(x)
+
+        chunks = [
+            make_chunk(
+                layer,
+                self.rank == self.world_size - 1 and chunk == num_chunks - 1,
+            )
+            for chunk, layer in enumerate(local_layers)
+        ]
+        executor = c10d._PipelineExecutor(
+            forward_group,
+            backward_group,
+            chunks,
+            num_micro_batches,
+            torch.empty(2, 4),
+        )
+        losses = executor.run(inputs if self.rank == 0 else [])
+
+        if self.rank == self.world_size - 1:
+            self.assertEqual(expected_losses, losses)
+        else:
+            self.assertEqual([], losses)
+        for layer, expected in zip(
+            local_layers, reference[self.rank::self.world_size]
+        ):
+            self.assertEqual(expected.weight.grad, layer.weight.grad)
+            self.assertEqual(expected.bias.grad, layer.bias.grad)
+
+    def test_pipeline_executor_1f1b(self):
+        self._test_pipeline_executor(num_chunks=1)
+
+    def test_pipeline_executor_interleaved(self):
+        self._test_pipeline_executor(num_chunks=2)
+
 
 class ProcessGroupNCCLNoGPUTest(TestCase):
     MAIN_PROCESS_RANK = 0
@@ -1869,6 +1990,21 @@ class ProcessGroupNCCLTest(TestCase):
         pg.reduce_scatter(ys, xs).wait()
         self.assertEqual(0, ys[0].numel())
 
+    @requires_nccl()
+    def test_hierarchical_allreduce_single_host(self):
+        # All the ranks are on one host, so allreduce stays flat and gives the
+        # same result as without the option.
+        store = c10d.FileStore(self.file.name, self.world_size)
+        options = c10d.ProcessGroupNCCL.Options()
+        options.hierarchical_allreduce = True
+        pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size, options)
+        self.assertTrue(pg.options.hierarchical_allreduce)
+
+        for numel in [1, 7, 1024]:
+            xs = [torch.arange(numel, dtype=torch.float, device="cuda:0")]
+            pg.allreduce(xs).wait()
+            self.assertEqual(torch.arange(numel, dtype=torch.float) * self.world_size, xs[0])
+
     @requires_nccl()
     def test_broadcast_ops(self):
         store = c10d.FileStore(self.file.name, self.world_size)
@@ -2094,6 +2230,63 @@ class ProcessGroupNCCLTest(TestCase):
             # TODO(#38095): Replace assertEqualIgnoreType. See issue #38095
             self.assertEqualIgnoreType(expected, output[i])
 
+    @requires_nccl()
+    def test_coalesced_ops(self):
+        store = c10d.FileStore(self.file.name, self.world_size)
+        pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
+
+        # Tensors of a coalesced collective may differ in type and shape.
+        def make_tensors():
+            return [
+                torch.arange(6, device="cuda:0").view(2, 3),
+                torch.tensor([1.5], device="cuda:0"),
+                torch.ones(3, dtype=torch.half, device="cuda:0"),
+            ]
+
+        tensors = make_tensors()
+        pg.allreduce_coalesced(tensors).wait()
+        for actual, expected in zip(tensors, make_tensors()):
+            self.assertEqual(expected, actual)
+
+        tensors = make_tensors()
+        opts = c10d.BroadcastOptions()
+        opts.rootRank = 0
+        pg.broadcast_coalesced(tensors, opts).wait()
+        for actual, expected in zip(tensors, make_tensors()):
+            self.assertEqual(expected, actual)
+
+        output_lists = [[torch.zeros_like(t) for t in make_tensors()]]
+        pg.allgather_coalesced(output_lists, make_tensors()).wait()
+        for actual, expected in zip(output_lists[0], make_tensors()):
+            self.assertEqual(expected, actual)
+
+        outputs = [torch.zeros_like(t) for t in make_tensors()]
+        pg.reduce_scatter_coalesced(outputs, [make_tensors()]).wait()
+        for actual, expected in zip(outputs, make_tensors()):
+            self.assertEqual(expected, actual)
+
+        with self.assertRaisesRegex(RuntimeError, "must be CUDA"):
+            pg.allreduce_coalesced([torch.ones(1, device="cuda:0"), torch.ones(1)])
+
+    @requires_nccl()
+    def test_sparse_allreduce(self):
+        store = c10d.FileStore(self.file.name, self.world_size)
+        pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
+
+        # Duplicate indices are summed and the result is coalesced in place.
+        indices = torch.tensor([[2, 0, 2], [1, 3, 1]])
+        values = torch.tensor([[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]])
+        expected = torch.sparse_coo_tensor(indices, values, (4, 5, 2)).coalesce()
+        tensor = torch.sparse_coo_tensor(indices, values, (4, 5, 2)).cuda(0)
+        pg.allreduce([tensor]).wait()
+        self.assertTrue(tensor.is_coalesced())
+        self.assertEqual(expected, tensor.cpu())
+
+        with self.assertRaisesRegex(RuntimeError, "only supports sparse allreduce with ReduceOp.SUM"):
+            opts = c10d.AllreduceOptions()
+            opts.reduceOp = c10d.ReduceOp.MAX
+            pg.allreduce([tensor], opts)
+
     @requires_nccl()
     def test_barrier(self):
         store = c10d.FileStore(self.file.name, self.world_size)
@@ -2431,6 +2624,27 @@ class DistributedDataParallelTest(MultiProcessTestCase):
     def test_gloo_backend_cpu_module_grad_is_view(self):
         self._test_gloo_backend([torch.device("cpu")], None, gradient_as_bucket_view=True)
 
+    @requires_gloo()
+    def test_ddp_adaptive_bucketing_gloo(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        process_group = c10d.ProcessGroupGloo(store, self.rank, self.world_size)
+        torch.manual_seed(0)
+        model = nn.Sequential(nn.Linear(4, 8), nn.ReLU(), nn.Linear(8, 2))
+        ddp_model = DistributedDataParallel(
+            copy.deepcopy(model), process_group=process_group
+        )
+        ddp_model._enable_adaptive_bucketing(num_iterations=2)
+        input = torch.randn(4, 4)
+        # The buckets are rebuilt in the second iteration, timed in the second
+        # and third ones, and tuned in the fourth one.
+        for _ in range(5):
+            ddp_model.zero_grad()
+            model.zero_grad()
+            ddp_model(input).sum().backward()
+            model(input).sum().backward()
+            for p, ref in zip(ddp_model.parameters(), model.parameters()):
+                self.assertEqual(p.grad, ref.grad)
+
     @requires_gloo()
     @skip_if_lt_x_gpu(2)
     def test_gloo_backend_1gpu_module_device_ids_integer_list(self):
@@ -3779,7 +3993,7 @@ class DistributedDataParallelTest(MultiProcessTestCase):
         return gpu_model
 
     def _gpu_model_with_builtin_ddp_comm_hook(
-        self, process_group, hook=None, gradient_as_bucket_view=False
+        self, process_group, hook=None, gradient_as_bucket_view=False, options=None
     ):
         device_id = gpus_for_rank(self.world_size)[self.rank][0]
         gpu_model = DistributedDataParallel(
@@ -3791,7 +4005,7 @@ class DistributedDataParallelTest(MultiProcessTestCase):
 
         # Register a built-in DDP communication hook if defined
         if hook is not None:
-            gpu_model._register_builtin_comm_hook(hook)
+            gpu_model._register_builtin_comm_hook(hook, options)
 
         return gpu_model
 
@@ -3960,6 +4174,39 @@ class DistributedDataParallelTest(MultiProcessTestCase):
             # check whether the grads are equal to what DDP without hook would return.
             self._run_and_verify_hook(gpu_model, 8, 0.25 * torch.ones(2, 2))
 
+    def _test_builtin_compression_ddp_comm_hooks_nccl(self, gradient_as_bucket_view=False):
+        """
+        This unit test verifies whether built-in C++ DDP communication hooks POWER_SGD
+        and TOPK_SPARSIFY give the same result with the case of no hook registered,
+        both before and after compression starts.
+        """
+        store = c10d.FileStore(self.file_name, self.world_size)
+        process_group = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
+
+        for comm_hook_type, use_error_feedback, warm_start in product(
+            [
+                dist.BuiltinCommHookType.POWER_SGD,
+                dist.BuiltinCommHookType.TOPK_SPARSIFY,
+            ],
+            [True, False],
+            [True, False],
+        ):
+            options = dist.BuiltinCommHookOptions()
+            options.start_iter = 2
+            options.use_error_feedback = use_error_feedback
+            options.warm_start = warm_start
+            # Low enough for the 2 x 2 gradient of the model to be compressed.
+            options.min_compression_rate = 0.5
+            gpu_model = self._gpu_model_with_builtin_ddp_comm_hook(
+                process_group, comm_hook_type, gradient_as_bucket_view, options
+            )
+
+            # The gradients are the same constant on all the ranks, so the
+            # rank-1 approximation of PowerSGD is exact.
+            for _ in range(options.start_iter + 2):
+                gpu_model.zero_grad()
+                self._run_and_verify_hook(gpu_model, 8, 0.25 * torch.ones(2, 2))
+
     @requires_nccl()
     @skip_if_lt_x_gpu(2)
     def test_ddp_comm_hook_allreduce_hook_nccl(self):
@@ -3980,6 +4227,11 @@ class DistributedDataParallelTest(MultiProcessTestCase):
     def test_builtin_ddp_comm_hooks_nccl(self):
         self._test_builtin_ddp_comm_hooks_nccl()
 
+    @requires_nccl()
+    @skip_if_lt_x_gpu(2)
+    def test_builtin_compression_ddp_comm_hooks_nccl(self):
+        self._test_builtin_compression_ddp_comm_hooks_nccl()
+
     @requires_nccl()
     @skip_if_lt_x_gpu(2)
     def test_powerSGD_ddp_comm_hook_nccl(self):
@@ -4024,6 +4276,124 @@ class DistributedDataParallelTest(MultiProcessTestCase):
     def test_builtin_ddp_comm_hooks_nccl_grad_is_view(self):
         self._test_builtin_ddp_comm_hooks_nccl(gradient_as_bucket_view=True)
 
+    @requires_nccl()
+    @skip_if_lt_x_gpu(2)
+    def test_builtin_compression_ddp_comm_hooks_nccl_grad_is_view(self):
+        self._test_builtin_compression_ddp_comm_hooks_nccl(gradient_as_bucket_view=True)
+
+    @requires_nccl()
+    @skip_if_lt_x_gpu(2)
+    def test_ddp_bucket_optimizer_nccl(self):
+        """
+        This unit test verifies whether stepping the parameters per bucket, with and
+        without a communication hook, or sharded, gives the same parameters as stepping
+        them with torch.optim after the backward pass.
+        """
+        store = c10d.FileStore(self.file_name, self.world_size)
+        process_group = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
+        device_id = gpus_for_rank(self.world_size)[self.rank][0]
+
+        for optimizer_type, use_comm_hook, shard_optimizer_state in product(
+            [dist.BucketOptimizerType.SGD, dist.BucketOptimizerType.ADAM],
+            [True, False],
+            [True, False],
+        ):
+            if use_comm_hook and shard_optimizer_state:
+                continue
+            options = dist.BucketOptimizerOptions()
+            options.lr = 0.1
+            options.weight_decay = 0.01
+            options.momentum = 0.9
+            model = ModuleForDdpCommHook().to(device_id)
+            gpu_model = DistributedDataParallel(
+                model,
+                device_ids=[device_id],
+                process_group=process_group,
+                gradient_as_bucket_view=True,
+            )
+            if use_comm_hook:
+                gpu_model._register_builtin_comm_hook(dist.BuiltinCommHookType.ALLREDUCE)
+            gpu_model._register_bucket_optimizer(
+                optimizer_type, options, shard_optimizer_state
+            )
+
+            ref_model = DistributedDataParallel(
+                copy.deepcopy(model),
+                device_ids=[device_id],
+                process_group=process_group,
+            )
+            if optimizer_type == dist.BucketOptimizerType.SGD:
+                optimizer = torch.optim.SGD(
+                    ref_model.parameters(),
+                    lr=options.lr,
+                    momentum=options.momentum,
+                    weight_decay=options.weight_decay,
+                )
+            else:
+                optimizer = torch.optim.Adam(
+                    ref_model.parameters(),
+                    lr=options.lr,
+                    weight_decay=options.weight_decay,
+                )
+
+            for _ in range(3):
+                gpu_model.zero_grad()
+                gpu_model(8, self.rank).mean().backward()
+                optimizer.zero_grad()
+                ref_model(8, self.rank).mean().backward()
+                optimizer.step()
+                self.assertEqual(
+                    list(gpu_model.parameters()), list(ref_model.parameters())
+                )
+
+    @requires_nccl()
+    @skip_if_lt_x_gpu(2)
+    def test_ddp_sharded_bucket_optimizer_uneven_bucket(self):
+        """
+        Shards a bucket whose size is not a multiple of the world size.
+        """
+        store = c10d.FileStore(self.file_name, self.world_size)
+        process_group = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
+        device_id = gpus_for_rank(self.world_size)[self.rank][0]
+        torch.manual_seed(0)
+        # 3 parameters, padded to 4 for 2 ranks.
+        model = nn.Linear(2, 1).to(device_id)
+        gpu_model = DistributedDataParallel(
+            model,
+            device_ids=[device_id],
+            process_group=process_group,
+            gradient_as_bucket_view=True,
+        )
+        options = dist.BucketOptimizerOptions()
+        options.lr = 0.1
+        gpu_model._register_bucket_optimizer(
+            dist.BucketOptimizerType.ADAM, options, shard_optimizer_state=True
+        )
+        ref_model = DistributedDataParallel(
+            copy.deepcopy(model), device_ids=[device_id], process_group=process_group
+        )
+        optimizer = torch.optim.Adam(ref_model.parameters(), lr=options.lr)
+
+        input = torch.randn(4, 2, device=device_id) * (self.rank + 1)
+        for _ in range(3):
+            gpu_model.zero_grad()
+            gpu_model(input).sum().backward()
+            optimizer.zero_grad()
+            ref_model(input).sum().backward()
+            optimizer.step()
+            self.assertEqual(list(gpu_model.parameters()), list(ref_model.parameters()))
+
+    @requires_nccl()
+    @skip_if_lt_x_gpu(2)
+    def test_ddp_bucket_optimizer_requires_grad_is_view(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        process_group = c10d.ProcessGroupNCCL(store, self.rank, self.world_size)
+        gpu_model = self._gpu_model_with_ddp_comm_hook(process_group)
+        with self.assertRaisesRegex(
+            RuntimeError, "requires gradient_as_bucket_view=True"
+        ):
+            gpu_model._register_bucket_optimizer(dist.BucketOptimizerType.SGD)
+
     @requires_nccl()
     @skip_if_lt_x_gpu(2)
     def test_powerSGD_ddp_comm_hook_nccl_grad_is_view(self):
@@ -4533,6 +4903,83 @@ class ComputeBucketAssignmentTest(TestCase):
         result = dist._compute_bucket_assignment_by_size(tensors, [200, 400])
         self.assertEqual([[0], [1], [2, 4], [3, 5]], result)
 
+    def test_by_time_single_bucket(self):
+        tensors = [torch.empty([100], dtype=torch.float) for _ in range(4)]
+        # Ready at the same time, splitting would only add latency.
+        result = dist._compute_bucket_assignment_by_time(
+            tensors, [0.0, 0.0, 0.0, 0.0], 100.0, 0.01
+        )
+        self.assertEqual([[0, 1, 2, 3]], result)
+
+    def test_by_time_spread_ready_times(self):
+        tensors = [torch.empty([100], dtype=torch.float) for _ in range(4)]
+        # Each reduction ends before the next gradient is ready.
+        result = dist._compute_bucket_assignment_by_time(
+            tensors, [0.0, 100.0, 200.0, 300.0], 1.0, 0.01
+        )
+        self.assertEqual([[0], [1], [2], [3]], result)
+        # Buckets are in ready order.
+        result = dist._compute_bucket_assignment_by_time(
+            tensors, [300.0, 200.0, 100.0, 0.0], 1.0, 0.01
+        )
+        self.assertEqual([[3], [2], [1], [0]], result)
+
+    def test_by_time_multi_dtype(self):
+        tensors = [
+            torch.empty([50], dtype=torch.float),
+            torch.empty([50], dtype=torch.float),
+            torch.empty([25], dtype=torch.double),
+            torch.empty([25], dtype=torch.double),
+        ]
+        result = dist._compute_bucket_assignment_by_time(
+            tensors, [0.0, 0.0, 0.0, 0.0], 100.0, 0.01
+        )
+        self.assertEqual([[0, 1], [2, 3]], result)
+
+    def test_by_time_sparse_gradient(self):
+        tensors = [torch.empty([100], dtype=torch.float) for _ in range(3)]
+        result = dist._compute_bucket_assignment_by_time(
+            tensors, [0.0, 0.0, 0.0], 100.0, 0.01, [False, True, False]
+        )
+        self.assertEqual([[0], [1], [2]], result)
+
+
+class SnapshotServiceTest(TestCase):
+    def _test_snapshot(self, device):
+        service = dist._SnapshotService(3)
+        state = {
+            "weight": torch.randn(16, 8, device=device),
+            "bias": torch.randn(8, device=device),
+            "step": torch.tensor(5, device=device),
+        }
+        with tempfile.TemporaryDirectory() as directory:
+            for _ in range(2):
+                expected = {name: t.clone() for name, t in state.items()}
+                service.snapshot(state, directory)
+                # The snapshot holds the values at the time it was taken.
+                for t in state.values():
+                    t.add_(1)
+                service.wait()
+                self.assertTrue(service.is_completed())
+                path = dist._SnapshotService.shard_path(directory, 3)
+                self.assertEqual(os.path.join(directory, "rank_3.pt"), path)
+                loaded = torch.load(path)
+                self.assertEqual(list(expected.keys()), list(loaded.keys()))
+                for name, t in expected.items():
+                    self.assertEqual(t.cpu(), loaded[name])
+
+            # Writing to a directory that does not exist fails on wait.
+            service.snapshot(state, os.path.join(directory, "missing"))
+            with self.assertRaises(RuntimeError):
+                service.wait()
+
+    def test_snapshot_cpu(self):
+        self._test_snapshot("cpu")
+
+    @unittest.skipIf(not torch.cuda.is_available(), "CUDA is not available")
+    def test_snapshot_cuda(self):
+        self._test_snapshot("cuda")
+
 
 @unittest.skipIf(
     TEST_WITH_TSAN,
@@ -4930,6 +5377,110 @@ class CommTest(MultiProcessTestCase):
         expected_tensor = torch.tensor([3] * 10).cuda(self.rank)
         self.assertEqual(expected_tensor, t)
 
+    @requires_nccl()
+    @skip_if_lt_x_gpu(2)
+    def test_pass_nccl_options_eager_init_device(self):
+        device = torch.device("cuda:%d" % self.rank)
+        pg_opts = c10d.ProcessGroupNCCL.Options()
+        pg_opts.eager_init_device = device
+
+        store = c10d.FileStore(self.file_name, self.world_size)
+        dist.init_process_group(
+            "nccl",
+            world_size=self.world_size,
+            rank=self.rank,
+            store=store,
+            pg_options=pg_opts
+        )
+        self.assertEqual(device, c10d.distributed_c10d._get_default_group().options.eager_init_device)
+
+        t = torch.tensor([self.rank + 1] * 10, device=device)
+        dist.all_reduce(t)
+        self.assertEqual(torch.tensor([3] * 10, device=device), t)
+
+        # New groups derive their communicator from the one of the default
+        # group, including on the ranks outside of them.
+        pg = c10d.new_group([0, 1])
+        self.assertEqual(device, pg.options.eager_init_device)
+        t = torch.tensor([self.rank + 1] * 10, device=device)
+        pg.allreduce(t).wait()
+        self.assertEqual(torch.tensor([3] * 10, device=device), t)
+
+        pg = c10d.new_group([1])
+        if self.rank == 1:
+            t = torch.tensor([self.rank + 1] * 10, device=device)
+            pg.allreduce(t).wait()
+            self.assertEqual(torch.tensor([2] * 10, device=device), t)
+
+    @requires_nccl()
+    @skip_if_lt_x_gpu(2)
+    def test_nccl_collective_traces(self):
+        device = torch.device("cuda:%d" % self.rank)
+        pg_opts = c10d.ProcessGroupNCCL.Options()
+        pg_opts.collective_trace_size = 2
+        store = c10d.FileStore(self.file_name, self.world_size)
+        pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size, pg_opts)
+
+        for _ in range(3):
+            t = torch.ones(10, device=device)
+            pg.allreduce(t).wait()
+        torch.cuda.synchronize(device)
+
+        # Only the last two collectives are kept.
+        traces = pg._get_collective_traces()
+        self.assertEqual([1, 2], [trace.seq for trace in traces])
+        for trace in traces:
+            self.assertEqual("ALLREDUCE", trace.op_type)
+            self.assertEqual(10, trace.numel)
+            self.assertEqual(40, trace.bytes)
+            self.assertGreaterEqual(trace.duration_us, 0)
+
+        skews = pg._gather_collective_traces()
+        self.assertEqual([1, 2], [skew.seq for skew in skews])
+        for skew in skews:
+            self.assertEqual(self.world_size, len(skew.duration_us))
+            self.assertEqual(0, min(skew.arrival_skew_us))
+            self.assertEqual(
+                max(skew.arrival_skew_us), skew.arrival_skew_us[skew.straggler]
+            )
+
+    def _test_nccl_alltoall_v(self, hierarchical):
+        device = torch.device("cuda:%d" % self.rank)
+        pg_opts = c10d.ProcessGroupNCCL.Options()
+        pg_opts.hierarchical_alltoall = hierarchical
+        store = c10d.FileStore(self.file_name, self.world_size)
+        pg = c10d.ProcessGroupNCCL(store, self.rank, self.world_size, pg_opts)
+
+        # Rank src sends src + dst + 1 rows of 10 * src + dst to rank dst, so
+        # the receivers can't know the sizes in advance.
+        input_split_sizes = [self.rank + dst + 1 for dst in range(self.world_size)]
+        input = torch.cat([
+            torch.full((size, 3), 10.0 * self.rank + dst, device=device)
+            for dst, size in enumerate(input_split_sizes)
+        ])
+        work = pg.alltoall_v(input, input_split_sizes)
+        work.wait()
+        output, output_split_sizes = work.result()
+
+        expected_sizes = [src + self.rank + 1 for src in range(self.world_size)]
+        self.assertEqual(torch.tensor(expected_sizes), output_split_sizes)
+        expected = torch.cat([
+            torch.full((size, 3), 10.0 * src + self.rank, device=device)
+            for src, size in enumerate(expected_sizes)
+        ])
+        self.assertEqual(expected, output)
+
+    @requires_nccl()
+    @skip_if_lt_x_gpu(2)
+    def test_nccl_alltoall_v(self):
+        self._test_nccl_alltoall_v(hierarchical=False)
+
+    @requires_nccl()
+    @skip_if_lt_x_gpu(2)
+    def test_nccl_alltoall_v_hierarchical_single_host(self):
+        # All the ranks are on one host, so alltoall_v stays flat.
+        self._test_nccl_alltoall_v(hierarchical=True)
+
     @requires_nccl()
     @skip_if_lt_x_gpu(4)
     def test_nccl_barrier(self):
@@ -1588,6 +1588,125 @@ class TestFrozenOptimizations(JitTestCase):
         output_f = frozen_mod.forward(input)
         self.assertEqual(output_s, output_f)
 
+    def test_linear_bn_folding(self):
+        for use_bias in [True, False]:
+            class LinearBN(torch.nn.Module):
+                def __init__(self):
+                    super(LinearBN, self).__init__()
+                    self.linear = nn.Linear(20, 30, bias=use_bias)
+                    self.bn = nn.BatchNorm1d(30, eps=0.001)
+
+                def forward(self, x):
+                    return self.bn(self.linear(x))
+
+            mod_eager = LinearBN().eval()
+            # give the batchnorm non-trivial statistics
+            mod_eager.bn.running_mean.uniform_()
+            mod_eager.bn.running_var.uniform_(0.5, 2)
+            inp = torch.rand(4, 20)
+
+            # tracing records the 2-d output the fold needs
+            traced_mod = torch.jit.trace(mod_eager, (inp,))
+            scripted_mod = torch.jit.freeze(traced_mod, optimize_numerics=False)
+            FileCheck().check("aten::linear").check("aten::batch_norm").run(scripted_mod.graph)
+            self.run_pass("fold_frozen_linear_bn", scripted_mod.graph)
+            FileCheck().check("aten::linear").check_not("aten::batch_norm").run(scripted_mod.graph)
+            self.assertEqual(mod_eager(inp), scripted_mod(inp))
+
+            # freezing runs the fold
+            scripted_mod = torch.jit.freeze(traced_mod)
+            FileCheck().check("aten::linear").check_not("aten::batch_norm").run(scripted_mod.graph)
+            self.assertEqual(mod_eager(inp), scripted_mod(inp))
+
+    def test_linear_add_mul_folding(self):
+        for use_bias, tensor_op in product([True, False], [True, False]):
+            class LinearOps(torch.nn.Module):
+                def __init__(self):
+                    super(LinearOps, self).__init__()
+                    self.linear = nn.Linear(20, 30, bias=use_bias)
+                    self.scale = torch.rand(30) if tensor_op else 2.5
+                    self.shift = torch.rand(30) if tensor_op else 0.5
+
+                def forward(self, x):
+                    return (self.linear(x) * self.scale - self.shift) / 2
+
+            mod_eager = LinearOps().eval()
+            scripted_mod = torch.jit.freeze(torch.jit.script(mod_eager), optimize_numerics=False)
+            FileCheck().check("aten::linear").check("aten::mul").check("aten::sub") \
+                .check("aten::div").run(scripted_mod.graph)
+            for _ in range(2):
+                self.run_pass("fold_frozen_linear_mul_or_div", scripted_mod.graph)
+                self.run_pass("fold_frozen_linear_add_or_sub", scripted_mod.graph)
+            FileCheck().check("aten::linear").check_not("aten::mul").check_not("aten::sub") \
+                .check_not("aten::div").run(scripted_mod.graph)
+            # freezing runs the folds
+            frozen_mod = torch.jit.freeze(torch.jit.script(mod_eager))
+            FileCheck().check("aten::linear").check_not("aten::mul").check_not("aten::sub") \
+                .check_not("aten::div").run(frozen_mod.graph)
+
+            for inp in [torch.rand(20), torch.rand(3, 20), torch.rand(2, 3, 20)]:
+                self.assertEqual(mod_eager(inp), scripted_mod(inp))
+                self.assertEqual(mod_eager(inp), frozen_mod(inp))
+
+        # an operand that broadcasts beyond the output features is left alone
+        class LinearAdd(torch.nn.Module):
+            def __init__(self):
+                super(LinearAdd, self).__init__()
+                self.linear = nn.Linear(20, 30)
+                self.shift = torch.rand(3, 30)
+
+            def forward(self, x):
+                return self.linear(x) + self.shift
+
+        scripted_mod = torch.jit.freeze(torch.jit.script(LinearAdd().eval()))
+        FileCheck().check("aten::linear").check("aten::add").run(scripted_mod.graph)
+
+    def test_matmul_to_linear_and_merge(self):
+        class QKV(torch.nn.Module):
+            def __init__(self):
+                super(QKV, self).__init__()
+                self.q = nn.Linear(16, 16)
+                self.k = nn.Linear(16, 16, bias=False)
+                self.v = torch.rand(16, 8)
+
+            def forward(self, x):
+                q = self.q(x).view(-1, 4, 4)
+                k = self.k(x).view(-1, 4, 4)
+                v = torch.matmul(x, self.v)
+                return q, k, v
+
+        mod_eager = QKV().eval()
+        scripted_mod = torch.jit.freeze(torch.jit.script(mod_eager), optimize_numerics=False)
+        FileCheck().check("aten::matmul").run(scripted_mod.graph)
+        self.run_pass("convert_frozen_matmul_to_linear", scripted_mod.graph)
+        FileCheck().check_not("aten::matmul").run(scripted_mod.graph)
+        self.run_pass("merge_frozen_parallel_linears", scripted_mod.graph)
+        FileCheck().check_count("aten::linear", 1, exactly=True).check_count("aten::narrow", 3, exactly=True) \
+            .run(scripted_mod.graph)
+        # freezing runs the conversion and the merge
+        frozen_mod = torch.jit.freeze(torch.jit.script(mod_eager))
+        FileCheck().check_not("aten::matmul").check_count("aten::linear", 1, exactly=True) \
+            .check_count("aten::narrow", 3, exactly=True).run(frozen_mod.graph)
+
+        inp = torch.rand(5, 16)
+        self.assertEqual(mod_eager(inp), scripted_mod(inp))
+        self.assertEqual(mod_eager(inp), frozen_mod(inp))
+
+        # linears whose input may be mutated between them are not merged
+        class Mutated(torch.nn.Module):
+            def __init__(self):
+                super(Mutated, self).__init__()
+                self.a = nn.Linear(16, 16)
+                self.b = nn.Linear(16, 16)
+
+            def forward(self, x):
+                y = self.a(x)
+                x.add_(1)
+                return y, self.b(x)
+
+        scripted_mod = torch.jit.freeze(torch.jit.script(Mutated().eval()))
+        FileCheck().check_count("aten::linear", 2, exactly=True).run(scripted_mod.graph)
+
     def test_freeze_remove_feature_dropout(self):
         class Net(nn.Module):
             def __init__(self):
@@ -1609,6 +1728,48 @@ class TestFrozenOptimizations(JitTestCase):
         output_f = frozen_mod.forward(input)
         self.assertEqual(output_s, output_f)
 
+    @unittest.skipIf(not torch.backends.mkl.is_available(), "MKL build is disabled")
+    def test_linear_prepack(self):
+        with set_default_dtype(torch.float):
+            for bias, inp_shape in product([True, False], [[20], [5, 20], [2, 5, 20]]):
+                mod = nn.Linear(20, 30, bias=bias).eval()
+                scripted_mod = torch.jit.freeze(torch.jit.script(mod))
+                # freezing alone keeps aten::linear for the passes that run after it
+                FileCheck().check("aten::linear").check_not("cpu_prepacked::linear_run").run(scripted_mod.graph)
+                self.run_pass("prepack_frozen_linear", scripted_mod.graph)
+                FileCheck().check_not("aten::linear").check("cpu_prepacked::linear_run").run(scripted_mod.graph)
+
+                inp = torch.rand(inp_shape)
+                self.assertEqual(mod(inp), scripted_mod(inp))
+
+                buffer = io.BytesIO()
+                torch.jit.save(scripted_mod, buffer)
+                buffer.seek(0)
+                loaded_mod = torch.jit.load(buffer)
+                self.assertEqual(mod(inp), loaded_mod(inp))
+
+        # double linear is left alone
+        mod = nn.Linear(20, 30).eval()
+        scripted_mod = torch.jit.freeze(torch.jit.script(mod))
+        self.run_pass("prepack_frozen_linear", scripted_mod.graph)
+        FileCheck().check("aten::linear").check_not("cpu_prepacked::linear_run").run(scripted_mod.graph)
+
+    @unittest.skipIf(not torch.backends.mkl.is_available(), "MKL build is disabled")
+    def test_optimize_for_inference_prepacks_last(self):
+        with set_default_dtype(torch.float):
+            mod = nn.Sequential(nn.Linear(20, 30), nn.ReLU(), nn.Linear(30, 10)).eval()
+            optimized_mod = torch.jit.optimize_for_inference(torch.jit.script(mod))
+            if torch._C.has_mkldnn:
+                # MKLDNN takes the linears, and their weights are not prepacked again
+                FileCheck().check("to_mkldnn").check("aten::linear").check("to_dense") \
+                    .check_not("cpu_prepacked::linear_run").run(optimized_mod.graph)
+            else:
+                FileCheck().check_not("aten::linear").check_count("cpu_prepacked::linear_run", 2, exactly=True) \
+                    .run(optimized_mod.graph)
+
+            inp = torch.rand(5, 20)
+            self.assertEqual(mod(inp), optimized_mod(inp))
+
     @unittest.skipIf(not torch._C.has_mkldnn, "MKL-DNN build is disabled")
     def test_freeze_mkdlnn(self):
         conv = torch.nn.Conv2d(3, 32, kernel_size=3, stride=2).eval().float()
@@ -1698,7 +1859,8 @@ class TestFrozenOptimizations(JitTestCase):
                     return x + self.tensor
 
             def test_unsupported(module, preserved_attrs=None):
-                mod = torch.jit.freeze(torch.jit.script(module.eval()), preserved_attrs)
+                # keep the add from being folded into the linear
+                mod = torch.jit.freeze(torch.jit.script(module.eval()), preserved_attrs, optimize_numerics=False)
                 self.run_pass("convert_frozen_ops_to_mkldnn", mod.graph)
                 FileCheck().check("to_mkldnn").check("linear").check("to_dense").check("add").run(mod.graph)
 
@@ -1724,7 +1886,8 @@ class TestFrozenOptimizations(JitTestCase):
             for add_inp in [20], [20, 20, 1]:
                 mod = nn.Sequential(nn.Linear(20, 20), Add(torch.rand(add_inp))).eval()
                 scripted_mod = torch.jit.script(mod)
-                scripted_mod = torch.jit.freeze(scripted_mod)
+                # keep the add from being folded into the linear
+                scripted_mod = torch.jit.freeze(scripted_mod, optimize_numerics=False)
                 self.run_pass("convert_frozen_ops_to_mkldnn", scripted_mod.graph)
                 FileCheck().check("prim::BroadcastMKLDNNTensors").run(scripted_mod.graph)
                 inp = torch.rand([20, 20])
@@ -1771,6 +1934,47 @@ class TestFrozenOptimizations(JitTestCase):
             FileCheck().check_count("to_dense", 1, exactly=True).run(mod.graph)
             self.assertEqual(mod(inp), sub_model(inp))
 
+    @unittest.skipIf(not torch._C.has_mkldnn, "MKL-DNN build is disabled")
+    def test_mkldnn_layout_propagation(self):
+        class Branches(nn.Module):
+            def __init__(self):
+                super().__init__()
+                self.conv1 = nn.Conv2d(3, 8, kernel_size=3, padding=1)
+                self.conv2 = nn.Conv2d(3, 8, kernel_size=1)
+                self.conv3 = nn.Conv2d(16, 4, kernel_size=3)
+
+            def forward(self, x):
+                y = torch.cat([self.conv1(x).tanh(), self.conv2(x)], dim=1)
+                y = torch.nn.functional.avg_pool2d(self.conv3(y), 2)
+                return torch.nn.functional.adaptive_avg_pool2d(y, (1, 1)).softmax(1)
+
+        with set_default_dtype(torch.float):
+            mod = Branches().eval()
+            scripted_mod = torch.jit.freeze(torch.jit.script(mod))
+            self.run_pass("convert_frozen_ops_to_mkldnn", scripted_mod.graph)
+            FileCheck().check("prim::MKLDNNConcat").check("avg_pool2d").check("softmax") \
+                       .check("to_dense").run(scripted_mod.graph)
+            FileCheck().check_count("to_mkldnn", 1, exactly=True).run(scripted_mod.graph)
+            FileCheck().check_count("to_dense", 1, exactly=True).run(scripted_mod.graph)
+            inp = torch.rand([2, 3, 16, 16])
+            self.assertEqual(scripted_mod(inp), mod(inp))
+            self.assertEqual(scripted_mod(inp), mod(inp))
+
+            # a cat with a dense input stays an aten::cat
+            class DenseCat(nn.Module):
+                def __init__(self):
+                    super().__init__()
+                    self.conv = nn.Conv2d(3, 8, kernel_size=1)
+
+                def forward(self, x):
+                    return torch.cat([self.conv(x), x.int().float()], dim=1)
+
+            mod = DenseCat().eval()
+            scripted_mod = torch.jit.freeze(torch.jit.script(mod))
+            self.run_pass("convert_frozen_ops_to_mkldnn", scripted_mod.graph)
+            FileCheck().check_not("prim::MKLDNNConcat").check("aten::cat").run(scripted_mod.graph)
+            self.assertEqual(scripted_mod(inp), mod(inp))
+
     @unittest.skipIf(torch._C.has_mkldnn, "Testing no mkldnn")
     def test_conv_to_mkldnn_no_mkldnn(self):
         # test no error when mkldnn not available
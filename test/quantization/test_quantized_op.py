@@ -975,6 +975,36 @@ class TestQuantizedOps(TestCase):
         np.testing.assert_equal(qC, qC_hat.int_repr(),
                                 "Quantized multiplication failed.")
 
+    """Tests the correctness of the fused elementwise op."""
+    def test_qelementwise(self):
+        elementwise = torch.ops.quantized.elementwise
+        A = torch.randn(2, 8, 5, 6)
+        B = torch.randn(2, 8, 5, 6)
+        C = torch.randn(8, 1, 1)
+        qA = torch.quantize_per_tensor(A, 0.05, 128, torch.quint8)
+        qB = torch.quantize_per_tensor(B, 0.04, 120, torch.quint8)
+        qC = torch.quantize_per_tensor(C, 0.02, 100, torch.quint8)
+        # per channel along the channels, which are innermost in channels last
+        qB_channelwise = torch.quantize_per_channel(
+            B, torch.rand(8, dtype=torch.double) / 10 + 0.01,
+            torch.randint(100, 150, (8,)), 1, torch.quint8)
+        scale, zero_point = 0.03, 64
+
+        for memory_format in (torch.contiguous_format, torch.channels_last):
+            qA_mf = qA.contiguous(memory_format=memory_format)
+            for qB_mf in (qB, qB_channelwise):
+                qB_mf = qB_mf.contiguous(memory_format=memory_format)
+                qY = elementwise(qA_mf, [qB_mf, qC], ["add", "relu", "mul"], scale, zero_point)
+                Y = F.relu(qA.dequantize() + qB_mf.dequantize()) * qC.dequantize()
+                qY_ref = torch.quantize_per_tensor(Y, scale, zero_point, torch.quint8)
+                self.assertEqual(qY.shape, qY_ref.shape)
+                # allow off by one results from rounding the float results
+                np.testing.assert_array_almost_equal(
+                    qY_ref.int_repr().numpy(), qY.int_repr().numpy(), decimal=0)
+
+        with self.assertRaisesRegex(RuntimeError, "operands"):
+            elementwise(qA, [qB], ["add", "mul"], scale, zero_point)
+
     """Tests channel shuffle operation on quantized tensors."""
     @given(X=hu.tensor(shapes=hu.array_shapes(min_dims=4, max_dims=4,
                                               min_side=2, max_side=32, max_numel=10**5),
@@ -2709,6 +2739,72 @@ class TestDynamicQuantizedLinear(TestCase):
                          msg="torch.ops.quantized.fbgemm_linear_dynamic results are off")
 
 
+    @skipIfNoFBGEMM
+    @given(
+        batch_size=st.integers(1, 4),
+        input_channels=st.integers(16, 32),
+        output_channels=st.integers(4, 8),
+        use_bias=st.booleans(),
+        activation=st.sampled_from(['none', 'relu', 'gelu']),
+        use_channelwise=st.booleans())
+    def test_qlinear_rowwise(self, batch_size, input_channels, output_channels,
+                             use_bias, activation, use_channelwise):
+        # reduce_range keeps vpmaddubsw from saturating
+        with override_quantized_engine('fbgemm'):
+            X = torch.randn(batch_size, 3, input_channels)
+            W = torch.randn(output_channels, input_channels)
+            b = torch.randn(output_channels) if use_bias else None
+            if use_channelwise:
+                W_q = torch.quantize_per_channel(
+                    W, scales=torch.rand(output_channels) * 0.05 + 0.01,
+                    zero_points=torch.zeros(output_channels, dtype=torch.long),
+                    axis=0, dtype=torch.qint8)
+            else:
+                W_scale, W_zp = _calculate_dynamic_qparams(W, torch.qint8)
+                W_q = torch.quantize_per_tensor(W, W_scale, W_zp, torch.qint8)
+            W_prepack = torch.ops.quantized.linear_prepack(W_q, b)
+            Y = torch.ops.quantized.linear_dynamic_rowwise(
+                X, W_prepack, activation, True)
+
+            # Every row of X is quantized with its own qparams
+            X_rows = X.reshape(-1, input_channels)
+            X_dq = torch.stack([
+                torch.quantize_per_tensor(
+                    row, *_calculate_dynamic_qparams(row, torch.quint8, True),
+                    torch.quint8).dequantize()
+                for row in X_rows]).reshape(X.shape)
+            Y_ref = F.linear(X_dq, W_q.dequantize(), b)
+            if activation == 'relu':
+                Y_ref = F.relu(Y_ref)
+            elif activation == 'gelu':
+                Y_ref = F.gelu(Y_ref)
+            self.assertEqual(Y, Y_ref, atol=1e-4, rtol=1e-4,
+                             msg="torch.ops.quantized.linear_dynamic_rowwise results are off")
+
+
+    @given(
+        batch_size=st.integers(1, 4),
+        input_channels=st.integers(4, 40).filter(lambda x: x % 4 == 0),
+        output_channels=st.integers(1, 16),
+        use_bias=st.booleans(),
+        bit_rate=st.sampled_from([2, 4]))
+    def test_qlinear_nbit(self, batch_size, input_channels, output_channels,
+                          use_bias, bit_rate):
+        prepack_op = getattr(torch.ops.quantized, 'linear_prepack_{}bit'.format(bit_rate))
+        linear_op = getattr(torch.ops.quantized, 'linear_{}bit'.format(bit_rate))
+        unpack_op = getattr(torch.ops.quantized, 'embedding_bag_{}bit_unpack'.format(bit_rate))
+
+        X = torch.randn(batch_size, 2, input_channels)
+        W = torch.randn(output_channels, input_channels)
+        b = torch.randn(output_channels) if use_bias else None
+        W_prepack = prepack_op(W)
+        Y = linear_op(X, W_prepack, b)
+        # The weights are packed in the layout of the n-bit embedding bags
+        Y_ref = F.linear(X, unpack_op(W_prepack), b)
+        self.assertEqual(Y, Y_ref, atol=1e-3, rtol=1e-3,
+                         msg="torch.ops.quantized.linear_{}bit results are off".format(bit_rate))
+
+
 class TestDynamicQuantizedRNNOp(TestCase):
     """Tests the correctness of the dynamic quantized lstm/gru."""
 
@@ -3108,6 +3204,28 @@ class TestQuantizedLinear(unittest.TestCase):
             np.testing.assert_equal(
                 W_q.q_zero_point(), W_q_origin.q_zero_point())
 
+    @unittest.skipIf(not torch.cuda.is_available(), "CUDA unavailable")
+    def test_qlinear_cuda(self):
+        X = torch.rand(8, 32, device='cuda')
+        W = torch.randn(16, 32, device='cuda')
+        b = torch.randn(16, device='cuda')
+        X_q = torch.quantize_per_tensor(X, 1.0 / 255, 0, torch.quint8)
+        W_q = torch.quantize_per_channel(
+            W, W.abs().max(dim=1)[0] / 127, torch.zeros(16, dtype=torch.long, device='cuda'),
+            0, torch.qint8)
+        Y_scale, Y_zero_point = 0.05, 128
+        for use_relu in (False, True):
+            W_prepack = torch.ops.quantized.linear_prepack(W_q, b)
+            qlinear = torch.ops.quantized.linear_relu if use_relu else torch.ops.quantized.linear
+            Y_q = qlinear(X_q, W_prepack, Y_scale, Y_zero_point)
+            Y_ref = F.linear(X_q.dequantize(), W_q.dequantize(), b)
+            if use_relu:
+                Y_ref = F.relu(Y_ref)
+            Y_ref_q = torch.quantize_per_tensor(Y_ref, Y_scale, Y_zero_point, torch.quint8)
+            # the float reference rounds differently, allow off by one results
+            np.testing.assert_array_almost_equal(
+                Y_ref_q.int_repr().cpu().numpy(), Y_q.int_repr().cpu().numpy(), decimal=0)
+
 
 @unittest.skipIf(sys.platform == "darwin", "Known test failure on Mac.")
 class TestQuantizedEmbeddingOps(TestCase):
@@ -3235,6 +3353,9 @@ class TestQuantizedEmbeddingOps(TestCase):
         if bit_rate == 4:
             pt_op = torch.ops.quantized.embedding_bag_4bit_rowwise_offsets
             pt_prepack_op = torch.ops.quantized.embedding_bag_4bit_prepack
+        elif bit_rate == 2:
+            pt_op = torch.ops.quantized.embedding_bag_2bit_rowwise_offsets
+            pt_prepack_op = torch.ops.quantized.embedding_bag_2bit_prepack
 
         weights = torch.from_numpy((np.random.random_sample((
             num_embeddings, embedding_dim)) + 1).astype(np.float32))
@@ -3262,6 +3383,9 @@ class TestQuantizedEmbeddingOps(TestCase):
             low=0, high=num_embeddings, size=num_indices, dtype=np.int64))
 
         q_weights = pt_prepack_op(weights)
+        if bit_rate == 2:
+            # 2 bits are too coarse to compare with the float weights
+            weights = torch.ops.quantized.embedding_bag_2bit_unpack(q_weights)
         per_sample_weights = torch.from_numpy(np.random.uniform(
             low=0.01, high=0.5, size=[len(indices)]).astype(np.float32)) if \
             enable_per_sample_weights else None
@@ -3401,6 +3525,33 @@ class TestQuantizedEmbeddingOps(TestCase):
                                                sparsity=sparsity,
                                                atol=0.1, rtol=1e-2)
 
+    """ Tests the correctness of the embedding_bag_2bit quantized operator """
+    @given(num_embeddings=st.integers(10, 100),
+           embedding_dim=st.integers(5, 50).filter(lambda x: x % 4 == 0),
+           num_offsets=st.integers(1, 20),
+           use_32bit_indices=st.booleans(),
+           use_32bit_offsets=st.booleans(),
+           enable_per_sample_weights=st.booleans(),
+           include_last_offset=st.booleans(),
+           fallback_to_no_sparse=st.booleans(),
+           sparsity=st.sampled_from([0.0, 0.5, 0.7]))
+    def test_embedding_bag_2bit(self, num_embeddings,
+                                embedding_dim, num_offsets,
+                                use_32bit_indices,
+                                use_32bit_offsets,
+                                enable_per_sample_weights,
+                                include_last_offset,
+                                fallback_to_no_sparse,
+                                sparsity):
+        self.embedding_bag_rowwise_offsets_run(2, num_embeddings,
+                                               embedding_dim, num_offsets,
+                                               use_32bit_indices, use_32bit_offsets,
+                                               enable_per_sample_weights,
+                                               include_last_offset,
+                                               fallback_to_no_sparse,
+                                               sparsity=sparsity,
+                                               atol=0.005, rtol=1e-3)
+
     """ Tests the correctness of the quantized embedding lookup operator """
     @given(num_embeddings=st.integers(10, 100),
            embedding_dim=st.integers(5, 50).filter(lambda x: x % 4 == 0))
@@ -4357,6 +4508,27 @@ class TestQuantizedConv(TestCase):
             (stride_d, stride_h, stride_w), (pad_d, pad_h, pad_w), (o_pad, o_pad, o_pad),
             channelwise)
 
+    @unittest.skipIf(not torch.cuda.is_available(), "CUDA unavailable")
+    @unittest.skipIf(not torch.backends.cudnn.is_available(), "cuDNN unavailable")
+    def test_qconv2d_cuda(self):
+        X = torch.rand(2, 8, 10, 10, device='cuda')
+        W = torch.randn(16, 8, 3, 3, device='cuda')
+        b = torch.randn(16, device='cuda')
+        X_q = torch.quantize_per_tensor(X, 1.0 / 255, 64, torch.quint8)
+        W_q = torch.quantize_per_tensor(W, W.abs().max().item() / 127, 0, torch.qint8)
+        Y_scale, Y_zero_point = 0.1, 128
+        for use_relu in (False, True):
+            W_prepack = torch.ops.quantized.conv2d_prepack(W_q, b, [1, 1], [1, 1], [1, 1], 1)
+            qconv = torch.ops.quantized.conv2d_relu if use_relu else torch.ops.quantized.conv2d
+            Y_q = qconv(X_q, W_prepack, Y_scale, Y_zero_point)
+            Y_ref = F.conv2d(X_q.dequantize(), W_q.dequantize(), b, padding=1)
+            if use_relu:
+                Y_ref = F.relu(Y_ref)
+            Y_ref_q = torch.quantize_per_tensor(Y_ref, Y_scale, Y_zero_point, torch.quint8)
+            # padding uses the input zero point, allow off by one results from rounding
+            np.testing.assert_array_almost_equal(
+                Y_ref_q.int_repr().cpu().numpy(), Y_q.int_repr().cpu().numpy(), decimal=0)
+
 class TestPadding(TestCase):
     @given(batch_size=st.integers(1, 64),
            channels=st.integers(1, 64),
@@ -11,6 +11,7 @@ from torch.quantization import (
     NoopObserver,
     FakeQuantize,
     FixedQParamsFakeQuantize,
+    FusedMovingAvgObsFakeQuantize,
     default_debug_qconfig,
     default_observer,
     default_histogram_observer,
@@ -1537,6 +1538,45 @@ class TestFakeQuantize(TestCase):
         for key in state_dict:
             self.assertEqual(state_dict[key], loaded_dict[key])
 
+    @given(device=st.sampled_from(['cpu', 'cuda'] if torch.cuda.is_available() else ['cpu']),
+           per_channel=st.booleans(),
+           symmetric=st.booleans())
+    def test_fused_moving_avg_obs_fq_module(self, device, per_channel, symmetric):
+        torch.random.manual_seed(NP_RANDOM_SEED)
+        if per_channel:
+            observer = MovingAveragePerChannelMinMaxObserver
+            qscheme = torch.per_channel_symmetric if symmetric else torch.per_channel_affine
+        else:
+            observer = MovingAverageMinMaxObserver
+            qscheme = torch.per_tensor_symmetric if symmetric else torch.per_tensor_affine
+        kwargs = dict(observer=observer, quant_min=0, quant_max=255, dtype=torch.quint8,
+                      qscheme=qscheme, reduce_range=False, averaging_constant=0.1)
+        if per_channel:
+            kwargs['ch_axis'] = 1
+        fq_ref = FakeQuantize(**kwargs).to(device)
+        fq_fused = FusedMovingAvgObsFakeQuantize(**kwargs).to(device)
+
+        for i in range(5):
+            if i == 3:
+                fq_ref.disable_observer()
+                fq_fused.disable_observer()
+            if i == 4:
+                fq_ref.disable_fake_quant()
+                fq_fused.disable_fake_quant()
+            X = torch.randn(4, 3, 5, device=device) * (i + 1)
+            X_ref = X.clone().requires_grad_()
+            X.requires_grad_()
+            Y_ref = fq_ref(X_ref)
+            Y = fq_fused(X)
+            self.assertEqual(fq_ref.scale, fq_fused.scale)
+            self.assertEqual(fq_ref.zero_point, fq_fused.zero_point)
+            self.assertEqual(Y_ref, Y, atol=tolerance, rtol=tolerance)
+
+            dout = torch.rand(X.shape, device=device)
+            Y_ref.backward(dout)
+            Y.backward(dout)
+            self.assertEqual(X_ref.grad, X.grad)
+
 def _get_buffer_ids(module):
     """
     Object addresses stay constant if and only if all modifications are in-place
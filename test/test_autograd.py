@@ -1210,6 +1210,37 @@ class TestAutograd(TestCase):
             w = adder(x, y)
             self.assertFalse(torch.is_grad_enabled())
 
+    def test_inference_mode(self):
+        x = torch.ones(5, 5, requires_grad=True)
+        with torch.inference_mode():
+            self.assertTrue(torch.is_inference_mode_enabled())
+            y = x * 2
+            z = torch.ones(5, 5)
+            # inference tensors are updated in place without a version bump
+            z.add_(1)
+            v = z.view(25)
+            with torch.inference_mode(False):
+                self.assertFalse(torch.is_inference_mode_enabled())
+        self.assertFalse(torch.is_inference_mode_enabled())
+
+        self.assertFalse(y.requires_grad)
+        self.assertIsNone(y.grad_fn)
+        self.assertEqual(z, torch.full((5, 5), 2.))
+        self.assertIsNone(v._base)
+        with self.assertRaisesRegex(RuntimeError, "do not track version counter"):
+            z._version
+        with self.assertRaisesRegex(RuntimeError, "Inplace update to inference tensor outside InferenceMode"):
+            z.add_(1)
+
+        @torch.inference_mode()
+        def func(x):
+            self.assertTrue(torch.is_inference_mode_enabled())
+            return x * 2
+
+        out = func(x)
+        self.assertFalse(out.requires_grad)
+        self.assertFalse(torch.is_inference_mode_enabled())
+
     def test_set_grad_generator_functions(self):
         @torch.no_grad()
         def gen_no_grad():
@@ -3545,6 +3576,117 @@ class TestAutograd(TestCase):
         d, = torch.autograd.grad(c, a, retain_graph=True, create_graph=True)
         self.assertTrue(d.requires_grad)
 
+    def test_compress_saved_tensors(self):
+        x = torch.randn(16, 32, requires_grad=True)
+        w = torch.randn(32, 32, requires_grad=True)
+
+        def run():
+            h = (x @ w).relu()
+            return h, (h @ w).tanh().sum()
+
+        h, out = run()
+        x_grad, w_grad = torch.autograd.grad(out, (x, w))
+
+        # Only the output saved by ReLU is packed, and exactly
+        with torch.autograd.compress_saved_tensors(dtype=None, min_bytes=0):
+            h, out = run()
+        self.assertEqual(h.grad_fn._saved_result, (h > 0).to(h.dtype))
+        self.assertEqual(torch.autograd.grad(out, (x, w)), (x_grad, w_grad))
+
+        for dtype in (torch.bfloat16, torch.int8):
+            with torch.autograd.compress_saved_tensors(dtype=dtype, min_bytes=0):
+                _, out = run()
+            grads = torch.autograd.grad(out, (x, w))
+            self.assertEqual(grads, (x_grad, w_grad), atol=5e-2, rtol=5e-2)
+
+        # Tensors smaller than min_bytes are kept
+        with torch.autograd.compress_saved_tensors(dtype=torch.int8):
+            h, out = run()
+        self.assertEqual(h.grad_fn._saved_result, h)
+        self.assertEqual(torch.autograd.grad(out, (x, w)), (x_grad, w_grad))
+
+    def test_parallel_cpu_backward(self):
+        x = torch.randn(8, 16, requires_grad=True)
+        ws = [torch.randn(16, 16, requires_grad=True) for _ in range(4)]
+
+        def run():
+            # independent towers joined at the end, one of them reentrant
+            outs = [(x @ w).tanh() @ w for w in ws[:-1]]
+            outs.append(checkpoint(lambda x: (x @ ws[-1]).sigmoid(), x))
+            return torch.stack(outs).sum()
+
+        grads = torch.autograd.grad(run(), [x] + ws)
+        with torch.autograd.parallel_cpu_backward(3):
+            for _ in range(3):
+                self.assertEqual(torch.autograd.grad(run(), [x] + ws), grads)
+            out = run()
+            out.backward()
+        self.assertEqual(x.grad, grads[0])
+        self.assertEqual(torch._C._autograd_cpu_worker_threads(), 0)
+
+        class Fail(Function):
+            @staticmethod
+            def forward(ctx, x):
+                return x.clone()
+
+            @staticmethod
+            def backward(ctx, grad):
+                raise RuntimeError("Simulate error")
+
+        with torch.autograd.parallel_cpu_backward(2):
+            with self.assertRaisesRegex(RuntimeError, "Simulate error"):
+                (Fail.apply(x) + x * 2).sum().backward()
+
+    def test_sequential_cpu_backward(self):
+        x = torch.randn(8, 16, requires_grad=True)
+        w = torch.randn(16, 16, requires_grad=True)
+        order = []
+
+        def run():
+            h = x @ w
+            h.register_hook(lambda grad: order.append("h"))
+            outs = [h.tanh(), h.sigmoid() * x, checkpoint(lambda h: (h @ w).relu(), h)]
+            for i, out in enumerate(outs):
+                out.register_hook(lambda grad, i=i: order.append(i))
+            return torch.stack(outs).sum()
+
+        grads = torch.autograd.grad(run(), (x, w))
+        expected_order = list(order)
+        with torch.autograd.sequential_cpu_backward():
+            del order[:]
+            run().backward()
+            self.assertEqual(order, expected_order)
+            self.assertEqual((x.grad, w.grad), grads)
+
+            # Final callbacks and errors behave as in the engine
+            called = []
+
+            class MyFunction(Function):
+                @staticmethod
+                def forward(ctx, x):
+                    return x.clone()
+
+                @staticmethod
+                def backward(ctx, grad):
+                    Variable._execution_engine.queue_callback(lambda: called.append(True))
+                    return grad
+
+            class Fail(Function):
+                @staticmethod
+                def forward(ctx, x):
+                    return x.clone()
+
+                @staticmethod
+                def backward(ctx, grad):
+                    raise RuntimeError("Simulate error")
+
+            MyFunction.apply(x).sum().backward()
+            self.assertEqual(called, [True])
+
+            with self.assertRaisesRegex(RuntimeError, "Simulate error"):
+                (Fail.apply(x) * 2).sum().backward()
+        self.assertFalse(torch._C._is_autograd_sequential_cpu_backward_enabled())
+
     def test_anomaly_detect_nan(self):
         size = 10
 
@@ -7016,6 +7158,30 @@ class TestAutogradForwardMode(TestCase):
 
             dual = fwAD.make_dual(foo, tangent[1:])
 
+    def test_batched_jvp(self):
+        # copy_ and detach are among the few ops with a forward formula for now
+        def func(x, y):
+            out = torch.zeros(2, 3)
+            out.copy_(x)
+            return out, y.detach(), torch.ones(2)
+
+        inputs = (torch.rand(2, 3), torch.rand(4))
+        v = (torch.rand(5, 2, 3), torch.rand(5, 4))
+        res = autogradF.batched_jvp(func, inputs, v)
+        self.assertEqual(res[0][0], inputs[0])
+        self.assertEqual(res[0][1], inputs[1])
+        self.assertEqual(res[0][2], torch.ones(2))
+        self.assertEqual(res[1][0], v[0])
+        self.assertEqual(res[1][1], v[1])
+        self.assertEqual(res[1][2], torch.zeros(5, 2))
+
+        with self.assertRaisesRegex(RuntimeError, "independent of the inputs"):
+            autogradF.batched_jvp(func, inputs, v, strict=True)
+        with self.assertRaisesRegex(RuntimeError, "Entry 1 in v has invalid size"):
+            autogradF.batched_jvp(func, inputs, (v[0], torch.rand(4, 4)))
+        with self.assertRaisesRegex(RuntimeError, "Only the tangent may have a batch dimension"):
+            torch._vmap_internals._vmap(lambda x: autogradF.batched_jvp(func, (x, inputs[1]), v))(torch.rand(3, 2, 3))
+
 
 # Generic device type autograd tests.
 class TestAutogradDeviceType(TestCase):
@@ -7478,6 +7644,57 @@ class TestAutogradDeviceType(TestCase):
         # previous allocation of z had the same size as the current one.
         self.assertEqual(base_mem, end_mem)
 
+    @onlyCUDA
+    def test_offload_saved_tensors(self, device):
+        def run(x, w):
+            # the sin saves (x @ w) and the matmul saves the tanh output
+            y = (x @ w).sin().tanh() @ w
+            return y.sum()
+
+        x = torch.randn(64, 64, device=device, requires_grad=True)
+        w = torch.randn(64, 64, device=device, requires_grad=True)
+        run(x, w).backward()
+        x_grad, w_grad = x.grad, w.grad
+        x.grad = w.grad = None
+
+        base_mem = torch.cuda.memory_allocated()
+        out = run(x, w)
+        kept_mem = torch.cuda.memory_allocated() - base_mem
+        out.backward()
+        x.grad = w.grad = None
+
+        with torch.autograd.offload_saved_tensors(min_bytes=0):
+            base_mem = torch.cuda.memory_allocated()
+            out = run(x, w)
+            offloaded_mem = torch.cuda.memory_allocated() - base_mem
+        # only the leaves x and w stay on the device
+        self.assertLess(offloaded_mem, kept_mem)
+        out.backward()
+        self.assertEqual(x.grad, x_grad)
+        self.assertEqual(w.grad, w_grad)
+
+    @onlyCUDA
+    def test_grouped_grad_accumulation(self, device):
+        params = [torch.randn(n, device=device, requires_grad=True) for n in (3, 5, 7)]
+        params.append(torch.randn(4, device=device, dtype=torch.double, requires_grad=True))
+        hooked = torch.randn(2, device=device, requires_grad=True)
+        seen = []
+        hooked.grad = torch.zeros(2, device=device)
+        acc = hooked.expand_as(hooked).grad_fn.next_functions[0][0]
+        acc.register_hook(lambda grad_inputs, grad_outputs: seen.append(hooked.grad.clone()))
+
+        def run():
+            return sum((p.float() * i).sum() for i, p in enumerate(params)) + (hooked * 2).sum()
+
+        run().backward()
+        expected = [2 * p.grad for p in params]
+        with torch.autograd.grouped_grad_accumulation():
+            run().backward()
+        self.assertEqual([p.grad for p in params], expected)
+        # Nodes with post hooks accumulate right away
+        self.assertEqual(seen[-1], torch.full((2,), 4., device=device))
+        self.assertFalse(torch._C._is_grouped_grad_accumulation_enabled())
+
     @onlyCUDA
     def test_pin_memory(self, device):
         x = torch.randn(2, 2, requires_grad=True)
@@ -1,6 +1,7 @@
 from itertools import repeat, chain, product
 from typing import NamedTuple
 import collections
+import copy
 import gc
 import io
 import os
@@ -1360,6 +1361,55 @@ class TestCuda(TestCase):
         self.assertEqual(gpu_tensor1[0], 1)
         self.assertEqual(gpu_tensor0[0], 2)
 
+    def test_caching_pinned_memory_views(self):
+        # a copy from a view with a storage offset also delays the reuse
+        cycles_per_ms = get_cycles_per_ms()
+        t = torch.zeros(1024).pin_memory()
+        ptr = t.data_ptr()
+        gpu_tensor = torch.cuda.FloatTensor([0])
+        torch.cuda._sleep(int(50 * cycles_per_ms))  # delay the copy
+        gpu_tensor.copy_(t[512:513], non_blocking=True)
+        del t
+        t = torch.zeros(1024).pin_memory()
+        self.assertNotEqual(t.data_ptr(), ptr, msg='allocation re-used too soon')
+
+    def test_caching_pinned_memory_stats(self):
+        torch.cuda.empty_host_cache()
+        torch.cuda.reset_peak_host_memory_stats()
+        before = torch.cuda.host_memory_stats()
+
+        # sizes of the same size class share cached blocks
+        t = torch.empty(1000, dtype=torch.uint8).pin_memory()
+        ptr = t.data_ptr()
+        stats = torch.cuda.host_memory_stats()
+        self.assertEqual(stats["allocation.current"], before["allocation.current"] + 1)
+        self.assertEqual(stats["allocated_bytes.current"], before["allocated_bytes.current"] + 1024)
+        del t
+        t = torch.empty(1010, dtype=torch.uint8).pin_memory()
+        self.assertEqual(t.data_ptr(), ptr, msg='allocation not reused')
+        del t
+
+        # but not blocks of other classes
+        t = torch.empty(100, dtype=torch.uint8).pin_memory()
+        self.assertNotEqual(t.data_ptr(), ptr)
+        del t
+
+        stats = torch.cuda.host_memory_stats()
+        self.assertEqual(stats["allocation.current"], before["allocation.current"])
+        self.assertGreater(stats["cached_bytes.current"], 0)
+
+        # blocks beyond the cache limit are released
+        try:
+            torch.cuda.set_host_memory_cache_limit(0)
+            stats = torch.cuda.host_memory_stats()
+            self.assertEqual(stats["cached_bytes.current"], 0)
+            self.assertGreater(stats["num_cache_releases"], before["num_cache_releases"])
+            t = torch.empty(1000, dtype=torch.uint8).pin_memory()
+            del t
+            self.assertEqual(torch.cuda.host_memory_stats()["cached_bytes.current"], 0)
+        finally:
+            torch.cuda.set_host_memory_cache_limit(2 ** 62)
+
     def test_caching_allocator_record_stream_oom(self):
         """allocations delayed by a record_stream call should still be freed on
         an out-of-memory in cuda_malloc_retry. see issue #19219"""
@@ -1380,6 +1430,148 @@ class TestCuda(TestCase):
         # cached blocks in case it affects future tests.
         torch.cuda.empty_cache()
 
+    @skipIfRocm
+    @unittest.skipIf(IS_WINDOWS, "expandable segments are not supported on Windows")
+    def test_expandable_segments(self):
+        # The allocator reads PYTORCH_CUDA_ALLOC_CONF once, so run in a fresh process
+        import subprocess
+        env = dict(os.environ, PYTORCH_CUDA_ALLOC_CONF="expandable_segments:True")
+        subprocess.check_call([sys.executable, '-c', """\
+import torch
+
+mb = 1024 * 1024
+a = torch.empty(30 * mb, dtype=torch.uint8, device='cuda')
+b = torch.empty(30 * mb, dtype=torch.uint8, device='cuda')
+assert b.data_ptr() == a.data_ptr() + 30 * mb
+reserved = torch.cuda.memory_reserved()
+del a, b
+# the two freed blocks coalesce, so no memory is mapped for a larger one
+c = torch.ones(50 * mb, dtype=torch.uint8, device='cuda')
+assert torch.cuda.memory_reserved() == reserved
+assert c.sum().item() == 50 * mb
+snapshot = torch.cuda.memory_snapshot()
+assert all(s['is_expandable'] for s in snapshot)
+assert sum(s['total_size'] for s in snapshot) == torch.cuda.memory_reserved()
+del c
+torch.cuda.empty_cache()
+assert torch.cuda.memory_reserved() == 0
+"""], env=env)
+
+    def test_stream_ordered_free(self):
+        import subprocess
+        env = dict(os.environ, PYTORCH_CUDA_ALLOC_CONF="stream_ordered_free:True")
+        subprocess.check_call([sys.executable, '-c', """\
+import torch
+
+side = torch.cuda.Stream()
+x = torch.empty(1024 * 1024, device='cuda')
+ptr = x.data_ptr()
+with torch.cuda.stream(side):
+    torch.cuda._sleep(50000000)
+    x.fill_(1)
+    # freed while the side stream is current, no record_stream needed
+    del x
+# reused on the allocation stream, which waits for the side stream
+y = torch.zeros(1024 * 1024, device='cuda')
+assert y.data_ptr() == ptr
+assert y.sum().item() == 0
+"""], env=env)
+
+    def test_garbage_collection_threshold(self):
+        import subprocess
+        env = dict(os.environ, PYTORCH_CUDA_ALLOC_CONF="garbage_collection_threshold:0.5")
+        subprocess.check_call([sys.executable, '-c', """\
+import torch
+
+torch.cuda.set_per_process_memory_fraction(0.5)
+limit = torch.cuda.get_device_properties(0).total_memory * 0.5
+size = int(limit * 0.1) // 4
+small = torch.empty(1024, device='cuda')
+del small
+small_reserved = torch.cuda.memory_stats()['reserved_bytes.small_pool.current']
+tensors = [torch.empty(size, device='cuda') for _ in range(4)]
+newest = tensors[1].data_ptr()
+del tensors[:2]
+# doesn't fit below half of the limit with both cached tensors kept
+big = torch.empty(int(limit * 0.15) // 4, device='cuda')
+assert torch.cuda.memory_reserved() <= limit * 0.5
+assert torch.cuda.memory_stats()['reserved_bytes.small_pool.current'] == small_reserved
+# the most recently freed segment is still cached
+again = torch.empty(size, device='cuda')
+assert again.data_ptr() == newest
+"""], env=env)
+
+    @unittest.skipIf(TEST_WITH_ROCM, "cudaMallocAsync is not available on ROCm")
+    def test_malloc_async_backend(self):
+        import subprocess
+        env = dict(os.environ, PYTORCH_CUDA_ALLOC_CONF="backend:cudaMallocAsync")
+        subprocess.check_call([sys.executable, '-c', """\
+import torch
+
+if torch.cuda.get_allocator_backend() != 'cudaMallocAsync':
+    # the CUDA toolkit is too old, the native backend is used
+    exit(0)
+a = torch.ones(3 * 1024 * 1024, device='cuda')
+assert torch.cuda.memory_allocated() == a.numel() * 4
+assert torch.cuda.memory_reserved() >= torch.cuda.memory_allocated()
+side = torch.cuda.Stream()
+with torch.cuda.stream(side):
+    b = a * 2
+a.record_stream(side)
+del a
+assert b.sum().item() == 6 * 1024 * 1024
+del b
+assert torch.cuda.memory_allocated() == 0
+torch.cuda.empty_cache()
+assert torch.cuda.memory_snapshot() == []
+"""], env=env)
+
+    def test_memory_history(self):
+        nbytes = 311 * 411 * 4
+        try:
+            torch.cuda.memory._record_memory_history(True, trace_alloc_max_entries=100,
+                                                     trace_alloc_record_context=True)
+            with torch.autograd.profiler.record_function("history_scope"):
+                x = torch.rand(311, 411, device='cuda')
+            ss = torch.cuda.memory._snapshot()
+            blocks = [b for s in ss['segments'] for b in s['blocks'] if b['requested_size'] == nbytes]
+            self.assertEqual(len(blocks), 1)
+            self.assertEqual(blocks[0]['state'], 'active_allocated')
+            self.assertIn('history_scope', blocks[0]['scopes'])
+            self.assertIn('aten::rand', blocks[0]['scopes'])
+
+            del x
+            trace = torch.cuda.memory._snapshot()['device_traces'][torch.cuda.current_device()]
+            actions = [e['action'] for e in trace if e['size'] == nbytes]
+            self.assertEqual(actions, ['alloc', 'free_requested', 'free_completed'])
+            self.assertIn('history_scope', trace[-1]['scopes'])
+
+            # the trace is a ring buffer of the last events
+            torch.cuda.memory._record_memory_history(True, trace_alloc_max_entries=4)
+            for _ in range(10):
+                torch.empty(1000, device='cuda')
+            trace = torch.cuda.memory._snapshot()['device_traces'][torch.cuda.current_device()]
+            self.assertEqual(len(trace), 4)
+            self.assertNotIn('scopes', trace[-1])
+        finally:
+            torch.cuda.memory._record_memory_history(False)
+
+    def test_memory_history_oom_snapshot(self):
+        with tempfile.TemporaryDirectory() as d:
+            path = os.path.join(d, 'oom.pickle')
+            try:
+                torch.cuda.memory._record_memory_history(True, trace_alloc_max_entries=10,
+                                                         oom_snapshot_path=path)
+                with self.assertRaisesRegex(RuntimeError, "out of memory"):
+                    torch.empty(1 << 50, dtype=torch.uint8, device='cuda')
+                with open(path, 'rb') as f:
+                    ss = pickle.load(f)
+                trace = ss['device_traces'][torch.cuda.current_device()]
+                self.assertEqual(trace[-1]['action'], 'oom')
+                self.assertEqual(trace[-1]['size'], 1 << 50)
+            finally:
+                torch.cuda.memory._record_memory_history(False)
+
     # Tests for historic illegal memory access, see #17040.
     def test_reduction_gpu_memory_accessing(self):
         x = torch.ones(512, 8, dtype=torch.float32, device='cuda')
@@ -3417,6 +3609,110 @@ torch.cuda.synchronize()
             torch.cuda.synchronize()
             torch.cuda.empty_cache()
 
+    @unittest.skipIf((not TEST_CUDA) or
+                     TEST_WITH_ROCM or
+                     int(torch.version.cuda.split(".")[0]) < 11, "CUDA >= 11.0 required for graphs")
+    def test_graph_record_stream(self):
+        # Frees of tensors used on other streams during a capture are
+        # deferred until the capture ends, instead of recording events
+        s0 = torch.cuda.Stream()
+        s1 = torch.cuda.Stream()
+        g = torch.cuda.CUDAGraph()
+        with torch.cuda.stream(s0):
+            a = torch.ones((1000,), device="cuda")
+            g.capture_begin()
+            self.assertTrue(torch.cuda.is_current_stream_capturing())
+            b = a * 2
+            s1.wait_stream(s0)
+            with torch.cuda.stream(s1):
+                c = b + 1
+            b.record_stream(s1)
+            del b
+            s0.wait_stream(s1)
+            c.record_stream(s0)
+            g.capture_end()
+        self.assertFalse(torch.cuda.is_current_stream_capturing())
+        torch.cuda.current_stream().wait_stream(s0)
+
+        g.replay()
+        self.assertEqual(c.sum().item(), 3000.)
+
+    @unittest.skipIf((not TEST_CUDA) or
+                     TEST_WITH_ROCM or
+                     int(torch.version.cuda.split(".")[0]) < 11, "CUDA >= 11.0 required for graphs")
+    def test_graph_training_step(self):
+        # Captures forward, backward and a capturable optimizer step
+        for opt_class in (torch.optim._multi_tensor.Adam, torch.optim._multi_tensor.AdamW):
+            for amsgrad in (False, True):
+                torch.manual_seed(5)
+                model_eager = torch.nn.Sequential(torch.nn.Linear(8, 16), torch.nn.ReLU(),
+                                                  torch.nn.Linear(16, 4)).cuda()
+                model_graphed = copy.deepcopy(model_eager)
+                opt_eager = opt_class(model_eager.parameters(), lr=0.1, amsgrad=amsgrad)
+                opt_graphed = opt_class(model_graphed.parameters(), lr=0.1, amsgrad=amsgrad,
+                                        capturable=True)
+                inputs = [torch.randn(6, 8, device="cuda") for _ in range(5)]
+
+                static_input = torch.zeros_like(inputs[0])
+                s = torch.cuda.Stream()
+                s.wait_stream(torch.cuda.current_stream())
+                with torch.cuda.stream(s):
+                    for i in range(3):
+                        opt_graphed.zero_grad(set_to_none=True)
+                        static_input.copy_(inputs[i])
+                        model_graphed(static_input).sum().backward()
+                        opt_graphed.step()
+                torch.cuda.current_stream().wait_stream(s)
+
+                g = torch.cuda.CUDAGraph()
+                opt_graphed.zero_grad(set_to_none=True)
+                with torch.cuda.graph(g):
+                    static_loss = model_graphed(static_input).sum()
+                    static_loss.backward()
+                    opt_graphed.step()
+
+                for i in range(3):
+                    opt_eager.zero_grad(set_to_none=True)
+                    model_eager(inputs[i]).sum().backward()
+                    opt_eager.step()
+                for i in range(3, 5):
+                    opt_eager.zero_grad(set_to_none=True)
+                    model_eager(inputs[i]).sum().backward()
+                    opt_eager.step()
+                    static_input.copy_(inputs[i])
+                    g.replay()
+
+                for p_eager, p_graphed in zip(model_eager.parameters(), model_graphed.parameters()):
+                    self.assertEqual(p_eager, p_graphed)
+                for p in model_graphed.parameters():
+                    self.assertEqual(opt_graphed.state[p]['step'].item(), 5)
+
+    @unittest.skipIf((not TEST_CUDA) or
+                     TEST_WITH_ROCM or
+                     int(torch.version.cuda.split(".")[0]) < 11, "CUDA >= 11.0 required for graphs")
+    def test_graph_inference_replay(self):
+        model = torch.nn.Sequential(torch.nn.Linear(8, 16), torch.nn.ReLU(),
+                                    torch.nn.Linear(16, 4)).cuda().eval()
+        frozen = torch.jit.freeze(torch.jit.script(model))
+        graphed = torch.cuda.make_graphed_inference(
+            frozen, [torch.randn(1, 8, device="cuda"), (torch.randn(5, 8, device="cuda"),)])
+
+        with torch.no_grad():
+            for rows in (1, 5, 3):
+                x = torch.randn(rows, 8, device="cuda")
+                self.assertEqual(graphed(x), model(x))
+
+            # captured shapes return their static outputs, others run the module
+            x = torch.randn(5, 8, device="cuda")
+            out = graphed(x)
+            self.assertEqual(graphed(x).data_ptr(), out.data_ptr())
+            fallback_out = graphed(torch.randn(3, 8, device="cuda"))
+            self.assertNotEqual(graphed(torch.randn(3, 8, device="cuda")).data_ptr(),
+                                fallback_out.data_ptr())
+
+        with self.assertRaisesRegex(ValueError, "must be CUDA tensors"):
+            torch.cuda.make_graphed_inference(frozen, [torch.randn(1, 8)])
+
     def test_batch_norm_gather_stats(self):
         input = torch.randn(1, 3, 3, 3, device='cuda')
         mean, invstd = torch.batch_norm_gather_stats(
@@ -11,7 +11,7 @@ import numpy as np
 from torch.testing._internal.common_utils import TestCase, run_tests, make_tensor
 from torch.testing._internal.common_device_type import (
     instantiate_device_type_tests, onlyCUDA, dtypes, dtypesIfCPU, dtypesIfCUDA,
-    onlyOnCPUAndCUDA)
+    onlyOnCPUAndCUDA, onlyCPU)
 
 
 class TestIndexing(TestCase):
@@ -741,6 +741,22 @@ class TestIndexing(TestCase):
         self.assertEqual(a[-2], 13)
         self.assertEqual(a[-1], 14)
 
+    @onlyCPU
+    @dtypes(torch.double, torch.long, torch.bfloat16)
+    def test_index_put_accumulate_parallel(self, device, dtype):
+        # Large enough to take the parallel bucketed path, which must match the
+        # serial accumulation exactly (see Note [Parallel accumulation in index_put_ and put_])
+        n, m = 200000, 1000
+        indices = torch.randint(m, (n,), device=device)
+        values = torch.randint(-10, 10, (n, 3), device=device).to(dtype)
+        # index_add_ accumulates serially in the same order
+        expected = torch.zeros(m, 3, dtype=dtype, device=device).index_add_(0, indices, values)
+        self.assertEqual(torch.zeros(m, 3, dtype=dtype, device=device).index_put_((indices, ), values, accumulate=True),
+                         expected, atol=0, rtol=0)
+        flat = torch.zeros(m * 3, dtype=dtype, device=device)
+        flat.put_(indices * 3, values[:, 0], accumulate=True)
+        self.assertEqual(flat.view(m, 3)[:, 0], expected[:, 0], atol=0, rtol=0)
+
     def test_multiple_byte_mask(self, device):
         v = torch.randn(5, 7, 3, device=device)
         # note: these broadcast together and are transposed to the first dim
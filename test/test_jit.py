@@ -10579,6 +10579,27 @@ dedent """
             self.assertEqual(torch.autograd.grad(sout.sum(), inputs),
                              torch.autograd.grad(out.sum(), inputs))
 
+    def test_independent_linear_batching(self):
+        def fn(x1, x2, x3, w1, w2, w3, b1, b3):
+            a = torch.nn.functional.linear(x1, w1, b1)
+            b = torch.addmm(b3, x3, w3)
+            c = torch.relu(a)
+            # depends on a, so it must not join the batch
+            d = torch.nn.functional.linear(c, w2, b1)
+            e = torch.addmm(b3, x1, w1)
+            return a, b, c + d, torch.nn.functional.linear(x2, w2, b1), e
+
+        inputs = [torch.rand(4, 8) for _ in range(3)] + [torch.rand(8, 8) for _ in range(3)] + \
+            [torch.rand(8), torch.rand(4, 8)]
+        graph = torch.jit.script(fn).graph
+        torch._C._jit_pass_complete_shape_analysis(graph, tuple(inputs), False)
+        self.run_pass('batch_mm', graph)
+        FileCheck().check("prim::MMBatchLinear").check_count("aten::linear", 1, exactly=True) \
+            .check_not("aten::addmm").run(str(graph))
+
+        batched = torch._C._create_function_from_graph("forward", graph)
+        self.assertEqual(batched(*inputs), fn(*inputs))
+
     def test_loop_unrolling(self):
         def fn(x):
             y = 0
@@ -769,6 +769,32 @@ class TestCudaFuser(JitTestCase):
         self.assertEqual(o, jit_o)
         self.assertGraphContains(t_jit.graph_for(x, y, z), FUSION_GUARD)
 
+    @unittest.skipIf(not RUN_CUDA, "requires CUDA")
+    @unittest.skipIf(GRAPH_EXECUTOR != ProfilingMode.PROFILING,
+                     "Requires fusion optimization pass to be effective")
+    def test_segmented_reduction(self):
+        dtype = torch.float
+        device = "cuda"
+        x = torch.randn([7, 4, 8], dtype=dtype, device=device)
+        y = torch.randn([7, 4, 8], dtype=dtype, device=device)
+
+        # two reductions, and a normalization reading the input of the first
+        # reduction, are split into several kernels
+        def t(x: torch.Tensor, y: torch.Tensor):
+            o = torch.mul(x, y)
+            s = torch.sum(o, dim=[0])
+            o = torch.sub(o, s)
+            o = torch.relu(o)
+            o = torch.sum(o, dim=[2])
+            return o
+        t_jit = torch.jit.script(t)
+        jit_o = t_jit(x, y)
+        jit_o = t_jit(x, y)
+        o = t(x, y)
+        self.assertEqual(o.dtype, jit_o.dtype)
+        self.assertTrue(self._compare("comparing output failed", o, jit_o, 1e-4))
+        self.assertGraphContains(t_jit.graph_for(x, y), FUSION_GUARD)
+
     @unittest.skipIf(not RUN_CUDA, "requires CUDA")
     @unittest.skipIf(GRAPH_EXECUTOR != ProfilingMode.PROFILING,
                      "Requires fusion optimization pass to be effective")
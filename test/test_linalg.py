@@ -3037,6 +3037,49 @@ class TestLinalg(TestCase):
             test_inverse_many_batches_helper(torch_inverse, 3, 512)
             test_inverse_many_batches_helper(torch_inverse, 64, 64)
 
+    # Exercises the register (n <= 8) and warp (8 < n <= 32) small-matrix kernels,
+    # see Note [Small-matrix batched linear algebra]
+    @onlyCUDA
+    @skipCUDAIfNoMagmaAndNoCusolver
+    @skipCPUIfNoLapack
+    @dtypes(torch.float32, torch.float64)
+    @precisionOverride({torch.float32: 1e-3, torch.float64: 1e-8})
+    def test_small_matrix_batched(self, device, dtype):
+        from torch.testing._internal.common_utils import (random_fullrank_matrix_distinct_singular_value,
+                                                          random_hermitian_pd_matrix)
+
+        for n, batch in [(1, 4), (2, 300), (3, 64), (5, 7), (8, 1000), (12, 64), (17, 300), (32, 256)]:
+            A = random_fullrank_matrix_distinct_singular_value(n, batch, dtype=dtype)
+            B = torch.randn(batch, n, 3, dtype=dtype)
+            A_cuda, B_cuda = A.to(device), B.to(device)
+
+            self.assertEqual(torch.inverse(A_cuda), torch.inverse(A), atol=self.precision, rtol=1e-3)
+            self.assertEqual(torch.linalg.inv(A_cuda), torch.linalg.inv(A), atol=self.precision, rtol=1e-3)
+            self.assertEqual(torch.linalg.solve(A_cuda, B_cuda), torch.linalg.solve(A, B), atol=self.precision, rtol=1e-3)
+            self.assertEqual(torch.solve(B_cuda, A_cuda)[0], torch.solve(B, A)[0], atol=self.precision, rtol=1e-3)
+
+            LU, pivots = torch.lu(A_cuda)
+            expected_LU, expected_pivots = torch.lu(A)
+            self.assertEqual(LU, expected_LU, atol=self.precision, rtol=1e-3)
+            self.assertEqual(pivots, expected_pivots)
+            LU, pivots = torch.lu(A_cuda, pivot=False)
+            _, L, U = torch.lu_unpack(LU, pivots)
+            self.assertEqual(L @ U, A_cuda, atol=self.precision, rtol=1e-3)
+
+            H = random_hermitian_pd_matrix(n, batch, dtype=dtype)
+            for upper in [False, True]:
+                self.assertEqual(torch.cholesky(H.to(device), upper=upper), torch.cholesky(H, upper=upper),
+                                 atol=self.precision, rtol=1e-3)
+
+        # errors are reported for the first failing matrix like the library paths
+        A = torch.eye(12, dtype=dtype, device=device).repeat(64, 1, 1)
+        A[5, -1, -1] = 0
+        with self.assertRaisesRegex(RuntimeError, r'For batch 5: U\(12,12\) is zero'):
+            torch.inverse(A)
+        A[5, -1, -1] = -1
+        with self.assertRaisesRegex(RuntimeError, r'For batch 5: U\(12,12\) is zero'):
+            torch.cholesky(A)
+
     @skipIfRocm  # https://github.com/pytorch/pytorch/issues/55552
     @skipCUDAIfNoMagmaAndNoCusolver
     @skipCPUIfNoLapack
@@ -5658,6 +5701,27 @@ scipy_lobpcg  | {:10.2e}  | {:10.2e}  | {:6} | N/A
                     m2 = torch.randn(k, m, device=device).to(dtype)
                     self._test_addmm_addmv(torch.addmm, M, m1, m2)
 
+    @dtypes(torch.float, torch.double)
+    @tf32_on_and_off(0.005)
+    def test_addmm_activation(self, device, dtype):
+        # A 1-d bias, as in nn.Linear, takes the fused epilogue on CUDA
+        for bias_size, use_gelu, transpose in itertools.product(((25,), (10, 25)), (False, True), (False, True)):
+            M = torch.randn(*bias_size, device=device, dtype=dtype)
+            m1 = torch.randn(10, 50, device=device, dtype=dtype)
+            m2 = torch.randn(25, 50, device=device, dtype=dtype)
+            m2 = m2.t() if transpose else m2.t().contiguous()
+            res = torch._addmm_activation(M, m1, m2, use_gelu=use_gelu)
+            ref = torch.addmm(M, m1, m2)
+            ref = torch.nn.functional.gelu(ref) if use_gelu else ref.relu()
+            self.assertEqual(res, ref)
+
+        # Backward, with a bias broadcast over the rows
+        for use_gelu in (False, True):
+            M = torch.randn(5, device=device, dtype=torch.double, requires_grad=True)
+            m1 = torch.randn(3, 4, device=device, dtype=torch.double, requires_grad=True)
+            m2 = torch.randn(4, 5, device=device, dtype=torch.double, requires_grad=True)
+            gradcheck(lambda *args: torch._addmm_activation(*args, beta=0.5, alpha=2, use_gelu=use_gelu), (M, m1, m2))
+
     @unittest.skipIf(IS_FBCODE and IS_REMOTE_GPU, "cublas runtime error")
     @onlyCUDA
     def test_matmul_45724(self, device):
@@ -5853,6 +5917,24 @@ scipy_lobpcg  | {:10.2e}  | {:10.2e}  | {:6} | N/A
                     self.assertRaises(RuntimeError, lambda: torch.bmm(b1.cpu(), b2))
                     self.assertRaises(RuntimeError, lambda: torch.bmm(b1, b2, out=res2.cpu()))
 
+    @onlyCPU
+    @dtypes(torch.float, torch.double)
+    def test_bmm_small_matrices(self, device, dtype):
+        # shapes around the vectorized kernel's tile sizes, below and above the
+        # naive kernel threshold
+        shapes = [(1, 1, 1), (3, 5, 7), (4, 16, 2), (5, 17, 9), (17, 33, 3), (64, 64, 64), (65, 3, 129)]
+        for (M, N, O), transpose1, transpose2 in itertools.product(shapes, (False, True), (False, True)):
+            b1 = make_tensor((6, N, M) if transpose1 else (6, M, N), device, dtype, low=-1, high=1)
+            b2 = make_tensor((6, O, N) if transpose2 else (6, N, O), device, dtype, low=-1, high=1)
+            b1 = b1.transpose(1, 2) if transpose1 else b1
+            b2 = b2.transpose(1, 2) if transpose2 else b2
+            expect = torch.stack([b1[i].double() @ b2[i].double() for i in range(6)]).to(dtype)
+            self.assertEqual(torch.bmm(b1, b2), expect)
+            # beta == 0 ignores nans in self
+            self.assertEqual(torch.baddbmm(torch.full_like(expect, nan), b1, b2, beta=0, alpha=2), 2 * expect)
+            c = make_tensor(expect.shape, device, dtype, low=-1, high=1)
+            self.assertEqual(torch.baddbmm(c, b1, b2, beta=0.5, alpha=-1), 0.5 * c - expect)
+
     @unittest.skipIf(IS_FBCODE and IS_REMOTE_GPU, "cublas runtime error")
     @onlyCUDA
     @wrapDeterministicFlagAPITest
@@ -37,7 +37,8 @@ from torch.testing import get_all_fp_dtypes
 from torch.testing._internal.common_utils import freeze_rng_state, run_tests, TestCase, skipIfNoLapack, skipIfRocm, \
     TEST_NUMPY, TEST_SCIPY, TEST_WITH_ROCM, download_file, \
     get_function_arglist, load_tests, repeat_test_for_types, ALL_TENSORTYPES, \
-    ALL_TENSORTYPES2, suppress_warnings, TemporaryFileName, TEST_WITH_UBSAN, IS_PPC
+    ALL_TENSORTYPES2, suppress_warnings, TemporaryFileName, TEST_WITH_UBSAN, IS_PPC, \
+    DeterministicGuard
 from torch.testing._internal.common_cuda import TEST_CUDA, TEST_MULTIGPU, TEST_CUDNN, TEST_CUDNN_VERSION
 from torch.testing._internal.common_nn import NNTestCase, NewModuleTest, CriterionTest, \
     module_tests, criterion_tests, loss_reference_fns, \
@@ -4785,6 +4786,36 @@ class TestNN(NNTestCase):
             with torch.backends.mkldnn.flags(enabled=enabled):
                 gradcheck(F.conv2d, (input, mod.weight))
 
+    def test_Conv2d_direct_cpu(self):
+        # Without autograd, depthwise and channels last convolutions take the
+        # direct CPU kernels; compare them with the im2col path taken when the
+        # weight requires grad.
+        def compare(input, weight, bias, **kwargs):
+            expected = F.conv2d(input, weight.requires_grad_(), bias, **kwargs).detach()
+            weight.requires_grad_(False)
+            with torch.no_grad():
+                actual = F.conv2d(input, weight, bias, **kwargs)
+            self.assertEqual(actual, expected)
+
+        with torch.backends.mkldnn.flags(enabled=False):
+            for dtype in (torch.float, torch.double):
+                for kernel, stride, padding, dilation in product(
+                        ((1, 1), (3, 3), (5, 2)), (1, 2), (0, 1, (2, 0)), (1, 2)):
+                    for multiplier in (1, 2):
+                        input = torch.randn(2, 6, 17, 19, dtype=dtype)
+                        weight = torch.randn(6 * multiplier, 1, *kernel, dtype=dtype)
+                        bias = torch.randn(6 * multiplier, dtype=dtype)
+                        compare(input, weight, bias, stride=stride, padding=padding,
+                                dilation=dilation, groups=6)
+
+                    input = torch.randn(2, 5, 13, 11, dtype=dtype).contiguous(memory_format=torch.channels_last)
+                    weight = torch.randn(7, 5, *kernel, dtype=dtype)
+                    for bias in (None, torch.randn(7, dtype=dtype)):
+                        compare(input, weight, bias, stride=stride, padding=padding, dilation=dilation)
+                        with torch.no_grad():
+                            out = F.conv2d(input, weight, bias, stride=stride, padding=padding, dilation=dilation)
+                        self.assertTrue(out.is_contiguous(memory_format=torch.channels_last))
+
     def test_Conv2d_OneDNN(self):
         def run_once(group_val=24, dilation=1):
             ifm = torch.ones([1, group_val, 6, 6], dtype=torch.float32)
@@ -5752,6 +5783,21 @@ class TestNN(NNTestCase):
         self.assertRaises(Exception, lambda: lstm(input, (hx, cx)))
         self.assertRaises(Exception, lambda: lstm(input, (cx, hx)))
 
+    def test_RNN_fused_cell_cpu(self):
+        # without autograd, LSTM and GRU layers run their whole sequence with
+        # fused pointwise kernels, compare them with the composite ops
+        for module, dtype, bias, batch_first in product(
+                (nn.LSTM, nn.GRU), (torch.float, torch.double), (True, False), (True, False)):
+            # hidden size not a multiple of the vector width
+            rnn = module(10, 19, num_layers=2, bidirectional=True, bias=bias,
+                         batch_first=batch_first).to(dtype)
+            input = torch.randn(5, 3, 10, dtype=dtype, requires_grad=True)
+            expected_output, expected_hidden = rnn(input)
+            with torch.no_grad():
+                output, hidden = rnn(input)
+            self.assertEqual(output, expected_output)
+            self.assertEqual(hidden, expected_hidden)
+
 
     @unittest.skipIf(not TEST_CUDA, 'CUDA not available')
     def test_pack_sequence_batch_sizes_throw(self):
@@ -9941,6 +9987,29 @@ class TestNN(NNTestCase):
         self.assertEqual(input.grad.dtype, dtype)
         self.assertEqual(input.grad, inputf.grad.to(dtype), atol=0.1, rtol=0)
 
+    def test_bfloat16_normalization_cpu(self, dtype=torch.bfloat16):
+        inputf = torch.randn(8, 16, 37, device="cpu", dtype=torch.float)
+        input = inputf.to(dtype)
+
+        out = F.softmax(input, dim=-1)
+        self.assertEqual(out.dtype, dtype)
+        self.assertEqual(out, F.softmax(inputf, dim=-1).to(dtype), atol=1e-2, rtol=0)
+
+        out = F.layer_norm(input, (37,))
+        self.assertEqual(out.dtype, dtype)
+        self.assertEqual(out, F.layer_norm(inputf, (37,)).to(dtype), atol=0.05, rtol=0)
+
+        bn = nn.BatchNorm1d(16).eval()
+        bn.running_mean.uniform_()
+        bn.running_var.uniform_(0.5, 1.5)
+        out = bn.to(dtype)(input)
+        self.assertEqual(out.dtype, dtype)
+        self.assertEqual(out, bn.float()(inputf).to(dtype), atol=0.05, rtol=0)
+
+        out = input.sum(dim=-1)
+        self.assertEqual(out.dtype, dtype)
+        self.assertEqual(out, inputf.to(dtype).float().sum(dim=-1).to(dtype), atol=0.1, rtol=1e-2)
+
     def test_adaptive_log_softmax(self):
         # args validation
         with self.assertRaises(ValueError):
@@ -11911,6 +11980,41 @@ class TestNNDeviceType(NNTestCase):
         if self.device_type == 'cuda':
             self._test_LayerNorm_cuda_half(device)
 
+    @onlyOnCPUAndCUDA
+    @dtypes(torch.float, torch.double)
+    def test_fused_dropout_add_layer_norm(self, device, dtype):
+        M, N, p, eps = 64, 100, 0.3, 1e-5
+        x = torch.randn(M, N, device=device, dtype=dtype, requires_grad=True)
+        residual = torch.randn(M, N, device=device, dtype=dtype, requires_grad=True)
+        weight = torch.randn(N, device=device, dtype=dtype, requires_grad=True)
+        bias = torch.randn(N, device=device, dtype=dtype, requires_grad=True)
+        inputs = (x, residual, weight, bias)
+        grad_out = torch.randn(M, N, device=device, dtype=dtype)
+
+        # The mask isn't returned; it is the nonzero pattern of the grad of x,
+        # which the backward computes from the regenerated mask
+        out = torch._fused_dropout_add_layer_norm(x, residual, weight, bias, p, True, eps)[0]
+        grads = torch.autograd.grad(out, inputs, grad_out)
+        mask = (grads[0] != 0).to(dtype)
+        self.assertEqual(mask.mean().item(), 1 - p, atol=0.05, rtol=0)
+        expected = F.layer_norm(x * mask / (1 - p) + residual, (N,), weight, bias, eps)
+        self.assertEqual(out, expected)
+        self.assertEqual(grads, torch.autograd.grad(expected, inputs, grad_out))
+
+        # The same seed gives the same mask
+        outs = [torch._fused_dropout_add_layer_norm(
+            x, residual, weight, bias, p, True, eps,
+            generator=torch.Generator(device=device).manual_seed(0))[0] for _ in range(2)]
+        self.assertEqual(outs[0], outs[1])
+
+        # Without dropout
+        expected = F.layer_norm(x + residual, (N,), weight, bias, eps)
+        expected_grads = torch.autograd.grad(expected, inputs, grad_out)
+        for p_, train in ((p, False), (0., True)):
+            out = torch._fused_dropout_add_layer_norm(x, residual, weight, bias, p_, train, eps)[0]
+            self.assertEqual(out, expected)
+            self.assertEqual(torch.autograd.grad(out, inputs, grad_out), expected_grads)
+
     @onlyOnCPUAndCUDA
     def test_GroupNorm_general(self, device):
         self._test_GroupNorm_general(device)
@@ -12792,6 +12896,24 @@ class TestNNDeviceType(NNTestCase):
         fn = fn_wrapper(device)
         _assertGradAndGradgradChecks(self, fn, (weight, ))
 
+    @onlyCUDA
+    @dtypes(torch.float, torch.double)
+    def test_embedding_dense_backward_large_table(self, device, dtype):
+        # More indices than the feature kernel takes, into a table with at
+        # least as many rows: the backward adds the rows atomically unless
+        # deterministic algorithms are required
+        num_weights, num_indices = 10000, 5000
+        indices = torch.randint(num_weights, (num_indices,), device=device)
+        indices[:100] = 7  # a hot row
+        indices[100:200] = 0
+        grad = torch.randn(num_indices, 20, device=device, dtype=dtype)
+
+        expected = torch.zeros(num_weights, 20, dtype=dtype).index_add_(0, indices.cpu(), grad.cpu())
+        for deterministic in (False, True):
+            with DeterministicGuard(deterministic):
+                grad_weight = torch.embedding_dense_backward(grad, indices, num_weights, 0, False)
+            self.assertEqual(grad_weight, expected.to(device).index_fill_(0, torch.tensor([0], device=device), 0))
+
     def test_embedding_scalar_weight_error(self, device):
         indices = torch.rand(2, 2, device=device).long()
         weight = torch.tensor(1.0, device=device)
@@ -13021,6 +13143,32 @@ class TestNNDeviceType(NNTestCase):
             out2 = conv1(input_c)
             self.assertEqual(out1, out2)
 
+    @onlyCPU
+    @dtypes(torch.float, torch.double)
+    def test_upsample_grid_sample_channels_last(self, device, dtype):
+        # channels counts below, at and above the vector width
+        for C in (3, 8, 19):
+            input = torch.randn(2, C, 9, 11, device=device, dtype=dtype)
+            input_cl = input.contiguous(memory_format=torch.channels_last)
+
+            for mode, align_corners in product(('nearest', 'bilinear', 'bicubic'), (True, False)):
+                kwargs = dict(mode=mode) if mode == 'nearest' else dict(mode=mode, align_corners=align_corners)
+                for size in ((5, 7), (17, 23)):
+                    out = F.interpolate(input_cl, size=size, **kwargs)
+                    self.assertTrue(out.is_contiguous(memory_format=torch.channels_last))
+                    self.assertEqual(out, F.interpolate(input, size=size, **kwargs))
+
+            grid = torch.rand(2, 6, 13, 2, device=device, dtype=dtype) * 2.4 - 1.2
+            for mode, padding_mode, align_corners in product(
+                    ('nearest', 'bilinear', 'bicubic'), ('zeros', 'border', 'reflection'), (True, False)):
+                kwargs = dict(mode=mode, padding_mode=padding_mode, align_corners=align_corners)
+                out = F.grid_sample(input_cl, grid, **kwargs)
+                self.assertTrue(out.is_contiguous(memory_format=torch.channels_last))
+                self.assertEqual(out, F.grid_sample(input, grid, **kwargs))
+                # non-contiguous grid
+                grid_t = grid.transpose(1, 2).contiguous().transpose(1, 2)
+                self.assertEqual(F.grid_sample(input_cl, grid_t, **kwargs), F.grid_sample(input, grid_t, **kwargs))
+
     @onlyCUDA
     @tf32_on_and_off(0.005)
     def test_grid_sample_large(self, device):
@@ -14076,6 +14224,48 @@ class TestNNDeviceType(NNTestCase):
         self.assertEqual(output_non_contig, output_contig)
 
 
+    @onlyCPU
+    @dtypes(torch.half, torch.bfloat16)
+    def test_embedding_bag_reduced_precision_cpu(self, device, dtype):
+        weight = torch.randn(50, 33, device=device).to(dtype)
+        input = torch.randint(0, 50, (700,), device=device)
+        per_sample_weights = torch.randn(700, device=device).to(dtype)
+        # skewed bag lengths, including empty bags
+        offsets = torch.tensor([0, 0, 1, 200, 203, 203, 700], device=device)
+        for mode, include_last_offset in itertools.product(('sum', 'mean', 'max'), (False, True)):
+            psw = per_sample_weights if mode == 'sum' else None
+            out = F.embedding_bag(input, weight, offsets, mode=mode, per_sample_weights=psw,
+                                  include_last_offset=include_last_offset)
+            expected = F.embedding_bag(input, weight.float(), offsets, mode=mode,
+                                       per_sample_weights=None if psw is None else psw.float(),
+                                       include_last_offset=include_last_offset)
+            self.assertEqual(out.dtype, dtype)
+            self.assertEqual(out, expected.to(dtype), atol=1e-2, rtol=1e-2)
+
+        with self.assertRaisesRegex(RuntimeError, "out of bounds"):
+            F.embedding_bag(torch.tensor([0, 50], device=device), weight, torch.tensor([0], device=device))
+
+    @onlyCPU
+    @dtypes(torch.int, torch.long)
+    def test_embedding_bag_sparse_backward_coalesced_cpu(self, device, dtype):
+        input = torch.randint(0, 30, (5000,), device=device, dtype=dtype)
+        offsets = torch.tensor([0, 3, 3, 1000, 4000], device=device, dtype=dtype)
+        per_sample_weights = torch.randn(5000, device=device, dtype=torch.double)
+        for mode, scale_grad_by_freq in itertools.product(('sum', 'mean'), (False, True)):
+            psw = per_sample_weights if mode == 'sum' else None
+            grads = []
+            for sparse in (False, True):
+                weight = torch.ones(40, 7, device=device, dtype=torch.double, requires_grad=True)
+                out = F.embedding_bag(input, weight, offsets, mode=mode, sparse=sparse,
+                                      per_sample_weights=psw, scale_grad_by_freq=scale_grad_by_freq)
+                out.backward(torch.arange(out.numel(), device=device, dtype=torch.double).view_as(out))
+                grads.append(weight.grad)
+            dense_grad, sparse_grad = grads
+            self.assertTrue(sparse_grad.is_sparse)
+            self.assertTrue(sparse_grad.is_coalesced())
+            self.assertEqual(sparse_grad._indices(), input.unique().long().view(1, -1))
+            self.assertEqual(sparse_grad.to_dense(), dense_grad)
+
     @onlyCUDA
     @dtypes(torch.int, torch.long)
     def test_embedding_bag_bfloat16(self, device, dtype):
@@ -412,6 +412,79 @@ class TestProfiler(TestCase):
             sort_by="self_cuda_time_total", row_limit=-1)
         self.assertIn("FLOPS", profiler_output)
 
+    def test_sampling_profiler(self):
+        def add_count():
+            for stats in torch._C._autograd._sampling_profiler_snapshot():
+                if stats.name == "aten::add" and stats.input_shapes == "[[4, 8], [4, 8], []]":
+                    self.assertEqual(stats.count, sum(stats.buckets))
+                    return stats.count
+            return 0
+
+        x = torch.randn(3, 5)
+        y = torch.randn(3, 5)
+        count_before = add_count()
+        torch._C._autograd._enable_sampling_profiler(1.0)
+        try:
+            self.assertTrue(torch._C._autograd._sampling_profiler_enabled())
+            for _ in range(10):
+                torch.add(x, y)
+        finally:
+            torch._C._autograd._disable_sampling_profiler()
+        self.assertFalse(torch._C._autograd._sampling_profiler_enabled())
+        self.assertEqual(add_count() - count_before, 10)
+
+        # disabled: nothing is sampled
+        torch.add(x, y)
+        self.assertEqual(add_count() - count_before, 10)
+
+        prometheus = torch._C._autograd._sampling_profiler_prometheus()
+        self.assertIn("# TYPE torch_op_latency_seconds histogram", prometheus)
+        self.assertIn(
+            'torch_op_latency_seconds_count{op="aten::add",input_shapes="[[4, 8], [4, 8], []]"}',
+            prometheus)
+        self.assertIn("torch_op_samples_dropped_total", prometheus)
+
+    def test_sampling_profiler_perf_counters(self):
+        x = torch.randn(64, 64)
+        torch._C._autograd._enable_sampling_profiler(1.0, with_perf_counters=True)
+        try:
+            for _ in range(10):
+                torch.mm(x, x)
+        finally:
+            torch._C._autograd._disable_sampling_profiler()
+        stats = [s for s in torch._C._autograd._sampling_profiler_snapshot() if s.name == "aten::mm"]
+        self.assertTrue(len(stats) > 0)
+        # Hardware counters may not be available, e.g. in containers
+        if stats[0].cycles > 0:
+            self.assertGreater(stats[0].instructions, 0)
+            self.assertIn('torch_op_cycles_total{op="aten::mm"',
+                          torch._C._autograd._sampling_profiler_prometheus())
+
+    def test_memory_timeline(self):
+        nbytes = 4 * 1024 * 1024
+        with torch.autograd.profiler.memory_timeline() as timeline:
+            with record_function("block"):
+                x = torch.ones(1024, 1024)
+                y = (x * 2).sum()
+
+        self.assertTrue(any(e.bytes >= nbytes and e.scope.startswith("block/") for e in timeline.events))
+        cpu_peaks = [p for p in timeline.peaks if p.device == "cpu"]
+        self.assertEqual(len(cpu_peaks), 1)
+        # x and x * 2 are both alive at the peak
+        self.assertGreaterEqual(cpu_peaks[0].bytes, 2 * nbytes)
+        held = sum(n for scope, n in cpu_peaks[0].holders if scope.startswith("block/"))
+        self.assertGreaterEqual(held, 2 * nbytes)
+        # x * 2 is freed before the block ends, x is not
+        transients = {t.scope: t.bytes for t in timeline.transients if t.device == "cpu"}
+        self.assertGreaterEqual(transients.get("block", 0), nbytes)
+        self.assertLess(transients.get("block", 0), 2 * nbytes)
+        self.assertIn("Peak cpu memory", timeline.table())
+
+        with _profile():
+            with self.assertRaisesRegex(RuntimeError, "profiler is enabled"):
+                with torch.autograd.profiler.memory_timeline():
+                    pass
+
     @unittest.skipIf(not kineto_available(), "Kineto is required")
     def test_kineto_profiler_api(self):
         called_num = [0]
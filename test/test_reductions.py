@@ -773,6 +773,19 @@ class TestReductions(TestCase):
         big_out = torch.ones(1000000, dtype=torch.int8, device=device).bincount()
         self.assertEqual(big_exp, big_out)
 
+    @onlyCPU
+    def test_bincount_parallel(self, device):
+        # Large enough to count into per-thread private histograms
+        x = torch.randint(1000, (300007,), device=device)
+        self.assertEqual(x.bincount(), torch.from_numpy(np.bincount(x.numpy())), atol=0, rtol=0)
+        self.assertEqual(x.bincount(minlength=2000), torch.from_numpy(np.bincount(x.numpy(), minlength=2000)),
+                         atol=0, rtol=0)
+        w = torch.rand(300007, dtype=torch.double, device=device)
+        self.assertEqual(x.bincount(w), torch.from_numpy(np.bincount(x.numpy(), w.numpy())))
+        # Too many bins to privatize
+        x = torch.randint(10 ** 6, (100000,), device=device)
+        self.assertEqual(x.bincount(), torch.from_numpy(np.bincount(x.numpy())), atol=0, rtol=0)
+
     @onlyCUDA
     @expectedAlertNondeterministic('_bincount_cuda', fn_has_device_arg=False)
     def test_bincount_alert_nondeterministic(self, device):
@@ -1108,6 +1121,24 @@ class TestReductions(TestCase):
         self._test_sum_reduction_vs_numpy(torch.nansum, np.nansum, device, dtype, with_extremal=True)
         self._test_sum_reduction_vs_numpy(torch.nansum, np.nansum, device, dtype, with_keepdim=True)
 
+    @onlyCPU
+    @dtypes(torch.half, torch.bfloat16, torch.float)
+    def test_sum_nansum_cascade(self, device, dtype):
+        # Low precision inputs are accumulated in float, so long reductions
+        # stay close to the float64 result along any dimension
+        x = torch.rand(67, 3001, device=device).to(dtype)
+        x_nan = x.clone()
+        x_nan[::5, ::3] = float('nan')
+        for dim in (None, 0, 1):
+            for t in (x, x.t(), x[:, 1::2]):
+                ref = t.double().sum() if dim is None else t.double().sum(dim)
+                actual = t.sum() if dim is None else t.sum(dim)
+                self.assertEqual(actual.double(), ref, atol=0, rtol=1e-3 if dtype == torch.float else 1e-2)
+            ref = x_nan.double().nansum() if dim is None else x_nan.double().nansum(dim)
+            actual = x_nan.nansum() if dim is None else x_nan.nansum(dim)
+            self.assertEqual(actual.double(), ref, atol=0, rtol=1e-3 if dtype == torch.float else 1e-2)
+            self.assertFalse(actual.isnan().any())
+
     @dtypes(*(torch.testing.get_all_complex_dtypes()))
     def test_nansum_complex(self, device, dtype):
         x = torch.randn((3, 3, 3), device=device, dtype=dtype)
@@ -1352,6 +1383,29 @@ class TestReductions(TestCase):
         device_tensor = cpu_tensor.to(device)
         self.assertEqual(device_tensor.var(), cpu_tensor.var())
 
+    @onlyCPU
+    @dtypes(torch.float, torch.double, torch.bfloat16)
+    def test_var_mean_layouts(self, device, dtype):
+        # Compares against double for all-reduce, inner and outer reductions,
+        # with sizes spanning several Welford blocks and vector tails
+        x = torch.randn(37, 4099, device=device, dtype=torch.double).mul_(3).add_(10)
+        cases = [(x, None), (x, 1), (x, 0), (x.t(), 0), (x.t(), 1),
+                 (x[:, ::2], 1), (x[::3], 0), (x.flatten(), 0)]
+        for t, dim in cases:
+            t = t.to(dtype)
+            ref = t.double()
+            for unbiased in (True, False):
+                if dim is None:
+                    var, mean = torch.var_mean(t, unbiased=unbiased)
+                    ref_var, ref_mean = torch.var_mean(ref, unbiased=unbiased)
+                else:
+                    var, mean = torch.var_mean(t, dim, unbiased=unbiased)
+                    ref_var, ref_mean = torch.var_mean(ref, dim, unbiased=unbiased)
+                self.assertEqual(var, ref_var.to(dtype), exact_dtype=False)
+                self.assertEqual(mean, ref_mean.to(dtype), exact_dtype=False)
+                std = t.std(dim, unbiased=unbiased) if dim is not None else t.std(unbiased=unbiased)
+                self.assertEqual(std, ref_var.sqrt().to(dtype), exact_dtype=False)
+
     # TODO: update this test to compare against NumPy
     @onlyCUDA
     def test_var_large_input(self, device):
@@ -2248,6 +2302,14 @@ class TestReductions(TestCase):
         # Test truncated range
         test_against_np(torch.randn(201, device=device), min=0.1, max=1)
 
+        # Large enough to count into per-thread private histograms, with a
+        # length that leaves a scalar tail after the vectorized loop. Compare
+        # against the sum of histograms of pieces too small to be split
+        for dtype in [torch.float, torch.double]:
+            large = torch.randn(300007, dtype=dtype, device=device)
+            expected = sum(torch.histc(piece, bins=1000, min=-2, max=2) for piece in large.split(10000))
+            self.assertEqual(torch.histc(large, bins=1000, min=-2, max=2), expected, atol=0, rtol=0)
+
         noncontig = torch.randn(100, 3, device=device)[:, 2]
         test_against_np(noncontig)
 
@@ -607,6 +607,19 @@ class TestShapeOps(TestCase):
         self.assertEqual(dst1, dst4, atol=0, rtol=0)
         self.assertEqual(strides, dst4.stride())
 
+    @onlyCPU
+    @dtypes(torch.bool, torch.uint8, torch.float, torch.bfloat16)
+    def test_nonzero_large(self, device, dtype):
+        # Spans several chunks of the parallel count and scatter, with a shape
+        # whose rows straddle the chunk boundaries
+        t = (torch.rand(7, 311, 97, device=device) < 0.3).to(dtype)
+        np_result = torch.from_numpy(np.stack(t.float().numpy().nonzero())).t()
+        self.assertEqual(t.nonzero(), np_result, atol=0, rtol=0)
+        self.assertEqual(t.transpose(0, 2).nonzero(),
+                         torch.from_numpy(np.stack(t.transpose(0, 2).float().numpy().nonzero())).t(),
+                         atol=0, rtol=0)
+        self.assertEqual(torch.zeros(100000, dtype=dtype, device=device).nonzero().shape, (0, 1))
+
     def test_nonzero_non_diff(self, device):
         x = torch.randn(10, requires_grad=True)
         nz = x.nonzero()
@@ -3,7 +3,7 @@ import numpy as np
 
 import random
 from torch._six import nan
-from itertools import permutations
+from itertools import permutations, product
 
 from torch.testing._internal.common_utils import \
     (TestCase, run_tests, make_tensor, slowTest)
@@ -147,6 +147,29 @@ class TestSortAndSelect(TestCase):
                 torch.arange(start=1, end=2 * ncopies, step=2, device=device)
             )
 
+    # Slices with at least 2 ** 16 elements take the parallel radix/merge sort path
+    @onlyCPU
+    @dtypes(torch.bool, torch.uint8, torch.int32, torch.int64, torch.half, torch.float, torch.double)
+    def test_sort_large_slice(self, device, dtype):
+        n = 2 ** 17 + 3
+        if dtype == torch.bool:
+            x = torch.randint(0, 2, (n,), device=device).to(dtype)
+        elif dtype.is_floating_point:
+            x = torch.randint(-100, 100, (n,), device=device).to(dtype) / 7
+            x[torch.randint(0, n, (n // 100,))] = float('nan')
+            x[torch.randint(0, n, (n // 100,))] = -0.0
+        else:
+            x = torch.randint(0, 100, (n,), device=device).to(dtype)
+        # a strided view checks that the slice is gathered and scattered correctly
+        x = torch.stack([x, x.flip(0)], dim=1)[:, 0]
+        for descending in (False, True):
+            values, idx = x.sort(stable=True, descending=descending)
+            self.assertEqual(values, x[idx])
+            # NaNs compare greater than everything else
+            key = np.nan_to_num(x.double().numpy(), nan=np.inf)
+            expected = np.argsort(-key if descending else key, kind='stable')
+            self.assertEqual(idx, torch.from_numpy(expected))
+
     @onlyCUDA
     @dtypes(torch.uint8)
     @largeTensorTest('200GB')  # Unfortunately 80GB A100 is not large enough
@@ -608,6 +631,25 @@ class TestSortAndSelect(TestCase):
         self.assertEqual(val, expected_val, atol=0, rtol=0)
         self.assertEqual(ind, expected_ind, atol=0, rtol=0)
 
+    # Covers the heap and radix select strategies of the CPU kernel and, with
+    # rows of at least 2 ** 18 elements, splitting a row between threads
+    @onlyCPU
+    @dtypes(torch.uint8, torch.int64, torch.float, torch.double)
+    def test_topk_long_rows(self, device, dtype):
+        for rows, n in ((1, 2 ** 18 + 5), (3, 1000)):
+            x = torch.randint(0, 100, (rows, n), device=device).to(dtype)
+            if dtype.is_floating_point:
+                x[:, torch.randint(0, n, (n // 100,))] = float('nan')
+            for k, largest in product((1, 10, n // 2), (True, False)):
+                val, idx = x.topk(k, largest=largest)
+                # ties go to the smaller index, as in a stable sort
+                expect_val, expect_idx = x.sort(descending=largest, stable=True)
+                self.assertEqual(val, expect_val[:, :k])
+                self.assertEqual(idx, expect_idx[:, :k])
+
+                val, idx = x.topk(k, largest=largest, sorted=False)
+                self.assertEqual(idx.sort().values, expect_idx[:, :k].sort().values)
+
     def _test_unique_scalar_empty(self, dtype, device, f):
         # test scalar
         x = torch.tensor(0, dtype=dtype, device=device)
@@ -712,6 +754,39 @@ class TestSortAndSelect(TestCase):
                                     count += 1
                             self.assertEqual(j, count)
 
+    @dtypes(torch.long, torch.float)
+    def test_unique_large(self, device, dtype):
+        # Large enough for the parallel CPU kernels
+        x = torch.randint(0, 5000, (200000,), device=device).to(dtype)
+        x_np = x.cpu().numpy()
+        expected, expected_inverse, expected_counts = np.unique(x_np, return_inverse=True, return_counts=True)
+        for is_sorted in (True, False):
+            unique, inverse, counts = torch.unique(x, sorted=is_sorted, return_inverse=True, return_counts=True)
+            if is_sorted:
+                self.assertEqual(unique.cpu().numpy(), expected)
+                self.assertEqual(counts.cpu().numpy(), expected_counts)
+            else:
+                order = unique.argsort()
+                self.assertEqual(unique[order].cpu().numpy(), expected)
+                self.assertEqual(counts[order].cpu().numpy(), expected_counts)
+            self.assertEqual(unique[inverse], x)
+
+        # Runs of equal values
+        x = x.sort().values.repeat(2)
+        unique, inverse, counts = torch.unique_consecutive(x, return_inverse=True, return_counts=True)
+        self.assertEqual(unique.cpu().numpy(), np.concatenate([expected, expected]))
+        self.assertEqual(counts.cpu().numpy(), np.concatenate([expected_counts, expected_counts]))
+        self.assertEqual(unique[inverse], x)
+
+        # Rows of a 2-d tensor
+        x = torch.randint(0, 3, (40000, 4), device=device).to(dtype)
+        x_np = x.cpu().numpy()
+        expected, expected_inverse, expected_counts = np.unique(x_np, axis=0, return_inverse=True, return_counts=True)
+        unique, inverse, counts = torch.unique(x, dim=0, return_inverse=True, return_counts=True)
+        self.assertEqual(unique.cpu().numpy(), expected)
+        self.assertEqual(inverse.cpu().numpy(), expected_inverse.reshape(-1))
+        self.assertEqual(counts.cpu().numpy(), expected_counts)
+
     @dtypes(*set(torch.testing.get_all_dtypes()) - {torch.bfloat16, torch.complex64, torch.complex128})
     def test_unique_consecutive(self, device, dtype):
         if dtype is torch.half and self.device_type == 'cpu':
@@ -226,6 +226,32 @@ class TestSparse(TestCase):
             t, _, _ = self._gen_sparse(len(sparse_size), nnz, sparse_size + dense_size, dtype, device, coalesced)
             _test_coalesce(t)  # this tests correctness
 
+    @dtypes(torch.double, torch.long)
+    def test_coalesce_large(self, device, dtype):
+        # Enough nonzeros that coalesce sorts and reduces them in parallel
+        # chunks, with keys that take several radix sort passes.
+        for sparse_size, dense_size in [([1 << 20], []), ([300, 700], [3, 5]), ([2, 3, 1 << 30], [17])]:
+            nnz = 100000
+            indices = torch.stack([torch.randint(s, (nnz,), device=device) for s in sparse_size])
+            # Repeat some of the nonzeros, so that there are runs to reduce.
+            indices = torch.cat([indices, indices[:, :nnz // 3]], dim=1)
+            values = torch.randint(-5, 5, (indices.size(1), *dense_size), device=device).to(dtype)
+            t = torch.sparse_coo_tensor(indices, values, sparse_size + dense_size)
+            tc = t.coalesce()
+            self.assertTrue(tc.is_coalesced())
+
+            flat = torch.zeros(len(sparse_size), dtype=torch.long, device=device)
+            mult = 1
+            for d in reversed(range(len(sparse_size))):
+                flat[d] = mult
+                mult *= sparse_size[d]
+            keys = (flat[:, None] * indices).sum(0)
+            unique_keys, inverse = keys.unique(sorted=True, return_inverse=True)
+            expected_values = torch.zeros((unique_keys.numel(), *dense_size), dtype=dtype, device=device)
+            expected_values.index_add_(0, inverse, values)
+            self.assertEqual((flat[:, None] * tc._indices()).sum(0), unique_keys)
+            self.assertEqual(tc._values(), expected_values)
+
     @dtypes(torch.double)
     def test_coalesce_reference_cycle(self, device, dtype):
         # Test coalesce doesn't create autograd graph cycles (gh-52253)
@@ -3153,6 +3179,29 @@ class TestSparse(TestCase):
         test_op(3, 100, [3, 4, 2, 3, 5, 2], coalesced)
         test_op(4, 100, [3, 4, 2, 3, 5, 2], coalesced)
 
+    @dtypes(torch.double)
+    def test_softmax_large(self, device, dtype):
+        # Enough pools that they are processed in parallel, with values of a
+        # wide range so that the running maximum of a pool often changes.
+        import torch.nn.functional as F
+
+        for sparse_size, dense_size in [([300, 700], []), ([40, 50, 60], [3])]:
+            nnz = 5000
+            indices = torch.stack([torch.randint(0, s, (nnz,), device=device) for s in sparse_size])
+            values = torch.randn([nnz] + dense_size, dtype=dtype, device=device) * 30
+            x = torch.sparse_coo_tensor(indices, values, sparse_size + dense_size).coalesce()
+            indices = x._indices()
+            dense = torch.full(x.shape, -float('inf'), dtype=dtype, device=device)
+            dense[tuple(indices)] = x._values()
+            for dim in range(len(sparse_size)):
+                for op, dense_op in [(torch.sparse.softmax, F.softmax), (torch.sparse.log_softmax, F.log_softmax)]:
+                    expected = dense_op(dense, dim)[tuple(indices)]
+                    self.assertEqual(op(x, dim)._values(), expected)
+                    # The result doesn't depend on the order of the nonzeros.
+                    perm = torch.randperm(x._nnz(), device=device)
+                    y = torch.sparse_coo_tensor(indices[:, perm], x._values()[perm], x.shape)
+                    self.assertEqual(op(y, dim).to_dense(), op(x, dim).to_dense())
+
     # TODO: Check after why ROCm's cusparseXcsrgemm2Nnz function doesn't return the same nnz value as CUDA
     @skipIfRocm
     @coalescedonoff
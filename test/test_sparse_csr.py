@@ -6,8 +6,10 @@ import functools
 import random
 import operator
 import numpy as np
+import unittest
 import warnings
 from torch.testing._internal.common_utils import TestCase, run_tests, load_tests
+from torch.testing._internal.common_cuda import TEST_CUDA
 
 # load_tests from torch.testing._internal.common_utils is used to automatically filter tests for
 # sharding on sandcastle. This line silences flake warnings
@@ -190,6 +192,164 @@ class TestSparseCSR(TestCase):
         with self.assertRaisesRegex(RuntimeError, "mv: expected"):
             csr.matmul(bad_vec)
 
+    def test_csr_matmul_dense(self):
+        # Row counts around the vector widths of the kernels, a power-law
+        # like row to unbalance equal row splits, and matrix-vector products.
+        csr = self.gen_sparse_csr((67, 50), 300)
+        heavy = self.gen_sparse_csr((1, 50), 50)
+        dense_csr = torch.cat([csr.to_dense(), heavy.to_dense().expand(3, 50)])
+        csr = dense_csr.to_sparse_csr()
+        for index_dtype in [torch.int32, torch.int64]:
+            for dtype, prec in [(torch.double, 1e-10), (torch.float, 1e-4), (torch.bfloat16, 5e-2)]:
+                sp = torch.sparse_csr_tensor(csr.crow_indices().to(index_dtype),
+                                             csr.col_indices().to(index_dtype),
+                                             csr.values().to(dtype),
+                                             csr.shape)
+                sp_dense = dense_csr.to(dtype)
+                for n in [1, 3, 8, 16, 37, 100]:
+                    mat = torch.randn(50, n).to(dtype)
+                    expected = sp_dense.double().matmul(mat.double())
+                    self.assertEqual(sp.matmul(mat).double(), expected, atol=prec, rtol=prec)
+                    # A non-contiguous dense matrix and addmm with alpha and beta.
+                    mat_t = torch.randn(n, 50).to(dtype).t()
+                    bias = torch.randn(70, n).to(dtype)
+                    res = torch.addmm(bias, sp, mat_t, beta=0.5, alpha=2.0)
+                    expected = 0.5 * bias.double() + 2.0 * sp_dense.double().matmul(mat_t.double())
+                    self.assertEqual(res.double(), expected, atol=prec * 10, rtol=prec)
+                vec = torch.randn(50).to(dtype)
+                self.assertEqual(sp.matmul(vec).double(), sp_dense.double().matmul(vec.double()),
+                                 atol=prec, rtol=prec)
+
+    def test_convert_indices_coo_csr(self):
+        def run(device):
+            for index_dtype in [torch.int32, torch.int64]:
+                # Empty leading, middle and trailing rows.
+                rows = torch.tensor([1, 1, 3, 3, 3, 4], dtype=index_dtype, device=device)
+                for out_int32 in [False, True]:
+                    crow = torch._convert_indices_from_coo_to_csr(rows, 7, out_int32=out_int32)
+                    self.assertEqual(crow.dtype, torch.int32 if out_int32 else torch.int64)
+                    self.assertEqual(crow.cpu().tolist(), [0, 0, 2, 2, 5, 6, 6, 6])
+                    cols = torch.arange(6, dtype=index_dtype, device=device)
+                    indices = torch._convert_indices_from_csr_to_coo(crow, cols, out_int32=out_int32)
+                    self.assertEqual(indices[0].cpu().tolist(), rows.cpu().tolist())
+                    self.assertEqual(indices[1].cpu().tolist(), cols.cpu().tolist())
+                empty = torch._convert_indices_from_coo_to_csr(rows[:0], 3)
+                self.assertEqual(empty.cpu().tolist(), [0, 0, 0, 0])
+
+        run('cpu')
+        if TEST_CUDA:
+            run('cuda')
+
+    def test_csr_to_sparse(self):
+        dense = torch.tensor([[0, 0, 1, 0], [1, 2, 0, 0], [0, 0, 0, 0]], dtype=torch.double)
+        coo = dense.to_sparse_csr().to_sparse()
+        self.assertTrue(coo.is_sparse)
+        self.assertEqual(coo.to_dense(), dense)
+
+    def test_sparse_sampled_addmm(self):
+        def run(device):
+            for dtype, prec in [(torch.double, 1e-10), (torch.float, 1e-4)]:
+                mask = self.gen_sparse_csr((10, 12), 30).to_dense().to(device=device, dtype=dtype)
+                csr = mask.to_sparse_csr()
+                pattern = mask != 0
+                for k in [0, 1, 7]:
+                    mat1 = torch.randn(10, k, dtype=dtype, device=device)
+                    mat2 = torch.randn(k, 12, dtype=dtype, device=device)
+                    res = torch.sparse_sampled_addmm(csr, mat1, mat2, beta=0.5, alpha=2.0)
+                    expected = torch.where(pattern, 0.5 * mask + 2.0 * mat1.matmul(mat2), mask)
+                    self.assertEqual(res.to_dense(), expected, atol=prec, rtol=prec)
+                    self.assertEqual(res.crow_indices(), csr.crow_indices())
+                    self.assertEqual(res.col_indices(), csr.col_indices())
+                    # A non-contiguous mat2.
+                    mat2_t = torch.randn(12, k, dtype=dtype, device=device).t()
+                    res = torch.sparse_sampled_addmm(csr, mat1, mat2_t)
+                    expected = torch.where(pattern, mask + mat1.matmul(mat2_t), mask)
+                    self.assertEqual(res.to_dense(), expected, atol=prec, rtol=prec)
+
+            csr = self.gen_sparse_csr((10, 12), 30)
+            with self.assertRaisesRegex(RuntimeError, "shapes cannot be multiplied"):
+                torch.sparse_sampled_addmm(csr, torch.randn(10, 3), torch.randn(4, 12))
+
+        run('cpu')
+        if TEST_CUDA:
+            run('cuda')
+
+    @unittest.skipIf(not TEST_CUDA, "CUDA not available")
+    def test_csr_matmul_cuda(self):
+        csr = self.gen_sparse_csr((70, 50), 400)
+        for index_dtype in [torch.int32, torch.int64]:
+            for dtype, prec in [(torch.double, 1e-10), (torch.float, 1e-4)]:
+                sp = torch.sparse_csr_tensor(csr.crow_indices().to(index_dtype),
+                                             csr.col_indices().to(index_dtype),
+                                             csr.values().to(dtype),
+                                             csr.shape, device='cuda')
+                self.assertTrue(sp.is_cuda)
+                sp_dense = sp.to_dense()
+                self.assertEqual(sp_dense, csr.to_dense().to(dtype), exact_dtype=False)
+                for n in [1, 8, 33]:
+                    mat = torch.randn(50, n, dtype=dtype, device='cuda')
+                    self.assertEqual(sp.matmul(mat), sp_dense.matmul(mat), atol=prec, rtol=prec)
+                    # Repeated calls hit the descriptor cache.
+                    self.assertEqual(sp.matmul(mat), sp_dense.matmul(mat), atol=prec, rtol=prec)
+                    mat_t = torch.randn(n, 50, dtype=dtype, device='cuda').t()
+                    bias = torch.randn(70, n, dtype=dtype, device='cuda')
+                    res = torch.addmm(bias, sp, mat_t, beta=0.5, alpha=2.0)
+                    self.assertEqual(res, 0.5 * bias + 2.0 * sp_dense.matmul(mat_t), atol=prec, rtol=prec)
+                vec = torch.randn(50, dtype=dtype, device='cuda')
+                self.assertEqual(sp.matmul(vec), sp_dense.matmul(vec), atol=prec, rtol=prec)
+
+        # Conversions stay on the device.
+        dense = csr.to_dense().cuda()
+        self.assertTrue(dense.to_sparse_csr().is_cuda)
+        self.assertEqual(dense.to_sparse_csr().to_dense(), dense)
+        self.assertEqual(dense.to_sparse().to_sparse_csr().to_sparse().to_dense(), dense)
+
+    def test_bsr(self):
+        def run(device):
+            for blocksize in [(2, 2), (4, 3), (16, 16)]:
+                shape = (blocksize[0] * 6, blocksize[1] * 5)
+                # Keep some of the blocks, but none in the third row of blocks.
+                keep = torch.rand(6, 5, device=device) < 0.3
+                keep[0, 0] = True
+                keep[2] = False
+                mask = keep.repeat_interleave(blocksize[0], 0).repeat_interleave(blocksize[1], 1)
+                dense = torch.randn(shape, device=device) * mask
+                bsr = dense.to_sparse_bsr(blocksize)
+                self.assertTrue(bsr.is_sparse_csr)
+                self.assertEqual(bsr._nnz(), int(keep.sum()))
+                self.assertEqual(bsr.values().shape[1:], blocksize)
+                self.assertEqual(bsr.to_dense(), dense)
+                self.assertEqual(bsr.to_sparse().to_dense(), dense)
+                for index_dtype in [torch.int32, torch.int64]:
+                    for dtype, prec in [(torch.double, 1e-10), (torch.float, 1e-4)]:
+                        sp = torch.sparse_bsr_tensor(bsr.crow_indices().to(index_dtype),
+                                                     bsr.col_indices().to(index_dtype),
+                                                     bsr.values().to(dtype), shape)
+                        sp_dense = dense.to(dtype)
+                        for n in [1, 7, 32]:
+                            mat = torch.randn(shape[1], n, dtype=dtype, device=device)
+                            self.assertEqual(torch.mm(sp, mat), sp_dense.matmul(mat), atol=prec, rtol=prec)
+                            # A non-contiguous dense matrix and addmm with alpha and beta.
+                            mat_t = torch.randn(n, shape[1], dtype=dtype, device=device).t()
+                            bias = torch.randn(shape[0], n, dtype=dtype, device=device)
+                            res = torch.addmm(bias, sp, mat_t, beta=0.5, alpha=2.0)
+                            self.assertEqual(res, 0.5 * bias + 2.0 * sp_dense.matmul(mat_t), atol=prec, rtol=prec)
+                        # A linear layer with a block sparse weight.
+                        input = torch.randn(3, 4, shape[1], dtype=dtype, device=device)
+                        bias = torch.randn(shape[0], dtype=dtype, device=device)
+                        self.assertEqual(torch.nn.functional.linear(input, sp, bias),
+                                         torch.nn.functional.linear(input, sp_dense, bias), atol=prec, rtol=prec)
+                        self.assertEqual(torch.nn.functional.linear(input, sp),
+                                         torch.nn.functional.linear(input, sp_dense), atol=prec, rtol=prec)
+
+            with self.assertRaisesRegex(RuntimeError, "must be a multiple of blocksize"):
+                torch.sparse_bsr_tensor(torch.tensor([0, 0]), torch.tensor([], dtype=torch.int64),
+                                        torch.randn(0, 2, 2), (3, 2), device=device)
+
+        run('cpu')
+        if TEST_CUDA:
+            run('cuda')
+
     def test_coo_csr_conversion(self):
         size = (5, 5)
         dense = torch.randn(size)
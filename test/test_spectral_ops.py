@@ -4,6 +4,7 @@ import math
 from contextlib import contextmanager
 from itertools import product
 import itertools
+import threading
 
 from torch.testing._internal.common_utils import \
     (TestCase, run_tests, TEST_NUMPY, TEST_LIBROSA, TEST_MKL)
@@ -674,6 +675,59 @@ class TestFFT(TestCase):
                             self.assertEqual(torch.backends.cuda.cufft_plan_cache.max_size, 10)  # default is cuda:0
                         self.assertEqual(torch.backends.cuda.cufft_plan_cache.max_size, 11)  # default is cuda:1
 
+    @skipCUDAIfRocm
+    @onlyCUDA
+    @dtypes(torch.float, torch.double)
+    def test_cufft_plan_cache_batch_bucketing(self, device, dtype):
+        plan_cache = torch.backends.cuda.cufft_plan_cache[device]
+        self.assertFalse(plan_cache.batch_bucketing)
+        complex_dtype = torch.cfloat if dtype == torch.float else torch.cdouble
+
+        # Strided input and output, and batches that are split, e.g. into 64 + 32 + 4
+        inputs = []
+        for batch in (1, 100, 64, 37):
+            x = torch.randn(batch, 3, 48, device=device, dtype=dtype)[:, 1]
+            c = torch.randn(batch, 2, 30, device=device, dtype=complex_dtype)
+            inputs.append((x, c))
+
+        def transforms(x, c):
+            return (torch.fft.rfft(x), torch.fft.fftn(c, dim=(1, 2)), torch.fft.irfft(c))
+
+        expected = [transforms(x, c) for x, c in inputs]
+        plan_cache.batch_bucketing = True
+        try:
+            plan_cache.clear()
+            for (x, c), e in zip(inputs, expected):
+                self.assertEqual(transforms(x, c), e)
+
+            # Batches of 100 and 37 share the plans of 64, 32, 4 and 1
+            plan_cache.clear()
+            for batch in (100, 37):
+                torch.fft.rfft(torch.randn(batch, 48, device=device, dtype=dtype))
+            self.assertEqual(plan_cache.size, 4)
+        finally:
+            plan_cache.batch_bucketing = False
+
+        # Concurrent transforms of the same geometry each get a plan
+        x = torch.randn(16, 256, device=device, dtype=dtype)
+        expected = torch.fft.rfft(x)
+        torch.cuda.synchronize(device)
+        results = [None] * 4
+
+        def run(i):
+            with torch.cuda.stream(torch.cuda.Stream(device)):
+                results[i] = [torch.fft.rfft(x) for _ in range(20)]
+                torch.cuda.current_stream().synchronize()
+
+        threads = [threading.Thread(target=run, args=(i,)) for i in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        for result in results:
+            for r in result:
+                self.assertEqual(r, expected)
+
     # passes on ROCm w/ python 2.7, fails w/ python 3.6
     @skipCPUIfNoMkl
     @onlyOnCPUAndCUDA
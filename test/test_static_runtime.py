@@ -29,6 +29,9 @@ class StaticModule:
             args, kwargs, warmup_runs, main_runs
         )
 
+    def profile(self, args, kwargs, warmup_runs, main_runs):
+        return self.static_module.profile(args, kwargs, warmup_runs, main_runs)
+
 
 def linear_shim(input: torch.Tensor, weight: torch.Tensor, bias: Optional[torch.Tensor] = None) -> torch.Tensor:
     output = input.matmul(weight.t())
@@ -174,6 +177,26 @@ class TestStaticModule(TestCase):
             [src, src, src, src_mask], {}, 2, 2
         )
 
+    def test_profile(self):
+        s = torch.full((2, 2), 2)
+        tg = torch.jit.script(trivial_graph)
+        tg_a = StaticModule(tg)
+        profile = tg_a.profile([s, s, s], {}, 2, 10)
+
+        self.assertGreater(len(profile.nodes), 0)
+        total_time = 0.0
+        for node in profile.nodes:
+            self.assertIn(node.run_mode, ("out_variant", "native", "fallback"))
+            self.assertLessEqual(node.p50_time, node.p90_time)
+            self.assertLessEqual(node.p90_time, node.p99_time)
+            self.assertLessEqual(node.p99_time, node.max_time)
+            self.assertIn(node.kind, profile.node_kinds)
+            total_time += node.mean_time
+        self.assertAlmostEqual(total_time, profile.total_time, places=3)
+        self.assertEqual(
+            sum(k.instances for k in profile.node_kinds.values()), len(profile.nodes)
+        )
+
     def test_mlp(self):
         # Arguments taken from benchmark script, ./bench/dlrm_s_benchmark.sh
         ln_bot = [512, 512, 64]
@@ -11,7 +11,7 @@ import random
 from torch.testing._internal.common_utils import (
     TestCase, run_tests, do_test_empty_full, TEST_WITH_ROCM, suppress_warnings,
     torch_to_numpy_dtype_dict, slowTest, TEST_SCIPY, IS_MACOS, IS_PPC,
-    IS_WINDOWS)
+    IS_WINDOWS, make_tensor)
 from torch.testing._internal.common_device_type import (
     instantiate_device_type_tests, deviceCountAtLeast, onlyOnCPUAndCUDA,
     onlyCPU, largeTensorTest, precisionOverride, dtypes,
@@ -677,6 +677,28 @@ class TestTensorCreation(TestCase):
             self.assertTrue(res2.is_contiguous(memory_format=torch.channels_last))
             self.assertEqual(res1, res2)
 
+    @onlyCPU
+    @dtypes(torch.float, torch.double, torch.int8, torch.int16, torch.bool, torch.cdouble)
+    def test_cat_mixed_layouts(self, device, dtype):
+        # Inputs above the grain size with different strides and memory formats
+        shape = (4, 15, 64, 64)
+        x = make_tensor(shape, device, dtype)
+        y = make_tensor(shape, device, dtype)
+        z = make_tensor((4, 15, 64, 128), device, dtype)
+        for dim in range(4):
+            w = z if dim == 3 else z[..., ::2]
+            inputs = (x, y, w, x)
+            expected = torch.cat([t.contiguous() for t in inputs], dim=dim)
+            mixed = (x.contiguous(memory_format=torch.channels_last),
+                     y.transpose(2, 3).contiguous().transpose(2, 3),
+                     w,
+                     x.contiguous(memory_format=torch.channels_last))
+            self.assertEqual(torch.cat(mixed, dim=dim), expected)
+
+            out = torch.empty_like(expected).contiguous(memory_format=torch.channels_last)
+            torch.cat(mixed, dim=dim, out=out)
+            self.assertEqual(out, expected)
+
     @onlyCUDA
     def test_cat_preserve_channels_last(self, device):
         x = torch.randn((4, 3, 8, 8), device=device)
@@ -2002,6 +2024,35 @@ class TestTensorCreation(TestCase):
         test_inference(torch.float64)
         test_inference(torch.float32)
 
+    @onlyCPU
+    def test_tensor_factory_fast_paths(self, device):
+        import array
+
+        # nested lists of Python numbers
+        data = [[float(i * 4 + j) for j in range(4)] for i in range(3)]
+        expected = torch.arange(12.).view(3, 4)
+        self.assertEqual(torch.tensor(data), expected)
+        self.assertEqual(torch.tensor(tuple(tuple(r) for r in data), dtype=torch.float64), expected.double())
+        self.assertIs(torch.tensor([[1, 2], [3, 4.5]]).dtype, torch.get_default_dtype())
+        self.assertIs(torch.tensor([[1, 2], [3, 4]]).dtype, torch.int64)
+        self.assertEqual(torch.tensor([[1, 2], [3, 4]], dtype=torch.int32), torch.tensor([[1, 2], [3, 4]]).int())
+        self.assertEqual(torch.tensor([2 ** 40, -3], dtype=torch.double), torch.tensor([2. ** 40, -3.]))
+        # falls back to the generic path, which reports these
+        self.assertRaisesRegex(ValueError, "expected sequence of length",
+                               lambda: torch.tensor([[1., 2.], [3.]]))
+        self.assertRaises(RuntimeError, lambda: torch.tensor([2 ** 70, 1]))
+        self.assertIs(torch.tensor([True, 1]).dtype, torch.int64)
+
+        # buffers are copied directly but infer the same dtypes as their elements
+        self.assertEqual(torch.tensor(array.array('d', [1., 2.5])), torch.tensor([1., 2.5]))
+        self.assertEqual(torch.tensor(array.array('f', [1., 2.5]), dtype=torch.float64),
+                         torch.tensor([1., 2.5], dtype=torch.float64))
+        self.assertEqual(torch.tensor(array.array('i', [1, -2])), torch.tensor([1, -2]))
+        self.assertEqual(torch.tensor(array.array('b', [1, -2]), dtype=torch.float32),
+                         torch.tensor([1., -2.]))
+        self.assertEqual(torch.tensor(b'\x01\x02'), torch.tensor([1, 2]))
+        self.assertEqual(torch.tensor(memoryview(bytearray(b'\x03'))), torch.tensor([3]))
+
     # TODO: this test should be updated
     @suppress_warnings
     @onlyCPU
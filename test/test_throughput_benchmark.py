@@ -1,6 +1,10 @@
 
+import io
+
 import torch
+from torch.jit.mobile import _load_for_lite_interpreter
 from torch.utils import ThroughputBenchmark
+from torch.utils.throughput_benchmark import MultiModelThroughputBenchmark
 from torch.testing import assert_allclose
 
 from torch.testing._internal.common_utils import run_tests, TestCase, TemporaryFileName
@@ -78,6 +82,72 @@ class TestThroughputBenchmark(TestCase):
         with TemporaryFileName() as fname:
             self.linear_test(TwoLayerNetModule, profiler_output_path=fname)
 
+    def test_static_runtime_batching(self):
+        module = TwoLayerNet(10, 5, 15)
+        bench = ThroughputBenchmark(module)
+        for batch_size in (1, 3):
+            bench.add_input(torch.randn(batch_size, 10), torch.randn(batch_size, 10))
+
+        stats = bench.benchmark(
+            num_calling_threads=4,
+            num_warmup_iters=10,
+            num_iters=200,
+            static_runtime_max_batch_size=8,
+            static_runtime_max_batch_delay_us=500,
+        )
+        self.assertEqual(stats.num_iters, 200)
+
+    def test_static_runtime(self):
+        module = TwoLayerNet(10, 5, 15)
+        bench = ThroughputBenchmark(module, use_static_runtime=True)
+        x1, x2 = torch.randn(8, 10), torch.randn(8, 10)
+        bench.add_input(x1, x2)
+        assert_allclose(bench.run_once(x1, x2), module(x1, x2))
+
+        stats = bench.benchmark(num_calling_threads=2, num_iters=100)
+        self.assertEqual(stats.num_iters, 100)
+
+    def test_lite_interpreter(self):
+        module = torch.jit.script(TwoLayerNetModule(10, 5, 15))
+        buffer = io.BytesIO(module._save_to_buffer_for_lite_interpreter())
+        bench = ThroughputBenchmark(_load_for_lite_interpreter(buffer))
+        x1, x2 = torch.randn(8, 10), torch.randn(8, 10)
+        bench.add_input(x1, x2)
+        assert_allclose(bench.run_once(x1, x2), module(x1, x2))
+
+        stats = bench.benchmark(num_calling_threads=2, num_iters=100)
+        self.assertEqual(stats.num_iters, 100)
+
+    def test_arrival_qps(self):
+        bench = ThroughputBenchmark(TwoLayerNet(10, 5, 15))
+        bench.add_input(torch.randn(8, 10), torch.randn(8, 10))
+
+        stats = bench.benchmark(num_calling_threads=2, num_iters=100, arrival_qps=1000)
+        self.assertEqual(stats.num_iters, 100)
+        # 100 arrivals at 1000 per second take about 100ms
+        self.assertGreater(stats.total_time_seconds, 0.05)
+        self.assertLessEqual(stats.latency_p50_ms, stats.latency_p99_ms)
+        self.assertLessEqual(stats.latency_p99_ms, stats.latency_max_ms)
+        self.assertEqual(sum(count for _, count in stats.latency_histogram), 100)
+        self.assertGreaterEqual(stats.latency_histogram[-1][0], stats.latency_max_ms)
+
+    def test_multi_model(self):
+        benches = []
+        for use_static_runtime in (False, True):
+            bench = ThroughputBenchmark(TwoLayerNet(10, 5, 15), use_static_runtime)
+            bench.add_input(torch.randn(8, 10), torch.randn(8, 10))
+            benches.append(bench)
+        mix = MultiModelThroughputBenchmark()
+        mix.add_model(benches[0], weight=3)
+        mix.add_model(benches[1], weight=1)
+
+        stats = mix.benchmark(num_calling_threads=4, num_iters=400)
+        self.assertEqual(stats.total.num_iters, 400)
+        self.assertEqual(len(stats.models), 2)
+        self.assertEqual(sum(s.num_iters for s in stats.models), 400)
+        self.assertGreater(stats.models[0].num_iters, stats.models[1].num_iters)
+        print(stats)
+
 
 if __name__ == '__main__':
     run_tests()
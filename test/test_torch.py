@@ -306,6 +306,25 @@ class AbstractTestCases:
             self.assertEqual(y[:, 0], range(100))
             self.assertEqual(y[:, 40], range(4000, 4100))
 
+        def test_copy_permute(self):
+            # Covers the tiled permute copy, including odd sizes that leave partial tiles
+            cases = [((3, 67, 45), (0, 2, 1)),
+                     ((2, 17, 70, 33), (0, 2, 3, 1)),
+                     ((2, 40, 3, 64), (0, 2, 1, 3)),
+                     ((5, 1, 33, 70), (3, 1, 0, 2)),
+                     ((130, 131), (1, 0))]
+            for dtype in [torch.uint8, torch.half, torch.bfloat16, torch.float, torch.double, torch.cdouble]:
+                for shape, perm in cases:
+                    x = torch.arange(torch.Size(shape).numel()).reshape(shape).to(dtype).permute(perm)
+                    y = torch.empty(x.shape, dtype=dtype)
+                    y.copy_(x)
+                    self.assertTrue(torch.equal(y, x))
+                    # Non-unit innermost source stride
+                    x = x[..., ::2]
+                    y = torch.empty(x.shape, dtype=dtype)
+                    y.copy_(x)
+                    self.assertTrue(torch.equal(y, x))
+
         def test_device(self):
             cpu = torch.device('cpu')
             self.assertEqual('cpu', str(cpu))
@@ -1680,6 +1699,42 @@ class AbstractTestCases:
                                    "missing 1 required positional arguments",
                                    lambda: torch.tensor().new_zeros((5, 5), 0))
 
+        def test_parsing_overload_cache(self):
+            # the same overloaded call with differently typed arguments must
+            # keep picking the right signature on repeated calls
+            x = torch.arange(4.)
+            for _ in range(3):
+                self.assertEqual(x.add(1), x + 1)
+                self.assertEqual(x.add(torch.tensor(2.)), x + 2)
+                self.assertEqual(x.add(x), x * 2)
+                self.assertEqual(x.to(torch.int64).dtype, torch.int64)
+                self.assertEqual(x.to(x.to(torch.int32)).dtype, torch.int32)
+                self.assertEqual(x.to('cpu', torch.float64).dtype, torch.float64)
+                self.assertEqual(torch.ones(torch.tensor(3), torch.tensor(4)).shape, torch.Size([3, 4]))
+                self.assertRaises(TypeError, lambda: torch.ones(torch.tensor([3, 4]), torch.tensor(4)))
+                # requires_grad changes which overloads accept a 0-dim tensor
+                self.assertRaises(TypeError,
+                                  lambda: torch.isclose(x, x, torch.tensor(1.5), torch.tensor(1., requires_grad=True)))
+                self.assertTrue(torch.isclose(x, x, torch.tensor(1.5), torch.tensor(1.)).all())
+
+        def test_vital_counters(self):
+            was_enabled = torch._C._vital_counters_enabled()
+            try:
+                torch._C._set_vital_counters_enabled(True)
+                torch._C._reset_vital_counters()
+                torch.empty(16, dtype=torch.float32)
+                torch._C._vital_record("test.histogram", 5)
+                torch._C._set_vital_counters_enabled(False)
+                torch._C._vital_record("test.histogram", 5)
+
+                self.assertGreaterEqual(torch._C._vital_counters()["allocator.cpu.allocations"], 1)
+                histogram = torch._C._vital_histograms()["test.histogram"]
+                self.assertEqual(histogram["count"], 1)
+                self.assertEqual(histogram["sum"], 5)
+                self.assertEqual(histogram["buckets"][3], 1)
+            finally:
+                torch._C._set_vital_counters_enabled(was_enabled)
+
         def test_half_tensor(self):
             devices = ["cpu"]
             if torch.cuda.is_available():
@@ -4897,6 +4952,22 @@ class TestTorchDeviceType(TestCase):
                          torch.tensor([[3], [1]], device=device,
                                       dtype=torch.float32).repeat(1, width))
 
+    # Contiguous last-dim gather and scatter_add take a fast path on CUDA
+    @onlyCUDA
+    @dtypes(torch.half, torch.float, torch.double)
+    def test_gather_scatter_add_last_dim(self, device, dtype):
+        for rows, size, k in ((3, 50, 8), (5, 17, 7), (1, 1000, 4096)):
+            input = torch.randn(rows, size, device=device, dtype=dtype)
+            index = torch.randint(size, (rows, k), device=device)
+            self.assertEqual(input.gather(1, index), input.cpu().gather(1, index.cpu()))
+
+            # Sorted indices, with long runs of duplicates
+            index = index.sort(dim=1)[0] // 7
+            src = torch.randn(rows, k, device=device, dtype=dtype)
+            expected = input.cpu().float().scatter_add(1, index.cpu(), src.cpu().float())
+            self.assertEqual(input.scatter_add(1, index, src).float().cpu(), expected,
+                             atol=1e-2 if dtype == torch.half else None, rtol=1e-2 if dtype == torch.half else None)
+
     @dtypes(*(torch.testing.get_all_fp_dtypes(include_bfloat16=False, include_half=False) +
               torch.testing.get_all_complex_dtypes()))
     @dtypesIfCPU(*(torch.testing.get_all_fp_dtypes(include_bfloat16=False, include_half=True) +
@@ -5028,6 +5099,20 @@ class TestTorchDeviceType(TestCase):
         dst = dst.masked_scatter(mask, src)
         self.assertEqual(dst, torch.tensor([True, True, True], device=device))
 
+    @onlyCPU
+    @dtypes(torch.float, torch.long)
+    def test_masked_select_large(self, device, dtype):
+        src = torch.arange(200003, device=device).to(dtype)
+        for mask_dtype in [torch.bool, torch.uint8]:
+            mask = (torch.rand(200003, device=device) < 0.4).to(mask_dtype)
+            with warnings.catch_warnings(record=True):
+                dst = src.masked_select(mask)
+            self.assertEqual(dst, torch.from_numpy(src.numpy()[mask.numpy().astype(bool)]), atol=0, rtol=0)
+        # Broadcast mask
+        src = src[:200000].view(400, 500)
+        mask = torch.rand(500, device=device) < 0.5
+        self.assertEqual(src.masked_select(mask), src[:, mask].reshape(-1), atol=0, rtol=0)
+
     @dtypes(*torch.testing.get_all_dtypes())
     def test_masked_select(self, device, dtype):
         if device == 'cpu':
@@ -6137,6 +6222,55 @@ class TestTorchDeviceType(TestCase):
         z = from_dlpack(to_dlpack(x))
         self.assertEqual(z, x)
 
+    @skipMeta
+    @dtypes(*torch.testing.get_all_dtypes())
+    def test_dlpack_conversion_with_dtypes(self, device, dtype):
+        x = make_tensor((5,), device, dtype, low=-9, high=9)
+        z = from_dlpack(to_dlpack(x))
+        self.assertEqual(z.dtype, dtype)
+        self.assertEqual(z, x)
+
+    @skipMeta
+    def test_dlpack_conversion_with_strides(self, device):
+        x = torch.randn(4, 6, 8, device=device)
+        for view in (x.t(), x[1:, ::2, 3:], x.permute(2, 0, 1)[::3], x.expand(2, 4, 6, 8)):
+            z = from_dlpack(to_dlpack(view))
+            self.assertEqual(z, view)
+            # no copy is made, also for views with a storage offset
+            self.assertEqual(z.data_ptr(), view.data_ptr())
+            self.assertEqual(z.stride(), view.stride())
+
+    @skipMeta
+    def test_dlpack_protocol(self, device):
+        x = torch.randn(3, 5, device=device)[:, 1:]
+        self.assertEqual(x.__dlpack_device__()[1], x.device.index or 0)
+        z = from_dlpack(x)
+        self.assertEqual(z, x)
+        self.assertEqual(z.data_ptr(), x.data_ptr())
+        z.fill_(1)
+        self.assertEqual(x, torch.ones_like(x))
+
+    @onlyCPU
+    def test_dlpack_quantized(self, device):
+        x = torch.quantize_per_tensor(torch.randn(3), 0.1, 0, torch.qint8)
+        with self.assertRaisesRegex(RuntimeError, "int_repr"):
+            to_dlpack(x)
+
+    @onlyCUDA
+    def test_dlpack_protocol_stream(self, device):
+        # the consumer stream waits for the work queued on the producer stream
+        producer = torch.cuda.Stream()
+        consumer = torch.cuda.Stream()
+        with torch.cuda.stream(producer):
+            x = torch.zeros(1024, 1024, device=device)
+            torch.cuda._sleep(100000000)
+            x.fill_(1)
+            capsule = x.__dlpack__(consumer.cuda_stream)
+        with torch.cuda.stream(consumer):
+            s = from_dlpack(capsule).sum()
+        consumer.synchronize()
+        self.assertEqual(s.item(), 1024 * 1024)
+
     @onlyCUDA
     @unittest.skipIf(PYTORCH_CUDA_MEMCHECK, "is_pinned uses failure to detect pointer property")
     def test_pin_memory_from_constructor(self, device):
@@ -6284,6 +6418,37 @@ class TestTorchDeviceType(TestCase):
         # expect no more than 1 repeating elements generated in 2 attempts
         self.assertLessEqual(2 * n_sample - samples.unique().size(0), 1)
 
+    @dtypes(torch.float, torch.double)
+    def test_multinomial_alias(self, device, dtype):
+        probs = torch.rand(3, 50, dtype=dtype, device=device)
+        probs[:, 7] = 0
+        probs[1] = 0
+        probs[1, 3] = 2
+        J, q = torch._multinomial_alias_setup(probs)
+        self.assertEqual(J.shape, probs.shape)
+        self.assertEqual(q.dtype, dtype)
+        n_sample = 100000
+        gen = torch.Generator(device=device)
+        gen.manual_seed(123)
+        samples = torch._multinomial_alias_draw(J, q, n_sample, generator=gen)
+        self.assertEqual(samples.shape, (3, n_sample))
+        self.assertFalse((samples == 7).any())
+        self.assertTrue((samples[1] == 3).all())
+        expected = probs / probs.sum(1, keepdim=True)
+        for row in range(3):
+            freqs = torch.bincount(samples[row].cpu(), minlength=50).to(dtype) / n_sample
+            self.assertEqual(freqs, expected[row].cpu(), atol=0.01, rtol=0)
+        # Draws are reproducible
+        gen.manual_seed(123)
+        self.assertEqual(torch._multinomial_alias_draw(J, q, n_sample, generator=gen), samples)
+        # 1-d distributions, and multinomial with replacement, which uses the
+        # alias method on CPU for enough samples
+        J, q = torch._multinomial_alias_setup(expected[0])
+        self.assertEqual(torch._multinomial_alias_draw(J, q, 10).shape, (10,))
+        samples = torch.multinomial(expected[0], n_sample, replacement=True)
+        freqs = torch.bincount(samples.cpu(), minlength=50).to(dtype) / n_sample
+        self.assertEqual(freqs, expected[0].cpu(), atol=0.01, rtol=0)
+
     def _test_memory_format_transformations(self, device, input_generator_fn, transformation_fn,
                                             memory_format, compare_data=True, default_is_preserve=False):
 
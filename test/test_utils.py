@@ -348,6 +348,56 @@ class TestCheckpoint(TestCase):
             out = checkpoint(run_fn2, input_var, input_var2)
             out.sum().backward()
 
+    def test_checkpoint_without_reentrant(self):
+        class Net(nn.Module):
+            def __init__(self):
+                super(Net, self).__init__()
+                self.counter = 0
+                self.linear = nn.Linear(10, 10)
+
+            def forward(self, input_var):
+                self.counter += 1
+                return self.linear(input_var).tanh().exp()
+
+        net = Net()
+        input_var = torch.randn(4, 10, requires_grad=True)
+        expected = torch.autograd.grad(net(input_var).sum(), [input_var] + list(net.parameters()))
+
+        net.counter = 0
+        out = checkpoint(net, input_var, use_reentrant=False)
+        self.assertEqual(net.counter, 1)
+        # torch.autograd.grad is supported
+        grads = torch.autograd.grad(out.sum(), [input_var] + list(net.parameters()))
+        self.assertEqual(net.counter, 2)
+        self.assertEqual(grads, expected)
+
+    def test_checkpoint_sequential_memory_budget(self):
+        class Net(nn.Module):
+            def __init__(self):
+                super(Net, self).__init__()
+                self.counter = 0
+                self.linear = nn.Linear(16, 16)
+
+            def forward(self, input_var):
+                self.counter += 1
+                return self.linear(input_var).relu()
+
+        modules = [Net() for _ in range(4)]
+        model = nn.Sequential(*modules)
+        input_var = torch.randn(8, 16, requires_grad=True)
+        model(input_var).sum().backward()
+        expected = [m.linear.weight.grad.clone() for m in modules]
+
+        # the last segment is never checkpointed
+        for budget, recomputed in [(0, 3), (1 << 20, 0)]:
+            model.zero_grad()
+            for m in modules:
+                m.counter = 0
+            out = checkpoint_sequential(model, 4, input_var, memory_budget=budget)
+            out.sum().backward()
+            self.assertEqual(sum(m.counter for m in modules), 4 + recomputed)
+            self.assertEqual([m.linear.weight.grad for m in modules], expected)
+
 class TestDataLoaderUtils(TestCase):
     def setUp(self):
         self.dataset = torch.randn(5, 3, 3, 2)
@@ -564,6 +564,21 @@ class TestVmapAPI(TestCase):
         result = vmap(vmap(vmap(op)))(x, y)
         self.assertEqual(result, op(x, y.view(100, 10, 10, 1)))
 
+    def test_fallback_counts(self):
+        torch._C._debug_only_reset_vmap_fallback_counts()
+        x = torch.randn(5, 3)
+        y = torch.randn(5, 3)
+        vmap(torch.atan2)(x, y)
+        vmap(torch.atan2)(x, y)
+        self.assertEqual(torch._C._debug_only_vmap_fallback_counts(), {'aten::atan2': 2})
+
+        # operators with a batching rule are not counted
+        vmap(lambda x: x.sum(0))(x)
+        self.assertEqual(torch._C._debug_only_vmap_fallback_counts(), {'aten::atan2': 2})
+
+        torch._C._debug_only_reset_vmap_fallback_counts()
+        self.assertEqual(torch._C._debug_only_vmap_fallback_counts(), {})
+
     def test_fallback_masked_fill(self):
         # NB: One day we will implement a batching rule for masked_fill
         # If/when we do, this test should be replaced to test the fallback
@@ -1880,6 +1895,112 @@ class TestVmapOperators(Namespace.TestVmapBase):
         test(vmap(lambda x: x.sum(2), in_dims=2), [torch.randn([2, 5, B0, B1, 3])],
              in_dims=2, out_dims=2)
 
+    def test_reductions_dim(self):
+        test = self._vmap_test
+        B0, B1 = 5, 7
+
+        for op in [lambda x: x.mean(0), lambda x: x.mean([0, -1], keepdim=True),
+                   lambda x: x.amax(-1), lambda x: x.amin([]), lambda x: x.var(1),
+                   lambda x: x.std([0, 1], unbiased=False), lambda x: x.norm(p=2, dim=1),
+                   lambda x: x.prod(1, keepdim=True), lambda x: x.max(1), lambda x: x.min(0)]:
+            test(op, [torch.randn(B0, 2, 3)])
+            test(op, [torch.randn(2, B0, 3)], in_dims=1, out_dims=1)
+            test(vmap(op), [torch.randn(B0, B1, 2, 3)])
+
+        # Per-example scalars
+        test(lambda x: x.mean(0), [torch.randn(B0)])
+        test(lambda x: x.amax([], keepdim=True), [torch.randn(B0)])
+        test(lambda x: x.max(-1), [torch.randn(B0)])
+
+    def test_softmax_and_cumsum(self):
+        test = self._vmap_test
+        B0, B1 = 5, 7
+
+        for op in [lambda x: x.softmax(0), lambda x: x.log_softmax(-1), lambda x: x.cumsum(1)]:
+            test(op, [torch.randn(B0, 2, 3)])
+            test(op, [torch.randn(2, 3, B0)], in_dims=2)
+            test(vmap(op), [torch.randn(B0, B1, 2, 3)])
+        test(lambda x: x.softmax(0), [torch.randn(B0)])
+
+    def test_index_select_and_gather(self):
+        test = self._vmap_test
+        B0, B1 = 5, 7
+        x = torch.randn(B0, 4, 3)
+        index = torch.randint(0, 4, (B0, 6))
+
+        test(lambda x, i: x.index_select(0, i), [x, index[0]], in_dims=(0, None))
+        test(lambda x, i: x.index_select(0, i), [x, index])
+        test(lambda x, i: x.index_select(-1, i), [x[0], index % 3], in_dims=(None, 0))
+        test(lambda x, i: x.index_select(0, i), [x, index[:, 0]])
+        test(vmap(lambda x, i: x.index_select(1, i)),
+             [torch.randn(B0, B1, 2, 4), torch.randint(0, 4, (B0, B1, 3))])
+
+        test(lambda x, i: x.gather(1, i), [x, torch.randint(0, 3, (B0, 4, 2))])
+        test(lambda x, i: x.gather(0, i), [x[0], torch.randint(0, 4, (B0, 2, 3))], in_dims=(None, 0))
+
+    def test_embedding(self):
+        test = self._vmap_test
+        B0, B1 = 5, 7
+        weight = torch.randn(10, 3)
+        indices = torch.randint(0, 10, (B0, 2, 4))
+
+        test(F.embedding, [indices, weight], in_dims=(0, None), check_propagates_grad=False)
+        test(lambda w, i: F.embedding(i, w), [weight, indices], in_dims=(None, 0))
+        test(lambda w, i: F.embedding(i, w), [torch.randn(B0, 10, 3), indices])
+        test(lambda w, i: F.embedding(i, w, padding_idx=0), [torch.randn(B0, 10, 3), indices[0]],
+             in_dims=(0, None))
+        test(vmap(lambda w, i: F.embedding(i, w)),
+             [torch.randn(B0, B1, 10, 3), torch.randint(0, 10, (B0, B1, 4))])
+
+    def test_conv2d(self):
+        test = self._vmap_test
+        B0, B1 = 3, 2
+        x = torch.randn(B0, 2, 4, 5, 5)
+        weight = torch.randn(B0, 6, 4, 3, 3)
+        bias = torch.randn(B0, 6)
+
+        for groups in [1, 2]:
+            conv = functools.partial(F.conv2d, padding=1, groups=groups)
+            w, b = weight[:, :, :4 // groups], bias
+            test(conv, [x, w[0], b[0]], in_dims=(0, None, None))
+            test(conv, [x[0], w, b[0]], in_dims=(None, 0, None))
+            test(conv, [x, w, b])
+            test(conv, [x[0], w[0], b], in_dims=(None, None, 0))
+        test(vmap(F.conv2d), [torch.randn(B0, B1, 2, 4, 5, 5), torch.randn(B0, B1, 6, 4, 3, 3)])
+
+        # transposed
+        test(lambda x, w: F.conv_transpose2d(x, w, stride=2), [x, torch.randn(B0, 4, 3, 3, 3)])
+
+    def test_layer_norm(self):
+        test = self._vmap_test
+        B0, B1 = 5, 7
+        x = torch.randn(B0, 2, 3, 4)
+        weight = torch.randn(B0, 3, 4)
+        bias = torch.randn(B0, 3, 4)
+
+        test(lambda x: F.layer_norm(x, (3, 4)), [x])
+        test(lambda x, w, b: F.layer_norm(x, (4,), w, b), [x, weight[0, 0], bias[0, 0]],
+             in_dims=(0, None, None))
+        test(lambda x, w, b: F.layer_norm(x, (3, 4), w, b), [x, weight, bias])
+        test(lambda x, w, b: F.layer_norm(x, (3, 4), w, b), [x[0], weight, bias[0]],
+             in_dims=(None, 0, None))
+        test(vmap(lambda x: F.layer_norm(x, (4,))), [torch.randn(B0, B1, 3, 4)])
+
+    def test_group_norm(self):
+        test = self._vmap_test
+        B0, B1 = 5, 7
+        x = torch.randn(B0, 2, 4, 3)
+        weight = torch.randn(B0, 4)
+        bias = torch.randn(B0, 4)
+
+        test(lambda x: F.group_norm(x, 2), [x])
+        test(lambda x, w, b: F.group_norm(x, 2, w, b), [x, weight[0], bias[0]],
+             in_dims=(0, None, None))
+        test(lambda x, w, b: F.group_norm(x, 2, w, b), [x, weight, bias])
+        test(lambda x, w, b: F.group_norm(x, 4, w, b), [x[0], weight, bias],
+             in_dims=(None, 0, 0))
+        test(vmap(lambda x: F.group_norm(x, 1)), [torch.randn(B0, B1, 2, 4, 3)])
+
     def test_reshape(self):
         test = self._vmap_test
         B0, B1, B2 = 7, 11, 13
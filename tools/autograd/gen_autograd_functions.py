@@ -25,6 +25,10 @@ struct TORCH_API ${op} : public ${superclass} {
     ${thread_lock}
     ${release_variables}
   }
+  void prefetch_variables() override {
+    ${thread_lock}
+    ${prefetch_variables}
+  }
   ${will_release_variables}
   ${saved_variables}
   ${saved_list_sizes}
@@ -276,6 +280,7 @@ def gen_autograd_functions(
 def process_function(info: DifferentiabilityInfo, template: CodeTemplate) -> str:
     saved_variables: List[str] = []
     release_variables: List[str] = []
+    prefetch_variables: List[str] = []
     saved_list_sizes: List[str] = []
     unpack: List[str] = []
     asserts: List[str] = []
@@ -300,6 +305,7 @@ def process_function(info: DifferentiabilityInfo, template: CodeTemplate) -> str
             saved_variables.append(f'SavedVariable {name}_;')
             release_variables.append(f'{name}_.reset_data();')
             release_variables.append(f'{name}_.reset_grad_function();')
+            prefetch_variables.append(f'{name}_.prefetch();')
             ptr = 'shared_from_this()' if is_output else ''
             unpack.append(f'auto {name} = {name}_.unpack({ptr});')
             getter_definitions.append(GETTER_DEFINITION_SAVEDVAR.substitute(
@@ -311,6 +317,7 @@ def process_function(info: DifferentiabilityInfo, template: CodeTemplate) -> str
             # Because the SavedVariable owns a tensor and a grad_fn, removing the SavedVariable makes them go away as well.
             release_variables.append(f'{name}_.clear();')
             release_variables.append(f'{name}_released_ = true;')
+            prefetch_variables.append(f'for (auto& var : {name}_) var.prefetch();')
             unpack.append(f'auto {name} = unpack_list({name}_);')
             asserts.append(f'TORCH_CHECK(!{name}_released_, ERR_BACKWARD_TWICE);')
             getter_definitions.append(GETTER_DEFINITION_SAVEDVAR.substitute(
@@ -322,6 +329,7 @@ def process_function(info: DifferentiabilityInfo, template: CodeTemplate) -> str
             # Because the SavedVariable owns a tensor and a grad_fn, removing the SavedVariable makes them go away as well.
             release_variables.append(f'{name}_.clear();')
             release_variables.append(f'{name}_released_ = true;')
+            prefetch_variables.append(f'for (auto& var : {name}_) var.prefetch();')
             unpack.append(f'auto {name} = unpack_opt_list({name}_);')
             asserts.append(f'TORCH_CHECK(!{name}_released_, ERR_BACKWARD_TWICE);')
             getter_definitions.append(GETTER_DEFINITION_SAVEDVAR.substitute(
@@ -439,6 +447,7 @@ def process_function(info: DifferentiabilityInfo, template: CodeTemplate) -> str
         compute_index_ranges=compute_index_ranges,
         saved_variables=saved_variables,
         release_variables=release_variables,
+        prefetch_variables=prefetch_variables,
         saved_list_sizes=saved_list_sizes,
         asserts=asserts,
         thread_lock=thread_lock,
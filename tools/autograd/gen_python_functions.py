@@ -79,7 +79,7 @@ SKIP_PYTHON_BINDINGS = [
     'alias', 'contiguous', 'is_cuda', 'is_sparse', 'is_sparse_csr', 'size', 'stride',
     '.*_backward', '.*_backward_(out|input|weight|bias)', '.*_forward',
     '.*_forward_out', '_unsafe_view', 'tensor', '_?sparse_coo_tensor.*',
-    '_?sparse_csr_tensor.*',
+    '_?sparse_csr_tensor.*', '_?sparse_bsr_tensor.*',
     '_arange.*', '_range.*', '_linspace.*', '_logspace.*',
     '_sparse_add_out', '_sparse_div.*', '_sparse_mul.*', '_sparse_sub.*', '_sparse_dense_add_out',
     'index', 'unique_dim_consecutive',
@@ -97,7 +97,8 @@ SKIP_PYTHON_BINDINGS = [
     '.*_overrideable',  # overrideable functions for backend extension
     'data', 'is_leaf', 'output_nr', '_version', 'requires_grad_', 'retain_grad', 'set_',
     '_fw_primal', 'fake_quantize_per_tensor_affine_cachemask',
-    'fake_quantize_per_channel_affine_cachemask',
+    'fake_quantize_per_channel_affine_cachemask', '_fused_moving_avg_obs_fq_helper',
+    '_quantize_int8_symmetric',
 ]
 
 # These function signatures are not exposed to Python. Note that this signature
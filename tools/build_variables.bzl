@@ -90,6 +90,8 @@ jit_core_sources = [
 core_sources_common = [
     "torch/csrc/autograd/profiler_legacy.cpp",
     "torch/csrc/autograd/profiler_kineto.cpp",
+    "torch/csrc/autograd/profiler_memory.cpp",
+    "torch/csrc/autograd/profiler_sampling.cpp",
     "torch/csrc/autograd/profiler_utils.cpp",
     "torch/csrc/autograd/autograd_meta.cpp",
     "torch/csrc/autograd/forward_grad.cpp",
@@ -123,6 +125,7 @@ core_trainer_sources = [
     "torch/csrc/autograd/input_buffer.cpp",
     "torch/csrc/autograd/record_function_ops.cpp",
     "torch/csrc/autograd/saved_variable.cpp",
+    "torch/csrc/autograd/saved_variable_packers.cpp",
     "torch/csrc/autograd/variable.cpp",
     "torch/csrc/jit/frontend/name_mangler.cpp",
     "torch/csrc/jit/ir/type_hashing.cpp",
@@ -137,6 +140,8 @@ core_sources_full_mobile = [
     "torch/csrc/jit/backends/backend_detail.cpp",
     "torch/csrc/jit/backends/backend_interface.cpp",
     "torch/csrc/jit/backends/backend_resolver.cpp",
+    "torch/csrc/jit/backends/xnnpack/xnnpack_backend_lib.cpp",
+    "torch/csrc/jit/backends/xnnpack/xnnpack_backend_preprocess.cpp",
     "torch/csrc/jit/codegen/fuser/codegen.cpp",
     "torch/csrc/jit/codegen/fuser/compiler.cpp",
     "torch/csrc/jit/codegen/fuser/executor.cpp",
@@ -210,6 +215,8 @@ core_sources_full_mobile = [
     "torch/csrc/jit/passes/prepack_folding.cpp",
     "torch/csrc/jit/passes/fold_conv_bn.cpp",
     "torch/csrc/jit/passes/frozen_conv_folding.cpp",
+    "torch/csrc/jit/passes/frozen_linear_folding.cpp",
+    "torch/csrc/jit/passes/frozen_linear_prepack.cpp",
     "torch/csrc/jit/passes/frozen_ops_to_mkldnn.cpp",
     "torch/csrc/jit/passes/frozen_graph_optimizations.cpp",
     "torch/csrc/jit/passes/remove_expands.cpp",
@@ -217,6 +224,7 @@ core_sources_full_mobile = [
     "torch/csrc/jit/passes/requires_grad_analysis.cpp",
     "torch/csrc/jit/passes/shape_analysis.cpp",
     "torch/csrc/jit/passes/specialize_autogradzero.cpp",
+    "torch/csrc/jit/passes/symbolic_shape_analysis.cpp",
     "torch/csrc/jit/passes/update_differentiable_graph_requires_grad.cpp",
     "torch/csrc/jit/passes/subgraph_rewrite.cpp",
     "torch/csrc/jit/passes/tensorexpr_fuser.cpp",
@@ -235,17 +243,21 @@ core_sources_full_mobile = [
     "torch/csrc/jit/python/update_graph_executor_opt.cpp",
     "torch/csrc/jit/runtime/argument_spec.cpp",
     "torch/csrc/jit/runtime/autodiff.cpp",
+    "torch/csrc/jit/runtime/disk_cache.cpp",
     "torch/csrc/jit/runtime/graph_executor.cpp",
     "torch/csrc/jit/runtime/interpreter.cpp",
     "torch/csrc/jit/runtime/logging.cpp",
+    "torch/csrc/jit/runtime/profiling_graph_cache.cpp",
     "torch/csrc/jit/runtime/profiling_graph_executor_impl.cpp",
     "torch/csrc/jit/runtime/profiling_record.cpp",
+    "torch/csrc/jit/runtime/register_calls.cpp",
     "torch/csrc/jit/runtime/symbolic_script.cpp",
     "torch/csrc/jit/serialization/import.cpp",
     "torch/csrc/jit/serialization/import_export_helpers.cpp",
     "torch/csrc/jit/serialization/import_source.cpp",
     "torch/csrc/jit/serialization/pickle.cpp",
     "torch/csrc/jit/serialization/python_print.cpp",
+    "torch/csrc/jit/serialization/record_prefetcher.cpp",
     "torch/csrc/jit/serialization/source_range_serialization.cpp",
     "torch/csrc/jit/tensorexpr/block_codegen.cpp",
     "torch/csrc/jit/tensorexpr/bounds_inference.cpp",
@@ -266,6 +278,7 @@ core_sources_full_mobile = [
     "torch/csrc/jit/tensorexpr/kernel.cpp",
     "torch/csrc/jit/tensorexpr/llvm_codegen.cpp",
     "torch/csrc/jit/tensorexpr/llvm_jit.cpp",
+    "torch/csrc/jit/tensorexpr/loop_schedule.cpp",
     "torch/csrc/jit/tensorexpr/loopnest.cpp",
     "torch/csrc/jit/tensorexpr/mem_arena.cpp",
     "torch/csrc/jit/tensorexpr/mem_dependency_checker.cpp",
@@ -277,11 +290,13 @@ core_sources_full_mobile = [
     "torch/csrc/jit/tensorexpr/unique_name_manager.cpp",
     "torch/csrc/jit/testing/file_check.cpp",
     "torch/csrc/jit/testing/hooks_for_testing.cpp",
+    "torch/csrc/utils/static_module_batcher.cpp",
     "torch/csrc/utils/tensor_flatten.cpp",
     "torch/csrc/utils/variadic.cpp",
 ]
 
 core_sources_full = core_sources_full_mobile + [
+    "torch/csrc/jit/runtime/static/constant_store.cpp",
     "torch/csrc/jit/runtime/static/fusion.cpp",
     "torch/csrc/jit/runtime/static/impl.cpp",
     "torch/csrc/jit/runtime/static/ops.cpp",
@@ -388,6 +403,7 @@ libtorch_cuda_core_sources = [
     "torch/csrc/CudaIPCTypes.cpp",
     "torch/csrc/cuda/comm.cpp",
     "torch/csrc/jit/codegen/fuser/cuda/fused_kernel.cpp",
+    "torch/csrc/jit/codegen/fuser/cuda/kernel_binary_cache.cpp",
     "torch/csrc/autograd/profiler_cuda.cpp",
     "torch/csrc/autograd/functions/comm.cpp",
     "torch/csrc/jit/codegen/cuda/arith.cpp",
@@ -446,7 +462,10 @@ libtorch_cuda_sources = libtorch_cuda_core_sources + [
 
 torch_cpp_srcs = [
     "torch/csrc/api/src/cuda.cpp",  # this just forwards stuff, no real CUDA
+    "torch/csrc/api/src/data/datasets/columnar.cpp",
     "torch/csrc/api/src/data/datasets/mnist.cpp",
+    "torch/csrc/api/src/data/detail/pinned_memory_pool.cpp",
+    "torch/csrc/api/src/data/detail/worker_process.cpp",
     "torch/csrc/api/src/data/samplers/distributed.cpp",
     "torch/csrc/api/src/data/samplers/random.cpp",
     "torch/csrc/api/src/data/samplers/sequential.cpp",
@@ -613,11 +632,14 @@ libtorch_python_core_sources = [
 ]
 
 libtorch_python_distributed_core_sources = [
+    "torch/lib/c10d/bucket_optimizer.cpp",
     "torch/lib/c10d/comm.cpp",
     "torch/lib/c10d/default_comm_hooks.cpp",
     "torch/lib/c10d/frontend.cpp",
     "torch/lib/c10d/reducer.cpp",
     "torch/lib/c10d/logger.cpp",
+    "torch/lib/c10d/pipeline.cpp",
+    "torch/lib/c10d/snapshot.cpp",
     "torch/csrc/distributed/c10d/python_comm_hook.cpp",
     "torch/csrc/distributed/c10d/init.cpp",
 ]
@@ -662,6 +684,7 @@ aten_cpu_source_non_codegen_list = [
     "aten/src/ATen/Context.cpp",
     "aten/src/ATen/DLConvertor.cpp",
     "aten/src/ATen/ExpandUtils.cpp",
+    "aten/src/ATen/InterOpPriority.cpp",
     "aten/src/ATen/MemoryOverlap.cpp",
     "aten/src/ATen/NamedTensorUtils.cpp",
     "aten/src/ATen/ParallelCommon.cpp",
@@ -768,6 +791,7 @@ aten_native_source_codegen_list = [
     "aten/src/ATen/native/cpu/DistanceOpsKernel.cpp",
     "aten/src/ATen/native/cpu/FillKernel.cpp",
     "aten/src/ATen/native/cpu/FunctionOfAMatrixUtilsKernel.cpp",
+    "aten/src/ATen/native/cpu/FusedOptimizerKernel.cpp",
     "aten/src/ATen/native/cpu/GridSamplerKernel.cpp",
     "aten/src/ATen/native/cpu/IndexKernel.cpp",
     "aten/src/ATen/native/cpu/LerpKernel.cpp",
@@ -776,15 +800,19 @@ aten_native_source_codegen_list = [
     "aten/src/ATen/native/cpu/MultinomialKernel.cpp",
     "aten/src/ATen/native/cpu/PointwiseOpsKernel.cpp",
     "aten/src/ATen/native/cpu/PowKernel.cpp",
+    "aten/src/ATen/native/cpu/RNNKernel.cpp",
     "aten/src/ATen/native/cpu/RangeFactoriesKernel.cpp",
     "aten/src/ATen/native/cpu/ReduceAllOpsKernel.cpp",
     "aten/src/ATen/native/cpu/ReduceOpsKernel.cpp",
     "aten/src/ATen/native/cpu/ScatterGatherKernel.cpp",
     "aten/src/ATen/native/cpu/SoftMaxKernel.cpp",
     "aten/src/ATen/native/cpu/SortingKernel.cpp",
+    "aten/src/ATen/native/cpu/SparseCoalesceKernel.cpp",
+    "aten/src/ATen/native/cpu/SparseCsrMmKernel.cpp",
     "aten/src/ATen/native/cpu/StackKernel.cpp",
     "aten/src/ATen/native/cpu/SumKernel.cpp",
     "aten/src/ATen/native/cpu/TensorCompareKernel.cpp",
+    "aten/src/ATen/native/cpu/TransformerKernel.cpp",
     "aten/src/ATen/native/cpu/UnaryOpsKernel.cpp",
     "aten/src/ATen/native/cpu/Unfold2d.cpp",
     "aten/src/ATen/native/cpu/UnfoldBackwardKernel.cpp",
@@ -812,6 +840,7 @@ aten_native_source_non_codegen_list = [
     "aten/src/ATen/native/quantized/cpu/qconv.cpp",
     "aten/src/ATen/native/quantized/cpu/qconv_prepack.cpp",
     "aten/src/ATen/native/quantized/cpu/qconv_unpack.cpp",
+    "aten/src/ATen/native/quantized/cpu/qelementwise.cpp",
     "aten/src/ATen/native/quantized/cpu/qelu.cpp",
     "aten/src/ATen/native/quantized/cpu/qembeddingbag.cpp",
     "aten/src/ATen/native/quantized/cpu/qembeddingbag_prepack.cpp",
@@ -820,6 +849,7 @@ aten_native_source_non_codegen_list = [
     "aten/src/ATen/native/quantized/cpu/qhardswish.cpp",
     "aten/src/ATen/native/quantized/cpu/qlinear.cpp",
     "aten/src/ATen/native/quantized/cpu/qlinear_dynamic.cpp",
+    "aten/src/ATen/native/quantized/cpu/qlinear_nbit.cpp",
     "aten/src/ATen/native/quantized/cpu/qlinear_prepack.cpp",
     "aten/src/ATen/native/quantized/cpu/qlinear_unpack.cpp",
     "aten/src/ATen/native/quantized/cpu/qmul.cpp",
@@ -843,6 +873,7 @@ aten_native_source_non_codegen_list = [
     "aten/src/ATen/native/quantized/affine_quantizer_base.cpp",
     "aten/src/ATen/native/quantized/fake_quant_per_channel_affine.cpp",
     "aten/src/ATen/native/quantized/fake_quant_per_tensor_affine.cpp",
+    "aten/src/ATen/native/quantized/fused_obs_fake_quant.cpp",
     "aten/src/ATen/native/quantized/library.cpp",
     "aten/src/ATen/quantized/QTensorImpl.cpp",
     "aten/src/ATen/quantized/Quantizer.cpp",
@@ -885,6 +916,7 @@ aten_native_source_non_codegen_list = [
     "aten/src/ATen/native/FractionalMaxPool2d.cpp",
     "aten/src/ATen/native/FractionalMaxPool3d.cpp",
     "aten/src/ATen/native/FunctionOfAMatrixUtils.cpp",
+    "aten/src/ATen/native/FusedOptimizers.cpp",
     "aten/src/ATen/native/GatedLinearUnit.cpp",
     "aten/src/ATen/native/GridSampler.cpp",
     "aten/src/ATen/native/Im2Col.cpp",
@@ -913,6 +945,7 @@ aten_native_source_non_codegen_list = [
     "aten/src/ATen/native/NamedTensor.cpp",
     "aten/src/ATen/native/Normalization.cpp",
     "aten/src/ATen/native/Onehot.cpp",
+    "aten/src/ATen/native/PackedLinear.cpp",
     "aten/src/ATen/native/PackedSequence.cpp",
     "aten/src/ATen/native/PixelShuffle.cpp",
     "aten/src/ATen/native/PointwiseOps.cpp",
@@ -945,6 +978,7 @@ aten_native_source_non_codegen_list = [
     "aten/src/ATen/native/TensorShape.cpp",
     "aten/src/ATen/native/TensorTransformations.cpp",
     "aten/src/ATen/native/TestOps.cpp",
+    "aten/src/ATen/native/Transformer.cpp",
     "aten/src/ATen/native/TriangularOps.cpp",
     "aten/src/ATen/native/TypeProperties.cpp",
     "aten/src/ATen/native/UnaryOps.cpp",
@@ -516,7 +516,10 @@ def is_foreach_op(name: str) -> bool:
         '_foreach_addcdiv_.Scalar',
         '_foreach_addcmul_.ScalarList',
         '_foreach_addcdiv_.ScalarList',
-        '_foreach_zero_'])
+        '_foreach_zero_',
+        '_fused_adam_',
+        '_fused_sgd_',
+        '_fused_adagrad_'])
 
 # The function schema is undoubtedly the most important data structure
 # in all of the codegen, as it defines the type signature for operators,
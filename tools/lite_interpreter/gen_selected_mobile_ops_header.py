@@ -37,6 +37,29 @@ selected_mobile_ops_preamble = """#pragma once
 
 """
 
+selected_operator_table_template_str = """#define TORCH_SELECTED_MOBILE_OPERATOR_TABLE
+
+namespace torch {
+namespace jit {
+namespace mobile {
+// The selected root operators, sorted, see Note [Selected operator table]
+constexpr const char* kSelectedOperators[] = {
+  $operators
+};
+} // namespace mobile
+} // namespace jit
+} // namespace torch
+
+"""
+selected_operator_table_template = CodeTemplate(selected_operator_table_template_str)
+
+def get_selected_operator_table_code(root_ops: Set[str]) -> str:
+    if not root_ops:
+        return ""
+    return selected_operator_table_template.substitute(
+        operators=['"' + op + '",' for op in sorted(root_ops)],
+    )
+
 def extract_root_operators(selective_builder: SelectiveBuilder) -> Set[str]:
     ops = []
     for (op_name, op) in selective_builder.operators.items():
@@ -80,6 +103,7 @@ def write_selected_mobile_ops(
         body_parts = [selected_mobile_ops_preamble]
         if not selective_builder.include_all_operators:
             body_parts.append("#define TORCH_OPERATOR_WHITELIST " + (";".join(sorted(root_ops))) + ";\n\n")
+            body_parts.append(get_selected_operator_table_code(root_ops))
 
         body_parts.append(get_selected_kernel_dtypes_code(selective_builder))
         header_contents = "".join(body_parts)
@@ -96,6 +120,7 @@ def write_selected_mobile_ops_with_all_dtypes(
     with open(output_file_path, "wb") as out_file:
         body_parts = [selected_mobile_ops_preamble]
         body_parts.append("#define TORCH_OPERATOR_WHITELIST " + (";".join(sorted(root_ops))) + ";\n\n")
+        body_parts.append(get_selected_operator_table_code(root_ops))
 
         selective_builder = SelectiveBuilder.get_nop_selector()
         body_parts.append(get_selected_kernel_dtypes_code(selective_builder))
@@ -1,4 +1,4 @@
-from typing import List, Set
+from typing import Callable, List, Optional, Set, Tuple
 from enum import Enum
 
 # Defined in tools/autograd/init.cpp
@@ -70,3 +70,63 @@ def _set_empty_test_observer(is_global: bool, sampling_prob: float) -> None: ...
 
 def _enable_profiler_legacy(config: ProfilerConfig) -> None: ...
 def _disable_profiler_legacy() -> List[List[ProfilerEvent]]: ...
+
+class _SampledOpStats:
+    name: str
+    input_shapes: str
+    count: int
+    total_ns: int
+    buckets: List[int]
+    cycles: int
+    instructions: int
+    llc_misses: int
+
+def _enable_sampling_profiler(sampling_prob: float = ..., with_perf_counters: bool = ...) -> None: ...
+def _disable_sampling_profiler() -> None: ...
+def _sampling_profiler_enabled() -> bool: ...
+def _sampling_profiler_snapshot() -> List[_SampledOpStats]: ...
+def _sampling_profiler_dropped_samples() -> int: ...
+def _sampling_profiler_prometheus() -> str: ...
+
+class _MemoryTimelineEvent:
+    time_ns: int
+    bytes: int
+    device: str
+    scope: str
+    alloc_scope: str
+
+class _MemoryTimelinePeak:
+    device: str
+    bytes: int
+    time_ns: int
+    holders: List[Tuple[str, int]]
+
+class _MemoryTimelineTransient:
+    scope: str
+    device: str
+    count: int
+    bytes: int
+
+class _MemoryTimeline:
+    events: List[_MemoryTimelineEvent]
+    peaks: List[_MemoryTimelinePeak]
+    transients: List[_MemoryTimelineTransient]
+
+def _enable_memory_timeline() -> None: ...
+def _disable_memory_timeline() -> _MemoryTimeline: ...
+
+class _SavedVariablePacker:
+    ...
+
+def _make_saved_tensor_packer(dtype: Optional[str], relu_mask: bool, min_bytes: int) -> _SavedVariablePacker: ...
+def _get_saved_tensor_packer() -> Optional[_SavedVariablePacker]: ...
+def _set_saved_tensor_packer(packer: Optional[_SavedVariablePacker]) -> None: ...
+
+class _RecomputePacker(_SavedVariablePacker):
+    def finish(self, keep: bool) -> None: ...
+    def saved_bytes(self) -> int: ...
+
+def _make_recompute_saved_tensor_packer(recompute: Callable[[], None], min_bytes: int) -> _RecomputePacker: ...
+
+class _InferenceMode:
+    def __init__(self, enabled: bool) -> None: ...
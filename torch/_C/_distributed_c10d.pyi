@@ -1,8 +1,8 @@
 from datetime import timedelta
 from enum import Enum
-from typing import Optional, List, Any, Tuple, overload
+from typing import Optional, List, Any, Callable, Dict, Tuple, overload
 
-from torch import Tensor
+from torch import Tensor, device
 
 # This module is defined in torch/csrc/distributed/c10d/init.cpp
 
@@ -12,10 +12,44 @@ _DEFAULT_NO_TIMEOUT: timedelta
 class BuiltinCommHookType(Enum):
     ALLREDUCE = ...
     FP16_COMPRESS = ...
+    POWER_SGD = ...
+    TOPK_SPARSIFY = ...
+
+class BuiltinCommHookOptions:
+    start_iter: int
+    use_error_feedback: bool
+    matrix_approximation_rank: int
+    min_compression_rate: float
+    warm_start: bool
+    orthogonalization_epsilon: float
+    random_seed: int
+    topk_ratio: float
+    def __init__(self): ...
+
+class BucketOptimizerType(Enum):
+    SGD = ...
+    ADAM = ...
+
+class BucketOptimizerOptions:
+    lr: float
+    weight_decay: float
+    momentum: float
+    beta1: float
+    beta2: float
+    eps: float
+    def __init__(self): ...
 
 def _register_comm_hook(reducer: Reducer, state: Any, comm_hook: Any): ...
 def _register_builtin_comm_hook(
-    reducer: Reducer, comm_hook_type: BuiltinCommHookType
+    reducer: Reducer,
+    comm_hook_type: BuiltinCommHookType,
+    options: BuiltinCommHookOptions = ...,
+): ...
+def _register_bucket_optimizer(
+    reducer: Reducer,
+    optimizer_type: BucketOptimizerType,
+    options: BucketOptimizerOptions = ...,
+    shard_optimizer_state: bool = ...,
 ): ...
 
 class GradBucket:
@@ -60,6 +94,25 @@ class Logger:
 
 def _get_debug_mode(): ...
 
+class _PipelineExecutor:
+    def __init__(
+        self,
+        forward_group: ProcessGroup,
+        backward_group: ProcessGroup,
+        chunks: List[Callable[[Tensor, int], Tensor]],
+        num_micro_batches: int,
+        activation: Tensor,
+    ): ...
+    def run(self, inputs: List[Tensor] = ...) -> List[Tensor]: ...
+
+class _SnapshotService:
+    def __init__(self, rank: int): ...
+    def snapshot(self, state: Dict[str, Tensor], directory: str): ...
+    def wait(self): ...
+    def is_completed(self) -> bool: ...
+    @staticmethod
+    def shard_path(directory: str, rank: int) -> str: ...
+
 class _DistributedDebugLevel(Enum):
     OFF = ...
     INFO = ...
@@ -117,6 +170,8 @@ class AllToAllOptions:
 class Store:
     def set(self, key: str, value: str): ...
     def get(self, key: str) -> bytes: ...
+    def multi_get(self, keys: List[str]) -> List[bytes]: ...
+    def multi_set(self, keys: List[str], values: List[str]): ...
     def add(self, key: str, value: int) -> int: ...
     def delete_key(self, key: str) -> bool: ...
     def num_keys(self) -> int: ...
@@ -196,6 +251,11 @@ class ProcessGroup:
         tensors: List[Tensor],
         opts=AllreduceCoalescedOptions(),
     ) -> Work: ...
+    def broadcast_coalesced(
+        self,
+        tensors: List[Tensor],
+        opts=BroadcastOptions(),
+    ) -> Work: ...
     @overload
     def reduce(
         self,
@@ -269,6 +329,12 @@ class ProcessGroup:
         output_tensors: Tensor,
         input_tensor: List[Tensor],
     ) -> Work: ...
+    def reduce_scatter_coalesced(
+        self,
+        output_tensors: List[Tensor],
+        input_lists: List[List[Tensor]],
+        opts=ReduceScatterOptions(),
+    ) -> Work: ...
     @overload
     def alltoall_base(
         self,
@@ -299,6 +365,12 @@ class ProcessGroup:
         output: List[Tensor],
         input: List[Tensor],
     ) -> Work: ...
+    def alltoall_v(
+        self,
+        input_tensor: Tensor,
+        input_split_sizes: List[int],
+        opts=AllToAllOptions(),
+    ) -> Work: ...
     def send(
         self,
         tensors: List[Tensor],
@@ -338,7 +410,28 @@ class ProcessGroupGloo(ProcessGroup):
     ...
 
 class ProcessGroupNCCL(ProcessGroup):
-    class Options: ...
+    class Options:
+        is_high_priority_stream: bool
+        hierarchical_allreduce: bool
+        hierarchical_alltoall: bool
+        eager_init_device: Optional[device]
+        split_from: Optional[ProcessGroupNCCL]
+        collective_trace_size: int
+    class _CollectiveTrace:
+        seq: int
+        op_type: str
+        numel: int
+        bytes: int
+        enqueue_time_us: int
+        duration_us: float
+    class _CollectiveSkew:
+        seq: int
+        op_type: str
+        bytes: int
+        enqueue_time_us: List[int]
+        duration_us: List[float]
+        arrival_skew_us: List[float]
+        straggler: int
     def __init__(
         self,
         store: Store,
@@ -346,6 +439,11 @@ class ProcessGroupNCCL(ProcessGroup):
         size: int,
         timeout: timedelta,
     ): ...
+    @property
+    def options(self) -> Options: ...
+    def _perform_nocolor_split(self, device: device) -> None: ...
+    def _get_collective_traces(self) -> List[_CollectiveTrace]: ...
+    def _gather_collective_traces(self) -> List[_CollectiveSkew]: ...
     @staticmethod
     def _group_start() -> None: ...
     @staticmethod
@@ -368,6 +466,14 @@ def _compute_bucket_assignment_by_size(
     expect_sparse_gradient: List[bool],
     tensor_indices: List[int],
 ) -> List[List[int]]: ...
+def _compute_bucket_assignment_by_time(
+    tensors: List[Tensor],
+    ready_times: List[float],
+    alpha: float,
+    beta: float,
+    expect_sparse_gradient: List[bool] = ...,
+    tensor_indices: List[int] = ...,
+) -> List[List[int]]: ...
 def _broadcast_coalesced(
     process_group: ProcessGroup,
     tensors: List[Tensor],
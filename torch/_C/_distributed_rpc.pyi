@@ -97,6 +97,8 @@ class ProcessGroupAgent(RpcAgent):
 class _TensorPipeRpcBackendOptionsBase(RpcBackendOptions):
     num_worker_threads: int
     device_maps: Dict[str, Dict[int, int]]
+    _batching_timeout_us: int
+    _batching_max_bytes: int
     def __init__(
         self,
         num_worker_threads: int,
@@ -654,6 +654,7 @@ from torch.autograd import (
     no_grad as no_grad,
     enable_grad as enable_grad,
     set_grad_enabled as set_grad_enabled,
+    inference_mode as inference_mode,
 )
 from torch import fft as fft
 from torch import futures as futures
@@ -33,7 +33,10 @@ def _save_storages(importer, obj):
     pickler.persistent_id = persistent_id
     pickler.dump(obj)
     data_value = data_buf.getvalue()
-    return data_value, serialized_storages, serialized_dtypes, importer.zip_reader if importer else None
+    zip_reader = importer.zip_reader if importer else None
+    if isinstance(zip_reader, _SharedStorageReader):
+        zip_reader = zip_reader.zip_reader
+    return data_value, serialized_storages, serialized_dtypes, zip_reader
 
 def _load_storages(id, zip_reader, obj_bytes, serialized_storages):
 
@@ -58,10 +61,24 @@ def _load_storages(id, zip_reader, obj_bytes, serialized_storages):
     result = _deploy_objects[id] = unpickler.load()
     return result
 
-def _get_package(zip_reader):
+class _SharedStorageReader:
+    """Wraps the zip reader of a package so that its storages are loaded by
+    ``get_storage_from_record``, which shares them with the other
+    interpreters that load the package."""
+    def __init__(self, zip_reader, get_storage_from_record):
+        self.zip_reader = zip_reader
+        self.get_storage_from_record = get_storage_from_record
+
+    def __getattr__(self, name):
+        return getattr(self.zip_reader, name)
+
+def _get_package(zip_reader, get_storage_from_record=None):
     if zip_reader not in _raw_packages:
         _raw_packages[zip_reader] = PackageImporter(zip_reader)
-    return _raw_packages[zip_reader]
+    importer = _raw_packages[zip_reader]
+    if get_storage_from_record is not None and not isinstance(importer.zip_reader, _SharedStorageReader):
+        importer.zip_reader = _SharedStorageReader(zip_reader, get_storage_from_record)
+    return importer
 
 
 _raw_packages: dict = {}
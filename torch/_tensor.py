@@ -1,4 +1,5 @@
 from collections import OrderedDict
+import enum
 import functools
 from numbers import Number
 from typing import Any, Dict, Optional, Tuple, Union
@@ -723,6 +724,51 @@ class Tensor(torch._C._TensorBase):
 
         return dict(typestr=typestr, shape=shape, strides=strides, data=data, version=2)
 
+    def __dlpack__(self, stream=None):
+        """
+        Creates a DLPack `capsule <https://data-apis.org/array-api/latest/design_topics/data_interchange.html#data-interchange>`_
+        of the current tensor to be exported to other libraries.
+
+        The capsule shares the tensor's memory, including for non-contiguous
+        tensors, which are exported with their strides.
+
+        Args:
+            stream (integer or None): An optional Python integer representing a
+            pointer to a CUDA stream. The current stream is synchronized with
+            this stream before the capsule is created, and since the capsule
+            shares its storage with the tensor this makes it safe to access from
+            both streams. If None or -1 is passed then no synchronization is performed.
+            The values 1 and 2 stand for the legacy and the per-thread default
+            stream.
+        """
+        if has_torch_function_unary(self):
+            return handle_torch_function(Tensor.__dlpack__, (self,), self, stream)
+
+        if stream is not None and type(stream) is not int:
+            # Stream pointers in CUDA/ROCm are uniquely numbered and can
+            # be retrieved from their integer value.
+            raise TypeError('stream must be ``int`` or ``none``')
+        if self.is_cuda and stream is not None and stream != -1:
+            with torch.cuda.device(self.device):
+                torch._C._cuda_externalStreamWaitCurrent(stream)
+        return torch._C._to_dlpack(self)
+
+    def __dlpack_device__(self) -> Tuple[enum.IntEnum, int]:
+        if has_torch_function_unary(self):
+            return handle_torch_function(Tensor.__dlpack_device__, (self,), self)
+        from torch.utils.dlpack import DLDeviceType
+        device = self.device
+        idx = device.index if device.index is not None else 0
+        if device.type == 'cuda' and torch.version.hip is not None:
+            device_type = DLDeviceType.kDLROCM
+        elif device.type == 'cuda':
+            device_type = DLDeviceType.kDLGPU
+        elif device.type == 'cpu':
+            device_type = DLDeviceType.kDLCPU
+        else:
+            raise ValueError('Unknown device type {} for Dlpack'.format(device.type))
+        return (device_type, idx)
+
     def refine_names(self, *names):
         r"""Refines the dimension names of :attr:`self` according to :attr:`names`.
 
@@ -927,21 +973,52 @@ class Tensor(torch._C._TensorBase):
         if self.is_sparse:
             coalesced_self = self.coalesce()
             row_indices = coalesced_self.indices()[0]
-            ro = [0]
-            i = 0
-            for irow in range(self.shape[0]):
-                while i < row_indices.size()[0] and row_indices[i] == irow:
-                    i += 1
-                ro.append(i)
-
-            return torch.sparse_csr_tensor(torch.tensor(ro, dtype=row_indices.dtype),
-                                           coalesced_self.indices()[1], coalesced_self.values(),
-                                           size=coalesced_self.shape, dtype=coalesced_self.dtype)
+            crow_indices = torch._convert_indices_from_coo_to_csr(
+                row_indices, self.shape[0], out_int32=row_indices.dtype == torch.int32)
+            return torch.sparse_csr_tensor(crow_indices,
+                                           coalesced_self.indices()[1].contiguous(),
+                                           coalesced_self.values(),
+                                           size=coalesced_self.shape, dtype=coalesced_self.dtype,
+                                           device=coalesced_self.device)
         elif self.is_sparse_csr:
             return self
         else:
             return self.to_sparse().to_sparse_csr()
 
+    def to_sparse_bsr(self, blocksize):
+        """ Convert a tensor to block sparse row (BSR) storage format, with
+        blocks of shape :attr:`blocksize`. Only works with 2D tensors whose
+        sizes are multiples of :attr:`blocksize`; blocks with a nonzero are
+        stored densely.
+
+        Examples::
+
+            >>> dense = torch.randn(10, 10)
+            >>> dense[:, 2:] = 0
+            >>> sparse = dense.to_sparse_bsr((2, 2))
+            >>> sparse._nnz()
+            5
+
+        """
+        shape = self.size()
+        if len(shape) != 2:
+            raise RuntimeError("Only 2D tensors can be converted to the BSR format but got shape: ", shape)
+        blocksize = tuple(blocksize)
+        if len(blocksize) != 2 or shape[0] % blocksize[0] != 0 or shape[1] % blocksize[1] != 0:
+            raise RuntimeError("Expected the shape to be a multiple of a 2D blocksize but got shape: ",
+                               shape, " and blocksize: ", blocksize)
+
+        dense = self.to_dense() if self.is_sparse or self.is_sparse_csr else self
+        block_rows = shape[0] // blocksize[0]
+        blocks = dense.reshape(block_rows, blocksize[0], shape[1] // blocksize[1], blocksize[1]).transpose(1, 2)
+        nonzero_blocks = blocks.ne(0).any(-1).any(-1)
+        block_indices = nonzero_blocks.nonzero()
+        crow_indices = torch._convert_indices_from_coo_to_csr(block_indices[:, 0], block_rows)
+        return torch.sparse_bsr_tensor(crow_indices,
+                                       block_indices[:, 1].contiguous(),
+                                       blocks[nonzero_blocks].contiguous(),
+                                       size=shape, dtype=self.dtype, device=self.device)
+
     def _update_names(self, names, inplace):
         if has_torch_function_unary(self):
             return handle_torch_function(Tensor._update_names, (self,), self, names, inplace)
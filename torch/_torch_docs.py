@@ -480,6 +480,52 @@ Keyword args:
     {out}
 """.format(**common_args))
 
+add_docstr(torch.sparse_sampled_addmm,
+           r"""
+sparse_sampled_addmm(input, mat1, mat2, *, beta=1, alpha=1, out=None) -> Tensor
+
+Performs a matrix multiplication of the dense matrices :attr:`mat1` and :attr:`mat2`
+at the locations specified by the sparsity pattern of :attr:`input`. The matrix
+:attr:`input` is added to the final result.
+
+Mathematically this performs the following operation:
+
+.. math::
+
+    \text{out} = \alpha\ (\text{mat1} \mathbin{@} \text{mat2})*\text{spy}(\text{input}) + \beta\ \text{input}
+
+where :math:`\text{spy}(\text{input})` is the sparsity pattern matrix of :attr:`input`, and
+:attr:`alpha` and :attr:`beta` are the scaling factors. The result has the sparsity
+pattern of :attr:`input`; this is also known as a sampled dense-dense matrix
+multiplication (SDDMM).
+
+.. note::
+    :attr:`input` must be a sparse CSR tensor. :attr:`mat1` and :attr:`mat2` must be
+    strided tensors.
+
+Args:
+    input (Tensor): a sparse CSR matrix of shape `(m, n)` to be added and used to
+        compute the sampled matrix multiplication
+    mat1 (Tensor): a dense matrix of shape `(m, k)` to be multiplied
+    mat2 (Tensor): a dense matrix of shape `(k, n)` to be multiplied
+
+Keyword args:
+    beta (Number, optional): multiplier for :attr:`input` (:math:`\beta`)
+    alpha (Number, optional): multiplier for :math:`mat1 @ mat2` (:math:`\alpha`)
+    {out}
+
+Examples::
+
+    >>> input = torch.eye(3).to_sparse_csr()
+    >>> mat1 = torch.randn(3, 5)
+    >>> mat2 = torch.randn(5, 3)
+    >>> torch.sparse_sampled_addmm(input, mat1, mat2)
+    tensor(crow_indices=tensor([0, 1, 2, 3]),
+           col_indices=tensor([0, 1, 2]),
+           values=tensor([ 0.2847, -0.7805, -0.1900]), size=(3, 3), nnz=3,
+           layout=torch.sparse_csr)
+""".format(**common_args))
+
 add_docstr(torch.smm,
            r"""
 smm(input, mat) -> Tensor
@@ -7923,6 +7969,46 @@ Example ::
            dtype=torch.float64, layout=torch.sparse_csr)
 """.format(**factory_common_args))
 
+add_docstr(torch.sparse_bsr_tensor,
+           r"""
+sparse_bsr_tensor(crow_indices, col_indices, values, size, *, dtype=None, device=None, requires_grad=False) -> Tensor
+
+Constructs a :ref:`sparse tensor in BSR (Block Sparse Row) <sparse-bsr-docs>` with the dense blocks
+:attr:`values` at the given :attr:`crow_indices` and :attr:`col_indices`, which index rows and columns
+of blocks. Matrix multiplications with BSR tensors multiply whole blocks with dense matrix products.
+
+Args:
+    crow_indices (array_like): One-dimensional array of size size[0] / blocksize[0] + 1. The last element
+        is the number of blocks. Each successive number in the tensor subtracted by the number before it
+        denotes the number of blocks in a given row of blocks.
+    col_indices (array_like): Column of blocks of each block in values. Strictly one dimensional tensor
+        with the same length as values.
+    values (array_list): The blocks of the tensor, of shape (nnz, blocksize[0], blocksize[1]). Can be a
+        list, tuple, NumPy ``ndarray``, and other types.
+    size (list, tuple, :class:`torch.Size`): Size of the sparse tensor, a multiple of the blocksize.
+
+Keyword args:
+    dtype (:class:`torch.dtype`, optional): the desired data type of returned tensor.
+        Default: if None, infers data type from :attr:`values`.
+    device (:class:`torch.device`, optional): the desired device of returned tensor.
+        Default: if None, uses the current device for the default tensor type
+        (see :func:`torch.set_default_tensor_type`). :attr:`device` will be the CPU
+        for CPU tensor types and the current CUDA device for CUDA tensor types.
+    {requires_grad}
+
+Example ::
+    >>> crow_indices = [0, 1, 2]
+    >>> col_indices = [1, 0]
+    >>> values = [[[1, 2], [3, 4]], [[5, 6], [7, 8]]]
+    >>> torch.sparse_bsr_tensor(torch.tensor(crow_indices, dtype=torch.int64),
+    ...                         torch.tensor(col_indices, dtype=torch.int64),
+    ...                         torch.tensor(values), (4, 4), dtype=torch.double).to_dense()
+    tensor([[0., 0., 1., 2.],
+            [0., 0., 3., 4.],
+            [5., 6., 0., 0.],
+            [7., 8., 0., 0.]], dtype=torch.float64)
+""".format(**factory_common_args))
+
 add_docstr(torch.sparse_coo_tensor,
            r"""
 sparse_coo_tensor(indices, values, size=None, *, dtype=None, device=None, requires_grad=False) -> Tensor
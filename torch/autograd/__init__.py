@@ -15,8 +15,13 @@ from typing import Any, Callable, List, Optional, Sequence, Tuple, Union
 from .variable import Variable
 from .function import Function, NestedIOFunction
 from .gradcheck import gradcheck, gradgradcheck
-from .grad_mode import no_grad, enable_grad, set_grad_enabled
+from .grad_mode import no_grad, enable_grad, set_grad_enabled, inference_mode
 from .anomaly_mode import detect_anomaly, set_detect_anomaly
+from .saved_tensor_offload import offload_saved_tensors
+from .saved_tensor_compression import compress_saved_tensors
+from .parallel_backward import parallel_cpu_backward
+from .sequential_backward import sequential_cpu_backward
+from .grad_accumulation import grouped_grad_accumulation
 from ..overrides import has_torch_function, handle_torch_function
 from . import functional
 from . import forward_ad
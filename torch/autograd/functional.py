@@ -1,6 +1,7 @@
 import torch
 from typing import Tuple, List
 from torch._vmap_internals import _vmap
+from . import forward_ad as fwAD
 
 # Utility functions
 
@@ -378,6 +379,91 @@ def jvp(func, inputs, v=None, create_graph=False, strict=False):
     return _tuple_postprocess(outputs, is_outputs_tuple), _tuple_postprocess(jvp, is_outputs_tuple)
 
 
+def batched_jvp(func, inputs, v, strict=False):
+    r"""Function that computes the Jacobian vector products of the given
+    function at the point given by the inputs for a batch of vectors ``v``.
+
+    Unlike :func:`jvp`, this uses forward mode AD with the whole batch of
+    vectors as the tangent of the inputs, so ``func`` is evaluated once and
+    every op propagates all the directions at the same time.
+
+    Args:
+        func (function): a Python function that takes Tensor inputs and returns
+            a tuple of Tensors or a Tensor.
+        inputs (tuple of Tensors or Tensor): inputs to the function ``func``.
+        v (tuple of Tensors or Tensor): The batch of vectors for which the
+            Jacobian vector products are computed. Each Tensor has the size of
+            the corresponding input with an extra leading dimension, the same
+            for all of them, that indexes the vectors.
+        strict (bool, optional): If ``True``, an error will be raised when we
+            detect that there exists an output that is independent of all the
+            inputs. If ``False``, we return a Tensor of zeros as the jvp for
+            said outputs, which is the expected mathematical value.
+            Defaults to ``False``.
+
+    Returns:
+        output (tuple): tuple with:
+            func_output (tuple of Tensors or Tensor): output of ``func(inputs)``
+
+            jvp (tuple of Tensors or Tensor): the Jacobian vector products,
+            with the shape of the output and the leading dimension of ``v``.
+
+    Example:
+
+        >>> def exp_reducer(x):
+        ...   return x.exp().sum(dim=1)
+        >>> inputs = torch.rand(4, 4)
+        >>> v = torch.eye(16).view(16, 4, 4)
+        >>> batched_jvp(exp_reducer, inputs, v)[1].shape
+        torch.Size([16, 4])
+
+    Note:
+        Every op used by ``func`` needs a forward mode AD formula, and the
+        ops of these formulas should have a batching rule for vmap to be
+        efficient. In-place operations on views of the inputs are not
+        supported.
+    """
+
+    is_inputs_tuple, inputs = _as_tuple(inputs, "inputs", "batched_jvp")
+    _, v = _as_tuple(v, "v", "batched_jvp")
+    if len(v) != len(inputs):
+        raise RuntimeError("v is a tuple of invalid length: should be {} but got {}.".format(len(inputs), len(v)))
+    batch_size = v[0].size(0) if v[0].dim() > 0 else None
+    for idx, (inp, tangents) in enumerate(zip(inputs, v)):
+        if batch_size is None or tangents.size() != (batch_size,) + inp.size():
+            raise RuntimeError("Entry {} in v has invalid size: should be a batch of vectors of size {} "
+                               "with the same batch size as the first entry but got size {}."
+                               .format(idx, inp.size(), tangents.size()))
+
+    # The outputs do not depend on the tangents so they are not batched, they
+    # are stored here instead of being expanded by vmap.
+    func_outputs = []
+
+    def push_forward(*tangents):
+        with fwAD.dual_level():
+            duals = tuple(fwAD.make_dual(inp.detach(), tangent) for inp, tangent in zip(inputs, tangents))
+            outputs = func(*duals)
+            is_outputs_tuple, outputs = _as_tuple(outputs, "outputs of the user-provided function", "batched_jvp")
+            primals = []
+            jvps = []
+            for i, out in enumerate(outputs):
+                primal, jvp = fwAD.unpack_dual(out)
+                if jvp is None:
+                    if strict:
+                        raise RuntimeError("The output of the user-provided function with index {} is "
+                                           "independent of the inputs. This is not allowed in strict mode.".format(i))
+                    jvp = torch.zeros_like(primal)
+                primals.append(primal.detach())
+                jvps.append(jvp)
+        func_outputs.append((is_outputs_tuple, tuple(primals)))
+        return tuple(jvps)
+
+    jvps = _vmap(push_forward)(*v)
+    is_outputs_tuple, outputs = func_outputs[0]
+
+    return _tuple_postprocess(outputs, is_outputs_tuple), _tuple_postprocess(jvps, is_outputs_tuple)
+
+
 def _construct_standard_basis_for(tensors: Tuple[torch.Tensor, ...], tensor_numels: Tuple[int, ...]) -> Tuple[torch.Tensor, ...]:
     # This function:
     # - constructs a N=sum(tensor_numels) standard basis. i.e. an NxN identity matrix.
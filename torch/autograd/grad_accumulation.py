@@ -0,0 +1,40 @@
+import torch
+
+from typing import Any
+
+
+class grouped_grad_accumulation(object):
+    r"""Context-manager under which gradients are accumulated into the
+    ``.grad`` of CUDA leaf tensors with a few multi-tensor kernels.
+
+    By default, every leaf tensor that already has a ``.grad`` gets its new
+    gradient added to it with its own kernel, so models with many small
+    parameters end their backward pass with many tiny kernel launches. Under
+    this context-manager these additions are deferred to the end of the
+    backward call and done with one :func:`torch._foreach_add_` per stream,
+    device and dtype.
+
+    Leaf tensors with post hooks on their gradient accumulator, e.g. the
+    parameters of :class:`~torch.nn.parallel.DistributedDataParallel`, are
+    updated right away as before. Hooks that read ``.grad`` of other tensors
+    during the backward pass see them before the accumulation.
+
+    Args:
+        enabled (bool): whether to enable it. Default: ``True``
+
+    Example::
+
+        >>> with torch.autograd.grouped_grad_accumulation():
+        ...     for inp in micro_batches:
+        ...         model(inp).sum().backward()
+    """
+
+    def __init__(self, enabled: bool = True) -> None:
+        self.enabled = enabled
+
+    def __enter__(self) -> None:
+        self.prev = torch._C._is_grouped_grad_accumulation_enabled()
+        torch._C._set_grouped_grad_accumulation(self.enabled)
+
+    def __exit__(self, *args: Any) -> None:
+        torch._C._set_grouped_grad_accumulation(self.prev)
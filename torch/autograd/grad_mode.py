@@ -5,7 +5,7 @@ import inspect
 from typing import Any, Callable, TypeVar, cast
 
 
-__all__ = ['no_grad', 'enable_grad', 'set_grad_enabled']
+__all__ = ['no_grad', 'enable_grad', 'set_grad_enabled', 'inference_mode']
 
 
 # Used for annotating the decorator usage of 'no_grad' and 'enable_grad'.
@@ -23,7 +23,7 @@ class _DecoratorContextManager:
 
         @functools.wraps(func)
         def decorate_context(*args, **kwargs):
-            with self.__class__():
+            with self.clone():
                 return func(*args, **kwargs)
         return cast(F, decorate_context)
 
@@ -37,10 +37,9 @@ class _DecoratorContextManager:
             # make sure the grad mode is properly set every time the execution
             # flow returns into the wrapped generator and restored when it
             # returns through our `yield` to our caller (see PR #49017).
-            cls = type(self)
             try:
                 # Issuing `None` to a generator fires it up
-                with cls():
+                with self.clone():
                     response = gen.send(None)
 
                 while True:
@@ -50,18 +49,18 @@ class _DecoratorContextManager:
 
                     except GeneratorExit:
                         # Inform the still active generator about its imminent closure
-                        with cls():
+                        with self.clone():
                             gen.close()
                         raise
 
                     except BaseException:
                         # Propagate the exception thrown at us by the caller
-                        with cls():
+                        with self.clone():
                             response = gen.throw(*sys.exc_info())
 
                     else:
                         # Pass the last request to the generator and get its response
-                        with cls():
+                        with self.clone():
                             response = gen.send(request)
 
             # We let the exceptions raised above by the generator's `.throw` or
@@ -77,6 +76,10 @@ class _DecoratorContextManager:
     def __enter__(self) -> None:
         raise NotImplementedError
 
+    def clone(self):
+        # override this method if your children class takes __init__ parameters
+        return self.__class__()
+
     def __exit__(self, exc_type: Any, exc_value: Any, traceback: Any) -> None:
         raise NotImplementedError
 
@@ -206,3 +209,62 @@ class set_grad_enabled(object):
 
     def __exit__(self, exc_type: Any, exc_value: Any, traceback: Any) -> None:
         torch._C._set_grad_enabled(self.prev)
+
+
+class inference_mode(_DecoratorContextManager):
+    r"""Context-manager that enables or disables inference mode
+
+    InferenceMode is a new context manager analogous to :class:`~no_grad`
+    to be used when you are certain your operations will have no interactions
+    with autograd (e.g., model serving). Code run under this mode gets better
+    performance by disabling view tracking and version counter bumps, and ops
+    on tensors created in this mode (inference tensors) go straight to their
+    kernels without passing through the autograd dispatch keys.
+
+    Inference tensors cannot be modified in-place outside InferenceMode and
+    cannot be saved for backward by ops recorded outside of it.
+
+    This context manager is thread local; it will not affect computation
+    in other threads.
+
+    Also functions as a decorator. (Make sure to instantiate with parenthesis.)
+
+    Args:
+        mode (bool): Flag whether to enable or disable inference mode
+
+    Example::
+
+        >>> import torch
+        >>> x = torch.ones(1, 2, 3, requires_grad=True)
+        >>> with torch.inference_mode():
+        ...   y = x * x
+        >>> y.requires_grad
+        False
+        >>> y._version
+        Traceback (most recent call last):
+        ...
+        RuntimeError: Inference tensor do not track version counter.
+        >>> @torch.inference_mode()
+        ... def func(x):
+        ...   return x * x
+        >>> out = func(x)
+        >>> out.requires_grad
+        False
+
+    """
+    def __init__(self, mode=True):
+        if not torch._jit_internal.is_scripting():
+            super().__init__()
+        # Holds a python binding to a RAII guard that can enable or disable
+        # inference mode
+        self._inference_mode_raii_guard = None
+        self.mode = mode
+
+    def __enter__(self):
+        self._inference_mode_raii_guard = torch._C._InferenceMode(self.mode)
+
+    def __exit__(self, exc_type: Any, exc_value: Any, traceback: Any) -> None:
+        del self._inference_mode_raii_guard
+
+    def clone(self):
+        return self.__class__(self.mode)
@@ -0,0 +1,42 @@
+import torch
+
+from typing import Any
+
+
+class parallel_cpu_backward(object):
+    r"""Context-manager under which the backward passes run on CPU worker
+    threads, so that independent branches of the graph run concurrently.
+
+    By default the thread that calls :func:`backward` or :func:`grad` runs
+    all the CPU nodes of the graph one at a time. Under this context-manager
+    they run on :attr:`num_threads` worker threads of the autograd engine,
+    each node as soon as all the gradients flowing into it are computed. This
+    helps graphs with several branches of small ops, e.g. multi-tower models,
+    which do not keep the intra-op thread pool busy on their own.
+
+    Only the backward pass needs to run under the context-manager. The worker
+    threads are started on first use and kept afterwards. Reentrant backward
+    calls, e.g. of :mod:`torch.utils.checkpoint`, still run on the thread that
+    makes them.
+
+    Args:
+        num_threads (int): number of worker threads, 0 runs the backward pass
+            on the calling thread.
+
+    Example::
+
+        >>> with torch.autograd.parallel_cpu_backward(4):
+        ...     loss.backward()
+    """
+
+    def __init__(self, num_threads: int) -> None:
+        if num_threads < 0:
+            raise ValueError("num_threads must be non-negative, got {}".format(num_threads))
+        self.num_threads = num_threads
+
+    def __enter__(self) -> None:
+        self.prev = torch._C._autograd_cpu_worker_threads()
+        torch._C._set_autograd_cpu_worker_threads(self.num_threads)
+
+    def __exit__(self, *args: Any) -> None:
+        torch._C._set_autograd_cpu_worker_threads(self.prev)
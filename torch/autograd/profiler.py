@@ -634,6 +634,77 @@ class record_function(ContextDecorator):
         return profiled_future
 
 
+class memory_timeline(object):
+    """Context manager that records a timeline of the CPU and CUDA memory
+    allocated and freed by the code it wraps, and attributes it to the scopes
+    it was allocated in.
+
+    A scope is the stack of operators and :class:`record_function` labels
+    that were running when memory was allocated, joined with ``/``, e.g.
+    ``forward/aten::linear/aten::addmm``. Labelling the blocks of a model,
+    e.g. the ``forward`` of each module, with :class:`record_function` makes
+    the memory they hold show up under their label.
+
+    After exiting, the following are available:
+
+    - ``events``: every allocation (positive ``bytes``) and free (negative
+      ``bytes``), with the time in nanoseconds since entering, the device,
+      the scope it happened in and, for frees, the scope of the allocation.
+    - ``peaks``: for each device, the peak of the memory allocated since
+      entering, when it happened, and ``holders``: the bytes alive at the
+      peak by the scope that allocated them, largest first. This is what
+      activation checkpointing or a smaller batch would save.
+    - ``transients``: by scope and device, the buffers that were allocated
+      and freed while the scope was running, largest total first, e.g. the
+      workspace of an operator or an intermediate result within a label.
+      Each buffer counts in the innermost such scope. They do not outlive
+      their scope but add to its peak.
+
+    Peaks are relative to the memory allocated when entering. Cannot be used
+    together with :class:`profile`.
+
+    Example:
+        >>> with torch.autograd.profiler.memory_timeline() as timeline:
+        ...     with torch.autograd.profiler.record_function("forward"):
+        ...         loss = model(x).sum()
+        ...     loss.backward()
+        >>> print(timeline.table())
+    """
+    def __init__(self):
+        self.events: List[Any] = []
+        self.peaks: List[Any] = []
+        self.transients: List[Any] = []
+
+    def __enter__(self):
+        torch._C._autograd._enable_memory_timeline()
+        return self
+
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        result = torch._C._autograd._disable_memory_timeline()
+        self.events = result.events
+        self.peaks = result.peaks
+        self.transients = result.transients
+        return False
+
+    def table(self, row_limit=10):
+        """Returns a summary of the peaks and transient buffers as a string,
+        with at most ``row_limit`` scopes per peak and transient buffers.
+        """
+        lines = []
+        for peak in self.peaks:
+            lines.append("Peak {} memory: {} at {:.3f}ms".format(
+                peak.device, format_memory(peak.bytes), peak.time_ns / 1e6))
+            for scope, nbytes in peak.holders[:row_limit]:
+                lines.append("  {:>12}  {}".format(format_memory(nbytes), scope or "<no scope>"))
+        if self.transients:
+            lines.append("Transient buffers:")
+            for transient in self.transients[:row_limit]:
+                lines.append("  {:>12}  {} ({} allocations on {})".format(
+                    format_memory(transient.bytes), transient.scope,
+                    transient.count, transient.device))
+        return "\n".join(lines)
+
+
 class emit_nvtx(object):
     """Context manager that makes every autograd operation emit an NVTX range.
 
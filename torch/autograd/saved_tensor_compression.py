@@ -0,0 +1,53 @@
+import torch
+
+from typing import Any, Optional
+
+
+class compress_saved_tensors(object):
+    r"""Context-manager under which tensors saved for backward are stored in a
+    compressed form, as an alternative to offloading them with
+    :class:`offload_saved_tensors`.
+
+    Non-leaf floating point tensors of at least :attr:`min_bytes` bytes that
+    the forward pass saves for the backward are packed when they are saved and
+    unpacked when the backward uses them, both in C++ kernels:
+
+    - with ``dtype=torch.bfloat16``, they are downcast to bfloat16.
+    - with ``dtype=torch.int8``, they are rounded to int8 with one scale per
+      channel (per slice of dimension 1).
+    - with :attr:`relu_mask`, the outputs ReLU saves for its own backward are
+      stored exactly as bool masks, since only their sign is needed.
+
+    Downcasting and rounding are lossy, so the gradients are approximate.
+    Only the forward pass needs to run under the context-manager.
+
+    Args:
+        dtype (torch.dtype, optional): ``torch.bfloat16``, ``torch.int8`` or
+            ``None`` to not change the type of saved tensors. Default: ``torch.bfloat16``
+        relu_mask (bool): store the outputs saved by ReLU as masks. Default: ``True``
+        min_bytes (int): size in bytes from which saved tensors are packed.
+            Default: 1 MiB
+
+    Example::
+
+        >>> model = torch.nn.Sequential(torch.nn.Linear(1024, 1024), torch.nn.ReLU())
+        >>> with torch.autograd.compress_saved_tensors(dtype=torch.int8):
+        ...     out = model(torch.randn(4096, 1024))
+        >>> out.sum().backward()
+    """
+
+    def __init__(self, dtype: Optional[torch.dtype] = torch.bfloat16, relu_mask: bool = True,
+                 min_bytes: int = 1 << 20) -> None:
+        if dtype not in (torch.bfloat16, torch.int8, None):
+            raise ValueError("dtype must be torch.bfloat16, torch.int8 or None, got {}".format(dtype))
+        if min_bytes < 0:
+            raise ValueError("min_bytes must be non-negative, got {}".format(min_bytes))
+        name = None if dtype is None else ('bfloat16' if dtype == torch.bfloat16 else 'int8')
+        self.packer = torch._C._autograd._make_saved_tensor_packer(name, relu_mask, min_bytes)
+
+    def __enter__(self) -> None:
+        self.prev = torch._C._autograd._get_saved_tensor_packer()
+        torch._C._autograd._set_saved_tensor_packer(self.packer)
+
+    def __exit__(self, *args: Any) -> None:
+        torch._C._autograd._set_saved_tensor_packer(self.prev)
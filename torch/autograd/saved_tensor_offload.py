@@ -0,0 +1,43 @@
+import torch
+
+from typing import Any
+
+
+class offload_saved_tensors(object):
+    r"""Context-manager under which large tensors saved for backward are kept
+    in pinned host memory instead of on the GPU.
+
+    Non-leaf CUDA tensors of at least :attr:`min_bytes` bytes that the forward
+    pass saves for the backward are copied to pinned host memory on a side
+    stream, and their device memory is released as soon as the forward pass
+    drops them. During the backward pass the autograd engine copies them back
+    one node ahead of their use, so that the copies overlap with the
+    computation. This trades host to device bandwidth for device memory, e.g.
+    to train with larger batches.
+
+    Only the forward pass needs to run under the context-manager; whether a
+    tensor is offloaded is decided when it is saved.
+
+    Args:
+        min_bytes (int): size in bytes from which saved tensors are offloaded.
+            Default: 1 MiB
+
+    Example::
+
+        >>> model = torch.nn.Sequential(torch.nn.Linear(1024, 1024), torch.nn.ReLU()).cuda()
+        >>> with torch.autograd.offload_saved_tensors():
+        ...     out = model(torch.randn(4096, 1024, device='cuda'))
+        >>> out.sum().backward()
+    """
+
+    def __init__(self, min_bytes: int = 1 << 20) -> None:
+        if min_bytes < 0:
+            raise ValueError("min_bytes must be non-negative, got {}".format(min_bytes))
+        self.min_bytes = min_bytes
+
+    def __enter__(self) -> None:
+        self.prev = torch._C._saved_tensor_offload_threshold()
+        torch._C._set_saved_tensor_offload_threshold(self.min_bytes)
+
+    def __exit__(self, *args: Any) -> None:
+        torch._C._set_saved_tensor_offload_threshold(self.prev)
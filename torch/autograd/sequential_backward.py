@@ -0,0 +1,39 @@
+import torch
+
+from typing import Any
+
+
+class sequential_cpu_backward(object):
+    r"""Context-manager under which the backward passes of CPU graphs skip the
+    scheduling of the autograd engine.
+
+    The autograd engine schedules every node of the graph through a ready
+    queue and looks up its inputs and dependencies in hash maps, which can
+    cost more than the nodes themselves for small models, e.g. RL policies.
+    Under this context-manager, :func:`backward` calls on graphs that are
+    entirely on CPU number the nodes once and run them on the calling thread,
+    in the same order the engine would, with their inputs and dependencies
+    kept in flat arrays.
+
+    Calls that pass ``inputs``, :func:`grad`, graphs with nodes on other
+    devices, anomaly detection and :class:`parallel_cpu_backward` use the
+    engine as usual.
+
+    Args:
+        enabled (bool): whether to enable it. Default: ``True``
+
+    Example::
+
+        >>> with torch.autograd.sequential_cpu_backward():
+        ...     loss.backward()
+    """
+
+    def __init__(self, enabled: bool = True) -> None:
+        self.enabled = enabled
+
+    def __enter__(self) -> None:
+        self.prev = torch._C._is_autograd_sequential_cpu_backward_enabled()
+        torch._C._set_autograd_sequential_cpu_backward(self.enabled)
+
+    def __exit__(self, *args: Any) -> None:
+        torch._C._set_autograd_sequential_cpu_backward(self.prev)
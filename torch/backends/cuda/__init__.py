@@ -29,8 +29,8 @@ class cuFFTPlanCacheAttrContextProp(object):
 class cuFFTPlanCache(object):
     r"""
     Represents a specific plan cache for a specific `device_index`. The
-    attributes `size` and `max_size`, and method `clear`, can fetch and/ or
-    change properties of the C++ cuFFT plan cache.
+    attributes `size`, `max_size` and `batch_bucketing`, and method `clear`,
+    can fetch and/ or change properties of the C++ cuFFT plan cache.
     """
     def __init__(self, device_index):
         self.device_index = device_index
@@ -43,6 +43,9 @@ class cuFFTPlanCache(object):
     max_size = cuFFTPlanCacheAttrContextProp(torch._cufft_get_plan_cache_max_size,
                                              torch._cufft_set_plan_cache_max_size)
 
+    batch_bucketing = cuFFTPlanCacheAttrContextProp(torch._cufft_get_plan_cache_batch_bucketing,
+                                                    torch._cufft_set_plan_cache_batch_bucketing)
+
     def clear(self):
         return torch._cufft_clear_plan_cache(self.device_index)
 
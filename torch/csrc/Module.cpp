@@ -11,12 +11,14 @@
 #include <TH/TH.h>
 #include <c10/util/Logging.h>
 #include <ATen/ATen.h>
+#include <ATen/BatchedFallback.h>
 #include <ATen/ExpandUtils.h>
 #include <ATen/dlpack.h>
 #include <ATen/DLConvertor.h>
 #include <ATen/Parallel.h>
 #include <ATen/Utils.h>
 #include <ATen/VmapMode.h>
+#include <ATen/core/Vitals.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
@@ -647,6 +649,28 @@ static PyObject * THPModule_are_vmap_fallback_warnings_enabled(PyObject* _unused
   END_HANDLE_TH_ERRORS
 }
 
+static PyObject * THPModule_vmap_fallback_counts(PyObject* _unused, PyObject *noargs) {
+  HANDLE_TH_ERRORS
+  THPObjectPtr counts(PyDict_New());
+  if (!counts) throw python_error();
+  for (const auto& entry : at::getVmapFallbackCounts()) {
+    THPObjectPtr count(THPUtils_packInt64(entry.second));
+    if (!count) throw python_error();
+    if (PyDict_SetItemString(counts.get(), entry.first.c_str(), count.get()) < 0) {
+      throw python_error();
+    }
+  }
+  return counts.release();
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * THPModule_reset_vmap_fallback_counts(PyObject* _unused, PyObject *noargs) {
+  HANDLE_TH_ERRORS
+  at::resetVmapFallbackCounts();
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
 //NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays, modernize-avoid-c-arrays)
 static PyMethodDef TorchMethods[] = {
   {"_initExtension",  THPModule_initExtension,   METH_O,       nullptr},
@@ -691,6 +715,8 @@ static PyMethodDef TorchMethods[] = {
   {"_vmapmode_decrement_nesting", THPModule_vmapmode_decrement_nesting, METH_NOARGS, nullptr},
   {"_debug_only_display_vmap_fallback_warnings", THPModule_set_display_vmap_fallback_warnings_mode, METH_O, nullptr},
   {"_debug_only_are_vmap_fallback_warnings_enabled", THPModule_are_vmap_fallback_warnings_enabled, METH_NOARGS, nullptr},
+  {"_debug_only_vmap_fallback_counts", THPModule_vmap_fallback_counts, METH_NOARGS, nullptr},
+  {"_debug_only_reset_vmap_fallback_counts", THPModule_reset_vmap_fallback_counts, METH_NOARGS, nullptr},
   {"_to_dlpack",      THPModule_toDLPack,          METH_O,       nullptr},
   {"_from_dlpack",    THPModule_fromDLPack,        METH_O,       nullptr},
   {"set_flush_denormal", THPModule_setFlushDenormal, METH_O,     nullptr},
@@ -934,6 +960,35 @@ PyObject* initModule() {
   py_module.def("_demangle", &c10::demangle);
   py_module.def("_log_api_usage_once", &LogAPIUsageOnceFromPython);
 
+  // See Note [Vital counters]
+  py_module.def("_vital_counters_enabled", &at::vitals::vitalCountersEnabled);
+  py_module.def(
+      "_set_vital_counters_enabled", &at::vitals::setVitalCountersEnabled);
+  py_module.def("_reset_vital_counters", &at::vitals::resetVitalCounters);
+  py_module.def("_vital_counters", []() {
+    py::dict result;
+    for (const auto& entry : at::vitals::vitalCounterValues()) {
+      result[py::str(entry.first)] = entry.second;
+    }
+    return result;
+  });
+  py_module.def("_vital_histograms", []() {
+    py::dict result;
+    for (const auto& entry : at::vitals::vitalHistogramValues()) {
+      py::dict histogram;
+      histogram["count"] = entry.second.count;
+      histogram["sum"] = entry.second.sum;
+      histogram["buckets"] = entry.second.buckets;
+      result[py::str(entry.first)] = histogram;
+    }
+    return result;
+  });
+  py_module.def("_vital_record", [](const std::string& name, int64_t value) {
+    if (at::vitals::vitalCountersEnabled()) {
+      at::vitals::vitalHistogram(name).record(value);
+    }
+  });
+
   py_module.def(
     "init_num_threads",
     torch::wrap_pybind_function(at::init_num_threads),
@@ -2,7 +2,10 @@
 
 #include <torch/data/dataloader_options.h>
 #include <torch/data/detail/data_shuttle.h>
+#include <torch/data/detail/map_tensors.h>
+#include <torch/data/detail/pinned_memory_pool.h>
 #include <torch/data/detail/sequencers.h>
+#include <torch/data/detail/worker_process.h>
 #include <torch/data/iterator.h>
 #include <torch/data/samplers/random.h>
 #include <torch/data/worker_exception.h>
@@ -11,9 +14,14 @@
 #include <torch/csrc/utils/memory.h>
 #include <torch/csrc/utils/variadic.h>
 
+#include <c10/core/Event.h>
+#include <c10/core/Stream.h>
+#include <c10/core/StreamGuard.h>
+#include <c10/core/impl/VirtualGuardImpl.h>
 #include <c10/util/Exception.h>
 
 #include <cstddef>
+#include <deque>
 #include <exception>
 #include <memory>
 #include <thread>
@@ -37,6 +45,9 @@ class DataLoaderBase {
       std::unique_ptr<Dataset> main_thread_dataset = nullptr)
       : options_(std::move(options)),
         main_thread_dataset_(std::move(main_thread_dataset)),
+        // At most max_jobs jobs are in flight, and one quit message per
+        // worker once the jobs are drained.
+        shuttle_(options_.max_jobs + options_.workers),
         sequencer_(new_sequencer()) {}
 
   virtual ~DataLoaderBase() {
@@ -88,6 +99,7 @@ class DataLoaderBase {
     for (auto& worker : workers_) {
       worker.join();
     }
+    worker_processes_.clear();
     joined_ = true;
   }
 
@@ -136,6 +148,7 @@ class DataLoaderBase {
   /// Resets the internal state of the DataLoader, optionally pre-fetching
   /// new jobs.
   virtual void reset() {
+    device_batches_.clear();
     shuttle_.drain();
     sequence_number_ = 0;
     sequencer_ = new_sequencer();
@@ -163,6 +176,41 @@ class DataLoaderBase {
   /// is exhausted. This operation will block until a batch is available if one
   /// is still expected.
   optional<BatchType> next() {
+    if (!options_.device) {
+      return next_host();
+    }
+    while (device_batches_.size() <= options_.device_prefetch) {
+      auto batch = next_host();
+      if (!batch) {
+        break;
+      }
+      device_batches_.push_back(to_device(std::move(*batch)));
+    }
+    if (device_batches_.empty()) {
+      return nullopt;
+    }
+    auto device_batch = std::move(device_batches_.front());
+    device_batches_.pop_front();
+    // Hand the batch over to the current stream, which must not run ahead of
+    // the copies, and which the caching allocator must wait for before it
+    // reuses the memory of the batch, allocated on the copy stream.
+    const auto device = copy_stream_->device();
+    const c10::impl::VirtualGuardImpl impl{device.type()};
+    const auto current = impl.getStream(device);
+    device_batch.event->block(current);
+    auto record_stream = [&](const Tensor& tensor) {
+      if (tensor.defined() && tensor.device() == device &&
+          tensor.has_storage()) {
+        impl.recordDataPtrOnStream(tensor.storage().data_ptr(), current);
+      }
+      return tensor;
+    };
+    return detail::map_tensors(std::move(device_batch.batch), record_stream);
+  }
+
+  /// Returns the next batch of data in host memory, or an empty `optional` if
+  /// the DataLoader is exhausted.
+  optional<BatchType> next_host() {
     if (options_.workers > 0) {
       while (optional<Result> result = this->pop_result()) {
         if (result->exception) {
@@ -173,20 +221,71 @@ class DataLoaderBase {
         }
       }
     } else if (auto batch_request = get_batch_request()) {
-      return this->main_thread_dataset_->get_batch(std::move(*batch_request));
+      return pin(
+          this->main_thread_dataset_->get_batch(std::move(*batch_request)));
     }
     return nullopt;
   }
 
-  /// The function that worker threads run.
-  void worker_thread(Dataset& dataset) {
+  /// Copies the tensors of `batch` to page-locked memory if the `pin_memory`
+  /// option is set.
+  template <typename T>
+  T pin(T batch) {
+    if (!options_.pin_memory) {
+      return batch;
+    }
+    auto pin_tensor = [this](const Tensor& tensor) {
+      return pinned_memory_pool_.pin(tensor);
+    };
+    return detail::map_tensors(std::move(batch), pin_tensor);
+  }
+
+  /// A batch being copied to the device, and the event recorded on the copy
+  /// stream after its copies.
+  struct DeviceBatch {
+    BatchType batch;
+    std::shared_ptr<c10::Event> event;
+  };
+
+  /// Enqueues the copies of the tensors of `batch` to the `device` option on
+  /// the copy stream.
+  DeviceBatch to_device(BatchType batch) {
+    const auto& device = *options_.device;
+    const c10::impl::VirtualGuardImpl impl{device.type()};
+    if (!copy_stream_) {
+      copy_stream_ = impl.getStreamFromGlobalPool(device);
+    }
+    std::vector<Tensor> host_tensors;
+    auto copy = [&](const Tensor& tensor) {
+      if (!tensor.defined()) {
+        return tensor;
+      }
+      host_tensors.push_back(tensor);
+      return tensor.to(copy_stream_->device(), /*non_blocking=*/true);
+    };
+    c10::OptionalStreamGuard guard{*copy_stream_};
+    auto device_batch = detail::map_tensors(std::move(batch), copy);
+    guard.reset();
+    auto event = std::make_shared<c10::Event>(device.type());
+    event->record(*copy_stream_);
+    // The page-locked buffers can only be reused once the copies are done.
+    for (const auto& tensor : host_tensors) {
+      pinned_memory_pool_.record_event(tensor, event);
+    }
+    return {std::move(device_batch), std::move(event)};
+  }
+
+  /// The function that worker threads run, with the dataset of the worker, or
+  /// the worker process that loads its batches.
+  template <typename Source>
+  void worker_thread(Source& source) {
     while (true) {
       auto job = shuttle_.pop_job();
       if (job.quit) {
         break;
       }
       try {
-        auto batch = dataset.get_batch(std::move(*job.batch_request));
+        auto batch = pin(source.get_batch(std::move(*job.batch_request)));
         shuttle_.push_result({std::move(batch), job.sequence_number});
       } catch (...) {
         shuttle_.push_result({std::current_exception(), job.sequence_number});
@@ -233,6 +332,10 @@ class DataLoaderBase {
   /// The worker threads, running the `worker_thread()` method.
   std::vector<std::thread> workers_;
 
+  /// The worker processes the worker threads hand their jobs to, if any.
+  std::vector<std::unique_ptr<detail::WorkerProcess<Batch, BatchRequest>>>
+      worker_processes_;
+
   /// The `DataShuttle` which takes care of the life cycle of a job.
   detail::DataShuttle<Job, Result> shuttle_;
 
@@ -241,6 +344,16 @@ class DataLoaderBase {
 
   /// True if the DataLoader has joined its worker threads.
   bool joined_ = false;
+
+  /// The page-locked buffers batches are copied into with the `pin_memory`
+  /// option.
+  detail::PinnedMemoryPool pinned_memory_pool_;
+
+  /// The stream the batches are copied to the `device` option on.
+  optional<c10::Stream> copy_stream_;
+
+  /// The batches whose copy to the `device` option was started, in order.
+  std::deque<DeviceBatch> device_batches_;
 };
 } // namespace data
 } // namespace torch
@@ -40,13 +40,17 @@ class StatelessDataLoader : public DataLoaderBase<
       Sampler sampler,
       DataLoaderOptions options)
       : super(std::move(options)), sampler_(std::move(sampler)) {
-    for (size_t w = 0; w < this->options_.workers; ++w) {
-      // Here we copy the dataset into the worker thread closure. Each worker
-      // has its own copy of the dataset. This means the dataset must be
-      // trivially copiable, or else we don't expect more than one worker to
-      // be in use.
-      this->workers_.emplace_back(
-          [this, dataset]() mutable { this->worker_thread(dataset); });
+    if (this->options_.worker_processes) {
+      start_worker_processes(dataset);
+    } else {
+      for (size_t w = 0; w < this->options_.workers; ++w) {
+        // Here we copy the dataset into the worker thread closure. Each worker
+        // has its own copy of the dataset. This means the dataset must be
+        // trivially copiable, or else we don't expect more than one worker to
+        // be in use.
+        this->workers_.emplace_back(
+            [this, dataset]() mutable { this->worker_thread(dataset); });
+      }
     }
     if (this->options_.workers == 0) {
       this->main_thread_dataset_ =
@@ -62,6 +66,27 @@ class StatelessDataLoader : public DataLoaderBase<
     super::reset();
   }
 
+  /// Forks one process per worker, with its own copy of `dataset`, and starts
+  /// the worker threads that hand their jobs to the processes. See
+  /// Note [DataLoader worker processes].
+  void start_worker_processes(const Dataset& dataset) {
+    using WorkerProcess =
+        detail::WorkerProcess<typename super::BatchType, BatchRequestType>;
+    for (size_t w = 0; w < this->options_.workers; ++w) {
+      this->worker_processes_.push_back(torch::make_unique<WorkerProcess>(
+          [dataset](BatchRequestType request) mutable {
+            return dataset.get_batch(std::move(request));
+          }));
+    }
+    // The threads are only started once all processes are forked, so that no
+    // process is forked while they run.
+    for (auto& process : this->worker_processes_) {
+      auto* worker_process = process.get();
+      this->workers_.emplace_back(
+          [this, worker_process] { this->worker_thread(*worker_process); });
+    }
+  }
+
   /// Queries the sampler for the next batch request (possibly progressing its
   /// internal state).
   optional<BatchRequestType> get_batch_request() override {
@@ -22,6 +22,14 @@ struct DataLoaderOptions {
   /// synchronously perform the data loading.
   TORCH_ARG(size_t, workers) = 0;
 
+  /// Whether each worker thread hands its jobs to a process of its own, forked
+  /// from the one of the DataLoader when the DataLoader is constructed and
+  /// holding its own copy of the dataset, instead of loading them itself. The
+  /// tensors of the batches are sent back in shared memory, without a copy in
+  /// the process of the DataLoader, and must be CPU tensors. Only supported for
+  /// stateless datasets, and not on Windows.
+  TORCH_ARG(bool, worker_processes) = false;
+
   /// The maximum number of jobs to enqueue for fetching by worker threads.
   /// Defaults to two times the number of worker threads.
   TORCH_ARG(optional<size_t>, max_jobs);
@@ -37,6 +45,21 @@ struct DataLoaderOptions {
   /// Whether to omit the last batch if it contains less than `batch_size`
   /// examples.
   TORCH_ARG(bool, drop_last) = false;
+
+  /// Whether to copy the tensors of each batch into page-locked host memory,
+  /// taken from a pool the DataLoader reuses across batches, in the thread
+  /// that loads the batch. Copies from page-locked memory to a CUDA device can
+  /// run asynchronously.
+  TORCH_ARG(bool, pin_memory) = false;
+
+  /// If set, the tensors of each batch are copied to this device on a side
+  /// stream, ahead of the batch being returned. The current stream of the
+  /// device waits for the copies when the batch is returned.
+  TORCH_ARG(optional<Device>, device);
+
+  /// The number of batches whose copy to `device` is started ahead of the one
+  /// being returned.
+  TORCH_ARG(size_t, device_prefetch) = 2;
 };
 
 /// Like `DataLoaderOptions`, but without any unconfigured state.
@@ -49,17 +72,25 @@ struct FullDataLoaderOptions {
   explicit FullDataLoaderOptions(DataLoaderOptions options)
       : batch_size(options.batch_size()),
         workers(options.workers()),
+        worker_processes(options.worker_processes()),
         max_jobs(options.max_jobs().value_or(2 * workers)),
         timeout(options.timeout()),
         enforce_ordering(options.enforce_ordering()),
-        drop_last(options.drop_last()) {}
+        drop_last(options.drop_last()),
+        pin_memory(options.pin_memory()),
+        device(options.device()),
+        device_prefetch(options.device_prefetch()) {}
 
   size_t batch_size;
   size_t workers;
+  bool worker_processes;
   size_t max_jobs;
   optional<std::chrono::milliseconds> timeout;
   bool enforce_ordering;
   bool drop_last;
+  bool pin_memory;
+  optional<Device> device;
+  size_t device_prefetch;
 };
 } // namespace data
 } // namespace torch
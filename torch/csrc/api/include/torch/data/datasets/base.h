@@ -30,6 +30,29 @@ template <typename T>
 struct is_optional : std::false_type {};
 template <typename T>
 struct is_optional<optional<T>> : std::true_type {};
+
+/// Writes `value` into `slot`, into the memory of its tensors for tensors.
+inline void copy_into(Tensor& slot, const Tensor& value) {
+  slot.copy_(value);
+}
+
+template <typename T>
+void copy_into(T& slot, T value) {
+  slot = std::move(value);
+}
+
+template <typename Data, typename Target>
+void copy_into(Example<Data, Target>& slot, Example<Data, Target> value) {
+  copy_into(slot.data, std::move(value.data));
+  copy_into(slot.target, std::move(value.target));
+}
+
+template <typename Data>
+void copy_into(
+    Example<Data, example::NoTarget>& slot,
+    Example<Data, example::NoTarget> value) {
+  copy_into(slot.data, std::move(value.data));
+}
 } // namespace detail
 
 /// A dataset that can yield data only in batches.
@@ -80,6 +103,15 @@ class Dataset : public BatchDataset<Self, std::vector<SingleExample>> {
   /// Returns the example at the given index.
   virtual ExampleType get(size_t index) = 0;
 
+  /// Writes the example at the given index into `slot`, whose tensors are
+  /// preallocated with the sizes and types of those of the example. This is
+  /// how `transforms::StackInto` fills its batch tensors, `slot` then holding
+  /// views of the rows of the batch. The default implementation copies the
+  /// result of `get()`, override it to load the example straight into `slot`.
+  virtual void get_into(size_t index, ExampleType& slot) {
+    detail::copy_into(slot, get(index));
+  }
+
   /// Returns a batch of data.
   /// The default implementation calls `get()` for every requested index
   /// in the batch.
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <torch/data/datasets/chunk.h>
+#include <torch/data/example.h>
+#include <torch/types.h>
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace datasets {
+
+/// A fixed-width column of a `ColumnarChunkReader`: a file holding the rows of
+/// the column back to back, each a contiguous tensor with the given shape and
+/// type, in native byte order and without any header, as written by
+/// `ColumnarChunkReader::write_column`.
+struct TORCH_API ColumnFile {
+  ColumnFile(std::string path, Dtype dtype, std::vector<int64_t> row_shape = {})
+      : path(std::move(path)), dtype(dtype), row_shape(std::move(row_shape)) {}
+
+  std::string path;
+  Dtype dtype;
+  std::vector<int64_t> row_shape;
+};
+
+/// A `ChunkDataReader` over a data and a target column that are memory mapped
+/// rather than read.
+///
+/// The rows are split into chunks of `chunk_size` rows, and each example of a
+/// chunk is a view of a row of the mapped columns, so that reading a chunk
+/// copies nothing and the only copy of the data is the one collating the
+/// examples into a batch. When a chunk is read, the kernel is asked to read
+/// its pages ahead, in the background, while the chunk waits in the cache of
+/// the `ChunkDataset` behind the chunks loaded before it. The kernel's own
+/// readahead around page faults is turned off, since chunks are usually
+/// sampled in random order.
+class TORCH_API ColumnarChunkReader : public ChunkDataReader<Example<>> {
+ public:
+  using BatchType = ChunkDataReader<Example<>>::ChunkType;
+
+  ColumnarChunkReader(ColumnFile data, ColumnFile target, size_t chunk_size);
+
+  /// Returns the examples of the chunk, as views of the mapped columns.
+  BatchType read_chunk(size_t chunk_index) override;
+
+  /// Returns the number of chunks, the last of which may be partial.
+  size_t chunk_count() override;
+
+  /// The reader holds no state across epochs.
+  void reset() override;
+
+  /// Returns the number of rows of the columns.
+  size_t size() const;
+
+  /// Writes the rows of `rows`, its first dimension, to a column file at
+  /// `path`.
+  static void write_column(const std::string& path, const Tensor& rows);
+
+ private:
+  Tensor data_, target_;
+  size_t chunk_size_;
+};
+} // namespace datasets
+} // namespace data
+} // namespace torch
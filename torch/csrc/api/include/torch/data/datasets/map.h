@@ -4,6 +4,7 @@
 #include <torch/types.h>
 
 #include <c10/util/ArrayRef.h>
+#include <c10/util/C++17.h>
 
 #include <cstddef>
 #include <type_traits>
@@ -15,6 +16,23 @@ namespace datasets {
 namespace detail {
 template <bool C, typename T>
 using optional_if_t = typename std::conditional<C, torch::optional<T>, T>::type;
+
+/// Whether `Transform` builds batches from the dataset and the batch request
+/// itself, like `transforms::StackInto`.
+template <
+    typename Transform,
+    typename Dataset,
+    typename BatchRequest,
+    typename = void>
+struct collates_from_dataset : std::false_type {};
+template <typename Transform, typename Dataset, typename BatchRequest>
+struct collates_from_dataset<
+    Transform,
+    Dataset,
+    BatchRequest,
+    c10::guts::void_t<decltype(std::declval<Transform&>().apply_batch_from(
+        std::declval<Dataset&>(),
+        std::declval<BatchRequest>()))>> : std::true_type {};
 } // namespace detail
 
 /// A `MapDataset` is a dataset that applies a transform to a source dataset.
@@ -70,11 +88,26 @@ class MapDataset : public BatchDataset<
   /// applies the transform to the output of `get_batch()` from the dataset.
   template <
       typename D = SourceDataset,
-      typename = torch::disable_if_t<D::is_stateful>>
+      typename = torch::disable_if_t<
+          D::is_stateful ||
+          detail::collates_from_dataset<AppliedTransform, D, BatchRequestType>::
+              value>>
   OutputBatchType get_batch_impl(BatchRequestType indices) {
     return transform_.apply_batch(dataset_.get_batch(std::move(indices)));
   }
 
+  /// The implementation of `get_batch()` for a transform that builds the batch
+  /// from the dataset itself, such as `transforms::StackInto`.
+  template <typename D = SourceDataset>
+  torch::enable_if_t<
+      !D::is_stateful &&
+          detail::collates_from_dataset<AppliedTransform, D, BatchRequestType>::
+              value,
+      OutputBatchType>
+  get_batch_impl(BatchRequestType indices) {
+    return transform_.apply_batch_from(dataset_, std::move(indices));
+  }
+
   /// The implementation of `get_batch()` for the stateful case. Here, we follow
   /// the semantics of `Optional.map()` in many functional languages, which
   /// applies a transformation to the optional's content when the optional
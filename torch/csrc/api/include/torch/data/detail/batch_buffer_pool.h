@@ -0,0 +1,65 @@
+#pragma once
+
+#include <torch/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace detail {
+
+/// A pool of batch tensors that `transforms::StackInto` fills in place.
+///
+/// A tensor of the pool is handed out again once nothing but the pool refers
+/// to it or to its storage anymore, i.e. once the batch it held was dropped.
+/// The pool is shared by the copies of the transform in the worker threads of
+/// a `DataLoader`, and keeps at most `max_buffers` tensors, those of other
+/// sizes making room for new ones when it is full.
+class BatchBufferPool {
+ public:
+  explicit BatchBufferPool(size_t max_buffers) : max_buffers_(max_buffers) {}
+
+  /// Returns a tensor for a batch of `batch_size` examples with the sizes and
+  /// options of `example`.
+  Tensor get(const Tensor& example, size_t batch_size) {
+    std::vector<int64_t> sizes{static_cast<int64_t>(batch_size)};
+    sizes.insert(sizes.end(), example.sizes().begin(), example.sizes().end());
+    std::lock_guard<std::mutex> lock(mutex_);
+    Tensor* free_buffer = nullptr;
+    for (auto& buffer : buffers_) {
+      if (!is_free(buffer)) {
+        continue;
+      }
+      if (buffer.sizes() == sizes &&
+          buffer.scalar_type() == example.scalar_type() &&
+          buffer.device() == example.device()) {
+        // Copying the tensor marks it as used before the lock is released.
+        return buffer;
+      }
+      free_buffer = &buffer;
+    }
+    auto buffer = torch::empty(sizes, example.options());
+    if (buffers_.size() < max_buffers_) {
+      buffers_.push_back(buffer);
+    } else if (free_buffer != nullptr) {
+      *free_buffer = buffer;
+    }
+    return buffer;
+  }
+
+ private:
+  static bool is_free(const Tensor& buffer) {
+    return buffer.use_count() == 1 &&
+        buffer.unsafeGetTensorImpl()->storage().use_count() == 1;
+  }
+
+  const size_t max_buffers_;
+  std::mutex mutex_;
+  std::vector<Tensor> buffers_;
+};
+} // namespace detail
+} // namespace data
+} // namespace torch
@@ -25,6 +25,12 @@ namespace detail {
 template <typename Job, typename Result>
 class DataShuttle {
  public:
+  /// Creates a `DataShuttle` whose job and result queues hold `capacity`
+  /// elements. Pushing to a full queue blocks, so the capacity should be at
+  /// least the number of jobs in flight at once.
+  explicit DataShuttle(size_t capacity = Queue<Job>::kDefaultCapacity)
+      : new_jobs_(capacity), results_(capacity) {}
+
   /// Pushes a new job. Called by the main thread.
   void push_job(Job job) {
     new_jobs_.push(std::move(job));
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <torch/data/example.h>
+#include <torch/types.h>
+
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace detail {
+
+/// Returns `batch` with `function` applied to each of its tensors, which are
+/// found in `Example`s, `std::vector`s and `optional`s, nested to any depth.
+/// Values of any other type are left as they are.
+template <typename Function>
+Tensor map_tensors(const Tensor& tensor, Function& function);
+
+template <typename Data, typename Target, typename Function>
+Example<Data, Target> map_tensors(
+    Example<Data, Target> example,
+    Function& function);
+
+template <typename Data, typename Function>
+Example<Data, example::NoTarget> map_tensors(
+    Example<Data, example::NoTarget> example,
+    Function& function);
+
+template <typename T, typename Function>
+std::vector<T> map_tensors(std::vector<T> values, Function& function);
+
+template <typename T, typename Function>
+optional<T> map_tensors(optional<T> value, Function& function);
+
+template <typename T, typename Function>
+T map_tensors(T value, Function& function);
+
+template <typename Function>
+Tensor map_tensors(const Tensor& tensor, Function& function) {
+  return function(tensor);
+}
+
+template <typename Data, typename Target, typename Function>
+Example<Data, Target> map_tensors(
+    Example<Data, Target> example,
+    Function& function) {
+  return {
+      map_tensors(std::move(example.data), function),
+      map_tensors(std::move(example.target), function)};
+}
+
+template <typename Data, typename Function>
+Example<Data, example::NoTarget> map_tensors(
+    Example<Data, example::NoTarget> example,
+    Function& function) {
+  return {map_tensors(std::move(example.data), function)};
+}
+
+template <typename T, typename Function>
+std::vector<T> map_tensors(std::vector<T> values, Function& function) {
+  for (auto& value : values) {
+    value = map_tensors(std::move(value), function);
+  }
+  return values;
+}
+
+template <typename T, typename Function>
+optional<T> map_tensors(optional<T> value, Function& function) {
+  if (!value) {
+    return nullopt;
+  }
+  return map_tensors(std::move(*value), function);
+}
+
+template <typename T, typename Function>
+T map_tensors(T value, Function& /*function*/) {
+  return value;
+}
+} // namespace detail
+} // namespace data
+} // namespace torch
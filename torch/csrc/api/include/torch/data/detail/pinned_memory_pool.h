@@ -0,0 +1,50 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/types.h>
+
+#include <c10/core/Event.h>
+#include <c10/core/Storage.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace detail {
+
+/// A pool of page-locked host buffers that the `DataLoader` copies batches
+/// into, so that their copies to the device can be asynchronous.
+///
+/// A buffer goes back to the pool once no tensor refers to it anymore and the
+/// copies reading from it are done, which the event recorded after them
+/// tells. The pool grows to the number of batches in flight at once and is
+/// then reused from one batch to the next, so that the page-locked memory,
+/// which is expensive to allocate, is allocated only once.
+class TORCH_API PinnedMemoryPool {
+ public:
+  /// Returns a contiguous copy of `tensor` in a buffer of the pool. Tensors
+  /// that are not dense CPU tensors, or are pinned already, are returned as
+  /// they are. May be called from several threads at once.
+  Tensor pin(const Tensor& tensor);
+
+  /// Keeps the buffer of `tensor`, if it comes from the pool, from being
+  /// reused until `event` completes.
+  void record_event(const Tensor& tensor, std::shared_ptr<c10::Event> event);
+
+  /// The number of buffers allocated by the pool.
+  size_t size() const;
+
+ private:
+  struct Buffer {
+    c10::Storage storage;
+    std::shared_ptr<c10::Event> event;
+  };
+
+  mutable std::mutex mutex_;
+  std::vector<Buffer> buffers_;
+};
+} // namespace detail
+} // namespace data
+} // namespace torch
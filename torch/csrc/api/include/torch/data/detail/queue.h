@@ -4,21 +4,28 @@
 
 #include <c10/util/Exception.h>
 
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <mutex>
-#include <queue>
+#include <thread>
 
 namespace torch {
 namespace data {
 namespace detail {
 
-/// A basic locked, blocking MPMC queue.
+/// A bounded, blocking MPMC queue.
 ///
-/// Every `push` and `pop` is guarded by a mutex. A condition variable is used
-/// to communicate insertion of new elements, such that waiting threads will be
-/// woken up if they are currently waiting inside a call to `pop()`.
+/// The elements live in a ring buffer whose cells carry a sequence number,
+/// which tells producers whether a cell is free and consumers whether it is
+/// filled, so that `push` and `pop` only contend on an atomic position counter
+/// each and never take a lock while the queue is neither full nor empty. A
+/// thread that finds the queue full (in `push`) or empty (in `pop`) retries for
+/// a while, yielding in between, and then parks on a condition variable, which
+/// the other side only signals when a thread is parked.
 ///
 /// Note that this data structure is written specifically for use with the
 /// `DataLoader`. Its behavior is tailored to this use case and may not be
@@ -26,14 +33,46 @@ namespace detail {
 template <typename T>
 class Queue {
  public:
-  /// Pushes a new value to the back of the `Queue` and notifies one thread on
-  /// the waiting side about this event.
+  /// The capacity of a `Queue` that is not given one.
+  static constexpr size_t kDefaultCapacity = 1024;
+
+  /// Creates a `Queue` that holds at least `capacity` elements, which is
+  /// rounded up to a power of two, and to two at least: with a single cell,
+  /// the sequence number of the cell once filled would mark it as free for the
+  /// next push.
+  explicit Queue(size_t capacity = kDefaultCapacity) {
+    size_t size = 2;
+    while (size < capacity) {
+      size *= 2;
+    }
+    mask_ = size - 1;
+    cells_.reset(new Cell[size]);
+    for (size_t i = 0; i < size; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  Queue(const Queue&) = delete;
+  Queue& operator=(const Queue&) = delete;
+
+  /// Pushes a new value to the back of the `Queue` and wakes up one thread on
+  /// the waiting side, if any. Blocks while the `Queue` is full.
   void push(T value) {
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      queue_.push(std::move(value));
+    for (size_t spin = 0; !try_push(value); ++spin) {
+      if (spin < kSpinCount) {
+        std::this_thread::yield();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(mutex_);
+      waiting_pushers_.fetch_add(1);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      while (!try_push(value)) {
+        not_full_.wait(lock);
+      }
+      waiting_pushers_.fetch_sub(1);
+      break;
     }
-    cv_.notify_one();
+    notify(waiting_poppers_, not_empty_);
   }
 
   /// Blocks until at least one element is ready to be popped from the front of
@@ -41,23 +80,42 @@ class Queue {
   /// spent waiting for an element. If the wait times out, an exception is
   /// raised.
   T pop(optional<std::chrono::milliseconds> timeout = nullopt) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    if (timeout) {
-      if (!cv_.wait_for(
-              lock, *timeout, [this] { return !this->queue_.empty(); })) {
+    T value;
+    for (size_t spin = 0; !try_pop(value); ++spin) {
+      if (spin < kSpinCount) {
+        std::this_thread::yield();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(mutex_);
+      waiting_poppers_.fetch_add(1);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      bool timed_out = false;
+      if (timeout) {
+        const auto deadline = std::chrono::steady_clock::now() + *timeout;
+        while (!try_pop(value)) {
+          if (not_empty_.wait_until(lock, deadline) ==
+                  std::cv_status::timeout &&
+              !try_pop(value)) {
+            timed_out = true;
+            break;
+          }
+        }
+      } else {
+        while (!try_pop(value)) {
+          not_empty_.wait(lock);
+        }
+      }
+      waiting_poppers_.fetch_sub(1);
+      if (timed_out) {
         // clang-format off
         AT_ERROR(
             "Timeout in DataLoader queue while waiting for next batch"
             " (timeout was ", timeout->count(), " ms)");
         // clang-format on
       }
-    } else {
-      cv_.wait(lock, [this] { return !this->queue_.empty(); });
+      break;
     }
-    AT_ASSERT(!queue_.empty());
-    T value = queue_.front();
-    queue_.pop();
-    lock.unlock();
+    notify(waiting_pushers_, not_full_);
     return value;
   }
 
@@ -66,18 +124,93 @@ class Queue {
   /// is assumed to be used to drain the queue during shutdown of a
   /// `DataLoader`.
   size_t clear() {
-    std::lock_guard<std::mutex> lock(this->mutex_);
-    const auto size = queue_.size();
-    while (!queue_.empty()) {
-      queue_.pop();
+    size_t size = 0;
+    T value;
+    while (try_pop(value)) {
+      ++size;
     }
     return size;
   }
 
  private:
-  std::queue<T> queue_;
+  /// The number of times a thread retries before it parks.
+  static constexpr size_t kSpinCount = 64;
+
+  struct Cell {
+    /// Equal to the position of the next push into the cell when it is free,
+    /// and to that position plus one once the push filled it.
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  /// Moves `value` into the queue, unless it is full.
+  bool try_push(T& value) {
+    size_t position = push_position_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells_[position & mask_];
+      const auto sequence = cell.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<intptr_t>(sequence) -
+          static_cast<intptr_t>(position);
+      if (diff == 0) {
+        if (push_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          cell.value = std::move(value);
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = push_position_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Moves the front of the queue into `value`, unless it is empty.
+  bool try_pop(T& value) {
+    size_t position = pop_position_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell& cell = cells_[position & mask_];
+      const auto sequence = cell.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<intptr_t>(sequence) -
+          static_cast<intptr_t>(position + 1);
+      if (diff == 0) {
+        if (pop_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          value = std::move(cell.value);
+          cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = pop_position_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Wakes up one of the threads parked on `condition`, if any. A parked
+  /// thread registers in `waiting` before it retries under the lock, and the
+  /// fence orders the push or pop that was just made before the check, so
+  /// either the parked thread sees that push or pop, or this sees the thread.
+  void notify(std::atomic<size_t>& waiting, std::condition_variable& condition) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load() > 0) {
+      // Taking the lock makes sure the thread is waiting on the condition.
+      { std::lock_guard<std::mutex> lock(mutex_); }
+      condition.notify_one();
+    }
+  }
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  alignas(64) std::atomic<size_t> push_position_{0};
+  alignas(64) std::atomic<size_t> pop_position_{0};
+  alignas(64) std::atomic<size_t> waiting_pushers_{0};
+  std::atomic<size_t> waiting_poppers_{0};
   std::mutex mutex_;
-  std::condition_variable cv_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
 };
 } // namespace detail
 } // namespace data
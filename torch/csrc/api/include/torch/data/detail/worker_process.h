@@ -0,0 +1,320 @@
+#pragma once
+
+#include <torch/data/example.h>
+#include <torch/types.h>
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <c10/util/Exception.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace detail {
+
+// Note [DataLoader worker processes]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// With the `worker_processes` option, each worker thread of a DataLoader
+// forwards its jobs to a process forked when the DataLoader is constructed,
+// which holds its own copy of the dataset, over a Unix domain socket.
+//
+// The batch request is sent as plain bytes. The tensors of the batch are
+// copied, in the worker process, into a shared memory segment, and the batch
+// is sent as bytes that describe where each tensor lies in the segment. The
+// tensors of the batch the DataLoader returns are views of the segment, so
+// that nothing is copied in the process of the DataLoader.
+//
+// Segments are created, and unlinked right away, by the worker process, and
+// are sent along the first batch they hold as a file descriptor, which the
+// process of the DataLoader maps once and keeps mapped. Once all the tensors
+// of a batch are gone, a message tells the worker process that its segment is
+// free, and the worker process reuses it for a later batch, so that segments
+// are not created, mapped and unmapped for each batch. Since segments have no
+// name once they are mapped, no shared memory is left behind when a process
+// dies.
+
+/// The bytes of a message between a DataLoader and one of its worker processes,
+/// along with the tensors they refer to, which are laid out in the shared
+/// memory segment the message is sent with.
+class TORCH_API WireWriter {
+ public:
+  /// Appends `size` bytes at `data` to the message.
+  void write(const void* data, size_t size);
+
+  /// Appends the type, sizes and offset in the segment of `tensor`, which must
+  /// be a CPU tensor, to the message.
+  void write_tensor(const Tensor& tensor);
+
+  const std::string& bytes() const noexcept {
+    return bytes_;
+  }
+
+  /// The tensors of the message, contiguous, and their offset in the segment.
+  const std::vector<std::pair<size_t, Tensor>>& tensors() const noexcept {
+    return tensors_;
+  }
+
+  /// The size of the segment the tensors of the message need.
+  size_t tensor_bytes() const noexcept {
+    return tensor_bytes_;
+  }
+
+ private:
+  std::string bytes_;
+  std::vector<std::pair<size_t, Tensor>> tensors_;
+  size_t tensor_bytes_ = 0;
+};
+
+/// Reads back what a `WireWriter` wrote, in the same order.
+class TORCH_API WireReader {
+ public:
+  /// Reads `bytes`, whose tensors lie in the memory at `segment`, which
+  /// `owner` keeps alive.
+  explicit WireReader(
+      std::string bytes,
+      void* segment = nullptr,
+      std::shared_ptr<void> owner = nullptr);
+
+  /// Copies the next `size` bytes of the message to `data`.
+  void read(void* data, size_t size);
+
+  /// Returns the next tensor of the message, a view of the segment.
+  Tensor read_tensor();
+
+ private:
+  std::string bytes_;
+  size_t position_ = 0;
+  char* segment_;
+  std::shared_ptr<void> owner_;
+};
+
+/// How values of type `T` are written to, and read from, messages between a
+/// DataLoader and its worker processes. Specialized for tensors, `Example`s,
+/// `std::vector`s, `optional`s, strings and arithmetic types, nested to any
+/// depth. Values of any other type cannot be sent between processes.
+template <typename T, typename Enable = void>
+struct WireFormat {
+  static void write(WireWriter& /*writer*/, const T& /*value*/) {
+    AT_ERROR(
+        "The batch or batch request type of this DataLoader "
+        "cannot be sent between processes");
+  }
+  static T read(WireReader& /*reader*/) {
+    AT_ERROR(
+        "The batch or batch request type of this DataLoader "
+        "cannot be sent between processes");
+  }
+};
+
+template <typename T>
+struct WireFormat<
+    T,
+    typename std::enable_if<std::is_arithmetic<T>::value>::type> {
+  static void write(WireWriter& writer, const T& value) {
+    writer.write(&value, sizeof(T));
+  }
+  static T read(WireReader& reader) {
+    T value;
+    reader.read(&value, sizeof(T));
+    return value;
+  }
+};
+
+template <>
+struct WireFormat<std::string> {
+  static void write(WireWriter& writer, const std::string& value) {
+    WireFormat<uint64_t>::write(writer, value.size());
+    writer.write(value.data(), value.size());
+  }
+  static std::string read(WireReader& reader) {
+    std::string value(WireFormat<uint64_t>::read(reader), '\0');
+    reader.read(&value[0], value.size());
+    return value;
+  }
+};
+
+template <>
+struct WireFormat<Tensor> {
+  static void write(WireWriter& writer, const Tensor& value) {
+    writer.write_tensor(value);
+  }
+  static Tensor read(WireReader& reader) {
+    return reader.read_tensor();
+  }
+};
+
+template <typename Data, typename Target>
+struct WireFormat<Example<Data, Target>> {
+  static void write(WireWriter& writer, const Example<Data, Target>& value) {
+    WireFormat<Data>::write(writer, value.data);
+    WireFormat<Target>::write(writer, value.target);
+  }
+  static Example<Data, Target> read(WireReader& reader) {
+    // The elements of a braced initializer list are evaluated in order.
+    return {WireFormat<Data>::read(reader), WireFormat<Target>::read(reader)};
+  }
+};
+
+template <typename Data>
+struct WireFormat<Example<Data, example::NoTarget>> {
+  static void write(
+      WireWriter& writer,
+      const Example<Data, example::NoTarget>& value) {
+    WireFormat<Data>::write(writer, value.data);
+  }
+  static Example<Data, example::NoTarget> read(WireReader& reader) {
+    return {WireFormat<Data>::read(reader)};
+  }
+};
+
+template <typename T>
+struct WireFormat<std::vector<T>> {
+  static void write(WireWriter& writer, const std::vector<T>& values) {
+    WireFormat<uint64_t>::write(writer, values.size());
+    for (const auto& value : values) {
+      WireFormat<T>::write(writer, value);
+    }
+  }
+  static std::vector<T> read(WireReader& reader) {
+    const auto size = WireFormat<uint64_t>::read(reader);
+    std::vector<T> values;
+    values.reserve(size);
+    for (uint64_t i = 0; i < size; ++i) {
+      values.push_back(WireFormat<T>::read(reader));
+    }
+    return values;
+  }
+};
+
+template <typename T>
+struct WireFormat<optional<T>> {
+  static void write(WireWriter& writer, const optional<T>& value) {
+    WireFormat<bool>::write(writer, value.has_value());
+    if (value) {
+      WireFormat<T>::write(writer, *value);
+    }
+  }
+  static optional<T> read(WireReader& reader) {
+    if (!WireFormat<bool>::read(reader)) {
+      return nullopt;
+    }
+    return WireFormat<T>::read(reader);
+  }
+};
+
+/// The end of a Unix domain socket between a DataLoader and one of its worker
+/// processes, over which messages are sent whole, along with an optional file
+/// descriptor.
+class TORCH_API WorkerChannel {
+ public:
+  enum class MessageType : uint32_t {
+    /// A batch request, from the DataLoader.
+    kRequest,
+    /// The id of a segment that is free again, from the DataLoader.
+    kRelease,
+    /// Tells the worker process to exit, from the DataLoader.
+    kQuit,
+    /// A batch, from the worker process.
+    kBatch,
+    /// The message of an exception the worker process raised.
+    kError,
+  };
+
+  struct Message {
+    MessageType type;
+    std::string payload;
+    /// A file descriptor sent along the message, or -1.
+    int fd = -1;
+  };
+
+  /// Takes ownership of the socket `fd`.
+  explicit WorkerChannel(int fd);
+  ~WorkerChannel();
+
+  WorkerChannel(const WorkerChannel&) = delete;
+  WorkerChannel& operator=(const WorkerChannel&) = delete;
+
+  /// Sends `message`, and throws if it cannot be sent. May be called from any
+  /// thread.
+  void send(const Message& message);
+
+  /// Like `send`, but returns false instead of throwing.
+  bool try_send(const Message& message) noexcept;
+
+  /// Receives the next message into `message`, or returns false if the other
+  /// end of the socket was closed.
+  bool receive(Message& message);
+
+ private:
+  int fd_;
+  std::mutex send_mutex_;
+};
+
+/// The part of `WorkerProcess` that does not depend on the batch type.
+class TORCH_API WorkerProcessBase {
+ public:
+  /// Handles a batch request of the DataLoader, read from the reader, by
+  /// writing the batch to the writer. Runs in the worker process.
+  using Handler = std::function<void(WireReader&, WireWriter&)>;
+
+  /// Forks the worker process, which runs `handler` on each batch request
+  /// until it is told to exit.
+  explicit WorkerProcessBase(Handler handler);
+
+  /// Tells the worker process to exit, and waits for it.
+  virtual ~WorkerProcessBase();
+
+  WorkerProcessBase(const WorkerProcessBase&) = delete;
+  WorkerProcessBase& operator=(const WorkerProcessBase&) = delete;
+
+ protected:
+  /// Sends the batch request in `request` to the worker process, and returns
+  /// a reader for the batch it sends back. Rethrows the message of an
+  /// exception raised by the worker process.
+  WireReader exchange(const WireWriter& request);
+
+ private:
+  struct Segment;
+
+  int pid_ = -1;
+  std::shared_ptr<WorkerChannel> channel_;
+  /// The segments of the worker process mapped in this process, by id.
+  std::unordered_map<uint64_t, std::shared_ptr<Segment>> segments_;
+};
+
+/// A worker process, forked from the process of the DataLoader, which maps
+/// batch requests to batches. See Note [DataLoader worker processes].
+template <typename Batch, typename BatchRequest>
+class WorkerProcess : public WorkerProcessBase {
+ public:
+  /// Forks a worker process that maps batch requests to batches with
+  /// `get_batch`.
+  explicit WorkerProcess(std::function<Batch(BatchRequest)> get_batch)
+      : WorkerProcessBase(
+            [get_batch](WireReader& reader, WireWriter& writer) {
+              WireFormat<Batch>::write(
+                  writer, get_batch(WireFormat<BatchRequest>::read(reader)));
+            }) {}
+
+  /// Returns the batch for `request`, whose tensors are views of shared
+  /// memory. Blocks until the worker process has loaded the batch.
+  Batch get_batch(BatchRequest request) {
+    WireWriter writer;
+    WireFormat<BatchRequest>::write(writer, request);
+    auto reader = exchange(writer);
+    return WireFormat<Batch>::read(reader);
+  }
+};
+} // namespace detail
+} // namespace data
+} // namespace torch
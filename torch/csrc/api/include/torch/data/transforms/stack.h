@@ -1,9 +1,15 @@
 #pragma once
 
+#include <torch/data/detail/batch_buffer_pool.h>
 #include <torch/data/example.h>
 #include <torch/data/transforms/collate.h>
 #include <torch/types.h>
 
+#include <c10/util/ArrayRef.h>
+#include <c10/util/Exception.h>
+
+#include <cstddef>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -44,6 +50,76 @@ struct Stack<TensorExample>
     return torch::stack(data);
   }
 };
+
+template <typename T = Example<>>
+struct StackInto;
+
+/// A `Stack` that has the dataset write each example straight into its row
+/// of the batch tensors, with `Dataset::get_into`, instead of stacking the
+/// examples the dataset returns. The batch tensors are taken from a pool and
+/// reused once the batches they held are dropped, so that a batch allocates
+/// nothing but its first example, which gives the sizes of the rest. A
+/// `MapDataset` applying this transform to a `Dataset` calls
+/// `apply_batch_from()`, and `apply_batch()`, which stacks, otherwise.
+///
+/// \rst
+/// .. code-block:: cpp
+///   auto dataset = MyDataset().map(transforms::StackInto<>());
+/// \endrst
+template <>
+struct StackInto<Example<>> : public Stack<Example<>> {
+  /// `max_batches` bounds the number of batch tensors kept for reuse. It
+  /// should be at least the number of batches alive at once, in flight in the
+  /// `DataLoader` and held by the caller.
+  explicit StackInto(size_t max_batches = 16)
+      : pool_(std::make_shared<detail::BatchBufferPool>(2 * max_batches)) {}
+
+  /// Returns the batch of the examples of `dataset` at `indices`.
+  template <typename Dataset>
+  auto apply_batch_from(Dataset& dataset, ArrayRef<size_t> indices)
+      -> decltype(dataset.get_into(size_t(), std::declval<Example<>&>()),
+                  Example<>()) {
+    TORCH_CHECK(!indices.empty(), "Expected a non-empty batch");
+    auto first = dataset.get(indices[0]);
+    auto data = pool_->get(first.data, indices.size());
+    auto targets = pool_->get(first.target, indices.size());
+    data[0].copy_(first.data);
+    targets[0].copy_(first.target);
+    for (size_t i = 1; i < indices.size(); ++i) {
+      Example<> slot(data[i], targets[i]);
+      dataset.get_into(indices[i], slot);
+    }
+    return {std::move(data), std::move(targets)};
+  }
+
+ private:
+  std::shared_ptr<detail::BatchBufferPool> pool_;
+};
+
+/// A `StackInto` for `Example<Tensor, NoTarget>` types.
+template <>
+struct StackInto<TensorExample> : public Stack<TensorExample> {
+  explicit StackInto(size_t max_batches = 16)
+      : pool_(std::make_shared<detail::BatchBufferPool>(max_batches)) {}
+
+  template <typename Dataset>
+  auto apply_batch_from(Dataset& dataset, ArrayRef<size_t> indices)
+      -> decltype(dataset.get_into(size_t(), std::declval<TensorExample&>()),
+                  TensorExample()) {
+    TORCH_CHECK(!indices.empty(), "Expected a non-empty batch");
+    auto first = dataset.get(indices[0]);
+    auto data = pool_->get(first.data, indices.size());
+    data[0].copy_(first.data);
+    for (size_t i = 1; i < indices.size(); ++i) {
+      TensorExample slot(data[i]);
+      dataset.get_into(indices[i], slot);
+    }
+    return data;
+  }
+
+ private:
+  std::shared_ptr<detail::BatchBufferPool> pool_;
+};
 } // namespace transforms
 } // namespace data
 } // namespace torch
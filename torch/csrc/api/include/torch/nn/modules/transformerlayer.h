@@ -37,6 +37,9 @@ class TORCH_API TransformerEncoderLayerImpl : public Cloneable<TransformerEncode
      : TransformerEncoderLayerImpl(TransformerEncoderLayerOptions(d_model, nhead)) {}
     explicit TransformerEncoderLayerImpl(const TransformerEncoderLayerOptions& options_);
 
+    /// In eval mode, when no gradient is needed, runs as the single fused
+    /// `_transformer_encoder_layer_fwd` op. Its outputs at the tokens that
+    /// `src_key_padding_mask` marks as padding are zeros.
     Tensor forward(
       const Tensor& src,
       const Tensor& src_mask = {},
@@ -51,6 +54,12 @@ class TORCH_API TransformerEncoderLayerImpl : public Cloneable<TransformerEncode
       {1, AnyValue(Tensor())},
       {2, AnyValue(Tensor())})
 
+  private:
+    bool can_use_fast_path(
+      const Tensor& src,
+      const Tensor& src_mask,
+      const Tensor& src_key_padding_mask) const;
+
   public:
     /// options with which this `TransformerEncoderLayer` was constructed
     TransformerEncoderLayerOptions options;
@@ -26,6 +26,9 @@ struct TORCH_API AdagradOptions : public OptimizerCloneableOptions<AdagradOption
   TORCH_ARG(double, weight_decay) = 0;
   TORCH_ARG(double, initial_accumulator_value) = 0;
   TORCH_ARG(double, eps) = 1e-10;
+  // Step each param group with one fused _fused_adagrad_ kernel call;
+  // sparse gradients still take the unfused path
+  TORCH_ARG(bool, fused) = false;
 public:
   void serialize(torch::serialize::InputArchive& archive) override;
   void serialize(torch::serialize::OutputArchive& archive) const override;
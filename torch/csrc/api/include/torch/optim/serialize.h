@@ -264,6 +264,15 @@ std::deque<T> list_to_deque(const c10::List<T>& list) {
   } \
 }
 
+// For options added after archives were written: keeps the default when the
+// archive doesn't have the option
+#define _TORCH_OPTIM_DESERIALIZE_TORCH_ARG_IF_EXISTS(T, name) { \
+  c10::IValue ivalue; \
+  if (archive.try_read(#name, ivalue)) { \
+    name(ivalue.to<T>()); \
+  } \
+}
+
 #define _TORCH_OPTIM_DESERIALIZE_TORCH_ARG_DEQUE(T, name) { \
   c10::IValue ivalue; \
   archive.read(#name, ivalue); \
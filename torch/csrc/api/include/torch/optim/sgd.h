@@ -27,6 +27,8 @@ struct TORCH_API SGDOptions : public OptimizerCloneableOptions<SGDOptions> {
   TORCH_ARG(double, dampening) = 0;
   TORCH_ARG(double, weight_decay) = 0;
   TORCH_ARG(bool, nesterov) = false;
+  // Step each param group with one fused _fused_sgd_ kernel call
+  TORCH_ARG(bool, fused) = false;
 public:
   void serialize(torch::serialize::InputArchive& archive) override;
   void serialize(torch::serialize::OutputArchive& archive) const override;
@@ -65,6 +67,9 @@ class TORCH_API SGD : public Optimizer {
   void load(serialize::InputArchive& archive) override;
 
  private:
+  // Steps the group with _fused_sgd_
+  void fused_step(OptimizerParamGroup& group);
+
   template <typename Self, typename Archive>
   static void serialize(Self& self, Archive& archive) {
     _TORCH_OPTIM_SERIALIZE_WITH_TEMPLATE_ARG(SGD);
@@ -0,0 +1,147 @@
+#include <torch/data/datasets/columnar.h>
+
+#include <torch/data/example.h>
+#include <torch/types.h>
+
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace torch {
+namespace data {
+namespace datasets {
+namespace {
+#ifndef _WIN32
+/// Gives the kernel `advice` about the memory of `tensor`, which must be
+/// contiguous. The advice is best effort, so errors are ignored.
+void advise(const Tensor& tensor, int advice) {
+  if (tensor.numel() == 0) {
+    return;
+  }
+  static const auto page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  const auto begin = reinterpret_cast<uintptr_t>(tensor.data_ptr());
+  const auto end = begin + tensor.numel() * tensor.element_size();
+  const auto page_begin = begin & ~(page_size - 1);
+  madvise(reinterpret_cast<void*>(page_begin), end - page_begin, advice);
+}
+#endif
+
+Tensor map_column(const ColumnFile& column) {
+  int64_t row_numel = 1;
+  for (const auto size : column.row_shape) {
+    TORCH_CHECK(size >= 0, "Invalid row shape ", column.row_shape);
+    row_numel *= size;
+  }
+  const int64_t row_bytes = row_numel * elementSize(column.dtype);
+  TORCH_CHECK(row_bytes > 0, "Column ", column.path, " has empty rows");
+
+  std::ifstream file(column.path, std::ios::binary | std::ios::ate);
+  TORCH_CHECK(file, "Error opening column file at ", column.path);
+  const int64_t file_bytes = file.tellg();
+  TORCH_CHECK(
+      file_bytes % row_bytes == 0,
+      "Column file ",
+      column.path,
+      " has ",
+      file_bytes,
+      " bytes, which is not a whole number of rows of ",
+      row_bytes,
+      " bytes");
+  const int64_t rows = file_bytes / row_bytes;
+  std::vector<int64_t> sizes{rows};
+  sizes.insert(sizes.end(), column.row_shape.begin(), column.row_shape.end());
+  if (rows == 0) {
+    // An empty file cannot be mapped.
+    return torch::empty(sizes, column.dtype);
+  }
+
+  auto mapped = torch::from_file(
+      column.path,
+      /*shared=*/false,
+      /*size=*/rows * row_numel,
+      TensorOptions(column.dtype));
+#ifndef _WIN32
+  advise(mapped, MADV_RANDOM);
+#endif
+  return mapped.view(sizes);
+}
+} // namespace
+
+ColumnarChunkReader::ColumnarChunkReader(
+    ColumnFile data,
+    ColumnFile target,
+    size_t chunk_size)
+    : data_(map_column(data)),
+      target_(map_column(target)),
+      chunk_size_(chunk_size) {
+  TORCH_CHECK(chunk_size_ > 0, "Chunk size must be positive");
+  TORCH_CHECK(
+      data_.size(0) == target_.size(0),
+      "The data column has ",
+      data_.size(0),
+      " rows but the target column has ",
+      target_.size(0));
+}
+
+ColumnarChunkReader::BatchType ColumnarChunkReader::read_chunk(
+    size_t chunk_index) {
+  TORCH_CHECK(
+      chunk_index < chunk_count(),
+      "Chunk index ",
+      chunk_index,
+      " is out of range for ",
+      chunk_count(),
+      " chunks");
+  const auto begin = static_cast<int64_t>(chunk_index * chunk_size_);
+  const auto length =
+      std::min(static_cast<int64_t>(chunk_size_), data_.size(0) - begin);
+  const auto data = data_.narrow(0, begin, length);
+  const auto target = target_.narrow(0, begin, length);
+#ifndef _WIN32
+  advise(data, MADV_WILLNEED);
+  advise(target, MADV_WILLNEED);
+#endif
+
+  BatchType examples;
+  examples.reserve(length);
+  for (int64_t i = 0; i < length; ++i) {
+    examples.emplace_back(data[i], target[i]);
+  }
+  return examples;
+}
+
+size_t ColumnarChunkReader::chunk_count() {
+  return (size() + chunk_size_ - 1) / chunk_size_;
+}
+
+void ColumnarChunkReader::reset() {}
+
+size_t ColumnarChunkReader::size() const {
+  return data_.size(0);
+}
+
+void ColumnarChunkReader::write_column(
+    const std::string& path,
+    const Tensor& rows) {
+  TORCH_CHECK(rows.dim() > 0, "Expected a tensor of rows");
+  const auto contiguous = rows.to(kCPU).contiguous();
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  TORCH_CHECK(file, "Error opening column file at ", path);
+  file.write(
+      static_cast<const char*>(contiguous.data_ptr()),
+      contiguous.numel() * contiguous.element_size());
+  TORCH_CHECK(file, "Error writing column file at ", path);
+}
+} // namespace datasets
+} // namespace data
+} // namespace torch
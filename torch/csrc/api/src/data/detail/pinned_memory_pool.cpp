@@ -0,0 +1,70 @@
+#include <torch/data/detail/pinned_memory_pool.h>
+#include <torch/types.h>
+
+#include <cstddef>
+#include <utility>
+
+namespace torch {
+namespace data {
+namespace detail {
+Tensor PinnedMemoryPool::pin(const Tensor& tensor) {
+  if (!tensor.defined() || !tensor.device().is_cpu() ||
+      tensor.layout() != kStrided || tensor.numel() == 0 ||
+      tensor.is_pinned()) {
+    return tensor;
+  }
+  const size_t nbytes = tensor.numel() * tensor.element_size();
+  c10::Storage storage;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // The smallest free buffer that is large enough.
+    Buffer* best = nullptr;
+    for (auto& buffer : buffers_) {
+      if (buffer.storage.use_count() == 1 && buffer.storage.nbytes() >= nbytes &&
+          (!buffer.event || buffer.event->query()) &&
+          (!best || buffer.storage.nbytes() < best->storage.nbytes())) {
+        best = &buffer;
+      }
+    }
+    if (best == nullptr) {
+      buffers_.push_back(
+          {torch::empty(
+               {static_cast<int64_t>(nbytes)},
+               TensorOptions(kByte).pinned_memory(true))
+               .storage(),
+           nullptr});
+      best = &buffers_.back();
+    }
+    best->event.reset();
+    // Taking a reference marks the buffer as used before the lock is released.
+    storage = best->storage;
+  }
+  auto pinned = torch::empty({0}, tensor.options())
+                    .set_(std::move(storage), 0, {tensor.numel()}, {1})
+                    .view(tensor.sizes());
+  pinned.copy_(tensor);
+  return pinned;
+}
+
+void PinnedMemoryPool::record_event(
+    const Tensor& tensor,
+    std::shared_ptr<c10::Event> event) {
+  if (!tensor.defined() || !tensor.has_storage()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& buffer : buffers_) {
+    if (buffer.storage.is_alias_of(tensor.storage())) {
+      buffer.event = std::move(event);
+      return;
+    }
+  }
+}
+
+size_t PinnedMemoryPool::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return buffers_.size();
+}
+} // namespace detail
+} // namespace data
+} // namespace torch
@@ -0,0 +1,545 @@
+#include <torch/data/detail/worker_process.h>
+
+#include <torch/types.h>
+
+#include <ATen/Parallel.h>
+#include <TH/THAllocator.h>
+#include <c10/util/Exception.h>
+#include <c10/util/Logging.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace torch {
+namespace data {
+namespace detail {
+namespace {
+/// Tensors are aligned to cache lines in the segments.
+constexpr size_t kTensorAlignment = 64;
+
+/// The id of the segment of a batch without tensor data.
+constexpr uint64_t kNoSegment = 0;
+
+struct MessageHeader {
+  uint32_t type;
+  uint32_t has_fd;
+  uint64_t size;
+};
+
+template <typename T>
+void append(std::string& bytes, const T& value) {
+  bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/// Reads a `T` at `position` in `bytes`, and moves `position` past it.
+template <typename T>
+T consume(const std::string& bytes, size_t& position) {
+  TORCH_CHECK(
+      position + sizeof(T) <= bytes.size(),
+      "Truncated message from a DataLoader worker process");
+  T value;
+  std::memcpy(&value, bytes.data() + position, sizeof(T));
+  position += sizeof(T);
+  return value;
+}
+
+#ifndef _WIN32
+/// The segments of a worker process, which it reuses once the DataLoader tells
+/// it that it is done with them.
+class SegmentPool {
+ public:
+  struct Segment {
+    uint64_t id;
+    at::DataPtr data;
+    size_t size;
+    bool free;
+    /// Whether the DataLoader was sent the segment already.
+    bool sent;
+  };
+
+  /// Returns the smallest free segment of at least `size` bytes, or a new one,
+  /// replacing the free segments that are too small, whose ids are appended to
+  /// `retired`.
+  Segment& acquire(size_t size, std::vector<uint64_t>& retired) {
+    Segment* best = nullptr;
+    for (auto& segment : segments_) {
+      if (segment.free && segment.size >= size &&
+          (!best || segment.size < best->size)) {
+        best = &segment;
+      }
+    }
+    if (best == nullptr) {
+      for (auto it = segments_.begin(); it != segments_.end();) {
+        if (it->free) {
+          retired.push_back(it->id);
+          it = segments_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      const auto id = next_id_++;
+      const auto name = "/torch_dataloader_" + std::to_string(getpid()) + "_" +
+          std::to_string(id);
+      // The segment is unlinked as soon as it is mapped, and only reachable
+      // through the file descriptor that is kept open to send it.
+      auto data = THMapAllocator::makeDataPtr(
+          name.c_str(),
+          TH_ALLOCATOR_MAPPED_SHAREDMEM | TH_ALLOCATOR_MAPPED_EXCLUSIVE |
+              TH_ALLOCATOR_MAPPED_KEEPFD | TH_ALLOCATOR_MAPPED_UNLINK,
+          size,
+          nullptr);
+      segments_.push_back({id, std::move(data), size, true, false});
+      best = &segments_.back();
+    }
+    best->free = false;
+    return *best;
+  }
+
+  void release(uint64_t id) {
+    for (auto& segment : segments_) {
+      if (segment.id == id) {
+        segment.free = true;
+        return;
+      }
+    }
+  }
+
+ private:
+  // A list, so that references to segments survive the erasure of others.
+  std::list<Segment> segments_;
+  uint64_t next_id_ = kNoSegment + 1;
+};
+
+/// Copies the tensors of `batch` into a segment of `pool`, and returns the
+/// message that sends it.
+WorkerChannel::Message pack_batch(const WireWriter& batch, SegmentPool& pool) {
+  WorkerChannel::Message message{WorkerChannel::MessageType::kBatch};
+  uint64_t id = kNoSegment;
+  uint64_t size = 0;
+  std::vector<uint64_t> retired;
+  if (batch.tensor_bytes() > 0) {
+    auto& segment = pool.acquire(batch.tensor_bytes(), retired);
+    auto* data = static_cast<char*>(segment.data.get());
+    for (const auto& tensor : batch.tensors()) {
+      torch::from_blob(
+          data + tensor.first, tensor.second.sizes(), tensor.second.options())
+          .copy_(tensor.second);
+    }
+    id = segment.id;
+    size = segment.size;
+    if (!segment.sent) {
+      message.fd = THMapAllocator::fromDataPtr(segment.data)->fd();
+      segment.sent = true;
+    }
+  }
+  append(message.payload, id);
+  append(message.payload, size);
+  append(message.payload, static_cast<uint64_t>(retired.size()));
+  for (const auto retired_id : retired) {
+    append(message.payload, retired_id);
+  }
+  message.payload += batch.bytes();
+  return message;
+}
+
+/// The main loop of a worker process.
+void serve(WorkerChannel& channel, const WorkerProcessBase::Handler& handler) {
+  SegmentPool pool;
+  WorkerChannel::Message message;
+  while (channel.receive(message)) {
+    if (message.type == WorkerChannel::MessageType::kQuit) {
+      break;
+    }
+    if (message.type == WorkerChannel::MessageType::kRelease) {
+      size_t position = 0;
+      pool.release(consume<uint64_t>(message.payload, position));
+      continue;
+    }
+    WorkerChannel::Message reply;
+    try {
+      WireReader request(std::move(message.payload));
+      WireWriter batch;
+      handler(request, batch);
+      reply = pack_batch(batch, pool);
+    } catch (const std::exception& e) {
+      reply = {WorkerChannel::MessageType::kError, e.what()};
+    }
+    channel.send(reply);
+  }
+}
+
+/// Throws the error of a failed system call.
+[[noreturn]] void throw_system_error(const char* call) {
+  AT_ERROR(call, " failed in DataLoader worker process: ", std::strerror(errno));
+}
+#endif
+} // namespace
+
+void WireWriter::write(const void* data, size_t size) {
+  bytes_.append(static_cast<const char*>(data), size);
+}
+
+void WireWriter::write_tensor(const Tensor& tensor) {
+  const uint8_t defined = tensor.defined();
+  write(&defined, sizeof(defined));
+  if (!defined) {
+    return;
+  }
+  TORCH_CHECK(
+      tensor.device().is_cpu() && tensor.layout() == kStrided,
+      "Only strided CPU tensors can be sent from a DataLoader worker process");
+  const auto contiguous = tensor.contiguous();
+  const auto type = static_cast<int8_t>(contiguous.scalar_type());
+  write(&type, sizeof(type));
+  const auto dim = static_cast<uint64_t>(contiguous.dim());
+  write(&dim, sizeof(dim));
+  write(contiguous.sizes().data(), dim * sizeof(int64_t));
+  const uint64_t offset =
+      (tensor_bytes_ + kTensorAlignment - 1) / kTensorAlignment *
+      kTensorAlignment;
+  write(&offset, sizeof(offset));
+  const auto nbytes = contiguous.numel() * contiguous.element_size();
+  if (nbytes > 0) {
+    tensors_.emplace_back(offset, contiguous);
+    tensor_bytes_ = offset + nbytes;
+  }
+}
+
+WireReader::WireReader(
+    std::string bytes,
+    void* segment,
+    std::shared_ptr<void> owner)
+    : bytes_(std::move(bytes)),
+      segment_(static_cast<char*>(segment)),
+      owner_(std::move(owner)) {}
+
+void WireReader::read(void* data, size_t size) {
+  TORCH_CHECK(
+      position_ + size <= bytes_.size(),
+      "Truncated message from a DataLoader worker process");
+  std::memcpy(data, bytes_.data() + position_, size);
+  position_ += size;
+}
+
+Tensor WireReader::read_tensor() {
+  uint8_t defined = 0;
+  read(&defined, sizeof(defined));
+  if (!defined) {
+    return Tensor();
+  }
+  int8_t type = 0;
+  read(&type, sizeof(type));
+  uint64_t dim = 0;
+  read(&dim, sizeof(dim));
+  std::vector<int64_t> sizes(dim);
+  read(sizes.data(), dim * sizeof(int64_t));
+  uint64_t offset = 0;
+  read(&offset, sizeof(offset));
+  const auto options = TensorOptions(static_cast<ScalarType>(type));
+  int64_t numel = 1;
+  for (const auto size : sizes) {
+    numel *= size;
+  }
+  if (numel == 0) {
+    return torch::empty(sizes, options);
+  }
+  TORCH_INTERNAL_ASSERT(segment_ != nullptr);
+  auto owner = owner_;
+  return torch::from_blob(
+      segment_ + offset, sizes, [owner](void*) {}, options);
+}
+
+#ifndef _WIN32
+WorkerChannel::WorkerChannel(int fd) : fd_(fd) {}
+
+WorkerChannel::~WorkerChannel() {
+  ::close(fd_);
+}
+
+void WorkerChannel::send(const Message& message) {
+  MessageHeader header{static_cast<uint32_t>(message.type),
+                       message.fd >= 0,
+                       message.payload.size()};
+  std::lock_guard<std::mutex> lock(send_mutex_);
+  const char* data = reinterpret_cast<const char*>(&header);
+  size_t remaining = sizeof(header);
+  // The file descriptor goes with the first byte of the header.
+  if (message.fd >= 0) {
+    char control[CMSG_SPACE(sizeof(int))] = {};
+    struct iovec iov;
+    iov.iov_base = const_cast<char*>(data);
+    iov.iov_len = remaining;
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), &message.fd, sizeof(int));
+    ssize_t sent;
+    do {
+      sent = ::sendmsg(fd_, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    if (sent < 0) {
+      throw_system_error("sendmsg");
+    }
+    data += sent;
+    remaining -= sent;
+  }
+  auto send_all = [this](const char* data, size_t remaining) {
+    while (remaining > 0) {
+      const auto sent = ::send(fd_, data, remaining, MSG_NOSIGNAL);
+      if (sent < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw_system_error("send");
+      }
+      data += sent;
+      remaining -= sent;
+    }
+  };
+  send_all(data, remaining);
+  send_all(message.payload.data(), message.payload.size());
+}
+
+bool WorkerChannel::try_send(const Message& message) noexcept {
+  try {
+    send(message);
+    return true;
+  } catch (...) {
+    return false;
+  }
+}
+
+bool WorkerChannel::receive(Message& message) {
+  MessageHeader header;
+  char* data = reinterpret_cast<char*>(&header);
+  size_t received = 0;
+  message.fd = -1;
+  while (received < sizeof(header)) {
+    char control[CMSG_SPACE(sizeof(int))] = {};
+    struct iovec iov;
+    iov.iov_base = data + received;
+    iov.iov_len = sizeof(header) - received;
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    const auto count = ::recvmsg(fd_, &msg, MSG_CMSG_CLOEXEC);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw_system_error("recvmsg");
+    }
+    if (count == 0) {
+      TORCH_CHECK(
+          received == 0,
+          "DataLoader worker process channel closed in the middle of a message");
+      return false;
+    }
+    for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+        std::memcpy(&message.fd, CMSG_DATA(cmsg), sizeof(int));
+      }
+    }
+    received += count;
+  }
+  message.type = static_cast<MessageType>(header.type);
+  TORCH_CHECK(
+      !header.has_fd || message.fd >= 0,
+      "Missing file descriptor in a message from a DataLoader worker process");
+  message.payload.resize(header.size);
+  received = 0;
+  while (received < header.size) {
+    const auto count =
+        ::recv(fd_, &message.payload[received], header.size - received, 0);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw_system_error("recv");
+    }
+    TORCH_CHECK(
+        count > 0,
+        "DataLoader worker process channel closed in the middle of a message");
+    received += count;
+  }
+  return true;
+}
+
+/// A segment of the worker process, mapped in this process.
+struct WorkerProcessBase::Segment {
+  at::DataPtr data;
+};
+
+namespace {
+/// Keeps the segment of a batch alive while any of its tensors is, and tells
+/// the worker process that the segment is free once none is.
+struct BatchLease {
+  ~BatchLease() {
+    // The worker process may be gone already, in which case there is no one
+    // to tell.
+    std::string payload;
+    append(payload, id);
+    channel->try_send({WorkerChannel::MessageType::kRelease, payload});
+  }
+
+  uint64_t id;
+  std::shared_ptr<void> segment;
+  std::shared_ptr<WorkerChannel> channel;
+};
+} // namespace
+
+WorkerProcessBase::WorkerProcessBase(Handler handler) {
+  int fds[2];
+  if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    throw_system_error("socketpair");
+  }
+  // Keeps the socket out of programs the DataLoader's process runs, which
+  // would otherwise keep the worker process from seeing it exit.
+  ::fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+  ::fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+  pid_ = ::fork();
+  if (pid_ < 0) {
+    ::close(fds[0]);
+    ::close(fds[1]);
+    throw_system_error("fork");
+  }
+  if (pid_ == 0) {
+    ::close(fds[0]);
+    // The worker process exits once the DataLoader's does: that closes the
+    // other end of the socket, and `serve` returns at the end of it. This
+    // does not depend on which thread forked, unlike PR_SET_PDEATHSIG. Worker
+    // processes forked later hold copies of the DataLoader's end of the
+    // sockets of earlier ones, so those see the end of theirs once the later
+    // ones exited.
+    int status = 0;
+    try {
+      // Intra-op parallelism runs serially in a forked process with the native
+      // backend anyway (see Note [Intra-op parallelism after fork]); this
+      // keeps the OpenMP backend from waiting on threads that were not forked.
+      at::set_num_threads(1);
+      WorkerChannel channel(fds[1]);
+      serve(channel, handler);
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "DataLoader worker process failed: " << e.what();
+      status = 1;
+    }
+    // The worker process shares the state of the DataLoader's, so it must
+    // not run any of its destructors or exit handlers.
+    ::_exit(status);
+  }
+  ::close(fds[1]);
+  channel_ = std::make_shared<WorkerChannel>(fds[0]);
+}
+
+WorkerProcessBase::~WorkerProcessBase() {
+  channel_->try_send({WorkerChannel::MessageType::kQuit});
+  int status;
+  while (::waitpid(pid_, &status, 0) < 0 && errno == EINTR) {
+  }
+}
+
+WireReader WorkerProcessBase::exchange(const WireWriter& request) {
+  TORCH_CHECK(
+      request.tensors().empty(),
+      "Batch requests with tensors cannot be sent to DataLoader worker processes");
+  channel_->send({WorkerChannel::MessageType::kRequest, request.bytes()});
+  WorkerChannel::Message reply;
+  TORCH_CHECK(
+      channel_->receive(reply),
+      "DataLoader worker process ",
+      pid_,
+      " exited unexpectedly");
+  if (reply.type == WorkerChannel::MessageType::kError) {
+    throw std::runtime_error(reply.payload);
+  }
+  TORCH_INTERNAL_ASSERT(reply.type == WorkerChannel::MessageType::kBatch);
+
+  size_t position = 0;
+  const auto id = consume<uint64_t>(reply.payload, position);
+  const auto size = consume<uint64_t>(reply.payload, position);
+  const auto retired_count = consume<uint64_t>(reply.payload, position);
+  for (uint64_t i = 0; i < retired_count; ++i) {
+    segments_.erase(consume<uint64_t>(reply.payload, position));
+  }
+  if (reply.fd >= 0) {
+    // Mapping the segment closes the file descriptor.
+    segments_[id] = std::make_shared<Segment>(Segment{THMapAllocator::makeDataPtr(
+        WITH_FD,
+        nullptr,
+        reply.fd,
+        TH_ALLOCATOR_MAPPED_SHAREDMEM | TH_ALLOCATOR_MAPPED_FROMFD,
+        size,
+        nullptr)});
+  }
+  // What is left of the payload is the batch.
+  auto batch = reply.payload.substr(position);
+  if (id == kNoSegment) {
+    return WireReader(std::move(batch));
+  }
+  auto it = segments_.find(id);
+  TORCH_INTERNAL_ASSERT(it != segments_.end());
+  auto lease = std::make_shared<BatchLease>();
+  lease->id = id;
+  lease->segment = it->second;
+  lease->channel = channel_;
+  return WireReader(std::move(batch), it->second->data.get(), std::move(lease));
+}
+#else
+WorkerChannel::WorkerChannel(int fd) : fd_(fd) {}
+
+WorkerChannel::~WorkerChannel() = default;
+
+void WorkerChannel::send(const Message& /*message*/) {
+  AT_ERROR("DataLoader worker processes are not supported on Windows");
+}
+
+bool WorkerChannel::try_send(const Message& /*message*/) noexcept {
+  return false;
+}
+
+bool WorkerChannel::receive(Message& /*message*/) {
+  AT_ERROR("DataLoader worker processes are not supported on Windows");
+}
+
+struct WorkerProcessBase::Segment {};
+
+WorkerProcessBase::WorkerProcessBase(Handler /*handler*/) {
+  AT_ERROR("DataLoader worker processes are not supported on Windows");
+}
+
+WorkerProcessBase::~WorkerProcessBase() = default;
+
+WireReader WorkerProcessBase::exchange(const WireWriter& /*request*/) {
+  AT_ERROR("DataLoader worker processes are not supported on Windows");
+}
+#endif
+} // namespace detail
+} // namespace data
+} // namespace torch
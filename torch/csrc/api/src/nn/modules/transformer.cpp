@@ -52,11 +52,57 @@ void TransformerEncoderLayerImpl::reset_parameters() {
   // dropout2->reset_parameters();
 }
 
+bool TransformerEncoderLayerImpl::can_use_fast_path(
+  const Tensor& src,
+  const Tensor& src_mask,
+  const Tensor& src_key_padding_mask) const {
+  if (is_training() || src.dim() != 3 ||
+      !(src.is_cuda() || (src.is_cpu() && (src.scalar_type() == kFloat || src.scalar_type() == kDouble)))) {
+    return false;
+  }
+  if (!self_attn->_qkv_same_embed_dim || !self_attn->in_proj_bias.defined() ||
+      self_attn->bias_k.defined() || self_attn->options.add_zero_attn() ||
+      !norm1->options.elementwise_affine() || !norm2->options.elementwise_affine() ||
+      norm1->options.eps() != norm2->options.eps()) {
+    return false;
+  }
+  // The fused kernel masks with -inf where a bool src_mask is set, while
+  // MultiheadAttention adds src_mask to the attention weights whatever its
+  // dtype, so only floating point masks mean the same on both paths
+  if ((src_mask.defined() && (src_mask.dim() != 2 || !src_mask.is_floating_point())) ||
+      (src_key_padding_mask.defined() && src_key_padding_mask.scalar_type() != kBool)) {
+    return false;
+  }
+  // The fast path has no autograd support
+  if (GradMode::is_enabled()) {
+    if (src.requires_grad()) {
+      return false;
+    }
+    for (const auto& parameter : parameters()) {
+      if (parameter.requires_grad()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 Tensor TransformerEncoderLayerImpl::forward(
   const Tensor& src,
   const Tensor& src_mask,
   const Tensor& src_key_padding_mask ) {
 
+  if (can_use_fast_path(src, src_mask, src_key_padding_mask)) {
+    return torch::_transformer_encoder_layer_fwd(
+      src, options.nhead(),
+      self_attn->in_proj_weight, self_attn->in_proj_bias,
+      self_attn->out_proj->weight, self_attn->out_proj->bias,
+      norm1->weight, norm1->bias, norm2->weight, norm2->bias,
+      linear1->weight, linear1->bias, linear2->weight, linear2->bias,
+      /*use_gelu=*/c10::get_if<enumtype::kGELU>(&options.activation()) != nullptr,
+      norm1->options.eps(), src_mask, src_key_padding_mask);
+  }
+
   // multihead attention
   Tensor src2 = std::get<0>(self_attn(src, src, src, src_key_padding_mask, /*need_weights=*/true, src_mask));
   // add & norm
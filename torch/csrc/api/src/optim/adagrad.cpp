@@ -8,6 +8,7 @@
 #include <ATen/ATen.h>
 
 #include <functional>
+#include <map>
 
 namespace torch {
 namespace optim {
@@ -19,7 +20,8 @@ bool operator==(const AdagradOptions& lhs, const AdagradOptions& rhs) {
           (lhs.lr_decay() == rhs.lr_decay()) &&
           (lhs.weight_decay() == rhs.weight_decay()) &&
           (lhs.initial_accumulator_value() == rhs.initial_accumulator_value()) &&
-          (lhs.eps() == rhs.eps());
+          (lhs.eps() == rhs.eps()) &&
+          (lhs.fused() == rhs.fused());
 }
 
 void AdagradOptions::serialize(torch::serialize::OutputArchive& archive) const {
@@ -28,6 +30,7 @@ void AdagradOptions::serialize(torch::serialize::OutputArchive& archive) const {
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(weight_decay);
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(initial_accumulator_value);
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(eps);
+  _TORCH_OPTIM_SERIALIZE_TORCH_ARG(fused);
 }
 
 void AdagradOptions::serialize(torch::serialize::InputArchive& archive) {
@@ -36,6 +39,7 @@ void AdagradOptions::serialize(torch::serialize::InputArchive& archive) {
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(double, weight_decay);
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(double, initial_accumulator_value);
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(double, eps);
+  _TORCH_OPTIM_DESERIALIZE_TORCH_ARG_IF_EXISTS(bool, fused);
 }
 
 double AdagradOptions::get_lr() const {
@@ -61,6 +65,16 @@ void AdagradParamState::serialize(torch::serialize::InputArchive& archive) {
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(Tensor, sum);
 }
 
+namespace {
+// The dense parameters of a group at the same step, which a single
+// _fused_adagrad_ call updates
+struct FusedAdagradBatch {
+  std::vector<Tensor> params;
+  std::vector<Tensor> grads;
+  std::vector<Tensor> state_sums;
+};
+} // namespace
+
 /// Adapted from
 /// https://github.com/pytorch/pytorch/blob/master/torch/optim/adagrad.py
 Tensor Adagrad::step(LossClosure closure) {
@@ -71,6 +85,7 @@ Tensor Adagrad::step(LossClosure closure) {
     loss = closure();
   }
   for (auto& group : param_groups_) {
+    std::map<int64_t, FusedAdagradBatch> fused_batches;
     for (auto& p : group.params()) {
       if (!p.grad().defined()) {
         continue;
@@ -81,6 +96,13 @@ Tensor Adagrad::step(LossClosure closure) {
       auto& options = static_cast<AdagradOptions&>(group.options());
 
       state.step(state.step() + 1);
+      if (options.fused() && !grad.is_sparse()) {
+        auto& batch = fused_batches[state.step()];
+        batch.params.push_back(p);
+        batch.grads.push_back(grad);
+        batch.state_sums.push_back(state.sum());
+        continue;
+      }
 
       if (options.weight_decay() != 0) {
         TORCH_CHECK(!p.grad().is_sparse(), "weight_decay option is not compatible with sparse gradients");
@@ -113,6 +135,16 @@ Tensor Adagrad::step(LossClosure closure) {
         p.addcdiv_(grad, std, -clr);
       }
     }
+
+    auto& options = static_cast<AdagradOptions&>(group.options());
+    for (auto& step_and_batch : fused_batches) {
+      auto& batch = step_and_batch.second;
+      const auto clr = options.lr() /
+          (1 + static_cast<double>(step_and_batch.first - 1) * options.lr_decay());
+      torch::_fused_adagrad_(
+          batch.params, batch.grads, batch.state_sums, clr,
+          options.weight_decay(), options.eps());
+    }
   }
   return loss;
 }
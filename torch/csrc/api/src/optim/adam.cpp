@@ -9,6 +9,7 @@
 
 #include <cmath>
 #include <functional>
+#include <map>
 
 namespace torch {
 namespace optim {
@@ -21,7 +22,8 @@ bool operator==(const AdamOptions& lhs, const AdamOptions& rhs) {
          (std::get<1>(lhs.betas()) == std::get<1>(rhs.betas())) &&
          (lhs.eps() == rhs.eps()) &&
          (lhs.weight_decay() == rhs.weight_decay() &&
-         (lhs.amsgrad() == rhs.amsgrad()));
+         (lhs.amsgrad() == rhs.amsgrad())) &&
+         (lhs.fused() == rhs.fused());
 }
 
 void AdamOptions::serialize(torch::serialize::OutputArchive& archive) const {
@@ -30,6 +32,7 @@ void AdamOptions::serialize(torch::serialize::OutputArchive& archive) const {
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(eps);
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(weight_decay);
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(amsgrad);
+  _TORCH_OPTIM_SERIALIZE_TORCH_ARG(fused);
 }
 
 void AdamOptions::serialize(torch::serialize::InputArchive& archive) {
@@ -38,6 +41,7 @@ void AdamOptions::serialize(torch::serialize::InputArchive& archive) {
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(double, eps);
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(double, weight_decay);
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(bool, amsgrad);
+  _TORCH_OPTIM_DESERIALIZE_TORCH_ARG_IF_EXISTS(bool, fused);
 }
 
 double AdamOptions::get_lr() const {
@@ -69,6 +73,18 @@ void AdamParamState::serialize(torch::serialize::InputArchive& archive) {
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(Tensor, max_exp_avg_sq);
 }
 
+namespace {
+// The parameters of a group at the same step, which a single _fused_adam_
+// call updates
+struct FusedAdamBatch {
+  std::vector<Tensor> params;
+  std::vector<Tensor> grads;
+  std::vector<Tensor> exp_avgs;
+  std::vector<Tensor> exp_avg_sqs;
+  std::vector<Tensor> max_exp_avg_sqs;
+};
+} // namespace
+
 Tensor Adam::step(LossClosure closure)  {
   NoGradGuard no_grad;
   Tensor loss = {};
@@ -77,6 +93,7 @@ Tensor Adam::step(LossClosure closure)  {
     loss = closure();
   }
   for (auto& group : param_groups_) {
+    std::map<int64_t, FusedAdamBatch> fused_batches;
     for (auto& p : group.params()) {
       if (!p.grad().defined()) {
         continue;
@@ -107,6 +124,17 @@ Tensor Adam::step(LossClosure closure)  {
       auto& max_exp_avg_sq = state.max_exp_avg_sq();
 
       state.step(state.step()+1);
+      if (options.fused()) {
+        auto& batch = fused_batches[state.step()];
+        batch.params.push_back(p);
+        batch.grads.push_back(grad);
+        batch.exp_avgs.push_back(exp_avg);
+        batch.exp_avg_sqs.push_back(exp_avg_sq);
+        if (options.amsgrad()) {
+          batch.max_exp_avg_sqs.push_back(max_exp_avg_sq);
+        }
+        continue;
+      }
       auto beta1 = std::get<0>(options.betas());
       auto beta2 = std::get<1>(options.betas());
 
@@ -134,6 +162,17 @@ Tensor Adam::step(LossClosure closure)  {
       auto step_size = options.lr() / bias_correction1;
       p.addcdiv_(exp_avg, denom, -step_size);
     }
+
+    auto& options = static_cast<AdamOptions&>(group.options());
+    for (auto& step_and_batch : fused_batches) {
+      auto& batch = step_and_batch.second;
+      torch::_fused_adam_(
+          batch.params, batch.grads, batch.exp_avgs, batch.exp_avg_sqs,
+          batch.max_exp_avg_sqs, options.lr(), std::get<0>(options.betas()),
+          std::get<1>(options.betas()), options.weight_decay(), options.eps(),
+          options.amsgrad(), /*decoupled_weight_decay=*/false,
+          step_and_batch.first);
+    }
   }
   return loss;
 }
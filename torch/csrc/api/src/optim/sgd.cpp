@@ -21,7 +21,8 @@ bool operator==(const SGDOptions& lhs, const SGDOptions& rhs) {
           (lhs.momentum() == rhs.momentum()) &&
           (lhs.dampening() == rhs.dampening()) &&
           (lhs.weight_decay() == rhs.weight_decay()) &&
-          (lhs.nesterov() == rhs.nesterov());
+          (lhs.nesterov() == rhs.nesterov()) &&
+          (lhs.fused() == rhs.fused());
 }
 
 void SGDOptions::serialize(torch::serialize::OutputArchive& archive) const {
@@ -30,6 +31,7 @@ void SGDOptions::serialize(torch::serialize::OutputArchive& archive) const {
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(dampening);
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(weight_decay);
   _TORCH_OPTIM_SERIALIZE_TORCH_ARG(nesterov);
+  _TORCH_OPTIM_SERIALIZE_TORCH_ARG(fused);
 }
 
 void SGDOptions::serialize(torch::serialize::InputArchive& archive) {
@@ -38,6 +40,7 @@ void SGDOptions::serialize(torch::serialize::InputArchive& archive) {
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(double, dampening);
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(double, weight_decay);
   _TORCH_OPTIM_DESERIALIZE_TORCH_ARG(bool, nesterov);
+  _TORCH_OPTIM_DESERIALIZE_TORCH_ARG_IF_EXISTS(bool, fused);
 }
 
 double SGDOptions::get_lr() const {
@@ -74,6 +77,10 @@ Tensor SGD::step(LossClosure closure)  {
     auto dampening = options.dampening();
     auto nesterov = options.nesterov();
 
+    if (options.fused()) {
+      fused_step(group);
+      continue;
+    }
     for (auto& p : group.params()) {
       if (!p.grad().defined()) {
         continue;
@@ -106,6 +113,45 @@ Tensor SGD::step(LossClosure closure)  {
   return loss;
 }
 
+void SGD::fused_step(OptimizerParamGroup& group) {
+  auto& options = static_cast<SGDOptions&>(group.options());
+  // The momentum buffers of the parameters at their first step are allocated
+  // here and written by the kernel, so those are stepped by a separate call
+  std::vector<Tensor> params[2], grads[2], momentum_buffers[2];
+  for (auto& p : group.params()) {
+    if (!p.grad().defined()) {
+      continue;
+    }
+    bool is_first_step = false;
+    if (options.momentum() != 0) {
+      auto param_state = state_.find(c10::guts::to_string(p.unsafeGetTensorImpl()));
+      Tensor buf;
+      if (param_state == state_.end()) {
+        is_first_step = true;
+        buf = torch::empty_like(p, MemoryFormat::Preserve);
+        auto state = std::make_unique<SGDParamState>();
+        state->momentum_buffer(buf);
+        state_[c10::guts::to_string(p.unsafeGetTensorImpl())] = std::move(state);
+      } else {
+        buf = static_cast<SGDParamState&>(*param_state->second).momentum_buffer();
+      }
+      momentum_buffers[is_first_step].push_back(buf);
+    }
+    params[is_first_step].push_back(p);
+    grads[is_first_step].push_back(p.grad());
+  }
+  for (int is_first_step = 0; is_first_step < 2; is_first_step++) {
+    if (params[is_first_step].empty()) {
+      continue;
+    }
+    torch::_fused_sgd_(
+        params[is_first_step], grads[is_first_step],
+        momentum_buffers[is_first_step], options.lr(), options.momentum(),
+        options.dampening(), options.weight_decay(), options.nesterov(),
+        is_first_step);
+  }
+}
+
 void SGD::save(serialize::OutputArchive& archive) const {
   serialize(*this, archive);
 }
@@ -726,6 +726,37 @@ Tensor mm_mat2_backward(const Tensor & grad, const Tensor & mat1, IntArrayRef si
   }
 }
 
+std::tuple<Tensor, Tensor, Tensor> addmm_activation_backward(
+    const Tensor& grad,
+    const Tensor& self,
+    const Tensor& mat1,
+    const Tensor& mat2,
+    const Scalar& beta,
+    const Scalar& alpha,
+    bool use_gelu,
+    const Tensor& result,
+    std::array<bool, 3> grad_input_mask) {
+  if (!grad.defined()) {
+    return std::tuple<Tensor, Tensor, Tensor>();
+  }
+  // The gradient before the activation: relu's follows from the result, while
+  // gelu's needs the input of the activation, which is recomputed
+  const Tensor grad_pre = use_gelu
+      ? at::gelu_backward(grad, at::addmm(self, mat1, mat2, beta, alpha))
+      : at::threshold_backward(grad, result, 0);
+  Tensor grad_self, grad_mat1, grad_mat2;
+  if (grad_input_mask[0]) {
+    grad_self = maybe_multiply(grad_pre, beta.conj());
+  }
+  if (grad_input_mask[1]) {
+    grad_mat1 = mm_mat1_backward(grad_pre, mat2, mat1.sizes(), mat1.strides(), alpha);
+  }
+  if (grad_input_mask[2]) {
+    grad_mat2 = mm_mat2_backward(grad_pre, mat1, mat2.sizes(), mat2.strides(), alpha);
+  }
+  return std::make_tuple(grad_self, grad_mat1, grad_mat2);
+}
+
 Tensor _sparse_addmm_sparse_backward(const Tensor& grad, const Tensor& sparse_, const Tensor& dense, const Scalar& alpha) {
   AT_ASSERT(sparse_.is_sparse());
   auto sparse = sparse_.coalesce();
@@ -1,5 +1,7 @@
 #include <torch/csrc/autograd/variable.h>
 
+#include <ATen/BatchedTensorImpl.h>
+
 namespace torch {
 namespace autograd {
 
@@ -123,11 +125,17 @@ void AutogradMeta::set_fw_grad(const Variable& new_grad_, const Variable& self,
     // TODO(alband) remove this spurious version counter bump
     auto new_grad = new_grad_;
 
-    TORCH_CHECK(self.is_same_size(new_grad_), "Trying to set a forward gradient that has a different size than that "
+    // A tangent batched by vmap has the logical sizes of self, see
+    // torch.autograd.functional.batched_jvp.
+    const bool is_batched = at::isBatchedTensor(new_grad_);
+
+    TORCH_CHECK(self.sizes().equals(new_grad_.sizes()), "Trying to set a forward gradient that has a different size than that "
                 "of the original Tensor, this is not supported. Tensor is of size ", self.sizes(), " while the given "
                 "forward gradient is of size ", new_grad_.sizes(), ".");
 
     if (is_inplace_op && is_view_) {
+      TORCH_CHECK(!is_batched, "Inplace operations on views are not supported with batched forward "
+                  "gradients. Make the dual Tensor from a Tensor that is not a view or use an out-of-place operation.");
       auto this_view_meta = static_cast<DifferentiableViewMeta*>(this);
 
       // For inplace ops on a Tensor that does not already have a forward grad and is a view, we propagate
@@ -171,7 +179,8 @@ void AutogradMeta::set_fw_grad(const Variable& new_grad_, const Variable& self,
     }
 
     // Enforce the basic layout constraint
-    if (!has_same_meta(new_grad, self)) {
+    // A batched tangent has no strides and stays as vmap laid it out
+    if (!is_batched && !has_same_meta(new_grad, self)) {
       Tensor new_grad_with_meta = new_with_same_meta(self);
       new_grad_with_meta.copy_(new_grad);
       new_grad = new_grad_with_meta;
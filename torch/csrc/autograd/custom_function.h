@@ -163,6 +163,7 @@ struct CppNode : public Node {
   std::vector<VariableInfo> output_info_;
 
   void release_variables() override;
+  void prefetch_variables() override;
 
   void set_ctx_grad_fn(const std::shared_ptr<Node> &node);
   void save_variables_to_ctx();
@@ -349,6 +350,14 @@ void CppNode<T>::release_variables() {
   ctx_.has_freed_buffers_ = true;
 }
 
+template<class T>
+void CppNode<T>::prefetch_variables() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& var : ctx_.saved_variables_) {
+    var.prefetch();
+  }
+}
+
 template<class T>
 void CppNode<T>::save_variables_to_ctx() {
   ctx_.save_variables();
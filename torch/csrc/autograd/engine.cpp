@@ -2,13 +2,16 @@
 
 #include <torch/csrc/autograd/autograd.h>
 #include <torch/csrc/autograd/function.h>
+#include <torch/csrc/autograd/functions/accumulate_grad.h>
 #include <torch/csrc/autograd/functions/basic_ops.h>
 #include <torch/csrc/autograd/grad_mode.h>
 #include <torch/csrc/autograd/anomaly_mode.h>
+#include <torch/csrc/autograd/saved_variable.h>
 #include <torch/csrc/autograd/variable.h>
 #include <torch/csrc/utils/memory.h>
 
 #include <ATen/DeviceGuard.h>
+#include <ATen/detail/CUDAHooksInterface.h>
 #include <ATen/ExpandUtils.h>
 #include <ATen/Parallel.h>
 #include <c10/util/Exception.h>
@@ -16,6 +19,7 @@
 #include <c10/core/Event.h>
 #include <c10/core/DeviceGuard.h>
 #include <c10/util/Optional.h>
+#include <c10/util/SmallVector.h>
 #include <c10/core/StreamGuard.h>
 
 #include <atomic>
@@ -98,6 +102,9 @@ static thread_local std::shared_ptr<GraphTask> current_graph_task = nullptr;
 // see Note [Reentrant backwards] for more details.
 static thread_local std::shared_ptr<ReadyQueue> local_ready_queue = nullptr;
 
+// True on the CPU worker threads, see Note [Parallel CPU backward]
+static thread_local bool is_cpu_worker = false;
+
 // Note [Reentrant backwards]
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~
 // To understand the reentrant backwards problem, we have to notice two
@@ -151,11 +158,38 @@ static thread_local std::shared_ptr<ReadyQueue> local_ready_queue = nullptr;
 // the default streams after backward() was sufficient to ensure
 // that backward() had finished running. To preserve this historic
 // behavior the engine records "leaf streams," the streams of the
-// leaf variables, and syncs them with their device's default stream
-// at the end of backward. All other streams are already synchronized
+// leaf variables, and syncs them with the current streams of the thread
+// that called backward(), as they were when backward() was called, at
+// the end of backward. All other streams are already synchronized
 // to happen before at least one leaf stream (per the above), so syncing
-// the leaf streams with the default streams is sufficient to implement
-// the historic behavior.
+// the leaf streams with the caller's current streams is sufficient to
+// implement the historic behavior, and also makes backward() ordered
+// before whatever the caller does next on its streams. In particular,
+// a backward pass launched while a side stream is being captured into a
+// CUDA graph stays within the capture, where syncing with the default
+// stream would be illegal. Devices without a primary context when
+// backward() is called fall back to their default stream.
+
+// Note [Parallel CPU backward]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// By default the thread that calls backward() runs all the CPU NodeTasks of
+// its graph task one at a time, even when independent branches of the graph
+// (e.g. the towers of a multi-branch model) could run concurrently.
+//
+// When set_num_cpu_worker_threads(n) is called with n > 0, non-reentrant
+// graph tasks push their CPU NodeTasks to cpu_worker_queue_ instead, which is
+// shared by n long running CPU worker threads. A NodeTask is only pushed once
+// all its dependencies are done (as computed by compute_dependencies), so
+// whatever the workers pop can run right away. Accumulating gradients into the
+// InputBuffers of not_ready_ is already done under GraphTask::mutex_, so
+// nothing else needs to be locked. The calling thread just waits for the
+// dummy task the worker completing the graph task sends to its
+// cpu_ready_queue_.
+//
+// Each worker keeps a local_ready_queue of its own, so a reentrant backward
+// call made from a worker is driven by that worker alone, as on any other CPU
+// thread. Workers are started on first use and are never stopped, like the
+// threads of Note [Reentrant backwards].
 
 int NodeTask::getReentrantDepth() const {
   std::shared_ptr<GraphTask> graph_task = base_.lock();
@@ -221,7 +255,13 @@ bool ReadyQueue::empty() const {
   return heap_.empty();
 }
 
-Engine::Engine() : max_recursion_depth_(MAX_DEPTH), non_reentrant_device_thread_count_(0) {}
+Engine::Engine()
+    : max_recursion_depth_(MAX_DEPTH),
+      cpu_worker_queue_(std::make_shared<ReadyQueue>()),
+      num_cpu_worker_threads_(0),
+      num_started_cpu_worker_threads_(0),
+      sequential_cpu_backward_enabled_(false),
+      non_reentrant_device_thread_count_(0) {}
 
 // Send shutdown tasks to all device_ready_queues_ if no backward tasks are running
 // Even though readyQueue should be empty, shutdown tasks have the highest priority
@@ -328,6 +368,10 @@ void GraphTaskGuard::restore_current_graph_task() {
   current_graph_task = std::move(last_graph_task_);
 }
 
+std::shared_ptr<GraphTask> get_current_graph_task() {
+  return current_graph_task;
+}
+
 // NOTE: graph_tasks do not necessarily form a stack. Imagine this
 // case:
 //
@@ -367,6 +411,11 @@ auto Engine::thread_main(const std::shared_ptr<GraphTask>& graph_task) -> void {
 
   // local_ready_queue should already been initialized when we get into thread_main
   TORCH_INTERNAL_ASSERT(local_ready_queue != nullptr);
+  // CPU workers take their tasks from the queue they share, but drive their
+  // reentrant backward calls from their own one
+  const auto& queue = (graph_task == nullptr && is_cpu_worker)
+      ? cpu_worker_queue_
+      : local_ready_queue;
   while (graph_task == nullptr || !graph_task->future_result_->completed()) {
     // local_graph_task represents the graph_task we retrieve from the queue.
     // The outer graph_task represents the overall graph_task we need to execute
@@ -376,7 +425,7 @@ auto Engine::thread_main(const std::shared_ptr<GraphTask>& graph_task) -> void {
       // Scope this block of execution since NodeTask is not needed after this
       // block and can be deallocated (release any references to grad tensors
       // as part of inputs_).
-      NodeTask task = local_ready_queue->pop();
+      NodeTask task = queue->pop();
       // This will only work if the worker is running a non backward task
       // TODO Needs to be fixed this to work in all cases
       if (task.isShutdownTask_) {
@@ -399,7 +448,7 @@ auto Engine::thread_main(const std::shared_ptr<GraphTask>& graph_task) -> void {
           // callbacks.
           GraphTaskGuard guard(local_graph_task);
           NodeGuard ndguard(task.fn_);
-          evaluate_function(local_graph_task, task.fn_.get(), task.inputs_, local_graph_task->cpu_ready_queue_);
+          evaluate_function(local_graph_task, task.fn_.get(), task.inputs_, local_graph_task->cpu_task_queue());
         } catch (std::exception& e) {
           thread_on_exception(local_graph_task, task.fn_, e);
         }
@@ -421,8 +470,10 @@ auto Engine::thread_main(const std::shared_ptr<GraphTask>& graph_task) -> void {
       // If it has work, it might see that graph_task->outstanding_tasks_ == 0
       // before it gets to the task, but it's a no-op anyway.
       //
-      // NB: This is not necessary if the current thread is the owning thread.
-      if (worker_device != base_owner) {
+      // NB: This is not necessary if the current thread is the owning thread,
+      // which a CPU worker never is for a graph task of another thread.
+      if (worker_device != base_owner ||
+          local_ready_queue != local_graph_task->cpu_ready_queue_) {
         // Synchronize outstanding_tasks_ with queue mutex
         std::atomic_thread_fence(std::memory_order_release);
         ready_queue_by_index(local_graph_task->cpu_ready_queue_, base_owner)
@@ -505,6 +556,11 @@ void GraphTask::exec_post_processing() {
     throw std::runtime_error("could not compute gradients for some functions");
   }
 
+  // The grads are complete by the time final callbacks run
+  if (!deferred_grads_.empty()) {
+    AccumulateGrad::accumulate_grouped(std::move(deferred_grads_));
+  }
+
   // set the thread_local current_graph_task_ as more callbacks can be installed
   // by existing final callbacks.
   GraphTaskGuard guard(shared_from_this());
@@ -522,15 +578,41 @@ void GraphTask::exec_post_processing() {
     cb_lock.lock();
   }
 
-  // Syncs leaf streams with default streams (if necessary)
+  // Syncs leaf streams with the caller's current streams (if necessary)
   // See note "Streaming backwards"
   for (const auto& leaf_stream : leaf_streams) {
     const auto guard = c10::impl::VirtualGuardImpl{c10::DeviceType::CUDA};
-    const auto default_stream = guard.getDefaultStream(leaf_stream.device());
-    if (leaf_stream != default_stream) {
+    const auto idx = leaf_stream.device_index();
+    const auto& caller_stream =
+        static_cast<size_t>(idx) < caller_current_streams_.size()
+        ? caller_current_streams_[idx]
+        : c10::nullopt;
+    const auto sync_stream = caller_stream.has_value()
+        ? *caller_stream
+        : guard.getDefaultStream(leaf_stream.device());
+    if (leaf_stream != sync_stream) {
       auto event = c10::Event{c10::DeviceType::CUDA};
       event.record(leaf_stream);
-      default_stream.wait(event);
+      sync_stream.wait(event);
+    }
+  }
+}
+
+void GraphTask::stash_current_streams() {
+  if (!c10::impl::hasDeviceGuardImpl(c10::DeviceType::CUDA)) {
+    return;
+  }
+  const auto guard = c10::impl::VirtualGuardImpl{c10::DeviceType::CUDA};
+  const auto num_devices = guard.deviceCount();
+  caller_current_streams_.resize(num_devices);
+  for (c10::DeviceIndex idx = 0; idx < num_devices; idx++) {
+    // Querying the current stream of a device without a primary context
+    // would create one, and its current stream is the default stream anyway
+    if (at::detail::getCUDAHooks().hasPrimaryContext(idx)) {
+      caller_current_streams_[idx] =
+          guard.getStream({c10::DeviceType::CUDA, idx});
+    } else {
+      caller_current_streams_[idx] = c10::nullopt;
     }
   }
 }
@@ -739,6 +821,16 @@ void Engine::evaluate_function(
   const auto opt_parent_stream = (*func).stream(c10::DeviceType::CUDA);
   c10::OptionalStreamGuard parent_stream_guard{opt_parent_stream};
 
+  // Overlaps bringing back the offloaded saved variables of the functions
+  // that run next with this one, see Note [Saved variable offloading]
+  if (SavedVariableOffload::threshold() >= 0) {
+    for (const auto& next : func->next_edges()) {
+      if (next.function) {
+        next.function->prefetch_variables();
+      }
+    }
+  }
+
   auto outputs = call_function(graph_task, func, inputs);
 
   auto& fn = *func;
@@ -770,8 +862,14 @@ void Engine::evaluate_function(
     }
   }
 
+  // The tasks made ready by this function are only pushed once mutex_ is
+  // released, so that the threads waiting on the ready queues do not wake up
+  // to contend for it. The current task is still outstanding, so the graph
+  // task cannot complete in between.
+  c10::SmallVector<std::pair<std::shared_ptr<ReadyQueue>, NodeTask>, 4> ready;
+
   // Lock mutex for the accesses to GraphTask dependencies_, not_ready_ and cpu_ready_queue_ below
-  std::lock_guard<std::mutex> lock(graph_task->mutex_);
+  std::unique_lock<std::mutex> lock(graph_task->mutex_);
   for (int i = 0; i < num_outputs; ++i) {
     auto& output = outputs[i];
     const auto& next = fn.next_edge(i);
@@ -813,7 +911,8 @@ void Engine::evaluate_function(
 
       if (is_ready) {
         auto queue = ready_queue(cpu_ready_queue, input_buffer.device());
-        queue->push(
+        ready.emplace_back(
+            std::move(queue),
             NodeTask(graph_task, next.function, std::move(input_buffer)));
       } else {
         not_ready.emplace(next.function.get(), std::move(input_buffer));
@@ -830,12 +929,18 @@ void Engine::evaluate_function(
                        opt_next_stream);
       if (is_ready) {
         auto queue = ready_queue(cpu_ready_queue, input_buffer.device());
-        queue->push(
+        ready.emplace_back(
+            std::move(queue),
             NodeTask(graph_task, next.function, std::move(input_buffer)));
         not_ready.erase(not_ready_it);
       }
     }
   }
+  lock.unlock();
+
+  for (auto& queue_and_task : ready) {
+    queue_and_task.first->push(std::move(queue_and_task.second));
+  }
 }
 
 inline static uint64_t compute_min_topological_nr(const edge_list& outputs) {
@@ -853,7 +958,6 @@ inline static uint64_t compute_min_topological_nr(const edge_list& outputs) {
 
 auto Engine::compute_dependencies(Node* root, GraphTask& task, uint64_t min_topo_nr) -> void {
   // Computes the number of dependencies for each function which requires grad
-  std::unordered_set<Node*> seen;
   std::vector<Node*> queue { root };
 
   // Queue contains all nodes that will start propagating gradients.
@@ -866,12 +970,153 @@ auto Engine::compute_dependencies(Node* root, GraphTask& task, uint64_t min_topo
     }
     for (const auto& edge : fn->next_edges()) {
       if (auto next_ptr = edge.function.get()) {
-        dependencies[next_ptr] += 1;
-        const bool was_inserted = seen.insert(next_ptr).second;
-        if (was_inserted) queue.push_back(next_ptr);
+        // A function is seen for the first time when it gets its first
+        // dependency, so no separate set of seen functions is needed
+        if (++dependencies[next_ptr] == 1) queue.push_back(next_ptr);
+      }
+    }
+  }
+  // At most every function with a dependency waits for its inputs at once,
+  // so neither map rehashes while the graph runs
+  task.not_ready_.reserve(dependencies.size());
+}
+
+// Note [Sequential CPU backward]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Training steps of a model whose structure does not change rebuild the same
+// backward graph every step, and for small CPU models (e.g. RL policies) the
+// bookkeeping of the engine costs more than the nodes themselves: hash map
+// lookups for the dependencies and InputBuffers of every edge, GraphTask::mutex_
+// and a ReadyQueue push and pop per node.
+//
+// When enabled, a plain backward() call (no inputs, not reentrant, no anomaly
+// mode) of a graph whose nodes all take CPU inputs is flattened instead: one
+// walk numbers the nodes and records, per next edge, the number of its target,
+// so dependency counts and input buffers live in flat arrays. The nodes then
+// run on the calling thread in the same order the engine would pick (highest
+// sequence_nr first among the ready ones), without locks or ready queues.
+// Since the graph is rebuilt every step, the walk has to happen every time
+// anyway; it replaces compute_dependencies. Reentrant backward calls made by
+// the nodes go through the engine as usual.
+namespace {
+
+struct FlatGraph {
+  // nodes[0] is the graph root
+  std::vector<std::shared_ptr<Node>> nodes;
+  std::vector<int> dependencies;
+  // The next edges of nodes[i] go to the nodes at
+  // next_nodes[next_offsets[i]] to next_nodes[next_offsets[i + 1]], -1 for
+  // invalid edges
+  std::vector<size_t> next_offsets;
+  std::vector<int64_t> next_nodes;
+};
+
+bool takes_cpu_inputs(const Node& fn) {
+  for (size_t i = 0; i < fn.num_inputs(); ++i) {
+    if (fn.input_metadata(i).device().type() != at::kCPU) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns nullopt if some node of the graph is not on CPU
+c10::optional<FlatGraph> flatten_cpu_graph(std::shared_ptr<Node> root) {
+  FlatGraph graph;
+  std::unordered_map<Node*, int64_t> indices{{root.get(), 0}};
+  graph.nodes.push_back(std::move(root));
+  graph.dependencies.push_back(0);
+  for (size_t i = 0; i < graph.nodes.size(); ++i) {
+    const auto& fn = *graph.nodes[i];
+    if (!takes_cpu_inputs(fn)) {
+      return c10::nullopt;
+    }
+    graph.next_offsets.push_back(graph.next_nodes.size());
+    for (const auto& edge : fn.next_edges()) {
+      if (!edge.is_valid()) {
+        graph.next_nodes.push_back(-1);
+        continue;
+      }
+      auto it = indices.emplace(edge.function.get(), graph.nodes.size());
+      if (it.second) {
+        graph.nodes.push_back(edge.function);
+        graph.dependencies.push_back(0);
       }
+      ++graph.dependencies[it.first->second];
+      graph.next_nodes.push_back(it.first->second);
     }
   }
+  graph.next_offsets.push_back(graph.next_nodes.size());
+  return graph;
+}
+
+void execute_flat_graph(
+    Engine& engine,
+    std::shared_ptr<GraphTask>& graph_task,
+    FlatGraph& graph,
+    InputBuffer&& input_buffer) {
+  engine.initialize_device_threads_pool();
+  // Reentrant backward calls made by the nodes are detected as such
+  set_device(CPU_DEVICE);
+  graph_task->owner_ = worker_device;
+
+  std::vector<InputBuffer> buffers;
+  buffers.reserve(graph.nodes.size());
+  buffers.push_back(std::move(input_buffer));
+  for (size_t i = 1; i < graph.nodes.size(); ++i) {
+    buffers.emplace_back(graph.nodes[i]->num_inputs());
+  }
+
+  // Same order as CompareNodeTaskTime within one graph task
+  std::priority_queue<std::pair<uint64_t, int64_t>> ready;
+  ready.emplace(graph.nodes[0]->sequence_nr(), 0);
+  {
+    GraphTaskGuard guard(graph_task);
+    AutoGradMode grad_mode(graph_task->grad_mode_);
+    while (!ready.empty()) {
+      const auto index = ready.top().second;
+      ready.pop();
+      const auto& fn = graph.nodes[index];
+      try {
+        NodeGuard ndguard(fn);
+        auto outputs = call_function(graph_task, fn.get(), buffers[index]);
+        if (!graph_task->keep_graph_) {
+          fn->release_variables();
+        }
+        const auto offset = graph.next_offsets[index];
+        for (size_t i = 0; i < outputs.size(); ++i) {
+          const auto next = graph.next_nodes[offset + i];
+          if (next < 0) continue;
+          buffers[next].add(
+              fn->next_edge(i).input_nr,
+              std::move(outputs[i]),
+              c10::nullopt,
+              c10::nullopt);
+          if (--graph.dependencies[next] == 0) {
+            ready.emplace(graph.nodes[next]->sequence_nr(), next);
+          }
+        }
+      } catch (std::exception& e) {
+        engine.thread_on_exception(graph_task, fn, e);
+        break;
+      }
+    }
+  }
+  worker_device = NO_DEVICE;
+
+  if (!graph_task->has_error_.load()) {
+    graph_task->mark_as_completed_and_run_post_processing();
+  }
+}
+
+} // namespace
+
+void Engine::set_sequential_cpu_backward_enabled(bool enabled) {
+  sequential_cpu_backward_enabled_.store(enabled);
+}
+
+bool Engine::is_sequential_cpu_backward_enabled() const {
+  return sequential_cpu_backward_enabled_.load();
 }
 
 auto Engine::execute(const edge_list& roots,
@@ -898,15 +1143,35 @@ auto Engine::execute(const edge_list& roots,
       /* depth */ not_reentrant_backward_call ? 0 : total_depth + 1,
       /* cpu_ready_queue */ local_ready_queue);
 
+  // See Note [Parallel CPU backward]
+  const int num_cpu_workers = num_cpu_worker_threads_.load();
+  if (not_reentrant_backward_call && num_cpu_workers > 0) {
+    start_cpu_worker_threads(num_cpu_workers);
+    graph_task->cpu_worker_queue_ = cpu_worker_queue_;
+  }
+
   // If we receive a single root, skip creating extra root node
   bool skip_dummy_node = roots.size() == 1;
   auto graph_root = skip_dummy_node ?
     roots.at(0).function :
     std::make_shared<GraphRoot>(roots, inputs);
 
+  // See Note [Sequential CPU backward]
+  c10::optional<FlatGraph> flat_graph;
+  if (not_reentrant_backward_call && outputs.empty() &&
+      sequential_cpu_backward_enabled_.load() &&
+      num_cpu_worker_threads_.load() == 0 && !AnomalyMode::is_enabled()) {
+    flat_graph = flatten_cpu_graph(graph_root);
+  }
+
   auto min_topo_nr = compute_min_topological_nr(outputs);
   // Now compute the dependencies for all executable functions
-  compute_dependencies(graph_root.get(), *graph_task, min_topo_nr);
+  if (!flat_graph) {
+    compute_dependencies(graph_root.get(), *graph_task, min_topo_nr);
+  }
+
+  // See Note [Streaming backwards]
+  graph_task->stash_current_streams();
 
   if (!outputs.empty()) {
     graph_task->init_to_execute(*graph_root, outputs, accumulate_grad, min_topo_nr);
@@ -924,7 +1189,13 @@ auto Engine::execute(const edge_list& roots,
                       input_stream,
                       opt_next_stream);
 
-    execute_with_graph_task(graph_task, graph_root, std::move(input_buffer));
+    if (flat_graph) {
+      execute_flat_graph(*this, graph_task, *flat_graph, std::move(input_buffer));
+    } else {
+      execute_with_graph_task(graph_task, graph_root, std::move(input_buffer));
+    }
+  } else if (flat_graph) {
+    execute_flat_graph(*this, graph_task, *flat_graph, InputBuffer(variable_list()));
   } else {
     execute_with_graph_task(graph_task, graph_root, InputBuffer(variable_list()));
   }
@@ -952,7 +1223,7 @@ std::shared_ptr<at::ivalue::Future> Engine::execute_with_graph_task(
   // Lock mutex for GraphTask.
   std::unique_lock<std::mutex> lock(graph_task->mutex_);
 
-  auto queue = ready_queue(graph_task->cpu_ready_queue_, input_buffer.device());
+  auto queue = ready_queue(graph_task->cpu_task_queue(), input_buffer.device());
 
   // worker_device == NO_DEVICE it's a CPU thread and it's trying to drive the
   // autograd engine with corresponding GraphTask, and its NOT a re-entrant call
@@ -1129,6 +1400,30 @@ auto Engine::start_device_threads() -> void {
   }
 }
 
+void Engine::set_num_cpu_worker_threads(int num_threads) {
+  TORCH_CHECK(
+      num_threads >= 0,
+      "Number of CPU worker threads must be non-negative, got ",
+      num_threads);
+  num_cpu_worker_threads_.store(num_threads);
+}
+
+int Engine::num_cpu_worker_threads() const {
+  return num_cpu_worker_threads_.load();
+}
+
+void Engine::start_cpu_worker_threads(int num_threads) {
+  std::lock_guard<std::mutex> lock(cpu_worker_threads_mutex_);
+  for (; num_started_cpu_worker_threads_ < num_threads;
+       ++num_started_cpu_worker_threads_) {
+    std::thread t([this] {
+      is_cpu_worker = true;
+      thread_init(CPU_DEVICE, std::make_shared<ReadyQueue>(), false);
+    });
+    t.detach();
+  }
+}
+
 void Engine::add_thread_pool_task(const std::weak_ptr<GraphTask>& graph_task) {
   std::unique_lock<std::mutex> lck(thread_pool_shared_->mutex_);
   // There may already be some items on the graphtasks_queue_ added by other
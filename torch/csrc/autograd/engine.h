@@ -57,7 +57,8 @@ struct GraphTask: std::enable_shared_from_this<GraphTask> {
   bool grad_mode_;
 
   // To protect reads/writes to not_ready_, dependencies_, captured_vars_,
-  // has_error_, future_result_, cpu_ready_queue_, and leaf_streams.
+  // has_error_, future_result_, cpu_ready_queue_, leaf_streams and
+  // deferred_grads_.
   std::mutex mutex_;
   std::unordered_map<Node*, InputBuffer> not_ready_;
   std::unordered_map<Node*, int> dependencies_;
@@ -112,6 +113,18 @@ struct GraphTask: std::enable_shared_from_this<GraphTask> {
 
   std::unordered_set<c10::Stream> leaf_streams;
 
+  // Per-device current streams of the execute() call that launched this
+  // GraphTask, nullopt for devices without a primary context. The leaf streams
+  // are synced with these, see Note [Streaming backwards]
+  std::vector<c10::optional<c10::Stream>> caller_current_streams_;
+
+  // Collects caller_current_streams_
+  void stash_current_streams();
+
+  // AccumulateGrad nodes and the gradients whose accumulation is deferred to
+  // the post processing. See Note [Grouped gradient accumulation]
+  std::vector<std::pair<std::shared_ptr<Node>, at::Tensor>> deferred_grads_;
+
   void init_to_execute(Node& graph_root, const edge_list& outputs, bool accumulate_grad, uint64_t min_topo_nr);
 
   // The value of worker_device in the thread that created this task.
@@ -152,6 +165,15 @@ struct GraphTask: std::enable_shared_from_this<GraphTask> {
   // and but next NodeTask should be run on CPU.
   std::shared_ptr<ReadyQueue> cpu_ready_queue_;
 
+  // Queue of the engine's CPU worker threads if they run the CPU NodeTasks of
+  // this graph task, nullptr otherwise. See Note [Parallel CPU backward]
+  std::shared_ptr<ReadyQueue> cpu_worker_queue_;
+
+  // The ready queue CPU NodeTasks of this graph task are pushed to
+  const std::shared_ptr<ReadyQueue>& cpu_task_queue() const {
+    return cpu_worker_queue_ ? cpu_worker_queue_ : cpu_ready_queue_;
+  }
+
   // Future representing the completion of the graph task. Notified when all
   // tasks are done.
   std::shared_ptr<at::ivalue::Future> future_result_;
@@ -180,6 +202,9 @@ struct GraphTask: std::enable_shared_from_this<GraphTask> {
   void exec_post_processing();
 };
 
+// The GraphTask the current thread runs a node of, nullptr if none
+TORCH_API std::shared_ptr<GraphTask> get_current_graph_task();
+
 // The guard that sets and restores current_graph_task.
 class GraphTaskGuard {
  public:
@@ -324,6 +349,18 @@ struct TORCH_API Engine {
   // Should be called after fork to notify that worker threads are gone
   void release_workers();
 
+  // Runs the CPU NodeTasks of non-reentrant backward calls on num_threads
+  // worker threads instead of the calling thread, 0 disables it.
+  // See Note [Parallel CPU backward]
+  void set_num_cpu_worker_threads(int num_threads);
+  int num_cpu_worker_threads() const;
+
+  // Runs the backward() calls of graphs that are entirely on CPU on the
+  // calling thread without going through the ready queues.
+  // See Note [Sequential CPU backward]
+  void set_sequential_cpu_backward_enabled(bool enabled);
+  bool is_sequential_cpu_backward_enabled() const;
+
   // Initializes a device thread for the autograd engine.
   virtual void thread_init(
       int device,
@@ -353,6 +390,8 @@ struct TORCH_API Engine {
   virtual void thread_main(const std::shared_ptr<GraphTask>& task);
   void reentrant_thread_init();
   void add_thread_pool_task(const std::weak_ptr<GraphTask>& graph_task);
+  // Starts the CPU worker threads that are not running yet
+  void start_cpu_worker_threads(int num_threads);
 
   // Ensures device_ready_queues_ are initialized only once
   std::once_flag start_device_threads_flag_;
@@ -366,6 +405,15 @@ struct TORCH_API Engine {
   // How many nested reentrant calls are allowed until a new thread is used
   int max_recursion_depth_;
 
+  // Shared by all CPU worker threads, see Note [Parallel CPU backward]
+  std::shared_ptr<ReadyQueue> cpu_worker_queue_;
+  std::atomic<int> num_cpu_worker_threads_;
+  // To protect num_started_cpu_worker_threads_
+  std::mutex cpu_worker_threads_mutex_;
+  int num_started_cpu_worker_threads_;
+
+  std::atomic<bool> sequential_cpu_backward_enabled_;
+
   struct ThreadPoolShared {
     // Data structures used by the threads for executing reentrant backwards
     // tasks. See Note [Reentrant backwards]
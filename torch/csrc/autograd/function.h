@@ -435,6 +435,11 @@ struct TORCH_API Node : std::enable_shared_from_this<Node> {
   /// release variables as they run.
   virtual void will_release_variables() {}
 
+  /// Starts bringing saved variables offloaded to host memory back to their
+  /// device, called before the functions preceding this one in the backward
+  /// run. See Note [Saved variable offloading] in saved_variable.cpp.
+  virtual void prefetch_variables() {}
+
   /// Returns true if this function is traceable. An op is traceable if all
   /// operations happening within `apply()` are performed on autograd
   /// `Variables` (i.e. apply mostly instantiates and applies other functions).
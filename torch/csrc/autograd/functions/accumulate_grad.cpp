@@ -1,11 +1,17 @@
 #include <torch/csrc/autograd/functions/accumulate_grad.h>
 
+#include <torch/csrc/autograd/engine.h>
 #include <torch/csrc/autograd/grad_mode.h>
 #include <torch/csrc/autograd/variable.h>
 #include <torch/csrc/autograd/functions/basic_ops.h>
 #include <torch/csrc/autograd/functions/tensor.h>
 #include <torch/csrc/autograd/functions/utils.h>
 
+#include <ATen/ATen.h>
+#include <c10/core/StreamGuard.h>
+
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <stdexcept>
 #include <utility>
@@ -14,6 +20,86 @@ using at::Tensor;
 
 namespace torch { namespace autograd {
 
+// Note [Grouped gradient accumulation]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Every AccumulateGrad node adds its gradient to the grad of its parameter
+// with its own add_ kernel, so models with thousands of small parameters
+// (biases, norms) end their backward pass with thousands of tiny launches.
+//
+// When grouped accumulation is enabled, the in place accumulations into
+// dense CUDA grads are instead stashed in GraphTask::deferred_grads_, and
+// done by accumulate_grouped in the post processing of the graph task, before
+// the final callbacks run, with one _foreach_add_ per stream, device and
+// dtype. Nodes with post hooks (e.g. DDP's) still accumulate right away,
+// since the hooks expect the grad to be updated. Other hooks that read the
+// grads during the backward pass see them before the accumulation.
+static std::atomic<bool> grouped_accumulation_enabled{false};
+
+namespace {
+
+bool can_group(const Tensor& grad, const Tensor& new_grad) {
+  return grad.is_cuda() && grad.layout() == at::kStrided &&
+      new_grad.layout() == at::kStrided &&
+      grad.device() == new_grad.device() &&
+      grad.scalar_type() == new_grad.scalar_type() &&
+      grad.sizes() == new_grad.sizes() &&
+      at::inplaceIsVmapCompatible(grad, new_grad);
+}
+
+} // namespace
+
+bool AccumulateGrad::is_grouped_accumulation_enabled() {
+  return grouped_accumulation_enabled.load();
+}
+
+void AccumulateGrad::set_grouped_accumulation_enabled(bool enabled) {
+  grouped_accumulation_enabled.store(enabled);
+}
+
+void AccumulateGrad::accumulate_grouped(
+    std::vector<std::pair<std::shared_ptr<Node>, Tensor>>&& deferred) {
+  AutoGradMode grad_mode(false);
+  struct Group {
+    c10::optional<c10::Stream> stream;
+    at::Device device;
+    at::ScalarType dtype;
+    std::vector<Tensor> grads;
+    std::vector<Tensor> new_grads;
+  };
+  std::vector<Group> groups;
+  for (auto& entry : deferred) {
+    auto& fn = static_cast<AccumulateGrad&>(*entry.first);
+    Tensor new_grad = std::move(entry.second);
+    std::lock_guard<std::mutex> lock(fn.mutex_);
+    at::Tensor& grad = fn.variable.mutable_grad();
+    if (!grad.defined() || !can_group(grad, new_grad)) {
+      // The grad was changed since, e.g. set to None by a hook
+      accumulateGrad(
+          fn.variable,
+          grad,
+          new_grad,
+          1 /* num_expected_refs */,
+          [&grad](at::Tensor&& grad_update) { grad = std::move(grad_update); });
+      continue;
+    }
+    const auto stream = fn.stream(c10::DeviceType::CUDA);
+    auto group = std::find_if(groups.begin(), groups.end(), [&](const Group& g) {
+      return g.stream == stream && g.device == grad.device() &&
+          g.dtype == grad.scalar_type();
+    });
+    if (group == groups.end()) {
+      groups.push_back(Group{stream, grad.device(), grad.scalar_type(), {}, {}});
+      group = groups.end() - 1;
+    }
+    group->grads.push_back(grad);
+    group->new_grads.push_back(std::move(new_grad));
+  }
+  for (auto& group : groups) {
+    c10::OptionalStreamGuard stream_guard{group.stream};
+    at::_foreach_add_(group.grads, group.new_grads);
+  }
+}
+
 // AccumulateGrad sets sequence_nr to the max value so it's always called
 // ASAP during backwards.
 AccumulateGrad::AccumulateGrad(Variable variable_)
@@ -45,6 +131,17 @@ auto AccumulateGrad::apply(variable_list&& grads) -> variable_list {
 
   at::Tensor& grad = variable.mutable_grad();
 
+  // See Note [Grouped gradient accumulation]
+  if (grouped_accumulation_enabled.load() && !GradMode::is_enabled() &&
+      post_hooks().empty() && grad.defined() && can_group(grad, new_grad)) {
+    if (auto graph_task = get_current_graph_task()) {
+      std::lock_guard<std::mutex> graph_task_lock(graph_task->mutex_);
+      graph_task->deferred_grads_.emplace_back(
+          shared_from_this(), std::move(new_grad));
+      return variable_list();
+    }
+  }
+
   // If the function has post hooks (for example, a DDP allreduce hook),
   // call_function in Engine.cpp will temporarily bump the expected refcount
   // by one, hence the addition of !post_hooks().empty() for 'num_expected_refs'
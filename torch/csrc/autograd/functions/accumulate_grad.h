@@ -27,6 +27,16 @@ struct TORCH_API AccumulateGrad : public Node {
 
   variable_list apply(variable_list&& grads) override;
 
+  // Whether in place accumulations into CUDA grads are deferred to the end of
+  // the backward call, see Note [Grouped gradient accumulation]
+  static bool is_grouped_accumulation_enabled();
+  static void set_grouped_accumulation_enabled(bool enabled);
+
+  // Adds each gradient to the grad of the variable of its AccumulateGrad
+  // node, with one _foreach_add_ per stream, device and dtype.
+  static void accumulate_grouped(
+      std::vector<std::pair<std::shared_ptr<Node>, at::Tensor>>&& deferred);
+
   static at::Tensor callHooks(
       const Variable& variable,
       at::Tensor new_grad) {
@@ -1,17 +1,24 @@
 #include <torch/csrc/python_headers.h>
 
 #include <c10/core/DeviceType.h>
+#include <c10/core/InferenceMode.h>
 #include <torch/csrc/Exceptions.h>
 #include <torch/csrc/utils/pybind.h>
+#include <pybind11/functional.h>
 #include <torch/csrc/autograd/autograd.h>
+#include <torch/csrc/autograd/engine.h>
+#include <torch/csrc/autograd/functions/accumulate_grad.h>
 #include <torch/csrc/autograd/grad_mode.h>
 #include <ATen/autocast_mode.h>
 #include <torch/csrc/autograd/profiler.h>
 #include <torch/csrc/autograd/python_function.h>
 #include <torch/csrc/autograd/function.h>
+#include <torch/csrc/autograd/saved_variable.h>
+#include <torch/csrc/autograd/saved_variable_packers.h>
 #include <torch/csrc/autograd/utils/wrap_outputs.h>
 #include <torch/csrc/autograd/utils/python_arg_parsing.h>
 #include <torch/csrc/utils/pycfunction_helpers.h>
+#include <torch/csrc/utils/python_numbers.h>
 
 PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
   using namespace torch::autograd::profiler;
@@ -193,6 +200,55 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
       disableProfilerLegacy,
       py::arg("profiler_disable_options") = ProfilerDisableOptions());
   m.def("_profiler_enabled", profilerEnabled);
+
+  py::class_<SampledOpStats>(m, "_SampledOpStats")
+      .def_readonly("name", &SampledOpStats::name)
+      .def_readonly("input_shapes", &SampledOpStats::input_shapes)
+      .def_readonly("count", &SampledOpStats::count)
+      .def_readonly("total_ns", &SampledOpStats::total_ns)
+      .def_readonly("buckets", &SampledOpStats::buckets)
+      .def_readonly("cycles", &SampledOpStats::cycles)
+      .def_readonly("instructions", &SampledOpStats::instructions)
+      .def_readonly("llc_misses", &SampledOpStats::llc_misses);
+  m.def(
+      "_enable_sampling_profiler",
+      enableSamplingProfiler,
+      py::arg("sampling_prob") = 0.001,
+      py::arg("with_perf_counters") = false);
+  m.def("_disable_sampling_profiler", disableSamplingProfiler);
+  m.def("_sampling_profiler_enabled", samplingProfilerEnabled);
+  m.def("_sampling_profiler_snapshot", samplingProfilerSnapshot);
+  m.def("_sampling_profiler_dropped_samples", samplingProfilerDroppedSamples);
+  m.def("_sampling_profiler_prometheus", samplingProfilerPrometheus);
+
+  py::class_<MemoryTimelineEvent>(m, "_MemoryTimelineEvent")
+      .def_readonly("time_ns", &MemoryTimelineEvent::time_ns)
+      .def_readonly("bytes", &MemoryTimelineEvent::bytes)
+      .def_property_readonly("device", [](const MemoryTimelineEvent& e) {
+        return e.device.str();
+      })
+      .def_readonly("scope", &MemoryTimelineEvent::scope)
+      .def_readonly("alloc_scope", &MemoryTimelineEvent::alloc_scope);
+  py::class_<MemoryTimelinePeak>(m, "_MemoryTimelinePeak")
+      .def_property_readonly("device", [](const MemoryTimelinePeak& p) {
+        return p.device.str();
+      })
+      .def_readonly("bytes", &MemoryTimelinePeak::bytes)
+      .def_readonly("time_ns", &MemoryTimelinePeak::time_ns)
+      .def_readonly("holders", &MemoryTimelinePeak::holders);
+  py::class_<MemoryTimelineTransient>(m, "_MemoryTimelineTransient")
+      .def_readonly("scope", &MemoryTimelineTransient::scope)
+      .def_property_readonly("device", [](const MemoryTimelineTransient& t) {
+        return t.device.str();
+      })
+      .def_readonly("count", &MemoryTimelineTransient::count)
+      .def_readonly("bytes", &MemoryTimelineTransient::bytes);
+  py::class_<MemoryTimeline>(m, "_MemoryTimeline")
+      .def_readonly("events", &MemoryTimeline::events)
+      .def_readonly("peaks", &MemoryTimeline::peaks)
+      .def_readonly("transients", &MemoryTimeline::transients);
+  m.def("_enable_memory_timeline", enableMemoryTimeline);
+  m.def("_disable_memory_timeline", disableMemoryTimeline);
   m.def("_enable_record_function", [](bool enable) {
     at::enableRecordFunction(enable);
   });
@@ -210,6 +266,43 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
     at::clearCallbacks();
   });
 
+  using torch::autograd::SavedVariablePacker;
+  py::class_<SavedVariablePacker, std::shared_ptr<SavedVariablePacker>>(
+      m, "_SavedVariablePacker");
+  m.def(
+      "_make_saved_tensor_packer",
+      [](c10::optional<std::string> dtype, bool relu_mask, int64_t min_bytes) {
+        c10::optional<at::ScalarType> scalar_type;
+        if (dtype) {
+          TORCH_CHECK(
+              *dtype == "bfloat16" || *dtype == "int8",
+              "Saved tensors can only be packed to bfloat16 or int8, got ",
+              *dtype);
+          scalar_type = *dtype == "bfloat16" ? at::kBFloat16 : at::kChar;
+        }
+        return torch::autograd::make_saved_variable_packer(
+            scalar_type, relu_mask, min_bytes);
+      });
+  using torch::autograd::RecomputePacker;
+  py::class_<
+      RecomputePacker,
+      SavedVariablePacker,
+      std::shared_ptr<RecomputePacker>>(m, "_RecomputePacker")
+      .def("finish", &RecomputePacker::finish)
+      .def("saved_bytes", &RecomputePacker::saved_bytes);
+  m.def(
+      "_make_recompute_saved_tensor_packer",
+      [](std::function<void()> recompute, int64_t min_bytes) {
+        return std::make_shared<RecomputePacker>(
+            std::move(recompute), min_bytes);
+      });
+  m.def("_get_saved_tensor_packer", &SavedVariablePacker::get);
+  m.def("_set_saved_tensor_packer", &SavedVariablePacker::set);
+
+  // Constructed by torch.inference_mode on __enter__ and destroyed on __exit__
+  py::class_<c10::InferenceMode>(m, "_InferenceMode")
+      .def(py::init<bool>());
+
   Py_RETURN_TRUE;
 }
 
@@ -294,6 +387,16 @@ static PyObject * is_grad_enabled(PyObject* _unused, PyObject *arg) {
   END_HANDLE_TH_ERRORS
 }
 
+static PyObject * is_inference_mode_enabled(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (c10::InferenceMode::is_enabled()) {
+    Py_RETURN_TRUE;
+  } else {
+    Py_RETURN_FALSE;
+  }
+  END_HANDLE_TH_ERRORS
+}
+
 static PyObject * set_anomaly_mode_enabled(PyObject* _unused, PyObject *arg) {
   HANDLE_TH_ERRORS
   if (!PyBool_Check(arg)) {
@@ -314,6 +417,78 @@ static PyObject * is_anomaly_mode_enabled(PyObject* _unused, PyObject *arg) {
   END_HANDLE_TH_ERRORS
 }
 
+static PyObject * set_saved_tensor_offload_threshold(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!THPUtils_checkLong(arg)) {
+    throw TypeError("threshold must be an int (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  SavedVariableOffload::set_threshold(THPUtils_unpackLong(arg));
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * saved_tensor_offload_threshold(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  return utils::wrap(SavedVariableOffload::threshold());
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * set_autograd_cpu_worker_threads(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!THPUtils_checkLong(arg)) {
+    throw TypeError("num_threads must be an int (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  Engine::get_default_engine().set_num_cpu_worker_threads(THPUtils_unpackLong(arg));
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * autograd_cpu_worker_threads(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  return utils::wrap(static_cast<int64_t>(Engine::get_default_engine().num_cpu_worker_threads()));
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * set_autograd_sequential_cpu_backward(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!PyBool_Check(arg)) {
+    throw TypeError("enabled must be a bool (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  Engine::get_default_engine().set_sequential_cpu_backward_enabled(arg == Py_True);
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * is_autograd_sequential_cpu_backward_enabled(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (Engine::get_default_engine().is_sequential_cpu_backward_enabled()) {
+    Py_RETURN_TRUE;
+  } else {
+    Py_RETURN_FALSE;
+  }
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * set_grouped_grad_accumulation(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!PyBool_Check(arg)) {
+    throw TypeError("enabled must be a bool (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  AccumulateGrad::set_grouped_accumulation_enabled(arg == Py_True);
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * is_grouped_grad_accumulation_enabled(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (AccumulateGrad::is_grouped_accumulation_enabled()) {
+    Py_RETURN_TRUE;
+  } else {
+    Py_RETURN_FALSE;
+  }
+  END_HANDLE_TH_ERRORS
+}
+
 static PyObject * python_enter_dual_level(PyObject* _unused, PyObject* arg) {
   HANDLE_TH_ERRORS
   // It is unlikely that the depth of forward nesting will overflow int64_t so we
@@ -340,6 +515,7 @@ static PyObject * python_exit_dual_level(PyObject* _unused, PyObject* args, PyOb
 static PyMethodDef methods[] = { // NOLINT
   {"_set_grad_enabled", set_grad_enabled, METH_O, nullptr},
   {"is_grad_enabled", is_grad_enabled, METH_NOARGS, nullptr},
+  {"is_inference_mode_enabled", is_inference_mode_enabled, METH_NOARGS, nullptr},
   {"_set_forward_AD_enabled", set_forward_AD_enabled, METH_O, nullptr},
   {"_is_forward_AD_enabled", is_forward_AD_enabled, METH_NOARGS, nullptr},
   {"set_autocast_enabled", set_autocast_enabled, METH_O, nullptr},
@@ -349,6 +525,14 @@ static PyMethodDef methods[] = { // NOLINT
   {"autocast_decrement_nesting", autocast_decrement_nesting, METH_NOARGS, nullptr},
   {"set_anomaly_enabled", set_anomaly_mode_enabled, METH_O, nullptr},
   {"is_anomaly_enabled", is_anomaly_mode_enabled, METH_NOARGS, nullptr},
+  {"_set_saved_tensor_offload_threshold", set_saved_tensor_offload_threshold, METH_O, nullptr},
+  {"_saved_tensor_offload_threshold", saved_tensor_offload_threshold, METH_NOARGS, nullptr},
+  {"_set_autograd_cpu_worker_threads", set_autograd_cpu_worker_threads, METH_O, nullptr},
+  {"_autograd_cpu_worker_threads", autograd_cpu_worker_threads, METH_NOARGS, nullptr},
+  {"_set_autograd_sequential_cpu_backward", set_autograd_sequential_cpu_backward, METH_O, nullptr},
+  {"_is_autograd_sequential_cpu_backward_enabled", is_autograd_sequential_cpu_backward_enabled, METH_NOARGS, nullptr},
+  {"_set_grouped_grad_accumulation", set_grouped_grad_accumulation, METH_O, nullptr},
+  {"_is_grouped_grad_accumulation_enabled", is_grouped_grad_accumulation_enabled, METH_NOARGS, nullptr},
   {"_enter_dual_level", python_enter_dual_level, METH_NOARGS, nullptr},
   {"_exit_dual_level", castPyCFunctionWithKeywords(python_exit_dual_level), METH_VARARGS | METH_KEYWORDS, nullptr},
   {nullptr, nullptr, 0, nullptr}
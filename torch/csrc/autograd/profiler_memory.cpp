@@ -0,0 +1,249 @@
+#include <torch/csrc/autograd/profiler_memory.h>
+
+#include <torch/csrc/autograd/profiler_legacy.h>
+
+#include <ATen/record_function.h>
+#include <c10/core/Allocator.h>
+#include <c10/util/ThreadLocalDebugInfo.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace torch { namespace autograd {
+namespace profiler {
+
+namespace {
+
+// The state of the memory timeline, shared by all the threads it follows.
+// See Note [Memory timeline].
+struct MemoryTimelineState : public c10::MemoryReportingInfoBase {
+  MemoryTimelineState() : start_ns_(getTime(/*allow_monotonic=*/true)) {}
+
+  bool memoryProfilingEnabled() const override {
+    return true;
+  }
+
+  void reportMemoryUsage(void* ptr, int64_t alloc_size, c10::Device device) override {
+    const uint64_t thread_id = at::RecordFunction::currentThreadId();
+    std::lock_guard<std::mutex> guard(mutex_);
+    // Taken under the lock, so that events are in time order.
+    const int64_t time_ns = getTime(/*allow_monotonic=*/true) - start_ns_;
+    const auto& stack = stacks_[thread_id];
+    const Frame* frame = stack.empty() ? nullptr : &stack.back();
+    RecordedEvent event{
+        MemoryTimelineEvent{
+            time_ns, alloc_size, device, frame ? frame->scope : std::string(), ""},
+        ptr};
+    if (alloc_size >= 0) {
+      Allocation allocation{{}, frame ? frame->scope : std::string()};
+      allocation.ranges.reserve(stack.size());
+      for (const auto& f : stack) {
+        allocation.ranges.emplace_back(f.handle, f.scope.size());
+      }
+      live_[ptr] = std::move(allocation);
+    } else {
+      auto it = live_.find(ptr);
+      if (it != live_.end()) {
+        const auto& allocation = it->second;
+        event.event.alloc_scope = allocation.scope;
+        // The buffer is transient in the innermost range that is still
+        // running and was running when it was allocated, if any.
+        for (auto range = allocation.ranges.rbegin();
+             range != allocation.ranges.rend();
+             ++range) {
+          if (active_ranges_.count(range->first)) {
+            std::string scope = allocation.scope.substr(0, range->second);
+            auto& transient = transients_.emplace(
+                std::make_pair(scope, device.str()),
+                MemoryTimelineTransient{scope, device, 0, 0}).first->second;
+            transient.count += 1;
+            transient.bytes -= alloc_size;
+            break;
+          }
+        }
+        live_.erase(it);
+      }
+    }
+    events_.push_back(std::move(event));
+  }
+
+  void pushRange(const at::RecordFunction& fn) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto& stack = stacks_[at::RecordFunction::currentThreadId()];
+    std::string scope = stack.empty()
+        ? std::string(fn.name().str())
+        : stack.back().scope + "/" + fn.name().str();
+    stack.push_back(Frame{fn.handle(), std::move(scope)});
+    active_ranges_.insert(fn.handle());
+  }
+
+  void popRange(const at::RecordFunction& fn) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    active_ranges_.erase(fn.handle());
+    // Ranges usually end in the reverse order they started on the thread
+    // they started on, but async ranges may not.
+    auto& stack = stacks_[at::RecordFunction::currentThreadId()];
+    for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+      if (it->handle == fn.handle()) {
+        stack.erase(std::next(it).base());
+        break;
+      }
+    }
+  }
+
+  void setCallbackHandle(at::CallbackHandle handle) {
+    handle_ = handle;
+  }
+
+  at::CallbackHandle callbackHandle() const {
+    return handle_;
+  }
+
+  MemoryTimeline finalize();
+
+ private:
+  struct Frame {
+    at::RecordFunctionHandle handle;
+    std::string scope;
+  };
+
+  struct Allocation {
+    // The ranges running when the allocation happened, outermost first,
+    // with the length of their scope.
+    std::vector<std::pair<at::RecordFunctionHandle, size_t>> ranges;
+    std::string scope;
+  };
+
+  struct RecordedEvent {
+    MemoryTimelineEvent event;
+    void* ptr;
+  };
+
+  std::mutex mutex_;
+  const int64_t start_ns_;
+  at::CallbackHandle handle_ = 0;
+  std::unordered_map<uint64_t, std::vector<Frame>> stacks_;
+  std::unordered_set<at::RecordFunctionHandle> active_ranges_;
+  std::unordered_map<void*, Allocation> live_;
+  std::vector<RecordedEvent> events_;
+  // By scope and device.
+  std::map<std::pair<std::string, std::string>, MemoryTimelineTransient> transients_;
+};
+
+MemoryTimeline MemoryTimelineState::finalize() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  MemoryTimeline timeline;
+
+  // First find the index of the event at which each device peaks...
+  struct DevicePeak {
+    c10::Device device;
+    int64_t current = 0;
+    int64_t peak = 0;
+    // One past the index of the event that reached the peak, or 0 if
+    // allocated memory never went above its starting point.
+    size_t end = 0;
+  };
+  std::map<std::string, DevicePeak> peaks;
+  for (size_t i = 0; i < events_.size(); ++i) {
+    const auto& event = events_[i].event;
+    auto it = peaks.emplace(event.device.str(), DevicePeak{event.device}).first;
+    auto& peak = it->second;
+    peak.current += event.bytes;
+    if (peak.current > peak.peak) {
+      peak.peak = peak.current;
+      peak.end = i + 1;
+    }
+  }
+
+  // ...then replay the events up to there to find what was alive at the peak.
+  for (const auto& kv : peaks) {
+    const auto& peak = kv.second;
+    std::unordered_map<void*, const MemoryTimelineEvent*> alive;
+    for (size_t i = 0; i < peak.end; ++i) {
+      const auto& event = events_[i].event;
+      if (event.device != peak.device) {
+        continue;
+      }
+      if (event.bytes >= 0) {
+        alive[events_[i].ptr] = &event;
+      } else {
+        alive.erase(events_[i].ptr);
+      }
+    }
+    std::unordered_map<std::string, int64_t> holders;
+    for (const auto& allocation : alive) {
+      holders[allocation.second->scope] += allocation.second->bytes;
+    }
+    MemoryTimelinePeak result{
+        peak.device,
+        peak.peak,
+        peak.end > 0 ? events_[peak.end - 1].event.time_ns : 0,
+        {holders.begin(), holders.end()}};
+    std::sort(
+        result.holders.begin(),
+        result.holders.end(),
+        [](const std::pair<std::string, int64_t>& a,
+           const std::pair<std::string, int64_t>& b) {
+          return a.second > b.second;
+        });
+    timeline.peaks.push_back(std::move(result));
+  }
+
+  for (auto& kv : transients_) {
+    timeline.transients.push_back(std::move(kv.second));
+  }
+  std::sort(
+      timeline.transients.begin(),
+      timeline.transients.end(),
+      [](const MemoryTimelineTransient& a, const MemoryTimelineTransient& b) {
+        return a.bytes > b.bytes;
+      });
+
+  timeline.events.reserve(events_.size());
+  for (auto& event : events_) {
+    timeline.events.push_back(std::move(event.event));
+  }
+  events_.clear();
+  return timeline;
+}
+
+MemoryTimelineState* getMemoryTimelineState() {
+  return static_cast<MemoryTimelineState*>(
+      c10::ThreadLocalDebugInfo::get(c10::DebugInfoKind::PROFILER_STATE));
+}
+
+} // namespace
+
+void enableMemoryTimeline() {
+  TORCH_CHECK(
+      !c10::ThreadLocalDebugInfo::get(c10::DebugInfoKind::PROFILER_STATE),
+      "Can't record the memory timeline while a profiler is enabled on this thread");
+  auto state = std::make_shared<MemoryTimelineState>();
+  c10::ThreadLocalDebugInfo::_push(c10::DebugInfoKind::PROFILER_STATE, state);
+  state->setCallbackHandle(at::addThreadLocalCallback(at::RecordFunctionCallback(
+      [](const at::RecordFunction& fn) -> std::unique_ptr<at::ObserverContext> {
+        if (auto* state_ptr = getMemoryTimelineState()) {
+          state_ptr->pushRange(fn);
+        }
+        return nullptr;
+      },
+      [](const at::RecordFunction& fn, at::ObserverContext*) {
+        if (auto* state_ptr = getMemoryTimelineState()) {
+          state_ptr->popRange(fn);
+        }
+      })
+    .needsIds(true)));
+}
+
+MemoryTimeline disableMemoryTimeline() {
+  auto* state_ptr = getMemoryTimelineState();
+  TORCH_CHECK(state_ptr, "Can't disable the memory timeline when it's not running");
+  auto state = c10::ThreadLocalDebugInfo::_pop(c10::DebugInfoKind::PROFILER_STATE);
+  at::removeCallback(state_ptr->callbackHandle());
+  return state_ptr->finalize();
+}
+
+}}}
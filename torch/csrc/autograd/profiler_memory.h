@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <c10/core/Device.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+namespace torch { namespace autograd {
+namespace profiler {
+
+// Note [Memory timeline]
+// ~~~~~~~~~~~~~~~~~~~~~~
+// The memory timeline records every allocation and free the CPU allocator and
+// the CUDA caching allocator report to the profiler (see
+// c10::reportMemoryUsageToProfiler), and attributes each to the scope it
+// happened in: the stack of RecordFunction ranges, operators and user scopes
+// such as `torch.autograd.profiler.record_function`, that were running on the
+// thread, joined with "/", e.g. "forward/aten::linear/aten::addmm". Scopes
+// are empty for memory allocated while no range was running.
+//
+// Frees are matched to allocations by address. From the matched pairs, the
+// timeline finds, per device, the peak of the memory allocated since it was
+// enabled, the scopes whose allocations were still alive at the peak, and
+// the transient buffers. A buffer is transient in the innermost range that
+// was running both when it was allocated and when it was freed, e.g. the
+// workspace of an operator, or the output of an operator that a later one
+// consumed within the same user scope: it does not outlive the range but
+// adds to its peak. Memory that was allocated before the timeline was
+// enabled and freed while it ran lowers the allocated memory below zero, so
+// peaks are relative to the memory in use when the timeline was enabled.
+//
+// Like the legacy profiler, the timeline is installed as the profiler state
+// of the thread that enables it, and follows it to the threads that inherit
+// its ThreadLocalState (e.g. autograd engine and at::launch threads). It
+// cannot run at the same time as the other profilers.
+
+struct TORCH_API MemoryTimelineEvent {
+  // Nanoseconds since the timeline was enabled.
+  int64_t time_ns;
+  // Bytes allocated, negative for frees.
+  int64_t bytes;
+  c10::Device device;
+  // The scope the allocation or free happened in.
+  std::string scope;
+  // For frees, the scope of the matching allocation, or empty if the
+  // memory was allocated before the timeline was enabled.
+  std::string alloc_scope;
+};
+
+struct TORCH_API MemoryTimelinePeak {
+  c10::Device device;
+  // Bytes allocated on the device at the peak, relative to when the
+  // timeline was enabled.
+  int64_t bytes;
+  int64_t time_ns;
+  // Bytes alive at the peak by the scope that allocated them, largest first.
+  std::vector<std::pair<std::string, int64_t>> holders;
+};
+
+struct TORCH_API MemoryTimelineTransient {
+  std::string scope;
+  c10::Device device;
+  // Number and total size of the buffers that were transient in the scope.
+  int64_t count;
+  int64_t bytes;
+};
+
+struct TORCH_API MemoryTimeline {
+  std::vector<MemoryTimelineEvent> events;
+  std::vector<MemoryTimelinePeak> peaks;
+  // Largest total first.
+  std::vector<MemoryTimelineTransient> transients;
+};
+
+// Starts recording the memory timeline on this thread.
+TORCH_API void enableMemoryTimeline();
+
+// Stops recording and returns the timeline; see Note [Memory timeline].
+TORCH_API MemoryTimeline disableMemoryTimeline();
+
+}}}
@@ -0,0 +1,450 @@
+#include <torch/csrc/autograd/profiler_sampling.h>
+
+#include <torch/csrc/autograd/profiler_legacy.h>
+
+#include <ATen/record_function.h>
+#include <c10/util/hash.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_set>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace torch { namespace autograd {
+namespace profiler {
+
+namespace {
+
+// Cycles, instructions and last level cache misses.
+constexpr size_t kNumPerfCounters = 3;
+using PerfCounterValues = std::array<uint64_t, kNumPerfCounters>;
+
+// Number of slots in the table of each thread; a power of two.
+constexpr size_t kTableSize = 1024;
+// Number of slots a sample probes for its key before it is dropped.
+constexpr size_t kMaxProbes = 32;
+
+struct Entry {
+  Entry(size_t hash, std::string name, std::string input_shapes)
+      : hash(hash), name(std::move(name)), input_shapes(std::move(input_shapes)) {}
+
+  const size_t hash;
+  const std::string name;
+  const std::string input_shapes;
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> total_ns{0};
+  std::array<std::atomic<uint64_t>, kSamplingProfilerNumBuckets> buckets{};
+  std::array<std::atomic<uint64_t>, kNumPerfCounters> perf_counters{};
+};
+
+// Only the thread that owns a counter writes it, so there is no need for a
+// read-modify-write; readers may see a value that is one sample behind.
+void bump(std::atomic<uint64_t>& counter, uint64_t value) {
+  counter.store(
+      counter.load(std::memory_order_relaxed) + value,
+      std::memory_order_relaxed);
+}
+
+size_t bucketFor(uint64_t ns) {
+  size_t bucket = 0;
+  uint64_t bound = kSamplingProfilerFirstBucketNs;
+  while (bucket + 1 < kSamplingProfilerNumBuckets && ns > bound) {
+    bound <<= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+// The histograms of one thread. See Note [Sampling profiler].
+struct ThreadTable {
+  ThreadTable() {
+    for (auto& slot : slots) {
+      slot.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  ~ThreadTable() {
+    for (auto& slot : slots) {
+      delete slot.load(std::memory_order_relaxed);
+    }
+  }
+
+  // Called by the owning thread only. `perf_counters` may be null.
+  void record(
+      const char* name,
+      const std::string& input_shapes,
+      uint64_t ns,
+      const PerfCounterValues* perf_counters) {
+    const size_t hash =
+        c10::hash_combine(std::hash<std::string>()(name), std::hash<std::string>()(input_shapes));
+    for (size_t probe = 0; probe < kMaxProbes; ++probe) {
+      auto& slot = slots[(hash + probe) & (kTableSize - 1)];
+      Entry* entry = slot.load(std::memory_order_relaxed);
+      if (!entry) {
+        entry = new Entry(hash, name, input_shapes);
+        // Publish the entry after its strings are written.
+        slot.store(entry, std::memory_order_release);
+      } else if (
+          entry->hash != hash || entry->name != name ||
+          entry->input_shapes != input_shapes) {
+        continue;
+      }
+      bump(entry->count, 1);
+      bump(entry->total_ns, ns);
+      bump(entry->buckets[bucketFor(ns)], 1);
+      if (perf_counters) {
+        for (size_t i = 0; i < kNumPerfCounters; ++i) {
+          bump(entry->perf_counters[i], (*perf_counters)[i]);
+        }
+      }
+      return;
+    }
+    bump(dropped, 1);
+  }
+
+  std::array<std::atomic<Entry*>, kTableSize> slots;
+  std::atomic<uint64_t> dropped{0};
+};
+
+using StatsMap = std::map<std::pair<std::string, std::string>, SampledOpStats>;
+
+// Adds the counters of `table` to `stats`. May be called from any thread.
+uint64_t addTo(const ThreadTable& table, StatsMap& stats) {
+  for (const auto& slot : table.slots) {
+    const Entry* entry = slot.load(std::memory_order_acquire);
+    if (!entry) {
+      continue;
+    }
+    auto& op = stats[{entry->name, entry->input_shapes}];
+    op.count += entry->count.load(std::memory_order_relaxed);
+    op.total_ns += entry->total_ns.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kSamplingProfilerNumBuckets; ++i) {
+      op.buckets[i] += entry->buckets[i].load(std::memory_order_relaxed);
+    }
+    op.cycles += entry->perf_counters[0].load(std::memory_order_relaxed);
+    op.instructions += entry->perf_counters[1].load(std::memory_order_relaxed);
+    op.llc_misses += entry->perf_counters[2].load(std::memory_order_relaxed);
+  }
+  return table.dropped.load(std::memory_order_relaxed);
+}
+
+struct Registry {
+  std::mutex mutex;
+  std::unordered_set<const ThreadTable*> live_tables;
+  // Totals of the threads that exited.
+  StatsMap exited_stats;
+  uint64_t exited_dropped = 0;
+};
+
+Registry& registry() {
+  // Leaked, since threads may exit after static destructors have run.
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+struct ThreadTableHolder {
+  ThreadTableHolder() : table(std::make_unique<ThreadTable>()) {
+    auto& r = registry();
+    std::lock_guard<std::mutex> guard(r.mutex);
+    r.live_tables.insert(table.get());
+  }
+
+  ~ThreadTableHolder() {
+    auto& r = registry();
+    std::lock_guard<std::mutex> guard(r.mutex);
+    r.live_tables.erase(table.get());
+    r.exited_dropped += addTo(*table, r.exited_stats);
+  }
+
+  std::unique_ptr<ThreadTable> table;
+};
+
+ThreadTable& threadTable() {
+  static thread_local ThreadTableHolder holder;
+  return *holder.table;
+}
+
+uint64_t collect(StatsMap& stats) {
+  auto& r = registry();
+  std::lock_guard<std::mutex> guard(r.mutex);
+  stats = r.exited_stats;
+  uint64_t dropped = r.exited_dropped;
+  for (const ThreadTable* table : r.live_tables) {
+    dropped += addTo(*table, stats);
+  }
+  return dropped;
+}
+
+int64_t roundUpToPowerOfTwo(int64_t size) {
+  int64_t rounded = 1;
+  while (rounded < size) {
+    rounded <<= 1;
+  }
+  return size == 0 ? 0 : rounded;
+}
+
+std::string bucketedInputShapes(const at::RecordFunction& fn) {
+  std::ostringstream oss;
+  oss << "[";
+  const auto& inputs = fn.inputs();
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (i > 0) {
+      oss << ", ";
+    }
+    oss << "[";
+    if (inputs[i].isTensor()) {
+      const auto& tensor = inputs[i].toTensor();
+      if (tensor.defined()) {
+        const auto sizes = tensor.sizes();
+        for (size_t d = 0; d < sizes.size(); ++d) {
+          if (d > 0) {
+            oss << ", ";
+          }
+          oss << roundUpToPowerOfTwo(sizes[d]);
+        }
+      }
+    }
+    oss << "]";
+  }
+  oss << "]";
+  return oss.str();
+}
+
+// The hardware counters of the calling thread, opened as one group so that
+// they are read together.
+class PerfCounterGroup {
+ public:
+  PerfCounterGroup() {
+    fds_.fill(-1);
+#ifdef __linux__
+    const uint64_t configs[kNumPerfCounters] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES};
+    for (size_t i = 0; i < kNumPerfCounters; ++i) {
+      struct perf_event_attr attr = {};
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = configs[i];
+      attr.read_format = PERF_FORMAT_GROUP;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      fds_[i] = static_cast<int>(syscall(
+          __NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+          /*group_fd=*/i == 0 ? -1 : fds_[0], /*flags=*/0));
+      if (fds_[i] < 0) {
+        closeAll();
+        return;
+      }
+    }
+#endif
+  }
+
+  ~PerfCounterGroup() {
+    closeAll();
+  }
+
+  PerfCounterGroup(const PerfCounterGroup&) = delete;
+  PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+  // Returns false if the counters are not available.
+  bool read(PerfCounterValues& values) const {
+#ifdef __linux__
+    if (fds_[0] < 0) {
+      return false;
+    }
+    struct {
+      uint64_t nr;
+      uint64_t values[kNumPerfCounters];
+    } buffer;
+    if (::read(fds_[0], &buffer, sizeof(buffer)) != sizeof(buffer) ||
+        buffer.nr != kNumPerfCounters) {
+      return false;
+    }
+    std::copy(buffer.values, buffer.values + kNumPerfCounters, values.begin());
+    return true;
+#else
+    return false;
+#endif
+  }
+
+ private:
+  void closeAll() {
+#ifdef __linux__
+    for (int& fd : fds_) {
+      if (fd >= 0) {
+        close(fd);
+        fd = -1;
+      }
+    }
+#endif
+  }
+
+  std::array<int, kNumPerfCounters> fds_;
+};
+
+const PerfCounterGroup& threadPerfCounters() {
+  static thread_local PerfCounterGroup counters;
+  return counters;
+}
+
+struct SamplingObserverContext : public at::ObserverContext {
+  std::string input_shapes;
+  int64_t start_ns = 0;
+  bool has_perf_counters = false;
+  PerfCounterValues perf_counters{};
+};
+
+// Handle of the RecordFunction callback, or 0 if the profiler is disabled.
+at::CallbackHandle sampling_callback_handle = 0;
+bool sampling_with_perf_counters = false;
+
+std::string escapeLabel(const std::string& value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (char c : value) {
+    if (c == '\\' || c == '"') {
+      escaped.push_back('\\');
+      escaped.push_back(c);
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped.push_back(c);
+    }
+  }
+  return escaped;
+}
+
+} // namespace
+
+void enableSamplingProfiler(double sampling_prob, bool with_perf_counters) {
+  TORCH_CHECK(!sampling_callback_handle, "The sampling profiler is already enabled");
+  sampling_with_perf_counters = with_perf_counters;
+  sampling_callback_handle = at::addGlobalCallback(at::RecordFunctionCallback(
+      [](const at::RecordFunction& fn) -> std::unique_ptr<at::ObserverContext> {
+        auto ctx = std::make_unique<SamplingObserverContext>();
+        ctx->input_shapes = bucketedInputShapes(fn);
+        if (sampling_with_perf_counters) {
+          ctx->has_perf_counters = threadPerfCounters().read(ctx->perf_counters);
+        }
+        ctx->start_ns = getTime(/*allow_monotonic=*/true);
+        return ctx;
+      },
+      [](const at::RecordFunction& fn, at::ObserverContext* ctx_ptr) {
+        const int64_t end_ns = getTime(/*allow_monotonic=*/true);
+        auto* ctx = static_cast<SamplingObserverContext*>(ctx_ptr);
+        TORCH_INTERNAL_ASSERT(ctx != nullptr);
+        PerfCounterValues perf_counters;
+        const bool has_perf_counters = ctx->has_perf_counters &&
+            threadPerfCounters().read(perf_counters);
+        if (has_perf_counters) {
+          // The end callback may run on another thread than the start
+          // callback, in which case the difference is meaningless.
+          for (size_t i = 0; i < kNumPerfCounters; ++i) {
+            perf_counters[i] = perf_counters[i] >= ctx->perf_counters[i]
+                ? perf_counters[i] - ctx->perf_counters[i]
+                : 0;
+          }
+        }
+        threadTable().record(
+            fn.name().str(),
+            ctx->input_shapes,
+            static_cast<uint64_t>(std::max<int64_t>(end_ns - ctx->start_ns, 0)),
+            has_perf_counters ? &perf_counters : nullptr);
+      })
+    .needsInputs(true)
+    .samplingProb(sampling_prob)
+    .scopes({at::RecordScope::FUNCTION}));
+}
+
+void disableSamplingProfiler() {
+  TORCH_CHECK(sampling_callback_handle, "The sampling profiler is not enabled");
+  at::removeCallback(sampling_callback_handle);
+  sampling_callback_handle = 0;
+}
+
+bool samplingProfilerEnabled() {
+  return sampling_callback_handle != 0;
+}
+
+std::vector<SampledOpStats> samplingProfilerSnapshot() {
+  StatsMap stats;
+  collect(stats);
+  std::vector<SampledOpStats> result;
+  result.reserve(stats.size());
+  for (auto& kv : stats) {
+    kv.second.name = kv.first.first;
+    kv.second.input_shapes = kv.first.second;
+    result.push_back(std::move(kv.second));
+  }
+  return result;
+}
+
+uint64_t samplingProfilerDroppedSamples() {
+  StatsMap stats;
+  return collect(stats);
+}
+
+std::string samplingProfilerPrometheus() {
+  StatsMap stats;
+  const uint64_t dropped = collect(stats);
+  std::ostringstream oss;
+  // Enough digits for the bucket bounds to be exact.
+  oss.precision(9);
+  oss << "# HELP torch_op_latency_seconds Latency of sampled operator calls.\n"
+      << "# TYPE torch_op_latency_seconds histogram\n";
+  for (const auto& kv : stats) {
+    const auto& op = kv.second;
+    const std::string labels = "op=\"" + escapeLabel(kv.first.first) +
+        "\",input_shapes=\"" + escapeLabel(kv.first.second) + "\"";
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < kSamplingProfilerNumBuckets; ++i) {
+      cumulative += op.buckets[i];
+      oss << "torch_op_latency_seconds_bucket{" << labels << ",le=\"";
+      if (i + 1 < kSamplingProfilerNumBuckets) {
+        oss << (kSamplingProfilerFirstBucketNs << i) * 1e-9;
+      } else {
+        oss << "+Inf";
+      }
+      oss << "\"} " << cumulative << "\n";
+    }
+    oss << "torch_op_latency_seconds_sum{" << labels << "} " << op.total_ns * 1e-9 << "\n"
+        << "torch_op_latency_seconds_count{" << labels << "} " << op.count << "\n";
+  }
+  const std::pair<const char*, uint64_t SampledOpStats::*> perf_counters[] = {
+      {"torch_op_cycles_total", &SampledOpStats::cycles},
+      {"torch_op_instructions_total", &SampledOpStats::instructions},
+      {"torch_op_llc_misses_total", &SampledOpStats::llc_misses}};
+  for (const auto& counter : perf_counters) {
+    bool header = false;
+    for (const auto& kv : stats) {
+      if (kv.second.cycles == 0) {
+        continue;
+      }
+      if (!header) {
+        oss << "# TYPE " << counter.first << " counter\n";
+        header = true;
+      }
+      oss << counter.first << "{op=\"" << escapeLabel(kv.first.first)
+          << "\",input_shapes=\"" << escapeLabel(kv.first.second) << "\"} "
+          << kv.second.*counter.second << "\n";
+    }
+  }
+  oss << "# HELP torch_op_samples_dropped_total Sampled operator calls that were not recorded.\n"
+      << "# TYPE torch_op_samples_dropped_total counter\n"
+      << "torch_op_samples_dropped_total " << dropped << "\n";
+  return oss.str();
+}
+
+}}}
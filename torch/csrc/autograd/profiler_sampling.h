@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+namespace torch { namespace autograd {
+namespace profiler {
+
+// Note [Sampling profiler]
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+// The sampling profiler is meant to be left on in production: instead of
+// recording every event, like the legacy and Kineto profilers do, it samples
+// operator calls through a global RecordFunction callback and only keeps, per
+// (operator name, bucket of input shapes), a count, a total and a histogram of
+// latencies. With a sampling probability of at most 1/1000 the RecordFunction
+// of an operator call is pre-sampled (see record_function.cpp), so that calls
+// that are not sampled cost no more than a thread local counter decrement.
+//
+// Each thread updates its own table of histograms, which a snapshot reads
+// without stopping it: the table has a fixed number of slots, entries are
+// published into their slot with a release store and never move, and counters
+// are relaxed atomics that only the owning thread writes. Input shapes are
+// bucketed by rounding each dimension up to a power of two, which bounds the
+// number of keys dynamic shapes produce. Samples whose key does not fit in the
+// table of their thread are counted as dropped. When a thread exits, its table
+// is folded into the totals of exited threads.
+//
+// With `with_perf_counters`, each thread that samples a call also opens a
+// group of hardware counters (cycles, instructions and last level cache
+// misses) with perf_event_open, counting that thread in user space only, and
+// reads it at the start and end of each sampled call. Comparing instructions
+// per cycle and cache misses per instruction tells memory bound operators from
+// compute bound ones; cache misses times the size of a cache line estimates
+// the memory traffic of an operator. Counters stay zero where they cannot be
+// opened, e.g. outside of Linux or when perf_event_paranoid forbids it.
+
+// Latency bucket `i` counts samples that took at most
+// kSamplingProfilerFirstBucketNs << i nanoseconds and more than the bound of
+// bucket i - 1; the last bucket counts all the slower samples.
+constexpr int64_t kSamplingProfilerFirstBucketNs = 1000;
+constexpr size_t kSamplingProfilerNumBuckets = 26;
+
+struct TORCH_API SampledOpStats {
+  std::string name;
+  // Input shapes of the sampled calls, with dimensions rounded up to powers
+  // of two, e.g. "[[64, 128], [128], []]".
+  std::string input_shapes;
+  uint64_t count = 0;
+  uint64_t total_ns = 0;
+  // Not cumulative; see kSamplingProfilerFirstBucketNs.
+  std::array<uint64_t, kSamplingProfilerNumBuckets> buckets{};
+  // Totals of the hardware counters, see `with_perf_counters`.
+  uint64_t cycles = 0;
+  uint64_t instructions = 0;
+  uint64_t llc_misses = 0;
+};
+
+// Starts sampling operator calls with probability `sampling_prob`, reading
+// hardware counters around them if `with_perf_counters`. Adds a global
+// RecordFunction callback, so like at::addGlobalCallback it is not thread
+// safe and should be called while no operators run.
+TORCH_API void enableSamplingProfiler(
+    double sampling_prob = 0.001,
+    bool with_perf_counters = false);
+
+// Stops sampling; the collected statistics are kept. Not thread safe, see
+// enableSamplingProfiler.
+TORCH_API void disableSamplingProfiler();
+
+TORCH_API bool samplingProfilerEnabled();
+
+// Statistics of all the samples taken since the process started, aggregated
+// across threads, sorted by name and input shapes. May be called at any time,
+// from any thread.
+TORCH_API std::vector<SampledOpStats> samplingProfilerSnapshot();
+
+// Number of samples dropped because the table of their thread was full.
+TORCH_API uint64_t samplingProfilerDroppedSamples();
+
+// samplingProfilerSnapshot() in the Prometheus text exposition format, as the
+// histogram `torch_op_latency_seconds` with labels `op` and `input_shapes`,
+// and the counters `torch_op_cycles_total`, `torch_op_instructions_total` and
+// `torch_op_llc_misses_total` for the operators that have hardware counters.
+TORCH_API std::string samplingProfilerPrometheus();
+
+}}}
@@ -6,14 +6,136 @@
 #include <torch/csrc/autograd/anomaly_mode.h>
 
 #include <ATen/Tensor.h>
+#include <c10/core/Event.h>
+#include <c10/core/StreamGuard.h>
+#include <c10/core/impl/VirtualGuardImpl.h>
 
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <utility>
 
 namespace torch { namespace autograd {
 
+// Note [Saved variable offloading]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Saved activations take most of the memory of training, and sit unused on
+// the device from the forward until their node runs in the backward. When
+// SavedVariableOffload::threshold() is non-negative, a SavedVariable of a
+// non-leaf CUDA tensor of at least that many bytes copies it to pinned host
+// memory on a side stream and keeps only the copy, so the device memory is
+// freed as soon as the forward drops the tensor. The copy waits for the work
+// of the current stream that produced the tensor, and the caching allocator
+// is told the memory is in use on the side stream, so the forward never
+// blocks on it. Leaves (parameters and inputs) are not offloaded, since they
+// stay alive on the device anyway.
+//
+// In the backward, Engine::evaluate_function calls Node::prefetch_variables()
+// on the next functions of the node it is about to run, which starts copying
+// their saved variables back on the side stream while the node computes.
+// unpack() makes the current stream wait on that copy, or copies the variable
+// back on the current stream if it was not prefetched. The unpacked variable
+// has the values, sizes and strides of the saved one, but not its storage.
+//
+// Only the functions generated from derivatives.yaml and C++ custom functions
+// prefetch; the saved variables of Python custom functions are copied back
+// when they are unpacked.
+int64_t SavedVariableOffload::_threshold = -1;
+
+// Note [Saved variable packing]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// As an alternative to offloading, saved variables can be stored in a
+// compressed form: when a SavedVariablePacker is set, every SavedVariable
+// offers its variable to it, and keeps what pack() returns instead of the
+// variable (which it does not offload then). unpack() rebuilds the data with
+// the packer's unpack(), the rest of the variable (version, grad_fn) is kept
+// as usual. Packing is lossy in general, it is up to the packer to only pack
+// what the backward tolerates. Packers run in C++, on the thread saving or
+// unpacking the variable, the built-in ones are in saved_variable_packers.h.
+namespace {
+
+std::shared_ptr<SavedVariablePacker> saved_variable_packer;
+
+} // namespace
+
+std::shared_ptr<SavedVariablePacker> SavedVariablePacker::get() {
+  return std::atomic_load(&saved_variable_packer);
+}
+
+void SavedVariablePacker::set(std::shared_ptr<SavedVariablePacker> packer) {
+  std::atomic_store(&saved_variable_packer, std::move(packer));
+}
+
+namespace {
+
+bool should_offload(const Variable& variable) {
+  const int64_t threshold = SavedVariableOffload::threshold();
+  return threshold >= 0 && variable.is_cuda() && !variable.is_leaf() &&
+      variable.layout() == at::kStrided &&
+      static_cast<int64_t>(variable.numel() * variable.element_size()) >= threshold;
+}
+
+} // namespace
+
+struct SavedVariable::Offload {
+  // Replaces data by a copy in pinned host memory
+  explicit Offload(at::Tensor& data)
+      : device_(data.device()),
+        impl_(device_.type()),
+        stream_(impl_.getStreamFromGlobalPool(device_)),
+        offloaded_(device_.type()),
+        prefetched_event_(device_.type()) {
+    c10::Event produced(device_.type());
+    produced.record(impl_.getStream(device_));
+    produced.block(stream_);
+    at::Tensor host;
+    {
+      c10::StreamGuard guard(stream_);
+      host = at::empty_like(
+          data, data.options().device(at::kCPU).pinned_memory(true));
+      host.copy_(data, /*non_blocking=*/true);
+    }
+    impl_.recordDataPtrOnStream(data.storage().data_ptr(), stream_);
+    offloaded_.record(stream_);
+    data = std::move(host);
+  }
+
+  void prefetch(const at::Tensor& host) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (prefetched_.defined()) {
+      return;
+    }
+    c10::StreamGuard guard(stream_);
+    prefetched_ = host.to(host.options().device(device_), /*non_blocking=*/true);
+    prefetched_event_.record(stream_);
+  }
+
+  // Returns the variable on its device, ready to be used on the current stream
+  at::Tensor fetch(const at::Tensor& host) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto current = impl_.getStream(device_);
+    if (prefetched_.defined()) {
+      prefetched_event_.block(current);
+      impl_.recordDataPtrOnStream(prefetched_.storage().data_ptr(), current);
+      // not kept, so that the memory is freed once the node is done with it
+      return std::exchange(prefetched_, at::Tensor());
+    }
+    offloaded_.block(current);
+    return host.to(host.options().device(device_), /*non_blocking=*/true);
+  }
+
+ private:
+  const at::Device device_;
+  const c10::impl::VirtualGuardImpl impl_;
+  const c10::Stream stream_;
+  c10::Event offloaded_;
+  std::mutex mutex_;
+  at::Tensor prefetched_;
+  c10::Event prefetched_event_;
+};
+
 SavedVariable::SavedVariable(const Variable& variable, bool is_output, bool is_inplace_view) {
   if (variable.defined()) {
     // Note [Inference tensor cannot be saved for backward]
@@ -59,6 +181,17 @@ SavedVariable::SavedVariable(const Variable& variable, bool is_output, bool is_i
     }
     version_counter_ = impl::version_counter(variable);
     saved_version_ = version_counter_.current_version();
+    if (auto packer = SavedVariablePacker::get()) {
+      packed_ = packer->pack(variable, is_output);
+      if (!packed_.empty()) {
+        packer_ = std::move(packer);
+        packed_dtype_ = data_.scalar_type();
+        data_.reset();
+      }
+    }
+    if (data_.defined() && should_offload(variable)) {
+      offload_ = std::make_shared<Offload>(data_);
+    }
   }
 }
 
@@ -66,7 +199,7 @@ SavedVariable::SavedVariable(const c10::optional<Variable>& variable, bool is_ou
   : SavedVariable(variable.has_value() ? *variable : Variable(), is_output, is_inplace_view) {}
 
 Variable SavedVariable::unpack(std::shared_ptr<Node> saved_for) const {
-  if (!data_.defined()) {
+  if (!data_.defined() && packed_.empty()) {
     if (!was_default_constructed_) {
       throw std::runtime_error(ERR_BACKWARD_TWICE);
     }
@@ -84,10 +217,11 @@ Variable SavedVariable::unpack(std::shared_ptr<Node> saved_for) const {
   }
 
   if (saved_version_ != version_counter_.current_version()) {
+    const auto& saved = data_.defined() ? data_ : packed_[0];
     std::stringstream message;
     message << "one of the variables needed for gradient computation has been "
-        "modified by an inplace operation: [" << data_.toString() << " "
-        << data_.sizes() << "]";
+        "modified by an inplace operation: [" << saved.toString() << " "
+        << saved.sizes() << "]";
     if (grad_fn) {
         message << ", which is output " << output_nr_
             << " of " << grad_fn->name() << ",";
@@ -110,11 +244,14 @@ Variable SavedVariable::unpack(std::shared_ptr<Node> saved_for) const {
   // NB: saved views are unpacked as normal Variables (not views) even though
   // they still share the same storage. This works only because we never call
   // in-place functions on unpacked variables.
+  const auto data = packer_ ? packer_->unpack(packed_, packed_dtype_)
+      : offload_ ? offload_->fetch(data_)
+      : data_;
   Variable var;
   if (grad_fn) {
-    var = make_variable(data_, Edge(std::move(grad_fn), output_nr_));
+    var = make_variable(data, Edge(std::move(grad_fn), output_nr_));
   } else {
-    var = make_variable(data_, requires_grad_);
+    var = make_variable(data, requires_grad_);
   }
   impl::set_version_counter(var, saved_version_);
 
@@ -139,6 +276,12 @@ Variable SavedVariable::unpack(std::shared_ptr<Node> saved_for) const {
   return var;
 }
 
+void SavedVariable::prefetch() {
+  if (offload_ && data_.defined()) {
+    offload_->prefetch(data_);
+  }
+}
+
 const char* ERR_BACKWARD_TWICE =
     "Trying to backward through the graph a second time, but the saved intermediate "
     "results have already been freed. Specify retain_graph=True when calling "
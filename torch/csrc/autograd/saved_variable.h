@@ -7,6 +7,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace torch { namespace autograd {
 
@@ -15,6 +16,40 @@ struct Node;
 
 TORCH_API extern const char* ERR_BACKWARD_TWICE;
 
+/// Controls the offloading of large saved variables to pinned host memory,
+/// see Note [Saved variable offloading] in saved_variable.cpp.
+struct TORCH_API SavedVariableOffload {
+  /// Saved variables of at least this many bytes are offloaded, offloading is
+  /// disabled if it is negative (the default).
+  static int64_t threshold() {
+    return _threshold;
+  }
+  static void set_threshold(int64_t bytes) {
+    _threshold = bytes;
+  }
+
+ private:
+  static int64_t _threshold;
+};
+
+/// Packs saved variables into a smaller form when they are saved and unpacks
+/// them when the backward uses them, see Note [Saved variable packing] in
+/// saved_variable.cpp.
+struct TORCH_API SavedVariablePacker {
+  virtual ~SavedVariablePacker() = default;
+
+  /// Returns the packed form of the data of variable, or no tensors to save
+  /// it unchanged. If is_output, variable.grad_fn() is the node saving it.
+  virtual std::vector<at::Tensor> pack(const Variable& variable, bool is_output) const = 0;
+
+  /// Rebuilds the data of a variable of type dtype from the result of pack
+  virtual at::Tensor unpack(const std::vector<at::Tensor>& packed, at::ScalarType dtype) const = 0;
+
+  /// The packer of the variables saved from now on, none by default
+  static std::shared_ptr<SavedVariablePacker> get();
+  static void set(std::shared_ptr<SavedVariablePacker> packer);
+};
+
 /// A snapshot of a variable at a certain version. A `SavedVariable` stores
 /// enough information to reconstruct a variable from a certain point in time.
 class TORCH_API SavedVariable {
@@ -36,7 +71,13 @@ class TORCH_API SavedVariable {
   /// circular reference.
   Variable unpack(std::shared_ptr<Node> saved_for = nullptr) const;
 
+  /// Starts copying an offloaded variable back to its device, so that it is
+  /// there by the time it is unpacked. Does nothing if it was not offloaded.
+  void prefetch();
+
   void reset_data() {
+    offload_.reset();
+    packed_.clear();
     return data_.reset();
   }
 
@@ -52,6 +93,16 @@ class TORCH_API SavedVariable {
   // either the saved Tensor or the unpacked Tensor. See note [ Using ForwardGrad ]
   std::shared_ptr<ForwardGrad> fw_grad_;
 
+  // Set if data_ is a host copy of a device tensor, see
+  // Note [Saved variable offloading]
+  struct Offload;
+  std::shared_ptr<Offload> offload_;
+
+  // Set instead of data_ if the packer packed the variable
+  std::shared_ptr<SavedVariablePacker> packer_;
+  std::vector<at::Tensor> packed_;
+  at::ScalarType packed_dtype_ = at::ScalarType::Undefined;
+
   // The gradient function associated with this node. If has_grad_fn
   // is false, then this is a leaf node. Note that the grad_fn is not saved if
   // it would create a circular reference. In that case, the grad_fn must be
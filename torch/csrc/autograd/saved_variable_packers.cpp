@@ -0,0 +1,207 @@
+#include <torch/csrc/autograd/saved_variable_packers.h>
+
+#include <torch/csrc/autograd/function.h>
+#include <torch/csrc/autograd/variable.h>
+
+#include <limits>
+#include <tuple>
+#include <vector>
+
+namespace torch { namespace autograd {
+
+namespace {
+
+bool is_relu(const std::shared_ptr<Node>& grad_fn) {
+  if (!grad_fn) {
+    return false;
+  }
+  const auto name = grad_fn->name();
+  return name == "ReluBackward0" || name == "ReluBackward1";
+}
+
+class BuiltinPacker final : public SavedVariablePacker {
+ public:
+  BuiltinPacker(
+      c10::optional<at::ScalarType> dtype,
+      bool relu_mask,
+      int64_t min_bytes)
+      : dtype_(dtype), relu_mask_(relu_mask), min_bytes_(min_bytes) {}
+
+  std::vector<at::Tensor> pack(const Variable& variable, bool is_output)
+      const override {
+    if (variable.is_leaf() || variable.layout() != at::kStrided ||
+        variable.numel() == 0 ||
+        !at::isFloatingType(variable.scalar_type()) ||
+        static_cast<int64_t>(variable.numel() * variable.element_size()) <
+            min_bytes_) {
+      return {};
+    }
+    const auto data = variable.tensor_data();
+    if (relu_mask_ && is_output && is_relu(variable.grad_fn())) {
+      return {at::gt(data, 0)};
+    }
+    if (!dtype_ || data.element_size() <= at::elementSize(*dtype_)) {
+      return {};
+    }
+    if (*dtype_ == at::kBFloat16) {
+      return {data.to(at::kBFloat16)};
+    }
+    return pack_int8(data);
+  }
+
+  at::Tensor unpack(
+      const std::vector<at::Tensor>& packed,
+      at::ScalarType dtype) const override {
+    if (packed.size() == 2) {
+      return at::mul(packed[0], packed[1]).to(dtype);
+    }
+    return packed[0].to(dtype);
+  }
+
+ private:
+  static std::vector<at::Tensor> pack_int8(const at::Tensor& data) {
+    at::Tensor min, max;
+    if (data.dim() >= 2) {
+      std::vector<int64_t> dims{0};
+      for (int64_t dim = 2; dim < data.dim(); ++dim) {
+        dims.push_back(dim);
+      }
+      min = at::amin(data, dims, /*keepdim=*/true);
+      max = at::amax(data, dims, /*keepdim=*/true);
+    } else {
+      std::tie(min, max) = at::_aminmax(data);
+    }
+    auto scale = at::maximum(max, min.neg())
+                     .to(at::kFloat)
+                     .div_(127)
+                     .clamp_min_(std::numeric_limits<float>::min());
+    return {at::_quantize_int8_symmetric(data, scale), scale};
+  }
+
+  const c10::optional<at::ScalarType> dtype_;
+  const bool relu_mask_;
+  const int64_t min_bytes_;
+};
+
+} // namespace
+
+std::shared_ptr<SavedVariablePacker> make_saved_variable_packer(
+    c10::optional<at::ScalarType> dtype,
+    bool relu_mask,
+    int64_t min_bytes) {
+  TORCH_CHECK(
+      !dtype || *dtype == at::kBFloat16 || *dtype == at::kChar,
+      "Saved variables can only be packed to bfloat16 or int8, got ",
+      *dtype);
+  return std::make_shared<BuiltinPacker>(dtype, relu_mask, min_bytes);
+}
+
+// Note [Recomputed saved variables]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// A RecomputePacker is set while the forward of a region runs. Every variable
+// the region saves goes through pack(), which numbers them in order. The
+// recomputable ones are packed as their number only, but their data is held
+// until finish(), which is where the caller decides, knowing saved_bytes(),
+// whether to keep them (as if they had been saved as usual) or to free them.
+//
+// The first unpack() of a freed variable, which happens in the backward when
+// the node that saved it runs, replays the region: recompute reruns its
+// forward with this packer set again, and since the rerun saves the same
+// variables in the same order, pack() picks up the data of the freed ones by
+// number. The graph of the rerun is not used, and the rerun happens at most
+// once, the other nodes of the region find their variables in place.
+RecomputePacker::RecomputePacker(
+    std::function<void()> recompute,
+    int64_t min_bytes)
+    : recompute_(std::move(recompute)), min_bytes_(min_bytes) {}
+
+std::vector<at::Tensor> RecomputePacker::pack(
+    const Variable& variable,
+    bool is_output) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (replaying_) {
+    const auto index = replay_index_++;
+    if (index < saved_.size() && recomputable_[index] &&
+        !saved_[index].defined()) {
+      saved_[index] = variable.tensor_data();
+    }
+    return {};
+  }
+  if (finished_) {
+    return {};
+  }
+  const auto index = static_cast<int64_t>(saved_.size());
+  const bool recomputable = !variable.is_leaf() &&
+      variable.layout() == at::kStrided &&
+      static_cast<int64_t>(variable.numel() * variable.element_size()) >=
+          min_bytes_;
+  recomputable_.push_back(recomputable);
+  if (!recomputable) {
+    saved_.emplace_back();
+    return {};
+  }
+  saved_.push_back(variable.tensor_data());
+  saved_bytes_ += variable.numel() * variable.element_size();
+  return {at::scalar_tensor(index, at::kLong)};
+}
+
+at::Tensor RecomputePacker::unpack(
+    const std::vector<at::Tensor>& packed,
+    at::ScalarType dtype) const {
+  const auto index = packed[0].item<int64_t>();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (saved_[index].defined()) {
+      return saved_[index];
+    }
+  }
+  replay();
+  std::lock_guard<std::mutex> lock(mutex_);
+  TORCH_CHECK(
+      saved_[index].defined(),
+      "Recomputing a region of the forward pass did not save the same "
+      "tensors as the first run, make sure it does not depend on anything "
+      "but its inputs.");
+  return saved_[index];
+}
+
+void RecomputePacker::replay() const {
+  std::call_once(replayed_, [this] {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      replaying_ = true;
+      replay_index_ = 0;
+    }
+    auto prev = SavedVariablePacker::get();
+    SavedVariablePacker::set(std::const_pointer_cast<RecomputePacker>(
+        shared_from_this()));
+    try {
+      recompute_();
+    } catch (...) {
+      SavedVariablePacker::set(std::move(prev));
+      std::lock_guard<std::mutex> lock(mutex_);
+      replaying_ = false;
+      throw;
+    }
+    SavedVariablePacker::set(std::move(prev));
+    std::lock_guard<std::mutex> lock(mutex_);
+    replaying_ = false;
+  });
+}
+
+void RecomputePacker::finish(bool keep) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  finished_ = true;
+  if (!keep) {
+    for (auto& tensor : saved_) {
+      tensor.reset();
+    }
+  }
+}
+
+int64_t RecomputePacker::saved_bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return saved_bytes_;
+}
+
+}} // namespace torch::autograd
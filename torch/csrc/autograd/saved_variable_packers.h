@@ -0,0 +1,76 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/autograd/saved_variable.h>
+
+#include <ATen/ATen.h>
+#include <c10/util/Optional.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace torch { namespace autograd {
+
+// The built-in saved variable packers, see Note [Saved variable packing] in
+// saved_variable.cpp. They only pack non-leaf floating point variables of at
+// least min_bytes bytes, since leaves (parameters and inputs) stay alive
+// anyway.
+//
+// dtype is the type variables are packed to:
+//   kBFloat16: variables are downcast, halving the memory of float32 ones
+//   kChar: variables are rounded to int8, with one float scale per slice of
+//     dim 1 (per channel, or per feature of 2-d inputs) computed from their
+//     absolute max
+//   nullopt: variables are not packed to another type
+// With relu_mask, the outputs ReLU saves for its backward, which only needs
+// their sign, are packed exactly as bool masks of their positive elements.
+TORCH_API std::shared_ptr<SavedVariablePacker> make_saved_variable_packer(
+    c10::optional<at::ScalarType> dtype,
+    bool relu_mask,
+    int64_t min_bytes);
+
+// Drops the variables saved by one region of the forward pass and recomputes
+// them when the backward first needs one of them, see Note [Recomputed saved
+// variables] in saved_variable_packers.cpp. recompute reruns the forward of the
+// region with this packer set. Variables smaller than min_bytes and leaves
+// are saved as usual.
+class TORCH_API RecomputePacker final
+    : public SavedVariablePacker,
+      public std::enable_shared_from_this<RecomputePacker> {
+ public:
+  RecomputePacker(std::function<void()> recompute, int64_t min_bytes);
+
+  std::vector<at::Tensor> pack(const Variable& variable, bool is_output)
+      const override;
+  at::Tensor unpack(
+      const std::vector<at::Tensor>& packed,
+      at::ScalarType dtype) const override;
+
+  /// Ends the forward of the region. With keep, the variables it saved are
+  /// kept and never recomputed, otherwise they are freed now.
+  void finish(bool keep);
+
+  /// The bytes of the variables the region saved that can be recomputed
+  int64_t saved_bytes() const;
+
+ private:
+  void replay() const;
+
+  const std::function<void()> recompute_;
+  const int64_t min_bytes_;
+  mutable std::mutex mutex_;
+  mutable std::once_flag replayed_;
+  // One entry per variable saved by the region, undefined for the ones saved
+  // as usual or freed by finish()
+  mutable std::vector<at::Tensor> saved_;
+  mutable std::vector<bool> recomputable_;
+  mutable int64_t saved_bytes_ = 0;
+  mutable bool finished_ = false;
+  mutable bool replaying_ = false;
+  mutable size_t replay_index_ = 0;
+};
+
+}} // namespace torch::autograd
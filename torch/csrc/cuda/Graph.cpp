@@ -6,6 +6,7 @@
 #include <torch/csrc/utils/pybind.h>
 
 #include <ATen/cuda/CUDAGraph.h>
+#include <c10/cuda/CUDAGraphsC10Utils.h>
 
 // Cargo culted partially from csrc/distributed/c10d/init.cpp
 // and partially from csrc/cuda/Stream.cpp.
@@ -23,7 +24,12 @@ void THCPGraph_init(PyObject *module) {
   auto torch_C_m = py::handle(module).cast<py::module>();
 
   torch_C_m
-      .def("_graph_pool_handle", &::at::cuda::graph_pool_handle);
+      .def("_graph_pool_handle", &::at::cuda::graph_pool_handle)
+      .def("_cuda_isCurrentStreamCapturing",
+           []() {
+             return ::c10::cuda::currentStreamCaptureStatusMayInitCtx() !=
+                 ::c10::cuda::CaptureStatus::None;
+           });
 
   shared_ptr_class_<::at::cuda::CUDAGraph>(torch_C_m, "_CudaGraphBase")
       .def(py::init<>())
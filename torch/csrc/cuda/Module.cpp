@@ -1,14 +1,19 @@
 #include <array>
+#include <atomic>
 #include <unordered_map>
 #include <thread>
 #include <chrono>
 #include <sstream>
 #include <TH/TH.h>
+#include <THC/THCCachingHostAllocator.h>
 #include <ATen/ATen.h>
 #include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/CUDAEvent.h>
 #include <ATen/CUDAGeneratorImpl.h>
+#include <ATen/record_function.h>
 #include <c10/cuda/CUDAFunctions.h>
 #include <c10/cuda/CUDACachingAllocator.h>
+#include <c10/util/Backtrace.h>
 #ifdef USE_NCCL
 #include <torch/csrc/cuda/python_nccl.h>
 #endif
@@ -174,6 +179,37 @@ PyObject * THCPModule_setStream_wrap(PyObject *self, PyObject *obj)
   END_HANDLE_TH_ERRORS
 }
 
+// Makes a stream that is not owned by PyTorch wait for the work queued so far
+// on the current stream, for handing tensors to other libraries (see
+// Tensor.__dlpack__). The stream is given as a cudaStream_t handle, with the
+// values 1 and 2 of the array API standing for the legacy and the per-thread
+// default stream.
+PyObject * THCPModule_externalStreamWaitCurrent_wrap(PyObject *self, PyObject *obj)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(PyLong_Check(obj), "invalid stream");
+  uintptr_t handle = PyLong_AsUnsignedLongLong(obj);
+  if (handle == static_cast<uintptr_t>(-1) && PyErr_Occurred()) {
+    throw python_error();
+  }
+  cudaStream_t external;
+  if (handle == 1) {
+    external = cudaStreamLegacy;
+  } else if (handle == 2) {
+    external = cudaStreamPerThread;
+  } else {
+    external = reinterpret_cast<cudaStream_t>(handle);
+  }
+  auto current = at::cuda::getCurrentCUDAStream();
+  if (external != current.stream()) {
+    at::cuda::CUDAEvent event;
+    event.record(current);
+    AT_CUDA_CHECK(cudaStreamWaitEvent(external, event.event(), 0));
+  }
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
 PyObject * THCPModule_getCompiledVersion(PyObject *self, PyObject *noargs)
 {
   return THPUtils_packInt64((int64_t) CUDA_VERSION);
@@ -369,6 +405,70 @@ PyObject * THCPModule_memoryStats(PyObject *_unused, PyObject *arg)
   END_HANDLE_TH_ERRORS
 }
 
+PyObject * THCPModule_hostMemoryStats(PyObject *_unused, PyObject *noargs)
+{
+  HANDLE_TH_ERRORS
+  using c10::cuda::CUDACachingAllocator::Stat;
+
+  const auto statToDict = [](const Stat& stat) {
+    py::dict dict;
+
+    dict["current"] = stat.current;
+    dict["peak"] = stat.peak;
+    dict["allocated"] = stat.allocated;
+    dict["freed"] = stat.freed;
+    return dict;
+  };
+
+  const THCCachingHostAllocatorStats stats = THCCachingHostAllocator_getStats();
+
+  py::dict result;
+  result["num_cache_releases"] = stats.num_cache_releases;
+  result["allocation"] = statToDict(stats.allocation);
+  result["segment"] = statToDict(stats.segment);
+  result["allocated_bytes"] = statToDict(stats.allocated_bytes);
+  result["reserved_bytes"] = statToDict(stats.reserved_bytes);
+  result["cached_bytes"] = statToDict(stats.cached_bytes);
+
+  return result.release().ptr();
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject * THCPModule_resetAccumulatedHostMemoryStats(PyObject *_unused, PyObject *noargs)
+{
+  HANDLE_TH_ERRORS
+  THCCachingHostAllocator_resetAccumulatedStats();
+  END_HANDLE_TH_ERRORS
+  Py_RETURN_NONE;
+}
+
+PyObject * THCPModule_resetPeakHostMemoryStats(PyObject *_unused, PyObject *noargs)
+{
+  HANDLE_TH_ERRORS
+  THCCachingHostAllocator_resetPeakStats();
+  END_HANDLE_TH_ERRORS
+  Py_RETURN_NONE;
+}
+
+PyObject * THCPModule_hostEmptyCache(PyObject *_unused, PyObject *noargs)
+{
+  HANDLE_TH_ERRORS
+  THCCachingHostAllocator_emptyCache();
+  END_HANDLE_TH_ERRORS
+  Py_RETURN_NONE;
+}
+
+PyObject * THCPModule_setHostMaxCachedBytes(PyObject *_unused, PyObject *arg)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg), "invalid argument to set_host_memory_cache_limit");
+  const int64_t max_cached_bytes = THPUtils_unpackLong(arg);
+  THPUtils_assert(max_cached_bytes >= 0, "set_host_memory_cache_limit expects a non-negative limit");
+  THCCachingHostAllocator_setMaxCachedBytes(static_cast<size_t>(max_cached_bytes));
+  END_HANDLE_TH_ERRORS
+  Py_RETURN_NONE;
+}
+
 PyObject * THCPModule_resetAccumulatedMemoryStats(PyObject *_unused, PyObject *arg)
 {
   HANDLE_TH_ERRORS
@@ -389,12 +489,83 @@ PyObject * THCPModule_resetPeakMemoryStats(PyObject *_unused, PyObject *arg)
   Py_RETURN_NONE;
 }
 
+PyObject * THCPModule_getAllocatorBackend(PyObject *_unused, PyObject *noargs)
+{
+  HANDLE_TH_ERRORS
+  return THPUtils_packString(c10::cuda::CUDACachingAllocator::allocatorBackend());
+  END_HANDLE_TH_ERRORS
+}
+
+namespace {
+
+using c10::cuda::CUDACachingAllocator::GatheredContext;
+
+// Context of allocator events recorded by _record_memory_history: the
+// RecordFunction scopes (operators and record_function labels) the calling
+// thread is in, and optionally its C++ stack. Symbolizing the stack is
+// deferred to the snapshot.
+struct AllocationContext : public GatheredContext {
+  std::vector<at::StringView> scopes;
+  std::vector<void*> cpp_frames;
+};
+
+// RecordFunction scopes of the current thread, maintained by a thread local
+// RecordFunction callback while the context is recorded
+thread_local std::vector<at::StringView> record_function_scopes;
+c10::optional<at::CallbackHandle> record_function_scopes_handle;
+std::atomic<bool> record_context_cpp{false};
+
+std::unique_ptr<at::ObserverContext> pushRecordFunctionScope(const at::RecordFunction& fn) {
+  record_function_scopes.push_back(fn.name());
+  return nullptr;
+}
+
+void popRecordFunctionScope(const at::RecordFunction& /* unused */, at::ObserverContext* /* unused */) {
+  if (!record_function_scopes.empty()) {
+    record_function_scopes.pop_back();
+  }
+}
+
+std::shared_ptr<GatheredContext> gatherAllocationContext() {
+  auto context = std::make_shared<AllocationContext>();
+  context->scopes = record_function_scopes;
+  if (record_context_cpp) {
+    // skip this frame
+    context->cpp_frames = c10::get_backtrace_frames(/*frames_to_skip=*/1);
+  }
+  return context;
+}
+
+void addContextToDict(const std::shared_ptr<GatheredContext>& context, py::dict& dict) {
+  const auto* allocation_context = dynamic_cast<const AllocationContext*>(context.get());
+  if (!allocation_context) {
+    return;
+  }
+  py::list scopes;
+  for (const auto& scope : allocation_context->scopes) {
+    scopes.append(scope.str());
+  }
+  dict["scopes"] = scopes;
+  if (!allocation_context->cpp_frames.empty()) {
+    py::list frames;
+    std::istringstream lines(c10::symbolize_backtrace_frames(allocation_context->cpp_frames));
+    std::string line;
+    while (std::getline(lines, line)) {
+      frames.append(line);
+    }
+    dict["cpp_frames"] = frames;
+  }
+}
+
+} // namespace
+
 PyObject * THCPModule_memorySnapshot(PyObject *_unused, PyObject *noargs)
 {
   HANDLE_TH_ERRORS
 
   using c10::cuda::CUDACachingAllocator::SegmentInfo;
   using c10::cuda::CUDACachingAllocator::BlockInfo;
+  using c10::cuda::CUDACachingAllocator::TraceEntry;
 
   const auto segmentInfoToDict = [](const SegmentInfo& segmentInfo) {
     py::dict segmentDict;
@@ -404,12 +575,17 @@ PyObject * THCPModule_memorySnapshot(PyObject *_unused, PyObject *noargs)
     segmentDict["allocated_size"] = segmentInfo.allocated_size;
     segmentDict["active_size"] = segmentInfo.active_size;
     segmentDict["segment_type"] = (segmentInfo.is_large ? "large" : "small");
+    segmentDict["is_expandable"] = segmentInfo.is_expandable;
+    segmentDict["stream"] = segmentInfo.stream;
+    addContextToDict(segmentInfo.context_when_allocated, segmentDict);
 
     py::list blocks;
     for (const auto& blockInfo : segmentInfo.blocks) {
       py::dict blockDict;
       blockDict["size"] = blockInfo.size;
+      blockDict["requested_size"] = blockInfo.requested_size;
       blockDict["state"] = (blockInfo.allocated ? "active_allocated" : (blockInfo.active ? "active_pending_free" : "inactive"));
+      addContextToDict(blockInfo.context_when_allocated, blockDict);
       blocks.append(blockDict);
     }
     segmentDict["blocks"] = blocks;
@@ -417,17 +593,99 @@ PyObject * THCPModule_memorySnapshot(PyObject *_unused, PyObject *noargs)
     return segmentDict;
   };
 
-  const std::vector<SegmentInfo>& snapshot = c10::cuda::CUDACachingAllocator::snapshot();
-  py::list result;
+  const auto traceEntryToDict = [](const TraceEntry& entry) {
+    static const std::array<const char*, 8> action_names = {
+        "alloc", "free_requested", "free_completed", "segment_alloc",
+        "segment_free", "segment_map", "segment_unmap", "oom"};
+    py::dict entryDict;
+    entryDict["action"] = action_names.at(entry.action);
+    if (entry.action == TraceEntry::OOM) {
+      entryDict["device_free"] = entry.addr;
+    } else {
+      entryDict["addr"] = entry.addr;
+    }
+    entryDict["size"] = entry.size;
+    entryDict["stream"] = reinterpret_cast<int64_t>(entry.stream);
+    addContextToDict(entry.context, entryDict);
+    return entryDict;
+  };
 
-  for (const auto& segmentInfo : snapshot) {
-    result.append(segmentInfoToDict(segmentInfo));
+  const auto snapshot = c10::cuda::CUDACachingAllocator::snapshot();
+  py::list segments;
+  for (const auto& segmentInfo : snapshot.segments) {
+    segments.append(segmentInfoToDict(segmentInfo));
   }
 
+  py::list traces;
+  for (const auto& trace : snapshot.device_traces) {
+    py::list trace_entries;
+    for (const auto& entry : trace) {
+      trace_entries.append(traceEntryToDict(entry));
+    }
+    traces.append(trace_entries);
+  }
+
+  py::dict result;
+  result["segments"] = segments;
+  result["device_traces"] = traces;
   return result.release().ptr();
   END_HANDLE_TH_ERRORS
 }
 
+PyObject * THCPModule_recordMemoryHistory(PyObject *_unused, PyObject *args)
+{
+  HANDLE_TH_ERRORS
+  int enabled = 0;
+  int record_context = 0;
+  int record_cpp = 0;
+  Py_ssize_t trace_alloc_max_entries = 0;
+  int trace_alloc_record_context = 0;
+  if (!PyArg_ParseTuple(args, "pppnp", &enabled, &record_context, &record_cpp,
+                        &trace_alloc_max_entries, &trace_alloc_record_context)) {
+    throw python_error();
+  }
+  THPUtils_assert(trace_alloc_max_entries >= 0,
+                  "_record_memory_history expects a non-negative trace_alloc_max_entries");
+
+  const bool gather = enabled && record_context;
+  record_context_cpp = record_cpp;
+  if (gather && !record_function_scopes_handle) {
+    record_function_scopes_handle = at::addThreadLocalCallback(
+        at::RecordFunctionCallback(pushRecordFunctionScope, popRecordFunctionScope));
+  } else if (!gather && record_function_scopes_handle) {
+    at::removeCallback(*record_function_scopes_handle);
+    record_function_scopes_handle = c10::nullopt;
+    record_function_scopes.clear();
+  }
+  c10::cuda::CUDACachingAllocator::recordHistory(
+      enabled, gather ? gatherAllocationContext : nullptr,
+      static_cast<size_t>(trace_alloc_max_entries), trace_alloc_record_context);
+  END_HANDLE_TH_ERRORS
+  Py_RETURN_NONE;
+}
+
+PyObject * THCPModule_attachOutOfMemoryObserver(PyObject *_unused, PyObject *observer)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(PyCallable_Check(observer), "expected a callable out of memory observer");
+  // Leaked on purpose, the observer stays attached until exit, when it can no
+  // longer be destroyed safely
+  auto* observer_obj = new py::object(py::reinterpret_borrow<py::object>(observer));
+  c10::cuda::CUDACachingAllocator::attachOutOfMemoryObserver(
+      [observer_obj](int64_t device, int64_t alloc_size, int64_t device_total, int64_t device_free) {
+        py::gil_scoped_acquire g;
+        try {
+          (*observer_obj)(device, alloc_size, device_total, device_free);
+        } catch (py::error_already_set& e) {
+          // the out of memory error is thrown regardless
+          e.restore();
+          PyErr_Print();
+        }
+      });
+  END_HANDLE_TH_ERRORS
+  Py_RETURN_NONE;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Cuda module initialization
 ////////////////////////////////////////////////////////////////////////////////
@@ -545,6 +803,7 @@ static struct PyMethodDef _THCPModule_methods[] = {
     THCPModule_getDefaultStream_wrap, METH_O, nullptr},
   {"_cuda_getCurrentBlasHandle", THCPModule_getCurrentBlasHandle_wrap, METH_NOARGS, nullptr},
   {"_cuda_setStream",    THCPModule_setStream_wrap,  METH_O, nullptr},
+  {"_cuda_externalStreamWaitCurrent", THCPModule_externalStreamWaitCurrent_wrap, METH_O, nullptr},
   {"_cuda_getCompiledVersion", THCPModule_getCompiledVersion, METH_NOARGS, nullptr},
   {"_cuda_hasPrimaryContext", THCPModule_hasPrimaryContext,  METH_O,  nullptr},
   {"_cuda_setMemoryFraction", THCPModule_setMemoryFraction, METH_VARARGS,  nullptr},
@@ -553,7 +812,15 @@ static struct PyMethodDef _THCPModule_methods[] = {
   {"_cuda_resetAccumulatedMemoryStats", THCPModule_resetAccumulatedMemoryStats, METH_O, nullptr},
   {"_cuda_resetPeakMemoryStats", THCPModule_resetPeakMemoryStats, METH_O,  nullptr},
   {"_cuda_memorySnapshot", THCPModule_memorySnapshot, METH_NOARGS, nullptr},
+  {"_cuda_getAllocatorBackend", THCPModule_getAllocatorBackend, METH_NOARGS, nullptr},
+  {"_cuda_recordMemoryHistory", THCPModule_recordMemoryHistory, METH_VARARGS, nullptr},
+  {"_cuda_attachOutOfMemoryObserver", THCPModule_attachOutOfMemoryObserver, METH_O, nullptr},
   {"_cuda_cudaHostAllocator", THCPModule_cudaHostAllocator, METH_NOARGS, nullptr},
+  {"_cuda_hostMemoryStats", THCPModule_hostMemoryStats, METH_NOARGS, nullptr},
+  {"_cuda_resetAccumulatedHostMemoryStats", THCPModule_resetAccumulatedHostMemoryStats, METH_NOARGS, nullptr},
+  {"_cuda_resetPeakHostMemoryStats", THCPModule_resetPeakHostMemoryStats, METH_NOARGS, nullptr},
+  {"_cuda_hostEmptyCache", THCPModule_hostEmptyCache, METH_NOARGS, nullptr},
+  {"_cuda_setHostMaxCachedBytes", THCPModule_setHostMaxCachedBytes, METH_O, nullptr},
   {"_cuda_cudaCachingAllocator_raw_alloc", THCPModule_cudaCachingAllocator_raw_alloc, METH_VARARGS, nullptr},
   {"_cuda_cudaCachingAllocator_raw_delete", THCPModule_cudaCachingAllocator_raw_delete, METH_O, nullptr},
   {"_cuda_synchronize", THCPModule_cudaSynchronize, METH_NOARGS, nullptr},
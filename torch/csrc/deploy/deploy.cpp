@@ -2,8 +2,12 @@
 
 #include <dlfcn.h>
 #include <libgen.h>
+#include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
 
+#include <exception>
+
 // these symbols are generated by cmake, using ld -r -b binary
 // libtorch_deployinterpreter.so which takes the contents of the so and embeds
 // it into a symbol that is then linked into libtorch_deploy.so. This enables us
@@ -15,6 +19,96 @@ extern "C" char _binary_libtorch_deployinterpreter_so_end[];
 namespace torch {
 namespace deploy {
 
+// Pins the current thread to a set of CPUs, and restores its previous
+// affinity when destroyed.
+struct CpuAffinityGuard {
+  explicit CpuAffinityGuard(const std::vector<int>& cpus)
+      : thread_(pthread_self()) {
+    TORCH_CHECK(
+        pthread_getaffinity_np(thread_, sizeof(previous_), &previous_) == 0,
+        "failed to get the CPU affinity of the thread");
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int cpu : cpus) {
+      CPU_SET(cpu, &cpu_set);
+    }
+    TORCH_CHECK(
+        pthread_setaffinity_np(thread_, sizeof(cpu_set), &cpu_set) == 0,
+        "failed to set the CPU affinity of the thread");
+  }
+  ~CpuAffinityGuard() {
+    pthread_setaffinity_np(thread_, sizeof(previous_), &previous_);
+  }
+
+ private:
+  pthread_t thread_;
+  cpu_set_t previous_;
+};
+
+namespace {
+
+int64_t interpreter_index(
+    InterpreterManager* manager,
+    const Interpreter* interp) {
+  auto instances = manager->all_instances();
+  for (size_t i = 0; i < instances.size(); ++i) {
+    if (&instances[i] == interp) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+} // namespace
+
+InterpreterSession InterpreterManager::acquire_one(
+    const std::atomic<bool>* warm) {
+  int where = resources_.acquire(warm);
+  InterpreterSession I = instances_[where].acquire_session();
+  I.notify_idx_ = where;
+  if (!cpu_affinity_[where].empty()) {
+    I.affinity_guard_ =
+        std::make_unique<CpuAffinityGuard>(cpu_affinity_[where]);
+  }
+  return I;
+}
+
+InterpreterManager::InterpreterManager(size_t n_interp)
+    : cpu_affinity_(n_interp), resources_(n_interp) {
+  // Starting an interpreter is dominated by initializing its Python and
+  // importing torch, which every interpreter does in its own copy of the
+  // library, so they can be started in parallel.
+  std::vector<std::unique_ptr<Interpreter>> started(n_interp);
+  std::vector<std::exception_ptr> errors(n_interp);
+  std::vector<std::thread> threads;
+  threads.reserve(n_interp);
+  for (size_t i = 0; i < n_interp; ++i) {
+    threads.emplace_back([this, i, &started, &errors] {
+      try {
+        started[i] = std::make_unique<Interpreter>(this);
+        auto I = started[i]->acquire_session();
+        // make torch.version.interp be the interpreter id
+        // can be used for balancing work across GPUs
+        I.global("torch", "version").attr("__setattr__")({"interp", int(i)});
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+  instances_.reserve(n_interp);
+  for (auto& interp : started) {
+    instances_.emplace_back(std::move(*interp));
+  }
+}
+
 Package InterpreterManager::load_package(const std::string& uri) {
   return Package(uri, this);
 }
@@ -31,8 +125,14 @@ InterpreterSession ReplicatedObj::acquire_session(
     const Interpreter* on_this_interpreter) const {
   InterpreterSession I = on_this_interpreter
       ? on_this_interpreter->acquire_session()
-      : pImpl_->manager_->acquire_one();
+      : pImpl_->manager_->acquire_one(pImpl_->loaded_.get());
   I.self = I.from_movable(*this);
+  int64_t idx = on_this_interpreter
+      ? interpreter_index(pImpl_->manager_, on_this_interpreter)
+      : I.notify_idx_;
+  if (idx >= 0) {
+    pImpl_->loaded_[idx] = true;
+  }
   return I;
 }
 
@@ -52,6 +152,10 @@ void ReplicatedObjImpl::unload(const Interpreter* on_this_interpreter) {
 
   InterpreterSession I = on_this_interpreter->acquire_session();
   I.impl_->unload(object_id_);
+  int64_t idx = interpreter_index(manager_, on_this_interpreter);
+  if (idx >= 0) {
+    loaded_[idx] = false;
+  }
 }
 
 ReplicatedObjImpl::~ReplicatedObjImpl() {
@@ -109,43 +213,100 @@ Interpreter::~Interpreter() {
   }
 }
 
-int LoadBalancer::acquire() {
+int LoadBalancer::try_acquire(const std::atomic<bool>* warm, uint64_t limit) {
   thread_local int last = 0;
-  size_t minusers = SIZE_MAX;
-  int min_idx = 0;
+  auto claim = [&](int idx) {
+    uint64_t prev = __atomic_load_n(&uses_[8 * idx], __ATOMIC_SEQ_CST);
+    while (prev < limit) {
+      if (__atomic_compare_exchange_n(
+              &uses_[8 * idx],
+              &prev,
+              prev + 1,
+              false,
+              __ATOMIC_SEQ_CST,
+              __ATOMIC_SEQ_CST)) {
+        last = idx;
+        return true;
+      }
+    }
+    return false;
+  };
+  if (warm) {
+    for (size_t i = 0; i < n_; ++i) {
+      if (warm[i].load(std::memory_order_relaxed) && claim(i)) {
+        return i;
+      }
+    }
+  }
+  // start from the interpreter this thread used last, so that a thread
+  // tends to keep using the same one
   for (size_t i = 0; i < n_; ++i, ++last) {
     if (last >= n_) {
       last = 0;
     }
-    uint64_t prev = 0;
-    bool acquired = __atomic_compare_exchange_n(
-        &uses_[8 * last],
-        &prev,
-        1ULL,
-        false,
-        __ATOMIC_SEQ_CST,
-        __ATOMIC_SEQ_CST);
-    if (acquired) {
-      // fast path, we found an interpreter with no users
+    if (claim(last)) {
       return last;
     }
-    // slow path, we don't want to use this interpreter because it is being
-    // used by someone else.
+  }
+  return -1;
+}
 
-    if (prev < minusers) {
-      minusers = prev;
-      min_idx = last;
+int LoadBalancer::acquire(const std::atomic<bool>* warm) {
+  const uint64_t max_users = max_users_;
+  // when callers are queued, new ones wait behind them
+  if (max_users == 0 || waiting_ == 0) {
+    // fast path, we find an interpreter with no users
+    int where = try_acquire(warm, 1);
+    if (where >= 0) {
+      return where;
     }
   }
-  // we failed to find a completely free interpreter. heuristically use the
-  // one with the least number of user (note that this may have changed since
-  // then, so this is only a heuristic).
-  __atomic_fetch_add(&uses_[8 * min_idx], 1ULL, __ATOMIC_SEQ_CST);
-  return min_idx;
+
+  if (max_users == 0) {
+    // we failed to find a completely free interpreter. heuristically use the
+    // one with the least number of user (note that this may have changed
+    // since then, so this is only a heuristic).
+    uint64_t minusers = UINT64_MAX;
+    int min_idx = 0;
+    for (size_t i = 0; i < n_; ++i) {
+      uint64_t users = __atomic_load_n(&uses_[8 * i], __ATOMIC_SEQ_CST);
+      if (users < minusers) {
+        minusers = users;
+        min_idx = i;
+      }
+    }
+    __atomic_fetch_add(&uses_[8 * min_idx], 1ULL, __ATOMIC_SEQ_CST);
+    return min_idx;
+  }
+
+  // slow path, wait for our turn and an interpreter with room for one more
+  // user
+  std::unique_lock<std::mutex> lock(mutex_);
+  const uint64_t ticket = next_ticket_++;
+  ++waiting_;
+  int where = -1;
+  cv_.wait(lock, [&] {
+    if (ticket != serving_ticket_) {
+      return false;
+    }
+    where = try_acquire(warm, max_users);
+    return where >= 0;
+  });
+  ++serving_ticket_;
+  --waiting_;
+  lock.unlock();
+  cv_.notify_all();
+  return where;
 }
 
 void LoadBalancer::free(int where) {
   __atomic_fetch_sub(&uses_[8 * where], 1ULL, __ATOMIC_SEQ_CST);
+  if (waiting_ > 0) {
+    // a waiter holds the mutex between checking for a free interpreter and
+    // waiting, so taking it here makes sure that the waiter gets notified
+    { std::lock_guard<std::mutex> guard(mutex_); }
+    cv_.notify_all();
+  }
 }
 
 } // namespace deploy
@@ -1,8 +1,11 @@
 #pragma once
 #include <assert.h>
 #include <torch/csrc/deploy/interpreter/interpreter_impl.h>
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
@@ -12,6 +15,7 @@ namespace deploy {
 
 struct ReplicatedObj;
 struct InterpreterManager;
+struct CpuAffinityGuard;
 
 struct TORCH_API InterpreterSession {
   InterpreterSession(
@@ -40,6 +44,9 @@ struct TORCH_API InterpreterSession {
   std::unique_ptr<InterpreterSessionImpl> impl_;
   InterpreterManager* manager_; // if created from one
   int64_t notify_idx_ = -1;
+  // restores the CPU affinity of the acquiring thread, see
+  // InterpreterManager::setInterpreterCpuAffinity
+  std::unique_ptr<CpuAffinityGuard> affinity_guard_;
 };
 
 class TORCH_API Interpreter {
@@ -81,34 +88,42 @@ struct TORCH_API LoadBalancer {
     TORCH_INTERNAL_ASSERT(n <= allocated_);
     n_ = n;
   }
-  int acquire();
+  // Limit the number of users of an interpreter. When all interpreters have
+  // that many users, acquire blocks until one is freed, and blocked callers
+  // are served in the order they arrived. 0, the default, means no limit:
+  // acquire never blocks and picks the interpreter with the fewest users.
+  void setMaxUsersPerInterpreter(size_t n) {
+    max_users_ = n;
+  }
+  // `warm`, when given, has an entry per interpreter; free interpreters
+  // with a true entry are picked before the others.
+  int acquire(const std::atomic<bool>* warm = nullptr);
   void free(int where);
 
  private:
+  // claim an interpreter with fewer than `limit` users, or return -1
+  int try_acquire(const std::atomic<bool>* warm, uint64_t limit);
+
   std::unique_ptr<uint64_t[]>
       uses_; // the approximate count of the number of users of interpreter
   size_t allocated_;
   size_t n_;
+  std::atomic<size_t> max_users_{0};
+  // FIFO queue of the callers blocked in acquire
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  uint64_t next_ticket_ = 0; // guarded by mutex_
+  uint64_t serving_ticket_ = 0; // guarded by mutex_
+  std::atomic<uint64_t> waiting_{0};
 };
 
 struct TORCH_API InterpreterManager {
-  InterpreterManager(size_t n_interp = 2) : resources_(n_interp) {
-    for (size_t i = 0; i < n_interp; ++i) {
-      instances_.emplace_back(this);
-      auto I = instances_.back().acquire_session();
-      // make torch.version.interp be the interpreter id
-      // can be used for balancing work across GPUs
-      I.global("torch", "version").attr("__setattr__")({"interp", int(i)});
-      // std::cerr << "Interpreter " << i << " initialized\n";
-    }
-  }
+  // the interpreters are started concurrently, each on its own thread
+  InterpreterManager(size_t n_interp = 2);
   // get a free model, guarenteed that no other user of acquire_one has the same
   // model. It _is_ possible that other users will be using the interpreter.
   InterpreterSession acquire_one() {
-    int where = resources_.acquire();
-    InterpreterSession I = instances_[where].acquire_session();
-    I.notify_idx_ = where;
-    return I;
+    return acquire_one(nullptr);
   }
 
   // use to make sure something gets run on all interpreters, such as loading or
@@ -120,6 +135,18 @@ struct TORCH_API InterpreterManager {
     AT_ASSERT(N <= instances_.size());
     resources_.setResourceLimit(N);
   }
+  // see LoadBalancer::setMaxUsersPerInterpreter
+  void setMaxUsersPerInterpreter(size_t N) {
+    resources_.setMaxUsersPerInterpreter(N);
+  }
+  // Pin the thread that acquires a session on interpreter `interp` through
+  // acquire_one to the given CPUs until the session is destroyed, which must
+  // happen on the same thread. Call before acquiring sessions. To spread
+  // interpreters over GPUs, use torch.version.interp, the interpreter id.
+  void setInterpreterCpuAffinity(size_t interp, std::vector<int> cpus) {
+    TORCH_CHECK(interp < instances_.size(), "no interpreter ", interp);
+    cpu_affinity_[interp] = std::move(cpus);
+  }
   Package load_package(const std::string& uri);
   Package load_package(std::shared_ptr<caffe2::serialize::ReadAdapterInterface> reader);
   InterpreterManager(const InterpreterManager&) = delete;
@@ -129,8 +156,11 @@ struct TORCH_API InterpreterManager {
  private:
   friend struct Package;
   friend struct InterpreterSession;
+  friend struct ReplicatedObj;
+  InterpreterSession acquire_one(const std::atomic<bool>* warm);
   size_t next_object_id_ = 0;
   std::vector<Interpreter> instances_;
+  std::vector<std::vector<int>> cpu_affinity_;
   LoadBalancer resources_;
 };
 
@@ -139,12 +169,18 @@ struct TORCH_API ReplicatedObjImpl {
       size_t object_id,
       PickledObject data,
       InterpreterManager* manager)
-      : object_id_(object_id), data_(data), manager_(manager) {}
+      : object_id_(object_id),
+        data_(data),
+        manager_(manager),
+        loaded_(new std::atomic<bool>[manager->all_instances().size()]()) {}
   ~ReplicatedObjImpl();
   void unload(const Interpreter* on_this_interpreter);
   int64_t object_id_;
   PickledObject data_;
   InterpreterManager* manager_;
+  // whether the object is unpickled on each interpreter of manager_, so
+  // that its sessions go to those interpreters when they are free
+  std::unique_ptr<std::atomic<bool>[]> loaded_;
 };
 
 struct TORCH_API ReplicatedObj {
@@ -192,7 +228,7 @@ struct TORCH_API Package {
   InterpreterSession acquire_session() {
     auto I = manager_->acquire_one();
     I.self = I.impl_->create_or_get_package_importer_from_container_file(
-        container_file_);
+        container_file_, storage_cache_);
     return I;
   }
 
@@ -203,18 +239,23 @@ struct TORCH_API Package {
           pm) // or really any of the constructors to our zip file format
       : manager_(pm),
         container_file_(
-            std::make_shared<caffe2::serialize::PyTorchStreamReader>(uri)) {}
+            std::make_shared<caffe2::serialize::PyTorchStreamReader>(uri)),
+        storage_cache_(std::make_shared<StorageCache>()) {}
     Package(
       std::shared_ptr<caffe2::serialize::ReadAdapterInterface> reader,
       InterpreterManager*
           pm) // or really any of the constructors to our zip file format
       : manager_(pm),
         container_file_(
-            std::make_shared<caffe2::serialize::PyTorchStreamReader>(reader)) {}
+            std::make_shared<caffe2::serialize::PyTorchStreamReader>(reader)),
+        storage_cache_(std::make_shared<StorageCache>()) {}
   friend struct ReplicatedObj;
   friend struct InterpreterManager;
   InterpreterManager* manager_;
   std::shared_ptr<caffe2::serialize::PyTorchStreamReader> container_file_;
+  // the storages of the tensors loaded from the package, shared by all the
+  // interpreters
+  std::shared_ptr<StorageCache> storage_cache_;
 };
 
 } // namespace deploy
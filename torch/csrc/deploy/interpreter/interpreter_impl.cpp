@@ -351,9 +351,34 @@ struct ConcreteInterpreterSessionImpl
   }
   Obj create_or_get_package_importer_from_container_file(
       const std::shared_ptr<caffe2::serialize::PyTorchStreamReader>&
-          container_file_) override {
+          container_file_,
+      const std::shared_ptr<torch::deploy::StorageCache>& storage_cache)
+      override {
     InitLockAcquire guard(interp_->init_lock_);
-    return wrap(interp_->get_package(container_file_));
+    // same as PyTorchFileReader.get_storage_from_record, but through the
+    // cache shared with the other interpreters
+    py::cpp_function get_storage_from_record(
+        [container_file_, storage_cache](
+            const std::string& record, size_t numel, py::object dtype) {
+          auto scalar_type =
+              reinterpret_cast<THPDtype*>(dtype.ptr())->scalar_type;
+          at::Storage storage = storage_cache->get_or_load(record, [&] {
+            at::DataPtr data(std::get<0>(container_file_->getRecord(record)));
+            return at::Storage(
+                c10::Storage::use_byte_size_t(),
+                numel * c10::elementSize(scalar_type),
+                std::move(data),
+                /*allocator=*/nullptr,
+                /*resizable=*/false);
+          });
+          auto ptr =
+              c10::make_intrusive<at::TensorImpl, at::UndefinedTensorImpl>(
+                  std::move(storage),
+                  at::DispatchKeySet(),
+                  at::CPU(scalar_type).typeMeta());
+          return at::Tensor(std::move(ptr));
+        });
+    return wrap(interp_->get_package(container_file_, get_storage_from_record));
   }
 
   PickledObject pickle(Obj container, Obj obj) override {
@@ -2,7 +2,11 @@
 // multi-python abstract code
 #include <ATen/ATen.h>
 #include <ATen/core/ivalue.h>
+#include <c10/util/intrusive_ptr.h>
 #include <caffe2/serialize/inline_container.h>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
 
 namespace torch {
 namespace deploy {
@@ -18,6 +22,42 @@ struct PickledObject {
   std::shared_ptr<caffe2::serialize::PyTorchStreamReader> container_file_;
 };
 
+// the storages loaded from the records of a package, shared by all the
+// interpreters so that a package loaded on many interpreters holds a single
+// copy of its tensors. Storages are weakly referenced, so they are freed once
+// no interpreter uses them.
+struct StorageCache {
+  // return the storage of `record`, calling `load` if it is not loaded yet
+  at::Storage get_or_load(
+      const std::string& record,
+      const std::function<at::Storage()>& load) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = storages_.find(record);
+    if (it != storages_.end()) {
+      auto storage_impl = it->second.lock();
+      if (storage_impl) {
+        return at::Storage(std::move(storage_impl));
+      }
+    }
+    at::Storage storage = load();
+    at::Storage ref = storage;
+    c10::weak_intrusive_ptr<c10::StorageImpl> weak_ref(
+        c10::intrusive_ptr<c10::StorageImpl>::reclaim(
+            ref.unsafeReleaseStorageImpl()));
+    if (it != storages_.end()) {
+      it->second = std::move(weak_ref);
+    } else {
+      storages_.emplace(record, std::move(weak_ref));
+    }
+    return storage;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, c10::weak_intrusive_ptr<c10::StorageImpl>>
+      storages_;
+};
+
 // this is a wrapper class that refers to a PyObject* instance in a particular
 // interpreter. We can't use normal PyObject or pybind11 objects here
 // because these objects get used in a user application which will not directly
@@ -55,7 +95,8 @@ struct InterpreterSessionImpl {
   virtual Obj from_ivalue(at::IValue value) = 0;
   virtual Obj create_or_get_package_importer_from_container_file(
       const std::shared_ptr<caffe2::serialize::PyTorchStreamReader>&
-          container_file_) = 0;
+          container_file_,
+      const std::shared_ptr<StorageCache>& storage_cache) = 0;
 
   virtual PickledObject pickle(Obj container, Obj obj) = 0;
   virtual Obj unpickle_or_get(int64_t id, const PickledObject& obj) = 0;
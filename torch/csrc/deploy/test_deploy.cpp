@@ -121,3 +121,44 @@ TEST(TorchpyTest, ThreadedSimpleModel) {
     ASSERT_TRUE(ref_output.equal(outputs[i]));
   }
 }
+
+TEST(TorchpyTest, SharedStorages) {
+  torch::deploy::InterpreterManager manager(2);
+  torch::deploy::Package p = manager.load_package(path("SIMPLE", simple));
+  auto first_parameter = [](torch::deploy::InterpreterSession& I) {
+    auto model = I.self.attr("load_pickle")({"model", "model.pkl"});
+    auto parameters = I.global("builtins", "iter")(
+        {model.attr("parameters")(std::vector<torch::deploy::Obj>())});
+    return I.global("builtins", "next")({parameters}).toIValue().toTensor();
+  };
+  // both sessions are held, so they are on different interpreters
+  auto I0 = p.acquire_session();
+  auto I1 = p.acquire_session();
+  ASSERT_EQ(first_parameter(I0).data_ptr(), first_parameter(I1).data_ptr());
+}
+
+TEST(TorchpyTest, LoadBalancerPrefersWarmInterpreters) {
+  torch::deploy::LoadBalancer balancer(3);
+  std::atomic<bool> warm[3] = {{false}, {false}, {true}};
+  int where = balancer.acquire(warm);
+  ASSERT_EQ(where, 2);
+  // the warm interpreter is busy, so a free one is used instead
+  int other = balancer.acquire(warm);
+  ASSERT_NE(other, 2);
+  balancer.free(where);
+  balancer.free(other);
+}
+
+TEST(TorchpyTest, LoadBalancerQueuesWhenBusy) {
+  torch::deploy::LoadBalancer balancer(1);
+  balancer.setMaxUsersPerInterpreter(1);
+  int where = balancer.acquire();
+  auto waiter = std::async(
+      std::launch::async, [&balancer]() { return balancer.acquire(); });
+  ASSERT_EQ(
+      waiter.wait_for(std::chrono::milliseconds(100)),
+      std::future_status::timeout);
+  balancer.free(where);
+  ASSERT_EQ(waiter.get(), 0);
+  balancer.free(0);
+}
@@ -107,8 +107,7 @@ void DistEngine::globalCpuThread(
 }
 
 DistEngine::DistEngine()
-    : initializedContextIds_(),
-      engine_(Engine::get_default_engine()),
+    : engine_(Engine::get_default_engine()),
       global_cpu_ready_queue_(std::make_shared<ReadyQueue>()),
       global_cpu_thread_(
           &DistEngine::globalCpuThread,
@@ -339,6 +338,32 @@ void DistEngine::execute_graph_task_until_ready_queue_empty(
       if (!(local_graph_task = task.base_.lock())) {
         continue;
       }
+      // Note [Pipelined gradient sends]
+      // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+      // RecvRpcBackward has no local next functions, all it does is to
+      // serialize its gradients and send them to the node that ran the
+      // forward. If there is still local work in the queue, hand the send to
+      // another thread so that the rest of this graph (and the backward pass
+      // on the peer, which is waiting for these gradients) does not wait for
+      // it. The outstanding task is accounted for by the launched execution,
+      // which does not increment it again.
+      if (task.fn_ && !cpu_ready_queue->empty() &&
+          dynamic_cast<RecvRpcBackward*>(task.fn_.get())) {
+        auto variables = InputBuffer::variables(std::move(task.inputs_));
+        at::launch([this,
+                    graphTask = local_graph_task,
+                    recvFn = task.fn_,
+                    variables = std::move(variables)]() mutable {
+          InputBuffer inputs(variables.size());
+          for (size_t i = 0; i < variables.size(); i++) {
+            inputs.add(i, std::move(variables[i]), c10::nullopt, c10::nullopt);
+          }
+          execute_graph_task_until_ready_queue_empty(
+              /*node_task*/ NodeTask(graphTask, recvFn, std::move(inputs)),
+              /*incrementOutstandingTasks*/ false);
+        });
+        continue;
+      }
       if (task.fn_ && !local_graph_task->has_error_.load()) {
         AutoGradMode grad_mode(local_graph_task->grad_mode_);
         try {
@@ -445,9 +470,11 @@ std::shared_ptr<c10::ivalue::Future> DistEngine::executeSendFunctionAsync(
     }
   }
 
-  std::unique_lock<std::mutex> lock(initializedContextIdsLock_);
-  if (initializedContextIds_.find(autogradContext->contextId()) ==
-      initializedContextIds_.end()) {
+  // Only backward passes of this context wait for its dependencies to be
+  // computed, those of other contexts proceed concurrently.
+  auto initState = getOrCreateContextInitState(autogradContext->contextId());
+  std::unique_lock<std::mutex> lock(initState->mutex);
+  if (!initState->initialized.load()) {
     edge_list outputEdges;
     // Pass in a dummy graphRoot since all send functions are the roots.
     auto dummyRoot = std::make_shared<GraphRoot>(edge_list(), variable_list());
@@ -455,7 +482,7 @@ std::shared_ptr<c10::ivalue::Future> DistEngine::executeSendFunctionAsync(
         autogradContext, {}, {}, dummyRoot, outputEdges, retainGraph);
 
     // Mark the autograd context id as initialized and unlock.
-    initializedContextIds_.insert(autogradContext->contextId());
+    initState->initialized.store(true);
     lock.unlock();
 
     // Enqueue the current send function.
@@ -545,17 +572,16 @@ void DistEngine::execute(
   // Compute dependencies locally, starting from all roots and all 'send'
   // functions.
   {
-    std::lock_guard<std::mutex> guard(initializedContextIdsLock_);
+    auto initState = getOrCreateContextInitState(autogradContext->contextId());
+    std::lock_guard<std::mutex> guard(initState->mutex);
     // Context should not have been initialized already.
-    TORCH_INTERNAL_ASSERT(
-        initializedContextIds_.find(autogradContext->contextId()) ==
-        initializedContextIds_.end());
+    TORCH_INTERNAL_ASSERT(!initState->initialized.load());
 
     computeDependencies(
         autogradContext, rootEdges, grads, graphRoot, outputEdges, retainGraph);
 
     // Mark the autograd context id as initialized.
-    initializedContextIds_.insert(autogradContext->contextId());
+    initState->initialized.store(true);
   }
 
   BackwardPassCleanupGuard guard(autogradContext);
@@ -594,9 +620,25 @@ void DistEngine::cleanupBackwardPass(const ContextPtr& autogradContext) {
   initializedContextIds_.erase(autogradContext->contextId());
 }
 
+std::shared_ptr<DistEngine::ContextInitState> DistEngine::
+    getOrCreateContextInitState(int64_t contextId) {
+  std::lock_guard<std::mutex> guard(initializedContextIdsLock_);
+  auto& initState = initializedContextIds_[contextId];
+  if (!initState) {
+    initState = std::make_shared<ContextInitState>();
+  }
+  return initState;
+}
+
 size_t DistEngine::numBackwardPasses() const {
   std::lock_guard<std::mutex> guard(initializedContextIdsLock_);
-  return initializedContextIds_.size();
+  size_t numInitialized = 0;
+  for (const auto& entry : initializedContextIds_) {
+    if (entry.second->initialized.load()) {
+      ++numInitialized;
+    }
+  }
+  return numInitialized;
 }
 
 std::unordered_map<std::string, int> DistEngine::getDebugInfo() const {
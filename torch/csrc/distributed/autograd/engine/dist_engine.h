@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <torch/csrc/autograd/engine.h>
@@ -138,10 +140,27 @@ class TORCH_API DistEngine {
   void globalCpuThread(
       const std::shared_ptr<torch::autograd::ReadyQueue>& ready_queue);
 
-  // Set of autograd context_ids, which we have already initialized for
-  // distributed autograd on this node (e.g.: already computed dependencies)
-  std::unordered_set<int64_t> initializedContextIds_;
-
+  // Initialization state of an autograd context for distributed autograd on
+  // this node. 'mutex' is held while the dependencies of the context are
+  // computed, so that only backward passes of the same context wait on it.
+  struct ContextInitState {
+    std::mutex mutex;
+    std::atomic<bool> initialized{false};
+  };
+
+  // Returns the initialization state of the given context, creating it if
+  // this is the first backward pass of the context on this node.
+  std::shared_ptr<ContextInitState> getOrCreateContextInitState(
+      int64_t contextId);
+
+  // Autograd context_ids which we have started to initialize for distributed
+  // autograd on this node (e.g.: computing dependencies), see
+  // ContextInitState::initialized for whether they are done.
+  std::unordered_map<int64_t, std::shared_ptr<ContextInitState>>
+      initializedContextIds_;
+
+  // Only protects initializedContextIds_ itself, not the initialization of
+  // the contexts in it.
   mutable std::mutex initializedContextIdsLock_;
 
   // Reference to local autograd engine.
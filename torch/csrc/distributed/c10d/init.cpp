@@ -29,7 +29,10 @@
 #include <c10d/comm.hpp>
 #include <c10d/frontend.hpp>
 #include <c10d/logger.hpp>
+#include <c10d/pipeline.hpp>
 #include <c10d/reducer.hpp>
+#include <c10d/snapshot.hpp>
+#include <torch/csrc/Device.h>
 #include <torch/csrc/Exceptions.h>
 #include <torch/csrc/distributed/c10d/python_comm_hook.h>
 #include <torch/csrc/jit/python/pybind_utils.h>
@@ -148,8 +151,20 @@ void _register_comm_hook(
 // function of the reducer input to set the hook type.
 void _register_builtin_comm_hook(
     ::c10d::Reducer& reducer,
-    ::c10d::BuiltinCommHookType comm_hook_type) {
-  reducer.register_builtin_comm_hook(comm_hook_type);
+    ::c10d::BuiltinCommHookType comm_hook_type,
+    const ::c10d::BuiltinCommHookOptions& options) {
+  reducer.register_builtin_comm_hook(comm_hook_type, options);
+}
+
+// Called from DDP's Python API to step the parameters per bucket, see
+// Note [Fused bucket optimizer step].
+void _register_bucket_optimizer(
+    ::c10d::Reducer& reducer,
+    ::c10d::BucketOptimizerType optimizer_type,
+    const ::c10d::BucketOptimizerOptions& options,
+    bool shard_optimizer_state) {
+  reducer.register_bucket_optimizer(
+      optimizer_type, options, shard_optimizer_state);
 }
 
 PyObject* c10d_init(PyObject* _unused, PyObject* noargs) {
@@ -170,6 +185,52 @@ PyObject* c10d_init(PyObject* _unused, PyObject* noargs) {
 
   auto module = py::handle(m).cast<py::module>();
 
+  py::class_<::c10d::BuiltinCommHookOptions>(
+      module,
+      "BuiltinCommHookOptions",
+      R"(
+Hyperparameters of the ``POWER_SGD`` and ``TOPK_SPARSIFY`` built-in communication
+hooks. The PowerSGD ones have the same meaning and defaults as in
+:class:`~torch.distributed.algorithms.ddp_comm_hooks.powerSGD_hook.PowerSGDState`,
+``start_iter`` being ``start_powerSGD_iter``. ``topk_ratio`` is the fraction of the
+elements of a bucket that ``TOPK_SPARSIFY`` sends.
+)")
+      .def(py::init<>())
+      .def_readwrite("start_iter", &::c10d::BuiltinCommHookOptions::start_iter)
+      .def_readwrite(
+          "use_error_feedback",
+          &::c10d::BuiltinCommHookOptions::use_error_feedback)
+      .def_readwrite(
+          "matrix_approximation_rank",
+          &::c10d::BuiltinCommHookOptions::matrix_approximation_rank)
+      .def_readwrite(
+          "min_compression_rate",
+          &::c10d::BuiltinCommHookOptions::min_compression_rate)
+      .def_readwrite("warm_start", &::c10d::BuiltinCommHookOptions::warm_start)
+      .def_readwrite(
+          "orthogonalization_epsilon",
+          &::c10d::BuiltinCommHookOptions::orthogonalization_epsilon)
+      .def_readwrite(
+          "random_seed", &::c10d::BuiltinCommHookOptions::random_seed)
+      .def_readwrite("topk_ratio", &::c10d::BuiltinCommHookOptions::topk_ratio);
+
+  py::class_<::c10d::BucketOptimizerOptions>(
+      module,
+      "BucketOptimizerOptions",
+      R"(
+Hyperparameters of the bucket optimizers, with the same meaning and defaults as
+in :class:`torch.optim.SGD` (``momentum``) and :class:`torch.optim.Adam`
+(``beta1``, ``beta2`` and ``eps``).
+)")
+      .def(py::init<>())
+      .def_readwrite("lr", &::c10d::BucketOptimizerOptions::lr)
+      .def_readwrite(
+          "weight_decay", &::c10d::BucketOptimizerOptions::weight_decay)
+      .def_readwrite("momentum", &::c10d::BucketOptimizerOptions::momentum)
+      .def_readwrite("beta1", &::c10d::BucketOptimizerOptions::beta1)
+      .def_readwrite("beta2", &::c10d::BucketOptimizerOptions::beta2)
+      .def_readwrite("eps", &::c10d::BucketOptimizerOptions::eps);
+
   module
       .def(
           "_register_comm_hook",
@@ -182,7 +243,15 @@ PyObject* c10d_init(PyObject* _unused, PyObject* noargs) {
           "_register_builtin_comm_hook",
           &_register_builtin_comm_hook,
           py::arg("reducer"),
-          py::arg("comm_hook_type"));
+          py::arg("comm_hook_type"),
+          py::arg("options") = ::c10d::BuiltinCommHookOptions())
+      .def(
+          "_register_bucket_optimizer",
+          &_register_bucket_optimizer,
+          py::arg("reducer"),
+          py::arg("optimizer_type"),
+          py::arg("options") = ::c10d::BucketOptimizerOptions(),
+          py::arg("shard_optimizer_state") = false);
 
   shared_ptr_class_<::c10d::GradBucket>(
       module,
@@ -255,9 +324,17 @@ Replaces the tensor in the bucket with the input tensor.
 )");
 
   py::enum_<::c10d::BuiltinCommHookType>(module, "BuiltinCommHookType", R"(
-An enum-like class for built-in communication hooks: ``ALLREDUCE`` and ``FP16_COMPRESS``.)")
+An enum-like class for built-in communication hooks: ``ALLREDUCE``, ``FP16_COMPRESS``,
+``POWER_SGD`` and ``TOPK_SPARSIFY``.)")
       .value("ALLREDUCE", ::c10d::BuiltinCommHookType::ALLREDUCE)
-      .value("FP16_COMPRESS", ::c10d::BuiltinCommHookType::FP16_COMPRESS);
+      .value("FP16_COMPRESS", ::c10d::BuiltinCommHookType::FP16_COMPRESS)
+      .value("POWER_SGD", ::c10d::BuiltinCommHookType::POWER_SGD)
+      .value("TOPK_SPARSIFY", ::c10d::BuiltinCommHookType::TOPK_SPARSIFY);
+
+  py::enum_<::c10d::BucketOptimizerType>(module, "BucketOptimizerType", R"(
+An enum-like class for the optimizers DDP can run per bucket: ``SGD`` and ``ADAM``.)")
+      .value("SGD", ::c10d::BucketOptimizerType::SGD)
+      .value("ADAM", ::c10d::BucketOptimizerType::ADAM);
 
   shared_ptr_class_<::c10d::Reducer>(module, "Reducer")
       .def(
@@ -299,6 +376,11 @@ An enum-like class for built-in communication hooks: ``ALLREDUCE`` and ``FP16_CO
           "_rebuild_buckets",
           &::c10d::Reducer::rebuild_buckets,
           py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_enable_adaptive_bucketing",
+          &::c10d::Reducer::enable_adaptive_bucketing,
+          py::arg("num_iterations"),
+          py::call_guard<py::gil_scoped_release>())
       .def(
           "get_bucket_tensors",
           &::c10d::Reducer::get_bucket_tensors,
@@ -370,6 +452,91 @@ An enum-like class for built-in communication hooks: ``ALLREDUCE`` and ``FP16_CO
       &::c10d::parseDistDebugLevel,
       py::call_guard<py::gil_scoped_release>());
 
+  shared_ptr_class_<::c10d::PipelineExecutor>(
+      module,
+      "_PipelineExecutor",
+      R"(
+Runs the forward and backward passes of micro-batches through a model split
+across the ranks of ``forward_group``, rank ``i`` being stage ``i``, with the
+1F1B schedule for one chunk per stage and the interleaved one for more.
+Activations are sent through ``forward_group`` and their gradients through
+``backward_group``, and the sends and recvs overlap with the compute.
+
+Each chunk is called as ``chunk(input, micro_batch)``. The last chunk of the
+last stage returns the loss, every other chunk an activation with the shape,
+dtype and device of ``activation``.
+)")
+      .def(
+          py::init([](c10::intrusive_ptr<::c10d::ProcessGroup> forward_group,
+                      c10::intrusive_ptr<::c10d::ProcessGroup> backward_group,
+                      const std::vector<py::function>& chunks,
+                      int64_t num_micro_batches,
+                      const at::Tensor& activation) {
+            std::vector<::c10d::PipelineExecutor::StageFn> fns;
+            for (const auto& chunk : chunks) {
+              fns.emplace_back(
+                  [chunk](const at::Tensor& input, int64_t micro_batch) {
+                    py::gil_scoped_acquire gil;
+                    return chunk(input, micro_batch).cast<at::Tensor>();
+                  });
+            }
+            return std::make_shared<::c10d::PipelineExecutor>(
+                std::move(forward_group),
+                std::move(backward_group),
+                std::move(fns),
+                num_micro_batches,
+                activation.sizes().vec(),
+                activation.options());
+          }),
+          py::arg("forward_group"),
+          py::arg("backward_group"),
+          py::arg("chunks"),
+          py::arg("num_micro_batches"),
+          py::arg("activation"))
+      .def(
+          "run",
+          &::c10d::PipelineExecutor::run,
+          py::arg("inputs") = std::vector<at::Tensor>(),
+          py::call_guard<py::gil_scoped_release>());
+
+  shared_ptr_class_<::c10d::SnapshotService>(
+      module,
+      "_SnapshotService",
+      R"(
+Saves checkpoints of the state of rank ``rank`` while training goes on.
+``snapshot`` copies the tensors of ``state`` into host buffers kept by the
+service, without blocking the caller, and writes them in the background to
+``<directory>/rank_<rank>.pt``, which :func:`torch.load` reads back as a dict.
+The tensors can be updated in place as soon as ``snapshot`` returns.
+)")
+      .def(py::init<int64_t>(), py::arg("rank"))
+      .def(
+          "snapshot",
+          [](::c10d::SnapshotService& self,
+             const py::dict& state,
+             const std::string& directory) {
+            std::vector<std::string> names;
+            std::vector<at::Tensor> tensors;
+            for (const auto& item : state) {
+              names.push_back(item.first.cast<std::string>());
+              tensors.push_back(item.second.cast<at::Tensor>());
+            }
+            py::gil_scoped_release release;
+            self.snapshot(names, tensors, directory);
+          },
+          py::arg("state"),
+          py::arg("directory"))
+      .def(
+          "wait",
+          &::c10d::SnapshotService::wait,
+          py::call_guard<py::gil_scoped_release>())
+      .def("is_completed", &::c10d::SnapshotService::isCompleted)
+      .def_static(
+          "shard_path",
+          &::c10d::SnapshotService::shardPath,
+          py::arg("directory"),
+          py::arg("rank"));
+
   py::enum_<::c10d::ReduceOp>(module, "ReduceOp", R"(
 An enum-like class for available reduction operations: ``SUM``, ``PRODUCT``,
 ``MIN``, ``MAX``, ``BAND``, ``BOR``, and ``BXOR``.
@@ -546,6 +713,62 @@ Example::
     >>> store.set("first_key", "first_value")
     >>> # Should return "first_value"
     >>> store.get("first_key")
+)")
+          .def(
+              "multi_get",
+              [](::c10d::Store& store, const std::vector<std::string>& keys) {
+                std::vector<std::vector<uint8_t>> values;
+                {
+                  py::gil_scoped_release release;
+                  values = store.multiGet(keys);
+                }
+                py::list result;
+                for (const auto& value : values) {
+                  result.append(py::bytes(
+                      reinterpret_cast<const char*>(value.data()),
+                      value.size()));
+                }
+                return result;
+              },
+              R"(
+Retrieves the values associated with the given ``keys`` in the store, waiting
+for them like :meth:`~torch.distributed.store.get`. The
+:class:`~torch.distributed.TCPStore` does this in a single round trip.
+
+Arguments:
+    keys (list[str]): The keys to retrieve the values of.
+
+Returns:
+    A list with the value associated with each key.
+
+Example::
+    >>> import torch.distributed as dist
+    >>> from datetime import timedelta
+    >>> store = dist.TCPStore("127.0.0.1", 0, 1, True, timedelta(seconds=30))
+    >>> store.multi_set(["first_key", "second_key"], ["po", "tato"])
+    >>> # Should return [b"po", b"tato"]
+    >>> store.multi_get(["first_key", "second_key"])
+)")
+          .def(
+              "multi_set",
+              [](::c10d::Store& store,
+                 const std::vector<std::string>& keys,
+                 const std::vector<std::string>& values) {
+                std::vector<std::vector<uint8_t>> values_;
+                values_.reserve(values.size());
+                for (const auto& value : values) {
+                  values_.emplace_back(value.begin(), value.end());
+                }
+                store.multiSet(keys, values_);
+              },
+              py::call_guard<py::gil_scoped_release>(),
+              R"(
+Inserts the key-value pairs into the store like :meth:`~torch.distributed.store.set`.
+The :class:`~torch.distributed.TCPStore` sends them in a single message.
+
+Arguments:
+    keys (list[str]): The keys to be added to the store.
+    values (list[str]): The values associated with ``keys``.
 )")
           .def(
               "add",
@@ -879,6 +1102,13 @@ Arguments:
               py::arg("opts") = ::c10d::AllreduceCoalescedOptions(),
               py::call_guard<py::gil_scoped_release>())
 
+          .def(
+              "broadcast_coalesced",
+              &::c10d::ProcessGroup::broadcast_coalesced,
+              py::arg("tensors"),
+              py::arg("opts") = ::c10d::BroadcastOptions(),
+              py::call_guard<py::gil_scoped_release>())
+
           .def(
               "reduce",
               &::c10d::ProcessGroup::reduce,
@@ -1005,6 +1235,14 @@ Arguments:
               py::arg("input_tensor"),
               py::call_guard<py::gil_scoped_release>())
 
+          .def(
+              "reduce_scatter_coalesced",
+              &::c10d::ProcessGroup::reduce_scatter_coalesced,
+              py::arg("output_tensors"),
+              py::arg("input_lists"),
+              py::arg("opts") = ::c10d::ReduceScatterOptions(),
+              py::call_guard<py::gil_scoped_release>())
+
           .def(
               "alltoall_base",
               &::c10d::ProcessGroup::alltoall_base,
@@ -1015,6 +1253,14 @@ Arguments:
               py::arg("opts") = ::c10d::AllToAllOptions(),
               py::call_guard<py::gil_scoped_release>())
 
+          .def(
+              "alltoall_v",
+              &::c10d::ProcessGroup::alltoall_v,
+              py::arg("input_tensor"),
+              py::arg("input_split_sizes"),
+              py::arg("opts") = ::c10d::AllToAllOptions(),
+              py::call_guard<py::gil_scoped_release>())
+
           .def(
               "alltoall_base",
               [](::c10d::ProcessGroup& pg,
@@ -1133,6 +1379,10 @@ Arguments:
     timeout (timedelta, optional): Timeout for operations executed against
             the process group. Default value equals 30 minutes.
 
+Setting ``_shm_allreduce`` to ``True`` makes the ranks of a host allreduce
+dense CPU tensors through shared memory, with only one rank per host going
+over the network (Linux only).
+
 Example::
     >>> import torch.distributed as dist
     >>> import tempfile
@@ -1148,7 +1398,10 @@ Example::
           py::init<std::chrono::milliseconds>(),
           py::arg("timeout") = kProcessGroupDefaultTimeout)
       .def_readwrite("_devices", &::c10d::ProcessGroupGloo::Options::devices)
-      .def_readwrite("_threads", &::c10d::ProcessGroupGloo::Options::threads);
+      .def_readwrite("_threads", &::c10d::ProcessGroupGloo::Options::threads)
+      .def_readwrite(
+          "_shm_allreduce",
+          &::c10d::ProcessGroupGloo::Options::shm_allreduce);
 
   processGroupGloo
       .def_static(
@@ -1243,7 +1496,63 @@ Example::
               py::arg("timeout") = kProcessGroupDefaultTimeout,
               py::call_guard<py::gil_scoped_release>())
           .def_property_readonly(
-              "options", &::c10d::ProcessGroupNCCL::getOptions);
+              "options", &::c10d::ProcessGroupNCCL::getOptions)
+          .def(
+              "_perform_nocolor_split",
+              [](::c10d::ProcessGroupNCCL& self, py::object device) {
+                TORCH_CHECK_TYPE(
+                    THPDevice_Check(device.ptr()),
+                    "device must be a torch.device");
+                const auto dev =
+                    reinterpret_cast<THPDevice*>(device.ptr())->device;
+                py::gil_scoped_release release;
+                self.performNocolorSplit(dev);
+              },
+              py::arg("device"))
+          .def(
+              "_get_collective_traces",
+              &::c10d::ProcessGroupNCCL::getCollectiveTraces,
+              py::call_guard<py::gil_scoped_release>())
+          .def(
+              "_gather_collective_traces",
+              &::c10d::ProcessGroupNCCL::gatherCollectiveTraces,
+              py::call_guard<py::gil_scoped_release>());
+
+  py::class_<::c10d::ProcessGroupNCCL::CollectiveTrace>(
+      processGroupNCCL, "_CollectiveTrace")
+      .def_readonly("seq", &::c10d::ProcessGroupNCCL::CollectiveTrace::seq)
+      .def_property_readonly(
+          "op_type",
+          [](const ::c10d::ProcessGroupNCCL::CollectiveTrace& self) {
+            return ::c10d::opTypeToString(self.opType);
+          })
+      .def_readonly("numel", &::c10d::ProcessGroupNCCL::CollectiveTrace::numel)
+      .def_readonly("bytes", &::c10d::ProcessGroupNCCL::CollectiveTrace::bytes)
+      .def_readonly(
+          "enqueue_time_us",
+          &::c10d::ProcessGroupNCCL::CollectiveTrace::enqueueTimeUs)
+      .def_readonly(
+          "duration_us", &::c10d::ProcessGroupNCCL::CollectiveTrace::durationUs);
+
+  py::class_<::c10d::ProcessGroupNCCL::CollectiveSkew>(
+      processGroupNCCL, "_CollectiveSkew")
+      .def_readonly("seq", &::c10d::ProcessGroupNCCL::CollectiveSkew::seq)
+      .def_property_readonly(
+          "op_type",
+          [](const ::c10d::ProcessGroupNCCL::CollectiveSkew& self) {
+            return ::c10d::opTypeToString(self.opType);
+          })
+      .def_readonly("bytes", &::c10d::ProcessGroupNCCL::CollectiveSkew::bytes)
+      .def_readonly(
+          "enqueue_time_us",
+          &::c10d::ProcessGroupNCCL::CollectiveSkew::enqueueTimeUs)
+      .def_readonly(
+          "duration_us", &::c10d::ProcessGroupNCCL::CollectiveSkew::durationUs)
+      .def_readonly(
+          "arrival_skew_us",
+          &::c10d::ProcessGroupNCCL::CollectiveSkew::arrivalSkewUs)
+      .def_readonly(
+          "straggler", &::c10d::ProcessGroupNCCL::CollectiveSkew::straggler);
 
   intrusive_ptr_class_<::c10d::ProcessGroupNCCL::Options>(
       processGroupNCCL,
@@ -1266,6 +1575,34 @@ Arguments:
             group to pick up high priority cuda streams. It lets CUDA driver
             to prioritize NCCL kernels when there are compute kernels waiting.
 
+Attributes:
+    hierarchical_allreduce (bool): run allreduce as a reduce-scatter among the
+            ranks of each host, an allreduce of the resulting chunks across
+            hosts and an allgather among the ranks of each host, so that only
+            a fraction of the data crosses the links between hosts. Ranks are
+            grouped by hostname, the number of ranks must be the same on every
+            host, otherwise allreduce stays flat. Only applies to a single
+            tensor per process. Default ``False``.
+    hierarchical_alltoall (bool): run ``alltoall_v`` as an alltoall among
+            the ranks of each host followed by one among the ranks with the
+            same local rank on every host, so that each rank exchanges
+            messages with fewer, larger peers, which pays off with many ranks.
+            Same topology requirements as ``hierarchical_allreduce``.
+            Default ``False``.
+    eager_init_device (torch.device, optional): create the NCCL
+            communicator of this CUDA device when the process group is
+            constructed rather than on its first collective. Default ``None``.
+    split_from (ProcessGroupNCCL, optional): with ``eager_init_device``,
+            derive the communicator from the one of this process group with
+            ``ncclCommSplit`` (NCCL 2.18+) instead of creating a new one. Its
+            ranks outside of the new group must call
+            ``_perform_nocolor_split`` on it. Default ``None``.
+    collective_trace_size (int): keep the type, size, enqueue time and
+            duration of the last ``collective_trace_size`` collectives, which
+            ``_get_collective_traces`` returns and
+            ``_gather_collective_traces`` compares across ranks to find the
+            ones that join collectives late. Default ``0`` (disabled).
+
 Example::
     >>> import torch.distributed as dist
     >>> from datetime import timedelta
@@ -1280,7 +1617,38 @@ Example::
           py::arg("is_high_priority_stream") = false)
       .def_readwrite(
           "is_high_priority_stream",
-          &::c10d::ProcessGroupNCCL::Options::is_high_priority_stream);
+          &::c10d::ProcessGroupNCCL::Options::is_high_priority_stream)
+      .def_readwrite(
+          "hierarchical_allreduce",
+          &::c10d::ProcessGroupNCCL::Options::hierarchical_allreduce)
+      .def_readwrite(
+          "hierarchical_alltoall",
+          &::c10d::ProcessGroupNCCL::Options::hierarchical_alltoall)
+      .def_property(
+          "eager_init_device",
+          [](const ::c10d::ProcessGroupNCCL::Options& self) -> py::object {
+            if (!self.eager_init_device) {
+              return py::none();
+            }
+            return py::reinterpret_steal<py::object>(
+                THPDevice_New(*self.eager_init_device));
+          },
+          [](::c10d::ProcessGroupNCCL::Options& self, py::object device) {
+            if (device.is_none()) {
+              self.eager_init_device = c10::nullopt;
+              return;
+            }
+            TORCH_CHECK_TYPE(
+                THPDevice_Check(device.ptr()),
+                "eager_init_device must be a torch.device or None");
+            self.eager_init_device =
+                reinterpret_cast<THPDevice*>(device.ptr())->device;
+          })
+      .def_readwrite(
+          "split_from", &::c10d::ProcessGroupNCCL::Options::split_from)
+      .def_readwrite(
+          "collective_trace_size",
+          &::c10d::ProcessGroupNCCL::Options::collective_trace_size);
   processGroupNCCL.def_static(
       "_group_start", []() { ::c10d::ProcessGroupNCCL::groupStart(); });
   processGroupNCCL.def_static(
@@ -1470,6 +1838,17 @@ Example::
       py::arg("tensor_indices") = std::vector<int64_t>(),
       py::call_guard<py::gil_scoped_release>());
 
+  module.def(
+      "_compute_bucket_assignment_by_time",
+      &::c10d::compute_bucket_assignment_by_time,
+      py::arg("tensors"),
+      py::arg("ready_times"),
+      py::arg("alpha"),
+      py::arg("beta"),
+      py::arg("expect_sparse_gradient") = std::vector<bool>(),
+      py::arg("tensor_indices") = std::vector<int64_t>(),
+      py::call_guard<py::gil_scoped_release>());
+
   module.def(
       "_verify_model_across_ranks",
       &::c10d::verify_replica0_across_processes,
@@ -621,6 +621,12 @@ PyObject* rpc_init(PyObject* _unused, PyObject* noargs) {
           "device_maps",
           &TensorPipeRpcBackendOptions::deviceMaps,
           R"(The device map locations.)")
+      .def_readwrite(
+          "_batching_timeout_us",
+          &TensorPipeRpcBackendOptions::batchingTimeoutUs)
+      .def_readwrite(
+          "_batching_max_bytes",
+          &TensorPipeRpcBackendOptions::batchingMaxBytes)
       .def("set_device_map", &TensorPipeRpcBackendOptions::setDeviceMap);
 
   module.attr("_DEFAULT_NUM_WORKER_THREADS") =
@@ -84,6 +84,13 @@ enum MessageType {
   RREF_BACKWARD_REQ = 23 | MessageTypeFlags::REQUEST_TYPE,
   RREF_BACKWARD_RESP = 24 | MessageTypeFlags::RESPONSE_TYPE,
 
+  // Requests sent together by TensorPipeAgent, see Note [Request batching].
+  BATCHED_REQUEST = 25 | MessageTypeFlags::REQUEST_TYPE,
+
+  // RRef fork requests, child accepts and user deletes sent together, see
+  // Note [Batched RRef control messages].
+  RREF_CONTROL_BATCH = 26 | MessageTypeFlags::REQUEST_TYPE,
+
   // Other internal message types
   EXCEPTION = 55 | MessageTypeFlags::RESPONSE_TYPE,
   UNKNOWN = 60
@@ -342,6 +342,37 @@ void RequestCallbackNoPython::processRRefForkRequest(
   markComplete(RRefAck().toMessage());
 }
 
+void RequestCallbackNoPython::processRRefControlBatch(
+    RpcCommandBase& rpc,
+    const std::function<void(Message)>& markComplete) const {
+  auto& rcb = static_cast<RRefControlBatch&>(rpc);
+  auto& ctx = RRefContext::getInstance();
+  // Entries are applied in the order the sender queued them, each the same way
+  // as the message of its type.
+  for (const auto& entry : rcb.entries()) {
+    switch (entry.type) {
+      case MessageType::RREF_FORK_REQUEST: {
+        ctx.addForkOfOwnerIfNotPresent(entry.rrefId, entry.forkId);
+        break;
+      }
+      case MessageType::RREF_CHILD_ACCEPT: {
+        ctx.delPendingChild(entry.forkId);
+        break;
+      }
+      case MessageType::RREF_USER_DELETE: {
+        auto deletedRRef = ctx.delForkOfOwner(entry.rrefId, entry.forkId);
+        handleRRefDelete(deletedRRef);
+        break;
+      }
+      default: {
+        TORCH_INTERNAL_ASSERT(
+            false, "Unexpected RRef control message type ", entry.type);
+      }
+    }
+  }
+  markComplete(RRefAck().toMessage());
+}
+
 void RequestCallbackNoPython::processForwardAutogradReq(
     RpcCommandBase& rpc,
     const int64_t messageId,
@@ -622,6 +653,10 @@ void RequestCallbackNoPython::processRpc(
       processRRefForkRequest(rpc, markComplete);
       return;
     }
+    case MessageType::RREF_CONTROL_BATCH: {
+      processRRefControlBatch(rpc, markComplete);
+      return;
+    }
     case MessageType::FORWARD_AUTOGRAD_REQ: {
       processForwardAutogradReq(rpc, messageId, responseFuture);
       return;
@@ -88,6 +88,10 @@ class TORCH_API RequestCallbackNoPython : public RequestCallback {
       RpcCommandBase& rpc,
       const std::function<void(Message)>& markComplete) const;
 
+  void processRRefControlBatch(
+      RpcCommandBase& rpc,
+      const std::function<void(Message)>& markComplete) const;
+
   void processForwardAutogradReq(
       RpcCommandBase& rpc,
       const int64_t messageId,
@@ -213,16 +213,8 @@ void RRefContext::delUser(
       // Sending an RRefUserDelete causes the receiver to run delForkOfOwner,
       // which is now idempotent. See the comment at RRefContext::delForkOfOwner
       // for more details.
-      ++numPendingFutures_;
-      auto jitFuture = agent_->sendWithRetries(
-          agent_->getWorkerInfo(owner),
-          RRefUserDelete(rrefId, forkId).toMessage());
-
-      std::weak_ptr<JitFuture> wp = jitFuture;
-      jitFuture->addCallback([this, wp]() {
-        handleException(*wp.lock());
-        --numPendingFutures_;
-      });
+      sendControlMessage(
+          owner, {MessageType::RREF_USER_DELETE, rrefId, forkId, owner});
     }
   }
 
@@ -495,30 +487,16 @@ void RRefContext::notifyOwnerAndParentOfFork(
     // In this case, the owner is the caller, and it does not add the fork id
     // into forks_. Because, there will be no real `UserRRef` associated
     // with this fork ID.
-    ++numPendingFutures_;
-    auto jitFuture = agent_->sendWithRetries(
-        agent_->getWorkerInfo(parent), RRefChildAccept(forkId).toMessage());
-    std::weak_ptr<JitFuture> wp = jitFuture;
-    jitFuture->addCallback([this, wp]() {
-      handleException(*wp.lock());
-      --numPendingFutures_;
-    });
+    sendControlMessage(
+        parent,
+        {MessageType::RREF_CHILD_ACCEPT, rref->rrefId(), forkId, parent});
   } else {
-    ++numPendingFutures_;
-    auto jitFuture = agent_->sendWithRetries(
-        agent_->getWorkerInfo(rref->owner()),
-        RRefForkRequest(rref->rrefId(), forkId).toMessage());
-
+    // The user is added before the request is sent, as the ack could arrive
+    // (and finishForkRequest run) before sendControlMessage returns.
     addPendingUser(forkId, rref);
-
-    std::weak_ptr<JitFuture> wp = jitFuture;
-    jitFuture->addCallback([this, forkId, parent, wp]() {
-      handleException(*wp.lock());
-      this->finishForkRequest(forkId, parent);
-      // Decrease after calling finishForkRequest because, as that creates a new
-      // future, it might otherwise cause the count to briefly go to zero.
-      --numPendingFutures_;
-    });
+    sendControlMessage(
+        rref->owner(),
+        {MessageType::RREF_FORK_REQUEST, rref->rrefId(), forkId, parent});
   }
 }
 
@@ -688,16 +666,97 @@ void RRefContext::clearRecordedPendingRRefsOnError() {
   recording_ = false;
 }
 
-void RRefContext::finishForkRequest(const ForkId& forkId, worker_id_t parent) {
+void RRefContext::finishForkRequest(
+    const RRefId& rrefId,
+    const ForkId& forkId,
+    worker_id_t parent) {
   delPendingUser(forkId);
+  sendControlMessage(
+      parent, {MessageType::RREF_CHILD_ACCEPT, rrefId, forkId, parent});
+}
+
+// Note [Batched RRef control messages]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Every fork and delete of a UserRRef used to cost its own RREF_FORK_REQUEST,
+// RREF_CHILD_ACCEPT or RREF_USER_DELETE message, which with many short-lived
+// RRefs is more traffic than the RPCs using them. Instead, at most one of
+// these messages is in flight to a worker at any time. The ones sent while it
+// is in flight are queued, and are all sent as a single RREF_CONTROL_BATCH
+// once it is acked. An RRef that is used sparingly pays no extra latency, and
+// the busier the RRefs to a worker get the more messages each batch carries.
+//
+// Delaying any of these messages is safe, it only keeps an RRef alive for
+// longer: a parent holds its child until RREF_CHILD_ACCEPT, which is only sent
+// once the owner acked RREF_FORK_REQUEST, and the owner holds the OwnerRRef
+// until RREF_USER_DELETE. The receiver applies the entries of a batch in
+// order, with the same idempotent functions as the messages, so batches can be
+// retried like them. Each message still counts in numPendingFutures_ until the
+// message or batch it was sent in is acked.
+void RRefContext::sendControlMessage(
+    worker_id_t dst,
+    ControlMessage message) {
   ++numPendingFutures_;
-  auto jitFuture = agent_->sendWithRetries(
-      agent_->getWorkerInfo(parent), RRefChildAccept(forkId).toMessage());
+  {
+    std::lock_guard<std::mutex> lock(controlMessageMutex_);
+    auto& queue = controlMessageQueues_[dst];
+    if (queue.inFlight) {
+      queue.pending.emplace_back(std::move(message));
+      return;
+    }
+    queue.inFlight = true;
+  }
+  sendControlMessages(dst, {std::move(message)});
+}
+
+void RRefContext::sendControlMessages(
+    worker_id_t dst,
+    std::vector<ControlMessage> messages) {
+  Message request;
+  if (messages.size() == 1) {
+    const auto& message = messages.front();
+    switch (message.type) {
+      case MessageType::RREF_FORK_REQUEST:
+        request = RRefForkRequest(message.rrefId, message.forkId).toMessage();
+        break;
+      case MessageType::RREF_CHILD_ACCEPT:
+        request = RRefChildAccept(message.forkId).toMessage();
+        break;
+      default:
+        request = RRefUserDelete(message.rrefId, message.forkId).toMessage();
+    }
+  } else {
+    std::vector<RRefControlBatch::Entry> entries;
+    entries.reserve(messages.size());
+    for (const auto& message : messages) {
+      entries.push_back({message.type, message.rrefId, message.forkId});
+    }
+    request = RRefControlBatch(std::move(entries)).toMessage();
+  }
 
+  auto jitFuture =
+      agent_->sendWithRetries(agent_->getWorkerInfo(dst), std::move(request));
   std::weak_ptr<JitFuture> wp = jitFuture;
-  jitFuture->addCallback([this, wp]() {
+  jitFuture->addCallback([this, dst, messages = std::move(messages), wp]() {
+    std::vector<ControlMessage> next;
+    {
+      std::lock_guard<std::mutex> lock(controlMessageMutex_);
+      auto& queue = controlMessageQueues_[dst];
+      next.swap(queue.pending);
+      queue.inFlight = !next.empty();
+    }
+    if (!next.empty()) {
+      sendControlMessages(dst, std::move(next));
+    }
+
     handleException(*wp.lock());
-    --numPendingFutures_;
+    for (const auto& message : messages) {
+      if (message.type == MessageType::RREF_FORK_REQUEST) {
+        this->finishForkRequest(message.rrefId, message.forkId, message.parent);
+      }
+      // Decrease after calling finishForkRequest because, as that creates a
+      // new future, it might otherwise cause the count to briefly go to zero.
+      --numPendingFutures_;
+    }
   });
 }
 
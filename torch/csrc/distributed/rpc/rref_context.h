@@ -232,7 +232,34 @@ class TORCH_API RRefContext {
       const ForkId& forkId,
       const TypePtr& type);
 
-  void finishForkRequest(const ForkId& forkId, worker_id_t parent);
+  void finishForkRequest(
+      const RRefId& rrefId,
+      const ForkId& forkId,
+      worker_id_t parent);
+
+  // An RREF_FORK_REQUEST, RREF_CHILD_ACCEPT or RREF_USER_DELETE message for
+  // RRef control message batching, see Note [Batched RRef control messages].
+  struct ControlMessage {
+    MessageType type;
+    RRefId rrefId;
+    ForkId forkId;
+    // For RREF_FORK_REQUEST, the worker to send RREF_CHILD_ACCEPT to once the
+    // owner acks the request.
+    worker_id_t parent;
+  };
+
+  // Control messages to one worker that wait for the one in flight to it.
+  struct ControlMessageQueue {
+    bool inFlight = false;
+    std::vector<ControlMessage> pending;
+  };
+
+  // Sends the message right away if there is none in flight to dst, otherwise
+  // queues it to be sent with the others once the one in flight is acked.
+  void sendControlMessage(worker_id_t dst, ControlMessage message);
+  void sendControlMessages(
+      worker_id_t dst,
+      std::vector<ControlMessage> messages);
 
   // If there is any leak on any RRef, this method will throw an error.
   void checkRRefLeaks(bool ignoreRRefLeak);
@@ -299,6 +326,9 @@ class TORCH_API RRefContext {
   // these pending requests, so that users can wait for it to reach zero.
   std::atomic<int64_t> numPendingFutures_{0};
 
+  std::mutex controlMessageMutex_;
+  std::unordered_map<worker_id_t, ControlMessageQueue> controlMessageQueues_;
+
   std::mutex destroyedMutex_;
   bool destroyed_;
 
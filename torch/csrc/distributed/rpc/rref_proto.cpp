@@ -189,6 +189,41 @@ std::unique_ptr<RRefForkRequest> RRefForkRequest::fromMessage(
   return std::make_unique<RRefForkRequest>(pair.first, pair.second);
 }
 
+const std::vector<RRefControlBatch::Entry>& RRefControlBatch::entries()
+    const {
+  return entries_;
+}
+
+Message RRefControlBatch::toMessageImpl() && {
+  std::vector<at::IValue> ivalues;
+  ivalues.reserve(entries_.size() * 3);
+  for (const auto& entry : entries_) {
+    ivalues.emplace_back(static_cast<int64_t>(entry.type));
+    ivalues.emplace_back(entry.rrefId.toIValue());
+    ivalues.emplace_back(entry.forkId.toIValue());
+  }
+  return fromIValues(std::move(ivalues), MessageType::RREF_CONTROL_BATCH);
+}
+
+std::unique_ptr<RRefControlBatch> RRefControlBatch::fromMessage(
+    const Message& message) {
+  auto values = toIValues(message, MessageType::RREF_CONTROL_BATCH);
+  TORCH_INTERNAL_ASSERT(
+      values.size() % 3 == 0,
+      "Expect a multiple of 3 IValues from message, got ",
+      values.size());
+
+  std::vector<Entry> entries;
+  entries.reserve(values.size() / 3);
+  for (size_t i = 0; i < values.size(); i += 3) {
+    entries.push_back(
+        {static_cast<MessageType>(values[i].toInt()),
+         RRefId::fromIValue(values[i + 1]),
+         ForkId::fromIValue(values[i + 2])});
+  }
+  return std::make_unique<RRefControlBatch>(std::move(entries));
+}
+
 Message RRefAck::toMessageImpl() && {
   return Message({}, {}, MessageType::RREF_ACK);
 }
@@ -155,6 +155,29 @@ class TORCH_API RRefForkRequest final : public ForkMessageBase {
   static std::unique_ptr<RRefForkRequest> fromMessage(const Message& message);
 };
 
+// Fork requests, child accepts and user deletes for the same worker, sent as
+// one message. See Note [Batched RRef control messages].
+class TORCH_API RRefControlBatch final : public RpcCommandBase {
+ public:
+  struct Entry {
+    // One of RREF_FORK_REQUEST, RREF_CHILD_ACCEPT or RREF_USER_DELETE.
+    MessageType type;
+    RRefId rrefId;
+    ForkId forkId;
+  };
+
+  explicit RRefControlBatch(std::vector<Entry> entries)
+      : entries_(std::move(entries)) {}
+
+  const std::vector<Entry>& entries() const;
+
+  Message toMessageImpl() && override;
+  static std::unique_ptr<RRefControlBatch> fromMessage(const Message& message);
+
+ private:
+  const std::vector<Entry> entries_;
+};
+
 class TORCH_API RRefAck final : public RpcCommandBase {
  public:
   RRefAck() {}
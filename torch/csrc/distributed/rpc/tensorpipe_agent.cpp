@@ -2,6 +2,7 @@
 
 #ifdef USE_TENSORPIPE
 
+#include <cstring>
 #include <limits>
 #include <tuple>
 #include <utility>
@@ -78,6 +79,98 @@ std::vector<c10::DeviceIndex> getDevicesForTensors(
   return deviceIndices;
 }
 
+// Note [Request batching]
+// ~~~~~~~~~~~~~~~~~~~~~~~
+// Each request is normally written to its pipe on its own, which costs a
+// TensorPipe write on the client and a read on the server even for requests
+// of a few bytes. When batchingTimeoutUs is set, requests to a worker that
+// are smaller than batchingMaxBytes and only hold CPU tensors are queued on
+// their ClientPipe instead, and the queue is sent as a single BATCHED_REQUEST
+// message once it holds batchingMaxBytes or batchingTimeoutUs after its first
+// request, whichever comes first. Any other request to the worker sends the
+// queue before itself, so that the requests of a thread stay in order, and
+// shutdown sends the queues that are left.
+//
+// The payload of a batch starts with the number of requests and a
+// BatchedRequestHeader per request, followed by the payloads of the requests,
+// and its tensors are those of all the requests, in order. The server splits
+// it and handles each request as if it had been read on its own, so requests
+// keep their ids and get their own responses, and the client arms one read
+// per request of the batch. Timeouts and errors are per request as usual.
+struct BatchedRequestHeader {
+  int64_t type;
+  int64_t id;
+  int64_t payloadSize;
+  int64_t numTensors;
+};
+
+Message batchRequests(std::vector<Message>&& requests) {
+  const int64_t numRequests = requests.size();
+  std::vector<char> payload(
+      sizeof(int64_t) + numRequests * sizeof(BatchedRequestHeader));
+  std::memcpy(payload.data(), &numRequests, sizeof(int64_t));
+  std::vector<torch::Tensor> tensors;
+  for (size_t i = 0; i < requests.size(); ++i) {
+    auto& request = requests[i];
+    const BatchedRequestHeader header{
+        request.type(),
+        request.id(),
+        static_cast<int64_t>(request.payload().size()),
+        static_cast<int64_t>(request.tensors().size())};
+    std::memcpy(
+        payload.data() + sizeof(int64_t) + i * sizeof(BatchedRequestHeader),
+        &header,
+        sizeof(header));
+    payload.insert(
+        payload.end(), request.payload().begin(), request.payload().end());
+    for (auto& tensor : request.tensors()) {
+      tensors.push_back(std::move(tensor));
+    }
+  }
+  return Message(
+      std::move(payload), std::move(tensors), MessageType::BATCHED_REQUEST);
+}
+
+std::vector<Message> unbatchRequests(Message&& batch) {
+  const auto& payload = batch.payload();
+  auto& tensors = batch.tensors();
+  int64_t numRequests = 0;
+  TORCH_INTERNAL_ASSERT(payload.size() >= sizeof(int64_t));
+  std::memcpy(&numRequests, payload.data(), sizeof(int64_t));
+  size_t payloadOffset =
+      sizeof(int64_t) + numRequests * sizeof(BatchedRequestHeader);
+  TORCH_INTERNAL_ASSERT(payload.size() >= payloadOffset);
+  size_t tensorOffset = 0;
+
+  std::vector<Message> requests;
+  requests.reserve(numRequests);
+  for (int64_t i = 0; i < numRequests; ++i) {
+    BatchedRequestHeader header;
+    std::memcpy(
+        &header,
+        payload.data() + sizeof(int64_t) + i * sizeof(BatchedRequestHeader),
+        sizeof(header));
+    TORCH_INTERNAL_ASSERT(
+        payloadOffset + header.payloadSize <= payload.size() &&
+        tensorOffset + header.numTensors <= tensors.size());
+    std::vector<char> requestPayload(
+        payload.begin() + payloadOffset,
+        payload.begin() + payloadOffset + header.payloadSize);
+    std::vector<torch::Tensor> requestTensors(
+        std::make_move_iterator(tensors.begin() + tensorOffset),
+        std::make_move_iterator(
+            tensors.begin() + tensorOffset + header.numTensors));
+    payloadOffset += header.payloadSize;
+    tensorOffset += header.numTensors;
+    requests.emplace_back(
+        std::move(requestPayload),
+        std::move(requestTensors),
+        static_cast<MessageType>(header.type),
+        header.id);
+  }
+  return requests;
+}
+
 } // namespace
 
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
@@ -555,6 +648,10 @@ void TensorPipeAgent::startImpl() {
   // Start the Timeout Thread
   timeoutThread_ = std::thread(&TensorPipeAgent::pollTimeoutRpcs, this);
 
+  if (opts_.batchingTimeoutUs > 0) {
+    batchingThread_ = std::thread(&TensorPipeAgent::pollBatches, this);
+  }
+
   listener_->accept([this](
                         const tensorpipe::Error& error,
                         std::shared_ptr<tensorpipe::Pipe> pipe) {
@@ -777,59 +874,71 @@ void TensorPipeAgent::respond(std::shared_ptr<tensorpipe::Pipe>& pipe) {
         // Arm for next read
         respond(pipe);
 
-        uint64_t messageId = requestMessage.id();
-        increaseCallCount(serverActiveCalls_);
-
-        VLOG(1) << "RPC agent for " << workerInfo_.name_
-                << " received request #" << messageId << " from "
-                << pipe->getRemoteName();
-
-        // Defer user RPC UDF run to thread pool
-        threadPool_.run([this,
-                         pipe,
-                         messageId,
-                         requestMessage{std::move(requestMessage)},
-                         ctx{std::move(ctx)}]() mutable {
-          // create guards again as this function runs on a different thread
-          MultiStreamGuard guard(ctx);
-          VLOG(1) << "RPC agent for " << workerInfo_.name_
-                  << " is running request #" << messageId << " from "
-                  << pipe->getRemoteName() << " in thread pool";
-
-          std::shared_ptr<JitFuture> futureResponseMessage;
-          try {
-            futureResponseMessage = cb_->operator()(requestMessage);
-          } catch (const std::exception& /* unused */) {
-            futureResponseMessage =
-                std::make_shared<JitFuture>(at::AnyClassType::get());
-            futureResponseMessage->setError(std::current_exception());
+        if (requestMessage.type() == MessageType::BATCHED_REQUEST) {
+          for (auto& request : unbatchRequests(std::move(requestMessage))) {
+            handleRequest(pipe, std::move(request), ctx);
           }
+        } else {
+          handleRequest(pipe, std::move(requestMessage), std::move(ctx));
+        }
+      });
+}
 
-          // Shortcut if immediately done
-          if (futureResponseMessage->completed()) {
-            decreaseCallCount(serverActiveCalls_);
-            sendCompletedResponseMessage(
-                pipe, futureResponseMessage, messageId, std::move(ctx));
-          } else {
-            // Not complete yet
-            increaseCallCount(serverActiveAsyncCalls_);
-            futureResponseMessage->addCallback([this,
-                                                pipe,
-                                                futureResponseMessage,
-                                                messageId,
-                                                ctx{std::move(ctx)}]() mutable {
-              decreaseCallCount(serverActiveCalls_);
-              decreaseCallCount(serverActiveAsyncCalls_);
-              sendCompletedResponseMessage(
-                  pipe, futureResponseMessage, messageId, std::move(ctx));
-            });
-          }
+void TensorPipeAgent::handleRequest(
+    std::shared_ptr<tensorpipe::Pipe>& pipe,
+    Message&& requestMessage,
+    std::shared_ptr<LazyStreamContext> ctx) {
+  uint64_t messageId = requestMessage.id();
+  increaseCallCount(serverActiveCalls_);
+
+  VLOG(1) << "RPC agent for " << workerInfo_.name_ << " received request #"
+          << messageId << " from " << pipe->getRemoteName();
+
+  // Defer user RPC UDF run to thread pool
+  threadPool_.run([this,
+                   pipe,
+                   messageId,
+                   requestMessage{std::move(requestMessage)},
+                   ctx{std::move(ctx)}]() mutable {
+    // create guards again as this function runs on a different thread
+    MultiStreamGuard guard(ctx);
+    VLOG(1) << "RPC agent for " << workerInfo_.name_
+            << " is running request #" << messageId << " from "
+            << pipe->getRemoteName() << " in thread pool";
 
-          VLOG(1) << "RPC agent for " << workerInfo_.name_
-                  << " done running request #" << messageId << " from "
-                  << pipe->getRemoteName() << " in thread pool";
-        });
+    std::shared_ptr<JitFuture> futureResponseMessage;
+    try {
+      futureResponseMessage = cb_->operator()(requestMessage);
+    } catch (const std::exception& /* unused */) {
+      futureResponseMessage =
+          std::make_shared<JitFuture>(at::AnyClassType::get());
+      futureResponseMessage->setError(std::current_exception());
+    }
+
+    // Shortcut if immediately done
+    if (futureResponseMessage->completed()) {
+      decreaseCallCount(serverActiveCalls_);
+      sendCompletedResponseMessage(
+          pipe, futureResponseMessage, messageId, std::move(ctx));
+    } else {
+      // Not complete yet
+      increaseCallCount(serverActiveAsyncCalls_);
+      futureResponseMessage->addCallback([this,
+                                          pipe,
+                                          futureResponseMessage,
+                                          messageId,
+                                          ctx{std::move(ctx)}]() mutable {
+        decreaseCallCount(serverActiveCalls_);
+        decreaseCallCount(serverActiveAsyncCalls_);
+        sendCompletedResponseMessage(
+            pipe, futureResponseMessage, messageId, std::move(ctx));
       });
+    }
+
+    VLOG(1) << "RPC agent for " << workerInfo_.name_
+            << " done running request #" << messageId << " from "
+            << pipe->getRemoteName() << " in thread pool";
+  });
 }
 
 std::shared_ptr<JitFuture> TensorPipeAgent::send(
@@ -930,6 +1039,48 @@ std::shared_ptr<JitFuture> TensorPipeAgent::send(
   VLOG(1) << "RPC agent for " << workerInfo_.name_ << " is sending request #"
           << messageId << " to " << clientPipe.pipe_->getRemoteName();
 
+  // See Note [Request batching]
+  if (opts_.batchingTimeoutUs > 0 && devices.empty()) {
+    int64_t messageBytes = requestMessage.payload().size();
+    for (const auto& tensor : requestMessage.tensors()) {
+      messageBytes += tensor.has_storage()
+          ? tensor.storage().nbytes()
+          : tensor.numel() * tensor.element_size();
+    }
+    if (messageBytes < opts_.batchingMaxBytes) {
+      bool full = false;
+      bool first = false;
+      {
+        std::lock_guard<std::mutex> lock(clientPipe.mutex_);
+        first = clientPipe.pendingBatch_.empty();
+        if (first) {
+          clientPipe.batchDeadline_ = std::chrono::steady_clock::now() +
+              std::chrono::microseconds(opts_.batchingTimeoutUs);
+        }
+        clientPipe.pendingBatch_.push_back(std::move(requestMessage));
+        clientPipe.pendingBatchBytes_ += messageBytes;
+        full = clientPipe.pendingBatchBytes_ >= opts_.batchingMaxBytes;
+      }
+      // A request queued after shutdown flushed the batches is sent now.
+      if (full || !rpcAgentRunning_.load()) {
+        std::lock_guard<std::mutex> writeLock(clientPipe.writeMutex_);
+        flushBatch(clientPipe);
+      } else if (first) {
+        {
+          std::lock_guard<std::mutex> lock(batchingMutex_);
+          batchDeadlines_.emplace_back(clientPipe.batchDeadline_, &clientPipe);
+        }
+        batchingCV_.notify_one();
+      }
+      return futureResponseMessage->jitFuture;
+    }
+  }
+  // Requests queued before this one are sent first. Holding the write lock
+  // until this one is written keeps a batch taken out by another thread from
+  // being written after it.
+  std::lock_guard<std::mutex> writeLock(clientPipe.writeMutex_);
+  flushBatch(clientPipe);
+
   auto ctx = createLazyStreamContext();
   ctx->waitForCurrentStreams(requestMessage.tensors());
   pipeWrite(
@@ -956,73 +1107,155 @@ std::shared_ptr<JitFuture> TensorPipeAgent::send(
         VLOG(1) << "RPC agent for " << workerInfo_.name_ << " sent request #"
                 << messageId << " to " << clientPipe.pipe_->getRemoteName();
 
-        pipeRead(
-            clientPipe.pipe_,
-            [this, &clientPipe](
-                const tensorpipe::Error& error,
-                Message&& responseMessage,
-                std::shared_ptr<LazyStreamContext> ctx) {
-              if (error) {
-                if (error.isOfType<tensorpipe::PipeClosedError>() &&
-                    !rpcAgentRunning_.load()) {
-                  // This is expected.
-                } else {
-                  LOG(WARNING)
-                      << "RPC agent for " << workerInfo_.name_
-                      << " encountered error when reading incoming response from "
-                      << clientPipe.pipe_->getRemoteName() << ": "
-                      << error.what();
-                }
-                handleClientError(clientPipe, error);
-                return;
-              }
-
-              // Identify future response message by message ID
-              uint64_t messageId = responseMessage.id();
-
-              VLOG(1) << "RPC agent for " << workerInfo_.name_
-                      << " received response #" << messageId << " from "
-                      << clientPipe.pipe_->getRemoteName();
-
-              std::shared_ptr<AtomicJitFuture> futureResponseMessage;
-              {
-                std::lock_guard<std::mutex> lock(clientPipe.mutex_);
-                // A read error will lead all following callbacks to be
-                // invoked with error, and shouldn't reach here.
-                TORCH_INTERNAL_ASSERT(
-                    !clientPipe.inError_, "Shouldn't be in error state");
-                auto it = clientPipe.pendingResponseMessage_.find(messageId);
-                TORCH_INTERNAL_ASSERT(
-                    it != clientPipe.pendingResponseMessage_.end(),
-                    "message ID ",
-                    messageId,
-                    " is not recognized");
-                futureResponseMessage = std::move(it->second);
-                clientPipe.pendingResponseMessage_.erase(it);
-              }
-
-              // Remove entry from timeoutMap_.
-              removeFromTimeoutMap(messageId);
-
-              if (responseMessage.type() == MessageType::EXCEPTION) {
-                markFutureWithError(
-                    std::move(futureResponseMessage),
-                    std::string(
-                        responseMessage.payload().begin(),
-                        responseMessage.payload().end()));
-              } else {
-                markFutureAsComplete(
-                    std::move(futureResponseMessage),
-                    std::move(responseMessage),
-                    std::move(ctx));
-              }
-            });
+        readResponse(clientPipe);
       },
       deviceMap);
 
   return futureResponseMessage->jitFuture;
 }
 
+void TensorPipeAgent::readResponse(ClientPipe& clientPipe) {
+  pipeRead(
+      clientPipe.pipe_,
+      [this, &clientPipe](
+          const tensorpipe::Error& error,
+          Message&& responseMessage,
+          std::shared_ptr<LazyStreamContext> ctx) {
+        if (error) {
+          if (error.isOfType<tensorpipe::PipeClosedError>() &&
+              !rpcAgentRunning_.load()) {
+            // This is expected.
+          } else {
+            LOG(WARNING)
+                << "RPC agent for " << workerInfo_.name_
+                << " encountered error when reading incoming response from "
+                << clientPipe.pipe_->getRemoteName() << ": "
+                << error.what();
+          }
+          handleClientError(clientPipe, error);
+          return;
+        }
+
+        // Identify future response message by message ID
+        uint64_t messageId = responseMessage.id();
+
+        VLOG(1) << "RPC agent for " << workerInfo_.name_
+                << " received response #" << messageId << " from "
+                << clientPipe.pipe_->getRemoteName();
+
+        std::shared_ptr<AtomicJitFuture> futureResponseMessage;
+        {
+          std::lock_guard<std::mutex> lock(clientPipe.mutex_);
+          // A read error will lead all following callbacks to be
+          // invoked with error, and shouldn't reach here.
+          TORCH_INTERNAL_ASSERT(
+              !clientPipe.inError_, "Shouldn't be in error state");
+          auto it = clientPipe.pendingResponseMessage_.find(messageId);
+          TORCH_INTERNAL_ASSERT(
+              it != clientPipe.pendingResponseMessage_.end(),
+              "message ID ",
+              messageId,
+              " is not recognized");
+          futureResponseMessage = std::move(it->second);
+          clientPipe.pendingResponseMessage_.erase(it);
+        }
+
+        // Remove entry from timeoutMap_.
+        removeFromTimeoutMap(messageId);
+
+        if (responseMessage.type() == MessageType::EXCEPTION) {
+          markFutureWithError(
+              std::move(futureResponseMessage),
+              std::string(
+                  responseMessage.payload().begin(),
+                  responseMessage.payload().end()));
+        } else {
+          markFutureAsComplete(
+              std::move(futureResponseMessage),
+              std::move(responseMessage),
+              std::move(ctx));
+        }
+      });
+}
+
+void TensorPipeAgent::flushBatch(ClientPipe& clientPipe) {
+  std::vector<Message> requests;
+  {
+    std::lock_guard<std::mutex> lock(clientPipe.mutex_);
+    if (clientPipe.pendingBatch_.empty()) {
+      return;
+    }
+    std::swap(requests, clientPipe.pendingBatch_);
+    clientPipe.pendingBatchBytes_ = 0;
+  }
+  const size_t numRequests = requests.size();
+
+  VLOG(1) << "RPC agent for " << workerInfo_.name_ << " is sending a batch of "
+          << numRequests << " requests to "
+          << clientPipe.pipe_->getRemoteName();
+
+  pipeWrite(
+      clientPipe.pipe_,
+      batchRequests(std::move(requests)),
+      /* devices */ {},
+      createLazyStreamContext(),
+      [this, &clientPipe, numRequests](const tensorpipe::Error& error) {
+        if (error) {
+          if (error.isOfType<tensorpipe::PipeClosedError>() &&
+              !rpcAgentRunning_.load()) {
+            // This is expected.
+          } else {
+            LOG(WARNING) << "RPC agent for " << workerInfo_.name_
+                         << " encountered error when sending a batch of "
+                         << numRequests << " requests to "
+                         << clientPipe.pipe_->getRemoteName() << ": "
+                         << error.what();
+          }
+          handleClientError(clientPipe, error);
+          return;
+        }
+
+        // Each request of the batch gets its own response.
+        for (size_t i = 0; i < numRequests; ++i) {
+          readResponse(clientPipe);
+        }
+      });
+}
+
+void TensorPipeAgent::pollBatches() {
+  std::unique_lock<std::mutex> lock(batchingMutex_);
+  while (rpcAgentRunning_.load()) {
+    if (batchDeadlines_.empty()) {
+      batchingCV_.wait(lock);
+      continue;
+    }
+    // All batches wait for the same time, so the deadlines are in order.
+    const auto deadline = batchDeadlines_.front().first;
+    if (std::chrono::steady_clock::now() < deadline) {
+      batchingCV_.wait_until(lock, deadline);
+      continue;
+    }
+    ClientPipe* clientPipe = batchDeadlines_.front().second;
+    batchDeadlines_.pop_front();
+    lock.unlock();
+    {
+      // The batch this deadline was for may have been sent already because
+      // it filled up, and a later one started since.
+      std::unique_lock<std::mutex> pipeLock(clientPipe->mutex_);
+      if (clientPipe->batchDeadline_ > deadline) {
+        pipeLock.unlock();
+        lock.lock();
+        continue;
+      }
+    }
+    {
+      std::lock_guard<std::mutex> writeLock(clientPipe->writeMutex_);
+      flushBatch(*clientPipe);
+    }
+    lock.lock();
+  }
+}
+
 void TensorPipeAgent::handleClientError(
     ClientPipe& clientPipe,
     const tensorpipe::Error& error) {
@@ -1168,6 +1401,28 @@ void TensorPipeAgent::shutdownImpl() {
   VLOG(1) << "RPC agent for " << workerInfo_.name_
           << " done waiting for timeout thread to join";
 
+  // Join the Batching Thread
+  {
+    // Taking the lock makes sure the thread is either waiting or about to see
+    // that the agent stopped running.
+    std::lock_guard<std::mutex> lock(batchingMutex_);
+  }
+  batchingCV_.notify_one();
+  if (batchingThread_.joinable()) {
+    batchingThread_.join();
+  }
+  // Send the batches whose deadline hadn't passed yet, so that their requests
+  // either complete or fail with the pipes when the context is joined below.
+  {
+    std::lock_guard<std::mutex> lock(connectedPipesMutex_);
+    for (auto& p : connectedPipes_) {
+      std::lock_guard<std::mutex> writeLock(p.second.writeMutex_);
+      flushBatch(p.second);
+    }
+  }
+  VLOG(1) << "RPC agent for " << workerInfo_.name_
+          << " done flushing pending batches";
+
   // This will close all the pipes and listeners, invoke all callbacks with
   // errors, turn down the I/O event loops and wait for everything to terminate.
   context_->join();
@@ -3,6 +3,7 @@
 #ifdef USE_TENSORPIPE
 
 #include <atomic>
+#include <deque>
 #include <thread>
 
 #include <c10/core/thread_pool.h>
@@ -82,6 +83,7 @@ struct CudaChannelRegistration {
 C10_DECLARE_REGISTRY(TensorPipeCudaChannelRegistry, CudaChannelRegistration);
 
 constexpr auto kDefaultNumWorkerThreads = 16;
+constexpr int64_t kDefaultBatchingMaxBytes = 64 * 1024;
 
 struct TensorPipeRpcBackendOptions : public RpcBackendOptions {
   TensorPipeRpcBackendOptions(
@@ -138,6 +140,11 @@ struct TensorPipeRpcBackendOptions : public RpcBackendOptions {
   const optional<std::vector<std::string>> transports;
   const optional<std::vector<std::string>> channels;
   std::unordered_map<std::string, tensorpipe::DeviceMap> deviceMaps;
+  // Small requests to a worker are held for up to batchingTimeoutUs
+  // microseconds, or until batchingMaxBytes of them are pending, and sent
+  // together. Disabled when 0, see Note [Request batching].
+  int64_t batchingTimeoutUs{0};
+  int64_t batchingMaxBytes{kDefaultBatchingMaxBytes};
 };
 
 // Struct to track the network source metrics
@@ -255,6 +262,12 @@ class TensorPipeAgent : public RpcAgent {
   // Respond to a call from a peer
   void respond(std::shared_ptr<tensorpipe::Pipe>& pipe);
 
+  // Runs a request read from a peer and sends back its response
+  void handleRequest(
+      std::shared_ptr<tensorpipe::Pipe>& pipe,
+      Message&& requestMessage,
+      std::shared_ptr<LazyStreamContext> ctx);
+
   void sendCompletedResponseMessage(
       std::shared_ptr<tensorpipe::Pipe>& pipe,
       std::shared_ptr<JitFuture>& futureResponseMessage,
@@ -334,8 +347,37 @@ class TensorPipeAgent : public RpcAgent {
     // Map from Message Request ID's to corresponding futures.
     std::unordered_map<uint64_t, std::shared_ptr<AtomicJitFuture>>
         pendingResponseMessage_;
+    // Requests waiting to be sent in a batch, their size, and when they must
+    // be sent at the latest. See Note [Request batching].
+    std::vector<Message> pendingBatch_;
+    int64_t pendingBatchBytes_{0};
+    steady_clock_time_point batchDeadline_;
+    // Held while taking requests out of pendingBatch_ and writing them, and
+    // while writing a request that isn't batched, so that writes to the pipe
+    // happen in the order the requests were queued. Never taken by the write
+    // and read callbacks, which may lock mutex_.
+    std::mutex writeMutex_;
   };
 
+  // Arms a read for the response to a request sent on the client pipe
+  void readResponse(ClientPipe& clientPipe);
+
+  // Sends the requests batched for the client pipe, if any. The caller must
+  // hold the pipe's writeMutex_.
+  void flushBatch(ClientPipe& clientPipe);
+
+  // Thread that sends the batches whose deadline has passed
+  std::thread batchingThread_;
+
+  // Function run by the batchingThread_
+  void pollBatches();
+
+  // Client pipes with a pending batch, in order of deadline, and the mutex
+  // and cv guarding them.
+  std::deque<std::pair<steady_clock_time_point, ClientPipe*>> batchDeadlines_;
+  std::mutex batchingMutex_;
+  std::condition_variable batchingCV_;
+
   const TensorPipeRpcBackendOptions opts_;
   std::unordered_map<std::string, tensorpipe::DeviceMap> reverseDeviceMaps_;
 
@@ -3,6 +3,7 @@
 #ifdef USE_TENSORPIPE
 
 #ifdef USE_CUDA_NOT_ROCM
+#include <ATen/cuda/CUDAMultiStreamGuard.h>
 #include <c10/core/DeviceGuard.h>
 #include <c10/cuda/CUDACachingAllocator.h>
 #endif
@@ -66,8 +67,19 @@ std::tuple<tensorpipe::Message, TensorpipeWriteBuffers> tensorpipeSerialize(
       tensorpipe::Message::Payload{payloadPtr, buffers.payload.size()});
 
   // Tensors
-  buffers.tensors = cloneSparseTensors(rpcMessage.tensors()).vec();
+  {
+#ifdef USE_CUDA_NOT_ROCM
+    // Clone CUDA tensors on the streams TensorPipe sends them from, which have
+    // already been made to wait for the current streams, so that the sends are
+    // ordered after the copies without syncing with the host.
+    at::cuda::CUDAMultiStreamGuard guard(ctx->getReservedStreams());
+#endif
+    buffers.tensors = cloneSparseTensors(rpcMessage.tensors()).vec();
+  }
 
+  // Sized like the previous message's, as in jit::pickle.
+  thread_local size_t pickleSizeHint = 0;
+  buffers.pickle.reserve(pickleSizeHint);
   torch::jit::Pickler pickler([&](const void* buf, size_t sz) -> size_t {
     buffers.pickle.insert(
         buffers.pickle.end(),
@@ -78,6 +90,7 @@ std::tuple<tensorpipe::Message, TensorpipeWriteBuffers> tensorpipeSerialize(
   pickler.protocol();
   pickler.pushIValue(buffers.tensors);
   pickler.stop();
+  pickleSizeHint = buffers.pickle.size();
   // kTpMessagePickleIdx = 3
   tpMessage.payloads.push_back(tensorpipe::Message::Payload{
       buffers.pickle.data(), buffers.pickle.size()});
@@ -93,7 +106,8 @@ std::tuple<tensorpipe::Message, TensorpipeWriteBuffers> tensorpipeSerialize(
         ? ""
         : std::to_string(deviceIndices[i]);
 
-    if (!tensorData.storageHasDeleter()) {
+    if (!tensorData.storageHasDeleter() &&
+        tensorDataVec[i].device().is_cpu()) {
       std::vector<char> storageData(
           tensorData.data(), tensorData.data() + tensorData.sizeInBytes());
       tensorpipe::CpuBuffer buffer;
@@ -124,6 +138,25 @@ std::tuple<tensorpipe::Message, TensorpipeWriteBuffers> tensorpipeSerialize(
 #ifdef USE_CUDA_NOT_ROCM
       } else if (tensorDataVec[i].device().is_cuda()) {
         auto stream = ctx->getStream(tensorDataVec[i].device().index());
+        auto storage = tensorDataVec[i].storage();
+        if (!tensorData.storageHasDeleter()) {
+          // Copy memory the tensor doesn't own on the device rather than
+          // through the host, on the stream it is sent from.
+          at::cuda::CUDAStreamGuard guard(stream);
+          auto copy = at::empty({0}, tensorDataVec[i].options())
+                          .set_(
+                              storage,
+                              /* storage_offset = */ 0,
+                              /* size = */
+                              {static_cast<int64_t>(
+                                  tensorData.sizeInBytes() /
+                                  tensorDataVec[i].element_size())},
+                              /* stride = */ {1})
+                          .clone();
+          storage = copy.storage();
+          tensorPtr = static_cast<char*>(copy.data_ptr());
+          buffers.tensors.push_back(std::move(copy));
+        }
         tensorpipe::CudaBuffer buffer;
         buffer.ptr = tensorPtr;
         buffer.stream = stream.stream();
@@ -137,7 +170,7 @@ std::tuple<tensorpipe::Message, TensorpipeWriteBuffers> tensorpipeSerialize(
         // record tensor data ptrs on TensorPipe streams, so that the tensors
         // won't be destructed before TensorPipe finishing sending them.
         c10::cuda::CUDACachingAllocator::recordStream(
-            tensorDataVec[i].storage().data_ptr(), stream);
+            storage.data_ptr(), stream);
 #endif
       } else {
         TORCH_CHECK(
@@ -123,6 +123,9 @@ std::unique_ptr<RpcCommandBase> deserializeRequest(const Message& request) {
     case MessageType::RREF_FORK_REQUEST: {
       return RRefForkRequest::fromMessage(request);
     }
+    case MessageType::RREF_CONTROL_BATCH: {
+      return RRefControlBatch::fromMessage(request);
+    }
     case MessageType::FORWARD_AUTOGRAD_REQ: {
       return autograd::RpcWithAutograd::fromMessage(request);
     }
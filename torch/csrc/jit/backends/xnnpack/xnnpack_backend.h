@@ -0,0 +1,58 @@
+#pragma once
+
+namespace torch {
+namespace jit {
+namespace xnnpack {
+
+// Note [XNNPACK backend]
+// ~~~~~~~~~~~~~~~~~~~~~~
+// The prepacked XNNPACK ops (see passes/xnnpack_rewrite.h) run one XNNPACK
+// operator per ATen op: every op goes through the dispatcher, and every
+// convolution converts its input to NHWC and its output back to NCHW. The
+// "xnnpack" backend instead lowers a whole method into a single XNNPACK
+// subgraph, which is turned into one runtime object when the lowered module
+// is loaded and run with a single call. Values stay NHWC inside the subgraph,
+// so layouts are only converted at the inputs and outputs of the method.
+//
+// Methods are lowered with
+//
+//   torch::jit::detail::codegen_backend_module("xnnpack", module, spec, ty)
+//
+// where module is in eval mode and spec maps the name of each lowered method
+// to a dict holding the shapes of its inputs under kInputShapes, e.g.
+// {"forward": {"input_shapes": [[1, 3, 224, 224]]}}. The module is frozen and
+// every node of the frozen method has to be one of aten::conv2d, aten::linear
+// (on 2-d inputs), aten::add (of two tensors of the same shape), aten::relu
+// and aten::hardtanh on float tensors; lowering fails on any other node. To
+// delegate the supported part of a model, lower the submodule holding it.
+//
+// The processed module maps each method name to a dict holding:
+//   kInputs, kOutputs: the ids of the values the method takes and returns
+//   kShapes: the shape of every value, indexed by value id, in NCHW for 4-d
+//     activations
+//   kConstants: (value id, tensor) tuples of the weights and biases, already
+//     in the layout XNNPACK expects them in
+//   kNodes: (kind, input ids, output id, int params, float params) tuples,
+//     in execution order
+// A value id of -1 stands for an absent input, e.g. a missing bias.
+
+constexpr const char* kInputShapes = "input_shapes";
+
+constexpr const char* kInputs = "inputs";
+constexpr const char* kOutputs = "outputs";
+constexpr const char* kShapes = "shapes";
+constexpr const char* kConstants = "constants";
+constexpr const char* kNodes = "nodes";
+
+// Node kinds and their params
+// int params: padding (h, w), kernel (h, w), stride (h, w), dilation (h, w),
+//   groups, input channels per group, output channels per group
+constexpr const char* kConv2d = "conv2d";
+constexpr const char* kLinear = "linear";
+constexpr const char* kAdd = "add";
+// float params: min, max
+constexpr const char* kClamp = "clamp";
+
+} // namespace xnnpack
+} // namespace jit
+} // namespace torch
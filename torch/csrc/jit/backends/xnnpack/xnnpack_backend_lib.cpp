@@ -0,0 +1,308 @@
+#include <torch/csrc/jit/backends/backend.h>
+#include <torch/csrc/jit/backends/xnnpack/xnnpack_backend.h>
+
+#ifdef USE_XNNPACK
+#include <ATen/native/xnnpack/Common.h>
+#endif
+
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+
+namespace torch {
+namespace jit {
+namespace xnnpack {
+
+#ifdef USE_XNNPACK
+
+namespace {
+
+struct SubgraphDeleter final {
+  void operator()(xnn_subgraph_t subgraph) const {
+    xnn_delete_subgraph(subgraph);
+  }
+};
+
+struct RuntimeDeleter final {
+  void operator()(xnn_runtime_t runtime) const {
+    xnn_delete_runtime(runtime);
+  }
+};
+
+// Activations are NHWC inside the subgraph
+std::vector<size_t> xnnpackDims(const std::vector<int64_t>& shape) {
+  if (shape.size() == 4) {
+    return {static_cast<size_t>(shape[0]),
+            static_cast<size_t>(shape[2]),
+            static_cast<size_t>(shape[3]),
+            static_cast<size_t>(shape[1])};
+  }
+  return std::vector<size_t>(shape.begin(), shape.end());
+}
+
+// The XNNPACK runtime of one lowered method
+class Executor {
+ public:
+  explicit Executor(const c10::impl::GenericDict& method) {
+    const auto inputs = method.at(kInputs).toIntVector();
+    const auto outputs = method.at(kOutputs).toIntVector();
+    std::vector<std::vector<int64_t>> shapes;
+    for (const IValue& shape : method.at(kShapes).toList()) {
+      shapes.push_back(shape.toIntVector());
+    }
+
+    xnn_subgraph_t subgraph_ptr = nullptr;
+    xnn_status status = xnn_create_subgraph(
+        inputs.size() + outputs.size(), /*flags=*/0, &subgraph_ptr);
+    TORCH_CHECK(xnn_status_success == status, "xnn_create_subgraph failed!");
+    std::unique_ptr<xnn_subgraph, SubgraphDeleter> subgraph(subgraph_ptr);
+
+    std::unordered_map<int64_t, uint32_t> ids;
+    const auto define = [&](int64_t id,
+                            const std::vector<size_t>& dims,
+                            const void* data,
+                            uint32_t external_id,
+                            uint32_t flags) {
+      uint32_t xnn_id = XNN_INVALID_VALUE_ID;
+      const xnn_status status = xnn_define_tensor_value(
+          subgraph.get(),
+          xnn_datatype_fp32,
+          dims.size(),
+          dims.data(),
+          data,
+          external_id,
+          flags,
+          &xnn_id);
+      TORCH_CHECK(
+          xnn_status_success == status, "xnn_define_tensor_value failed!");
+      ids[id] = xnn_id;
+    };
+
+    // the subgraph refers to the weights, which have to outlive the runtime
+    for (const IValue& constant : method.at(kConstants).toList()) {
+      const auto& elements = constant.toTuple()->elements();
+      constants_.push_back(elements[1].toTensor().contiguous());
+      const auto& tensor = constants_.back();
+      define(
+          elements[0].toInt(),
+          std::vector<size_t>(tensor.sizes().begin(), tensor.sizes().end()),
+          tensor.data_ptr<float>(),
+          XNN_INVALID_VALUE_ID,
+          /*flags=*/0);
+    }
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      define(
+          inputs[i],
+          xnnpackDims(shapes[inputs[i]]),
+          nullptr,
+          i,
+          XNN_VALUE_FLAG_EXTERNAL_INPUT);
+      input_shapes_.push_back(shapes[inputs[i]]);
+    }
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      define(
+          outputs[i],
+          xnnpackDims(shapes[outputs[i]]),
+          nullptr,
+          inputs.size() + i,
+          XNN_VALUE_FLAG_EXTERNAL_OUTPUT);
+      output_shapes_.push_back(shapes[outputs[i]]);
+    }
+
+    const auto id = [&](int64_t value) -> uint32_t {
+      return value < 0 ? XNN_INVALID_VALUE_ID : ids.at(value);
+    };
+    constexpr float kMin = -std::numeric_limits<float>::infinity();
+    constexpr float kMax = std::numeric_limits<float>::infinity();
+    for (const IValue& node : method.at(kNodes).toList()) {
+      const auto& elements = node.toTuple()->elements();
+      const auto& kind = elements[0].toStringRef();
+      const auto in = elements[1].toIntVector();
+      const int64_t out = elements[2].toInt();
+      const auto p = elements[3].toIntVector();
+      const auto f = elements[4].toDoubleVector();
+      if (!ids.count(out)) {
+        define(
+            out,
+            xnnpackDims(shapes[out]),
+            nullptr,
+            XNN_INVALID_VALUE_ID,
+            /*flags=*/0);
+      }
+
+      if (kind == kConv2d) {
+        status = xnn_define_convolution_2d(
+            subgraph.get(),
+            p[0], // input_padding_top
+            p[1], // input_padding_right
+            p[0], // input_padding_bottom
+            p[1], // input_padding_left
+            p[2], // kernel_height
+            p[3], // kernel_width
+            p[4], // subsampling_height
+            p[5], // subsampling_width
+            p[6], // dilation_height
+            p[7], // dilation_width
+            p[8], // groups
+            p[9], // group_input_channels
+            p[10], // group_output_channels
+            kMin,
+            kMax,
+            id(in[0]),
+            id(in[1]),
+            id(in[2]),
+            id(out),
+            /*flags=*/0);
+      } else if (kind == kLinear) {
+        status = xnn_define_fully_connected(
+            subgraph.get(),
+            kMin,
+            kMax,
+            id(in[0]),
+            id(in[1]),
+            id(in[2]),
+            id(out),
+            /*flags=*/0);
+      } else if (kind == kAdd) {
+        status = xnn_define_add2(
+            subgraph.get(),
+            kMin,
+            kMax,
+            id(in[0]),
+            id(in[1]),
+            id(out),
+            /*flags=*/0);
+      } else if (kind == kClamp) {
+        // XNNPACK fuses a clamp into the node producing its input
+        status = xnn_define_clamp(
+            subgraph.get(), f[0], f[1], id(in[0]), id(out), /*flags=*/0);
+      } else {
+        TORCH_CHECK(false, "Unknown XNNPACK backend node ", kind);
+      }
+      TORCH_CHECK(
+          xnn_status_success == status, "Defining XNNPACK ", kind, " failed!");
+    }
+
+    xnn_runtime_t runtime = nullptr;
+    status = xnn_create_runtime_v2(
+        subgraph.get(), caffe2::pthreadpool_(), /*flags=*/0, &runtime);
+    TORCH_CHECK(xnn_status_success == status, "xnn_create_runtime_v2 failed!");
+    runtime_.reset(runtime);
+  }
+
+  c10::impl::GenericList run(const c10::impl::GenericList& inputs) {
+    TORCH_CHECK(
+        inputs.size() == input_shapes_.size(),
+        "Expected ",
+        input_shapes_.size(),
+        " inputs, got ",
+        inputs.size());
+    std::vector<at::Tensor> tensors;
+    std::vector<xnn_external_value> externals;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      auto input = inputs.get(i).toTensor();
+      TORCH_CHECK(
+          input.scalar_type() == at::kFloat &&
+              input.sizes() == c10::IntArrayRef(input_shapes_[i]),
+          "The XNNPACK backend was compiled for float inputs of shape ",
+          c10::IntArrayRef(input_shapes_[i]));
+      // only converted if not already NHWC
+      input = input.contiguous(
+          input.dim() == 4 ? at::MemoryFormat::ChannelsLast
+                           : at::MemoryFormat::Contiguous);
+      externals.push_back({static_cast<uint32_t>(i), input.data_ptr<float>()});
+      tensors.push_back(std::move(input));
+    }
+    c10::List<at::Tensor> outputs;
+    for (size_t i = 0; i < output_shapes_.size(); ++i) {
+      // returned in channels last, so no conversion is needed either
+      auto output = at::empty(
+          output_shapes_[i],
+          at::TensorOptions(at::kFloat),
+          output_shapes_[i].size() == 4 ? at::MemoryFormat::ChannelsLast
+                                        : at::MemoryFormat::Contiguous);
+      externals.push_back(
+          {static_cast<uint32_t>(inputs.size() + i), output.data_ptr<float>()});
+      outputs.push_back(output);
+    }
+
+    // the runtime is set up for the buffers of one call at a time
+    std::lock_guard<std::mutex> guard(mutex_);
+    xnn_status status =
+        xnn_setup_runtime(runtime_.get(), externals.size(), externals.data());
+    TORCH_CHECK(xnn_status_success == status, "xnn_setup_runtime failed!");
+    status = xnn_invoke_runtime(runtime_.get());
+    TORCH_CHECK(xnn_status_success == status, "xnn_invoke_runtime failed!");
+    return c10::impl::toList(outputs);
+  }
+
+ private:
+  std::unique_ptr<xnn_runtime, RuntimeDeleter> runtime_;
+  std::vector<at::Tensor> constants_;
+  std::vector<std::vector<int64_t>> input_shapes_;
+  std::vector<std::vector<int64_t>> output_shapes_;
+  std::mutex mutex_;
+};
+
+} // namespace
+
+#endif /* USE_XNNPACK */
+
+// Runs the methods lowered by the preprocess function registered in
+// xnnpack_backend_preprocess.cpp, see Note [XNNPACK backend].
+class XNNPACKBackend : public PyTorchBackendInterface {
+ public:
+  explicit XNNPACKBackend() {}
+  virtual ~XNNPACKBackend() = default;
+
+  bool is_available() override {
+#ifdef USE_XNNPACK
+    return at::native::xnnpack::internal::available();
+#else
+    return false;
+#endif
+  }
+
+  c10::impl::GenericDict compile(
+      c10::IValue processed,
+      c10::impl::GenericDict method_compile_spec) override {
+#ifdef USE_XNNPACK
+    auto handles = c10::Dict<std::string, int64_t>();
+    for (const auto& entry : processed.toGenericDict()) {
+      handles.insert(entry.key().toStringRef(), executors_.size());
+      executors_.push_back(
+          std::make_unique<Executor>(entry.value().toGenericDict()));
+    }
+    return c10::impl::toGenericDict(handles);
+#else
+    // only called when is_available
+    TORCH_CHECK(false, "XNNPACK is not enabled. Please build with USE_XNNPACK=1");
+    return c10::impl::GenericDict(StringType::get(), AnyType::get());
+#endif
+  }
+
+  c10::impl::GenericList execute(
+      c10::IValue handle,
+      c10::impl::GenericList inputs) override {
+#ifdef USE_XNNPACK
+    return executors_.at(handle.toInt())->run(inputs);
+#else
+    TORCH_CHECK(false, "XNNPACK is not enabled. Please build with USE_XNNPACK=1");
+    return inputs;
+#endif
+  }
+
+#ifdef USE_XNNPACK
+ private:
+  std::vector<std::unique_ptr<Executor>> executors_;
+#endif
+};
+
+namespace {
+constexpr auto backend_name = "xnnpack";
+static auto cls = torch::jit::backend<XNNPACKBackend>(backend_name);
+} // namespace
+
+} // namespace xnnpack
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,327 @@
+#include <torch/csrc/jit/backends/backend_preprocess.h>
+#include <torch/csrc/jit/backends/xnnpack/xnnpack_backend.h>
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/passes/freeze_module.h>
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+namespace torch {
+namespace jit {
+namespace xnnpack {
+namespace {
+
+// Lowers the nodes of a frozen method into the format described in
+// Note [XNNPACK backend], computing the shape of every value on the way.
+class Lowering {
+ public:
+  Lowering(
+      std::shared_ptr<Graph> graph,
+      std::vector<std::vector<int64_t>> input_shapes)
+      : graph_(std::move(graph)),
+        input_shapes_(std::move(input_shapes)),
+        constants_(AnyType::get()),
+        nodes_(AnyType::get()) {}
+
+  c10::Dict<IValue, IValue> run() {
+    const auto graph_inputs = graph_->inputs().slice(1);
+    TORCH_CHECK(
+        graph_inputs.size() == input_shapes_.size(),
+        "Expected ",
+        graph_inputs.size(),
+        " input shapes, got ",
+        input_shapes_.size());
+    c10::List<int64_t> inputs;
+    for (size_t i = 0; i < graph_inputs.size(); ++i) {
+      TORCH_CHECK(
+          graph_inputs[i]->type()->isSubtypeOf(TensorType::get()),
+          "XNNPACK backend only supports tensor inputs");
+      inputs.push_back(addValue(graph_inputs[i], input_shapes_[i]));
+    }
+
+    for (Node* node : graph_->nodes()) {
+      lowerNode(node);
+    }
+
+    std::vector<Value*> graph_outputs(
+        graph_->outputs().begin(), graph_->outputs().end());
+    if (graph_outputs.size() == 1 &&
+        graph_outputs[0]->node()->kind() == prim::TupleConstruct) {
+      const auto elements = graph_outputs[0]->node()->inputs();
+      graph_outputs.assign(elements.begin(), elements.end());
+    }
+    c10::List<int64_t> outputs;
+    for (Value* output : graph_outputs) {
+      const int64_t id = valueId(output, output->node());
+      TORCH_CHECK(
+          std::find(inputs.begin(), inputs.end(), id) == inputs.end(),
+          "XNNPACK backend does not support methods returning their inputs");
+      outputs.push_back(id);
+    }
+
+    c10::Dict<IValue, IValue> method(StringType::get(), AnyType::get());
+    method.insert(kInputs, inputs);
+    method.insert(kOutputs, outputs);
+    method.insert(kShapes, shapes_);
+    method.insert(kConstants, constants_);
+    method.insert(kNodes, nodes_);
+    return method;
+  }
+
+ private:
+  void lowerNode(Node* node) {
+    switch (node->kind()) {
+      case prim::Constant:
+        // constants are added when they are used
+        break;
+      case prim::TupleConstruct:
+        TORCH_CHECK(
+            node->output()->uses().size() == 1 &&
+                node->output()->uses()[0].user == graph_->return_node(),
+            "XNNPACK backend only supports tuples as method outputs. Source code: ",
+            node->sourceRange().str());
+        break;
+      case aten::conv2d:
+        lowerConv2d(node);
+        break;
+      case aten::linear:
+        lowerLinear(node);
+        break;
+      case aten::add:
+        lowerAdd(node);
+        break;
+      case aten::relu:
+      case aten::relu_:
+        lowerClamp(node, 0, std::numeric_limits<float>::infinity());
+        break;
+      case aten::hardtanh:
+      case aten::hardtanh_:
+        lowerClamp(
+            node,
+            constant(node->input(1), node).toDouble(),
+            constant(node->input(2), node).toDouble());
+        break;
+      default:
+        TORCH_CHECK(
+            false,
+            "The node of ",
+            node->kind().toQualString(),
+            " is not supported by the XNNPACK backend. Source code: ",
+            node->sourceRange().str());
+    }
+  }
+
+  void lowerConv2d(Node* node) {
+    const int64_t input = valueId(node->input(0), node);
+    const auto input_shape = shapes_.get(input).vec();
+    TORCH_CHECK(
+        input_shape.size() == 4,
+        "XNNPACK backend only supports 4-d conv2d inputs. Source code: ",
+        node->sourceRange().str());
+    const auto weight = constantTensor(node->input(1), node);
+    const auto stride = expandParam(constant(node->input(3), node), node);
+    const auto padding = expandParam(constant(node->input(4), node), node);
+    const auto dilation = expandParam(constant(node->input(5), node), node);
+    const int64_t groups = constant(node->input(6), node).toInt();
+    TORCH_CHECK(
+        weight.dim() == 4 && input_shape[1] == weight.size(1) * groups &&
+            weight.size(0) % groups == 0,
+        "Invalid conv2d weight. Source code: ",
+        node->sourceRange().str());
+
+    std::vector<int64_t> output_shape{input_shape[0], weight.size(0)};
+    for (size_t i = 0; i < 2; ++i) {
+      const int64_t kernel = dilation[i] * (weight.size(i + 2) - 1) + 1;
+      output_shape.push_back(
+          (input_shape[i + 2] + 2 * padding[i] - kernel) / stride[i] + 1);
+    }
+    // XNNPACK expects OHWI filters
+    const int64_t filter =
+        addConstant(weight.permute({0, 2, 3, 1}).contiguous());
+    const int64_t bias = optionalConstant(node->input(2), node);
+    const int64_t output = addValue(node->output(), output_shape);
+
+    c10::List<int64_t> params{padding[0],
+                              padding[1],
+                              weight.size(2),
+                              weight.size(3),
+                              stride[0],
+                              stride[1],
+                              dilation[0],
+                              dilation[1],
+                              groups,
+                              weight.size(1),
+                              weight.size(0) / groups};
+    addNode(kConv2d, {input, filter, bias}, output, params);
+  }
+
+  void lowerLinear(Node* node) {
+    const int64_t input = valueId(node->input(0), node);
+    const auto input_shape = shapes_.get(input).vec();
+    const auto weight = constantTensor(node->input(1), node);
+    TORCH_CHECK(
+        input_shape.size() == 2 && weight.dim() == 2 &&
+            input_shape[1] == weight.size(1),
+        "XNNPACK backend only supports linear on 2-d inputs. Source code: ",
+        node->sourceRange().str());
+    const int64_t filter = addConstant(weight.contiguous());
+    const int64_t bias = optionalConstant(node->input(2), node);
+    const int64_t output =
+        addValue(node->output(), {input_shape[0], weight.size(0)});
+    addNode(kLinear, {input, filter, bias}, output);
+  }
+
+  void lowerAdd(Node* node) {
+    TORCH_CHECK(
+        node->input(1)->type()->isSubtypeOf(TensorType::get()) &&
+            constant(node->input(2), node).toScalar().toDouble() == 1,
+        "XNNPACK backend only supports adding two tensors. Source code: ",
+        node->sourceRange().str());
+    const int64_t a = valueId(node->input(0), node);
+    const int64_t b = valueId(node->input(1), node);
+    const auto shape = shapes_.get(a).vec();
+    TORCH_CHECK(
+        shape == shapes_.get(b).vec(),
+        "XNNPACK backend does not support broadcasting add. Source code: ",
+        node->sourceRange().str());
+    addNode(kAdd, {a, b}, addValue(node->output(), shape));
+  }
+
+  void lowerClamp(Node* node, double min, double max) {
+    const int64_t input = valueId(node->input(0), node);
+    // an in-place op is lowered as a functional one, which is only correct if
+    // the value it modifies is not used afterwards
+    TORCH_CHECK(
+        node->kind() == aten::relu || node->kind() == aten::hardtanh ||
+            node->input(0)->uses().size() == 1,
+        "XNNPACK backend does not support reusing the input of ",
+        node->kind().toQualString(),
+        ". Source code: ",
+        node->sourceRange().str());
+    const int64_t output = addValue(node->output(), shapes_.get(input).vec());
+    addNode(kClamp, {input}, output, c10::List<int64_t>(), {min, max});
+  }
+
+  IValue constant(Value* value, Node* node) {
+    auto ivalue = toIValue(value);
+    TORCH_CHECK(
+        ivalue,
+        "XNNPACK backend expects argument ",
+        value->debugName(),
+        " of ",
+        node->kind().toQualString(),
+        " to be a constant. Source code: ",
+        node->sourceRange().str());
+    return *ivalue;
+  }
+
+  at::Tensor constantTensor(Value* value, Node* node) {
+    auto ivalue = constant(value, node);
+    TORCH_CHECK(
+        ivalue.isTensor() && ivalue.toTensor().scalar_type() == at::kFloat,
+        "XNNPACK backend only supports float weights. Source code: ",
+        node->sourceRange().str());
+    return ivalue.toTensor();
+  }
+
+  int64_t optionalConstant(Value* value, Node* node) {
+    if (constant(value, node).isNone()) {
+      return -1;
+    }
+    return addConstant(constantTensor(value, node).contiguous());
+  }
+
+  std::vector<int64_t> expandParam(const IValue& param, Node* node) {
+    auto values = param.toIntVector();
+    if (values.size() == 1) {
+      values.push_back(values[0]);
+    }
+    TORCH_CHECK(
+        values.size() == 2,
+        "Expected 2-d params. Source code: ",
+        node->sourceRange().str());
+    return values;
+  }
+
+  int64_t valueId(Value* value, Node* node) {
+    auto it = ids_.find(value);
+    TORCH_CHECK(
+        it != ids_.end(),
+        "XNNPACK backend expects ",
+        value->debugName(),
+        " to be computed by the lowered method. Source code: ",
+        node->sourceRange().str());
+    return it->second;
+  }
+
+  int64_t addValue(Value* value, c10::IntArrayRef shape) {
+    const int64_t id = shapes_.size();
+    shapes_.push_back(c10::List<int64_t>(shape));
+    ids_[value] = id;
+    return id;
+  }
+
+  int64_t addConstant(const at::Tensor& tensor) {
+    const int64_t id = shapes_.size();
+    shapes_.push_back(c10::List<int64_t>(tensor.sizes()));
+    constants_.push_back(c10::ivalue::Tuple::create({id, tensor}));
+    return id;
+  }
+
+  void addNode(
+      const char* kind,
+      c10::List<int64_t> inputs,
+      int64_t output,
+      c10::List<int64_t> int_params = c10::List<int64_t>(),
+      c10::List<double> float_params = c10::List<double>()) {
+    nodes_.push_back(c10::ivalue::Tuple::create(
+        {kind, inputs, output, int_params, float_params}));
+  }
+
+  std::shared_ptr<Graph> graph_;
+  std::vector<std::vector<int64_t>> input_shapes_;
+  std::unordered_map<Value*, int64_t> ids_;
+  c10::List<c10::List<int64_t>> shapes_;
+  c10::impl::GenericList constants_;
+  c10::impl::GenericList nodes_;
+};
+
+c10::IValue preprocess(
+    const Module& mod,
+    const c10::Dict<IValue, IValue>& method_compile_spec) {
+  std::vector<std::string> methods;
+  for (const auto& entry : method_compile_spec) {
+    methods.push_back(entry.key().toStringRef());
+  }
+  // Freezing inlines the methods and folds the parameters into constants
+  auto frozen = freeze_module(mod, methods);
+
+  c10::Dict<IValue, IValue> compiled(StringType::get(), AnyType::get());
+  for (const auto& entry : method_compile_spec) {
+    const auto& name = entry.key().toStringRef();
+    const auto spec = entry.value().toGenericDict();
+    TORCH_CHECK(
+        spec.contains(kInputShapes),
+        "The compile spec of method ",
+        name,
+        " does not hold the ",
+        kInputShapes,
+        " the XNNPACK backend needs");
+    std::vector<std::vector<int64_t>> input_shapes;
+    for (const IValue& shape : spec.at(kInputShapes).toList()) {
+      input_shapes.push_back(shape.toIntVector());
+    }
+    auto graph = frozen.get_method(name).graph()->copy();
+    compiled.insert(name, Lowering(graph, std::move(input_shapes)).run());
+  }
+  return compiled;
+}
+
+constexpr auto backend_name = "xnnpack";
+static auto pre_reg = backend_preprocess_register(backend_name, preprocess);
+
+} // namespace
+} // namespace xnnpack
+} // namespace jit
+} // namespace torch
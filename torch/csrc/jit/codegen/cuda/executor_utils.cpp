@@ -8,6 +8,7 @@
 #include <torch/csrc/jit/codegen/cuda/instrumentation.h>
 #include <torch/csrc/jit/codegen/cuda/ir_all_nodes.h>
 #include <torch/csrc/jit/codegen/fuser/cuda/fused_kernel.h>
+#include <torch/csrc/jit/codegen/fuser/cuda/kernel_binary_cache.h>
 #include <torch/csrc/jit/resource_guard.h>
 
 #include <nvfuser_resources/block_reduction.h>
@@ -244,6 +245,84 @@ StatefulExpressionEvaluator statefulBindInputs(
   return evaluator;
 }
 
+namespace {
+
+// Compiles code with NVRTC, returning SASS (CUBIN) if compile_to_sass is set,
+// and PTX otherwise
+KernelBinary compileKernelBinary(
+    const std::string& code,
+    const std::string& func_name,
+    const std::vector<const char*>& args,
+    bool compile_to_sass) {
+  nvrtcProgram program; // NOLINT(cppcoreguidelines-init-variables)
+
+  {
+    FUSER_PERF_SCOPE("nvrtcCreateProgram");
+    AT_CUDA_NVRTC_CHECK(at::globalContext().getNVRTC().nvrtcCreateProgram(
+        &program, code.c_str(), nullptr, 0, nullptr, nullptr));
+  }
+
+  ResourceGuard holdProgram([&] {
+    FUSER_PERF_SCOPE("nvrtcDestroyProgram");
+    AT_CUDA_NVRTC_CHECK(
+        at::globalContext().getNVRTC().nvrtcDestroyProgram(&program));
+  });
+
+  at::globalContext().getNVRTC().nvrtcAddNameExpression(
+      program, func_name.c_str());
+
+  {
+    FUSER_PERF_SCOPE("nvrtcCompileProgram");
+
+    const auto result = at::globalContext().getNVRTC().nvrtcCompileProgram(
+        program, args.size(), args.data());
+
+    if (result != NVRTC_SUCCESS) {
+      size_t logsize;
+      at::globalContext().getNVRTC().nvrtcGetProgramLogSize(program, &logsize);
+      std::vector<char> log(logsize);
+      at::globalContext().getNVRTC().nvrtcGetProgramLog(program, log.data());
+
+      TORCH_INTERNAL_ASSERT(
+          false, code.c_str(), "\nCUDA NVRTC compile error: ", log.data());
+    }
+
+    AT_CUDA_NVRTC_CHECK(result);
+  }
+
+  KernelBinary kernel;
+  const char* lowered_kernel_name = nullptr;
+  at::globalContext().getNVRTC().nvrtcGetLoweredName(
+      program, func_name.c_str(), &lowered_kernel_name);
+  kernel.name = lowered_kernel_name;
+
+  size_t ptx_size = 0;
+
+  {
+    FUSER_PERF_SCOPE("get PTX");
+#if CUDA_VERSION >= 11010
+    // compile_to_sass determines whether we are generating SASS or PTX, hence
+    // the different API.
+    const auto getSize = compile_to_sass
+        ? at::globalContext().getNVRTC().nvrtcGetCUBINSize
+        : at::globalContext().getNVRTC().nvrtcGetPTXSize;
+    const auto getFunc = compile_to_sass
+        ? at::globalContext().getNVRTC().nvrtcGetCUBIN
+        : at::globalContext().getNVRTC().nvrtcGetPTX;
+#else
+    const auto getSize = at::globalContext().getNVRTC().nvrtcGetPTXSize;
+    const auto getFunc = at::globalContext().getNVRTC().nvrtcGetPTX;
+#endif
+    AT_CUDA_NVRTC_CHECK(getSize(program, &ptx_size));
+    kernel.binary.resize(ptx_size);
+    AT_CUDA_NVRTC_CHECK(getFunc(program, kernel.binary.data()));
+  }
+
+  return kernel;
+}
+
+} // namespace
+
 NvrtcFunction nvrtcCompile(
     const std::string& code,
     const std::string& func_name,
@@ -265,20 +344,6 @@ NvrtcFunction nvrtcCompile(
   bool compile_to_sass = false;
   codegenOutputQuery(prop, major, minor, compile_to_sass);
 
-  nvrtcProgram program; // NOLINT(cppcoreguidelines-init-variables)
-
-  {
-    FUSER_PERF_SCOPE("nvrtcCreateProgram");
-    AT_CUDA_NVRTC_CHECK(at::globalContext().getNVRTC().nvrtcCreateProgram(
-        &program, code.c_str(), nullptr, 0, nullptr, nullptr));
-  }
-
-  ResourceGuard holdProgram([&] {
-    FUSER_PERF_SCOPE("nvrtcDestroyProgram");
-    AT_CUDA_NVRTC_CHECK(
-        at::globalContext().getNVRTC().nvrtcDestroyProgram(&program));
-  });
-
 #ifdef __HIP_PLATFORM_HCC__
   std::vector<const char*> args = {"--std=c++14"};
 #else
@@ -331,54 +396,16 @@ NvrtcFunction nvrtcCompile(
     }
   }
 
-  at::globalContext().getNVRTC().nvrtcAddNameExpression(
-      program, func_name.c_str());
-
-  {
-    FUSER_PERF_SCOPE("nvrtcCompileProgram");
-
-    const auto result = at::globalContext().getNVRTC().nvrtcCompileProgram(
-        program, args.size(), args.data());
-
-    if (result != NVRTC_SUCCESS) {
-      size_t logsize;
-      at::globalContext().getNVRTC().nvrtcGetProgramLogSize(program, &logsize);
-      std::vector<char> log(logsize);
-      at::globalContext().getNVRTC().nvrtcGetProgramLog(program, log.data());
-
-      TORCH_INTERNAL_ASSERT(
-          false, code.c_str(), "\nCUDA NVRTC compile error: ", log.data());
-    }
-
-    AT_CUDA_NVRTC_CHECK(result);
-  }
-
-  const char* lowered_kernel_name = nullptr;
-  at::globalContext().getNVRTC().nvrtcGetLoweredName(
-      program, func_name.c_str(), &lowered_kernel_name);
-
-  size_t ptx_size = 0;
-  std::vector<char> ptx;
-
-  {
-    FUSER_PERF_SCOPE("get PTX");
-#if CUDA_VERSION >= 11010
-    // compile_to_sass determines whether we are generating SASS or PTX, hence
-    // the different API.
-    const auto getSize = compile_to_sass
-        ? at::globalContext().getNVRTC().nvrtcGetCUBINSize
-        : at::globalContext().getNVRTC().nvrtcGetPTXSize;
-    const auto getFunc = compile_to_sass
-        ? at::globalContext().getNVRTC().nvrtcGetCUBIN
-        : at::globalContext().getNVRTC().nvrtcGetPTX;
-#else
-    const auto getSize = at::globalContext().getNVRTC().nvrtcGetPTXSize;
-    const auto getFunc = at::globalContext().getNVRTC().nvrtcGetPTX;
-#endif
-    AT_CUDA_NVRTC_CHECK(getSize(program, &ptx_size));
-    ptx.resize(ptx_size);
-    AT_CUDA_NVRTC_CHECK(getFunc(program, ptx.data()));
+  // see Note [Kernel binary cache]
+  const std::string cache_key = kernelBinaryCacheKey(code, args);
+  auto cached = loadKernelBinary(cache_key);
+  if (!cached) {
+    cached = compileKernelBinary(code, func_name, args, compile_to_sass);
+    storeKernelBinary(cache_key, *cached);
   }
+  const char* lowered_kernel_name = cached->name.c_str();
+  std::vector<char>& ptx = cached->binary;
+  const size_t ptx_size = ptx.size();
 
   NvrtcFunction compiled_kernel_;
 
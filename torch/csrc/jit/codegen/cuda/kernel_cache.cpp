@@ -4,8 +4,12 @@
 #include <torch/csrc/jit/codegen/cuda/ir_utils.h>
 #include <torch/csrc/jit/codegen/cuda/parser.h>
 #include <torch/csrc/jit/codegen/cuda/scheduler.h>
+#include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/runtime/graph_executor.h>
 
+#include <algorithm>
+#include <unordered_set>
+
 namespace torch {
 namespace jit {
 namespace fuser {
@@ -112,6 +116,46 @@ at::DimVector graphReductionAxes(const std::shared_ptr<Graph>& graph) {
   return reduction_axes;
 }
 
+// Assign the nodes of graph to segments, see [ Note -- segmented fusion ].
+// Constants are left out, they are copied into every segment using them.
+std::vector<std::vector<Node*>> segmentNodes(
+    const std::shared_ptr<Graph>& graph) {
+  std::vector<std::vector<Node*>> segments(1);
+  bool has_reduction = false;
+  // values computed from the reduction of the current segment;
+  std::unordered_set<const Value*> reduced;
+
+  for (auto n : graph->nodes()) {
+    if (n->kind() == prim::Constant) {
+      continue;
+    }
+    bool reads_reduced = false;
+    bool reads_unreduced = false;
+    for (auto input : n->inputs()) {
+      if (reduced.count(input)) {
+        reads_reduced = true;
+      } else if (
+          input->type()->isSubtypeOf(TensorType::get()) &&
+          input->node()->kind() != prim::Constant) {
+        reads_unreduced = true;
+      }
+    }
+    const bool is_reduction = isReductionNode(n);
+    if ((is_reduction && has_reduction) || (reads_reduced && reads_unreduced)) {
+      segments.emplace_back();
+      has_reduction = false;
+      reduced.clear();
+      reads_reduced = false;
+    }
+    segments.back().push_back(n);
+    if (is_reduction || reads_reduced) {
+      has_reduction |= is_reduction;
+      reduced.insert(n->outputs().begin(), n->outputs().end());
+    }
+  }
+  return segments;
+}
+
 // TODO(CONTIGUITY)
 at::DimVector getPermutationPerSortedStride(const TensorTypePtr& type) {
   FUSER_PERF_SCOPE("getPermutationPerSortedStride");
@@ -530,6 +574,11 @@ GraphCache::GraphCache(const std::shared_ptr<Graph>& graph) {
   TORCH_INTERNAL_ASSERT(
       IsNewExecutorEnabled(), "legacy executor is not supported by nvfuser");
 
+  if (segmentNodes(graph).size() > 1) {
+    segmentGraph(graph);
+    return;
+  }
+
   // [ NOTE - reduction in graph ]
   //
   // reduction complicates our permutation in integration, it addes two things:
@@ -565,6 +614,10 @@ std::vector<at::Tensor> GraphCache::runGraphWithInputs(
     const at::ArrayRef<IValue>& inputs) {
   FUSER_PERF_SCOPE("runGraphWithInputs");
 
+  if (!segments_.empty()) {
+    return runSegmentsWithInputs(inputs);
+  }
+
   // GraphCache need to permute inputs/outputs to accommodate dimension
   // coalescing
   if (requiresPermutation()) {
@@ -603,6 +656,111 @@ std::vector<at::Tensor> GraphCache::runGraphWithInputs(
   }
 }
 
+void GraphCache::segmentGraph(const std::shared_ptr<Graph>& graph) {
+  FUSER_PERF_SCOPE("GraphCache::segmentGraph");
+
+  // index in the value table of the values computed so far;
+  std::unordered_map<const Value*, size_t> value_index;
+  for (size_t i = 0; i < graph->inputs().size(); i++) {
+    value_index[graph->inputs()[i]] = i;
+  }
+  size_t num_values = graph->inputs().size();
+
+  for (const auto& nodes : segmentNodes(graph)) {
+    const std::unordered_set<const Node*> in_segment(nodes.begin(), nodes.end());
+    auto segment_graph = std::make_shared<Graph>();
+    std::unordered_map<Value*, Value*> env;
+    Segment segment;
+
+    auto value_map_fn = [&](Value* v) -> Value* {
+      auto iter = env.find(v);
+      if (iter != env.end()) {
+        return iter->second;
+      }
+      Value* mapped = nullptr;
+      if (v->node()->kind() == prim::Constant) {
+        mapped = segment_graph
+                     ->insertNode(segment_graph->createClone(
+                         v->node(), [](Value*) -> Value* {
+                           TORCH_INTERNAL_ASSERT(false, "constant has input");
+                           return nullptr;
+                         }))
+                     ->output();
+      } else {
+        mapped = segment_graph->addInput()->copyMetadata(v);
+        auto tensor_type = v->type()->cast<TensorType>();
+        if (tensor_type && v->node() != graph->param_node()) {
+          // only the inputs of the fusion are profiled and guarded, drop the
+          // strides of intermediate values.
+          mapped->setType(TensorType::create(
+              tensor_type->scalarType(),
+              tensor_type->device(),
+              tensor_type->symbolic_sizes(),
+              VaryingShape<Stride>(tensor_type->dim()),
+              tensor_type->requires_grad()));
+        }
+        segment.inputs.push_back(value_index.at(v));
+      }
+      env[v] = mapped;
+      return mapped;
+    };
+
+    for (auto n : nodes) {
+      auto cloned =
+          segment_graph->insertNode(segment_graph->createClone(n, value_map_fn));
+      for (size_t i = 0; i < n->outputs().size(); i++) {
+        env[n->output(i)] = cloned->output(i);
+      }
+    }
+
+    // values read by later segments, or returned by the graph
+    for (auto n : nodes) {
+      for (auto output : n->outputs()) {
+        const bool escapes = std::any_of(
+            output->uses().begin(), output->uses().end(), [&](const Use& use) {
+              return in_segment.count(use.user) == 0;
+            });
+        if (escapes) {
+          segment_graph->registerOutput(env.at(output));
+          value_index[output] = num_values++;
+        }
+      }
+    }
+
+    GRAPH_DEBUG("Fusion segment ", segments_.size(), ":\n", *segment_graph);
+    segment.graph_cache = std::make_unique<GraphCache>(segment_graph);
+    segments_.emplace_back(std::move(segment));
+  }
+
+  for (auto output : graph->outputs()) {
+    segmented_outputs_.push_back(value_index.at(output));
+  }
+}
+
+std::vector<at::Tensor> GraphCache::runSegmentsWithInputs(
+    const at::ArrayRef<IValue>& inputs) {
+  FUSER_PERF_SCOPE("runSegmentsWithInputs");
+
+  std::vector<IValue> values(inputs.begin(), inputs.end());
+  std::vector<IValue> segment_inputs;
+  for (const auto& segment : segments_) {
+    segment_inputs.clear();
+    for (auto index : segment.inputs) {
+      segment_inputs.push_back(values[index]);
+    }
+    auto segment_outputs =
+        segment.graph_cache->runGraphWithInputs(segment_inputs);
+    values.insert(values.end(), segment_outputs.begin(), segment_outputs.end());
+  }
+
+  std::vector<at::Tensor> outputs;
+  outputs.reserve(segmented_outputs_.size());
+  for (auto index : segmented_outputs_) {
+    outputs.push_back(values[index].toTensor());
+  }
+  return outputs;
+}
+
 } // namespace cuda
 } // namespace fuser
 } // namespace jit
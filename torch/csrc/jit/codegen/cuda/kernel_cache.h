@@ -122,6 +122,26 @@ class TORCH_CUDA_CU_API InputsIdLookup {
 //!     d) rank;
 //!     e) scalar type;
 
+//! [ Note -- segmented fusion ]
+//!
+//! `FusionExecutorCache` schedules a fusion as a single kernel, which holds at
+//! most one reduction, optionally followed by point-wise operations on its
+//! result. Fusions with several reductions, or normalizations, where the
+//! result of a reduction is combined with the tensor it reduced (e.g.
+//! `x - x.sum(0)`), can not be scheduled that way.
+//!
+//! `GraphCache` splits the graph of such fusions into segments that can, and
+//! runs them one after the other. Nodes are assigned to segments in
+//! topological order; a new segment is started at a reduction when the current
+//! one already has one, and at a node that reads both a value computed from
+//! the reduction of the current segment and a tensor that is not. Values
+//! crossing segments are materialized as outputs of the segment producing
+//! them, i.e. written to global memory, and are inputs of the segments reading
+//! them. Each segment is handled by its own nested `GraphCache`.
+//!
+//! Profiling information only covers the inputs of the fusion, so a segment
+//! input that is an intermediate value makes no assumption on its strides.
+
 class FusionExecutorCache {
  public:
   //! create new fusion executor cache at a given device to handle kernel
@@ -199,6 +219,12 @@ class GraphCache {
   std::vector<at::Tensor> runGraphWithInputs(
       const at::ArrayRef<IValue>& inputs);
 
+  //! number of kernels the graph is split into, see
+  //! [ Note -- segmented fusion ]
+  size_t numSegments() const {
+    return segments_.empty() ? 1 : segments_.size();
+  }
+
  private:
   //! Computation graph;
   std::shared_ptr<Graph> graph_;
@@ -224,6 +250,26 @@ class GraphCache {
 
   //! FusionExecutorCache that performs schedule and kernel execution;
   std::unique_ptr<FusionExecutorCache> fusion_executor_cache_;
+
+  //! split graph into `segments_`, see [ Note -- segmented fusion ]
+  void segmentGraph(const std::shared_ptr<Graph>& graph);
+
+  //! execute `segments_` in order
+  std::vector<at::Tensor> runSegmentsWithInputs(
+      const at::ArrayRef<IValue>& inputs);
+
+  //! A segment reads its inputs from, and appends its outputs to, a table of
+  //! values that starts with the inputs of the graph.
+  struct Segment {
+    std::unique_ptr<GraphCache> graph_cache;
+    std::vector<size_t> inputs;
+  };
+
+  //! segments of a graph that is not scheduled as a single kernel, empty
+  //! otherwise;
+  std::vector<Segment> segments_;
+  //! index in the value table of each output of a segmented graph;
+  std::vector<size_t> segmented_outputs_;
 };
 
 } // namespace cuda
@@ -4,6 +4,8 @@
 #include <torch/csrc/jit/codegen/cuda/instrumentation.h>
 #include <torch/csrc/jit/codegen/cuda/parser.h>
 
+#include <cstdlib>
+
 namespace torch {
 namespace jit {
 namespace fuser {
@@ -288,6 +290,18 @@ bool createTrickyBroadcast(const Node* consumer, const Node* producer) {
   return false;
 }
 
+// Producers containing reductions are merged into their consumers, and the
+// resulting fusion is split into kernels at run time, see
+// [ Note -- segmented fusion ]. This can be turned off with
+// `PYTORCH_CUDA_FUSER_DISABLE_SEGMENTATION=1`.
+bool isSegmentationEnabled() {
+  static const bool enabled = []() {
+    const char* disable_env = getenv("PYTORCH_CUDA_FUSER_DISABLE_SEGMENTATION");
+    return !(disable_env && atoi(disable_env));
+  }();
+  return enabled;
+}
+
 } // namespace
 
 bool isFusableCudaFusionGroup(const Node* node) {
@@ -302,9 +316,8 @@ bool isFusableCudaFusionGroup(const Node* node) {
 bool isFusableCudaFusionGroup(const Node* fusion, const Node* node) {
   FUSER_PERF_SCOPE("isFusableCudaFusionGroup");
 
-  // TODO: lift the restriction of not fusing producer containing reduction when
-  //       we have proper scheduling.
-  if (isFusableCudaFusionGroup(node) && !hasReductionOperation(node) &&
+  if (isFusableCudaFusionGroup(node) &&
+      (isSegmentationEnabled() || !hasReductionOperation(node)) &&
       !createTrickyBroadcast(fusion, node)) {
     // ensure if the node has a designated device, it's on the same device with
     // fusion.
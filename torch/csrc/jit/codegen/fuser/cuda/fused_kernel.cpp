@@ -1,6 +1,7 @@
 #include <torch/csrc/jit/codegen/fuser/cuda/fused_kernel.h>
 
 #include <torch/csrc/jit/codegen/fuser/compiler.h>
+#include <torch/csrc/jit/codegen/fuser/cuda/kernel_binary_cache.h>
 
 #include <ATen/ATen.h>
 #include <ATen/CUDAGeneratorImpl.h>
@@ -75,6 +76,52 @@ void codegenOutputQuery(
   compile_to_sass = ((major == prop->major) && (minor == prop->minor));
 }
 
+// Compiles code with NVRTC, returning SASS (CUBIN) if compile_to_sass is set,
+// and PTX otherwise
+static std::vector<char> compileKernelBinary(
+    const std::string& code,
+    const std::vector<const char*>& args,
+    bool compile_to_sass) {
+  // Creates the NVRTC program
+  nvrtcProgram program;
+  AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcCreateProgram(
+      &program, code.c_str(), nullptr, 0, nullptr, nullptr));
+
+  const auto result =
+      nvrtc().nvrtcCompileProgram(program, args.size(), args.data());
+  if (result != NVRTC_SUCCESS) {
+    size_t logsize;
+    AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcGetProgramLogSize(program, &logsize));
+    std::vector<char> log(logsize);
+    AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcGetProgramLog(program, log.data()));
+    std::stringstream cu;
+    cu << log.data();
+    throw std::runtime_error(cu.str());
+  }
+  ResourceGuard holdProgram(
+      [&] { AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcDestroyProgram(&program)); });
+  AT_CUDA_NVRTC_CHECK(result);
+  size_t ptx_size;
+  std::vector<char> ptx;
+#if CUDA_VERSION >= 11010
+  // compile_to_sass determines whether we are generating SASS or PTX, hence
+  // the different API.
+  const auto getSize = compile_to_sass
+      ? at::globalContext().getNVRTC().nvrtcGetCUBINSize
+      : at::globalContext().getNVRTC().nvrtcGetPTXSize;
+  const auto getFunc = compile_to_sass
+      ? at::globalContext().getNVRTC().nvrtcGetCUBIN
+      : at::globalContext().getNVRTC().nvrtcGetPTX;
+#else
+  const auto getSize = at::globalContext().getNVRTC().nvrtcGetPTXSize;
+  const auto getFunc = at::globalContext().getNVRTC().nvrtcGetPTX;
+#endif
+  AT_CUDA_NVRTC_CHECK(getSize(program, &ptx_size));
+  ptx.resize(ptx_size);
+  AT_CUDA_NVRTC_CHECK(getFunc(program, ptx.data()));
+  return ptx;
+}
+
 // Compiles the specified kernel and stores the metadata required to run it
 FusedKernelCUDA::FusedKernelCUDA(
     at::DeviceIndex device,
@@ -115,11 +162,6 @@ FusedKernelCUDA::FusedKernelCUDA(
   bool compile_to_sass = false;
   codegenOutputQuery(prop_, major, minor, compile_to_sass);
 
-  // Creates the NVRTC program
-  nvrtcProgram program;
-  AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcCreateProgram(
-      &program, code_.c_str(), nullptr, 0, nullptr, nullptr));
-
 #ifdef __HIP_PLATFORM_HCC__
   std::vector<const char*> args = {};
 #else
@@ -140,37 +182,15 @@ FusedKernelCUDA::FusedKernelCUDA(
   const std::vector<const char*> args = {
       "--std=c++14", compute.c_str(), "-default-device"};
 #endif
-  const auto result =
-      nvrtc().nvrtcCompileProgram(program, args.size(), args.data());
-  if (result != NVRTC_SUCCESS) {
-    size_t logsize;
-    AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcGetProgramLogSize(program, &logsize));
-    std::vector<char> log(logsize);
-    AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcGetProgramLog(program, log.data()));
-    std::stringstream cu;
-    cu << log.data();
-    throw std::runtime_error(cu.str());
+
+  // see Note [Kernel binary cache]
+  const std::string cache_key = kernelBinaryCacheKey(code_, args);
+  if (auto cached = loadKernelBinary(cache_key)) {
+    ptx_ = std::move(cached->binary);
+  } else {
+    ptx_ = compileKernelBinary(code_, args, compile_to_sass);
+    storeKernelBinary(cache_key, {name_, ptx_});
   }
-  ResourceGuard holdProgram(
-      [&] { AT_CUDA_NVRTC_CHECK(nvrtc().nvrtcDestroyProgram(&program)); });
-  AT_CUDA_NVRTC_CHECK(result);
-  size_t ptx_size;
-#if CUDA_VERSION >= 11010
-  // compile_to_sass determines whether we are generating SASS or PTX, hence
-  // the different API.
-  const auto getSize = compile_to_sass
-      ? at::globalContext().getNVRTC().nvrtcGetCUBINSize
-      : at::globalContext().getNVRTC().nvrtcGetPTXSize;
-  const auto getFunc = compile_to_sass
-      ? at::globalContext().getNVRTC().nvrtcGetCUBIN
-      : at::globalContext().getNVRTC().nvrtcGetPTX;
-#else
-  const auto getSize = at::globalContext().getNVRTC().nvrtcGetPTXSize;
-  const auto getFunc = at::globalContext().getNVRTC().nvrtcGetPTX;
-#endif
-  AT_CUDA_NVRTC_CHECK(getSize(program, &ptx_size));
-  ptx_.resize(ptx_size);
-  AT_CUDA_NVRTC_CHECK(getFunc(program, ptx_.data()));
 
   AT_CUDA_DRIVER_CHECK(nvrtc().cuModuleLoadData(&module_, ptx_.data()));
   AT_CUDA_DRIVER_CHECK(
@@ -0,0 +1,100 @@
+#include <torch/csrc/jit/codegen/fuser/cuda/kernel_binary_cache.h>
+
+#include <ATen/Context.h>
+#include <ATen/cuda/CUDAContext.h>
+#include <ATen/cuda/nvrtc_stub/ATenNVRTC.h>
+#include <c10/util/hash.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/runtime/disk_cache.h>
+
+#include <sstream>
+
+namespace torch {
+namespace jit {
+namespace fuser {
+namespace cuda {
+
+namespace {
+
+// bump whenever the format of the entries or of the key changes
+constexpr const char* kCacheVersion = "1";
+
+DiskCache& kernelBinaryCache() {
+  static DiskCache cache("PYTORCH_CUDA_FUSER_CACHE_DIR", ".bin");
+  return cache;
+}
+
+} // namespace
+
+void setKernelBinaryCacheDir(std::string dir) {
+  kernelBinaryCache().setDir(std::move(dir));
+}
+
+std::string getKernelBinaryCacheDir() {
+  return kernelBinaryCache().dir();
+}
+
+std::string kernelBinaryCacheKey(
+    const std::string& code,
+    const std::vector<const char*>& args) {
+  int nvrtc_major = 0, nvrtc_minor = 0;
+  AT_CUDA_NVRTC_CHECK(at::globalContext().getNVRTC().nvrtcVersion(
+      &nvrtc_major, &nvrtc_minor));
+  // args name the target architecture, except on ROCm
+  const auto prop = at::cuda::getCurrentDeviceProperties();
+  std::stringstream ss;
+  ss << kCacheVersion << "\n"
+     << nvrtc_major << "." << nvrtc_minor << "\n"
+     << prop->name << " " << prop->major << "." << prop->minor << "\n";
+  for (const char* arg : args) {
+    ss << arg << "\n";
+  }
+  ss << code;
+  // the source is hashed separately so that two kernels have to collide on
+  // both hashes to share an entry
+  std::stringstream key;
+  key << std::hex << c10::stable_hash(ss.str()) << "-"
+      << c10::stable_hash(code);
+  return key.str();
+}
+
+c10::optional<KernelBinary> loadKernelBinary(const std::string& key) {
+  auto entry = kernelBinaryCache().load(key);
+  if (!entry) {
+    return c10::nullopt;
+  }
+  // the version and the kernel name, each on a line, then the binary
+  const auto version_end = entry->find('\n');
+  const auto name_end = version_end == std::string::npos
+      ? std::string::npos
+      : entry->find('\n', version_end + 1);
+  if (name_end == std::string::npos || name_end == version_end + 1 ||
+      entry->compare(0, version_end, kCacheVersion) != 0) {
+    GRAPH_DEBUG("Ignoring unreadable kernel binary ", key);
+    return c10::nullopt;
+  }
+  KernelBinary kernel;
+  kernel.name = entry->substr(version_end + 1, name_end - version_end - 1);
+  kernel.binary.assign(entry->begin() + name_end + 1, entry->end());
+  if (kernel.binary.empty()) {
+    GRAPH_DEBUG("Ignoring empty kernel binary ", key);
+    return c10::nullopt;
+  }
+  GRAPH_DEBUG("Loaded kernel binary ", key);
+  return kernel;
+}
+
+bool storeKernelBinary(const std::string& key, const KernelBinary& kernel) {
+  std::string entry = std::string(kCacheVersion) + "\n" + kernel.name + "\n";
+  entry.append(kernel.binary.data(), kernel.binary.size());
+  if (!kernelBinaryCache().store(key, entry)) {
+    return false;
+  }
+  GRAPH_DEBUG("Stored kernel binary ", key);
+  return true;
+}
+
+} // namespace cuda
+} // namespace fuser
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <c10/util/Optional.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <string>
+#include <vector>
+
+namespace torch {
+namespace jit {
+namespace fuser {
+namespace cuda {
+
+// Note [Kernel binary cache]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Both the legacy CUDA fuser and nvFuser compile their generated kernels with
+// NVRTC when they are first run, in every process. When a cache directory is
+// set, the PTX or CUBIN produced by NVRTC is written to that directory, and a
+// later compilation of the same kernel, in this or any other process sharing
+// the directory, loads it instead of invoking NVRTC again. Loading the module
+// into the CUDA context is still done by every process.
+//
+// Entries are keyed by a hash of the kernel source, of the NVRTC options,
+// which include the target architecture, and of the NVRTC version, so an
+// entry is only used for the exact compilation it was produced by. An entry
+// that fails to load is ignored.
+//
+// Entries live in a DiskCache (see Note [On-disk caches]) whose directory is
+// read from PYTORCH_CUDA_FUSER_CACHE_DIR. An empty directory (the default)
+// disables the cache.
+
+struct KernelBinary {
+  // the name the kernel function is looked up by in the module
+  std::string name;
+  // the PTX or CUBIN returned by NVRTC
+  std::vector<char> binary;
+};
+
+TORCH_CUDA_CU_API void setKernelBinaryCacheDir(std::string dir);
+TORCH_CUDA_CU_API std::string getKernelBinaryCacheDir();
+
+// The cache key of code compiled with the NVRTC options args
+TORCH_CUDA_CU_API std::string kernelBinaryCacheKey(
+    const std::string& code,
+    const std::vector<const char*>& args);
+
+// Returns nullopt if there is no usable entry for key
+TORCH_CUDA_CU_API c10::optional<KernelBinary> loadKernelBinary(
+    const std::string& key);
+// Returns whether the binary was stored
+TORCH_CUDA_CU_API bool storeKernelBinary(
+    const std::string& key,
+    const KernelBinary& kernel);
+
+} // namespace cuda
+} // namespace fuser
+} // namespace jit
+} // namespace torch
@@ -2,6 +2,7 @@
 
 #include <ATen/ATen.h>
 #include <ATen/ExpandUtils.h>
+#include <ATen/core/Vitals.h>
 #include <ATen/core/functional.h>
 #include <ATen/core/stack.h>
 #include <c10/util/Optional.h>
@@ -383,6 +384,7 @@ bool runFusion(const int64_t key, Stack& stack, std::string* code_out) {
   ArgSpec arg_spec{inputs, device.index()};
   auto maybe_kernel = spec.findKernel(arg_spec);
   if (!maybe_kernel) {
+    TORCH_VITAL_COUNT("fuser.kernel_cache_misses", 1);
     const auto kernel = compileKernel(spec, arg_spec, *maybe_map_size, device);
     spec.cacheKernel(arg_spec, kernel);
   }
@@ -560,17 +560,21 @@ void AliasDb::analyzeImpl(Node* node) {
       makePointerTo(node->outputs().at(1), node->inputs().at(1));
       return;
     }
+    case prim::MKLDNNConcat:
+      return analyzeCreator(node);
     // TODO: think more about TensorExpr alias correctness
     case prim::TensorExprGroup:
     case prim::MKLDNNGroup:
     case prim::ConstantMKLDNNTensor:
     case prim::StaticSubgraph:
+    case prim::StaticTensorExprGroup:
     case prim::Constant:
     case prim::AutogradZero:
     case prim::AutogradAdd:
     case prim::FusedConcat:
     case prim::MMTreeReduce:
     case prim::MMBatchSide:
+    case prim::MMBatchLinear:
     case prim::BroadcastSizes:
     case prim::ChunkSizes:
     case prim::Closure:
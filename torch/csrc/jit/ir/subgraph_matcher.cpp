@@ -2,6 +2,7 @@
 #include <torch/csrc/jit/jit_log.h>
 #include <regex>
 #include <stack>
+#include <unordered_set>
 
 namespace torch {
 namespace jit {
@@ -12,7 +13,7 @@ namespace {
  */
 class SubgraphMatcher {
  public:
-  explicit SubgraphMatcher(const Graph& pattern) : pattern_(pattern) {}
+  explicit SubgraphMatcher(const Graph& pattern);
 
   /**
    * \brief Compare matchGraph with the part of the graph denoted by a node \p
@@ -40,16 +41,36 @@ class SubgraphMatcher {
   bool matchNodes(const Node* n1, Node* n2);
   bool matchAttributes(const Node* n1, Node* n2);
 
+  bool matchStringAttribute(const std::string& pattern, const std::string& s);
+
   static bool isInput(const Value* v);
-  static bool isOutput(const Value* v);
+  bool isOutput(const Value* v) const;
 
   std::unordered_map<const Node*, Node*> nodes_map_;
   std::unordered_map<const Value*, Value*> values_map_;
 
   const Graph& pattern_;
   const Node* anchor_ = nullptr;
+
+  // The node every match is anchored at, i.e. the producer of the main output.
+  // Anchors of a different kind are rejected without touching the maps above,
+  // which keeps a scan over a large graph cheap for patterns that are rare.
+  const Node* bottom_node_;
+  bool filter_anchors_by_kind_;
+  std::unordered_set<const Value*> pattern_outputs_;
+  // String attributes in patterns are regexes; compile each one only once.
+  std::unordered_map<std::string, std::regex> regex_cache_;
 };
 
+SubgraphMatcher::SubgraphMatcher(const Graph& pattern)
+    : pattern_(pattern),
+      bottom_node_((*pattern.nodes().end())->input(0)->node()),
+      pattern_outputs_(pattern.outputs().begin(), pattern.outputs().end()) {
+  // Param and match::module bottom nodes match nodes of other kinds.
+  filter_anchors_by_kind_ = bottom_node_->kind() != prim::Param &&
+      bottom_node_->kind() != Symbol::fromQualString("match::module");
+}
+
 /**
  * \brief A function to verify that \p PATTERN is valid. Concrete requirements
  * for validity can be found in subgraph_matcher.h.
@@ -70,13 +91,25 @@ bool SubgraphMatcher::isInput(const Value* v) {
   return v->node()->kind() == prim::Param;
 }
 
-bool SubgraphMatcher::isOutput(const Value* v) {
-  for (const Value* output : v->owningGraph()->outputs()) {
-    if (v == output) {
-      return true;
-    }
+bool SubgraphMatcher::isOutput(const Value* v) const {
+  return pattern_outputs_.count(v);
+}
+
+/**
+ * Match a string attribute of the graph against a (regex) string attribute of
+ * the pattern. Most patterns use plain names, which are compared directly.
+ */
+bool SubgraphMatcher::matchStringAttribute(
+    const std::string& pattern,
+    const std::string& s) {
+  if (pattern.find_first_of(".[]{}()*+?|^$\\") == std::string::npos) {
+    return pattern == s;
   }
-  return false;
+  auto it = regex_cache_.find(pattern);
+  if (it == regex_cache_.end()) {
+    it = regex_cache_.emplace(pattern, std::regex(pattern)).first;
+  }
+  return std::regex_match(s, it->second);
 }
 
 /**
@@ -143,7 +176,7 @@ bool SubgraphMatcher::matchAttributes(const Node* n1, Node* n2) {
     }
     switch (n1->kindOf(attr_name)) {
       case AttributeKind::s:
-        if (!std::regex_match(n2->s(attr_name), std::regex(n1->s(attr_name)))) {
+        if (!matchStringAttribute(n1->s(attr_name), n2->s(attr_name))) {
           GRAPH_DEBUG(
               "Nodes did not match because attribute '",
               attr_name.toQualString(),
@@ -315,15 +348,17 @@ bool SubgraphMatcher::matchNodes(const Node* n1, Node* n2) {
  * exiting node in the pattern and anchor node in the actual graph.
  */
 bool SubgraphMatcher::matchesSubgraphFromAnchorNode(Node* anchor) {
+  // matchNodes would reject such an anchor anyway, only later.
+  if (filter_anchors_by_kind_ && bottom_node_->kind() != anchor->kind()) {
+    return false;
+  }
+
   GRAPH_UPDATE("Starting match from a new anchor: ", *anchor);
   nodes_map_.clear();
   values_map_.clear();
   anchor_ = anchor;
 
-  const Node* bottom_node = *(pattern_.nodes().end());
-  bottom_node = bottom_node->input(0)->node();
-
-  if (!matchNodes(bottom_node, anchor)) {
+  if (!matchNodes(bottom_node_, anchor)) {
     return false;
   }
 
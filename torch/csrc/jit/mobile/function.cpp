@@ -6,11 +6,84 @@
 #include <torch/csrc/jit/runtime/operator.h>
 #include <torch/custom_class_detail.h>
 
+#ifdef TEMPLATE_SELECTIVE_BUILD
+#include <ATen/selected_mobile_ops.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
 namespace torch {
 namespace jit {
 
 char const* toString(OpCode op);
 namespace mobile {
+
+namespace {
+
+std::function<void(Stack&)> lookupOperator(const c10::OperatorName& opname) {
+  auto jit_op = findOperatorFor(opname);
+  if (jit_op) {
+    return [jit_op](Stack& stack) { jit_op->getOperation()(&stack); };
+  }
+  auto op = c10::Dispatcher::singleton().findSchema(opname);
+  if (op.has_value()) {
+    return [op](Stack& stack) { op->callBoxed(&stack); };
+  }
+  return nullptr;
+}
+
+#ifdef TORCH_SELECTED_MOBILE_OPERATOR_TABLE
+SelectedOperatorTable& selectedOperators() {
+  static SelectedOperatorTable table(kSelectedOperators);
+  return table;
+}
+#endif
+
+} // namespace
+
+// Note [Selected operator table]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// In a selective build, the root operators models may call are known when the
+// runtime is built, and gen_selected_mobile_ops_header.py emits them, sorted,
+// as kSelectedOperators. Each of them is looked up in the operator registry
+// and the dispatcher at most once per process, the first time a model calls
+// it, into a table indexed like kSelectedOperators. Loading a model then finds
+// its operators by binary search in that table instead of looking each of
+// them up again. Operators not in the table are looked up as usual.
+//
+// The table is never cleared: its entries hold the OperatorHandles (or the
+// registered Operators) they resolved to for the life of the process, so
+// the selected operators must stay registered as long as the runtime is in
+// use.
+SelectedOperatorTable::SelectedOperatorTable(c10::ArrayRef<const char*> names)
+    : names_(names), resolved_(names.size()) {}
+
+std::function<void(Stack&)> SelectedOperatorTable::lookup(
+    const c10::OperatorName& opname) {
+  std::string key = opname.name;
+  if (!opname.overload_name.empty()) {
+    key += "." + opname.overload_name;
+  }
+  auto it = std::lower_bound(
+      names_.begin(),
+      names_.end(),
+      key,
+      [](const char* a, const std::string& b) {
+        return std::strcmp(a, b.c_str()) < 0;
+      });
+  if (it == names_.end() || key != *it) {
+    return lookupOperator(opname);
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto& fn = resolved_[it - names_.begin()];
+  if (!fn) {
+    fn = lookupOperator(opname);
+  }
+  return fn;
+}
+
 Function::Function(c10::QualifiedName name)
     : name_(std::move(name)), code_(std::make_shared<Code>()) {}
 
@@ -34,23 +107,34 @@ bool Function::append_operator(
     const std::string& name,
     const std::string& overload_name,
     int64_t model_version) {
-  // Keep the original opname in code_
-  code_->op_names_.emplace_back(name, overload_name);
-  auto opname = code_->op_names_.back();
+  c10::OperatorName opname(name, overload_name);
+  auto fn = resolve_operator(opname, model_version);
+  if (!fn) {
+    // Keep the original opname in code_
+    code_->op_names_.emplace_back(std::move(opname));
+    return false;
+  }
+  append_operator(std::move(opname), std::move(*fn));
+  return true;
+}
 
-  const auto& opname_c10 = opname;
-  std::function<void(Stack&)> fn;
+void Function::append_operator(
+    c10::OperatorName opname,
+    std::function<void(Stack&)> fn) {
+  code_->op_names_.emplace_back(std::move(opname));
+  code_->operators_.emplace_back(std::move(fn));
+}
 
-  auto jit_op = findOperatorFor(opname);
-  if (jit_op) {
-    fn = [jit_op](Stack& stack) { jit_op->getOperation()(&stack); };
-  } else {
-    auto op = c10::Dispatcher::singleton().findSchema(opname_c10);
-    if (op.has_value()) {
-      fn = [op](Stack& stack) { op->callBoxed(&stack); };
-    } else {
-      return false;
-    }
+c10::optional<std::function<void(Stack&)>> Function::resolve_operator(
+    const c10::OperatorName& opname,
+    int64_t model_version) {
+#ifdef TORCH_SELECTED_MOBILE_OPERATOR_TABLE
+  std::function<void(Stack&)> fn = selectedOperators().lookup(opname);
+#else
+  std::function<void(Stack&)> fn = lookupOperator(opname);
+#endif
+  if (!fn) {
+    return c10::nullopt;
   }
 
   if (model_version == 0x3LL &&
@@ -65,9 +149,7 @@ bool Function::append_operator(
       fn(stack);
     };
   }
-
-  code_->operators_.emplace_back(fn);
-  return true;
+  return fn;
 }
 
 void Function::set_module_debug_info_list_size(size_t size) {
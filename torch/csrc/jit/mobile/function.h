@@ -2,6 +2,11 @@
 
 #include <ATen/core/function_schema.h>
 #include <ATen/core/ivalue.h>
+#include <ATen/core/operator_name.h>
+#include <c10/util/ArrayRef.h>
+#include <c10/util/Optional.h>
+#include <functional>
+#include <mutex>
 #include <vector>
 
 namespace torch {
@@ -24,6 +29,16 @@ class Function {
       const std::string& name,
       const std::string& overload_name,
       int64_t model_version);
+  // Appends an operator resolved by resolve_operator, so that an operator
+  // used by several functions is only looked up once
+  void append_operator(
+      c10::OperatorName opname,
+      std::function<void(Stack&)> fn);
+  // The function calling opname as it is called by models of model_version,
+  // nullopt if the operator is not registered
+  static c10::optional<std::function<void(Stack&)>> resolve_operator(
+      const c10::OperatorName& opname,
+      int64_t model_version);
   void set_module_debug_info_list_size(size_t size);
   void set_module_info(const std::string& module_info, size_t pc);
   void append_constant(const c10::IValue& constant);
@@ -44,6 +59,22 @@ class Function {
   std::vector<std::string> pc_to_module_debug_info_;
 };
 
+// Resolves the operators of a selective build at most once per process, see
+// Note [Selected operator table]
+class SelectedOperatorTable {
+ public:
+  // names are sorted and formatted as name[.overload_name]
+  explicit SelectedOperatorTable(c10::ArrayRef<const char*> names);
+  // The function calling opname, or nullptr if it is not registered.
+  // Operators that are not in names are looked up every time.
+  std::function<void(Stack&)> lookup(const c10::OperatorName& opname);
+
+ private:
+  c10::ArrayRef<const char*> names_;
+  std::mutex mutex_;
+  std::vector<std::function<void(Stack&)>> resolved_;
+};
+
 } // namespace mobile
 } // namespace jit
 } // namespace torch
@@ -144,12 +144,20 @@ class BytecodeDeserializer final {
   std::unordered_set<std::string> load_and_find_unsupported_operator_names(
       const std::vector<IValue>& ops_list,
       mobile::Function* function,
-      int64_t model_version) const;
+      int64_t model_version);
+  TypePtr parseType(const std::string& type_str);
   std::shared_ptr<CompilationUnit> compilation_unit_;
   std::unordered_set<std::string> imported_libs_;
   std::unique_ptr<PyTorchStreamReader> reader_{};
   c10::optional<at::Device> device_;
   uint64_t module_load_options_;
+  // Most operators and types are used by several methods of a model, they are
+  // only resolved and parsed the first time
+  std::unordered_map<
+      c10::OperatorName,
+      c10::optional<std::function<void(Stack&)>>>
+      resolved_operators_;
+  std::unordered_map<std::string, TypePtr> parsed_types_;
 };
 
 BytecodeDeserializer::BytecodeDeserializer(
@@ -163,7 +171,7 @@ std::unordered_set<std::string> BytecodeDeserializer::
     load_and_find_unsupported_operator_names(
         const std::vector<IValue>& ops_list,
         mobile::Function* function,
-        int64_t model_version) const {
+        int64_t model_version) {
   std::unordered_set<std::string> unsupported_op_names;
   // ops_list is the list of operator names that were read in from
   // bytecode.plk for the method that is currently being processed.
@@ -171,11 +179,22 @@ std::unordered_set<std::string> BytecodeDeserializer::
     auto op_item = op.toTuple()->elements();
     TORCH_CHECK(
         op_item.size() == 2, "There should be two parts in an operator name.");
-    auto op_found = function->append_operator(
-        op_item[0].toString()->string(),
-        op_item[1].toString()->string(),
-        model_version);
-    if (!op_found) {
+    c10::OperatorName opname(
+        op_item[0].toString()->string(), op_item[1].toString()->string());
+    auto it = resolved_operators_.find(opname);
+    if (it == resolved_operators_.end()) {
+      it = resolved_operators_
+               .emplace(
+                   opname,
+                   mobile::Function::resolve_operator(opname, model_version))
+               .first;
+    }
+    if (it->second) {
+      function->append_operator(std::move(opname), *it->second);
+    } else {
+      // records the name of the missing operator
+      function->append_operator(
+          opname.name, opname.overload_name, model_version);
       unsupported_op_names.emplace(operator_str(
           op_item[0].toString()->string(), op_item[1].toString()->string()));
     }
@@ -183,6 +202,14 @@ std::unordered_set<std::string> BytecodeDeserializer::
   return unsupported_op_names;
 }
 
+TypePtr BytecodeDeserializer::parseType(const std::string& type_str) {
+  auto it = parsed_types_.find(type_str);
+  if (it == parsed_types_.end()) {
+    it = parsed_types_.emplace(type_str, c10::parseType(type_str)).first;
+  }
+  return it->second;
+}
+
 TypePtr BytecodeDeserializer::resolveTypeName(const c10::QualifiedName& qn) {
   // HACK: first we check whether the name starts with special prefix to
   // tell if it's a supported pytorch class type. There are two special
@@ -200,7 +227,7 @@ TypePtr BytecodeDeserializer::resolveTypeName(const c10::QualifiedName& qn) {
     }
     return compilation_unit_->get_class(qn);
   } else {
-    return c10::parseType(qn.qualifiedName());
+    return parseType(qn.qualifiedName());
   }
 }
 
@@ -334,7 +361,7 @@ void BytecodeDeserializer::parseMethods(
             " cannot be found.");
         function->append_type(classType);
       } else {
-        function->append_type(c10::parseType(t.toStringRef()));
+        function->append_type(parseType(t.toStringRef()));
       }
     }
 
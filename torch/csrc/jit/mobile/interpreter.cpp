@@ -9,6 +9,13 @@
 #include <ATen/record_function.h>
 #include <torch/csrc/jit/mobile/observer.h>
 
+// See Note [Interpreter dispatch] in runtime/interpreter.cpp
+#if defined(__GNUC__) || defined(__clang__)
+#define TORCH_JIT_COMPUTED_GOTO 1
+#else
+#define TORCH_JIT_COMPUTED_GOTO 0
+#endif
+
 namespace torch {
 namespace jit {
 char const* toString(OpCode op);
@@ -43,8 +50,26 @@ using namespace at;
 
 bool InterpreterState::run(Stack& stack) {
   size_t pc = 0;
+  // See Note [Interpreter dispatch] in runtime/interpreter.cpp
+  Instruction inst(RET, 0, 0);
+#if TORCH_JIT_COMPUTED_GOTO
+  static const void* const dispatch_table[] = {
+#define DISPATCH_LABEL(op, _) &&label_##op,
+      FORALL_OPCODES(DISPATCH_LABEL)
+#undef DISPATCH_LABEL
+  };
+#define INST(op) label_##op
+#define DISPATCH()                      \
+  do {                                  \
+    inst = code_->instructions_[pc];    \
+    goto* dispatch_table[inst.op];      \
+  } while (false)
+#else
+#define INST(op) case op
+#define DISPATCH() break
+#endif
   while (true) {
-    Instruction inst = code_->instructions_[pc];
+    inst = code_->instructions_[pc];
 
     //    std::cout << "RUNNING " << pc << " " << code_->instructions_[pc];
     //    if (inst.op == OP) {
@@ -54,8 +79,13 @@ bool InterpreterState::run(Stack& stack) {
     //      }
     //    }
     //    std::cout << std::endl;
+#if TORCH_JIT_COMPUTED_GOTO
+    goto* dispatch_table[inst.op];
+    {
+#else
     switch (inst.op) {
-      case OP: {
+#endif
+      INST(OP): {
         if (at::hasGlobalCallbacks()) {
           if (auto* mobile_debug_info =
                   static_cast<MobileDebugInfo*>(c10::ThreadLocalDebugInfo::get(
@@ -77,13 +107,13 @@ bool InterpreterState::run(Stack& stack) {
         }
         code_->operators_[inst.X](stack);
         ++pc;
-      } break;
-      case OPN: {
+      } DISPATCH();
+      INST(OPN): {
         stack.push_back(inst.N);
         code_->operators_[inst.X](stack);
         ++pc;
-      } break;
-      case INTERFACE_CALL: {
+      } DISPATCH();
+      INST(INTERFACE_CALL): {
         torch::jit::Function& method =
             peek(stack, 0, inst.N)
                 .toObject()
@@ -91,44 +121,44 @@ bool InterpreterState::run(Stack& stack) {
                 ->getMethod(code_->constants_[inst.X].toStringRef());
         method.run(stack);
         ++pc;
-      } break;
-      case LOAD:
+      } DISPATCH();
+      INST(LOAD):
         stack.emplace_back(reg(inst.X));
         ++pc;
-        break;
-      case MOVE:
+        DISPATCH();
+      INST(MOVE):
         stack.emplace_back(std::move(reg(inst.X)));
         ++pc;
-        break;
-      case STORE:
+        DISPATCH();
+      INST(STORE):
         reg(inst.X) = pop(stack);
         ++pc;
-        break;
-      case STOREN:
+        DISPATCH();
+      INST(STOREN):
         for (size_t i = inst.N; i > 0; --i) {
           reg(inst.X + i - 1) = pop(stack);
         }
         ++pc;
-        break;
-      case DROP:
+        DISPATCH();
+      INST(DROP):
         pop(stack);
         ++pc;
-        break;
-      case DROPR:
+        DISPATCH();
+      INST(DROPR):
         reg(inst.X) = IValue();
         ++pc;
-        break;
-      case LOADC:
+        DISPATCH();
+      INST(LOADC):
         stack.emplace_back(code_->constants_[inst.X]);
         ++pc;
-        break;
-      case GET_ATTR: {
+        DISPATCH();
+      INST(GET_ATTR): {
         auto userObj = pop(stack).toObject();
         auto value = userObj->getSlot(inst.X);
         push(stack, std::move(value));
         ++pc;
-      } break;
-      case SET_ATTR: {
+      } DISPATCH();
+      INST(SET_ATTR): {
         auto v = pop(stack);
         auto userObj = pop(stack).toObject();
         // Mobile only: since the number of slots is not known, resize the
@@ -140,14 +170,14 @@ bool InterpreterState::run(Stack& stack) {
         }
         userObj->setSlot(inst.X, std::move(v));
         ++pc;
-      } break;
-      case JF:
+      } DISPATCH();
+      INST(JF):
         pc += (pop(stack).toBool()) ? 1 : inst.X;
-        break;
-      case JMP:
+        DISPATCH();
+      INST(JMP):
         pc += inst.X;
-        break;
-      case LOOP: {
+        DISPATCH();
+      INST(LOOP): {
         // stack: iteration_count, max_iter, cond, loop_carried_deps...
         auto frame = stack.end() - (inst.N + 1);
         int64_t trip_count = frame[0].toInt();
@@ -165,48 +195,48 @@ bool InterpreterState::run(Stack& stack) {
           drop(stack, 3); // iteration_count, max_iter, cond
           pc += inst.X;
         }
-      } break;
-      case RET:
+      } DISPATCH();
+      INST(RET):
         return false;
-      case LIST_CONSTRUCT: {
+      INST(LIST_CONSTRUCT): {
         const auto& type = code_->types_[inst.X]->expectRef<at::ListType>();
         listConstruct(stack, type, inst.N);
         ++pc;
-      } break;
-      case LIST_UNPACK: {
+      } DISPATCH();
+      INST(LIST_UNPACK): {
         listUnpack(stack, inst.X);
         ++pc;
-      } break;
-      case TUPLE_CONSTRUCT: {
+      } DISPATCH();
+      INST(TUPLE_CONSTRUCT): {
         tupleConstruct(stack, inst.X);
         ++pc;
-      } break;
-      case TUPLE_SLICE: {
+      } DISPATCH();
+      INST(TUPLE_SLICE): {
         tupleSlice(stack, inst.X, inst.X + inst.N);
         ++pc;
-      } break;
-      case DICT_CONSTRUCT: {
+      } DISPATCH();
+      INST(DICT_CONSTRUCT): {
         const auto& type = code_->types_[inst.X]->expectRef<at::DictType>();
         dictConstruct(stack, type, inst.N);
         ++pc;
-      } break;
-      case NAMED_TUPLE_CONSTRUCT: {
+      } DISPATCH();
+      INST(NAMED_TUPLE_CONSTRUCT): {
         namedTupleConstruct(
             stack, code_->types_[inst.X]->expect<at::TupleType>(), inst.N);
         ++pc;
-      } break;
-      case CREATE_OBJECT: {
+      } DISPATCH();
+      INST(CREATE_OBJECT): {
         auto type = code_->types_[inst.X]->expect<c10::ClassType>();
         createObject(stack, type);
         ++pc;
-      } break;
-      case ISINSTANCE: {
+      } DISPATCH();
+      INST(ISINSTANCE): {
         at::ArrayRef<TypePtr> types(
             &(code_->types_[inst.X]), &(code_->types_[inst.X + inst.N]));
         isinstance(stack, types);
         ++pc;
-      } break;
-      case WARN: {
+      } DISPATCH();
+      INST(WARN): {
         drop(stack, 1);
         // Note: Please don't move the pop(stack) code below into the TORCH_WARN
         // macro since TORCH_WARN fails to evaluate its arguments when
@@ -217,8 +247,23 @@ bool InterpreterState::run(Stack& stack) {
         TORCH_WARN(sref);
         stack.pop_back();
         ++pc;
-      } break;
-      default:
+      } DISPATCH();
+      // rejected by Function::append_instruction, see isOpSupportedInMobile
+      INST(WAIT):
+      INST(CALL):
+      INST(GUARD):
+      INST(TYPECHECK):
+      INST(FAIL_GUARD):
+      INST(PROFILE_OP):
+      INST(TAIL_CALL):
+      INST(FORK):
+      INST(ENTER):
+      INST(EXIT):
+      INST(PUSH_OP):
+      INST(PUSH_OP_STORE):
+      INST(OP_STORE):
+      INST(REG_OP):
+      INST(REG_OP_STORE):
         AT_ERROR(toString(inst.op), " is invalid.");
     }
     //  for (auto val : stack) {
@@ -229,6 +274,8 @@ bool InterpreterState::run(Stack& stack) {
     //    }
     //  }
   }
+#undef INST
+#undef DISPATCH
   return false;
 }
 
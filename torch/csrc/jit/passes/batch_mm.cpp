@@ -11,6 +11,8 @@
 
 #include <ATen/ATen.h>
 #include <algorithm>
+#include <array>
+#include <map>
 #include <unordered_map>
 
 namespace torch {
@@ -361,31 +363,47 @@ RegisterOperators mm_batch_side_reg({Operator(
     },
     aliasAnalysisIsSpecialCase())});
 
-std::pair<std::vector<Node*>, std::vector<Node*>> gatherIndependentMMUses(
-    Value* value,
+// Sorts mms topologically and drops the ones that depend on an earlier one.
+std::vector<Node*> filterIndependentNodes(
+    std::vector<Node*> mms,
     AliasDb& alias_db) {
-  const auto postprocess = [&](std::vector<Node*> mms) {
-    if (mms.size() == 0) {
-      return mms;
-    }
-    std::sort(mms.begin(), mms.end(), [](Node* n, Node* m) {
-      return n->isBefore(m);
-    });
-    // Filter out dependent MMs. This algorithm might do very badly if e.g. you
-    // have a lot of independent MMs, that depend on the first one, but I doubt
-    // this will be a common scenario.
-    for (size_t i = 0; i < mms.size(); ++i) {
-      if (mms[i] == nullptr)
+  if (mms.size() == 0) {
+    return mms;
+  }
+  std::sort(mms.begin(), mms.end(), [](Node* n, Node* m) {
+    return n->isBefore(m);
+  });
+  // Filter out dependent MMs. This algorithm might do very badly if e.g. you
+  // have a lot of independent MMs, that depend on the first one, but I doubt
+  // this will be a common scenario.
+  for (size_t i = 0; i < mms.size(); ++i) {
+    if (mms[i] == nullptr)
+      continue;
+    for (size_t j = i + 1; j < mms.size(); ++j) {
+      if (mms[j] == nullptr)
         continue;
-      for (size_t j = i + 1; j < mms.size(); ++j) {
-        if (mms[j] == nullptr)
-          continue;
-        if (!alias_db.couldMoveBeforeTopologically(mms[j], mms[i])) {
-          mms[j] = nullptr;
-        }
+      if (!alias_db.couldMoveBeforeTopologically(mms[j], mms[i])) {
+        mms[j] = nullptr;
       }
     }
-    return c10::filter(mms, [](Node* n) { return n != nullptr; });
+  }
+  return c10::filter(mms, [](Node* n) { return n != nullptr; });
+}
+
+// Moves the independent nodes in `mms` (see filterIndependentNodes) next to
+// each other, so a single node replacing them can be inserted before mms[0].
+void moveNodesTogether(const std::vector<Node*>& mms, AliasDb& alias_db) {
+  for (int64_t i = static_cast<int64_t>(mms.size()) - 2; i >= 0; --i) {
+    bool move_ok = alias_db.moveBeforeTopologicallyValid(mms[i], mms[i + 1]);
+    AT_ASSERT(move_ok);
+  }
+}
+
+std::pair<std::vector<Node*>, std::vector<Node*>> gatherIndependentMMUses(
+    Value* value,
+    AliasDb& alias_db) {
+  const auto postprocess = [&](std::vector<Node*> mms) {
+    return filterIndependentNodes(std::move(mms), alias_db);
   };
 
   Block* block = value->node()->owningBlock();
@@ -409,10 +427,7 @@ void BatchMMSide(Block* block, AliasDb& alias_db) {
   static constexpr size_t how_many_is_many = 8;
   const auto batch_side = [&](std::vector<Node*>& mms, Side side) {
     AT_ASSERT(!mms.empty());
-    for (int64_t i = static_cast<int64_t>(mms.size()) - 2; i >= 0; --i) {
-      bool move_ok = alias_db.moveBeforeTopologicallyValid(mms[i], mms[i + 1]);
-      AT_ASSERT(move_ok);
-    }
+    moveNodesTogether(mms, alias_db);
     WithInsertPoint insert_guard{mms[0]};
     Graph* graph = mms[0]->owningGraph();
     Node* batch_mm = graph->create(
@@ -452,6 +467,196 @@ void BatchMMSide(Block* block, AliasDb& alias_db) {
   }
 }
 
+// Independent linears
+//
+// Models with many small fully connected layers (e.g. the wide part of
+// DeepAndWide) end up with independent linear/addmm ops that all have the
+// same shapes, but different inputs and weights. They can run as a single
+// baddbmm on the stacked operands:
+//
+//   out_i = b_i + x_i @ W_i   for i in 0..k  ==>  out = baddbmm(B, X, W)
+//
+// where X, W and B stack the x_i, W_i and broadcasted b_i along a new
+// leading dim. The outputs are the slices of out along that dim, so they
+// never overlap and are contiguous.
+
+bool shape_is_fast_for_batch(const at::Tensor& weight) {
+  // The weights are stacked on every call, which only pays off for small ones
+  return weight.numel() <= 256 * 256;
+}
+
+bool have_same_dtype_and_device(at::TensorList inputs) {
+  return std::all_of(inputs.begin(), inputs.end(), [&](const at::Tensor& t) {
+    return t.scalar_type() == inputs[0].scalar_type() &&
+        t.device() == inputs[0].device();
+  });
+}
+
+RegisterOperators mm_batch_linear_reg({Operator(
+    prim::MMBatchLinear,
+    [](const Node* node) -> Operation {
+      size_t num_linears = node->outputs().size();
+      // addmm takes its rhs as is, linear takes it transposed
+      std::vector<int64_t> is_addmm = node->is(Symbol::attr("addmm"));
+      return [num_linears, is_addmm](Stack* stack) {
+        std::vector<at::Tensor> inputs, weights, rhses, biases;
+        inputs.reserve(num_linears);
+        weights.reserve(num_linears);
+        rhses.reserve(num_linears);
+        biases.reserve(num_linears);
+        bool any_bias = false;
+        bool all_bias = true;
+        auto args = last(stack, 3 * num_linears);
+        for (size_t i = 0; i < num_linears; ++i) {
+          inputs.push_back(args[3 * i].toTensor());
+          weights.push_back(args[3 * i + 1].toTensor());
+          rhses.push_back(
+              is_addmm[i] ? weights.back() : weights.back().t());
+          const IValue& bias = args[3 * i + 2];
+          biases.push_back(bias.isNone() ? at::Tensor() : bias.toTensor());
+          any_bias |= biases.back().defined();
+          all_bias &= biases.back().defined();
+        }
+        drop(stack, 3 * num_linears);
+
+        bool can_batch = any_bias == all_bias && inputs[0].dim() == 2 &&
+            rhses[0].dim() == 2 && have_same_shape(inputs) &&
+            have_same_shape(rhses) && have_same_dtype_and_device(inputs) &&
+            have_same_dtype_and_device(rhses) &&
+            shape_is_fast_for_batch(rhses[0]);
+        if (can_batch && all_bias) {
+          can_batch =
+              have_same_shape(biases) && have_same_dtype_and_device(biases);
+        }
+        if (can_batch) {
+          auto x = at::stack(inputs);
+          auto w = at::stack(rhses);
+          at::Tensor out;
+          if (all_bias) {
+            std::vector<int64_t> out_sizes{
+                inputs[0].size(0), rhses[0].size(1)};
+            auto b = at::stack(fmap(biases, [&](const at::Tensor& bias) {
+              return bias.expand(out_sizes);
+            }));
+            out = at::baddbmm(b, x, w);
+          } else {
+            out = at::bmm(x, w);
+          }
+          auto outputs = out.unbind(0);
+          stack->insert(
+              stack->end(),
+              std::make_move_iterator(outputs.begin()),
+              std::make_move_iterator(outputs.end()));
+        } else {
+          for (size_t i = 0; i < num_linears; ++i) {
+            if (is_addmm[i]) {
+              stack->emplace_back(at::addmm(biases[i], inputs[i], weights[i]));
+            } else {
+              stack->emplace_back(at::linear(inputs[i], weights[i], biases[i]));
+            }
+          }
+        }
+      };
+    },
+    aliasAnalysisIsSpecialCase())});
+
+bool isBatchableAddmm(Node* node) {
+  if (!node->matches(
+          "aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta=1, Scalar alpha=1) -> Tensor")) {
+    return false;
+  }
+  for (Value* v : {node->namedInput("beta"), node->namedInput("alpha")}) {
+    auto scalar = toIValue(v);
+    if (!scalar || !scalar->isScalar() || scalar->toScalar().toDouble() != 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the operands of a batchable linear/addmm as (input, weight, bias).
+c10::optional<std::array<Value*, 3>> batchableLinearOperands(Node* node) {
+  if (node->matches(
+          "aten::linear(Tensor input, Tensor weight, Tensor? bias=None) -> Tensor")) {
+    return std::array<Value*, 3>{
+        node->inputs()[0], node->inputs()[1], node->inputs()[2]};
+  }
+  if (isBatchableAddmm(node)) {
+    return std::array<Value*, 3>{
+        node->inputs()[1], node->inputs()[2], node->inputs()[0]};
+  }
+  return c10::nullopt;
+}
+
+// Only linears whose shapes are known (e.g. after profiling) to be the same
+// are grouped, so that the runtime shape check is unlikely to fail.
+c10::optional<std::vector<int64_t>> batchKey(Node* node) {
+  auto operands = batchableLinearOperands(node);
+  if (!operands) {
+    return c10::nullopt;
+  }
+  std::vector<int64_t> key{node->kind() == aten::addmm};
+  for (size_t i = 0; i < 3; ++i) {
+    Value* v = (*operands)[i];
+    if (i == 2 && v->type()->isSubtypeOf(NoneType::get())) {
+      key.push_back(-1);
+      continue;
+    }
+    auto type = v->type()->cast<TensorType>();
+    if (!type || !type->scalarType() || !type->device()) {
+      return c10::nullopt;
+    }
+    auto sizes = type->sizes().concrete_sizes();
+    if (!sizes || (i < 2 && sizes->size() != 2)) {
+      return c10::nullopt;
+    }
+    key.push_back(static_cast<int64_t>(*type->scalarType()));
+    key.push_back(type->device()->is_cuda());
+    key.push_back(sizes->size());
+    key.insert(key.end(), sizes->begin(), sizes->end());
+  }
+  return key;
+}
+
+void BatchIndependentLinears(Block* block, AliasDb& alias_db) {
+  static constexpr size_t min_batch_size = 2;
+  std::map<std::vector<int64_t>, std::vector<Node*>> groups;
+  for (Node* node : block->nodes()) {
+    if (auto key = batchKey(node)) {
+      groups[*key].push_back(node);
+    } else {
+      for (Block* subblock : node->blocks()) {
+        BatchIndependentLinears(subblock, alias_db);
+      }
+    }
+  }
+
+  for (auto& item : groups) {
+    auto linears = filterIndependentNodes(std::move(item.second), alias_db);
+    if (linears.size() < min_batch_size) {
+      continue;
+    }
+    moveNodesTogether(linears, alias_db);
+    WithInsertPoint insert_guard{linears[0]};
+    Graph* graph = linears[0]->owningGraph();
+    Node* batch_linear = graph->create(
+        prim::MMBatchLinear,
+        /*inputs=*/{},
+        /*num_outputs=*/linears.size());
+    graph->insertNode(batch_linear);
+    std::vector<int64_t> is_addmm;
+    for (size_t i = 0; i < linears.size(); ++i) {
+      is_addmm.push_back(linears[i]->kind() == aten::addmm);
+      for (Value* operand : *batchableLinearOperands(linears[i])) {
+        batch_linear->addInput(operand);
+      }
+      batch_linear->outputs().at(i)->setType(linears[i]->output()->type());
+      linears[i]->output()->replaceAllUsesWith(batch_linear->outputs().at(i));
+    }
+    batch_linear->is_(Symbol::attr("addmm"), std::move(is_addmm));
+  }
+}
+
 bool hasMutableOperators(Block* block) {
   for (auto n : block->nodes()) {
     if (n->kind().is_aten() && n->schema().is_mutable())
@@ -473,6 +678,12 @@ void BatchMM(std::shared_ptr<Graph>& graph) {
   BatchMMTreeReduce(graph->block());
   BatchMMSide(graph->block(), alias_db);
   EliminateDeadCode(graph);
+  {
+    // The passes above added nodes the first AliasDb doesn't know about
+    AliasDb linear_alias_db(graph);
+    BatchIndependentLinears(graph->block(), linear_alias_db);
+    EliminateDeadCode(graph);
+  }
   // It's possible that transpose rearrangements have created sequences of
   // consecutive transposes that didn't exist before.
 
@@ -2,6 +2,7 @@
 #include <torch/csrc/jit/ir/ir_views.h>
 #include <torch/csrc/jit/passes/frozen_conv_folding.h>
 #include <torch/csrc/jit/passes/frozen_graph_optimizations.h>
+#include <torch/csrc/jit/passes/frozen_linear_folding.h>
 #include <torch/csrc/jit/passes/remove_dropout.h>
 #include <torch/csrc/jit/runtime/graph_executor.h>
 #include <torch/csrc/utils/memory.h>
@@ -15,11 +16,17 @@ void OptimizeFrozenGraph(
   removeDropout(graph);
   // run a couple times to capture Conv -> Mul -> Add etc
   if (optimize_numerics) {
+    ConvertFrozenMatmulToLinear(graph);
     for (size_t i = 0; i < 2; i++) {
       FoldFrozenConvBatchnorm(graph);
       FoldFrozenConvAddOrSub(graph);
       FoldFrozenConvMulOrDiv(graph);
+      FoldFrozenLinearBatchnorm(graph);
+      FoldFrozenLinearAddOrSub(graph);
+      FoldFrozenLinearMulOrDiv(graph);
     }
+    // after folding, so each merged linear already carries its epilogue
+    MergeFrozenParallelLinears(graph);
   }
 }
 
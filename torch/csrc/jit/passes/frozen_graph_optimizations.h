@@ -8,6 +8,11 @@
  * - FoldFrozenConvBatchnorm
  * - FoldFrozenConvAddOrSub
  * - FoldFrozenConvMulOrDiv
+ * - ConvertFrozenMatmulToLinear
+ * - FoldFrozenLinearBatchnorm
+ * - FoldFrozenLinearAddOrSub
+ * - FoldFrozenLinearMulOrDiv
+ * - MergeFrozenParallelLinears
  */
 
 namespace torch {
@@ -0,0 +1,503 @@
+#include <ATen/Utils.h>
+#include <c10/core/ScalarType.h>
+#include <c10/util/Exception.h>
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/constant_propagation.h>
+#include <torch/csrc/jit/passes/dead_code_elimination.h>
+#include <torch/csrc/jit/passes/frozen_linear_folding.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+using Tensor = at::Tensor;
+
+bool nonConstantParameters(Node* n) {
+  for (size_t i = 1; i < n->inputs().size(); i++) {
+    if (n->inputs().at(i)->node()->kind() != prim::Constant) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool supportedLinearNode(Node* n) {
+  if (n->kind() != aten::linear || nonConstantParameters(n)) {
+    return false;
+  }
+  auto weight = constant_as<Tensor>(n->namedInput("weight"));
+  return weight && weight->dim() == 2 && weight->is_floating_point();
+}
+
+// The rank of the linear output, if the graph records it. The output has
+// the same rank as the input.
+c10::optional<int64_t> linearOutputDim(Node* linear) {
+  for (Value* v : {linear->output(), linear->namedInput("input")}) {
+    if (auto type = v->type()->cast<TensorType>()) {
+      if (auto dim = type->dim()) {
+        return static_cast<int64_t>(*dim);
+      }
+    }
+  }
+  return c10::nullopt;
+}
+
+Tensor linearBias(Node* linear, const Tensor& weight) {
+  if (linear->namedInput("bias")->type() == NoneType::get()) {
+    return at::zeros({weight.size(0)}, weight.options());
+  }
+  return constant_as<Tensor>(linear->namedInput("bias")).value();
+}
+
+void ConvertFrozenMatmulToLinear(Block* b) {
+  for (Node* n : b->nodes()) {
+    for (Block* block : n->blocks()) {
+      ConvertFrozenMatmulToLinear(block);
+    }
+
+    if (!n->matches("aten::matmul(Tensor self, Tensor other) -> Tensor")) {
+      continue;
+    }
+    auto other = constant_as<Tensor>(n->namedInput("other"));
+    if (!other || other->dim() != 2 || !other->is_floating_point()) {
+      continue;
+    }
+    // matmul(x, W) == linear(x, W^T) for any x with at least one dim
+    auto graph = b->owningGraph();
+    WithInsertPoint guard(n);
+    auto weight = graph->insertConstant(other->t().contiguous());
+    weight->setDebugName(n->namedInput("other")->debugName() + "_t");
+    auto none = graph->insertConstant(IValue());
+    auto linear =
+        graph->create(aten::linear, {n->namedInput("self"), weight, none});
+    linear->output()->setType(n->output()->type());
+    graph->insertNode(linear);
+    GRAPH_UPDATE("Replacing ", *n, " with ", *linear);
+    n->output()->replaceAllUsesWith(linear->output());
+    // DCE run after cleans up nodes
+  }
+}
+
+void FoldFrozenLinearBatchnorm(Block* b) {
+  for (Node* n : b->nodes()) {
+    for (Block* block : n->blocks()) {
+      FoldFrozenLinearBatchnorm(block);
+    }
+
+    if (n->kind() != aten::batch_norm ||
+        !supportedLinearNode(n->inputs().at(0)->node())) {
+      continue;
+    }
+    auto linear = n->inputs().at(0)->node();
+    auto bn = n;
+    if (nonConstantParameters(bn) ||
+        constant_as<bool>(bn->namedInput("training")).value_or(true)) {
+      continue;
+    }
+    if (linear->output()->uses().size() > 1) {
+      continue;
+    }
+    // batchnorm normalizes dim 1, which is the feature dim of the linear
+    // output only for 2-d outputs
+    if (linearOutputDim(linear) != c10::optional<int64_t>(2)) {
+      continue;
+    }
+
+    auto bn_rm = constant_as<Tensor>(bn->namedInput("running_mean")).value();
+    auto bn_rv = constant_as<Tensor>(bn->namedInput("running_var")).value();
+    auto bn_eps = constant_as<double>(bn->namedInput("eps")).value();
+    auto linear_w = constant_as<Tensor>(linear->namedInput("weight")).value();
+    if (bn_rm.dim() != 1 || bn_rm.size(0) != linear_w.size(0) ||
+        bn_rm.scalar_type() != linear_w.scalar_type()) {
+      continue;
+    }
+    auto linear_b = linearBias(linear, linear_w);
+    Tensor bn_w;
+    if (bn->namedInput("weight")->type() == NoneType::get()) {
+      bn_w = at::ones_like(bn_rm);
+    } else {
+      bn_w = constant_as<Tensor>(bn->namedInput("weight")).value();
+    }
+    Tensor bn_b;
+    if (bn->namedInput("bias")->type() == NoneType::get()) {
+      bn_b = at::zeros_like(bn_rm);
+    } else {
+      bn_b = constant_as<Tensor>(bn->namedInput("bias")).value();
+    }
+
+    auto scale = bn_w * at::rsqrt(bn_rv + bn_eps);
+    auto fused_w = linear_w * scale.unsqueeze(1);
+    auto fused_b = (linear_b - bn_rm) * scale + bn_b;
+
+    WithInsertPoint guard(linear);
+    auto graph = b->owningGraph();
+    auto fused_linear_w = graph->insertConstant(fused_w);
+    auto fused_linear_b = graph->insertConstant(fused_b);
+    auto linear_w_value = linear->namedInput("weight");
+    auto linear_b_value = linear->namedInput("bias");
+
+    fused_linear_w->setDebugName(linear_w_value->debugName() + "_fused_bn");
+    fused_linear_b->setDebugName(linear_b_value->debugName() + "_fused_bn");
+
+    linear->replaceInputWith(linear_w_value, fused_linear_w);
+    linear->replaceInputWith(linear_b_value, fused_linear_b);
+
+    bn->output()->replaceAllUsesWith(linear->output());
+    // DCE run after cleans up nodes
+  }
+}
+
+bool supportedAddOrSub(Node* n) {
+  static const OperatorSet add_set{
+      "aten::add.Tensor(Tensor self, Tensor other, *, Scalar alpha=1) -> Tensor",
+      "aten::add.Scalar(Tensor self, Scalar other, Scalar alpha=1) -> Tensor",
+      // sub is equivalent to add
+      "aten::sub.Tensor(Tensor self, Tensor other, *, Scalar alpha=1) -> Tensor",
+      "aten::sub.Scalar(Tensor self, Scalar other, Scalar alpha=1) -> Tensor",
+  };
+  return n->isMemberOf(add_set);
+}
+
+bool supportedMulOrDiv(Node* n) {
+  static const OperatorSet mul_set{
+      "aten::mul.Tensor(Tensor self, Tensor other) -> Tensor",
+      "aten::mul.Scalar(Tensor self, Scalar other) -> Tensor",
+      // div is equivalent to mul
+      "aten::div.Tensor(Tensor self, Tensor other) -> Tensor",
+      "aten::div.Scalar(Tensor self, Scalar other) -> Tensor",
+  };
+  return n->isMemberOf(mul_set);
+}
+
+// Like the conv case (see opDoesNotBroadCastWithConv), the constant operand
+// can only be folded if it broadcasts to both the weight and the linear
+// output without changing the output shape: every dim must be 1 except the
+// last, which may be out-features. Without a known output rank it also must
+// not have more than one dim.
+bool opDoesNotBroadCastWithLinear(
+    const Tensor& op_tensor,
+    const Tensor& weight_tensor,
+    c10::optional<int64_t> output_dim) {
+  if (op_tensor.dim() > output_dim.value_or(1)) {
+    return false;
+  }
+  for (int64_t i = 0; i < op_tensor.dim() - 1; i++) {
+    if (op_tensor.size(i) != 1) {
+      return false;
+    }
+  }
+  return op_tensor.dim() == 0 || op_tensor.size(-1) == 1 ||
+      op_tensor.size(-1) == weight_tensor.size(0);
+}
+
+bool checkLinearAndBroadcastingOpPreConditions(Node* linear, Node* op) {
+  if (nonConstantParameters(op)) {
+    return false;
+  }
+  if (linear->output()->uses().size() > 1) {
+    return false;
+  }
+
+  Tensor weight_tensor =
+      constant_as<Tensor>(linear->namedInput("weight")).value();
+  if (op->inputs().at(1)->type()->cast<TensorType>()) {
+    auto op_tensor = constant_as<Tensor>(op->inputs().at(1)).value();
+    if (!opDoesNotBroadCastWithLinear(
+            op_tensor, weight_tensor, linearOutputDim(linear))) {
+      return false;
+    }
+    // avoid fusing op that causes type promotion
+    if (!op_tensor.is_floating_point() ||
+        c10::promoteTypes(
+            op_tensor.scalar_type(), weight_tensor.scalar_type()) !=
+            weight_tensor.scalar_type()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Tensor resizeConstantScalarOrTensorToShape(
+    Value* v,
+    const std::vector<int64_t>& shape,
+    at::TensorOptions options) {
+  Tensor ret_tensor;
+  if (v->type()->cast<TensorType>()) {
+    ret_tensor = constant_as<Tensor>(v).value();
+  } else {
+    ret_tensor = at::zeros(shape, options);
+    if (v->type()->cast<IntType>()) {
+      ret_tensor.fill_(constant_as<int64_t>(v).value());
+    } else {
+      ret_tensor.fill_(constant_as<double>(v).value());
+    }
+  }
+
+  if (ret_tensor.numel() == 1) {
+    ret_tensor = ret_tensor.reshape({1});
+    std::vector<int64_t> expand_shape(shape.size(), 1);
+    expand_shape[0] = -1;
+    ret_tensor = ret_tensor.reshape(expand_shape).expand(shape);
+  } else {
+    ret_tensor = ret_tensor.reshape(shape);
+  }
+  return ret_tensor;
+}
+
+// Runs `op` with `lhs` and `rhs` substituted for its two tensor operands and
+// returns the result.
+Tensor runOpOnConstants(Node* op, const Tensor& lhs, const Tensor& rhs) {
+  auto graph = op->owningGraph();
+  op->replaceInput(0, graph->insertConstant(lhs));
+  op->replaceInput(1, graph->insertConstant(rhs));
+  auto stack_out = runNodeIfInputsAreConstant(op);
+  TORCH_INTERNAL_ASSERT(stack_out && stack_out->size() == 1);
+  return (*stack_out)[0].toTensor();
+}
+
+void FoldFrozenLinearAddOrSub(Block* b) {
+  for (Node* n : b->nodes()) {
+    for (Block* block : n->blocks()) {
+      FoldFrozenLinearAddOrSub(block);
+    }
+
+    if (!supportedAddOrSub(n) ||
+        !supportedLinearNode(n->inputs().at(0)->node())) {
+      continue;
+    }
+    auto linear = n->inputs().at(0)->node();
+    auto add_or_sub = n;
+    if (!checkLinearAndBroadcastingOpPreConditions(linear, add_or_sub)) {
+      continue;
+    }
+
+    Tensor weight_tensor =
+        constant_as<Tensor>(linear->namedInput("weight")).value();
+    Tensor add_or_sub_tensor = resizeConstantScalarOrTensorToShape(
+        add_or_sub->inputs().at(1),
+        {weight_tensor.size(0)},
+        weight_tensor.options());
+    Tensor bias = linearBias(linear, weight_tensor);
+
+    WithInsertPoint guard(linear);
+    Tensor fuse_bias = runOpOnConstants(add_or_sub, bias, add_or_sub_tensor);
+
+    auto fused_linear_b = b->owningGraph()->insertConstant(fuse_bias);
+    auto linear_b_value = linear->namedInput("bias");
+    fused_linear_b->setDebugName(
+        linear_b_value->debugName() + "_fused_" +
+        add_or_sub->kind().toUnqualString());
+    linear->replaceInputWith(linear_b_value, fused_linear_b);
+    add_or_sub->output()->replaceAllUsesWith(linear->output());
+    // DCE run after cleans up nodes
+  }
+}
+
+void FoldFrozenLinearMulOrDiv(Block* b) {
+  for (Node* n : b->nodes()) {
+    for (Block* block : n->blocks()) {
+      FoldFrozenLinearMulOrDiv(block);
+    }
+
+    if (!supportedMulOrDiv(n) ||
+        !supportedLinearNode(n->inputs().at(0)->node())) {
+      continue;
+    }
+    auto linear = n->inputs().at(0)->node();
+    auto mul_or_div = n;
+    if (!checkLinearAndBroadcastingOpPreConditions(linear, mul_or_div)) {
+      continue;
+    }
+
+    Tensor weight_tensor =
+        constant_as<Tensor>(linear->namedInput("weight")).value();
+    int64_t out_features = weight_tensor.size(0);
+    Value* op_value = mul_or_div->inputs().at(1);
+    bool has_bias = linear->namedInput("bias")->type() != NoneType::get();
+    Tensor bias = linearBias(linear, weight_tensor);
+
+    WithInsertPoint guard(linear);
+    auto graph = b->owningGraph();
+
+    // each output feature is scaled, i.e. each row of the weight
+    Tensor fuse_weight = runOpOnConstants(
+        mul_or_div,
+        weight_tensor,
+        resizeConstantScalarOrTensorToShape(
+            op_value, {out_features, 1}, weight_tensor.options()));
+    auto fused_linear_w = graph->insertConstant(fuse_weight);
+    auto linear_w_value = linear->namedInput("weight");
+    fused_linear_w->setDebugName(
+        linear_w_value->debugName() + "_fused_" +
+        mul_or_div->kind().toUnqualString());
+    linear->replaceInputWith(linear_w_value, fused_linear_w);
+
+    if (has_bias) {
+      Tensor fuse_bias = runOpOnConstants(
+          mul_or_div,
+          bias,
+          resizeConstantScalarOrTensorToShape(
+              op_value, {out_features}, bias.options()));
+      auto fused_linear_b = graph->insertConstant(fuse_bias);
+      auto linear_b_value = linear->namedInput("bias");
+      fused_linear_b->setDebugName(
+          linear_b_value->debugName() + "_fused_" +
+          mul_or_div->kind().toUnqualString());
+      linear->replaceInputWith(linear_b_value, fused_linear_b);
+    }
+    mul_or_div->output()->replaceAllUsesWith(linear->output());
+    // DCE run after cleans up nodes
+  }
+}
+
+// Collects, per block, the groups of mergeable linears that read the same
+// input, in program order.
+void collectParallelLinears(
+    Block* b,
+    std::vector<std::vector<Node*>>& groups) {
+  std::unordered_map<Value*, size_t> group_index;
+  std::vector<std::vector<Node*>> block_groups;
+  for (Node* n : b->nodes()) {
+    for (Block* block : n->blocks()) {
+      collectParallelLinears(block, groups);
+    }
+    if (!supportedLinearNode(n)) {
+      continue;
+    }
+    auto bias_value = n->namedInput("bias");
+    if (bias_value->type() != NoneType::get() &&
+        constant_as<Tensor>(bias_value)->dim() != 1) {
+      continue;
+    }
+    Value* input = n->namedInput("input");
+    auto it = group_index.find(input);
+    if (it == group_index.end()) {
+      group_index.emplace(input, block_groups.size());
+      block_groups.push_back({n});
+    } else {
+      block_groups[it->second].push_back(n);
+    }
+  }
+  for (auto& group : block_groups) {
+    if (group.size() > 1) {
+      groups.push_back(std::move(group));
+    }
+  }
+}
+
+// Merges `group`, a list of linears on the same input, into one linear with
+// the weights concatenated along out-features. Each original output becomes
+// a contiguous slice of the merged output, so downstream ops that need
+// contiguous inputs (e.g. view for attention heads) keep working.
+void mergeParallelLinears(const std::vector<Node*>& group) {
+  auto graph = group[0]->owningGraph();
+  std::vector<Tensor> weights;
+  std::vector<Tensor> biases;
+  bool any_bias = false;
+  for (Node* linear : group) {
+    auto weight = constant_as<Tensor>(linear->namedInput("weight")).value();
+    weights.push_back(weight);
+    biases.push_back(linearBias(linear, weight));
+    any_bias |= linear->namedInput("bias")->type() != NoneType::get();
+  }
+
+  WithInsertPoint guard(group[0]);
+  auto merged_w = graph->insertConstant(at::cat(weights, 0));
+  merged_w->setDebugName(
+      group[0]->namedInput("weight")->debugName() + "_merged");
+  auto merged_b = any_bias ? graph->insertConstant(at::cat(biases, 0))
+                           : graph->insertConstant(IValue());
+  auto merged = graph->create(
+      aten::linear, {group[0]->namedInput("input"), merged_w, merged_b});
+  merged->output()->setType(unshapedType(group[0]->output()->type()));
+  graph->insertNode(merged);
+  GRAPH_UPDATE("Merging ", group.size(), " linears into ", *merged);
+
+  int64_t offset = 0;
+  for (size_t i = 0; i < group.size(); i++) {
+    int64_t out_features = weights[i].size(0);
+    auto slice = graph->insert(
+        aten::narrow, {merged->output(), -1, offset, out_features});
+    auto contiguous = graph->insert(aten::contiguous, {slice});
+    contiguous->setType(group[i]->output()->type());
+    group[i]->output()->replaceAllUsesWith(contiguous);
+    offset += out_features;
+  }
+  // DCE run after cleans up nodes
+}
+
+bool mergeableLinearGroup(const std::vector<Node*>& group, AliasDb& db) {
+  // a write to the input between the linears would make them read
+  // different values
+  if (db.hasWriters(group[0]->namedInput("input"))) {
+    return false;
+  }
+  auto first_w = constant_as<Tensor>(group[0]->namedInput("weight")).value();
+  for (Node* linear : group) {
+    auto weight = constant_as<Tensor>(linear->namedInput("weight")).value();
+    if (weight.size(1) != first_w.size(1) ||
+        weight.scalar_type() != first_w.scalar_type() ||
+        weight.device() != first_w.device()) {
+      return false;
+    }
+    auto bias_value = linear->namedInput("bias");
+    if (bias_value->type() != NoneType::get()) {
+      auto bias = constant_as<Tensor>(bias_value).value();
+      if (bias.scalar_type() != first_w.scalar_type() ||
+          bias.device() != first_w.device()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+void ConvertFrozenMatmulToLinear(std::shared_ptr<Graph>& graph) {
+  ConvertFrozenMatmulToLinear(graph->block());
+  EliminateDeadCode(graph);
+}
+
+void FoldFrozenLinearBatchnorm(std::shared_ptr<Graph>& graph) {
+  FoldFrozenLinearBatchnorm(graph->block());
+  EliminateDeadCode(graph);
+}
+
+void FoldFrozenLinearAddOrSub(std::shared_ptr<Graph>& graph) {
+  FoldFrozenLinearAddOrSub(graph->block());
+  EliminateDeadCode(graph);
+}
+
+void FoldFrozenLinearMulOrDiv(std::shared_ptr<Graph>& graph) {
+  FoldFrozenLinearMulOrDiv(graph->block());
+  EliminateDeadCode(graph);
+}
+
+void MergeFrozenParallelLinears(std::shared_ptr<Graph>& graph) {
+  std::vector<std::vector<Node*>> groups;
+  collectParallelLinears(graph->block(), groups);
+  if (groups.empty()) {
+    return;
+  }
+  std::vector<std::vector<Node*>> mergeable;
+  {
+    AliasDb db(graph);
+    for (auto& group : groups) {
+      if (mergeableLinearGroup(group, db)) {
+        mergeable.push_back(std::move(group));
+      }
+    }
+  }
+  for (const auto& group : mergeable) {
+    mergeParallelLinears(group);
+  }
+  EliminateDeadCode(graph);
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+// Replaces aten::matmul with a constant 2-d right-hand side by the
+// equivalent aten::linear so the linear folding passes below can apply.
+// This pass only works on Frozen Graphs; otherwise it is a No-Op.
+TORCH_API void ConvertFrozenMatmulToLinear(std::shared_ptr<Graph>& graph);
+
+// Fuses Linear -> Batchnorm into a single Linear by
+// folding batchnorm weights into linear weights. Only applies when the
+// linear output is known to be 2-d, where batchnorm normalizes the features.
+// This pass only works on Frozen Graphs; otherwise it is a No-Op.
+TORCH_API void FoldFrozenLinearBatchnorm(std::shared_ptr<Graph>& graph);
+
+// Fuses Linear -> Add/Sub into a single Linear by
+// folding add constant tensor into linear bias.
+// This pass only works on Frozen Graphs; otherwise it is a No-Op.
+TORCH_API void FoldFrozenLinearAddOrSub(std::shared_ptr<Graph>& graph);
+
+// Fuses Linear -> Mul/Div into a single Linear by
+// folding mul constant tensor into linear weights and bias.
+// This pass only works on Frozen Graphs; otherwise it is a No-Op.
+TORCH_API void FoldFrozenLinearMulOrDiv(std::shared_ptr<Graph>& graph);
+
+// Merges aten::linear nodes that share an input and have constant weights
+// (e.g. Q/K/V projections) into one wider linear whose output is split
+// back into the original outputs.
+// This pass only works on Frozen Graphs; otherwise it is a No-Op.
+TORCH_API void MergeFrozenParallelLinears(std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
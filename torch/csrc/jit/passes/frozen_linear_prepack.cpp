@@ -0,0 +1,76 @@
+#include <ATen/Context.h>
+#include <ATen/native/PackedLinear.h>
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/dead_code_elimination.h>
+#include <torch/csrc/jit/passes/frozen_linear_prepack.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+using Tensor = at::Tensor;
+
+// Weights already converted by ConvertFrozenOpsToMKLDNN are left to MKLDNN
+bool isFloatCpuTensor(const Tensor& t, int64_t dim) {
+  return t.layout() == at::kStrided && t.dim() == dim &&
+      t.scalar_type() == at::kFloat && t.device().is_cpu() &&
+      !t.requires_grad();
+}
+
+void PrepackFrozenLinear(Block* b) {
+  for (Node* n : b->nodes()) {
+    for (Block* block : n->blocks()) {
+      PrepackFrozenLinear(block);
+    }
+
+    if (n->kind() != aten::linear) {
+      continue;
+    }
+    auto weight = toIValue(n->namedInput("weight"));
+    auto bias_value = n->namedInput("bias");
+    auto bias = toIValue(bias_value);
+    if (!weight || !weight->isTensor() ||
+        !isFloatCpuTensor(weight->toTensor(), 2)) {
+      continue;
+    }
+    c10::optional<Tensor> bias_tensor;
+    if (bias_value->type() != NoneType::get()) {
+      if (!bias || !bias->isTensor() ||
+          !isFloatCpuTensor(bias->toTensor(), 1)) {
+        continue;
+      }
+      bias_tensor = bias->toTensor();
+    }
+
+    auto context = at::native::LinearFp32PackedContext::create(
+        weight->toTensor(), bias_tensor);
+    WithInsertPoint guard(n);
+    auto graph = b->owningGraph();
+    auto context_value = graph->insertConstant(IValue(std::move(context)));
+    context_value->setDebugName(
+        n->namedInput("weight")->debugName() + "_prepacked");
+    auto run = graph->create(
+        Symbol::fromQualString("cpu_prepacked::linear_run"),
+        {n->namedInput("input"), context_value});
+    run->output()->setType(n->output()->type());
+    graph->insertNode(run);
+    GRAPH_UPDATE("Replacing ", *n, " with ", *run);
+    n->output()->replaceAllUsesWith(run->output());
+  }
+}
+
+} // namespace
+
+void PrepackFrozenLinear(std::shared_ptr<Graph>& graph) {
+  if (!at::hasMKL()) {
+    return;
+  }
+  PrepackFrozenLinear(graph->block());
+  EliminateDeadCode(graph);
+}
+
+} // namespace jit
+} // namespace torch
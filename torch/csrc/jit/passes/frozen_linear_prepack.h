@@ -0,0 +1,18 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+// Replaces fp32 aten::linear calls that have a constant weight with
+// cpu_prepacked::linear_run, which packs the weight once for the CPU GEMM
+// instead of on every call. Only runs when ATen is built with MKL.
+// Since folding passes cannot see through cpu_prepacked::linear_run, this is
+// not part of OptimizeFrozenGraph but runs last, after
+// ConvertFrozenOpsToMKLDNN, whose linears it leaves alone.
+// This pass only works on Frozen Graphs; otherwise it is a No-Op.
+TORCH_API void PrepackFrozenLinear(std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
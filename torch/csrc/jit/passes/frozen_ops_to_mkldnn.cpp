@@ -1,4 +1,5 @@
 #include <ATen/Utils.h>
+#include <ATen/WrapDimUtils.h>
 
 #include <ATen/Config.h>
 #include <ATen/core/interned_strings.h>
@@ -24,6 +25,7 @@
 // clang-format off
 // moving ConvUtils include induces import cycle
 #include <ATen/native/ConvUtils.h>
+#include <ATen/native/mkldnn/MKLDNNCommon.h>
 #include <algorithm>
 #include <memory>
 // clang-format on
@@ -169,7 +171,8 @@ void InplaceMKLDNNSubgraph(std::shared_ptr<Graph> graph) {
 
   for (Node* node : graph->nodes()) {
     auto k = node->kind();
-    if (k == aten::relu || k == aten::sigmoid || k == aten::dropout) {
+    if (k == aten::relu || k == aten::sigmoid || k == aten::tanh ||
+        k == aten::dropout) {
       if (set_liveness[alias_mapping[node->inputs().at(0)]]->isAfter(node)) {
         continue;
       }
@@ -245,6 +248,42 @@ const RegisterOperators BroadOpReg({
         AliasAnalysisKind::INTERNAL_SPECIAL_CASE),
 });
 
+// Variadic concatenation of MKLDNN tensors along attr::dim. aten::cat takes
+// its inputs as a Tensor[], which cannot be moved into an MKLDNN group
+// independently of the ListConstruct that builds it, so eligible cats are
+// rewritten to this op before slicing and rewritten back if they end up
+// outside of a group.
+Operation MKLDNNConcatOp(const Node* node) {
+  const int64_t dim = node->i(attr::dim);
+  const size_t num_inputs = node->inputs().size();
+  return [dim, num_inputs](Stack* stack) {
+    std::vector<ideep::tensor> inputs;
+    inputs.reserve(num_inputs);
+    auto ivalues = last(stack, num_inputs);
+    const Tensor first = ivalues[0].toTensor();
+    for (const IValue& v : ivalues) {
+      inputs.push_back(at::native::itensor_from_mkldnn(v.toTensor()));
+    }
+    drop(stack, num_inputs);
+    ideep::tensor output;
+    ideep::concat::compute(
+        inputs, static_cast<int>(at::maybe_wrap_dim(dim, first.dim())), output);
+    push(
+        stack,
+        at::native::new_with_itensor_mkldnn(
+            std::move(output),
+            optTypeMetaToScalarType(first.options().dtype_opt()),
+            first.options().device_opt()));
+  };
+}
+
+const RegisterOperators MKLDNNConcatOpReg({
+    torch::jit::Operator(
+        prim::MKLDNNConcat,
+        MKLDNNConcatOp,
+        AliasAnalysisKind::INTERNAL_SPECIAL_CASE),
+});
+
 Operation ConstantMKLDNNTensorOp(const Node* node) {
   const auto& t = node->t(attr::value);
   return [t](Stack* stack) {
@@ -405,7 +444,11 @@ void moveWeightsToMKLDNN(Node* n) {
   }
 }
 
-void ComputeSubgraphInMKLDNN(Node* subgraph_node) {
+// `inserted_to_dense` collects the to_dense nodes created for group outputs,
+// so that later groups consuming those outputs can skip the round trip.
+void ComputeSubgraphInMKLDNN(
+    Node* subgraph_node,
+    std::unordered_set<Node*>& inserted_to_dense) {
   auto graph = subgraph_node->owningGraph();
   Value* none_value = nullptr;
   {
@@ -417,6 +460,14 @@ void ComputeSubgraphInMKLDNN(Node* subgraph_node) {
     if (!v->type()->cast<TensorType>()) {
       continue;
     }
+    // The input was converted to dense at the end of a previous MKLDNN
+    // group, so feed that group's MKLDNN output in directly instead of
+    // reordering it back. The to_dense is removed by DCE if it has no
+    // other users.
+    if (inserted_to_dense.count(v->node())) {
+      subgraph_node->replaceInput(i, v->node()->input(0));
+      continue;
+    }
     auto to_mkldnn =
         graph->create(c10::Symbol::fromQualString("aten::to_mkldnn"), 1)
             ->insertBefore(subgraph_node);
@@ -436,6 +487,7 @@ void ComputeSubgraphInMKLDNN(Node* subgraph_node) {
                 c10::Symbol::fromQualString("aten::to_dense"), {v, none_value})
             ->insertAfter(subgraph_node);
     v->replaceAllUsesAfterNodeWith(from_mkldnn, from_mkldnn->output());
+    inserted_to_dense.insert(from_mkldnn);
   }
 
   auto subgraph = SubgraphUtils::getSubgraph(subgraph_node);
@@ -503,6 +555,53 @@ bool frozenMkldnnCompatibleConvNode(Node* n) {
   return supportedMKLDNNWeight(weight);
 }
 
+// Rewrites `aten::cat(prim::ListConstruct(a, b, ...), dim)` with a constant
+// dim into `prim::MKLDNNConcat[dim](a, b, ...)` so that it can be sliced into
+// an MKLDNN group like any other node with tensor inputs.
+void ConvertCatToMKLDNNConcat(Block* b) {
+  for (auto it = b->nodes().begin(); it != b->nodes().end();) {
+    Node* n = *it;
+    it++;
+    for (Block* block : n->blocks()) {
+      ConvertCatToMKLDNNConcat(block);
+    }
+    if (!n->matches("aten::cat(Tensor[] tensors, int dim=0) -> Tensor")) {
+      continue;
+    }
+    Value* list = n->namedInput("tensors");
+    auto dim = constant_as<int64_t>(n->namedInput("dim"));
+    if (list->node()->kind() != prim::ListConstruct ||
+        list->uses().size() != 1 || !dim ||
+        list->node()->inputs().size() == 0) {
+      continue;
+    }
+    Node* concat = b->owningGraph()->create(
+        prim::MKLDNNConcat, list->node()->inputs(), 1);
+    concat->i_(attr::dim, *dim);
+    concat->output()->setType(n->output()->type());
+    concat->insertBefore(n);
+    n->output()->replaceAllUsesWith(concat->output());
+    Node* list_node = list->node();
+    n->destroy();
+    list_node->destroy();
+  }
+}
+
+// Undoes ConvertCatToMKLDNNConcat for a concat that was not sliced into an
+// MKLDNN group.
+void ConvertMKLDNNConcatToCat(Node* concat) {
+  Graph* graph = concat->owningGraph();
+  WithInsertPoint guard(concat);
+  Value* list = graph->insertNode(graph->createList(
+                                      TensorType::get(), concat->inputs()))
+                    ->output();
+  Value* dim = graph->insertConstant(concat->i(attr::dim));
+  Value* cat = graph->insert(aten::cat, {list, dim});
+  cat->setType(concat->output()->type());
+  concat->output()->replaceAllUsesWith(cat);
+  concat->destroy();
+}
+
 // [mkldnn perf strategy]
 // Certain ops - aten::linear, aten::conv2d, aten::conv3d - provide a huge speed
 // up just by converting the constant weights to MKLDNN AOT, and then at runtime
@@ -538,7 +637,8 @@ class MKLDNNSubgraphSlicer {
     // un-inlining autodiff subgraphs. We first recursively construct all
     // subgraphs and then unmerge them into the graph
     buildupSubgraphs();
-    computeSubgraphsInMKLDNN();
+    std::unordered_set<Node*> inserted_to_dense;
+    computeSubgraphsInMKLDNN(inserted_to_dense);
     // Run CSE globally onceto eliminate duplicates that may have occurred
     // while inlining subgraphs.
     EliminateCommonSubexpression(graph_);
@@ -625,6 +725,8 @@ class MKLDNNSubgraphSlicer {
     switch (n->kind()) {
       case aten::relu:
       case aten::sigmoid:
+      case aten::tanh:
+      case prim::MKLDNNConcat:
       // TODO: max_pool on mkldnn can be slower than in eager. ideally, we'd
       // only fuse it if we knew including max_pool lead to fewer layout
       // conversions. from initial testing including it speeds up models
@@ -642,6 +744,25 @@ class MKLDNNSubgraphSlicer {
       }
       return true;
     }
+    if (n->kind() == aten::avg_pool2d || n->kind() == aten::avg_pool3d) {
+      // mkldnn pooling does not support divisor_override
+      return n->namedInput("divisor_override")->type() == NoneType::get();
+    }
+    if (n->kind() == aten::adaptive_avg_pool2d) {
+      // mkldnn requires the input size to be divisible by the output size,
+      // which we can only prove for global pooling
+      auto output_size =
+          constant_as<std::vector<int64_t>>(n->namedInput("output_size"));
+      return output_size &&
+          std::all_of(output_size->begin(), output_size->end(), [](int64_t s) {
+                return s == 1;
+              });
+    }
+    if (n->kind() == aten::softmax) {
+      return n->matches(
+                 "aten::softmax.int(Tensor self, int dim, ScalarType? dtype=None) -> Tensor") &&
+          n->namedInput("dtype")->type() == NoneType::get();
+    }
     // TODO: dropout removal. mkldnn doesnt support train=True
     if (n->kind() == aten::dropout) {
       auto train = constant_as<bool>(n->namedInput("train")).value();
@@ -650,20 +771,24 @@ class MKLDNNSubgraphSlicer {
     return false;
   }
 
-  void computeSubgraphsInMKLDNN() {
+  void computeSubgraphsInMKLDNN(std::unordered_set<Node*>& inserted_to_dense) {
     auto curNode = *block_->nodes().begin();
     while (curNode != *block_->nodes().end()) {
       auto nextNode = curNode->next();
       if (curNode->kind() == prim::MKLDNNGroup) {
-        ComputeSubgraphInMKLDNN(curNode);
+        ComputeSubgraphInMKLDNN(curNode, inserted_to_dense);
         InplaceMKLDNNSubgraph(SubgraphUtils::getSubgraph(curNode));
         SubgraphUtils::unmergeSubgraph(curNode);
+      } else if (curNode->kind() == prim::MKLDNNConcat) {
+        // not part of any group, so its inputs are dense
+        ConvertMKLDNNConcatToCat(curNode);
       }
       curNode = nextNode;
     }
     for (Node* n : block_->nodes()) {
       for (Block* b : n->blocks()) {
-        MKLDNNSubgraphSlicer(b, graph_, aliasDb_).computeSubgraphsInMKLDNN();
+        MKLDNNSubgraphSlicer(b, graph_, aliasDb_)
+            .computeSubgraphsInMKLDNN(inserted_to_dense);
       }
     }
   }
@@ -727,6 +852,39 @@ class MKLDNNSubgraphSlicer {
   AliasDb& aliasDb_;
 };
 
+// Logs every layout conversion left in the graph along with the number of
+// bytes it copies, when the shape is known. Conversions inside loops are
+// paid on every iteration, so they are called out separately.
+void ReportMKLDNNLayoutConversions(Block* b) {
+  for (Node* n : b->nodes()) {
+    for (Block* block : n->blocks()) {
+      ReportMKLDNNLayoutConversions(block);
+    }
+    if (n->kind() != aten::to_mkldnn && n->kind() != aten::to_dense) {
+      continue;
+    }
+    std::string cost = "unknown size";
+    auto type = n->input(0)->type()->cast<TensorType>();
+    if (type) {
+      auto numel = type->numel();
+      if (numel) {
+        cost = c10::str(*numel * sizeof(float), " bytes");
+      }
+    }
+    bool in_loop = false;
+    for (Node* owner = b->owningNode(); owner;
+         owner = owner->owningBlock()->owningNode()) {
+      in_loop |= owner->kind() == prim::Loop;
+    }
+    GRAPH_DEBUG(
+        "Remaining MKLDNN layout conversion (",
+        cost,
+        in_loop ? ", inside a loop" : "",
+        "): ",
+        *n);
+  }
+}
+
 bool containsMKLDNNGroup(Block* b) {
   for (Node* n : b->nodes()) {
     for (Block* block : n->blocks()) {
@@ -759,13 +917,16 @@ void ConvertFrozenOpsToMKLDNN(std::shared_ptr<Graph>& graph) {
           aten::relu_,
           aten::dropout_,
           aten::sigmoid_,
+          Symbol::fromQualString("aten::tanh_"),
       };
       return mkldnn_ops.count(node_to_functionalize->kind()) != 0;
     });
+    ConvertCatToMKLDNNConcat(graph->block());
     AliasDb db(graph);
     MKLDNNSubgraphSlicer(graph->block(), graph, db).run();
     EliminateDeadCode(graph);
     GRAPH_DUMP("After convert frozen ops to mkldnn", graph);
+    ReportMKLDNNLayoutConversions(graph->block());
   } else {
     GRAPH_DUMP("No mkldnn compatible frozen nodes", graph);
   }
@@ -126,6 +126,88 @@ void fuseHardtanhWithPackedOps(std::shared_ptr<Graph>& graph) {
   rewriter.runOnGraph(graph, torch::jit::graph_rewrite_helper::isClampFusable);
 }
 
+void fuseHardswishWithPackedOps(std::shared_ptr<Graph>& graph) {
+  SubgraphRewriter rewriter;
+
+  std::string conv2d_prepack_run_hardswish_fused = R"(
+    graph(%input, %packed_weight_bias):
+        %r = metal_prepack::conv2d_hardswish_run(%input, %packed_weight_bias)
+        return (%r) )";
+
+  std::string conv2d_prepack_run_hardswish = R"(
+    graph(%input, %packed_weight_bias):
+        %r = metal_prepack::conv2d_run(%input, %packed_weight_bias)
+        %r = aten::hardswish(%r)
+        return (%r) )";
+
+  rewriter.RegisterRewritePattern(
+      conv2d_prepack_run_hardswish, conv2d_prepack_run_hardswish_fused);
+
+  std::string conv2d_prepack_run_hardswish_inplace = R"(
+    graph(%input, %packed_weight_bias):
+        %r = metal_prepack::conv2d_run(%input, %packed_weight_bias)
+        %r = aten::hardswish_(%r)
+        return (%r) )";
+
+  rewriter.RegisterRewritePattern(
+      conv2d_prepack_run_hardswish_inplace, conv2d_prepack_run_hardswish_fused);
+
+  rewriter.runOnGraph(graph);
+}
+
+bool isAddFusable(
+    const Match& match,
+    const std::unordered_map<std::string, Value*>& vmap) {
+  const auto& match_vmap = match.values_map;
+  // aten::add(Tensor, Scalar, Scalar) matches the pattern as well
+  if (!match_vmap.at(vmap.at("other"))->type()->isSubtypeOf(
+          TensorType::get())) {
+    return false;
+  }
+  auto alpha = graph_rewrite_helper::getIValue("alpha", match_vmap, vmap);
+  return alpha && alpha->isScalar() && alpha->toScalar().toDouble() == 1;
+}
+
+void fuseAddWithPackedOps(std::shared_ptr<Graph>& graph) {
+  SubgraphRewriter rewriter;
+
+  std::string conv2d_prepack_run_add_fused = R"(
+    graph(%input, %packed_weight_bias, %other, %alpha):
+        %r = metal_prepack::conv2d_add_run(%input, %other, %packed_weight_bias)
+        return (%r) )";
+
+  std::string conv2d_prepack_run_add = R"(
+    graph(%input, %packed_weight_bias, %other, %alpha):
+        %y = metal_prepack::conv2d_run(%input, %packed_weight_bias)
+        %r = aten::add(%y, %other, %alpha)
+        return (%r) )";
+
+  rewriter.RegisterRewritePattern(
+      conv2d_prepack_run_add, conv2d_prepack_run_add_fused);
+
+  std::string conv2d_prepack_run_add_reversed = R"(
+    graph(%input, %packed_weight_bias, %other, %alpha):
+        %y = metal_prepack::conv2d_run(%input, %packed_weight_bias)
+        %r = aten::add(%other, %y, %alpha)
+        return (%r) )";
+
+  rewriter.RegisterRewritePattern(
+      conv2d_prepack_run_add_reversed, conv2d_prepack_run_add_fused);
+
+  // only the output of the convolution may be updated in place, it is not
+  // visible outside of the pattern
+  std::string conv2d_prepack_run_add_inplace = R"(
+    graph(%input, %packed_weight_bias, %other, %alpha):
+        %y = metal_prepack::conv2d_run(%input, %packed_weight_bias)
+        %r = aten::add_(%y, %other, %alpha)
+        return (%r) )";
+
+  rewriter.RegisterRewritePattern(
+      conv2d_prepack_run_add_inplace, conv2d_prepack_run_add_fused);
+
+  rewriter.runOnGraph(graph, isAddFusable);
+}
+
 } // namespace
 
 void metalInsertPrePackedOps(std::shared_ptr<Graph>& graph) {
@@ -154,6 +236,9 @@ void metalFusePrePackedConvWithClamp(script::Module& module) {
   auto graph = module.get_method("forward").graph();
   fuseReluWithPackedOps(graph);
   fuseHardtanhWithPackedOps(graph);
+  // the clamp fused above is applied before the hardswish or the add
+  fuseHardswishWithPackedOps(graph);
+  fuseAddWithPackedOps(graph);
 }
 
 void metalInsertCopyOps(script::Module& module) {
@@ -39,24 +39,34 @@ Module SubgraphRewriter::runOnModule(const Module& module) {
 void SubgraphRewriter::runOnGraph(
     std::shared_ptr<Graph>& graph,
     const std::vector<MatchFilter>& filters) {
-  for (const RewritePatternDescr& pattern : patterns_) {
-    rewriteSinglePatternOnGraph(graph, pattern, filters);
+  for (size_t idx = 0; idx < patterns_.size(); idx++) {
+    rewriteSinglePatternOnGraph(graph, getParsedPattern(idx), filters);
   }
 }
 
+ParsedRewritePattern& SubgraphRewriter::getParsedPattern(size_t idx) {
+  if (parsed_patterns_.size() < patterns_.size()) {
+    parsed_patterns_.resize(patterns_.size());
+  }
+  if (!parsed_patterns_[idx]) {
+    auto parsed = std::make_shared<ParsedRewritePattern>();
+    parseIR(patterns_[idx].pattern, &parsed->pattern_graph, parsed->vmap);
+    parseIR(patterns_[idx].replacement, &parsed->replacement_graph);
+    parsed_patterns_[idx] = std::move(parsed);
+  }
+  return *parsed_patterns_[idx];
+}
+
 void SubgraphRewriter::rewriteSinglePatternOnGraph(
     std::shared_ptr<Graph>& graph,
-    const RewritePatternDescr& pattern,
+    ParsedRewritePattern& pattern,
     const std::vector<MatchFilter>& filters) {
   std::unordered_map<Value*, Value*> rewrite_map;
   std::vector<Value*> values_to_rewrite;
 
-  Graph pattern_graph;
-  std::unordered_map<std::string, Value*> vmap;
-  parseIR(pattern.pattern, &pattern_graph, vmap);
-
-  Graph replacement_graph;
-  parseIR(pattern.replacement, &replacement_graph);
+  Graph& pattern_graph = pattern.pattern_graph;
+  const auto& vmap = pattern.vmap;
+  Graph& replacement_graph = pattern.replacement_graph;
 
   const auto& matches = findPatternMatches(pattern_graph, *graph);
   for (const Match& match : matches) {
@@ -21,6 +21,7 @@ namespace jit {
 
 // Forward declarations.
 struct RewritePatternDescr;
+struct ParsedRewritePattern;
 struct Match;
 
 using MatchFilter = std::function<
@@ -87,11 +88,18 @@ class TORCH_API SubgraphRewriter {
 
  private:
   std::vector<RewritePatternDescr> patterns_;
+  // Parsed pattern and replacement graphs, one per entry of patterns_. They
+  // are parsed on first use and reused by later runs, so that applying the
+  // rewriter to many graphs (e.g. every method of a large module) does not
+  // re-parse the IR each time.
+  std::vector<std::shared_ptr<ParsedRewritePattern>> parsed_patterns_;
   std::unordered_set<Node*> nodes_to_delete_;
 
+  ParsedRewritePattern& getParsedPattern(size_t idx);
+
   void rewriteSinglePatternOnGraph(
       std::shared_ptr<Graph>& graph,
-      const RewritePatternDescr& pattern,
+      ParsedRewritePattern& pattern,
       const std::vector<MatchFilter>& filters);
 
   bool overlapsWithPreviousMatches(const Match* match);
@@ -107,5 +115,17 @@ struct RewritePatternDescr {
   std::string replacement;
 };
 
+/** A rewrite pattern with its IR already parsed.
+ *
+ * `vmap` maps value names in the pattern IR to values of `pattern_graph`; it
+ * is what match filters receive. Like `RewritePatternDescr`, this is an
+ * implementation detail of `SubgraphRewriter`.
+ */
+struct ParsedRewritePattern {
+  Graph pattern_graph;
+  std::unordered_map<std::string, Value*> vmap;
+  Graph replacement_graph;
+};
+
 } // namespace jit
 } // namespace torch
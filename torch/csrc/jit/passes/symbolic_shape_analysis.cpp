@@ -0,0 +1,734 @@
+#include <torch/csrc/jit/passes/symbolic_shape_analysis.h>
+
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/runtime/operator.h>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+using c10::ShapeSymbol;
+using c10::Stride;
+using c10::SymbolicShape;
+using c10::VaryingShape;
+
+using SymbolicDims = std::vector<ShapeSymbol>;
+
+// A formula returns the dimensions of the single tensor output of a node, or
+// nullopt if it can't say anything about them (not even the rank).
+using formula_t = std::function<c10::optional<SymbolicDims>(Node*)>;
+
+c10::optional<SymbolicDims> dimsOf(const Value* v) {
+  auto tensor_type = v->type()->cast<TensorType>();
+  if (!tensor_type) {
+    return c10::nullopt;
+  }
+  return tensor_type->symbolic_sizes().sizes();
+}
+
+c10::optional<size_t> normalizeDim(int64_t dim, size_t rank) {
+  const auto signed_rank = static_cast<int64_t>(rank);
+  if (dim < -signed_rank || dim >= signed_rank) {
+    return c10::nullopt;
+  }
+  return dim < 0 ? dim + signed_rank : dim;
+}
+
+bool isStaticSize(const ShapeSymbol& s, int64_t size) {
+  return s.is_static() && s.static_size() == size;
+}
+
+// Size of a dimension that has to be equal in two tensors, e.g. the batch
+// dimension of bmm.
+ShapeSymbol unifySymbols(const ShapeSymbol& a, const ShapeSymbol& b) {
+  return a.is_static() ? a : b.is_static() ? b : a;
+}
+
+ShapeSymbol broadcastSymbols(const ShapeSymbol& a, const ShapeSymbol& b) {
+  if (a == b || isStaticSize(b, 1)) {
+    return a;
+  }
+  if (isStaticSize(a, 1)) {
+    return b;
+  }
+  // a symbolic dimension broadcast with a static one other than 1 is either 1
+  // or equal to it
+  if (a.is_static() != b.is_static()) {
+    return a.is_static() ? a : b;
+  }
+  return ShapeSymbol::newSymbol();
+}
+
+ShapeSymbol productOfSymbols(SymbolicDims::const_iterator begin, SymbolicDims::const_iterator end) {
+  int64_t product = 1;
+  c10::optional<ShapeSymbol> symbolic;
+  for (auto it = begin; it != end; ++it) {
+    if (isStaticSize(*it, 0)) {
+      return ShapeSymbol::fromStaticSize(0);
+    }
+    if (it->is_static()) {
+      product *= it->static_size();
+    } else if (!symbolic) {
+      symbolic = *it;
+    } else {
+      return ShapeSymbol::newSymbol();
+    }
+  }
+  if (!symbolic) {
+    return ShapeSymbol::fromStaticSize(product);
+  }
+  return product == 1 ? *symbolic : ShapeSymbol::newSymbol();
+}
+
+// The symbol for an int argument used as a size: a constant, or a dimension of
+// a tensor read with aten::size. Returns nullopt for negative constants (the
+// -1 of view) and a fresh symbol for anything else.
+c10::optional<ShapeSymbol> symbolForSize(Value* v) {
+  if (auto constant = constant_as<int64_t>(v)) {
+    if (*constant < 0) {
+      return c10::nullopt;
+    }
+    return ShapeSymbol::fromStaticSize(*constant);
+  }
+  Node* producer = v->node();
+  if (producer->matches("aten::size(Tensor self, int dim) -> int")) {
+    auto dims = dimsOf(producer->input(0));
+    auto dim = constant_as<int64_t>(producer->input(1));
+    if (dims && dim) {
+      if (auto d = normalizeDim(*dim, dims->size())) {
+        return (*dims)[*d];
+      }
+    }
+  }
+  return ShapeSymbol::newSymbol();
+}
+
+// Symbols for the elements of an int[] argument used as sizes, see
+// symbolForSize. Returns nullopt if not even the length of the list is known.
+c10::optional<std::vector<c10::optional<ShapeSymbol>>> symbolsForSizes(Value* list) {
+  std::vector<c10::optional<ShapeSymbol>> result;
+  if (auto constant = constant_as<c10::List<int64_t>>(list)) {
+    for (int64_t size : constant->vec()) {
+      if (size < 0) {
+        result.emplace_back(c10::nullopt);
+      } else {
+        result.emplace_back(ShapeSymbol::fromStaticSize(size));
+      }
+    }
+    return result;
+  }
+  Node* producer = list->node();
+  if (producer->kind() == prim::ListConstruct) {
+    for (Value* element : producer->inputs()) {
+      result.push_back(symbolForSize(element));
+    }
+    return result;
+  }
+  if (producer->matches("aten::size(Tensor self) -> int[]")) {
+    if (auto dims = dimsOf(producer->input(0))) {
+      return std::vector<c10::optional<ShapeSymbol>>(dims->begin(), dims->end());
+    }
+  }
+  return c10::nullopt;
+}
+
+c10::optional<std::vector<int64_t>> constantInts(Node* node, const char* name) {
+  if (auto list = constant_as<c10::List<int64_t>>(node->namedInput(name))) {
+    return list->vec();
+  }
+  return c10::nullopt;
+}
+
+c10::optional<SymbolicDims> sameAsFirstInput(Node* node) {
+  return dimsOf(node->input(0));
+}
+
+c10::optional<SymbolicDims> broadcastInputs(Node* node) {
+  c10::optional<SymbolicDims> result;
+  for (Value* input : node->inputs()) {
+    if (!input->type()->cast<TensorType>()) {
+      continue;
+    }
+    auto dims = dimsOf(input);
+    if (!dims) {
+      return c10::nullopt;
+    }
+    if (!result) {
+      result = std::move(dims);
+      continue;
+    }
+    // align trailing dimensions
+    if (dims->size() > result->size()) {
+      std::swap(*dims, *result);
+    }
+    const size_t offset = result->size() - dims->size();
+    for (size_t i = 0; i < dims->size(); i++) {
+      (*result)[offset + i] = broadcastSymbols((*result)[offset + i], (*dims)[i]);
+    }
+  }
+  return result;
+}
+
+c10::optional<SymbolicDims> matmulFormula(Node* node) {
+  auto a = dimsOf(node->input(0));
+  auto b = dimsOf(node->input(1));
+  if (!a || !b || a->empty() || b->empty()) {
+    return c10::nullopt;
+  }
+  // (batch..., rows, k) @ (batch..., k, cols), where vectors have no rows or
+  // no cols
+  SymbolicDims a_batch, b_batch, result;
+  if (a->size() >= 2) {
+    a_batch.assign(a->begin(), a->end() - 2);
+  }
+  if (b->size() >= 2) {
+    b_batch.assign(b->begin(), b->end() - 2);
+  }
+  if (a_batch.size() < b_batch.size()) {
+    std::swap(a_batch, b_batch);
+  }
+  result = a_batch;
+  const size_t offset = a_batch.size() - b_batch.size();
+  for (size_t i = 0; i < b_batch.size(); i++) {
+    result[offset + i] = broadcastSymbols(result[offset + i], b_batch[i]);
+  }
+  if (a->size() >= 2) {
+    result.push_back(a->at(a->size() - 2));
+  }
+  if (b->size() >= 2) {
+    result.push_back(b->back());
+  }
+  return result;
+}
+
+// The -1 entry of view/reshape is numel(self) / product(other sizes). It can be
+// computed whenever the symbolic dimensions of self that are not cancelled by
+// equal output dimensions are all static.
+ShapeSymbol inferViewDim(SymbolicDims self, const std::vector<c10::optional<ShapeSymbol>>& sizes) {
+  int64_t known_product = 1;
+  for (const auto& size : sizes) {
+    if (!size) {
+      continue;
+    }
+    if (size->is_static()) {
+      known_product *= size->static_size();
+      continue;
+    }
+    auto it = std::find(self.begin(), self.end(), *size);
+    if (it == self.end()) {
+      return ShapeSymbol::newSymbol();
+    }
+    self.erase(it);
+  }
+  const ShapeSymbol remaining = productOfSymbols(self.begin(), self.end());
+  if (!remaining.is_static()) {
+    return known_product == 1 ? remaining : ShapeSymbol::newSymbol();
+  }
+  if (known_product == 0 || remaining.static_size() % known_product != 0) {
+    return ShapeSymbol::newSymbol();
+  }
+  return ShapeSymbol::fromStaticSize(remaining.static_size() / known_product);
+}
+
+c10::optional<SymbolicDims> viewFormula(Node* node) {
+  auto self = dimsOf(node->input(0));
+  auto sizes = symbolsForSizes(node->input(1));
+  if (!sizes) {
+    return c10::nullopt;
+  }
+  SymbolicDims result;
+  for (const auto& size : *sizes) {
+    if (size) {
+      result.push_back(*size);
+    } else if (self) {
+      result.push_back(inferViewDim(*self, *sizes));
+    } else {
+      result.push_back(ShapeSymbol::newSymbol());
+    }
+  }
+  return result;
+}
+
+c10::optional<SymbolicDims> convFormula(Node* node) {
+  auto input = dimsOf(node->input(0));
+  auto weight = dimsOf(node->input(1));
+  auto stride = constantInts(node, "stride");
+  auto padding = constantInts(node, "padding");
+  auto dilation = constantInts(node, "dilation");
+  if (!input || !weight || input->size() < 3 || input->size() != weight->size()) {
+    return c10::nullopt;
+  }
+  const size_t spatial = input->size() - 2;
+  auto param = [&](const c10::optional<std::vector<int64_t>>& values, size_t i) -> c10::optional<int64_t> {
+    if (!values || values->empty()) {
+      return c10::nullopt;
+    }
+    return values->size() == 1 ? values->at(0) : values->at(i);
+  };
+  SymbolicDims result = {input->at(0), weight->at(0)};
+  for (size_t i = 0; i < spatial; i++) {
+    const ShapeSymbol in = input->at(i + 2);
+    const ShapeSymbol kernel = weight->at(i + 2);
+    auto s = param(stride, i);
+    auto p = param(padding, i);
+    auto d = param(dilation, i);
+    if (!s || !p || !d || !kernel.is_static()) {
+      result.push_back(ShapeSymbol::newSymbol());
+      continue;
+    }
+    const int64_t shrink = *d * (kernel.static_size() - 1) - 2 * *p;
+    if (in.is_static()) {
+      result.push_back(ShapeSymbol::fromStaticSize(
+          (in.static_size() - shrink - 1) / *s + 1));
+    } else if (*s == 1 && shrink == 0) {
+      // "same" convolutions preserve symbolic sizes
+      result.push_back(in);
+    } else {
+      result.push_back(ShapeSymbol::newSymbol());
+    }
+  }
+  return result;
+}
+
+c10::optional<SymbolicDims> reduceFormula(Node* node) {
+  auto self = dimsOf(node->input(0));
+  auto dims = constantInts(node, "dim");
+  auto keepdim = constant_as<bool>(node->namedInput("keepdim"));
+  if (!self || !dims || !keepdim) {
+    return c10::nullopt;
+  }
+  std::vector<bool> reduced(self->size(), dims->empty());
+  for (int64_t dim : *dims) {
+    auto d = normalizeDim(dim, self->size());
+    if (!d) {
+      return c10::nullopt;
+    }
+    reduced[*d] = true;
+  }
+  SymbolicDims result;
+  for (size_t i = 0; i < self->size(); i++) {
+    if (!reduced[i]) {
+      result.push_back(self->at(i));
+    } else if (*keepdim) {
+      result.push_back(ShapeSymbol::fromStaticSize(1));
+    }
+  }
+  return result;
+}
+
+c10::optional<SymbolicDims> catFormula(Node* node) {
+  Node* list = node->input(0)->node();
+  auto dim = constant_as<int64_t>(node->input(1));
+  if (list->kind() != prim::ListConstruct || list->inputs().empty() || !dim) {
+    return c10::nullopt;
+  }
+  c10::optional<SymbolicDims> result;
+  SymbolicDims cat_sizes;
+  c10::optional<size_t> d;
+  for (Value* tensor : list->inputs()) {
+    auto dims = dimsOf(tensor);
+    if (!dims || (result && dims->size() != result->size())) {
+      return c10::nullopt;
+    }
+    if (!result) {
+      d = normalizeDim(*dim, dims->size());
+      if (!d) {
+        return c10::nullopt;
+      }
+      result = dims;
+    }
+    for (size_t i = 0; i < dims->size(); i++) {
+      if (i != *d) {
+        (*result)[i] = unifySymbols((*result)[i], (*dims)[i]);
+      }
+    }
+    cat_sizes.push_back((*dims)[*d]);
+  }
+  const bool all_static = std::all_of(
+      cat_sizes.begin(), cat_sizes.end(), [](const ShapeSymbol& s) { return s.is_static(); });
+  if (all_static) {
+    int64_t total = 0;
+    for (const auto& s : cat_sizes) {
+      total += s.static_size();
+    }
+    (*result)[*d] = ShapeSymbol::fromStaticSize(total);
+  } else if (cat_sizes.size() > 1) {
+    (*result)[*d] = ShapeSymbol::newSymbol();
+  }
+  return result;
+}
+
+c10::optional<SymbolicDims> sliceFormula(Node* node) {
+  auto self = dimsOf(node->input(0));
+  auto dim = constant_as<int64_t>(node->namedInput("dim"));
+  if (!self || !dim) {
+    return c10::nullopt;
+  }
+  auto d = normalizeDim(*dim, self->size());
+  if (!d) {
+    return c10::nullopt;
+  }
+  Value* start_value = node->namedInput("start");
+  Value* end_value = node->namedInput("end");
+  auto start = start_value->mustBeNone() ? c10::optional<int64_t>(0)
+                                         : constant_as<int64_t>(start_value);
+  auto end = end_value->mustBeNone()
+      ? c10::optional<int64_t>(std::numeric_limits<int64_t>::max())
+      : constant_as<int64_t>(end_value);
+  auto step = constant_as<int64_t>(node->namedInput("step"));
+  SymbolicDims result = *self;
+  const ShapeSymbol size = (*self)[*d];
+  if (start && end && step && *start == 0 &&
+      *end == std::numeric_limits<int64_t>::max() && *step == 1) {
+    return result;
+  }
+  if (!start || !end || !step || *step <= 0 || !size.is_static()) {
+    result[*d] = ShapeSymbol::newSymbol();
+    return result;
+  }
+  auto clamp_index = [&](int64_t index) {
+    if (index < 0) {
+      index += size.static_size();
+    }
+    return std::min(std::max<int64_t>(index, 0), size.static_size());
+  };
+  const int64_t begin = clamp_index(*start);
+  const int64_t stop = std::max(clamp_index(*end), begin);
+  result[*d] = ShapeSymbol::fromStaticSize((stop - begin + *step - 1) / *step);
+  return result;
+}
+
+const std::vector<std::pair<OperatorSet, formula_t>>& shapeFormulas() {
+  static const std::vector<std::pair<OperatorSet, formula_t>> formulas = {
+      {{
+           "aten::relu(Tensor self) -> Tensor",
+           "aten::sigmoid(Tensor self) -> Tensor",
+           "aten::tanh(Tensor self) -> Tensor",
+           "aten::neg(Tensor self) -> Tensor",
+           "aten::exp(Tensor self) -> Tensor",
+           "aten::log(Tensor self) -> Tensor",
+           "aten::erf(Tensor self) -> Tensor",
+           "aten::gelu(Tensor self) -> Tensor",
+           "aten::silu(Tensor self) -> Tensor",
+           "aten::abs(Tensor self) -> Tensor",
+           "aten::sqrt(Tensor self) -> Tensor",
+           "aten::rsqrt(Tensor self) -> Tensor",
+           "aten::hardswish(Tensor self) -> Tensor",
+           "aten::hardtanh(Tensor self, Scalar min_val, Scalar max_val) -> Tensor",
+           "aten::leaky_relu(Tensor self, Scalar negative_slope) -> Tensor",
+           "aten::elu(Tensor self, Scalar alpha, Scalar scale, Scalar input_scale) -> Tensor",
+           "aten::clamp(Tensor self, Scalar? min, Scalar? max) -> Tensor",
+           "aten::dropout(Tensor input, float p, bool train) -> Tensor",
+           "aten::clone(Tensor self, *, MemoryFormat? memory_format=None) -> Tensor",
+           "aten::contiguous(Tensor(a) self, *, MemoryFormat memory_format=contiguous_format) -> Tensor(a)",
+           "aten::detach(Tensor(a) self) -> Tensor(a)",
+           "aten::softmax(Tensor self, int dim, ScalarType? dtype=None) -> Tensor",
+           "aten::log_softmax(Tensor self, int dim, ScalarType? dtype=None) -> Tensor",
+           "aten::layer_norm(Tensor input, int[] normalized_shape, Tensor? weight, Tensor? bias, float eps, bool cudnn_enable) -> Tensor",
+           "aten::batch_norm(Tensor input, Tensor? weight, Tensor? bias, Tensor? running_mean, Tensor? running_var, bool training, float momentum, float eps, bool cudnn_enabled) -> Tensor",
+           "aten::add(Tensor self, Scalar other, Scalar alpha) -> Tensor",
+           "aten::sub(Tensor self, Scalar other, Scalar alpha) -> Tensor",
+           "aten::mul(Tensor self, Scalar other) -> Tensor",
+           "aten::div(Tensor self, Scalar other) -> Tensor",
+           "aten::pow(Tensor self, Scalar exponent) -> Tensor",
+           "aten::to(Tensor self, ScalarType dtype, bool non_blocking, bool copy, MemoryFormat? memory_format) -> Tensor",
+           "aten::type_as(Tensor self, Tensor other) -> Tensor",
+       },
+       sameAsFirstInput},
+      {{
+           "aten::add(Tensor self, Tensor other, *, Scalar alpha) -> Tensor",
+           "aten::sub(Tensor self, Tensor other, *, Scalar alpha) -> Tensor",
+           "aten::mul(Tensor self, Tensor other) -> Tensor",
+           "aten::div(Tensor self, Tensor other) -> Tensor",
+           "aten::pow(Tensor self, Tensor exponent) -> Tensor",
+           "aten::maximum(Tensor self, Tensor other) -> Tensor",
+           "aten::minimum(Tensor self, Tensor other) -> Tensor",
+           "aten::eq(Tensor self, Tensor other) -> Tensor",
+           "aten::where(Tensor condition, Tensor self, Tensor other) -> Tensor",
+       },
+       broadcastInputs},
+      {{"aten::expand_as(Tensor(a) self, Tensor other) -> Tensor(a)"},
+       [](Node* node) { return dimsOf(node->input(1)); }},
+      {{"aten::matmul(Tensor self, Tensor other) -> Tensor"}, matmulFormula},
+      {{"aten::mm(Tensor self, Tensor mat2) -> Tensor"},
+       [](Node* node) -> c10::optional<SymbolicDims> {
+         auto a = dimsOf(node->input(0));
+         auto b = dimsOf(node->input(1));
+         if (!a || !b || a->size() != 2 || b->size() != 2) {
+           return c10::nullopt;
+         }
+         return SymbolicDims{a->at(0), b->at(1)};
+       }},
+      {{"aten::bmm(Tensor self, Tensor mat2) -> Tensor"},
+       [](Node* node) -> c10::optional<SymbolicDims> {
+         auto a = dimsOf(node->input(0));
+         auto b = dimsOf(node->input(1));
+         if (!a || !b || a->size() != 3 || b->size() != 3) {
+           return c10::nullopt;
+         }
+         return SymbolicDims{unifySymbols(a->at(0), b->at(0)), a->at(1), b->at(2)};
+       }},
+      {{"aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta, Scalar alpha) -> Tensor"},
+       [](Node* node) -> c10::optional<SymbolicDims> {
+         auto a = dimsOf(node->input(1));
+         auto b = dimsOf(node->input(2));
+         if (!a || !b || a->size() != 2 || b->size() != 2) {
+           return c10::nullopt;
+         }
+         return SymbolicDims{a->at(0), b->at(1)};
+       }},
+      {{"aten::linear(Tensor input, Tensor weight, Tensor? bias=None) -> Tensor"},
+       [](Node* node) -> c10::optional<SymbolicDims> {
+         auto input = dimsOf(node->input(0));
+         auto weight = dimsOf(node->input(1));
+         if (!input || !weight || input->empty() || weight->size() != 2) {
+           return c10::nullopt;
+         }
+         input->back() = weight->at(0);
+         return input;
+       }},
+      {{"aten::transpose(Tensor(a) self, int dim0, int dim1) -> Tensor(a)"},
+       [](Node* node) -> c10::optional<SymbolicDims> {
+         auto self = dimsOf(node->input(0));
+         auto dim0 = constant_as<int64_t>(node->input(1));
+         auto dim1 = constant_as<int64_t>(node->input(2));
+         if (!self || !dim0 || !dim1) {
+           return c10::nullopt;
+         }
+         auto d0 = normalizeDim(*dim0, self->size());
+         auto d1 = normalizeDim(*dim1, self->size());
+         if (!d0 || !d1) {
+           return c10::nullopt;
+         }
+         std::swap((*self)[*d0], (*self)[*d1]);
+         return self;
+       }},
+      {{"aten::t(Tensor(a) self) -> Tensor(a)"},
+       [](Node* node) -> c10::optional<SymbolicDims> {
+         auto self = dimsOf(node->input(0));
+         if (!self || self->size() > 2) {
+           return c10::nullopt;
+         }
+         std::reverse(self->begin(), self->end());
+         return self;
+       }},
+      {{"aten::permute(Tensor(a) self, int[] dims) -> Tensor(a)"},
+       [](Node* node) -> c10::optional<SymbolicDims> {
+         auto self = dimsOf(node->input(0));
+         auto dims = constantInts(node, "dims");
+         if (!self || !dims || dims->size() != self->size()) {
+           return c10::nullopt;
+         }
+         SymbolicDims result;
+         for (int64_t dim : *dims) {
+           auto d = normalizeDim(dim, self->size());
+           if (!d) {
+             return c10::nullopt;
+           }
+           result.push_back((*self)[*d]);
+         }
+         return result;
+       }},
+      {{"aten::unsqueeze(Tensor(a) self, int dim) -> Tensor(a)"},
+       [](Node* node) -> c10::optional<SymbolicDims> {
+         auto self = dimsOf(node->input(0));
+         auto dim = constant_as<int64_t>(node->input(1));
+         if (!self || !dim) {
+           return c10::nullopt;
+         }
+         auto d = normalizeDim(*dim, self->size() + 1);
+         if (!d) {
+           return c10::nullopt;
+         }
+         self->insert(self->begin() + *d, ShapeSymbol::fromStaticSize(1));
+         return self;
+       }},
+      {{"aten::squeeze(Tensor(a) self, int dim) -> Tensor(a)"},
+       [](Node* node) -> c10::optional<SymbolicDims> {
+         auto self = dimsOf(node->input(0));
+         auto dim = constant_as<int64_t>(node->input(1));
+         if (!self || !dim) {
+           return c10::nullopt;
+         }
+         if (self->empty()) {
+           return self;
+         }
+         auto d = normalizeDim(*dim, self->size());
+         // the rank depends on whether a symbolic dimension is 1
+         if (!d || !(*self)[*d].is_static()) {
+           return c10::nullopt;
+         }
+         if (isStaticSize((*self)[*d], 1)) {
+           self->erase(self->begin() + *d);
+         }
+         return self;
+       }},
+      {{"aten::flatten(Tensor(a) self, int start_dim, int end_dim) -> Tensor(a)"},
+       [](Node* node) -> c10::optional<SymbolicDims> {
+         auto self = dimsOf(node->input(0));
+         auto start_dim = constant_as<int64_t>(node->input(1));
+         auto end_dim = constant_as<int64_t>(node->input(2));
+         if (!self || !start_dim || !end_dim) {
+           return c10::nullopt;
+         }
+         if (self->empty()) {
+           return SymbolicDims{ShapeSymbol::fromStaticSize(1)};
+         }
+         auto start = normalizeDim(*start_dim, self->size());
+         auto end = normalizeDim(*end_dim, self->size());
+         if (!start || !end || *start > *end) {
+           return c10::nullopt;
+         }
+         SymbolicDims result(self->begin(), self->begin() + *start);
+         result.push_back(productOfSymbols(self->begin() + *start, self->begin() + *end + 1));
+         result.insert(result.end(), self->begin() + *end + 1, self->end());
+         return result;
+       }},
+      {{
+           "aten::view(Tensor(a) self, int[] size) -> Tensor(a)",
+           "aten::reshape(Tensor(a) self, int[] shape) -> Tensor(a)",
+       },
+       viewFormula},
+      {{"aten::select(Tensor(a) self, int dim, int index) -> Tensor(a)"},
+       [](Node* node) -> c10::optional<SymbolicDims> {
+         auto self = dimsOf(node->input(0));
+         auto dim = constant_as<int64_t>(node->input(1));
+         if (!self || !dim) {
+           return c10::nullopt;
+         }
+         auto d = normalizeDim(*dim, self->size());
+         if (!d) {
+           return c10::nullopt;
+         }
+         self->erase(self->begin() + *d);
+         return self;
+       }},
+      {{"aten::slice(Tensor(a) self, int dim, int? start, int? end, int step) -> Tensor(a)"},
+       sliceFormula},
+      {{"aten::cat(Tensor[] tensors, int dim) -> Tensor"}, catFormula},
+      {{"aten::sum(Tensor self, *, ScalarType? dtype=None) -> Tensor"},
+       [](Node*) { return c10::optional<SymbolicDims>(SymbolicDims{}); }},
+      {{
+           "aten::sum(Tensor self, int[1] dim, bool keepdim, *, ScalarType? dtype=None) -> Tensor",
+           "aten::mean(Tensor self, int[1] dim, bool keepdim, *, ScalarType? dtype=None) -> Tensor",
+       },
+       reduceFormula},
+      {{
+           "aten::conv1d(Tensor input, Tensor weight, Tensor? bias, int[1] stride, int[1] padding, int[1] dilation, int groups) -> Tensor",
+           "aten::conv2d(Tensor input, Tensor weight, Tensor? bias, int[2] stride, int[2] padding, int[2] dilation, int groups) -> Tensor",
+           "aten::conv3d(Tensor input, Tensor weight, Tensor? bias, int[3] stride, int[3] padding, int[3] dilation, int groups) -> Tensor",
+       },
+       convFormula},
+      {{"aten::adaptive_avg_pool2d(Tensor self, int[2] output_size) -> Tensor"},
+       [](Node* node) -> c10::optional<SymbolicDims> {
+         auto self = dimsOf(node->input(0));
+         auto output_size = constantInts(node, "output_size");
+         if (!self || !output_size || self->size() < 2) {
+           return c10::nullopt;
+         }
+         SymbolicDims result(self->begin(), self->end() - 2);
+         for (size_t i = 0; i < 2; i++) {
+           result.push_back(ShapeSymbol::fromStaticSize(
+               output_size->size() == 1 ? output_size->at(0) : output_size->at(i)));
+         }
+         return result;
+       }},
+      {{"aten::embedding(Tensor weight, Tensor indices, int padding_idx, bool scale_grad_by_freq, bool sparse) -> Tensor"},
+       [](Node* node) -> c10::optional<SymbolicDims> {
+         auto weight = dimsOf(node->input(0));
+         auto indices = dimsOf(node->input(1));
+         if (!weight || !indices || weight->size() != 2) {
+           return c10::nullopt;
+         }
+         indices->push_back(weight->at(1));
+         return indices;
+       }},
+  };
+  return formulas;
+}
+
+void setSymbolicDims(Value* v, SymbolicDims dims) {
+  auto tensor_type = v->type()->cast<TensorType>();
+  if (!tensor_type || tensor_type->symbolic_sizes().isComplete()) {
+    return;
+  }
+  const size_t rank = dims.size();
+  v->setType(TensorType::create(
+      tensor_type->scalarType(),
+      tensor_type->device(),
+      SymbolicShape(std::move(dims)),
+      VaryingShape<Stride>(rank),
+      tensor_type->requiresGrad()));
+}
+
+void propagateOnNode(Node* node) {
+  if (node->outputs().size() != 1 || !node->output()->type()->cast<TensorType>()) {
+    return;
+  }
+  for (const auto& entry : shapeFormulas()) {
+    if (node->isMemberOf(entry.first)) {
+      if (auto dims = entry.second(node)) {
+        setSymbolicDims(node->output(), std::move(*dims));
+      }
+      return;
+    }
+  }
+}
+
+void propagateOnBlock(Block* block);
+
+// Both branches of an If produce an output; a dimension keeps its symbol only
+// if it has the same one in both.
+void propagateOnIf(Node* node) {
+  propagateOnBlock(node->blocks().at(0));
+  propagateOnBlock(node->blocks().at(1));
+  for (size_t i = 0; i < node->outputs().size(); i++) {
+    auto then_dims = dimsOf(node->blocks().at(0)->outputs().at(i));
+    auto else_dims = dimsOf(node->blocks().at(1)->outputs().at(i));
+    if (!then_dims || !else_dims || then_dims->size() != else_dims->size()) {
+      continue;
+    }
+    SymbolicDims dims;
+    for (size_t d = 0; d < then_dims->size(); d++) {
+      dims.push_back(
+          (*then_dims)[d] == (*else_dims)[d] ? (*then_dims)[d]
+                                             : ShapeSymbol::newSymbol());
+    }
+    setSymbolicDims(node->outputs().at(i), std::move(dims));
+  }
+}
+
+void propagateOnBlock(Block* block) {
+  for (Node* node : block->nodes()) {
+    if (node->kind() == prim::If) {
+      propagateOnIf(node);
+      continue;
+    }
+    // loop carried values may change shape between iterations, so the outputs
+    // of a Loop keep their types
+    for (Block* sub_block : node->blocks()) {
+      propagateOnBlock(sub_block);
+    }
+    propagateOnNode(node);
+  }
+}
+
+} // namespace
+
+void PropagateSymbolicShapes(const std::shared_ptr<Graph>& graph) {
+  propagateOnBlock(graph->block());
+  GRAPH_DUMP("After PropagateSymbolicShapes: ", graph);
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <memory>
+
+namespace torch {
+namespace jit {
+
+struct Graph;
+
+// Propagates symbolic shapes (see c10::SymbolicShape) from the inputs of the
+// graph to the tensors it computes. Unlike PropagateInputShapes, dimensions
+// that are not known statically are not dropped: an output dimension that is
+// provably equal to an input dimension gets that dimension's ShapeSymbol, so
+// e.g. for a Float(*, 64) input %x with symbol SS(-2) for its first dimension,
+//
+//   %y = aten::linear(%x, %w, %b)          # %w : Float(128, 64)
+//   %z = aten::view(%y, [%batch, 2, -1])   # %batch = aten::size(%x, 0)
+//
+// gets %y : Float(SS(-2), 128) and %z : Float(SS(-2), 2, 64). Dimensions that
+// cannot be expressed this way get fresh symbols. Only the shapes of the output
+// types are updated; tensors whose sizes are already complete are left alone.
+TORCH_API void PropagateSymbolicShapes(const std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
@@ -28,6 +28,8 @@ namespace torch {
 namespace jit {
 
 static bool texpr_reductions_enabled = false;
+static bool texpr_cpu_reductions_enabled = true;
+static bool texpr_symbolic_shapes_enabled = false;
 
 bool isSupportedForBlock(Node* node) {
   switch (node->kind()) {
@@ -169,18 +171,24 @@ static const OperatorSet& supported_eltwise_set() {
   return supported_eltwise_set;
 }
 
-bool isSupported(Node* node) {
-  // For Block codegen we allow limited ops.
-  if (tensorexpr::getTEGenerateBlockCode()) {
-    return isSupportedForBlock(node);
-  }
-
+static const OperatorSet& supported_reduction_set() {
+  // clang-format off
   static const OperatorSet supported_reduction_set{
       "aten::sum(Tensor self, *, ScalarType? dtype=None) -> Tensor",
       "aten::sum.dim_IntList(Tensor self, int[1] dim, bool keepdim=False, *, ScalarType? dtype=None) -> Tensor",
       "aten::softmax.int(Tensor self, int dim , ScalarType? dtype=None) -> Tensor",
       "aten::log_softmax.int(Tensor self, int dim, ScalarType? dtype=None) -> Tensor",
   };
+  // clang-format on
+  return supported_reduction_set;
+}
+
+bool isSupported(Node* node) {
+  // For Block codegen we allow limited ops.
+  if (tensorexpr::getTEGenerateBlockCode()) {
+    return isSupportedForBlock(node);
+  }
+
   static const OperatorSet supported_misc_set{
       "aten::cat(Tensor[] tensors, int dim=0) -> Tensor",
       "aten::unsqueeze(Tensor(a) self, int dim) -> Tensor(a)",
@@ -189,7 +197,8 @@ bool isSupported(Node* node) {
 
   if (node->isMemberOf(supported_eltwise_set()) ||
       node->isMemberOf(supported_misc_set) ||
-      (texpr_reductions_enabled && node->isMemberOf(supported_reduction_set))) {
+      ((texpr_reductions_enabled || texpr_cpu_reductions_enabled) &&
+       node->isMemberOf(supported_reduction_set()))) {
     // We only insert guards on Tensor types, so we rely on the output
     // of a node being uniquely determined by its input types.
     // bail if any non-Tensor input affects the output type
@@ -258,6 +267,26 @@ bool texprReductionsEnabled() {
   return texpr_reductions_enabled;
 }
 
+bool setTexprCpuReductionsEnabled(bool value) {
+  bool old_value = texpr_cpu_reductions_enabled;
+  texpr_cpu_reductions_enabled = value;
+  return old_value;
+}
+
+bool texprCpuReductionsEnabled() {
+  return texpr_cpu_reductions_enabled;
+}
+
+bool setTexprSymbolicShapesEnabled(bool value) {
+  bool old_value = texpr_symbolic_shapes_enabled;
+  texpr_symbolic_shapes_enabled = value;
+  return old_value;
+}
+
+bool texprSymbolicShapesEnabled() {
+  return texpr_symbolic_shapes_enabled;
+}
+
 void removeProfileNodesAndSpecializeTypes(Block* b) {
   for (auto it = b->nodes().begin(); it != b->nodes().end(); it++) {
     if (it->kind() == prim::profile) {
@@ -830,18 +859,42 @@ class TensorExprFuser {
     return true;
   }
   bool allShapesAreKnown(Node* node) {
-    // TODO: Relax the checks to support dynamic shapes
+    bool known = true;
     for (Value* input : node->inputs()) {
-      if (!shapeIsKnown(input)) {
-        return false;
-      }
+      known = known && shapeIsKnown(input);
     }
     for (Value* output : node->outputs()) {
-      if (!shapeIsKnown(output)) {
-        return false;
+      known = known && shapeIsKnown(output);
+    }
+    return known ||
+        (texpr_symbolic_shapes_enabled && symbolicShapesAreSupported(node));
+  }
+
+  // Elementwise nodes whose tensors all have the same symbolic shape, so that
+  // the kernel does not have to decide about broadcasting at runtime, see
+  // Note [Symbolic shapes in NNC]
+  bool symbolicShapesAreSupported(Node* node) {
+    if (!node->isMemberOf(tensorexpr::supported_eltwise_set())) {
+      return false;
+    }
+    c10::optional<std::vector<c10::ShapeSymbol>> shape;
+    for (auto values : {node->inputs(), node->outputs()}) {
+      for (Value* v : values) {
+        auto tt = v->type()->cast<TensorType>();
+        if (!tt) {
+          continue;
+        }
+        if (!tensorexpr::symbolicShapeIsSupported(tt)) {
+          return false;
+        }
+        auto sizes = *tt->symbolic_sizes().sizes();
+        if (shape && *shape != sizes) {
+          return false;
+        }
+        shape = std::move(sizes);
       }
     }
-    return true;
+    return shape.has_value();
   }
 
   bool canFuseOnDevice(Value* v) {
@@ -961,6 +1014,16 @@ class TensorExprFuser {
       }
     }
 
+    // Reductions are fused on CPU unless disabled there, and on other devices
+    // only when texprReductionsEnabled() is set.
+    if (node->isMemberOf(tensorexpr::supported_reduction_set()) &&
+        !texprReductionsEnabled()) {
+      auto device = tensorexpr::pickDeviceType(node->inputs());
+      if (!device || !device->is_cpu() || !texprCpuReductionsEnabled()) {
+        return false;
+      }
+    }
+
     if (node->kind() == aten::to) {
       // only support same-device conversion
       auto device = tensorexpr::pickDeviceType(node->inputs());
@@ -1167,7 +1230,20 @@ class TensorExprFuser {
       liftTensorConstantsFromFusionGroups(fusion_group);
       insertTypeGuard(
           fusion_group,
-          [](const TensorTypePtr& t) { return t; },
+          [](const TensorTypePtr& t) {
+            if (!texpr_symbolic_shapes_enabled || t->isComplete()) {
+              return t;
+            }
+            // the kernel checks the sizes and strides of inputs with
+            // symbolic dims, see Note [Symbolic shapes in NNC]
+            return TensorType::create(
+                t->scalarType(),
+                t->device(),
+                t->symbolic_sizes(),
+                VaryingShape<Stride>(),
+                t->requiresGrad(),
+                t->undefined());
+          },
           prim::TypeCheck);
     }
   }
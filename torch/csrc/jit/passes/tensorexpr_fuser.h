@@ -24,6 +24,13 @@ TORCH_API void setTensorExprFuserEnabled(bool val);
 TORCH_API bool tensorExprFuserEnabled();
 TORCH_API bool setTexprReductionsEnabled(bool value);
 TORCH_API bool texprReductionsEnabled();
+// Fuse reductions and softmax on CPU even if texprReductionsEnabled() is off
+TORCH_API bool setTexprCpuReductionsEnabled(bool value);
+TORCH_API bool texprCpuReductionsEnabled();
+// Fuse nodes whose profiled shapes have dims that vary across runs, compiling
+// kernels that take those dims as arguments instead of specializing on sizes
+TORCH_API bool setTexprSymbolicShapesEnabled(bool value);
+TORCH_API bool texprSymbolicShapesEnabled();
 
 TORCH_API void RemoveProfileNodesAndSpecializeTypes(
     std::shared_ptr<Graph>& graph);
@@ -9,6 +9,7 @@
 #include <torch/csrc/jit/frontend/ir_emitter.h>
 #include <torch/csrc/jit/frontend/tracer.h>
 #include <torch/csrc/jit/ir/irparser.h>
+#include <torch/csrc/jit/passes/batch_mm.h>
 #include <torch/csrc/jit/passes/canonicalize.h>
 #include <torch/csrc/jit/passes/canonicalize_graph_fuser_ops.h>
 #include <torch/csrc/jit/passes/common_subexpression_elimination.h>
@@ -24,6 +25,8 @@
 #include <torch/csrc/jit/passes/freeze_module.h>
 #include <torch/csrc/jit/passes/frozen_conv_add_relu_fusion.h>
 #include <torch/csrc/jit/passes/frozen_conv_folding.h>
+#include <torch/csrc/jit/passes/frozen_linear_folding.h>
+#include <torch/csrc/jit/passes/frozen_linear_prepack.h>
 #include <torch/csrc/jit/passes/frozen_graph_optimizations.h>
 #include <torch/csrc/jit/passes/frozen_ops_to_mkldnn.h>
 #include <torch/csrc/jit/passes/fuse_linear.h>
@@ -68,6 +71,7 @@
 #include <torch/csrc/jit/passes/shape_analysis.h>
 #include <torch/csrc/jit/passes/specialize_autogradzero.h>
 #include <torch/csrc/jit/passes/subgraph_rewrite.h>
+#include <torch/csrc/jit/passes/symbolic_shape_analysis.h>
 #include <torch/csrc/jit/passes/tensorexpr_fuser.h>
 #include <torch/csrc/jit/passes/utils/check_alias_annotation.h>
 #include <torch/csrc/jit/passes/vulkan_rewrite.h>
@@ -160,6 +164,7 @@ void initJITBindings(PyObject* module) {
             ONNXAssignOutputShape(graph, tensors, desc, onnx_shape_inference);
           })
       .def("_jit_pass_lower_all_tuples", LowerAllTuples)
+      .def("_jit_pass_batch_mm", BatchMM)
       .def("_jit_pass_onnx_function_substitution", ONNXFunctionCallSubstitution)
       .def(
           "_jit_pass_onnx_fold_if",
@@ -317,6 +322,18 @@ void initJITBindings(PyObject* module) {
       .def("_jit_pass_fold_frozen_conv_bn", &FoldFrozenConvBatchnorm)
       .def("_jit_pass_fold_frozen_conv_add_or_sub", &FoldFrozenConvAddOrSub)
       .def("_jit_pass_fold_frozen_conv_mul_or_div", &FoldFrozenConvMulOrDiv)
+      .def("_jit_pass_fold_frozen_linear_bn", &FoldFrozenLinearBatchnorm)
+      .def(
+          "_jit_pass_fold_frozen_linear_add_or_sub", &FoldFrozenLinearAddOrSub)
+      .def(
+          "_jit_pass_fold_frozen_linear_mul_or_div", &FoldFrozenLinearMulOrDiv)
+      .def(
+          "_jit_pass_convert_frozen_matmul_to_linear",
+          &ConvertFrozenMatmulToLinear)
+      .def(
+          "_jit_pass_merge_frozen_parallel_linears",
+          &MergeFrozenParallelLinears)
+      .def("_jit_pass_prepack_frozen_linear", &PrepackFrozenLinear)
       .def("_jit_pass_convert_frozen_ops_to_mkldnn", &ConvertFrozenOpsToMKLDNN)
       .def("_jit_pass_fuse_frozen_conv_add_relu", &FuseFrozenConvAddRelu)
       .def("_jit_pass_optimize_frozen_graph", &OptimizeFrozenGraph)
@@ -459,6 +476,11 @@ void initJITBindings(PyObject* module) {
           [](std::shared_ptr<Graph>& g) { return ConstantPropagation(g); },
           py::arg("graph"))
       .def("_jit_pass_erase_shape_information", EraseShapeInformation)
+      .def(
+          "_jit_pass_propagate_symbolic_shapes",
+          [](const std::shared_ptr<Graph>& graph) {
+            PropagateSymbolicShapes(graph);
+          })
       .def(
           "_jit_pass_create_autodiff_subgraphs",
           [](const std::shared_ptr<Graph>& graph) {
@@ -570,6 +592,13 @@ void initJITBindings(PyObject* module) {
             getBailoutDepth() = depth;
             return old_depth;
           })
+      .def(
+          "_jit_set_num_specializations",
+          [](size_t num) {
+            size_t old_num = getNumSpecializations();
+            getNumSpecializations() = num;
+            return old_num;
+          })
       .def(
           "_jit_set_inline_everything_mode",
           [](bool enabled) { getInlineEverythingMode() = enabled; })
@@ -631,6 +660,14 @@ void initJITBindings(PyObject* module) {
       .def("_jit_texpr_set_fallback_allowed", &tensorexpr::setFallbackAllowed)
       .def("_jit_set_texpr_reductions_enabled", &setTexprReductionsEnabled)
       .def("_jit_texpr_reductions_enabled", &texprReductionsEnabled)
+      .def(
+          "_jit_set_texpr_cpu_reductions_enabled",
+          &setTexprCpuReductionsEnabled)
+      .def("_jit_texpr_cpu_reductions_enabled", &texprCpuReductionsEnabled)
+      .def(
+          "_jit_set_texpr_symbolic_shapes_enabled",
+          &setTexprSymbolicShapesEnabled)
+      .def("_jit_texpr_symbolic_shapes_enabled", &texprSymbolicShapesEnabled)
       .def(
           "_jit_set_te_generate_block_code",
           [](bool gen_block_code) {
@@ -643,6 +680,30 @@ void initJITBindings(PyObject* module) {
             using namespace torch::jit::tensorexpr;
             return getTEGenerateBlockCode();
           })
+      .def(
+          "_jit_set_te_tune_loop_schedules",
+          [](bool tune) {
+            using namespace torch::jit::tensorexpr;
+            return getTETuneLoopSchedules() = tune;
+          })
+      .def(
+          "_jit_get_te_tune_loop_schedules",
+          []() -> bool {
+            using namespace torch::jit::tensorexpr;
+            return getTETuneLoopSchedules();
+          })
+      .def(
+          "_jit_set_te_tuning_log",
+          [](std::string path) {
+            using namespace torch::jit::tensorexpr;
+            setTETuningLogPath(std::move(path));
+          })
+      .def(
+          "_jit_get_te_tuning_log",
+          []() {
+            using namespace torch::jit::tensorexpr;
+            return getTETuningLogPath();
+          })
       .def(
           "_jit_get_te_must_use_llvm_cpu",
           []() -> bool {
@@ -0,0 +1,74 @@
+#include <torch/csrc/jit/runtime/disk_cache.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+
+namespace torch {
+namespace jit {
+
+DiskCache::DiskCache(const char* dir_env_var, std::string extension)
+    : extension_(std::move(extension)) {
+  const char* dir_env = std::getenv(dir_env_var);
+  dir_ = dir_env ? dir_env : "";
+}
+
+void DiskCache::setDir(std::string dir) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  dir_ = std::move(dir);
+}
+
+std::string DiskCache::dir() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return dir_;
+}
+
+std::string DiskCache::entryPath(const std::string& dir, const std::string& key)
+    const {
+  return dir + "/" + key + extension_;
+}
+
+c10::optional<std::string> DiskCache::load(const std::string& key) const {
+  const auto cache_dir = dir();
+  if (cache_dir.empty()) {
+    return c10::nullopt;
+  }
+  std::ifstream in(entryPath(cache_dir, key), std::ios::in | std::ios::binary);
+  if (!in) {
+    return c10::nullopt;
+  }
+  return std::string(
+      std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+bool DiskCache::store(const std::string& key, const std::string& contents)
+    const {
+  const auto cache_dir = dir();
+  if (cache_dir.empty()) {
+    return false;
+  }
+  // write to a temporary file and rename it so that concurrent readers never
+  // see a partial entry
+  const std::string path = entryPath(cache_dir, key);
+  std::stringstream tmp;
+  tmp << path << ".tmp" << std::hex << std::random_device()();
+  {
+    std::ofstream out(tmp.str(), std::ios::out | std::ios::binary);
+    out.write(contents.data(), contents.size());
+    if (!out) {
+      std::remove(tmp.str().c_str());
+      return false;
+    }
+  }
+  if (std::rename(tmp.str().c_str(), path.c_str()) != 0) {
+    std::remove(tmp.str().c_str());
+    return false;
+  }
+  return true;
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <c10/util/Optional.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <mutex>
+#include <string>
+
+namespace torch {
+namespace jit {
+
+// Note [On-disk caches]
+// ~~~~~~~~~~~~~~~~~~~~~
+// A DiskCache is a directory of entries that outlive the process, each one a
+// file named after its key, shared by every process that uses the same
+// directory. It backs the profiled graph cache and the CUDA fuser's kernel
+// binary cache.
+//
+// The directory is read from an environment variable when the cache is
+// created and can be changed later with setDir. An empty directory (the
+// default) disables the cache: load finds nothing and store does nothing.
+//
+// Keys are expected to be hashes computed with c10::stable_hash, which is the
+// same in every process and build. Entries are written to a temporary file
+// that is renamed into place, so processes storing the same entry
+// concurrently never read a partial one. Callers must still validate what
+// they load, since a directory can hold entries of older versions.
+class TORCH_API DiskCache {
+ public:
+  // Entries are stored as <dir>/<key><extension>.
+  DiskCache(const char* dir_env_var, std::string extension);
+
+  void setDir(std::string dir);
+  std::string dir() const;
+
+  // Returns the contents of the entry for key, if there is one.
+  c10::optional<std::string> load(const std::string& key) const;
+  // Returns whether the entry was stored.
+  bool store(const std::string& key, const std::string& contents) const;
+
+ private:
+  std::string entryPath(const std::string& dir, const std::string& key) const;
+
+  mutable std::mutex mutex_;
+  std::string dir_;
+  const std::string extension_;
+};
+
+} // namespace jit
+} // namespace torch
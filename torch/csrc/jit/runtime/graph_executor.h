@@ -110,6 +110,9 @@ TORCH_API std::atomic<bool>& getProfilingMode();
 TORCH_API std::atomic<bool>& getExecutorMode();
 TORCH_API std::atomic<size_t>& getNumProfiledRuns();
 TORCH_API std::atomic<size_t>& getBailoutDepth();
+// Number of optimized plans a profiling executor keeps for different input
+// types, see Note [Specialized plans]
+TORCH_API std::atomic<size_t>& getNumSpecializations();
 TORCH_API bool IsNewExecutorEnabled();
 
 struct TORCH_API GraphOptimizerEnabledGuard {
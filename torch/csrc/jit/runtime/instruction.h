@@ -54,7 +54,14 @@ namespace jit {
   _(FORK, "CN") /* launch a thread to run code entry x with N inputs  */       \
   _(WARN, "I") /* emit a warning with line information */                      \
   _(ENTER, "EN") /* enter scope of a contextmanager */                         \
-  _(EXIT, "EX") /* exit the last entered contextmanager */
+  _(EXIT, "EX") /* exit the last entered contextmanager */                     \
+  /* superinstructions, only found in the code the interpreter runs, see */    \
+  /* Note [Interpreter superinstructions] */                                   \
+  _(PUSH_OP, "RI") /* the N pushes starting here, then the OP after them */    \
+  _(PUSH_OP_STORE, "RI") /* PUSH_OP, then the STORE after the OP */            \
+  _(OP_STORE, "O") /* invoke operator X, then the STORE after it */            \
+  _(REG_OP, "RI") /* PUSH_OP through the register calling convention */        \
+  _(REG_OP_STORE, "RI") /* REG_OP, then the STORE after the OP */
 
 enum OpCode : uint8_t {
 #define DEFINE_OP(op, _) op,
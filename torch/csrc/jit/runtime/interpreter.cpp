@@ -1,6 +1,8 @@
 #include <torch/csrc/jit/runtime/interpreter.h>
 
+#include <ATen/InterOpPriority.h>
 #include <ATen/Parallel.h>
+#include <ATen/core/Vitals.h>
 #include <ATen/core/ivalue.h>
 #include <ATen/record_function.h>
 #include <c10/core/thread_pool.h>
@@ -22,6 +24,7 @@
 #include <torch/csrc/jit/runtime/jit_exception.h>
 #include <torch/csrc/jit/runtime/operator.h>
 #include <torch/csrc/jit/runtime/profiling_record.h>
+#include <torch/csrc/jit/runtime/register_calls.h>
 #include <torch/csrc/jit/runtime/vararg_functions.h>
 
 #ifdef USE_RPC
@@ -29,6 +32,7 @@
 using torch::distributed::autograd::DistAutogradContainer;
 #endif
 
+#include <algorithm>
 #include <exception>
 #include <iostream>
 #include <memory>
@@ -41,6 +45,21 @@ using torch::distributed::autograd::DistAutogradContainer;
 #include <utility>
 #include <vector>
 
+// Note [Interpreter dispatch]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// With compilers that support labels as values, InterpreterStateImpl::runImpl
+// dispatches through a table of labels, and each instruction jumps to the
+// next one itself (DISPATCH), instead of going back to a single switch. The
+// indirect branch of each instruction is then predicted from the instruction
+// before it, which is what makes the sequences of common instructions cheap.
+// The handlers are written once, INST and DISPATCH expand to case labels and
+// breaks of a switch for the other compilers.
+#if defined(__GNUC__) || defined(__clang__)
+#define TORCH_JIT_COMPUTED_GOTO 1
+#else
+#define TORCH_JIT_COMPUTED_GOTO 0
+#endif
+
 namespace torch {
 namespace jit {
 
@@ -441,9 +460,37 @@ Ttarget safe_narrow_cast(Tsource v) {
   return res;
 }
 
+// Note [Interpreter superinstructions]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Most of the instructions of scalar code come in sequences like
+// LOAD, LOAD, OP, STORE: the inputs of an operator are pushed, it runs, and
+// its output is stored to a register. Dispatching each of them costs an
+// unpredictable indirect branch and a reload of the frame, which dominates
+// when the operators themselves are cheap. So the code the interpreter runs,
+// dispatch_instructions_, is a copy of instructions_ in which the first
+// instruction of each such sequence is replaced by a superinstruction that
+// runs the whole sequence:
+// - PUSH_OP: 1 to kMaxFusedPushes LOAD, MOVE or LOADC followed by an OP
+// - PUSH_OP_STORE: PUSH_OP followed by a STORE
+// - OP_STORE: an OP followed by a STORE
+// - REG_OP, REG_OP_STORE: PUSH_OP and PUSH_OP_STORE of an operator that has a
+//   RegisterOperation, when the pushes are all of its inputs. The operator is
+//   passed pointers to the operands instead of a stack, and the registers of
+//   the MOVEs are cleared after the call, see
+//   Note [Register calling convention]
+// The N of a PUSH_OP or REG_OP is the number of pushes, the operands are read
+// from instructions_. The other instructions of the sequence are left as they
+// are, so that the program counters don't change and jumps into the middle of
+// a sequence still run the rest of it. instructions_ is what gets dumped and
+// exported, superinstructions never leave the interpreter.
+constexpr size_t kMaxFusedPushes = 4;
+
 struct CodeImpl {
   friend struct InterpreterState;
   std::vector<Instruction> instructions_;
+  // instructions_ with superinstructions, what the interpreter runs, see
+  // Note [Interpreter superinstructions]
+  std::vector<Instruction> dispatch_instructions_;
 
   // same length as instructions.
   // what node in the graph cause this
@@ -452,6 +499,9 @@ struct CodeImpl {
 
   std::vector<IValue> constant_table_;
   std::vector<Operation> operator_table_;
+  // same length as operator_table_, nullptr for the operators without a
+  // RegisterOperation
+  std::vector<RegisterOperation> register_operation_table_;
   std::vector<Function*> function_table_;
   std::vector<std::unique_ptr<GraphFunction>> forked_functions_;
   std::vector<TypePtr> type_table_;
@@ -514,6 +564,44 @@ struct CodeImpl {
     // we deferred the emission of bailout blocks so they appear at the end
     // emit them now and patch up the jumps
     insertBailoutBlocks();
+    emitSuperinstructions();
+  }
+
+  void emitSuperinstructions() {
+    dispatch_instructions_ = instructions_;
+    auto is_push = [](OpCode op) {
+      return op == LOAD || op == MOVE || op == LOADC;
+    };
+    const size_t size = instructions_.size();
+    size_t i = 0;
+    while (i < size) {
+      size_t pushes = 0;
+      while (i + pushes < size && pushes < kMaxFusedPushes &&
+             is_push(instructions_[i + pushes].op)) {
+        pushes++;
+      }
+      const size_t op_index = i + pushes;
+      if (op_index == size || instructions_[op_index].op != OP) {
+        i += std::max<size_t>(pushes, 1);
+        continue;
+      }
+      const bool store =
+          op_index + 1 < size && instructions_[op_index + 1].op == STORE;
+      Instruction& head = dispatch_instructions_[i];
+      const bool register_call = pushes > 0 &&
+          register_operation_table_[instructions_[op_index].X] &&
+          instructions_source_[op_index]->inputs().size() == pushes;
+      if (register_call) {
+        head.op = store ? REG_OP_STORE : REG_OP;
+        head.N = pushes;
+      } else if (pushes > 0) {
+        head.op = store ? PUSH_OP_STORE : PUSH_OP;
+        head.N = pushes;
+      } else if (store) {
+        head.op = OP_STORE;
+      }
+      i = op_index + (store ? 2 : 1);
+    }
   }
 
   const std::vector<c10::IValue>& constant_table() const {
@@ -529,6 +617,7 @@ struct CodeImpl {
         if (count-- == 0) {
           // patching GUARD to FAIL_GUARD
           instructions_[instr_index].op = FAIL_GUARD;
+          dispatch_instructions_[instr_index].op = FAIL_GUARD;
           GRAPH_DEBUG(
               "Added a bailout request for ",
               index,
@@ -639,8 +728,10 @@ struct CodeImpl {
     const Operator& op = node->getOperator();
     if (op.hasOperation() && op.schema().is_vararg()) {
       insertInstruction(OPN, operator_table_.size(), node->inputs().size());
+      register_operation_table_.push_back(nullptr);
     } else {
       insertInstruction(OP, operator_table_.size());
+      register_operation_table_.push_back(findRegisterOperation(node));
     }
     operator_table_.emplace_back(op.getOperation(node));
   }
@@ -1145,6 +1236,40 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
     return *(registers.end() - reg);
   }
 
+  // pushes the operand of a LOAD, MOVE or LOADC run by a superinstruction
+  void pushOperand(Stack& stack, const Instruction& inst) {
+    switch (inst.op) {
+      case LOAD:
+        stack.emplace_back(reg(inst.X));
+        break;
+      case MOVE:
+        stack.emplace_back(std::move(reg(inst.X)));
+        break;
+      default:
+        stack.emplace_back(frames.back().function->constant_table_[inst.X]);
+        break;
+    }
+  }
+
+  // points args at the operands of the n LOAD, MOVE or LOADC at code, for a
+  // RegisterOperation
+  void loadOperands(const Instruction* code, size_t n, const IValue** args) {
+    for (size_t i = 0; i < n; ++i) {
+      args[i] = code[i].op == LOADC
+          ? &frames.back().function->constant_table_[code[i].X]
+          : &reg(code[i].X);
+    }
+  }
+
+  // what the MOVEs among the operands would have left behind
+  void clearMovedOperands(const Instruction* code, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      if (code[i].op == MOVE) {
+        reg(code[i].X) = IValue();
+      }
+    }
+  }
+
   void dump(std::ostream& out, const Stack& stack) const {
     out << "Stack:\n";
     for (const auto& val : stack) {
@@ -1196,20 +1321,45 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
     if (frames.back().pc == 0 && stack_start_ == 0) {
       checkAndStartRecordFunction(frames.back(), stack);
     }
+    // See Note [Interpreter dispatch]
+    Frame* frame = nullptr;
+    Instruction inst(RET, 0, 0);
+#if TORCH_JIT_COMPUTED_GOTO
+    static const void* const dispatch_table[] = {
+#define DISPATCH_LABEL(op, _) &&label_##op,
+        FORALL_OPCODES(DISPATCH_LABEL)
+#undef DISPATCH_LABEL
+    };
+#define INST(op) label_##op
+#define DISPATCH()                                             \
+  do {                                                         \
+    frame = &frames.back();                                    \
+    inst = frame->function->dispatch_instructions_[frame->pc]; \
+    goto* dispatch_table[inst.op];                             \
+  } while (false)
+#else
+#define INST(op) case op
+#define DISPATCH() break
+#endif
     try {
       while (true) {
-        Frame& frame = frames.back();
+        frame = &frames.back();
         // std::cout << "RUNNING ";
-        // frames.back().function->dump(std::cout, frame.pc);
-        Instruction inst = frame.function->instructions_[frame.pc];
+        // frames.back().function->dump(std::cout, frame->pc);
+        inst = frame->function->dispatch_instructions_[frame->pc];
+#if TORCH_JIT_COMPUTED_GOTO
+        goto* dispatch_table[inst.op];
+        {
+#else
         switch (inst.op) {
-          case ENTER: {
+#endif
+          INST(ENTER): {
             const auto& obj = peek(stack, 0, 1);
             TORCH_INTERNAL_ASSERT(obj.isObject());
             entered_objects.push_back(obj);
-            ++frame.pc;
-          } break;
-          case EXIT: {
+            ++frame->pc;
+          } DISPATCH();
+          INST(EXIT): {
             auto obj = entered_objects.back().toObject();
             auto& f = obj->type()->getMethod("__exit__");
             push(stack, std::move(obj));
@@ -1218,65 +1368,65 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             push(stack, IValue());
             push(stack, IValue());
             runGraphFunction(stack, &f);
-          } break;
-          case OP:
-            frame.function->operator_table_[inst.X](&stack);
-            ++frame.pc;
-            break;
-          case OPN:
+          } DISPATCH();
+          INST(OP):
+            frame->function->operator_table_[inst.X](&stack);
+            ++frame->pc;
+            DISPATCH();
+          INST(OPN):
             stack.push_back(inst.N);
-            frame.function->operator_table_[inst.X](&stack);
-            ++frame.pc;
-            break;
-          case LOAD:
+            frame->function->operator_table_[inst.X](&stack);
+            ++frame->pc;
+            DISPATCH();
+          INST(LOAD):
             stack.emplace_back(reg(inst.X));
-            ++frame.pc;
-            break;
-          case MOVE:
+            ++frame->pc;
+            DISPATCH();
+          INST(MOVE):
             stack.emplace_back(std::move(reg(inst.X)));
-            ++frame.pc;
-            break;
-          case STORE:
+            ++frame->pc;
+            DISPATCH();
+          INST(STORE):
             reg(inst.X) = pop(stack);
-            ++frame.pc;
-            break;
-          case STOREN:
+            ++frame->pc;
+            DISPATCH();
+          INST(STOREN):
             for (size_t i = inst.N; i > 0; --i) {
               reg(inst.X + i - 1) = pop(stack);
             }
-            ++frame.pc;
-            break;
-          case DROP:
+            ++frame->pc;
+            DISPATCH();
+          INST(DROP):
             pop(stack);
-            ++frame.pc;
-            break;
-          case DROPR:
+            ++frame->pc;
+            DISPATCH();
+          INST(DROPR):
             reg(inst.X) = IValue();
-            ++frame.pc;
-            break;
-          case LOADC:
-            stack.emplace_back(frame.function->constant_table_[inst.X]);
-            ++frame.pc;
-            break;
-          case GET_ATTR: {
+            ++frame->pc;
+            DISPATCH();
+          INST(LOADC):
+            stack.emplace_back(frame->function->constant_table_[inst.X]);
+            ++frame->pc;
+            DISPATCH();
+          INST(GET_ATTR): {
             auto userObj = pop(stack).toObject();
             auto value = userObj->getSlot(inst.X);
             push(stack, std::move(value));
-            ++frame.pc;
-          } break;
-          case SET_ATTR: {
+            ++frame->pc;
+          } DISPATCH();
+          INST(SET_ATTR): {
             auto v = pop(stack);
             auto userObj = pop(stack).toObject();
             userObj->setSlot(inst.X, std::move(v));
-            ++frame.pc;
-          } break;
-          case JF:
-            frame.pc += (pop(stack).toBool()) ? 1 : inst.X;
-            break;
-          case JMP:
-            frame.pc += inst.X;
-            break;
-          case LOOP: {
+            ++frame->pc;
+          } DISPATCH();
+          INST(JF):
+            frame->pc += (pop(stack).toBool()) ? 1 : inst.X;
+            DISPATCH();
+          INST(JMP):
+            frame->pc += inst.X;
+            DISPATCH();
+          INST(LOOP): {
             // stack: iteration_count, max_iter, cond, loop_carried_deps...
             auto fr = stack.end() - (inst.N + 1);
             int64_t trip_count = fr[0].toInt();
@@ -1285,25 +1435,25 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             if (trip_count < max_trip_count && cond) {
               fr[2] = trip_count;
               fr[0] = trip_count + 1;
-              ++frame.pc;
+              ++frame->pc;
             } else {
               size_t n_loop_carried = inst.N - 2;
               for (size_t i = 0; i < n_loop_carried; ++i) {
                 fr[i] = std::move(fr[i + 3]);
               }
               drop(stack, 3); // iteration_count, max_iter, cond
-              frame.pc += inst.X;
+              frame->pc += inst.X;
             }
-          } break;
-          case CALL: {
-            Function* fn = frame.function->function_table_[inst.X];
+          } DISPATCH();
+          INST(CALL): {
+            Function* fn = frame->function->function_table_[inst.X];
             if (!fn->isGraphFunction()) {
               runBuiltinFunction(stack, fn);
             } else {
               runGraphFunction(stack, fn);
             }
-          } break;
-          case INTERFACE_CALL: {
+          } DISPATCH();
+          INST(INTERFACE_CALL): {
             // note the hash table lookup to find the function
             // this can be more optimized if necessary, caching parts
             // of the hashing computation or storing the offset when
@@ -1321,17 +1471,17 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
                     .toObject()
                     ->type()
                     ->getMethod(
-                        frame.function->constant_table_[inst.X].toStringRef());
+                        frame->function->constant_table_[inst.X].toStringRef());
             if (!function.isGraphFunction()) {
               runBuiltinFunction(stack, &function);
             } else {
               runGraphFunction(stack, &function);
             }
-          } break;
-          case RET:
+          } DISPATCH();
+          INST(RET):
             if (frames.size() > 1) {
               leaveFrame();
-              break;
+              DISPATCH();
             }
             if (future_) {
               auto num_outputs = frames.back().function->n_outputs;
@@ -1345,9 +1495,10 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             // destroy the last frame and call RecordFunction's end callbacks
             leaveFrame();
             return false;
-          case WAIT: {
+          INST(WAIT): {
             auto future = stack.back().toFuture();
             if (!future->completed()) {
+              at::raise_interop_priority_for(*future);
               getOrCreateFuture();
 
               // callback needs to be a struct rather than a lambda so that
@@ -1400,39 +1551,43 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             }
             stack.pop_back();
             stack.emplace_back(future->value());
-            ++frame.pc;
-          } break;
-          case PROFILE_OP: {
-            auto& frame_id_ref = frame.id;
+            ++frame->pc;
+          } DISPATCH();
+          INST(PROFILE_OP): {
+            auto& frame_id_ref = frame->id;
             if (!frame_id_ref.has_value()) {
               frame_id_ref = Frame::num_frames++;
             }
             const auto& callback =
-                frame.function->profile_function_table_[inst.X];
+                frame->function->profile_function_table_[inst.X];
             push(stack, c10::IValue{static_cast<int64_t>(*frame_id_ref)});
             callback(stack);
-            ++frame.pc;
-            break;
+            ++frame->pc;
+            DISPATCH();
           }
-          case FAIL_GUARD: {
+          INST(FAIL_GUARD): {
             // patch FAIL_GUARD back to GUARD
             GRAPH_DEBUG(
                 "Bailout ", inst.X, " triggered via bailout_requests_!");
-            frame.function->instructions_[frame.pc].op = GUARD;
+            frame->function->instructions_[frame->pc].op = GUARD;
+            frame->function->dispatch_instructions_[frame->pc].op = GUARD;
+            TORCH_VITAL_COUNT("jit.guard_failures", 1);
             push(stack, false);
-            ++frame.pc;
-            break;
+            ++frame->pc;
+            DISPATCH();
           }
-          case TYPECHECK: {
+          INST(TYPECHECK): {
             int num_inputs = inst.N, i = 0;
             TORCH_INTERNAL_ASSERT(stack.size() >= num_inputs && num_inputs > 0);
             // Check every input's shape against profiled (expected) shape.
             for (i = 0; i < num_inputs; i++) {
               auto& input = peek(stack, i, num_inputs);
               auto& t = input.toTensor();
-              const TypePtr& expected = frame.function->type_table_[inst.X + i];
+              const TypePtr& expected =
+                  frame->function->type_table_[inst.X + i];
               auto* expected_type = expected->castRaw<TensorType>();
               if (t.defined() && !expected_type->matchTensor(t)) {
+                TORCH_VITAL_COUNT("jit.typecheck_failures", 1);
                 push(stack, false);
                 break;
               }
@@ -1440,10 +1595,10 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             if (i == num_inputs) {
               push(stack, true);
             }
-            ++frame.pc;
-            break;
+            ++frame->pc;
+            DISPATCH();
           }
-          case GUARD: {
+          INST(GUARD): {
             if (!stack.back().isTensor()) {
               // stack.back() is an Uninitialized IValue and this is a guard
               // on a block output. Uninitialized IValues are never used
@@ -1451,31 +1606,36 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
               push(stack, true);
             } else {
               auto& t = stack.back().toTensor();
-              const TypePtr& expected = frame.function->type_table_[inst.X];
+              const TypePtr& expected = frame->function->type_table_[inst.X];
               auto* expected_type = expected->castRaw<TensorType>();
               if (t.defined() &&
                   !frames.back().symbols2dims.bindSymbolicShapes(
                       t.sizes(), expected_type->symbolic_sizes())) {
+                TORCH_VITAL_COUNT("jit.guard_failures", 1);
                 push(stack, false);
               } else {
-                push(stack, expected_type->matchTensor(t));
+                bool matches = expected_type->matchTensor(t);
+                if (!matches) {
+                  TORCH_VITAL_COUNT("jit.guard_failures", 1);
+                }
+                push(stack, matches);
               }
             }
-            ++frame.pc;
-          } break;
-          case TAIL_CALL: {
+            ++frame->pc;
+          } DISPATCH();
+          INST(TAIL_CALL): {
             GRAPH_DEBUG("running TAIL_CALL for ", inst.X);
-            frame.function->function_table_[inst.X]->ensure_defined();
+            frame->function->function_table_[inst.X]->ensure_defined();
             size_t remaining_bailout_depth =
-                frame.function->remaining_bailout_depth_ > 0
-                ? frame.function->remaining_bailout_depth_ - 1
+                frame->function->remaining_bailout_depth_ > 0
+                ? frame->function->remaining_bailout_depth_ - 1
                 : 0;
-            const Code& code = frame.function->function_table_[inst.X]
+            const Code& code = frame->function->function_table_[inst.X]
                                    ->get_executor()
                                    .getPlanFor(stack, remaining_bailout_depth)
                                    .code;
             size_t num_inputs = code.num_inputs();
-            size_t base_pointer = frame.base_pointer;
+            size_t base_pointer = frame->base_pointer;
             TORCH_INTERNAL_ASSERT(stack.size() >= num_inputs);
             size_t inputs_start = stack.size() - num_inputs;
             for (size_t i = 0; i < num_inputs; ++i) {
@@ -1486,54 +1646,54 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             leaveFrame();
             enterFrame(code, base_pointer);
             checkAndStartRecordFunction(frames.back(), stack);
-          } break;
-          case LIST_UNPACK: {
+          } DISPATCH();
+          INST(LIST_UNPACK): {
             listUnpack(stack, inst.X);
-            ++frame.pc;
-          } break;
-          case TUPLE_CONSTRUCT: {
+            ++frame->pc;
+          } DISPATCH();
+          INST(TUPLE_CONSTRUCT): {
             tupleConstruct(stack, inst.X);
-            ++frame.pc;
-          } break;
-          case TUPLE_SLICE: {
+            ++frame->pc;
+          } DISPATCH();
+          INST(TUPLE_SLICE): {
             tupleSlice(stack, inst.X, inst.X + inst.N);
-            ++frame.pc;
-          } break;
-          case NAMED_TUPLE_CONSTRUCT: {
+            ++frame->pc;
+          } DISPATCH();
+          INST(NAMED_TUPLE_CONSTRUCT): {
             namedTupleConstruct(
                 stack,
-                frame.function->type_table_[inst.X]->expect<TupleType>(),
+                frame->function->type_table_[inst.X]->expect<TupleType>(),
                 inst.N);
-            ++frame.pc;
-          } break;
-          case LIST_CONSTRUCT: {
+            ++frame->pc;
+          } DISPATCH();
+          INST(LIST_CONSTRUCT): {
             const auto& type =
-                frame.function->type_table_[inst.X]->expectRef<ListType>();
+                frame->function->type_table_[inst.X]->expectRef<ListType>();
             listConstruct(stack, type, inst.N);
-            ++frame.pc;
-          } break;
-          case DICT_CONSTRUCT: {
+            ++frame->pc;
+          } DISPATCH();
+          INST(DICT_CONSTRUCT): {
             const auto& type =
-                frame.function->type_table_[inst.X]->expectRef<DictType>();
+                frame->function->type_table_[inst.X]->expectRef<DictType>();
             dictConstruct(stack, type, inst.N);
-            ++frame.pc;
-          } break;
-          case CREATE_OBJECT: {
+            ++frame->pc;
+          } DISPATCH();
+          INST(CREATE_OBJECT): {
             auto type =
-                frame.function->type_table_[inst.X]->expect<ClassType>();
+                frame->function->type_table_[inst.X]->expect<ClassType>();
             createObject(stack, type);
-            ++frame.pc;
-          } break;
-          case ISINSTANCE: {
+            ++frame->pc;
+          } DISPATCH();
+          INST(ISINSTANCE): {
             at::ArrayRef<TypePtr> types(
-                &(frame.function->type_table_[inst.X]),
-                &(frame.function->type_table_[inst.X + inst.N]));
+                &(frame->function->type_table_[inst.X]),
+                &(frame->function->type_table_[inst.X + inst.N]));
             isinstance(stack, types);
-            ++frame.pc;
-          } break;
-          case FORK: {
+            ++frame->pc;
+          } DISPATCH();
+          INST(FORK): {
             // Move inputs to a separate stack
-            Function* forked_fn = frame.function->function_table_[inst.X];
+            Function* forked_fn = frame->function->function_table_[inst.X];
             InterpreterState forked_interpreter(
                 forked_fn->get_executor()
                     .getPlanFor(stack, GraphExecutor::getDefaultNumBailOuts())
@@ -1545,10 +1705,16 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
                 getDistAutogradContextId());
             drop(stack, inst.N);
             push(stack, forked_interpreter.getFuture());
-            taskLauncher_(std::move(continuation));
-            ++frame.pc;
-          } break;
-          case WARN: {
+            {
+              // lets a wait on the future raise the priority of the fork,
+              // see Note [Inter-op task priorities]
+              at::internal::LaunchForFutureGuard guard(
+                  forked_interpreter.getFuture());
+              taskLauncher_(std::move(continuation));
+            }
+            ++frame->pc;
+          } DISPATCH();
+          INST(WARN): {
             // Keeps track of which WARN instruction has been executed before,
             // we only want to execute each WARN once to match default Python
             // warning behavior.
@@ -1558,7 +1724,7 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             }
 
             Node* node =
-                frames.back().function->instructions_source_.at(frame.pc);
+                frames.back().function->instructions_source_.at(frame->pc);
             auto range = node->sourceRange().source();
             if (range->filename()) {
               drop(stack, 1);
@@ -1581,10 +1747,67 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
               }
               stack.pop_back();
             }
-            ++frame.pc;
-          } break;
+            ++frame->pc;
+          } DISPATCH();
+          INST(PUSH_OP): {
+            // See Note [Interpreter superinstructions]
+            const Instruction* code =
+                &frame->function->instructions_[frame->pc];
+            for (size_t i = 0; i < inst.N; ++i) {
+              pushOperand(stack, code[i]);
+            }
+            frame->pc += inst.N;
+            frame->function->operator_table_[code[inst.N].X](&stack);
+            ++frame->pc;
+          } DISPATCH();
+          INST(PUSH_OP_STORE): {
+            const Instruction* code =
+                &frame->function->instructions_[frame->pc];
+            for (size_t i = 0; i < inst.N; ++i) {
+              pushOperand(stack, code[i]);
+            }
+            frame->pc += inst.N;
+            frame->function->operator_table_[code[inst.N].X](&stack);
+            reg(code[inst.N + 1].X) = pop(stack);
+            frame->pc += 2;
+          } DISPATCH();
+          INST(REG_OP): {
+            // See Note [Register calling convention]
+            const Instruction* code =
+                &frame->function->instructions_[frame->pc];
+            const IValue* args[kMaxFusedPushes];
+            loadOperands(code, inst.N, args);
+            frame->pc += inst.N;
+            IValue result =
+                frame->function->register_operation_table_[code[inst.N].X](
+                    args);
+            clearMovedOperands(code, inst.N);
+            stack.emplace_back(std::move(result));
+            ++frame->pc;
+          } DISPATCH();
+          INST(REG_OP_STORE): {
+            const Instruction* code =
+                &frame->function->instructions_[frame->pc];
+            const IValue* args[kMaxFusedPushes];
+            loadOperands(code, inst.N, args);
+            frame->pc += inst.N;
+            IValue result =
+                frame->function->register_operation_table_[code[inst.N].X](
+                    args);
+            clearMovedOperands(code, inst.N);
+            reg(code[inst.N + 1].X) = std::move(result);
+            frame->pc += 2;
+          } DISPATCH();
+          INST(OP_STORE):
+            frame->function->operator_table_[inst.X](&stack);
+            ++frame->pc;
+            reg(frame->function->instructions_[frame->pc].X) = pop(stack);
+            ++frame->pc;
+            DISPATCH();
         }
       }
+#undef INST
+#undef DISPATCH
     } catch (std::exception& e) {
       for (auto it = entered_objects.rbegin(), end = entered_objects.rend();
            it != end;
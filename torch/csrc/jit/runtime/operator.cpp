@@ -241,11 +241,14 @@ bool printerHasSpecialCaseFor(Symbol sym) {
       prim::CudaFusionGuard, // optimization pass adds it
       prim::TensorExprGroup, // optimization pass adds it
       prim::StaticSubgraph, // optimization pass adds it
+      prim::StaticTensorExprGroup, // optimization pass adds it
       prim::ConstantMKLDNNTensor, // optimization pass adds it
       prim::BroadcastMKLDNNTensors, // optimization pass adds it
+      prim::MKLDNNConcat, // optimization pass adds it
       prim::Load, // used in interpreter only
       prim::MMTreeReduce, // used as an optimization
       prim::MMBatchSide, // used as an optimization
+      prim::MMBatchLinear, // used as an optimization
       prim::Store, // used in interpreter only
       prim::profile, // used in interpreter only
       prim::profile_ivalue, // used in interpreter only
@@ -281,6 +284,7 @@ bool aliasAnalysisHasSpecialCaseFor(Symbol symbol) {
       prim::DifferentiableGraph,
       prim::TensorExprGroup,
       prim::StaticSubgraph,
+      prim::StaticTensorExprGroup,
       prim::FunctionalGraph,
       prim::Constant,
       prim::Uninitialized,
@@ -292,6 +296,7 @@ bool aliasAnalysisHasSpecialCaseFor(Symbol symbol) {
       prim::GradOf,
       prim::MMTreeReduce,
       prim::MMBatchSide,
+      prim::MMBatchLinear,
       prim::BroadcastSizes,
       prim::ChunkSizes,
       prim::Closure,
@@ -305,6 +310,7 @@ bool aliasAnalysisHasSpecialCaseFor(Symbol symbol) {
       prim::MKLDNNGroup,
       prim::ConstantMKLDNNTensor,
       prim::BroadcastMKLDNNTensors,
+      prim::MKLDNNConcat,
       prim::fork,
       prim::CreateObject,
       prim::AutogradAdd,
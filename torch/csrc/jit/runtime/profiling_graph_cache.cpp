@@ -0,0 +1,93 @@
+#include <torch/csrc/jit/runtime/profiling_graph_cache.h>
+
+#include <c10/util/hash.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/ir/irparser.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/runtime/disk_cache.h>
+
+#include <sstream>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// bump whenever the format of the entries or of the key changes
+constexpr const char* kCacheVersion = "1";
+
+DiskCache& profiledGraphCache() {
+  static DiskCache cache("PYTORCH_JIT_PROFILING_CACHE_DIR", ".ir");
+  return cache;
+}
+
+} // namespace
+
+void setProfilingGraphCacheDir(std::string dir) {
+  profiledGraphCache().setDir(std::move(dir));
+}
+
+std::string getProfilingGraphCacheDir() {
+  return profiledGraphCache().dir();
+}
+
+std::string profilingGraphCacheKey(const Graph& graph, const Stack& stack) {
+  std::stringstream ss;
+  ss << kCacheVersion << "\n" << graph.toString(false);
+  const size_t num_inputs = graph.inputs().size();
+  TORCH_INTERNAL_ASSERT(stack.size() >= num_inputs);
+  for (const IValue& input : last(stack, num_inputs)) {
+    if (input.isTensor()) {
+      ss << *TensorType::create(input.toTensor()) << "\n";
+    } else {
+      ss << input.type()->annotation_str() << "\n";
+    }
+  }
+  std::stringstream key;
+  key << std::hex << c10::stable_hash(ss.str());
+  return key.str();
+}
+
+std::shared_ptr<Graph> loadProfiledGraph(const std::string& key) {
+  auto text = profiledGraphCache().load(key);
+  if (!text) {
+    return nullptr;
+  }
+  auto graph = std::make_shared<Graph>();
+  try {
+    parseIR(*text, graph.get());
+  } catch (const std::exception& e) {
+    GRAPH_DEBUG("Ignoring unreadable profiled graph ", key, ": ", e.what());
+    return nullptr;
+  }
+  GRAPH_DEBUG("Loaded profiled graph ", key);
+  return graph;
+}
+
+bool storeProfiledGraph(const std::string& key, const Graph& graph) {
+  if (profiledGraphCache().dir().empty()) {
+    return false;
+  }
+  const std::string text = graph.toString(false);
+  // only store graphs that read back as themselves
+  try {
+    Graph parsed;
+    parseIR(text, &parsed);
+    if (parsed.toString(false) != text) {
+      GRAPH_DEBUG(
+          "Not caching profiled graph ", key, ": IR does not round-trip");
+      return false;
+    }
+  } catch (const std::exception& e) {
+    GRAPH_DEBUG("Not caching profiled graph ", key, ": ", e.what());
+    return false;
+  }
+  if (!profiledGraphCache().store(key, text)) {
+    return false;
+  }
+  GRAPH_DEBUG("Stored profiled graph ", key);
+  return true;
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <ATen/core/stack.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <memory>
+#include <string>
+
+namespace torch {
+namespace jit {
+
+struct Graph;
+
+// Note [Profiled graph cache]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// ProfilingGraphExecutorImpl runs a graph getNumProfiledRuns() times to
+// collect the types that drive guard insertion and fusion, and it has to do
+// so again in every process. When a cache directory is set, the executor
+// writes the profiled graph, i.e. the graph with its prim::profile nodes
+// carrying the observed types, to that directory once profiling is done. A
+// later process running the same graph with inputs of the same types reads
+// it back and goes straight to runProfilingOptimizations.
+//
+// Entries are keyed by a hash of the unoptimized graph and of the types of the
+// inputs of the first call, so an entry is only used for the graph and the
+// input specialization it was recorded for. Inputs that later differ from the
+// recorded types are handled by the guards, exactly as after profiling.
+//
+// Entries are stored as IR text. A graph that does not survive a round-trip
+// through parseIR (e.g. one holding Tensor constants) is not cached, and an
+// entry that fails to load is ignored, so the cache never changes what runs.
+// The optimized graph itself is not cached, since fusion groups and fallback
+// functions hold subgraphs and Functions that the IR text cannot express.
+
+// Entries live in a DiskCache (see Note [On-disk caches]) whose directory is
+// read from PYTORCH_JIT_PROFILING_CACHE_DIR. An empty directory (the default)
+// disables the cache.
+TORCH_API void setProfilingGraphCacheDir(std::string dir);
+TORCH_API std::string getProfilingGraphCacheDir();
+
+// The cache key of graph called with the inputs on top of stack
+TORCH_API std::string profilingGraphCacheKey(
+    const Graph& graph,
+    const Stack& stack);
+
+// Returns nullptr if there is no usable entry for key
+TORCH_API std::shared_ptr<Graph> loadProfiledGraph(const std::string& key);
+// Returns whether the graph was stored
+TORCH_API bool storeProfiledGraph(const std::string& key, const Graph& graph);
+
+} // namespace jit
+} // namespace torch
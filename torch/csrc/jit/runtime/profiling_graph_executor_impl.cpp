@@ -1,5 +1,6 @@
 #include <torch/csrc/jit/runtime/profiling_graph_executor_impl.h>
 
+#include <ATen/core/Vitals.h>
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/passes/bailout_graph.h>
 #include <torch/csrc/jit/passes/batch_mm.h>
@@ -32,6 +33,7 @@
 #include <torch/csrc/jit/passes/tensorexpr_fuser.h>
 #include <torch/csrc/jit/passes/update_differentiable_graph_requires_grad.h>
 #include <torch/csrc/jit/passes/utils/subgraph_utils.h>
+#include <torch/csrc/jit/runtime/profiling_graph_cache.h>
 
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
 C10_DEFINE_bool(
@@ -47,6 +49,7 @@ C10_DEFINE_bool(
 
 constexpr size_t kDefaultNumProfiledRuns = 1;
 constexpr size_t kDefaultBailoutDepth = 20;
+constexpr size_t kDefaultNumSpecializations = 1;
 
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
 C10_DEFINE_int64(
@@ -58,6 +61,11 @@ C10_DEFINE_int64(
     torch_jit_bailout_depth,
     kDefaultBailoutDepth,
     "Number of re-specializations");
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+C10_DEFINE_int64(
+    torch_jit_num_specializations,
+    kDefaultNumSpecializations,
+    "Number of optimized plans kept for different input types");
 
 namespace torch {
 namespace jit {
@@ -78,6 +86,8 @@ static std::atomic<bool> profiling_mode{true};
 static std::atomic<size_t> num_profiled_runs{kDefaultNumProfiledRuns};
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
 static std::atomic<size_t> bailout_depth{kDefaultBailoutDepth};
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static std::atomic<size_t> num_specializations{kDefaultNumSpecializations};
 
 std::atomic<bool>& getProfilingMode() {
   return profiling_mode;
@@ -105,6 +115,15 @@ std::atomic<size_t>& getBailoutDepth() {
   return bailout_depth;
 }
 
+std::atomic<size_t>& getNumSpecializations() {
+  // Initialize num_specializations from command-line flag.
+  static const size_t init = []() {
+    return num_specializations = FLAGS_torch_jit_num_specializations;
+  }();
+  (void)init; // Silence clang-tidy.
+  return num_specializations;
+}
+
 static bool needsGradientInProfilingMode(Block* b) {
   for (auto n : b->nodes()) {
     if (n->kind() == prim::BailOut) {
@@ -611,6 +630,24 @@ void ProfilingGraphExecutorImpl::runProfilingInsensitiveOptimizations(
       *graph);
 }
 
+// The types profiled for the tensor inputs of graph, nullptr for the inputs
+// without profiling information
+static std::vector<TensorTypePtr> profiledInputTypes(const Graph& graph) {
+  std::vector<TensorTypePtr> types;
+  for (const Value* input : graph.inputs()) {
+    TensorTypePtr type;
+    for (const Use& use : input->uses()) {
+      if (use.user->kind() == prim::profile &&
+          use.user->hasAttribute(attr::profiled_type)) {
+        type = use.user->ty(attr::profiled_type)->cast<TensorType>();
+        break;
+      }
+    }
+    types.push_back(std::move(type));
+  }
+  return types;
+}
+
 ProfilingGraphExecutorImpl::ProfilingGraphExecutorImpl(
     const std::shared_ptr<Graph>& graph,
     std::string function_name)
@@ -651,9 +688,72 @@ const ExecutionPlan& ProfilingGraphExecutorImpl::getOptimizedPlanFor(
     runProfilingInsensitiveOptimizations(copy);
     GRAPH_DUMP("Optimized SimpleExecutor Graph: ", copy);
     optimized_plan_ = ExecutionPlan(copy, function_name_);
+    // the simple executor has no guards, so its plan takes any inputs
+    specialized_plans_.push_back(SpecializedPlan{{}, *optimized_plan_});
     return *optimized_plan_;
   }
 
+  // see Note [Profiled graph cache]
+  std::shared_ptr<Graph> profiled_graph;
+  if (!pr_ && !optimized_plan_ && !getProfilingGraphCacheDir().empty()) {
+    cache_key_ = profilingGraphCacheKey(*graph, stack);
+    profiled_graph = loadProfiledGraph(*cache_key_);
+  }
+
+  if (!profiled_graph) {
+    profiled_graph = getProfiledGraph();
+    if (!profiled_graph) {
+      return profiling_plans_.back();
+    }
+    if (cache_key_ && !optimized_plan_) {
+      storeProfiledGraph(*cache_key_, *profiled_graph);
+    }
+  }
+
+  auto input_types = profiledInputTypes(*profiled_graph);
+  runProfilingOptimizations(profiled_graph);
+  // replaces a fallback graph inserted by
+  // specialize_autogradzero if one exists
+  replaceFallbackGraphWithFallbackFunction(profiled_graph->block());
+  GRAPH_DUMP("Optimized Graph: ", profiled_graph);
+  TORCH_VITAL_COUNT("jit.optimized_plans", 1);
+  if (!specialized_plans_.empty()) {
+    TORCH_VITAL_COUNT("jit.recompilations", 1);
+  }
+  specialized_plans_.push_back(SpecializedPlan{
+      std::move(input_types),
+      ExecutionPlan(
+          profiled_graph, function_name_, *remaining_bailout_depth_)});
+  if (!optimized_plan_) {
+    optimized_plan_ = specialized_plans_.back().plan;
+  }
+  // the next call that matches none of the specialized plans starts
+  // profiling anew. The record is kept alive since the profiling plan, which
+  // may still be running, calls back into it.
+  if (pr_) {
+    retired_profiling_records_.push_back(std::move(pr_));
+  }
+  return specialized_plans_.back().plan;
+}
+
+const ExecutionPlan* ProfilingGraphExecutorImpl::findSpecializedPlan(
+    const Stack& stack) {
+  auto inputs = last(stack, num_inputs);
+  for (SpecializedPlan& specialized : specialized_plans_) {
+    bool match = true;
+    for (size_t i = 0; i < specialized.input_types.size() && match; i++) {
+      const TensorTypePtr& type = specialized.input_types[i];
+      match = !type ||
+          (inputs[i].isTensor() && type->matchTensor(inputs[i].toTensor()));
+    }
+    if (match) {
+      return &specialized.plan;
+    }
+  }
+  return nullptr;
+}
+
+std::shared_ptr<Graph> ProfilingGraphExecutorImpl::getProfiledGraph() {
   // if a profiling graph hasn't been created yet
   if (!pr_) {
     auto copy = graph->copy();
@@ -666,25 +766,18 @@ const ExecutionPlan& ProfilingGraphExecutorImpl::getOptimizedPlanFor(
     // `aten::_grad_sum_to_size` input.
     InsertProfileNodesForSpecializeAutogradZero(pr_.get());
     GRAPH_DUMP("Profiled Graph: ", pr_->graph());
-    profiling_plan_ = ExecutionPlan(pr_->graph(), function_name_);
+    profiling_plans_.emplace_back(pr_->graph(), function_name_);
     // fall-through
   }
 
   // profile until a graph is ready
   if (!pr_->ready()) {
-    return *profiling_plan_;
+    return nullptr;
   }
 
   auto copy = pr_->graph()->copy();
   ProfilingRecord::removeProfileCounter(copy->block());
-  runProfilingOptimizations(copy);
-  // replaces a fallback graph inserted by
-  // specialize_autogradzero if one exists
-  replaceFallbackGraphWithFallbackFunction(copy->block());
-  GRAPH_DUMP("Optimized Graph: ", copy);
-  optimized_plan_ =
-      ExecutionPlan(copy, function_name_, *remaining_bailout_depth_);
-  return *optimized_plan_;
+  return copy;
 }
 
 const ExecutionPlan& ProfilingGraphExecutorImpl::getPlanFor(
@@ -695,7 +788,17 @@ const ExecutionPlan& ProfilingGraphExecutorImpl::getPlanFor(
   // IMPORTANT: This is a hot path of calling a torchscript function. Try not to
   // add any code above this.
   if (optimized_plan_) {
-    return *optimized_plan_;
+    const size_t max_plans = getNumSpecializations();
+    if (max_plans <= 1) {
+      return *optimized_plan_;
+    }
+    // see Note [Specialized plans]
+    if (const ExecutionPlan* plan = findSpecializedPlan(stack)) {
+      return *plan;
+    }
+    if (specialized_plans_.size() >= max_plans) {
+      return *optimized_plan_;
+    }
   }
 
   return getOptimizedPlanFor(stack, remaining_bailout_depth);
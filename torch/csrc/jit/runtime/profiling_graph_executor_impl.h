@@ -1,6 +1,8 @@
 #pragma once
 #include <torch/csrc/jit/runtime/graph_executor_impl.h>
 
+#include <deque>
+
 namespace torch {
 namespace jit {
 
@@ -17,25 +19,51 @@ struct ProfilingGraphExecutorImpl : public GraphExecutorImplBase {
   void debugFlushCompilationCache() {
     std::lock_guard<std::mutex> lock(compile_mutex);
     pr_.reset();
+    retired_profiling_records_.clear();
     fallback_plan_.reset();
-    profiling_plan_.reset();
+    profiling_plans_.clear();
     optimized_plan_.reset();
+    specialized_plans_.clear();
     // prevent memory leaks
     fallback_functions_.clear();
     remaining_bailout_depth_.reset();
+    cache_key_.reset();
   }
 
  private:
   const ExecutionPlan& getOptimizedPlanFor(
       Stack& stack,
       size_t remaining_bailout_depth);
+  // the profiled graph once profiling is done, nullptr while profiling
+  std::shared_ptr<Graph> getProfiledGraph();
+  const ExecutionPlan* findSpecializedPlan(const Stack& stack);
   void runProfilingInsensitiveOptimizations(std::shared_ptr<Graph>& graph);
   void runProfilingOptimizations(std::shared_ptr<Graph>& graph);
   void replaceFallbackGraphWithFallbackFunction(Block* b);
   std::unique_ptr<ProfilingRecord> pr_;
-  c10::optional<ExecutionPlan>
-      profiling_plan_; // plan to run in order to profiling the code
+  std::vector<std::unique_ptr<ProfilingRecord>> retired_profiling_records_;
+  // plans to run in order to profiling the code, the last one is current.
+  // Plans are never removed since callers hold references to them.
+  std::deque<ExecutionPlan> profiling_plans_;
+  // the first optimized plan, which is run for all the inputs once there is
+  // no room for more specialized plans
   c10::optional<ExecutionPlan> optimized_plan_;
+  // Note [Specialized plans]
+  // ~~~~~~~~~~~~~~~~~~~~~~~~
+  // The guards of an optimized plan only hold for the input types it was
+  // profiled with, and inputs of other types run the fallback paths of the
+  // plan, i.e. the unfused graph. A model that sees a few regimes of input
+  // types would run most of its calls unoptimized. With
+  // getNumSpecializations() > 1, a call whose inputs match none of the
+  // optimized plans profiles and optimizes a new plan for its input types,
+  // until there are that many plans. Calls go to the first plan whose
+  // profiled input types they match, and to optimized_plan_ otherwise.
+  struct SpecializedPlan {
+    // profiled type of each input, nullptr if the input is not checked
+    std::vector<TensorTypePtr> input_types;
+    ExecutionPlan plan;
+  };
+  std::deque<SpecializedPlan> specialized_plans_;
   // this plan is used if getGraphExecutorOptimize is unset
   c10::optional<ExecutionPlan> fallback_plan_;
   // fallback functions are inserted for tensorexpr fusion groups
@@ -48,6 +76,8 @@ struct ProfilingGraphExecutorImpl : public GraphExecutorImplBase {
   // of the GraphExecutor and only shared with InterpreterState
   std::vector<std::unique_ptr<Function>> fallback_functions_;
   c10::optional<size_t> remaining_bailout_depth_;
+  // key of this graph in the profiled graph cache, if the cache is enabled
+  c10::optional<std::string> cache_key_;
 };
 
 } // namespace jit
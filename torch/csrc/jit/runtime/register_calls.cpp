@@ -0,0 +1,88 @@
+#include <torch/csrc/jit/runtime/register_calls.h>
+
+#include <ATen/ATen.h>
+#include <torch/csrc/jit/ir/ir.h>
+
+#include <unordered_map>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// See Note [Register calling convention]. The scalar operators have the
+// semantics of the ones defined with DEFINE_BINARY_OP and
+// DEFINE_COMPARISON_OP in register_prim_ops.cpp.
+#define DEFINE_SCALAR_REGISTER_OP(aten_op, op)                    \
+  {{#aten_op, "int"}, [](const IValue* const* args) -> IValue {   \
+     const int64_t a = args[0]->toInt();                          \
+     const int64_t b = args[1]->toInt();                          \
+     return op;                                                   \
+   }},                                                            \
+  {{#aten_op, "float"}, [](const IValue* const* args) -> IValue { \
+     const double a = args[0]->toDouble();                        \
+     const double b = args[1]->toDouble();                        \
+     return op;                                                   \
+   }}
+
+#define DEFINE_UNARY_TENSOR_REGISTER_OP(aten_op, fn)         \
+  {{#aten_op, ""}, [](const IValue* const* args) -> IValue { \
+     return fn(args[0]->toTensor());                         \
+   }}
+
+#define DEFINE_BINARY_TENSOR_REGISTER_OP(aten_op, fn)              \
+  {{#aten_op, "Tensor"}, [](const IValue* const* args) -> IValue { \
+     return fn(args[0]->toTensor(), args[1]->toTensor());          \
+   }}
+
+#define DEFINE_ALPHA_TENSOR_REGISTER_OP(aten_op, fn)                           \
+  {{#aten_op, "Tensor"}, [](const IValue* const* args) -> IValue {             \
+     return fn(args[0]->toTensor(), args[1]->toTensor(), args[2]->toScalar()); \
+   }}
+
+using RegisterOperationMap =
+    std::unordered_map<c10::OperatorName, RegisterOperation>;
+
+const RegisterOperationMap& registerOperations() {
+  static const RegisterOperationMap operations{
+      DEFINE_SCALAR_REGISTER_OP(aten::add, a + b),
+      DEFINE_SCALAR_REGISTER_OP(aten::sub, a - b),
+      DEFINE_SCALAR_REGISTER_OP(aten::mul, a * b),
+      DEFINE_SCALAR_REGISTER_OP(aten::eq, a == b),
+      DEFINE_SCALAR_REGISTER_OP(aten::ne, a != b),
+      DEFINE_SCALAR_REGISTER_OP(aten::lt, a < b),
+      DEFINE_SCALAR_REGISTER_OP(aten::gt, a > b),
+      DEFINE_SCALAR_REGISTER_OP(aten::le, a <= b),
+      DEFINE_SCALAR_REGISTER_OP(aten::ge, a >= b),
+      DEFINE_ALPHA_TENSOR_REGISTER_OP(aten::add, at::add),
+      DEFINE_ALPHA_TENSOR_REGISTER_OP(aten::sub, at::sub),
+      DEFINE_BINARY_TENSOR_REGISTER_OP(aten::mul, at::mul),
+      DEFINE_BINARY_TENSOR_REGISTER_OP(aten::div, at::div),
+      DEFINE_BINARY_TENSOR_REGISTER_OP(aten::matmul, at::matmul),
+      DEFINE_UNARY_TENSOR_REGISTER_OP(aten::relu, at::relu),
+      DEFINE_UNARY_TENSOR_REGISTER_OP(aten::sigmoid, at::sigmoid),
+      DEFINE_UNARY_TENSOR_REGISTER_OP(aten::tanh, at::tanh),
+  };
+  return operations;
+}
+
+#undef DEFINE_SCALAR_REGISTER_OP
+#undef DEFINE_UNARY_TENSOR_REGISTER_OP
+#undef DEFINE_BINARY_TENSOR_REGISTER_OP
+#undef DEFINE_ALPHA_TENSOR_REGISTER_OP
+
+} // namespace
+
+RegisterOperation findRegisterOperation(const Node* node) {
+  const FunctionSchema* schema = node->maybeSchema();
+  if (!schema || schema->is_vararg() ||
+      schema->arguments().size() != node->inputs().size()) {
+    return nullptr;
+  }
+  const auto& operations = registerOperations();
+  auto it = operations.find(schema->operator_name());
+  return it == operations.end() ? nullptr : it->second;
+}
+
+} // namespace jit
+} // namespace torch
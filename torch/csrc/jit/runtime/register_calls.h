@@ -0,0 +1,33 @@
+#pragma once
+
+#include <ATen/core/ivalue.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+namespace torch {
+namespace jit {
+
+struct Node;
+
+// Note [Register calling convention]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// A boxed Operation pops its arguments from the Stack and pushes its result,
+// so calling even `a + b` on ints copies both operands onto the stack, pops
+// them into locals, checks their tags and pushes the result back. For the
+// operators below, which are most of the operators of scalar code and the
+// common elementwise ones, there is also a RegisterOperation taking pointers
+// to its arguments where they already are, i.e. the registers and the
+// constant table of the interpreter, and returning its result. The interpreter
+// uses it for the OPs whose inputs are all LOADs, MOVEs and LOADCs, see
+// Note [Interpreter superinstructions].
+//
+// A RegisterOperation must behave exactly like the boxed Operation of the
+// same schema. Tensor operators call the unboxed ATen function, which goes
+// through the dispatcher like the boxed call does, so autograd, tracing,
+// profiling and autocast see the same thing.
+using RegisterOperation = IValue (*)(const IValue* const* args);
+
+// The RegisterOperation for the operator of node, or nullptr if there is none
+TORCH_API RegisterOperation findRegisterOperation(const Node* node);
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,118 @@
+#include <torch/csrc/jit/runtime/static/constant_store.h>
+
+#include <c10/util/hash.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// words of the data hashed, evenly spaced over it
+constexpr size_t kNumSampledWords = 4096;
+
+bool canIntern(const at::Tensor& t) {
+  return t.defined() && t.device().is_cpu() && t.layout() == at::kStrided &&
+      !t.is_quantized() && !t.requires_grad() && t.is_contiguous() &&
+      t.has_storage();
+}
+
+size_t nbytes(const at::Tensor& t) {
+  return t.numel() * t.element_size();
+}
+
+size_t hashTensor(const at::Tensor& t) {
+  size_t hash = c10::get_hash(
+      static_cast<int>(t.scalar_type()), t.sizes().vec(), t.strides().vec());
+  const size_t num_words = nbytes(t) / sizeof(uint64_t);
+  const auto* data = static_cast<const char*>(t.data_ptr());
+  const size_t step = std::max<size_t>(1, num_words / kNumSampledWords);
+  for (size_t i = 0; i < num_words; i += step) {
+    uint64_t word;
+    std::memcpy(&word, data + i * sizeof(uint64_t), sizeof(word));
+    hash = c10::hash_combine(hash, std::hash<uint64_t>()(word));
+  }
+  // the bytes after the last whole word
+  for (size_t i = num_words * sizeof(uint64_t); i < nbytes(t); ++i) {
+    hash = c10::hash_combine(hash, static_cast<size_t>(data[i]));
+  }
+  return hash;
+}
+
+bool sameTensor(const at::Tensor& a, const at::Tensor& b) {
+  return a.scalar_type() == b.scalar_type() && a.sizes() == b.sizes() &&
+      a.strides() == b.strides() &&
+      std::memcmp(a.data_ptr(), b.data_ptr(), nbytes(a)) == 0;
+}
+
+} // namespace
+
+StaticConstantStore& StaticConstantStore::global() {
+  static StaticConstantStore store;
+  return store;
+}
+
+at::Tensor StaticConstantStore::intern(const at::Tensor& t) {
+  if (!canIntern(t)) {
+    return t;
+  }
+  const size_t hash = hashTensor(t);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& candidates = tensors_[hash];
+  for (const auto& weak : candidates) {
+    auto impl = weak.lock();
+    if (!impl) {
+      continue;
+    }
+    at::Tensor interned(std::move(impl));
+    if (interned.unsafeGetTensorImpl() == t.unsafeGetTensorImpl()) {
+      return t;
+    }
+    if (sameTensor(interned, t)) {
+      deduplicated_bytes_ += nbytes(t);
+      return interned;
+    }
+  }
+  candidates.emplace_back(t.getIntrusivePtr());
+  // prune once the entries doubled since the last time, so that the cost is
+  // amortized over the interned Tensors
+  if (++num_interned_since_prune_ > tensors_.size()) {
+    prune();
+  }
+  return t;
+}
+
+void StaticConstantStore::prune() {
+  for (auto it = tensors_.begin(); it != tensors_.end();) {
+    auto& candidates = it->second;
+    candidates.erase(
+        std::remove_if(
+            candidates.begin(),
+            candidates.end(),
+            [](const WeakTensor& weak) { return weak.expired(); }),
+        candidates.end());
+    it = candidates.empty() ? tensors_.erase(it) : std::next(it);
+  }
+  num_interned_since_prune_ = 0;
+}
+
+size_t StaticConstantStore::num_tensors() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t count = 0;
+  for (const auto& entry : tensors_) {
+    for (const auto& weak : entry.second) {
+      count += !weak.expired();
+    }
+  }
+  return count;
+}
+
+size_t StaticConstantStore::deduplicated_bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return deduplicated_bytes_;
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <ATen/core/Tensor.h>
+#include <c10/util/intrusive_ptr.h>
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+// Note [Static Runtime constant deduplication]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Hosts serving many variants of a model, which share most of their
+// embedding tables and FC weights, load the same weights once per
+// StaticModule: freezing turns the parameters of each module into constants
+// of its own graph. With StaticModuleOptions::deduplicate_constants, the
+// StaticModule constructor interns the Tensor constants of its graph in the
+// process wide StaticConstantStore, which hands out the Tensor an earlier
+// module interned if one has the same dtype, sizes, strides and contents.
+// The graph and the constants of the module then refer to that Tensor, and
+// the duplicate is freed once the Module it came from is.
+//
+// Tensors are looked up by a hash of their metadata and of a sample of their
+// data, and compared in full. The store only holds weak references, a Tensor
+// lives as long as the modules using it. Only contiguous, dense CPU Tensors
+// are interned, others are used as they are. Constants are never written to
+// by Static Runtime, but a Tensor shared this way must not be written to by
+// its owner either.
+
+class TORCH_API StaticConstantStore {
+ public:
+  static StaticConstantStore& global();
+
+  // Returns the interned Tensor equal to t, or interns t
+  at::Tensor intern(const at::Tensor& t);
+
+  // live interned Tensors, and the bytes of the Tensors intern() replaced by
+  // them so far
+  size_t num_tensors() const;
+  size_t deduplicated_bytes() const;
+
+ private:
+  using WeakTensor =
+      c10::weak_intrusive_ptr<c10::TensorImpl, c10::UndefinedTensorImpl>;
+
+  // drops the entries of freed Tensors
+  void prune();
+
+  mutable std::mutex mutex_;
+  std::unordered_map<size_t, std::vector<WeakTensor>> tensors_;
+  size_t num_interned_since_prune_{0};
+  size_t deduplicated_bytes_{0};
+};
+
+} // namespace jit
+} // namespace torch
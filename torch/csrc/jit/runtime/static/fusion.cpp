@@ -7,11 +7,17 @@
 #include <torch/csrc/jit/passes/dead_code_elimination.h>
 #include <torch/csrc/jit/passes/freeze_module.h>
 #include <torch/csrc/jit/passes/remove_mutation.h>
+#include <torch/csrc/jit/passes/shape_analysis.h>
 #include <torch/csrc/jit/passes/utils/subgraph_utils.h>
 #include <torch/csrc/jit/runtime/custom_operator.h>
+#include <torch/csrc/jit/runtime/operator.h>
 #include <torch/csrc/jit/runtime/static/impl.h>
 #include <torch/csrc/jit/runtime/static/ops.h>
 #include <torch/csrc/jit/runtime/static/passes.h>
+#include <torch/csrc/jit/tensorexpr/kernel.h>
+
+#include <map>
+#include <mutex>
 
 namespace torch {
 namespace jit {
@@ -315,5 +321,274 @@ void createFusionGroups(Block* block, AliasDb* aliasDb, size_t min_size) {
   inlineSmallFusionGroups(block, min_size);
 }
 
+// Note [Static Runtime TensorExpr fusion]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// With StaticModuleOptions::enable_tensorexpr_fusion, chains of pointwise ops
+// are grouped into prim::StaticTensorExprGroup nodes. The first time a group
+// sees a combination of sizes and dtypes of its inputs, it specializes its
+// subgraph to them and compiles it with TensorExprKernel. The group runs as
+// an out variant, so the kernel writes into the output tensors the
+// MemoryPlanner manages instead of allocating them.
+//
+// TensorExprKernel only compiles for static shapes, so a group keeps one
+// kernel per input shape, up to kMaxTensorExprKernels, and runs its unfused
+// subgraph with the interpreter for other shapes, for inputs that aren't
+// contiguous CPU tensors, and when a kernel can't be built. Without LLVM the
+// kernels would run on the IR evaluator, which is slower than the unfused
+// ops, so the groups always run the interpreter then.
+
+namespace {
+
+constexpr size_t kMaxTensorExprKernels = 16;
+
+bool isFusiblePointwise(Node* node) {
+  // clang-format off
+  static const OperatorSet pointwise_ops{
+      "aten::add.Tensor(Tensor self, Tensor other, *, Scalar alpha=1) -> Tensor",
+      "aten::add.Scalar(Tensor self, Scalar other, Scalar alpha=1) -> Tensor",
+      "aten::sub.Tensor(Tensor self, Tensor other, *, Scalar alpha=1) -> Tensor",
+      "aten::sub.Scalar(Tensor self, Scalar other, Scalar alpha=1) -> Tensor",
+      "aten::mul.Tensor(Tensor self, Tensor other) -> Tensor",
+      "aten::mul.Scalar(Tensor self, Scalar other) -> Tensor",
+      "aten::div.Tensor(Tensor self, Tensor other) -> Tensor",
+      "aten::div.Scalar(Tensor self, Scalar other) -> Tensor",
+      "aten::pow.Tensor_Scalar(Tensor self, Scalar exponent) -> Tensor",
+      "aten::clamp(Tensor self, Scalar? min=None, Scalar? max=None) -> Tensor",
+      "aten::abs(Tensor self) -> Tensor",
+      "aten::neg(Tensor self) -> Tensor",
+      "aten::reciprocal(Tensor self) -> Tensor",
+      "aten::exp(Tensor self) -> Tensor",
+      "aten::log(Tensor self) -> Tensor",
+      "aten::sqrt(Tensor self) -> Tensor",
+      "aten::rsqrt(Tensor self) -> Tensor",
+      "aten::relu(Tensor self) -> Tensor",
+      "aten::sigmoid(Tensor self) -> Tensor",
+      "aten::tanh(Tensor self) -> Tensor",
+      "aten::erf(Tensor self) -> Tensor",
+  };
+  // clang-format on
+  if (!node->isMemberOf(pointwise_ops)) {
+    return false;
+  }
+  // scalars are folded into the kernel
+  for (Value* input : node->inputs()) {
+    if (!input->type()->cast<TensorType>()) {
+      REQ(input->node()->kind() == prim::Constant);
+    }
+  }
+  return true;
+}
+
+void createTensorExprGroups(Block* block, AliasDb* aliasDb) {
+  for (auto it = block->nodes().rbegin(); it != block->nodes().rend();) {
+    Node* n = *it;
+    for (Block* b : n->blocks()) {
+      createTensorExprGroups(b, aliasDb);
+    }
+    if (!isFusiblePointwise(n)) {
+      ++it;
+      continue;
+    }
+    Node* group = SubgraphUtils::createSingletonSubgraphAndUpdateAliasing(
+        n, prim::StaticTensorExprGroup, *aliasDb);
+    // pull in the pointwise producers until there are none left
+    bool merged = true;
+    while (merged) {
+      merged = false;
+      for (Value* input : sortReverseTopological(group->inputs(), block)) {
+        Node* producer = input->node();
+        if (isFusiblePointwise(producer) &&
+            aliasDb->moveBeforeTopologicallyValid(producer, group)) {
+          SubgraphUtils::mergeNodeIntoSubgraphAndUpdateAliasing(
+              producer, group, *aliasDb);
+          merged = true;
+          break;
+        }
+      }
+    }
+    debugDumpFusionGroup("Created tensorexpr group: ", group);
+    it = ++group->reverseIterator();
+  }
+}
+
+void inlineSmallTensorExprGroups(Block* block, size_t min_size) {
+  std::vector<Node*> groups;
+  for (Node* n : block->nodes()) {
+    for (Block* b : n->blocks()) {
+      inlineSmallTensorExprGroups(b, min_size);
+    }
+    if (n->kind() == prim::StaticTensorExprGroup) {
+      groups.push_back(n);
+    }
+  }
+  for (Node* group : groups) {
+    auto subgraph = SubgraphUtils::getSubgraph(group);
+    size_t num_nodes = 0;
+    for (Node* n : subgraph->nodes()) {
+      num_nodes += n->kind() != prim::Constant;
+    }
+    if (num_nodes < min_size) {
+      GRAPH_UPDATE("Tensorexpr group is too small, unmerging: ", *group);
+      SubgraphUtils::unmergeSubgraph(group);
+    }
+  }
+}
+
+// See Note [Static Runtime TensorExpr fusion]
+class TensorExprGroupRunner {
+ public:
+  explicit TensorExprGroupRunner(const Node* node)
+      : subgraph_(node->g(attr::Subgraph)),
+        fallback_code_(subgraph_, "<static tensorexpr fallback>") {}
+
+  // Writes into the defined tensors of outputs, which may be managed by the
+  // MemoryPlanner, and fills in the others
+  void run(at::ArrayRef<IValue> inputs, std::vector<at::Tensor>& outputs) {
+    std::vector<at::Tensor> results = outputs;
+    if (auto* kernel = kernelFor(inputs)) {
+      kernel->runWithOutputs(inputs, results);
+    } else {
+      Stack stack(inputs.begin(), inputs.end());
+      InterpreterState(fallback_code_).run(stack);
+      results.clear();
+      for (auto& output : stack) {
+        results.push_back(std::move(output).toTensor());
+      }
+    }
+    outputs.resize(results.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+      if (outputs[i].defined() && !outputs[i].is_same(results[i])) {
+        // the MemoryPlanner keeps pointers to the storages of the outputs
+        outputs[i].resize_(results[i].sizes());
+        outputs[i].copy_(results[i]);
+      } else {
+        outputs[i] = std::move(results[i]);
+      }
+    }
+  }
+
+ private:
+  tensorexpr::TensorExprKernel* kernelFor(at::ArrayRef<IValue> inputs) {
+#ifndef TORCH_ENABLE_LLVM
+    return nullptr;
+#else
+    std::vector<int64_t> key;
+    for (const IValue& input : inputs) {
+      if (!input.isTensor()) {
+        return nullptr;
+      }
+      const auto& t = input.toTensor();
+      if (!t.device().is_cpu() || !t.is_contiguous() || t.requires_grad()) {
+        return nullptr;
+      }
+      key.push_back(static_cast<int64_t>(t.scalar_type()));
+      key.push_back(t.dim());
+      key.insert(key.end(), t.sizes().begin(), t.sizes().end());
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = kernels_.find(key);
+    if (it == kernels_.end()) {
+      if (kernels_.size() >= kMaxTensorExprKernels) {
+        return nullptr;
+      }
+      // shapes that fail to compile are remembered as nullptr
+      it = kernels_.emplace(std::move(key), compile(inputs)).first;
+    }
+    return it->second.get();
+#endif
+  }
+
+  std::unique_ptr<tensorexpr::TensorExprKernel> compile(
+      at::ArrayRef<IValue> inputs) {
+    auto graph = subgraph_->copy();
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      graph->inputs()[i]->setType(TensorType::create(inputs[i].toTensor()));
+    }
+    PropagateInputShapes(graph);
+    for (Value* output : graph->outputs()) {
+      auto type = output->type()->cast<TensorType>();
+      if (!type || !type->isComplete()) {
+        GRAPH_DEBUG("Incomplete output shapes, not compiling ", *graph);
+        return nullptr;
+      }
+    }
+    try {
+      return std::make_unique<tensorexpr::TensorExprKernel>(graph);
+    } catch (const std::exception& e) {
+      GRAPH_DEBUG("Failed to compile ", *graph, ": ", e.what());
+      return nullptr;
+    }
+  }
+
+  std::shared_ptr<Graph> subgraph_;
+  Code fallback_code_;
+  std::mutex mutex_;
+  // input dtypes and sizes -> kernel
+  std::map<
+      std::vector<int64_t>,
+      std::unique_ptr<tensorexpr::TensorExprKernel>>
+      kernels_;
+};
+
+Operation createTensorExprGroupOperation(const Node* node) {
+  auto runner = std::make_shared<TensorExprGroupRunner>(node);
+  const auto num_inputs = node->inputs().size();
+  return [runner, num_inputs](Stack* stack) {
+    RECORD_FUNCTION("Static TensorExpr group", std::vector<c10::IValue>());
+    std::vector<at::Tensor> outputs;
+    runner->run(torch::jit::last(stack, num_inputs), outputs);
+    torch::jit::drop(stack, num_inputs);
+    for (auto& output : outputs) {
+      push_one(*stack, std::move(output));
+    }
+    return 0;
+  };
+}
+
+RegisterOperators StaticTensorExprGroupOps({torch::jit::Operator(
+    prim::StaticTensorExprGroup,
+    createTensorExprGroupOperation,
+    AliasAnalysisKind::INTERNAL_SPECIAL_CASE)});
+
+} // namespace
+
+// the out variant, writing into the outputs of the previous run
+REGISTER_OPERATOR_FUNCTOR(
+    prim::StaticTensorExprGroup,
+    prim_StaticTensorExprGroup,
+    [](Node* n) -> SROperator {
+      auto runner = std::make_shared<TensorExprGroupRunner>(n);
+      return [runner](ProcessedNode* p_node) {
+        std::vector<IValue> inputs;
+        inputs.reserve(p_node->inputs().size());
+        for (size_t i = 0; i < p_node->inputs().size(); ++i) {
+          inputs.push_back(p_node->Input(i));
+        }
+        std::vector<at::Tensor> outputs;
+        outputs.reserve(p_node->outputs().size());
+        for (size_t i = 0; i < p_node->outputs().size(); ++i) {
+          const auto& output = p_node->Output(i);
+          outputs.push_back(output.isTensor() ? output.toTensor() : at::Tensor());
+        }
+        runner->run(inputs, outputs);
+        for (size_t i = 0; i < outputs.size(); ++i) {
+          p_node->Output(i) = std::move(outputs[i]);
+        }
+      };
+    });
+
+void fuseTensorExprChains(std::shared_ptr<Graph> graph, size_t min_size) {
+  auto aliasDb = torch::make_unique<AliasDb>(graph);
+  createTensorExprGroups(graph->block(), aliasDb.get());
+  inlineSmallTensorExprGroups(graph->block(), min_size);
+  for (Node* n : graph->nodes()) {
+    if (n->kind() == prim::StaticTensorExprGroup) {
+      ConstantPooling(SubgraphUtils::getSubgraph(n));
+    }
+  }
+  EliminateDeadCode(graph);
+  GRAPH_DUMP("After fuseTensorExprChains: ", graph);
+}
+
 } // namespace jit
 } // namespace torch
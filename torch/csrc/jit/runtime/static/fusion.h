@@ -9,5 +9,11 @@ TORCH_API void fuseStaticSubgraphs(
     std::shared_ptr<Graph> graph,
     size_t min_size);
 
+// Groups chains of pointwise ops into prim::StaticTensorExprGroup nodes,
+// see Note [Static Runtime TensorExpr fusion]
+TORCH_API void fuseTensorExprChains(
+    std::shared_ptr<Graph> graph,
+    size_t min_size = 2);
+
 } // namespace jit
 } // namespace torch
@@ -1,8 +1,11 @@
 #include <torch/csrc/jit/runtime/static/impl.h>
 
+#include <ATen/Functions.h>
+#include <ATen/Parallel.h>
 #include <ATen/core/interned_strings.h>
 #include <c10/core/CPUAllocator.h>
 #include <c10/core/InferenceMode.h>
+#include <c10/util/ThreadLocalDebugInfo.h>
 #include <caffe2/core/scope_guard.h>
 #include <caffe2/core/timer.h>
 #include <torch/csrc/jit/ir/alias_analysis.h>
@@ -11,10 +14,21 @@
 #include <torch/csrc/jit/passes/freeze_module.h>
 #include <torch/csrc/jit/passes/remove_mutation.h>
 #include <torch/csrc/jit/passes/subgraph_rewrite.h>
+#include <torch/csrc/jit/runtime/static/constant_store.h>
+#include <torch/csrc/jit/runtime/static/fusion.h>
 #include <torch/csrc/jit/runtime/static/ops.h>
 #include <torch/csrc/jit/runtime/static/passes.h>
 #include <torch/csrc/jit/runtime/vararg_functions.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+
 namespace torch {
 namespace jit {
 
@@ -36,11 +50,14 @@ void OptimizeGraph(
   // to exposed folders.
 #ifdef FBCODE_CAFFE2
   if (opts.enable_out_variant) {
-    ReplaceWithCopy(graph);
+    ReplaceWithCopy(graph, opts.keep_views);
     FuseSigridTransformsListUnpack(graph);
   }
 #endif
   ConstantPropagation(graph);
+  if (opts.enable_tensorexpr_fusion && opts.enable_out_variant) {
+    fuseTensorExprChains(graph);
+  }
 }
 
 void CheckGraphEligibility(const std::shared_ptr<torch::jit::Graph>& graph) {
@@ -267,6 +284,143 @@ LivenessInformation GetLivenessInformation(
   return std::make_pair(liveness_map, always_alive);
 }
 
+// Returns the lifetimes of the Tensor outputs of ops with out variants, the
+// values the MemoryPlanner may manage. As in GetLivenessInformation, the uses
+// of values created later that may alias a value extend its lifetime, and
+// nodes in sub-blocks are represented by their top-level node. Lifetimes are
+// in node indices, or in stages if node_stages (see GetNodeStages) is given.
+std::unordered_map<const Value*, ValueLifetime> GetValueLifetimes(
+    const std::shared_ptr<torch::jit::Graph>& graph,
+    AliasDb& db,
+    const std::vector<size_t>& node_stages = {}) {
+  // same order as StaticModule::nodes_
+  std::unordered_map<const Node*, size_t> node_to_idx;
+  std::vector<const Value*> values_in_creation_order;
+  std::unordered_map<const Value*, size_t> values_to_idx_in_creation_order;
+  size_t num_nodes = 0;
+  for (const auto* node : graph->nodes()) {
+    if (node->kind() == prim::Constant) {
+      continue;
+    }
+    node_to_idx[node] =
+        node_stages.empty() ? num_nodes : node_stages.at(num_nodes);
+    num_nodes++;
+    for (const auto* v : node->outputs()) {
+      values_to_idx_in_creation_order[v] = values_in_creation_order.size();
+      values_in_creation_order.emplace_back(v);
+    }
+  }
+  // graph outputs are used after the last node
+  const size_t end = node_stages.empty()
+      ? num_nodes
+      : *std::max_element(node_stages.begin(), node_stages.end()) + 1;
+
+  auto last_use_fn = [&](const Value* v) {
+    size_t last = node_to_idx.at(v->node());
+    for (const auto& u : v->uses()) {
+      const Node* user = u.user;
+      while (user->owningBlock() != graph->block()) {
+        user = user->owningBlock()->owningNode();
+      }
+      const auto it = node_to_idx.find(user);
+      last = std::max(last, it != node_to_idx.end() ? it->second : end);
+    }
+    return last;
+  };
+
+  std::unordered_map<const Value*, ValueLifetime> lifetimes;
+  for (auto* node : graph->nodes()) {
+    if (node->kind() == prim::Constant || !canReuseInputsOutputs(node)) {
+      continue;
+    }
+    for (const auto* v : node->outputs()) {
+      if (!v->type()->cast<TensorType>()) {
+        continue;
+      }
+      size_t last = last_use_fn(v);
+      auto idx = values_to_idx_in_creation_order.at(v) + 1;
+      for (; idx < values_in_creation_order.size(); ++idx) {
+        const auto* alias_v = values_in_creation_order[idx];
+        if (mayContainAlias(db, v, alias_v)) {
+          last = std::max(last, last_use_fn(alias_v));
+        }
+      }
+      lifetimes[v] = std::make_pair(node_to_idx.at(node), last);
+    }
+  }
+  return lifetimes;
+}
+
+// Whether a node must not run concurrently with any other node: it has side
+// effects or writes to its inputs, or a node in one of its blocks does
+bool IsOrderedNode(Node* node, AliasDb& db) {
+  if (node->hasSideEffects() || db.isMutable(node)) {
+    return true;
+  }
+  for (Block* block : node->blocks()) {
+    for (Node* inner : block->nodes()) {
+      if (IsOrderedNode(inner, db)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Returns the stage of each node, in the order of StaticModule::nodes_, for
+// enable_inter_op_parallelism. A node runs in the stage after the last stage
+// of the nodes producing the values it uses, including the values used in
+// its blocks, so the nodes of one stage are independent of each other.
+// Ordered nodes (see IsOrderedNode) get a stage of their own, after all
+// nodes before them and before all nodes after them.
+std::vector<size_t> GetNodeStages(
+    const std::shared_ptr<torch::jit::Graph>& graph,
+    AliasDb& db) {
+  std::unordered_map<const Node*, size_t> node_to_stage;
+  std::vector<size_t> stages;
+  size_t num_stages = 0;
+  // first stage the next node may run in
+  size_t min_stage = 0;
+
+  for (Node* node : graph->nodes()) {
+    if (node->kind() == prim::Constant) {
+      continue;
+    }
+    size_t stage = min_stage;
+    const bool ordered = IsOrderedNode(node, db);
+    if (ordered) {
+      stage = num_stages;
+    } else {
+      std::function<void(Node*)> add_dependencies = [&](Node* n) {
+        for (const Value* input : n->inputs()) {
+          const Node* producer = input->node();
+          while (producer->owningBlock() != graph->block()) {
+            producer = producer->owningBlock()->owningNode();
+          }
+          const auto it = node_to_stage.find(producer);
+          if (producer != node && it != node_to_stage.end()) {
+            stage = std::max(stage, it->second + 1);
+          }
+        }
+        for (Block* block : n->blocks()) {
+          for (Node* inner : block->nodes()) {
+            add_dependencies(inner);
+          }
+          add_dependencies(block->return_node());
+        }
+      };
+      add_dependencies(node);
+    }
+    node_to_stage[node] = stage;
+    stages.push_back(stage);
+    num_stages = std::max(num_stages, stage + 1);
+    if (ordered) {
+      min_stage = stage + 1;
+    }
+  }
+  return stages;
+}
+
 // Collect the set of Values that are candidates for memory planning:
 //   - Values that are used in in-place operators (i.e., _out variants), and
 //   - excluding those that are either inputs or outputs of
@@ -509,6 +663,9 @@ StaticModule::StaticModule(
         c10::optional<c10::FunctionSchema>> graph_and_schema,
     const StaticModuleOptions& opts)
     : opts_(opts),
+      runtime_pool_(std::make_unique<StaticRuntimePool>(
+          opts.max_idle_runtimes,
+          opts.runtime_idle_timeout)),
       graph_(std::move(graph_and_schema.first)),
       schema_(std::move(graph_and_schema.second)) {
   // map Value* to IValue (from inputs or prim::Constant) or null
@@ -535,6 +692,12 @@ StaticModule::StaticModule(
     }
     auto* v = node->output();
     TORCH_CHECK(v->type()->kind() != FunctionType::Kind);
+    if (opts.deduplicate_constants && node->hasAttribute(attr::value) &&
+        node->kindOf(attr::value) == AttributeKind::t) {
+      node->t_(
+          attr::value,
+          StaticConstantStore::global().intern(node->t(attr::value)));
+    }
     constants_.emplace_back(toIValue(v).value());
   }
   {
@@ -556,15 +719,32 @@ StaticModule::StaticModule(
     if (node->kind() == prim::Constant) {
       continue;
     }
+    c10::optional<ProcessedBlocks> blocks;
+    if (!node->blocks().empty()) {
+      blocks.emplace(node, opts);
+    }
     std::vector<const IValue*> ivalue_inputs;
     std::vector<DefInfo> input_ssa_defs;
     for (Value* input : node->inputs()) {
       ivalue_inputs.emplace_back(value_to_ivalue.at(input));
       input_ssa_defs.emplace_back(value_to_ssa_def.at(input));
     }
+    if (blocks) {
+      for (Value* input : blocks->free_variables()) {
+        ivalue_inputs.emplace_back(value_to_ivalue.at(input));
+        input_ssa_defs.emplace_back(value_to_ssa_def.at(input));
+      }
+    }
     node_inputs_ssa_def_map_[node_idx] = input_ssa_defs;
     nodes_.emplace_back(
-        ProcessedNode(node, std::move(ivalue_inputs), opts.enable_out_variant));
+        ProcessedNode(
+            node,
+            std::move(ivalue_inputs),
+            opts.enable_out_variant,
+            opts.cache_tensor_iterator_geometry));
+    if (blocks) {
+      nodes_.back().set_blocks(std::move(*blocks));
+    }
     for (size_t i = 0; i < node->outputs().size(); ++i) {
       value_to_ivalue[node->outputs()[i]] = nullptr;
       value_to_ssa_def[node->outputs()[i]] = std::make_pair(node_idx, i);
@@ -578,7 +758,22 @@ StaticModule::StaticModule(
   AliasDb alias_db(graph_);
   auto lm = GetLivenessInformation(graph_, alias_db);
   external_values_ = lm.second;
-  if (opts_.optimize_memory) {
+  std::vector<size_t> node_stages;
+  if (opts_.enable_inter_op_parallelism) {
+    node_stages = GetNodeStages(graph_, alias_db);
+    for (size_t i = 0; i < node_stages.size(); ++i) {
+      if (node_stages[i] >= parallel_stages_.size()) {
+        parallel_stages_.resize(node_stages[i] + 1);
+      }
+      parallel_stages_[node_stages[i]].push_back(i);
+    }
+  }
+  if (opts_.enable_out_variant) {
+    value_lifetimes_ = GetValueLifetimes(graph_, alias_db, node_stages);
+  }
+  // the liveness of memonger follows the order of the nodes, which the
+  // nodes of a stage don't run in
+  if (opts_.optimize_memory && !opts_.enable_inter_op_parallelism) {
     auto values = GetMemoryPlanningCandidates(graph_);
     if (!opts_.enable_out_variant) {
       values.first = {};
@@ -601,20 +796,100 @@ size_t StaticModule::num_inputs() const {
 }
 
 StaticRuntime& StaticModule::runtime() {
-  if (!cached_runtime_) {
-    cached_runtime_ = std::make_unique<StaticRuntime>(*this);
-  }
-  return *cached_runtime_;
+  return runtime_pool_->primary(*this);
 }
 
 std::vector<at::Tensor> StaticModule::operator()(
     const std::vector<at::Tensor>& inps) {
-  return runtime()(inps);
+  return runtime_pool_->run(
+      *this, [&](StaticRuntime& runtime) { return runtime(inps); });
 }
 c10::IValue StaticModule::operator()(
     const std::vector<c10::IValue>& args,
     const std::unordered_map<std::string, c10::IValue>& kwargs) {
-  return runtime()(args, kwargs);
+  return runtime_pool_->run(*this, [&](StaticRuntime& runtime) {
+    return runtime(args, kwargs);
+  });
+}
+
+// Note [StaticModule runtime pool]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// A StaticRuntime runs one inference at a time, so concurrent calls of a
+// StaticModule need runtimes of their own. A call takes the primary runtime,
+// the one StaticModule::runtime() returns, if no other call holds it, which is
+// a single atomic exchange and so costs single-threaded callers nothing.
+// Otherwise it takes the idle runtime that ran last, whose memory plan and
+// buffers are the most likely to be warm, or creates one, and hands it back
+// after the run. A runtime whose run threw is dropped instead, its state is
+// not worth trusting.
+//
+// At most max_idle_runtimes idle runtimes are kept, more are freed when they
+// are handed back, and runtimes idle for longer than runtime_idle_timeout are
+// freed, so the memory of a burst of concurrency is given back once it is
+// over. The primary runtime lives as long as the module.
+
+StaticRuntimePool::StaticRuntimePool(
+    size_t max_idle,
+    std::chrono::milliseconds idle_timeout)
+    : max_idle_(max_idle), idle_timeout_(idle_timeout) {}
+
+StaticRuntime& StaticRuntimePool::primary(const StaticModule& sm) {
+  // created on first use, so that the runtime refers to the module at its
+  // final address
+  if (!primary_) {
+    primary_ = std::make_unique<StaticRuntime>(sm);
+  }
+  return *primary_;
+}
+
+StaticRuntimePool::Lease StaticRuntimePool::acquire(const StaticModule& sm) {
+  if (!primary_in_use_.exchange(true, std::memory_order_acquire)) {
+    return {&primary(sm), true};
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    evict_idle(std::chrono::steady_clock::now());
+    if (!idle_.empty()) {
+      StaticRuntime* runtime = idle_.back().runtime.release();
+      idle_.pop_back();
+      return {runtime, false};
+    }
+    num_created_++;
+  }
+  return {new StaticRuntime(sm), false};
+}
+
+void StaticRuntimePool::release(const Lease& lease, bool failed) {
+  if (lease.primary) {
+    primary_in_use_.store(false, std::memory_order_release);
+    return;
+  }
+  std::unique_ptr<StaticRuntime> runtime(lease.runtime);
+  if (failed) {
+    return;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(mutex_);
+  evict_idle(now);
+  if (idle_.size() < max_idle_) {
+    idle_.push_back(IdleRuntime{std::move(runtime), now});
+  }
+}
+
+void StaticRuntimePool::evict_idle(std::chrono::steady_clock::time_point now) {
+  while (!idle_.empty() && now - idle_.front().since > idle_timeout_) {
+    idle_.pop_front();
+  }
+}
+
+size_t StaticRuntimePool::num_idle() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return idle_.size();
+}
+
+size_t StaticRuntimePool::num_created() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_created_;
 }
 
 StaticRuntime::StaticRuntime(const StaticModule& sm) : static_module_(sm) {
@@ -696,33 +971,62 @@ c10::IValue StaticRuntime::operator()(
   // functions, such as resize_ and resize_as_.
   c10::InferenceMode mode;
 
-  if (planner_) {
-    planner_->allocate();
-  }
-
+  std::vector<c10::IValue> s;
   if (!kwargs.empty()) {
     // This is not ideal
     TORCH_CHECK(
         static_module_.schema(),
         "Schema is not available. Consider creating the Static Runtime "
         "with StaticModule(const torch::jit::Module& m) instead.");
-    std::vector<c10::IValue> s = args;
+    s = args;
     static_module_.schema()->checkAndNormalizeInputs(s, kwargs);
-    for (size_t i = 0; i < s.size(); i++) {
-      Input(i) = std::move(s[i]);
+  }
+  const std::vector<c10::IValue>& inputs = kwargs.empty() ? args : s;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    Input(i) = inputs[i];
+  }
+
+  run_graph();
+
+  // Inputs are cleaned up by run_graph and constants belong to the module,
+  // so graphs returning them, like the blocks of prim::If and prim::Loop
+  // often do, get copies. Node outputs are moved, there is no need to keep
+  // references of them in static runtime anymore.
+  auto take_output = [&](size_t i) -> c10::IValue {
+    const auto& def = static_module_.output_indices()[i];
+    if (def.first == StaticModule::INPUT_VALUE) {
+      return inputs[def.second];
     }
-  } else {
-    for (size_t i = 0; i < args.size(); i++) {
-      Input(i) = args[i];
+    if (def.first == StaticModule::CONSTANT_VALUE) {
+      return *outputs_[i];
+    }
+    return std::move(*outputs_[i]);
+  };
+  if (static_module_.num_outputs() > 1) {
+    std::vector<c10::IValue> outputs;
+    outputs.reserve(static_module_.num_outputs());
+    for (auto i = 0; i < static_module_.num_outputs(); ++i) {
+      outputs.emplace_back(take_output(i));
     }
+    return c10::ivalue::Tuple::create(std::move(outputs));
+  }
+
+#ifndef NDEBUG
+  check_for_memory_leak(false);
+#endif
+
+  return take_output(0);
+}
+
+void StaticRuntime::run_graph() {
+  if (planner_) {
+    planner_->allocate(memory_plan_bucket());
   }
 
   // NB: before optimizing the order of execution, ensure that the
   // memory optimization pass (LivenessMap) is
   // aware of the new order!
-  for (auto& n : nodes_) {
-    n.run();
-  }
+  run_nodes();
 
   if (static_module_.opts().cleanup_activations) {
     if (!planner_) {
@@ -730,7 +1034,12 @@ c10::IValue StaticRuntime::operator()(
           this,
           static_module_.values_share_same_storage(),
           static_module_.external_values(),
-          static_module_.opts().enable_out_variant);
+          static_module_.value_lifetimes(),
+          static_module_.opts().enable_out_variant,
+          static_module_.opts().optimize_output_memory,
+          static_module_.opts().bucket_memory_plans);
+      // record the first run in the plan of its bucket
+      planner_->select_plan(memory_plan_bucket());
     }
     planner_->deallocate();
     // clean up owning refs of input tensors
@@ -738,24 +1047,201 @@ c10::IValue StaticRuntime::operator()(
       ival = IValue();
     }
   }
+}
 
-  // no need to keep references of outputs in static runtime anymore
-  if (static_module_.num_outputs() > 1) {
-    std::vector<c10::IValue> outputs;
-    outputs.reserve(static_module_.num_outputs());
-    for (auto i = 0; i < static_module_.num_outputs(); ++i) {
-      // use move here. Otherwise, clean up outputs_[i] explicitly
-      outputs.emplace_back(std::move(*outputs_[i]));
+// Note [Bound inputs and outputs]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// operator() copies its arguments into inputs_ and boxes the outputs into a
+// new IValue, or a new tuple for several outputs, on every call. A serving
+// loop that refills the same input tensors and consumes the outputs in place
+// can instead bind them once:
+//
+//   runtime.bind_inputs({input});
+//   runtime.bind_outputs({output});
+//   while (...) {
+//     input.copy_(...);
+//     runtime.run();
+//     consume(output);
+//   }
+//
+// run() points inputs_ to the bound inputs, and before running the nodes,
+// points the output IValue of each node with an out variant that produces a
+// graph output to its bound tensor, so the out variant writes the result
+// straight into it, resizing it as needed. The other outputs, e.g. views or
+// outputs of ops without out variant, are copied into their bound tensors
+// after the run. Either way the bound tensors keep their identity, so the
+// caller can hold on to them across runs. Outputs must be Tensors with the
+// dtype of the bound tensors, and outputs can't be bound with
+// optimize_output_memory, which hands the outputs out of its own arena.
+
+void StaticRuntime::bind_inputs(std::vector<at::Tensor> inputs) {
+  TORCH_CHECK(
+      inputs.size() == inputs_.size(),
+      "Expected ",
+      inputs_.size(),
+      " inputs to bind, got ",
+      inputs.size());
+  bound_inputs_ = std::move(inputs);
+}
+
+void StaticRuntime::bind_outputs(std::vector<at::Tensor> outputs) {
+  TORCH_CHECK(
+      outputs.size() == outputs_.size(),
+      "Expected ",
+      outputs_.size(),
+      " outputs to bind, got ",
+      outputs.size());
+  TORCH_CHECK(
+      !static_module_.opts().optimize_output_memory,
+      "Outputs can't be bound with optimize_output_memory");
+  for (const auto& output : outputs) {
+    TORCH_CHECK(output.defined(), "Bound outputs must be defined");
+  }
+  bound_outputs_ = std::move(outputs);
+  bound_outputs_in_place_.assign(outputs_.size(), false);
+  std::unordered_set<const IValue*> seen;
+  for (size_t i = 0; i < outputs_.size(); ++i) {
+    int node_idx;
+    int out_idx;
+    std::tie(node_idx, out_idx) = static_module_.output_indices()[i];
+    // an output returned twice is written into its first bound tensor
+    bound_outputs_in_place_[i] = node_idx >= 0 &&
+        nodes_[node_idx].has_out_variant() &&
+        seen.insert(outputs_[i]).second;
+  }
+}
+
+void StaticRuntime::run() {
+  TORCH_CHECK(
+      bound_inputs_.size() == inputs_.size() &&
+          bound_outputs_.size() == outputs_.size(),
+      "Bind the inputs and outputs before calling run()");
+  // See Note [Bound inputs and outputs]
+  c10::InferenceMode mode;
+
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    inputs_[i] = bound_inputs_[i];
+  }
+  for (size_t i = 0; i < outputs_.size(); ++i) {
+    if (bound_outputs_in_place_[i]) {
+      *outputs_[i] = bound_outputs_[i];
     }
-    return c10::ivalue::Tuple::create(std::move(outputs));
   }
 
-#ifndef NDEBUG
-  check_for_memory_leak(false);
-#endif
+  run_graph();
+
+  for (size_t i = 0; i < outputs_.size(); ++i) {
+    int node_idx;
+    int out_idx;
+    std::tie(node_idx, out_idx) = static_module_.output_indices()[i];
+    // inputs_ were cleaned up already
+    const IValue& output = node_idx == StaticModule::INPUT_VALUE
+        ? IValue(bound_inputs_[out_idx])
+        : *outputs_[i];
+    TORCH_CHECK(output.isTensor(), "Output ", i, " is not a Tensor");
+    at::Tensor& bound = bound_outputs_[i];
+    if (!output.toTensor().is_same(bound)) {
+      bound.resize_(output.toTensor().sizes());
+      bound.copy_(output.toTensor());
+    }
+  }
+  // release the outputs of the nodes, constants returned as outputs stay
+  for (size_t i = 0; i < outputs_.size(); ++i) {
+    if (static_module_.output_indices()[i].first >= 0) {
+      *outputs_[i] = IValue();
+    }
+  }
+}
+
+namespace {
+
+// Shared by the tasks running the nodes of one stage. Tasks that start after
+// all nodes were taken exit without touching the nodes, so the caller only
+// waits for the nodes to be done.
+struct StageState {
+  explicit StageState(size_t num_nodes) : num_nodes(num_nodes) {}
+
+  const size_t num_nodes;
+  std::atomic<size_t> next{0};
+  std::mutex mutex;
+  std::condition_variable cv;
+  size_t num_done = 0; // guarded by mutex
+  std::exception_ptr error; // guarded by mutex
+};
+
+void RunStageNodes(
+    const std::shared_ptr<StageState>& state,
+    const std::vector<size_t>& stage,
+    std::vector<ProcessedNode>& nodes) {
+  for (size_t i = state->next++; i < state->num_nodes; i = state->next++) {
+    std::exception_ptr error;
+    try {
+      nodes[stage[i]].run();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (error && !state->error) {
+      state->error = error;
+    }
+    if (++state->num_done == state->num_nodes) {
+      state->cv.notify_one();
+    }
+  }
+}
+
+} // namespace
+
+void StaticRuntime::run_nodes() {
+  if (!static_module_.opts().enable_inter_op_parallelism) {
+    for (auto& n : nodes_) {
+      n.run();
+    }
+    return;
+  }
+
+  const size_t num_threads = at::get_num_interop_threads();
+  for (const auto& stage : static_module_.parallel_stages()) {
+    if (stage.size() == 1 || num_threads <= 1) {
+      for (const size_t idx : stage) {
+        nodes_[idx].run();
+      }
+      continue;
+    }
+    // The calling thread runs nodes of the stage too, which keeps progress
+    // when the pool is busy, e.g. when called from an inter-op thread
+    auto state = std::make_shared<StageState>(stage.size());
+    const size_t num_tasks = std::min(stage.size() - 1, num_threads);
+    auto* nodes = &nodes_;
+    for (size_t i = 0; i < num_tasks; ++i) {
+      at::launch([state, &stage, nodes]() {
+        RunStageNodes(state, stage, *nodes);
+      });
+    }
+    RunStageNodes(state, stage, nodes_);
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&] { return state->num_done == state->num_nodes; });
+    if (state->error) {
+      std::rethrow_exception(state->error);
+    }
+  }
+}
 
-  // use move here. Otherwise, clean up outputs_[0] explicitly
-  return std::move(*outputs_[0]);
+size_t StaticRuntime::memory_plan_bucket() const {
+  if (!static_module_.opts().bucket_memory_plans) {
+    return 0;
+  }
+  for (const IValue& input : inputs_) {
+    if (input.isTensor() && input.toTensor().dim() > 0) {
+      const int64_t batch_size = input.toTensor().size(0);
+      size_t bucket = 0;
+      while ((int64_t(1) << bucket) < batch_size) {
+        ++bucket;
+      }
+      return bucket;
+    }
+  }
+  return 0;
 }
 
 void StaticRuntime::benchmark(
@@ -807,11 +1293,31 @@ void StaticRuntime::benchmark(
   if (planner_) {
     std::cout << "Total memory managed: " << planner_->total_managed()
               << " bytes" << std::endl;
+    std::cout << "Arena size of managed memory: " << planner_->arena_size()
+              << " bytes" << std::endl;
+    if (static_module_.opts().optimize_output_memory) {
+      std::cout << "Total output memory managed: "
+                << planner_->total_managed_outputs() << " bytes" << std::endl;
+    }
     if (static_module_.opts().optimize_memory) {
       std::cout << "Total number of reused tensors: "
                 << planner_->total_reused_tensors() << std::endl;
     }
   }
+
+  // See Note [Generic out variants]
+  std::map<std::string, int> fallback_nodes;
+  for (const ProcessedNode& pnode : nodes_) {
+    if (!pnode.has_out_variant() && !canRunNatively(pnode.node())) {
+      fallback_nodes[pnode.node()->kind().toQualString()]++;
+    }
+  }
+  if (!fallback_nodes.empty()) {
+    std::cout << "Nodes without out variant:" << std::endl;
+    for (const auto& p : fallback_nodes) {
+      std::cout << std::setw(10) << p.second << " " << p.first << std::endl;
+    }
+  }
 }
 
 float StaticRuntime::benchmark_model(
@@ -837,6 +1343,54 @@ StaticRuntime::IndividualMetrics StaticRuntime::benchmark_individual_ops(
     const std::unordered_map<std::string, c10::IValue>& kwargs,
     const int warmup_runs,
     const int main_runs) {
+  return run_individual_ops(args, kwargs, warmup_runs, main_runs, nullptr);
+}
+
+namespace {
+
+// Counts the CPU allocations reported on this thread, for
+// StaticRuntime::profile
+struct AllocationCounter : public c10::MemoryReportingInfoBase {
+  void reportMemoryUsage(void* /* unused */, int64_t alloc_size, c10::Device)
+      override {
+    if (alloc_size > 0) {
+      bytes += alloc_size;
+      allocations++;
+    }
+  }
+
+  bool memoryProfilingEnabled() const override {
+    return true;
+  }
+
+  size_t bytes = 0;
+  size_t allocations = 0;
+};
+
+// nearest-rank percentile of sorted
+float percentile(const std::vector<float>& sorted, double q) {
+  const auto rank = static_cast<size_t>(std::ceil(q * sorted.size()));
+  return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+} // namespace
+
+StaticRuntime::ProfileResults StaticRuntime::profile(
+    const std::vector<c10::IValue>& args,
+    const std::unordered_map<std::string, c10::IValue>& kwargs,
+    const int warmup_runs,
+    const int main_runs) {
+  ProfileResults results;
+  run_individual_ops(args, kwargs, warmup_runs, main_runs, &results);
+  return results;
+}
+
+StaticRuntime::IndividualMetrics StaticRuntime::run_individual_ops(
+    const std::vector<c10::IValue>& args,
+    const std::unordered_map<std::string, c10::IValue>& kwargs,
+    const int warmup_runs,
+    const int main_runs,
+    ProfileResults* profile) {
   TORCH_CHECK(warmup_runs >= 0 && main_runs >= 1);
 
   // See comment on above use of InferenceMode for
@@ -867,6 +1421,18 @@ StaticRuntime::IndividualMetrics StaticRuntime::benchmark_individual_ops(
     operator()(args, kwargs);
   }
 
+  // per run times of the nodes, and the allocations the nodes made
+  std::vector<std::vector<float>> node_times;
+  std::vector<std::pair<size_t, size_t>> node_allocations;
+  std::shared_ptr<AllocationCounter> counter;
+  c10::optional<c10::DebugInfoGuard> counter_guard;
+  if (profile) {
+    node_times.resize(nodes_.size());
+    node_allocations.resize(nodes_.size());
+    counter = std::make_shared<AllocationCounter>();
+    counter_guard.emplace(c10::DebugInfoKind::PROFILER_STATE, counter);
+  }
+
   // main runs
   for (int k = 0; k < main_runs; k++) {
     for (size_t i = 0; i < stack.size(); i++) {
@@ -874,16 +1440,23 @@ StaticRuntime::IndividualMetrics StaticRuntime::benchmark_individual_ops(
     }
     timer.Start();
     if (planner_) {
-      planner_->allocate();
+      planner_->allocate(memory_plan_bucket());
     }
     float millis = timer.MilliSeconds();
     results.memory_alloc_time += millis;
 
     for (size_t i = 0; i < nodes_.size(); i++) {
+      const size_t bytes = counter ? counter->bytes : 0;
+      const size_t allocations = counter ? counter->allocations : 0;
       timer.Start();
       nodes_[i].run();
       millis = timer.MilliSeconds();
       results.time_per_node[i] += millis;
+      if (profile) {
+        node_times[i].push_back(millis);
+        node_allocations[i].first += counter->bytes - bytes;
+        node_allocations[i].second += counter->allocations - allocations;
+      }
     }
     timer.Start();
     if (static_module_.opts().cleanup_activations) {
@@ -892,7 +1465,12 @@ StaticRuntime::IndividualMetrics StaticRuntime::benchmark_individual_ops(
             this,
             static_module_.values_share_same_storage(),
             static_module_.external_values(),
-            static_module_.opts().enable_out_variant);
+            static_module_.value_lifetimes(),
+            static_module_.opts().enable_out_variant,
+            static_module_.opts().optimize_output_memory,
+            static_module_.opts().bucket_memory_plans);
+        // record the first run in the plan of its bucket
+        planner_->select_plan(memory_plan_bucket());
       }
       planner_->deallocate();
       // clean up owning refs of input tensors
@@ -944,6 +1522,47 @@ StaticRuntime::IndividualMetrics StaticRuntime::benchmark_individual_ops(
     const std::string& kind = p.first;
     results.percent_per_node_type[kind] = p.second / results.total_time * 100;
   }
+
+  if (profile) {
+    counter_guard.reset();
+    profile->nodes.resize(nodes_.size());
+    for (size_t i = 0; i < nodes_.size(); i++) {
+      const ProcessedNode& pnode = nodes_[i];
+      NodeProfile& node_profile = profile->nodes[i];
+      node_profile.kind = pnode.node()->kind().toQualString();
+      std::ostringstream ss;
+      pnode.node()->print(ss, 0, nullptr, false);
+      node_profile.node = ss.str();
+      if (pnode.has_out_variant()) {
+        node_profile.run_mode = "out_variant";
+      } else if (canRunNatively(pnode.node())) {
+        node_profile.run_mode = "native";
+      } else {
+        node_profile.run_mode = "fallback";
+      }
+
+      std::vector<float>& times = node_times[i];
+      std::sort(times.begin(), times.end());
+      node_profile.mean_time = results.time_per_node[i];
+      node_profile.p50_time = percentile(times, 0.5);
+      node_profile.p90_time = percentile(times, 0.9);
+      node_profile.p99_time = percentile(times, 0.99);
+      node_profile.max_time = times.back();
+      node_profile.allocated_bytes = node_allocations[i].first / main_runs;
+      node_profile.num_allocations = node_allocations[i].second / main_runs;
+
+      NodeKindProfile& kind_profile = profile->node_kinds[node_profile.kind];
+      kind_profile.instances++;
+      kind_profile.time += node_profile.mean_time;
+      kind_profile.allocated_bytes += node_profile.allocated_bytes;
+      kind_profile.num_allocations += node_profile.num_allocations;
+      profile->allocated_bytes += node_profile.allocated_bytes;
+    }
+    profile->total_time = results.total_time;
+    for (auto& p : profile->node_kinds) {
+      p.second.percent = results.percent_per_node_type[p.first];
+    }
+  }
   return results;
 }
 
@@ -994,13 +1613,17 @@ static void assign_storage_to_managed_tensors(
     const std::unordered_set<const Value*>& managed_tensor_values,
     const std::unordered_map<const Value*, std::vector<const Value*>>&
         value_to_same_storage_values,
+    const std::unordered_map<const Value*, ValueLifetime>& value_lifetimes,
     std::vector<std::pair<size_t, std::vector<c10::StorageImpl*>>>&
-        managed_storage) {
+        managed_storage,
+    std::vector<ValueLifetime>& managed_storage_lifetimes) {
   // map Value to index to managed_storage, where multiple values can
   // map to the same index (i.e., sharing the same storage)
   std::unordered_map<const Value*, size_t> value_to_storage_idx;
   // the StorageImpls of Tensor views should not be managed
-  std::unordered_set<c10::StorageImpl*> managed_storage_impls;
+  std::unordered_map<c10::StorageImpl*, size_t> managed_storage_impls;
+  // values without a known lifetime are alive during the whole run
+  const ValueLifetime whole_run(0, runtime->nodes().size());
 
   // Snapshot of the current memory state
   for (const auto& pnode : runtime->nodes()) {
@@ -1010,28 +1633,46 @@ static void assign_storage_to_managed_tensors(
       if (managed_tensor_values.count(val)) {
         TORCH_CHECK(ival.isTensor());
         auto* impl = ival.toTensor().storage().unsafeGetStorageImpl();
-
-        auto didInsert = managed_storage_impls.insert(impl).second;
-        if (!didInsert) {
+        const auto lifetime_it = value_lifetimes.find(val);
+        const ValueLifetime& lifetime = lifetime_it != value_lifetimes.end()
+            ? lifetime_it->second
+            : whole_run;
+
+        auto it = managed_storage_impls.find(impl);
+        if (it != managed_storage_impls.end()) {
+          // the lifetime of a storage covers those of all of its tensors
+          auto& storage_lifetime = managed_storage_lifetimes[it->second];
+          storage_lifetime.first =
+              std::min(storage_lifetime.first, lifetime.first);
+          storage_lifetime.second =
+              std::max(storage_lifetime.second, lifetime.second);
           continue;
         }
 
+        size_t storage_idx;
         if (value_to_storage_idx.count(val)) {
-          managed_storage[value_to_storage_idx.at(val)].second.emplace_back(
-              impl);
+          storage_idx = value_to_storage_idx.at(val);
+          managed_storage[storage_idx].second.emplace_back(impl);
+          auto& storage_lifetime = managed_storage_lifetimes[storage_idx];
+          storage_lifetime.first =
+              std::min(storage_lifetime.first, lifetime.first);
+          storage_lifetime.second =
+              std::max(storage_lifetime.second, lifetime.second);
         } else {
           auto p =
               std::make_pair<size_t, std::vector<c10::StorageImpl*>>(0, {impl});
           managed_storage.emplace_back(std::move(p));
+          managed_storage_lifetimes.emplace_back(lifetime);
+          storage_idx = managed_storage.size() - 1;
           // first of a group, update the value_to_storage_idx map with the
           // index
           if (value_to_same_storage_values.count(val)) {
-            auto storage_idx = managed_storage.size() - 1;
             for (const auto* v : value_to_same_storage_values.at(val)) {
               value_to_storage_idx[v] = storage_idx;
             }
           }
         }
+        managed_storage_impls[impl] = storage_idx;
       }
     }
   }
@@ -1042,10 +1683,16 @@ MemoryPlanner::MemoryPlanner(
     const std::unordered_map<const Value*, std::vector<const Value*>>&
         value_to_same_storage_values,
     const std::unordered_set<const Value*>& external_values,
-    bool out_variants) {
+    const std::unordered_map<const Value*, ValueLifetime>& value_lifetimes,
+    bool out_variants,
+    bool optimize_output_memory,
+    bool bucket_memory_plans)
+    : bucket_memory_plans_(bucket_memory_plans) {
   // collect register indices of outputs of ops with out variant
   std::unordered_set<const Value*> managed_tensor_values;
   std::unordered_set<const Value*> leaked_values;
+  // outputs of the graph produced by ops with out variant
+  std::unordered_set<const Value*> managed_output_values;
   if (out_variants) {
     for (ProcessedNode& pnode : runtime->nodes()) {
       if (canReuseInputsOutputs(pnode.node())) {
@@ -1066,14 +1713,31 @@ MemoryPlanner::MemoryPlanner(
         }
       }
     }
+    if (optimize_output_memory) {
+      for (const Value* output : runtime->graph().outputs()) {
+        if (output->node()->kind() != prim::Constant &&
+            output->node()->kind() != prim::Param &&
+            canReuseInputsOutputs(output->node()) &&
+            output->type()->cast<TensorType>()) {
+          managed_output_values.insert(output);
+        }
+      }
+    }
   }
 
   // collect unmanaged output ivalues
   std::unordered_set<IValue*> unmanaged_ivalues;
+  std::unordered_set<IValue*> managed_output_ivalues;
   for (ProcessedNode& pnode : runtime->nodes()) {
     for (auto i = 0; i < pnode.outputs().size(); ++i) {
       // Types are stored in the underlying TorchScript IR
       const Value* out_v = pnode.node()->outputs()[i];
+      if (managed_output_values.count(out_v)) {
+        IValue* out = &pnode.Output(i);
+        if (managed_output_ivalues.insert(out).second) {
+          managed_outputs_.push_back({out, 0, caffe2::TypeMeta()});
+        }
+      }
       if (managed_tensor_values.count(out_v) || leaked_values.count(out_v)) {
         continue;
       }
@@ -1100,7 +1764,9 @@ MemoryPlanner::MemoryPlanner(
         runtime,
         managed_tensor_values,
         value_to_same_storage_values,
-        managed_tensor_storage_);
+        value_lifetimes,
+        managed_tensor_storage_,
+        managed_tensor_lifetimes_);
   }
 }
 
@@ -1116,35 +1782,194 @@ at::DataPtr MemoryPlanner::allocate_buffer(size_t size) {
   return allocator->allocate(size);
 }
 
-void MemoryPlanner::allocate() {
-  if (managed_bytes_ == 0) {
-    return;
+size_t AssignArenaOffsets(
+    const std::vector<size_t>& sizes,
+    const std::vector<ValueLifetime>& lifetimes,
+    std::vector<size_t>& offsets) {
+  TORCH_INTERNAL_ASSERT(sizes.size() == lifetimes.size());
+  offsets.assign(sizes.size(), 0);
+
+  // largest first, ties broken by lifetime and index for determinism
+  std::vector<size_t> order(sizes.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
   }
-  buffer_ = allocate_buffer(managed_bytes_);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    if (sizes[a] != sizes[b]) {
+      return sizes[a] > sizes[b];
+    }
+    if (lifetimes[a] != lifetimes[b]) {
+      return lifetimes[a] < lifetimes[b];
+    }
+    return a < b;
+  });
+
+  size_t arena_size = 0;
+  // placed buffers, ordered by offset
+  std::vector<size_t> placed;
+  placed.reserve(sizes.size());
+  for (const size_t i : order) {
+    const size_t size = sizes[i];
+    if (size == 0) {
+      continue;
+    }
+    size_t best_offset = 0;
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    size_t prev_end = 0;
+    for (const size_t j : placed) {
+      const bool overlap = lifetimes[i].first <= lifetimes[j].second &&
+          lifetimes[j].first <= lifetimes[i].second;
+      if (!overlap) {
+        continue;
+      }
+      if (offsets[j] >= prev_end) {
+        const size_t gap = offsets[j] - prev_end;
+        if (gap >= size && gap < best_gap) {
+          best_offset = prev_end;
+          best_gap = gap;
+        }
+      }
+      prev_end = std::max(prev_end, offsets[j] + sizes[j]);
+    }
+    if (best_gap == std::numeric_limits<size_t>::max()) {
+      best_offset = prev_end;
+    }
+    offsets[i] = best_offset;
+    arena_size = std::max(arena_size, best_offset + size);
+    placed.insert(
+        std::upper_bound(
+            placed.begin(),
+            placed.end(),
+            best_offset,
+            [&](size_t offset, size_t j) { return offset < offsets[j]; }),
+        i);
+  }
+  return arena_size;
+}
+
+namespace {
+
+// Shared by the output tensors allocated together in one run, see
+// MemoryPlanner::allocate
+struct OutputBuffer {
+  std::atomic<size_t> refcount;
+  at::DataPtr data;
+};
+
+void releaseOutputBuffer(void* ctx) {
+  auto* buffer = static_cast<OutputBuffer*>(ctx);
+  if (--buffer->refcount == 0) {
+    delete buffer;
+  }
+}
 
-  size_t offset = 0;
-  uint8_t* start = static_cast<uint8_t*>(buffer_.get());
+} // namespace
+
+void MemoryPlanner::select_plan(size_t bucket) {
+  if (!bucket_memory_plans_ || bucket == bucket_) {
+    return;
+  }
+  if (plans_.size() <= std::max(bucket, bucket_)) {
+    plans_.resize(std::max(bucket, bucket_) + 1);
+  }
 
-  reused_tensors_ = 0;
+  Plan& current = plans_[bucket_];
+  current.storage_sizes.clear();
   for (const auto& ms : managed_tensor_storage_) {
-    auto tensor_size = ms.first;
-    if (tensor_size == 0) {
-      continue;
+    current.storage_sizes.push_back(ms.first);
+  }
+  current.offsets = std::move(managed_tensor_offsets_);
+  current.managed_bytes = managed_bytes_;
+  current.arena_bytes = arena_bytes_;
+  current.outputs.clear();
+  for (const auto& output : managed_outputs_) {
+    current.outputs.emplace_back(output.nbytes, output.dtype);
+  }
+  current.output_bytes = managed_output_bytes_;
+
+  // a bucket that was never run starts without a plan, and its first run
+  // allocates with the default allocator
+  Plan& next = plans_[bucket];
+  for (size_t i = 0; i < managed_tensor_storage_.size(); ++i) {
+    managed_tensor_storage_[i].first =
+        i < next.storage_sizes.size() ? next.storage_sizes[i] : 0;
+  }
+  managed_tensor_offsets_ = std::move(next.offsets);
+  managed_bytes_ = next.managed_bytes;
+  arena_bytes_ = next.arena_bytes;
+  for (size_t i = 0; i < managed_outputs_.size(); ++i) {
+    if (i < next.outputs.size()) {
+      managed_outputs_[i].nbytes = next.outputs[i].first;
+      managed_outputs_[i].dtype = next.outputs[i].second;
+    } else {
+      managed_outputs_[i].nbytes = 0;
     }
-    const auto& impls = ms.second;
-    DCHECK_LE(offset + tensor_size, managed_bytes_);
-    void* src = static_cast<void*>(start + offset);
+  }
+  managed_output_bytes_ = next.output_bytes;
+  bucket_ = bucket;
+}
 
-    for (auto& impl : impls) {
-      impl->set_data_ptr_noswap(at::DataPtr(src, src, nullptr, impl->device()));
-      impl->set_nbytes(tensor_size);
-      reused_tensors_++;
+void MemoryPlanner::allocate(size_t bucket) {
+  select_plan(bucket);
+
+  if (managed_bytes_ != 0) {
+    if (buffer_bytes_ < arena_bytes_) {
+      // free the old arena first, its size was outgrown
+      buffer_ = {};
+      buffer_ = allocate_buffer(arena_bytes_);
+      buffer_bytes_ = arena_bytes_;
+    }
+
+    uint8_t* start = static_cast<uint8_t*>(buffer_.get());
+
+    reused_tensors_ = 0;
+    for (size_t i = 0; i < managed_tensor_storage_.size(); ++i) {
+      const auto& ms = managed_tensor_storage_[i];
+      auto tensor_size = ms.first;
+      if (tensor_size == 0) {
+        continue;
+      }
+      const auto& impls = ms.second;
+      const size_t offset = managed_tensor_offsets_[i];
+      DCHECK_LE(offset + tensor_size, buffer_bytes_);
+      void* src = static_cast<void*>(start + offset);
+
+      for (auto& impl : impls) {
+        impl->set_data_ptr_noswap(
+            at::DataPtr(src, src, nullptr, impl->device()));
+        impl->set_nbytes(tensor_size);
+        reused_tensors_++;
+      }
+      reused_tensors_--;
     }
-    reused_tensors_--;
+  }
 
-    offset += tensor_size;
+  if (managed_output_bytes_ != 0) {
+    // The output tensors are created here, with the dtypes and sizes of the
+    // previous run, and share one buffer that is freed with the last of them.
+    // Out variants resize them as needed.
+    auto* output_buffer = new OutputBuffer();
+    output_buffer->data = allocate_buffer(managed_output_bytes_);
+    output_buffer->refcount = 1;
+    uint8_t* start = static_cast<uint8_t*>(output_buffer->data.get());
+    size_t offset = 0;
+    for (auto& output : managed_outputs_) {
+      if (output.nbytes == 0 || !output.ivalue->isNone()) {
+        continue;
+      }
+      at::Tensor tensor =
+          at::empty({0}, at::TensorOptions().dtype(output.dtype));
+      auto* impl = tensor.storage().unsafeGetStorageImpl();
+      output_buffer->refcount++;
+      impl->set_data_ptr_noswap(at::DataPtr(
+          start + offset, output_buffer, releaseOutputBuffer, impl->device()));
+      impl->set_nbytes(output.nbytes);
+      *output.ivalue = std::move(tensor);
+      offset += output.nbytes;
+    }
+    DCHECK_LE(offset, managed_output_bytes_);
+    releaseOutputBuffer(output_buffer);
   }
-  DCHECK_EQ(offset, managed_bytes_);
 }
 
 void MemoryPlanner::deallocate() {
@@ -1152,6 +1977,9 @@ void MemoryPlanner::deallocate() {
 
   // free memory used by outputs of ops in out variants
   // but keep the TensorImpl and StorageImpl around
+  bool sizes_changed = false;
+  std::vector<size_t> sizes;
+  sizes.reserve(managed_tensor_storage_.size());
   for (auto& ms : managed_tensor_storage_) {
     const auto& impls = ms.second;
     size_t max = 0;
@@ -1165,23 +1993,247 @@ void MemoryPlanner::deallocate() {
     // run (following C2 tradition), exploiting the fact that tensor storage
     // size does not have to match that of real tensor size. The following logic
     // records the tensor storage size for the next run.
+    if (bucket_memory_plans_) {
+      // the largest size seen in the bucket, so that its plan settles
+      max = std::max(max, ms.first);
+    }
+    sizes_changed |= ms.first != max;
     ms.first = max;
+    sizes.push_back(max);
     managed_bytes_ += max;
   }
+  // The offsets only need to be planned again when sizes changed, which
+  // doesn't happen with static shapes
+  if (sizes_changed || managed_tensor_offsets_.size() != sizes.size()) {
+    arena_bytes_ = AssignArenaOffsets(
+        sizes, managed_tensor_lifetimes_, managed_tensor_offsets_);
+  }
+
+  // the outputs of this run are released by the client, only record their
+  // sizes for the next run
+  managed_output_bytes_ = 0;
+  for (auto& output : managed_outputs_) {
+    const size_t previous_nbytes = output.nbytes;
+    output.nbytes = 0;
+    if (!output.ivalue->isTensor()) {
+      continue;
+    }
+    const auto& tensor = output.ivalue->toTensor();
+    if (tensor.defined() && tensor.device().is_cpu()) {
+      output.nbytes = compute_aligned_tensor_size(tensor.storage().nbytes());
+      if (bucket_memory_plans_ && output.dtype == tensor.dtype()) {
+        output.nbytes = std::max(output.nbytes, previous_nbytes);
+      }
+      output.dtype = tensor.dtype();
+      managed_output_bytes_ += output.nbytes;
+    }
+  }
 
   // for unmanaged ivalues (either tensor or non-tensor), we reset the *iv so
   // that the objects pointed to by *iv may be reclaimed by reference counting
   for (auto& iv : unmanaged_ivalues_) {
     *iv = IValue();
   }
-  buffer_ = {};
+}
+
+// Note [Static Runtime control flow]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// prim::If and prim::Loop run their blocks without the JIT interpreter. Each
+// block becomes a graph of its own, whose inputs are the inputs of the block
+// followed by the free variables of the node, i.e. the values used in any of
+// its blocks and defined outside of it, and whose outputs are those of the
+// block. The graph gets a StaticModule with the options of the enclosing
+// module, and so its own out variants and memory plan, which are reused on
+// every iteration of a loop and every run taking the branch.
+//
+// In the enclosing graph the node takes the free variables as extra inputs,
+// so that their lifetimes extend to the node like the liveness analysis of
+// its uses in sub-blocks already assumes, and runs the blocks on them:
+// - prim::If runs the block picked by its condition.
+// - prim::Loop runs its body while the trip count isn't reached and the
+//   condition holds, passing the iteration and the loop-carried values, and
+//   taking the condition and the new loop-carried values from its outputs.
+// The outputs of the blocks are not managed by their memory plan, they become
+// the unmanaged outputs of the node.
+
+namespace {
+
+// whether v is defined in one of the blocks of node, at any depth
+bool isDefinedInside(const Value* v, const Node* node) {
+  for (const Block* b = v->node()->owningBlock(); b != nullptr;) {
+    const Node* owner = b->owningNode();
+    if (owner == node) {
+      return true;
+    }
+    if (owner == nullptr) {
+      return false;
+    }
+    b = owner->owningBlock();
+  }
+  return false;
+}
+
+void collectFreeVariables(
+    Block* block,
+    const Node* node,
+    std::vector<Value*>& free_variables,
+    std::unordered_set<Value*>& seen) {
+  auto visit = [&](Node* n) {
+    for (Value* input : n->inputs()) {
+      if (!isDefinedInside(input, node) && seen.insert(input).second) {
+        free_variables.push_back(input);
+      }
+    }
+  };
+  for (Node* n : block->nodes()) {
+    visit(n);
+    for (Block* sub_block : n->blocks()) {
+      collectFreeVariables(sub_block, node, free_variables, seen);
+    }
+  }
+  visit(block->return_node());
+}
+
+std::shared_ptr<Graph> graphFromBlock(
+    Block* block,
+    const std::vector<Value*>& free_variables) {
+  auto graph = std::make_shared<Graph>();
+  std::unordered_map<Value*, Value*> env;
+  for (Value* input : block->inputs()) {
+    env[input] = graph->addInput()->copyMetadata(input);
+  }
+  for (Value* input : free_variables) {
+    env[input] = graph->addInput()->copyMetadata(input);
+  }
+  auto value_map = [&](Value* v) { return env.at(v); };
+  for (Node* n : block->nodes()) {
+    Node* clone = graph->insertNode(graph->createClone(n, value_map));
+    for (size_t i = 0; i < n->outputs().size(); ++i) {
+      env[n->outputs()[i]] = clone->outputs()[i];
+    }
+  }
+  for (Value* output : block->outputs()) {
+    graph->registerOutput(env.at(output));
+  }
+  if (block->outputs().empty()) {
+    graph->registerOutput(graph->insertConstant(IValue()));
+  }
+  return graph;
+}
+
+} // namespace
+
+ProcessedBlocks::ProcessedBlocks(Node* node, const StaticModuleOptions& opts)
+    : node_(node) {
+  TORCH_CHECK(
+      node->kind() == prim::If || node->kind() == prim::Loop,
+      "Static Runtime only supports the blocks of prim::If and prim::Loop, got ",
+      node->kind().toQualString());
+  std::unordered_set<Value*> seen;
+  for (Block* block : node->blocks()) {
+    collectFreeVariables(block, node, free_variables_, seen);
+  }
+  // the outputs of a block are passed on by the node, they can't live in its
+  // memory plan
+  StaticModuleOptions block_opts = opts;
+  block_opts.optimize_output_memory = false;
+  for (Block* block : node->blocks()) {
+    modules_.emplace_back(new StaticModule(
+        std::make_pair(graphFromBlock(block, free_variables_), c10::nullopt),
+        block_opts));
+  }
+  runtimes_.resize(modules_.size());
+}
+
+ProcessedBlocks::ProcessedBlocks(const ProcessedBlocks& other)
+    : node_(other.node_),
+      free_variables_(other.free_variables_),
+      modules_(other.modules_) {
+  runtimes_.resize(modules_.size());
+}
+
+ProcessedBlocks& ProcessedBlocks::operator=(const ProcessedBlocks& other) {
+  node_ = other.node_;
+  free_variables_ = other.free_variables_;
+  modules_ = other.modules_;
+  runtimes_.clear();
+  runtimes_.resize(modules_.size());
+  return *this;
+}
+
+std::vector<IValue> ProcessedBlocks::run_block(
+    size_t i,
+    std::vector<IValue>&& args) {
+  if (!runtimes_[i]) {
+    runtimes_[i] = std::make_unique<StaticRuntime>(*modules_[i]);
+  }
+  IValue result = (*runtimes_[i])(args, {});
+  const size_t num_outputs = node_->blocks()[i]->outputs().size();
+  if (num_outputs == 0) {
+    return {};
+  }
+  if (num_outputs == 1) {
+    return {std::move(result)};
+  }
+  auto elements = result.toTuple()->elements();
+  return std::vector<IValue>(
+      std::make_move_iterator(elements.begin()),
+      std::make_move_iterator(elements.end()));
+}
+
+void ProcessedBlocks::run(ProcessedNode* p_node) {
+  const size_t num_inputs = node_->inputs().size();
+  std::vector<IValue> free_values;
+  free_values.reserve(free_variables_.size());
+  for (size_t i = num_inputs; i < p_node->inputs().size(); ++i) {
+    free_values.emplace_back(p_node->Input(i));
+  }
+
+  if (node_->kind() == prim::If) {
+    auto outputs =
+        run_block(p_node->Input(0).toBool() ? 0 : 1, std::move(free_values));
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      p_node->Output(i) = std::move(outputs[i]);
+    }
+    return;
+  }
+
+  // prim::Loop(max_trip_count, initial_condition, loop_carried...)
+  const int64_t max_trip_count = p_node->Input(0).toInt();
+  bool condition = p_node->Input(1).toBool();
+  std::vector<IValue> carried;
+  carried.reserve(num_inputs - 2);
+  for (size_t i = 2; i < num_inputs; ++i) {
+    carried.emplace_back(p_node->Input(i));
+  }
+  for (int64_t trip = 0; trip < max_trip_count && condition; ++trip) {
+    std::vector<IValue> args;
+    args.reserve(1 + carried.size() + free_values.size());
+    args.emplace_back(trip);
+    args.insert(
+        args.end(),
+        std::make_move_iterator(carried.begin()),
+        std::make_move_iterator(carried.end()));
+    args.insert(args.end(), free_values.begin(), free_values.end());
+    auto outputs = run_block(0, std::move(args));
+    condition = outputs[0].toBool();
+    carried.assign(
+        std::make_move_iterator(outputs.begin() + 1),
+        std::make_move_iterator(outputs.end()));
+  }
+  for (size_t i = 0; i < carried.size(); ++i) {
+    p_node->Output(i) = std::move(carried[i]);
+  }
 }
 
 ProcessedNode::ProcessedNode(
     Node* node,
     std::vector<const IValue*>&& inputs,
-    bool enable_out_variants)
-    : node_(node), inputs_(std::move(inputs)) {
+    bool enable_out_variants,
+    bool cache_tensor_iterator_geometry)
+    : node_(node),
+      inputs_(std::move(inputs)),
+      cache_tensor_iterator_geometry_(cache_tensor_iterator_geometry) {
   // TODO leverage type information
   outputs_.resize(node->outputs().size());
 
@@ -1198,7 +2250,8 @@ ProcessedNode::ProcessedNode(
   } else if (
       node->kind() != prim::ListConstruct &&
       node->kind() != prim::TupleConstruct &&
-      node->kind() != prim::DictConstruct && node->kind() != prim::ListUnpack) {
+      node->kind() != prim::DictConstruct && node->kind() != prim::ListUnpack &&
+      node->kind() != prim::If && node->kind() != prim::Loop) {
     const Operator& op = node->getOperator();
     TORCH_CHECK(op.hasOperation());
     op_ = op.getOperation(node);
@@ -1211,9 +2264,16 @@ ProcessedNode::ProcessedNode(
 
 void ProcessedNode::run() {
   if (fn_) {
+    // Out variants write into the outputs of the previous run, so from the
+    // second run on their TensorIterator geometry is usually unchanged.
+    at::TensorIteratorGeometryCacheGuard guard(
+        cache_tensor_iterator_geometry_ ? &tensor_iterator_geometry_cache_
+                                        : nullptr);
     fn_(this);
   } else if (native_fn_) {
     native_fn_(this);
+  } else if (blocks_) {
+    blocks_->run(this);
   } else {
     std::vector<IValue> stack;
     const size_t size = node_->inputs().size();
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <ATen/TensorIterator.h>
 #include <ATen/core/interned_strings.h>
 #include <ATen/core/ivalue.h>
 #include <c10/core/CPUAllocator.h>
@@ -9,6 +10,11 @@
 #include <torch/csrc/jit/passes/freeze_module.h>
 #include <torch/csrc/jit/passes/inliner.h>
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+
 namespace torch {
 namespace jit {
 
@@ -16,8 +22,37 @@ struct TORCH_API StaticModuleOptions {
   bool cleanup_activations{true};
   bool enable_out_variant{true};
   bool optimize_memory{true};
-  // to enable MemoryPlanner on output tensors
+  // to enable MemoryPlanner on output tensors, which are then allocated
+  // together from one buffer per run
   bool optimize_output_memory{false};
+  // to let out variants reuse the TensorIterator geometry of their previous
+  // run when input and output layouts are unchanged
+  bool cache_tensor_iterator_geometry{false};
+  // to keep one memory plan per bucket of batch sizes, the size of dim 0 of
+  // the first Tensor input rounded up to a power of two, so that models with
+  // dynamic batch sizes don't plan their memory again whenever it changes
+  bool bucket_memory_plans{false};
+  // to run the independent nodes of each stage of the graph concurrently on
+  // the inter-op thread pool, see StaticModule::parallel_stages
+  bool enable_inter_op_parallelism{false};
+  // to compile chains of pointwise ops into TensorExpr kernels that write
+  // into the memory planned outputs, see
+  // Note [Static Runtime TensorExpr fusion]
+  bool enable_tensorexpr_fusion{false};
+  // to share the Tensor constants, e.g. frozen weights, that are equal to
+  // those of other StaticModules, see
+  // Note [Static Runtime constant deduplication]
+  bool deduplicate_constants{false};
+  // to keep reshape, flatten, permute and narrow zero-copy views of their
+  // inputs, whose lifetimes the MemoryPlanner extends over the uses of the
+  // views, instead of copying them into managed outputs, see
+  // Note [Static Runtime views]
+  bool keep_views{true};
+  // bound on the idle StaticRuntimes StaticModule::operator() keeps for
+  // concurrent callers, and how long an idle one is kept, see
+  // Note [StaticModule runtime pool]
+  size_t max_idle_runtimes{128};
+  std::chrono::milliseconds runtime_idle_timeout{60000};
 };
 
 /// The static runime supports two execution modes.
@@ -40,34 +75,35 @@ struct TORCH_API StaticModuleOptions {
 ///
 /// Mode 2: similar to data parallelism, run the same model for different inputs
 /// on different threads at the same time.
-/// You should have one StaticModule per model, and one StaticRuntime instance
-/// per running thread. To avoiding creating StaticRuntimes on the fly, use a
-/// synchronized stack (i.e. boost::lockfree::stack) to cache all the
-/// StaticRuntime instances in your code.
+/// You should have one StaticModule per model, and call it from all the
+/// threads. Concurrent calls run on different StaticRuntime instances, which
+/// the StaticModule caches, see Note [StaticModule runtime pool].
 /// @code
 ///   // initialization
+///   StaticModuleOptions opts;
+///   // the default of 128 is good for most cases
+///   opts.max_idle_runtimes = 64;
 ///   auto module = std::make_shared<StaticModule>(m, opts);
 ///
-///   // 128 is good for most cases. Pick a number that works for you
-///   boost::lockfree::stack<std::shared_ptr<StaticRuntime>,
-///     boost::lockfree::fixed_sized<true>> pool(128);
-///
-///   // inference
-///   std::shared_ptr<StaticRuntime> runtime = nullptr;
-///   pool.pop(runtime);
-///   if (!runtime) {
-///     // holds a reference to the underlying module
-///     // but does its own memory management
-///     runtime = std::make_shared<StaticRuntime>(*module);
-///   }
-///   auto output = runtime(args, kwargs);
-///   pool.push(runtime);
+///   // inference, on any thread
+///   auto output = (*module)(args, kwargs);
 /// @endcode
 ///
+/// A StaticRuntime can also be created and cached by hand, it holds a
+/// reference to the underlying module but does its own memory management.
+/// StaticModule::runtime() is the runtime calls use when there are no
+/// concurrent ones, it must not be used while other threads call the module.
+///
+
+// Indices of the first node that may write a value and of the last node that
+// may read it, or anything aliasing it, in the order of StaticModule::nodes(),
+// or the indices of their stages with enable_inter_op_parallelism
+using ValueLifetime = std::pair<size_t, size_t>;
 
 class MemoryPlanner;
 class ProcessedNode;
 class StaticRuntime;
+class StaticRuntimePool;
 class TORCH_API StaticModule {
  public:
   explicit StaticModule(
@@ -90,6 +126,9 @@ class TORCH_API StaticModule {
           c10::optional<c10::FunctionSchema>> graph_and_schema,
       const StaticModuleOptions& opts);
 
+  // builds the StaticModules of sub-blocks
+  friend class ProcessedBlocks;
+
   // for <kind, idx>
   //   if kind == CONSTANT_KIND: map to constants_[idx]
   //   if kind == INPUT_KIND: map to inputs_[idx]
@@ -97,6 +136,7 @@ class TORCH_API StaticModule {
   using DefInfo = std::pair<int, int>;
 
  public:
+  // Both operator()s may be called from several threads at the same time
   std::vector<at::Tensor> operator()(const std::vector<at::Tensor>& inps);
 
   // This interface only works if StaticModule was initialized
@@ -143,12 +183,31 @@ class TORCH_API StaticModule {
     return external_values_;
   }
 
+  // lifetimes of the values the MemoryPlanner may manage
+  inline const std::unordered_map<const Value*, ValueLifetime>&
+  value_lifetimes() const {
+    return value_lifetimes_;
+  }
+
+  // With enable_inter_op_parallelism, the indices of the nodes of each stage.
+  // The nodes of a stage only use values produced by earlier stages, and the
+  // stages run one after the other. Nodes with side effects or mutations get
+  // a stage of their own. Value lifetimes are in stages then, so that the
+  // MemoryPlanner doesn't let values in use by concurrent nodes share memory.
+  inline const std::vector<std::vector<size_t>>& parallel_stages() const {
+    return parallel_stages_;
+  }
+
   StaticRuntime& runtime();
 
+  const StaticRuntimePool& runtime_pool() const {
+    return *runtime_pool_;
+  }
+
  private:
   // Static runtime states
   StaticModuleOptions opts_;
-  std::unique_ptr<StaticRuntime> cached_runtime_;
+  std::unique_ptr<StaticRuntimePool> runtime_pool_;
   // IValue table (defined by prim::Constant nodes)
   std::vector<IValue> constants_;
   // a vector of ssa_defs corresponding to graph->outputs()
@@ -163,6 +222,8 @@ class TORCH_API StaticModule {
   // values whose live-time exceeds that of running one inference (e.g., input,
   // output, prim::Constants, and their aliases)
   std::unordered_set<const Value*> external_values_;
+  std::unordered_map<const Value*, ValueLifetime> value_lifetimes_;
+  std::vector<std::vector<size_t>> parallel_stages_;
 
   // Original input
   std::shared_ptr<torch::jit::Graph> graph_;
@@ -181,6 +242,13 @@ class TORCH_API StaticRuntime {
       const std::vector<c10::IValue>& args,
       const std::unordered_map<std::string, c10::IValue>& kwargs);
 
+  // Binds caller owned tensors as the inputs and outputs of run(), for
+  // serving loops that refill the same tensors, see
+  // Note [Bound inputs and outputs]
+  void bind_inputs(std::vector<at::Tensor> inputs);
+  void bind_outputs(std::vector<at::Tensor> outputs);
+  void run();
+
   void benchmark(
       const std::vector<c10::IValue>& args,
       const std::unordered_map<std::string, c10::IValue>& kwargs,
@@ -211,6 +279,50 @@ class TORCH_API StaticRuntime {
       const int warmup_runs,
       const int main_runs);
 
+  // Times are in ms per run, bytes are per run and count the allocations made
+  // through the default CPU allocator by the thread running the node
+  struct NodeProfile {
+    std::string kind;
+    // the node as printed in the graph
+    std::string node;
+    // "out_variant", "native" or "fallback", i.e. the JIT operator
+    std::string run_mode;
+    float mean_time{0.0};
+    float p50_time{0.0};
+    float p90_time{0.0};
+    float p99_time{0.0};
+    float max_time{0.0};
+    size_t allocated_bytes{0};
+    size_t num_allocations{0};
+  };
+
+  struct NodeKindProfile {
+    int instances{0};
+    float time{0.0};
+    float percent{0.0};
+    size_t allocated_bytes{0};
+    size_t num_allocations{0};
+  };
+
+  struct ProfileResults {
+    // in the order of nodes()
+    std::vector<NodeProfile> nodes;
+    std::unordered_map<std::string, NodeKindProfile> node_kinds;
+    // sum of the mean times of the nodes
+    float total_time{0.0};
+    size_t allocated_bytes{0};
+  };
+
+  // Like benchmark_individual_ops, but keeps the distribution of the times of
+  // each node and the memory it allocates. Installs its own memory reporter
+  // as the profiler state of the thread, so memory profiling of the autograd
+  // profiler doesn't see the main runs.
+  ProfileResults profile(
+      const std::vector<c10::IValue>& args,
+      const std::unordered_map<std::string, c10::IValue>& kwargs,
+      const int warmup_runs,
+      const int main_runs);
+
   // Input is readwrite
   IValue& Input(size_t i) {
     DCHECK(i < inputs_.size());
@@ -241,17 +353,94 @@ class TORCH_API StaticRuntime {
 
   void check_for_memory_leak(bool output_returned = true);
 
+  // nullptr before the end of the first run, or without cleanup_activations
+  const MemoryPlanner* memory_planner() const {
+    return planner_.get();
+  }
+
  private:
   // Memory planning is only enabled if sm->opts().cleanup_activations is true.
   // Otherwise, the memory used by activations is cached inside the static
   // runtime.
   std::unique_ptr<MemoryPlanner> planner_;
+  // the memory plan bucket of the current inputs, see
+  // StaticModuleOptions::bucket_memory_plans
+  size_t memory_plan_bucket() const;
+  // runs nodes_ in order, or stage by stage with enable_inter_op_parallelism
+  void run_nodes();
+  // runs the nodes on inputs_ between allocating and freeing the managed
+  // memory, leaving the outputs in outputs_
+  void run_graph();
+  // benchmark_individual_ops, also filling profile if not null
+  IndividualMetrics run_individual_ops(
+      const std::vector<c10::IValue>& args,
+      const std::unordered_map<std::string, c10::IValue>& kwargs,
+      const int warmup_runs,
+      const int main_runs,
+      ProfileResults* profile);
   std::vector<IValue> inputs_;
   std::vector<IValue*> outputs_;
+  std::vector<at::Tensor> bound_inputs_;
+  std::vector<at::Tensor> bound_outputs_;
+  // whether the node producing each output writes into its bound tensor
+  std::vector<bool> bound_outputs_in_place_;
   const StaticModule& static_module_;
   std::vector<ProcessedNode> nodes_;
 };
 
+// The StaticRuntimes of a StaticModule, handed out to concurrent callers of
+// StaticModule::operator(). See Note [StaticModule runtime pool]
+class TORCH_API StaticRuntimePool {
+ public:
+  StaticRuntimePool(size_t max_idle, std::chrono::milliseconds idle_timeout);
+
+  // Runs fn on a runtime of sm that no other caller uses meanwhile
+  template <typename F>
+  auto run(const StaticModule& sm, F&& fn) {
+    Lease lease = acquire(sm);
+    try {
+      auto result = fn(*lease.runtime);
+      release(lease, false);
+      return result;
+    } catch (...) {
+      release(lease, true);
+      throw;
+    }
+  }
+
+  // The runtime of single-threaded use, which calls take whenever it is free
+  StaticRuntime& primary(const StaticModule& sm);
+
+  size_t num_idle() const;
+  // runtimes created besides the primary one, including the evicted ones
+  size_t num_created() const;
+
+ private:
+  struct Lease {
+    StaticRuntime* runtime;
+    bool primary;
+  };
+  struct IdleRuntime {
+    std::unique_ptr<StaticRuntime> runtime;
+    std::chrono::steady_clock::time_point since;
+  };
+
+  Lease acquire(const StaticModule& sm);
+  // puts the runtime back, or drops it if its run failed
+  void release(const Lease& lease, bool failed);
+  void evict_idle(std::chrono::steady_clock::time_point now);
+
+  const size_t max_idle_;
+  const std::chrono::milliseconds idle_timeout_;
+  std::unique_ptr<StaticRuntime> primary_;
+  std::atomic<bool> primary_in_use_{false};
+
+  mutable std::mutex mutex_;
+  // least recently used first
+  std::deque<IdleRuntime> idle_; // guarded by mutex_
+  size_t num_created_{0}; // guarded by mutex_
+};
+
 /// There are three types of ops in a processed graph in Static Runtime:
 ///   1. op with _out variant
 ///   2. view producing op
@@ -266,13 +455,22 @@ class TORCH_API StaticRuntime {
 /// tracking the unique StorageImpls of the output tensors of ops with _out
 /// variants. It tries to do this in several steps:
 ///   1. record the max memory usage for each StorageImpl at the end of each
-///      iteration
-///   2. in the next iteration, allocate the buffer for the max total usage and
-///      compute the offset of each allocation with regard to the single memory
-///      buffer, optionally reusing memory.  In the first iteration, we rely on
-///      the default allocator for memory allocation.
-///   3. free the buffer at the end of each iteration
-/// Steps 1 and 3 are handled by `deallocate()`, and step 2 by `allocate()`.
+///      iteration, and when it changed, plan the offset of each StorageImpl
+///      in a single arena so that StorageImpls with overlapping lifetimes
+///      don't overlap in memory (see AssignArenaOffsets)
+///   2. in the next iteration, point the StorageImpls into the arena, which
+///      is only reallocated when the planned arena outgrows it. In the first
+///      iteration, we rely on the default allocator for memory allocation.
+/// Step 1 is handled by `deallocate()`, and step 2 by `allocate()`.
+/// With optimize_output_memory, the outputs of the graph produced by ops with
+/// _out variants are preallocated by `allocate()` from one buffer per run,
+/// sized after the previous run. The buffer lives until the client released
+/// all of these outputs.
+/// With bucket_memory_plans, the recorded sizes and the planned offsets are
+/// kept per bucket of batch sizes. `allocate(bucket)` switches to the plan of
+/// the bucket, and within a bucket, sizes only grow, so the offsets of a
+/// bucket are planned again only until it saw its largest batch. The arena is
+/// shared by all buckets.
 /// Only models with simple output types are supported, i.e. None, Tensor or
 /// List/Tuple of Tensors. Complex output types such as List of Lists are not
 /// supported.
@@ -283,9 +481,15 @@ class MemoryPlanner {
       StaticRuntime* runtime,
       const std::unordered_map<const Value*, std::vector<const Value*>>&,
       const std::unordered_set<const Value*>& external_values,
-      bool out_variants);
-
-  void allocate();
+      const std::unordered_map<const Value*, ValueLifetime>& value_lifetimes,
+      bool out_variants,
+      bool optimize_output_memory = false,
+      bool bucket_memory_plans = false);
+
+  // makes the plan of the bucket the active one, which allocate() uses and
+  // deallocate() updates
+  void select_plan(size_t bucket);
+  void allocate(size_t bucket = 0);
   void deallocate();
   size_t total_managed() const {
     return managed_bytes_;
@@ -293,6 +497,13 @@ class MemoryPlanner {
   size_t total_reused_tensors() const {
     return reused_tensors_;
   }
+  // size of the arena planned for the managed tensors
+  size_t arena_size() const {
+    return arena_bytes_;
+  }
+  size_t total_managed_outputs() const {
+    return managed_output_bytes_;
+  }
 
  private:
   // ivalues created in one run but not managed by MemoryPlanner
@@ -303,29 +514,96 @@ class MemoryPlanner {
   // Thus, if memonger is disabled, all vectors are of size 1.
   std::vector<std::pair<size_t, std::vector<c10::StorageImpl*>>>
       managed_tensor_storage_;
+  // lifetime of each entry of managed_tensor_storage_, the hull of the
+  // lifetimes of its values
+  std::vector<ValueLifetime> managed_tensor_lifetimes_;
+  // offset of each entry of managed_tensor_storage_ in buffer_
+  std::vector<size_t> managed_tensor_offsets_;
   size_t managed_bytes_{0};
   size_t reused_tensors_{0};
-  at::DataPtr buffer_; // allocated each time we call Run()
+  size_t arena_bytes_{0};
+  at::DataPtr buffer_; // kept across runs, grown when arena_bytes_ outgrows it
+  size_t buffer_bytes_{0};
 
   // since output tensors are alive after one inference, their storage
   // is managed differently (e.g., deallocation happens at client side)
-  // std::vector<std::pair<sizse_t, std::vector<c10::StorageImpl*>>>
-  //     managed_output_storage_;
-  // size_t managed_output_bytes_{0};
-  // size_t reused_output_tensors_{0};
-  // at::DataPtr output_buffer_; // allocated each time we call Run()
+  struct ManagedOutput {
+    IValue* ivalue;
+    // aligned size and dtype of the output tensor of the previous run
+    size_t nbytes;
+    caffe2::TypeMeta dtype;
+  };
+  std::vector<ManagedOutput> managed_outputs_;
+  size_t managed_output_bytes_{0};
+
+  // the sizes recorded and the offsets planned for one bucket, stashed while
+  // another bucket is active
+  struct Plan {
+    std::vector<size_t> storage_sizes;
+    std::vector<size_t> offsets;
+    size_t managed_bytes{0};
+    size_t arena_bytes{0};
+    std::vector<std::pair<size_t, caffe2::TypeMeta>> outputs;
+    size_t output_bytes{0};
+  };
+  bool bucket_memory_plans_;
+  size_t bucket_{0};
+  std::vector<Plan> plans_; // indexed by bucket
 
   static size_t compute_aligned_tensor_size(size_t nbytes);
   static at::DataPtr allocate_buffer(size_t size);
 };
 
+// Assigns offsets in an arena to buffers of the given sizes and lifetimes,
+// such that buffers whose lifetimes overlap don't overlap in the arena, and
+// returns the size of the arena. Buffers are placed from the largest to the
+// smallest, each in the smallest gap that fits it between the buffers placed
+// so far that are alive at the same time, or above all of them.
+TORCH_API size_t AssignArenaOffsets(
+    const std::vector<size_t>& sizes,
+    const std::vector<ValueLifetime>& lifetimes,
+    std::vector<size_t>& offsets);
+
+// The blocks of a prim::If or prim::Loop node, each run by a StaticRuntime of
+// its own, with its own memory plan. See Note [Static Runtime control flow]
+class TORCH_API ProcessedBlocks {
+ public:
+  ProcessedBlocks(Node* node, const StaticModuleOptions& opts);
+
+  // Copies share the StaticModules of the blocks and create StaticRuntimes of
+  // their own when they first run
+  ProcessedBlocks(const ProcessedBlocks& other);
+  ProcessedBlocks& operator=(const ProcessedBlocks& other);
+
+  // Values used in the blocks and defined outside of the node, which the
+  // ProcessedNode takes as extra inputs after the inputs of the node
+  const std::vector<Value*>& free_variables() const {
+    return free_variables_;
+  }
+
+  const std::vector<std::shared_ptr<StaticModule>>& modules() const {
+    return modules_;
+  }
+
+  void run(ProcessedNode* p_node);
+
+ private:
+  std::vector<IValue> run_block(size_t i, std::vector<IValue>&& args);
+
+  Node* node_;
+  std::vector<Value*> free_variables_;
+  std::vector<std::shared_ptr<StaticModule>> modules_;
+  std::vector<std::unique_ptr<StaticRuntime>> runtimes_;
+};
+
 class ProcessedNode {
  public:
   ProcessedNode() = default;
   ProcessedNode(
       Node* n,
       std::vector<const IValue*>&& inputs,
-      bool enable_out_variant);
+      bool enable_out_variant,
+      bool cache_tensor_iterator_geometry = false);
 
   void run();
 
@@ -361,6 +639,15 @@ class ProcessedNode {
     return static_cast<bool>(fn_);
   }
 
+  // the blocks of prim::If and prim::Loop nodes
+  const c10::optional<ProcessedBlocks>& blocks() const {
+    return blocks_;
+  }
+
+  void set_blocks(ProcessedBlocks blocks) {
+    blocks_ = std::move(blocks);
+  }
+
  private:
   Node* node_;
   c10::optional<Operation> op_;
@@ -368,6 +655,9 @@ class ProcessedNode {
   std::function<void(ProcessedNode*)> native_fn_;
   std::vector<const IValue*> inputs_; // unowned
   std::vector<IValue> outputs_;
+  c10::optional<ProcessedBlocks> blocks_;
+  bool cache_tensor_iterator_geometry_{false};
+  at::TensorIteratorGeometryCache tensor_iterator_geometry_cache_;
 };
 
 } // namespace jit
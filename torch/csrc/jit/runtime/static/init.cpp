@@ -37,6 +37,33 @@ void initStaticModuleBindings(PyObject* module) {
       .def_readonly(
           "instances_per_node_type",
           &StaticRuntime::IndividualMetrics::instances_per_node_type);
+  py::class_<StaticRuntime::NodeProfile>(static_module, "NodeProfile")
+      .def_readonly("kind", &StaticRuntime::NodeProfile::kind)
+      .def_readonly("node", &StaticRuntime::NodeProfile::node)
+      .def_readonly("run_mode", &StaticRuntime::NodeProfile::run_mode)
+      .def_readonly("mean_time", &StaticRuntime::NodeProfile::mean_time)
+      .def_readonly("p50_time", &StaticRuntime::NodeProfile::p50_time)
+      .def_readonly("p90_time", &StaticRuntime::NodeProfile::p90_time)
+      .def_readonly("p99_time", &StaticRuntime::NodeProfile::p99_time)
+      .def_readonly("max_time", &StaticRuntime::NodeProfile::max_time)
+      .def_readonly(
+          "allocated_bytes", &StaticRuntime::NodeProfile::allocated_bytes)
+      .def_readonly(
+          "num_allocations", &StaticRuntime::NodeProfile::num_allocations);
+  py::class_<StaticRuntime::NodeKindProfile>(static_module, "NodeKindProfile")
+      .def_readonly("instances", &StaticRuntime::NodeKindProfile::instances)
+      .def_readonly("time", &StaticRuntime::NodeKindProfile::time)
+      .def_readonly("percent", &StaticRuntime::NodeKindProfile::percent)
+      .def_readonly(
+          "allocated_bytes", &StaticRuntime::NodeKindProfile::allocated_bytes)
+      .def_readonly(
+          "num_allocations", &StaticRuntime::NodeKindProfile::num_allocations);
+  py::class_<StaticRuntime::ProfileResults>(static_module, "ProfileResults")
+      .def_readonly("nodes", &StaticRuntime::ProfileResults::nodes)
+      .def_readonly("node_kinds", &StaticRuntime::ProfileResults::node_kinds)
+      .def_readonly("total_time", &StaticRuntime::ProfileResults::total_time)
+      .def_readonly(
+          "allocated_bytes", &StaticRuntime::ProfileResults::allocated_bytes);
   static_module
       .def(
           "__call__",
@@ -78,6 +105,19 @@ void initStaticModuleBindings(PyObject* module) {
                 kwargs.begin(), kwargs.end()};
             return self.runtime().benchmark_individual_ops(
                 arg_ivalues, kwarg_ivalues, warmup_runs, main_runs);
+          })
+      .def(
+          "profile",
+          [](StaticModule& self,
+             const std::vector<at::Tensor>& args,
+             const std::unordered_map<std::string, at::Tensor>& kwargs,
+             const int warmup_runs,
+             const int main_runs) {
+            std::vector<c10::IValue> arg_ivalues{args.begin(), args.end()};
+            std::unordered_map<std::string, c10::IValue> kwarg_ivalues{
+                kwargs.begin(), kwargs.end()};
+            return self.runtime().profile(
+                arg_ivalues, kwarg_ivalues, warmup_runs, main_runs);
           });
   m.def(
        "_jit_to_static_module",
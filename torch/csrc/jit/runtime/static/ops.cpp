@@ -11,12 +11,15 @@
 #include <ATen/native/quantized/cpu/qembeddingbag.h>
 #include <c10/util/irange.h>
 #include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/runtime/operator.h>
 #include <torch/csrc/jit/runtime/vararg_functions.h>
 #include <torch/csrc/jit/tensorexpr/ir.h>
 #include <torch/csrc/jit/tensorexpr/ir_simplifier.h>
 #include <torch/csrc/jit/tensorexpr/llvm_codegen.h>
 #include <torch/csrc/jit/tensorexpr/loopnest.h>
 
+#include <mutex>
+
 namespace at {
 namespace native {
 // copy version of view ops
@@ -112,9 +115,112 @@ bool opIsRegistered(const c10::Symbol& op_name) {
   return SROperatorRegistry()->Has(name);
 }
 
+// Note [Generic out variants]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Ops without a hand-written out variant in SROperatorRegistry get one
+// derived from their out= overload, which every op declared with an `out`
+// overload in native_functions.yaml has. A functional aten op qualifies if
+// - it returns a single Tensor and none of its arguments or returns are
+//   annotated with alias info, i.e. it neither mutates nor returns a view,
+// - an overload of the same op takes the same arguments followed by a single
+//   kwarg-only Tensor(a!) out argument, and returns it.
+// The first run calls the functional op, so the output gets the dtype, layout
+// and device the op picks, and later runs call the out= overload on the
+// output resized to zero. Like the hand-written out variants, this relies on
+// the dtypes of the inputs not changing between runs. The overload is called
+// through the boxed calling convention, which is slower than calling the
+// kernel directly, so hot ops still deserve an entry in the registry.
+namespace {
+
+std::shared_ptr<Operator> findOutOverload(const FunctionSchema& schema) {
+  if (schema.returns().size() != 1 ||
+      schema.returns()[0].type()->kind() != TypeKind::TensorType ||
+      schema.returns()[0].alias_info() || schema.is_vararg()) {
+    return nullptr;
+  }
+  const auto& args = schema.arguments();
+  for (const auto& arg : args) {
+    if (arg.alias_info()) {
+      return nullptr;
+    }
+  }
+
+  for (const auto& op : getAllOperatorsFor(Symbol::fromQualString(
+           schema.name()))) {
+    const auto& out_schema = op->schema();
+    const auto& out_args = out_schema.arguments();
+    if (out_args.size() != args.size() + 1 ||
+        out_schema.returns().size() != 1) {
+      continue;
+    }
+    const auto& out_arg = out_args.back();
+    if (!out_arg.kwarg_only() ||
+        out_arg.type()->kind() != TypeKind::TensorType ||
+        !out_arg.alias_info() || !out_arg.alias_info()->isWrite()) {
+      continue;
+    }
+    bool same_args = true;
+    for (size_t i = 0; i < args.size() && same_args; ++i) {
+      same_args = args[i].name() == out_args[i].name() &&
+          *args[i].type() == *out_args[i].type() &&
+          !out_args[i].alias_info();
+    }
+    if (same_args) {
+      return op;
+    }
+  }
+  return nullptr;
+}
+
+// The out= overload for the schema of n, if n qualifies for a generic out
+// variant. Looked up once per schema.
+std::shared_ptr<Operator> getOutOverload(Node* n) {
+  if (!n->kind().is_aten() || n->outputs().size() != 1) {
+    return nullptr;
+  }
+  const FunctionSchema* schema = n->maybeSchema();
+  if (!schema) {
+    return nullptr;
+  }
+  static std::mutex mutex;
+  static std::unordered_map<const FunctionSchema*, std::shared_ptr<Operator>>
+      cache;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = cache.find(schema);
+  if (it == cache.end()) {
+    it = cache.emplace(schema, findOutOverload(*schema)).first;
+  }
+  return it->second;
+}
+
+SROperator getGenericOutOperation(Node* n) {
+  Operation functional_op = n->getOperation();
+  Operation out_op = getOutOverload(n)->getOperation();
+  return [functional_op, out_op](ProcessedNode* p_node) {
+    Stack stack;
+    const size_t num_inputs = p_node->inputs().size();
+    stack.reserve(num_inputs + 1);
+    for (size_t i = 0; i < num_inputs; ++i) {
+      stack.emplace_back(p_node->Input(i));
+    }
+    if (p_node->Output(0).isNone()) {
+      functional_op(&stack);
+      DCHECK_EQ(stack.size(), 1);
+      p_node->Output(0) = std::move(stack[0]);
+      return;
+    }
+    auto& out_t = p_node->Output(0).toTensor();
+    fastResizeToZero(out_t);
+    stack.emplace_back(out_t);
+    out_op(&stack);
+  };
+}
+
+} // namespace
+
 bool canRunOutOfPlace(Node* n) {
   auto op_name = std::string(n->kind().toQualString());
-  return SROperatorRegistry()->Has(op_name);
+  return SROperatorRegistry()->Has(op_name) || getOutOverload(n) != nullptr;
 }
 
 // Keep function canReuseInputsOutputs because the name canReuseInputsOutputs is
@@ -852,10 +958,26 @@ std::function<void(ProcessedNode*)> getOutOfPlaceOperation(Node* n) {
   if (SROperatorRegistry()->Has(op_name)) {
     return SROperatorRegistry()->Create(op_name)->Generate(n);
   }
+  // See Note [Generic out variants]
+  if (getOutOverload(n)) {
+    return getGenericOutOperation(n);
+  }
 
   return [](ProcessedNode*) { TORCH_CHECK(0); };
 }
 
+std::vector<Node*> nodesWithoutOutVariant(const std::shared_ptr<Graph>& graph) {
+  std::vector<Node*> nodes;
+  for (Node* n : graph->nodes()) {
+    if (n->kind() == prim::Constant || canRunOutOfPlace(n) ||
+        canRunNatively(n)) {
+      continue;
+    }
+    nodes.push_back(n);
+  }
+  return nodes;
+}
+
 std::function<void(ProcessedNode*)> getNativeOperation(Node* n) {
   if (n->kind() == c10::Symbol::fromQualString("aten::transpose")) {
     return [](ProcessedNode* p_node) {
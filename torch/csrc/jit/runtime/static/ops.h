@@ -94,5 +94,11 @@ std::function<void(ProcessedNode*)> getOutOfPlaceOperation(Node* n);
 bool canRunNatively(Node* n);
 std::function<void(ProcessedNode*)> getNativeOperation(Node* n);
 
+// The nodes of the graph that have neither an out variant, hand-written or
+// generic (see Note [Generic out variants]), nor a native implementation.
+// They run their JIT operator, which allocates their outputs on every run.
+TORCH_API std::vector<Node*> nodesWithoutOutVariant(
+    const std::shared_ptr<Graph>& graph);
+
 } // namespace jit
 } // namespace torch
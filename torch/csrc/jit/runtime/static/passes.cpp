@@ -371,7 +371,22 @@ bool HasInplaceOp(std::shared_ptr<Graph>& graph, const AliasDb& alias_db) {
   return HasInplaceOp(graph->block(), alias_db);
 }
 
-void ReplaceWithCopy(std::shared_ptr<torch::jit::Graph>& graph) {
+// Note [Static Runtime views]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// A view node doesn't run an out variant, so its output isn't managed by the
+// MemoryPlanner, but it keeps the storage of its input alive. The lifetimes
+// the MemoryPlanner uses are alias aware (see GetValueLifetimes and
+// GetLivenessInformation in impl.cpp): the uses of a view extend the lifetime
+// of the managed value it is a view of, so views never need to be copies for
+// the memory plan to be safe. Copies trade a memcpy for a managed output and
+// a shorter lifetime of the input, which is only worth it for views that
+// aren't free anyway, like aten::to. The cases where copying would change
+// results, views of values that in-place ops mutate and views that alias the
+// graph outputs, are left alone either way.
+
+void ReplaceWithCopy(
+    std::shared_ptr<torch::jit::Graph>& graph,
+    bool keep_views) {
   auto* fake_input =
       graph->insert(Symbol::fromQualString("static_runtime::pure_inputs"), {});
   fake_input->node()->moveBefore(*graph->nodes().begin());
@@ -404,6 +419,12 @@ void ReplaceWithCopy(std::shared_ptr<torch::jit::Graph>& graph) {
       {c10::Symbol::fromQualString("aten::to"),
        c10::Symbol::fromQualString("static_runtime::to_copy")}};
 
+  const std::set<c10::Symbol> views = {
+      c10::Symbol::fromQualString("aten::permute"),
+      c10::Symbol::fromQualString("aten::narrow"),
+      c10::Symbol::fromQualString("aten::reshape"),
+      c10::Symbol::fromQualString("aten::flatten")};
+
   bool has_inplace_ops = HasInplaceOp(graph, db);
   std::vector<std::pair<Node*, Node*>> replacement;
   for (auto* n : graph->nodes()) {
@@ -411,6 +432,9 @@ void ReplaceWithCopy(std::shared_ptr<torch::jit::Graph>& graph) {
         !opIsRegistered(supported.at(n->kind()))) {
       continue;
     }
+    if (keep_views && views.count(n->kind())) {
+      continue;
+    }
     DCHECK(n->outputs().size() == 1);
 
     // In cases of having in-place ops in the graph, only replace the op with
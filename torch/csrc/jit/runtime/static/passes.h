@@ -8,7 +8,13 @@ TORCH_API void FuseInferenceOpsForSparseNN(
 TORCH_API void FuseSigridTransformsListUnpack(
     std::shared_ptr<torch::jit::Graph>& graph);
 
-TORCH_API void ReplaceWithCopy(std::shared_ptr<torch::jit::Graph>& graph);
+// Replaces view ops whose outputs the MemoryPlanner could manage with copy
+// versions that have out variants. With keep_views, only aten::to, which
+// usually isn't a view, is replaced, and reshape, flatten, permute and narrow
+// stay zero-copy views. See Note [Static Runtime views]
+TORCH_API void ReplaceWithCopy(
+    std::shared_ptr<torch::jit::Graph>& graph,
+    bool keep_views = false);
 
 TORCH_API bool HasInplaceOp(
     std::shared_ptr<Graph>& graph,
@@ -87,6 +87,12 @@ TORCH_API void ExportModule(
     bool bytecode_format = false,
     bool save_mobile_debug_info = false);
 
+// Deflate level, 1 (fastest) to 9 (smallest), of the tensor records written
+// by ExportModule, or 0 (the default) to store them uncompressed. Tensors are
+// compressed on the intra-op thread pool. Compressed records are always read
+// into memory when loaded, never aliased, see PyTorchStreamReader::getRecord.
+TORCH_API int& getTensorRecordCompressionLevel();
+
 // Write the bytes of a pickle archive and the tensors referenced inside that
 // archive
 TORCH_API void writeArchiveAndTensors(
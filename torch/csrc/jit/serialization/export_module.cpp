@@ -20,9 +20,11 @@
 #include <caffe2/serialize/inline_container.h>
 
 #include <ATen/ATen.h>
+#include <ATen/Parallel.h>
 
 #include <ATen/core/jit_type.h>
 #include <ATen/core/qualified_name.h>
+#include <algorithm>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -372,6 +374,11 @@ void SetExportModuleMobileInfoConverter(
   GetMobileInfoConverter() = std::move(converter);
 }
 
+int& getTensorRecordCompressionLevel() {
+  static int level = 0;
+  return level;
+}
+
 class ScriptModuleSerializer {
  public:
   explicit ScriptModuleSerializer(const std::string& filename)
@@ -425,13 +432,7 @@ class ScriptModuleSerializer {
     data_pickle.protocol();
     data_pickle.pushIValue(value);
     data_pickle.stop();
-    size_t i = 0;
-    std::string prefix = archive_name + "/";
-    for (const auto& td : data_pickle.tensorData()) {
-      WriteableTensorData writable_td = getWriteableTensorData(td);
-      std::string fname = prefix + c10::to_string(i++);
-      writer_.writeRecord(fname, writable_td.data(), writable_td.sizeInBytes());
-    }
+    writeTensors(archive_name + "/", data_pickle.tensorData());
     std::string fname = archive_name + ".pkl";
     writer_.writeRecord(fname, data.data(), data.size());
 
@@ -441,6 +442,47 @@ class ScriptModuleSerializer {
     }
   }
 
+  void writeTensors(
+      const std::string& prefix,
+      const std::vector<at::Tensor>& tensors) {
+    const int level = getTensorRecordCompressionLevel();
+    if (level == 0) {
+      for (size_t i = 0; i < tensors.size(); i++) {
+        WriteableTensorData writable_td = getWriteableTensorData(tensors[i]);
+        std::string fname = prefix + c10::to_string(i);
+        writer_.writeRecord(
+            fname, writable_td.data(), writable_td.sizeInBytes());
+      }
+      return;
+    }
+    // Tensors are compressed a batch at a time on the intra-op thread pool and
+    // written in order, so that only one batch of them is held in host memory
+    // in addition to the module.
+    const size_t batch_size = std::max(at::get_num_threads(), 1);
+    std::vector<WriteableTensorData> batch;
+    std::vector<caffe2::serialize::CompressedRecord> compressed;
+    for (size_t begin = 0; begin < tensors.size(); begin += batch_size) {
+      const size_t end = std::min(begin + batch_size, tensors.size());
+      batch.clear();
+      for (size_t i = begin; i < end; i++) {
+        batch.push_back(getWriteableTensorData(tensors[i]));
+      }
+      compressed.clear();
+      compressed.resize(batch.size());
+      at::parallel_for(
+          0, batch.size(), 1, [&](int64_t batch_begin, int64_t batch_end) {
+            for (int64_t j = batch_begin; j < batch_end; j++) {
+              compressed[j] = caffe2::serialize::compressRecord(
+                  batch[j].data(), batch[j].sizeInBytes(), level);
+            }
+          });
+      for (size_t i = begin; i < end; i++) {
+        writer_.writeCompressedRecord(
+            prefix + c10::to_string(i), compressed[i - begin]);
+      }
+    }
+  }
+
   void writeExtraFiles(const Module& module, const ExtraFilesMap& extra_files) {
     // Write out extra files.
     for (const auto& kv : extra_files) {
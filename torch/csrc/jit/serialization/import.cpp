@@ -12,14 +12,17 @@
 #include <torch/csrc/jit/passes/subgraph_rewrite.h>
 #include <torch/csrc/jit/serialization/import_source.h>
 #include <torch/csrc/jit/serialization/pickle.h>
+#include <torch/csrc/jit/serialization/record_prefetcher.h>
 #include <torch/csrc/jit/serialization/source_range_serialization.h>
 #include <torch/csrc/jit/serialization/unpickler.h>
 
 #include <caffe2/serialize/file_adapter.h>
 #include <caffe2/serialize/inline_container.h>
 #include <caffe2/serialize/istream_adapter.h>
+#include <caffe2/serialize/mmap_adapter.h>
 
 #include <ATen/ATen.h>
+#include <ATen/detail/CUDAHooksInterface.h>
 #include <fmt/format.h>
 
 #include <fstream>
@@ -32,6 +35,7 @@ namespace jit {
 
 using caffe2::serialize::FileAdapter;
 using caffe2::serialize::IStreamAdapter;
+using caffe2::serialize::MmapAdapter;
 using caffe2::serialize::PyTorchStreamReader;
 using caffe2::serialize::ReadAdapterInterface;
 
@@ -83,10 +87,16 @@ IValue readArchiveAndTensors(
     return len;
   };
 
-  std::string archive_name_plus_slash = archive_name + "/";
+  // Tensors loaded to a CUDA device are read into pinned memory and copied
+  // to the device asynchronously, the prefetcher bounds the number of them
+  // held in host memory at once
+  c10::Allocator* allocator = nullptr;
+  if (device && device->is_cuda() && at::globalContext().hasCUDA()) {
+    allocator = at::detail::getCUDAHooks().getPinnedMemoryAllocator();
+  }
+  RecordPrefetcher prefetcher(stream_reader, archive_name + "/", allocator);
   auto read_record = [&](const std::string& name) {
-    std::string ss = archive_name_plus_slash + name;
-    return std::get<0>(stream_reader.getRecord(ss));
+    return prefetcher.getRecord(name);
   };
 
   Unpickler unpickler(
@@ -355,6 +365,20 @@ Module load(
   return module;
 }
 
+Module load_lazily(const std::string& filename) {
+  ExtraFilesMap extra_files;
+  return load_lazily(filename, extra_files);
+}
+
+Module load_lazily(const std::string& filename, ExtraFilesMap& extra_files) {
+  // PyTorchStreamReader aliases the records of the mapping instead of reading
+  // them, which leaves the pages of a tensor unread until it is accessed.
+  // Loading to any other device than the CPU would copy every tensor.
+  auto rai = std::make_shared<MmapAdapter>(
+      filename, MmapAdapter::Mode::CopyOnWrite);
+  return load(std::move(rai), at::Device(at::kCPU), extra_files);
+}
+
 Module load(
     std::shared_ptr<ReadAdapterInterface> rai,
     c10::optional<c10::Device> device) {
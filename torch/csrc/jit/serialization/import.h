@@ -75,6 +75,20 @@ TORCH_API Module load(
     c10::optional<c10::Device> device,
     ExtraFilesMap& extra_files);
 
+/// Loads a serialized `Module` from the given `filename` to the CPU without
+/// reading the data of its tensors.
+///
+/// The file is mapped into memory copy-on-write and the tensors of the module
+/// alias the mapping, so the data of a tensor is only read from the file when
+/// it is first accessed, and tensors that are never accessed, e.g. cold shards
+/// of an embedding table, take no memory. Writing to a tensor copies the pages
+/// written to and leaves the file unchanged. The file must not be modified
+/// while the module, or any tensor loaded from it, is alive.
+TORCH_API Module load_lazily(const std::string& filename);
+
+TORCH_API Module
+load_lazily(const std::string& filename, ExtraFilesMap& extra_files);
+
 /// Loads a serialized `Module` from the given shared_ptr `rai`.
 ///
 /// The reader adapter, which is for customized input stream, must contain a
@@ -22,7 +22,12 @@ void pickle(
 std::vector<char> pickle(
     const IValue& ivalue,
     std::vector<at::Tensor>* tensor_table) {
+  // The values a thread pickles, e.g. the RPC messages it sends, tend to be
+  // of similar sizes, so reserve as much as the previous one took rather than
+  // growing the buffer, and copying what was already written, a few times.
+  thread_local size_t sizeHint = 0;
   std::vector<char> data;
+  data.reserve(sizeHint);
 
   pickle(
       [&](const char* bytes, size_t len) {
@@ -31,6 +36,7 @@ std::vector<char> pickle(
       ivalue,
       tensor_table);
 
+  sizeHint = data.size();
   return data;
 }
 
@@ -0,0 +1,94 @@
+#include <torch/csrc/jit/serialization/record_prefetcher.h>
+
+#include <caffe2/serialize/inline_container.h>
+
+#include <algorithm>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+int num_record_read_threads = 4;
+
+// records read ahead of the last one asked for, per thread
+constexpr size_t kRecordsAheadPerThread = 2;
+
+} // namespace
+
+int& getNumRecordReadThreads() {
+  return num_record_read_threads;
+}
+
+RecordPrefetcher::RecordPrefetcher(
+    caffe2::serialize::PyTorchStreamReader& reader,
+    const std::string& dir,
+    c10::Allocator* allocator)
+    : reader_(reader), dir_(dir), allocator_(allocator) {
+  const int num_threads = getNumRecordReadThreads();
+  for (const auto& record : reader_.getAllRecords()) {
+    if (record.size() > dir_.size() &&
+        record.compare(0, dir_.size(), dir_) == 0) {
+      std::string name = record.substr(dir_.size());
+      index_.emplace(name, entries_.size());
+      entries_.emplace_back();
+      entries_.back().name = std::move(name);
+    }
+  }
+  window_ = kRecordsAheadPerThread * std::max(num_threads, 1);
+  if (num_threads > 0 && entries_.size() > 1) {
+    pool_ = std::make_unique<c10::ThreadPool>(num_threads);
+    prefetchUpTo(0);
+  }
+}
+
+RecordPrefetcher::~RecordPrefetcher() {
+  // the reads in flight refer to reader_
+  for (size_t i = 0; i < num_started_; i++) {
+    if (!entries_[i].taken) {
+      entries_[i].data.wait();
+    }
+  }
+}
+
+void RecordPrefetcher::prefetchUpTo(size_t index) {
+  const size_t end = std::min(index + window_ + 1, entries_.size());
+  for (; num_started_ < end; num_started_++) {
+    auto promise = std::make_shared<std::promise<at::DataPtr>>();
+    entries_[num_started_].data = promise->get_future();
+    std::string name = entries_[num_started_].name;
+    pool_->run([this, promise, name]() {
+      try {
+        promise->set_value(readRecord(name));
+      } catch (...) {
+        promise->set_exception(std::current_exception());
+      }
+    });
+  }
+}
+
+at::DataPtr RecordPrefetcher::readRecord(const std::string& name) {
+  if (allocator_) {
+    return std::get<0>(reader_.getRecord(dir_ + name, allocator_));
+  }
+  return std::get<0>(reader_.getRecord(dir_ + name));
+}
+
+at::DataPtr RecordPrefetcher::getRecord(const std::string& name) {
+  auto it = index_.find(name);
+  if (!pool_ || it == index_.end()) {
+    return readRecord(name);
+  }
+  const size_t index = it->second;
+  prefetchUpTo(index);
+  Entry& entry = entries_[index];
+  if (entry.taken) {
+    // a record referred to more than once is only prefetched the first time
+    return readRecord(name);
+  }
+  entry.taken = true;
+  return entry.data.get();
+}
+
+} // namespace jit
+} // namespace torch
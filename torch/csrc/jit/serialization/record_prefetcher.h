@@ -0,0 +1,73 @@
+#pragma once
+
+#include <c10/core/Allocator.h>
+#include <c10/core/thread_pool.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace caffe2 {
+namespace serialize {
+class PyTorchStreamReader;
+} // namespace serialize
+} // namespace caffe2
+
+namespace torch {
+namespace jit {
+
+// Reads the tensor records of an archive on a pool of threads while the
+// unpickler works through the pickle referring to them.
+//
+// Records are read in the order they are stored in, which is the order the
+// pickle refers to them in for archives written by torch::jit::ExportModule,
+// up to a fixed number of records ahead of the last one asked for, so that
+// only a few records are held in memory at once. While the calling thread
+// unpickles a tensor, or copies it to the device it is loaded to, the pool
+// reads the next records, in parallel if the reader of the archive supports
+// concurrent reads.
+class TORCH_API RecordPrefetcher {
+ public:
+  // Prefetches the records in directory dir of the archive read by reader,
+  // which must outlive the prefetcher. If allocator is given, records are read
+  // into memory allocated by it, see PyTorchStreamReader::getRecord.
+  RecordPrefetcher(
+      caffe2::serialize::PyTorchStreamReader& reader,
+      const std::string& dir,
+      c10::Allocator* allocator = nullptr);
+  // Waits for the reads in flight
+  ~RecordPrefetcher();
+
+  // The record name in dir
+  at::DataPtr getRecord(const std::string& name);
+
+ private:
+  void prefetchUpTo(size_t index);
+  at::DataPtr readRecord(const std::string& name);
+
+  struct Entry {
+    std::string name;
+    std::future<at::DataPtr> data;
+    bool taken = false;
+  };
+
+  caffe2::serialize::PyTorchStreamReader& reader_;
+  std::string dir_;
+  c10::Allocator* allocator_;
+  std::vector<Entry> entries_;
+  std::unordered_map<std::string, size_t> index_;
+  // number of entries whose read has been started
+  size_t num_started_ = 0;
+  size_t window_;
+  std::unique_ptr<c10::ThreadPool> pool_;
+};
+
+// Number of threads reading the tensor records of an archive loaded by
+// torch::jit::load, 0 to read them on the calling thread as they are needed
+TORCH_API int& getNumRecordReadThreads();
+
+} // namespace jit
+} // namespace torch
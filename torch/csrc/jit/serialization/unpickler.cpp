@@ -431,7 +431,10 @@ PickleOpCode Unpickler::readInstruction() {
       }
 
       if (device.is_cuda() || device.is_xpu()) {
-        tensor = tensor.to(device, tensor.scalar_type());
+        // records read into pinned memory are copied asynchronously, so that
+        // the next records are read while this one is copied
+        tensor = tensor.to(
+            device, tensor.scalar_type(), /*non_blocking=*/tensor.is_pinned());
       } else if (device.type() != DeviceType::CPU) {
         AT_ERROR(
             "supported devices include CPU and CUDA, however got ",
@@ -1,6 +1,7 @@
 #include <torch/csrc/jit/tensorexpr/kernel.h>
 
 #include <ATen/ExpandUtils.h>
+#include <ATen/Parallel.h>
 #include <ATen/TensorGeometry.h>
 #include <c10/util/string_utils.h>
 #include <torch/csrc/jit/jit_log.h>
@@ -11,6 +12,10 @@
 #include <torch/csrc/jit/tensorexpr/loopnest.h>
 #include <torch/csrc/jit/tensorexpr/operators/conv2d.h>
 
+#include <chrono>
+#include <limits>
+#include <sstream>
+
 using namespace torch::jit;
 using namespace torch::jit::tensorexpr;
 
@@ -31,6 +36,8 @@ static bool te_generate_block_code = false;
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
 static bool te_must_use_llvm_on_cpu = true;
 static bool cat_wo_conditionals = false; // NOLINT
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+static int64_t te_cpu_parallel_grain_size = at::internal::GRAIN_SIZE;
 
 bool setFallbackAllowed(bool value) {
   bool old_value = fallback_allowed;
@@ -84,6 +91,10 @@ int& getTECudaPointwiseBlockSize() {
   return te_cuda_pointwise_block_size;
 }
 
+int64_t& getTECpuParallelGrainSize() {
+  return te_cpu_parallel_grain_size;
+}
+
 // TODO: Remove this global var
 // Ideally Block code gen should be decided
 // based on device type in tensor.
@@ -126,6 +137,26 @@ c10::optional<std::vector<int64_t>> tensorSizes(torch::jit::Value* v) {
   return it->sizes().concrete_sizes();
 }
 
+bool symbolicShapeIsSupported(const TensorTypePtr& t) {
+  auto rank = t->dim();
+  if (!rank || *rank == 0 || !t->scalarType() || !t->device()) {
+    return false;
+  }
+  // the strides of a contiguous tensor, from the smallest one
+  const auto& strides = t->stride_properties();
+  if (strides.size() != rank) {
+    return false;
+  }
+  for (size_t i = 0; i < *rank; i++) {
+    const auto& stride = strides[i];
+    if (!stride || stride->stride_index_ != *rank - 1 - i ||
+        !stride->contiguous_.value_or(false)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // The fuser only supports conv2d with very specific properties:
 // - Static shapes: 4-d input and filter, 1-d bias.
 // - Constant strides/padding/dilation/groups
@@ -1689,7 +1720,28 @@ Tensor* TensorExprKernel::computeValue(const torch::jit::Value* v) {
   }
 }
 
-Stmt* TensorExprKernel::transformLoops(BackendType backendType, Stmt* st) {
+static void vectorizeReductions(LoopNest& l) {
+  // 8 floats fill an AVX2 register
+  const int kReductionLanes = 8;
+  std::vector<const Buf*> reductionBufs;
+  for (auto store : NodeFinder<Store>::find(l.root_stmt())) {
+    if (dynamic_cast<const ReduceOp*>(store->value()) &&
+        std::find(reductionBufs.begin(), reductionBufs.end(), store->buf()) ==
+            reductionBufs.end()) {
+      reductionBufs.push_back(store->buf());
+    }
+  }
+  for (auto buf : reductionBufs) {
+    if (l.vectorizeReduction(buf, kReductionLanes)) {
+      GRAPH_DEBUG("Vectorized reduction into ", buf->name_hint());
+    }
+  }
+}
+
+Stmt* TensorExprKernel::transformLoops(
+    BackendType backendType,
+    Stmt* st,
+    const LoopSchedule& schedule) {
   torch::jit::tensorexpr::LoopNest l(st, bufOutputs_);
   GRAPH_DEBUG("Original Stmt:\n", std::to_string(l.root_stmt()), "\n");
 
@@ -1787,6 +1839,17 @@ Stmt* TensorExprKernel::transformLoops(BackendType backendType, Stmt* st) {
     }
   }
 
+  // see Note [Loop schedule search]
+  if (backendType == kLLVMCodeGen && !hasReduction) {
+    scheduleOutputLoops(l, schedule);
+  }
+
+  // vectorizeInnerLoops cannot handle reduction axes, so on CPU reductions are
+  // vectorized separately by rfactoring them over a vector of partial results.
+  if (backendType == kLLVMCodeGen && hasReduction) {
+    vectorizeReductions(l);
+  }
+
   l.prepareForCodegen();
 
   if (backendType == kLLVMCodeGen && !hasReduction) {
@@ -1800,6 +1863,57 @@ Stmt* TensorExprKernel::transformLoops(BackendType backendType, Stmt* st) {
   return stmt;
 }
 
+void TensorExprKernel::scheduleOutputLoops(
+    LoopNest& l,
+    const LoopSchedule& schedule) {
+  // Run the loops of large outputs on the intra-op thread pool, like the ATen
+  // kernels they replace do with at::parallel_for. Random numbers are left
+  // alone since their iterations are not independent.
+  const int64_t grainSize = getTECpuParallelGrainSize();
+  const int64_t numThreads = at::get_num_threads();
+  const bool parallel = schedule.parallel && !hasRandom_ && grainSize > 0 &&
+      numThreads > 1;
+  for (auto buf : bufOutputs_) {
+    std::vector<For*> loops = l.getLoopStmtsFor(buf);
+    if (loops.empty()) {
+      continue;
+    }
+    int64_t numel = 1;
+    for (For* loop : loops) {
+      const Expr* extent =
+          IRSimplifier::simplify(new Sub(loop->stop(), loop->start()));
+      if (!extent->isConstant()) {
+        numel = 0;
+        break;
+      }
+      numel *= immediateAs<int>(extent);
+    }
+    const int64_t numChunks =
+        parallel ? std::min(numThreads, numel / grainSize) : 1;
+
+    if (schedule.tile > 0) {
+      if (For* outer = tileInnerLoops(l, buf, schedule.tile)) {
+        if (numChunks > 1) {
+          outer->set_parallel();
+        }
+        continue;
+      }
+    }
+
+    if (numChunks <= 1) {
+      continue;
+    }
+    For* flattened = loops[0];
+    if (loops.size() > 1 && !LoopNest::flatten(loops, &flattened)) {
+      continue;
+    }
+    For* outer = nullptr;
+    For* inner = nullptr;
+    For* tail = nullptr;
+    LoopNest::parallelizeWithTail(flattened, numChunks, &outer, &inner, &tail);
+  }
+}
+
 std::string TensorExprKernel::getCodeGenName(BackendType backendType) {
   switch (backendType) {
     case kCudaCodeGen:
@@ -1889,22 +2003,32 @@ void TensorExprKernel::bindInput(const torch::jit::Value* input) {
           "t" + input_name_map_[input],
           ToDtype(static_cast<ScalarType>(*tt->scalarType())),
           {0});
-      std::vector<DimArg> inputTensorDims;
-      for (size_t i = 0; i < *tt->sizes().size(); i++) {
-        auto const size = *tt->sizes()[i];
-        inputTensorDims.emplace_back(
-            DimArg(IntImm::make(size), "i" + c10::to_string(i)));
+      std::vector<ExprHandle> sizes;
+      std::vector<ExprHandle> strides;
+      if (tt->isComplete()) {
+        for (size_t i = 0; i < *tt->sizes().size(); i++) {
+          sizes.push_back(IntImm::make(*tt->sizes()[i]));
+          strides.push_back(IntImm::make(*tt->strides()[i]));
+        }
+      } else {
+        // see Note [Symbolic shapes in NNC]
+        sizes = bindSymbolicSizes(input->offset(), tt);
+        strides.resize(sizes.size());
+        ExprHandle stride = IntImm::make(1);
+        for (size_t i = sizes.size(); i > 0; i--) {
+          strides[i - 1] = stride;
+          stride = stride * sizes[i - 1];
+        }
       }
-      auto const strides = tt->strides();
       tensors_.emplace(
           input,
           Compute(
               "input" + c10::to_string(tensors_.size() + 1),
-              inputTensorDims,
+              dimsFromSizes(sizes),
               [&](const std::vector<VarHandle>& axes) {
                 ExprHandle idx = 0;
                 for (size_t i = 0; i < axes.size(); i++) {
-                  idx = idx + axes[i] * IntImm::make(*strides[i]);
+                  idx = idx + axes[i] * strides[i];
                 }
                 return inBuffer.load(idx);
               }));
@@ -1936,6 +2060,34 @@ void TensorExprKernel::bindInput(const torch::jit::Value* input) {
   }
 }
 
+std::vector<ExprHandle> TensorExprKernel::bindSymbolicSizes(
+    size_t input,
+    const TensorTypePtr& tt) {
+  if (!symbolicShapeIsSupported(tt)) {
+    throw malformed_input("input with unsupported symbolic shape");
+  }
+  SymbolicInput symbolic{input, {}, {}};
+  std::vector<ExprHandle> sizes;
+  for (const c10::ShapeSymbol& symbol : *tt->symbolic_sizes().sizes()) {
+    if (symbol.is_static()) {
+      sizes.push_back(IntImm::make(symbol.static_size()));
+      symbolic.sizes.push_back(symbol.static_size());
+      symbolic.vars.push_back(0);
+      continue;
+    }
+    auto it = shapeSymbolVars_.find(symbol);
+    if (it == shapeSymbolVars_.end()) {
+      it = shapeSymbolVars_.emplace(symbol, shapeVars_.size()).first;
+      shapeVars_.emplace_back("s" + c10::to_string(shapeVars_.size()), kInt);
+    }
+    sizes.push_back(shapeVars_[it->second]);
+    symbolic.sizes.push_back(-1);
+    symbolic.vars.push_back(it->second);
+  }
+  symbolicInputs_.push_back(std::move(symbolic));
+  return sizes;
+}
+
 namespace {
 
 // Remove all indices from axes positions.
@@ -2139,6 +2291,10 @@ Tensor* TensorExprKernel::computeSoftmax(
   auto maybe_dtype = v->node()->get(attr::dtype);
   if (maybe_dtype && !maybe_dtype->isNone()) {
     dtype = ToDtype(static_cast<ScalarType>(maybe_dtype->toInt()));
+  } else if (auto maybe_stype = findDtypeForValue(v)) {
+    // Without an explicit dtype the result has the type of the input, which
+    // the max reduction needs for its initial value.
+    dtype = ToDtype(*maybe_stype);
   }
 
   auto max = Reduce(
@@ -2390,6 +2546,11 @@ Tensor* TensorExprKernel::convertOutputToCorrectStrides(torch::jit::Value* v) {
   TORCH_INTERNAL_ASSERT(tensors_.count(v));
   Tensor* tensor = tensors_[v];
 
+  // outputs with symbolic dims are contiguous, see
+  // Note [Symbolic shapes in NNC]
+  if (!tt->sizes().concrete_sizes()) {
+    return tensor;
+  }
   TORCH_INTERNAL_ASSERT(tt->sizes().concrete_sizes());
   const auto sizes = *tt->sizes().concrete_sizes();
   std::vector<int64_t> default_strides = TensorType::contiguousStridesOf(sizes);
@@ -2466,6 +2627,10 @@ void TensorExprKernel::compile() {
       block->append_stmt(tensors_.at(input)->stmt());
     }
   }
+  // dim vars are passed after the inputs
+  for (const VarHandle& var : shapeVars_) {
+    bufferArgs_.emplace_back(var);
+  }
 
   // Bind nodes to tensor compute expressions.
   for (auto const& n : graph_->nodes()) {
@@ -2501,16 +2666,44 @@ void TensorExprKernel::compile() {
     }
     tensors_[output] = properly_strided_output;
     const auto& tt = output->type()->expect<TensorType>();
-    auto sizes = *tt->sizes().concrete_sizes();
-    tensorOutputSizes_.push_back(sizes);
-    auto strides = *tt->strides().concrete_sizes();
-
-    // If the tensor is not dense or overlaps, we have
-    // no way of matching the profiled striding
-    if (denseAndNonOverlapping(sizes, strides)) {
-      tensorOutputStrides_.push_back(*tt->strides().concrete_sizes());
+    if (tt->sizes().concrete_sizes()) {
+      auto sizes = *tt->sizes().concrete_sizes();
+      tensorOutputSizes_.push_back(sizes);
+      auto strides = *tt->strides().concrete_sizes();
+
+      // If the tensor is not dense or overlaps, we have
+      // no way of matching the profiled striding
+      if (denseAndNonOverlapping(sizes, strides)) {
+        tensorOutputStrides_.push_back(*tt->strides().concrete_sizes());
+      } else {
+        tensorOutputStrides_.push_back(
+            TensorType::contiguousStridesOf(sizes));
+      }
+      tensorOutputShapeVars_.emplace_back();
     } else {
-      tensorOutputStrides_.push_back(TensorType::contiguousStridesOf(sizes));
+      // see Note [Symbolic shapes in NNC]. The sizes of the dims bound to dim
+      // vars, and the strides, are filled in on every call.
+      std::vector<int64_t> sizes;
+      std::vector<int64_t> vars;
+      for (const Expr* dim : tensors_.at(output)->buf()->dims()) {
+        if (auto imm = dynamic_cast<const IntImm*>(dim)) {
+          sizes.push_back(imm->value());
+          vars.push_back(-1);
+          continue;
+        }
+        auto var = std::find_if(
+            shapeVars_.begin(), shapeVars_.end(), [&](const VarHandle& v) {
+              return v.node() == dim;
+            });
+        if (var == shapeVars_.end()) {
+          throw malformed_input("output with unsupported symbolic shape");
+        }
+        sizes.push_back(0);
+        vars.push_back(var - shapeVars_.begin());
+      }
+      tensorOutputSizes_.push_back(sizes);
+      tensorOutputStrides_.emplace_back();
+      tensorOutputShapeVars_.push_back(std::move(vars));
     }
 
     bufOutputs_.insert(tensors_.at(output)->buf());
@@ -2520,18 +2713,105 @@ void TensorExprKernel::compile() {
     tensors_.erase(output);
   }
 
-  BackendType backendType = inferBackendTypeFromDevice(device_);
-  Stmt* stmt = transformLoops(backendType, block);
+  backendType_ = inferBackendTypeFromDevice(device_);
+  stmt_ = block;
+  pickLoopSchedule();
 
   // Generate code.
-  codegen_ = CreateCodeGen(
-      getCodeGenName(backendType),
+  codegen_ = generateCode(schedule_);
+}
+
+std::unique_ptr<CodeGen> TensorExprKernel::generateCode(
+    const LoopSchedule& schedule) {
+  // transformLoops works in place, keep stmt_ for the other schedules
+  Stmt* stmt = transformLoops(backendType_, Stmt::clone(stmt_), schedule);
+  return CreateCodeGen(
+      getCodeGenName(backendType_),
       stmt,
       bufferArgs_,
       device_,
       SubgraphUtils::generateNameForGraph(graph_));
 }
 
+void TensorExprKernel::pickLoopSchedule() {
+  // see Note [Loop schedule search]
+  if (backendType_ != kLLVMCodeGen ||
+      NodeFinder<ReduceOp>::find(stmt_).size() != 0) {
+    return;
+  }
+  std::stringstream text;
+  text << getCodeGenName(backendType_) << " " << at::get_num_threads() << "\n"
+       << graph_->toString(false);
+  scheduleKey_ = loopScheduleKey(text.str());
+  if (auto tuned = lookupTunedLoopSchedule(scheduleKey_)) {
+    schedule_ = *tuned;
+    return;
+  }
+
+  LoopNest l(Stmt::clone(stmt_), bufOutputs_);
+  l.inlineIntermediateBufs(/*allow_duplicated_work=*/false);
+  scheduleCandidates_ = searchLoopSchedules(l, bufOutputs_);
+  schedule_ = scheduleCandidates_.front();
+  GRAPH_DEBUG("Picked ", schedule_, " for ", scheduleKey_);
+
+  // Kernels with random numbers cannot be run more than once per call, and
+  // the timings of one call are meaningless for kernels with symbolic shapes.
+  if (getTETuneLoopSchedules() && !hasRandom_ && shapeVars_.empty() &&
+      scheduleCandidates_.size() > 1) {
+    needsTuning_ = true;
+  } else {
+    scheduleCandidates_.clear();
+  }
+}
+
+void TensorExprKernel::tuneLoopSchedule(
+    const std::vector<CodeGen::CallArg>& runArgs) {
+  std::lock_guard<std::mutex> guard(tuningMutex_);
+  if (!needsTuning_) {
+    return;
+  }
+  const size_t kMaxTunedSchedules = 4;
+  const int kTimedRuns = 3;
+  auto timeCall = [&](CodeGen& codegen) {
+    // warm up
+    codegen.call(runArgs);
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < kTimedRuns; ++i) {
+      auto start = std::chrono::steady_clock::now();
+      codegen.call(runArgs);
+      std::chrono::duration<double> time =
+          std::chrono::steady_clock::now() - start;
+      best = std::min(best, time.count());
+    }
+    return best;
+  };
+
+  // scheduleCandidates_[0] is the current schedule
+  double bestTime = timeCall(*codegen_);
+  const size_t numTuned =
+      std::min(kMaxTunedSchedules, scheduleCandidates_.size());
+  for (size_t i = 1; i < numTuned; ++i) {
+    const LoopSchedule& candidate = scheduleCandidates_[i];
+    std::unique_ptr<CodeGen> codegen;
+    try {
+      codegen = generateCode(candidate);
+    } catch (const std::exception& e) {
+      GRAPH_DEBUG("Could not compile ", candidate, ": ", e.what());
+      continue;
+    }
+    double time = timeCall(*codegen);
+    GRAPH_DEBUG("Time of ", candidate, ": ", time);
+    if (time < bestTime) {
+      bestTime = time;
+      schedule_ = candidate;
+      codegen_ = std::move(codegen);
+    }
+  }
+  scheduleCandidates_.clear();
+  recordTunedLoopSchedule(scheduleKey_, schedule_);
+  needsTuning_ = false;
+}
+
 TensorExprKernel::TensorExprKernel(const std::shared_ptr<Graph>& subgraph)
     : graph_(subgraph), code_(subgraph, "") {
   allow_fallback_ = fallbackAllowed();
@@ -2566,11 +2846,42 @@ void TensorExprKernel::run(Stack& stack) {
   }
 }
 
+bool TensorExprKernel::bindShapeVars(
+    const at::ArrayRef<IValue>& inputs,
+    std::vector<int64_t>& shapeValues) {
+  shapeValues.assign(shapeVars_.size(), -1);
+  for (const SymbolicInput& symbolic : symbolicInputs_) {
+    const at::Tensor& t = inputs[symbolic.input].toTensor();
+    if (t.dim() != static_cast<int64_t>(symbolic.sizes.size()) ||
+        !t.is_contiguous()) {
+      return false;
+    }
+    for (size_t i = 0; i < symbolic.sizes.size(); i++) {
+      const int64_t size = t.size(i);
+      if (symbolic.sizes[i] >= 0) {
+        if (size != symbolic.sizes[i]) {
+          return false;
+        }
+        continue;
+      }
+      int64_t& value = shapeValues[symbolic.vars[i]];
+      // dim vars are ints
+      if ((value >= 0 && value != size) ||
+          size > std::numeric_limits<int>::max()) {
+        return false;
+      }
+      value = size;
+    }
+  }
+  return true;
+}
+
 std::vector<CodeGen::CallArg> TensorExprKernel::prepareRunArgs(
     const at::ArrayRef<IValue>& inputs,
+    const std::vector<int64_t>& shapeValues,
     std::vector<at::Tensor>& outputs) {
   std::vector<CodeGen::CallArg> runArgs;
-  runArgs.reserve(inputs.size() + bufOutputs_.size());
+  runArgs.reserve(inputs.size() + shapeValues.size() + bufOutputs_.size());
 
   for (const auto& input : inputs) {
     if (input.isInt()) {
@@ -2581,17 +2892,46 @@ std::vector<CodeGen::CallArg> TensorExprKernel::prepareRunArgs(
       runArgs.emplace_back(input.toTensor().data_ptr());
     }
   }
+  for (int64_t value : shapeValues) {
+    runArgs.emplace_back(static_cast<int>(value));
+  }
 
+  // outputs passed in by runWithOutputs are reused if they fit
+  outputs.resize(bufOutputs_.size());
   for (size_t i = 0, e = bufOutputs_.size(); i < e; ++i) {
     auto const& opts = tensorOutputTensorOptions_[i];
-    outputs.emplace_back(codegen_->empty_strided(
-        tensorOutputSizes_[i],
-        tensorOutputStrides_[i],
-        opts.dtype,
-        opts.layout,
-        opts.device,
-        opts.pinned_memory));
-    runArgs.emplace_back(outputs.back().data_ptr());
+    const std::vector<int64_t>* sizes = &tensorOutputSizes_[i];
+    const std::vector<int64_t>* strides = &tensorOutputStrides_[i];
+    std::vector<int64_t> symbolicSizes;
+    std::vector<int64_t> symbolicStrides;
+    if (!tensorOutputShapeVars_[i].empty()) {
+      symbolicSizes = *sizes;
+      for (size_t d = 0; d < symbolicSizes.size(); d++) {
+        const int64_t var = tensorOutputShapeVars_[i][d];
+        if (var >= 0) {
+          symbolicSizes[d] = shapeValues[var];
+        }
+      }
+      symbolicStrides = TensorType::contiguousStridesOf(symbolicSizes);
+      sizes = &symbolicSizes;
+      strides = &symbolicStrides;
+    }
+    at::Tensor& output = outputs[i];
+    const bool reuse = output.defined() &&
+        output.scalar_type() == opts.dtype && output.device() == opts.device &&
+        *strides == TensorType::contiguousStridesOf(*sizes);
+    if (reuse) {
+      output.resize_(*sizes);
+    } else {
+      output = codegen_->empty_strided(
+          *sizes,
+          *strides,
+          opts.dtype,
+          opts.layout,
+          opts.device,
+          opts.pinned_memory);
+    }
+    runArgs.emplace_back(output.data_ptr());
   }
   return runArgs;
 }
@@ -2600,6 +2940,38 @@ Stmt* TensorExprKernel::getCodeGenStmt() {
   return codegen_->stmt();
 }
 
+void TensorExprKernel::runWithOutputs(
+    at::ArrayRef<IValue> inputs,
+    std::vector<at::Tensor>& outputs) {
+  auto runFallback = [&]() {
+    Stack stack(inputs.begin(), inputs.end());
+    fallback(stack);
+    outputs.clear();
+    for (auto& o : stack) {
+      outputs.push_back(std::move(o).toTensor());
+    }
+  };
+  std::vector<int64_t> shapeValues;
+  if (use_fallback_ || !bindShapeVars(inputs, shapeValues)) {
+    runFallback();
+    return;
+  }
+  try {
+    KernelScope kernelScope(&kernelArena_);
+    std::vector<CodeGen::CallArg> runArgs =
+        prepareRunArgs(inputs, shapeValues, outputs);
+    if (needsTuning_) {
+      tuneLoopSchedule(runArgs);
+    }
+    codegen_->call(runArgs);
+  } catch (...) {
+    if (!allow_fallback_) {
+      throw;
+    }
+    runFallback();
+  }
+}
+
 void TensorExprKernel::runKernel(Stack& stack) {
   KernelScope kernelScope(&kernelArena_);
 
@@ -2607,7 +2979,19 @@ void TensorExprKernel::runKernel(Stack& stack) {
   auto inputs = last(stack, nInputs_);
   std::vector<at::Tensor> outputs;
 
-  std::vector<CodeGen::CallArg> runArgs = prepareRunArgs(inputs, outputs);
+  // see Note [Symbolic shapes in NNC]
+  std::vector<int64_t> shapeValues;
+  if (!bindShapeVars(inputs, shapeValues)) {
+    fallback(stack);
+    return;
+  }
+
+  std::vector<CodeGen::CallArg> runArgs =
+      prepareRunArgs(inputs, shapeValues, outputs);
+
+  if (needsTuning_) {
+    tuneLoopSchedule(runArgs);
+  }
 
   // Call the kernel.
   codegen_->call(runArgs);
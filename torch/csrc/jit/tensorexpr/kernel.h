@@ -4,12 +4,18 @@
 #include <torch/csrc/jit/runtime/interpreter.h>
 #include <torch/csrc/jit/tensorexpr/analysis.h>
 #include <torch/csrc/jit/tensorexpr/codegen.h>
+#include <torch/csrc/jit/tensorexpr/loop_schedule.h>
 #include <torch/csrc/jit/tensorexpr/tensor.h>
 
+#include <atomic>
+#include <mutex>
+
 namespace torch {
 namespace jit {
 namespace tensorexpr {
 
+class LoopNest;
+
 template <typename T>
 inline std::vector<int64_t> bufferSizes(const T& t) {
   std::vector<int64_t> sizes;
@@ -22,12 +28,25 @@ inline std::vector<int64_t> bufferSizes(const T& t) {
 // Returns true if the TE fuser supports this conv2d.
 bool conv2dIsSupported(const Node* node);
 
+// Returns true if a kernel can take a tensor of type t whose sizes are not
+// all known, see Note [Symbolic shapes in NNC].
+TORCH_API bool symbolicShapeIsSupported(const TensorTypePtr& t);
+
 class TORCH_API TensorExprKernel {
  public:
   explicit TensorExprKernel(const std::shared_ptr<Graph>& subgraph);
 
   void run(Stack& stack);
 
+  // Like run, but writes the outputs into existing tensors, for callers that
+  // manage the memory of the outputs. Each defined tensor of outputs that has
+  // the dtype and device of the corresponding kernel output, which has to be
+  // contiguous, is resized and written to; the others are replaced by new
+  // tensors.
+  void runWithOutputs(
+      at::ArrayRef<IValue> inputs,
+      std::vector<at::Tensor>& outputs);
+
   void fallback(Stack& stack) {
     InterpreterState(code_).run(stack);
   }
@@ -153,12 +172,26 @@ class TORCH_API TensorExprKernel {
 
   Tensor* computeValue(const torch::jit::Value* v);
 
-  Stmt* transformLoops(BackendType backendType, Stmt* st);
+  Stmt* transformLoops(
+      BackendType backendType,
+      Stmt* st,
+      const LoopSchedule& schedule);
+  void scheduleOutputLoops(LoopNest& l, const LoopSchedule& schedule);
+  std::unique_ptr<CodeGen> generateCode(const LoopSchedule& schedule);
+  void pickLoopSchedule();
+  void tuneLoopSchedule(const std::vector<CodeGen::CallArg>& runArgs);
 
   std::string getCodeGenName(BackendType backendType);
 
+  std::vector<ExprHandle> bindSymbolicSizes(
+      size_t input,
+      const TensorTypePtr& tt);
+  bool bindShapeVars(
+      const at::ArrayRef<IValue>& inputs,
+      std::vector<int64_t>& shapeValues);
   std::vector<CodeGen::CallArg> prepareRunArgs(
       const at::ArrayRef<IValue>& inputs,
+      const std::vector<int64_t>& shapeValues,
       std::vector<at::Tensor>& outputs);
   BackendType inferBackendTypeFromDevice(at::Device device);
 
@@ -206,6 +239,15 @@ class TORCH_API TensorExprKernel {
   std::unordered_map<const torch::jit::Value*, std::string> input_name_map_;
   std::unique_ptr<CodeGen> codegen_;
   at::Device device_ = at::kCPU;
+  BackendType backendType_ = kUninitialized;
+  // the loop nests of the outputs before any loop transformation
+  Stmt* stmt_ = nullptr;
+  // see Note [Loop schedule search]
+  LoopSchedule schedule_;
+  std::string scheduleKey_;
+  std::vector<LoopSchedule> scheduleCandidates_;
+  std::atomic<bool> needsTuning_{false};
+  std::mutex tuningMutex_;
   KernelArena kernelArena_;
   std::vector<TypePtr> inputTypes_;
   std::shared_ptr<Graph> graph_;
@@ -216,11 +258,43 @@ class TORCH_API TensorExprKernel {
   bool hasBroadcast_{false};
   std::unordered_map<const torch::jit::Value*, std::vector<ExprHandle>>
       known_sizes_;
+
+  // Note [Symbolic shapes in NNC]
+  // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+  // Profiling gives a dimension whose size varied across the profiled runs a
+  // ShapeSymbol instead of a size, and dimensions that always had the same
+  // size in the same frame share the symbol. Rather than specializing on one
+  // size, a kernel binds each such symbol to a dim var, a kernel argument
+  // read from the sizes of the inputs on every call, and keeps static
+  // dimensions as constants. Inputs and outputs with symbolic dims must be
+  // contiguous, and the fuser only fuses nodes with symbolic dims that do
+  // not broadcast, so that every output dim is either static or a dim var.
+  //
+  // The type guard of the fusion group does not check sizes or strides of
+  // such inputs, so a call whose inputs do not fit the kernel, i.e. differ in
+  // rank or static sizes, give one symbol different sizes or are not
+  // contiguous, runs the fallback instead.
+  struct SymbolicInput {
+    size_t input;
+    // size of each dim, -1 for the dims bound to a dim var
+    std::vector<int64_t> sizes;
+    // the dim var of each dim, unused for static dims
+    std::vector<size_t> vars;
+  };
+  std::map<c10::ShapeSymbol, size_t> shapeSymbolVars_;
+  std::vector<VarHandle> shapeVars_;
+  std::vector<SymbolicInput> symbolicInputs_;
+  // the dim var of each dim of each output, -1 for static dims. Empty for
+  // outputs without symbolic dims.
+  std::vector<std::vector<int64_t>> tensorOutputShapeVars_;
 };
 
 TORCH_API int& getTECudaPointwiseLoopLevels();
 TORCH_API int& getTECudaPointwiseBlockCount();
 TORCH_API int& getTECudaPointwiseBlockSize();
+// Minimal number of elements per thread of a CPU kernel, which runs the loops
+// of larger outputs in parallel. Non-positive values disable parallel loops.
+TORCH_API int64_t& getTECpuParallelGrainSize();
 TORCH_API bool& getTEGenerateBlockCode();
 TORCH_API bool& getTEMustUseLLVMOnCPU();
 TORCH_API bool fallbackAllowed();
@@ -0,0 +1,353 @@
+#include <torch/csrc/jit/tensorexpr/loop_schedule.h>
+
+#include <ATen/Parallel.h>
+#include <c10/util/Flags.h>
+#include <c10/util/hash.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/tensorexpr/analysis.h>
+#include <torch/csrc/jit/tensorexpr/eval.h>
+#include <torch/csrc/jit/tensorexpr/ir_simplifier.h>
+#include <torch/csrc/jit/tensorexpr/kernel.h>
+#include <torch/csrc/jit/tensorexpr/loopnest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+C10_DEFINE_string(
+    torch_jit_te_tuning_log,
+    "",
+    "File in which the loop schedules picked by timing TensorExpr kernels are "
+    "persisted");
+
+namespace torch {
+namespace jit {
+namespace tensorexpr {
+
+static bool te_tune_loop_schedules = false;
+
+namespace {
+
+// Parameters of the cost model, see Note [Loop schedule search]
+constexpr int64_t kCacheLineBytes = 64;
+constexpr int64_t kL1CacheBytes = 32 * 1024;
+// cost of starting a sweep of the innermost loop
+constexpr double kLoopCost = 0.25;
+// cost of handing the loops to the intra-op thread pool
+constexpr double kParallelCost = 1000;
+
+const int kTileSizes[] = {8, 16, 32, 64};
+
+c10::optional<int64_t> loopExtent(const For* f) {
+  const Expr* extent = IRSimplifier::simplify(new Sub(f->stop(), f->start()));
+  if (!extent->isConstant()) {
+    return c10::nullopt;
+  }
+  return immediateAs<int64_t>(extent);
+}
+
+bool tilesEvenly(const std::vector<For*>& loops, int tile) {
+  if (loops.size() < 2) {
+    return false;
+  }
+  for (const For* f : {loops[loops.size() - 2], loops.back()}) {
+    auto extent = loopExtent(f);
+    if (!extent || *extent <= tile || *extent % tile != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The stride, in elements, of the flattened index of an access to buf along
+// var, or nullopt if it is not a constant.
+c10::optional<int64_t> accessStride(
+    const Buf* buf,
+    const std::vector<const Expr*>& indices,
+    const Var* var) {
+  if (indices.empty() || indices.size() != buf->ndim()) {
+    return c10::nullopt;
+  }
+  const Expr* flat = indices[0];
+  for (size_t i = 1; i < indices.size(); ++i) {
+    flat = new Add(new Mul(flat, buf->dim(i)), indices[i]);
+  }
+  const Expr* next = Substitute(flat, {{var, new Add(var, new IntImm(1))}});
+  const Expr* stride = IRSimplifier::simplify(new Sub(next, flat));
+  if (!stride->isConstant()) {
+    return c10::nullopt;
+  }
+  return immediateAs<int64_t>(stride);
+}
+
+struct Access {
+  c10::optional<int64_t> innerStride;
+  c10::optional<int64_t> outerStride;
+  int64_t elementBytes;
+};
+
+bool isContiguous(const c10::optional<int64_t>& stride, int64_t elementBytes) {
+  return stride && std::abs(*stride) * elementBytes < kCacheLineBytes;
+}
+
+double outputCost(
+    LoopNest& l,
+    const Buf* buf,
+    const LoopSchedule& schedule,
+    int64_t numThreads,
+    int64_t grainSize) {
+  std::vector<For*> loops = l.getLoopStmtsFor(buf);
+  if (loops.empty()) {
+    return 0;
+  }
+  int64_t numel = 1;
+  for (const For* f : loops) {
+    auto extent = loopExtent(f);
+    if (!extent) {
+      // every schedule looks the same to the model
+      return 0;
+    }
+    numel *= *extent;
+  }
+  const For* inner = loops.back();
+  const For* outer = loops.size() > 1 ? loops[loops.size() - 2] : nullptr;
+  const bool tiled = schedule.tile > 0 && tilesEvenly(loops, schedule.tile);
+  const int64_t sweep = tiled ? schedule.tile : *loopExtent(inner);
+
+  std::vector<Access> accesses;
+  auto addAccess = [&](const Buf* b, const std::vector<const Expr*>& indices) {
+    accesses.push_back(
+        {accessStride(b, indices, inner->var()),
+         outer ? accessStride(b, indices, outer->var()) : c10::nullopt,
+         b->dtype().byte_size()});
+  };
+  for (const Stmt* s : l.getAllWritesToBuf(buf)) {
+    const Store* store = dynamic_cast<const Store*>(s);
+    if (!store) {
+      continue;
+    }
+    addAccess(store->buf(), store->indices());
+    for (const Load* load : NodeFinder<Load>::find(store)) {
+      addAccess(load->buf(), load->indices());
+    }
+  }
+
+  int64_t numStrided = 0;
+  for (const Access& a : accesses) {
+    if (!isContiguous(a.innerStride, a.elementBytes)) {
+      numStrided++;
+    }
+  }
+
+  double cost = static_cast<double>(numel) / sweep * kLoopCost;
+  for (const Access& a : accesses) {
+    const double lines =
+        static_cast<double>(numel) * a.elementBytes / kCacheLineBytes;
+    if (isContiguous(a.innerStride, a.elementBytes)) {
+      cost += lines;
+    } else if (
+        a.innerStride && isContiguous(a.outerStride, a.elementBytes) &&
+        sweep * kCacheLineBytes * numStrided <= kL1CacheBytes) {
+      // the lines of one sweep are still cached for the next iterations of
+      // the outer loop, which read the rest of them
+      cost += lines;
+    } else {
+      cost += numel;
+    }
+  }
+
+  if (schedule.parallel && numThreads > 1 && grainSize > 0) {
+    const int64_t numChunks = std::min(numThreads, numel / grainSize);
+    if (numChunks > 1) {
+      cost = cost / numChunks + kParallelCost;
+    }
+  }
+  return cost;
+}
+
+struct TuningLog {
+  std::mutex mutex;
+  std::string path = FLAGS_torch_jit_te_tuning_log;
+  bool loaded = false;
+  std::unordered_map<std::string, LoopSchedule> entries;
+};
+
+TuningLog& tuningLog() {
+  static TuningLog log;
+  return log;
+}
+
+// Reads the entries of the log file, later entries taking precedence. Must
+// be called with the mutex of log held.
+void loadTuningLog(TuningLog& log) {
+  if (log.loaded) {
+    return;
+  }
+  log.loaded = true;
+  if (log.path.empty()) {
+    return;
+  }
+  std::ifstream in(log.path);
+  std::string key;
+  LoopSchedule schedule;
+  while (in >> key >> schedule.tile >> schedule.parallel) {
+    log.entries[key] = schedule;
+  }
+}
+
+} // namespace
+
+std::ostream& operator<<(std::ostream& out, const LoopSchedule& schedule) {
+  return out << "LoopSchedule(tile=" << schedule.tile
+             << ", parallel=" << schedule.parallel << ")";
+}
+
+For* tileInnerLoops(LoopNest& l, const Buf* buf, int tile) {
+  std::vector<For*> loops = l.getLoopStmtsFor(buf);
+  if (!tilesEvenly(loops, tile)) {
+    return nullptr;
+  }
+  For* x = loops[loops.size() - 2];
+  For* y = loops.back();
+  if (x->body()->nstmts() != 1) {
+    return nullptr;
+  }
+  For* yOuter = nullptr;
+  For* yInner = nullptr;
+  LoopNest::splitWithMask(y, tile, &yOuter, &yInner);
+  For* xOuter = nullptr;
+  For* xInner = nullptr;
+  LoopNest::splitWithMask(x, tile, &xOuter, &xInner);
+  // splitting x copied its body, including the outer loop of y
+  yOuter = dynamic_cast<For*>(xInner->body()->stmts().front());
+  TORCH_INTERNAL_ASSERT(yOuter);
+  l.reorderAxis(xInner, yOuter);
+  return loops.size() > 2 ? loops[0] : xOuter;
+}
+
+double estimateLoopScheduleCost(
+    LoopNest& l,
+    const std::unordered_set<const Buf*>& outputs,
+    const LoopSchedule& schedule) {
+  const int64_t numThreads = at::get_num_threads();
+  const int64_t grainSize = getTECpuParallelGrainSize();
+  double cost = 0;
+  for (const Buf* buf : outputs) {
+    cost += outputCost(l, buf, schedule, numThreads, grainSize);
+  }
+  return cost;
+}
+
+std::vector<LoopSchedule> searchLoopSchedules(
+    LoopNest& l,
+    const std::unordered_set<const Buf*>& outputs) {
+  const int64_t numThreads = at::get_num_threads();
+  const int64_t grainSize = getTECpuParallelGrainSize();
+
+  std::vector<int> tiles = {0};
+  for (int tile : kTileSizes) {
+    for (const Buf* buf : outputs) {
+      if (tilesEvenly(l.getLoopStmtsFor(buf), tile)) {
+        tiles.push_back(tile);
+        break;
+      }
+    }
+  }
+  bool anyParallel = false;
+  if (numThreads > 1 && grainSize > 0) {
+    for (const Buf* buf : outputs) {
+      int64_t numel = 1;
+      for (const For* f : l.getLoopStmtsFor(buf)) {
+        numel *= loopExtent(f).value_or(0);
+      }
+      anyParallel |= numel / grainSize > 1;
+    }
+  }
+
+  std::vector<std::pair<double, LoopSchedule>> candidates;
+  for (int tile : tiles) {
+    for (bool parallel : {true, false}) {
+      if (!parallel && !anyParallel) {
+        continue;
+      }
+      LoopSchedule schedule;
+      schedule.tile = tile;
+      schedule.parallel = parallel;
+      candidates.emplace_back(
+          estimateLoopScheduleCost(l, outputs, schedule), schedule);
+    }
+  }
+  std::stable_sort(
+      candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+      });
+
+  std::vector<LoopSchedule> schedules;
+  for (const auto& c : candidates) {
+    GRAPH_DEBUG("Estimated cost of ", c.second, ": ", c.first);
+    schedules.push_back(c.second);
+  }
+  return schedules;
+}
+
+bool& getTETuneLoopSchedules() {
+  return te_tune_loop_schedules;
+}
+
+void setTETuningLogPath(std::string path) {
+  TuningLog& log = tuningLog();
+  std::lock_guard<std::mutex> guard(log.mutex);
+  log.path = std::move(path);
+  log.loaded = false;
+  log.entries.clear();
+}
+
+std::string getTETuningLogPath() {
+  TuningLog& log = tuningLog();
+  std::lock_guard<std::mutex> guard(log.mutex);
+  return log.path;
+}
+
+std::string loopScheduleKey(const std::string& text) {
+  // bump whenever LoopSchedule or the way it is applied changes
+  static const std::string kVersion = "1\n";
+  std::stringstream key;
+  key << std::hex << c10::stable_hash(kVersion + text);
+  return key.str();
+}
+
+c10::optional<LoopSchedule> lookupTunedLoopSchedule(const std::string& key) {
+  TuningLog& log = tuningLog();
+  std::lock_guard<std::mutex> guard(log.mutex);
+  loadTuningLog(log);
+  auto it = log.entries.find(key);
+  if (it == log.entries.end()) {
+    return c10::nullopt;
+  }
+  return it->second;
+}
+
+void recordTunedLoopSchedule(
+    const std::string& key,
+    const LoopSchedule& schedule) {
+  TuningLog& log = tuningLog();
+  std::lock_guard<std::mutex> guard(log.mutex);
+  loadTuningLog(log);
+  log.entries[key] = schedule;
+  if (log.path.empty()) {
+    return;
+  }
+  std::ofstream out(log.path, std::ios::app);
+  out << key << " " << schedule.tile << " " << schedule.parallel << "\n";
+  if (!out) {
+    GRAPH_DEBUG("Could not append to the tuning log ", log.path);
+  }
+}
+
+} // namespace tensorexpr
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <c10/util/Optional.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <ostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace torch {
+namespace jit {
+namespace tensorexpr {
+
+class Buf;
+class For;
+class LoopNest;
+
+// Note [Loop schedule search]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// A CPU kernel gets its loops vectorized and, for large outputs, run in
+// parallel. On top of that, the two innermost loops of each output can be
+// tiled, so that outputs whose inputs are read with a large stride along the
+// innermost loop, e.g. transposes, touch a tile's worth of cache lines at a
+// time instead of a full row. A LoopSchedule selects among these
+// transformations.
+//
+// searchLoopSchedules lists the schedules that apply to a kernel, ordered by
+// a simple analytic cost model: the number of cache lines the kernel reads
+// from memory, assuming lines are reused only while the lines touched by one
+// sweep of the innermost loop fit in the L1 cache, divided among the threads
+// that run it. The kernel uses the cheapest one.
+//
+// The model knows nothing about the actual machine, so with
+// getTETuneLoopSchedules() set a kernel instead times the most promising
+// schedules on the inputs of its first call and keeps the fastest. The
+// choice is recorded in the tuning log, which is read back by every kernel
+// compiled later for the same graph, including in other processes when a
+// tuning log file is set, so tuning is done once per kernel and machine.
+
+struct TORCH_API LoopSchedule {
+  // Tile the two innermost loops of each output by tile x tile, 0 for none
+  int tile = 0;
+  // Run the loops of large outputs in parallel, see getTECpuParallelGrainSize
+  bool parallel = true;
+
+  bool operator==(const LoopSchedule& other) const {
+    return tile == other.tile && parallel == other.parallel;
+  }
+  bool operator!=(const LoopSchedule& other) const {
+    return !(*this == other);
+  }
+};
+
+TORCH_API std::ostream& operator<<(
+    std::ostream& out,
+    const LoopSchedule& schedule);
+
+// Tiles the two innermost loops of the loop nest of buf and returns the
+// outermost loop of the tiled nest. Returns nullptr, leaving the loops
+// unchanged, if they do not split evenly into tiles.
+TORCH_API For* tileInnerLoops(LoopNest& l, const Buf* buf, int tile);
+
+// The estimated cost of computing outputs with schedule, in cache lines read.
+// The intermediate buffers of l must have been inlined.
+TORCH_API double estimateLoopScheduleCost(
+    LoopNest& l,
+    const std::unordered_set<const Buf*>& outputs,
+    const LoopSchedule& schedule);
+
+// The schedules that apply to the outputs of l, cheapest first. The default
+// schedule comes first among schedules of the same cost.
+TORCH_API std::vector<LoopSchedule> searchLoopSchedules(
+    LoopNest& l,
+    const std::unordered_set<const Buf*>& outputs);
+
+// Time the candidate schedules of a kernel on its first call
+TORCH_API bool& getTETuneLoopSchedules();
+
+// The file the tuning log is persisted to. An empty path (the default) keeps
+// it in memory only. Setting the path drops the entries of the previous log.
+TORCH_API void setTETuningLogPath(std::string path);
+TORCH_API std::string getTETuningLogPath();
+
+// The key of the kernel described by text in the tuning log
+TORCH_API std::string loopScheduleKey(const std::string& text);
+TORCH_API c10::optional<LoopSchedule> lookupTunedLoopSchedule(
+    const std::string& key);
+TORCH_API void recordTunedLoopSchedule(
+    const std::string& key,
+    const LoopSchedule& schedule);
+
+} // namespace tensorexpr
+} // namespace jit
+} // namespace torch
@@ -1193,6 +1193,29 @@ void LoopNest::splitWithTail(
   }
 }
 
+void LoopNest::parallelizeWithTail(
+    For* f,
+    int num_chunks,
+    For** outer,
+    For** inner,
+    For** tail) {
+  if (!f) {
+    throw malformed_input("parallelizeWithTail attempted on null loop", f);
+  }
+  const Expr* extent = IRSimplifier::simplify(new Sub(f->stop(), f->start()));
+  if (!extent->isConstant()) {
+    throw malformed_input(
+        "parallelizeWithTail attempted on loop with non-constant extent", f);
+  }
+  int extent_val = immediateAs<int>(extent);
+  if (num_chunks <= 0 || extent_val < num_chunks) {
+    throw malformed_input(
+        "parallelizeWithTail attempted with more chunks than iterations", f);
+  }
+  splitWithTail(f, extent_val / num_chunks, outer, inner, tail);
+  (*outer)->set_parallel();
+}
+
 void LoopNest::splitWithMask(For* f, int factor) {
   // NOLINTNEXTLINE(cppcoreguidelines-init-variables)
   For *outer, *inner;
@@ -2530,6 +2553,72 @@ bool LoopNest::rfactor(Stmt* st, For* outer_reduction_for, Buf** rfac_buf_ptr) {
   return true;
 }
 
+static Store* findReductionStore(const std::vector<const Stmt*>& writes) {
+  Store* reduction_store = nullptr;
+  for (const Stmt* s : writes) {
+    const Store* store = dynamic_cast<const Store*>(s);
+    if (store && dynamic_cast<const ReduceOp*>(store->value())) {
+      if (reduction_store) {
+        // More than one reduction into the same buffer
+        return nullptr;
+      }
+      reduction_store = const_cast<Store*>(store);
+    }
+  }
+  return reduction_store;
+}
+
+bool LoopNest::vectorizeReduction(const Buf* buf, int lanes) {
+  Store* reduction_store = findReductionStore(getAllWritesToBuf(buf));
+  if (!reduction_store) {
+    return false;
+  }
+  const ReduceOp* reduce_op =
+      static_cast<const ReduceOp*>(reduction_store->value());
+  if (reduce_op->reduce_args().size() != 1) {
+    return false;
+  }
+
+  // The reduction store must be the only stmt in the loop over its axis.
+  For* reduction_for = getParentLoop(reduction_store);
+  if (!reduction_for || reduction_for->var() != reduce_op->reduce_args()[0] ||
+      reduction_for->body()->nstmts() != 1) {
+    return false;
+  }
+  const Expr* extent = IRSimplifier::simplify(
+      new Sub(reduction_for->stop(), reduction_for->start()));
+  if (!extent->isConstant() || immediateAs<int>(extent) <= lanes ||
+      immediateAs<int>(extent) % lanes != 0) {
+    return false;
+  }
+
+  // for j_inner
+  //   for j_outer
+  //     X[i] = ReduceOp(X[i] + Y[i, 8 * j_outer + j_inner], ...)
+  For* outer = nullptr;
+  For* inner = nullptr;
+  splitWithMask(reduction_for, lanes, &outer, &inner);
+  reorderAxis(outer, inner);
+
+  reduction_store = findReductionStore(getAllWritesToBuf(buf));
+  TORCH_INTERNAL_ASSERT(reduction_store);
+  For* lanes_for = getParentLoop(getParentLoop(reduction_store));
+  TORCH_INTERNAL_ASSERT(lanes_for && lanes_for->var() == inner->var());
+
+  Buf* rfac_buf = nullptr;
+  if (!rfactor(reduction_store, lanes_for, &rfac_buf)) {
+    return false;
+  }
+
+  // Give the init, the accumulation and the final reduction a loop each, and
+  // vectorize the first two.
+  std::vector<For*> loops = distributeLoop(lanes_for);
+  TORCH_INTERNAL_ASSERT(loops.size() == 3);
+  vectorize(loops[0]);
+  vectorize(loops[1]);
+  return true;
+}
+
 } // namespace tensorexpr
 } // namespace jit
 } // namespace torch
@@ -101,6 +101,17 @@ class TORCH_API LoopNest {
       For** inner,
       For** tail);
 
+  // Splits f into num_chunks chunks of consecutive iterations that run in
+  // parallel on the ATen intra-op thread pool, followed by a tail of fewer
+  // than num_chunks iterations. The iterations of f must be independent and
+  // its trip count constant. Only the LLVM backend runs parallel loops.
+  static void parallelizeWithTail(
+      For* f,
+      int num_chunks,
+      For** outer,
+      For** inner,
+      For** tail);
+
   static void splitWithMask(For* f, int factor);
   static void splitWithMask(For* f, int factor, For** outer, For** inner);
 
@@ -304,6 +315,31 @@ class TORCH_API LoopNest {
   bool rfactor(Stmt* s, For* outer_reduction_for);
   bool rfactor(Stmt* s, For* outer_reduction_for, Buf** rfac_buf_ptr);
 
+  // Vectorizes the reduction into buf over its reduction axis. The axis is
+  // split by lanes and rfactored, so that lanes partial results are
+  // accumulated side by side in a vector and combined at the end:
+  //
+  // Original IR:
+  //   for i
+  //     X[i] = 0
+  //     for j             # reduction axis, 0 <= j < 16
+  //       X[i] = ReduceOp(X[i] + Y[i,j], reduce_axis={j})
+  //
+  // After vectorizeReduction(X, 8)
+  //   for i
+  //     X[i] = 0
+  //     X_rfac[i, Ramp(0, 1, 8)] = Broadcast(0, 8)
+  //     for j_outer
+  //       X_rfac[i, Ramp(0, 1, 8)] = ReduceOp(X_rfac[i, Ramp(0, 1, 8)] +
+  //           Y[i, Ramp(8 * j_outer, 1, 8)], reduce_axis={j_outer})
+  //     for j_inner
+  //       X[i] = ReduceOp(X[i] + X_rfac[i,j_inner], reduce_axis={j_inner})
+  //
+  // This only applies to reductions over a single axis whose extent is a
+  // constant multiple of lanes; returns false, leaving the loops unchanged, on
+  // anything else.
+  bool vectorizeReduction(const Buf* buf, int lanes);
+
   void setBufferMap(
       For* f,
       const std::unordered_map<std::string, const Buf*>& map);
@@ -17,15 +17,40 @@ void initThroughputBenchmarkBindings(PyObject* module) {
       .def_readwrite("num_worker_threads", &BenchmarkConfig::num_worker_threads)
       .def_readwrite("num_warmup_iters", &BenchmarkConfig::num_warmup_iters)
       .def_readwrite("num_iters", &BenchmarkConfig::num_iters)
-      .def_readwrite("profiler_output_path", &BenchmarkConfig::profiler_output_path);
+      .def_readwrite("profiler_output_path", &BenchmarkConfig::profiler_output_path)
+      .def_readwrite(
+          "static_runtime_max_batch_size",
+          &BenchmarkConfig::static_runtime_max_batch_size)
+      .def_readwrite(
+          "static_runtime_max_batch_delay_us",
+          &BenchmarkConfig::static_runtime_max_batch_delay_us)
+      .def_readwrite("arrival_qps", &BenchmarkConfig::arrival_qps);
 
   py::class_<BenchmarkExecutionStats>(m, "BenchmarkExecutionStats")
       .def_readonly("latency_avg_ms", &BenchmarkExecutionStats::latency_avg_ms)
-      .def_readonly("num_iters", &BenchmarkExecutionStats::num_iters);
+      .def_readonly("num_iters", &BenchmarkExecutionStats::num_iters)
+      .def_readonly("total_time_ms", &BenchmarkExecutionStats::total_time_ms)
+      .def_readonly("latency_p50_ms", &BenchmarkExecutionStats::latency_p50_ms)
+      .def_readonly("latency_p90_ms", &BenchmarkExecutionStats::latency_p90_ms)
+      .def_readonly("latency_p99_ms", &BenchmarkExecutionStats::latency_p99_ms)
+      .def_readonly("latency_max_ms", &BenchmarkExecutionStats::latency_max_ms)
+      .def_readonly(
+          "latency_histogram_bounds_ms",
+          &BenchmarkExecutionStats::latency_histogram_bounds_ms)
+      .def_readonly(
+          "latency_histogram_counts",
+          &BenchmarkExecutionStats::latency_histogram_counts);
+
+  py::class_<MultiModelExecutionStats>(m, "MultiModelExecutionStats")
+      .def_readonly("total", &MultiModelExecutionStats::total)
+      .def_readonly("models", &MultiModelExecutionStats::models);
 
   py::class_<ThroughputBenchmark>(m, "ThroughputBenchmark", py::dynamic_attr())
       .def(py::init<jit::Module>())
+      // Before py::object, which would accept a LiteScriptModule as well
+      .def(py::init<jit::mobile::Module>())
       .def(py::init<py::object>())
+      .def("enable_static_runtime", &ThroughputBenchmark::enableStaticRuntime)
       .def(
           "add_input",
           [](ThroughputBenchmark& self, py::args args, py::kwargs kwargs) {
@@ -46,6 +71,18 @@ void initThroughputBenchmarkBindings(PyObject* module) {
         return self.benchmark(config);
       });
 
+  py::class_<MultiModelBenchmark>(m, "MultiModelBenchmark")
+      .def(py::init<>())
+      .def(
+          "add_model",
+          &MultiModelBenchmark::addModel,
+          py::keep_alive<1, 2>())
+      .def("benchmark", [](MultiModelBenchmark& self, BenchmarkConfig config) {
+        // See ThroughputBenchmark.benchmark
+        pybind11::gil_scoped_release no_gil_guard;
+        return self.benchmark(config);
+      });
+
 
 }
 
@@ -1015,6 +1015,49 @@ void PythonArgParser::check_deprecated(const FunctionSignature & signature) {
   }
 }
 
+// Note [Signature dispatch cache]
+// For overloaded functions, raw_parse tries every signature in order until
+// one accepts the arguments, which for e.g. Tensor.add or Tensor.to means
+// several failed matches on every call. Whether a signature accepts a
+// positional argument only depends on the argument's Python type for the
+// builtin types below, and additionally on the dim, numel, requires_grad and
+// integral-ness for tensors (see FunctionParameter::check). So for calls
+// whose positional arguments all have such types, and no keyword arguments,
+// we remember the first signature that matched and go straight to it.
+// Sequences (e.g. int lists) are value dependent and never cached.
+// The cache is only accessed with the GIL held, and stops growing at
+// kMaxDispatchCacheSize entries.
+bool PythonArgParser::dispatch_key(PyObject* args, PyObject* kwargs, DispatchKey& key) {
+  if (kwargs && PyDict_Size(kwargs) > 0) {
+    return false;
+  }
+  auto nargs = args ? PyTuple_GET_SIZE(args) : 0;
+  if (nargs > static_cast<ssize_t>(kMaxCachedArgs)) {
+    return false;
+  }
+  key.fill(0);
+  key[0] = nargs;
+  for (ssize_t i = 0; i < nargs; i++) {
+    PyObject* obj = PyTuple_GET_ITEM(args, i);
+    PyTypeObject* type = Py_TYPE(obj);
+    key[2 * i + 1] = reinterpret_cast<uintptr_t>(type);
+    if (THPVariable_CheckTypeExact(type)) {
+      auto& var = ((THPVariable*)obj)->cdata;
+      // var-args int lists also accept one element tensors via __index__
+      key[2 * i + 2] = 1 | (var.dim() == 0) << 1 | (var.numel() == 1) << 2 |
+          var.requires_grad() << 3 |
+          at::isIntegralType(var.scalar_type(), /*includeBool=*/false) << 4;
+    } else if (!(type == &PyLong_Type || type == &PyFloat_Type ||
+                 type == &PyBool_Type || type == &PyComplex_Type ||
+                 type == &PyUnicode_Type || obj == Py_None ||
+                 THPDtype_Check(obj) || THPLayout_Check(obj) ||
+                 THPMemoryFormat_Check(obj) || THPDevice_Check(obj))) {
+      return false;
+    }
+  }
+  return true;
+}
+
 PythonArgs PythonArgParser::raw_parse(PyObject* self, PyObject* args, PyObject* kwargs, PyObject* parsed_args[]) {  // NOLINT
   if (signatures_.size() == 1) {
     auto& signature = signatures_[0];
@@ -1023,8 +1066,25 @@ PythonArgs PythonArgParser::raw_parse(PyObject* self, PyObject* args, PyObject*
     return PythonArgs(traceable, signature, parsed_args);
   }
 
-  for (auto& signature : signatures_) {
+  DispatchKey key;
+  bool cacheable = dispatch_key(args, kwargs, key);
+  if (cacheable) {
+    auto it = dispatch_cache_.find(key);
+    if (it != dispatch_cache_.end()) {
+      auto& signature = signatures_[it->second];
+      if (signature.parse(self, args, kwargs, parsed_args, false)) {
+        check_deprecated(signature);
+        return PythonArgs(traceable, signature, parsed_args);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < signatures_.size(); i++) {
+    auto& signature = signatures_[i];
     if (signature.parse(self, args, kwargs, parsed_args, false)) {
+      if (cacheable && dispatch_cache_.size() < kMaxDispatchCacheSize) {
+        dispatch_cache_.emplace(key, i);
+      }
       check_deprecated(signature);
       return PythonArgs(traceable, signature, parsed_args);
     }
@@ -66,12 +66,14 @@
 
 #include <ATen/ATen.h>
 #include <c10/util/Exception.h>
+#include <c10/util/hash.h>
 
 #include <array>
 #include <cstddef>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace torch {
@@ -117,7 +119,23 @@ private:
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,modernize-avoid-c-arrays)
   PythonArgs raw_parse(PyObject* self, PyObject* args, PyObject* kwargs, PyObject* parsed_args[]);
 
+  // See Note [Signature dispatch cache]
+  static constexpr size_t kMaxCachedArgs = 8;
+  static constexpr size_t kMaxDispatchCacheSize = 64;
+  using DispatchKey = std::array<uintptr_t, 2 * kMaxCachedArgs + 1>;
+  struct DispatchKeyHash {
+    size_t operator()(const DispatchKey& key) const {
+      size_t seed = 0;
+      for (auto v : key) {
+        seed = c10::hash_combine(seed, std::hash<uintptr_t>()(v));
+      }
+      return seed;
+    }
+  };
+  static bool dispatch_key(PyObject* args, PyObject* kwargs, DispatchKey& key);
+
   std::vector<FunctionSignature> signatures_;
+  std::unordered_map<DispatchKey, size_t, DispatchKeyHash> dispatch_cache_;
   std::string function_name;
   ssize_t max_args;
   bool traceable;
@@ -0,0 +1,196 @@
+#include <torch/csrc/utils/static_module_batcher.h>
+
+#include <ATen/ATen.h>
+#include <c10/core/InferenceMode.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+const StaticModule& checkModule(const std::shared_ptr<StaticModule>& module) {
+  TORCH_CHECK(module, "StaticModuleBatcher: module must not be null");
+  return *module;
+}
+
+} // namespace
+
+StaticModuleBatcher::StaticModuleBatcher(
+    std::shared_ptr<StaticModule> module,
+    StaticModuleBatcherOptions opts)
+    : module_(std::move(module)),
+      opts_(opts),
+      runtime_(checkModule(module_)) {
+  TORCH_CHECK(
+      opts_.max_batch_size > 0,
+      "StaticModuleBatcher: max_batch_size must be positive, got ",
+      opts_.max_batch_size);
+  TORCH_CHECK(
+      opts_.batch_dim >= 0,
+      "StaticModuleBatcher: batch_dim must be non-negative, got ",
+      opts_.batch_dim);
+  worker_ = std::thread([this] { loop(); });
+}
+
+StaticModuleBatcher::~StaticModuleBatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> StaticModuleBatcher::run(
+    std::vector<at::Tensor> inputs) {
+  TORCH_CHECK(!inputs.empty(), "StaticModuleBatcher: expected inputs");
+  const int64_t batch_size = inputs[0].dim() > opts_.batch_dim
+      ? inputs[0].size(opts_.batch_dim)
+      : -1;
+  for (const auto& input : inputs) {
+    TORCH_CHECK(
+        input.dim() > opts_.batch_dim &&
+            input.size(opts_.batch_dim) == batch_size,
+        "StaticModuleBatcher: expected all inputs to have the same size along "
+        "dim ",
+        opts_.batch_dim,
+        ", got an input of sizes ",
+        input.sizes());
+  }
+
+  auto future = c10::make_intrusive<c10::ivalue::Future>(ListType::ofTensors());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TORCH_CHECK(!stop_, "StaticModuleBatcher: the batcher is shutting down");
+    pending_.push_back(Request{
+        std::move(inputs),
+        batch_size,
+        future,
+        std::chrono::steady_clock::now()});
+    pending_rows_ += batch_size;
+  }
+  cv_.notify_one();
+  return future;
+}
+
+std::vector<at::Tensor> StaticModuleBatcher::operator()(
+    std::vector<at::Tensor> inputs) {
+  auto future = run(std::move(inputs));
+  future->wait();
+  return future->value().toTensorVector();
+}
+
+int64_t StaticModuleBatcher::num_runs() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_runs_;
+}
+
+int64_t StaticModuleBatcher::num_requests() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_requests_;
+}
+
+void StaticModuleBatcher::loop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+    if (pending_.empty()) {
+      return;
+    }
+    // give the oldest request max_delay to find company
+    cv_.wait_until(lock, pending_.front().enqueued + opts_.max_delay, [this] {
+      return stop_ || pending_rows_ >= opts_.max_batch_size;
+    });
+
+    std::vector<Request> batch;
+    int64_t rows = 0;
+    while (!pending_.empty() &&
+           (batch.empty() ||
+            rows + pending_.front().batch_size <= opts_.max_batch_size)) {
+      rows += pending_.front().batch_size;
+      pending_rows_ -= pending_.front().batch_size;
+      batch.push_back(std::move(pending_.front()));
+      pending_.pop_front();
+    }
+    num_runs_++;
+    num_requests_ += batch.size();
+
+    lock.unlock();
+    runBatch(batch);
+    lock.lock();
+  }
+}
+
+void StaticModuleBatcher::runAlone(Request& request) {
+  try {
+    auto outputs = runtime_(request.inputs);
+    request.future->markCompleted(c10::IValue(std::move(outputs)));
+  } catch (...) {
+    request.future->setError(std::current_exception());
+  }
+}
+
+void StaticModuleBatcher::runBatch(std::vector<Request>& batch) {
+  if (batch.size() == 1) {
+    runAlone(batch[0]);
+    return;
+  }
+
+  c10::InferenceMode mode;
+  std::vector<int64_t> batch_sizes;
+  int64_t rows = 0;
+  for (const auto& request : batch) {
+    batch_sizes.push_back(request.batch_size);
+    rows += request.batch_size;
+  }
+
+  std::vector<at::Tensor> outputs;
+  try {
+    const size_t num_inputs = batch[0].inputs.size();
+    std::vector<at::Tensor> inputs;
+    inputs.reserve(num_inputs);
+    for (size_t i = 0; i < num_inputs; ++i) {
+      std::vector<at::Tensor> parts;
+      parts.reserve(batch.size());
+      for (const auto& request : batch) {
+        TORCH_CHECK(
+            request.inputs.size() == num_inputs,
+            "StaticModuleBatcher: requests have different numbers of inputs");
+        parts.push_back(request.inputs[i]);
+      }
+      inputs.push_back(at::cat(parts, opts_.batch_dim));
+    }
+    outputs = runtime_(inputs);
+    for (const auto& output : outputs) {
+      TORCH_CHECK(
+          output.dim() > opts_.batch_dim &&
+              output.size(opts_.batch_dim) == rows,
+          "StaticModuleBatcher: expected the outputs to have ",
+          rows,
+          " rows along dim ",
+          opts_.batch_dim,
+          ", got an output of sizes ",
+          output.sizes());
+    }
+  } catch (...) {
+    // some requests can't go together, or fail on their own
+    for (auto& request : batch) {
+      runAlone(request);
+    }
+    return;
+  }
+
+  std::vector<std::vector<at::Tensor>> results(batch.size());
+  for (const auto& output : outputs) {
+    auto parts = output.split_with_sizes(batch_sizes, opts_.batch_dim);
+    for (size_t r = 0; r < batch.size(); ++r) {
+      results[r].push_back(std::move(parts[r]));
+    }
+  }
+  for (size_t r = 0; r < batch.size(); ++r) {
+    batch[r].future->markCompleted(c10::IValue(std::move(results[r])));
+  }
+}
+
+} // namespace jit
+} // namespace torch
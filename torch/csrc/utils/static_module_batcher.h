@@ -0,0 +1,99 @@
+#pragma once
+
+#include <ATen/core/ivalue.h>
+#include <torch/csrc/jit/runtime/static/impl.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+struct TORCH_API StaticModuleBatcherOptions {
+  // Largest batch, in rows along batch_dim, a run coalesces requests into.
+  // A larger request still runs, alone.
+  int64_t max_batch_size{32};
+  // How long the oldest pending request waits for more requests before the
+  // batch runs anyway
+  std::chrono::microseconds max_delay{1000};
+  // Dimension of the inputs and outputs requests are concatenated along
+  int64_t batch_dim{0};
+};
+
+/**
+ * Coalesces concurrent calls to a StaticModule into batched runs, for
+ * serving workloads whose requests are too small to use the machine well,
+ * e.g. GEMMs with a handful of rows.
+ *
+ * run() queues a request and returns a future. A worker thread owning its
+ * own StaticRuntime takes the pending requests once they add up to
+ * max_batch_size rows, or once the oldest one waited max_delay, concatenates
+ * each input along batch_dim, runs the module once, and splits each output
+ * along batch_dim back into the futures. All Tensor inputs and outputs must
+ * have the batch dimension, with the size of the request along it, and the
+ * model must treat the rows independently. If a batch fails, e.g. because
+ * the other dimensions of its requests differ, its requests are run one by
+ * one so only the faulty ones fail.
+ *
+ * The outputs delivered to a request are views into the outputs of the
+ * batched run.
+ */
+class TORCH_API StaticModuleBatcher {
+ public:
+  explicit StaticModuleBatcher(
+      std::shared_ptr<StaticModule> module,
+      StaticModuleBatcherOptions opts = StaticModuleBatcherOptions());
+  // Runs the pending requests, then stops the worker
+  ~StaticModuleBatcher();
+
+  StaticModuleBatcher(const StaticModuleBatcher&) = delete;
+  StaticModuleBatcher& operator=(const StaticModuleBatcher&) = delete;
+
+  // The future completes with the list of the outputs of the request
+  c10::intrusive_ptr<c10::ivalue::Future> run(std::vector<at::Tensor> inputs);
+
+  // Blocking version of run()
+  std::vector<at::Tensor> operator()(std::vector<at::Tensor> inputs);
+
+  const StaticModuleBatcherOptions& opts() const {
+    return opts_;
+  }
+
+  // batched runs and requests served so far
+  int64_t num_runs() const;
+  int64_t num_requests() const;
+
+ private:
+  struct Request {
+    std::vector<at::Tensor> inputs;
+    int64_t batch_size;
+    c10::intrusive_ptr<c10::ivalue::Future> future;
+    std::chrono::steady_clock::time_point enqueued;
+  };
+
+  void loop();
+  void runBatch(std::vector<Request>& batch);
+  void runAlone(Request& request);
+
+  const std::shared_ptr<StaticModule> module_;
+  const StaticModuleBatcherOptions opts_;
+  // only used by the worker thread
+  StaticRuntime runtime_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Request> pending_; // guarded by mutex_
+  int64_t pending_rows_{0}; // guarded by mutex_
+  bool stop_{false}; // guarded by mutex_
+  int64_t num_runs_{0}; // guarded by mutex_
+  int64_t num_requests_{0}; // guarded by mutex_
+  std::thread worker_;
+};
+
+} // namespace jit
+} // namespace torch
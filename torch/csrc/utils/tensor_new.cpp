@@ -25,7 +25,10 @@
 #include <c10/util/irange.h>
 #include <c10/util/Optional.h>
 
+#include <cstring>
+#include <memory>
 #include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 using at::Backend;
@@ -197,6 +200,165 @@ void recursive_store(char* data, IntArrayRef sizes, IntArrayRef strides, int64_t
   }
 }
 
+// Note [Fast paths for tensors from Python data]
+// recursive_store goes through PySequence_Fast and store_scalar for every
+// element, after compute_sizes and infer_scalar_type each walked the data.
+// For the two common cases of large inputs we avoid most of that:
+//  - 1-d array.array, memoryview, bytes and bytearray objects whose buffer
+//    has a native numeric format are copied directly from the buffer.
+//  - nested lists/tuples with only Python floats and ints as leaves are
+//    validated in one pass over the pointers (shape and whether any float
+//    is present, which is all type inference can conclude for them) and
+//    then written with type-specialized stores.
+// Both produce exactly what the generic path would, including the inferred
+// dtype; anything they don't handle (or would raise on) goes through the
+// generic path.
+
+c10::optional<ScalarType> buffer_format_scalar_type(const Py_buffer& view) {
+  const char* format = view.format ? view.format : "B";
+  if (format[0] == '@') {
+    format++;
+  }
+  if (format[0] == '\0' || format[1] != '\0') {
+    return c10::nullopt;
+  }
+  switch (format[0]) {
+    case 'f': return view.itemsize == 4 ? c10::make_optional(ScalarType::Float) : c10::nullopt;
+    case 'd': return view.itemsize == 8 ? c10::make_optional(ScalarType::Double) : c10::nullopt;
+    case '?': return view.itemsize == 1 ? c10::make_optional(ScalarType::Bool) : c10::nullopt;
+    case 'B': return view.itemsize == 1 ? c10::make_optional(ScalarType::Byte) : c10::nullopt;
+    case 'b': case 'h': case 'i': case 'l': case 'q':
+      switch (view.itemsize) {
+        case 1: return ScalarType::Char;
+        case 2: return ScalarType::Short;
+        case 4: return ScalarType::Int;
+        case 8: return ScalarType::Long;
+      }
+  }
+  return c10::nullopt;
+}
+
+Tensor new_from_buffer(PyObject* data, ScalarType scalar_type, bool type_inference, bool pin_memory) {
+  if (!(PyMemoryView_Check(data) || PyBytes_CheckExact(data) || PyByteArray_CheckExact(data) ||
+        strcmp(Py_TYPE(data)->tp_name, "array.array") == 0)) {
+    return Tensor();
+  }
+  Py_buffer view;
+  if (PyObject_GetBuffer(data, &view, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) != 0) {
+    PyErr_Clear();
+    return Tensor();
+  }
+  std::unique_ptr<Py_buffer, decltype(&PyBuffer_Release)> view_guard(&view, &PyBuffer_Release);
+  auto buffer_scalar_type = buffer_format_scalar_type(view);
+  if (view.ndim != 1 || !buffer_scalar_type) {
+    return Tensor();
+  }
+  // the elements are Python floats, ints or bools to the generic path
+  bool is_floating = at::isFloatingType(*buffer_scalar_type);
+  if (type_inference) {
+    scalar_type = is_floating ? torch::tensors::get_default_scalar_type() :
+        *buffer_scalar_type == ScalarType::Bool ? ScalarType::Bool : ScalarType::Long;
+  } else if (is_floating && !(at::isFloatingType(scalar_type) || at::isComplexType(scalar_type))) {
+    // store_scalar refuses to convert floats to integers
+    return Tensor();
+  }
+  auto tensor = at::empty({view.shape[0]}, at::initialTensorOptions().dtype(scalar_type).pinned_memory(pin_memory));
+  tensor.copy_(at::from_blob(view.buf, {view.shape[0]}, at::initialTensorOptions().dtype(*buffer_scalar_type)));
+  return tensor;
+}
+
+inline bool is_fast_number(PyObject* obj) {
+  return PyFloat_CheckExact(obj) || PyLong_CheckExact(obj);
+}
+
+inline bool is_fast_sequence(PyObject* obj) {
+  return PyList_CheckExact(obj) || PyTuple_CheckExact(obj);
+}
+
+inline Py_ssize_t fast_sequence_size(PyObject* obj) {
+  return PyList_CheckExact(obj) ? PyList_GET_SIZE(obj) : PyTuple_GET_SIZE(obj);
+}
+
+inline PyObject** fast_sequence_items(PyObject* obj) {
+  return PyList_CheckExact(obj) ? ((PyListObject*)obj)->ob_item : ((PyTupleObject*)obj)->ob_item;
+}
+
+// Checks that obj is a nested list/tuple of exactly `sizes` with float/int
+// leaves, and records whether any leaf is a float.
+bool check_number_sequence(PyObject* obj, IntArrayRef sizes, int64_t dim, bool& has_float) {
+  if (!is_fast_sequence(obj) || fast_sequence_size(obj) != sizes[dim]) {
+    return false;
+  }
+  PyObject** items = fast_sequence_items(obj);
+  if (dim + 1 == static_cast<int64_t>(sizes.size())) {
+    for (int64_t i = 0; i < sizes[dim]; i++) {
+      if (PyFloat_CheckExact(items[i])) {
+        has_float = true;
+      } else if (!PyLong_CheckExact(items[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+  for (int64_t i = 0; i < sizes[dim]; i++) {
+    if (!check_number_sequence(items[i], sizes, dim + 1, has_float)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename scalar_t>
+scalar_t* store_number_sequence(scalar_t* data, IntArrayRef sizes, int64_t dim, PyObject* obj) {
+  PyObject** items = fast_sequence_items(obj);
+  if (dim + 1 == static_cast<int64_t>(sizes.size())) {
+    for (int64_t i = 0; i < sizes[dim]; i++) {
+      PyObject* item = items[i];
+      if (std::is_floating_point<scalar_t>::value) {
+        *data++ = static_cast<scalar_t>(PyFloat_CheckExact(item) ?
+            PyFloat_AS_DOUBLE(item) : THPUtils_unpackDouble(item));
+      } else {
+        *data++ = static_cast<scalar_t>(THPUtils_unpackLong(item));
+      }
+    }
+    return data;
+  }
+  for (int64_t i = 0; i < sizes[dim]; i++) {
+    data = store_number_sequence(data, sizes, dim + 1, items[i]);
+  }
+  return data;
+}
+
+Tensor new_from_number_sequence(PyObject* data, ScalarType scalar_type, bool type_inference, bool pin_memory) {
+  std::vector<int64_t> sizes;
+  for (PyObject* seq = data; is_fast_sequence(seq); seq = fast_sequence_items(seq)[0]) {
+    sizes.push_back(fast_sequence_size(seq));
+    if (sizes.back() == 0 || sizes.size() > MAX_DIMS) {
+      return Tensor();
+    }
+  }
+  bool has_float = false;
+  if (sizes.empty() || !check_number_sequence(data, sizes, 0, has_float)) {
+    return Tensor();
+  }
+  if (type_inference) {
+    scalar_type = has_float ? torch::tensors::get_default_scalar_type() : ScalarType::Long;
+  }
+  if (!(scalar_type == ScalarType::Float || scalar_type == ScalarType::Double ||
+        (!has_float && (scalar_type == ScalarType::Long || scalar_type == ScalarType::Int)))) {
+    return Tensor();
+  }
+  auto tensor = at::empty(sizes, at::initialTensorOptions().dtype(scalar_type).pinned_memory(pin_memory));
+  switch (scalar_type) {
+    case ScalarType::Float: store_number_sequence(tensor.data_ptr<float>(), sizes, 0, data); break;
+    case ScalarType::Double: store_number_sequence(tensor.data_ptr<double>(), sizes, 0, data); break;
+    case ScalarType::Long: store_number_sequence(tensor.data_ptr<int64_t>(), sizes, 0, data); break;
+    case ScalarType::Int: store_number_sequence(tensor.data_ptr<int32_t>(), sizes, 0, data); break;
+    default: TORCH_INTERNAL_ASSERT(false);
+  }
+  return tensor;
+}
+
 Tensor internal_new_from_data(
     c10::TensorOptions options,
     at::ScalarType scalar_type,
@@ -248,8 +410,6 @@ Tensor internal_new_from_data(
   }
 #endif
 
-  auto sizes = compute_sizes(data);
-  ScalarType inferred_scalar_type = type_inference ? infer_scalar_type(data) : scalar_type;
   // This exists to prevent us from tracing the call to empty().  The actual
   // autograd code doesn't really matter, because requires_grad is always false
   // here.
@@ -257,11 +417,21 @@ Tensor internal_new_from_data(
   {
     at::AutoNonVariableTypeMode guard;  // TODO: remove
     at::tracer::impl::NoTracerDispatchMode tracer_guard;
-    tensor = at::empty(sizes, at::initialTensorOptions().dtype(inferred_scalar_type).pinned_memory(pin_memory));
-    recursive_store(
-        (char*)tensor.data_ptr(), tensor.sizes(), tensor.strides(), 0,
-        inferred_scalar_type, tensor.dtype().itemsize(), data);
+    // See Note [Fast paths for tensors from Python data]
+    tensor = new_from_buffer(data, scalar_type, type_inference, pin_memory);
+    if (!tensor.defined()) {
+      tensor = new_from_number_sequence(data, scalar_type, type_inference, pin_memory);
+    }
+    if (!tensor.defined()) {
+      auto sizes = compute_sizes(data);
+      ScalarType inferred_scalar_type = type_inference ? infer_scalar_type(data) : scalar_type;
+      tensor = at::empty(sizes, at::initialTensorOptions().dtype(inferred_scalar_type).pinned_memory(pin_memory));
+      recursive_store(
+          (char*)tensor.data_ptr(), tensor.sizes(), tensor.strides(), 0,
+          inferred_scalar_type, tensor.dtype().itemsize(), data);
+    }
   }
+  ScalarType inferred_scalar_type = tensor.scalar_type();
   auto device = device_opt.has_value() ? *device_opt : options.device();
   pybind11::gil_scoped_release no_gil;
   maybe_initialize_cuda(device);
@@ -658,6 +828,43 @@ Tensor sparse_csr_tensor_ctor(c10::DispatchKey dispatch_key, at::ScalarType scal
   throw std::runtime_error("sparse_csr_tensor(): invalid arguments");
 }
 
+Tensor sparse_bsr_tensor_ctor(c10::DispatchKey dispatch_key, at::ScalarType scalar_type, PyObject* args, PyObject* kwargs) {
+  TORCH_INTERNAL_ASSERT(!isSparseCsr(dispatchKeyToBackend(dispatch_key)));
+  static PythonArgParser parser({
+      "sparse_bsr_tensor(PyObject* crow_indices, PyObject* col_indices, PyObject* values, IntArrayRef size, *, ScalarType dtype=None, Layout? layout=None, Device? device=None, bool pin_memory=False, bool requires_grad=False)",
+  });
+  const int NUM_ARGS = 9, CROW_INDICES_ARG = 0, COL_INDICES_ARG = 1, VALUES_ARG = 2, SIZE_ARRAY_ARG = 3,
+            TYPE_INFERENCE_ARG = 4, DEVICE_TYPE_ARG = 7, REQ_GRAD_ARG = 8;
+  ParsedArgs<NUM_ARGS> parsed_args;
+  auto r = parser.parse(args, kwargs, parsed_args);
+  THPObjectPtr crow_indices_dtype_attr(PyObject_GetAttrString(r.pyobject(CROW_INDICES_ARG), "dtype"));
+  THPObjectPtr col_indices_dtype_attr(PyObject_GetAttrString(r.pyobject(COL_INDICES_ARG), "dtype"));
+  at::ScalarType crow_indices_scalar_type = reinterpret_cast<THPDtype*>(
+    crow_indices_dtype_attr.get())->scalar_type;
+  at::ScalarType col_indices_scalar_type = reinterpret_cast<THPDtype*>(
+    col_indices_dtype_attr.get())->scalar_type;
+
+  bool type_inference = r.isNone(TYPE_INFERENCE_ARG);
+  const auto inferred_options = typeIdWithDefault(r, DEVICE_TYPE_ARG, dispatch_key);
+  const auto inferred_scalar_type = r.scalartypeWithDefault(TYPE_INFERENCE_ARG, scalar_type);
+  at::OptionalDeviceGuard device_guard(r.deviceOptional(DEVICE_TYPE_ARG));
+
+  Tensor values = internal_new_from_data(inferred_options, inferred_scalar_type, r.deviceOptional(DEVICE_TYPE_ARG),
+                                         r.pyobject(VALUES_ARG), /*copy_variables=*/false, /*copy_numpy=*/true,
+                                         /*type_inference=*/type_inference);
+  Tensor crow_indices = internal_new_from_data(values.options(),
+    crow_indices_scalar_type, r.deviceOptional(DEVICE_TYPE_ARG), r.pyobject(CROW_INDICES_ARG),
+    /*copy_variables=*/false, /*copy_numpy=*/true,
+    /*type_inference=*/false);
+  Tensor col_indices = internal_new_from_data(values.options(),
+    col_indices_scalar_type, r.deviceOptional(DEVICE_TYPE_ARG), r.pyobject(COL_INDICES_ARG),
+    /*copy_variables=*/false, /*copy_numpy=*/true,
+    /*type_inference=*/false);
+
+  return at::sparse_bsr_tensor(crow_indices, col_indices, values, r.intlist(SIZE_ARRAY_ARG),
+                               values.options().layout(at::kSparseBsr)).set_requires_grad(r.toBool(REQ_GRAD_ARG));
+}
+
 // Note [Ensuring sparse values and indices match devices]
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 // In all places where we construct indices, we read out options from values
@@ -1,20 +1,42 @@
 #include <torch/csrc/utils/throughput_benchmark.h>
 
 #include <pybind11/pybind11.h>
+#include <torch/csrc/autograd/profiler.h>
 #include <torch/csrc/jit/python/pybind_utils.h>
 
+#include <ATen/Parallel.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 namespace torch {
 namespace throughput_benchmark {
 
 std::ostream& operator<<(std::ostream& os, const BenchmarkExecutionStats& value) {
     return os << "Average latency / iter (ms): " << value.latency_avg_ms
+              << "\n Latency p50 / p90 / p99 (ms): " << value.latency_p50_ms
+              << " / " << value.latency_p90_ms << " / " << value.latency_p99_ms
               << "\n Total number of iters: " << value.num_iters;
 }
 
+void ThroughputBenchmark::checkInitialized() const {
+  CHECK_EQ(
+      script_module_.initialized() + mobile_module_.initialized() +
+          module_.initialized(),
+      1);
+}
+
 void ThroughputBenchmark::addInput(py::args args, py::kwargs kwargs) {
-  CHECK(script_module_.initialized() ^ module_.initialized());
+  checkInitialized();
   if (script_module_.initialized()) {
     script_module_.addInput(std::move(args), std::move(kwargs));
+  } else if (mobile_module_.initialized()) {
+    mobile_module_.addInput(std::move(args), std::move(kwargs));
   } else {
     CHECK(module_.initialized());
     module_.addInput(std::move(args), std::move(kwargs));
@@ -22,14 +44,34 @@ void ThroughputBenchmark::addInput(py::args args, py::kwargs kwargs) {
 }
 
 py::object ThroughputBenchmark::runOnce(py::args&& args, py::kwargs&& kwargs)  {
-  CHECK(script_module_.initialized() ^ module_.initialized());
-  if (script_module_.initialized()) {
+  checkInitialized();
+  if (script_module_.initialized() && static_module_) {
+    auto stack = jit::createStackForSchema(
+        script_module_.model_.get_method("forward").function().getSchema(),
+        std::move(args),
+        std::move(kwargs),
+        script_module_.model_._ivalue());
+    stack.erase(stack.begin());
+    c10::IValue result;
+    {
+      pybind11::gil_scoped_release no_gil_guard;
+      result = (*static_module_)(stack, {});
+    }
+    return jit::toPyObject(std::move(result));
+  } else if (script_module_.initialized()) {
     c10::IValue result;
     {
       pybind11::gil_scoped_release no_gil_guard;
       result = script_module_.runOnce(std::move(args), std::move(kwargs));
     }
     return jit::toPyObject(std::move(result));
+  } else if (mobile_module_.initialized()) {
+    c10::IValue result;
+    {
+      pybind11::gil_scoped_release no_gil_guard;
+      result = mobile_module_.runOnce(std::move(args), std::move(kwargs));
+    }
+    return jit::toPyObject(std::move(result));
   } else {
     CHECK(module_.initialized());
     return module_.runOnce(std::move(args), std::move(kwargs));
@@ -40,29 +82,333 @@ ThroughputBenchmark::ThroughputBenchmark(
     jit::Module script_module)
     : script_module_(script_module) {}
 
+ThroughputBenchmark::ThroughputBenchmark(
+    jit::mobile::Module mobile_module)
+    : mobile_module_(
+          std::make_shared<jit::mobile::Module>(std::move(mobile_module))) {}
+
 ThroughputBenchmark::ThroughputBenchmark(
     py::object module)
     : module_(std::move(module)) {}
 
-BenchmarkExecutionStats ThroughputBenchmark::benchmark(
+void ThroughputBenchmark::enableStaticRuntime() {
+  TORCH_CHECK(
+      script_module_.initialized(),
+      "Static Runtime can only run a ScriptModule");
+  if (!static_module_) {
+    static_module_ = std::make_shared<jit::StaticModule>(script_module_.model_);
+  }
+}
+
+detail::CallSampler ThroughputBenchmark::sampler(
     const BenchmarkConfig& config) const {
-  CHECK(script_module_.initialized() ^ module_.initialized());
-  // Main benchmark thread doesn't hold the GIL after scheduling worker threads
-  // But for now we don't release it as we will be implicitly manipulating with
-  // py::object ref. counts in the case of nn.Module benchmarking.
+  checkInitialized();
   if (script_module_.initialized()) {
-    return script_module_.benchmark(config);
+    TORCH_CHECK(
+        !script_module_.inputs_.empty(),
+        "Please provide benchmark inputs."
+        "Did you forget to call add_input()? ");
+    if (config.static_runtime_max_batch_size > 0) {
+      jit::StaticModuleBatcherOptions opts;
+      opts.max_batch_size = config.static_runtime_max_batch_size;
+      opts.max_delay =
+          std::chrono::microseconds(config.static_runtime_max_batch_delay_us);
+      auto batcher = std::make_shared<detail::StaticModuleBatcherBenchmark>(
+          std::make_shared<jit::StaticModuleBatcher>(
+              static_module_
+                  ? static_module_
+                  : std::make_shared<jit::StaticModule>(script_module_.model_),
+              opts));
+      batcher->inputs_ = script_module_.inputs_;
+      return [batcher](std::mt19937& engine) {
+        return batcher->sampleCall(engine);
+      };
+    }
+    if (static_module_) {
+      auto runtime =
+          std::make_shared<detail::StaticModuleBenchmark>(static_module_);
+      runtime->inputs_ = script_module_.inputs_;
+      return [runtime](std::mt19937& engine) {
+        return runtime->sampleCall(engine);
+      };
+    }
+    return [this](std::mt19937& engine) {
+      return script_module_.sampleCall(engine);
+    };
+  } else if (mobile_module_.initialized()) {
+    TORCH_CHECK(
+        !mobile_module_.inputs_.empty(),
+        "Please provide benchmark inputs."
+        "Did you forget to call add_input()? ");
+    return [this](std::mt19937& engine) {
+      return mobile_module_.sampleCall(engine);
+    };
   } else {
     CHECK(module_.initialized());
+    TORCH_CHECK(
+        !module_.inputs_.empty(),
+        "Please provide benchmark inputs."
+        "Did you forget to call add_input()? ");
     TORCH_WARN("Starting benchmark on an nn.Module. This can be slow due "
     "to Python GIL.For proper inference simulation you might want to switch to "
     "a ScriptModule instead");
-    return module_.benchmark(config);
+    return [this](std::mt19937& engine) { return module_.sampleCall(engine); };
   }
 }
 
+BenchmarkExecutionStats ThroughputBenchmark::benchmark(
+    const BenchmarkConfig& config) const {
+  // Main benchmark thread doesn't hold the GIL after scheduling worker threads
+  // But for now we don't release it as we will be implicitly manipulating with
+  // py::object ref. counts in the case of nn.Module benchmarking.
+  return detail::runBenchmark(config, {sampler(config)}, {1.0}).total;
+}
+
+void MultiModelBenchmark::addModel(
+    const ThroughputBenchmark& benchmark,
+    double weight) {
+  TORCH_CHECK(weight > 0, "Expected a positive weight, but got ", weight);
+  models_.push_back(&benchmark);
+  weights_.push_back(weight);
+}
+
+MultiModelExecutionStats MultiModelBenchmark::benchmark(
+    const BenchmarkConfig& config) const {
+  TORCH_CHECK(
+      !models_.empty(),
+      "Please provide benchmark models. Did you forget to call add_model()? ");
+  std::vector<detail::CallSampler> samplers;
+  samplers.reserve(models_.size());
+  for (const auto* model : models_) {
+    samplers.push_back(model->sampler(config));
+  }
+  return detail::runBenchmark(config, samplers, weights_);
+}
+
 namespace detail {
 
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+float toMilliseconds(Clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+             .count() /
+      1000.0 / 1000.0;
+}
+
+BenchmarkExecutionStats latencyStats(
+    std::vector<float> latencies_ms,
+    float total_time_ms) {
+  BenchmarkExecutionStats stats;
+  stats.num_iters = latencies_ms.size();
+  stats.total_time_ms = total_time_ms;
+  if (latencies_ms.empty()) {
+    return stats;
+  }
+  std::sort(latencies_ms.begin(), latencies_ms.end());
+  double total_latency_ms = 0;
+  for (float latency_ms : latencies_ms) {
+    total_latency_ms += latency_ms;
+  }
+  stats.latency_avg_ms = total_latency_ms / latencies_ms.size();
+  // Nearest-rank percentiles
+  auto percentile = [&](double p) {
+    size_t rank = std::ceil(p * latencies_ms.size());
+    return latencies_ms[std::max<size_t>(rank, 1) - 1];
+  };
+  stats.latency_p50_ms = percentile(0.5);
+  stats.latency_p90_ms = percentile(0.9);
+  stats.latency_p99_ms = percentile(0.99);
+  stats.latency_max_ms = latencies_ms.back();
+
+  auto it = latencies_ms.begin();
+  for (float bound_ms = 0.01; it != latencies_ms.end(); bound_ms *= 2) {
+    auto next = std::upper_bound(it, latencies_ms.end(), bound_ms);
+    stats.latency_histogram_bounds_ms.push_back(bound_ms);
+    stats.latency_histogram_counts.push_back(next - it);
+    it = next;
+  }
+  return stats;
+}
+
+} // namespace
+
+MultiModelExecutionStats runBenchmark(
+    const BenchmarkConfig& config,
+    const std::vector<CallSampler>& samplers,
+    const std::vector<double>& weights) {
+  TORCH_CHECK(
+      config.num_worker_threads == 1,
+      "Only parallelization by callers is supported");
+  TORCH_CHECK(
+      config.arrival_qps >= 0,
+      "Expected a non-negative arrival_qps, but got ",
+      config.arrival_qps);
+  TORCH_INTERNAL_ASSERT(!samplers.empty());
+  TORCH_INTERNAL_ASSERT(samplers.size() == weights.size());
+
+  LOG(INFO) << at::get_parallel_info();
+
+  // We pre-generate calls here for each of the threads. This allows us to
+  // safely move inputs out for each of the threads independently and thus avoid
+  // overhead from the benchmark runner itself
+  const bool open_loop = config.arrival_qps > 0;
+  std::vector<std::vector<size_t>> thread_models(config.num_calling_threads);
+  std::vector<std::vector<BenchmarkCall>> thread_calls(
+      config.num_calling_threads);
+  // With an arrival rate, the time between the arrivals of consecutive
+  // measured calls of each thread. The arrivals of all the threads together
+  // then are a Poisson process of rate arrival_qps.
+  std::vector<std::vector<Clock::duration>> thread_gaps(
+      config.num_calling_threads);
+  std::vector<size_t> input_iters(config.num_calling_threads);
+  {
+    std::random_device seeder;
+    std::mt19937 engine(seeder());
+    std::discrete_distribution<size_t> pick_model(
+        weights.begin(), weights.end());
+    std::exponential_distribution<double> gap_s(
+        open_loop ? config.arrival_qps / config.num_calling_threads : 1.0);
+
+    for (int thread_id = 0; thread_id < config.num_calling_threads;
+         ++thread_id) {
+      // Just in case we generate num_iters inputs for each of the threads
+      // This was if one thread does all the work we will be fine
+      for (int i = 0; i < config.num_iters + config.num_warmup_iters; ++i) {
+        size_t model = pick_model(engine);
+        thread_models[thread_id].push_back(model);
+        thread_calls[thread_id].push_back(samplers[model](engine));
+        if (open_loop && i < config.num_iters) {
+          thread_gaps[thread_id].push_back(
+              std::chrono::duration_cast<Clock::duration>(
+                  std::chrono::duration<double>(gap_s(engine))));
+        }
+      }
+      input_iters[thread_id] = 0;
+    }
+  }
+
+  std::mutex m;
+  std::condition_variable worker_main_cv;
+  std::condition_variable main_worker_cv;
+  // TODO: add GUARDED_BY once it is available
+  int64_t initialized{0};
+  int64_t finished{0};
+  bool start{false};
+  Clock::time_point start_time;
+  std::atomic<int64_t> num_attempted_iters{0};
+  // The model and latency of each measured call, per thread
+  std::vector<std::vector<std::pair<size_t, float>>> thread_latencies(
+      config.num_calling_threads);
+  std::vector<std::thread> callers;
+
+  for (auto thread_id = 0; thread_id < config.num_calling_threads;
+       ++thread_id) {
+    callers.emplace_back([&, thread_id]() {
+      auto& calls = thread_calls[thread_id];
+      auto& iter = input_iters[thread_id];
+      // We use conditional variable as a barrier to make sure each thread
+      // performs required warmeup iterations before we start measuring
+      for (auto j = 0; j < config.num_warmup_iters; ++j) {
+        calls[iter]();
+        ++iter;
+      }
+      Clock::time_point arrival;
+      {
+        std::unique_lock<std::mutex> lock(m);
+        ++initialized;
+        worker_main_cv.notify_one();
+        while (!start) {
+          main_worker_cv.wait(lock);
+        }
+        arrival = start_time;
+      }
+      LOG(INFO) << "Starting forward thread " << thread_id;
+      auto& latencies = thread_latencies[thread_id];
+      latencies.reserve(config.num_iters);
+      size_t num_calls = 0;
+      while (num_attempted_iters.fetch_add(1) < config.num_iters) {
+        if (open_loop) {
+          // A call that arrives while the thread is busy with an earlier one
+          // waits, and its latency includes that wait
+          arrival += thread_gaps[thread_id][num_calls];
+          std::this_thread::sleep_until(arrival);
+        } else {
+          arrival = Clock::now();
+        }
+        calls[iter]();
+        latencies.emplace_back(
+            thread_models[thread_id][iter],
+            toMilliseconds(Clock::now() - arrival));
+        ++iter;
+        ++num_calls;
+      }
+
+      {
+        std::unique_lock<std::mutex> lock(m);
+        ++finished;
+        worker_main_cv.notify_one();
+        LOG(INFO) << "Shutting down forward thread " << thread_id
+                  << ". Total number of finished threads: " << finished;
+      }
+
+    });
+  }
+
+  std::unique_ptr<torch::autograd::profiler::RecordProfile> profiler_guard;
+  {
+    std::unique_lock<std::mutex> lock(m);
+    while (initialized != config.num_calling_threads) {
+      worker_main_cv.wait(lock);
+    }
+    if (!config.profiler_output_path.empty()) {
+      LOG(INFO) << "Using Autograd profiler. Trace will be saved to "
+                << config.profiler_output_path;
+      profiler_guard.reset(new torch::autograd::profiler::RecordProfile(
+        config.profiler_output_path));
+    }
+    LOG(INFO) << "Starting threads";
+    start = true;
+    start_time = Clock::now();
+  }
+
+  main_worker_cv.notify_all();
+  {
+    std::unique_lock<std::mutex> lock(m);
+    worker_main_cv.wait(
+        lock, [&]() { return finished == config.num_calling_threads; });
+  }
+  auto end_time = Clock::now();
+  profiler_guard.reset();
+  LOG(INFO) << "Finished benchmark";
+
+  for (auto& t : callers) {
+    t.join();
+  }
+
+  // Only the config.num_iters calls that were made count, the last attempted
+  // iteration of each calling thread doesn't represent real work
+  float total_time_ms = toMilliseconds(end_time - start_time);
+  std::vector<float> latencies_ms;
+  std::vector<std::vector<float>> model_latencies_ms(samplers.size());
+  for (const auto& latencies : thread_latencies) {
+    for (const auto& model_and_latency : latencies) {
+      latencies_ms.push_back(model_and_latency.second);
+      model_latencies_ms[model_and_latency.first].push_back(
+          model_and_latency.second);
+    }
+  }
+
+  MultiModelExecutionStats stats;
+  stats.total = latencyStats(std::move(latencies_ms), total_time_ms);
+  for (auto& model_latencies : model_latencies_ms) {
+    stats.models.push_back(
+        latencyStats(std::move(model_latencies), total_time_ms));
+  }
+  return stats;
+}
+
 template <>
 void ScriptModuleBenchmark::runOnce(ScriptModuleInput&& input) const {
   CHECK(initialized_);
@@ -84,6 +430,49 @@ ScriptModuleOutput ScriptModuleBenchmark::runOnce(
   return function(std::move(stack));
 }
 
+template <>
+void StaticModuleBatcherBenchmark::runOnce(ScriptModuleInput&& input) const {
+  CHECK(initialized_);
+  std::vector<at::Tensor> tensors;
+  tensors.reserve(input.size() - 1);
+  // input[0] is the module
+  for (size_t i = 1; i < input.size(); ++i) {
+    TORCH_CHECK(
+        input[i].isTensor(),
+        "Static Runtime batching only supports Tensor inputs");
+    tensors.push_back(std::move(input[i]).toTensor());
+  }
+  model_->run(std::move(tensors))->wait();
+}
+
+template <>
+void StaticModuleBenchmark::runOnce(ScriptModuleInput&& input) const {
+  CHECK(initialized_);
+  // input[0] is the module
+  input.erase(input.begin());
+  (*model_)(input, {});
+}
+
+template <>
+void MobileModuleBenchmark::runOnce(ScriptModuleInput&& input) const {
+  CHECK(initialized_);
+  model_->forward(std::move(input));
+}
+
+template <>
+ScriptModuleOutput MobileModuleBenchmark::runOnce(
+    py::args&& args,
+    py::kwargs&& kwargs) const {
+  CHECK(initialized_);
+  TORCH_CHECK(
+      kwargs.empty(), "Lite interpreter modules don't take keyword arguments");
+  ScriptModuleInput input;
+  for (const auto& arg : args) {
+    input.push_back(jit::toTypeInferredIValue(arg));
+  }
+  return model_->forward(std::move(input));
+}
+
 template <>
 void ModuleBenchmark::runOnce(ModuleInput&& input) const {
   CHECK(initialized_);
@@ -115,6 +504,17 @@ void ScriptModuleBenchmark::addInput(ScriptModuleInput&& input) {
   inputs_.emplace_back(std::move(input));
 }
 
+template <>
+void MobileModuleBenchmark::addInput(py::args&& args, py::kwargs&& kwargs) {
+  TORCH_CHECK(
+      kwargs.empty(), "Lite interpreter modules don't take keyword arguments");
+  ScriptModuleInput input;
+  for (const auto& arg : args) {
+    input.push_back(jit::toTypeInferredIValue(arg));
+  }
+  inputs_.emplace_back(std::move(input));
+}
+
 template <>
 void ModuleBenchmark::addInput(py::args&& args, py::kwargs&& kwargs) {
   inputs_.emplace_back(std::move(args), std::move(kwargs));
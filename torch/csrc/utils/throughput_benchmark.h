@@ -2,12 +2,16 @@
 
 #include <ATen/core/ivalue.h>
 #include <torch/csrc/jit/api/module.h>
+#include <torch/csrc/jit/mobile/module.h>
 #include <pybind11/pybind11.h>
 
 #include <torch/csrc/jit/python/pybind_utils.h>
+#include <torch/csrc/utils/static_module_batcher.h>
 
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -23,10 +27,35 @@ namespace throughput_benchmark {
 struct BenchmarkExecutionStats {
   float latency_avg_ms{-1};
   int64_t num_iters{-1};
+  // Wall time of the measured part of the benchmark
+  float total_time_ms{-1};
+  // Percentiles of the latencies of the individual calls. When calls arrive
+  // at a given rate (see BenchmarkConfig::arrival_qps) the latency of a call
+  // counts from its scheduled arrival, so it includes the time the call waited
+  // for a calling thread to become free
+  float latency_p50_ms{-1};
+  float latency_p90_ms{-1};
+  float latency_p99_ms{-1};
+  float latency_max_ms{-1};
+  // latency_histogram_counts[i] calls took more than
+  // latency_histogram_bounds_ms[i - 1] and at most
+  // latency_histogram_bounds_ms[i]. The bounds double from 10us up to the
+  // largest latency
+  std::vector<float> latency_histogram_bounds_ms;
+  std::vector<int64_t> latency_histogram_counts;
 };
 
 std::ostream& operator<<(std::ostream& os, const BenchmarkExecutionStats& value);
 
+/**
+ * Results of a benchmark of a mix of models: the statistics of all the calls
+ * and those of the calls of each model, in the order the models were added
+ */
+struct MultiModelExecutionStats {
+  BenchmarkExecutionStats total;
+  std::vector<BenchmarkExecutionStats> models;
+};
+
 /**
  * Use this struct in order to configure a throughput benchmark run.
  * This struct should include parameters related to threading, batching, number
@@ -57,10 +86,35 @@ struct BenchmarkConfig {
   // before the main benchmark loop (but after the warmup):
   // RecordProfile guard(profiler_output_path);
   std::string profiler_output_path{""};
+  // If positive, a ScriptModule is run by Static Runtime behind a
+  // jit::StaticModuleBatcher, which coalesces the concurrent calls of the
+  // calling threads into batches of up to this many rows along dim 0
+  int64_t static_runtime_max_batch_size{0};
+  // How long a call waits for more calls to batch with, in microseconds
+  int64_t static_runtime_max_batch_delay_us{1000};
+  // If positive, calls arrive in an open loop, as a Poisson process of this
+  // many calls per second across all calling threads, which serve them in
+  // turn. Otherwise each calling thread makes its next call as soon as the
+  // previous one returns
+  double arrival_qps{0};
 };
 
 namespace detail {
 
+// A call of a model on a copy of one of its inputs, prepared ahead of the
+// benchmark so that running it costs nothing but the model itself
+using BenchmarkCall = std::function<void()>;
+// Prepares the next call of a model, drawing its input with the given engine
+using CallSampler = std::function<BenchmarkCall(std::mt19937&)>;
+
+// Runs the benchmark loop of BenchmarkConfig on a mix of models, each call
+// going to the model of samplers[i] with probability proportional to
+// weights[i]
+MultiModelExecutionStats runBenchmark(
+    const BenchmarkConfig& config,
+    const std::vector<CallSampler>& samplers,
+    const std::vector<double>& weights);
+
 /**
  * A helper class to abstract out different models we test throughput of
  */
@@ -81,6 +135,9 @@ public:
   // conversions at the benchmark time
   void addInput(py::args&&, py::kwargs&&);
   void addInput(Input&&);
+  // Prepares a call on one of the inputs, drawn uniformly at random. The call
+  // refers to this helper, which must outlive it
+  BenchmarkCall sampleCall(std::mt19937& engine) const;
   BenchmarkExecutionStats benchmark(const BenchmarkConfig& config) const;
 
   bool initialized() const { return initialized_; }
@@ -151,27 +208,79 @@ void ScriptModuleBenchmark::addInput(ScriptModuleInput&& input);
 template <>
 void ModuleBenchmark::addInput(py::args&& args, py::kwargs&& kwargs);
 
+// Runs the inputs of a ScriptModuleBenchmark, without the module argument,
+// through a StaticModuleBatcher
+typedef BenchmarkHelper<
+    ScriptModuleInput,
+    at::IValue,
+    std::shared_ptr<jit::StaticModuleBatcher>>
+    StaticModuleBatcherBenchmark;
+
+template <>
+void StaticModuleBatcherBenchmark::runOnce(ScriptModuleInput&& input) const;
+
+// Runs the inputs of a ScriptModuleBenchmark, without the module argument,
+// on Static Runtime
+typedef BenchmarkHelper<
+    ScriptModuleInput,
+    at::IValue,
+    std::shared_ptr<jit::StaticModule>>
+    StaticModuleBenchmark;
+
+template <>
+void StaticModuleBenchmark::runOnce(ScriptModuleInput&& input) const;
+
+// Runs a module on the lite interpreter. Its inputs don't include the module
+typedef BenchmarkHelper<
+    ScriptModuleInput,
+    at::IValue,
+    std::shared_ptr<jit::mobile::Module>>
+    MobileModuleBenchmark;
+template <>
+inline BenchmarkHelper<
+    ScriptModuleInput,
+    at::IValue,
+    std::shared_ptr<jit::mobile::Module>>::BenchmarkHelper()
+  : initialized_(false) {}
+
+template <>
+void MobileModuleBenchmark::runOnce(ScriptModuleInput&& input) const;
+
+template <>
+ScriptModuleOutput MobileModuleBenchmark::runOnce(
+    py::args&& args,
+    py::kwargs&& kwargs) const;
+
+template <>
+void MobileModuleBenchmark::addInput(py::args&& args, py::kwargs&& kwargs);
+
 } // namespace detail
 
 /**
  * This class is a small c++ component responsible for executing a PyTorch
  * module under an inference server like load. It can emulate multiple calling
- * threads to a single module provided. In the future we plan to enhance this
- * component to support inter and intra-op parallelism as well as multiple
- * models running in a single process.
+ * threads to a single module provided, and MultiModelBenchmark runs several
+ * of them in a single process. In the future we plan to enhance this
+ * component to support inter and intra-op parallelism.
  *
  * For current available configurations refer to the BenchmkarConfig
  * documentation
  *
- * The class supports working with either nn.Module or ScriptModule.
+ * The class supports working with nn.Module, ScriptModule (on the JIT
+ * interpreter or on Static Runtime) and lite interpreter modules.
  * Under the hood it just dispatches to corresponding specialization of
  * class BenchmarkHelper<Input, Output, Model>
  */
 class C10_HIDDEN ThroughputBenchmark {
  public:
   explicit ThroughputBenchmark(jit::Module module);
+  explicit ThroughputBenchmark(jit::mobile::Module module);
   explicit ThroughputBenchmark(py::object module);
 
+  // Runs a ScriptModule on Static Runtime instead of the JIT interpreter,
+  // including in runOnce
+  void enableStaticRuntime();
+
   // Add one more input example. This input example should be in the exact
   // format the module under test expects. It is responsibility of the module to
   // perform any such format checks, the benchmark doesn't perform any
@@ -188,9 +297,39 @@ class C10_HIDDEN ThroughputBenchmark {
   BenchmarkExecutionStats benchmark(const BenchmarkConfig& config) const;
 
  private:
+  friend class MultiModelBenchmark;
+
+  // Prepares the calls of the model the way config asks to run it. The
+  // sampler may refer to this benchmark, which must outlive it
+  detail::CallSampler sampler(const BenchmarkConfig& config) const;
+  void checkInitialized() const;
+
   detail::ScriptModuleBenchmark script_module_;
+  // Set by enableStaticRuntime()
+  std::shared_ptr<jit::StaticModule> static_module_;
+  detail::MobileModuleBenchmark mobile_module_;
   detail::ModuleBenchmark module_;
 };
+
+/**
+ * Runs several models in one process, under the load of the calls of all of
+ * them, to reproduce the contention between the models of a server. Each call
+ * goes to one of the models at random, in proportion to their weights, and
+ * the arrival process and calling threads of BenchmarkConfig are shared by
+ * all of them.
+ */
+class C10_HIDDEN MultiModelBenchmark {
+ public:
+  // The benchmark must outlive this object. Its inputs are those added to it
+  // and the config it runs with is the one passed to benchmark()
+  void addModel(const ThroughputBenchmark& benchmark, double weight);
+
+  MultiModelExecutionStats benchmark(const BenchmarkConfig& config) const;
+
+ private:
+  std::vector<const ThroughputBenchmark*> models_;
+  std::vector<double> weights_;
+};
 } // namespace throughput benchmark
 } // namepsace torch
 
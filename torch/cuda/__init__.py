@@ -17,6 +17,7 @@ import threading
 from typing import List, Optional, Tuple, Union, Any
 from ._utils import _get_device_index, _dummy_type
 from .streams import Stream, Event, _Graph, _graph_pool_handle
+from .graphs import CUDAGraph, graph, graph_pool_handle, is_current_stream_capturing, make_graphed_inference
 from .. import device as _device
 import torch._C
 
@@ -0,0 +1,222 @@
+import gc
+import torch
+
+from ._utils import _dummy_type
+from torch.utils._pytree import tree_flatten
+
+
+if not hasattr(torch._C, '_CudaGraphBase'):
+    # Define dummy base classes
+    torch._C.__dict__['_CudaGraphBase'] = _dummy_type('_CudaGraphBase')
+    torch._C.__dict__['_graph_pool_handle'] = _dummy_type('_graph_pool_handle')
+if not hasattr(torch._C, '_cuda_isCurrentStreamCapturing'):
+    torch._C.__dict__['_cuda_isCurrentStreamCapturing'] = _dummy_type('_cuda_isCurrentStreamCapturing')
+
+
+def is_current_stream_capturing():
+    r"""Returns True if CUDA graph capture is underway on the current CUDA stream, False otherwise.
+
+    If a CUDA context does not exist on the current device, returns False without initializing the context.
+    """
+    return torch._C._cuda_isCurrentStreamCapturing()
+
+
+def graph_pool_handle():
+    r"""Returns an opaque token representing the id of a graph memory pool.
+
+    Pass it as ``pool`` to :class:`~torch.cuda.graph` or
+    :meth:`CUDAGraph.capture_begin` to hint that several graphs may share the
+    pool. See :ref:`graph-memory-management`.
+    """
+    return torch._C._graph_pool_handle()
+
+
+class CUDAGraph(torch._C._CudaGraphBase):
+    r"""Wrapper around a CUDA graph.
+
+    Graphs are usually captured with the :class:`~torch.cuda.graph` context
+    manager, see :ref:`cuda-graph-semantics`.
+    """
+    def __init__(self):
+        super(CUDAGraph, self).__init__()
+
+    def capture_begin(self, pool=None):
+        r"""Begins capturing CUDA work on the current stream.
+
+        Arguments:
+            pool (optional): Token (returned by :func:`~torch.cuda.graph_pool_handle`
+                or :meth:`other_Graph_instance.pool()<torch.cuda.CUDAGraph.pool>`)
+                hinting this graph may share memory with the indicated pool.
+        """
+        if pool is None:
+            super(CUDAGraph, self).capture_begin()
+        else:
+            super(CUDAGraph, self).capture_begin(pool)
+
+    def capture_end(self):
+        r"""Ends CUDA graph capture on the current stream.
+
+        After ``capture_end``, ``replay`` may be called on this instance.
+        """
+        super(CUDAGraph, self).capture_end()
+
+    def replay(self):
+        r"""Replays the CUDA work captured by this graph."""
+        super(CUDAGraph, self).replay()
+
+    def reset(self):
+        r"""Deletes the graph currently held by this instance."""
+        super(CUDAGraph, self).reset()
+
+    def pool(self):
+        r"""Returns an opaque token representing the id of this graph's memory pool.
+
+        This id can optionally be passed to another graph's ``capture_begin``,
+        which hints the other graph may share the same memory pool.
+        """
+        return super(CUDAGraph, self).pool()
+
+
+class graph(object):
+    r"""Context-manager that captures CUDA work into a :class:`torch.cuda.CUDAGraph`
+    object for later replay.
+
+    See :ref:`cuda-graph-semantics` for a general introduction,
+    detailed use, and constraints.
+
+    Arguments:
+        cuda_graph (torch.cuda.CUDAGraph): Graph object used for capture.
+        pool (optional): Token (returned by :func:`~torch.cuda.graph_pool_handle` or
+            :meth:`other_Graph_instance.pool()<torch.cuda.CUDAGraph.pool>`) hinting this graph's capture
+            may share memory from the specified pool. See :ref:`graph-memory-management`.
+        stream (torch.cuda.Stream, optional): If supplied, will be set as the current stream in the context.
+            If not supplied, ``graph`` sets its own internal side stream as the current stream in the context.
+
+    .. note::
+        For effective memory sharing, if you pass a ``pool`` used by a previous capture and the previous capture
+        used an explicit ``stream`` argument, you should pass the same ``stream`` argument to this capture.
+
+    .. warning::
+        Capture can't run on the default stream, and everything the captured
+        region reads (inputs, parameters, optimizer state, and the learning rate
+        of optimizers) is read from the memory and values it had at capture time.
+        Copy new data into the same tensors before each replay.
+    """
+    default_capture_stream = None
+
+    def __init__(self,
+                 cuda_graph,
+                 pool=None,
+                 stream=None):
+        # Lazy-init here rather than at module level because CUDA may not be
+        # initialized yet when torch.cuda is imported.
+        if self.__class__.default_capture_stream is None:
+            self.__class__.default_capture_stream = torch.cuda.Stream()
+
+        self.pool = () if pool is None else (pool,)
+        self.capture_stream = stream if stream is not None else self.__class__.default_capture_stream
+        assert self.capture_stream is not None
+        self.stream_ctx = torch.cuda.stream(self.capture_stream)
+        self.cuda_graph = cuda_graph
+
+    def __enter__(self):
+        # Free as much memory as we can for the graph
+        torch.cuda.synchronize()
+        gc.collect()
+        torch.cuda.empty_cache()
+
+        self.stream_ctx.__enter__()
+
+        self.cuda_graph.capture_begin(*self.pool)
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.cuda_graph.capture_end()
+        self.stream_ctx.__exit__(exc_type, exc_value, traceback)
+        # returning None propagates exceptions from either capture_end or stream_ctx.__exit__()
+
+
+def _input_key(args):
+    key = []
+    for arg in args:
+        if isinstance(arg, torch.Tensor):
+            key.append((arg.shape, arg.dtype, arg.device))
+        else:
+            key.append(arg)
+    return tuple(key)
+
+
+class _GraphedInference(object):
+    def __init__(self, module, sample_args, num_warmup_iters):
+        self.module = module
+        self.graphs = {}
+        for args in sample_args:
+            args = (args,) if isinstance(args, torch.Tensor) else tuple(args)
+            if any(isinstance(arg, torch.Tensor) and not arg.is_cuda for arg in args):
+                raise ValueError("make_graphed_inference: sample inputs must be CUDA tensors")
+            key = _input_key(args)
+            if key in self.graphs:
+                continue
+            static_args = tuple(arg.clone() if isinstance(arg, torch.Tensor) else arg
+                                for arg in args)
+
+            # Warmup on a side stream also lets a TorchScript module compile
+            # its optimized plan before capture.
+            s = torch.cuda.Stream()
+            s.wait_stream(torch.cuda.current_stream())
+            with torch.no_grad(), torch.cuda.stream(s):
+                for _ in range(num_warmup_iters):
+                    module(*static_args)
+            torch.cuda.current_stream().wait_stream(s)
+
+            g = CUDAGraph()
+            with torch.no_grad(), graph(g):
+                static_outputs = module(*static_args)
+            if not all(isinstance(out, torch.Tensor) for out in tree_flatten(static_outputs)[0]):
+                raise ValueError("make_graphed_inference: the module must only return tensors")
+            self.graphs[key] = (g, static_args, static_outputs)
+
+    def __call__(self, *args):
+        try:
+            entry = self.graphs.get(_input_key(args))
+        except TypeError:
+            # unhashable non-tensor arguments are never captured
+            entry = None
+        if entry is None:
+            return self.module(*args)
+        g, static_args, static_outputs = entry
+        for static_arg, arg in zip(static_args, args):
+            if isinstance(static_arg, torch.Tensor):
+                static_arg.copy_(arg)
+        g.replay()
+        return static_outputs
+
+
+def make_graphed_inference(module, sample_args, num_warmup_iters=3):
+    r"""Captures the forward of an inference module into one
+    :class:`~torch.cuda.CUDAGraph` per declared input shape.
+
+    Returns a callable. When it is called with inputs whose shapes, dtypes and
+    devices (and non-tensor arguments) match one of ``sample_args``, it copies
+    the inputs into that capture's static inputs and replays the graph. This
+    removes the per-kernel launch overhead of the interpreter. Calls with
+    other inputs run ``module`` normally.
+
+    Arguments:
+        module (callable): Module to capture, typically a frozen
+            :class:`~torch.jit.ScriptModule` (see :func:`torch.jit.freeze`).
+            It must return tensors or nested tuples, lists or dicts of tensors,
+            and must satisfy the constraints of :ref:`cuda-graph-semantics`.
+        sample_args (list): One tuple of positional arguments (or a single
+            tensor) per input shape to capture.
+        num_warmup_iters (int, optional): Number of untimed calls on a side
+            stream before each capture. For TorchScript modules this must be
+            enough for the executor to finish profiling. Default: ``3``.
+
+    .. warning::
+        Replays return the same output tensors every time, so each call
+        overwrites the results of the previous call with the same shapes.
+        Clone outputs that have to outlive the next call. Captures run under
+        :func:`torch.no_grad` and each holds on to a private memory pool, see
+        :ref:`graph-memory-management`.
+    """
+    return _GraphedInference(module, sample_args, num_warmup_iters)
@@ -1,7 +1,8 @@
 import collections
 import contextlib
+import pickle
 import warnings
-from typing import Any, Dict, Union
+from typing import Any, Dict, Optional, Union
 
 import torch
 from . import is_initialized, _get_device_index, _lazy_init
@@ -394,9 +395,186 @@ def memory_snapshot():
         See :ref:`cuda-memory-management` for more details about GPU memory
         management.
     """
+    return torch._C._cuda_memorySnapshot()["segments"]
+
+
+def get_allocator_backend() -> str:
+    r"""Returns the backend of the CUDA memory allocator, ``native`` for the
+    caching allocator of PyTorch or ``cudaMallocAsync`` for the stream-ordered
+    allocator of the CUDA driver.
+
+    The backend is selected with the ``backend`` option of the
+    ``PYTORCH_CUDA_ALLOC_CONF`` environment variable before the first CUDA
+    allocation.
+
+    .. note::
+        See :ref:`cuda-memory-management` for more details about GPU memory
+        management.
+    """
+    return torch._C._cuda_getAllocatorBackend()
+
+
+_oom_snapshot_path: Optional[str] = None
+
+
+def _dump_snapshot_on_oom(device, alloc_size, device_total, device_free):
+    if _oom_snapshot_path is not None:
+        _dump_snapshot(_oom_snapshot_path)
+
+
+def _record_memory_history(enabled: bool = True, record_context: bool = True,
+                           record_context_cpp: bool = False,
+                           trace_alloc_max_entries: int = 1,
+                           trace_alloc_record_context: bool = False,
+                           oom_snapshot_path: Optional[str] = None) -> None:
+    r"""Enables or disables recording the history of the CUDA caching allocator
+    on all devices, for inspection with :func:`_snapshot`.
+
+    Arguments:
+        enabled (bool): whether to record the history.
+        record_context (bool): records the context of each allocation with its
+            block: the names of the enclosing operators and
+            :class:`torch.autograd.profiler.record_function` scopes. Scopes
+            are tracked for the calling thread and the autograd threads it
+            starts, allocations from other threads record no scopes.
+        record_context_cpp (bool): adds the C++ stack to the context.
+        trace_alloc_max_entries (int): keeps the last
+            ``trace_alloc_max_entries`` allocator events (allocations, frees
+            and segment changes) per device in a ring buffer. ``0`` disables
+            the trace.
+        trace_alloc_record_context (bool): records the context with the
+            events of the trace, requires ``record_context``.
+        oom_snapshot_path (str, optional): if set, a snapshot is dumped to
+            this path with :func:`_dump_snapshot` whenever an allocation fails
+            with an out of memory error.
+
+    .. note::
+        Recording the context makes every allocation and free slower, and
+        tracking the scopes adds a callback to every operator.
+    """
+    global _oom_snapshot_path
+    _lazy_init()
+    if oom_snapshot_path is not None and _oom_snapshot_path is None:
+        torch._C._cuda_attachOutOfMemoryObserver(_dump_snapshot_on_oom)
+    _oom_snapshot_path = oom_snapshot_path if enabled else None
+    torch._C._cuda_recordMemoryHistory(enabled, record_context, record_context_cpp,
+                                       trace_alloc_max_entries, trace_alloc_record_context)
+
+
+def _snapshot() -> Dict[str, Any]:
+    r"""Returns the state of the CUDA caching allocator across all devices,
+    including the history recorded with :func:`_record_memory_history`.
+
+    The result is a dictionary with the keys
+
+    - ``"segments"``: the segments held by the allocator, as returned by
+      :func:`memory_snapshot`. Each segment has its ``"stream"`` and each
+      block its ``"requested_size"``. While the context is recorded, allocated
+      blocks and segments have the ``"scopes"`` and, with C++ context,
+      ``"cpp_frames"`` of the allocation.
+    - ``"device_traces"``: per device, the recorded events from oldest to
+      newest. Each event has an ``"action"`` (``"alloc"``, ``"free_requested"``,
+      ``"free_completed"``, ``"segment_alloc"``, ``"segment_free"``,
+      ``"segment_map"``, ``"segment_unmap"`` or ``"oom"``), an ``"addr"``
+      (``"device_free"`` for ``"oom"``), a ``"size"``, a ``"stream"`` and,
+      if requested, the context.
+    """
     return torch._C._cuda_memorySnapshot()
 
 
+def _dump_snapshot(filename: str = "snapshot.pickle") -> None:
+    r"""Saves :func:`_snapshot` to ``filename`` with :mod:`pickle`, for
+    analysis in a separate process."""
+    with open(filename, "wb") as f:
+        pickle.dump(_snapshot(), f)
+
+
+def host_memory_stats() -> Dict[str, Any]:
+    r"""Returns a dictionary of statistics of the caching allocator for pinned
+    host memory, the one behind :meth:`~torch.Tensor.pin_memory`.
+
+    The return value of this function is a dictionary of statistics, each of
+    which is a non-negative integer.
+
+    Core statistics, each with ``current``, ``peak``, ``allocated`` and
+    ``freed`` values as in :func:`~torch.cuda.memory_stats`:
+
+    - ``"allocation.{current,peak,allocated,freed}"``:
+      number of allocation requests received by the allocator.
+    - ``"allocated_bytes.{current,peak,allocated,freed}"``:
+      amount of allocated memory, rounded up to the size classes of the
+      allocator.
+    - ``"segment.{current,peak,allocated,freed}"``:
+      number of blocks reserved with ``cudaHostAlloc()``.
+    - ``"reserved_bytes.{current,peak,allocated,freed}"``:
+      amount of reserved memory.
+    - ``"cached_bytes.{current,peak,allocated,freed}"``:
+      amount of freed memory kept for reuse, including blocks that wait for
+      the streams they were used on.
+
+    In addition, ``"num_cache_releases"`` counts the cached blocks released
+    with ``cudaFreeHost()``, by :func:`~torch.cuda.empty_host_cache` or to honor
+    the limit of :func:`~torch.cuda.set_host_memory_cache_limit`.
+    """
+    result = []
+
+    def _recurse_add_to_result(prefix, obj):
+        if isinstance(obj, dict):
+            if len(prefix) > 0:
+                prefix += "."
+            for k, v in obj.items():
+                _recurse_add_to_result(prefix + k, v)
+        else:
+            result.append((prefix, obj))
+
+    stats = host_memory_stats_as_nested_dict()
+    _recurse_add_to_result("", stats)
+    result.sort()
+
+    return collections.OrderedDict(result)
+
+
+def host_memory_stats_as_nested_dict() -> Dict[str, Any]:
+    r"""Returns the result of :func:`~torch.cuda.host_memory_stats` as a nested dictionary."""
+    if not is_initialized():
+        return {}
+    return torch._C._cuda_hostMemoryStats()
+
+
+def reset_accumulated_host_memory_stats() -> None:
+    r"""Resets the "accumulated" (historical) stats tracked by the pinned host
+    memory allocator, see :func:`~torch.cuda.host_memory_stats`."""
+    if is_initialized():
+        torch._C._cuda_resetAccumulatedHostMemoryStats()
+
+
+def reset_peak_host_memory_stats() -> None:
+    r"""Resets the "peak" stats tracked by the pinned host memory allocator,
+    see :func:`~torch.cuda.host_memory_stats`."""
+    if is_initialized():
+        torch._C._cuda_resetPeakHostMemoryStats()
+
+
+def empty_host_cache() -> None:
+    r"""Releases the pinned host memory cached by the caching host allocator."""
+    if is_initialized():
+        torch._C._cuda_hostEmptyCache()
+
+
+def set_host_memory_cache_limit(limit: int) -> None:
+    r"""Sets the maximum amount of freed pinned host memory, in bytes, that the
+    caching host allocator keeps for reuse. Memory freed beyond the limit is
+    released with ``cudaFreeHost()``, which can synchronize the device, so the
+    limit is best set above the steady state working set. Unlimited by
+    default.
+
+    Args:
+        limit (int): maximum number of cached bytes.
+    """
+    _lazy_init()
+    torch._C._cuda_setHostMaxCachedBytes(limit)
+
+
 def memory_summary(device: Union[Device, int] = None, abbreviated: bool = False) -> str:
     r"""Returns a human-readable printout of the current memory allocator
     statistics for a given device.
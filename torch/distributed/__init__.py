@@ -30,16 +30,23 @@ if is_available():
         Reducer,
         Logger,
         BuiltinCommHookType,
+        BuiltinCommHookOptions,
+        BucketOptimizerType,
+        BucketOptimizerOptions,
         GradBucket,
         _DEFAULT_FIRST_BUCKET_BYTES,
         _register_comm_hook,
         _register_builtin_comm_hook,
+        _register_bucket_optimizer,
         _broadcast_coalesced,
         _compute_bucket_assignment_by_size,
+        _compute_bucket_assignment_by_time,
         _verify_model_across_ranks,
         _test_python_store,
         _DistributedDebugLevel,
-        _get_debug_mode
+        _get_debug_mode,
+        _PipelineExecutor,
+        _SnapshotService,
     )
     if sys.platform != 'win32':
         from torch._C._distributed_c10d import (
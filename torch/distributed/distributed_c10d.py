@@ -357,6 +357,20 @@ def _get_default_group():
     return GroupMember.WORLD
 
 
+def _get_split_source_group():
+    """
+    Returns the default process group if it is an NCCL process group whose
+    communicator was created eagerly, in which case new NCCL process groups
+    derive their communicator from it.
+    """
+    default_pg = _get_default_group()
+    if _pg_map[default_pg][0] != Backend.NCCL:
+        return None
+    if default_pg.options.eager_init_device is None:
+        return None
+    return default_pg
+
+
 def _get_default_store():
     """
     Getting the default store created by init_process_group
@@ -461,7 +475,11 @@ def init_process_group(backend,
             specifying what additional options need to be passed in during
             the construction of specific process groups. i.e. for the ``nccl``
             backend, ``is_high_priority_stream`` can be specified so that
-            process group can pick up high priority cuda streams.
+            process group can pick up high priority cuda streams. Setting
+            ``eager_init_device`` of the ``nccl`` options to the device of the
+            rank creates its NCCL communicator here rather than on the first
+            collective, and groups created later with :func:`new_group` then
+            derive theirs from it with ``ncclCommSplit`` where supported.
 
     .. note:: Note that if passing in pg_options and set the ``pg_options.timeout``,
         it will override the default timeout of the ``timeout`` argument.
@@ -599,9 +617,17 @@ def _new_process_group_helper(world_size,
     else:
         # If this is a subgroup (which means group_ranks is specified),
         # we check if the current process is a member of the new group.
+        split_from = None
         if not is_default_group:
+            if backend == Backend.NCCL:
+                split_from = _get_split_source_group()
             global_rank = _get_default_group().rank()
             if global_rank not in group_ranks:
+                # Splitting the communicator of the default group is
+                # collective over all of its ranks.
+                if split_from is not None:
+                    split_from._perform_nocolor_split(
+                        split_from.options.eager_init_device)
                 return GroupMember.NON_GROUP_MEMBER
 
         # Use the group name as prefix in the default store, such that
@@ -650,6 +676,10 @@ def _new_process_group_helper(world_size,
                 pg_options.is_high_priority_stream = False
                 pg_options.timeout = timeout
 
+            if split_from is not None:
+                pg_options.eager_init_device = split_from.options.eager_init_device
+                pg_options.split_from = split_from
+
             pg = ProcessGroupNCCL(
                 prefix_store,
                 rank,
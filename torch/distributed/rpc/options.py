@@ -3,7 +3,7 @@ from . import constants as rpc_contants
 
 import torch
 
-from typing import Dict, List
+from typing import Dict, List, Optional
 
 
 class TensorPipeRpcBackendOptions(_TensorPipeRpcBackendOptionsBase):
@@ -42,6 +42,8 @@ class TensorPipeRpcBackendOptions(_TensorPipeRpcBackendOptionsBase):
         device_maps: Dict = None,
         _transports: List = None,
         _channels: List = None,
+        _batching_timeout_us: int = 0,
+        _batching_max_bytes: Optional[int] = None,
     ):
         super().__init__(
             num_worker_threads,
@@ -51,6 +53,12 @@ class TensorPipeRpcBackendOptions(_TensorPipeRpcBackendOptionsBase):
             init_method,
             device_maps if device_maps else {}
         )
+        # Opt-in batching of small requests to the same worker, which are sent
+        # together after at most ``_batching_timeout_us`` microseconds or once
+        # ``_batching_max_bytes`` of them are pending.
+        self._batching_timeout_us = _batching_timeout_us
+        if _batching_max_bytes is not None:
+            self._batching_max_bytes = _batching_max_bytes
 
     def set_device_map(self, to: str, device_map: Dict):
         r"""
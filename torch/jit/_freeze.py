@@ -113,6 +113,11 @@ def optimize_frozen_module(mod, optimize_numerics: bool = True):
         - Conv -> Batchnorm folding
         - Conv -> Add/Sub folding
         - Conv -> Mul/Div folding
+        - Matmul with a constant 2-d weight -> Linear conversion
+        - Linear -> Batchnorm folding
+        - Linear -> Add/Sub folding
+        - Linear -> Mul/Div folding
+        - Merging of parallel Linears that share an input
 
     Args:
         mod (:class:`ScriptModule`): a frozen module to be optimized
@@ -121,7 +126,8 @@ def optimize_frozen_module(mod, optimize_numerics: bool = True):
         preserve numerics. These optimizations preserve default rtol and atol of `torch.testing.assert_allclose`
         when applied on a single transformation, however in a module where many transformations are applied
         the rtol or atol may no longer fall within the default `assert_allclose` tolerance. Conv -> Batchnorm folding,
-        Conv-Add/Sub, and Conv -> Mul/Div folding all may alter numerics.
+        Conv-Add/Sub, Conv -> Mul/Div folding, the Linear foldings and merging parallel Linears all may alter
+        numerics.
 
     Returns:
         None
@@ -148,8 +154,55 @@ def optimize_frozen_module(mod, optimize_numerics: bool = True):
     # intentionally duplicated to make to make it easier to create custom optimization sequence
     torch._C._jit_pass_remove_dropout(mod._c)
     if optimize_numerics:
+        torch._C._jit_pass_convert_frozen_matmul_to_linear(mod.graph)
         # run a couple times to capture Conv -> Mul -> Add etc
         for _ in range(2):
             torch._C._jit_pass_fold_frozen_conv_bn(mod.graph)
             torch._C._jit_pass_fold_frozen_conv_add_or_sub(mod.graph)
             torch._C._jit_pass_fold_frozen_conv_mul_or_div(mod.graph)
+            torch._C._jit_pass_fold_frozen_linear_bn(mod.graph)
+            torch._C._jit_pass_fold_frozen_linear_add_or_sub(mod.graph)
+            torch._C._jit_pass_fold_frozen_linear_mul_or_div(mod.graph)
+        # after folding, so each merged linear already carries its epilogue
+        torch._C._jit_pass_merge_frozen_parallel_linears(mod.graph)
+
+
+def optimize_for_inference(mod: ScriptModule) -> ScriptModule:
+    r"""
+    Performs a set of optimization passes to optimize a model for the purposes of inference.
+    If the model is not already frozen, `optimize_for_inference` will invoke `torch.jit.freeze`
+    automatically.
+
+    In addition to the optimizations of `torch.jit.optimize_frozen_module`, this runs passes
+    that change the operators of the graph for faster CPU execution, and that later folding
+    passes cannot see through:
+        - Conversion of ops with constant weights to MKLDNN (requires MKL-DNN)
+        - Linear weight prepacking, for fp32 linears left out of MKLDNN (requires MKL)
+
+    Args:
+        mod (:class:`ScriptModule`): a module to be optimized
+
+    Returns:
+        Optimized :class:`ScriptModule`.
+
+    Example:
+
+    .. testcode::
+        import torch
+        mod = torch.nn.Sequential(torch.nn.Linear(20, 30), torch.nn.ReLU())
+        optimized_mod = torch.jit.optimize_for_inference(torch.jit.script(mod.eval()))
+        print(optimized_mod.graph)
+    """
+    if not isinstance(mod, ScriptModule):
+        raise RuntimeError(
+            "optimize_for_inference expects a ScriptModule as input. "
+            "Please use torch.jit.script or torch.jit.trace to script your 'nn.Module'."
+        )
+
+    # frozen modules no longer have a training attribute
+    if hasattr(mod, "training"):
+        mod = freeze(mod.eval())
+
+    torch._C._jit_pass_convert_frozen_ops_to_mkldnn(mod.graph)
+    torch._C._jit_pass_prepack_frozen_linear(mod.graph)
+    return mod
@@ -38,6 +38,14 @@ const inline char* getNcclErrorDetailStr(ncclResult_t error) {
 #define ENABLE_NCCL_ERROR_CHECKING
 #endif
 
+// ncclCommSplit is only supported from NCCL 2.18.
+#if defined(NCCL_MAJOR) && (NCCL_MAJOR == 2) && defined(NCCL_MINOR) && \
+    (NCCL_MINOR >= 18)
+#define NCCL_HAS_COMM_SPLIT
+#elif defined(NCCL_MAJOR) && (NCCL_MAJOR >= 3)
+#define NCCL_HAS_COMM_SPLIT
+#endif
+
 // P2P is enabled only for NCCL versions 2.7+ since ncclSend()
 // and ncclRecv() are not supported in earlier versions.
 #if defined(NCCL_MAJOR) && (NCCL_MAJOR == 2) && defined(NCCL_MINOR) && \
@@ -47,6 +55,14 @@ const inline char* getNcclErrorDetailStr(ncclResult_t error) {
 #define ENABLE_NCCL_P2P_SUPPORT
 #endif
 
+// Capturing NCCL kernels into CUDA graphs is supported since NCCL 2.9.6.
+#if defined(NCCL_MAJOR) && (NCCL_MAJOR == 2) && defined(NCCL_MINOR) && \
+    ((NCCL_MINOR > 9) || ((NCCL_MINOR == 9) && defined(NCCL_PATCH) && (NCCL_PATCH >= 6)))
+#define ENABLE_NCCL_GRAPH_CAPTURE
+#elif defined(NCCL_MAJOR) && (NCCL_MAJOR >= 3)
+#define ENABLE_NCCL_GRAPH_CAPTURE
+#endif
+
 // Macro to throw on a non-successful NCCL return value.
 #define C10D_NCCL_CHECK(cmd)                                                  \
   do {                                                                        \
@@ -115,6 +131,25 @@ class NCCLComm {
     return comm;
   }
 
+#ifdef NCCL_HAS_COMM_SPLIT
+  // Derives a communicator among the ranks of source that pass the same
+  // color, ordered by key, without going through the bootstrap of
+  // ncclCommInitRank. Every rank of source must call it, those not in any new
+  // communicator with NCCL_SPLIT_NOCOLOR, and get a null ncclComm_. commId
+  // is not used by NCCL, it only identifies the communicator in the store.
+  static std::shared_ptr<NCCLComm> split(
+      NCCLComm* source,
+      int color,
+      int key,
+      ncclUniqueId commId) {
+    auto comm = std::make_shared<NCCLComm>();
+    C10D_NCCL_CHECK(ncclCommSplit(
+        source->getNcclComm(), color, key, &(comm->ncclComm_), nullptr));
+    comm->ncclId_ = commId;
+    return comm;
+  }
+#endif
+
   ncclUniqueId getNcclId() {
     return ncclId_;
   }
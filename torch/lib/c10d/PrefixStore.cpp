@@ -38,6 +38,17 @@ std::vector<uint8_t> PrefixStore::get(const std::string& key) {
   return store_->get(joinKey(key));
 }
 
+std::vector<std::vector<uint8_t>> PrefixStore::multiGet(
+    const std::vector<std::string>& keys) {
+  return store_->multiGet(joinKeys(keys));
+}
+
+void PrefixStore::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  store_->multiSet(joinKeys(keys), values);
+}
+
 int64_t PrefixStore::add(const std::string& key, int64_t value) {
   return store_->add(joinKey(key), value);
 }
@@ -22,6 +22,13 @@ class PrefixStore : public Store {
 
   std::vector<uint8_t> get(const std::string& key) override;
 
+  std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys) override;
+
+  void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values) override;
+
   int64_t add(const std::string& key, int64_t value) override;
 
   bool deleteKey(const std::string& key) override;
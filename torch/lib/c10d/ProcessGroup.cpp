@@ -184,4 +184,26 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroup::allgather_coalesced(
       "no support for allgather_coalesced in this process group");
 }
 
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroup::broadcast_coalesced(
+    std::vector<at::Tensor>& /* unused */,
+    const BroadcastOptions& /* unused */) {
+  throw std::runtime_error(
+      "no support for broadcast_coalesced in this process group");
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroup::reduce_scatter_coalesced(
+    std::vector<at::Tensor>& /* unused */,
+    std::vector<std::vector<at::Tensor>>& /* unused */,
+    const ReduceScatterOptions& /* unused */) {
+  throw std::runtime_error(
+      "no support for reduce_scatter_coalesced in this process group");
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroup::alltoall_v(
+    at::Tensor& /* unused */,
+    std::vector<int64_t>& /* unused */,
+    const AllToAllOptions& /* unused */) {
+  throw std::runtime_error("no support for alltoall_v in this process group");
+}
+
 } // namespace c10d
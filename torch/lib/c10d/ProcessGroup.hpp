@@ -236,6 +236,19 @@ class ProcessGroup : public torch::CustomClassHolder {
       std::vector<at::Tensor>& inputTensors,
       const AllgatherOptions& opts = AllgatherOptions());
 
+  // Broadcasts each of the tensors, which may differ in size and type, from
+  // opts.rootRank, issuing the broadcasts together where the backend can.
+  virtual c10::intrusive_ptr<ProcessGroup::Work> broadcast_coalesced(
+      std::vector<at::Tensor>& tensors,
+      const BroadcastOptions& opts = BroadcastOptions());
+
+  // Reduce-scatters each list of inputTensorLists into the corresponding
+  // output tensor, issuing the reductions together where the backend can.
+  virtual c10::intrusive_ptr<ProcessGroup::Work> reduce_scatter_coalesced(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensorLists,
+      const ReduceScatterOptions& opts = ReduceScatterOptions());
+
   virtual c10::intrusive_ptr<ProcessGroup::Work> gather(
       std::vector<std::vector<at::Tensor>>& outputTensors,
       std::vector<at::Tensor>& inputTensors,
@@ -267,6 +280,15 @@ class ProcessGroup : public torch::CustomClassHolder {
     throw std::runtime_error("ProcessGroup does not support alltoall");
   }
 
+  // Sends inputSplitSizes[r] rows of inputTensor, in rank order, to each rank
+  // r, which does not need to know how many rows it receives. result() of the
+  // Work is the rows received, in rank order, followed by a CPU int64 tensor
+  // of how many came from each rank.
+  virtual c10::intrusive_ptr<ProcessGroup::Work> alltoall_v(
+      at::Tensor& inputTensor,
+      std::vector<int64_t>& inputSplitSizes,
+      const AllToAllOptions& opts = AllToAllOptions());
+
   virtual void monitoredBarrier(
       const BarrierOptions& /* unused */, bool /* unused */ = false ) {
     auto backendName = getBackendName();
@@ -1,9 +1,14 @@
 #include <c10d/ProcessGroupGloo.hpp>
 
 #include <c10d/GlooDeviceFactory.hpp>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <exception>
+#include <fstream>
+#include <random>
 #include <ratio>
+#include <sstream>
 #include <tuple>
 
 #ifdef _WIN32
@@ -17,6 +22,12 @@
 #endif
 #include <sys/types.h>
 
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include <type_traits>
 
 #include <gloo/allgather.h>
@@ -637,6 +648,390 @@ std::shared_ptr<::gloo::transport::Device> ProcessGroupGloo::
 }
 #endif
 
+// Note [Shared memory allreduce]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Gloo connects every pair of ranks with TCP, loopback included, so with many
+// ranks per host an allreduce of CPU tensors is bound by the kernel copying
+// the data through sockets rather than by memory bandwidth. With
+// Options::shm_allreduce, the ranks of a host map a common segment of
+// /dev/shm with one slot per rank and a result buffer, and allreduce a dense
+// CPU tensor chunk by chunk:
+//
+//   1. every rank copies its chunk into its slot,
+//   2. every rank reduces its 1/localSize share of the chunk over all slots
+//      into the result buffer,
+//   3. if there is more than one host, the first rank of every host (its
+//      leader) allreduces the result buffer with the other leaders through
+//      Gloo,
+//   4. every rank copies the result buffer into its tensor.
+//
+// The steps are separated by a barrier on per rank counters in the segment.
+// Only leaders talk over the network, with one connection per host pair.
+//
+// The segment is shared by all shm allreduces of the process group, which run
+// one at a time in the order they were issued (the same on all ranks), even
+// though the worker threads may pick them up in a different order.
+class ProcessGroupGloo::IntraNodeReducer {
+ public:
+  // Returns nullptr, on every rank alike, if no two ranks share a host or if
+  // the ranks of some host could not map a common segment.
+  static std::shared_ptr<IntraNodeReducer> create(
+      const c10::intrusive_ptr<Store>& store,
+      ::gloo::rendezvous::Store& glooStore,
+      int rank,
+      int size,
+      const c10::intrusive_ptr<Options>& options);
+
+  ~IntraNodeReducer() {
+#ifdef __linux__
+    munmap(data_, bytes_);
+#endif
+  }
+
+  // Whether allreduce() can handle tensor and op, the other allreduces go
+  // through Gloo.
+  static bool supports(const at::Tensor& tensor, ReduceOp op) {
+    switch (tensor.scalar_type()) {
+      case at::kFloat:
+      case at::kDouble:
+      case at::kChar:
+      case at::kByte:
+      case at::kInt:
+      case at::kLong:
+        break;
+      default:
+        return false;
+    }
+    return op <= ReduceOp::MAX && tensor.layout() == c10::kStrided &&
+        tensor.is_contiguous() && tensor.numel() > 0;
+  }
+
+  // Called from the thread issuing the collectives, in program order.
+  uint64_t nextSequence() {
+    return nextSequence_++;
+  }
+
+  // Set on the leaders if there is more than one host.
+  const std::shared_ptr<::gloo::Context>& leaderContext() const {
+    return leaderContext_;
+  }
+
+  // Allreduces tensor in place, once the allreduces with a smaller sequence
+  // number are done. interNodeAllreduce is step 3 of the note, it gets a view
+  // of the result buffer.
+  void allreduce(
+      at::Tensor& tensor,
+      ReduceOp op,
+      uint64_t sequence,
+      const std::function<void(at::Tensor&)>& interNodeAllreduce);
+
+ private:
+  // Counter of a rank in the segment, on its own cache line.
+  struct alignas(64) Flag {
+    std::atomic<uint64_t> generation;
+  };
+
+  static constexpr size_t kChunkBytes = 1 << 20;
+
+  IntraNodeReducer(
+      void* data,
+      size_t bytes,
+      int localRank,
+      int localSize,
+      bool multiHost,
+      std::chrono::milliseconds timeout)
+      : data_(data),
+        bytes_(bytes),
+        localRank_(localRank),
+        localSize_(localSize),
+        multiHost_(multiHost),
+        timeout_(timeout) {}
+
+  static size_t segmentBytes(int localSize) {
+    return sizeof(Flag) * (localSize + 1) + kChunkBytes * (localSize + 1);
+  }
+
+  Flag* flags() {
+    // The first flag holds the token the leader checks the mapping with.
+    return static_cast<Flag*>(data_) + 1;
+  }
+
+  char* slot(int localRank) {
+    return reinterpret_cast<char*>(flags() + localSize_) +
+        kChunkBytes * localRank;
+  }
+
+  char* result() {
+    return slot(localSize_);
+  }
+
+  void barrier();
+
+  void* const data_;
+  const size_t bytes_;
+  const int localRank_;
+  const int localSize_;
+  const bool multiHost_;
+  const std::chrono::milliseconds timeout_;
+  std::shared_ptr<::gloo::Context> leaderContext_;
+
+  uint64_t generation_ = 0;
+  std::atomic<uint64_t> nextSequence_{0};
+  uint64_t running_ = 0;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+#ifdef __linux__
+namespace {
+
+// Identifies the host, and the boot of it, that shares /dev/shm with us.
+std::string getHostIdentity() {
+  std::array<char, HOST_NAME_MAX> hostname{};
+  if (gethostname(hostname.data(), HOST_NAME_MAX) != 0) {
+    throw std::system_error(errno, std::system_category());
+  }
+  std::string bootId;
+  std::ifstream("/proc/sys/kernel/random/boot_id") >> bootId;
+  return std::string(hostname.data()) + "/" + bootId;
+}
+
+std::string storeKey(const std::string& name, int rank) {
+  return "shm_allreduce/" + name + "/" + std::to_string(rank);
+}
+
+void setString(
+    const c10::intrusive_ptr<Store>& store,
+    const std::string& key,
+    const std::string& value) {
+  store->set(key, std::vector<uint8_t>(value.begin(), value.end()));
+}
+
+std::string getString(
+    const c10::intrusive_ptr<Store>& store,
+    const std::string& key) {
+  const auto value = store->get(key);
+  return std::string(value.begin(), value.end());
+}
+
+} // namespace
+#endif
+
+std::shared_ptr<ProcessGroupGloo::IntraNodeReducer> ProcessGroupGloo::
+    IntraNodeReducer::create(
+        const c10::intrusive_ptr<Store>& store,
+        ::gloo::rendezvous::Store& glooStore,
+        int rank,
+        int size,
+        const c10::intrusive_ptr<Options>& options) {
+#ifndef __linux__
+  TORCH_WARN_ONCE("shm_allreduce is only supported on Linux, ignoring it");
+  return nullptr;
+#else
+  setString(store, storeKey("host", rank), getHostIdentity());
+  std::vector<std::string> hosts;
+  for (int r = 0; r < size; r++) {
+    hosts.push_back(getString(store, storeKey("host", r)));
+  }
+
+  // Ranks of this host, and leaders of all hosts, in rank order.
+  std::vector<int> localRanks;
+  std::vector<int> leaders;
+  std::unordered_map<std::string, int> hostSizes;
+  for (int r = 0; r < size; r++) {
+    if (hosts[r] == hosts[rank]) {
+      localRanks.push_back(r);
+    }
+    if (hostSizes[hosts[r]]++ == 0) {
+      leaders.push_back(r);
+    }
+  }
+  int maxLocalSize = 0;
+  for (const auto& it : hostSizes) {
+    maxLocalSize = std::max(maxLocalSize, it.second);
+  }
+  if (maxLocalSize == 1) {
+    return nullptr;
+  }
+
+  const int leader = localRanks[0];
+  const int localRank =
+      std::find(localRanks.begin(), localRanks.end(), rank) -
+      localRanks.begin();
+  const int localSize = localRanks.size();
+  const auto bytes = segmentBytes(localSize);
+
+  // The leader creates the segment, the others open it by name and check the
+  // token the leader wrote in it, in case /dev/shm is not what they share.
+  void* data = MAP_FAILED;
+  std::string path;
+  uint64_t token = 0;
+  if (rank == leader) {
+    std::random_device rd;
+    token = (static_cast<uint64_t>(rd()) << 32) | rd();
+    path = c10::str("/dev/shm/torch_gloo_", getpid(), "_", token);
+    const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd != -1) {
+      if (ftruncate(fd, bytes) == 0) {
+        data = mmap(
+            nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      }
+      close(fd);
+    }
+    if (data != MAP_FAILED) {
+      static_cast<Flag*>(data)->generation.store(token);
+    }
+    setString(
+        store,
+        storeKey("segment", leader),
+        data != MAP_FAILED ? c10::str(token, " ", path) : "");
+  } else {
+    std::istringstream segment(getString(store, storeKey("segment", leader)));
+    if (segment >> token >> path) {
+      const int fd = open(path.c_str(), O_RDWR);
+      if (fd != -1) {
+        data = mmap(
+            nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+      }
+      if (data != MAP_FAILED &&
+          static_cast<Flag*>(data)->generation.load() != token) {
+        munmap(data, bytes);
+        data = MAP_FAILED;
+      }
+    }
+  }
+
+  setString(store, storeKey("mapped", rank), data != MAP_FAILED ? "1" : "0");
+  bool mapped = true;
+  for (int r = 0; r < size; r++) {
+    mapped = getString(store, storeKey("mapped", r)) == "1" && mapped;
+  }
+  // Everyone of this host has mapped the segment or given up by now.
+  if (rank == leader && !path.empty()) {
+    unlink(path.c_str());
+  }
+  if (!mapped) {
+    if (data != MAP_FAILED) {
+      munmap(data, bytes);
+    }
+    TORCH_WARN(
+        "shm_allreduce could not map a shared memory segment on every host, "
+        "allreduce will go through Gloo");
+    return nullptr;
+  }
+
+  std::shared_ptr<IntraNodeReducer> reducer(new IntraNodeReducer(
+      data,
+      bytes,
+      localRank,
+      localSize,
+      leaders.size() > 1,
+      options->timeout));
+  if (leaders.size() > 1 && rank == leader) {
+    const int hostIndex =
+        std::find(leaders.begin(), leaders.end(), rank) - leaders.begin();
+    auto context = std::make_shared<::gloo::rendezvous::Context>(
+        hostIndex, static_cast<int>(leaders.size()));
+    auto leaderStore =
+        ::gloo::rendezvous::PrefixStore("shm_allreduce", glooStore);
+    context->setTimeout(options->timeout);
+    context->connectFullMesh(leaderStore, options->devices[0]);
+    reducer->leaderContext_ = std::move(context);
+  }
+  return reducer;
+#endif
+}
+
+void ProcessGroupGloo::IntraNodeReducer::barrier() {
+  generation_++;
+  flags()[localRank_].generation.store(generation_, std::memory_order_release);
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < localSize_; i++) {
+    while (flags()[i].generation.load(std::memory_order_acquire) <
+           generation_) {
+      std::this_thread::yield();
+      TORCH_CHECK(
+          std::chrono::steady_clock::now() - start < timeout_,
+          "Timed out waiting for the other ranks of this host in a shared "
+          "memory allreduce");
+    }
+  }
+}
+
+void ProcessGroupGloo::IntraNodeReducer::allreduce(
+    at::Tensor& tensor,
+    ReduceOp op,
+    uint64_t sequence,
+    const std::function<void(at::Tensor&)>& interNodeAllreduce) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [&] { return running_ == sequence; });
+  lock.unlock();
+  auto done = [&]() {
+    lock.lock();
+    running_++;
+    lock.unlock();
+    cv_.notify_all();
+  };
+
+  try {
+    const auto flat = tensor.view(-1);
+    const auto options = tensor.options();
+    const int64_t chunkNumel = kChunkBytes / tensor.element_size();
+    for (int64_t offset = 0; offset < flat.numel(); offset += chunkNumel) {
+      const auto n = std::min(chunkNumel, flat.numel() - offset);
+      at::from_blob(slot(localRank_), {n}, options)
+          .copy_(flat.narrow(0, offset, n));
+      barrier();
+
+      const auto begin = n * localRank_ / localSize_;
+      const auto end = n * (localRank_ + 1) / localSize_;
+      if (end > begin) {
+        auto acc = at::from_blob(result(), {n}, options)
+                       .narrow(0, begin, end - begin);
+        for (int i = 0; i < localSize_; i++) {
+          const auto other = at::from_blob(slot(i), {n}, options)
+                                 .narrow(0, begin, end - begin);
+          if (i == 0) {
+            acc.copy_(other);
+            continue;
+          }
+          switch (op) {
+            case ReduceOp::SUM:
+              acc.add_(other);
+              break;
+            case ReduceOp::PRODUCT:
+              acc.mul_(other);
+              break;
+            case ReduceOp::MIN:
+              at::minimum_out(acc, acc, other);
+              break;
+            case ReduceOp::MAX:
+              at::maximum_out(acc, acc, other);
+              break;
+            default:
+              TORCH_INTERNAL_ASSERT(false, "Unsupported ReduceOp");
+          }
+        }
+      }
+      barrier();
+
+      auto reduced = at::from_blob(result(), {n}, options);
+      if (multiHost_) {
+        if (leaderContext_) {
+          interNodeAllreduce(reduced);
+        }
+        barrier();
+      }
+      flat.narrow(0, offset, n).copy_(reduced);
+    }
+  } catch (...) {
+    done();
+    throw;
+  }
+  done();
+}
+
 ProcessGroupGloo::ProcessGroupGloo(
     const c10::intrusive_ptr<Store>& store,
     int rank,
@@ -673,6 +1068,11 @@ ProcessGroupGloo::ProcessGroupGloo(
     contexts_.push_back(std::move(context));
   }
 
+  if (options->shm_allreduce) {
+    intraNodeReducer_ =
+        IntraNodeReducer::create(store, *store_, rank_, size_, options);
+  }
+
   // Every worker thread stores the AsyncWork object it's currently
   // working on in the workInProgress_ vector. It must have size equal
   // to the number of workers such that they can simply index into it
@@ -952,6 +1352,35 @@ class AsyncAllreduceWork : public ProcessGroupGloo::AsyncWork {
   std::vector<at::Tensor> outputs_;
 };
 
+class AsyncShmAllreduceWork : public AsyncAllreduceWork {
+ public:
+  AsyncShmAllreduceWork(
+      const std::shared_ptr<gloo::Context>& context,
+      std::vector<at::Tensor>& inputs,
+      ReduceOp reduceOp,
+      uint32_t tag,
+      std::shared_ptr<ProcessGroupGloo::IntraNodeReducer> reducer)
+      : AsyncAllreduceWork(context, inputs, reduceOp, tag),
+        reducer(std::move(reducer)),
+        sequence(this->reducer->nextSequence()) {}
+
+  const std::shared_ptr<ProcessGroupGloo::IntraNodeReducer> reducer;
+  const uint64_t sequence;
+
+  void run() override {
+    reducer->allreduce(
+        inputs[0], reduceOp, sequence, [&](at::Tensor& reduced) {
+          const auto& scalarType = reduced.scalar_type();
+          gloo::AllreduceOptions opts(reducer->leaderContext());
+          opts.setReduceFunction(getFunction(scalarType, reduceOp));
+          opts.setTag(tag);
+          GENERATE_ALL_TYPES(scalarType, setOutput, opts, reduced);
+          gloo::allreduce(opts);
+        });
+    outputs_ = inputs;
+  }
+};
+
 class AsyncAllreduceCoalescedWork : public AsyncAllreduceWork {
  public:
   AsyncAllreduceCoalescedWork(
@@ -1117,15 +1546,18 @@ class AsyncSparseAllreduceWork : public ProcessGroupGloo::AsyncWork {
     // Perform global reduction.
     AT_ASSERT(static_cast<int>(indices.size()) == context->size);
     AT_ASSERT(static_cast<int>(values.size()) == context->size);
-    auto output = at::sparse_coo_tensor(
-        indices[0], values[0], input.sizes(), input.options());
-    for (auto i = 1; i < context->size; i++) {
-      output += at::sparse_coo_tensor(
-          indices[i], values[i], input.sizes(), input.options());
-    }
-
-    // Coalesce for good measure.
-    return output.coalesce();
+    // Sum the entries of all ranks at once instead of adding the tensors one
+    // rank at a time, which merges an ever larger partial sum per rank.
+    at::Tensor outputIndices, inverse;
+    std::tie(outputIndices, inverse) =
+        uniqueSparseIndices(at::cat(indices, 1), input.sizes());
+    auto outputValuesSizes = input._values().sizes().vec();
+    outputValuesSizes[0] = outputIndices.size(1);
+    auto outputValues = at::zeros(outputValuesSizes, input._values().options());
+    outputValues.index_add_(0, inverse, at::cat(values, 0));
+    return at::_sparse_coo_tensor_unsafe(
+               outputIndices, outputValues, input.sizes(), input.options())
+        ._coalesced_(true);
   }
 
   void run() override {
@@ -1416,7 +1848,11 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce(
   auto tag = nextTag();
   auto context = getContext(tag);
   if (device.type() == at::kCPU) {
-    if (layout == c10::kStrided) {
+    if (intraNodeReducer_ && inputs.size() == 1 &&
+        IntraNodeReducer::supports(inputs[0], opts.reduceOp)) {
+      work = c10::make_intrusive<AsyncShmAllreduceWork>(
+          std::move(context), inputs, opts.reduceOp, tag, intraNodeReducer_);
+    } else if (layout == c10::kStrided) {
       work = c10::make_intrusive<AsyncAllreduceWork>(
           std::move(context), inputs, opts.reduceOp, tag);
     } else if (layout == c10::kSparse) {
@@ -144,12 +144,19 @@ class ProcessGroupGloo : public ProcessGroup {
 
     std::vector<std::shared_ptr<::gloo::transport::Device>> devices;
     int threads;
+
+    // Reduce dense CPU tensors among the ranks of a host through shared
+    // memory, see Note [Shared memory allreduce]. Linux only.
+    bool shm_allreduce = false;
   };
 
   const std::string getBackendName() const override {
     return std::string(GLOO_BACKEND_NAME);
   }
 
+  // Reduces among the ranks of a host through shared memory.
+  class IntraNodeReducer;
+
   // Helper functions to create a new device object.
   // They are static functions on this class to keep them logically
   // separate from the rest of the code base (e.g. torch/csrc/distributed).
@@ -284,6 +291,10 @@ class ProcessGroupGloo : public ProcessGroup {
   // to contexts being used in a round-robin fashion.
   std::shared_ptr<::gloo::Context> getContext(uint32_t tag);
 
+  // Set if options_->shm_allreduce is true and the ranks of each host could
+  // share memory, see Note [Shared memory allreduce].
+  std::shared_ptr<IntraNodeReducer> intraNodeReducer_;
+
   // Entrypoint for worker threads.
   void runLoop(int workerIndex);
 
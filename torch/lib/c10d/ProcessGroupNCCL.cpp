@@ -1,13 +1,22 @@
 #include <c10d/ProcessGroupNCCL.hpp>
 
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
 #include <exception>
 #include <map>
 #include <tuple>
 #include <unordered_set>
 
+#include <unistd.h>
+
 #include <THC/THC.h>
 
+#include <ATen/SparseTensorUtils.h>
+#include <ATen/core/Vitals.h>
 #include <ATen/cuda/CUDAContext.h>
+#include <c10/cuda/CUDAGraphsC10Utils.h>
 #include <c10/cuda/CUDAGuard.h>
 #include <c10/util/Logging.h>
 #include <torch/csrc/cuda/nccl.h>
@@ -152,6 +161,34 @@ void syncStreams(
   }
 }
 
+// Note [CUDA graph capture of collectives]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// A collective issued while the current stream is being captured into a CUDA
+// graph is captured too: syncStreams makes the NCCL stream join the capture,
+// and WorkNCCL::wait joins it back into the capturing stream. Everything that
+// would run outside of the graph must be avoided though:
+// - The NCCL communicator must already exist, since creating it synchronizes
+//   with the other ranks. Running the collective once before the capture (as
+//   the warmup iterations of a captured training step do) creates it.
+// - Events recorded during the capture can't be queried, so the work is not
+//   handed to the watchdog thread, and wait() doesn't block on its completion
+//   even with NCCL_BLOCKING_WAIT. Errors and timeouts of replays are not
+//   detected by the process group.
+// Capturing NCCL kernels needs NCCL 2.9.6 or newer.
+
+// Whether the current stream of the first device is captured into a CUDA
+// graph, see Note [CUDA graph capture of collectives]
+bool isCapturing(const std::vector<at::Device>& devices) {
+#if defined(CUDA_VERSION) && CUDA_VERSION >= 11000
+  cudaStreamCaptureStatus status;
+  C10_CUDA_CHECK(cudaStreamIsCapturing(
+      at::cuda::getCurrentCUDAStream(devices[0].index()), &status));
+  return status != cudaStreamCaptureStatusNone;
+#else
+  return false;
+#endif
+}
+
 // Given a ncclUniqueId, convert it to a string representation that can be put
 // in the store.
 std::string buildNcclUniqueIdStr(const ncclUniqueId& ncclID) {
@@ -334,8 +371,9 @@ void ProcessGroupNCCL::WorkNCCL::synchronizeInternal(
     std::chrono::milliseconds timeout) {
   synchronizeStreams();
 
-  // In case of blocking, wait for the operation to complete.
-  if (blockingWait_) {
+  // In case of blocking, wait for the operation to complete. Not while
+  // capturing, see Note [CUDA graph capture of collectives]
+  if (blockingWait_ && !isCapturing(devices_)) {
     // Use the passed in timeout if provided, otherwise use the default
     // opTimeout for each WorkNCCL object.
     std::chrono::milliseconds workTimeout =
@@ -425,6 +463,11 @@ ProcessGroupNCCL::ProcessGroupNCCL(
       terminateProcessGroup_(false) {
   TORCH_CHECK(at::cuda::getNumGPUs() != 0,
     "ProcessGroupNCCL is only supported with GPUs, no GPUs found!");
+  TORCH_CHECK(
+      options_->collective_trace_size >= 0,
+      "collective_trace_size must be non-negative, got ",
+      options_->collective_trace_size);
+  traceBuffer_.resize(options_->collective_trace_size);
   blockingWait_ = parseEnvVarFlag(NCCL_BLOCKING_WAIT);
   asyncErrorHandling_ = parseEnvVarFlag(NCCL_ASYNC_ERROR_HANDLING);
 
@@ -458,7 +501,12 @@ ProcessGroupNCCL::ProcessGroupNCCL(
             << "\nTIMEOUT(ms): " << options_->timeout.count()
             << "\nUSE_HIGH_PRIORITY_STREAM: "
             << options_->is_high_priority_stream
+            << "\nCOLLECTIVE_TRACE_SIZE: " << options_->collective_trace_size
             << "\nNCCL_DEBUG: " << ncclDebugLevel;
+
+  if (options_->eager_init_device) {
+    eagerInitNCCLComm(*options_->eager_init_device);
+  }
 }
 
 ProcessGroupNCCL::~ProcessGroupNCCL() {
@@ -860,7 +908,16 @@ std::vector<std::shared_ptr<NCCLComm>>& ProcessGroupNCCL::getNCCLComm(
     C10D_NCCL_CHECK(ncclGroupStart());
   }
 
-  ncclStreams_.emplace(devicesKey, std::move(streamVal));
+  return cacheNCCLComms(
+      devicesKey, devices, std::move(ncclComms), std::move(streamVal));
+}
+
+std::vector<std::shared_ptr<NCCLComm>>& ProcessGroupNCCL::cacheNCCLComms(
+    const std::string& devicesKey,
+    const std::vector<at::Device>& devices,
+    std::vector<std::shared_ptr<NCCLComm>> ncclComms,
+    std::vector<at::cuda::CUDAStream> streams) {
+  ncclStreams_.emplace(devicesKey, std::move(streams));
 
   // Note: these events are created with the (default) cudaEventDisableTiming
   // flag This flag provides the best performance when used with
@@ -875,13 +932,216 @@ std::vector<std::shared_ptr<NCCLComm>>& ProcessGroupNCCL::getNCCLComm(
   std::lock_guard<std::mutex> lock(mutex_);
 
   // Record the communicators based on ncclUniqueId.
-  ncclIdToCommMap_.emplace(buildNcclUniqueIdStr(ncclID), ncclComms);
+  ncclIdToCommMap_.emplace(
+      buildNcclUniqueIdStr(ncclComms.front()->getNcclId()), ncclComms);
 
   // Move the NCCL resource to cache
   devNCCLCommMap_.emplace(devicesKey, std::move(ncclComms));
   return devNCCLCommMap_[devicesKey];
 }
 
+// Note [Eager NCCL communicator init]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// By default communicators are created by the first collective on a set of
+// devices, so the first step of a job also pays for the ncclUniqueId exchange
+// through the store and the bootstrap of ncclCommInitRank, at a different
+// time on every rank. With Options::eager_init_device the communicator of
+// that device is created in the constructor instead, where all ranks
+// synchronize anyway, and collectives on that device find it cached.
+//
+// A process group created with Options::split_from as well derives its
+// communicator from the one of split_from with ncclCommSplit, which reuses
+// the connections split_from already set up instead of bootstrapping new
+// ones. ncclCommSplit is collective over split_from, so its ranks that are
+// not part of the new group call performNocolorSplit. The store is still used
+// to agree on an ncclUniqueId, but only as the name under which the watchdog
+// reports the communicator as aborted to the other ranks.
+void ProcessGroupNCCL::eagerInitNCCLComm(const at::Device& device) {
+  TORCH_CHECK(
+      device.is_cuda(),
+      "ProcessGroupNCCL can only eagerly initialize CUDA devices, got ",
+      device);
+  const std::vector<at::Device> devices{device};
+  const auto devicesKey = getKeyFromDevices(devices);
+#ifdef NCCL_HAS_COMM_SPLIT
+  if (options_->split_from) {
+    auto& parentComms = options_->split_from->getNCCLComm(
+        devicesKey, devices, OpType::ALLREDUCE);
+    usedDeviceIdxs_.insert(device.index());
+
+    ncclUniqueId ncclID;
+    if (rank_ == 0) {
+      C10D_NCCL_CHECK(ncclGetUniqueId(&ncclID));
+    }
+    broadcastUniqueNCCLID(&ncclID, OpType::ALLREDUCE, devicesKey, 0);
+
+    at::cuda::OptionalCUDAGuard gpuGuard(device);
+    std::vector<std::shared_ptr<NCCLComm>> ncclComms{NCCLComm::split(
+        parentComms.front().get(), /*color=*/0, /*key=*/rank_, ncclID)};
+    std::vector<at::cuda::CUDAStream> streams{
+        at::cuda::getStreamFromPool(options_->is_high_priority_stream)};
+    cacheNCCLComms(
+        devicesKey, devices, std::move(ncclComms), std::move(streams));
+    return;
+  }
+#endif
+  getNCCLComm(devicesKey, devices, OpType::ALLREDUCE);
+}
+
+void ProcessGroupNCCL::performNocolorSplit(const at::Device& device) {
+#ifdef NCCL_HAS_COMM_SPLIT
+  const std::vector<at::Device> devices{device};
+  auto& ncclComms =
+      getNCCLComm(getKeyFromDevices(devices), devices, OpType::ALLREDUCE);
+  at::cuda::OptionalCUDAGuard gpuGuard(device);
+  // The returned communicator is null, there is nothing to keep.
+  NCCLComm::split(
+      ncclComms.front().get(),
+      NCCL_SPLIT_NOCOLOR,
+      rank_,
+      ncclComms.front()->getNcclId());
+#endif
+}
+
+// Note [Hierarchical allreduce]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// With Options::hierarchical_allreduce, allreduce of a single tensor per
+// process runs in three steps, so that only 1/localSize of the data crosses
+// the (slower) links between hosts:
+//   1. ncclReduceScatter among the localSize ranks of the host, after which
+//      local rank i holds the sum over the host of the i-th chunk,
+//   2. ncclAllReduce of that chunk among the ranks with local rank i on every
+//      host,
+//   3. ncclAllGather of the chunks among the ranks of the host.
+// Ranks are grouped by the hostname they publish to the store, so the
+// topology needs no configuration. It must be uniform (the same number of
+// ranks on every host) for the chunks to line up, otherwise, or with a single
+// host or a single rank per host, allreduce stays flat. All the steps run in
+// place on the NCCL stream of the flat communicator, which is still used for
+// the numel % localSize elements that do not fill a chunk.
+const ProcessGroupNCCL::HierarchicalTopology& ProcessGroupNCCL::
+    getHierarchicalTopology() {
+  if (hierarchicalTopology_) {
+    return *hierarchicalTopology_;
+  }
+  char hostname[HOST_NAME_MAX + 1] = {0};
+  TORCH_CHECK(
+      gethostname(hostname, HOST_NAME_MAX) == 0,
+      "gethostname failed: ",
+      strerror(errno));
+  const std::string keyPrefix = "hierarchical_allreduce/host/";
+  store_->set(
+      keyPrefix + std::to_string(rank_),
+      std::vector<uint8_t>(hostname, hostname + strlen(hostname)));
+
+  // Hosts in the order of their lowest rank, and the ranks of each host
+  std::vector<std::string> hosts;
+  std::vector<std::vector<int>> hostRanks;
+  int myHost = 0;
+  for (int rank = 0; rank < size_; ++rank) {
+    const auto value = store_->get(keyPrefix + std::to_string(rank));
+    const std::string host(value.begin(), value.end());
+    const auto it = std::find(hosts.begin(), hosts.end(), host);
+    const int index = it - hosts.begin();
+    if (it == hosts.end()) {
+      hosts.push_back(host);
+      hostRanks.emplace_back();
+    }
+    hostRanks[index].push_back(rank);
+    if (rank == rank_) {
+      myHost = index;
+    }
+  }
+
+  HierarchicalTopology topology;
+  topology.nodeRank = myHost;
+  topology.numNodes = hosts.size();
+  topology.localSize = hostRanks[myHost].size();
+  topology.localRank =
+      std::find(hostRanks[myHost].begin(), hostRanks[myHost].end(), rank_) -
+      hostRanks[myHost].begin();
+  topology.hostRanks = hostRanks;
+  topology.enabled = topology.numNodes > 1 && topology.localSize > 1 &&
+      std::all_of(hostRanks.begin(),
+                  hostRanks.end(),
+                  [&](const std::vector<int>& ranks) {
+                    return static_cast<int>(ranks.size()) ==
+                        topology.localSize;
+                  });
+  if (!topology.enabled) {
+    LOG(INFO) << "[Rank " << rank_ << "] Hierarchical allreduce needs the same "
+              << "number of ranks, more than one, on more than one host. "
+              << "Falling back to flat allreduce.";
+  }
+  hierarchicalTopology_ = topology;
+  return *hierarchicalTopology_;
+}
+
+std::pair<std::shared_ptr<NCCLComm>, std::shared_ptr<NCCLComm>>
+ProcessGroupNCCL::getHierarchicalNCCLComms(
+    const std::string& devicesKey,
+    const at::Device& device) {
+  const auto& topology = getHierarchicalTopology();
+  if (!topology.enabled) {
+    return {nullptr, nullptr};
+  }
+  const auto intraKey = devicesKey + "/hierarchical_intra";
+  const auto interKey = devicesKey + "/hierarchical_inter";
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto intra = devNCCLCommMap_.find(intraKey);
+    auto inter = devNCCLCommMap_.find(interKey);
+    if (intra != devNCCLCommMap_.end() && inter != devNCCLCommMap_.end()) {
+      return {intra->second[0], inter->second[0]};
+    }
+  }
+
+  // Every rank creates its intra-host communicator first, so the blocking
+  // ncclCommInitRank calls cannot wait on each other across the two kinds.
+  const auto counter = std::to_string(hierarchicalCommCounter_++);
+  at::cuda::OptionalCUDAGuard gpuGuard(device);
+  auto createComm = [&](const std::string& storeKey, int numRanks, int rank) {
+    ncclUniqueId ncclID;
+    if (rank == 0) {
+      C10D_NCCL_CHECK(ncclGetUniqueId(&ncclID));
+      store_->set(
+          storeKey,
+          std::vector<uint8_t>(
+              reinterpret_cast<uint8_t*>(&ncclID),
+              reinterpret_cast<uint8_t*>(&ncclID) + NCCL_UNIQUE_ID_BYTES));
+    } else {
+      auto vec = store_->get(storeKey);
+      TORCH_CHECK(vec.size() == NCCL_UNIQUE_ID_BYTES);
+      std::memcpy(&ncclID, vec.data(), vec.size());
+    }
+    auto comm = NCCLComm::create(numRanks, rank, ncclID);
+    std::lock_guard<std::mutex> lock(mutex_);
+    ncclIdToCommMap_.emplace(
+        buildNcclUniqueIdStr(ncclID),
+        std::vector<std::shared_ptr<NCCLComm>>{comm});
+    return comm;
+  };
+  auto intra = createComm(
+      "hierarchical_allreduce/intra/" + counter + "/" +
+          std::to_string(topology.nodeRank),
+      topology.localSize,
+      topology.localRank);
+  auto inter = createComm(
+      "hierarchical_allreduce/inter/" + counter + "/" +
+          std::to_string(topology.localRank),
+      topology.numNodes,
+      topology.nodeRank);
+
+  // Cached with the other communicators, so that the watchdog checks them
+  // for errors and they are aborted with the process group.
+  std::lock_guard<std::mutex> lock(mutex_);
+  devNCCLCommMap_.emplace(
+      intraKey, std::vector<std::shared_ptr<NCCLComm>>{intra});
+  devNCCLCommMap_.emplace(
+      interKey, std::vector<std::shared_ptr<NCCLComm>>{inter});
+  return {intra, inter};
+}
+
 namespace {
 
 // Check validity of tensor
@@ -934,6 +1194,27 @@ void check_gpu_tensors(const std::vector<at::Tensor>& tensors) {
   }
 }
 
+// Check that all `tensors' of a coalesced collective are on the same GPU. Unlike
+// check_gpu_tensors, they may differ in type and shape.
+void check_coalesced_gpu_tensors(const std::vector<at::Tensor>& tensors) {
+  if (tensors.size() == 0) {
+    throw std::runtime_error("Tensor list must be nonempty");
+  }
+  const auto device = tensors.front().device();
+  for (const auto& t : tensors) {
+    if (!t.is_cuda() || t.is_sparse()) {
+      throw std::runtime_error("Tensors must be CUDA and dense");
+    }
+    if (!t.is_non_overlapping_and_dense()) {
+      throw std::runtime_error("Tensors must be non-overlapping and dense");
+    }
+    if (t.device() != device) {
+      throw std::runtime_error(
+          "Tensors of a coalesced collective must be on the same GPU device");
+    }
+  }
+}
+
 // Flatten each list in `tensor_lists' for a gather or scatter operation, and
 // ensure compatibility with the corresponding tensor in `other'.
 std::vector<at::Tensor> flatten_for_scatter_gather(
@@ -1013,6 +1294,62 @@ ProcessGroupNCCL::Options::Options(
     : ProcessGroup::Options(timeout, NCCL_BACKEND_NAME),
       is_high_priority_stream(is_high_priority_stream) {}
 
+// Note [Collective tracing]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~
+// With Options::collective_trace_size, every collective records its type,
+// size and enqueue time, and a pair of timing events around its NCCL calls on
+// the stream of its first device, in a ring buffer of that many entries.
+// Nothing waits on the events, they are only read when the traces are.
+//
+// A collective completes at about the same time on all ranks, since none can
+// finish before the last one joins. The start event of a rank marks when it
+// joined: when its NCCL stream reached the collective, which accounts both
+// for the host enqueueing it late and for the compute queued before it. So
+// the longer a rank's collective took, the earlier it joined, and the
+// difference with the longest one is how long the others waited for it,
+// without relying on the clocks of the hosts being in sync.
+// gatherCollectiveTraces exchanges the traces of all ranks through the store
+// to compute that skew for each collective and name the rank that joined
+// last. Point-to-point operations are not traced, as ranks run different
+// ones.
+std::shared_ptr<ProcessGroupNCCL::TraceEntry> ProcessGroupNCCL::traceStart(
+    OpType opType,
+    const std::vector<at::Tensor>& inputs,
+    at::cuda::CUDAStream& stream) {
+  if (traceBuffer_.empty()) {
+    return nullptr;
+  }
+  auto entry = std::make_shared<TraceEntry>();
+  entry->trace.opType = opType;
+  entry->trace.numel = 0;
+  entry->trace.bytes = 0;
+  for (const auto& input : inputs) {
+    entry->trace.numel += input.numel();
+    entry->trace.bytes += input.numel() * input.element_size();
+  }
+  entry->trace.enqueueTimeUs =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  entry->trace.durationUs = -1;
+  entry->start.record(stream);
+  return entry;
+}
+
+void ProcessGroupNCCL::traceEnd(
+    const std::shared_ptr<TraceEntry>& entry,
+    at::cuda::CUDAStream& stream) {
+  if (!entry) {
+    return;
+  }
+  entry->end.record(stream);
+  // Only published once both events are recorded, so getCollectiveTraces
+  // never reads an event being recorded.
+  std::lock_guard<std::mutex> lock(traceMutex_);
+  entry->trace.seq = traceSeq_++;
+  traceBuffer_[entry->trace.seq % traceBuffer_.size()] = entry;
+}
+
 template <typename Fn, typename PreProcess, typename PostProcess>
 c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::collective(
     std::vector<at::Tensor>& inputs,
@@ -1024,6 +1361,22 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::collective(
     const char* profilingTitle) {
   const auto devices = getDeviceList(inputs);
   const auto key = getKeyFromDevices(devices);
+  TORCH_VITAL_RECORD(
+      "nccl.collective_bytes", static_cast<int64_t>(inputs[0].nbytes()));
+
+  // See Note [CUDA graph capture of collectives]
+  const bool capturing = isCapturing(devices);
+  if (capturing) {
+#ifndef ENABLE_NCCL_GRAPH_CAPTURE
+    TORCH_CHECK(false, "Capturing NCCL collectives into CUDA graphs needs NCCL 2.9.6 or newer");
+#endif
+    std::lock_guard<std::mutex> lock(mutex_);
+    TORCH_CHECK(
+        devNCCLCommMap_.find(key) != devNCCLCommMap_.end(),
+        "NCCL communicators can't be created during CUDA graph capture, "
+        "run the collective once before capturing it");
+  }
+
   auto& ncclComms = getNCCLComm(key, devices, opType);
 
   // First let NCCL streams wait for input tensors allocation streams
@@ -1056,6 +1409,10 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::collective(
         inputs[i].storage().data_ptr(), ncclStream);
   }
 
+  // See Note [Collective tracing]
+  const auto traceEntry =
+      capturing ? nullptr : traceStart(opType, inputs, ncclStreams_[key][0]);
+
   {
     AutoNcclGroup nccl_group_guard;
     for (size_t i = 0; i < inputs.size(); ++i) {
@@ -1066,6 +1423,8 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::collective(
     }
   }
 
+  traceEnd(traceEntry, ncclStreams_[key][0]);
+
   post(ncclStreams_[key]);
 
   // Event should only be recorded after the ncclGroupEnd()
@@ -1098,7 +1457,111 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::collective(
     work->recordFunctionEndCallback_();
   }
 
-  if (asyncErrorHandling_) {
+  if (asyncErrorHandling_ && !capturing) {
+    workEnqueue(work);
+  }
+
+  return work;
+}
+
+// Note [Coalesced collectives]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// The *_coalesced collectives take many tensors, typically small ones like the
+// biases and norm weights of a model, on a single GPU. Rather than flattening
+// them into a buffer and copying the result back, which costs two extra
+// kernels and the memory of the buffer, they issue one NCCL call per tensor
+// between ncclGroupStart and ncclGroupEnd, so that NCCL launches them together
+// on the same communicator and stream. Each tensor keeps its own type and
+// shape, and the whole group completes as a single Work.
+template <typename Fn>
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::collectiveCoalesced(
+    std::vector<at::Tensor>& inputs,
+    std::vector<at::Tensor>& outputs,
+    size_t numCalls,
+    Fn fn,
+    OpType opType,
+    const char* profilingTitle) {
+  const std::vector<at::Device> devices{inputs.front().device()};
+  const auto key = getKeyFromDevices(devices);
+  if (at::vitals::vitalCountersEnabled()) {
+    int64_t bytes = 0;
+    for (const auto& input : inputs) {
+      bytes += static_cast<int64_t>(input.nbytes());
+    }
+    TORCH_VITAL_RECORD("nccl.collective_bytes", bytes);
+  }
+
+  // See Note [CUDA graph capture of collectives]
+  const bool capturing = isCapturing(devices);
+  if (capturing) {
+#ifndef ENABLE_NCCL_GRAPH_CAPTURE
+    TORCH_CHECK(false, "Capturing NCCL collectives into CUDA graphs needs NCCL 2.9.6 or newer");
+#endif
+    std::lock_guard<std::mutex> lock(mutex_);
+    TORCH_CHECK(
+        devNCCLCommMap_.find(key) != devNCCLCommMap_.end(),
+        "NCCL communicators can't be created during CUDA graph capture, "
+        "run the collective once before capturing it");
+  }
+
+  auto& ncclComms = getNCCLComm(key, devices, opType);
+
+  // First let NCCL streams wait for input tensors allocation streams
+  syncStreams(devices, ncclEvents_[key], ncclStreams_[key]);
+
+  auto work = initWork(devices, rank_, opType, profilingTitle, inputs);
+
+  // Store references to outputs to be used by WorkNCCL::result and operator<<.
+  work->outputs_ = std::make_shared<std::vector<at::Tensor>>(outputs);
+
+  at::cuda::OptionalCUDAGuard gpuGuard(devices[0]);
+  at::cuda::CUDAStream& ncclStream = ncclStreams_[key][0];
+
+  // See [Sync Streams].
+  for (const auto& tensor : inputs) {
+    c10::cuda::CUDACachingAllocator::recordStream(
+        tensor.storage().data_ptr(), ncclStream);
+  }
+  for (const auto& tensor : outputs) {
+    c10::cuda::CUDACachingAllocator::recordStream(
+        tensor.storage().data_ptr(), ncclStream);
+  }
+
+  // See Note [Collective tracing]
+  const auto traceEntry =
+      capturing ? nullptr : traceStart(opType, inputs, ncclStream);
+
+  {
+    AutoNcclGroup nccl_group_guard;
+    for (size_t i = 0; i < numCalls; ++i) {
+      C10D_NCCL_CHECK(fn(i, ncclComms[0]->getNcclComm(), ncclStream));
+    }
+  }
+
+  traceEnd(traceEntry, ncclStream);
+
+  // Event should only be recorded after the ncclGroupEnd()
+  (*work->cudaEvents_)[0].record(ncclStream);
+  work->ncclComms_[0] = ncclComms[0];
+
+  {
+    at::cuda::CUDAMultiStreamGuard streamGuard(ncclStreams_[key]);
+    work->future_ = c10::make_intrusive<at::cuda::CUDAFuture>(
+        c10::ListType::create(c10::TensorType::get()));
+    work->future_->markCompleted(at::IValue(*work->outputs_));
+  }
+
+  // Set appropriate work parameters.
+  work->blockingWait_ = blockingWait_;
+  work->opTimeout_ = options_->timeout;
+  work->store_ = store_;
+
+  if (work->recordFunctionEndCallback_) {
+    // See the comment in collective().
+    work->recordFunctionEndCallback_();
+  }
+
+  if (asyncErrorHandling_ && !capturing) {
     workEnqueue(work);
   }
 
@@ -1214,11 +1677,146 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::pointToPoint(
       [](std::vector<at::cuda::CUDAStream>&) {});
 }
 
+// Note [Sparse allreduce]
+// ~~~~~~~~~~~~~~~~~~~~~~~
+// Sparse gradients, e.g. of embeddings, are allreduced by gathering the
+// indices of all ranks, which are small next to the values, and deduping them
+// on every rank the same way (see uniqueSparseIndices). Each rank then adds
+// its own values at the positions of its indices in a dense buffer of the
+// union, and a plain allreduce of that buffer sums the values of all ranks.
+// The indices are padded to the largest nnz for the allgather, so the nnz of
+// the ranks are gathered first, which is the only host sync of the op.
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce_sparse(
+    at::Tensor& tensor,
+    const AllreduceOptions& opts) {
+  TORCH_CHECK(
+      tensor.is_cuda(), "ProcessGroupNCCL only supports CUDA sparse tensors");
+  TORCH_CHECK(
+      opts.reduceOp == ReduceOp::SUM,
+      "ProcessGroupNCCL only supports sparse allreduce with ReduceOp.SUM");
+
+  const auto input = tensor.coalesce();
+  const auto indices = input._indices();
+  const auto values = input._values();
+  const int64_t nnz = indices.size(1);
+
+  std::vector<at::Tensor> localNnz{at::full({1}, nnz, indices.options())};
+  std::vector<std::vector<at::Tensor>> gatheredNnz(1);
+  for (int i = 0; i < size_; i++) {
+    gatheredNnz[0].push_back(at::empty_like(localNnz[0]));
+  }
+  allgather(gatheredNnz, localNnz)->wait();
+  const auto counts = at::cat(gatheredNnz[0]).cpu();
+  const auto* countsData = counts.data_ptr<int64_t>();
+  const int64_t maxNnz = *std::max_element(countsData, countsData + size_);
+
+  std::vector<at::Tensor> localIndices{
+      at::zeros({indices.size(0), maxNnz}, indices.options())};
+  localIndices[0].narrow(1, 0, nnz).copy_(indices);
+  std::vector<std::vector<at::Tensor>> gatheredIndices(1);
+  for (int i = 0; i < size_; i++) {
+    gatheredIndices[0].push_back(at::empty_like(localIndices[0]));
+  }
+  allgather(gatheredIndices, localIndices)->wait();
+  int64_t offset = 0;
+  for (int i = 0; i < size_; i++) {
+    gatheredIndices[0][i] = gatheredIndices[0][i].narrow(1, 0, countsData[i]);
+    if (i < rank_) {
+      offset += countsData[i];
+    }
+  }
+
+  at::Tensor outputIndices, inverse;
+  std::tie(outputIndices, inverse) =
+      uniqueSparseIndices(at::cat(gatheredIndices[0], 1), input.sizes());
+  auto outputValuesSizes = values.sizes().vec();
+  outputValuesSizes[0] = outputIndices.size(1);
+  std::vector<at::Tensor> outputValues{
+      at::zeros(outputValuesSizes, values.options())};
+  outputValues[0].index_add_(0, inverse.narrow(0, offset, nnz), values);
+
+  // The tensor holds the buffer from now on, so the allreduce below updates
+  // it in place like a dense one.
+  at::sparse::alias_into_sparse(tensor, outputIndices, outputValues[0]);
+  tensor._coalesced_(true);
+  return allreduce(outputValues, opts);
+}
+
 c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce(
     std::vector<at::Tensor>& tensors,
     const AllreduceOptions& opts) {
+  if (tensors.size() == 1 && tensors[0].is_sparse()) {
+    return allreduce_sparse(tensors[0], opts);
+  }
   check_gpu_tensors(tensors);
 
+  // See Note [Hierarchical allreduce]
+  if (options_->hierarchical_allreduce && tensors.size() == 1 &&
+      ncclActiveGroupCounter_ == 0 && !isCapturing(getDeviceList(tensors))) {
+    const auto& topology = getHierarchicalTopology();
+    const int64_t chunk = tensors[0].numel() / topology.localSize;
+    if (topology.enabled && chunk > 0) {
+      const auto comms = getHierarchicalNCCLComms(
+          getKeyFromDevices(getDeviceList(tensors)), tensors[0].device());
+      return collective(
+          tensors,
+          tensors,
+          [&](at::Tensor& input,
+              at::Tensor& output,
+              ncclComm_t comm,
+              at::cuda::CUDAStream& stream) {
+            const auto dataType = getNcclDataType(input.scalar_type());
+            const auto reduceOp = getNcclReduceOp(opts.reduceOp, input);
+            auto* data = static_cast<char*>(input.data_ptr());
+            auto* localChunk =
+                data + topology.localRank * chunk * input.element_size();
+            // Each step depends on the previous one, so they can't be in
+            // the group collective() opened, see [Group Start/End Note].
+            C10D_NCCL_CHECK(ncclGroupEnd());
+            C10D_NCCL_CHECK(ncclReduceScatter(
+                data,
+                localChunk,
+                chunk,
+                dataType,
+                reduceOp,
+                comms.first->getNcclComm(),
+                stream.stream()));
+            C10D_NCCL_CHECK(ncclAllReduce(
+                localChunk,
+                localChunk,
+                chunk,
+                dataType,
+                reduceOp,
+                comms.second->getNcclComm(),
+                stream.stream()));
+            C10D_NCCL_CHECK(ncclAllGather(
+                localChunk,
+                data,
+                chunk,
+                dataType,
+                comms.first->getNcclComm(),
+                stream.stream()));
+            const int64_t tail =
+                input.numel() - chunk * topology.localSize;
+            if (tail > 0) {
+              auto* tailData =
+                  data + chunk * topology.localSize * input.element_size();
+              C10D_NCCL_CHECK(ncclAllReduce(
+                  tailData,
+                  tailData,
+                  tail,
+                  dataType,
+                  reduceOp,
+                  comm,
+                  stream.stream()));
+            }
+            return ncclGroupStart();
+          },
+          OpType::ALLREDUCE,
+          "nccl:all_reduce");
+    }
+  }
+
   return collective(
       tensors,
       tensors,
@@ -1242,8 +1840,46 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce(
 c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::allreduce_coalesced(
     std::vector<at::Tensor>& tensors,
     const AllreduceCoalescedOptions& opts) {
-  throw std::runtime_error(
-      "allreduce_coalesced is currently not supported with NCCL");
+  check_coalesced_gpu_tensors(tensors);
+
+  return collectiveCoalesced(
+      tensors,
+      tensors,
+      tensors.size(),
+      [&](size_t i, ncclComm_t comm, at::cuda::CUDAStream& stream) {
+        return ncclAllReduce(
+            tensors[i].data_ptr(),
+            tensors[i].data_ptr(),
+            tensors[i].numel(),
+            getNcclDataType(tensors[i].scalar_type()),
+            getNcclReduceOp(opts.reduceOp, tensors[i]),
+            comm,
+            stream.stream());
+      },
+      OpType::ALLREDUCE_COALESCED,
+      "nccl:all_reduce_coalesced");
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::broadcast_coalesced(
+    std::vector<at::Tensor>& tensors,
+    const BroadcastOptions& opts) {
+  check_coalesced_gpu_tensors(tensors);
+
+  return collectiveCoalesced(
+      tensors,
+      tensors,
+      tensors.size(),
+      [&](size_t i, ncclComm_t comm, at::cuda::CUDAStream& stream) {
+        return ncclBcast(
+            tensors[i].data_ptr(),
+            tensors[i].numel(),
+            getNcclDataType(tensors[i].scalar_type()),
+            opts.rootRank,
+            comm,
+            stream.stream());
+      },
+      OpType::BROADCAST,
+      "nccl:broadcast_coalesced");
 }
 
 c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::broadcast(
@@ -1344,11 +1980,59 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::allgather(
 }
 
 c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::allgather_coalesced(
-    std::vector<std::vector<at::Tensor>>& /* unused */,
-    std::vector<at::Tensor>& /* unused */,
+    std::vector<std::vector<at::Tensor>>& outputTensorLists,
+    std::vector<at::Tensor>& inputTensors,
     const AllgatherOptions& /* unused */) {
-  throw std::runtime_error(
-      "ProcessGroupNCCL does not support allgather_coalesced");
+  check_coalesced_gpu_tensors(inputTensors);
+  if (outputTensorLists.size() != static_cast<size_t>(size_)) {
+    throw std::runtime_error(
+        "Output lists of allgather_coalesced should be equal to world size");
+  }
+  std::vector<at::Tensor> outputs;
+  for (const auto& outputList : outputTensorLists) {
+    if (outputList.size() != inputTensors.size()) {
+      throw std::runtime_error(
+          "Each output list of allgather_coalesced must have as many tensors "
+          "as the input list");
+    }
+    for (size_t i = 0; i < outputList.size(); ++i) {
+      if (outputList[i].numel() != inputTensors[i].numel() ||
+          outputList[i].scalar_type() != inputTensors[i].scalar_type()) {
+        throw std::runtime_error(
+            "Output tensors of allgather_coalesced must have the size and "
+            "type of the corresponding input tensor");
+      }
+    }
+    outputs.insert(outputs.end(), outputList.begin(), outputList.end());
+  }
+  check_coalesced_gpu_tensors(outputs);
+  if (outputs.front().device() != inputTensors.front().device()) {
+    throw std::runtime_error(
+        "Input and output tensors of allgather_coalesced must be on the same "
+        "GPU device");
+  }
+
+  // Every rank broadcasts its inputs straight into the matching outputs of
+  // all ranks, which needs neither a flat buffer nor equally sized tensors.
+  const size_t numTensors = inputTensors.size();
+  return collectiveCoalesced(
+      inputTensors,
+      outputs,
+      outputs.size(),
+      [&](size_t i, ncclComm_t comm, at::cuda::CUDAStream& stream) {
+        const auto root = i / numTensors;
+        auto& input = inputTensors[i % numTensors];
+        return ncclBroadcast(
+            input.data_ptr(),
+            outputs[i].data_ptr(),
+            input.numel(),
+            getNcclDataType(input.scalar_type()),
+            root,
+            comm,
+            stream.stream());
+      },
+      OpType::ALLGATHER_COALESCED,
+      "nccl:all_gather_coalesced");
 }
 
 c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::reduce_scatter(
@@ -1397,6 +2081,63 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::reduce_scatter(
       "nccl:reduce_scatter");
 }
 
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::reduce_scatter_coalesced(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<std::vector<at::Tensor>>& inputTensorLists,
+    const ReduceScatterOptions& opts) {
+  check_coalesced_gpu_tensors(outputTensors);
+  if (inputTensorLists.size() != static_cast<size_t>(size_)) {
+    throw std::runtime_error(
+        "Input lists of reduce_scatter_coalesced should be equal to world size");
+  }
+  std::vector<at::Tensor> inputs;
+  for (const auto& inputList : inputTensorLists) {
+    if (inputList.size() != outputTensors.size()) {
+      throw std::runtime_error(
+          "Each input list of reduce_scatter_coalesced must have as many "
+          "tensors as the output list");
+    }
+    for (size_t i = 0; i < inputList.size(); ++i) {
+      if (inputList[i].numel() != outputTensors[i].numel() ||
+          inputList[i].scalar_type() != outputTensors[i].scalar_type()) {
+        throw std::runtime_error(
+            "Input tensors of reduce_scatter_coalesced must have the size and "
+            "type of the corresponding output tensor");
+      }
+    }
+    inputs.insert(inputs.end(), inputList.begin(), inputList.end());
+  }
+  check_coalesced_gpu_tensors(inputs);
+  if (inputs.front().device() != outputTensors.front().device()) {
+    throw std::runtime_error(
+        "Input and output tensors of reduce_scatter_coalesced must be on the "
+        "same GPU device");
+  }
+
+  // inputTensorLists[r] is reduced into the outputs of rank r, one reduce
+  // per tensor and rank, see allgather_coalesced.
+  const size_t numTensors = outputTensors.size();
+  return collectiveCoalesced(
+      inputs,
+      outputTensors,
+      inputs.size(),
+      [&](size_t i, ncclComm_t comm, at::cuda::CUDAStream& stream) {
+        const auto root = i / numTensors;
+        auto& output = outputTensors[i % numTensors];
+        return ncclReduce(
+            inputs[i].data_ptr(),
+            output.data_ptr(),
+            output.numel(),
+            getNcclDataType(output.scalar_type()),
+            getNcclReduceOp(opts.reduceOp, output),
+            root,
+            comm,
+            stream.stream());
+      },
+      OpType::REDUCE_SCATTER,
+      "nccl:reduce_scatter_coalesced");
+}
+
 c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::barrier(
     const BarrierOptions& opts) {
   std::vector<at::Device> devices;
@@ -1525,6 +2266,309 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::alltoall_base(
   }
 }
 
+// Note [Variable size alltoall]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// alltoall_v is alltoall_base for callers that only know how many rows they
+// send, like the lookups of sharded embeddings. It exchanges the split sizes
+// first, reads the ones it receives on the host to allocate the output, which
+// is the only host sync of the op, then exchanges the rows.
+//
+// With Options::hierarchical_alltoall and the topology of Note [Hierarchical
+// allreduce], both exchanges run in two steps, so that each rank talks to
+// localSize + numNodes peers instead of to every rank, and the messages that
+// cross hosts are localSize times fewer and larger:
+//   1. within the host, rank (node, l) sends to the local rank l' the rows for
+//      the ranks with local rank l' on every host, ordered by host,
+//   2. across hosts, among the ranks with the same local rank l, it sends to
+//      host n the rows it now holds for rank (n, l), ordered by source local
+//      rank, which it then puts back in rank order.
+// The sizes take the same path: step 1 gives each rank the sizes of the blocks
+// it receives in step 1 and sends in step 2, and step 2 the sizes it receives
+// in step 2, which are the output split sizes. Blocks are regrouped between
+// the steps by a copy on the NCCL stream.
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::alltoall_v(
+    at::Tensor& inputTensor,
+    std::vector<int64_t>& inputSplitSizes,
+    const AllToAllOptions& /* unused */) {
+  check_gpu_single_tensor(inputTensor);
+  TORCH_CHECK(
+      inputTensor.dim() > 0,
+      "alltoall_v needs a tensor with at least one dimension");
+  TORCH_CHECK(
+      inputSplitSizes.size() == static_cast<size_t>(size_),
+      "alltoall_v needs one split size per rank, got ",
+      inputSplitSizes.size(),
+      " for ",
+      size_,
+      " ranks");
+  c10d::checkSplitSizes(inputSplitSizes, inputTensor, size_);
+  const std::vector<at::Device> devices{inputTensor.device()};
+  TORCH_CHECK(
+      ncclActiveGroupCounter_ == 0 && !isCapturing(devices),
+      "alltoall_v reads the split sizes it receives on the host, so it can't "
+      "run in a group or be captured into a CUDA graph");
+
+  const bool hierarchical =
+      options_->hierarchical_alltoall && getHierarchicalTopology().enabled;
+  std::vector<int64_t> outputSplitSizes(size_);
+  // With hierarchical, the sizes of the blocks received in step 1, indexed by
+  // source local rank then destination host.
+  std::vector<int64_t> intraSplitSizes;
+  if (!hierarchical) {
+    auto sendSizes =
+        at::tensor(inputSplitSizes, at::kLong).to(inputTensor.device());
+    auto recvSizes = at::empty_like(sendSizes);
+    std::vector<int64_t> equalSplits;
+    alltoall_base(recvSizes, sendSizes, equalSplits, equalSplits)->wait();
+    const auto sizes = recvSizes.cpu();
+    std::copy(
+        sizes.data_ptr<int64_t>(),
+        sizes.data_ptr<int64_t>() + size_,
+        outputSplitSizes.begin());
+  } else {
+    const auto& topology = getHierarchicalTopology();
+    const int localSize = topology.localSize;
+    const int numNodes = topology.numNodes;
+    const auto comms = getHierarchicalNCCLComms(
+        getKeyFromDevices(devices), inputTensor.device());
+    std::vector<int64_t> sendSizesData;
+    for (int l = 0; l < localSize; l++) {
+      for (int n = 0; n < numNodes; n++) {
+        sendSizesData.push_back(inputSplitSizes[topology.hostRanks[n][l]]);
+      }
+    }
+    std::vector<at::Tensor> sendSizes{
+        at::tensor(sendSizesData, at::kLong).to(inputTensor.device())};
+    std::vector<at::Tensor> recvSizes{at::empty_like(sendSizes[0])};
+    at::Tensor intraSizes;
+    collective(
+        sendSizes,
+        recvSizes,
+        [&](at::Tensor& input,
+            at::Tensor& output,
+            ncclComm_t /* unused */,
+            at::cuda::CUDAStream& stream) {
+          // The steps depend on each other, see [Group Start/End Note].
+          C10D_NCCL_CHECK(ncclGroupEnd());
+          at::cuda::CUDAStreamGuard streamGuard(stream);
+          c10::cuda::CUDACachingAllocator::recordStream(
+              output.storage().data_ptr(), stream);
+          intraSizes = at::empty_like(input);
+          torch::cuda::nccl::all2all_single_equal_split(
+              input, intraSizes, localSize, comms.first->getNcclComm(), stream);
+          auto interSend =
+              intraSizes.view({localSize, numNodes}).t().contiguous();
+          torch::cuda::nccl::all2all_single_equal_split(
+              interSend, output, numNodes, comms.second->getNcclComm(), stream);
+          C10D_NCCL_CHECK(ncclGroupStart());
+          return ncclSuccess;
+        },
+        OpType::ALLTOALL_BASE,
+        "nccl:all_to_all")
+        ->wait();
+    const auto sizes = at::cat({intraSizes, recvSizes[0]}).cpu();
+    const auto* sizesData = sizes.data_ptr<int64_t>();
+    intraSplitSizes.assign(sizesData, sizesData + size_);
+    for (int n = 0; n < numNodes; n++) {
+      for (int l = 0; l < localSize; l++) {
+        outputSplitSizes[topology.hostRanks[n][l]] =
+            sizesData[size_ + n * localSize + l];
+      }
+    }
+  }
+
+  auto outputSizes = inputTensor.sizes().vec();
+  outputSizes[0] = c10::sum_integers(outputSplitSizes);
+  auto outputTensor = at::empty(outputSizes, inputTensor.options());
+  auto work = hierarchical
+      ? alltoall_v_hierarchical(
+            outputTensor,
+            inputTensor,
+            inputSplitSizes,
+            intraSplitSizes,
+            outputSplitSizes)
+      : alltoall_base(
+            outputTensor, inputTensor, outputSplitSizes, inputSplitSizes);
+  auto ncclWork = dynamic_cast<ProcessGroupNCCL::WorkNCCL*>(work.get());
+  TORCH_INTERNAL_ASSERT(ncclWork);
+  ncclWork->outputs_ = std::make_shared<std::vector<at::Tensor>>(
+      std::vector<at::Tensor>{
+          outputTensor, at::tensor(outputSplitSizes, at::kLong)});
+  return work;
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::
+    alltoall_v_hierarchical(
+        at::Tensor& outputTensor,
+        at::Tensor& inputTensor,
+        const std::vector<int64_t>& inputSplitSizes,
+        const std::vector<int64_t>& intraSplitSizes,
+        const std::vector<int64_t>& outputSplitSizes) {
+  const auto& topology = getHierarchicalTopology();
+  const int localSize = topology.localSize;
+  const int numNodes = topology.numNodes;
+  const auto& hostRanks = topology.hostRanks;
+  const auto comms = getHierarchicalNCCLComms(
+      getKeyFromDevices({inputTensor.device()}), inputTensor.device());
+  const int64_t rowNumel = c10::multiply_integers(
+      inputTensor.sizes().begin() + 1, inputTensor.sizes().end());
+
+  // Returns the blocks of rows of tensor, whose sizes are given in order by
+  // sizes, at the given indices, and the number of elements of each group of
+  // groupSize consecutive indices.
+  const auto regroup = [&](const at::Tensor& tensor,
+                           const std::vector<int64_t>& sizes,
+                           const std::vector<int64_t>& indices,
+                           int64_t groupSize,
+                           std::vector<size_t>* lengths,
+                           std::vector<size_t>* offsets) {
+    std::vector<int64_t> starts(sizes.size());
+    for (size_t i = 1; i < sizes.size(); i++) {
+      starts[i] = starts[i - 1] + sizes[i - 1];
+    }
+    std::vector<at::Tensor> blocks;
+    size_t offset = 0;
+    for (size_t i = 0; i < indices.size(); i++) {
+      blocks.push_back(tensor.narrow(0, starts[indices[i]], sizes[indices[i]]));
+      if (i % groupSize == 0) {
+        (*offsets)[i / groupSize] = offset;
+        (*lengths)[i / groupSize] = 0;
+      }
+      (*lengths)[i / groupSize] += sizes[indices[i]] * rowNumel;
+      offset += sizes[indices[i]] * rowNumel;
+    }
+    return blocks;
+  };
+  // Lengths and offsets, in elements, of the consecutive groups of blocks.
+  const auto groupLengths = [&](const std::vector<int64_t>& sizes,
+                                int64_t groupSize,
+                                std::vector<size_t>* lengths,
+                                std::vector<size_t>* offsets) {
+    size_t offset = 0;
+    for (size_t group = 0; group < lengths->size(); group++) {
+      (*offsets)[group] = offset;
+      (*lengths)[group] = 0;
+      for (int64_t i = 0; i < groupSize; i++) {
+        (*lengths)[group] += sizes[group * groupSize + i] * rowNumel;
+      }
+      offset += (*lengths)[group];
+    }
+  };
+
+  std::vector<at::Tensor> inputs{inputTensor};
+  std::vector<at::Tensor> outputs{outputTensor};
+  return collective(
+      inputs,
+      outputs,
+      [&](at::Tensor& input,
+          at::Tensor& output,
+          ncclComm_t /* unused */,
+          at::cuda::CUDAStream& stream) {
+        // The steps depend on each other, see [Group Start/End Note].
+        C10D_NCCL_CHECK(ncclGroupEnd());
+        at::cuda::CUDAStreamGuard streamGuard(stream);
+        c10::cuda::CUDACachingAllocator::recordStream(
+            output.storage().data_ptr(), stream);
+        auto rowsLike = [&](const std::vector<int64_t>& sizes) {
+          auto shape = input.sizes().vec();
+          shape[0] = c10::sum_integers(sizes);
+          return at::empty(shape, input.options());
+        };
+
+        // Step 1: the rows for the ranks of local rank l on every host go to
+        // local rank l.
+        std::vector<int64_t> indices;
+        for (int l = 0; l < localSize; l++) {
+          for (int n = 0; n < numNodes; n++) {
+            indices.push_back(hostRanks[n][l]);
+          }
+        }
+        std::vector<size_t> sendLengths(localSize), sendOffsets(localSize);
+        std::vector<size_t> recvLengths(localSize), recvOffsets(localSize);
+        auto intraSend = at::cat(regroup(
+            input,
+            inputSplitSizes,
+            indices,
+            numNodes,
+            &sendLengths,
+            &sendOffsets));
+        groupLengths(intraSplitSizes, numNodes, &recvLengths, &recvOffsets);
+        auto intraRecv = rowsLike(intraSplitSizes);
+        torch::cuda::nccl::all2all_single_unequal_split(
+            intraSend.data_ptr(),
+            sendLengths.data(),
+            sendOffsets.data(),
+            intraRecv.data_ptr(),
+            recvLengths.data(),
+            recvOffsets.data(),
+            input.element_size(),
+            input.scalar_type(),
+            comms.first->getNcclComm(),
+            stream);
+
+        // Step 2: the rows for rank (n, localRank) go to host n.
+        indices.clear();
+        for (int n = 0; n < numNodes; n++) {
+          for (int l = 0; l < localSize; l++) {
+            indices.push_back(l * numNodes + n);
+          }
+        }
+        sendLengths.resize(numNodes);
+        sendOffsets.resize(numNodes);
+        recvLengths.resize(numNodes);
+        recvOffsets.resize(numNodes);
+        auto interSend = at::cat(regroup(
+            intraRecv,
+            intraSplitSizes,
+            indices,
+            localSize,
+            &sendLengths,
+            &sendOffsets));
+        std::vector<int64_t> interSplitSizes;
+        for (int n = 0; n < numNodes; n++) {
+          for (int l = 0; l < localSize; l++) {
+            interSplitSizes.push_back(outputSplitSizes[hostRanks[n][l]]);
+          }
+        }
+        groupLengths(interSplitSizes, localSize, &recvLengths, &recvOffsets);
+        auto interRecv = rowsLike(interSplitSizes);
+        torch::cuda::nccl::all2all_single_unequal_split(
+            interSend.data_ptr(),
+            sendLengths.data(),
+            sendOffsets.data(),
+            interRecv.data_ptr(),
+            recvLengths.data(),
+            recvOffsets.data(),
+            input.element_size(),
+            input.scalar_type(),
+            comms.second->getNcclComm(),
+            stream);
+
+        // Back to rank order.
+        std::vector<int64_t> blockOfRank(size_);
+        for (int n = 0; n < numNodes; n++) {
+          for (int l = 0; l < localSize; l++) {
+            blockOfRank[hostRanks[n][l]] = n * localSize + l;
+          }
+        }
+        std::vector<size_t> unusedLengths(size_), unusedOffsets(size_);
+        at::cat_out(
+            output,
+            regroup(
+                interRecv,
+                interSplitSizes,
+                blockOfRank,
+                1,
+                &unusedLengths,
+                &unusedOffsets),
+            0);
+        C10D_NCCL_CHECK(ncclGroupStart());
+        return ncclSuccess;
+      },
+      OpType::ALLTOALL_BASE,
+      "nccl:all_to_all");
+}
+
 c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::alltoall(
     std::vector<at::Tensor>& outputTensors,
     std::vector<at::Tensor>& inputTensors,
@@ -1607,6 +2651,25 @@ c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::alltoall(
       "ProcessGroupNCCL only supports alltoall* for NCCL lib version >= 2.7.0");
 }
 
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::alltoall_v(
+    at::Tensor& /* unused */,
+    std::vector<int64_t>& /* unused */,
+    const AllToAllOptions& /* unused */) {
+  throw std::runtime_error(
+      "ProcessGroupNCCL only supports alltoall* for NCCL lib version >= 2.7.0");
+}
+
+c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::
+    alltoall_v_hierarchical(
+        at::Tensor& /* unused */,
+        at::Tensor& /* unused */,
+        const std::vector<int64_t>& /* unused */,
+        const std::vector<int64_t>& /* unused */,
+        const std::vector<int64_t>& /* unused */) {
+  throw std::runtime_error(
+      "ProcessGroupNCCL only supports alltoall* for NCCL lib version >= 2.7.0");
+}
+
 c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::send(
     std::vector<at::Tensor>& /* unused */,
     int /* unused */,
@@ -1638,6 +2701,88 @@ void ProcessGroupNCCL::groupEnd() {
   --ncclActiveGroupCounter_;
 }
 
+std::vector<ProcessGroupNCCL::CollectiveTrace> ProcessGroupNCCL::
+    getCollectiveTraces() {
+  std::vector<std::shared_ptr<TraceEntry>> entries;
+  {
+    std::lock_guard<std::mutex> lock(traceMutex_);
+    // The oldest entry is the one the next collective replaces.
+    for (size_t i = 0; i < traceBuffer_.size(); i++) {
+      const auto& entry =
+          traceBuffer_[(traceSeq_ + i) % traceBuffer_.size()];
+      if (entry) {
+        entries.push_back(entry);
+      }
+    }
+  }
+  std::vector<CollectiveTrace> traces;
+  traces.reserve(entries.size());
+  for (const auto& entry : entries) {
+    auto trace = entry->trace;
+    if (entry->end.query()) {
+      trace.durationUs = entry->start.elapsed_time(entry->end) * 1000.0;
+    }
+    traces.push_back(trace);
+  }
+  return traces;
+}
+
+std::vector<ProcessGroupNCCL::CollectiveSkew> ProcessGroupNCCL::
+    gatherCollectiveTraces() {
+  const auto traces = getCollectiveTraces();
+  const std::string keyPrefix = "collective_trace/" +
+      std::to_string(traceGatherCounter_++) + "/";
+  std::vector<uint8_t> value(traces.size() * sizeof(CollectiveTrace));
+  if (!traces.empty()) {
+    std::memcpy(value.data(), traces.data(), value.size());
+  }
+  store_->set(keyPrefix + std::to_string(rank_), value);
+
+  // The completed traces of each collective, in rank order.
+  std::map<uint64_t, std::vector<CollectiveTrace>> tracesBySeq;
+  for (int rank = 0; rank < size_; rank++) {
+    const auto rankValue = store_->get(keyPrefix + std::to_string(rank));
+    std::vector<CollectiveTrace> rankTraces(
+        rankValue.size() / sizeof(CollectiveTrace));
+    if (!rankTraces.empty()) {
+      std::memcpy(rankTraces.data(), rankValue.data(), rankValue.size());
+    }
+    for (const auto& trace : rankTraces) {
+      if (trace.durationUs >= 0) {
+        tracesBySeq[trace.seq].push_back(trace);
+      }
+    }
+  }
+
+  std::vector<CollectiveSkew> skews;
+  for (const auto& it : tracesBySeq) {
+    const auto& seqTraces = it.second;
+    // Skip the collectives a rank no longer has or has not completed.
+    if (seqTraces.size() != static_cast<size_t>(size_)) {
+      continue;
+    }
+    CollectiveSkew skew;
+    skew.seq = it.first;
+    skew.opType = seqTraces[0].opType;
+    skew.bytes = seqTraces[0].bytes;
+    double maxDurationUs = 0;
+    for (const auto& trace : seqTraces) {
+      skew.enqueueTimeUs.push_back(trace.enqueueTimeUs);
+      skew.durationUs.push_back(trace.durationUs);
+      maxDurationUs = std::max(maxDurationUs, trace.durationUs);
+    }
+    skew.straggler = 0;
+    for (int rank = 0; rank < size_; rank++) {
+      skew.arrivalSkewUs.push_back(maxDurationUs - skew.durationUs[rank]);
+      if (skew.arrivalSkewUs[rank] > skew.arrivalSkewUs[skew.straggler]) {
+        skew.straggler = rank;
+      }
+    }
+    skews.push_back(std::move(skew));
+  }
+  return skews;
+}
+
 c10::intrusive_ptr<ProcessGroup::Work> ProcessGroupNCCL::gather(
     std::vector<std::vector<at::Tensor>>& /* unused */,
     std::vector<at::Tensor>& /* unused */,
@@ -198,6 +198,60 @@ class ProcessGroupNCCL : public ProcessGroup {
 
     // Schedule NCCL operations on high priority CUDA streams
     bool is_high_priority_stream;
+
+    // Run allreduce as a reduce-scatter within each host, an allreduce
+    // across hosts and an allgather within each host, see
+    // Note [Hierarchical allreduce].
+    bool hierarchical_allreduce = false;
+
+    // Run alltoall_v in two steps, within each host and then across hosts,
+    // see Note [Variable size alltoall].
+    bool hierarchical_alltoall = false;
+
+    // Create the communicator of this device when the process group is
+    // constructed instead of on its first collective, see
+    // Note [Eager NCCL communicator init].
+    c10::optional<at::Device> eager_init_device;
+
+    // With eager_init_device, derive the communicator from the one of this
+    // process group on the same device with ncclCommSplit, if NCCL supports
+    // it. The ranks of split_from that are not part of the new process group
+    // must call performNocolorSplit on it at the same time.
+    c10::intrusive_ptr<ProcessGroupNCCL> split_from;
+
+    // Keep the timings of the last collective_trace_size collectives, see
+    // Note [Collective tracing]. Zero disables tracing.
+    int64_t collective_trace_size = 0;
+  };
+
+  // Timings of a collective run by the process group, see
+  // Note [Collective tracing].
+  struct CollectiveTrace {
+    // Index of the collective among those the process group ran, which is
+    // the same on all ranks.
+    uint64_t seq;
+    OpType opType;
+    int64_t numel;
+    int64_t bytes;
+    // Wall clock time the collective was enqueued, in us since the epoch.
+    int64_t enqueueTimeUs;
+    // Time from the collective reaching the front of its NCCL stream to its
+    // completion, in us, or -1 if it has not completed yet.
+    double durationUs;
+  };
+
+  // Timings of a collective on all ranks, see gatherCollectiveTraces.
+  struct CollectiveSkew {
+    uint64_t seq;
+    OpType opType;
+    int64_t bytes;
+    // Indexed by rank.
+    std::vector<int64_t> enqueueTimeUs;
+    std::vector<double> durationUs;
+    // How long after the first rank each rank joined the collective, in us.
+    std::vector<double> arrivalSkewUs;
+    // The rank that joined last.
+    int straggler;
   };
 
   // If you wish to create multiple process groups, each with a potentially
@@ -273,11 +327,20 @@ class ProcessGroupNCCL : public ProcessGroup {
       std::vector<at::Tensor>& inputTensors,
       const AllgatherOptions& opts = AllgatherOptions()) override;
 
+  c10::intrusive_ptr<ProcessGroup::Work> broadcast_coalesced(
+      std::vector<at::Tensor>& tensors,
+      const BroadcastOptions& opts = BroadcastOptions()) override;
+
   c10::intrusive_ptr<ProcessGroup::Work> reduce_scatter(
       std::vector<at::Tensor>& outputTensors,
       std::vector<std::vector<at::Tensor>>& inputTensors,
       const ReduceScatterOptions& opts = ReduceScatterOptions()) override;
 
+  c10::intrusive_ptr<ProcessGroup::Work> reduce_scatter_coalesced(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<std::vector<at::Tensor>>& inputTensorLists,
+      const ReduceScatterOptions& opts = ReduceScatterOptions()) override;
+
   c10::intrusive_ptr<ProcessGroup::Work> barrier(
       const BarrierOptions& opts = BarrierOptions()) override;
 
@@ -293,6 +356,11 @@ class ProcessGroupNCCL : public ProcessGroup {
       std::vector<at::Tensor>& inputTensors,
       const AllToAllOptions& opts = AllToAllOptions()) override;
 
+  c10::intrusive_ptr<ProcessGroup::Work> alltoall_v(
+      at::Tensor& inputTensor,
+      std::vector<int64_t>& inputSplitSizes,
+      const AllToAllOptions& opts = AllToAllOptions()) override;
+
   c10::intrusive_ptr<ProcessGroup::Work> send(
       std::vector<at::Tensor>& tensors,
       int dstRank,
@@ -303,10 +371,24 @@ class ProcessGroupNCCL : public ProcessGroup {
       int srcRank,
       int tag) override;
 
+  // To be called on the ranks of the process group that are not part of a
+  // process group created with split_from set to it, see Options::split_from.
+  // Does nothing if NCCL does not support ncclCommSplit.
+  void performNocolorSplit(const at::Device& device);
+
   static void groupStart();
 
   static void groupEnd();
 
+  // Returns the traces of the last collectives, oldest first, if
+  // Options::collective_trace_size is set.
+  std::vector<CollectiveTrace> getCollectiveTraces();
+
+  // Exchanges the traces of all ranks through the store and returns the
+  // timings of the collectives that all ranks traced and completed, oldest
+  // first. Must be called by all ranks.
+  std::vector<CollectiveSkew> gatherCollectiveTraces();
+
   // Unsupported Ops
   c10::intrusive_ptr<ProcessGroup::Work> gather(
       std::vector<std::vector<at::Tensor>>& outputTensors,
@@ -330,6 +412,17 @@ class ProcessGroupNCCL : public ProcessGroup {
       const std::string& devicesKey,
       int p2pRank);
 
+  // Creates the communicator of Options::eager_init_device.
+  void eagerInitNCCLComm(const at::Device& device);
+
+  // Caches ncclComms as the communicators of devicesKey, along with their
+  // streams and events.
+  std::vector<std::shared_ptr<NCCLComm>>& cacheNCCLComms(
+      const std::string& devicesKey,
+      const std::vector<at::Device>& devices,
+      std::vector<std::shared_ptr<NCCLComm>> ncclComms,
+      std::vector<at::cuda::CUDAStream> streams);
+
   // Helper that either looks up the cached NCCL communicators or creates
   // a new set of NCCL communicators as a cache entry
   std::vector<std::shared_ptr<NCCLComm>>& getNCCLComm(
@@ -339,6 +432,30 @@ class ProcessGroupNCCL : public ProcessGroup {
       int p2pRank = 0,
       bool isSendRecvSelf = false);
 
+  // Ranks of the process group grouped by host, exchanged through the store
+  // the first time hierarchical allreduce runs.
+  struct HierarchicalTopology {
+    int localRank = 0;
+    int localSize = 1;
+    int nodeRank = 0;
+    int numNodes = 1;
+    // Whether every host runs the same number of ranks, more than one, and
+    // there is more than one host. Otherwise allreduce stays flat.
+    bool enabled = false;
+    // hostRanks[node][localRank] is the rank in the process group.
+    std::vector<std::vector<int>> hostRanks;
+  };
+
+  const HierarchicalTopology& getHierarchicalTopology();
+
+  // Returns the intra-host and inter-host communicators of the device,
+  // creating them if needed, or nullptrs if the topology does not allow
+  // hierarchical allreduce.
+  std::pair<std::shared_ptr<NCCLComm>, std::shared_ptr<NCCLComm>>
+  getHierarchicalNCCLComms(
+      const std::string& devicesKey,
+      const at::Device& device);
+
   // Wrapper method which can be overridden for tests.
   virtual std::exception_ptr checkForNCCLErrors(
       const std::vector<std::shared_ptr<NCCLComm>>& ncclComms);
@@ -374,6 +491,54 @@ class ProcessGroupNCCL : public ProcessGroup {
       OpType opType,
       const char* profilingTitle = nullptr);
 
+  // Helper for the coalesced collectives, which take tensors on a single
+  // device and call
+  //
+  //    ncclResult_t fn(size_t i, ncclComm_t, at::cuda::CUDAStream&);
+  //
+  // for i in [0, numCalls) in one NCCL group. See Note [Coalesced collectives].
+  template <typename Fn>
+  c10::intrusive_ptr<ProcessGroup::Work> collectiveCoalesced(
+      std::vector<at::Tensor>& inputs,
+      std::vector<at::Tensor>& outputs,
+      size_t numCalls,
+      Fn fn,
+      OpType opType,
+      const char* profilingTitle = nullptr);
+
+  // The two steps of hierarchical alltoall_v, given the split sizes
+  // exchanged beforehand, see Note [Variable size alltoall].
+  c10::intrusive_ptr<ProcessGroup::Work> alltoall_v_hierarchical(
+      at::Tensor& outputTensor,
+      at::Tensor& inputTensor,
+      const std::vector<int64_t>& inputSplitSizes,
+      const std::vector<int64_t>& intraSplitSizes,
+      const std::vector<int64_t>& outputSplitSizes);
+
+  // Allreduce of a sparse COO tensor, see Note [Sparse allreduce].
+  c10::intrusive_ptr<ProcessGroup::Work> allreduce_sparse(
+      at::Tensor& tensor,
+      const AllreduceOptions& opts);
+
+  // A traced collective and the events timing it on its NCCL stream.
+  struct TraceEntry {
+    CollectiveTrace trace;
+    at::cuda::CUDAEvent start{cudaEventDefault};
+    at::cuda::CUDAEvent end{cudaEventDefault};
+  };
+
+  // If tracing is enabled, adds a collective on inputs to the trace buffer
+  // and records its start on stream. Returns the entry to pass to traceEnd,
+  // or nullptr.
+  std::shared_ptr<TraceEntry> traceStart(
+      OpType opType,
+      const std::vector<at::Tensor>& inputs,
+      at::cuda::CUDAStream& stream);
+
+  void traceEnd(
+      const std::shared_ptr<TraceEntry>& entry,
+      at::cuda::CUDAStream& stream);
+
   // Helper that encapsulates work shared across point-to-point communication
   // primitives. It is the same structure as the helper used for collective
   // communicaiton primitives.
@@ -432,6 +597,11 @@ class ProcessGroupNCCL : public ProcessGroup {
   // used to scope keys used in the store.
   uint64_t ncclCommCounter_{0};
 
+  // Same as ncclCommCounter_, for the communicators of hierarchical allreduce.
+  uint64_t hierarchicalCommCounter_{0};
+
+  c10::optional<HierarchicalTopology> hierarchicalTopology_;
+
   // The NCCL communicator that the process group has cached.
   //
   // For collective operations:
@@ -507,6 +677,20 @@ class ProcessGroupNCCL : public ProcessGroup {
   // Device Indexes used for all collectives in this group
   std::set<int> usedDeviceIdxs_;
 
+  // Ring buffer of the last Options::collective_trace_size collectives,
+  // indexed by seq modulo its size.
+  std::vector<std::shared_ptr<TraceEntry>> traceBuffer_;
+
+  // The seq of the next traced collective.
+  uint64_t traceSeq_{0};
+
+  // The number of gatherCollectiveTraces calls, which scopes its keys in the
+  // store.
+  uint64_t traceGatherCounter_{0};
+
+  // Mutex to guard traceBuffer_ and traceSeq_.
+  std::mutex traceMutex_;
+
   // map from the key: "group name + pg counter (ID)" to the
   // unique NCCL ID count. This needs to be group and pg specific
   //
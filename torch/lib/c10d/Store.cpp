@@ -8,6 +8,31 @@ constexpr std::chrono::milliseconds Store::kNoTimeout;
 // Define destructor symbol for abstract base class.
 Store::~Store() {}
 
+std::vector<std::vector<uint8_t>> Store::multiGet(
+    const std::vector<std::string>& keys) {
+  std::vector<std::vector<uint8_t>> values;
+  values.reserve(keys.size());
+  for (const auto& key : keys) {
+    values.push_back(get(key));
+  }
+  return values;
+}
+
+void Store::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  TORCH_CHECK(
+      keys.size() == values.size(),
+      "multiSet expects as many values as keys, got ",
+      values.size(),
+      " values for ",
+      keys.size(),
+      " keys");
+  for (size_t i = 0; i < keys.size(); i++) {
+    set(keys[i], values[i]);
+  }
+}
+
 const std::chrono::milliseconds& Store::getTimeout() const noexcept {
     return timeout_;
 }
@@ -37,6 +37,15 @@ class Store : public torch::CustomClassHolder {
 
   virtual std::vector<uint8_t> get(const std::string& key) = 0;
 
+  // Batched get and set. The defaults call get and set for every key, stores
+  // that can do them in one round trip override them.
+  virtual std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys);
+
+  virtual void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values);
+
   virtual int64_t add(const std::string& key, int64_t value) = 0;
 
   virtual bool deleteKey(const std::string& key) = 0;
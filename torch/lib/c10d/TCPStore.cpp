@@ -24,7 +24,9 @@ enum class QueryType : uint8_t {
   CHECK,
   WAIT,
   GETNUMKEYS,
-  DELETE_KEY
+  DELETE_KEY,
+  MULTI_GET,
+  MULTI_SET
 };
 
 enum class CheckResponseType : uint8_t { READY, NOT_READY };
@@ -98,13 +100,8 @@ void TCPStoreDaemon::queryFds(std::vector<struct pollfd>& fds) {
           ++it;
         }
       }
-      for (auto it = keysAwaited_.begin(); it != keysAwaited_.end();) {
-        if (it->first == fds[fdIdx].fd) {
-          it = keysAwaited_.erase(it);
-        } else {
-          ++it;
-        }
-      }
+      keysAwaited_.erase(fds[fdIdx].fd);
+      pendingGets_.erase(fds[fdIdx].fd);
       fds.erase(fds.begin() + fdIdx);
       sockets_.erase(sockets_.begin() + fdIdx - CONNECT_SOCKET_OFFSET);
       --fdIdx;
@@ -116,8 +113,10 @@ void TCPStoreDaemon::queryFds(std::vector<struct pollfd>& fds) {
 // query communicates with the worker. The format
 // of the query is as follows:
 // type of query | size of arg1 | arg1 | size of arg2 | arg2 | ...
-// or, in the case of wait
+// or, in the case of wait, check and multi get
 // type of query | number of args | size of arg1 | arg1 | ...
+// or, in the case of multi set
+// type of query | number of keys | size of key1 | key1 | size of value1 | ...
 void TCPStoreDaemon::query(int socket) {
   QueryType qt;
   tcputil::recvBytes<QueryType>(socket, &qt, 1);
@@ -146,6 +145,12 @@ void TCPStoreDaemon::query(int socket) {
   } else if (qt == QueryType::DELETE_KEY) {
     deleteHandler(socket);
 
+  } else if (qt == QueryType::MULTI_GET) {
+    multiGetHandler(socket);
+
+  } else if (qt == QueryType::MULTI_SET) {
+    multiSetHandler(socket);
+
   } else {
     throw std::runtime_error("Unexpected query type");
   }
@@ -156,8 +161,15 @@ void TCPStoreDaemon::wakeupWaitingClients(const std::string& key) {
   if (socketsToWait != waitingSockets_.end()) {
     for (int socket : socketsToWait->second) {
       if (--keysAwaited_[socket] == 0) {
-        tcputil::sendValue<WaitResponseType>(
-            socket, WaitResponseType::STOP_WAITING);
+        keysAwaited_.erase(socket);
+        auto pendingGet = pendingGets_.find(socket);
+        if (pendingGet != pendingGets_.end()) {
+          sendValues(socket, pendingGet->second);
+          pendingGets_.erase(pendingGet);
+        } else {
+          tcputil::sendValue<WaitResponseType>(
+              socket, WaitResponseType::STOP_WAITING);
+        }
       }
     }
     waitingSockets_.erase(socketsToWait);
@@ -218,6 +230,45 @@ void TCPStoreDaemon::getHandler(int socket) const {
   tcputil::sendVector<uint8_t>(socket, data);
 }
 
+// Answers once all keys are set, so that a get is a single round trip instead
+// of a wait followed by a get.
+void TCPStoreDaemon::multiGetHandler(int socket) {
+  SizeType nargs;
+  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
+  std::vector<std::string> keys(nargs);
+  for (size_t i = 0; i < nargs; i++) {
+    keys[i] = tcputil::recvString(socket);
+  }
+  if (waitForKeys(socket, keys)) {
+    pendingGets_[socket] = std::move(keys);
+  } else {
+    sendValues(socket, keys);
+  }
+}
+
+void TCPStoreDaemon::multiSetHandler(int socket) {
+  SizeType nargs;
+  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
+  for (size_t i = 0; i < nargs; i++) {
+    std::string key = tcputil::recvString(socket);
+    tcpStore_[key] = tcputil::recvVector<uint8_t>(socket);
+    wakeupWaitingClients(key);
+  }
+}
+
+void TCPStoreDaemon::sendValues(
+    int socket,
+    const std::vector<std::string>& keys) const {
+  for (size_t i = 0; i < keys.size(); i++) {
+    // A key deleted in the meantime reads as empty.
+    auto it = tcpStore_.find(keys[i]);
+    tcputil::sendVector<uint8_t>(
+        socket,
+        it != tcpStore_.end() ? it->second : std::vector<uint8_t>(),
+        i != keys.size() - 1);
+  }
+}
+
 void TCPStoreDaemon::getNumKeysHandler(int socket) const {
   tcputil::sendValue<int64_t>(socket, tcpStore_.size());
 }
@@ -250,20 +301,28 @@ void TCPStoreDaemon::waitHandler(int socket) {
   for (size_t i = 0; i < nargs; i++) {
     keys[i] = tcputil::recvString(socket);
   }
-  if (checkKeys(keys)) {
+  if (!waitForKeys(socket, keys)) {
     tcputil::sendValue<WaitResponseType>(
         socket, WaitResponseType::STOP_WAITING);
-  } else {
-    int numKeysToAwait = 0;
-    for (auto& key : keys) {
-      // Only count keys that have not already been set
-      if (tcpStore_.find(key) == tcpStore_.end()) {
-        waitingSockets_[key].push_back(socket);
-        numKeysToAwait++;
-      }
+  }
+}
+
+bool TCPStoreDaemon::waitForKeys(
+    int socket,
+    const std::vector<std::string>& keys) {
+  if (checkKeys(keys)) {
+    return false;
+  }
+  int numKeysToAwait = 0;
+  for (auto& key : keys) {
+    // Only count keys that have not already been set
+    if (tcpStore_.find(key) == tcpStore_.end()) {
+      waitingSockets_[key].push_back(socket);
+      numKeysToAwait++;
     }
-    keysAwaited_[socket] = numKeysToAwait;
   }
+  keysAwaited_[socket] = numKeysToAwait;
+  return true;
 }
 
 bool TCPStoreDaemon::checkKeys(const std::vector<std::string>& keys) const {
@@ -503,10 +562,60 @@ std::vector<uint8_t> TCPStore::get(const std::string& key) {
 }
 
 std::vector<uint8_t> TCPStore::getHelper_(const std::string& key) {
-  waitHelper_({key}, timeout_);
-  tcputil::sendValue<QueryType>(storeSocket_, QueryType::GET);
-  tcputil::sendString(storeSocket_, key);
-  return tcputil::recvVector<uint8_t>(storeSocket_);
+  return multiGetHelper_({key}, timeout_)[0];
+}
+
+std::vector<std::vector<uint8_t>> TCPStore::multiGet(
+    const std::vector<std::string>& keys) {
+  std::vector<std::string> regKeys;
+  regKeys.reserve(keys.size());
+  for (const auto& key : keys) {
+    regKeys.push_back(regularPrefix_ + key);
+  }
+  return multiGetHelper_(regKeys, timeout_);
+}
+
+std::vector<std::vector<uint8_t>> TCPStore::multiGetHelper_(
+    const std::vector<std::string>& keys,
+    const std::chrono::milliseconds& timeout) {
+  if (keys.empty()) {
+    return {};
+  }
+  setRecvTimeout_(timeout);
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::MULTI_GET);
+  SizeType nkeys = keys.size();
+  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, true);
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(storeSocket_, keys[i], (i != (nkeys - 1)));
+  }
+  std::vector<std::vector<uint8_t>> values;
+  values.reserve(nkeys);
+  for (size_t i = 0; i < nkeys; i++) {
+    values.push_back(tcputil::recvVector<uint8_t>(storeSocket_));
+  }
+  return values;
+}
+
+void TCPStore::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  TORCH_CHECK(
+      keys.size() == values.size(),
+      "multiSet expects as many values as keys, got ",
+      values.size(),
+      " values for ",
+      keys.size(),
+      " keys");
+  if (keys.empty()) {
+    return;
+  }
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::MULTI_SET);
+  SizeType nkeys = keys.size();
+  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, true);
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(storeSocket_, regularPrefix_ + keys[i], true);
+    tcputil::sendVector<uint8_t>(storeSocket_, values[i], i != nkeys - 1);
+  }
 }
 
 int64_t TCPStore::add(const std::string& key, int64_t value) {
@@ -570,6 +679,20 @@ void TCPStore::wait(
 void TCPStore::waitHelper_(
     const std::vector<std::string>& keys,
     const std::chrono::milliseconds& timeout) {
+  setRecvTimeout_(timeout);
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::WAIT);
+  SizeType nkeys = keys.size();
+  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(storeSocket_, keys[i], (i != (nkeys - 1)));
+  }
+  auto waitResponse = tcputil::recvValue<WaitResponseType>(storeSocket_);
+  if (waitResponse != WaitResponseType::STOP_WAITING) {
+    throw std::runtime_error("Stop_waiting response is expected");
+  }
+}
+
+void TCPStore::setRecvTimeout_(const std::chrono::milliseconds& timeout) {
   // Set the socket timeout if there is a wait timeout
   if (timeout != kNoTimeout) {
 #ifdef _WIN32
@@ -586,16 +709,6 @@ void TCPStore::waitHelper_(
         reinterpret_cast<char*>(&timeoutTV),
         sizeof(timeoutTV)));
   }
-  tcputil::sendValue<QueryType>(storeSocket_, QueryType::WAIT);
-  SizeType nkeys = keys.size();
-  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
-  for (size_t i = 0; i < nkeys; i++) {
-    tcputil::sendString(storeSocket_, keys[i], (i != (nkeys - 1)));
-  }
-  auto waitResponse = tcputil::recvValue<WaitResponseType>(storeSocket_);
-  if (waitResponse != WaitResponseType::STOP_WAITING) {
-    throw std::runtime_error("Stop_waiting response is expected");
-  }
 }
 
 const std::string& TCPStore::getHost() const noexcept {
@@ -32,13 +32,19 @@ class TCPStoreDaemon {
   void compareSetHandler(int socket);
   void addHandler(int socket);
   void getHandler(int socket) const;
+  void multiGetHandler(int socket);
+  void multiSetHandler(int socket);
   void checkHandler(int socket) const;
   void getNumKeysHandler(int socket) const;
   void deleteHandler(int socket);
   void waitHandler(int socket);
 
   bool checkKeys(const std::vector<std::string>& keys) const;
+  // Registers socket as waiting for the keys that are not set yet, returns
+  // whether there are any.
+  bool waitForKeys(int socket, const std::vector<std::string>& keys);
   void wakeupWaitingClients(const std::string& key);
+  void sendValues(int socket, const std::vector<std::string>& keys) const;
 
   void initStopSignal();
   void closeStopSignal();
@@ -49,6 +55,9 @@ class TCPStoreDaemon {
   std::unordered_map<std::string, std::vector<int>> waitingSockets_;
   // From socket -> number of keys awaited
   std::unordered_map<int, size_t> keysAwaited_;
+  // From socket -> keys to send the values of once none is awaited anymore,
+  // for the sockets waiting in a multi get rather than a wait
+  std::unordered_map<int, std::vector<std::string>> pendingGets_;
 
   std::vector<int> sockets_;
   int storeListenSocket_;
@@ -82,6 +91,15 @@ class TCPStore : public Store {
 
   std::vector<uint8_t> get(const std::string& key) override;
 
+  // Waits for all keys to be set and gets them in one round trip.
+  std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys) override;
+
+  // Sets all keys in one message, without waiting for the server, like set.
+  void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values) override;
+
   int64_t add(const std::string& key, int64_t value) override;
 
   bool deleteKey(const std::string& key) override;
@@ -108,9 +126,13 @@ class TCPStore : public Store {
  protected:
   int64_t addHelper_(const std::string& key, int64_t value);
   std::vector<uint8_t> getHelper_(const std::string& key);
+  std::vector<std::vector<uint8_t>> multiGetHelper_(
+      const std::vector<std::string>& keys,
+      const std::chrono::milliseconds& timeout);
   void waitHelper_(
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout);
+  void setRecvTimeout_(const std::chrono::milliseconds& timeout);
 
   bool isServer_;
   int storeSocket_ = -1;
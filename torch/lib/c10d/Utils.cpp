@@ -71,6 +71,28 @@ namespace c10d {
   return it->second;
 }
 
+std::tuple<at::Tensor, at::Tensor> uniqueSparseIndices(
+    const at::Tensor& indices,
+    at::IntArrayRef sizes) {
+  const auto sparseDim = indices.size(0);
+  // Linearize the indices in row-major order, which is also the order of a
+  // coalesced tensor, and dedupe them in one pass instead of merging the
+  // entries of the ranks one at a time.
+  auto linear = indices.select(0, 0).clone();
+  for (int64_t d = 1; d < sparseDim; d++) {
+    linear.mul_(sizes[d]).add_(indices.select(0, d));
+  }
+  at::Tensor unique, inverse;
+  std::tie(unique, inverse) =
+      at::_unique(linear, /*sorted=*/true, /*return_inverse=*/true);
+
+  auto uniqueIndices = at::empty({sparseDim, unique.size(0)}, indices.options());
+  for (int64_t d = sparseDim - 1; d >= 0; d--) {
+    uniqueIndices.select(0, d).copy_(unique.remainder(sizes[d]));
+    unique = unique.div(sizes[d], "floor");
+  }
+  return std::make_tuple(uniqueIndices, inverse);
+}
 
 namespace tcputil {
 
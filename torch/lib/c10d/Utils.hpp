@@ -370,6 +370,14 @@ inline at::Tensor newLikeFlat(std::vector<at::Tensor>& tensors) {
   return at::empty(sizes, t.options());
 }
 
+// Dedupes the (sparseDim, nnz) indices of a sparse COO tensor of the given
+// sizes, e.g. the indices gathered from all ranks. Returns the unique indices,
+// in coalesced order, and for each input index the position of its unique one,
+// so that values can be summed with index_add_.
+std::tuple<at::Tensor, at::Tensor> uniqueSparseIndices(
+    const at::Tensor& indices,
+    at::IntArrayRef sizes);
+
 inline std::vector<std::vector<int64_t>> getSizes(
     const std::vector<at::Tensor>& tensors) {
   std::vector<std::vector<int64_t>> sizes(tensors.size());
@@ -0,0 +1,110 @@
+#include <c10d/bucket_optimizer.hpp>
+
+#include <cmath>
+
+namespace c10d {
+
+void SGDBucketOptimizer::step(
+    const std::vector<size_t>& state_keys,
+    const std::vector<at::Tensor>& params,
+    const std::vector<at::Tensor>& grads) {
+  at::NoGradGuard no_grad;
+  auto d_p = options_.weight_decay != 0
+      ? at::_foreach_add(grads, params, options_.weight_decay)
+      : grads;
+  if (options_.momentum != 0) {
+    std::vector<at::Tensor> bufs;
+    std::vector<at::Tensor> updates;
+    for (size_t i = 0; i < state_keys.size(); i++) {
+      auto& buf = momentum_buffers_[state_keys[i]];
+      if (!buf.defined()) {
+        buf = d_p[i].clone();
+      } else {
+        bufs.push_back(buf);
+        updates.push_back(d_p[i]);
+      }
+    }
+    if (!bufs.empty()) {
+      at::_foreach_mul_(bufs, options_.momentum);
+      at::_foreach_add_(bufs, updates);
+    }
+    // Same order as params, whether or not the buffer was just created.
+    d_p.clear();
+    for (const auto index : state_keys) {
+      d_p.push_back(momentum_buffers_[index]);
+    }
+  }
+  at::_foreach_add_(params, d_p, -options_.lr);
+}
+
+void AdamBucketOptimizer::step(
+    const std::vector<size_t>& state_keys,
+    const std::vector<at::Tensor>& params,
+    const std::vector<at::Tensor>& grads) {
+  at::NoGradGuard no_grad;
+  std::vector<at::Tensor> exp_avgs;
+  std::vector<at::Tensor> exp_avg_sqs;
+  std::vector<c10::Scalar> bias_correction2_sqrts;
+  std::vector<c10::Scalar> step_sizes;
+  for (size_t i = 0; i < state_keys.size(); i++) {
+    auto& state = states_[state_keys[i]];
+    if (!state.exp_avg.defined()) {
+      state.exp_avg = at::zeros_like(params[i], at::MemoryFormat::Preserve);
+      state.exp_avg_sq = at::zeros_like(params[i], at::MemoryFormat::Preserve);
+    }
+    state.step++;
+    exp_avgs.push_back(state.exp_avg);
+    exp_avg_sqs.push_back(state.exp_avg_sq);
+    const double bias_correction1 =
+        1 - std::pow(options_.beta1, static_cast<double>(state.step));
+    const double bias_correction2 =
+        1 - std::pow(options_.beta2, static_cast<double>(state.step));
+    bias_correction2_sqrts.emplace_back(std::sqrt(bias_correction2));
+    step_sizes.emplace_back(-options_.lr / bias_correction1);
+  }
+
+  const auto g = options_.weight_decay != 0
+      ? at::_foreach_add(grads, params, options_.weight_decay)
+      : grads;
+  at::_foreach_mul_(exp_avgs, options_.beta1);
+  at::_foreach_add_(exp_avgs, g, 1 - options_.beta1);
+  at::_foreach_mul_(exp_avg_sqs, options_.beta2);
+  at::_foreach_addcmul_(exp_avg_sqs, g, g, 1 - options_.beta2);
+  auto denoms = at::_foreach_sqrt(exp_avg_sqs);
+  at::_foreach_div_(denoms, bias_correction2_sqrts);
+  at::_foreach_add_(denoms, options_.eps);
+  at::_foreach_addcdiv_(params, exp_avgs, denoms, step_sizes);
+}
+
+std::unique_ptr<BucketOptimizer> makeBucketOptimizer(
+    BucketOptimizerType type,
+    const BucketOptimizerOptions& options) {
+  TORCH_CHECK(options.lr >= 0, "Invalid learning rate: ", options.lr);
+  TORCH_CHECK(
+      options.weight_decay >= 0,
+      "Invalid weight_decay value: ",
+      options.weight_decay);
+  switch (type) {
+    case BucketOptimizerType::SGD:
+      TORCH_CHECK(
+          options.momentum >= 0,
+          "Invalid momentum value: ",
+          options.momentum);
+      return std::make_unique<SGDBucketOptimizer>(options);
+    case BucketOptimizerType::ADAM:
+      TORCH_CHECK(
+          options.beta1 >= 0 && options.beta1 < 1 && options.beta2 >= 0 &&
+              options.beta2 < 1,
+          "Invalid beta parameters: (",
+          options.beta1,
+          ", ",
+          options.beta2,
+          ")");
+      TORCH_CHECK(options.eps >= 0, "Invalid epsilon value: ", options.eps);
+      return std::make_unique<AdamBucketOptimizer>(options);
+  }
+  TORCH_CHECK(false, "Unknown bucket optimizer type");
+  return nullptr;
+}
+
+} // namespace c10d
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace c10d {
+
+enum class BucketOptimizerType {
+  SGD = 1,
+  ADAM = 2,
+};
+
+// Hyperparameters of the bucket optimizers, with the same meaning and
+// defaults as in torch.optim.SGD and torch.optim.Adam.
+struct BucketOptimizerOptions {
+  double lr = 0.01;
+  double weight_decay = 0;
+
+  // SGD only.
+  double momentum = 0;
+
+  // ADAM only.
+  double beta1 = 0.9;
+  double beta2 = 0.999;
+  double eps = 1e-8;
+};
+
+// An optimizer the reducer runs on the parameters of a bucket as soon as the
+// gradients of the bucket are reduced, see Note [Fused bucket optimizer step].
+class BucketOptimizer {
+ public:
+  virtual ~BucketOptimizer() {}
+
+  // Updates params in place given their reduced grads, which must not be
+  // modified. The optimizer state of params[i] is kept under state_keys[i]:
+  // the index of the param in the model, which unlike its position in the
+  // bucket does not change when the buckets are rebuilt, or the index of the
+  // bucket when params are shards of the flat parameters of the buckets.
+  virtual void step(
+      const std::vector<size_t>& state_keys,
+      const std::vector<at::Tensor>& params,
+      const std::vector<at::Tensor>& grads) = 0;
+};
+
+class SGDBucketOptimizer : public BucketOptimizer {
+ public:
+  explicit SGDBucketOptimizer(const BucketOptimizerOptions& options)
+      : options_(options) {}
+
+  ~SGDBucketOptimizer() override {}
+
+  void step(
+      const std::vector<size_t>& state_keys,
+      const std::vector<at::Tensor>& params,
+      const std::vector<at::Tensor>& grads) override;
+
+ private:
+  const BucketOptimizerOptions options_;
+  std::unordered_map<size_t, at::Tensor> momentum_buffers_;
+};
+
+class AdamBucketOptimizer : public BucketOptimizer {
+ public:
+  explicit AdamBucketOptimizer(const BucketOptimizerOptions& options)
+      : options_(options) {}
+
+  ~AdamBucketOptimizer() override {}
+
+  void step(
+      const std::vector<size_t>& state_keys,
+      const std::vector<at::Tensor>& params,
+      const std::vector<at::Tensor>& grads) override;
+
+ private:
+  struct State {
+    int64_t step = 0;
+    at::Tensor exp_avg;
+    at::Tensor exp_avg_sq;
+  };
+
+  const BucketOptimizerOptions options_;
+  std::unordered_map<size_t, State> states_;
+};
+
+std::unique_ptr<BucketOptimizer> makeBucketOptimizer(
+    BucketOptimizerType type,
+    const BucketOptimizerOptions& options);
+
+} // namespace c10d
@@ -1,11 +1,58 @@
 #include <c10d/default_comm_hooks.hpp>
 
+#include <ATen/CPUGeneratorImpl.h>
 #include <c10d/comm.hpp>
 #include <c10d/ProcessGroup.hpp>
 #include <torch/torch.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace c10d {
 
+namespace {
+
+c10::intrusive_ptr<c10::ivalue::Future> allreduceAndDivide(
+    ProcessGroup* process_group,
+    at::Tensor& tensor) {
+  std::vector<at::Tensor> tensors = {tensor};
+  auto allreduce_work = process_group->allreduce(tensors);
+
+  auto div_by_process_group_size = [allreduce_work, process_group]() {
+    auto tensor = allreduce_work->result()[0];
+    tensor.div_(process_group->getSize());
+    return c10::IValue(tensor);
+  };
+
+  auto fut = allreduce_work->getFuture();
+  return fut->then(div_by_process_group_size, fut->elementType());
+}
+
+// Gram-Schmidt on the columns of matrix, in place. Much faster than at::qr
+// for the few columns of the PowerSGD low-rank tensors.
+void orthogonalize(const at::Tensor& matrix, double epsilon) {
+  const auto num_cols = matrix.size(1);
+  for (int64_t i = 0; i < num_cols; ++i) {
+    auto col = matrix.narrow(1, i, 1);
+    // The epsilon avoids a division by zero on a vanishing gradient.
+    col.div_(at::norm(col) + epsilon);
+    if (i + 1 < num_cols) {
+      auto rest = matrix.narrow(1, i + 1, num_cols - i - 1);
+      rest.sub_(at::sum(col * rest, 0) * col);
+    }
+  }
+}
+
+void checkStartIter(const BuiltinCommHookOptions& options, bool uses_memory) {
+  TORCH_CHECK(
+      !uses_memory || options.start_iter > 1,
+      "Expect start_iter > 1 if use_error_feedback or warm_start is enabled, "
+      "because gradients can only be compressed after the first two "
+      "iterations in DDP.");
+}
+
+} // namespace
+
 c10::intrusive_ptr<c10::ivalue::Future> AllReduceCommHook::runHook(
     GradBucket& bucket) {
   std::vector<at::Tensor> tensors = {bucket.getTensorRef()};
@@ -38,4 +85,227 @@ c10::intrusive_ptr<c10::ivalue::Future> FP16CompressCommHook::runHook(
       decompress_and_div_by_process_group_size, fut->elementType());
 }
 
+PowerSGDCommHook::PowerSGDCommHook(
+    ProcessGroup* state,
+    const BuiltinCommHookOptions& options)
+    : CppCommHookInterface<ProcessGroup*>(state),
+      options_(options),
+      generator_(at::make_generator<at::CPUGeneratorImpl>(options.random_seed)) {
+  TORCH_CHECK(
+      options_.matrix_approximation_rank > 0,
+      "matrix_approximation_rank must be positive");
+  checkStartIter(options_, options_.use_error_feedback || options_.warm_start);
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> PowerSGDCommHook::runHook(
+    GradBucket& bucket) {
+  auto& input_tensor = bucket.getTensorRef();
+  const auto bucket_index = bucket.getIndex();
+  const int64_t iter = iter_;
+  // Bucket 0 is the last one to allreduce in an iteration.
+  if (bucket.isTheLastBucketToAllreduce()) {
+    ++iter_;
+  }
+  if (iter < options_.start_iter) {
+    return allreduceAndDivide(state_, input_tensor);
+  }
+
+  // Adds the error of the previous iteration, and keeps a copy of the input to
+  // compute the error of this one once it is decompressed.
+  at::Tensor input_tensor_cp;
+  if (options_.use_error_feedback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = error_dict_.find(bucket_index);
+    if (it != error_dict_.end()) {
+      input_tensor.add_(it->second);
+    }
+    input_tensor_cp = input_tensor.clone();
+  }
+
+  // Gradients are compressed as matrices of their first dimension by the
+  // rest, if (n + m) * rank * min_compression_rate < n * m.
+  std::vector<at::Tensor> tensors_to_compress, uncompressed_tensors;
+  std::vector<int64_t> ranks;
+  int64_t total_ps_size = 0;
+  int64_t total_qs_size = 0;
+  for (const auto& tensor : bucket.getPerParameterTensors()) {
+    auto matrix = tensor.view({tensor.dim() > 0 ? tensor.size(0) : 1, -1});
+    const auto n = matrix.size(0);
+    const auto m = matrix.size(1);
+    const auto rank =
+        std::min({n, m, options_.matrix_approximation_rank});
+    if ((n + m) * rank * options_.min_compression_rate < n * m) {
+      tensors_to_compress.push_back(matrix);
+      ranks.push_back(rank);
+      total_ps_size += n * rank;
+      total_qs_size += m * rank;
+    } else {
+      uncompressed_tensors.push_back(tensor.view(-1));
+    }
+  }
+
+  auto uncompressed_tensors_memory = uncompressed_tensors.empty()
+      ? at::empty({0}, input_tensor.options())
+      : at::cat(uncompressed_tensors);
+
+  // The Ps and Qs of a bucket live in one flat tensor each, so that they are
+  // allreduced at once. With warm_start, the Qs of the previous iteration are
+  // the starting point of this one.
+  bool need_randomize_qs = !options_.warm_start ||
+      !q_memory_dict_.count(bucket_index) ||
+      q_memory_dict_[bucket_index].numel() != total_qs_size;
+  if (need_randomize_qs) {
+    p_memory_dict_[bucket_index] =
+        at::empty({total_ps_size}, input_tensor.options());
+    q_memory_dict_[bucket_index] =
+        at::randn(
+            {total_qs_size},
+            generator_,
+            input_tensor.options().device(at::kCPU))
+            .to(input_tensor.device());
+  }
+  auto p_memory = p_memory_dict_[bucket_index];
+  auto q_memory = q_memory_dict_[bucket_index];
+  std::vector<at::Tensor> ps, qs;
+  int64_t p_idx = 0;
+  int64_t q_idx = 0;
+  for (size_t i = 0; i < tensors_to_compress.size(); ++i) {
+    const auto n = tensors_to_compress[i].size(0);
+    const auto m = tensors_to_compress[i].size(1);
+    ps.push_back(p_memory.narrow(0, p_idx, n * ranks[i]).view({n, ranks[i]}));
+    qs.push_back(q_memory.narrow(0, q_idx, m * ranks[i]).view({m, ranks[i]}));
+    p_idx += n * ranks[i];
+    q_idx += m * ranks[i];
+  }
+  for (size_t i = 0; i < tensors_to_compress.size(); ++i) {
+    orthogonalize(qs[i], options_.orthogonalization_epsilon);
+    at::matmul_out(ps[i], tensors_to_compress[i], qs[i]);
+  }
+
+  std::vector<at::Tensor> uncompressed_vec = {uncompressed_tensors_memory};
+  auto uncompressed_work = state_->allreduce(uncompressed_vec);
+  // Since the Ps are orthogonalized afterwards, they are not divided by the
+  // process group size.
+  std::vector<at::Tensor> p_vec = {p_memory};
+  auto p_work = state_->allreduce(p_vec);
+
+  auto decompress = [this,
+                     uncompressed_work,
+                     uncompressed_tensors,
+                     tensors_to_compress,
+                     ps,
+                     qs,
+                     q_memory,
+                     input_tensor,
+                     input_tensor_cp,
+                     bucket_index]() mutable {
+    const auto world_size = state_->getSize();
+    uncompressed_work->wait();
+    auto uncompressed_tensors_memory =
+        uncompressed_work->result()[0].div_(world_size);
+    int64_t idx = 0;
+    for (auto& tensor : uncompressed_tensors) {
+      tensor.copy_(uncompressed_tensors_memory.narrow(0, idx, tensor.numel()));
+      idx += tensor.numel();
+    }
+
+    for (size_t i = 0; i < tensors_to_compress.size(); ++i) {
+      orthogonalize(ps[i], options_.orthogonalization_epsilon);
+      at::matmul_out(qs[i], tensors_to_compress[i].t(), ps[i]);
+    }
+    std::vector<at::Tensor> q_vec = {q_memory};
+    auto q_work = state_->allreduce(q_vec);
+    q_work->wait();
+    q_memory.div_(world_size);
+    for (size_t i = 0; i < tensors_to_compress.size(); ++i) {
+      at::matmul_out(tensors_to_compress[i], ps[i], qs[i].t());
+    }
+
+    if (options_.use_error_feedback) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      error_dict_[bucket_index] = input_tensor_cp - input_tensor;
+    }
+    return c10::IValue(input_tensor);
+  };
+
+  auto fut = p_work->getFuture();
+  return fut->then(decompress, fut->elementType());
+}
+
+TopKSparsifyCommHook::TopKSparsifyCommHook(
+    ProcessGroup* state,
+    const BuiltinCommHookOptions& options)
+    : CppCommHookInterface<ProcessGroup*>(state), options_(options) {
+  TORCH_CHECK(
+      options_.topk_ratio > 0 && options_.topk_ratio <= 1,
+      "topk_ratio must be in (0, 1], got ",
+      options_.topk_ratio);
+  checkStartIter(options_, options_.use_error_feedback);
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> TopKSparsifyCommHook::runHook(
+    GradBucket& bucket) {
+  auto& input_tensor = bucket.getTensorRef();
+  const auto bucket_index = bucket.getIndex();
+  const int64_t iter = iter_;
+  if (bucket.isTheLastBucketToAllreduce()) {
+    ++iter_;
+  }
+  const auto numel = input_tensor.numel();
+  const auto world_size = state_->getSize();
+  const auto k = std::max<int64_t>(
+      1, static_cast<int64_t>(std::ceil(numel * options_.topk_ratio)));
+  // Each rank receives the values and the int64 indices of all the ranks.
+  const bool worth_sparsifying = k * world_size *
+          (input_tensor.element_size() + sizeof(int64_t)) <
+      numel * input_tensor.element_size();
+  if (iter < options_.start_iter || !worth_sparsifying) {
+    return allreduceAndDivide(state_, input_tensor);
+  }
+
+  if (options_.use_error_feedback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = error_dict_.find(bucket_index);
+    if (it != error_dict_.end()) {
+      input_tensor.add_(it->second);
+    }
+  }
+
+  auto indices = std::get<1>(at::topk(input_tensor.abs(), k, 0, true, false));
+  auto values = input_tensor.index_select(0, indices);
+  if (options_.use_error_feedback) {
+    // What is not sent this iteration is added to the next one.
+    auto error = input_tensor.clone();
+    error.index_fill_(0, indices, 0);
+    std::lock_guard<std::mutex> lock(mutex_);
+    error_dict_[bucket_index] = std::move(error);
+  }
+
+  std::vector<std::vector<at::Tensor>> gathered_values(1);
+  std::vector<std::vector<at::Tensor>> gathered_indices(1);
+  for (int i = 0; i < world_size; ++i) {
+    gathered_values[0].push_back(at::empty_like(values));
+    gathered_indices[0].push_back(at::empty_like(indices));
+  }
+  std::vector<at::Tensor> values_vec = {values};
+  std::vector<at::Tensor> indices_vec = {indices};
+  auto values_work = state_->allgather(gathered_values, values_vec);
+  auto indices_work = state_->allgather(gathered_indices, indices_vec);
+
+  auto densify = [values_work,
+                  gathered_values,
+                  gathered_indices,
+                  input_tensor,
+                  world_size]() mutable {
+    values_work->wait();
+    input_tensor.zero_().index_add_(
+        0, at::cat(gathered_indices[0]), at::cat(gathered_values[0]));
+    input_tensor.div_(world_size);
+    return c10::IValue(input_tensor);
+  };
+
+  auto fut = indices_work->getFuture();
+  return fut->then(densify, fut->elementType());
+}
+
 } // namespace c10d
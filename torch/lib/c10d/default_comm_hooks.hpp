@@ -1,13 +1,42 @@
 #pragma once
 
+#include <ATen/core/Generator.h>
 #include <c10d/comm.hpp>
 #include <c10d/ProcessGroup.hpp>
 
+#include <mutex>
+#include <unordered_map>
+
 namespace c10d {
 
 enum class BuiltinCommHookType {
   ALLREDUCE = 1,
   FP16_COMPRESS = 2,
+  POWER_SGD = 3,
+  TOPK_SPARSIFY = 4,
+};
+
+// Hyperparameters of the compression hooks. The PowerSGD ones have the same
+// meaning and defaults as in PowerSGDState of powerSGD_hook.py.
+struct BuiltinCommHookOptions {
+  // Both compression hooks run vanilla allreduce for the first start_iter
+  // iterations. Must be greater than 1 if use_error_feedback or warm_start is
+  // set, since DDP rebuilds its buckets after the first iteration.
+  int64_t start_iter = 1000;
+  // Adds the error of the previous compression of a bucket to its gradients.
+  bool use_error_feedback = true;
+
+  // POWER_SGD only.
+  int64_t matrix_approximation_rank = 1;
+  double min_compression_rate = 2;
+  // Reuses the low-rank Qs of the previous iteration.
+  bool warm_start = true;
+  double orthogonalization_epsilon = 0;
+  // Same on all the replicas, so that they draw the same random Qs.
+  uint64_t random_seed = 0;
+
+  // TOPK_SPARSIFY only, the fraction of the elements of a bucket sent.
+  double topk_ratio = 0.01;
 };
 
 class AllReduceCommHook : public CppCommHookInterface<ProcessGroup*> {
@@ -30,4 +59,49 @@ class FP16CompressCommHook : public CppCommHookInterface<ProcessGroup*> {
   c10::intrusive_ptr<c10::ivalue::Future> runHook(GradBucket& bucket) override;
 };
 
+// Compresses every gradient matrix M of the bucket into the low-rank P and Q
+// such that M ~ P * Q^T, and allreduces P and Q. Gradients that are not
+// worth compressing, like biases, are allreduced in one flat tensor.
+class PowerSGDCommHook : public CppCommHookInterface<ProcessGroup*> {
+ public:
+  PowerSGDCommHook(ProcessGroup* state, const BuiltinCommHookOptions& options);
+
+  ~PowerSGDCommHook() override {}
+
+  c10::intrusive_ptr<c10::ivalue::Future> runHook(GradBucket& bucket) override;
+
+ private:
+  const BuiltinCommHookOptions options_;
+  at::Generator generator_;
+  int64_t iter_ = 0;
+  // Keyed by bucket index.
+  std::unordered_map<size_t, at::Tensor> error_dict_;
+  std::unordered_map<size_t, at::Tensor> p_memory_dict_;
+  std::unordered_map<size_t, at::Tensor> q_memory_dict_;
+  // Guards error_dict_, which is updated once the bucket is reduced.
+  std::mutex mutex_;
+};
+
+// Sends the topk_ratio fraction of the elements of the bucket with the largest
+// magnitude, as values and indices allgathered from all the ranks, and sums
+// them into a dense tensor. Falls back to allreduce if that is not smaller.
+class TopKSparsifyCommHook : public CppCommHookInterface<ProcessGroup*> {
+ public:
+  TopKSparsifyCommHook(
+      ProcessGroup* state,
+      const BuiltinCommHookOptions& options);
+
+  ~TopKSparsifyCommHook() override {}
+
+  c10::intrusive_ptr<c10::ivalue::Future> runHook(GradBucket& bucket) override;
+
+ private:
+  const BuiltinCommHookOptions options_;
+  int64_t iter_ = 0;
+  // Keyed by bucket index.
+  std::unordered_map<size_t, at::Tensor> error_dict_;
+  // Guards error_dict_, which is updated once the bucket is reduced.
+  std::mutex mutex_;
+};
+
 } // namespace c10d
@@ -0,0 +1,333 @@
+#include <c10d/pipeline.hpp>
+
+#include <algorithm>
+
+#include <c10/util/Exception.h>
+#include <torch/csrc/autograd/autograd.h>
+
+namespace c10d {
+
+// Note [Pipeline schedules]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~
+// A model split into P stages, one per rank, each holding V chunks, is a
+// pipeline of P * V virtual stages: chunk c of stage s is virtual stage
+// c * P + s, whose forward output goes to stage (s + 1) % P and whose input
+// gradient goes back to stage (s - 1) % P.
+//
+// With V = 1 stage s runs the 1F1B schedule: the forwards of the first
+// P - s - 1 micro-batches, then alternately one forward and one backward, then
+// the remaining backwards. At most P - s micro-batches have their activations
+// held at once, instead of all of them as when every forward runs first.
+//
+// With V > 1 stage s runs the interleaved schedule: micro-batches go through
+// the chunks in groups of P, forwards in chunk order and backwards in reverse
+// chunk order, with (P - s - 1) * 2 + (V - 1) * P forwards in the warmup. The
+// bubble shrinks by a factor V, for V times as many messages. The number of
+// micro-batches must be a multiple of P.
+std::vector<PipelineAction> makePipelineSchedule(
+    int64_t stage,
+    int64_t num_stages,
+    int64_t num_micro_batches,
+    int64_t num_chunks) {
+  TORCH_CHECK(
+      num_stages > 0 && stage >= 0 && stage < num_stages,
+      "Invalid pipeline stage ",
+      stage,
+      " of ",
+      num_stages);
+  TORCH_CHECK(
+      num_micro_batches > 0,
+      "Expected at least one micro-batch, got ",
+      num_micro_batches);
+  TORCH_CHECK(
+      num_chunks > 0, "Expected at least one model chunk, got ", num_chunks);
+  TORCH_CHECK(
+      num_chunks == 1 || num_micro_batches % num_stages == 0,
+      "The interleaved schedule needs a number of micro-batches that is a "
+      "multiple of the number of stages, got ",
+      num_micro_batches,
+      " micro-batches for ",
+      num_stages,
+      " stages");
+
+  const int64_t total = num_micro_batches * num_chunks;
+  const int64_t warmup = num_chunks == 1
+      ? std::min(num_stages - stage - 1, num_micro_batches)
+      : std::min(
+            (num_stages - stage - 1) * 2 + (num_chunks - 1) * num_stages,
+            total);
+  // The k-th forward or backward of the stage.
+  const auto action = [&](int64_t k, bool forward) {
+    int64_t chunk = (k / num_stages) % num_chunks;
+    if (!forward) {
+      chunk = num_chunks - 1 - chunk;
+    }
+    const int64_t micro_batch =
+        (k / (num_stages * num_chunks)) * num_stages + k % num_stages;
+    return PipelineAction{forward, chunk, micro_batch};
+  };
+
+  std::vector<PipelineAction> schedule;
+  schedule.reserve(total * 2);
+  for (int64_t k = 0; k < warmup; k++) {
+    schedule.push_back(action(k, /*forward=*/true));
+  }
+  for (int64_t k = 0; k < total - warmup; k++) {
+    schedule.push_back(action(warmup + k, /*forward=*/true));
+    schedule.push_back(action(k, /*forward=*/false));
+  }
+  for (int64_t k = total - warmup; k < total; k++) {
+    schedule.push_back(action(k, /*forward=*/false));
+  }
+  return schedule;
+}
+
+PipelineExecutor::PipelineExecutor(
+    c10::intrusive_ptr<ProcessGroup> forward_group,
+    c10::intrusive_ptr<ProcessGroup> backward_group,
+    std::vector<StageFn> chunks,
+    int64_t num_micro_batches,
+    std::vector<int64_t> activation_shape,
+    at::TensorOptions activation_options)
+    : forward_group_(std::move(forward_group)),
+      backward_group_(std::move(backward_group)),
+      chunks_(std::move(chunks)),
+      stage_(forward_group_->getRank()),
+      num_stages_(forward_group_->getSize()),
+      num_micro_batches_(num_micro_batches),
+      activation_shape_(std::move(activation_shape)),
+      activation_options_(activation_options),
+      schedule_(makePipelineSchedule(
+          stage_,
+          num_stages_,
+          num_micro_batches_,
+          chunks_.size())) {
+  TORCH_CHECK(
+      backward_group_->getRank() == stage_ &&
+          backward_group_->getSize() == num_stages_,
+      "The forward and backward process groups of a pipeline must have the "
+      "same ranks");
+  // NCCL orders the sends and recvs between two ranks of a process group on
+  // one stream, so a send only completes once the peer reaches the matching
+  // recv. Each direction needs its own group, and with two stages the
+  // interleaved schedule sends activations both ways between the same ranks.
+  if (forward_group_->getBackendName() == "nccl") {
+    TORCH_CHECK(
+        forward_group_ != backward_group_,
+        "A pipeline over NCCL needs distinct forward and backward process "
+        "groups");
+    TORCH_CHECK(
+        chunks_.size() == 1 || num_stages_ > 2,
+        "The interleaved schedule needs more than two stages over NCCL");
+  }
+}
+
+bool PipelineExecutor::isFirst(int64_t chunk) const {
+  return stage_ == 0 && chunk == 0;
+}
+
+bool PipelineExecutor::isLast(int64_t chunk) const {
+  return stage_ == num_stages_ - 1 &&
+      chunk == static_cast<int64_t>(chunks_.size()) - 1;
+}
+
+int PipelineExecutor::tag(int64_t stage, int64_t chunk, int64_t micro_batch)
+    const {
+  return static_cast<int>(
+      (chunk * num_stages_ + stage) * num_micro_batches_ + micro_batch);
+}
+
+// Note [Pipeline executor]
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+// The executor runs the actions of makePipelineSchedule in order on the
+// calling thread. Communication never waits on compute: sends are posted as
+// soon as an activation or gradient is ready and only waited on at the end of
+// the run, and the recvs of the next forward and of the next backward are
+// posted before the current action runs, so the transfer of the next input
+// overlaps with the current compute. With NCCL the sends and recvs run on the
+// streams the process group keeps per pair of ranks, and waiting on a recv
+// only makes the current stream wait on it.
+//
+// A received activation is made a leaf that requires grad, so the backward of
+// a micro-batch, which the autograd engine runs from its output and the
+// gradient received for it, leaves the gradient to send back in its grad.
+void PipelineExecutor::postRecvs(size_t index) {
+  for (const bool forward : {true, false}) {
+    auto& next = forward ? next_forward_recv_ : next_backward_recv_;
+    while (next < schedule_.size()) {
+      const auto& action = schedule_[next];
+      const bool ahead = next > index;
+      next++;
+      if (action.forward != forward ||
+          (forward ? isFirst(action.chunk) : isLast(action.chunk))) {
+        continue;
+      }
+      std::vector<at::Tensor> tensors{
+          at::empty(activation_shape_, activation_options_)};
+      c10::intrusive_ptr<ProcessGroup::Work> work;
+      if (forward) {
+        const int64_t src = (stage_ + num_stages_ - 1) % num_stages_;
+        const int64_t src_chunk =
+            stage_ == 0 ? action.chunk - 1 : action.chunk;
+        work = forward_group_->recv(
+            tensors, src, tag(src, src_chunk, action.micro_batch));
+      } else {
+        const int64_t src = (stage_ + 1) % num_stages_;
+        const int64_t src_chunk =
+            stage_ == num_stages_ - 1 ? action.chunk + 1 : action.chunk;
+        work = backward_group_->recv(
+            tensors, src, tag(src, src_chunk, action.micro_batch));
+      }
+      auto& recvs = forward ? forward_recvs_ : backward_recvs_;
+      recvs.emplace(
+          Key(action.chunk, action.micro_batch),
+          PendingOp{tensors[0], std::move(work)});
+      if (ahead) {
+        break;
+      }
+    }
+  }
+}
+
+at::Tensor PipelineExecutor::waitRecv(
+    std::map<Key, PendingOp>& recvs,
+    const Key& key) {
+  auto it = recvs.find(key);
+  TORCH_INTERNAL_ASSERT(it != recvs.end());
+  auto op = std::move(it->second);
+  recvs.erase(it);
+  op.work->wait();
+  return op.tensor;
+}
+
+void PipelineExecutor::send(
+    ProcessGroup& group,
+    at::Tensor tensor,
+    int dst_rank,
+    int tag) {
+  // Drop the sends that are done, so their tensors can be freed.
+  sends_.erase(
+      std::remove_if(
+          sends_.begin(),
+          sends_.end(),
+          [](const PendingOp& op) {
+            if (!op.work->isCompleted()) {
+              return false;
+            }
+            op.work->wait();
+            return true;
+          }),
+      sends_.end());
+  std::vector<at::Tensor> tensors{tensor.contiguous()};
+  auto work = group.send(tensors, dst_rank, tag);
+  sends_.push_back(PendingOp{tensors[0], std::move(work)});
+}
+
+void PipelineExecutor::forward(
+    const PipelineAction& action,
+    const std::vector<at::Tensor>& inputs) {
+  const Key key(action.chunk, action.micro_batch);
+  const auto input = isFirst(action.chunk)
+      ? inputs[action.micro_batch]
+      : waitRecv(forward_recvs_, key).requires_grad_(true);
+  auto output = chunks_[action.chunk](input, action.micro_batch);
+  TORCH_CHECK(
+      output.defined(),
+      "Chunk ",
+      action.chunk,
+      " of pipeline stage ",
+      stage_,
+      " returned an undefined tensor");
+  if (isLast(action.chunk)) {
+    losses_[action.micro_batch] = output.detach();
+  } else {
+    TORCH_CHECK(
+        output.sizes() == activation_shape_ &&
+            output.scalar_type() ==
+                c10::typeMetaToScalarType(activation_options_.dtype()),
+        "Chunk ",
+        action.chunk,
+        " of pipeline stage ",
+        stage_,
+        " returned an activation of shape ",
+        output.sizes(),
+        " and type ",
+        output.scalar_type(),
+        ", expected shape ",
+        activation_shape_,
+        " and type ",
+        activation_options_.dtype());
+    send(
+        *forward_group_,
+        output.detach(),
+        (stage_ + 1) % num_stages_,
+        tag(stage_, action.chunk, action.micro_batch));
+  }
+  activations_.emplace(key, std::make_pair(input, std::move(output)));
+}
+
+void PipelineExecutor::backward(const PipelineAction& action) {
+  const Key key(action.chunk, action.micro_batch);
+  auto it = activations_.find(key);
+  TORCH_INTERNAL_ASSERT(it != activations_.end());
+  const auto input = std::move(it->second.first);
+  const auto output = std::move(it->second.second);
+  activations_.erase(it);
+
+  if (isLast(action.chunk)) {
+    torch::autograd::backward({output});
+  } else {
+    torch::autograd::backward({output}, {waitRecv(backward_recvs_, key)});
+  }
+  if (!isFirst(action.chunk)) {
+    auto grad = input.grad();
+    if (!grad.defined()) {
+      grad = at::zeros_like(input);
+    }
+    send(
+        *backward_group_,
+        grad,
+        (stage_ + num_stages_ - 1) % num_stages_,
+        tag(stage_, action.chunk, action.micro_batch));
+  }
+}
+
+std::vector<at::Tensor> PipelineExecutor::run(
+    const std::vector<at::Tensor>& inputs) {
+  if (stage_ == 0) {
+    TORCH_CHECK(
+        static_cast<int64_t>(inputs.size()) == num_micro_batches_,
+        "Expected ",
+        num_micro_batches_,
+        " micro-batches on the first pipeline stage, got ",
+        inputs.size());
+  }
+  // Start from a clean state even if the previous run threw.
+  next_forward_recv_ = 0;
+  next_backward_recv_ = 0;
+  forward_recvs_.clear();
+  backward_recvs_.clear();
+  activations_.clear();
+  sends_.clear();
+  losses_.clear();
+  if (stage_ == num_stages_ - 1) {
+    losses_.resize(num_micro_batches_);
+  }
+
+  for (size_t i = 0; i < schedule_.size(); i++) {
+    postRecvs(i);
+    const auto& action = schedule_[i];
+    if (action.forward) {
+      forward(action, inputs);
+    } else {
+      backward(action);
+    }
+  }
+  for (auto& op : sends_) {
+    op.work->wait();
+  }
+  sends_.clear();
+  return std::move(losses_);
+}
+
+} // namespace c10d
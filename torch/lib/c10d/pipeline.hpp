@@ -0,0 +1,116 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <c10/util/intrusive_ptr.h>
+#include <c10d/ProcessGroup.hpp>
+
+namespace c10d {
+
+// One step of a pipeline schedule: the forward or the backward of a
+// micro-batch through one of the model chunks held by this stage.
+struct PipelineAction {
+  bool forward;
+  int64_t chunk;
+  int64_t micro_batch;
+};
+
+// Returns the actions stage runs, in order, for a pipeline of num_stages
+// stages each holding num_chunks model chunks. With one chunk this is the 1F1B
+// schedule, with more the interleaved one, see Note [Pipeline schedules].
+std::vector<PipelineAction> makePipelineSchedule(
+    int64_t stage,
+    int64_t num_stages,
+    int64_t num_micro_batches,
+    int64_t num_chunks);
+
+// Runs the forward and backward passes of micro-batches through a model split
+// across the ranks of a process group, see Note [Pipeline executor].
+class PipelineExecutor {
+ public:
+  // Runs a model chunk on the input of a micro-batch. The last chunk of the
+  // last stage returns the loss, every other one the activation passed to the
+  // next chunk, which must have the shape and options given to the executor.
+  using StageFn =
+      std::function<at::Tensor(const at::Tensor& input, int64_t micro_batch)>;
+
+  // Activations travel through forward_group and their gradients through
+  // backward_group, which must have the same ranks, the rank being the stage.
+  PipelineExecutor(
+      c10::intrusive_ptr<ProcessGroup> forward_group,
+      c10::intrusive_ptr<ProcessGroup> backward_group,
+      std::vector<StageFn> chunks,
+      int64_t num_micro_batches,
+      std::vector<int64_t> activation_shape,
+      at::TensorOptions activation_options);
+
+  // Runs the forward and backward passes of all micro-batches. inputs are the
+  // micro-batches and are only used on the first stage. Gradients accumulate
+  // into the parameters of the chunks as in a plain backward. Returns the
+  // detached losses on the last stage, and nothing on the others.
+  std::vector<at::Tensor> run(const std::vector<at::Tensor>& inputs);
+
+  const std::vector<PipelineAction>& schedule() const {
+    return schedule_;
+  }
+
+ private:
+  using Key = std::pair<int64_t, int64_t>;
+
+  // A tensor and the send or recv work that uses it.
+  struct PendingOp {
+    at::Tensor tensor;
+    c10::intrusive_ptr<ProcessGroup::Work> work;
+  };
+
+  bool isFirst(int64_t chunk) const;
+  bool isLast(int64_t chunk) const;
+
+  // Tag of the message sent from the given chunk of stage, which identifies
+  // it among those of the other micro-batches and chunks on the same pair.
+  int tag(int64_t stage, int64_t chunk, int64_t micro_batch) const;
+
+  // Posts the recvs of the actions up to index and of the first forward and
+  // the first backward action after it that were not posted yet.
+  void postRecvs(size_t index);
+
+  at::Tensor waitRecv(std::map<Key, PendingOp>& recvs, const Key& key);
+
+  void send(ProcessGroup& group, at::Tensor tensor, int dst_rank, int tag);
+
+  void forward(
+      const PipelineAction& action,
+      const std::vector<at::Tensor>& inputs);
+
+  void backward(const PipelineAction& action);
+
+  const c10::intrusive_ptr<ProcessGroup> forward_group_;
+  const c10::intrusive_ptr<ProcessGroup> backward_group_;
+  const std::vector<StageFn> chunks_;
+  const int64_t stage_;
+  const int64_t num_stages_;
+  const int64_t num_micro_batches_;
+  const std::vector<int64_t> activation_shape_;
+  const at::TensorOptions activation_options_;
+  const std::vector<PipelineAction> schedule_;
+
+  // State of one run.
+  // Index in schedule_ of the next forward and backward action whose recv
+  // is not posted yet.
+  size_t next_forward_recv_ = 0;
+  size_t next_backward_recv_ = 0;
+  std::map<Key, PendingOp> forward_recvs_;
+  std::map<Key, PendingOp> backward_recvs_;
+  // Input and output of the forward of each (chunk, micro-batch) until its
+  // backward has run.
+  std::map<Key, std::pair<at::Tensor, at::Tensor>> activations_;
+  std::vector<PendingOp> sends_;
+  std::vector<at::Tensor> losses_;
+};
+
+} // namespace c10d
@@ -1,6 +1,9 @@
 #include <c10d/reducer.hpp>
 
+#include <algorithm>
 #include <functional>
+#include <limits>
+#include <numeric>
 
 #include <c10/core/DeviceGuard.h>
 #include <c10/core/StreamGuard.h>
@@ -24,6 +27,11 @@ inline int64_t current_time_in_nanos() {
 
 constexpr int kUnsetDivFactor = -1;
 
+// Sizes of the buffers allreduced to measure the cost of an allreduce, the
+// large one being at least twice the small one, and timed runs of each.
+constexpr int64_t kAllreduceCostSmallBytes = 64 * 1024;
+constexpr int kAllreduceCostRuns = 3;
+
 } // namespace
 
 Reducer::Reducer(
@@ -527,8 +535,10 @@ void Reducer::mark_variable_ready(VariableIndex index) {
       auto results = workHandle->result();
       // Guard against the results being empty
       TORCH_INTERNAL_ASSERT(results.size() > 0);
+      // The first element counts the active processes, see
+      // DistributedDataParallel.forward.
       at::Tensor& res = results.front();
-      divFactor_ = res.item().to<int>();
+      divFactor_ = res[0].item().to<int>();
     }
   }
 
@@ -659,7 +669,9 @@ void Reducer::mark_bucket_ready(size_t bucket_index) {
     // See Note [DDP Communication Hook]
     // TODO(@sinannasir): merge `work` and `future_work`. Related to GH Issue
     // #41266.
-    if (comm_hook_ == nullptr) {
+    if (shard_bucket_optimizer_) {
+      bucket.future_work = step_sharded_bucket_optimizer(next_bucket_, bucket);
+    } else if (comm_hook_ == nullptr) {
       bucket.work = process_group_->allreduce(tensors);
     } else {
       GradBucket grad_bucket(
@@ -672,9 +684,122 @@ void Reducer::mark_bucket_ready(size_t bucket_index) {
           bucket.replicas[0].sizes_vec);
       bucket.future_work = comm_hook_->runHook(grad_bucket);
     }
+    if (bucket_optimizer_ != nullptr && !shard_bucket_optimizer_) {
+      bucket.future_work = step_bucket_optimizer(
+          bucket,
+          comm_hook_ == nullptr ? bucket.work->getFuture()
+                                : bucket.future_work);
+    }
   }
 }
 
+// Note [Fused bucket optimizer step]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// With a bucket optimizer registered, the parameters of a bucket are updated
+// in a callback of the future of its reduction. The step of a bucket then runs
+// (on the streams of that future, after the reduction) while the backward pass
+// computes and reduces the next buckets, instead of the steps of all the
+// parameters running after the backward pass. finalize_backward waits on the
+// future of the step, so the next forward pass sees the updated parameters.
+//
+// The grads passed to the optimizer are the bucket views, which requires
+// gradient_as_bucket_view for the grads of the parameters to be them, and
+// every parameter must get a gradient in every iteration, as an unused one
+// would be stepped on a zero gradient.
+c10::intrusive_ptr<torch::jit::Future> Reducer::step_bucket_optimizer(
+    Bucket& bucket,
+    c10::intrusive_ptr<torch::jit::Future> reduced) {
+  // Since currently we do not support single-process multiple-device mode, we
+  // can assume only one replica in the bucket.
+  const auto& replica = bucket.replicas[0];
+  auto step = [this,
+               reduced,
+               contents = replica.contents,
+               variable_indices = bucket.variable_indices,
+               params = replica.variables,
+               grads = replica.bucket_views_in]() {
+    if (comm_hook_ != nullptr) {
+      // The hook may return its result in a newly allocated tensor.
+      const auto result = comm_hook_->parseHookResult(reduced->value())[0];
+      if (!result.is_alias_of(contents)) {
+        contents.copy_(result);
+      }
+    }
+    bucket_optimizer_->step(variable_indices, params, grads);
+    return c10::IValue(c10::List<at::Tensor>({contents}));
+  };
+  return reduced->then(step, c10::ListType::create(c10::TensorType::get()));
+}
+
+// Note [Sharded bucket optimizer step]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// With a sharded bucket optimizer, the contents of a bucket, padded to a
+// multiple of the world size, are reduce-scattered instead of allreduced, so
+// that each process only gets the reduced gradients of its shard of the
+// bucket. It steps the same shard of the parameters of the bucket, flattened
+// like their gradients, and the updated shards are then allgathered into the
+// parameters of every process. The optimizer state is only held for the shard,
+// which divides its memory by the world size, and the contents of the buckets
+// (hence the grads of the parameters) are left unreduced.
+//
+// The allgather is issued in the callback of the reduce-scatter, which runs
+// inline since the future of a NCCL work is completed when the work is
+// enqueued, so every process issues the collectives in the same order. The
+// state is kept by bucket index, so the buckets are not rebuilt.
+c10::intrusive_ptr<torch::jit::Future> Reducer::step_sharded_bucket_optimizer(
+    size_t bucket_index,
+    Bucket& bucket) {
+  const auto& replica = bucket.replicas[0];
+  const int64_t world_size = process_group_->getSize();
+  const int64_t numel = replica.contents.numel();
+  const int64_t shard_size = (numel + world_size - 1) / world_size;
+  const int64_t padding = shard_size * world_size - numel;
+  // The gradients were already divided by divFactor_ when copied into the
+  // bucket, as for allreduce.
+  auto grads = padding == 0
+      ? replica.contents
+      : at::constant_pad_nd(replica.contents, {0, padding});
+  std::vector<std::vector<at::Tensor>> inputs = {grads.chunk(world_size)};
+  std::vector<at::Tensor> outputs = {
+      at::empty({shard_size}, replica.contents.options())};
+  auto work = process_group_->reduce_scatter(outputs, inputs);
+
+  auto step = [this,
+               work,
+               bucket_index,
+               shard_size,
+               world_size,
+               params = replica.variables,
+               grad_views = replica.bucket_views_in,
+               offsets = replica.offsets]() {
+    at::NoGradGuard no_grad;
+    auto grad_shard = work->result()[0];
+    // Laid out like the grads, so that the shards match.
+    auto flat_params = at::zeros({shard_size * world_size}, grad_shard.options());
+    std::vector<at::Tensor> param_views;
+    param_views.reserve(params.size());
+    for (size_t i = 0; i < params.size(); i++) {
+      param_views.push_back(flat_params.as_strided(
+          grad_views[i].sizes(), grad_views[i].strides(), offsets[i]));
+      param_views.back().copy_(params[i]);
+    }
+    auto param_shard = flat_params.narrow(
+        0, process_group_->getRank() * shard_size, shard_size);
+    bucket_optimizer_->step({bucket_index}, {param_shard}, {grad_shard});
+
+    std::vector<std::vector<at::Tensor>> gathered = {
+        flat_params.chunk(world_size)};
+    std::vector<at::Tensor> shard = {param_shard};
+    process_group_->allgather(gathered, shard)->wait();
+    for (size_t i = 0; i < params.size(); i++) {
+      params[i].copy_(param_views[i]);
+    }
+    return c10::IValue(c10::List<at::Tensor>({grad_shard}));
+  };
+  auto fut = work->getFuture();
+  return fut->then(step, fut->elementType());
+}
+
 void Reducer::initialize_buckets(
     std::vector<std::vector<size_t>> bucket_indices) {
   // If initialize_buckets is called inside DDP constructor, then
@@ -1171,8 +1296,17 @@ void Reducer::finalize_backward() {
 
   // Wait for asynchronous reduction to complete and unflatten contents.
   for (auto& bucket : buckets_) {
-    // See Note [DDP Communication Hook]
-    if (comm_hook_ == nullptr) {
+    if (bucket_optimizer_ != nullptr) {
+      // See Note [Fused bucket optimizer step]. The contents of the bucket
+      // already hold the reduced gradients, or with a sharded optimizer keep
+      // the local ones, see Note [Sharded bucket optimizer step].
+      TORCH_INTERNAL_ASSERT(
+          bucket.future_work,
+          "Expected bucket.future_work not to be null. "
+          "This may indicate that the bucket optimizer was not properly installed.");
+      bucket.future_work->wait();
+    } else if (comm_hook_ == nullptr) {
+      // See Note [DDP Communication Hook]
       TORCH_INTERNAL_ASSERT(
           bucket.work,
           "Expected bucket.work not to be null. "
@@ -1229,6 +1363,8 @@ void Reducer::finalize_backward() {
   if (should_collect_runtime_stats()) {
     record_backward_comm_end_time();
   }
+
+  record_ready_times();
 }
 
 void Reducer::runGradCallbackForVariable(
@@ -1337,6 +1473,10 @@ bool Reducer::rebuild_buckets() {
   // exception below.
   std::lock_guard<std::mutex> lock(mutex_);
   ensure_prior_reduction_finished();
+  if (should_tune_buckets()) {
+    tune_buckets();
+    return true;
+  }
   if (!should_rebuild_buckets() || rebuilt_params_.empty()) {
     return false;
   }
@@ -1379,21 +1519,134 @@ bool Reducer::rebuild_buckets() {
   return true;
 }
 
+// Note [Adaptive bucketing]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~
+// The buckets are first assigned by size, in the reverse order of the
+// parameters, then rebuilt once in the order their gradients were ready in the
+// first iteration. With adaptive bucketing, the times the gradients are ready,
+// relative to the start of the backward pass, are then averaged over a number
+// of iterations, and the cost of an allreduce is measured as alpha + beta *
+// bytes. The buckets are reduced one after the other, each when its last
+// gradient is ready and the previous reduction ended, so the end of the
+// reduction of the last bucket is a function of the bucket boundaries, which
+// compute_bucket_assignment_by_time minimizes with dynamic programming over
+// the gradients in ready order. Few large buckets pay for waiting on their last
+// gradient, many small ones for alpha, and the communication exposed after the
+// backward pass is the difference between the two.
+//
+// The times are host timestamps of the autograd hooks, so on GPUs they are when
+// the kernels were launched rather than run. Every rank tunes the buckets with
+// its own timings and the buckets of rank 0 are used, through
+// sync_bucket_indices.
+void Reducer::enable_adaptive_bucketing(size_t num_iterations) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  TORCH_CHECK(num_iterations > 0, "Expected num_iterations > 0.");
+  TORCH_CHECK(
+      !find_unused_parameters_,
+      "Adaptive bucketing does not support find_unused_parameters=True.");
+  TORCH_CHECK(
+      !shard_bucket_optimizer_,
+      "Adaptive bucketing cannot be combined with a sharded bucket optimizer.");
+  TORCH_CHECK(
+      replicas_.size() == 1,
+      "Adaptive bucketing does not support single-process multiple-device mode.");
+  adaptive_bucketing_iterations_ = num_iterations;
+}
+
+bool Reducer::should_tune_buckets() const {
+  return adaptive_bucketing_iterations_ > 0 && !has_tuned_buckets_ &&
+      adaptive_bucketing_samples_ >= adaptive_bucketing_iterations_;
+}
+
+void Reducer::record_ready_times() {
+  // Only time the buckets that will be tuned, rebuilt ones.
+  if (adaptive_bucketing_iterations_ == 0 || has_tuned_buckets_ ||
+      should_rebuild_buckets()) {
+    return;
+  }
+  const auto& ready_times = backward_stats_[0];
+  if (ready_time_sums_.empty()) {
+    ready_time_sums_.assign(ready_times.size(), 0);
+  }
+  for (size_t i = 0; i < ready_times.size(); i++) {
+    ready_time_sums_[i] += ready_times[i];
+  }
+  adaptive_bucketing_samples_++;
+}
+
+std::pair<double, double> Reducer::measure_allreduce_cost() {
+  const auto& variable = replicas_[0][0];
+  const auto time_allreduce = [&](int64_t bytes) {
+    auto tensor = at::zeros(
+        {std::max<int64_t>(bytes / variable.element_size(), 1)},
+        variable.options());
+    std::vector<at::Tensor> tensors = {tensor};
+    auto best = std::numeric_limits<int64_t>::max();
+    // The first run is a warmup.
+    for (int run = 0; run <= kAllreduceCostRuns; run++) {
+      const auto start = current_time_in_nanos();
+      process_group_->allreduce(tensors)->wait();
+      // Also waits for the allreduce to end on the device.
+      tensor[0].item();
+      if (run > 0) {
+        best = std::min(best, current_time_in_nanos() - start);
+      }
+    }
+    return static_cast<double>(best);
+  };
+  const int64_t small_bytes = kAllreduceCostSmallBytes;
+  const int64_t large_bytes = std::max(bucket_bytes_cap_, 2 * small_bytes);
+  const double small_time = time_allreduce(small_bytes);
+  const double large_time = time_allreduce(large_bytes);
+  const double beta =
+      std::max(large_time - small_time, 0.0) / (large_bytes - small_bytes);
+  const double alpha = std::max(small_time - beta * small_bytes, 0.0);
+  return {alpha, beta};
+}
+
+void Reducer::tune_buckets() {
+  double alpha, beta;
+  std::tie(alpha, beta) = measure_allreduce_cost();
+  std::vector<double> ready_times;
+  ready_times.reserve(ready_time_sums_.size());
+  for (const auto sum : ready_time_sums_) {
+    ready_times.push_back(
+        static_cast<double>(sum) / adaptive_bucketing_samples_);
+  }
+  auto bucket_indices = compute_bucket_assignment_by_time(
+      replicas_[0], ready_times, alpha, beta, expect_sparse_gradients_[0]);
+  sync_bucket_indices(bucket_indices);
+
+  has_tuned_buckets_ = true;
+  ready_time_sums_.clear();
+  LOG(INFO) << "Reducer buckets have been tuned to " << bucket_indices.size()
+            << " buckets, with an allreduce cost of " << alpha << " + " << beta
+            << " * bytes ns.";
+  initialize_buckets(std::move(bucket_indices));
+}
+
 // See Note [DDP Communication Hook]
 void Reducer::register_comm_hook(std::unique_ptr<CommHookInterface> iface) {
   TORCH_CHECK(
       comm_hook_ == nullptr,
       "register_comm_hook or register_builtin_comm_hook can only be called once.");
+  TORCH_CHECK(
+      !shard_bucket_optimizer_,
+      "register_comm_hook cannot be combined with a sharded bucket optimizer.");
 
   comm_hook_ = std::move(iface);
 }
 
 // See Note [DDP Communication Hook]
 void Reducer::register_builtin_comm_hook(
-    c10d::BuiltinCommHookType comm_hook_type) {
+    c10d::BuiltinCommHookType comm_hook_type,
+    const c10d::BuiltinCommHookOptions& options) {
   TORCH_CHECK(
       comm_hook_ == nullptr,
       "register_builtin_comm_hook or register_comm_hook can only be called once.");
+  TORCH_CHECK(
+      !shard_bucket_optimizer_,
+      "register_builtin_comm_hook cannot be combined with a sharded bucket optimizer.");
   // TODO: Support GLOO and MPI backends for DDP communication hook.
   TORCH_CHECK(
       process_group_->getBackendName() == "nccl",
@@ -1411,12 +1664,60 @@ void Reducer::register_builtin_comm_hook(
           std::make_unique<c10d::FP16CompressCommHook>(process_group_.get());
       LOG(INFO) << "Built-in communication hook FP16_COMPRESS is registered.";
       break;
+    case c10d::BuiltinCommHookType::POWER_SGD:
+      comm_hook_ = std::make_unique<c10d::PowerSGDCommHook>(
+          process_group_.get(), options);
+      LOG(INFO) << "Built-in communication hook POWER_SGD is registered.";
+      break;
+    case c10d::BuiltinCommHookType::TOPK_SPARSIFY:
+      comm_hook_ = std::make_unique<c10d::TopKSparsifyCommHook>(
+          process_group_.get(), options);
+      LOG(INFO) << "Built-in communication hook TOPK_SPARSIFY is registered.";
+      break;
     default:
       TORCH_WARN_ONCE(
           "Unknown built-in DDP comm hook type is provided. No comm hook will be used.");
   }
 }
 
+// See Note [Fused bucket optimizer step]
+void Reducer::register_bucket_optimizer(
+    c10d::BucketOptimizerType optimizer_type,
+    const c10d::BucketOptimizerOptions& options,
+    bool shard_optimizer_state) {
+  TORCH_CHECK(
+      bucket_optimizer_ == nullptr,
+      "register_bucket_optimizer can only be called once.");
+  TORCH_CHECK(
+      !shard_optimizer_state || comm_hook_ == nullptr,
+      "register_bucket_optimizer with shard_optimizer_state=True cannot be combined with a comm hook.");
+  TORCH_CHECK(
+      process_group_->getBackendName() == "nccl",
+      "register_bucket_optimizer currently can only support NCCL backend, but the current backend is ",
+      process_group_->getBackendName());
+  TORCH_CHECK(
+      replicas_.size() == 1,
+      "register_bucket_optimizer does not support single-process multiple-device mode.");
+  TORCH_CHECK(
+      gradient_as_bucket_view_,
+      "register_bucket_optimizer requires gradient_as_bucket_view=True.");
+  TORCH_CHECK(
+      !find_unused_parameters_,
+      "register_bucket_optimizer does not support find_unused_parameters=True.");
+  for (const auto expect_sparse_gradient : expect_sparse_gradients_[0]) {
+    TORCH_CHECK(
+        !expect_sparse_gradient,
+        "register_bucket_optimizer does not support sparse gradients.");
+  }
+
+  bucket_optimizer_ = makeBucketOptimizer(optimizer_type, options);
+  shard_bucket_optimizer_ = shard_optimizer_state;
+  LOG(INFO) << (shard_optimizer_state ? "Sharded bucket optimizer "
+                                      : "Bucket optimizer ")
+            << (optimizer_type == BucketOptimizerType::SGD ? "SGD" : "ADAM")
+            << " is registered.";
+}
+
 void Reducer::ensure_prior_reduction_finished() {
   // Check that any prior reduction has finished.
   // The variable `require_finalize_` is true until all gradients
@@ -1682,6 +1983,81 @@ std::vector<std::vector<size_t>> compute_bucket_assignment_by_size(
   return result;
 }
 
+// See Note [Adaptive bucketing]
+std::vector<std::vector<size_t>> compute_bucket_assignment_by_time(
+    const std::vector<at::Tensor>& tensors,
+    const std::vector<double>& ready_times,
+    double alpha,
+    double beta,
+    const std::vector<bool>& expect_sparse_gradient,
+    const std::vector<int64_t>& tensor_indices) {
+  TORCH_INTERNAL_ASSERT(tensors.size() > 0);
+  TORCH_INTERNAL_ASSERT(tensors.size() == ready_times.size());
+  TORCH_INTERNAL_ASSERT(
+      expect_sparse_gradient.empty() ||
+      (tensors.size() == expect_sparse_gradient.size()));
+  const auto tensor_index = [&](size_t i) -> size_t {
+    return tensor_indices.empty() ? i : tensor_indices[i];
+  };
+  const auto is_sparse = [&](size_t i) {
+    return !expect_sparse_gradient.empty() &&
+        expect_sparse_gradient[tensor_index(i)];
+  };
+
+  // Tensors in the order their gradients are ready.
+  const auto num_tensors = tensors.size();
+  std::vector<size_t> order(num_tensors);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return ready_times[a] < ready_times[b];
+  });
+  // bytes[j] is the size of the first j tensors.
+  std::vector<double> bytes(num_tensors + 1, 0);
+  for (size_t j = 0; j < num_tensors; j++) {
+    const auto& tensor = tensors[order[j]];
+    TORCH_CHECK(!tensor.is_sparse(), "No support for sparse tensors.");
+    bytes[j + 1] = bytes[j] + tensor.numel() * tensor.element_size();
+  }
+
+  // end[j] is the earliest the reduction of the first j tensors can end, when
+  // the last of their buckets starts at the tensor start[j]. A bucket cannot
+  // mix types or devices, and a sparse gradient gets its own bucket.
+  std::vector<double> end(
+      num_tensors + 1, std::numeric_limits<double>::infinity());
+  std::vector<size_t> start(num_tensors + 1, 0);
+  end[0] = std::numeric_limits<double>::lowest();
+  for (size_t j = 1; j <= num_tensors; j++) {
+    const auto& last = tensors[order[j - 1]];
+    const auto key = BucketKey(last.scalar_type(), last.device());
+    for (size_t i = j; i-- > 0;) {
+      const auto& first = tensors[order[i]];
+      if (i < j - 1 &&
+          (is_sparse(order[i]) || is_sparse(order[j - 1]) ||
+           !(BucketKey(first.scalar_type(), first.device()) == key))) {
+        break;
+      }
+      const double bucket_end = std::max(end[i], ready_times[order[j - 1]]) +
+          alpha + beta * (bytes[j] - bytes[i]);
+      if (bucket_end < end[j]) {
+        end[j] = bucket_end;
+        start[j] = i;
+      }
+    }
+  }
+
+  std::vector<std::vector<size_t>> result;
+  for (size_t j = num_tensors; j > 0; j = start[j]) {
+    std::vector<size_t> bucket;
+    bucket.reserve(j - start[j]);
+    for (size_t k = start[j]; k < j; k++) {
+      bucket.push_back(tensor_index(order[k]));
+    }
+    result.push_back(std::move(bucket));
+  }
+  std::reverse(result.begin(), result.end());
+  return result;
+}
+
 // Verifies corresponding params in replica 0 have the same sizes/strides
 // across processes.
 void verify_replica0_across_processes(
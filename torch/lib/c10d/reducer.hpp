@@ -12,6 +12,7 @@
 
 #include <c10/util/intrusive_ptr.h>
 #include <c10d/ProcessGroup.hpp>
+#include <c10d/bucket_optimizer.hpp>
 #include <c10d/comm.hpp>
 #include <c10d/default_comm_hooks.hpp>
 #include <torch/csrc/autograd/function.h>
@@ -74,8 +75,23 @@ class Reducer {
 
   // Registers a built-in C++ comm hook to the reducer. This function can only
   // be called once before calling backward.
-  // Cannot combine with the call of `register_comm_hook`.
-  void register_builtin_comm_hook(c10d::BuiltinCommHookType comm_hook_type);
+  // Cannot combine with the call of `register_comm_hook`. The options are only
+  // used by the compression hooks.
+  void register_builtin_comm_hook(
+      c10d::BuiltinCommHookType comm_hook_type,
+      const c10d::BuiltinCommHookOptions& options = {});
+
+  // Registers an optimizer that updates the parameters of each bucket as soon
+  // as the bucket is reduced, instead of after the whole backward pass. This
+  // function can only be called once before calling backward. The parameters
+  // must then not be stepped by another optimizer. If shard_optimizer_state,
+  // each process only reduces and steps its shard of every bucket.
+  // See Note [Fused bucket optimizer step] and
+  // Note [Sharded bucket optimizer step].
+  void register_bucket_optimizer(
+      c10d::BucketOptimizerType optimizer_type,
+      const c10d::BucketOptimizerOptions& options = {},
+      bool shard_optimizer_state = false);
 
   // Returns a vector of tensors in each bucket in sequential order.
   std::vector<std::vector<at::Tensor>> get_bucket_tensors() const;
@@ -93,11 +109,19 @@ class Reducer {
   // rebuilt.
   bool rebuild_buckets();
 
+  // Tunes the bucket sizes once, after timing the backward passes of
+  // num_iterations iterations that follow the rebuild of the buckets, see
+  // Note [Adaptive bucketing]. The tuned buckets are set by the next
+  // rebuild_buckets call.
+  void enable_adaptive_bucketing(size_t num_iterations);
+
   // Returns true if we should rebuild buckets, else false. We only rebuild
   // buckets once after the first iteration and never rebuild them if
-  // find_unused_parameters_.
+  // find_unused_parameters_, nor with a sharded bucket optimizer, whose state
+  // is laid out like the buckets.
   inline bool should_rebuild_buckets() const {
-    return !find_unused_parameters_ && !has_rebuilt_bucket_;
+    return !find_unused_parameters_ && !has_rebuilt_bucket_ &&
+        !shard_bucket_optimizer_;
   }
 
   // Pushes all parameters to be rebuilt.
@@ -300,7 +324,8 @@ class Reducer {
     // Keep work handle around when this set of buckets is being reduced.
     c10::intrusive_ptr<c10d::ProcessGroup::Work> work;
 
-    // Keep future work handle around if DDP comm hook is registered.
+    // Keep future work handle around if DDP comm hook or bucket optimizer is
+    // registered.
     c10::intrusive_ptr<torch::jit::Future> future_work;
 
     // If this bucket should expect a single sparse gradient.
@@ -425,6 +450,33 @@ class Reducer {
     const std::vector<torch::autograd::Variable>& outputs);
   // comm_hook_ is used to access the DDP communication hook if registered.
   std::unique_ptr<CommHookInterface> comm_hook_;
+  // bucket_optimizer_ is set if the parameters are stepped per bucket.
+  std::unique_ptr<BucketOptimizer> bucket_optimizer_;
+  // Steps the parameters of the bucket once the values of the future, which
+  // are reduced, are in its contents. Returns the future of the step.
+  c10::intrusive_ptr<torch::jit::Future> step_bucket_optimizer(
+      Bucket& bucket,
+      c10::intrusive_ptr<torch::jit::Future> reduced);
+  // Whether bucket_optimizer_ steps the shards of the buckets.
+  bool shard_bucket_optimizer_ = false;
+  // Reduce-scatters the bucket and steps the shard of this process, then
+  // allgathers the parameters. Returns the future of the allgather.
+  c10::intrusive_ptr<torch::jit::Future> step_sharded_bucket_optimizer(
+      size_t bucket_index,
+      Bucket& bucket);
+  // See Note [Adaptive bucketing]. Sums of the times the gradients of the
+  // variables of replica 0 were ready, over adaptive_bucketing_samples_
+  // backward passes.
+  size_t adaptive_bucketing_iterations_ = 0;
+  size_t adaptive_bucketing_samples_ = 0;
+  std::vector<int64_t> ready_time_sums_;
+  bool has_tuned_buckets_ = false;
+  bool should_tune_buckets() const;
+  void record_ready_times();
+  void tune_buckets();
+  // Returns alpha and beta, in nanoseconds, such that allreducing a bucket of
+  // b bytes takes alpha + beta * b.
+  std::pair<double, double> measure_allreduce_cost();
   // Current thread local state
   at::ThreadLocalState thread_local_state_;
   friend class Logger;
@@ -442,6 +494,21 @@ std::vector<std::vector<size_t>> compute_bucket_assignment_by_size(
     const std::vector<bool>& expect_sparse_gradient = {},
     const std::vector<int64_t>& tensor_indices = {});
 
+// Splits tensors into the buckets that minimize the time the reduction of the
+// last bucket ends, given the time ready_times[i] the gradient of tensors[i] is
+// ready and a cost of alpha + beta * b to reduce a bucket of b bytes, see
+// Note [Adaptive bucketing]. The buckets are returned in the order their
+// gradients are ready. Like compute_bucket_assignment_by_size, the index of
+// tensors[i] assigned to bucket is tensor_indices[i], or i if tensor_indices
+// is empty.
+std::vector<std::vector<size_t>> compute_bucket_assignment_by_time(
+    const std::vector<at::Tensor>& tensors,
+    const std::vector<double>& ready_times,
+    double alpha,
+    double beta,
+    const std::vector<bool>& expect_sparse_gradient = {},
+    const std::vector<int64_t>& tensor_indices = {});
+
 // Verify models across all processes are the same as model on rank 0 with
 // respect to no. of params and matching dtype/size/layout.
 void verify_replica0_across_processes(
@@ -0,0 +1,188 @@
+#include <c10d/snapshot.hpp>
+
+#include <chrono>
+#include <unordered_set>
+
+#include <ATen/core/Dict.h>
+#include <c10/core/StreamGuard.h>
+#include <c10/core/impl/VirtualGuardImpl.h>
+#include <c10/util/Exception.h>
+#include <c10/util/Logging.h>
+#include <caffe2/serialize/inline_container.h>
+#include <torch/csrc/jit/serialization/export.h>
+#include <torch/csrc/jit/serialization/pickler.h>
+
+namespace c10d {
+
+// Note [Checkpoint snapshots]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Saving a checkpoint with torch.save stops training for as long as it takes
+// to copy the state to the host and write it out. A snapshot splits this in
+// two. The capture copies every tensor into a host buffer of the service,
+// pinned for device tensors, with non-blocking copies on a side stream per
+// device. The side stream waits for the work already enqueued on the current
+// stream, and the current stream waits for the copies, so the caller does not
+// block: only the device work that follows, such as the optimizer step that
+// updates the parameters in place, is delayed by the device to host copies.
+// The buffers are kept across snapshots, so once the first one is taken the
+// capture allocates nothing.
+//
+// A writer thread then waits for the copies, pickles the buffers as a dict
+// the way torch.save does and writes it with PyTorchStreamWriter to one file
+// per rank, while the training goes on. There is one set of buffers, so the
+// next snapshot waits for this write to finish.
+SnapshotService::SnapshotService(int64_t rank) : rank_(rank) {
+  TORCH_CHECK(rank >= 0, "Invalid rank ", rank);
+}
+
+SnapshotService::~SnapshotService() {
+  try {
+    wait();
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Writing the checkpoint snapshot of rank " << rank_
+               << " failed: " << e.what();
+  }
+}
+
+std::string SnapshotService::shardPath(
+    const std::string& directory,
+    int64_t rank) {
+  return directory + "/rank_" + std::to_string(rank) + ".pt";
+}
+
+void SnapshotService::snapshot(
+    const std::vector<std::string>& names,
+    const std::vector<at::Tensor>& tensors,
+    const std::string& directory) {
+  TORCH_CHECK(
+      names.size() == tensors.size(),
+      "Expected as many names as tensors, got ",
+      names.size(),
+      " names and ",
+      tensors.size(),
+      " tensors");
+  wait();
+  capture(names, tensors);
+  const auto path = shardPath(directory, rank_);
+  done_ = false;
+  writer_ = std::thread([this, path] {
+    try {
+      write(path);
+    } catch (...) {
+      error_ = std::current_exception();
+    }
+    done_ = true;
+  });
+}
+
+void SnapshotService::wait() {
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+  if (error_) {
+    auto error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+bool SnapshotService::isCompleted() const {
+  return done_;
+}
+
+void SnapshotService::capture(
+    const std::vector<std::string>& names,
+    const std::vector<at::Tensor>& tensors) {
+  at::NoGradGuard no_grad;
+  const std::unordered_set<std::string> unique_names(names.begin(), names.end());
+  TORCH_CHECK(
+      unique_names.size() == names.size(),
+      "The names of the tensors of a snapshot must be unique");
+  // Free the buffers of the tensors that are no longer part of the snapshot.
+  for (auto it = buffers_.begin(); it != buffers_.end();) {
+    if (unique_names.count(it->first) == 0) {
+      it = buffers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  std::unordered_map<c10::Device, std::vector<size_t>> device_tensors;
+  for (size_t i = 0; i < tensors.size(); i++) {
+    const auto& tensor = tensors[i];
+    TORCH_CHECK(
+        tensor.defined() && tensor.layout() == at::kStrided,
+        "Snapshots only support dense tensors, got ",
+        names[i]);
+    const bool on_device = tensor.device().type() != at::kCPU;
+    auto& buffer = buffers_[names[i]];
+    if (!buffer.defined() || buffer.sizes() != tensor.sizes() ||
+        buffer.scalar_type() != tensor.scalar_type()) {
+      buffer = at::empty(
+          tensor.sizes(),
+          tensor.options().device(at::kCPU).pinned_memory(on_device));
+    }
+    if (on_device) {
+      device_tensors[tensor.device()].push_back(i);
+    } else {
+      buffer.copy_(tensor);
+    }
+  }
+
+  events_.clear();
+  for (const auto& entry : device_tensors) {
+    const auto device = entry.first;
+    const c10::impl::VirtualGuardImpl impl{device.type()};
+    auto it = streams_.find(device);
+    if (it == streams_.end()) {
+      it = streams_.emplace(device, impl.getStreamFromGlobalPool(device))
+               .first;
+    }
+    const auto stream = it->second;
+    const auto current = impl.getStream(device);
+
+    c10::Event ready{device.type()};
+    ready.record(current);
+    ready.block(stream);
+    {
+      c10::OptionalStreamGuard guard{stream};
+      for (const auto i : entry.second) {
+        buffers_[names[i]].copy_(tensors[i], /*non_blocking=*/true);
+        // The tensor must outlive the copy even if the caller frees it.
+        impl.recordDataPtrOnStream(tensors[i].storage().data_ptr(), stream);
+      }
+    }
+    c10::Event copied{device.type()};
+    copied.record(stream);
+    copied.block(current);
+    events_.push_back(std::move(copied));
+  }
+  names_ = names;
+}
+
+void SnapshotService::write(const std::string& path) {
+  for (const auto& event : events_) {
+    while (!event.query()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  c10::Dict<std::string, at::Tensor> state;
+  for (const auto& name : names_) {
+    state.insert(name, buffers_.at(name));
+  }
+  std::vector<char> data;
+  torch::jit::Pickler pickler([&](const char* buf, size_t size) {
+    data.insert(data.end(), buf, buf + size);
+  });
+  pickler.protocol();
+  pickler.pushIValue(state);
+  pickler.stop();
+
+  caffe2::serialize::PyTorchStreamWriter writer(path);
+  torch::jit::writeArchiveAndTensors(
+      "data", data.data(), data.size(), pickler.tensorData(), writer);
+  writer.writeEndOfFile();
+}
+
+} // namespace c10d
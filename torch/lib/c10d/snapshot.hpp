@@ -0,0 +1,70 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+#include <atomic>
+#include <exception>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <c10/core/Event.h>
+#include <c10/core/Stream.h>
+
+namespace c10d {
+
+// Saves the state of one rank, such as its parameters and optimizer state,
+// while training goes on, see Note [Checkpoint snapshots].
+class SnapshotService {
+ public:
+  explicit SnapshotService(int64_t rank);
+
+  // Waits for the write in progress, and logs rather than throws its error.
+  ~SnapshotService();
+
+  // Captures tensors and writes them, as a dict from names to tensors that
+  // torch.load reads back, to shardPath(directory, rank) in the background.
+  // Returns once the copies are enqueued. The tensors can be modified in
+  // place right away on their current stream, whose later work waits for the
+  // copies. Waits for the previous write first, and rethrows its error.
+  void snapshot(
+      const std::vector<std::string>& names,
+      const std::vector<at::Tensor>& tensors,
+      const std::string& directory);
+
+  // Waits for the write in progress, if any, and rethrows its error.
+  void wait();
+
+  // Whether the last snapshot is written.
+  bool isCompleted() const;
+
+  static std::string shardPath(const std::string& directory, int64_t rank);
+
+ private:
+  // Copies to the host buffers on the side streams, and records the events
+  // the writer waits on.
+  void capture(
+      const std::vector<std::string>& names,
+      const std::vector<at::Tensor>& tensors);
+
+  void write(const std::string& path);
+
+  const int64_t rank_;
+
+  // Host copy of the tensor of each name, reused across snapshots as long as
+  // its size and type do not change, and pinned for the device tensors.
+  std::unordered_map<std::string, at::Tensor> buffers_;
+  // Names of the tensors of the last snapshot, in order.
+  std::vector<std::string> names_;
+  // Side stream of each device the tensors are on, and the events recorded
+  // on them after the copies of the last snapshot.
+  std::unordered_map<c10::Device, c10::Stream> streams_;
+  std::vector<c10::Event> events_;
+
+  std::thread writer_;
+  std::atomic<bool> done_{true};
+  std::exception_ptr error_;
+};
+
+} // namespace c10d
@@ -699,8 +699,14 @@ class DistributedDataParallel(Module):
             self.logger.set_runtime_stats_and_log()
             self.reducer.prepare_for_forward()
         if self.ddp_uneven_inputs_config.ddp_join_enabled:
-            ones = torch.ones(1, device=self.device)
-            work = dist.all_reduce(ones, group=self.process_group, async_op=True)
+            # A single allreduce per iteration tells joined ranks both that
+            # this rank is still active and whether it syncs gradients in this
+            # backward pass. The reducer only waits for it when the first
+            # gradient is ready, so it overlaps with the forward pass.
+            join_signal = torch.ones(2, device=self.device)
+            if not (torch.is_grad_enabled() and self.require_backward_grad_sync):
+                join_signal[1] = 0
+            work = dist.all_reduce(join_signal, group=self.process_group, async_op=True)
             self.reducer._set_forward_pass_work_handle(
                 work,
                 self.ddp_uneven_inputs_config.ddp_join_divide_by_initial_world_size,
@@ -718,10 +724,6 @@ class DistributedDataParallel(Module):
         if self.require_forward_param_sync:
             self._sync_params()
 
-        if self.ddp_uneven_inputs_config.ddp_join_enabled:
-            # Notify joined ranks whether they should sync in backwards pass or not.
-            self._check_global_requires_backward_grad_sync(is_joined_rank=False)
-
         if self.device_ids:
             inputs, kwargs = self.to_kwargs(inputs, kwargs, self.device_ids[0])
             output = self.module(*inputs[0], **kwargs[0])
@@ -809,25 +811,14 @@ class DistributedDataParallel(Module):
         return self
 
     # When running in join mode, schedules an allreduce to match the one in the
-    # forward pass to determine the no. of currently active processes and whether
-    # all processes have joined.
+    # forward pass to determine the no. of currently active processes, whether
+    # all processes have joined, and whether any of the active processes syncs
+    # gradients in this iteration's backward pass.
     def _schedule_shadow_all_reduce_for_fwd_pass(self):
-        all_active_procs = torch.zeros(1, device=self.device)
-        dist.all_reduce(all_active_procs, group=self.process_group)
-        return all_active_procs.item()
-
-    # When running in join mode, schedules an allreduce to notify joined ranks
-    # of whether backwards pass synchronization will run this iteraton or not.
-    def _check_global_requires_backward_grad_sync(self, is_joined_rank):
-        if not is_joined_rank and self.require_backward_grad_sync:
-            requires_sync_tensor = torch.ones(1, device=self.device)
-        else:
-            requires_sync_tensor = torch.zeros(1, device=self.device)
-
-        work = dist.all_reduce(
-            requires_sync_tensor, group=self.process_group, async_op=True
-        )
-        return work, requires_sync_tensor
+        join_signal = torch.zeros(2, device=self.device)
+        dist.all_reduce(join_signal, group=self.process_group)
+        num_active_procs, num_syncing_procs = join_signal.tolist()
+        return num_active_procs, num_syncing_procs != 0
 
     # When running in join mode, checks and performs sync of module buffers if
     # the models have buffers that should be synchronized in the forward pass.
@@ -987,7 +978,10 @@ class DistributedDataParallel(Module):
                             "lead to performance degradation during training."
                         )
                     # Schedules allreduce to match fwd pass allreduce in non-joined procs
-                    num_active_procs = self._schedule_shadow_all_reduce_for_fwd_pass()
+                    (
+                        num_active_procs,
+                        should_sync_backwards,
+                    ) = self._schedule_shadow_all_reduce_for_fwd_pass()
                     if num_active_procs == 0:
                         all_procs_joined = True
                     else:
@@ -1000,15 +994,6 @@ class DistributedDataParallel(Module):
                         # buffers in the forward pass.
                         self._check_and_sync_module_buffers()
 
-                        (
-                            work,
-                            should_sync_backwards_tensor,
-                        ) = self._check_global_requires_backward_grad_sync(
-                            is_joined_rank=True
-                        )
-                        work.wait()
-                        # If nonzero, then we should sync in the bwd pass.
-                        should_sync_backwards = should_sync_backwards_tensor.item() != 0
                         # Forward param sync is disabled in the next iteration
                         # if we are skipping grad sync this iteration. Hence, we
                         # set require_forward_param_sync appropriately here.
@@ -1116,7 +1101,7 @@ class DistributedDataParallel(Module):
         self.logger._set_comm_hook_name(hook.__qualname__)
         dist._register_comm_hook(self.reducer, state, hook)
 
-    def _register_builtin_comm_hook(self, comm_hook_type):
+    def _register_builtin_comm_hook(self, comm_hook_type, options=None):
         r"""
         Registers a built-in communication hook that specifies how DDP
         aggregates gradients across multiple workers.
@@ -1125,7 +1110,9 @@ class DistributedDataParallel(Module):
 
         Args:
             comm_hook_type (dist.BuiltinCommHookType): type of communication hook, such as
-            ALLREDUCE, FP16_COMPRESS, etc.
+            ALLREDUCE, FP16_COMPRESS, POWER_SGD, TOPK_SPARSIFY, etc.
+            options (dist.BuiltinCommHookOptions, optional): hyperparameters of the
+            POWER_SGD and TOPK_SPARSIFY hooks, the defaults if ``None``.
 
         .. warning ::
             DDP communication hook can only be registered once and should be registered
@@ -1145,9 +1132,95 @@ class DistributedDataParallel(Module):
 
             >>> ddp._register_builtin_comm_hook(dist.BuiltinCommHookType.FP16_COMPRESS)
 
+            Below is an example of PowerSGD with a rank of 2, started after 100
+            iterations of vanilla allreduce, which runs without holding the GIL.
+
+            >>> options = dist.BuiltinCommHookOptions()
+            >>> options.matrix_approximation_rank = 2
+            >>> options.start_iter = 100
+            >>> ddp._register_builtin_comm_hook(dist.BuiltinCommHookType.POWER_SGD, options)
+
         """
         self.logger._set_comm_hook_name(str(comm_hook_type))
-        dist._register_builtin_comm_hook(self.reducer, comm_hook_type)
+        if options is None:
+            options = dist.BuiltinCommHookOptions()
+        dist._register_builtin_comm_hook(self.reducer, comm_hook_type, options)
+
+    def _register_bucket_optimizer(
+        self, optimizer_type, options=None, shard_optimizer_state=False
+    ):
+        r"""
+        Registers an optimizer that DDP runs on the parameters of each bucket
+        as soon as the gradients of the bucket are allreduced, so that the
+        optimizer step overlaps with the backward pass and the communication
+        of the remaining buckets, instead of running after them.
+
+        Args:
+            optimizer_type (dist.BucketOptimizerType): ``SGD`` or ``ADAM``.
+            options (dist.BucketOptimizerOptions, optional): hyperparameters of
+            the optimizer, the defaults if ``None``.
+            shard_optimizer_state (bool, optional): if ``True``, each bucket is
+            reduce-scattered instead of allreduced, each rank steps its shard
+            of the parameters of the bucket and keeps the optimizer state of
+            that shard only, and the updated parameters are allgathered
+            (ZeRO stage 2). The ``.grad`` of the parameters are then not
+            reduced. Buckets are not rebuilt in this mode.
+
+        .. warning ::
+            The parameters are updated by the end of ``backward()``, so they must
+            not also be stepped by an optimizer. Gradients still accumulate and
+            need to be zeroed as usual.
+
+        .. warning ::
+            The bucket optimizer can only be registered once, before calling
+            backward. It requires the NCCL backend and
+            ``gradient_as_bucket_view=True``, and does not support
+            ``find_unused_parameters=True``, sparse gradients or
+            single-process multiple-device mode.
+
+        .. warning ::
+            The bucket optimizer is experimental and subject to change.
+
+        Example::
+            Below is an example of SGD with momentum stepped per bucket.
+
+            >>> ddp = DistributedDataParallel(model, gradient_as_bucket_view=True)
+            >>> options = dist.BucketOptimizerOptions()
+            >>> options.lr = 0.1
+            >>> options.momentum = 0.9
+            >>> ddp._register_bucket_optimizer(dist.BucketOptimizerType.SGD, options)
+            >>> ddp(input).sum().backward()  # also updates the parameters
+
+        """
+        if options is None:
+            options = dist.BucketOptimizerOptions()
+        dist._register_bucket_optimizer(
+            self.reducer, optimizer_type, options, shard_optimizer_state
+        )
+
+    def _enable_adaptive_bucketing(self, num_iterations=10):
+        r"""
+        Tunes the bucket boundaries to the measured timing of the training.
+        After the buckets are rebuilt in the order in which gradients become
+        ready, DDP averages over ``num_iterations`` iterations the time at
+        which each gradient is ready in the backward pass. It then measures the
+        cost of an allreduce, and sets once the buckets that minimize the
+        communication left to wait for after the backward pass, instead of
+        filling them up to ``bucket_cap_mb``.
+
+        Args:
+            num_iterations (int): number of backward passes to time.
+
+        .. warning ::
+            The buckets of rank 0 are used on all ranks, and the timing only
+            uses host timestamps. Communication hooks that keep per-bucket
+            state should not rely on bucket indices across the tuning.
+
+        Example::
+            >>> ddp = DistributedDataParallel(model)
+            >>> ddp._enable_adaptive_bucketing(num_iterations=20)
+        """
+        self.reducer._enable_adaptive_bucketing(num_iterations)
 
     def _distributed_broadcast_coalesced(
         self, tensors, buffer_size, authoritative_rank=0
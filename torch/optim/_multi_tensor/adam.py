@@ -22,6 +22,11 @@ class Adam(Optimizer):
         amsgrad (boolean, optional): whether to use the AMSGrad variant of this
             algorithm from the paper `On the Convergence of Adam and Beyond`_
             (default: False)
+        capturable (boolean, optional): whether this instance is safe to
+            capture in a CUDA graph (see :ref:`cuda-graph-semantics`). The
+            step counts are then kept in tensors on the device of the
+            parameters, so that replays of the graph advance them, while the
+            learning rate is fixed at capture time (default: False)
 
     .. _Adam\: A Method for Stochastic Optimization:
         https://arxiv.org/abs/1412.6980
@@ -32,7 +37,7 @@ class Adam(Optimizer):
     """
 
     def __init__(self, params, lr=1e-3, betas=(0.9, 0.999), eps=1e-8,
-                 weight_decay=0, amsgrad=False):
+                 weight_decay=0, amsgrad=False, capturable=False):
         if not 0.0 <= lr:
             raise ValueError("Invalid learning rate: {}".format(lr))
         if not 0.0 <= eps:
@@ -44,13 +49,15 @@ class Adam(Optimizer):
         if not 0.0 <= weight_decay:
             raise ValueError("Invalid weight_decay value: {}".format(weight_decay))
         defaults = dict(lr=lr, betas=betas, eps=eps,
-                        weight_decay=weight_decay, amsgrad=amsgrad)
+                        weight_decay=weight_decay, amsgrad=amsgrad,
+                        capturable=capturable)
         super(Adam, self).__init__(params, defaults)
 
     def __setstate__(self, state):
         super(Adam, self).__setstate__(state)
         for group in self.param_groups:
             group.setdefault('amsgrad', False)
+            group.setdefault('capturable', False)
 
     @torch.no_grad()
     def step(self, closure=None):
@@ -67,6 +74,7 @@ class Adam(Optimizer):
 
         for group in self.param_groups:
             amsgrad = group['amsgrad']
+            capturable = group['capturable']
 
             grads = []
             states = []
@@ -87,7 +95,8 @@ class Adam(Optimizer):
 
                 # State initialization
                 if len(state) == 0:
-                    state['step'] = 0
+                    state['step'] = (torch.zeros((), dtype=torch.float, device=p.device)
+                                     if capturable else 0)
                     # Exponential moving average of gradient values
                     state['exp_avg'] = torch.zeros_like(p, memory_format=torch.preserve_format)
                     # Exponential moving average of squared gradient values
@@ -102,13 +111,29 @@ class Adam(Optimizer):
                 if amsgrad:
                     max_exp_avg_sq.append(state['max_exp_avg_sq'])
 
-                state['step'] += 1
+                # Steps move between Python numbers and tensors when the
+                # state is loaded into an optimizer with a different capturable
+                if capturable and not torch.is_tensor(state['step']):
+                    state['step'] = torch.tensor(float(state['step']), device=p.device)
+                elif not capturable and torch.is_tensor(state['step']):
+                    state['step'] = int(state['step'].item())
+
+                if not capturable:
+                    state['step'] += 1
                 states.append(state)
 
             beta1, beta2 = group['betas']
 
-            bias_correction1 = [1 - beta1 ** state['step'] for state in states]
-            bias_correction2 = [1 - beta2 ** state['step'] for state in states]
+            if capturable:
+                # Everything that depends on the steps is computed on the
+                # device, so that it is part of the captured graph
+                state_steps = [state['step'] for state in states]
+                torch._foreach_add_(state_steps, 1)
+                bias_correction1 = [1 - torch.pow(beta1, step) for step in state_steps]
+                bias_correction2 = [1 - torch.pow(beta2, step) for step in state_steps]
+            else:
+                bias_correction1 = [1 - beta1 ** state['step'] for state in states]
+                bias_correction2 = [1 - beta2 ** state['step'] for state in states]
             if group['weight_decay'] != 0:
                 grads = torch._foreach_add(grads, params_with_grad, alpha=group['weight_decay'])
 
@@ -127,17 +152,29 @@ class Adam(Optimizer):
 
                 # Use the max. for normalizing running avg. of gradient
                 max_exp_avg_sq_sqrt = torch._foreach_sqrt(max_exp_avg_sq)
-                bias_correction_sqrt = [math.sqrt(bc) for bc in bias_correction2]
+                if capturable:
+                    bias_correction_sqrt = torch._foreach_sqrt(bias_correction2)
+                else:
+                    bias_correction_sqrt = [math.sqrt(bc) for bc in bias_correction2]
                 torch._foreach_div_(max_exp_avg_sq_sqrt, bias_correction_sqrt)
                 denom = torch._foreach_add(max_exp_avg_sq_sqrt, group['eps'])
             else:
                 exp_avg_sq_sqrt = torch._foreach_sqrt(exp_avg_sq)
-                bias_correction_sqrt = [math.sqrt(bc) for bc in bias_correction2]
+                if capturable:
+                    bias_correction_sqrt = torch._foreach_sqrt(bias_correction2)
+                else:
+                    bias_correction_sqrt = [math.sqrt(bc) for bc in bias_correction2]
                 torch._foreach_div_(exp_avg_sq_sqrt, bias_correction_sqrt)
                 denom = torch._foreach_add(exp_avg_sq_sqrt, group['eps'])
 
-            step_size = [(group['lr'] / bc) * -1 for bc in bias_correction1]
-            torch._foreach_addcdiv_(params_with_grad, exp_avg, denom, step_size)
+            if capturable:
+                # params -= lr / bc1 * exp_avg / denom, with the step sizes
+                # folded into the denominators since they are tensors
+                torch._foreach_mul_(denom, [bc / -group['lr'] for bc in bias_correction1])
+                torch._foreach_addcdiv_(params_with_grad, exp_avg, denom)
+            else:
+                step_size = [(group['lr'] / bc) * -1 for bc in bias_correction1]
+                torch._foreach_addcdiv_(params_with_grad, exp_avg, denom, step_size)
 
         return loss
 
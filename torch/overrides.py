@@ -85,6 +85,7 @@ def get_ignored_functions() -> Set[Callable]:
         torch.import_ir_module_from_buffer,
         torch.is_anomaly_enabled,
         torch.is_grad_enabled,
+        torch.is_inference_mode_enabled,
         torch.merge_type_from_type_comment,
         torch.parse_ir,
         torch.parse_schema,
@@ -113,6 +114,7 @@ def get_ignored_functions() -> Set[Callable]:
         torch.qscheme,
         torch.set_grad_enabled,
         torch.no_grad,
+        torch.inference_mode,
         torch.enable_grad,
         torch.layout,
         torch.align_tensors,
@@ -161,6 +163,7 @@ def get_ignored_functions() -> Set[Callable]:
         torch.scalar_tensor,
         torch.sparse_coo_tensor,
         torch.sparse_csr_tensor,
+        torch.sparse_bsr_tensor,
         torch.tril_indices,
         torch.triu_indices,
         torch.vander,
@@ -218,6 +221,7 @@ def get_ignored_functions() -> Set[Callable]:
         Tensor.stride,
         Tensor.unflatten,
         Tensor.to_sparse_csr,
+        Tensor.to_sparse_bsr,
         Tensor._reduce_ex_internal,
     }
 
@@ -401,6 +405,9 @@ def get_testing_overrides() -> Dict[Callable, Callable]:
         torch.expm1: lambda input, out=None: -1,
         torch.fake_quantize_per_channel_affine: lambda input, scale, zero_point, axis, quant_min, quant_max: -1,
         torch.fake_quantize_per_tensor_affine: lambda input, scale, zero_point, quant_min, quant_max: -1,
+        torch.fused_moving_avg_obs_fake_quant: (lambda x, observer_on, fake_quant_on, running_min, running_max, scale,
+                                                zero_point, averaging_const, quant_min, quant_max, ch_axis,
+                                                per_row_fake_quant=False, symmetric_quant=False: -1),
         torch.fbgemm_linear_fp16_weight: lambda input, packed_weight, bias: -1,
         torch.fbgemm_linear_fp16_weight_fp32_activation: lambda input, packed_weight, bias: -1,
         torch.fbgemm_linear_int8_weight: lambda input, weight, packed, col_offsets, weight_scale, weight_zero_point, bias: -1,
@@ -819,6 +826,7 @@ def get_testing_overrides() -> Dict[Callable, Callable]:
         torch.solve: lambda input, A, out=None: -1,
         torch.linalg.solve: lambda input, other, out=None: -1,
         torch.sort: lambda input, dim=-1, descending=False, *, stable=False, out=None: -1,
+        torch.sparse_sampled_addmm: lambda input, mat1, mat2, beta=1, alpha=1, out=None: -1,
         torch.split: lambda tensor, split_size_or_sections, dim=0: -1,
         torch.split_with_sizes: lambda tensor, split_size_or_sections, dim=0: -1,
         torch.sqrt: lambda input, out=None: -1,
@@ -904,6 +912,8 @@ def get_testing_overrides() -> Dict[Callable, Callable]:
         Tensor.__mod__: lambda self, other: -1,
         Tensor.__imod__: lambda self, other: -1,
         Tensor.__array_wrap__: lambda self, array: -1,
+        Tensor.__dlpack__: lambda self, stream=None: -1,
+        Tensor.__dlpack_device__: lambda self: -1,
         Tensor.__getitem__: lambda self, idx: -1,
         Tensor.__deepcopy__: lambda self, memo: -1,
         Tensor.__int__: lambda self: -1,
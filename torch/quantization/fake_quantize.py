@@ -244,6 +244,40 @@ class FixedQParamsFakeQuantize(FakeQuantizeBase):
                    self.quant_min, self.quant_max, self.qscheme)
 
 
+class FusedMovingAvgObsFakeQuantize(FakeQuantize):
+    r"""FakeQuantize with a moving average min/max observer, where observing,
+    computing the quantization parameters and fake quantizing the input are
+    done by the fused ``torch.fused_moving_avg_obs_fake_quant`` op. The
+    observer statistics, the parameters and the enabled flags all stay on the
+    device of the input, so the forward does not sync with the host.
+
+    The arguments are the same as for :class:`FakeQuantize`, with `observer`
+    one of :class:`MovingAverageMinMaxObserver` and
+    :class:`MovingAveragePerChannelMinMaxObserver`. The quantization parameters
+    are computed for the range [`quant_min`, `quant_max`] of this module.
+    """
+
+    def __init__(self, observer=MovingAverageMinMaxObserver, quant_min=0, quant_max=255, **observer_kwargs):
+        super().__init__(observer, quant_min, quant_max, **observer_kwargs)
+        assert type(self.activation_post_process) in \
+            [MovingAverageMinMaxObserver, MovingAveragePerChannelMinMaxObserver], \
+            'Only moving average observers are supported in FusedMovingAvgObsFakeQuantize, got ' + \
+            str(type(self.activation_post_process))
+        self.is_symmetric_quant = self.qscheme in [torch.per_tensor_symmetric, torch.per_channel_symmetric]
+
+    def forward(self, X):
+        observer = self.activation_post_process
+        if self.is_per_channel:
+            running_min, running_max = observer.min_vals, observer.max_vals
+        else:
+            running_min, running_max = observer.min_val, observer.max_val
+        return torch.fused_moving_avg_obs_fake_quant(
+            X, self.observer_enabled, self.fake_quant_enabled,
+            running_min, running_max, self.scale, self.zero_point,
+            observer.averaging_constant, self.quant_min, self.quant_max,
+            self.ch_axis, self.is_per_channel, self.is_symmetric_quant)
+
+
 default_fake_quant = FakeQuantize.with_args(observer=MovingAverageMinMaxObserver, quant_min=0, quant_max=255,
                                             dtype=torch.quint8, qscheme=torch.per_tensor_affine, reduce_range=True)
 default_weight_fake_quant = FakeQuantize.with_args(observer=MovingAverageMinMaxObserver, quant_min=-128, quant_max=127,
@@ -3116,6 +3116,8 @@ class DistributedTest:
             cpp_builtin_hooks = [
                 dist.BuiltinCommHookType.ALLREDUCE,
                 dist.BuiltinCommHookType.FP16_COMPRESS,
+                dist.BuiltinCommHookType.POWER_SGD,
+                dist.BuiltinCommHookType.TOPK_SPARSIFY,
             ]
 
             for hook in hooks:
@@ -1775,6 +1775,39 @@ class DistAutogradTest(CommonDistAutogradTest):
 
         dist.barrier()
 
+    def _run_backward_to_all_workers(self):
+        t1 = torch.rand((3, 3), requires_grad=True)
+        t2 = torch.rand((3, 3), requires_grad=True)
+        with dist_autograd.context() as context_id:
+            futs = [
+                rpc.rpc_async(worker_name(rank), torch.mul, args=(t1, t2))
+                for rank in range(self.world_size)
+                if rank != self.rank
+            ]
+            loss = torch.stack([fut.wait() for fut in futs]).sum()
+            # One RecvRpcBackward per worker is ready at once.
+            dist_autograd.backward(context_id, [loss])
+            grads = dist_autograd.get_gradients(context_id)
+            self.assertEqual(t2 * (self.world_size - 1), grads[t1])
+            self.assertEqual(t1 * (self.world_size - 1), grads[t2])
+
+    @dist_init
+    def test_backward_concurrent_contexts(self):
+        errors = []
+
+        def run():
+            try:
+                self._run_backward_to_all_workers()
+            except Exception as e:
+                errors.append(e)
+
+        threads = [threading.Thread(target=run) for _ in range(10)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual([], errors)
+
     @dist_init
     def test_backward_accumulate_grads(self):
         t1 = torch.rand((3, 3), requires_grad=True)
@@ -10,6 +10,7 @@ from torch.testing._internal.distributed.rpc.rpc_agent_test_fixture import (
 retryable_message_types = ["RREF_FORK_REQUEST",
                            "RREF_CHILD_ACCEPT",
                            "RREF_USER_DELETE",
+                           "RREF_CONTROL_BATCH",
                            "CLEANUP_AUTOGRAD_CONTEXT_REQ"]
 
 # The following messages incur the corresponding delay in seconds while being
@@ -246,6 +246,10 @@ def my_rref_function(rref_a, rref_b):
     return rref_a.to_here() + rref_b.to_here()
 
 
+def sum_rrefs(rrefs):
+    return sum(rref.to_here() for rref in rrefs)
+
+
 def delayed_add(a, b, seconds=0.05):
     time.sleep(seconds)
     return a + b
@@ -3183,6 +3187,24 @@ class RpcTest(RpcAgentTestFixture):
         )
         self.assertEqual(ret_rref.to_here(), True)
 
+    @dist_init
+    def test_many_short_lived_rrefs(self):
+        # Forks and deletes of many RRefs at once, whose control messages to
+        # the owner are batched.
+        if self.rank != 0:
+            return
+
+        owner_rank = 1
+        rrefs = [
+            rpc.remote(worker_name(owner_rank), torch.add, args=(torch.ones(2), i))
+            for i in range(50)
+        ]
+        ret = rpc.rpc_sync(worker_name(2), sum_rrefs, args=(rrefs,))
+        self.assertEqual(ret, sum(torch.ones(2) + i for i in range(50)))
+
+        del rrefs
+        wait_until_owners_and_forks_on_rank(0, 0, rank=owner_rank)
+
     @dist_init
     def test_rref_py_pickle_not_supported(self):
         local_rref = RRef(35)
@@ -4710,6 +4732,41 @@ class TensorPipeAgentRpcTest(RpcAgentTestFixture):
                 rpc_timeout=timeout,
             )
 
+    @dist_init(setup_rpc=False)
+    def test_tensorpipe_request_batching(self):
+        rpc_backend_options = rpc.TensorPipeRpcBackendOptions(
+            init_method=self.rpc_backend_options.init_method,
+            num_worker_threads=self.rpc_backend_options.num_worker_threads,
+            _batching_timeout_us=1000,
+            _batching_max_bytes=4096,
+        )
+        rpc.init_rpc(
+            name=worker_name(self.rank),
+            backend=self.rpc_backend,
+            rank=self.rank,
+            world_size=self.world_size,
+            rpc_backend_options=rpc_backend_options,
+        )
+
+        dst = worker_name((self.rank + 1) % self.world_size)
+        # Small requests are batched, either until the timeout or until the
+        # batch is full, and large ones are sent on their own after them.
+        futs = [
+            rpc.rpc_async(dst, torch.add, args=(torch.ones(2) * i, 1))
+            for i in range(100)
+        ]
+        futs.append(rpc.rpc_async(dst, torch.add, args=(torch.ones(4096), 1)))
+        for i, fut in enumerate(futs[:-1]):
+            self.assertEqual(fut.wait(), torch.ones(2) * i + 1)
+        self.assertEqual(futs[-1].wait(), torch.ones(4096) + 1)
+
+        # A lone request is sent once the timeout expires.
+        self.assertEqual(
+            rpc.rpc_sync(dst, torch.add, args=(torch.ones(2), 1)),
+            torch.ones(2) + 1,
+        )
+        rpc.shutdown()
+
     @dist_init
     def _test_rref_get_type_timeout(self, blocking):
         # Test where we try to get the type of a RRef from an owner, but RRef
@@ -5276,6 +5333,38 @@ class TensorPipeAgentCudaRpcTest(RpcAgentTestFixture):
         dst = worker_name(self.rank)
         self._test_device_maps_return_to_gpu(dst)
 
+    @staticmethod
+    def _gpu_view_add(x):
+        return x + 1
+
+    @skip_if_lt_x_gpu(2)
+    def test_device_maps_gpu_view(self):
+        options = self.rpc_backend_options
+        dst = worker_name((self.rank + 1) % self.world_size)
+        options.set_device_map(dst, {0: 1})
+
+        rpc.init_rpc(
+            name=worker_name(self.rank),
+            backend=self.rpc_backend,
+            rank=self.rank,
+            world_size=self.world_size,
+            rpc_backend_options=options,
+        )
+
+        # A small view of a large tensor is cloned before it is sent, which
+        # must be ordered after the kernels still writing to the tensor.
+        x = torch.zeros(1000 * 1000, device=0)
+        for _ in range(10):
+            x.add_(1)
+        ret = rpc.rpc_sync(
+            dst,
+            TensorPipeAgentCudaRpcTest._gpu_view_add,
+            args=(x[:10],)
+        )
+        self.assertEqual(ret.device, torch.device(0))
+        self.assertEqual(ret, torch.full((10,), 11.0, device=0))
+        rpc.shutdown()
+
     @staticmethod
     def _add_to_gpu(x, y):
         return (x + y).to(0)
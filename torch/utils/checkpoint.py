@@ -142,6 +142,42 @@ class CheckpointFunction(torch.autograd.Function):
         return (None, None) + grads
 
 
+
+def _checkpoint_without_reentrant(function, preserve_rng_state, args):
+    """Runs ``function(*args)`` with a packer that drops the tensors it saves
+    for backward and recomputes them by running it again when the backward
+    first needs one of them. Returns the outputs and the packer, whose
+    ``finish`` still has to be called."""
+    had_autocast_in_fwd = torch.is_autocast_enabled()
+    fwd_cpu_state = None
+    had_cuda_in_fwd = False
+    fwd_gpu_devices: List[int] = []
+    fwd_gpu_states: List[torch.Tensor] = []
+    if preserve_rng_state:
+        fwd_cpu_state = torch.get_rng_state()
+        # Don't eagerly initialize the cuda context, see CheckpointFunction
+        if torch.cuda._initialized:
+            had_cuda_in_fwd = True
+            fwd_gpu_devices, fwd_gpu_states = get_device_states(*args)
+
+    def recompute():
+        with torch.random.fork_rng(devices=fwd_gpu_devices, enabled=preserve_rng_state):
+            if preserve_rng_state:
+                torch.set_rng_state(fwd_cpu_state)
+                if had_cuda_in_fwd:
+                    set_device_states(fwd_gpu_devices, fwd_gpu_states)
+            with torch.enable_grad(), torch.cuda.amp.autocast(had_autocast_in_fwd):
+                function(*detach_variable(tuple(args)))
+
+    packer = torch._C._autograd._make_recompute_saved_tensor_packer(recompute, 0)
+    prev = torch._C._autograd._get_saved_tensor_packer()
+    torch._C._autograd._set_saved_tensor_packer(packer)
+    try:
+        outputs = function(*args)
+    finally:
+        torch._C._autograd._set_saved_tensor_packer(prev)
+    return outputs, packer
+
 def checkpoint(function, *args, **kwargs):
     r"""Checkpoint a model or part of the model
 
@@ -190,6 +226,13 @@ def checkpoint(function, *args, **kwargs):
         model won't have gradients. At least one of the outputs needs to have
         :code:`requires_grad=True` as well.
 
+    With ``use_reentrant=False``, :attr:`function` instead runs with gradients
+    enabled, and the autograd engine drops the tensors it saves for backward.
+    The first time the backward needs one of them, :attr:`function` is run
+    again to recompute them all. None of the limitations above apply then:
+    :func:`torch.autograd.grad` is supported and the outputs are the ones of
+    :attr:`function`. The inputs must not be modified in-place after the call.
+
     Args:
         function: describes what to run in the forward pass of the model or
             part of the model. It should also know how to handle the inputs
@@ -198,6 +241,9 @@ def checkpoint(function, *args, **kwargs):
             first input as ``activation`` and the second input as ``hidden``
         preserve_rng_state(bool, optional, default=True):  Omit stashing and restoring
             the RNG state during each checkpoint.
+        use_reentrant(bool, optional, default=True): Rerun :attr:`function`
+            in a nested backward pass instead of recomputing the saved tensors
+            in the autograd engine.
         args: tuple containing inputs to the :attr:`function`
 
     Returns:
@@ -205,10 +251,15 @@ def checkpoint(function, *args, **kwargs):
     """
     # Hack to mix *args with **kwargs in a python 2.7-compliant way
     preserve = kwargs.pop('preserve_rng_state', True)
+    use_reentrant = kwargs.pop('use_reentrant', True)
     if kwargs:
         raise ValueError("Unexpected keyword arguments: " + ",".join(arg for arg in kwargs))
 
-    return CheckpointFunction.apply(function, preserve, *args)
+    if use_reentrant:
+        return CheckpointFunction.apply(function, preserve, *args)
+    outputs, packer = _checkpoint_without_reentrant(function, preserve, args)
+    packer.finish(False)
+    return outputs
 
 
 def checkpoint_sequential(functions, segments, input, **kwargs):
@@ -244,6 +295,12 @@ def checkpoint_sequential(functions, segments, input, **kwargs):
         input: A Tensor that is input to :attr:`functions`
         preserve_rng_state(bool, optional, default=True):  Omit stashing and restoring
             the RNG state during each checkpoint.
+        memory_budget(int, optional): With a budget in bytes, the segments
+            are checkpointed with ``use_reentrant=False`` and only recomputed
+            as needed: the tensors a segment saves for backward are kept if
+            they fit in the budget, together with the ones kept for the
+            previous segments, otherwise they are recomputed in the backward
+            pass. ``0`` recomputes all of them.
 
     Returns:
         Output of running :attr:`functions` sequentially on :attr:`*inputs`
@@ -251,9 +308,12 @@ def checkpoint_sequential(functions, segments, input, **kwargs):
     Example:
         >>> model = nn.Sequential(...)
         >>> input_var = checkpoint_sequential(model, chunks, input_var)
+        >>> # keep up to 1 GiB of activations, recompute the rest
+        >>> input_var = checkpoint_sequential(model, chunks, input_var, memory_budget=1 << 30)
     """
     # Hack for keyword-only parameter in a python 2.7-compliant way
     preserve = kwargs.pop('preserve_rng_state', True)
+    memory_budget = kwargs.pop('memory_budget', None)
     if kwargs:
         raise ValueError("Unexpected keyword arguments: " + ",".join(arg for arg in kwargs))
 
@@ -270,8 +330,18 @@ def checkpoint_sequential(functions, segments, input, **kwargs):
     segment_size = len(functions) // segments
     # the last chunk has to be non-volatile
     end = -1
+    kept_bytes = 0
     for start in range(0, segment_size * (segments - 1), segment_size):
         end = start + segment_size - 1
-        input = checkpoint(run_function(start, end, functions), input,
-                           preserve_rng_state=preserve)
+        if memory_budget is None:
+            input = checkpoint(run_function(start, end, functions), input,
+                               preserve_rng_state=preserve)
+            continue
+        input, packer = _checkpoint_without_reentrant(
+            run_function(start, end, functions), preserve, (input,))
+        saved_bytes = packer.saved_bytes()
+        keep = kept_bytes + saved_bytes <= memory_budget
+        if keep:
+            kept_bytes += saved_bytes
+        packer.finish(keep)
     return run_function(end + 1, len(functions) - 1, functions)(input)
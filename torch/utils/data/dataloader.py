@@ -1180,6 +1180,9 @@ class _MultiProcessingDataLoaderIter(_BaseDataLoaderIter):
                 return self._process_data(data)
 
             assert not self._shutdown and self._tasks_outstanding > 0
+            # How many prefetched batches we are about to block on; a depth
+            # that stays near zero means the workers can't keep up.
+            torch._C._vital_record("dataloader.tasks_outstanding", self._tasks_outstanding)
             idx, data = self._get_data()
             self._tasks_outstanding -= 1
             if self._dataset_kind == _DatasetKind.Iterable:
@@ -1,19 +1,22 @@
+from typing import Any
+
+import enum
 import torch
 
-from torch._C import _from_dlpack as from_dlpack
+from torch._C import _from_dlpack
 from torch._C import _to_dlpack as to_dlpack
 
-torch._C._add_docstr(from_dlpack, r"""from_dlpack(dlpack) -> Tensor
-
-Decodes a DLPack to a tensor.
 
-Args:
-    dlpack: a PyCapsule object with the dltensor
+class DLDeviceType(enum.IntEnum):
+    # Enums as in DLPack specification (aten/src/ATen/dlpack.h)
+    kDLCPU = 1
+    kDLGPU = 2
+    kDLCPUPinned = 3
+    kDLOpenCL = 4
+    kDLMetal = 8
+    kDLVPI = 9
+    kDLROCM = 10
 
-The tensor will share the memory with the object represented
-in the dlpack.
-Note that each dlpack can only be consumed once.
-""")
 
 torch._C._add_docstr(to_dlpack, r"""to_dlpack(tensor) -> PyCapsule
 
@@ -22,6 +25,46 @@ Returns a DLPack representing the tensor.
 Args:
     tensor: a tensor to be exported
 
-The dlpack shares the tensors memory.
+The dlpack shares the tensors memory, non-contiguous tensors are exported
+with their strides instead of being copied.
 Note that each dlpack can only be consumed once.
 """)
+
+
+def from_dlpack(ext_tensor: Any) -> torch.Tensor:
+    """from_dlpack(ext_tensor) -> Tensor
+
+    Converts a tensor from an external library into a ``torch.Tensor``.
+
+    Args:
+        ext_tensor (object with ``__dlpack__`` attribute, or a DLPack capsule):
+            The tensor or DLPack capsule to convert.
+
+            If ``ext_tensor`` is a tensor (or ndarray) object, it must support
+            the ``__dlpack__`` protocol (i.e., have a ``ext_tensor.__dlpack__``
+            method). When it lives on a CUDA device, the current stream is
+            passed to ``__dlpack__`` so that the producer orders its pending
+            work before any work queued on that stream.
+
+            If ``ext_tensor`` is a DLPack capsule, it is converted as is, and
+            the caller is responsible for synchronizing the producer's stream.
+
+    The tensor will share the memory with the object represented
+    in the dlpack.
+    Note that each dlpack capsule can only be consumed once.
+    """
+    if hasattr(ext_tensor, '__dlpack__'):
+        device = ext_tensor.__dlpack_device__()
+        if device[0] in (DLDeviceType.kDLGPU, DLDeviceType.kDLROCM):
+            stream = torch.cuda.current_stream('cuda:{}'.format(device[1]))
+            # the array API passes the legacy default stream of CUDA as 1,
+            # since 0 is ambiguous there
+            is_cuda = device[0] == DLDeviceType.kDLGPU
+            stream_ptr = 1 if is_cuda and stream.cuda_stream == 0 else stream.cuda_stream
+            dlpack = ext_tensor.__dlpack__(stream=stream_ptr)
+        else:
+            dlpack = ext_tensor.__dlpack__()
+    else:
+        # a capsule from to_dlpack or another library
+        dlpack = ext_tensor
+    return _from_dlpack(dlpack)
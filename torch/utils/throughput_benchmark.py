@@ -36,6 +36,32 @@ class ExecutionStats(object):
     def num_iters(self):
         return self._c_stats.num_iters
 
+    @property
+    def latency_p50_ms(self):
+        return self._c_stats.latency_p50_ms
+
+    @property
+    def latency_p90_ms(self):
+        return self._c_stats.latency_p90_ms
+
+    @property
+    def latency_p99_ms(self):
+        return self._c_stats.latency_p99_ms
+
+    @property
+    def latency_max_ms(self):
+        return self._c_stats.latency_max_ms
+
+    @property
+    def latency_histogram(self):
+        '''
+        Returns a list of (bound_ms, count) pairs: count iterations took more than
+        the bound of the previous pair and at most bound_ms. The bounds double
+        from 10us up to the largest latency
+        '''
+        return list(zip(self._c_stats.latency_histogram_bounds_ms,
+                        self._c_stats.latency_histogram_counts))
+
     @property
     def iters_per_second(self):
         '''
@@ -45,27 +71,51 @@ class ExecutionStats(object):
 
     @property
     def total_time_seconds(self):
-        return self.num_iters * (
-            self.latency_avg_ms / 1000.0) / self.benchmark_config.num_calling_threads
+        return self._c_stats.total_time_ms / 1000.0
 
 
     def __str__(self):
         return '\n'.join([
             "Average latency per example: " + format_time(time_ms=self.latency_avg_ms),
+            "Latency p50 / p90 / p99: {} / {} / {}".format(
+                format_time(time_ms=self.latency_p50_ms),
+                format_time(time_ms=self.latency_p90_ms),
+                format_time(time_ms=self.latency_p99_ms)),
             "Total number of iterations: {}".format(self.num_iters),
             "Total number of iterations per second (across all threads): {:.2f}".format(self.iters_per_second),
             "Total time: " + format_time(time_s=self.total_time_seconds)
         ])
 
 
+def _benchmark_config(
+        num_calling_threads,
+        num_warmup_iters,
+        num_iters,
+        profiler_output_path,
+        static_runtime_max_batch_size,
+        static_runtime_max_batch_delay_us,
+        arrival_qps):
+    config = torch._C.BenchmarkConfig()
+    config.num_calling_threads = num_calling_threads
+    config.num_warmup_iters = num_warmup_iters
+    config.num_iters = num_iters
+    config.profiler_output_path = profiler_output_path
+    config.static_runtime_max_batch_size = static_runtime_max_batch_size
+    config.static_runtime_max_batch_delay_us = static_runtime_max_batch_delay_us
+    config.arrival_qps = arrival_qps
+    return config
+
+
 class ThroughputBenchmark(object):
     '''
     This class is a wrapper around a c++ component throughput_benchmark::ThroughputBenchmark
-    responsible for executing a PyTorch module (nn.Module or ScriptModule)
-    under an inference server like load. It can emulate multiple calling threads
-    to a single module provided. In the future we plan to enhance this component
-    to support inter and intra-op parallelism as well as multiple models
-    running in a single process.
+    responsible for executing a PyTorch module (nn.Module, ScriptModule or a
+    LiteScriptModule of the lite interpreter) under an inference server like load.
+    It can emulate multiple calling threads to a single module provided, with the
+    calls either made back to back or arriving at a given rate. Several
+    benchmarks can run in a single process with MultiModelThroughputBenchmark.
+    In the future we plan to enhance this component to support inter and
+    intra-op parallelism.
 
     Please note that even though nn.Module is supported, it might incur an overhead
     from the need to hold GIL every time we execute Python code or pass around
@@ -90,13 +140,23 @@ class ThroughputBenchmark(object):
         >>> print("Avg latency (ms): {}".format(stats.latency_avg_ms))
         >>> print("Number of iterations: {}".format(stats.num_iters))
 
+    Args:
+        module: the module to benchmark
+        use_static_runtime (bool): Run a ScriptModule on Static Runtime instead
+            of the JIT interpreter
+
     '''
 
-    def __init__(self, module):
+    def __init__(self, module, use_static_runtime=False):
+        from torch.jit.mobile import LiteScriptModule
         if isinstance(module, torch.jit.ScriptModule):
             self._benchmark = torch._C.ThroughputBenchmark(module._c)
+        elif isinstance(module, LiteScriptModule):
+            self._benchmark = torch._C.ThroughputBenchmark(module._c)
         else:
             self._benchmark = torch._C.ThroughputBenchmark(module)
+        if use_static_runtime:
+            self._benchmark.enable_static_runtime()
 
     def run_once(self, *args, **kwargs):
         '''
@@ -121,7 +181,10 @@ class ThroughputBenchmark(object):
             num_calling_threads=1,
             num_warmup_iters=10,
             num_iters=100,
-            profiler_output_path=""):
+            profiler_output_path="",
+            static_runtime_max_batch_size=0,
+            static_runtime_max_batch_delay_us=1000,
+            arrival_qps=0):
         '''
         Args:
             num_warmup_iters (int): Warmup iters are used to make sure we run a module
@@ -141,16 +204,90 @@ class ThroughputBenchmark(object):
                 execution (but not the warmup phase). The full trace will be saved
                 into the file path provided by this argument
 
+            static_runtime_max_batch_size (int): If positive, a ScriptModule is run by
+                Static Runtime and the concurrent calls of the calling threads are
+                coalesced into batches of up to this many rows. The inputs are
+                concatenated along dim 0 and the outputs split back, so all inputs and
+                outputs must be Tensors with the batch as dim 0
+
+            static_runtime_max_batch_delay_us (int): How long, in microseconds, a call
+                waits for other calls to batch with before it runs anyway
 
-        This function returns BenchmarkExecutionStats object which is defined via pybind11.
-        It currently has two fields:
+            arrival_qps (float): If positive, the calls arrive as a Poisson process
+                of this many calls per second, which the calling threads serve in
+                turn, instead of each thread making its next call as soon as the
+                previous one returns. The latency of a call then counts from its
+                arrival, including the time it waited for a free calling thread
+
+
+        This function returns an ExecutionStats object wrapping the
+        BenchmarkExecutionStats defined via pybind11. Its main fields are:
             - num_iters - number of actual iterations the benchmark have made
-            - avg_latency_ms - average time it took to infer on one input example in milliseconds
+            - latency_avg_ms - average time it took to infer on one input example in milliseconds
+            - latency_p50_ms, latency_p90_ms, latency_p99_ms - percentiles of that time
+            - latency_histogram - a histogram of that time
         '''
-        config = torch._C.BenchmarkConfig()
-        config.num_calling_threads = num_calling_threads
-        config.num_warmup_iters = num_warmup_iters
-        config.num_iters = num_iters
-        config.profiler_output_path = profiler_output_path
+        config = _benchmark_config(
+            num_calling_threads, num_warmup_iters, num_iters, profiler_output_path,
+            static_runtime_max_batch_size, static_runtime_max_batch_delay_us,
+            arrival_qps)
         c_stats = self._benchmark.benchmark(config)
         return ExecutionStats(c_stats, config)
+
+
+class MultiModelExecutionStats(object):
+    def __init__(self, c_stats, benchmark_config):
+        self.total = ExecutionStats(c_stats.total, benchmark_config)
+        self.models = [ExecutionStats(s, benchmark_config) for s in c_stats.models]
+
+    def __str__(self):
+        return '\n\n'.join(
+            ["All models:\n" + str(self.total)] +
+            ["Model {}:\n{}".format(i, s) for i, s in enumerate(self.models)])
+
+
+class MultiModelThroughputBenchmark(object):
+    '''
+    Runs several ThroughputBenchmarks in a single process, under the load of the
+    calls to all of them, to reproduce the contention between the models of a
+    server. Each call goes to one of the models at random, in proportion to their
+    weights, and the calling threads are shared by all the models.
+
+    Example::
+
+        >>> bench = MultiModelThroughputBenchmark()
+        >>> bench.add_model(ranking_bench, weight=3)
+        >>> bench.add_model(ThroughputBenchmark(lite_module), weight=1)
+        >>> stats = bench.benchmark(num_calling_threads=8, arrival_qps=2000)
+        >>> print("p99 of the lite module (ms): {}".format(stats.models[1].latency_p99_ms))
+    '''
+
+    def __init__(self):
+        self._benchmark = torch._C.MultiModelBenchmark()
+
+    def add_model(self, benchmark, weight=1.0):
+        '''
+        Adds a ThroughputBenchmark, with the inputs added to it, to the mix
+        '''
+        self._benchmark.add_model(benchmark._benchmark, weight)
+
+    def benchmark(
+            self,
+            num_calling_threads=1,
+            num_warmup_iters=10,
+            num_iters=100,
+            profiler_output_path="",
+            static_runtime_max_batch_size=0,
+            static_runtime_max_batch_delay_us=1000,
+            arrival_qps=0):
+        '''
+        Takes the arguments of ThroughputBenchmark.benchmark, which apply to all
+        the models, and returns a MultiModelExecutionStats with the ExecutionStats
+        of all the calls (total) and those of the calls to each model (models)
+        '''
+        config = _benchmark_config(
+            num_calling_threads, num_warmup_iters, num_iters, profiler_output_path,
+            static_runtime_max_batch_size, static_runtime_max_batch_delay_us,
+            arrival_qps)
+        c_stats = self._benchmark.benchmark(config)
+        return MultiModelExecutionStats(c_stats, config)